@@ -42,6 +42,16 @@ typedef struct {
 	size_t size;
 } irq_pio_range_t;
 
+/** Merge repeated notifications while one is still undelivered.
+ *
+ * With this subscription flag, an interrupt that arrives while the
+ * previous notification still waits in the answerbox updates that
+ * message in place instead of posting a new one. The difference
+ * between the request labels of two consecutively received
+ * notifications tells the driver how many interrupts they stand for.
+ */
+#define IRQ_NOTIF_COALESCE  1
+
 typedef enum {
 	/** Read 1 byte from the I/O space.
 	 *
@@ -35,11 +35,28 @@
 #ifndef _ABI_KLOG_H_
 #define _ABI_KLOG_H_
 
+#include <stdint.h>
+
 typedef enum {
 	KLOG_WRITE,
 	KLOG_READ
 } klog_operation_t;
 
+/** Header page of the kernel log physical memory area.
+ *
+ * The cyclic log entry buffer immediately follows the header page.
+ * All positions are monotonic byte counters; the buffer offset of a
+ * position is its remainder modulo the buffer length.
+ */
+typedef struct {
+	/** Total number of bytes appended to the log */
+	volatile uint64_t wpos;
+	/** Position of the oldest entry still present in the buffer */
+	volatile uint64_t start;
+	/** Consumer position, updated by the log reader */
+	volatile uint64_t rpos;
+} klog_shared_t;
+
 #endif
 
 /** @}
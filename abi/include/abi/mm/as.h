@@ -45,6 +45,7 @@ enum {
 	AS_AREA_CACHEABLE    = 0x08,
 	AS_AREA_GUARD        = 0x10,
 	AS_AREA_LATE_RESERVE = 0x20,
+	AS_AREA_HUGE         = 0x40,
 };
 
 static void *const AS_AREA_ANY = (void *) -1;
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup abi_generic
+ * @{
+ */
+/** @file
+ */
+
+#ifndef _ABI_PMU_H_
+#define _ABI_PMU_H_
+
+/** Number of hardware performance counters virtualized per task. */
+#define PMU_COUNTERS  2
+
+/** Hardware events countable by the performance counters. */
+typedef enum {
+	PMU_EVENT_CYCLES,
+	PMU_EVENT_INSTRUCTIONS,
+	PMU_EVENT_CACHE_REFS,
+	PMU_EVENT_CACHE_MISSES,
+	PMU_EVENT_BRANCHES,
+	PMU_EVENT_BRANCH_MISSES,
+
+	PMU_EVENT_MAX
+} pmu_event_t;
+
+/** Operations of the SYS_PMU_CTL syscall. */
+typedef enum {
+	PMU_CTL_START,
+	PMU_CTL_STOP,
+	PMU_CTL_READ
+} pmu_ctl_t;
+
+#endif
+
+/** @}
+ */
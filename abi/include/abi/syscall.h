@@ -107,7 +107,10 @@ typedef enum {
 
 	SYS_DEBUG_CONSOLE,
 
-	SYS_KLOG
+	SYS_KLOG,
+
+	SYS_BOOTTIME_MARK,
+	SYS_PMU_CTL
 } syscall_t;
 
 #endif
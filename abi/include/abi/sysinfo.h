@@ -144,6 +144,86 @@ typedef struct {
 	uint64_t count;              /**< Number of handled exceptions */
 } stats_exc_t;
 
+/** Tracepoint events recorded by the kernel
+ *
+ */
+typedef enum {
+	/** scheduler_enter(): arg1 = thread id, arg2 = new thread state */
+	TRACE_EVENT_SCHEDULER_ENTER = 1,
+	/** Syscall entry: arg1 = syscall id, arg2 = first syscall argument */
+	TRACE_EVENT_SYSCALL = 2,
+	/** ipc_call(): arg1 = interface and method, arg2 = caller task ID */
+	TRACE_EVENT_IPC_CALL = 3,
+	/** frame_alloc_generic(): arg1 = frame count, arg2 = flags */
+	TRACE_EVENT_FRAME_ALLOC = 4
+} trace_event_t;
+
+/** One tracepoint entry of the trace.data sysinfo item
+ *
+ * The item consists of one block per CPU, each block being the
+ * value of the per-CPU buffer head counter (a size_t) followed by
+ * trace.entries (another sysinfo item) entries.
+ *
+ */
+typedef struct {
+	uint64_t stamp;  /**< Cycle counter value at emit time */
+	uint32_t event;  /**< Event identifier (trace_event_t) */
+	uint32_t cpu;    /**< Logical id of the emitting CPU */
+	uint64_t arg1;   /**< First event argument */
+	uint64_t arg2;   /**< Second event argument */
+} trace_entry_t;
+
+/** The sample was taken while the CPU was executing kernel code */
+#define PROFILE_SAMPLE_KERNEL  0x01
+
+/** One sample of the profile.data sysinfo item
+ *
+ * The item consists of one block per CPU, each block being the
+ * value of the per-CPU buffer head counter (a size_t) followed by
+ * profile.entries (another sysinfo item) samples.
+ *
+ */
+typedef struct {
+	uint64_t pc;         /**< Interrupted program counter */
+	uint64_t task_id;    /**< ID of the interrupted task */
+	uint64_t thread_id;  /**< ID of the interrupted thread */
+	uint32_t cpu;        /**< Logical id of the sampling CPU */
+	uint32_t flags;      /**< PROFILE_SAMPLE_* flags */
+} profile_sample_t;
+
+/** Number of log2-scaled buckets in one IPC latency histogram */
+#define IPC_LAT_BUCKETS  32
+
+/** IPC latency histograms of the ipc.latency.data sysinfo item
+ *
+ * Aggregated over all calls answered in the system while IPC latency
+ * tracing was enabled. Bucket i of each histogram counts the calls
+ * for which the respective interval took between 2^i (inclusive) and
+ * 2^(i+1) (exclusive) CPU cycles.
+ *
+ */
+typedef struct {
+	uint64_t queue[IPC_LAT_BUCKETS];    /**< Send to server dispatch */
+	uint64_t service[IPC_LAT_BUCKETS];  /**< Dispatch to answer */
+	uint64_t ret[IPC_LAT_BUCKETS];      /**< Answer to caller pickup */
+} ipc_lat_data_t;
+
+/** Maximum size of a boot milestone name (including the terminator) */
+#define BOOTTIME_NAME_SIZE  32
+
+/** One milestone of the boottime.data sysinfo item
+ *
+ * The item is an array of the milestones recorded so far, in the
+ * order in which they were recorded.
+ *
+ */
+typedef struct {
+	uint64_t cycles;               /**< Cycle counter at the milestone */
+	uint64_t usec;                 /**< Uptime in microseconds (zero
+	                                    before the clock starts ticking) */
+	char name[BOOTTIME_NAME_SIZE]; /**< Milestone name */
+} boottime_entry_t;
+
 /** Load fixed-point value */
 typedef uint32_t load_t;
 
@@ -35,6 +35,10 @@
 #ifndef _ABI_UDEBUG_H_
 #define _ABI_UDEBUG_H_
 
+#include <_bits/native.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #define UDEBUG_EVMASK(event)  (1 << ((event) - 1))
 
 typedef enum { /* udebug_method_t */
@@ -150,7 +154,51 @@ typedef enum { /* udebug_method_t */
 	 * - ARG4 - size of receiving buffer in bytes
 	 *
 	 */
-	UDEBUG_M_MEM_READ
+	UDEBUG_M_MEM_READ,
+
+	/** Read several ranges of the debugged tasks's memory at once.
+	 *
+	 * - ARG2 - destination address in the caller's address space
+	 * - ARG3 - address of an array of udebug_mem_range_t structures
+	 *          in the caller's address space
+	 * - ARG4 - number of ranges in the array
+	 *
+	 * The ranges are read in order and packed back to back into the
+	 * destination buffer. On answer, the kernel will set:
+	 *
+	 * - ARG2 - total number of bytes copied
+	 *
+	 */
+	UDEBUG_M_MEM_READ_V,
+
+	/** Enable or disable the syscall event ring.
+	 *
+	 * While the ring is enabled, syscall events selected by the event
+	 * mask are recorded into a per-task ring instead of stopping the
+	 * thread and are drained with UDEBUG_M_EV_READ. Other events are
+	 * still reported through the GO protocol.
+	 *
+	 * - ARG2 - zero to disable, non-zero to enable
+	 *
+	 */
+	UDEBUG_M_SET_EVRING,
+
+	/** Read and remove recorded events from the syscall event ring.
+	 *
+	 * - ARG2 - destination address in the caller's address space
+	 * - ARG3 - size of receiving buffer in bytes
+	 *
+	 * The kernel fills the buffer with a series of udebug_ev_t
+	 * structures (oldest first) and removes them from the ring.
+	 * On answer, the kernel will set:
+	 *
+	 * - ARG2 - number of bytes that were actually copied
+	 * - ARG3 - number of bytes of the complete data
+	 * - ARG4 - number of events lost to ring overflow since the
+	 *          last read
+	 *
+	 */
+	UDEBUG_M_EV_READ
 } udebug_method_t;
 
 typedef enum {
@@ -178,6 +226,34 @@ typedef enum {
 	    UDEBUG_EVMASK(UDEBUG_EVENT_THREAD_E))
 } udebug_evmask_t;
 
+/** Maximum number of ranges in one UDEBUG_M_MEM_READ_V request. */
+#define UDEBUG_MEM_RANGES_MAX  64
+
+/** One source range of a vectored memory read. */
+typedef struct {
+	/** Address in the debugged task's address space */
+	uintptr_t addr;
+	/** Number of bytes to read */
+	size_t size;
+} udebug_mem_range_t;
+
+/** Number of entries in the syscall event ring. */
+#define UDEBUG_EV_RING_SIZE  128
+
+/** One syscall event recorded in the event ring. */
+typedef struct {
+	/** Hash of the thread that generated the event */
+	sysarg_t thread;
+	/** UDEBUG_EVENT_SYSCALL_B or UDEBUG_EVENT_SYSCALL_E */
+	sysarg_t etype;
+	/** Syscall number */
+	sysarg_t sc_id;
+	/** Syscall return value (end variant only) */
+	sysarg_t sc_rc;
+	/** Syscall arguments */
+	sysarg_t args[6];
+} udebug_ev_t;
+
 #endif
 
 /** @}
@@ -0,0 +1,766 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_adt
+ * @{
+ */
+
+/** @file B-tree ordered map.
+ *
+ * Cache-friendly alternative to the ordered dictionary. Where the
+ * ordered dictionary chases one pointer per comparison, a B-tree node
+ * packs several keys into a couple of cache lines, so a lookup touches
+ * only a handful of nodes. Unlike the ordered dictionary the map is not
+ * intrusive: it stores pointers to entries and obtains keys via a
+ * callback. Duplicate keys are not supported.
+ */
+
+#include <adt/btree.h>
+#include <assert.h>
+#include <errno.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/** Get key of entry.
+ *
+ * @param tree B-tree
+ * @param entry Entry
+ * @return Key of @a entry
+ */
+static void *btree_key(btree_t *tree, void *entry)
+{
+	return tree->getkey(entry);
+}
+
+/** Allocate new node.
+ *
+ * @param leaf True iff the new node is a leaf
+ * @return New node or @c NULL if out of memory
+ */
+static btree_node_t *btree_node_new(bool leaf)
+{
+	btree_node_t *node;
+
+	node = calloc(1, sizeof(btree_node_t));
+	if (node == NULL)
+		return NULL;
+
+	node->leaf = leaf;
+	return node;
+}
+
+/** Free node and all its descendants.
+ *
+ * @param node Node or @c NULL
+ */
+static void btree_node_destroy(btree_node_t *node)
+{
+	unsigned short i;
+
+	if (node == NULL)
+		return;
+
+	if (!node->leaf) {
+		for (i = 0; i <= node->nentries; i++)
+			btree_node_destroy(node->child[i]);
+	}
+
+	free(node);
+}
+
+/** Find position of key within node.
+ *
+ * Return the index of the first entry whose key is greater than or
+ * equal to @a key (possibly one past the last entry).
+ *
+ * @param tree B-tree
+ * @param node Node
+ * @param key Key
+ * @param match Place to store @c true iff the entry at the returned
+ *              index has key equal to @a key
+ * @return Entry index
+ */
+static unsigned short btree_node_find(btree_t *tree, btree_node_t *node,
+    void *key, bool *match)
+{
+	unsigned short i;
+	int rel;
+
+	/* Nodes are small and cache-resident; linear scan wins here. */
+	for (i = 0; i < node->nentries; i++) {
+		rel = tree->cmp(key, btree_key(tree, node->entry[i]));
+		if (rel <= 0) {
+			*match = (rel == 0);
+			return i;
+		}
+	}
+
+	*match = false;
+	return node->nentries;
+}
+
+/** Split full child of a node.
+ *
+ * Child @a idx of @a parent must be full and @a parent must not be.
+ * The child's median entry is promoted to @a parent and the upper
+ * half of the child moves to a newly allocated right sibling.
+ *
+ * @param parent Parent node
+ * @param idx Index of the full child
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t btree_split_child(btree_node_t *parent, unsigned short idx)
+{
+	btree_node_t *child = parent->child[idx];
+	btree_node_t *rnode;
+
+	assert(child->nentries == BTREE_MAX_ENTRIES);
+	assert(parent->nentries < BTREE_MAX_ENTRIES);
+
+	rnode = btree_node_new(child->leaf);
+	if (rnode == NULL)
+		return ENOMEM;
+
+	/* Upper half of the entries moves to the new right sibling. */
+	rnode->nentries = BTREE_DEGREE - 1;
+	memcpy(rnode->entry, &child->entry[BTREE_DEGREE],
+	    (BTREE_DEGREE - 1) * sizeof(void *));
+	if (!child->leaf) {
+		memcpy(rnode->child, &child->child[BTREE_DEGREE],
+		    BTREE_DEGREE * sizeof(btree_node_t *));
+	}
+
+	child->nentries = BTREE_DEGREE - 1;
+
+	/* Promote the median entry to the parent. */
+	memmove(&parent->entry[idx + 1], &parent->entry[idx],
+	    (parent->nentries - idx) * sizeof(void *));
+	memmove(&parent->child[idx + 2], &parent->child[idx + 1],
+	    (parent->nentries - idx) * sizeof(btree_node_t *));
+	parent->entry[idx] = child->entry[BTREE_DEGREE - 1];
+	parent->child[idx + 1] = rnode;
+	parent->nentries++;
+
+	return EOK;
+}
+
+/** Merge child with its right sibling.
+ *
+ * Both child @a idx and child @a idx + 1 of @a node must hold exactly
+ * BTREE_DEGREE - 1 entries. The separating entry is demoted from
+ * @a node and the right sibling is freed.
+ *
+ * @param node Parent node
+ * @param idx Index of the left child
+ */
+static void btree_merge_children(btree_node_t *node, unsigned short idx)
+{
+	btree_node_t *lnode = node->child[idx];
+	btree_node_t *rnode = node->child[idx + 1];
+
+	assert(lnode->nentries == BTREE_DEGREE - 1);
+	assert(rnode->nentries == BTREE_DEGREE - 1);
+
+	/* Demote the separating entry and append the right sibling. */
+	lnode->entry[BTREE_DEGREE - 1] = node->entry[idx];
+	memcpy(&lnode->entry[BTREE_DEGREE], rnode->entry,
+	    (BTREE_DEGREE - 1) * sizeof(void *));
+	if (!lnode->leaf) {
+		memcpy(&lnode->child[BTREE_DEGREE], rnode->child,
+		    BTREE_DEGREE * sizeof(btree_node_t *));
+	}
+	lnode->nentries = BTREE_MAX_ENTRIES;
+
+	memmove(&node->entry[idx], &node->entry[idx + 1],
+	    (node->nentries - idx - 1) * sizeof(void *));
+	memmove(&node->child[idx + 1], &node->child[idx + 2],
+	    (node->nentries - idx - 1) * sizeof(btree_node_t *));
+	node->nentries--;
+
+	free(rnode);
+}
+
+/** Make sure child is fit for removal descent.
+ *
+ * Ensure that child @a idx of @a node holds at least BTREE_DEGREE
+ * entries, borrowing an entry from a sibling or merging with one
+ * as needed. The child may be replaced by a merged node.
+ *
+ * @param node Parent node
+ * @param idx Index of the child; updated if a merge shifts it
+ */
+static void btree_fill_child(btree_node_t *node, unsigned short *idx)
+{
+	btree_node_t *child = node->child[*idx];
+	btree_node_t *lnode;
+	btree_node_t *rnode;
+
+	if (child->nentries >= BTREE_DEGREE)
+		return;
+
+	if (*idx > 0 && node->child[*idx - 1]->nentries >= BTREE_DEGREE) {
+		/* Borrow the largest entry from the left sibling. */
+		lnode = node->child[*idx - 1];
+
+		memmove(&child->entry[1], &child->entry[0],
+		    child->nentries * sizeof(void *));
+		if (!child->leaf) {
+			memmove(&child->child[1], &child->child[0],
+			    (child->nentries + 1) * sizeof(btree_node_t *));
+			child->child[0] = lnode->child[lnode->nentries];
+		}
+		child->entry[0] = node->entry[*idx - 1];
+		child->nentries++;
+
+		node->entry[*idx - 1] = lnode->entry[lnode->nentries - 1];
+		lnode->nentries--;
+	} else if (*idx < node->nentries &&
+	    node->child[*idx + 1]->nentries >= BTREE_DEGREE) {
+		/* Borrow the smallest entry from the right sibling. */
+		rnode = node->child[*idx + 1];
+
+		child->entry[child->nentries] = node->entry[*idx];
+		if (!child->leaf)
+			child->child[child->nentries + 1] = rnode->child[0];
+		child->nentries++;
+
+		node->entry[*idx] = rnode->entry[0];
+		memmove(&rnode->entry[0], &rnode->entry[1],
+		    (rnode->nentries - 1) * sizeof(void *));
+		if (!rnode->leaf) {
+			memmove(&rnode->child[0], &rnode->child[1],
+			    rnode->nentries * sizeof(btree_node_t *));
+		}
+		rnode->nentries--;
+	} else if (*idx < node->nentries) {
+		/* Merge with the right sibling. */
+		btree_merge_children(node, *idx);
+	} else {
+		/* Merge with the left sibling. */
+		(*idx)--;
+		btree_merge_children(node, *idx);
+	}
+}
+
+/** Remove entry with key from subtree.
+ *
+ * @a node must be the root or hold at least BTREE_DEGREE entries.
+ *
+ * @param tree B-tree
+ * @param node Subtree root
+ * @param key Key to remove
+ * @return Removed entry or @c NULL if not found
+ */
+static void *btree_node_remove(btree_t *tree, btree_node_t *node, void *key)
+{
+	btree_node_t *child;
+	unsigned short idx;
+	bool match;
+	void *entry;
+	void *sub;
+
+	idx = btree_node_find(tree, node, key, &match);
+
+	if (match && node->leaf) {
+		entry = node->entry[idx];
+		memmove(&node->entry[idx], &node->entry[idx + 1],
+		    (node->nentries - idx - 1) * sizeof(void *));
+		node->nentries--;
+		return entry;
+	}
+
+	if (match) {
+		entry = node->entry[idx];
+
+		if (node->child[idx]->nentries >= BTREE_DEGREE) {
+			/* Replace with the predecessor entry. */
+			child = node->child[idx];
+			while (!child->leaf)
+				child = child->child[child->nentries];
+			sub = child->entry[child->nentries - 1];
+
+			node->entry[idx] = sub;
+			(void) btree_node_remove(tree, node->child[idx],
+			    btree_key(tree, sub));
+		} else if (node->child[idx + 1]->nentries >= BTREE_DEGREE) {
+			/* Replace with the successor entry. */
+			child = node->child[idx + 1];
+			while (!child->leaf)
+				child = child->child[0];
+			sub = child->entry[0];
+
+			node->entry[idx] = sub;
+			(void) btree_node_remove(tree, node->child[idx + 1],
+			    btree_key(tree, sub));
+		} else {
+			/* Merge both children around the entry and recurse. */
+			btree_merge_children(node, idx);
+			(void) btree_node_remove(tree, node->child[idx], key);
+		}
+
+		return entry;
+	}
+
+	if (node->leaf)
+		return NULL;
+
+	btree_fill_child(node, &idx);
+	return btree_node_remove(tree, node->child[idx], key);
+}
+
+/** Initialize B-tree.
+ *
+ * @param tree B-tree
+ * @param getkey Function to get key of entry
+ * @param cmp Function to compare keys
+ */
+void btree_initialize(btree_t *tree, btree_getkey_t getkey, btree_cmp_t cmp)
+{
+	tree->root = NULL;
+	tree->nentries = 0;
+	tree->getkey = getkey;
+	tree->cmp = cmp;
+}
+
+/** Finalize B-tree.
+ *
+ * Free all nodes. The entries themselves are not touched; they are
+ * owned by the caller.
+ *
+ * @param tree B-tree
+ */
+void btree_finalize(btree_t *tree)
+{
+	btree_node_destroy(tree->root);
+	tree->root = NULL;
+	tree->nentries = 0;
+}
+
+/** Return true if B-tree is empty.
+ *
+ * @param tree B-tree
+ * @return @c true iff the map contains no entries
+ */
+bool btree_empty(btree_t *tree)
+{
+	return tree->nentries == 0;
+}
+
+/** Return the number of entries in B-tree.
+ *
+ * @param tree B-tree
+ * @return Number of entries
+ */
+size_t btree_count(btree_t *tree)
+{
+	return tree->nentries;
+}
+
+/** Insert entry in B-tree.
+ *
+ * @param tree B-tree
+ * @param entry Entry to insert
+ * @return EOK on success, EEXIST if an entry with the same key is
+ *         already present, ENOMEM if out of memory
+ */
+errno_t btree_insert(btree_t *tree, void *entry)
+{
+	btree_node_t *node;
+	btree_node_t *nroot;
+	void *key;
+	unsigned short idx;
+	bool match;
+	errno_t rc;
+
+	key = btree_key(tree, entry);
+
+	if (tree->root == NULL) {
+		tree->root = btree_node_new(true);
+		if (tree->root == NULL)
+			return ENOMEM;
+
+		tree->root->entry[0] = entry;
+		tree->root->nentries = 1;
+		tree->nentries = 1;
+		return EOK;
+	}
+
+	if (btree_find_eq(tree, key) != NULL)
+		return EEXIST;
+
+	if (tree->root->nentries == BTREE_MAX_ENTRIES) {
+		/* Grow the tree by splitting the root. */
+		nroot = btree_node_new(false);
+		if (nroot == NULL)
+			return ENOMEM;
+
+		nroot->child[0] = tree->root;
+		rc = btree_split_child(nroot, 0);
+		if (rc != EOK) {
+			free(nroot);
+			return rc;
+		}
+
+		tree->root = nroot;
+	}
+
+	node = tree->root;
+	while (!node->leaf) {
+		idx = btree_node_find(tree, node, key, &match);
+		assert(!match);
+
+		if (node->child[idx]->nentries == BTREE_MAX_ENTRIES) {
+			rc = btree_split_child(node, idx);
+			if (rc != EOK)
+				return rc;
+
+			if (tree->cmp(key, btree_key(tree,
+			    node->entry[idx])) > 0)
+				idx++;
+		}
+
+		node = node->child[idx];
+	}
+
+	idx = btree_node_find(tree, node, key, &match);
+	assert(!match);
+
+	memmove(&node->entry[idx + 1], &node->entry[idx],
+	    (node->nentries - idx) * sizeof(void *));
+	node->entry[idx] = entry;
+	node->nentries++;
+	tree->nentries++;
+
+	return EOK;
+}
+
+/** Remove entry from B-tree.
+ *
+ * @param tree B-tree
+ * @param key Key of the entry to remove
+ * @return Removed entry or @c NULL if not found
+ */
+void *btree_remove(btree_t *tree, void *key)
+{
+	btree_node_t *oroot;
+	void *entry;
+
+	if (tree->root == NULL)
+		return NULL;
+
+	entry = btree_node_remove(tree, tree->root, key);
+	if (entry == NULL)
+		return NULL;
+
+	tree->nentries--;
+
+	if (tree->root->nentries == 0) {
+		/* Shrink the tree by one level. */
+		oroot = tree->root;
+		tree->root = oroot->leaf ? NULL : oroot->child[0];
+		free(oroot);
+	}
+
+	return entry;
+}
+
+/** Find entry with key equal to @a key.
+ *
+ * @param tree B-tree
+ * @param key Key
+ * @return Entry or @c NULL if not found
+ */
+void *btree_find_eq(btree_t *tree, void *key)
+{
+	btree_node_t *node;
+	unsigned short idx;
+	bool match;
+
+	node = tree->root;
+	while (node != NULL) {
+		idx = btree_node_find(tree, node, key, &match);
+		if (match)
+			return node->entry[idx];
+
+		node = node->leaf ? NULL : node->child[idx];
+	}
+
+	return NULL;
+}
+
+/** Find first entry with key greater than or equal to @a key.
+ *
+ * @param tree B-tree
+ * @param key Key
+ * @return Entry or @c NULL if not found
+ */
+void *btree_find_geq(btree_t *tree, void *key)
+{
+	btree_node_t *node;
+	unsigned short idx;
+	bool match;
+	void *cand;
+
+	cand = NULL;
+	node = tree->root;
+	while (node != NULL) {
+		idx = btree_node_find(tree, node, key, &match);
+		if (match)
+			return node->entry[idx];
+
+		if (idx < node->nentries)
+			cand = node->entry[idx];
+
+		node = node->leaf ? NULL : node->child[idx];
+	}
+
+	return cand;
+}
+
+/** Find first entry with key greater than @a key.
+ *
+ * @param tree B-tree
+ * @param key Key
+ * @return Entry or @c NULL if not found
+ */
+void *btree_find_gt(btree_t *tree, void *key)
+{
+	btree_node_t *node;
+	unsigned short idx;
+	bool match;
+	void *cand;
+
+	cand = NULL;
+	node = tree->root;
+	while (node != NULL) {
+		idx = btree_node_find(tree, node, key, &match);
+		if (match)
+			idx++;
+
+		if (idx < node->nentries)
+			cand = node->entry[idx];
+
+		node = node->leaf ? NULL : node->child[idx];
+	}
+
+	return cand;
+}
+
+/** Find last entry with key less than or equal to @a key.
+ *
+ * @param tree B-tree
+ * @param key Key
+ * @return Entry or @c NULL if not found
+ */
+void *btree_find_leq(btree_t *tree, void *key)
+{
+	btree_node_t *node;
+	unsigned short idx;
+	bool match;
+	void *cand;
+
+	cand = NULL;
+	node = tree->root;
+	while (node != NULL) {
+		idx = btree_node_find(tree, node, key, &match);
+		if (match)
+			return node->entry[idx];
+
+		if (idx > 0)
+			cand = node->entry[idx - 1];
+
+		node = node->leaf ? NULL : node->child[idx];
+	}
+
+	return cand;
+}
+
+/** Find last entry with key less than @a key.
+ *
+ * @param tree B-tree
+ * @param key Key
+ * @return Entry or @c NULL if not found
+ */
+void *btree_find_lt(btree_t *tree, void *key)
+{
+	btree_node_t *node;
+	unsigned short idx;
+	bool match;
+	void *cand;
+
+	cand = NULL;
+	node = tree->root;
+	while (node != NULL) {
+		idx = btree_node_find(tree, node, key, &match);
+
+		if (idx > 0)
+			cand = node->entry[idx - 1];
+
+		node = node->leaf ? NULL : node->child[idx];
+	}
+
+	return cand;
+}
+
+/** Return entry with the smallest key.
+ *
+ * @param tree B-tree
+ * @return Entry or @c NULL if the map is empty
+ */
+void *btree_first(btree_t *tree)
+{
+	btree_node_t *node;
+
+	node = tree->root;
+	if (node == NULL)
+		return NULL;
+
+	while (!node->leaf)
+		node = node->child[0];
+
+	return node->entry[0];
+}
+
+/** Return entry with the largest key.
+ *
+ * @param tree B-tree
+ * @return Entry or @c NULL if the map is empty
+ */
+void *btree_last(btree_t *tree)
+{
+	btree_node_t *node;
+
+	node = tree->root;
+	if (node == NULL)
+		return NULL;
+
+	while (!node->leaf)
+		node = node->child[node->nentries];
+
+	return node->entry[node->nentries - 1];
+}
+
+/** Validate B-tree subtree.
+ *
+ * Verify fill invariants, key ordering and uniform leaf depth.
+ *
+ * @param tree B-tree
+ * @param node Subtree root
+ * @param root True iff @a node is the tree root
+ * @param lo Lower key bound or @c NULL
+ * @param hi Upper key bound or @c NULL
+ * @param depth Place to store leaf depth of the subtree
+ * @param cnt Place to add the number of entries in the subtree
+ * @return EOK if the subtree is valid, EINVAL otherwise
+ */
+static errno_t btree_validate_node(btree_t *tree, btree_node_t *node,
+    bool root, void *lo, void *hi, size_t *depth, size_t *cnt)
+{
+	unsigned short i;
+	void *key;
+	size_t cdepth;
+	size_t fdepth;
+	errno_t rc;
+
+	if (node->nentries > BTREE_MAX_ENTRIES)
+		return EINVAL;
+	if (!root && node->nentries < BTREE_DEGREE - 1)
+		return EINVAL;
+	if (root && node->nentries < 1)
+		return EINVAL;
+
+	for (i = 0; i < node->nentries; i++) {
+		key = btree_key(tree, node->entry[i]);
+		if (lo != NULL && tree->cmp(key, lo) <= 0)
+			return EINVAL;
+		if (hi != NULL && tree->cmp(key, hi) >= 0)
+			return EINVAL;
+		if (i > 0 && tree->cmp(btree_key(tree, node->entry[i - 1]),
+		    key) >= 0)
+			return EINVAL;
+	}
+
+	*cnt += node->nentries;
+
+	if (node->leaf) {
+		*depth = 0;
+		return EOK;
+	}
+
+	fdepth = 0;
+	for (i = 0; i <= node->nentries; i++) {
+		rc = btree_validate_node(tree, node->child[i], false,
+		    (i > 0) ? btree_key(tree, node->entry[i - 1]) : lo,
+		    (i < node->nentries) ?
+		    btree_key(tree, node->entry[i]) : hi,
+		    &cdepth, cnt);
+		if (rc != EOK)
+			return rc;
+
+		if (i == 0)
+			fdepth = cdepth;
+		else if (cdepth != fdepth)
+			return EINVAL;
+	}
+
+	*depth = fdepth + 1;
+	return EOK;
+}
+
+/** Validate B-tree.
+ *
+ * Used for testing purposes.
+ *
+ * @param tree B-tree
+ * @return EOK if the tree is valid, EINVAL otherwise
+ */
+errno_t btree_validate(btree_t *tree)
+{
+	size_t depth;
+	size_t cnt;
+	errno_t rc;
+
+	if (tree->root == NULL)
+		return (tree->nentries == 0) ? EOK : EINVAL;
+
+	cnt = 0;
+	rc = btree_validate_node(tree, tree->root, true, NULL, NULL,
+	    &depth, &cnt);
+	if (rc != EOK)
+		return rc;
+
+	if (cnt != tree->nentries)
+		return EINVAL;
+
+	return EOK;
+}
+
+/** @}
+ */
@@ -1,5 +1,6 @@
 /*
  * Copyright (c) 2017 Jiri Svoboda
+ * Copyright (c) 2026 HelenOS contributors
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -31,13 +32,33 @@
  */
 
 /** @file Circular buffer
+ *
+ * Lock-free for a single producer and a single consumer. The producer
+ * publishes entries with a release store of the write index, the
+ * consumer frees slots with a release store of the read index, so no
+ * per-element locking is needed between an interrupt-notification
+ * fibril and its consumer. Both indices run in [0, 2 * nmemb); the
+ * buffer position is the index modulo nmemb.
  */
 
 #include <adt/circ_buf.h>
 #include <errno.h>
 #include <mem.h>
+#include <stdatomic.h>
 #include <stddef.h>
 
+/** Return number of used entries given a read and write index.
+ *
+ * @param cbuf Circular buffer
+ * @param rp Read index
+ * @param wp Write index
+ * @return Number of used buffer entries
+ */
+static size_t circ_buf_used(circ_buf_t *cbuf, size_t rp, size_t wp)
+{
+	return (wp + 2 * cbuf->nmemb - rp) % (2 * cbuf->nmemb);
+}
+
 /** Initialize circular buffer.
  *
  * @param cbuf Circular buffer
@@ -50,32 +71,42 @@ void circ_buf_init(circ_buf_t *cbuf, void *buf, size_t nmemb, size_t size)
 	cbuf->buf = buf;
 	cbuf->nmemb = nmemb;
 	cbuf->size = size;
-	cbuf->rp = 0;
-	cbuf->wp = 0;
-	cbuf->nused = 0;
+	atomic_store_explicit(&cbuf->rp, 0, memory_order_relaxed);
+	atomic_store_explicit(&cbuf->wp, 0, memory_order_relaxed);
 }
 
 /** Return number of free buffer entries.
+ *
+ * When called by the producer the result can only grow concurrently;
+ * for any other caller it is a snapshot.
  *
  * @param cbuf Circular buffer
  * @return Number of free buffer entries
  */
 size_t circ_buf_nfree(circ_buf_t *cbuf)
 {
-	return cbuf->nmemb - cbuf->nused;
+	return cbuf->nmemb - circ_buf_nused(cbuf);
 }
 
 /** Return number of used buffer entries.
+ *
+ * When called by the consumer the result can only grow concurrently;
+ * for any other caller it is a snapshot.
  *
  * @param cbuf Circular buffer
  * @return Number of used buffer entries
  */
 size_t circ_buf_nused(circ_buf_t *cbuf)
 {
-	return cbuf->nused;
+	size_t rp = atomic_load_explicit(&cbuf->rp, memory_order_acquire);
+	size_t wp = atomic_load_explicit(&cbuf->wp, memory_order_acquire);
+
+	return circ_buf_used(cbuf, rp, wp);
 }
 
 /** Push new entry into circular buffer.
+ *
+ * May only be called by the producer.
  *
  * @param cbuf Circular buffer
  * @param data Pointer to entry data
@@ -83,30 +114,104 @@ size_t circ_buf_nused(circ_buf_t *cbuf)
  */
 errno_t circ_buf_push(circ_buf_t *cbuf, const void *data)
 {
-	if (circ_buf_nfree(cbuf) == 0)
-		return EAGAIN;
-
-	memcpy(cbuf->buf + cbuf->size * cbuf->wp, data, cbuf->size);
-	cbuf->wp = (cbuf->wp + 1) % cbuf->nmemb;
-	cbuf->nused++;
-	return EOK;
+	return (circ_buf_push_n(cbuf, data, 1) == 1) ? EOK : EAGAIN;
 }
 
 /** Pop entry from circular buffer.
+ *
+ * May only be called by the consumer.
  *
  * @param cbuf Circular buffer
  * @param datab Pointer to data buffer for storing entry
- * @return EOK on success, EAGAIN if circular buffer is full
+ * @return EOK on success, EAGAIN if circular buffer is empty
  */
 errno_t circ_buf_pop(circ_buf_t *cbuf, void *datab)
 {
-	if (cbuf->nused == 0)
-		return EAGAIN;
+	return (circ_buf_pop_n(cbuf, datab, 1) == 1) ? EOK : EAGAIN;
+}
+
+/** Push up to @a cnt entries into circular buffer.
+ *
+ * May only be called by the producer. All pushed entries are published
+ * to the consumer with a single release store.
+ *
+ * @param cbuf Circular buffer
+ * @param data Pointer to entry data
+ * @param cnt Number of entries to push
+ * @return Number of entries actually pushed (less than @a cnt if the
+ *         buffer has filled up)
+ */
+size_t circ_buf_push_n(circ_buf_t *cbuf, const void *data, size_t cnt)
+{
+	size_t wp = atomic_load_explicit(&cbuf->wp, memory_order_relaxed);
+	size_t rp = atomic_load_explicit(&cbuf->rp, memory_order_acquire);
+	size_t nfree;
+	size_t pos;
+	size_t seg;
+
+	nfree = cbuf->nmemb - circ_buf_used(cbuf, rp, wp);
+	if (cnt > nfree)
+		cnt = nfree;
+	if (cnt == 0)
+		return 0;
+
+	/* Copy in up to two segments around the end of the buffer. */
+	pos = wp % cbuf->nmemb;
+	seg = cbuf->nmemb - pos;
+	if (seg > cnt)
+		seg = cnt;
+
+	memcpy(cbuf->buf + cbuf->size * pos, data, cbuf->size * seg);
+	if (cnt > seg) {
+		memcpy(cbuf->buf, data + cbuf->size * seg,
+		    cbuf->size * (cnt - seg));
+	}
+
+	atomic_store_explicit(&cbuf->wp, (wp + cnt) % (2 * cbuf->nmemb),
+	    memory_order_release);
+	return cnt;
+}
+
+/** Pop up to @a cnt entries from circular buffer.
+ *
+ * May only be called by the consumer. All popped slots are returned
+ * to the producer with a single release store.
+ *
+ * @param cbuf Circular buffer
+ * @param datab Pointer to data buffer for storing entries
+ * @param cnt Number of entries to pop
+ * @return Number of entries actually popped (less than @a cnt if the
+ *         buffer has run empty)
+ */
+size_t circ_buf_pop_n(circ_buf_t *cbuf, void *datab, size_t cnt)
+{
+	size_t rp = atomic_load_explicit(&cbuf->rp, memory_order_relaxed);
+	size_t wp = atomic_load_explicit(&cbuf->wp, memory_order_acquire);
+	size_t nused;
+	size_t pos;
+	size_t seg;
+
+	nused = circ_buf_used(cbuf, rp, wp);
+	if (cnt > nused)
+		cnt = nused;
+	if (cnt == 0)
+		return 0;
+
+	/* Copy in up to two segments around the end of the buffer. */
+	pos = rp % cbuf->nmemb;
+	seg = cbuf->nmemb - pos;
+	if (seg > cnt)
+		seg = cnt;
+
+	memcpy(datab, cbuf->buf + cbuf->size * pos, cbuf->size * seg);
+	if (cnt > seg) {
+		memcpy(datab + cbuf->size * seg, cbuf->buf,
+		    cbuf->size * (cnt - seg));
+	}
 
-	memcpy(datab, cbuf->buf + cbuf->size * cbuf->rp, cbuf->size);
-	cbuf->rp = (cbuf->rp + 1) % cbuf->nmemb;
-	cbuf->nused--;
-	return EOK;
+	atomic_store_explicit(&cbuf->rp, (rp + cnt) % (2 * cbuf->nmemb),
+	    memory_order_release);
+	return cnt;
 }
 
 /** @}
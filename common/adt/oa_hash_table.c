@@ -0,0 +1,591 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ */
+
+/*
+ * This is an open-addressing (robin hood) variant of the generic hash
+ * table. Where the chained table chases a per-item link node for every
+ * bucket entry, this table keeps (item pointer, cached hash) pairs in a
+ * single flat array, so a lookup touches a handful of consecutive
+ * cachelines instead of one line per collision.
+ *
+ * Robin hood insertion keeps the probe sequences short by displacing
+ * already-placed items that sit closer to their home slot than the item
+ * being inserted. Deletion shifts the following run of items backward,
+ * so the table needs no tombstones in steady state. Because the user's
+ * hash functions are not required to distribute well over a power-of-two
+ * slot count, all hashes are passed through hash_mix() before use.
+ *
+ * The operations structure is shared with the chained table; only the
+ * table type and function names differ.
+ */
+
+#include <adt/hash.h>
+#include <adt/oa_hash_table.h>
+#include <assert.h>
+#include <stdlib.h>
+
+/* Minimum (and initial default) slot count; must be a power of two. */
+#define OA_HT_MIN_SLOTS  64
+
+static void oa_ht_remove_slot(oa_hash_table_t *, size_t);
+static void oa_ht_resize(oa_hash_table_t *, size_t);
+static void oa_ht_grow_if_needed(oa_hash_table_t *);
+static void oa_ht_shrink_if_needed(oa_hash_table_t *);
+
+/*
+ * Items removed while an apply is ongoing are replaced with this sentinel
+ * (keeping the cached hash valid) instead of shifting the slot array under
+ * the traversal. The sentinels are swept once the apply finishes.
+ */
+static ht_link_t oa_ht_deleted_sentinel;
+
+#define OA_HT_DELETED  (&oa_ht_deleted_sentinel)
+
+/** Returns the home slot index of a (mixed) hash. */
+static inline size_t oa_ht_home(const oa_hash_table_t *h, size_t hash)
+{
+	return hash & (h->slot_cnt - 1);
+}
+
+/** Returns the distance of slot @a idx from the home slot of @a hash. */
+static inline size_t oa_ht_dist(const oa_hash_table_t *h, size_t hash,
+    size_t idx)
+{
+	return (idx - oa_ht_home(h, hash)) & (h->slot_cnt - 1);
+}
+
+/** Rounds up to the nearest suitable power-of-two slot count. */
+static size_t oa_ht_round_up_size(size_t size)
+{
+	size_t rounded_size = OA_HT_MIN_SLOTS;
+
+	while (rounded_size < size)
+		rounded_size *= 2;
+
+	return rounded_size;
+}
+
+/** Places an item with a precomputed mixed hash. A free slot must exist. */
+static void oa_ht_insert_slot(oa_hash_table_t *h, ht_link_t *item, size_t hash)
+{
+	size_t mask = h->slot_cnt - 1;
+	size_t idx = oa_ht_home(h, hash);
+	size_t dist = 0;
+
+	while (true) {
+		oa_ht_slot_t *slot = &h->slot[idx];
+
+		if (slot->item == NULL) {
+			slot->item = item;
+			slot->hash = hash;
+			return;
+		}
+
+		/*
+		 * Robin hood: if the resident item is closer to its home
+		 * than we are to ours, displace it and continue inserting
+		 * the displaced item instead.
+		 */
+		size_t resident_dist = oa_ht_dist(h, slot->hash, idx);
+		if (resident_dist < dist) {
+			ht_link_t *tmp_item = slot->item;
+			size_t tmp_hash = slot->hash;
+
+			slot->item = item;
+			slot->hash = hash;
+
+			item = tmp_item;
+			hash = tmp_hash;
+			dist = resident_dist;
+		}
+
+		idx = (idx + 1) & mask;
+		++dist;
+	}
+}
+
+/** Create open-addressing hash table.
+ *
+ * @param h         Hash table structure. Will be initialized by this call.
+ * @param init_size Initial desired number of slots. The table grows once
+ *                  it is three quarters full. Pass zero if you want the
+ *                  default initial size.
+ * @param op        Hash table operations structure, shared with the
+ *                  chained hash table. remove_callback() is optional and
+ *                  can be NULL if no action is to be taken upon removal.
+ *                  equal() is optional if and only if
+ *                  oa_hash_table_insert_unique() and
+ *                  oa_hash_table_find_next() will never be invoked.
+ *                  All other operations are mandatory.
+ *
+ * @return True on success
+ *
+ */
+bool oa_hash_table_create(oa_hash_table_t *h, size_t init_size,
+    const hash_table_ops_t *op)
+{
+	assert(h);
+	assert(op && op->hash && op->key_hash && op->key_equal);
+
+	/* Check for compulsory ops. */
+	if (!op || !op->hash || !op->key_hash || !op->key_equal)
+		return false;
+
+	h->slot_cnt = oa_ht_round_up_size(init_size);
+
+	h->slot = calloc(h->slot_cnt, sizeof(oa_ht_slot_t));
+	if (!h->slot)
+		return false;
+
+	h->item_cnt = 0;
+	h->deleted_cnt = 0;
+	h->op = op;
+	h->apply_ongoing = false;
+
+	return true;
+}
+
+/** Destroy an open-addressing hash table instance.
+ *
+ * @param h Hash table to be destroyed.
+ *
+ */
+void oa_hash_table_destroy(oa_hash_table_t *h)
+{
+	assert(h && h->slot);
+	assert(!h->apply_ongoing);
+
+	oa_hash_table_clear(h);
+
+	free(h->slot);
+
+	h->slot = NULL;
+	h->slot_cnt = 0;
+}
+
+/** Returns true if there are no items in the table. */
+bool oa_hash_table_empty(oa_hash_table_t *h)
+{
+	assert(h && h->slot);
+	return h->item_cnt == 0;
+}
+
+/** Returns the number of items in the table. */
+size_t oa_hash_table_size(oa_hash_table_t *h)
+{
+	assert(h && h->slot);
+	return h->item_cnt;
+}
+
+/** Remove all elements from the hash table
+ *
+ * @param h Hash table to be cleared
+ */
+void oa_hash_table_clear(oa_hash_table_t *h)
+{
+	assert(h && h->slot);
+	assert(!h->apply_ongoing);
+
+	if (h->item_cnt != 0) {
+		for (size_t idx = 0; idx < h->slot_cnt; ++idx) {
+			ht_link_t *item = h->slot[idx].item;
+			if (item == NULL)
+				continue;
+
+			h->slot[idx].item = NULL;
+
+			if (h->op->remove_callback)
+				h->op->remove_callback(item);
+		}
+
+		h->item_cnt = 0;
+	}
+
+	/* Shrink the table to its minimum size if possible. */
+	if (OA_HT_MIN_SLOTS < h->slot_cnt)
+		oa_ht_resize(h, OA_HT_MIN_SLOTS);
+}
+
+/** Insert item into a hash table.
+ *
+ * @param h    Hash table.
+ * @param item Item to be inserted into the hash table.
+ */
+void oa_hash_table_insert(oa_hash_table_t *h, ht_link_t *item)
+{
+	assert(item);
+	assert(h && h->slot);
+	assert(!h->apply_ongoing);
+
+	/* Grow first so that a free slot is guaranteed to exist. */
+	++h->item_cnt;
+	oa_ht_grow_if_needed(h);
+
+	oa_ht_insert_slot(h, item, hash_mix(h->op->hash(item)));
+}
+
+/** Insert item into a hash table if not already present.
+ *
+ * @param h    Hash table.
+ * @param item Item to be inserted into the hash table.
+ *
+ * @return False if such an item had already been inserted.
+ * @return True if the inserted item was the only item with such a lookup key.
+ */
+bool oa_hash_table_insert_unique(oa_hash_table_t *h, ht_link_t *item)
+{
+	assert(item);
+	assert(h && h->slot);
+	assert(h->op && h->op->hash && h->op->equal);
+	assert(!h->apply_ongoing);
+
+	size_t mask = h->slot_cnt - 1;
+	size_t hash = hash_mix(h->op->hash(item));
+	size_t idx = oa_ht_home(h, hash);
+	size_t dist = 0;
+
+	/*
+	 * Check for duplicates. The probe may stop as soon as it reaches
+	 * an item closer to its home slot than the sought key is to its
+	 * own; robin hood ordering guarantees no match can follow.
+	 */
+	while (true) {
+		oa_ht_slot_t *slot = &h->slot[idx];
+
+		if (slot->item == NULL || dist > oa_ht_dist(h, slot->hash, idx))
+			break;
+
+		if (slot->hash == hash && slot->item != OA_HT_DELETED &&
+		    h->op->equal(slot->item, item))
+			return false;
+
+		idx = (idx + 1) & mask;
+		++dist;
+	}
+
+	++h->item_cnt;
+	oa_ht_grow_if_needed(h);
+
+	oa_ht_insert_slot(h, item, hash);
+
+	return true;
+}
+
+/** Search hash table for an item matching keys.
+ *
+ * @param h   Hash table.
+ * @param key Array of all keys needed to compute hash index.
+ *
+ * @return Matching item on success, NULL if there is no such item.
+ *
+ */
+ht_link_t *oa_hash_table_find(const oa_hash_table_t *h, const void *key)
+{
+	assert(h && h->slot);
+
+	size_t mask = h->slot_cnt - 1;
+	size_t hash = hash_mix(h->op->key_hash(key));
+	size_t idx = oa_ht_home(h, hash);
+	size_t dist = 0;
+
+	while (true) {
+		oa_ht_slot_t *slot = &h->slot[idx];
+
+		if (slot->item == NULL || dist > oa_ht_dist(h, slot->hash, idx))
+			return NULL;
+
+		/*
+		 * The cached hash filters out mismatches without calling
+		 * op->key_equal() and without touching the item itself.
+		 */
+		if (slot->hash == hash && slot->item != OA_HT_DELETED &&
+		    h->op->key_equal(key, slot->item))
+			return slot->item;
+
+		idx = (idx + 1) & mask;
+		++dist;
+	}
+}
+
+/** Find the next item equal to item.
+ *
+ * Unlike the chained table, all items with equal keys reside in a single
+ * probe run, so the search needs no separate first-match argument.
+ *
+ * @param h    Hash table.
+ * @param item An item present in the table.
+ *
+ * @return The next item with a key equal to @a item's, NULL if none.
+ */
+ht_link_t *oa_hash_table_find_next(const oa_hash_table_t *h, ht_link_t *item)
+{
+	assert(item);
+	assert(h && h->slot);
+
+	size_t mask = h->slot_cnt - 1;
+	size_t hash = hash_mix(h->op->hash(item));
+	size_t idx = oa_ht_home(h, hash);
+	size_t dist = 0;
+	bool seen = false;
+
+	while (true) {
+		oa_ht_slot_t *slot = &h->slot[idx];
+
+		if (slot->item == NULL || dist > oa_ht_dist(h, slot->hash, idx))
+			return NULL;
+
+		if (slot->item == item) {
+			seen = true;
+		} else if (seen && slot->hash == hash &&
+		    slot->item != OA_HT_DELETED &&
+		    h->op->equal(slot->item, item)) {
+			return slot->item;
+		}
+
+		idx = (idx + 1) & mask;
+		++dist;
+	}
+}
+
+/** Empties slot @a idx by shifting the following run of items backward. */
+static void oa_ht_remove_slot(oa_hash_table_t *h, size_t idx)
+{
+	size_t mask = h->slot_cnt - 1;
+
+	while (true) {
+		size_t next = (idx + 1) & mask;
+		oa_ht_slot_t *next_slot = &h->slot[next];
+
+		/*
+		 * Items sitting in their home slot must not be shifted;
+		 * the run ends there.
+		 */
+		if (next_slot->item == NULL ||
+		    oa_ht_dist(h, next_slot->hash, next) == 0) {
+			h->slot[idx].item = NULL;
+			return;
+		}
+
+		h->slot[idx] = *next_slot;
+		idx = next;
+	}
+}
+
+/** Remove all matching items from hash table.
+ *
+ * For each removed item, h->remove_callback() is called.
+ *
+ * @param h    Hash table.
+ * @param key  Array of keys that will be compared against items of
+ *             the hash table.
+ *
+ * @return Returns the number of removed items.
+ */
+size_t oa_hash_table_remove(oa_hash_table_t *h, const void *key)
+{
+	assert(h && h->slot);
+	assert(!h->apply_ongoing);
+
+	size_t mask = h->slot_cnt - 1;
+	size_t hash = hash_mix(h->op->key_hash(key));
+	size_t idx = oa_ht_home(h, hash);
+	size_t dist = 0;
+
+	size_t removed = 0;
+
+	while (true) {
+		oa_ht_slot_t *slot = &h->slot[idx];
+
+		if (slot->item == NULL || dist > oa_ht_dist(h, slot->hash, idx))
+			break;
+
+		if (slot->hash == hash && h->op->key_equal(key, slot->item)) {
+			ht_link_t *item = slot->item;
+
+			/*
+			 * Removal pulls the successor into this slot, so
+			 * re-examine the slot without advancing the probe.
+			 */
+			oa_ht_remove_slot(h, idx);
+			++removed;
+
+			if (h->op->remove_callback)
+				h->op->remove_callback(item);
+			continue;
+		}
+
+		idx = (idx + 1) & mask;
+		++dist;
+	}
+
+	h->item_cnt -= removed;
+	oa_ht_shrink_if_needed(h);
+
+	return removed;
+}
+
+/** Removes an item already present in the table. The item must be in the table. */
+void oa_hash_table_remove_item(oa_hash_table_t *h, ht_link_t *item)
+{
+	assert(item);
+	assert(h && h->slot);
+
+	size_t mask = h->slot_cnt - 1;
+	size_t hash = hash_mix(h->op->hash(item));
+	size_t idx = oa_ht_home(h, hash);
+
+	/* The item is present, so the probe is guaranteed to find it. */
+	while (h->slot[idx].item != item)
+		idx = (idx + 1) & mask;
+
+	if (h->apply_ongoing) {
+		/*
+		 * An apply is traversing the slot array; leave a sentinel
+		 * behind instead of shifting items under the traversal.
+		 */
+		h->slot[idx].item = OA_HT_DELETED;
+		++h->deleted_cnt;
+	} else {
+		oa_ht_remove_slot(h, idx);
+	}
+
+	--h->item_cnt;
+
+	if (h->op->remove_callback)
+		h->op->remove_callback(item);
+	oa_ht_shrink_if_needed(h);
+}
+
+/** Apply function to all items in hash table.
+ *
+ * @param h   Hash table.
+ * @param f   Function to be applied. Return false if no more items
+ *            should be visited. The functor may only delete the supplied
+ *            item (via oa_hash_table_remove_item()); it must not mutate
+ *            the table in any other way.
+ * @param arg Argument to be passed to the function.
+ */
+void oa_hash_table_apply(oa_hash_table_t *h, bool (*f)(ht_link_t *, void *),
+    void *arg)
+{
+	assert(f);
+	assert(h && h->slot);
+
+	if (h->item_cnt == 0)
+		return;
+
+	h->apply_ongoing = true;
+
+	for (size_t idx = 0; idx < h->slot_cnt; ++idx) {
+		ht_link_t *item = h->slot[idx].item;
+
+		if (item == NULL || item == OA_HT_DELETED)
+			continue;
+
+		/*
+		 * f() may delete item; deletion during apply only plants
+		 * a sentinel, so the slot array does not shift under us.
+		 */
+		if (!f(item, arg))
+			break;
+	}
+
+	h->apply_ongoing = false;
+
+	/*
+	 * Sweep the sentinels left behind by deletions. Backward shifting
+	 * can move a sentinel past the array wrap-around into an already
+	 * swept slot, so repeat until none remain.
+	 */
+	while (h->deleted_cnt > 0) {
+		for (size_t idx = 0; idx < h->slot_cnt; ++idx) {
+			while (h->slot[idx].item == OA_HT_DELETED) {
+				oa_ht_remove_slot(h, idx);
+				--h->deleted_cnt;
+			}
+		}
+	}
+
+	oa_ht_shrink_if_needed(h);
+	oa_ht_grow_if_needed(h);
+}
+
+/** Shrinks the table if the table is only sparely populated. */
+static inline void oa_ht_shrink_if_needed(oa_hash_table_t *h)
+{
+	if (h->item_cnt <= h->slot_cnt / 8 && OA_HT_MIN_SLOTS < h->slot_cnt)
+		oa_ht_resize(h, h->slot_cnt / 2);
+}
+
+/** Grows the table once it is three quarters full. */
+static inline void oa_ht_grow_if_needed(oa_hash_table_t *h)
+{
+	if (h->item_cnt + h->deleted_cnt > h->slot_cnt / 4 * 3)
+		oa_ht_resize(h, 2 * h->slot_cnt);
+}
+
+/** Allocates and rehashes items to a new slot array. Frees the old one. */
+static void oa_ht_resize(oa_hash_table_t *h, size_t new_slot_cnt)
+{
+	assert(h && h->slot);
+	assert(OA_HT_MIN_SLOTS <= new_slot_cnt);
+
+	/* We are traversing the table and resizing would mess up the slots. */
+	if (h->apply_ongoing)
+		return;
+
+	/* Leave the table as is if we cannot resize. */
+	oa_ht_slot_t *new_slots = calloc(new_slot_cnt, sizeof(oa_ht_slot_t));
+	if (!new_slots)
+		return;
+
+	oa_ht_slot_t *old_slots = h->slot;
+	size_t old_slot_cnt = h->slot_cnt;
+
+	h->slot = new_slots;
+	h->slot_cnt = new_slot_cnt;
+
+	for (size_t old_idx = 0; old_idx < old_slot_cnt; ++old_idx) {
+		if (old_slots[old_idx].item != NULL) {
+			oa_ht_insert_slot(h, old_slots[old_idx].item,
+			    old_slots[old_idx].hash);
+		}
+	}
+
+	free(old_slots);
+}
+
+/** @}
+ */
@@ -1,5 +1,6 @@
 /*
  * Copyright (c) 2005 Sergey Bondari
+ * Copyright (c) 2026 HelenOS contributors
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -32,9 +33,13 @@
 
 /**
  * @file
- * @brief Gnome Sort.
+ * @brief Generic sort.
  *
- * This file contains an implementation of gnome sort
+ * This file contains an implementation of introsort: quicksort with
+ * a median-of-three pivot, falling back to heapsort when the
+ * recursion gets too deep and to insertion sort for small ranges.
+ * Elements of common widths (4, 8 and 16 bytes) are swapped with
+ * direct loads and stores instead of byte copying.
  *
  */
 
@@ -51,49 +56,277 @@
  */
 #define IBUF_SIZE  32
 
+/** Ranges of at most this many elements are insertion sorted. */
+#define SORT_SMALL  16
+
 /** Array accessor.
  *
  */
 #define INDEX(buf, i, elem_size)  ((buf) + (i) * (elem_size))
 
-/** Gnome sort
+struct sort_ctx;
+
+typedef void (*sort_swap_t)(void *, void *, struct sort_ctx *);
+
+/** Sorting state shared by the introsort phases.
+ *
+ */
+typedef struct sort_ctx {
+	/** Size of one element. */
+	size_t elem_size;
+
+	/** Comparator function. */
+	sort_cmp_t cmp;
+
+	/** 3rd argument passed to cmp. */
+	void *arg;
+
+	/** Scratch memory buffer elem_size bytes long. */
+	void *slot;
+
+	/** Swap routine for the element width. */
+	sort_swap_t swap;
+} sort_ctx_t;
+
+/** Swap aligned 4-byte elements. */
+static void sort_swap_4(void *a, void *b, sort_ctx_t *ctx)
+{
+	(void) ctx;
+
+	uint32_t tmp = *((uint32_t *) a);
+	*((uint32_t *) a) = *((uint32_t *) b);
+	*((uint32_t *) b) = tmp;
+}
+
+/** Swap aligned 8-byte elements. */
+static void sort_swap_8(void *a, void *b, sort_ctx_t *ctx)
+{
+	(void) ctx;
+
+	uint64_t tmp = *((uint64_t *) a);
+	*((uint64_t *) a) = *((uint64_t *) b);
+	*((uint64_t *) b) = tmp;
+}
+
+/** Swap 8-byte aligned 16-byte elements. */
+static void sort_swap_16(void *a, void *b, sort_ctx_t *ctx)
+{
+	(void) ctx;
+
+	uint64_t *wa = (uint64_t *) a;
+	uint64_t *wb = (uint64_t *) b;
+
+	uint64_t tmp = wa[0];
+	wa[0] = wb[0];
+	wb[0] = tmp;
+
+	tmp = wa[1];
+	wa[1] = wb[1];
+	wb[1] = tmp;
+}
+
+/** Swap elements of any width through the scratch buffer. */
+static void sort_swap_any(void *a, void *b, sort_ctx_t *ctx)
+{
+	memcpy(ctx->slot, a, ctx->elem_size);
+	memcpy(a, b, ctx->elem_size);
+	memcpy(b, ctx->slot, ctx->elem_size);
+}
+
+/** Insertion sort
  *
- * Apply generic gnome sort algorithm on supplied data,
- * using pre-allocated buffer.
+ * Used for small ranges where its low overhead beats the
+ * asymptotically better algorithms. Each element is lifted into
+ * the scratch buffer and the sorted run is shifted towards the
+ * end, so every element is written at most once per position.
  *
- * @param data      Pointer to data to be sorted.
- * @param cnt       Number of elements to be sorted.
- * @param elem_size Size of one element.
- * @param cmp       Comparator function.
- * @param arg       3rd argument passed to cmp.
- * @param slot      Pointer to scratch memory buffer
- *                  elem_size bytes long.
+ * @param ctx  Sorting state.
+ * @param data Pointer to the range to be sorted.
+ * @param cnt  Number of elements in the range.
+ *
+ */
+static void sort_insertion(sort_ctx_t *ctx, void *data, size_t cnt)
+{
+	size_t elem_size = ctx->elem_size;
+
+	for (size_t i = 1; i < cnt; i++) {
+		if (ctx->cmp(INDEX(data, i, elem_size),
+		    INDEX(data, i - 1, elem_size), ctx->arg) >= 0)
+			continue;
+
+		memcpy(ctx->slot, INDEX(data, i, elem_size), elem_size);
+
+		size_t j = i;
+		while ((j > 0) && (ctx->cmp(ctx->slot,
+		    INDEX(data, j - 1, elem_size), ctx->arg) < 0)) {
+			memcpy(INDEX(data, j, elem_size),
+			    INDEX(data, j - 1, elem_size), elem_size);
+			j--;
+		}
+
+		memcpy(INDEX(data, j, elem_size), ctx->slot, elem_size);
+	}
+}
+
+/** Sift the root of a binary max-heap down to its place.
+ *
+ * @param ctx  Sorting state.
+ * @param data Pointer to the heap storage.
+ * @param root Index of the element to sift down.
+ * @param end  Index of the last element of the heap.
+ *
+ */
+static void sort_sift_down(sort_ctx_t *ctx, void *data, size_t root,
+    size_t end)
+{
+	size_t elem_size = ctx->elem_size;
+
+	while (2 * root + 1 <= end) {
+		size_t child = 2 * root + 1;
+
+		if ((child + 1 <= end) &&
+		    (ctx->cmp(INDEX(data, child, elem_size),
+		    INDEX(data, child + 1, elem_size), ctx->arg) < 0))
+			child++;
+
+		if (ctx->cmp(INDEX(data, root, elem_size),
+		    INDEX(data, child, elem_size), ctx->arg) >= 0)
+			return;
+
+		ctx->swap(INDEX(data, root, elem_size),
+		    INDEX(data, child, elem_size), ctx);
+		root = child;
+	}
+}
+
+/** Heapsort
+ *
+ * Fallback for ranges where quicksort recursed too deep. Guarantees
+ * O(n log n) regardless of the pivot choices that got us here.
+ *
+ * @param ctx  Sorting state.
+ * @param data Pointer to the range to be sorted.
+ * @param cnt  Number of elements in the range.
  *
  */
-static void _gsort(void *data, size_t cnt, size_t elem_size, sort_cmp_t cmp,
-    void *arg, void *slot)
+static void sort_heap(sort_ctx_t *ctx, void *data, size_t cnt)
 {
-	size_t i = 0;
-
-	while (i < cnt) {
-		if ((i != 0) &&
-		    (cmp(INDEX(data, i, elem_size),
-		    INDEX(data, i - 1, elem_size), arg) < 0)) {
-			memcpy(slot, INDEX(data, i, elem_size), elem_size);
-			memcpy(INDEX(data, i, elem_size), INDEX(data, i - 1, elem_size),
-			    elem_size);
-			memcpy(INDEX(data, i - 1, elem_size), slot, elem_size);
-			i--;
-		} else
+	if (cnt < 2)
+		return;
+
+	for (size_t start = cnt / 2; start > 0; start--)
+		sort_sift_down(ctx, data, start - 1, cnt - 1);
+
+	for (size_t end = cnt - 1; end > 0; end--) {
+		ctx->swap(data, INDEX(data, end, ctx->elem_size), ctx);
+		sort_sift_down(ctx, data, 0, end - 1);
+	}
+}
+
+/** Partition a range around a median-of-three pivot.
+ *
+ * @param ctx  Sorting state.
+ * @param data Pointer to the array being sorted.
+ * @param lo   Index of the first element of the range.
+ * @param hi   Index of the last element of the range.
+ *
+ * @return Final index of the pivot element.
+ *
+ */
+static size_t sort_partition(sort_ctx_t *ctx, void *data, size_t lo,
+    size_t hi)
+{
+	size_t elem_size = ctx->elem_size;
+	size_t mid = lo + (hi - lo) / 2;
+
+	/* Order lo, mid and hi; the median ends up in the middle. */
+	if (ctx->cmp(INDEX(data, mid, elem_size), INDEX(data, lo, elem_size),
+	    ctx->arg) < 0)
+		ctx->swap(INDEX(data, mid, elem_size),
+		    INDEX(data, lo, elem_size), ctx);
+
+	if (ctx->cmp(INDEX(data, hi, elem_size), INDEX(data, lo, elem_size),
+	    ctx->arg) < 0)
+		ctx->swap(INDEX(data, hi, elem_size),
+		    INDEX(data, lo, elem_size), ctx);
+
+	if (ctx->cmp(INDEX(data, hi, elem_size), INDEX(data, mid, elem_size),
+	    ctx->arg) < 0)
+		ctx->swap(INDEX(data, hi, elem_size),
+		    INDEX(data, mid, elem_size), ctx);
+
+	/* Use the median as the pivot, parked in hi. */
+	ctx->swap(INDEX(data, mid, elem_size), INDEX(data, hi, elem_size),
+	    ctx);
+
+	void *pivot = INDEX(data, hi, elem_size);
+	size_t i = lo;
+
+	for (size_t j = lo; j < hi; j++) {
+		if (ctx->cmp(INDEX(data, j, elem_size), pivot, ctx->arg) < 0) {
+			if (i != j)
+				ctx->swap(INDEX(data, i, elem_size),
+				    INDEX(data, j, elem_size), ctx);
 			i++;
+		}
 	}
+
+	if (i != hi)
+		ctx->swap(INDEX(data, i, elem_size), pivot, ctx);
+
+	return i;
 }
 
-/** Gnome sort wrapper
+/** Introsort a range
+ *
+ * Quicksorts the range, always recursing into the smaller partition
+ * and looping on the larger one so the stack stays logarithmic.
+ * Ranges of at most SORT_SMALL elements are left for insertion sort
+ * and exhausting the depth budget switches to heapsort.
  *
- * This is only a wrapper that takes care of memory
- * allocations for storing the slot element for generic
- * gnome sort algorithm.
+ * @param ctx   Sorting state.
+ * @param data  Pointer to the array being sorted.
+ * @param lo    Index of the first element of the range.
+ * @param hi    Index of the last element of the range.
+ * @param depth Remaining quicksort recursion budget.
+ *
+ */
+static void sort_intro(sort_ctx_t *ctx, void *data, size_t lo, size_t hi,
+    unsigned int depth)
+{
+	while ((lo < hi) && (hi - lo >= SORT_SMALL)) {
+		if (depth == 0) {
+			sort_heap(ctx, INDEX(data, lo, ctx->elem_size),
+			    hi - lo + 1);
+			return;
+		}
+
+		depth--;
+
+		size_t pivot = sort_partition(ctx, data, lo, hi);
+
+		if (pivot - lo < hi - pivot) {
+			if (pivot > lo)
+				sort_intro(ctx, data, lo, pivot - 1, depth);
+			lo = pivot + 1;
+		} else {
+			if (pivot < hi)
+				sort_intro(ctx, data, pivot + 1, hi, depth);
+			if (pivot == lo)
+				return;
+			hi = pivot - 1;
+		}
+	}
+
+	if (lo < hi)
+		sort_insertion(ctx, INDEX(data, lo, ctx->elem_size),
+		    hi - lo + 1);
+}
+
+/** Generic sort
+ *
+ * Apply introsort on the supplied data. The only ordering guarantee
+ * is the one given by the comparator; the sort is not stable.
  *
  * @param data      Pointer to data to be sorted.
  * @param cnt       Number of elements to be sorted.
@@ -107,19 +340,46 @@ static void _gsort(void *data, size_t cnt, size_t elem_size, sort_cmp_t cmp,
 bool gsort(void *data, size_t cnt, size_t elem_size, sort_cmp_t cmp, void *arg)
 {
 	uint8_t ibuf_slot[IBUF_SIZE];
-	void *slot;
+	sort_ctx_t ctx;
+
+	if (cnt < 2)
+		return true;
+
+	ctx.elem_size = elem_size;
+	ctx.cmp = cmp;
+	ctx.arg = arg;
 
 	if (elem_size > IBUF_SIZE) {
-		slot = (void *) malloc(elem_size);
-		if (!slot)
+		ctx.slot = malloc(elem_size);
+		if (!ctx.slot)
 			return false;
 	} else
-		slot = (void *) ibuf_slot;
+		ctx.slot = (void *) ibuf_slot;
+
+	/*
+	 * The width-specialized swaps use direct loads and stores, so
+	 * they are only safe when the array is suitably aligned.
+	 */
+	uintptr_t addr = (uintptr_t) data;
+
+	if ((elem_size == 4) && ((addr % 4) == 0))
+		ctx.swap = sort_swap_4;
+	else if ((elem_size == 8) && ((addr % 8) == 0))
+		ctx.swap = sort_swap_8;
+	else if ((elem_size == 16) && ((addr % 8) == 0))
+		ctx.swap = sort_swap_16;
+	else
+		ctx.swap = sort_swap_any;
+
+	/* Budget of 2 log2(cnt) quicksort levels before heapsort. */
+	unsigned int depth = 0;
+	for (size_t n = cnt; n > 1; n >>= 1)
+		depth += 2;
 
-	_gsort(data, cnt, elem_size, cmp, arg, slot);
+	sort_intro(&ctx, data, 0, cnt - 1, depth);
 
 	if (elem_size > IBUF_SIZE)
-		free(slot);
+		free(ctx.slot);
 
 	return true;
 }
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ */
+
+#ifndef _LIBC_BTREE_H_
+#define _LIBC_BTREE_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Minimum degree of the B-tree.
+ *
+ * Every node except the root holds at least BTREE_DEGREE - 1 and at
+ * most 2 * BTREE_DEGREE - 1 entries. The value is chosen so that a
+ * node occupies two 64-byte cache lines on 64-bit architectures.
+ */
+#define BTREE_DEGREE  4
+
+/** Maximum number of entries in one node. */
+#define BTREE_MAX_ENTRIES  (2 * BTREE_DEGREE - 1)
+
+/** Get key of entry */
+typedef void *(*btree_getkey_t)(void *);
+
+/** Compare keys */
+typedef int (*btree_cmp_t)(void *, void *);
+
+/** B-tree node */
+typedef struct btree_node {
+	/** Number of entries stored in the node */
+	unsigned short nentries;
+
+	/** True for nodes without children */
+	bool leaf;
+
+	/** Stored entries, ordered by key */
+	void *entry[BTREE_MAX_ENTRIES];
+
+	/** Children; child[i] holds the keys below entry[i] */
+	struct btree_node *child[2 * BTREE_DEGREE];
+} btree_node_t;
+
+/** B-tree ordered map */
+typedef struct {
+	/** Root node or @c NULL when empty */
+	btree_node_t *root;
+
+	/** Number of entries in the map */
+	size_t nentries;
+
+	/** Get key of entry */
+	btree_getkey_t getkey;
+
+	/** Compare keys */
+	btree_cmp_t cmp;
+} btree_t;
+
+extern void btree_initialize(btree_t *, btree_getkey_t, btree_cmp_t);
+extern void btree_finalize(btree_t *);
+extern bool btree_empty(btree_t *);
+extern size_t btree_count(btree_t *);
+extern errno_t btree_insert(btree_t *, void *);
+extern void *btree_remove(btree_t *, void *);
+extern void *btree_find_eq(btree_t *, void *);
+extern void *btree_find_geq(btree_t *, void *);
+extern void *btree_find_gt(btree_t *, void *);
+extern void *btree_find_leq(btree_t *, void *);
+extern void *btree_find_lt(btree_t *, void *);
+extern void *btree_first(btree_t *);
+extern void *btree_last(btree_t *);
+extern errno_t btree_validate(btree_t *);
+
+#endif
+
+/** @}
+ */
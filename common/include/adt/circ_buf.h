@@ -36,9 +36,17 @@
 #define _LIBC_CIRC_BUF_H_
 
 #include <errno.h>
+#include <stdatomic.h>
 #include <stddef.h>
 
-/** Circular buffer */
+/** Circular buffer.
+ *
+ * Safe for concurrent use by a single producer and a single consumer
+ * without external locking: the producer only stores the write index,
+ * the consumer only stores the read index. Both indices run in the
+ * range [0, 2 * nmemb) so that a full buffer can be told apart from
+ * an empty one without sacrificing a slot.
+ */
 typedef struct {
 	/** Buffer */
 	void *buf;
@@ -46,12 +54,10 @@ typedef struct {
 	size_t nmemb;
 	/** Member size */
 	size_t size;
-	/** Read position */
-	size_t rp;
-	/** Write position */
-	size_t wp;
-	/** Number of used entries */
-	size_t nused;
+	/** Read index, written only by the consumer */
+	atomic_size_t rp;
+	/** Write index, written only by the producer */
+	atomic_size_t wp;
 } circ_buf_t;
 
 extern void circ_buf_init(circ_buf_t *, void *, size_t, size_t);
@@ -59,6 +65,8 @@ extern size_t circ_buf_nfree(circ_buf_t *);
 extern size_t circ_buf_nused(circ_buf_t *);
 extern errno_t circ_buf_push(circ_buf_t *, const void *);
 extern errno_t circ_buf_pop(circ_buf_t *, void *);
+extern size_t circ_buf_push_n(circ_buf_t *, const void *, size_t);
+extern size_t circ_buf_pop_n(circ_buf_t *, void *, size_t);
 
 #endif
 
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ */
+
+#ifndef _LIBC_OA_HASH_TABLE_H_
+#define _LIBC_OA_HASH_TABLE_H_
+
+#include <adt/hash_table.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <member.h>
+
+/** Slot of an open-addressing hash table.
+ *
+ * A free slot has item == NULL. The mixed hash of the item's lookup key
+ * is cached in the slot so that probing and item displacement never need
+ * to call back into the item's hash operation.
+ */
+typedef struct {
+	ht_link_t *item;
+	size_t hash;
+} oa_ht_slot_t;
+
+/** Open-addressing hash table structure.
+ *
+ * Uses the same operations structure (and the same item link type) as the
+ * chained hash_table_t, so users can switch between the two without
+ * touching their key logic. Unlike the chained table, the item's link_t
+ * is not actually linked anywhere; the table keeps pointers to the items
+ * in a flat slot array.
+ */
+typedef struct {
+	const hash_table_ops_t *op;
+	oa_ht_slot_t *slot;
+	size_t slot_cnt;
+	size_t item_cnt;
+	size_t deleted_cnt;
+	bool apply_ongoing;
+} oa_hash_table_t;
+
+#define oa_hash_table_get_inst(item, type, member) \
+	member_to_inst((item), type, member)
+
+extern bool oa_hash_table_create(oa_hash_table_t *, size_t,
+    const hash_table_ops_t *);
+extern void oa_hash_table_destroy(oa_hash_table_t *);
+
+extern bool oa_hash_table_empty(oa_hash_table_t *);
+extern size_t oa_hash_table_size(oa_hash_table_t *);
+
+extern void oa_hash_table_clear(oa_hash_table_t *);
+extern void oa_hash_table_insert(oa_hash_table_t *, ht_link_t *);
+extern bool oa_hash_table_insert_unique(oa_hash_table_t *, ht_link_t *);
+extern ht_link_t *oa_hash_table_find(const oa_hash_table_t *, const void *);
+extern ht_link_t *oa_hash_table_find_next(const oa_hash_table_t *, ht_link_t *);
+extern size_t oa_hash_table_remove(oa_hash_table_t *, const void *);
+extern void oa_hash_table_remove_item(oa_hash_table_t *, ht_link_t *);
+extern void oa_hash_table_apply(oa_hash_table_t *,
+    bool (*)(ht_link_t *, void *), void *);
+
+#endif
+
+/** @}
+ */
@@ -130,6 +130,19 @@ static const char *digits_small = "0123456789abcdef";
 static const char *digits_big = "0123456789ABCDEF";
 static const char invalch = U_SPECIAL;
 
+/** Digit pairs 00-99 for converting decimals two digits at a time. */
+static const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
 /** Print one or more characters without adding newline.
  *
  * @param buf  Buffer holding characters with size of
@@ -422,6 +435,29 @@ static int print_number(uint64_t num, int width, int precision, int base,
 	if (num == 0) {
 		*ptr-- = '0';
 		size++;
+	} else if (base == 10) {
+		/*
+		 * Decimal is by far the most common base. Produce two digits
+		 * per division using a lookup table, halving the number of
+		 * (slow) 64-bit divisions.
+		 */
+		while (num >= 100) {
+			const char *pair = &digit_pairs[(num % 100) << 1];
+			num /= 100;
+			*ptr-- = pair[1];
+			*ptr-- = pair[0];
+			size += 2;
+		}
+
+		if (num >= 10) {
+			const char *pair = &digit_pairs[num << 1];
+			*ptr-- = pair[1];
+			*ptr-- = pair[0];
+			size += 2;
+		} else {
+			*ptr-- = '0' + num;
+			size++;
+		}
 	} else {
 		do {
 			*ptr-- = digits[num % base];
@@ -46,6 +46,16 @@
 #undef memmove
 #undef memchr
 
+/** A word with the lowest bit set in each byte. */
+#define WORD_ONES  (((unsigned long) -1) / 0xff)
+
+/** A word with the highest bit set in each byte. */
+#define WORD_HIGHS  (WORD_ONES * 0x80)
+
+/** True if any byte of the word is zero. */
+#define word_has_zero(w) \
+	((((w) - WORD_ONES) & ~(w) & WORD_HIGHS) != 0)
+
 /** Fill memory block with a constant value. */
 DO_NOT_DISCARD
 ATTRIBUTE_OPTIMIZE_NO_TLDP
@@ -256,8 +266,33 @@ ATTRIBUTE_OPTIMIZE_NO_TLDP
 {
 	uint8_t *u1 = (uint8_t *) s1;
 	uint8_t *u2 = (uint8_t *) s2;
+	size_t word_size = sizeof(unsigned long);
 	size_t i;
 
+	/*
+	 * Skip equal prefix words when both areas are congruent modulo
+	 * the word size.
+	 */
+	if (((uintptr_t) u1 & (word_size - 1)) ==
+	    ((uintptr_t) u2 & (word_size - 1))) {
+		/* Compare the initial segment up to the word boundary. */
+		while (len != 0 && ((uintptr_t) u1 & (word_size - 1)) != 0) {
+			if (*u1 != *u2)
+				return (int)(*u1) - (int)(*u2);
+			++u1;
+			++u2;
+			--len;
+		}
+
+		/* Skip whole equal words. */
+		while (len >= word_size &&
+		    *(unsigned long *) u1 == *(unsigned long *) u2) {
+			u1 += word_size;
+			u2 += word_size;
+			len -= word_size;
+		}
+	}
+
 	for (i = 0; i < len; i++) {
 		if (*u1 != *u2)
 			return (int)(*u1) - (int)(*u2);
@@ -283,11 +318,34 @@ void *memchr(const void *s, int c, size_t n)
 {
 	uint8_t *u = (uint8_t *) s;
 	unsigned char uc = (unsigned char) c;
-	size_t i;
+	size_t word_size = sizeof(unsigned long);
+
+	/* Search the initial segment up to the word boundary. */
+	while (n != 0 && ((uintptr_t) u & (word_size - 1)) != 0) {
+		if (*u == uc)
+			return (void *) u;
+		++u;
+		--n;
+	}
+
+	/*
+	 * Skip whole words free of the searched byte. A word XORed with
+	 * the byte replicated to all positions contains a zero byte
+	 * exactly where the byte occurs.
+	 */
+	unsigned long pattern = WORD_ONES * uc;
+	while (n >= word_size) {
+		if (word_has_zero(*(unsigned long *) u ^ pattern))
+			break;
+		u += word_size;
+		n -= word_size;
+	}
 
-	for (i = 0; i < n; i++) {
-		if (u[i] == uc)
-			return (void *) &u[i];
+	while (n != 0) {
+		if (*u == uc)
+			return (void *) u;
+		++u;
+		--n;
 	}
 
 	return NULL;
@@ -130,6 +130,26 @@
 /** Number of data bits in a UTF-8 continuation byte */
 #define CONT_BITS  6
 
+/*
+ * Word-at-a-time scanning of ASCII-dominant strings. A word that contains
+ * no zero byte and no byte with the top bit set holds a full word of plain
+ * ASCII characters, which lets the hot paths below skip the UTF-8 decoder
+ * for the common case of path names and identifiers.
+ */
+
+/** A word with the lowest bit set in each byte */
+#define CHUNK_ONES  (((unsigned long) -1) / 0xff)
+
+/** A word with the highest bit set in each byte */
+#define CHUNK_HIGHS  (CHUNK_ONES * 0x80)
+
+/** True if any byte of the word is zero */
+#define chunk_has_zero(w) \
+	((((w) - CHUNK_ONES) & ~(w) & CHUNK_HIGHS) != 0)
+
+/** True if any byte of the word has the top (non-ASCII) bit set */
+#define chunk_has_nonascii(w)  (((w) & CHUNK_HIGHS) != 0)
+
 /** Decode a single character from a string.
  *
  * Decode a single character from a string of size @a size. Decoding starts
@@ -328,7 +348,25 @@ size_t str_size(const char *str)
 {
 	size_t size = 0;
 
-	while (*str++ != 0)
+	/* Scan bytes up to the first word boundary. */
+	while ((((uintptr_t) (str + size)) & (sizeof(unsigned long) - 1)) != 0) {
+		if (str[size] == 0)
+			return size;
+
+		size++;
+	}
+
+	/*
+	 * Scan whole aligned words. Reading the word holding the
+	 * terminator is safe since it cannot cross a page boundary.
+	 */
+	const unsigned long *w = (const unsigned long *) (str + size);
+	while (!chunk_has_zero(*w)) {
+		w++;
+		size += sizeof(unsigned long);
+	}
+
+	while (str[size] != 0)
 		size++;
 
 	return size;
@@ -584,8 +622,44 @@ int str_cmp(const char *s1, const char *s2)
 	char32_t c1 = 0;
 	char32_t c2 = 0;
 
-	size_t off1 = 0;
-	size_t off2 = 0;
+	size_t off = 0;
+
+	/*
+	 * Fast path: skip an identical, purely ASCII common prefix one
+	 * word at a time. Both strings advance in lock step over plain
+	 * ASCII characters only, so the decoder below always resumes at
+	 * a sequence boundary. Aligned word access requires the strings
+	 * to be congruent modulo the word size.
+	 */
+	if ((((uintptr_t) s1) & (sizeof(unsigned long) - 1)) ==
+	    (((uintptr_t) s2) & (sizeof(unsigned long) - 1))) {
+		while ((((uintptr_t) (s1 + off)) &
+		    (sizeof(unsigned long) - 1)) != 0) {
+			uint8_t b = (uint8_t) s1[off];
+			if ((b == 0) || (b >= 0x80) || (b != (uint8_t) s2[off]))
+				break;
+
+			off++;
+		}
+
+		if ((((uintptr_t) (s1 + off)) &
+		    (sizeof(unsigned long) - 1)) == 0) {
+			const unsigned long *w1 =
+			    (const unsigned long *) (s1 + off);
+			const unsigned long *w2 =
+			    (const unsigned long *) (s2 + off);
+
+			while ((*w1 == *w2) && (!chunk_has_zero(*w1)) &&
+			    (!chunk_has_nonascii(*w1))) {
+				w1++;
+				w2++;
+				off += sizeof(unsigned long);
+			}
+		}
+	}
+
+	size_t off1 = off;
+	size_t off2 = off;
 
 	while (true) {
 		c1 = str_decode(s1, &off1, STR_NO_LIMIT);
@@ -842,6 +916,40 @@ void str_cpy(char *dest, size_t size, const char *src)
 	size_t src_off = 0;
 	size_t dest_off = 0;
 
+	/*
+	 * Fast path: copy a leading run of ASCII characters word by word.
+	 * Source and destination advance in lock step, so the decoder
+	 * below picks up at a sequence boundary. Aligned word access
+	 * requires the buffers to be congruent modulo the word size.
+	 */
+	if ((((uintptr_t) src) & (sizeof(unsigned long) - 1)) ==
+	    (((uintptr_t) dest) & (sizeof(unsigned long) - 1))) {
+		size_t limit = size - 1;
+
+		while (((((uintptr_t) (src + src_off)) &
+		    (sizeof(unsigned long) - 1)) != 0) && (src_off < limit)) {
+			uint8_t b = (uint8_t) src[src_off];
+			if ((b == 0) || (b >= 0x80))
+				break;
+
+			dest[dest_off++] = src[src_off++];
+		}
+
+		if ((((uintptr_t) (src + src_off)) &
+		    (sizeof(unsigned long) - 1)) == 0) {
+			while (src_off + sizeof(unsigned long) <= limit) {
+				unsigned long w = *(const unsigned long *)
+				    (src + src_off);
+				if (chunk_has_zero(w) || chunk_has_nonascii(w))
+					break;
+
+				*(unsigned long *) (dest + dest_off) = w;
+				src_off += sizeof(unsigned long);
+				dest_off += sizeof(unsigned long);
+			}
+		}
+	}
+
 	char32_t ch;
 	while ((ch = str_decode(src, &src_off, STR_NO_LIMIT)) != 0) {
 		if (chr_encode(ch, dest, &dest_off, size - 1) != EOK)
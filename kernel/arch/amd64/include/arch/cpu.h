@@ -92,6 +92,9 @@ typedef struct {
 	unsigned int id; /** CPU's local, ie physical, APIC ID. */
 
 	size_t iomapver_copy;  /** Copy of TASK's I/O Permission bitmap generation count. */
+
+	/** Bitmask of performance counters currently programmed on this CPU. */
+	uint8_t pmu_programmed;
 } cpu_arch_t;
 
 struct star_msr {
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_amd64
+ * @{
+ */
+/** @file
+ * @brief Performance monitoring unit driver.
+ *
+ * Programs the architectural performance monitoring counters and
+ * virtualizes them per task: the scheduler stops the counters and
+ * folds their values into the outgoing task whenever a CPU switches
+ * tasks, so a task observes only events generated by its own threads.
+ * Threads of one task running on several CPUs in parallel count on
+ * each CPU and the per-CPU contributions sum up in the task.
+ *
+ * Only the architectural performance monitoring interface (CPUID
+ * leaf 0xa) is supported; on processors that do not report it the
+ * control syscall returns ENOTSUP.
+ */
+
+#include <abi/pmu.h>
+#include <arch.h>
+#include <arch/asm.h>
+#include <arch/cpuid.h>
+#include <cpu.h>
+#include <errno.h>
+#include <pmu/pmu.h>
+#include <proc/task.h>
+#include <stdatomic.h>
+#include <syscall/copy.h>
+#include <sysinfo/sysinfo.h>
+
+/** First general-purpose performance counter MSR. */
+#define IA32_PMC0  0x000000c1
+
+/** First performance event select MSR. */
+#define IA32_PERFEVTSEL0  0x00000186
+
+/** Count events in user mode. */
+#define EVTSEL_USR  (1 << 16)
+
+/** Count events in kernel mode. */
+#define EVTSEL_OS  (1 << 17)
+
+/** Enable the counter. */
+#define EVTSEL_EN  (1 << 22)
+
+/** CPUID leaf describing the architectural performance monitoring. */
+#define PMU_CPUID_LEAF  0x0000000a
+
+/** True when the architectural performance counters are available. */
+static bool pmu_supported = false;
+
+/** Event select encodings of the architectural events. */
+static const uint32_t pmu_evtsel[PMU_EVENT_MAX] = {
+	[PMU_EVENT_CYCLES] = 0x003c,
+	[PMU_EVENT_INSTRUCTIONS] = 0x00c0,
+	[PMU_EVENT_CACHE_REFS] = 0x4f2e,
+	[PMU_EVENT_CACHE_MISSES] = 0x412e,
+	[PMU_EVENT_BRANCHES] = 0x00c4,
+	[PMU_EVENT_BRANCH_MISSES] = 0x00c5
+};
+
+/** Program one counter on the current CPU.
+ *
+ * Must run with interrupts disabled.
+ */
+static void pmu_counter_program(unsigned int counter, pmu_event_t event)
+{
+	write_msr(IA32_PMC0 + counter, 0);
+	write_msr(IA32_PERFEVTSEL0 + counter,
+	    pmu_evtsel[event] | EVTSEL_USR | EVTSEL_OS | EVTSEL_EN);
+
+	CPU->arch.pmu_programmed |= (1 << counter);
+}
+
+/** Stop one counter on the current CPU and credit the task.
+ *
+ * Folds the events counted on this CPU since the counter was
+ * programmed into the task total and restarts the count from zero.
+ * Must run with interrupts disabled.
+ */
+static void pmu_counter_collect(task_t *task, unsigned int counter)
+{
+	if (!(CPU->arch.pmu_programmed & (1 << counter)))
+		return;
+
+	uint64_t delta = read_msr(IA32_PMC0 + counter);
+	write_msr(IA32_PMC0 + counter, 0);
+
+	atomic_fetch_add_explicit(&task->pmu.value[counter], delta,
+	    memory_order_relaxed);
+}
+
+/** Detect the performance monitoring unit. */
+void pmu_init(void)
+{
+	if (has_cpuid()) {
+		cpu_info_t info;
+
+		cpuid(INTEL_CPUID_LEVEL, &info);
+		if (info.cpuid_eax >= PMU_CPUID_LEAF) {
+			cpuid(PMU_CPUID_LEAF, &info);
+
+			unsigned int version = info.cpuid_eax & 0xff;
+			unsigned int counters = (info.cpuid_eax >> 8) & 0xff;
+
+			pmu_supported = (version > 0) &&
+			    (counters >= PMU_COUNTERS);
+		}
+	}
+
+	sysinfo_set_item_val("pmu.counters", NULL,
+	    pmu_supported ? PMU_COUNTERS : 0);
+}
+
+/** Initialize the performance counter state of a new task. */
+void pmu_task_init(task_t *task)
+{
+	for (unsigned int i = 0; i < PMU_COUNTERS; i++) {
+		task->pmu.active[i] = false;
+		task->pmu.event[i] = PMU_EVENT_CYCLES;
+		atomic_store_explicit(&task->pmu.value[i], 0,
+		    memory_order_relaxed);
+	}
+}
+
+/** Stop counting on behalf of a task leaving this CPU.
+ *
+ * Called by the scheduler with interrupts disabled when the CPU
+ * switches to a thread of a different task.
+ */
+void pmu_preempt(task_t *task)
+{
+	if ((!pmu_supported) || (CPU->arch.pmu_programmed == 0))
+		return;
+
+	for (unsigned int i = 0; i < PMU_COUNTERS; i++) {
+		if (task->pmu.active[i])
+			pmu_counter_collect(task, i);
+
+		write_msr(IA32_PERFEVTSEL0 + i, 0);
+	}
+
+	CPU->arch.pmu_programmed = 0;
+}
+
+/** Start counting on behalf of a task entering this CPU.
+ *
+ * Called by the scheduler with interrupts disabled when the CPU
+ * switches to a thread of a different task.
+ */
+void pmu_resume(task_t *task)
+{
+	if (!pmu_supported)
+		return;
+
+	for (unsigned int i = 0; i < PMU_COUNTERS; i++) {
+		if (task->pmu.active[i])
+			pmu_counter_program(i, task->pmu.event[i]);
+	}
+}
+
+/** Control the performance counters of the calling task
+ *
+ * Counter configuration changes take effect immediately on the
+ * calling CPU; threads of the task already running on other CPUs
+ * pick them up on their next task switch.
+ *
+ * @param op      Operation (pmu_ctl_t).
+ * @param counter Counter index.
+ * @param arg     Event to count for PMU_CTL_START, user space address
+ *                of a uint64_t for PMU_CTL_READ, unused otherwise.
+ *
+ * @return EOK on success.
+ * @return ENOTSUP if the hardware lacks usable counters.
+ * @return EINVAL on an invalid operation, counter or event.
+ *
+ */
+sys_errno_t sys_pmu_ctl(sysarg_t op, sysarg_t counter, uspace_addr_t arg)
+{
+	if (!pmu_supported)
+		return (sys_errno_t) ENOTSUP;
+
+	if (counter >= PMU_COUNTERS)
+		return (sys_errno_t) EINVAL;
+
+	task_t *task = TASK;
+	ipl_t ipl;
+
+	switch (op) {
+	case PMU_CTL_START:
+		if (arg >= PMU_EVENT_MAX)
+			return (sys_errno_t) EINVAL;
+
+		ipl = interrupts_disable();
+
+		task->pmu.event[counter] = (pmu_event_t) arg;
+		atomic_store_explicit(&task->pmu.value[counter], 0,
+		    memory_order_relaxed);
+		task->pmu.active[counter] = true;
+		pmu_counter_program(counter, (pmu_event_t) arg);
+
+		interrupts_restore(ipl);
+		return EOK;
+
+	case PMU_CTL_STOP:
+		ipl = interrupts_disable();
+
+		if (task->pmu.active[counter]) {
+			pmu_counter_collect(task, counter);
+			task->pmu.active[counter] = false;
+			write_msr(IA32_PERFEVTSEL0 + counter, 0);
+			CPU->arch.pmu_programmed &= ~(1 << counter);
+		}
+
+		interrupts_restore(ipl);
+		return EOK;
+
+	case PMU_CTL_READ:
+		ipl = interrupts_disable();
+
+		if (task->pmu.active[counter])
+			pmu_counter_collect(task, counter);
+
+		uint64_t value = atomic_load_explicit(
+		    &task->pmu.value[counter], memory_order_relaxed);
+
+		interrupts_restore(ipl);
+		return copy_to_uspace(arg, &value, sizeof(value));
+
+	default:
+		return (sys_errno_t) EINVAL;
+	}
+}
+
+/** @}
+ */
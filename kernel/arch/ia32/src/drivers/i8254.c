@@ -62,6 +62,12 @@
 
 static irq_t i8254_irq;
 
+/*
+ * The calibration channel of the i8254 is shared by all processors, so
+ * concurrently booting application processors must take turns using it.
+ */
+static SPINLOCK_STATIC_INITIALIZE(i8254_calibration_lock);
+
 static irq_ownership_t i8254_claim(irq_t *irq)
 {
 	return IRQ_ACCEPT;
@@ -103,6 +109,8 @@ void i8254_normal_operation(void)
 
 void i8254_calibrate_delay_loop(void)
 {
+	spinlock_lock(&i8254_calibration_lock);
+
 	/*
 	 * One-shot timer. Count-down from 0xffff at 1193180Hz
 	 * MAGIC_NUMBER is the magic value for 1ms.
@@ -156,7 +164,7 @@ void i8254_calibrate_delay_loop(void)
 
 	CPU->frequency_mhz = (clk2 - clk1) >> SHIFT;
 
-	return;
+	spinlock_unlock(&i8254_calibration_lock);
 }
 
 /** @}
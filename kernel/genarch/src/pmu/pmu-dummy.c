@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_genarch
+ * @{
+ */
+/** @file
+ * @brief Performance monitoring unit dummy.
+ *
+ * Used on architectures without a performance counter driver.
+ */
+
+#include <errno.h>
+#include <pmu/pmu.h>
+#include <proc/task.h>
+#include <sysinfo/sysinfo.h>
+
+void pmu_init(void)
+{
+	sysinfo_set_item_val("pmu.counters", NULL, 0);
+}
+
+void pmu_task_init(task_t *task)
+{
+	for (unsigned int i = 0; i < PMU_COUNTERS; i++) {
+		task->pmu.active[i] = false;
+		task->pmu.event[i] = PMU_EVENT_CYCLES;
+		atomic_store_explicit(&task->pmu.value[i], 0,
+		    memory_order_relaxed);
+	}
+}
+
+void pmu_preempt(task_t *task)
+{
+	(void) task;
+}
+
+void pmu_resume(task_t *task)
+{
+	(void) task;
+}
+
+sys_errno_t sys_pmu_ctl(sysarg_t op, sysarg_t counter, uspace_addr_t arg)
+{
+	(void) op;
+	(void) counter;
+	(void) arg;
+
+	return (sys_errno_t) ENOTSUP;
+}
+
+/** @}
+ */
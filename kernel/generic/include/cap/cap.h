@@ -42,6 +42,7 @@
 #include <adt/hash_table.h>
 #include <lib/ra.h>
 #include <synch/mutex.h>
+#include <synch/spinlock.h>
 #include <atomic.h>
 
 typedef enum {
@@ -81,6 +82,13 @@ typedef struct kobject {
 	kobject_type_t type;
 	atomic_size_t refcnt;
 
+	/**
+	 * True if the wrapper is embedded in the encapsulated object and
+	 * is freed along with it, rather than being a standalone
+	 * allocation.
+	 */
+	bool embedded;
+
 	/** Mutex protecting caps_list */
 	mutex_t caps_list_lock;
 	/** List of published capabilities associated with the kobject */
@@ -112,6 +120,9 @@ typedef struct cap {
 
 	ht_link_t caps_link;
 
+	/** Link in the task's cache of freed capabilities. */
+	struct cap *free_link;
+
 	/* The underlying kernel object. */
 	kobject_t *kobject;
 } cap_t;
@@ -123,6 +134,13 @@ typedef struct cap_info {
 
 	hash_table_t caps;
 	ra_arena_t *handles;
+
+	/** Protects free_caps and free_count. */
+	SPINLOCK_DECLARE(free_lock);
+	/** Cache of freed capabilities, chained via cap_t::free_link. */
+	struct cap *free_caps;
+	/** Number of capabilities in the cache. */
+	size_t free_count;
 } cap_info_t;
 
 extern void caps_init(void);
@@ -141,6 +159,7 @@ extern void cap_free(struct task *, cap_handle_t);
 extern kobject_t *kobject_alloc(unsigned int);
 extern void kobject_free(kobject_t *);
 extern void kobject_initialize(kobject_t *, kobject_type_t, void *);
+extern void kobject_initialize_embedded(kobject_t *, kobject_type_t, void *);
 extern kobject_t *kobject_get(struct task *, cap_handle_t, kobject_type_t);
 extern void kobject_add_ref(kobject_t *);
 extern void kobject_put(kobject_t *);
@@ -37,6 +37,7 @@
 
 #include <mm/tlb.h>
 #include <synch/spinlock.h>
+#include <synch/qspinlock.h>
 #include <proc/scheduler.h>
 #include <arch/cpu.h>
 #include <arch/context.h>
@@ -77,8 +78,24 @@ typedef struct cpu_local {
 	context_t scheduler_context;
 
 	struct thread *prev_thread;
+
+	/** Number of queued spinlock nodes currently in use. */
+	unsigned int qnode_depth;
+
+	/**
+	 * Istate of the innermost exception currently being dispatched
+	 * on this CPU, NULL outside of exception context. Maintained by
+	 * exc_dispatch(), consumed by the sampling profiler.
+	 */
+	struct istate *current_istate;
 } cpu_local_t;
 
+/** Number of levels of the per-CPU timer wheel (see time/timeout.c). */
+#define TIMEOUT_WHEEL_LEVELS  4
+
+/** Number of slots per timer wheel level. Must be a power of two. */
+#define TIMEOUT_WHEEL_SLOTS   64
+
 /** CPU structure.
  *
  * There is one structure like this for every processor.
@@ -92,9 +109,27 @@ typedef struct cpu {
 	atomic_size_t nrdy;
 	runq_t rq[RQ_COUNT];
 
+	/**
+	 * Lock-free inbox of threads woken up from a remote CPU.
+	 * Multiple producers push here, the owning CPU drains it
+	 * into its run queues in the scheduler.
+	 */
+	_Atomic(struct thread *) wakeup_inbox;
+
 	IRQ_SPINLOCK_DECLARE(timeoutlock);
+	/** Sorted list of timeouts expiring within the next few ticks. */
 	list_t timeout_active_list;
 
+	/**
+	 * Hierarchical timer wheel holding timeouts beyond the sorted list
+	 * horizon. Protected by @c timeoutlock.
+	 */
+	list_t timeout_wheel[TIMEOUT_WHEEL_LEVELS][TIMEOUT_WHEEL_SLOTS];
+	/** Clock tick up to which the timer wheel has been advanced. */
+	uint64_t timeout_wheel_tick;
+	/** Number of timeouts in the sorted list and the wheel together. */
+	size_t timeout_pending;
+
 	/**
 	 * Processor cycle accounting.
 	 */
@@ -106,6 +141,12 @@ typedef struct cpu {
 	 */
 	unsigned int id;
 
+	/**
+	 * NUMA node the processor belongs to. Detected by architecture
+	 * code during boot, zero on non-NUMA systems.
+	 */
+	unsigned int node;
+
 	bool active;
 	volatile bool tlb_active;
 
@@ -114,6 +155,12 @@ typedef struct cpu {
 
 	cpu_arch_t arch;
 
+	/**
+	 * Queue nodes for queued spinlocks. Other CPUs spin on and link
+	 * through these, so they live in the shared part of the structure.
+	 */
+	qspinlock_node_t qnodes[QSPINLOCK_NESTING];
+
 #ifdef CONFIG_FPU_LAZY
 	/* For synchronization between FPU trap and thread destructor. */
 	IRQ_SPINLOCK_DECLARE(fpu_lock);
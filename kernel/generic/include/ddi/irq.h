@@ -82,6 +82,10 @@ typedef struct {
 	irq_code_t *code;
 	/** Counter. */
 	size_t counter;
+	/** When true, undelivered notifications are merged into one. */
+	bool coalesce;
+	/** Last posted notification, possibly still undelivered. */
+	call_t *pending_call;
 } ipc_notif_cfg_t;
 
 /** Structure representing one device IRQ.
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_debug
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_SAMPLING_H_
+#define KERN_SAMPLING_H_
+
+#include <abi/sysinfo.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <trace.h>
+#include <typedefs.h>
+
+/** Number of samples in one per-CPU profiling buffer (a power of two) */
+#define PROFILE_BUF_ENTRIES  4096
+
+/** Per-CPU profiling sample ring buffer
+ *
+ * The sample layout (profile_sample_t) is shared with user space,
+ * which receives the buffers via the profile.data sysinfo item.
+ *
+ */
+typedef struct {
+	/** Total number of samples claimed so far */
+	atomic_size_t head;
+
+	/** Circular sample storage */
+	profile_sample_t samples[PROFILE_BUF_ENTRIES];
+} profile_buf_t;
+
+/** Global profiling enable flag */
+extern atomic_bool profile_enabled;
+
+extern void profile_init(void);
+extern void profile_start(void);
+extern void profile_stop(void);
+extern void profile_record(void);
+
+/** Take a profiling sample on the clock tick
+ *
+ * Called from clock(). When profiling is disabled (the default),
+ * this costs a single relaxed load per tick.
+ *
+ */
+_NO_TRACE static inline void profile_clock_tick(void)
+{
+	if (atomic_load_explicit(&profile_enabled, memory_order_relaxed))
+		profile_record();
+}
+
+#endif
+
+/** @}
+ */
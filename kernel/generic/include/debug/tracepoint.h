@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_debug
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_TRACEPOINT_H_
+#define KERN_TRACEPOINT_H_
+
+#include <abi/sysinfo.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <trace.h>
+#include <typedefs.h>
+
+/** Number of entries in one per-CPU tracepoint buffer (a power of two) */
+#define TRACEPOINT_BUF_ENTRIES  1024
+
+/** Per-CPU tracepoint ring buffer
+ *
+ * The entry layout (trace_entry_t) is shared with user space,
+ * which receives the buffers via the trace.data sysinfo item.
+ *
+ */
+typedef struct {
+	/** Total number of entries claimed so far */
+	atomic_size_t head;
+
+	/** Circular entry storage */
+	trace_entry_t entries[TRACEPOINT_BUF_ENTRIES];
+} tracepoint_buf_t;
+
+/** Global tracepoint enable flag */
+extern atomic_bool tracepoint_enabled;
+
+extern void tracepoint_init(void);
+extern void tracepoint_start(void);
+extern void tracepoint_stop(void);
+extern void tracepoint_record(uint32_t, sysarg_t, sysarg_t);
+
+/** Emit a static tracepoint event
+ *
+ * When tracing is disabled (the default), this costs a single
+ * relaxed load, so the tracepoints can stay compiled into hot
+ * paths unconditionally.
+ *
+ * @param event Event identifier.
+ * @param arg1  First event argument.
+ * @param arg2  Second event argument.
+ *
+ */
+_NO_TRACE static inline void tracepoint_emit(trace_event_t event,
+    sysarg_t arg1, sysarg_t arg2)
+{
+	if (atomic_load_explicit(&tracepoint_enabled, memory_order_relaxed))
+		tracepoint_record(event, arg1, arg2);
+}
+
+#endif
+
+/** @}
+ */
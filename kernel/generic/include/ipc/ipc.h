@@ -40,6 +40,7 @@
 #include <synch/waitq.h>
 #include <abi/ipc/ipc.h>
 #include <abi/proc/task.h>
+#include <ipc/latency.h>
 #include <typedefs.h>
 #include <mm/slab.h>
 #include <cap/cap.h>
@@ -73,6 +74,8 @@ typedef struct phone {
 	atomic_size_t active_calls;
 	/** User-defined label */
 	sysarg_t label;
+	/** Latency summary for calls sent through this phone. */
+	ipc_lat_phone_t lat;
 	kobject_t *kobject;
 } phone_t;
 
@@ -109,6 +112,9 @@ typedef struct answerbox {
 typedef struct call {
 	kobject_t *kobject;
 
+	/** Kernel object wrapper embedded to avoid a second allocation. */
+	kobject_t kobject_storage;
+
 	/**
 	 * Task link.
 	 * Valid only when the call is not forgotten.
@@ -154,6 +160,15 @@ typedef struct call {
 	/** Phone which was used to send the call. */
 	phone_t *caller_phone;
 
+	/*
+	 * Cycle stamps of the individual edges of the interaction,
+	 * recorded for IPC latency tracing. Zero when the respective
+	 * edge was not crossed with tracing enabled.
+	 */
+	uint64_t sent_stamp;
+	uint64_t dispatched_stamp;
+	uint64_t answered_stamp;
+
 	/** Private data to internal IPC. */
 	sysarg_t priv;
 
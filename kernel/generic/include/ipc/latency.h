@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_ipc
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_IPC_LATENCY_H_
+#define KERN_IPC_LATENCY_H_
+
+#include <abi/sysinfo.h>
+#include <arch/cycle.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <trace.h>
+
+struct call;
+
+/** Per-phone IPC latency summary
+ *
+ * Totals of the latencies observed for calls sent through one phone
+ * while IPC latency tracing was enabled. Updated when the caller
+ * picks up an answer, under the lock of the answerbox receiving the
+ * answer.
+ *
+ */
+typedef struct {
+	/** Number of answered calls accounted */
+	uint64_t count;
+	/** Total cycles the calls spent queued before server dispatch */
+	uint64_t queue_cycles;
+	/** Total cycles between server dispatch and answer */
+	uint64_t service_cycles;
+	/** Total cycles the answers waited for caller pickup */
+	uint64_t return_cycles;
+} ipc_lat_phone_t;
+
+/** Global IPC latency tracing enable flag */
+extern atomic_bool ipc_lat_enabled;
+
+extern void ipc_lat_init(void);
+extern void ipc_lat_start(void);
+extern void ipc_lat_stop(void);
+extern void ipc_lat_account(struct call *);
+
+/** Take a cycle stamp for one edge of an IPC interaction
+ *
+ * When tracing is disabled (the default), this costs a single
+ * relaxed load, so the stamping can stay compiled into the IPC hot
+ * paths unconditionally.
+ *
+ * @return Current value of the cycle counter when tracing is
+ *         enabled, zero (meaning "not stamped") otherwise.
+ *
+ */
+_NO_TRACE static inline uint64_t ipc_lat_stamp(void)
+{
+	if (atomic_load_explicit(&ipc_lat_enabled, memory_order_relaxed))
+		return get_cycle();
+
+	return 0;
+}
+
+/** Account an answered call as it is picked up by the caller
+ *
+ * When tracing is disabled, this costs a single relaxed load.
+ *
+ * @param call Answered call being returned to the caller.
+ *
+ */
+_NO_TRACE static inline void ipc_lat_pickup(struct call *call)
+{
+	if (atomic_load_explicit(&ipc_lat_enabled, memory_order_relaxed))
+		ipc_lat_account(call);
+}
+
+#endif
+
+/** @}
+ */
@@ -46,6 +46,7 @@ extern void main_bsp(void);
 extern void main_ap(void);
 
 extern void malloc_init(void);
+extern void malloc_prefill(void);
 
 #endif
 
@@ -41,6 +41,7 @@
 #include <arch/mm/as.h>
 #include <arch/mm/asid.h>
 #include <arch/istate.h>
+#include <atomic.h>
 #include <synch/spinlock.h>
 #include <synch/mutex.h>
 #include <adt/list.h>
@@ -126,6 +127,19 @@ typedef struct as {
 	 */
 	odict_t as_areas;
 
+	/** Number of pages mapped by the areas of this address space.
+	 *
+	 * Maintained incrementally as areas are created, resized and
+	 * destroyed, so statistics do not need to walk the areas.
+	 */
+	atomic_size_t pages_mapped;
+
+	/** Number of resident (used) pages in this address space.
+	 *
+	 * Maintained incrementally by the used space maps of the areas.
+	 */
+	atomic_size_t pages_resident;
+
 	/** Non-generic content. */
 	as_genarch_t genarch;
 
@@ -183,6 +197,8 @@ typedef struct used_space {
 	odict_t ivals;
 	/** Total number of used pages. */
 	size_t pages;
+	/** Containing address space (for resident page accounting) */
+	struct as *as;
 } used_space_t;
 
 /**
@@ -324,6 +340,7 @@ extern errno_t as_area_resize(as_t *, uintptr_t, size_t, unsigned int);
 extern errno_t as_area_share(as_t *, uintptr_t, size_t, as_t *, unsigned int,
     uintptr_t *, uintptr_t);
 extern errno_t as_area_change_flags(as_t *, unsigned int, uintptr_t);
+extern void as_area_prefault(as_t *, uintptr_t, size_t);
 extern as_area_t *as_area_first(as_t *);
 extern as_area_t *as_area_next(as_area_t *);
 
@@ -63,6 +63,11 @@ typedef uint8_t frame_flags_t;
  * Fall back to low memory if that fails.
  */
 #define FRAME_HIGHMEM     0x10
+/**
+ * Prefer a zone local to the requesting CPU's NUMA node.
+ * Fall back to remote nodes if no local zone can satisfy the request.
+ */
+#define FRAME_LOCAL       0x20
 
 // NOTE: If neither FRAME_LOWMEM nor FRAME_HIGHMEM is set, FRAME_LOWMEM is
 //       assumed as a safe default, and a runtime warning may be issued.
@@ -110,6 +115,9 @@ typedef struct {
 	/** Type of the zone */
 	zone_flags_t flags;
 
+	/** NUMA node the zone belongs to (0 on non-NUMA systems) */
+	unsigned int node;
+
 	/** Frame bitmap */
 	bitmap_t bitmap;
 
@@ -142,6 +150,7 @@ extern size_t frame_total_free_get(void);
 
 extern size_t find_zone(pfn_t, size_t, size_t);
 extern size_t zone_create(pfn_t, size_t, pfn_t, zone_flags_t);
+extern void zone_set_node(size_t, unsigned int);
 extern void *frame_get_parent(pfn_t, size_t);
 extern void frame_set_parent(pfn_t, void *, size_t);
 extern void frame_mark_unavailable(pfn_t, size_t);
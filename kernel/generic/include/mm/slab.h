@@ -43,6 +43,9 @@
 /** Initial Magazine size (TODO: dynamically growing magazines) */
 #define SLAB_MAG_SIZE  4
 
+/** Default number of magazines exchanged with the depot in one go */
+#define SLAB_DEPOT_BATCH  4
+
 /** If object size is less, store control structure inside SLAB */
 #define SLAB_INSIDE_SIZE  (PAGE_SIZE >> 3)
 
@@ -74,6 +77,9 @@ typedef struct {
 typedef struct {
 	slab_magazine_t *current;
 	slab_magazine_t *last;
+	/** Stock of full magazines exchanged with the depot in batches */
+	list_t spare;
+	size_t spare_count;
 	IRQ_SPINLOCK_DECLARE(lock);
 } slab_mag_cache_t;
 
@@ -93,6 +99,9 @@ typedef struct {
 	/** Flags changing behaviour of cache */
 	unsigned int flags;
 
+	/** How many magazines to exchange with the depot per maglock hold */
+	size_t depot_batch;
+
 	/* Computed values */
 	size_t frames;   /**< Number of frames to be allocated */
 	size_t objects;  /**< Number of objects that fit in */
@@ -124,6 +133,8 @@ extern void *slab_alloc(slab_cache_t *, unsigned int)
     __attribute__((malloc));
 extern void slab_free(slab_cache_t *, void *);
 extern size_t slab_reclaim(unsigned int);
+extern void slab_cache_set_depot_batch(slab_cache_t *, size_t);
+extern size_t slab_cache_prefill(slab_cache_t *, size_t);
 
 /* slab subsytem initialization */
 extern void slab_cache_init(void);
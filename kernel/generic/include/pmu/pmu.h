@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_PMU_H_
+#define KERN_PMU_H_
+
+#include <abi/pmu.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <typedefs.h>
+
+struct task;
+
+/** Per-task virtualized performance counter state.
+ *
+ * The configuration is written only from the syscall handler running
+ * in the owning task; the accumulated values are updated with relaxed
+ * atomics by whichever CPU preempts a thread of the task, so counts
+ * of threads running in parallel on multiple CPUs sum up naturally.
+ */
+typedef struct {
+	/** Counter is configured and counting. */
+	bool active[PMU_COUNTERS];
+
+	/** Event selected for each counter. */
+	pmu_event_t event[PMU_COUNTERS];
+
+	/** Event count accumulated over the task's CPU time. */
+	atomic_uint_fast64_t value[PMU_COUNTERS];
+} pmu_task_t;
+
+extern void pmu_init(void);
+extern void pmu_task_init(struct task *);
+extern void pmu_preempt(struct task *);
+extern void pmu_resume(struct task *);
+
+extern sys_errno_t sys_pmu_ctl(sysarg_t, sysarg_t, uspace_addr_t);
+
+#endif
+
+/** @}
+ */
@@ -53,6 +53,7 @@
 #include <ipc/kbox.h>
 #include <mm/as.h>
 #include <mm/tlb.h>
+#include <pmu/pmu.h>
 #include <proc/scheduler.h>
 #include <security/perm.h>
 #include <synch/mutex.h>
@@ -71,8 +72,8 @@ typedef struct task {
 
 	/** Task lock.
 	 *
-	 * Must be acquired before threads_lock and thread lock of any of its
-	 * threads.
+	 * Must be acquired before the thread registry locks and thread lock
+	 * of any of its threads.
 	 */
 	IRQ_SPINLOCK_DECLARE(lock);
 
@@ -128,6 +129,9 @@ typedef struct task {
 	/** Architecture specific task data. */
 	task_arch_t arch;
 
+	/** Virtualized performance counters. */
+	pmu_task_t pmu;
+
 	/** Accumulated accounting. */
 	uint64_t ucycles;
 	uint64_t kcycles;
@@ -135,10 +139,8 @@ typedef struct task {
 	debug_sections_t *debug_sections;
 } task_t;
 
-/** Synchronize access to @c tasks */
-IRQ_SPINLOCK_EXTERN(tasks_lock);
-/** Ordered dictionary of all tasks by ID (of task_t structures) */
-extern odict_t tasks;
+extern void task_registry_lock(void);
+extern void task_registry_unlock(void);
 
 extern void task_init(void);
 extern void task_done(void);
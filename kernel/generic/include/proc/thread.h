@@ -73,6 +73,9 @@ typedef struct thread {
 
 	link_t rq_link;  /**< Run queue link. */
 	link_t wq_link;  /**< Wait queue link. */
+
+	/** Link for the target CPU's lock-free wakeup inbox. */
+	struct thread *wakeup_link;
 	link_t th_link;  /**< Links to threads within containing task. */
 
 	/** Link to @c threads ordered dictionary. */
@@ -209,8 +212,8 @@ typedef struct thread {
 	uint64_t last_cycle;
 } thread_t;
 
-IRQ_SPINLOCK_EXTERN(threads_lock);
-extern odict_t threads;
+extern void thread_registry_lock(void);
+extern void thread_registry_unlock(void);
 
 extern void thread_init(void);
 extern thread_t *thread_create(void (*)(void *), void *, task_t *,
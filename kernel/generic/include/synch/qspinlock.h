@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_sync
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_QSPINLOCK_H_
+#define KERN_QSPINLOCK_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/**
+ * Number of queue nodes kept per CPU. One node is consumed per queued
+ * spinlock held, so this bounds the number of queued spinlocks that can
+ * be held simultaneously by one CPU (including nested interrupt
+ * handlers).
+ */
+#define QSPINLOCK_NESTING  8
+
+/** Per-CPU queue node of a queued spinlock (MCS). */
+typedef struct qspinlock_node {
+	_Atomic(struct qspinlock_node *) next;
+	atomic_bool locked;
+} qspinlock_node_t;
+
+/**
+ * Queued spinlock with FIFO ordering and local spinning (MCS).
+ *
+ * A drop-in alternative to spinlock_t for locks that are heavily
+ * contended on larger SMP machines. Each waiter spins on its own
+ * per-CPU queue node, so a lock handover moves a single cache line
+ * from the previous owner to exactly one waiter instead of restarting
+ * a test-and-set storm among all of them.
+ *
+ * Queued spinlocks held simultaneously by one CPU must be released in
+ * LIFO order.
+ */
+typedef struct qspinlock {
+#ifdef CONFIG_SMP
+	_Atomic(qspinlock_node_t *) tail;
+
+#ifdef CONFIG_DEBUG_SPINLOCK
+	const char *name;
+#endif /* CONFIG_DEBUG_SPINLOCK */
+#endif
+} qspinlock_t;
+
+#define QSPINLOCK_DECLARE(lock_name)  qspinlock_t lock_name
+#define QSPINLOCK_EXTERN(lock_name)   extern qspinlock_t lock_name
+
+#ifdef CONFIG_SMP
+#ifdef CONFIG_DEBUG_SPINLOCK
+#define QSPINLOCK_INITIALIZER(desc_name) { .name = (desc_name), .tail = NULL }
+#else
+#define QSPINLOCK_INITIALIZER(desc_name) { .tail = NULL }
+#endif
+#else
+#define QSPINLOCK_INITIALIZER(desc_name) {}
+#endif
+
+#define QSPINLOCK_INITIALIZE_NAME(lock_name, desc_name) \
+	qspinlock_t lock_name = QSPINLOCK_INITIALIZER(desc_name)
+
+#define QSPINLOCK_STATIC_INITIALIZE_NAME(lock_name, desc_name) \
+	static qspinlock_t lock_name = QSPINLOCK_INITIALIZER(desc_name)
+
+#define QSPINLOCK_INITIALIZE(lock_name) \
+	QSPINLOCK_INITIALIZE_NAME(lock_name, #lock_name)
+
+#define QSPINLOCK_STATIC_INITIALIZE(lock_name) \
+	QSPINLOCK_STATIC_INITIALIZE_NAME(lock_name, #lock_name)
+
+#ifdef CONFIG_SMP
+
+extern void qspinlock_initialize(qspinlock_t *, const char *);
+extern void qspinlock_lock(qspinlock_t *);
+extern void qspinlock_unlock(qspinlock_t *);
+extern bool qspinlock_trylock(qspinlock_t *);
+extern bool qspinlock_locked(qspinlock_t *);
+
+#else
+
+#include <preemption.h>
+
+static inline void qspinlock_initialize(qspinlock_t *l, const char *name)
+{
+}
+
+static inline void qspinlock_lock(qspinlock_t *l)
+{
+	preemption_disable();
+}
+
+static inline void qspinlock_unlock(qspinlock_t *l)
+{
+	preemption_enable();
+}
+
+static inline bool qspinlock_trylock(qspinlock_t *l)
+{
+	preemption_disable();
+	return true;
+}
+
+static inline bool qspinlock_locked(qspinlock_t *l)
+{
+	return true;
+}
+
+#endif
+
+#endif
+
+/** @}
+ */
@@ -37,6 +37,7 @@
 #define KERN_SYSINFO_H_
 
 #include <typedefs.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <str.h>
 #include <abi/sysinfo.h>
@@ -101,7 +102,7 @@ typedef union {
  * This structure is generated from the constant
  * items or by the generating functions. Note that
  * the validity of the data is limited by the scope
- * of single sysinfo invocation guarded by sysinfo_lock.
+ * of a single sysinfo invocation.
  *
  */
 typedef struct {
@@ -127,35 +128,47 @@ typedef struct {
  *
  */
 typedef union {
-	struct sysinfo_item *table;            /**< Fixed subtree (list of subitems) */
+	_Atomic(struct sysinfo_item *) table;  /**< Fixed subtree (list of subitems) */
 	sysinfo_gen_subtree_data_t generator;  /**< Generated subtree */
 } sysinfo_subtree_t;
 
 /** Sysinfo item
+ *
+ * Readers traverse the tree without holding any lock. The atomic
+ * members act as publication points: writers initialize an item
+ * (or a whole detached branch of items) completely and only then
+ * make it reachable using a release store, while readers use the
+ * matching acquire loads. Items are never removed from the tree.
  *
  */
 typedef struct sysinfo_item {
 	char *name;                           /**< Item name */
 
-	sysinfo_item_val_type_t val_type;     /**< Item value type */
+	/** Item value type */
+	_Atomic sysinfo_item_val_type_t val_type;
+
 	sysinfo_item_val_t val;               /**< Item value */
 
-	sysinfo_subtree_type_t subtree_type;  /**< Subtree type */
+	/** Subtree type */
+	_Atomic sysinfo_subtree_type_t subtree_type;
+
 	sysinfo_subtree_t subtree;            /**< Subtree */
 
-	struct sysinfo_item *next;            /**< Sibling item */
+	_Atomic(struct sysinfo_item *) next;  /**< Sibling item */
 } sysinfo_item_t;
 
-extern void sysinfo_set_item_val(const char *, sysinfo_item_t **, sysarg_t);
-extern void sysinfo_set_item_data(const char *, sysinfo_item_t **, void *,
-    size_t);
-extern void sysinfo_set_item_gen_val(const char *, sysinfo_item_t **,
+extern void sysinfo_set_item_val(const char *, _Atomic(sysinfo_item_t *) *,
+    sysarg_t);
+extern void sysinfo_set_item_data(const char *, _Atomic(sysinfo_item_t *) *,
+    void *, size_t);
+extern void sysinfo_set_item_gen_val(const char *, _Atomic(sysinfo_item_t *) *,
     sysinfo_fn_val_t, void *);
-extern void sysinfo_set_item_gen_data(const char *, sysinfo_item_t **,
+extern void sysinfo_set_item_gen_data(const char *, _Atomic(sysinfo_item_t *) *,
     sysinfo_fn_data_t, void *);
-extern void sysinfo_set_item_undefined(const char *, sysinfo_item_t **);
+extern void sysinfo_set_item_undefined(const char *,
+    _Atomic(sysinfo_item_t *) *);
 
-extern void sysinfo_set_subtree_fn(const char *, sysinfo_item_t **,
+extern void sysinfo_set_subtree_fn(const char *, _Atomic(sysinfo_item_t *) *,
     sysinfo_fn_subtree_t, void *);
 
 extern void sysinfo_init(void);
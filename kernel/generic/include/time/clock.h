@@ -35,6 +35,7 @@
 #ifndef KERN_CLOCK_H_
 #define KERN_CLOCK_H_
 
+#include <stdint.h>
 #include <typedefs.h>
 
 #define HZ  100
@@ -50,6 +51,7 @@ extern uptime_t *uptime;
 
 extern void clock(void);
 extern void clock_counter_init(void);
+extern uint64_t clock_idle_ticks(void);
 
 #endif
 
@@ -61,7 +61,15 @@ typedef struct {
 
 #define us2ticks(us)  ((uint64_t) (((uint32_t) (us) / (1000000 / HZ))))
 
+/**
+ * Timeouts may fire up to 1/16 of their remaining delay late if that
+ * allows them to share a single clock interrupt with another timeout.
+ */
+#define TIMEOUT_SLACK_SHIFT  4
+
 extern deadline_t timeout_deadline_in_usec(uint32_t us);
+extern deadline_t timeout_next_deadline(void);
+extern void timeout_wheel_advance(uint64_t);
 
 extern void timeout_init(void);
 extern void timeout_initialize(timeout_t *);
@@ -63,6 +63,15 @@ typedef struct {
 	int not_stoppable_count;
 	struct task *debugger;
 	udebug_evmask_t evmask;
+
+	/** Syscall event ring or NULL if the ring is disabled */
+	udebug_ev_t *ev_ring;
+	/** Index where the next event will be recorded */
+	size_t ev_ring_head;
+	/** Number of events currently in the ring */
+	size_t ev_ring_count;
+	/** Events dropped due to ring overflow since the last read */
+	size_t ev_ring_lost;
 } udebug_task_t;
 
 /** Debugging part of thread_t structure.
@@ -55,6 +55,12 @@ errno_t udebug_args_read(thread_t *t, void **buffer);
 errno_t udebug_regs_read(thread_t *t, void **buffer);
 
 errno_t udebug_mem_read(uspace_addr_t uspace_addr, size_t n, void **buffer);
+errno_t udebug_mem_read_v(const udebug_mem_range_t *ranges, size_t nranges,
+    void **buffer, size_t *size);
+
+errno_t udebug_ev_ring_set(bool enable);
+errno_t udebug_ev_read(void **buffer, size_t buf_size, size_t *stored,
+    size_t *needed, size_t *lost);
 
 #endif
 
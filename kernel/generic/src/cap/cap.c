@@ -95,6 +95,12 @@
 #define CAPS_SIZE	(INT_MAX - (int) CAPS_START)
 #define CAPS_LAST	(CAPS_SIZE - 1)
 
+/** Maximum number of freed capabilities cached per task. */
+#define CAP_FREE_CACHE_MAX	64
+
+/** Number of capability slots prepared when the cache runs empty. */
+#define CAP_REFILL_BATCH	4
+
 static slab_cache_t *cap_cache;
 static slab_cache_t *kobject_cache;
 
@@ -173,6 +179,10 @@ void caps_task_init(task_t *task)
 
 	for (kobject_type_t t = 0; t < KOBJECT_TYPE_MAX; t++)
 		list_initialize(&task->cap_info->type_list[t]);
+
+	spinlock_initialize(&task->cap_info->free_lock, "cap_info.free_lock");
+	task->cap_info->free_caps = NULL;
+	task->cap_info->free_count = 0;
 }
 
 /** Deallocate the capability info structure
@@ -181,6 +191,15 @@ void caps_task_init(task_t *task)
  */
 void caps_task_free(task_t *task)
 {
+	/* Return the cached capability slots before tearing down the table. */
+	while (task->cap_info->free_caps != NULL) {
+		cap_t *cap = task->cap_info->free_caps;
+		task->cap_info->free_caps = cap->free_link;
+
+		hash_table_remove_item(&task->cap_info->caps, &cap->caps_link);
+		slab_free(cap_cache, cap);
+	}
+
 	hash_table_destroy(&task->cap_info->caps);
 	ra_arena_destroy(task->cap_info->handles);
 	free(task->cap_info);
@@ -225,10 +244,59 @@ static void cap_initialize(cap_t *cap, task_t *task, cap_handle_t handle)
 	cap->state = CAP_STATE_FREE;
 	cap->task = task;
 	cap->handle = handle;
+	cap->free_link = NULL;
 	link_initialize(&cap->kobj_link);
 	link_initialize(&cap->type_link);
 }
 
+/** Take a capability from the task's cache of freed slots.
+ *
+ * Unlike the full allocation path, this does not take the cap_info
+ * mutex, only a short-held spinlock.
+ *
+ * @return Cached capability in the CAP_STATE_FREE state.
+ * @return NULL if the cache is empty.
+ */
+static cap_t *cap_free_cache_get(task_t *task)
+{
+	spinlock_lock(&task->cap_info->free_lock);
+
+	cap_t *cap = task->cap_info->free_caps;
+	if (cap) {
+		task->cap_info->free_caps = cap->free_link;
+		task->cap_info->free_count--;
+		cap->free_link = NULL;
+	}
+
+	spinlock_unlock(&task->cap_info->free_lock);
+
+	return cap;
+}
+
+/** Insert a capability into the task's cache of freed slots.
+ *
+ * @return True if the capability was cached.
+ * @return False if the cache is full and the slot should be deallocated
+ *         for real.
+ */
+static bool cap_free_cache_put(task_t *task, cap_t *cap)
+{
+	bool cached = false;
+
+	spinlock_lock(&task->cap_info->free_lock);
+
+	if (task->cap_info->free_count < CAP_FREE_CACHE_MAX) {
+		cap->free_link = task->cap_info->free_caps;
+		task->cap_info->free_caps = cap;
+		task->cap_info->free_count++;
+		cached = true;
+	}
+
+	spinlock_unlock(&task->cap_info->free_lock);
+
+	return cached;
+}
+
 /** Get capability using capability handle
  *
  * @param task    Task whose capability to get.
@@ -264,8 +332,21 @@ static cap_t *cap_get(task_t *task, cap_handle_t handle, cap_state_t state)
  */
 errno_t cap_alloc(task_t *task, cap_handle_t *handle)
 {
+	/*
+	 * Fast path: reuse a recently freed slot. The capability stayed in
+	 * the hash table with its handle reserved, so no cap_info mutex is
+	 * needed. Until the state is flipped below, lookups of the handle
+	 * keep failing the same way they did while the slot was free.
+	 */
+	cap_t *cap = cap_free_cache_get(task);
+	if (cap) {
+		cap->state = CAP_STATE_ALLOCATED;
+		*handle = cap->handle;
+		return EOK;
+	}
+
 	mutex_lock(&task->cap_info->lock);
-	cap_t *cap = slab_alloc(cap_cache, FRAME_ATOMIC);
+	cap = slab_alloc(cap_cache, FRAME_ATOMIC);
 	if (!cap) {
 		mutex_unlock(&task->cap_info->lock);
 		return ENOMEM;
@@ -281,6 +362,33 @@ errno_t cap_alloc(task_t *task, cap_handle_t *handle)
 
 	cap->state = CAP_STATE_ALLOCATED;
 	*handle = cap->handle;
+
+	/*
+	 * Batched refill: prepare spare slots while the mutex is held so
+	 * that subsequent allocations take the fast path. Failures here are
+	 * not errors, the requested capability is already allocated.
+	 */
+	for (unsigned int i = 1; i < CAP_REFILL_BATCH; i++) {
+		cap_t *spare = slab_alloc(cap_cache, FRAME_ATOMIC);
+		if (!spare)
+			break;
+		if (!ra_alloc(task->cap_info->handles, 1, 1, &hbase)) {
+			slab_free(cap_cache, spare);
+			break;
+		}
+		cap_initialize(spare, task, (cap_handle_t) hbase);
+		hash_table_insert(&task->cap_info->caps, &spare->caps_link);
+
+		if (!cap_free_cache_put(task, spare)) {
+			/* Concurrent frees filled the cache in the meantime. */
+			hash_table_remove_item(&task->cap_info->caps,
+			    &spare->caps_link);
+			ra_free(task->cap_info->handles, hbase, 1);
+			slab_free(cap_cache, spare);
+			break;
+		}
+	}
+
 	mutex_unlock(&task->cap_info->lock);
 
 	return EOK;
@@ -401,9 +509,17 @@ void cap_free(task_t *task, cap_handle_t handle)
 
 	assert(cap);
 
-	hash_table_remove_item(&task->cap_info->caps, &cap->caps_link);
-	ra_free(task->cap_info->handles, cap_handle_raw(handle), 1);
-	slab_free(cap_cache, cap);
+	/*
+	 * Keep the slot in the hash table with its handle reserved and cache
+	 * it for reuse by cap_alloc(). Only when the cache is full is the
+	 * slot deallocated for real.
+	 */
+	cap->state = CAP_STATE_FREE;
+	if (!cap_free_cache_put(task, cap)) {
+		hash_table_remove_item(&task->cap_info->caps, &cap->caps_link);
+		ra_free(task->cap_info->handles, cap_handle_raw(handle), 1);
+		slab_free(cap_cache, cap);
+	}
 	mutex_unlock(&task->cap_info->lock);
 }
 
@@ -430,10 +546,28 @@ void kobject_initialize(kobject_t *kobj, kobject_type_t type, void *raw)
 	mutex_initialize(&kobj->caps_list_lock, MUTEX_PASSIVE);
 	list_initialize(&kobj->caps_list);
 
+	kobj->embedded = false;
 	kobj->type = type;
 	kobj->raw = raw;
 }
 
+/** Initialize kernel object embedded in the encapsulated object
+ *
+ * Unlike a wrapper set up by kobject_initialize(), an embedded wrapper
+ * shares its allocation with the encapsulated object and is freed by
+ * the type's destroy operation along with it.
+ *
+ * @param kobj  Kernel object to initialize.
+ * @param type  Type of the kernel object.
+ * @param raw   Raw pointer to the encapsulated object.
+ */
+void kobject_initialize_embedded(kobject_t *kobj, kobject_type_t type,
+    void *raw)
+{
+	kobject_initialize(kobj, type, raw);
+	kobj->embedded = true;
+}
+
 /** Get new reference to kernel object from capability
  *
  * @param task    Task from which to get the reference.
@@ -481,8 +615,17 @@ void kobject_add_ref(kobject_t *kobj)
 void kobject_put(kobject_t *kobj)
 {
 	if (atomic_postdec(&kobj->refcnt) == 1) {
+		/*
+		 * An embedded wrapper is freed by the destroy operation
+		 * together with the encapsulated object, so the flag must
+		 * be read beforehand.
+		 */
+		bool embedded = kobj->embedded;
+
 		KOBJECT_OP(kobj)->destroy(kobj->raw);
-		kobject_free(kobj);
+
+		if (!embedded)
+			kobject_free(kobj);
 	}
 }
 
@@ -67,7 +67,10 @@
 #include <ipc/ipc.h>
 #include <ipc/irq.h>
 #include <ipc/event.h>
+#include <ipc/latency.h>
 #include <sysinfo/sysinfo.h>
+#include <debug/sampling.h>
+#include <debug/tracepoint.h>
 #include <symtab.h>
 #include <errno.h>
 #include <stdlib.h>
@@ -521,6 +524,48 @@ static cmd_info_t sysinfo_info = {
 	.argc = 0
 };
 
+static int cmd_ipclat(cmd_arg_t *argv);
+static cmd_arg_t ipclat_argv = {
+	.type = ARG_TYPE_STRING_OPTIONAL,
+	.buffer = flag_buf,
+	.len = sizeof(flag_buf)
+};
+static cmd_info_t ipclat_info = {
+	.name = "ipclat",
+	.description = "Control IPC latency tracing (start|stop).",
+	.func = cmd_ipclat,
+	.argc = 1,
+	.argv = &ipclat_argv
+};
+
+static int cmd_profile(cmd_arg_t *argv);
+static cmd_arg_t profile_argv = {
+	.type = ARG_TYPE_STRING_OPTIONAL,
+	.buffer = flag_buf,
+	.len = sizeof(flag_buf)
+};
+static cmd_info_t profile_info = {
+	.name = "profile",
+	.description = "Control the sampling profiler (start|stop).",
+	.func = cmd_profile,
+	.argc = 1,
+	.argv = &profile_argv
+};
+
+static int cmd_trace(cmd_arg_t *argv);
+static cmd_arg_t trace_argv = {
+	.type = ARG_TYPE_STRING_OPTIONAL,
+	.buffer = flag_buf,
+	.len = sizeof(flag_buf)
+};
+static cmd_info_t trace_info = {
+	.name = "trace",
+	.description = "Control kernel tracepoints (start|stop).",
+	.func = cmd_trace,
+	.argc = 1,
+	.argv = &trace_argv
+};
+
 /* Data and methods for 'zones' command */
 static int cmd_zones(cmd_arg_t *argv);
 static cmd_info_t zones_info = {
@@ -605,8 +650,10 @@ static cmd_info_t *basic_commands[] = {
 	&halt_info,
 	&help_info,
 	&ipc_info,
+	&ipclat_info,
 	&kill_info,
 	&physmem_info,
+	&profile_info,
 	&reboot_info,
 	&sched_info,
 	&set4_info,
@@ -615,6 +662,7 @@ static cmd_info_t *basic_commands[] = {
 	&tasks_info,
 	&threads_info,
 	&tlb_info,
+	&trace_info,
 	&uptime_info,
 	&version_info,
 	&zones_info,
@@ -1225,6 +1273,72 @@ int cmd_sysinfo(cmd_arg_t *argv)
 	return 1;
 }
 
+/** Command for controlling IPC latency tracing
+ *
+ * @param argv Optional argument (start|stop).
+ *
+ * @return Always 1
+ */
+int cmd_ipclat(cmd_arg_t *argv)
+{
+	if (str_cmp(flag_buf, "start") == 0)
+		ipc_lat_start();
+	else if (str_cmp(flag_buf, "stop") == 0)
+		ipc_lat_stop();
+	else if (str_cmp(flag_buf, "") == 0)
+		printf("IPC latency tracing is %s.\n",
+		    atomic_load_explicit(&ipc_lat_enabled,
+		    memory_order_relaxed) ? "enabled" : "disabled");
+	else
+		printf("Unknown argument \"%s\".\n", flag_buf);
+
+	return 1;
+}
+
+/** Command for controlling the sampling profiler
+ *
+ * @param argv Optional argument (start|stop).
+ *
+ * @return Always 1
+ */
+int cmd_profile(cmd_arg_t *argv)
+{
+	if (str_cmp(flag_buf, "start") == 0)
+		profile_start();
+	else if (str_cmp(flag_buf, "stop") == 0)
+		profile_stop();
+	else if (str_cmp(flag_buf, "") == 0)
+		printf("Profiling is %s.\n",
+		    atomic_load_explicit(&profile_enabled,
+		    memory_order_relaxed) ? "enabled" : "disabled");
+	else
+		printf("Unknown argument \"%s\".\n", flag_buf);
+
+	return 1;
+}
+
+/** Command for controlling kernel tracepoints
+ *
+ * @param argv Optional argument (start|stop).
+ *
+ * @return Always 1
+ */
+int cmd_trace(cmd_arg_t *argv)
+{
+	if (str_cmp(flag_buf, "start") == 0)
+		tracepoint_start();
+	else if (str_cmp(flag_buf, "stop") == 0)
+		tracepoint_stop();
+	else if (str_cmp(flag_buf, "") == 0)
+		printf("Tracing is %s.\n",
+		    atomic_load_explicit(&tracepoint_enabled,
+		    memory_order_relaxed) ? "enabled" : "disabled");
+	else
+		printf("Unknown argument \"%s\".\n", flag_buf);
+
+	return 1;
+}
+
 /** Command for listing thread information
  *
  * @param argv Ignored
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_debug
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Timer-driven sampling profiler.
+ *
+ * While profiling is enabled, every clock tick records the program
+ * counter interrupted by the timer interrupt, together with the ids
+ * of the current task and thread, into a per-CPU ring buffer. The
+ * program counter is taken from the istate that the exception
+ * dispatcher stashed in CPU_LOCAL, so both kernel and user space
+ * code is attributed correctly.
+ *
+ * The buffers are exported to user space as the profile.data sysinfo
+ * item (the concatenation of all per-CPU buffers, each prefixed by
+ * its head counter) and turned into a flat profile by the kprofile
+ * tool, which symbolizes the sampled addresses against ELF images.
+ * Profiling is started and stopped from the kernel console.
+ */
+
+#include <arch.h>
+#include <config.h>
+#include <cpu.h>
+#include <debug/sampling.h>
+#include <interrupt.h>
+#include <mem.h>
+#include <proc/task.h>
+#include <proc/thread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sysinfo/sysinfo.h>
+#include <time/clock.h>
+
+/** Global profiling enable flag */
+atomic_bool profile_enabled = ATOMIC_VAR_INIT(false);
+
+/** Per-CPU sample buffers (config.cpu_count of them) */
+static profile_buf_t *profile_bufs = NULL;
+
+/** Record one profiling sample
+ *
+ * Called by profile_clock_tick() from the clock interrupt when
+ * profiling is enabled (interrupts are disabled). Records the
+ * program counter that the timer interrupt preempted. If the
+ * interrupted istate is not known (the tick did not arrive through
+ * exc_dispatch()), the tick is skipped rather than attributed to a
+ * bogus address.
+ *
+ */
+void profile_record(void)
+{
+	if (profile_bufs == NULL)
+		return;
+
+	istate_t *istate = CPU_LOCAL->current_istate;
+	if (istate == NULL)
+		return;
+
+	unsigned int cpu = CPU->id;
+	profile_buf_t *buf = &profile_bufs[cpu];
+
+	size_t seq = atomic_fetch_add_explicit(&buf->head, 1,
+	    memory_order_relaxed);
+	profile_sample_t *sample = &buf->samples[seq % PROFILE_BUF_ENTRIES];
+
+	sample->pc = istate_get_pc(istate);
+	sample->task_id = (TASK != NULL) ? TASK->taskid : 0;
+	sample->thread_id = (THREAD != NULL) ? THREAD->tid : 0;
+	sample->cpu = cpu;
+	sample->flags = istate_from_uspace(istate) ? 0 : PROFILE_SAMPLE_KERNEL;
+}
+
+/** Start profiling */
+void profile_start(void)
+{
+	atomic_store_explicit(&profile_enabled, true, memory_order_relaxed);
+}
+
+/** Stop profiling */
+void profile_stop(void)
+{
+	atomic_store_explicit(&profile_enabled, false, memory_order_relaxed);
+}
+
+/** Get profiling buffer snapshot
+ *
+ * Generate a snapshot of all per-CPU sample buffers for the
+ * profile.data sysinfo item. Each buffer is prefixed by the value
+ * of its head counter so that the reader can locate the oldest
+ * sample and tell how many samples were taken (and possibly
+ * overwritten) in total.
+ *
+ * @param item    Sysinfo item (unused).
+ * @param size    Size of the returned data.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Data containing the snapshot.
+ * @return NULL if the dry run is requested or on failure.
+ *
+ */
+static void *profile_get_data(struct sysinfo_item *item, size_t *size,
+    bool dry_run, void *data)
+{
+	size_t buf_size = sizeof(size_t) + sizeof(profile_bufs->samples);
+	*size = buf_size * config.cpu_count;
+
+	if ((dry_run) || (profile_bufs == NULL))
+		return NULL;
+
+	uint8_t *snapshot = (uint8_t *) malloc(*size);
+	if (snapshot == NULL) {
+		/* No free space for allocation */
+		*size = 0;
+		return NULL;
+	}
+
+	uint8_t *pos = snapshot;
+	for (unsigned int cpu = 0; cpu < config.cpu_count; cpu++) {
+		profile_buf_t *buf = &profile_bufs[cpu];
+
+		size_t head = atomic_load_explicit(&buf->head,
+		    memory_order_relaxed);
+		memcpy(pos, &head, sizeof(head));
+		pos += sizeof(head);
+
+		memcpy(pos, buf->samples, sizeof(buf->samples));
+		pos += sizeof(buf->samples);
+	}
+
+	return ((void *) snapshot);
+}
+
+/** Get profiling status
+ *
+ * @param item Sysinfo item (unused).
+ * @param data Unused.
+ *
+ * @return Nonzero if profiling is currently enabled.
+ *
+ */
+static sysarg_t profile_get_enabled(struct sysinfo_item *item, void *data)
+{
+	return (sysarg_t) atomic_load_explicit(&profile_enabled,
+	    memory_order_relaxed);
+}
+
+/** Initialize the sampling profiler
+ *
+ * Allocate the per-CPU sample buffers and register the sysinfo
+ * items. Until this is called (and profiling is started), the
+ * clock tick hook is inert.
+ *
+ */
+void profile_init(void)
+{
+	profile_bufs = (profile_buf_t *) calloc(config.cpu_count,
+	    sizeof(profile_buf_t));
+	if (profile_bufs == NULL) {
+		printf("Could not allocate profiling buffers.\n");
+		return;
+	}
+
+	sysinfo_set_item_gen_val("profile.enabled", NULL, profile_get_enabled,
+	    NULL);
+	sysinfo_set_item_gen_data("profile.data", NULL, profile_get_data,
+	    NULL);
+	sysinfo_set_item_val("profile.entries", NULL, PROFILE_BUF_ENTRIES);
+	sysinfo_set_item_val("profile.rate", NULL, HZ);
+}
+
+/** @}
+ */
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_debug
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Static tracepoint facility.
+ *
+ * Low-overhead event tracing for diagnosing timing problems that
+ * printf-style debugging would perturb. Selected hot paths contain
+ * static tracepoints which, when tracing is enabled, append a small
+ * fixed-size record to a per-CPU ring buffer. Recording an event
+ * costs a handful of plain stores and one atomic increment of the
+ * local buffer head; when tracing is disabled, only a relaxed load
+ * of the enable flag remains.
+ *
+ * The buffers are exported to user space as the trace.data sysinfo
+ * item (the concatenation of all per-CPU buffers, each prefixed by
+ * its head counter). The snapshot is taken without stopping the
+ * writers, so the reader has to treat entries close to the head as
+ * potentially torn; everything older is stable. Tracing is started
+ * and stopped from the kernel console.
+ */
+
+#include <arch/cycle.h>
+#include <config.h>
+#include <cpu.h>
+#include <debug/tracepoint.h>
+#include <mem.h>
+#include <preemption.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sysinfo/sysinfo.h>
+
+/** Global tracepoint enable flag */
+atomic_bool tracepoint_enabled = ATOMIC_VAR_INIT(false);
+
+/** Per-CPU tracepoint buffers (config.cpu_count of them) */
+static tracepoint_buf_t *tracepoint_bufs = NULL;
+
+/** Record a tracepoint event
+ *
+ * Called by tracepoint_emit() when tracing is enabled. Safe to call
+ * from any context, including interrupt handlers. The entry slot is
+ * claimed with an atomic increment so that an interrupt handler
+ * emitting an event on top of interrupted thread-level code (or a
+ * rare migration between the buffer lookup and the stores) cannot
+ * corrupt another entry.
+ *
+ * @param event Event identifier.
+ * @param arg1  First event argument.
+ * @param arg2  Second event argument.
+ *
+ */
+void tracepoint_record(uint32_t event, sysarg_t arg1, sysarg_t arg2)
+{
+	if (tracepoint_bufs == NULL)
+		return;
+
+	preemption_disable();
+
+	unsigned int cpu = CPU->id;
+	tracepoint_buf_t *buf = &tracepoint_bufs[cpu];
+
+	size_t seq = atomic_fetch_add_explicit(&buf->head, 1,
+	    memory_order_relaxed);
+	tracepoint_entry_t *entry =
+	    &buf->entries[seq % TRACEPOINT_BUF_ENTRIES];
+
+	entry->stamp = get_cycle();
+	entry->event = event;
+	entry->cpu = cpu;
+	entry->arg1 = arg1;
+	entry->arg2 = arg2;
+
+	preemption_enable();
+}
+
+/** Start tracing */
+void tracepoint_start(void)
+{
+	atomic_store_explicit(&tracepoint_enabled, true,
+	    memory_order_relaxed);
+}
+
+/** Stop tracing */
+void tracepoint_stop(void)
+{
+	atomic_store_explicit(&tracepoint_enabled, false,
+	    memory_order_relaxed);
+}
+
+/** Get tracepoint buffer snapshot
+ *
+ * Generate a snapshot of all per-CPU tracepoint buffers for the
+ * trace.data sysinfo item. Each buffer is prefixed by the value of
+ * its head counter so that the reader can locate the oldest entry
+ * and detect how many events were recorded (and possibly
+ * overwritten) in total.
+ *
+ * @param item    Sysinfo item (unused).
+ * @param size    Size of the returned data.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Data containing the snapshot.
+ * @return NULL if the dry run is requested or on failure.
+ *
+ */
+static void *trace_get_data(struct sysinfo_item *item, size_t *size,
+    bool dry_run, void *data)
+{
+	size_t buf_size = sizeof(size_t) + sizeof(tracepoint_bufs->entries);
+	*size = buf_size * config.cpu_count;
+
+	if ((dry_run) || (tracepoint_bufs == NULL))
+		return NULL;
+
+	uint8_t *snapshot = (uint8_t *) malloc(*size);
+	if (snapshot == NULL) {
+		/* No free space for allocation */
+		*size = 0;
+		return NULL;
+	}
+
+	uint8_t *pos = snapshot;
+	for (unsigned int cpu = 0; cpu < config.cpu_count; cpu++) {
+		tracepoint_buf_t *buf = &tracepoint_bufs[cpu];
+
+		size_t head = atomic_load_explicit(&buf->head,
+		    memory_order_relaxed);
+		memcpy(pos, &head, sizeof(head));
+		pos += sizeof(head);
+
+		memcpy(pos, buf->entries, sizeof(buf->entries));
+		pos += sizeof(buf->entries);
+	}
+
+	return ((void *) snapshot);
+}
+
+/** Get tracing status
+ *
+ * @param item Sysinfo item (unused).
+ * @param data Unused.
+ *
+ * @return Nonzero if tracing is currently enabled.
+ *
+ */
+static sysarg_t trace_get_enabled(struct sysinfo_item *item, void *data)
+{
+	return (sysarg_t) atomic_load_explicit(&tracepoint_enabled,
+	    memory_order_relaxed);
+}
+
+/** Initialize the tracepoint facility
+ *
+ * Allocate the per-CPU buffers and register the sysinfo items.
+ * Until this is called (and tracing is started), the tracepoints
+ * are inert.
+ *
+ */
+void tracepoint_init(void)
+{
+	tracepoint_bufs = (tracepoint_buf_t *) calloc(config.cpu_count,
+	    sizeof(tracepoint_buf_t));
+	if (tracepoint_bufs == NULL) {
+		printf("Could not allocate tracepoint buffers.\n");
+		return;
+	}
+
+	sysinfo_set_item_gen_val("trace.enabled", NULL, trace_get_enabled,
+	    NULL);
+	sysinfo_set_item_gen_data("trace.data", NULL, trace_get_data, NULL);
+	sysinfo_set_item_val("trace.entries", NULL, TRACEPOINT_BUF_ENTRIES);
+}
+
+/** @}
+ */
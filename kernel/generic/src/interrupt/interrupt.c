@@ -131,8 +131,23 @@ _NO_TRACE void exc_dispatch(unsigned int n, istate_t *istate)
 		THREAD->udebug.uspace_state = istate;
 #endif
 
+	/*
+	 * Remember the istate of the innermost exception so that the
+	 * sampling profiler can attribute timer ticks to the interrupted
+	 * program counter. Saved and restored to survive nested
+	 * exceptions.
+	 */
+	istate_t *prev_istate = NULL;
+	if (CPU) {
+		prev_istate = CPU_LOCAL->current_istate;
+		CPU_LOCAL->current_istate = istate;
+	}
+
 	exc_table[n].handler(n + IVT_FIRST, istate);
 
+	if (CPU)
+		CPU_LOCAL->current_istate = prev_istate;
+
 #ifdef CONFIG_UDEBUG
 	if (THREAD)
 		THREAD->udebug.uspace_state = NULL;
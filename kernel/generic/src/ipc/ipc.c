@@ -51,6 +51,7 @@
 #include <ipc/sysipc_priv.h>
 #include <errno.h>
 #include <mm/slab.h>
+#include <config.h>
 #include <arch.h>
 #include <proc/task.h>
 #include <memw.h>
@@ -59,7 +60,9 @@
 #include <proc/thread.h>
 #include <arch/interrupt.h>
 #include <ipc/irq.h>
+#include <ipc/latency.h>
 #include <cap/cap.h>
+#include <debug/tracepoint.h>
 #include <stdlib.h>
 
 static void ipc_forget_call(call_t *);
@@ -113,21 +116,14 @@ kobject_ops_t call_kobject_ops = {
  */
 call_t *ipc_call_alloc(void)
 {
-	// TODO: Allocate call and kobject in single allocation
-
 	call_t *call = slab_alloc(call_cache, FRAME_ATOMIC);
 	if (!call)
 		return NULL;
 
-	kobject_t *kobj = kobject_alloc(0);
-	if (!kobj) {
-		slab_free(call_cache, call);
-		return NULL;
-	}
-
 	_ipc_call_init(call);
-	kobject_initialize(kobj, KOBJECT_TYPE_CALL, call);
-	call->kobject = kobj;
+	kobject_initialize_embedded(&call->kobject_storage, KOBJECT_TYPE_CALL,
+	    call);
+	call->kobject = &call->kobject_storage;
 
 	return call;
 }
@@ -200,6 +196,7 @@ void ipc_phone_init(phone_t *phone, task_t *caller)
 	phone->state = IPC_PHONE_FREE;
 	atomic_store(&phone->active_calls, 0);
 	phone->label = 0;
+	memsetb(&phone->lat, sizeof(phone->lat), 0);
 	phone->kobject = NULL;
 }
 
@@ -317,6 +314,9 @@ void _ipc_answer_free_call(call_t *call, bool selflocked)
 
 	call->data.task_id = TASK->taskid;
 
+	/* Stamp the answer edge for IPC latency tracing */
+	call->answered_stamp = ipc_lat_stamp();
+
 	if (do_lock)
 		irq_spinlock_lock(&callerbox->lock, true);
 
@@ -408,8 +408,15 @@ static void _ipc_call(phone_t *phone, answerbox_t *box, call_t *call,
 	caller->ipc_info.call_sent++;
 	irq_spinlock_unlock(&caller->lock, true);
 
-	if (!(call->flags & IPC_CALL_FORWARDED))
+	if (!(call->flags & IPC_CALL_FORWARDED)) {
 		_ipc_call_actions_internal(phone, call, preforget);
+		/*
+		 * Stamp the send edge for IPC latency tracing. Forwarded
+		 * calls keep their original stamp, so the caller sees the
+		 * latency of the whole chain.
+		 */
+		call->sent_stamp = ipc_lat_stamp();
+	}
 
 	irq_spinlock_lock(&box->lock, true);
 	list_append(&call->ab_link, &box->calls);
@@ -442,6 +449,9 @@ errno_t ipc_call(phone_t *phone, call_t *call)
 		return ENOENT;
 	}
 
+	tracepoint_emit(TRACE_EVENT_IPC_CALL, ipc_get_imethod(&call->data),
+	    (sysarg_t) (TASK != NULL ? TASK->taskid : 0));
+
 	answerbox_t *box = phone->callee;
 	_ipc_call(phone, box, call, false);
 
@@ -578,6 +588,10 @@ errno_t ipc_wait_for_call(answerbox_t *box, uint32_t usec, unsigned int flags,
 		request = list_get_instance(list_first(&box->answers),
 		    call_t, ab_link);
 		list_remove(&request->ab_link);
+
+		/* Account the answered call for IPC latency tracing */
+		ipc_lat_pickup(request);
+
 		atomic_dec(&request->caller_phone->active_calls);
 		atomic_dec(&box->active_calls);
 		kobject_put(request->caller_phone->kobject);
@@ -590,6 +604,9 @@ errno_t ipc_wait_for_call(answerbox_t *box, uint32_t usec, unsigned int flags,
 		    call_t, ab_link);
 		list_remove(&request->ab_link);
 
+		/* Stamp the dispatch edge for IPC latency tracing */
+		request->dispatched_stamp = ipc_lat_stamp();
+
 		/* Append request to dispatch queue */
 		list_append(&request->ab_link, &box->dispatched_calls);
 	} else {
@@ -891,6 +908,19 @@ void ipc_init(void)
 	    NULL, 0);
 	answerbox_cache = slab_cache_create("answerbox_t", sizeof(answerbox_t),
 	    0, NULL, NULL, 0);
+
+	/*
+	 * Calls and phones are allocated and freed at very high rates in
+	 * message storms, so keep them on the per-CPU magazine fast path:
+	 * move magazines to and from the depot in bigger batches and stock
+	 * the depots up front.
+	 */
+	slab_cache_set_depot_batch(call_cache, 2 * SLAB_DEPOT_BATCH);
+	slab_cache_set_depot_batch(phone_cache, 2 * SLAB_DEPOT_BATCH);
+	(void) slab_cache_prefill(call_cache,
+	    2 * SLAB_MAG_SIZE * config.cpu_count);
+	(void) slab_cache_prefill(phone_cache,
+	    SLAB_MAG_SIZE * config.cpu_count);
 }
 
 static void ipc_print_call_list(list_t *list)
@@ -952,6 +982,19 @@ static bool print_task_phone_cb(cap_t *cap, void *arg)
 			break;
 		}
 
+		/*
+		 * The summary is updated under the answerbox lock, not
+		 * the phone lock; the unsynchronized read is good enough
+		 * for diagnostic output.
+		 */
+		if (phone->lat.count > 0) {
+			printf(" avg lat q/s/r %" PRIu64 "/%" PRIu64
+			    "/%" PRIu64 " cycles",
+			    phone->lat.queue_cycles / phone->lat.count,
+			    phone->lat.service_cycles / phone->lat.count,
+			    phone->lat.return_cycles / phone->lat.count);
+		}
+
 		printf("\n");
 	}
 	mutex_unlock(&phone->lock);
@@ -50,6 +50,13 @@
  * - ARG5: payload modified by a 'top-half' handler (scratch[5])
  * - request_label: interrupt counter (may be needed to assure correct order
  *                  in multithreaded drivers)
+ *
+ * If the notification was subscribed with IRQ_NOTIF_COALESCE, an interrupt
+ * that arrives while the previous notification is still waiting in the
+ * answerbox updates the waiting message in place (latest payload, current
+ * counter) instead of posting another one. The counter difference between
+ * two consecutively received notifications tells the driver how many
+ * interrupts were merged, so it can switch to polling under load.
  */
 
 #include <arch.h>
@@ -300,6 +307,15 @@ static void irq_destroy(void *arg)
 
 	irq_hash_out(irq);
 
+	/*
+	 * The IRQ can no longer be dispatched, so the reference kept for
+	 * notification coalescing may be dropped without locking.
+	 */
+	if (irq->notif_cfg.pending_call) {
+		kobject_put(irq->notif_cfg.pending_call->kobject);
+		irq->notif_cfg.pending_call = NULL;
+	}
+
 	/* Free up the IRQ code and associated structures. */
 	code_free(irq->notif_cfg.code);
 	slab_free(irq_cache, irq);
@@ -315,6 +331,7 @@ kobject_ops_t irq_kobject_ops = {
  * @param inr     IRQ number.
  * @param imethod Interface and method to be associated with the notification.
  * @param ucode   Uspace pointer to top-half IRQ code.
+ * @param flags   Notification flags (IRQ_NOTIF_COALESCE).
  *
  * @param[out] uspace_handle  Uspace pointer to IRQ capability handle
  *
@@ -322,11 +339,15 @@ kobject_ops_t irq_kobject_ops = {
  *
  */
 errno_t ipc_irq_subscribe(answerbox_t *box, inr_t inr, sysarg_t imethod,
-    uspace_ptr_irq_code_t ucode, uspace_ptr_cap_irq_handle_t uspace_handle)
+    uspace_ptr_irq_code_t ucode, sysarg_t flags,
+    uspace_ptr_cap_irq_handle_t uspace_handle)
 {
 	if ((inr < 0) || (inr > last_inr))
 		return ELIMIT;
 
+	if ((flags & ~((sysarg_t) IRQ_NOTIF_COALESCE)) != 0)
+		return EINVAL;
+
 	irq_code_t *code;
 	if (ucode) {
 		code = code_from_uspace(ucode);
@@ -371,6 +392,8 @@ errno_t ipc_irq_subscribe(answerbox_t *box, inr_t inr, sysarg_t imethod,
 	irq->notif_cfg.imethod = imethod;
 	irq->notif_cfg.code = code;
 	irq->notif_cfg.counter = 0;
+	irq->notif_cfg.coalesce = (flags & IRQ_NOTIF_COALESCE) != 0;
+	irq->notif_cfg.pending_call = NULL;
 
 	/*
 	 * Insert the IRQ structure into the uspace IRQ hash table.
@@ -424,6 +447,18 @@ errno_t ipc_irq_unsubscribe(answerbox_t *box, cap_irq_handle_t handle)
  */
 static void send_call(irq_t *irq, call_t *call)
 {
+	/*
+	 * Keep a reference to the last posted notification so that a
+	 * subsequent interrupt may be merged into it while it waits in the
+	 * answerbox. The reference must be taken before the call is
+	 * enqueued, since the receiver may consume it immediately.
+	 */
+	if (irq->notif_cfg.coalesce) {
+		assert(irq->notif_cfg.pending_call == NULL);
+		kobject_add_ref(call->kobject);
+		irq->notif_cfg.pending_call = call;
+	}
+
 	irq_spinlock_lock(&irq->notif_cfg.answerbox->irq_lock, false);
 	list_append(&call->ab_link, &irq->notif_cfg.answerbox->irq_notifs);
 	irq_spinlock_unlock(&irq->notif_cfg.answerbox->irq_lock, false);
@@ -431,6 +466,60 @@ static void send_call(irq_t *irq, call_t *call)
 	waitq_wake_one(&irq->notif_cfg.answerbox->wq);
 }
 
+/** Try to merge a notification into the last undelivered one.
+ *
+ * Assume irq->lock is locked and interrupts disabled.
+ *
+ * @param irq IRQ structure referencing the target answerbox.
+ * @param a1  Payload argument.
+ * @param a2  Payload argument.
+ * @param a3  Payload argument.
+ * @param a4  Payload argument.
+ * @param a5  Payload argument.
+ *
+ * @return True if the notification was merged and no new message is to
+ *         be sent.
+ *
+ */
+static bool coalesce_call(irq_t *irq, sysarg_t a1, sysarg_t a2, sysarg_t a3,
+    sysarg_t a4, sysarg_t a5)
+{
+	call_t *pending = irq->notif_cfg.pending_call;
+	if (pending == NULL)
+		return false;
+
+	answerbox_t *box = irq->notif_cfg.answerbox;
+	bool merged = false;
+
+	irq_spinlock_lock(&box->irq_lock, false);
+
+	/*
+	 * list_remove() reinitializes the link, so an in-use link means the
+	 * notification still waits in the answerbox and may be updated in
+	 * place. The receiver dequeues it while holding the same lock and
+	 * reads it only afterwards.
+	 */
+	if (link_in_use(&pending->ab_link)) {
+		pending->priv = ++irq->notif_cfg.counter;
+		ipc_set_arg1(&pending->data, a1);
+		ipc_set_arg2(&pending->data, a2);
+		ipc_set_arg3(&pending->data, a3);
+		ipc_set_arg4(&pending->data, a4);
+		ipc_set_arg5(&pending->data, a5);
+		merged = true;
+	}
+
+	irq_spinlock_unlock(&box->irq_lock, false);
+
+	if (!merged) {
+		/* The notification was delivered in the meantime. */
+		irq->notif_cfg.pending_call = NULL;
+		kobject_put(pending->kobject);
+	}
+
+	return merged;
+}
+
 /** Apply the top-half IRQ code to find out whether to accept the IRQ or not.
  *
  * @param irq IRQ structure.
@@ -529,6 +618,12 @@ void ipc_irq_top_half_handler(irq_t *irq)
 	assert(irq_spinlock_locked(&irq->lock));
 
 	if (irq->notif_cfg.answerbox) {
+		uint32_t *scratch = irq->notif_cfg.scratch;
+
+		if (coalesce_call(irq, scratch[1], scratch[2], scratch[3],
+		    scratch[4], scratch[5]))
+			return;
+
 		call_t *call = ipc_call_alloc();
 		if (!call)
 			return;
@@ -539,11 +634,11 @@ void ipc_irq_top_half_handler(irq_t *irq)
 
 		/* Set up args */
 		ipc_set_imethod(&call->data, irq->notif_cfg.imethod);
-		ipc_set_arg1(&call->data, irq->notif_cfg.scratch[1]);
-		ipc_set_arg2(&call->data, irq->notif_cfg.scratch[2]);
-		ipc_set_arg3(&call->data, irq->notif_cfg.scratch[3]);
-		ipc_set_arg4(&call->data, irq->notif_cfg.scratch[4]);
-		ipc_set_arg5(&call->data, irq->notif_cfg.scratch[5]);
+		ipc_set_arg1(&call->data, scratch[1]);
+		ipc_set_arg2(&call->data, scratch[2]);
+		ipc_set_arg3(&call->data, scratch[3]);
+		ipc_set_arg4(&call->data, scratch[4]);
+		ipc_set_arg5(&call->data, scratch[5]);
 
 		send_call(irq, call);
 	}
@@ -565,6 +660,11 @@ void ipc_irq_send_msg(irq_t *irq, sysarg_t a1, sysarg_t a2, sysarg_t a3,
 	irq_spinlock_lock(&irq->lock, true);
 
 	if (irq->notif_cfg.answerbox) {
+		if (coalesce_call(irq, a1, a2, a3, a4, a5)) {
+			irq_spinlock_unlock(&irq->lock, true);
+			return;
+		}
+
 		call_t *call = ipc_call_alloc();
 		if (!call) {
 			irq_spinlock_unlock(&irq->lock, true);
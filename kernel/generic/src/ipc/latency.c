@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_ipc
+ * @{
+ */
+
+/**
+ * @file
+ * @brief IPC latency tracing.
+ *
+ * Optional cycle-accurate timing of asynchronous IPC interactions.
+ * When tracing is enabled, every call is stamped when it is sent,
+ * when the server dispatches it and when it is answered. When the
+ * caller later picks up the answer, the three intervals (queueing
+ * before the server, service in the server, return of the answer)
+ * are folded into global log2-scaled histograms and into a summary
+ * attached to the caller's phone. The histograms are exported to
+ * user space as the ipc.latency.data sysinfo item; the per-phone
+ * summaries are printed by the ipc kernel console command. Tracing
+ * is controlled by the ipclat kernel console command and, while
+ * disabled (the default), costs only a relaxed load of the enable
+ * flag per edge.
+ *
+ * Calls answered by the kernel without ever being dispatched to a
+ * server are not accounted. On SMP systems the cycle counters of the
+ * individual CPUs are assumed to advance at the same rate; constant
+ * offsets between them distort individual samples by a constant
+ * amount, which log2 bucketing mostly hides.
+ */
+
+#include <bitops.h>
+#include <ipc/ipc.h>
+#include <ipc/latency.h>
+#include <stdlib.h>
+#include <sysinfo/sysinfo.h>
+
+/** Global IPC latency tracing enable flag */
+atomic_bool ipc_lat_enabled = ATOMIC_VAR_INIT(false);
+
+/** Global latency histograms, indexed by log2 of the cycle count */
+static atomic_uint_fast64_t queue_hist[IPC_LAT_BUCKETS];
+static atomic_uint_fast64_t service_hist[IPC_LAT_BUCKETS];
+static atomic_uint_fast64_t return_hist[IPC_LAT_BUCKETS];
+
+/** Convert a cycle count to its histogram bucket index */
+static size_t lat_bucket(uint64_t cycles)
+{
+	if (cycles == 0)
+		return 0;
+
+	size_t bucket = fnzb64(cycles);
+	if (bucket >= IPC_LAT_BUCKETS)
+		bucket = IPC_LAT_BUCKETS - 1;
+
+	return bucket;
+}
+
+/** Count one interval into a global histogram */
+static void hist_add(atomic_uint_fast64_t *hist, uint64_t cycles)
+{
+	atomic_fetch_add_explicit(&hist[lat_bucket(cycles)], 1,
+	    memory_order_relaxed);
+}
+
+/** Account an answered call into the latency statistics
+ *
+ * Called by ipc_lat_pickup() when the caller picks up an answer and
+ * tracing is enabled. Runs under the lock of the answerbox receiving
+ * the answer, which also serializes the updates of the caller
+ * phone's summary.
+ *
+ * @param call Answered call being returned to the caller.
+ *
+ */
+void ipc_lat_account(call_t *call)
+{
+	uint64_t now = get_cycle();
+
+	/*
+	 * Require a complete, monotonic set of stamps. Calls sent or
+	 * dispatched before tracing was enabled (and calls answered by
+	 * the kernel without reaching a server) lack some of them.
+	 */
+	if ((call->sent_stamp == 0) ||
+	    (call->dispatched_stamp < call->sent_stamp) ||
+	    (call->answered_stamp < call->dispatched_stamp) ||
+	    (now < call->answered_stamp))
+		return;
+
+	uint64_t queue = call->dispatched_stamp - call->sent_stamp;
+	uint64_t service = call->answered_stamp - call->dispatched_stamp;
+	uint64_t ret = now - call->answered_stamp;
+
+	hist_add(queue_hist, queue);
+	hist_add(service_hist, service);
+	hist_add(return_hist, ret);
+
+	phone_t *phone = call->caller_phone;
+	phone->lat.count++;
+	phone->lat.queue_cycles += queue;
+	phone->lat.service_cycles += service;
+	phone->lat.return_cycles += ret;
+}
+
+/** Start IPC latency tracing
+ *
+ * The global histograms are reset so that every start begins a fresh
+ * measurement. The per-phone summaries keep accumulating.
+ *
+ */
+void ipc_lat_start(void)
+{
+	for (size_t i = 0; i < IPC_LAT_BUCKETS; i++) {
+		atomic_store_explicit(&queue_hist[i], 0,
+		    memory_order_relaxed);
+		atomic_store_explicit(&service_hist[i], 0,
+		    memory_order_relaxed);
+		atomic_store_explicit(&return_hist[i], 0,
+		    memory_order_relaxed);
+	}
+
+	atomic_store_explicit(&ipc_lat_enabled, true, memory_order_relaxed);
+}
+
+/** Stop IPC latency tracing */
+void ipc_lat_stop(void)
+{
+	atomic_store_explicit(&ipc_lat_enabled, false, memory_order_relaxed);
+}
+
+/** Get IPC latency histogram snapshot
+ *
+ * Generate a snapshot of the global latency histograms for the
+ * ipc.latency.data sysinfo item. The snapshot is taken without
+ * stopping the writers; the individual counters are consistent, the
+ * histograms as a whole need not be.
+ *
+ * @param item    Sysinfo item (unused).
+ * @param size    Size of the returned data.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Data containing the snapshot.
+ * @return NULL if the dry run is requested or on failure.
+ *
+ */
+static void *ipc_lat_get_data(struct sysinfo_item *item, size_t *size,
+    bool dry_run, void *data)
+{
+	*size = sizeof(ipc_lat_data_t);
+
+	if (dry_run)
+		return NULL;
+
+	ipc_lat_data_t *snapshot = (ipc_lat_data_t *) malloc(*size);
+	if (snapshot == NULL) {
+		/* No free space for allocation */
+		*size = 0;
+		return NULL;
+	}
+
+	for (size_t i = 0; i < IPC_LAT_BUCKETS; i++) {
+		snapshot->queue[i] = atomic_load_explicit(&queue_hist[i],
+		    memory_order_relaxed);
+		snapshot->service[i] = atomic_load_explicit(&service_hist[i],
+		    memory_order_relaxed);
+		snapshot->ret[i] = atomic_load_explicit(&return_hist[i],
+		    memory_order_relaxed);
+	}
+
+	return ((void *) snapshot);
+}
+
+/** Get IPC latency tracing status
+ *
+ * @param item Sysinfo item (unused).
+ * @param data Unused.
+ *
+ * @return Nonzero if tracing is currently enabled.
+ *
+ */
+static sysarg_t ipc_lat_get_enabled(struct sysinfo_item *item, void *data)
+{
+	return (sysarg_t) atomic_load_explicit(&ipc_lat_enabled,
+	    memory_order_relaxed);
+}
+
+/** Initialize IPC latency tracing
+ *
+ * Register the sysinfo items. Until tracing is started, the stamping
+ * in the IPC paths is inert.
+ *
+ */
+void ipc_lat_init(void)
+{
+	sysinfo_set_item_gen_val("ipc.latency.enabled", NULL,
+	    ipc_lat_get_enabled, NULL);
+	sysinfo_set_item_gen_data("ipc.latency.data", NULL, ipc_lat_get_data,
+	    NULL);
+	sysinfo_set_item_val("ipc.latency.buckets", NULL, IPC_LAT_BUCKETS);
+}
+
+/** @}
+ */
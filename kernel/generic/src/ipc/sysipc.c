@@ -879,6 +879,7 @@ sys_errno_t sys_ipc_poke(void)
  * @param inr     IRQ number.
  * @param imethod Interface and method to be associated with the notification.
  * @param ucode   Uspace pointer to the top-half pseudocode.
+ * @param flags   Notification flags (IRQ_NOTIF_COALESCE).
  *
  * @param[out] uspace_handle  Uspace pointer to IRQ capability handle
  *
@@ -887,12 +888,14 @@ sys_errno_t sys_ipc_poke(void)
  *
  */
 sys_errno_t sys_ipc_irq_subscribe(inr_t inr, sysarg_t imethod,
-    uspace_ptr_irq_code_t ucode, uspace_ptr_cap_irq_handle_t uspace_handle)
+    uspace_ptr_irq_code_t ucode, sysarg_t flags,
+    uspace_ptr_cap_irq_handle_t uspace_handle)
 {
 	if (!(perm_get(TASK) & PERM_IRQ_REG))
 		return EPERM;
 
-	return ipc_irq_subscribe(&TASK->answerbox, inr, imethod, ucode, uspace_handle);
+	return ipc_irq_subscribe(&TASK->answerbox, inr, imethod, ucode, flags,
+	    uspace_handle);
 }
 
 /** Disconnect an IRQ handler from a task.
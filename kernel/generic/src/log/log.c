@@ -32,8 +32,11 @@
 /** @file
  */
 
+#include <assert.h>
+#include <barrier.h>
 #include <sysinfo/sysinfo.h>
 #include <synch/spinlock.h>
+#include <mm/frame.h>
 #include <typedefs.h>
 #include <ddi/irq.h>
 #include <ddi/ddi.h>
@@ -58,8 +61,20 @@
 #define LOG_LENGTH   (LOG_PAGES * PAGE_SIZE)
 #define LOG_ENTRY_HEADER_LENGTH (sizeof(size_t) + sizeof(uint32_t))
 
-/** Cyclic buffer holding the data for kernel log */
-uint8_t log_buffer[LOG_LENGTH] __attribute__((aligned(PAGE_SIZE)));
+/** Kernel log memory area shared with userspace.
+ *
+ * The header page carries the monotonic writer/reader positions, the
+ * cyclic buffer holding the log entry data follows on the next page.
+ * The whole area is mappable by the log reader via physmem_map().
+ */
+static struct {
+	klog_shared_t hdr;
+	uint8_t pad[PAGE_SIZE - sizeof(klog_shared_t)];
+	uint8_t buffer[LOG_LENGTH];
+} log_area __attribute__((aligned(PAGE_SIZE)));
+
+/** Physical memory area used for the kernel log */
+static parea_t log_parea;
 
 /** Kernel log initialized */
 static atomic_bool log_inited = false;
@@ -92,6 +107,20 @@ static void log_update(void *);
  */
 void log_init(void)
 {
+	void *faddr = (void *) KA2PA(&log_area);
+
+	assert((uintptr_t) faddr % FRAME_SIZE == 0);
+
+	ddi_parea_init(&log_parea);
+	log_parea.pbase = (uintptr_t) faddr;
+	log_parea.frames = SIZE2FRAMES(sizeof(log_area));
+	log_parea.unpriv = false;
+	log_parea.mapped = false;
+	ddi_parea_register(&log_parea);
+
+	sysinfo_set_item_val("klog.faddr", NULL, (sysarg_t) faddr);
+	sysinfo_set_item_val("klog.pages", NULL, LOG_PAGES + 1);
+
 	event_set_unmask_callback(EVENT_KLOG, log_update);
 	atomic_store(&log_inited, true);
 }
@@ -99,7 +128,7 @@ void log_init(void)
 static size_t log_copy_from(uint8_t *data, size_t pos, size_t len)
 {
 	for (size_t i = 0; i < len; i++, pos = (pos + 1) % LOG_LENGTH) {
-		data[i] = log_buffer[pos];
+		data[i] = log_area.buffer[pos];
 	}
 	return pos;
 }
@@ -107,7 +136,7 @@ static size_t log_copy_from(uint8_t *data, size_t pos, size_t len)
 static size_t log_copy_to(const uint8_t *data, size_t pos, size_t len)
 {
 	for (size_t i = 0; i < len; i++, pos = (pos + 1) % LOG_LENGTH) {
-		log_buffer[pos] = data[i];
+		log_area.buffer[pos] = data[i];
 	}
 	return pos;
 }
@@ -129,13 +158,24 @@ static void log_append(const uint8_t *data, size_t len)
 	size_t log_free = LOG_LENGTH - log_used - log_current_len;
 
 	/* Discard older entries to make space, if necessary */
-	while (len > log_free) {
-		size_t entry_len;
-		log_copy_from((uint8_t *) &entry_len, log_start, sizeof(size_t));
-		log_start = (log_start + entry_len) % LOG_LENGTH;
-		log_used -= entry_len;
-		log_free += entry_len;
-		next_for_uspace -= entry_len;
+	if (len > log_free) {
+		while (len > log_free) {
+			size_t entry_len;
+			log_copy_from((uint8_t *) &entry_len, log_start, sizeof(size_t));
+			log_start = (log_start + entry_len) % LOG_LENGTH;
+			log_used -= entry_len;
+			log_free += entry_len;
+			next_for_uspace -= entry_len;
+			log_area.hdr.start += entry_len;
+		}
+
+		/*
+		 * The mapped reader detects overruns by re-checking the
+		 * start position after copying an entry, so the advanced
+		 * position must be visible before the entry data is
+		 * overwritten below.
+		 */
+		write_barrier();
 	}
 
 	size_t pos = (log_current_start + log_current_len) % LOG_LENGTH;
@@ -177,6 +217,10 @@ void log_end(void)
 	log_copy_to((uint8_t *) &log_current_len, log_current_start, sizeof(size_t));
 	log_used += log_current_len;
 
+	/* Publish the entry to the mapped reader */
+	write_barrier();
+	log_area.hdr.wpos += log_current_len;
+
 	kio_push_char('\n');
 	spinlock_unlock(&kio_lock);
 	spinlock_unlock(&log_lock);
@@ -193,8 +237,17 @@ static void log_update(void *event)
 		return;
 
 	spinlock_lock(&log_lock);
-	if (next_for_uspace < log_used)
+
+	/*
+	 * Ring the doorbell only while the reader is behind. A reader
+	 * using the mapped buffer advances hdr.rpos as it consumes
+	 * entries; a reader relying on KLOG_READ leaves hdr.rpos at
+	 * zero and is notified as before.
+	 */
+	if ((next_for_uspace < log_used) &&
+	    (log_area.hdr.rpos < log_area.hdr.wpos))
 		event_notify_0(EVENT_KLOG, true);
+
 	spinlock_unlock(&log_lock);
 }
 
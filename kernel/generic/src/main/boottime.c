@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Boot milestone timing.
+ *
+ * Records named timestamps at the major milestones of the boot
+ * process, from kernel entry through the start of the individual
+ * user space services. Kernel milestones are recorded directly with
+ * boottime_mark(); user space components record theirs through the
+ * SYS_BOOTTIME_MARK syscall. The table of milestones is exported to
+ * user space as the boottime.data sysinfo item and reported by the
+ * boottime application.
+ *
+ * Each milestone carries both a cycle counter value (usable from the
+ * very first instants of the kernel) and the uptime in microseconds
+ * (zero until the clock starts ticking, tick-granular afterwards).
+ */
+
+#include <abi/sysinfo.h>
+#include <arch/cycle.h>
+#include <barrier.h>
+#include <errno.h>
+#include <main/boottime.h>
+#include <mem.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <str.h>
+#include <syscall/copy.h>
+#include <sysinfo/sysinfo.h>
+#include <time/clock.h>
+
+/** Table of recorded milestones */
+static boottime_entry_t boottime_entries[BOOTTIME_ENTRIES];
+
+/** Number of milestones claimed so far (may exceed BOOTTIME_ENTRIES) */
+static atomic_size_t boottime_head = ATOMIC_VAR_INIT(0);
+
+/** Get the current uptime in microseconds
+ *
+ * @return Uptime in microseconds, zero before the clock is
+ *         initialized.
+ *
+ */
+static uint64_t boottime_uptime_usec(void)
+{
+	if (uptime == NULL)
+		return 0;
+
+	sysarg_t s2 = uptime->seconds2;
+	read_barrier();
+	sysarg_t usecs = uptime->useconds;
+	read_barrier();
+	sysarg_t s1 = uptime->seconds1;
+
+	/* A tick is in progress; second granularity has to do. */
+	if (s1 != s2)
+		usecs = 0;
+
+	return (uint64_t) s1 * 1000000 + usecs;
+}
+
+/** Record a boot milestone
+ *
+ * Safe to call from any context, including the very early phases of
+ * main_bsp() before the memory management is up. When the table is
+ * full, further milestones are silently dropped.
+ *
+ * @param name Milestone name, truncated to BOOTTIME_NAME_SIZE - 1
+ *             characters.
+ *
+ */
+void boottime_mark(const char *name)
+{
+	size_t seq = atomic_fetch_add_explicit(&boottime_head, 1,
+	    memory_order_relaxed);
+	if (seq >= BOOTTIME_ENTRIES)
+		return;
+
+	boottime_entry_t *entry = &boottime_entries[seq];
+
+	entry->cycles = get_cycle();
+	entry->usec = boottime_uptime_usec();
+	str_cpy(entry->name, BOOTTIME_NAME_SIZE, name);
+}
+
+/** Syscall to record a boot milestone from user space
+ *
+ * @param uspace_name Milestone name in user space.
+ * @param name_len    Length of the name in bytes.
+ *
+ * @return EOK on success or an error code from @ref errno.h.
+ *
+ */
+sys_errno_t sys_boottime_mark(const uspace_ptr_const_char uspace_name,
+    size_t name_len)
+{
+	char namebuf[BOOTTIME_NAME_SIZE];
+
+	/* Cap length of name and copy it from userspace. */
+	if (name_len > BOOTTIME_NAME_SIZE - 1)
+		name_len = BOOTTIME_NAME_SIZE - 1;
+
+	errno_t rc = copy_from_uspace(namebuf, uspace_name, name_len);
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	namebuf[name_len] = '\0';
+
+	boottime_mark(namebuf);
+
+	return EOK;
+}
+
+/** Get boot milestone table snapshot
+ *
+ * Generate a snapshot of the recorded milestones for the
+ * boottime.data sysinfo item.
+ *
+ * @param item    Sysinfo item (unused).
+ * @param size    Size of the returned data.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Data containing the snapshot.
+ * @return NULL if the dry run is requested or on failure.
+ *
+ */
+static void *boottime_get_data(struct sysinfo_item *item, size_t *size,
+    bool dry_run, void *data)
+{
+	size_t count = atomic_load_explicit(&boottime_head,
+	    memory_order_relaxed);
+	if (count > BOOTTIME_ENTRIES)
+		count = BOOTTIME_ENTRIES;
+
+	*size = count * sizeof(boottime_entry_t);
+
+	if (dry_run)
+		return NULL;
+
+	void *snapshot = malloc(*size);
+	if (snapshot == NULL) {
+		/* No free space for allocation */
+		*size = 0;
+		return NULL;
+	}
+
+	memcpy(snapshot, boottime_entries, *size);
+
+	return snapshot;
+}
+
+/** Initialize the boot milestone export
+ *
+ * Register the sysinfo item. Milestones recorded before this call
+ * are kept and become visible once the item exists.
+ *
+ */
+void boottime_init(void)
+{
+	sysinfo_set_item_gen_data("boottime.data", NULL, boottime_get_data,
+	    NULL);
+}
+
+/** @}
+ */
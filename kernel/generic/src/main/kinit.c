@@ -42,6 +42,7 @@
  */
 
 #include <assert.h>
+#include <main/boottime.h>
 #include <main/kinit.h>
 #include <config.h>
 #include <arch.h>
@@ -318,6 +319,8 @@ void kinit(void *arg)
 		}
 	}
 
+	boottime_mark("kernel:init_tasks");
+
 #ifdef CONFIG_KCONSOLE
 	if (!stdin) {
 		thread_sleep(10);
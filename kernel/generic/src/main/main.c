@@ -85,8 +85,13 @@
 #include <ddi/ddi.h>
 #include <main/main.h>
 #include <ipc/event.h>
+#include <ipc/latency.h>
+#include <main/boottime.h>
+#include <pmu/pmu.h>
 #include <sysinfo/sysinfo.h>
 #include <sysinfo/stats.h>
+#include <debug/sampling.h>
+#include <debug/tracepoint.h>
 #include <lib/ra.h>
 #include <cap/cap.h>
 
@@ -188,6 +193,9 @@ void main_bsp_separated_stack(void)
 	/* Keep this the first thing. */
 	current_initialize(CURRENT);
 
+	/* Approximates the boot loader handoff. */
+	boottime_mark("kernel:entry");
+
 	version_print();
 
 	LOG("\nconfig.base=%p config.kernel_size=%zu",
@@ -225,11 +233,13 @@ void main_bsp_separated_stack(void)
 	ddi_init();
 	ARCH_OP(post_mm_init);
 	reserve_init();
+	boottime_mark("kernel:mm");
 	ARCH_OP(pre_smp_init);
 	smp_init();
 
 	/* Slab must be initialized after we know the number of processors. */
 	slab_enable_cpucache();
+	malloc_prefill();
 
 	uint64_t size;
 	const char *size_suffix;
@@ -240,6 +250,7 @@ void main_bsp_separated_stack(void)
 	cpu_init();
 	calibrate_delay_loop();
 	ARCH_OP(post_cpu_init);
+	boottime_mark("kernel:cpu");
 
 	clock_counter_init();
 	timeout_init();
@@ -264,6 +275,12 @@ void main_bsp_separated_stack(void)
 	kio_init();
 	log_init();
 	stats_init();
+	tracepoint_init();
+	profile_init();
+	ipc_lat_init();
+	boottime_init();
+	pmu_init();
+	boottime_mark("kernel:subsys");
 
 	/*
 	 * Create kernel task.
@@ -324,8 +341,6 @@ void main_ap(void)
 	ARCH_OP(post_mm_init);
 
 	cpu_init();
-	calibrate_delay_loop();
-	ARCH_OP(post_cpu_init);
 
 	/*
 	 * If we woke kmp up before we left the kernel stack, we could
@@ -349,7 +364,18 @@ void main_ap_separated_stack(void)
 	 */
 	timeout_init();
 
+	/*
+	 * This processor no longer uses the bootstrap stack or the shared
+	 * trampoline staging data, so the next application processor may be
+	 * started right away. The expensive remainder of the initialization,
+	 * most notably the delay loop calibration, then overlaps with the
+	 * bring-up of the remaining processors.
+	 */
 	semaphore_up(&ap_completion_semaphore);
+
+	calibrate_delay_loop();
+	ARCH_OP(post_cpu_init);
+
 	scheduler_run();
 	/* not reached */
 }
@@ -183,6 +183,8 @@ as_t *as_create(unsigned int flags)
 
 	refcount_init(&as->refcount);
 	as->cpu_refcount = 0;
+	atomic_store(&as->pages_mapped, 0);
+	atomic_store(&as->pages_resident, 0);
 
 #ifdef AS_PAGE_TABLE
 	as->genarch.page_table = page_table_create(flags);
@@ -844,8 +846,11 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 	}
 
 	used_space_initialize(&area->used_space);
+	area->used_space.as = as;
 	odict_insert(&area->las_areas, &as->as_areas, NULL);
 
+	atomic_fetch_add(&as->pages_mapped, pages);
+
 	mutex_unlock(&as->lock);
 
 	return area;
@@ -1071,6 +1076,11 @@ errno_t as_area_resize(as_t *as, uintptr_t address, size_t size, unsigned int fl
 		}
 	}
 
+	if (pages > area->pages)
+		atomic_fetch_add(&as->pages_mapped, pages - area->pages);
+	else
+		atomic_fetch_sub(&as->pages_mapped, area->pages - pages);
+
 	area->pages = pages;
 
 	mutex_unlock(&area->lock);
@@ -1157,6 +1167,8 @@ errno_t as_area_destroy(as_t *as, uintptr_t address)
 	area->attributes |= AS_AREA_ATTR_PARTIAL;
 	sh_info_remove_reference(area->sh_info);
 
+	atomic_fetch_sub(&as->pages_mapped, area->pages);
+
 	mutex_unlock(&area->lock);
 
 	/*
@@ -1607,6 +1619,62 @@ page_fault:
 	return AS_PF_DEFER;
 }
 
+/** Prefault pages of an address space area.
+ *
+ * Best-effort eager servicing of page faults anticipated in the given
+ * range. Unlike as_page_fault(), this function may be called on an address
+ * space other than the one of the calling thread. Only areas whose backend
+ * services faults irrespective of the current address space (i.e. the ELF
+ * backend) are prefaulted; other areas are silently left alone.
+ *
+ * @param as      Address space.
+ * @param address Address within the range to prefault.
+ * @param size    Size of the range.
+ *
+ */
+void as_area_prefault(as_t *as, uintptr_t address, size_t size)
+{
+	uintptr_t page = ALIGN_DOWN(address, PAGE_SIZE);
+	uintptr_t end = ALIGN_UP(address + size, PAGE_SIZE);
+
+	mutex_lock(&as->lock);
+
+	as_area_t *area = find_area_and_lock(as, page);
+	if (!area) {
+		mutex_unlock(&as->lock);
+		return;
+	}
+
+	if ((area->attributes & AS_AREA_ATTR_PARTIAL) ||
+	    (area->backend != &elf_backend)) {
+		mutex_unlock(&area->lock);
+		mutex_unlock(&as->lock);
+		return;
+	}
+
+	page_table_lock(as, false);
+
+	for (; page < end; page += PAGE_SIZE) {
+		if (page >= area->base + P2SZ(area->pages))
+			break;
+
+		pte_t pte;
+		if (page_mapping_find(as, page, false, &pte) &&
+		    PTE_PRESENT(&pte))
+			continue;
+
+		/*
+		 * Failures are not fatal here; the page will be serviced
+		 * the regular way when it is actually accessed.
+		 */
+		(void) area->backend->page_fault(area, page, PF_ACCESS_READ);
+	}
+
+	page_table_unlock(as, false);
+	mutex_unlock(&area->lock);
+	mutex_unlock(&as->lock);
+}
+
 /** Switch address spaces.
  *
  * Note that this function cannot sleep as it is essentially a part of
@@ -1856,6 +1924,7 @@ static void used_space_initialize(used_space_t *used_space)
 {
 	odict_initialize(&used_space->ivals, used_space_getkey, used_space_cmp);
 	used_space->pages = 0;
+	used_space->as = NULL;
 }
 
 /** Finalize used space map.
@@ -2000,6 +2069,10 @@ static int used_space_cmp(void *a, void *b)
 static void used_space_remove_ival(used_space_ival_t *ival)
 {
 	ival->used_space->pages -= ival->count;
+	if (ival->used_space->as != NULL) {
+		atomic_fetch_sub(&ival->used_space->as->pages_resident,
+		    ival->count);
+	}
 	odict_remove(&ival->lused_space);
 	slab_free(used_space_ival_cache, ival);
 }
@@ -2015,6 +2088,10 @@ static void used_space_shorten_ival(used_space_ival_t *ival, size_t count)
 	assert(count < ival->count);
 
 	ival->used_space->pages -= ival->count - count;
+	if (ival->used_space->as != NULL) {
+		atomic_fetch_sub(&ival->used_space->as->pages_resident,
+		    ival->count - count);
+	}
 	ival->count = count;
 }
 
@@ -2088,6 +2165,8 @@ bool used_space_insert(used_space_t *used_space, uintptr_t page, size_t count)
 	}
 
 	used_space->pages += count;
+	if (used_space->as != NULL)
+		atomic_fetch_add(&used_space->as->pages_resident, count);
 	return true;
 }
 
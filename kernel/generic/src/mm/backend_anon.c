@@ -53,6 +53,15 @@
 #include <memw.h>
 #include <arch.h>
 
+/**
+ * Size, in base pages, of the block that an AS_AREA_HUGE area is
+ * populated with on a page fault. The 2 MiB block matches the large
+ * page size of ia32/amd64, so the physically contiguous and naturally
+ * aligned backing can later be promoted to a hardware large-page
+ * mapping.
+ */
+#define ANON_HUGE_PAGES  ((2 * 1024 * 1024) / PAGE_SIZE)
+
 static bool anon_create(as_area_t *);
 static bool anon_resize(as_area_t *, size_t);
 static void anon_share(as_area_t *);
@@ -170,6 +179,74 @@ bool anon_is_shareable(as_area_t *area)
 	return !(area->flags & AS_AREA_LATE_RESERVE);
 }
 
+/** Populate a whole large-page-sized block of an AS_AREA_HUGE area.
+ *
+ * The naturally aligned block containing the faulting page is backed
+ * by a single physically contiguous, aligned run of frames and mapped
+ * in one go. The mappings are still inserted with base page
+ * granularity, so a partial unmap demotes the block simply by
+ * returning the individual frames.
+ *
+ * The address space area and page tables must be already locked.
+ *
+ * @param area  Pointer to the address space area.
+ * @param upage Faulting virtual page.
+ *
+ * @return True if the block was populated.
+ * @return False if the caller shall fall back to single-page service.
+ */
+static bool anon_populate_huge(as_area_t *area, uintptr_t upage)
+{
+	uintptr_t bpage = ALIGN_DOWN(upage, P2SZ(ANON_HUGE_PAGES));
+
+	/* The whole block must lie within the area. */
+	if ((bpage < area->base) ||
+	    (bpage + P2SZ(ANON_HUGE_PAGES) > area->base + P2SZ(area->pages)))
+		return false;
+
+	/* Bail out if any page of the block is already mapped. */
+	for (size_t i = 0; i < ANON_HUGE_PAGES; i++) {
+		pte_t pte;
+
+		if (page_mapping_find(area->as, bpage + P2SZ(i), false, &pte))
+			return false;
+	}
+
+	if (area->flags & AS_AREA_LATE_RESERVE) {
+		if (!reserve_try_alloc(ANON_HUGE_PAGES))
+			return false;
+	}
+
+	/*
+	 * Allocate a naturally aligned contiguous run of frames. The
+	 * alignment constraint keeps the physical block eligible for
+	 * promotion to a hardware large-page mapping.
+	 */
+	uintptr_t frame = frame_alloc(ANON_HUGE_PAGES,
+	    FRAME_NO_RESERVE | FRAME_ATOMIC | FRAME_HIGHMEM,
+	    P2SZ(ANON_HUGE_PAGES) - 1);
+	if (!frame) {
+		if (area->flags & AS_AREA_LATE_RESERVE)
+			reserve_free(ANON_HUGE_PAGES);
+
+		return false;
+	}
+
+	uintptr_t kaddr = km_map(frame, P2SZ(ANON_HUGE_PAGES), PAGE_SIZE,
+	    PAGE_READ | PAGE_WRITE | PAGE_CACHEABLE);
+	memsetb((void *) kaddr, P2SZ(ANON_HUGE_PAGES), 0);
+	km_unmap(kaddr, P2SZ(ANON_HUGE_PAGES));
+
+	for (size_t i = 0; i < ANON_HUGE_PAGES; i++)
+		page_mapping_insert(AS, bpage + P2SZ(i), frame + P2SZ(i),
+		    as_area_get_flags(area));
+
+	if (!used_space_insert(&area->used_space, bpage, ANON_HUGE_PAGES))
+		panic("Cannot insert used space.");
+
+	return true;
+}
+
 /** Service a page fault in the anonymous memory address space area.
  *
  * The address space area and page tables must be already locked.
@@ -236,6 +313,15 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		 *   the different causes
 		 */
 
+		if (area->flags & AS_AREA_HUGE) {
+			if (anon_populate_huge(area, upage)) {
+				mutex_unlock(&area->sh_info->lock);
+				return AS_PF_OK;
+			}
+
+			/* Fall back to single-page service. */
+		}
+
 		if (area->flags & AS_AREA_LATE_RESERVE) {
 			/*
 			 * Reserve the memory for this page now.
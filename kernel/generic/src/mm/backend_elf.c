@@ -63,6 +63,9 @@ static bool elf_is_shareable(as_area_t *);
 static int elf_page_fault(as_area_t *, uintptr_t, pf_access_t);
 static void elf_frame_free(as_area_t *, uintptr_t, uintptr_t);
 
+/** Number of pages covered by one fault-around cluster. */
+#define ELF_FAULT_AROUND_PAGES	16
+
 mem_backend_t elf_backend = {
 	.create = elf_create,
 	.resize = elf_resize,
@@ -243,6 +246,78 @@ bool elf_is_shareable(as_area_t *area)
 	return true;
 }
 
+/** Premap neighbors of a faulting page that are backed by the ELF image.
+ *
+ * Large binaries would otherwise cold-start with one page fault per page of
+ * text. Read-only pages of the initialized portion of the segment are mapped
+ * directly to the frames of the kernel ELF image, so the neighboring pages
+ * from the same naturally aligned cluster can be mapped in the same fault
+ * without copying anything.
+ *
+ * The address space area and page tables must be already locked.
+ *
+ * @param area		Pointer to the address space area.
+ * @param upage		Faulting virtual page.
+ */
+static void elf_fault_around(as_area_t *area, uintptr_t upage)
+{
+	elf_header_t *elf = area->backend_data.elf;
+	elf_segment_header_t *entry = area->backend_data.segment;
+	uintptr_t base = (uintptr_t)
+	    (((void *) elf) + ALIGN_DOWN(entry->p_offset, PAGE_SIZE));
+	uintptr_t start_anon = entry->p_vaddr + entry->p_filesz;
+	size_t j;
+
+	/*
+	 * Pages of a writable segment are copied and must go through the
+	 * regular fault handling one by one.
+	 */
+	if (entry->p_flags & PF_W)
+		return;
+
+	uintptr_t cluster = ALIGN_DOWN(upage, P2SZ(ELF_FAULT_AROUND_PAGES));
+
+	for (j = 0; j < ELF_FAULT_AROUND_PAGES; j++) {
+		uintptr_t page = cluster + P2SZ(j);
+		pte_t pte;
+
+		if (page == upage)
+			continue;
+
+		if ((page < area->base) ||
+		    (page >= area->base + P2SZ(area->pages)))
+			continue;
+
+		uintptr_t elfpage = elf_orig_page(area, page);
+
+		/*
+		 * Skip pages that are not fully backed by the initialized
+		 * portion of the segment.
+		 */
+		if ((elfpage < entry->p_vaddr) ||
+		    (elfpage + PAGE_SIZE > start_anon))
+			continue;
+
+		if (page_mapping_find(area->as, page, false, &pte))
+			continue;
+
+		size_t i = (elfpage - ALIGN_DOWN(entry->p_vaddr, PAGE_SIZE)) >>
+		    PAGE_WIDTH;
+
+		bool found = page_mapping_find(AS_KERNEL,
+		    base + i * FRAME_SIZE, true, &pte);
+
+		(void) found;
+		assert(found);
+		assert(PTE_PRESENT(&pte));
+
+		page_mapping_insert(area->as, page, PTE_GET_FRAME(&pte),
+		    as_area_get_flags(area));
+		if (!used_space_insert(&area->used_space, page, 1))
+			panic("Cannot insert used space.");
+	}
+}
+
 /** Service a page fault in the ELF backend address space area.
  *
  * The address space area and page tables must be already locked.
@@ -267,7 +342,7 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	size_t i;
 	bool dirty = false;
 
-	assert(page_table_locked(AS));
+	assert(page_table_locked(area->as));
 	assert(mutex_locked(&area->lock));
 	assert(IS_ALIGNED(upage, PAGE_SIZE));
 
@@ -300,7 +375,7 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		    upage - area->base, &frame);
 		if (rc == EOK) {
 			frame_reference_add(ADDR2PFN(frame));
-			page_mapping_insert(AS, upage, frame,
+			page_mapping_insert(area->as, upage, frame,
 			    as_area_get_flags(area));
 			if (!used_space_insert(&area->used_space, upage, 1))
 				panic("Cannot insert used space.");
@@ -396,10 +471,16 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 
 	mutex_unlock(&area->sh_info->lock);
 
-	page_mapping_insert(AS, upage, frame, as_area_get_flags(area));
+	page_mapping_insert(area->as, upage, frame, as_area_get_flags(area));
 	if (!used_space_insert(&area->used_space, upage, 1))
 		panic("Cannot insert used space.");
 
+	/*
+	 * Eagerly map the neighboring image-backed pages to reduce the
+	 * number of faults taken when the binary is cold-started.
+	 */
+	elf_fault_around(area, upage);
+
 	return AS_PF_OK;
 }
 
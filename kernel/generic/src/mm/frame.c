@@ -61,6 +61,8 @@
 #include <config.h>
 #include <str.h>
 #include <proc/thread.h> /* THREAD */
+#include <cpu.h> /* CPU */
+#include <debug/tracepoint.h>
 
 zones_t zones;
 
@@ -233,17 +235,22 @@ _NO_TRACE static bool zone_can_alloc(zone_t *zone, size_t count,
  * @param constraint Indication of bits that cannot be set in the
  *                   physical frame number of the first allocated frame.
  * @param hint       Preferred zone.
+ * @param node       Required NUMA node or (size_t) -1 for any node.
  *
  * @return Zone that can allocate specified number of frames.
  * @return -1 if no zone can satisfy the request.
  *
  */
 _NO_TRACE static size_t find_free_zone_all(size_t count, zone_flags_t flags,
-    pfn_t constraint, size_t hint)
+    pfn_t constraint, size_t hint, size_t node)
 {
 	for (size_t pos = 0; pos < zones.count; pos++) {
 		size_t i = (pos + hint) % zones.count;
 
+		/* Restrict the search to the requested node. */
+		if ((node != (size_t) -1) && (zones.info[i].node != node))
+			continue;
+
 		/* Check whether the zone meets the search criteria. */
 		if (!ZONE_FLAGS_MATCH(zones.info[i].flags, flags))
 			continue;
@@ -279,17 +286,22 @@ _NO_TRACE static bool is_high_priority(pfn_t base, size_t count)
  * @param constraint Indication of bits that cannot be set in the
  *                   physical frame number of the first allocated frame.
  * @param hint       Preferred zone.
+ * @param node       Required NUMA node or (size_t) -1 for any node.
  *
  * @return Zone that can allocate specified number of frames.
  * @return -1 if no low-priority zone can satisfy the request.
  *
  */
 _NO_TRACE static size_t find_free_zone_lowprio(size_t count, zone_flags_t flags,
-    pfn_t constraint, size_t hint)
+    pfn_t constraint, size_t hint, size_t node)
 {
 	for (size_t pos = 0; pos < zones.count; pos++) {
 		size_t i = (pos + hint) % zones.count;
 
+		/* Restrict the search to the requested node. */
+		if ((node != (size_t) -1) && (zones.info[i].node != node))
+			continue;
+
 		/* Skip zones containing only high-priority memory. */
 		if (is_high_priority(zones.info[i].base, zones.info[i].count))
 			continue;
@@ -316,13 +328,14 @@ _NO_TRACE static size_t find_free_zone_lowprio(size_t count, zone_flags_t flags,
  * @param constraint Indication of bits that cannot be set in the
  *                   physical frame number of the first allocated frame.
  * @param hint       Preferred zone.
+ * @param node       Required NUMA node or (size_t) -1 for any node.
  *
  * @return Zone that can allocate specified number of frames.
  * @return -1 if no zone can satisfy the request.
  *
  */
 _NO_TRACE static size_t find_free_zone(size_t count, zone_flags_t flags,
-    pfn_t constraint, size_t hint)
+    pfn_t constraint, size_t hint, size_t node)
 {
 	if (hint >= zones.count)
 		hint = 0;
@@ -332,12 +345,13 @@ _NO_TRACE static size_t find_free_zone(size_t count, zone_flags_t flags,
 	 * zones with high-priority memory.
 	 */
 
-	size_t znum = find_free_zone_lowprio(count, flags, constraint, hint);
+	size_t znum = find_free_zone_lowprio(count, flags, constraint, hint,
+	    node);
 	if (znum != (size_t) -1)
 		return znum;
 
 	/* Take all zones into account */
-	return find_free_zone_all(count, flags, constraint, hint);
+	return find_free_zone_all(count, flags, constraint, hint, node);
 }
 
 /*
@@ -658,6 +672,7 @@ _NO_TRACE static void zone_construct(zone_t *zone, pfn_t start, size_t count,
 	zone->base = start;
 	zone->count = count;
 	zone->flags = flags;
+	zone->node = 0;
 	zone->free_count = count;
 	zone->busy_count = 0;
 
@@ -810,6 +825,26 @@ size_t zone_create(pfn_t start, size_t count, pfn_t confframe,
 	return znum;
 }
 
+/** Assign a zone to a NUMA node.
+ *
+ * Called by architecture code once the memory topology is known.
+ * Allocations with FRAME_LOCAL prefer zones whose node matches the
+ * node of the requesting CPU.
+ *
+ * @param znum Zone number.
+ * @param node NUMA node the zone belongs to.
+ *
+ */
+void zone_set_node(size_t znum, unsigned int node)
+{
+	irq_spinlock_lock(&zones.lock, true);
+
+	if (znum < zones.count)
+		zones.info[znum].node = node;
+
+	irq_spinlock_unlock(&zones.lock, true);
+}
+
 /*
  * Frame functions
  */
@@ -846,17 +881,18 @@ void *frame_get_parent(pfn_t pfn, size_t hint)
 }
 
 static size_t try_find_zone(size_t count, bool lowmem,
-    pfn_t frame_constraint, size_t hint)
+    pfn_t frame_constraint, size_t hint, size_t node)
 {
 	if (!lowmem) {
 		size_t znum = find_free_zone(count,
-		    ZONE_HIGHMEM | ZONE_AVAILABLE, frame_constraint, hint);
+		    ZONE_HIGHMEM | ZONE_AVAILABLE, frame_constraint, hint,
+		    node);
 		if (znum != (size_t) -1)
 			return znum;
 	}
 
 	return find_free_zone(count, ZONE_LOWMEM | ZONE_AVAILABLE,
-	    frame_constraint, hint);
+	    frame_constraint, hint, node);
 }
 
 /** Allocate frames of physical memory.
@@ -875,6 +911,9 @@ uintptr_t frame_alloc_generic(size_t count, frame_flags_t flags,
 {
 	assert(count > 0);
 
+	tracepoint_emit(TRACE_EVENT_FRAME_ALLOC, (sysarg_t) count,
+	    (sysarg_t) flags);
+
 	size_t hint = pzone ? (*pzone) : 0;
 	pfn_t frame_constraint = ADDR2PFN(constraint);
 
@@ -890,10 +929,23 @@ loop:
 	// TODO: Print diagnostic if neither is explicitly specified.
 	bool lowmem = (flags & FRAME_LOWMEM) || !(flags & FRAME_HIGHMEM);
 
+	/*
+	 * With FRAME_LOCAL, restrict the first pass to zones on the
+	 * requesting CPU's NUMA node and only then consider remote nodes.
+	 */
+	size_t node = ((flags & FRAME_LOCAL) && (CPU != NULL)) ?
+	    CPU->node : (size_t) -1;
+
 	/*
 	 * First, find suitable frame zone.
 	 */
-	size_t znum = try_find_zone(count, lowmem, frame_constraint, hint);
+	size_t znum = try_find_zone(count, lowmem, frame_constraint, hint,
+	    node);
+
+	/* The local node is exhausted, fall back to the remote nodes. */
+	if ((znum == (size_t) -1) && (node != (size_t) -1))
+		znum = try_find_zone(count, lowmem, frame_constraint, hint,
+		    (size_t) -1);
 
 	/*
 	 * If no memory, reclaim some slab memory,
@@ -906,7 +958,7 @@ loop:
 
 		if (freed > 0)
 			znum = try_find_zone(count, lowmem,
-			    frame_constraint, hint);
+			    frame_constraint, hint, (size_t) -1);
 
 		if (znum == (size_t) -1) {
 			irq_spinlock_unlock(&zones.lock, true);
@@ -915,7 +967,7 @@ loop:
 
 			if (freed > 0)
 				znum = try_find_zone(count, lowmem,
-				    frame_constraint, hint);
+				    frame_constraint, hint, (size_t) -1);
 		}
 	}
 
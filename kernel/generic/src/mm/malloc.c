@@ -36,6 +36,7 @@
 #include <memw.h>
 #include <main/main.h> // malloc_init()
 #include <macros.h>
+#include <config.h>
 
 /** Minimum size to be allocated by malloc */
 #define SLAB_MIN_MALLOC_W  4
@@ -82,6 +83,33 @@ void malloc_init(void)
 	}
 }
 
+/** Warm up the caches of common allocation sizes.
+ *
+ * Called once the per-CPU magazine layer is available. Allocations in
+ * the 16 B - 4 KiB range make up the bulk of kernel malloc() traffic
+ * and are frequently requested from interrupt-adjacent paths, so
+ * widen their depot batches and stock their depots up front. This
+ * keeps such allocations on the per-CPU magazine fast path instead of
+ * falling through to the globally locked slab layer.
+ */
+void malloc_prefill(void)
+{
+	size_t i;
+	size_t size;
+
+	for (i = 0, size = (1 << SLAB_MIN_MALLOC_W);
+	    i < (SLAB_MAX_MALLOC_W - SLAB_MIN_MALLOC_W + 1);
+	    i++, size <<= 1) {
+		if (size > PAGE_SIZE)
+			continue;
+
+		slab_cache_set_depot_batch(malloc_caches[i],
+		    2 * SLAB_DEPOT_BATCH);
+		(void) slab_cache_prefill(malloc_caches[i],
+		    2 * SLAB_MAG_SIZE * config.cpu_count);
+	}
+}
+
 static void _check_sizes(size_t *alignment, size_t *size)
 {
 	assert(size);
@@ -367,6 +367,70 @@ _NO_TRACE static void put_mag_to_cache(slab_cache_t *cache,
 	irq_spinlock_unlock(&cache->maglock, true);
 }
 
+/** Take a batch of full magazines from the depot
+ *
+ * Removes up to cache->depot_batch full magazines under a single
+ * maglock acquisition. The first magazine is returned, the rest is
+ * stocked into the requesting CPU's spare list.
+ *
+ * Assumes mag_cache[CPU->id].lock is held.
+ *
+ */
+_NO_TRACE static slab_magazine_t *get_mag_batch_from_cache(slab_cache_t *cache)
+{
+	slab_mag_cache_t *mags = &cache->mag_cache[CPU->id];
+	slab_magazine_t *mag = NULL;
+
+	irq_spinlock_lock(&cache->maglock, true);
+
+	for (size_t i = 0; i < cache->depot_batch; i++) {
+		if (list_empty(&cache->magazines))
+			break;
+
+		slab_magazine_t *cur = list_get_instance(
+		    list_first(&cache->magazines), slab_magazine_t, link);
+		list_remove(&cur->link);
+		atomic_dec(&cache->magazine_counter);
+
+		if (mag == NULL) {
+			mag = cur;
+		} else {
+			list_append(&cur->link, &mags->spare);
+			mags->spare_count++;
+		}
+	}
+
+	irq_spinlock_unlock(&cache->maglock, true);
+
+	return mag;
+}
+
+/** Flush the CPU's spare magazines to the depot
+ *
+ * Returns all locally stocked full magazines under a single maglock
+ * acquisition.
+ *
+ * Assumes mag_cache[CPU->id].lock is held.
+ *
+ */
+_NO_TRACE static void put_mag_batch_to_cache(slab_cache_t *cache,
+    slab_mag_cache_t *mags)
+{
+	irq_spinlock_lock(&cache->maglock, true);
+
+	while (!list_empty(&mags->spare)) {
+		slab_magazine_t *mag = list_get_instance(
+		    list_first(&mags->spare), slab_magazine_t, link);
+		list_remove(&mag->link);
+		mags->spare_count--;
+
+		list_prepend(&mag->link, &cache->magazines);
+		atomic_inc(&cache->magazine_counter);
+	}
+
+	irq_spinlock_unlock(&cache->maglock, true);
+}
+
 /** Free all objects in magazine and free memory associated with magazine
  *
  * @return Number of freed pages
@@ -409,10 +473,21 @@ _NO_TRACE static slab_magazine_t *get_full_current_mag(slab_cache_t *cache)
 		}
 	}
 
-	/* Local magazines are empty, import one from magazine list */
-	slab_magazine_t *newmag = get_mag_from_cache(cache, 1);
-	if (!newmag)
-		return NULL;
+	/* Local magazines are empty, try the CPU's spare stock first. */
+	slab_mag_cache_t *mags = &cache->mag_cache[CPU->id];
+	slab_magazine_t *newmag;
+
+	if (mags->spare_count > 0) {
+		newmag = list_get_instance(list_first(&mags->spare),
+		    slab_magazine_t, link);
+		list_remove(&newmag->link);
+		mags->spare_count--;
+	} else {
+		/* Import a whole batch from the shared depot. */
+		newmag = get_mag_batch_from_cache(cache);
+		if (!newmag)
+			return NULL;
+	}
 
 	if (lastmag)
 		magazine_destroy(cache, lastmag);
@@ -492,9 +567,19 @@ _NO_TRACE static slab_magazine_t *make_empty_current_mag(slab_cache_t *cache)
 	newmag->size = SLAB_MAG_SIZE;
 	newmag->busy = 0;
 
-	/* Flush last to magazine list */
-	if (lastmag)
-		put_mag_to_cache(cache, lastmag);
+	/*
+	 * Flush last to the CPU's spare stock; the stock is returned to
+	 * the depot in one go once a whole batch accumulates.
+	 */
+	if (lastmag) {
+		slab_mag_cache_t *mags = &cache->mag_cache[CPU->id];
+
+		list_prepend(&lastmag->link, &mags->spare);
+		mags->spare_count++;
+
+		if (mags->spare_count >= cache->depot_batch)
+			put_mag_batch_to_cache(cache, mags);
+	}
 
 	/* Move current as last, save new as current */
 	cache->mag_cache[CPU->id].last = cmag;
@@ -574,6 +659,7 @@ _NO_TRACE static bool make_magcache(slab_cache_t *cache)
 	size_t i;
 	for (i = 0; i < config.cpu_count; i++) {
 		memsetb(&cache->mag_cache[i], sizeof(cache->mag_cache[i]), 0);
+		list_initialize(&cache->mag_cache[i].spare);
 		irq_spinlock_initialize(&cache->mag_cache[i].lock,
 		    "slab.cache.mag_cache[].lock");
 	}
@@ -602,6 +688,7 @@ _NO_TRACE static void _slab_cache_create(slab_cache_t *cache, const char *name,
 	cache->constructor = constructor;
 	cache->destructor = destructor;
 	cache->flags = flags;
+	cache->depot_batch = SLAB_DEPOT_BATCH;
 
 	list_initialize(&cache->full_slabs);
 	list_initialize(&cache->partial_slabs);
@@ -652,6 +739,69 @@ slab_cache_t *slab_cache_create(const char *name, size_t size, size_t align,
 	return cache;
 }
 
+/** Set the number of magazines moved per depot lock acquisition
+ *
+ * Hot caches benefit from a larger batch, caches of large objects
+ * may want to keep the default to limit per-CPU stock.
+ *
+ */
+void slab_cache_set_depot_batch(slab_cache_t *cache, size_t batch)
+{
+	if (batch == 0)
+		batch = 1;
+
+	cache->depot_batch = batch;
+}
+
+/** Warm up a cache by stocking its depot with full magazines
+ *
+ * Intended to be called during boot for caches with known burst
+ * usage (e.g. IPC structures) so that the first storms of
+ * allocations are served from magazines instead of the slab layer.
+ *
+ * @param cache   Cache to be prefilled.
+ * @param objects Number of objects to prefill.
+ *
+ * @return Number of objects actually stocked.
+ *
+ */
+size_t slab_cache_prefill(slab_cache_t *cache, size_t objects)
+{
+	if (cache->flags & SLAB_CACHE_NOMAGAZINE)
+		return 0;
+
+	size_t filled = 0;
+
+	while (filled < objects) {
+		slab_magazine_t *mag = slab_alloc(&mag_cache,
+		    FRAME_ATOMIC | FRAME_NO_RECLAIM);
+		if (!mag)
+			break;
+
+		mag->size = SLAB_MAG_SIZE;
+		mag->busy = 0;
+
+		while ((mag->busy < mag->size) && (filled < objects)) {
+			void *obj = slab_obj_create(cache, FRAME_ATOMIC);
+			if (!obj)
+				break;
+
+			mag->objs[mag->busy++] = obj;
+			atomic_inc(&cache->cached_objs);
+			filled++;
+		}
+
+		if (mag->busy == 0) {
+			slab_free(&mag_cache, mag);
+			break;
+		}
+
+		put_mag_to_cache(cache, mag);
+	}
+
+	return filled;
+}
+
 /** Reclaim space occupied by objects that are already free
  *
  * @param flags If contains SLAB_RECLAIM_ALL, do aggressive freeing
@@ -696,6 +846,15 @@ _NO_TRACE static size_t _slab_reclaim(slab_cache_t *cache, unsigned int flags)
 				frames += magazine_destroy(cache, mag);
 			cache->mag_cache[i].last = NULL;
 
+			while (!list_empty(&cache->mag_cache[i].spare)) {
+				mag = list_get_instance(
+				    list_first(&cache->mag_cache[i].spare),
+				    slab_magazine_t, link);
+				list_remove(&mag->link);
+				frames += magazine_destroy(cache, mag);
+			}
+			cache->mag_cache[i].spare_count = 0;
+
 			irq_spinlock_unlock(&cache->mag_cache[i].lock, true);
 		}
 	}
@@ -41,6 +41,8 @@
 
 #include <mm/tlb.h>
 #include <mm/asid.h>
+#include <mm/page.h>
+#include <macros.h>
 #include <arch/mm/tlb.h>
 #include <assert.h>
 #include <smp/ipi.h>
@@ -67,6 +69,102 @@ void tlb_init(void)
  */
 IRQ_SPINLOCK_STATIC_INITIALIZE(tlblock);
 
+/** Replace the contents of a message queue with one TLB_INVL_ALL message.
+ *
+ * Assume cpu->tlb_lock is held.
+ *
+ * @param cpu CPU whose message queue is to be erased.
+ *
+ */
+static void tlb_degrade_to_invl_all(cpu_t *cpu)
+{
+	cpu->tlb_messages_count = 1;
+	cpu->tlb_messages[0].type = TLB_INVL_ALL;
+	cpu->tlb_messages[0].asid = ASID_INVALID;
+	cpu->tlb_messages[0].page = 0;
+	cpu->tlb_messages[0].count = 0;
+}
+
+/** Enqueue one TLB shootdown message into a CPU's message queue.
+ *
+ * The message is coalesced with the already queued ones whenever
+ * possible: overlapping or adjacent page runs of the same address
+ * space are merged into a single range message and requests covered
+ * by a broader pending invalidation are dropped. Assume cpu->tlb_lock
+ * is held.
+ *
+ * @param cpu   CPU to deliver the message to.
+ * @param type  Type describing scope of shootdown.
+ * @param asid  Address space, if required by type.
+ * @param page  Virtual page address, if required by type.
+ * @param count Number of pages, if required by type.
+ *
+ */
+static void tlb_shootdown_enqueue(cpu_t *cpu, tlb_invalidate_type_t type,
+    asid_t asid, uintptr_t page, size_t count)
+{
+	if (type == TLB_INVL_ALL) {
+		tlb_degrade_to_invl_all(cpu);
+		return;
+	}
+
+	for (size_t idx = 0; idx < cpu->tlb_messages_count; idx++) {
+		tlb_shootdown_msg_t *msg = &cpu->tlb_messages[idx];
+
+		/* Already covered by a pending full invalidation. */
+		if (msg->type == TLB_INVL_ALL)
+			return;
+
+		if (msg->asid != asid)
+			continue;
+
+		/* Already covered by a pending ASID invalidation. */
+		if (msg->type == TLB_INVL_ASID)
+			return;
+
+		if (type == TLB_INVL_ASID) {
+			/* Subsume the pending page run. */
+			msg->type = TLB_INVL_ASID;
+			msg->page = 0;
+			msg->count = 0;
+			return;
+		}
+
+		assert(msg->type == TLB_INVL_PAGES);
+
+		/* Merge overlapping or adjacent page runs. */
+		uintptr_t start = msg->page;
+		uintptr_t end = msg->page + P2SZ(msg->count);
+
+		if ((page <= end) && (start <= page + P2SZ(count))) {
+			uintptr_t nstart = min(start, page);
+			uintptr_t nend = max(end, page + P2SZ(count));
+
+			msg->page = nstart;
+			msg->count = (nend - nstart) >> PAGE_WIDTH;
+			return;
+		}
+	}
+
+	if (cpu->tlb_messages_count == TLB_MESSAGE_QUEUE_LEN) {
+		/*
+		 * The message queue is full.
+		 * Erase the queue and store one TLB_INVL_ALL message.
+		 */
+		tlb_degrade_to_invl_all(cpu);
+		return;
+	}
+
+	/*
+	 * Enqueue the message.
+	 */
+	size_t idx = cpu->tlb_messages_count++;
+	cpu->tlb_messages[idx].type = type;
+	cpu->tlb_messages[idx].asid = asid;
+	cpu->tlb_messages[idx].page = page;
+	cpu->tlb_messages[idx].count = count;
+}
+
 /** Send TLB shootdown message.
  *
  * This function attempts to deliver TLB shootdown message
@@ -95,26 +193,7 @@ ipl_t tlb_shootdown_start(tlb_invalidate_type_t type, asid_t asid,
 		cpu_t *cpu = &cpus[i];
 
 		irq_spinlock_lock(&cpu->tlb_lock, false);
-		if (cpu->tlb_messages_count == TLB_MESSAGE_QUEUE_LEN) {
-			/*
-			 * The message queue is full.
-			 * Erase the queue and store one TLB_INVL_ALL message.
-			 */
-			cpu->tlb_messages_count = 1;
-			cpu->tlb_messages[0].type = TLB_INVL_ALL;
-			cpu->tlb_messages[0].asid = ASID_INVALID;
-			cpu->tlb_messages[0].page = 0;
-			cpu->tlb_messages[0].count = 0;
-		} else {
-			/*
-			 * Enqueue the message.
-			 */
-			size_t idx = cpu->tlb_messages_count++;
-			cpu->tlb_messages[idx].type = type;
-			cpu->tlb_messages[idx].asid = asid;
-			cpu->tlb_messages[idx].page = page;
-			cpu->tlb_messages[idx].count = count;
-		}
+		tlb_shootdown_enqueue(cpu, type, asid, page, count);
 		irq_spinlock_unlock(&cpu->tlb_lock, false);
 	}
 
@@ -59,6 +59,9 @@
  */
 void *program_loader = NULL;
 
+/** Size of the entry-point region prefaulted at program creation time. */
+#define ENTRY_PREFAULT_SIZE	(16 * PAGE_SIZE)
+
 /** Create a program using an existing address space.
  *
  * @param as         Address space containing a binary program image.
@@ -103,6 +106,12 @@ errno_t program_create(as_t *as, uspace_addr_t entry_addr, char *name, program_t
 		return ENOMEM;
 	}
 
+	/*
+	 * Prefault the region around the entry point so that the task
+	 * does not start by taking a fault per page of its text.
+	 */
+	as_area_prefault(as, (uintptr_t) entry_addr, ENTRY_PREFAULT_SIZE);
+
 	kernel_uarg->uspace_entry = entry_addr;
 	kernel_uarg->uspace_stack = virt;
 	kernel_uarg->uspace_stack_size = STACK_SIZE_USER;
@@ -61,12 +61,18 @@
 #include <adt/list.h>
 #include <panic.h>
 #include <cpu.h>
+#include <debug/tracepoint.h>
+#include <pmu/pmu.h>
 #include <stdio.h>
 #include <log.h>
 #include <stacktrace.h>
 
 atomic_size_t nrdy;  /**< Number of ready threads in the system. */
 
+#ifdef CONFIG_SMP
+static bool try_steal_thread(void);
+#endif
+
 #ifdef CONFIG_FPU_LAZY
 void scheduler_fpu_lazy_request(void)
 {
@@ -104,6 +110,74 @@ void scheduler_init(void)
 {
 }
 
+/** Push a thread woken up on a remote CPU to that CPU's wakeup inbox.
+ *
+ * Lock-free multi-producer push. The thread becomes ready on the target
+ * CPU without the producer ever touching the target's run queue locks,
+ * which removes the wakeup-path contention between remote wakers and
+ * the local scheduler.
+ */
+static void wakeup_inbox_push(cpu_t *cpu, thread_t *thread)
+{
+	thread->wakeup_link = atomic_load_explicit(&cpu->wakeup_inbox,
+	    memory_order_relaxed);
+
+	while (!atomic_compare_exchange_weak_explicit(&cpu->wakeup_inbox,
+	    &thread->wakeup_link, thread,
+	    memory_order_release, memory_order_relaxed))
+		;
+
+	atomic_inc(&nrdy);
+	atomic_inc(&cpu->nrdy);
+}
+
+/** Drain the local CPU's wakeup inbox into its run queues.
+ *
+ * Single-consumer counterpart of wakeup_inbox_push(). Only ever called
+ * by the owning CPU with interrupts disabled.
+ */
+static void wakeup_inbox_drain(void)
+{
+	assert(interrupts_disabled());
+
+	thread_t *thread = atomic_exchange_explicit(&CPU->wakeup_inbox, NULL,
+	    memory_order_acquire);
+
+	if (thread == NULL)
+		return;
+
+	/*
+	 * The inbox is a LIFO stack. Reverse it first so that threads
+	 * become ready in the order in which they were woken up.
+	 */
+	thread_t *reversed = NULL;
+
+	while (thread != NULL) {
+		thread_t *next = thread->wakeup_link;
+		thread->wakeup_link = reversed;
+		reversed = thread;
+		thread = next;
+	}
+
+	while (reversed != NULL) {
+		thread_t *next = reversed->wakeup_link;
+		reversed->wakeup_link = NULL;
+
+		/*
+		 * Woken threads always start at the highest priority.
+		 * The nrdy counters were already incremented by the producer.
+		 */
+		runq_t *rq = &CPU->rq[0];
+
+		irq_spinlock_lock(&rq->lock, false);
+		list_append(&reversed->rq_link, &rq->rq);
+		rq->n++;
+		irq_spinlock_unlock(&rq->lock, false);
+
+		reversed = next;
+	}
+}
+
 /** Get thread to be scheduled
  *
  * Get the optimal thread to be scheduled
@@ -118,6 +192,8 @@ static thread_t *try_find_thread(int *rq_index)
 	assert(interrupts_disabled());
 	assert(CPU != NULL);
 
+	wakeup_inbox_drain();
+
 	if (atomic_load(&CPU->nrdy) == 0)
 		return NULL;
 
@@ -171,6 +247,17 @@ static thread_t *find_best_thread(int *rq_index)
 		if (thread != NULL)
 			return thread;
 
+#ifdef CONFIG_SMP
+		/*
+		 * The local run queues are empty. Before going idle, try to
+		 * pull a thread from the busiest CPU. This reacts to bursty
+		 * load much faster than the periodic kcpulb thread, which is
+		 * kept only as a fallback correcting long-term imbalance.
+		 */
+		if (try_steal_thread())
+			continue;
+#endif
+
 		/*
 		 * For there was nothing to run, the CPU goes to sleep
 		 * until a hardware interrupt or an IPI comes.
@@ -201,14 +288,18 @@ static void switch_task(task_t *task)
 	if (old_as != new_as)
 		as_switch(old_as, new_as);
 
-	if (TASK)
+	if (TASK) {
+		pmu_preempt(TASK);
 		task_release(TASK);
+	}
 
 	TASK = task;
 
 	task_hold(TASK);
 
 	before_task_runs_arch();
+
+	pmu_resume(TASK);
 }
 
 /** Prevent rq starvation
@@ -415,7 +506,15 @@ void thread_requeue_sleeping(thread_t *thread)
 		atomic_set_unordered(&thread->cpu, CPU);
 	}
 
-	add_to_rq(thread, cpu, 0);
+	if (cpu == CPU) {
+		add_to_rq(thread, cpu, 0);
+	} else {
+		/*
+		 * Remote wakeup. Enqueue through the target CPU's lock-free
+		 * inbox instead of contending for its run queue lock.
+		 */
+		wakeup_inbox_push(cpu, thread);
+	}
 
 	interrupts_restore(ipl);
 }
@@ -475,6 +574,9 @@ void scheduler_enter(state_t new_state)
 	assert(CPU != NULL);
 	assert(THREAD != NULL);
 
+	tracepoint_emit(TRACE_EVENT_SCHEDULER_ENTER, (sysarg_t) THREAD->tid,
+	    (sysarg_t) new_state);
+
 	if (atomic_load(&haltstate))
 		halt();
 
@@ -680,6 +782,51 @@ static thread_t *steal_thread_from(cpu_t *old_cpu, int i)
 	return NULL;
 }
 
+/** Steal a thread from the busiest CPU.
+ *
+ * Event-driven counterpart of kcpulb. Invoked by an idle CPU from the
+ * scheduler as soon as its run queues become empty, so that runnable
+ * threads do not sit on other CPUs while this one sleeps.
+ *
+ * @return True if a thread was migrated to a local run queue.
+ */
+static bool try_steal_thread(void)
+{
+	assert(interrupts_disabled());
+	assert(CPU != NULL);
+
+	/* Find the busiest remote CPU. */
+	cpu_t *busiest = NULL;
+	size_t busiest_nrdy = 0;
+
+	for (size_t acpu = 0; acpu < config.cpu_active; acpu++) {
+		cpu_t *cpu = &cpus[acpu];
+
+		if (cpu == CPU)
+			continue;
+
+		size_t cpu_nrdy = atomic_load(&cpu->nrdy);
+		if (cpu_nrdy > busiest_nrdy) {
+			busiest = cpu;
+			busiest_nrdy = cpu_nrdy;
+		}
+	}
+
+	if (busiest == NULL)
+		return false;
+
+	/*
+	 * Search the victim's queues from the least priority one, taking
+	 * threads from the tail, i.e. those that would run there last.
+	 */
+	for (int rq = RQ_COUNT - 1; rq >= 0; rq--) {
+		if (steal_thread_from(busiest, rq) != NULL)
+			return true;
+	}
+
+	return false;
+}
+
 /** Load balancing thread
  *
  * SMP load balancing thread, supervising thread supplies
@@ -41,6 +41,7 @@
 #include <proc/task.h>
 #include <mm/as.h>
 #include <mm/slab.h>
+#include <pmu/pmu.h>
 #include <atomic.h>
 #include <synch/spinlock.h>
 #include <synch/waitq.h>
@@ -59,23 +60,36 @@
 #include <syscall/copy.h>
 #include <macros.h>
 
-/** Spinlock protecting the @c tasks ordered dictionary. */
-IRQ_SPINLOCK_INITIALIZE(tasks_lock);
+/** Number of task registry shards. Must be a power of two. */
+#define TASKS_SHARDS  16
 
-/** Ordered dictionary of active tasks by task ID.
+/** One shard of the task registry. */
+typedef struct {
+	/** Spinlock protecting the @c tasks ordered dictionary. */
+	IRQ_SPINLOCK_DECLARE(lock);
+	/** Ordered dictionary of active tasks by task ID. */
+	odict_t tasks;
+} task_shard_t;
+
+/** Task registry, sharded by task ID.
  *
- * Members are task_t structures.
+ * Members of the shard dictionaries are task_t structures. Updates and
+ * lookups take only the lock of the respective shard; walking the whole
+ * registry requires all shard locks (see task_registry_lock()).
  *
- * The task is guaranteed to exist after it was found in the @c tasks
- * dictionary as long as:
+ * The task is guaranteed to exist after it was found in the registry
+ * as long as:
  *
- * @li the tasks_lock is held,
+ * @li the lock of the task's shard is held,
  * @li the task's lock is held when task's lock is acquired before releasing
- *     tasks_lock or
+ *     the shard lock or
  * @li the task's refcount is greater than 0
  *
  */
-odict_t tasks;
+static task_shard_t task_shards[TASKS_SHARDS];
+
+/** Spinlock protecting the @c task_counter. */
+IRQ_SPINLOCK_STATIC_INITIALIZE(taskid_lock);
 
 static task_id_t task_counter = 0;
 
@@ -89,13 +103,58 @@ static size_t tsk_destructor(void *);
 static void *tasks_getkey(odlink_t *);
 static int tasks_cmp(void *, void *);
 
+/** Get the registry shard responsible for the given task ID.
+ *
+ * Task IDs are assigned sequentially, so the low-order bits spread the
+ * tasks evenly across the shards.
+ *
+ * @param id Task ID.
+ * @return Registry shard.
+ */
+static task_shard_t *task_shard(task_id_t id)
+{
+	return &task_shards[id & (TASKS_SHARDS - 1)];
+}
+
+/** Lock the entire task registry.
+ *
+ * Required for walking the registry via task_first()/task_next() and for
+ * task_count(). The shards are always locked in ascending order to prevent
+ * deadlock.
+ *
+ */
+void task_registry_lock(void)
+{
+	irq_spinlock_lock(&task_shards[0].lock, true);
+
+	for (size_t i = 1; i < TASKS_SHARDS; i++)
+		irq_spinlock_lock(&task_shards[i].lock, false);
+}
+
+/** Unlock the entire task registry.
+ *
+ */
+void task_registry_unlock(void)
+{
+	for (size_t i = TASKS_SHARDS - 1; i > 0; i--)
+		irq_spinlock_unlock(&task_shards[i].lock, false);
+
+	irq_spinlock_unlock(&task_shards[0].lock, true);
+}
+
 /** Initialize kernel tasks support.
  *
  */
 void task_init(void)
 {
 	TASK = NULL;
-	odict_initialize(&tasks, tasks_getkey, tasks_cmp);
+
+	for (size_t i = 0; i < TASKS_SHARDS; i++) {
+		irq_spinlock_initialize(&task_shards[i].lock, "tasks_lock");
+		odict_initialize(&task_shards[i].tasks, tasks_getkey,
+		    tasks_cmp);
+	}
+
 	task_cache = slab_cache_create("task_t", sizeof(task_t), 0,
 	    tsk_constructor, tsk_destructor, 0);
 }
@@ -123,7 +182,7 @@ void task_done(void)
 #ifdef CONFIG_DEBUG
 		printf("Killing tasks... ");
 #endif
-		irq_spinlock_lock(&tasks_lock, true);
+		task_registry_lock();
 		tasks_left = 0;
 
 		task = task_first();
@@ -139,7 +198,7 @@ void task_done(void)
 			task = task_next(task);
 		}
 
-		irq_spinlock_unlock(&tasks_lock, true);
+		task_registry_unlock();
 
 		thread_sleep(1);
 
@@ -221,6 +280,8 @@ task_t *task_create(as_t *as, const char *name)
 	task->ipc_info.irq_notif_received = 0;
 	task->ipc_info.forwarded = 0;
 
+	pmu_task_init(task);
+
 	event_task_init(task);
 
 	task->answerbox.active = true;
@@ -252,13 +313,18 @@ task_t *task_create(as_t *as, const char *name)
 		(void) ipc_phone_connect(phone_obj->phone, ipc_box_0);
 	}
 
-	irq_spinlock_lock(&tasks_lock, true);
-
+	irq_spinlock_lock(&taskid_lock, true);
 	task->taskid = ++task_counter;
+	irq_spinlock_unlock(&taskid_lock, true);
+
+	task_shard_t *shard = task_shard(task->taskid);
+
+	irq_spinlock_lock(&shard->lock, true);
+
 	odlink_initialize(&task->ltasks);
-	odict_insert(&task->ltasks, &tasks, NULL);
+	odict_insert(&task->ltasks, &shard->tasks, NULL);
 
-	irq_spinlock_unlock(&tasks_lock, true);
+	irq_spinlock_unlock(&shard->lock, true);
 
 	return task;
 }
@@ -271,11 +337,13 @@ task_t *task_create(as_t *as, const char *name)
 static void task_destroy(task_t *task)
 {
 	/*
-	 * Remove the task from the task odict.
+	 * Remove the task from its registry shard.
 	 */
-	irq_spinlock_lock(&tasks_lock, true);
+	task_shard_t *shard = task_shard(task->taskid);
+
+	irq_spinlock_lock(&shard->lock, true);
 	odict_remove(&task->ltasks);
-	irq_spinlock_unlock(&tasks_lock, true);
+	irq_spinlock_unlock(&shard->lock, true);
 
 	/*
 	 * Perform architecture specific task destruction.
@@ -381,18 +449,19 @@ sys_errno_t sys_task_set_name(const uspace_ptr_char uspace_name, size_t name_len
 
 	/*
 	 * As the task name is referenced also from the
-	 * threads, lock the threads' lock for the course
+	 * threads, lock the task's registry shard for the course
 	 * of the update.
 	 */
+	task_shard_t *shard = task_shard(TASK->taskid);
 
-	irq_spinlock_lock(&tasks_lock, true);
+	irq_spinlock_lock(&shard->lock, true);
 	irq_spinlock_lock(&TASK->lock, false);
 
 	/* Set task name */
 	str_cpy(TASK->name, TASK_NAME_BUFLEN, namebuf);
 
 	irq_spinlock_unlock(&TASK->lock, false);
-	irq_spinlock_unlock(&tasks_lock, true);
+	irq_spinlock_unlock(&shard->lock, true);
 
 	return EOK;
 }
@@ -415,6 +484,9 @@ sys_errno_t sys_task_kill(uspace_ptr_task_id_t uspace_taskid)
 }
 
 /** Find task structure corresponding to task ID.
+ *
+ * Only the lock of the shard responsible for @a id is taken, so lookups
+ * do not contend with updates or lookups in the other shards.
  *
  * @param id Task ID.
  *
@@ -424,10 +496,11 @@ sys_errno_t sys_task_kill(uspace_ptr_task_id_t uspace_taskid)
 task_t *task_find_by_id(task_id_t id)
 {
 	task_t *task = NULL;
+	task_shard_t *shard = task_shard(id);
 
-	irq_spinlock_lock(&tasks_lock, true);
+	irq_spinlock_lock(&shard->lock, true);
 
-	odlink_t *odlink = odict_find_eq(&tasks, &id, NULL);
+	odlink_t *odlink = odict_find_eq(&shard->tasks, &id, NULL);
 	if (odlink != NULL) {
 		task = odict_get_instance(odlink, task_t, ltasks);
 
@@ -441,24 +514,36 @@ task_t *task_find_by_id(task_id_t id)
 			task = NULL;
 	}
 
-	irq_spinlock_unlock(&tasks_lock, true);
+	irq_spinlock_unlock(&shard->lock, true);
 
 	return task;
 }
 
 /** Get count of tasks.
+ *
+ * The entire task registry must be locked (see task_registry_lock()).
  *
  * @return Number of tasks in the system
  */
 size_t task_count(void)
 {
+	size_t count = 0;
+
 	assert(interrupts_disabled());
-	assert(irq_spinlock_locked(&tasks_lock));
 
-	return odict_count(&tasks);
+	for (size_t i = 0; i < TASKS_SHARDS; i++) {
+		assert(irq_spinlock_locked(&task_shards[i].lock));
+		count += odict_count(&task_shards[i].tasks);
+	}
+
+	return count;
 }
 
-/** Get first task (task with lowest ID).
+/** Get first task.
+ *
+ * The entire task registry must be locked (see task_registry_lock()).
+ * Note that the registry is walked shard by shard, so the tasks are
+ * not visited in global task ID order.
  *
  * @return Pointer to first task or @c NULL if there are none.
  */
@@ -467,16 +552,21 @@ task_t *task_first(void)
 	odlink_t *odlink;
 
 	assert(interrupts_disabled());
-	assert(irq_spinlock_locked(&tasks_lock));
 
-	odlink = odict_first(&tasks);
-	if (odlink == NULL)
-		return NULL;
+	for (size_t i = 0; i < TASKS_SHARDS; i++) {
+		assert(irq_spinlock_locked(&task_shards[i].lock));
+
+		odlink = odict_first(&task_shards[i].tasks);
+		if (odlink != NULL)
+			return odict_get_instance(odlink, task_t, ltasks);
+	}
 
-	return odict_get_instance(odlink, task_t, ltasks);
+	return NULL;
 }
 
-/** Get next task (with higher task ID).
+/** Get next task.
+ *
+ * The entire task registry must be locked (see task_registry_lock()).
  *
  * @param cur Current task
  * @return Pointer to next task or @c NULL if there are no more tasks.
@@ -484,15 +574,24 @@ task_t *task_first(void)
 task_t *task_next(task_t *cur)
 {
 	odlink_t *odlink;
+	size_t i = cur->taskid & (TASKS_SHARDS - 1);
 
 	assert(interrupts_disabled());
-	assert(irq_spinlock_locked(&tasks_lock));
+	assert(irq_spinlock_locked(&task_shards[i].lock));
 
-	odlink = odict_next(&cur->ltasks, &tasks);
-	if (odlink == NULL)
-		return NULL;
+	odlink = odict_next(&cur->ltasks, &task_shards[i].tasks);
+	if (odlink != NULL)
+		return odict_get_instance(odlink, task_t, ltasks);
+
+	for (i++; i < TASKS_SHARDS; i++) {
+		assert(irq_spinlock_locked(&task_shards[i].lock));
+
+		odlink = odict_first(&task_shards[i].tasks);
+		if (odlink != NULL)
+			return odict_get_instance(odlink, task_t, ltasks);
+	}
 
-	return odict_get_instance(odlink, task_t, ltasks);
+	return NULL;
 }
 
 /** Get accounting data of given task.
@@ -655,7 +754,7 @@ static void task_print(task_t *task, bool additional)
 void task_print_list(bool additional)
 {
 	/* Messing with task structures, avoid deadlock */
-	irq_spinlock_lock(&tasks_lock, true);
+	task_registry_lock();
 
 #ifdef __32_BITS__
 	if (additional)
@@ -682,7 +781,7 @@ void task_print_list(bool additional)
 		task = task_next(task);
 	}
 
-	irq_spinlock_unlock(&tasks_lock, true);
+	task_registry_unlock();
 }
 
 /** Get key function for the @c tasks ordered dictionary.
@@ -51,6 +51,7 @@
 #include <cpu.h>
 #include <str.h>
 #include <context.h>
+#include <adt/hash.h>
 #include <adt/list.h>
 #include <adt/odict.h>
 #include <time/clock.h>
@@ -80,24 +81,33 @@ const char *thread_states[] = {
 	"Lingering"
 };
 
-/** Lock protecting the @c threads ordered dictionary .
- *
- * For locking rules, see declaration thereof.
- */
-IRQ_SPINLOCK_INITIALIZE(threads_lock);
+/** Number of thread registry shards. Must be a power of two. */
+#define THREADS_SHARDS  16
+
+/** One shard of the thread registry. */
+typedef struct {
+	/** Lock protecting the @c threads ordered dictionary. */
+	IRQ_SPINLOCK_DECLARE(lock);
+	/** Ordered dictionary of threads by their address (i.e. pointer to
+	 * the thread_t structure).
+	 */
+	odict_t threads;
+} thread_shard_t;
 
-/** Ordered dictionary of all threads by their address (i.e. pointer to
- * the thread_t structure).
+/** Thread registry, sharded by thread structure address.
  *
- * When a thread is found in the @c threads ordered dictionary, it is
- * guaranteed to exist as long as the @c threads_lock is held.
+ * Members of the shard dictionaries are of type thread_t. Updates and
+ * lookups take only the lock of the respective shard; walking the whole
+ * registry requires all shard locks (see thread_registry_lock()).
  *
- * Members are of type thread_t.
+ * When a thread is found in the registry, it is guaranteed to exist as
+ * long as the lock of its shard is held.
  *
- * This structure contains weak references. Any reference from it must not leave
- * threads_lock critical section unless strengthened via thread_try_ref().
+ * This structure contains weak references. Any reference from it must not
+ * leave the shard lock critical section unless strengthened via
+ * thread_try_ref().
  */
-odict_t threads;
+static thread_shard_t thread_shards[THREADS_SHARDS];
 
 IRQ_SPINLOCK_STATIC_INITIALIZE(tidlock);
 static thread_id_t last_tid = 0;
@@ -107,6 +117,48 @@ static slab_cache_t *thread_cache;
 static void *threads_getkey(odlink_t *);
 static int threads_cmp(void *, void *);
 
+/** Get the registry shard responsible for the given thread.
+ *
+ * The registry is keyed by thread structure address so that the shard can
+ * be determined without dereferencing the (possibly weak) pointer. The
+ * address bits are mixed to spread the slab-allocated structures evenly
+ * across the shards.
+ *
+ * @param thread Thread (weak reference suffices).
+ * @return Registry shard.
+ */
+static thread_shard_t *thread_shard(thread_t *thread)
+{
+	return &thread_shards[hash_mix((uintptr_t) thread) &
+	    (THREADS_SHARDS - 1)];
+}
+
+/** Lock the entire thread registry.
+ *
+ * Required for walking the registry via thread_first()/thread_next(), for
+ * thread_count() and for thread_find_by_id(). The shards are always locked
+ * in ascending order to prevent deadlock.
+ *
+ */
+void thread_registry_lock(void)
+{
+	irq_spinlock_lock(&thread_shards[0].lock, true);
+
+	for (size_t i = 1; i < THREADS_SHARDS; i++)
+		irq_spinlock_lock(&thread_shards[i].lock, false);
+}
+
+/** Unlock the entire thread registry.
+ *
+ */
+void thread_registry_unlock(void)
+{
+	for (size_t i = THREADS_SHARDS - 1; i > 0; i--)
+		irq_spinlock_unlock(&thread_shards[i].lock, false);
+
+	irq_spinlock_unlock(&thread_shards[0].lock, true);
+}
+
 /** Initialization and allocation for thread_t structure
  *
  */
@@ -117,6 +169,7 @@ static errno_t thr_constructor(void *obj, unsigned int kmflags)
 	link_initialize(&thread->rq_link);
 	link_initialize(&thread->wq_link);
 	link_initialize(&thread->th_link);
+	thread->wakeup_link = NULL;
 
 	/* call the architecture-specific part of the constructor */
 	thr_constructor_arch(thread);
@@ -185,7 +238,12 @@ void thread_init(void)
 	thread_cache = slab_cache_create("thread_t", sizeof(thread_t), _Alignof(thread_t),
 	    thr_constructor, thr_destructor, 0);
 
-	odict_initialize(&threads, threads_getkey, threads_cmp);
+	for (size_t i = 0; i < THREADS_SHARDS; i++) {
+		irq_spinlock_initialize(&thread_shards[i].lock,
+		    "threads_lock");
+		odict_initialize(&thread_shards[i].threads, threads_getkey,
+		    threads_cmp);
+	}
 }
 
 /** Wire thread to the given CPU
@@ -315,10 +373,12 @@ static void thread_destroy(void *obj)
 
 	ipl_t ipl = interrupts_disable();
 
-	/* Remove thread from global list. */
-	irq_spinlock_lock(&threads_lock, false);
+	/* Remove thread from its registry shard. */
+	thread_shard_t *shard = thread_shard(thread);
+
+	irq_spinlock_lock(&shard->lock, false);
 	odict_remove(&thread->lthreads);
-	irq_spinlock_unlock(&threads_lock, false);
+	irq_spinlock_unlock(&shard->lock, false);
 
 	/* Remove thread from task's list and accumulate accounting. */
 	irq_spinlock_lock(&thread->task->lock, false);
@@ -405,11 +465,13 @@ void thread_attach(thread_t *thread, task_t *task)
 	irq_spinlock_unlock(&task->lock, false);
 
 	/*
-	 * Register this thread in the system-wide dictionary.
+	 * Register this thread in the system-wide registry.
 	 */
-	irq_spinlock_lock(&threads_lock, false);
-	odict_insert(&thread->lthreads, &threads, NULL);
-	irq_spinlock_unlock(&threads_lock, false);
+	thread_shard_t *shard = thread_shard(thread);
+
+	irq_spinlock_lock(&shard->lock, false);
+	odict_insert(&thread->lthreads, &shard->threads, NULL);
+	irq_spinlock_unlock(&shard->lock, false);
 
 	interrupts_restore(ipl);
 }
@@ -727,7 +789,7 @@ void thread_print_list(bool additional)
 	thread_t *thread;
 
 	/* Accessing system-wide threads list through thread_first()/thread_next(). */
-	irq_spinlock_lock(&threads_lock, true);
+	thread_registry_lock();
 
 	if (sizeof(void *) <= 4) {
 		if (additional)
@@ -751,20 +813,26 @@ void thread_print_list(bool additional)
 		thread = thread_next(thread);
 	}
 
-	irq_spinlock_unlock(&threads_lock, true);
+	thread_registry_unlock();
 }
 
 static bool thread_exists(thread_t *thread)
 {
-	odlink_t *odlink = odict_find_eq(&threads, thread, NULL);
+	odlink_t *odlink = odict_find_eq(&thread_shard(thread)->threads,
+	    thread, NULL);
 	return odlink != NULL;
 }
 
 /** Check whether the thread exists, and if so, return a reference to it.
+ *
+ * Only the lock of the shard responsible for @a thread is taken, so
+ * lookups do not contend with updates or lookups in the other shards.
  */
 thread_t *thread_try_get(thread_t *thread)
 {
-	irq_spinlock_lock(&threads_lock, true);
+	thread_shard_t *shard = thread_shard(thread);
+
+	irq_spinlock_lock(&shard->lock, true);
 
 	if (thread_exists(thread)) {
 		/* Try to strengthen the reference. */
@@ -773,7 +841,7 @@ thread_t *thread_try_get(thread_t *thread)
 		thread = NULL;
 	}
 
-	irq_spinlock_unlock(&threads_lock, true);
+	irq_spinlock_unlock(&shard->lock, true);
 
 	return thread;
 }
@@ -802,12 +870,12 @@ void thread_update_accounting(bool user)
 
 /** Find thread structure corresponding to thread ID.
  *
- * The threads_lock must be already held by the caller of this function and
- * interrupts must be disabled.
+ * The entire thread registry must be already locked by the caller of this
+ * function (see thread_registry_lock()) and interrupts must be disabled.
  *
  * The returned reference is weak.
  * If the caller needs to keep it, thread_try_ref() must be used to upgrade
- * to a strong reference _before_ threads_lock is released.
+ * to a strong reference _before_ the registry is unlocked.
  *
  * @param id Thread ID.
  *
@@ -819,7 +887,6 @@ thread_t *thread_find_by_id(thread_id_t thread_id)
 	thread_t *thread;
 
 	assert(interrupts_disabled());
-	assert(irq_spinlock_locked(&threads_lock));
 
 	thread = thread_first();
 	while (thread != NULL) {
@@ -833,18 +900,28 @@ thread_t *thread_find_by_id(thread_id_t thread_id)
 }
 
 /** Get count of threads.
+ *
+ * The entire thread registry must be locked (see thread_registry_lock()).
  *
  * @return Number of threads in the system
  */
 size_t thread_count(void)
 {
+	size_t count = 0;
+
 	assert(interrupts_disabled());
-	assert(irq_spinlock_locked(&threads_lock));
 
-	return odict_count(&threads);
+	for (size_t i = 0; i < THREADS_SHARDS; i++) {
+		assert(irq_spinlock_locked(&thread_shards[i].lock));
+		count += odict_count(&thread_shards[i].threads);
+	}
+
+	return count;
 }
 
 /** Get first thread.
+ *
+ * The entire thread registry must be locked (see thread_registry_lock()).
  *
  * @return Pointer to first thread or @c NULL if there are none.
  */
@@ -853,16 +930,21 @@ thread_t *thread_first(void)
 	odlink_t *odlink;
 
 	assert(interrupts_disabled());
-	assert(irq_spinlock_locked(&threads_lock));
 
-	odlink = odict_first(&threads);
-	if (odlink == NULL)
-		return NULL;
+	for (size_t i = 0; i < THREADS_SHARDS; i++) {
+		assert(irq_spinlock_locked(&thread_shards[i].lock));
+
+		odlink = odict_first(&thread_shards[i].threads);
+		if (odlink != NULL)
+			return odict_get_instance(odlink, thread_t, lthreads);
+	}
 
-	return odict_get_instance(odlink, thread_t, lthreads);
+	return NULL;
 }
 
 /** Get next thread.
+ *
+ * The entire thread registry must be locked (see thread_registry_lock()).
  *
  * @param cur Current thread
  * @return Pointer to next thread or @c NULL if there are no more threads.
@@ -870,24 +952,33 @@ thread_t *thread_first(void)
 thread_t *thread_next(thread_t *cur)
 {
 	odlink_t *odlink;
+	size_t i = hash_mix((uintptr_t) cur) & (THREADS_SHARDS - 1);
 
 	assert(interrupts_disabled());
-	assert(irq_spinlock_locked(&threads_lock));
+	assert(irq_spinlock_locked(&thread_shards[i].lock));
 
-	odlink = odict_next(&cur->lthreads, &threads);
-	if (odlink == NULL)
-		return NULL;
+	odlink = odict_next(&cur->lthreads, &thread_shards[i].threads);
+	if (odlink != NULL)
+		return odict_get_instance(odlink, thread_t, lthreads);
+
+	for (i++; i < THREADS_SHARDS; i++) {
+		assert(irq_spinlock_locked(&thread_shards[i].lock));
 
-	return odict_get_instance(odlink, thread_t, lthreads);
+		odlink = odict_first(&thread_shards[i].threads);
+		if (odlink != NULL)
+			return odict_get_instance(odlink, thread_t, lthreads);
+	}
+
+	return NULL;
 }
 
 #ifdef CONFIG_UDEBUG
 
 void thread_stack_trace(thread_id_t thread_id)
 {
-	irq_spinlock_lock(&threads_lock, true);
+	thread_registry_lock();
 	thread_t *thread = thread_try_ref(thread_find_by_id(thread_id));
-	irq_spinlock_unlock(&threads_lock, true);
+	thread_registry_unlock();
 
 	if (thread == NULL) {
 		printf("No such thread.\n");
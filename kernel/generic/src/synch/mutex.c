@@ -41,6 +41,9 @@
 #include <synch/mutex.h>
 #include <synch/semaphore.h>
 #include <arch.h>
+#include <arch/asm.h>
+#include <atomic.h>
+#include <config.h>
 #include <stacktrace.h>
 #include <cpu.h>
 #include <proc/thread.h>
@@ -94,6 +97,62 @@ static void mutex_lock_active(mutex_t *mtx)
 		printf("cpu%u: not deadlocked\n", CPU->id);
 }
 
+#ifdef CONFIG_SMP
+
+/** Upper bound on busy-wait iterations of the adaptive lock path. */
+#define MUTEX_SPIN_LIMIT  1000
+
+/** Try to acquire the mutex by spinning for a short while.
+ *
+ * Blocking on the wait queue costs two context switches, which is a
+ * poor trade when the owner holds the mutex only for a brief critical
+ * section. Spin as long as the owner is running on another CPU and can
+ * thus release the mutex soon, and give up after a bounded number of
+ * iterations.
+ *
+ * Thread structures are slab-allocated and therefore type-stable, so
+ * dereferencing a stale owner pointer is memory-safe; at worst we
+ * mispredict the owner's state and stop spinning early.
+ *
+ * @return True if the mutex was acquired by spinning.
+ */
+static bool mutex_lock_adaptive(mutex_t *mtx)
+{
+	if (config.cpu_active == 1)
+		return false;
+
+	for (unsigned int cnt = 0; cnt < MUTEX_SPIN_LIMIT; cnt++) {
+		if (semaphore_trydown(&mtx->sem) == EOK)
+			return true;
+
+		thread_t *owner = mtx->owner;
+
+		/*
+		 * Spinning only pays off while the owner makes progress
+		 * on another CPU. A sleeping, preempted or unknown owner
+		 * means we better block right away.
+		 */
+		if ((owner == NULL) || (owner == THREAD))
+			break;
+
+		if (atomic_get_unordered(&owner->state) != Running)
+			break;
+
+		cpu_spin_hint();
+	}
+
+	return false;
+}
+
+#else /* CONFIG_SMP */
+
+static bool mutex_lock_adaptive(mutex_t *mtx)
+{
+	return false;
+}
+
+#endif /* CONFIG_SMP */
+
 /** Acquire mutex.
  *
  * This operation is uninterruptible and cannot fail.
@@ -111,7 +170,9 @@ void mutex_lock(mutex_t *mtx)
 		return;
 	}
 
-	semaphore_down(&mtx->sem);
+	if (!mutex_lock_adaptive(mtx))
+		semaphore_down(&mtx->sem);
+
 	mtx->owner = THREAD;
 	mtx->nesting = 1;
 }
@@ -163,8 +224,13 @@ void mutex_unlock(mutex_t *mtx)
 		assert(mtx->owner == THREAD);
 		if (--mtx->nesting > 0)
 			return;
-		mtx->owner = NULL;
 	}
+
+	/*
+	 * Clear the owner before waking up waiters so that threads on the
+	 * adaptive spin path stop attributing the mutex to us.
+	 */
+	mtx->owner = NULL;
 	semaphore_up(&mtx->sem);
 }
 
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_sync
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Queued spinlocks.
+ *
+ * MCS-style queued spinlock. Waiters enqueue a per-CPU node into a
+ * single-word tail queue and spin on their own node, which eliminates
+ * the cache line ping-pong of the plain test-and-set spinlock under
+ * contention and grants the lock in FIFO order.
+ */
+
+#include <arch/asm.h>
+#include <synch/qspinlock.h>
+#include <assert.h>
+#include <atomic.h>
+#include <arch.h>
+#include <preemption.h>
+#include <cpu.h>
+
+#ifdef CONFIG_SMP
+
+/** Initialize queued spinlock
+ *
+ * @param lock Pointer to qspinlock_t structure.
+ *
+ */
+void qspinlock_initialize(qspinlock_t *lock, const char *name)
+{
+	atomic_store_explicit(&lock->tail, NULL, memory_order_relaxed);
+#ifdef CONFIG_DEBUG_SPINLOCK
+	lock->name = name;
+#endif
+}
+
+/** Claim a queue node of the current CPU.
+ *
+ * Must be called with preemption disabled, so that the owning CPU
+ * cannot change under our hands.
+ */
+static qspinlock_node_t *qnode_claim(void)
+{
+	assert(PREEMPTION_DISABLED);
+	assert(CPU != NULL);
+
+	assert(CPU_LOCAL->qnode_depth < QSPINLOCK_NESTING);
+	qspinlock_node_t *node = &CPU->qnodes[CPU_LOCAL->qnode_depth++];
+
+	atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+	atomic_store_explicit(&node->locked, true, memory_order_relaxed);
+
+	return node;
+}
+
+/** Return the most recently claimed queue node of the current CPU. */
+static qspinlock_node_t *qnode_current(void)
+{
+	assert(PREEMPTION_DISABLED);
+	assert(CPU != NULL);
+	assert(CPU_LOCAL->qnode_depth > 0);
+
+	return &CPU->qnodes[CPU_LOCAL->qnode_depth - 1];
+}
+
+static void qnode_release(void)
+{
+	CPU_LOCAL->qnode_depth--;
+}
+
+/** Lock queued spinlock
+ *
+ * @param lock Pointer to qspinlock_t structure.
+ *
+ */
+void qspinlock_lock(qspinlock_t *lock)
+{
+	preemption_disable();
+
+	qspinlock_node_t *node = qnode_claim();
+
+	qspinlock_node_t *prev = atomic_exchange_explicit(&lock->tail, node,
+	    memory_order_acq_rel);
+
+	if (prev != NULL) {
+		/* Publish our node to the predecessor. */
+		atomic_store_explicit(&prev->next, node, memory_order_release);
+
+		/*
+		 * Spin on our own node only. The previous owner flips it
+		 * when handing the lock over.
+		 */
+		while (atomic_load_explicit(&node->locked,
+		    memory_order_acquire))
+			cpu_spin_hint();
+	}
+}
+
+/** Unlock queued spinlock
+ *
+ * @param lock Pointer to qspinlock_t structure.
+ *
+ */
+void qspinlock_unlock(qspinlock_t *lock)
+{
+	qspinlock_node_t *node = qnode_current();
+
+	qspinlock_node_t *next = atomic_load_explicit(&node->next,
+	    memory_order_acquire);
+
+	if (next == NULL) {
+		/* No known successor, try to close the queue. */
+		qspinlock_node_t *expected = node;
+
+		if (atomic_compare_exchange_strong_explicit(&lock->tail,
+		    &expected, NULL,
+		    memory_order_acq_rel, memory_order_acquire)) {
+			qnode_release();
+			preemption_enable();
+			return;
+		}
+
+		/* A successor is enqueuing itself, wait for the link. */
+		do {
+			next = atomic_load_explicit(&node->next,
+			    memory_order_acquire);
+		} while (next == NULL);
+	}
+
+	/* Hand the lock over to the first waiter. */
+	atomic_store_explicit(&next->locked, false, memory_order_release);
+
+	qnode_release();
+	preemption_enable();
+}
+
+/**
+ * Lock queued spinlock conditionally. If the spinlock is not available
+ * at the moment, signal failure.
+ *
+ * @param lock Pointer to qspinlock_t structure.
+ *
+ * @return true on success.
+ *
+ */
+bool qspinlock_trylock(qspinlock_t *lock)
+{
+	preemption_disable();
+
+	qspinlock_node_t *node = qnode_claim();
+	qspinlock_node_t *expected = NULL;
+
+	bool ret = atomic_compare_exchange_strong_explicit(&lock->tail,
+	    &expected, node, memory_order_acq_rel, memory_order_relaxed);
+
+	if (!ret) {
+		qnode_release();
+		preemption_enable();
+	}
+
+	return ret;
+}
+
+/** Find out whether the queued spinlock is currently locked.
+ *
+ * @param lock Queued spinlock.
+ * @return True if the spinlock is locked, false otherwise.
+ */
+bool qspinlock_locked(qspinlock_t *lock)
+{
+	return atomic_load_explicit(&lock->tail,
+	    memory_order_relaxed) != NULL;
+}
+
+#endif  /* CONFIG_SMP */
+
+/** @}
+ */
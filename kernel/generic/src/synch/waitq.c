@@ -315,10 +315,56 @@ void waitq_wake_one(waitq_t *wq)
 	irq_spinlock_unlock(&wq->lock, true);
 }
 
-static void _wake_all(waitq_t *wq)
+/** Dequeue all sleepers in one go and wake them as a batch.
+ *
+ * Must be called with wq->lock held. The lock is released by this function,
+ * before the woken threads are handed over to the scheduler, so that a
+ * broadcast does not hammer the per-CPU run queues from under the waitq
+ * lock.
+ *
+ * Claiming the wakeup (the sleep_state exchange) is done while the lock is
+ * still held; a successfully claimed thread cannot run, time out or exit
+ * until we requeue it, so it is safe to chain the claimed threads through
+ * their wakeup_link fields without holding any lock. Threads whose wakeup
+ * was claimed by a concurrent timeout or interrupt requeue themselves.
+ *
+ * Once the lock is dropped, the wait queue itself is not accessed anymore,
+ * preserving the guarantee that a woken sleeper may deallocate the waitq
+ * after it observes its removed link.
+ */
+static void _wake_all_and_unlock(waitq_t *wq)
 {
-	while (!list_empty(&wq->sleepers))
-		_wake_one(wq);
+	thread_t *batch = NULL;
+	thread_t **tail = &batch;
+
+	while (!list_empty(&wq->sleepers)) {
+		thread_t *thread = list_get_instance(list_first(&wq->sleepers),
+		    thread_t, wq_link);
+		list_remove(&thread->wq_link);
+
+		int state = atomic_exchange_explicit(&thread->sleep_state,
+		    SLEEP_WOKE, memory_order_acq_rel);
+
+		if (state == SLEEP_ASLEEP) {
+			thread->wakeup_link = NULL;
+			*tail = thread;
+			tail = &thread->wakeup_link;
+		}
+	}
+
+	irq_spinlock_unlock(&wq->lock, true);
+
+	while (batch != NULL) {
+		thread_t *thread = batch;
+		batch = thread->wakeup_link;
+		thread->wakeup_link = NULL;
+
+		/*
+		 * The reference consumed here is the reference implicitly
+		 * passed to us by the sleeper in thread_wait_finish().
+		 */
+		thread_requeue_sleeping(thread);
+	}
 }
 
 /**
@@ -330,8 +376,7 @@ void waitq_close(waitq_t *wq)
 	irq_spinlock_lock(&wq->lock, true);
 	wq->wakeup_balance = 0;
 	wq->closed = true;
-	_wake_all(wq);
-	irq_spinlock_unlock(&wq->lock, true);
+	_wake_all_and_unlock(wq);
 }
 
 /**
@@ -341,8 +386,7 @@ void waitq_wake_all(waitq_t *wq)
 {
 	irq_spinlock_lock(&wq->lock, true);
 	wq->wakeup_balance = 0;
-	_wake_all(wq);
-	irq_spinlock_unlock(&wq->lock, true);
+	_wake_all_and_unlock(wq);
 }
 
 /** @}
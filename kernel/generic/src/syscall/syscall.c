@@ -53,6 +53,9 @@
 #include <sysinfo/sysinfo.h>
 #include <console/console.h>
 #include <udebug/udebug.h>
+#include <debug/tracepoint.h>
+#include <main/boottime.h>
+#include <pmu/pmu.h>
 #include <log.h>
 
 static syshandler_t syscall_table[] = {
@@ -133,6 +136,9 @@ static syshandler_t syscall_table[] = {
 	[SYS_DEBUG_CONSOLE] = (syshandler_t) sys_debug_console,
 
 	[SYS_KLOG] = (syshandler_t) sys_klog,
+
+	[SYS_BOOTTIME_MARK] = (syshandler_t) sys_boottime_mark,
+	[SYS_PMU_CTL] = (syshandler_t) sys_pmu_ctl,
 };
 
 /** Dispatch system call */
@@ -144,6 +150,8 @@ sysarg_t syscall_handler(sysarg_t a1, sysarg_t a2, sysarg_t a3,
 	thread_update_accounting(true);
 	interrupts_restore(ipl);
 
+	tracepoint_emit(TRACE_EVENT_SYSCALL, id, a1);
+
 #ifdef CONFIG_UDEBUG
 	/*
 	 * An istate_t-compatible record was created on the stack by the
@@ -139,31 +139,12 @@ static void *get_stats_cpus(struct sysinfo_item *item, size_t *size,
 static size_t get_task_virtmem(as_t *as)
 {
 	/*
-	 * We are holding spinlocks here and therefore are not allowed to
-	 * block. Only attempt to lock the address space and address space
-	 * area mutexes conditionally. If it is not possible to lock either
-	 * object, return inexact statistics by skipping the respective object.
+	 * The counter is maintained incrementally as address space areas
+	 * are created, resized and destroyed, so there is no need to walk
+	 * (and lock) the address space areas here. This keeps the cost of
+	 * a statistics snapshot constant per task.
 	 */
-
-	if (mutex_trylock(&as->lock) != EOK)
-		return 0;
-
-	size_t pages = 0;
-
-	/* Walk areas in the address space and count pages */
-	as_area_t *area = as_area_first(as);
-	while (area != NULL) {
-		if (mutex_trylock(&area->lock) != EOK)
-			continue;
-
-		pages += area->pages;
-		mutex_unlock(&area->lock);
-		area = as_area_next(area);
-	}
-
-	mutex_unlock(&as->lock);
-
-	return (pages << PAGE_WIDTH);
+	return (atomic_load(&as->pages_mapped) << PAGE_WIDTH);
 }
 
 /** Get the resident (used) size of a virtual address space
@@ -176,31 +157,10 @@ static size_t get_task_virtmem(as_t *as)
 static size_t get_task_resmem(as_t *as)
 {
 	/*
-	 * We are holding spinlocks here and therefore are not allowed to
-	 * block. Only attempt to lock the address space and address space
-	 * area mutexes conditionally. If it is not possible to lock either
-	 * object, return inexact statistics by skipping the respective object.
+	 * Maintained incrementally by the used space maps of the areas,
+	 * mirroring their page counts, so no walk is needed either.
 	 */
-
-	if (mutex_trylock(&as->lock) != EOK)
-		return 0;
-
-	size_t pages = 0;
-
-	/* Walk areas in the address space and count pages */
-	as_area_t *area = as_area_first(as);
-	while (area != NULL) {
-		if (mutex_trylock(&area->lock) != EOK)
-			continue;
-
-		pages += area->used_space.pages;
-		mutex_unlock(&area->lock);
-		area = as_area_next(area);
-	}
-
-	mutex_unlock(&as->lock);
-
-	return (pages << PAGE_WIDTH);
+	return (atomic_load(&as->pages_resident) << PAGE_WIDTH);
 }
 
 /** Produce task statistics
@@ -241,28 +201,28 @@ static void *get_stats_tasks(struct sysinfo_item *item, size_t *size,
     bool dry_run, void *data)
 {
 	/* Messing with task structures, avoid deadlock */
-	irq_spinlock_lock(&tasks_lock, true);
+	task_registry_lock();
 
 	/* Count the tasks */
 	size_t count = task_count();
 
 	if (count == 0) {
 		/* No tasks found (strange) */
-		irq_spinlock_unlock(&tasks_lock, true);
+		task_registry_unlock();
 		*size = 0;
 		return NULL;
 	}
 
 	*size = sizeof(stats_task_t) * count;
 	if (dry_run) {
-		irq_spinlock_unlock(&tasks_lock, true);
+		task_registry_unlock();
 		return NULL;
 	}
 
 	stats_task_t *stats_tasks = (stats_task_t *) malloc(*size);
 	if (stats_tasks == NULL) {
 		/* No free space for allocation */
-		irq_spinlock_unlock(&tasks_lock, true);
+		task_registry_unlock();
 		*size = 0;
 		return NULL;
 	}
@@ -282,7 +242,7 @@ static void *get_stats_tasks(struct sysinfo_item *item, size_t *size,
 		task = task_next(task);
 	}
 
-	irq_spinlock_unlock(&tasks_lock, true);
+	task_registry_unlock();
 
 	return ((void *) stats_tasks);
 }
@@ -330,28 +290,28 @@ static void *get_stats_threads(struct sysinfo_item *item, size_t *size,
     bool dry_run, void *data)
 {
 	/* Messing with threads structures */
-	irq_spinlock_lock(&threads_lock, true);
+	thread_registry_lock();
 
 	/* Count the threads */
 	size_t count = thread_count();
 
 	if (count == 0) {
 		/* No threads found (strange) */
-		irq_spinlock_unlock(&threads_lock, true);
+		thread_registry_unlock();
 		*size = 0;
 		return NULL;
 	}
 
 	*size = sizeof(stats_thread_t) * count;
 	if (dry_run) {
-		irq_spinlock_unlock(&threads_lock, true);
+		thread_registry_unlock();
 		return NULL;
 	}
 
 	stats_thread_t *stats_threads = (stats_thread_t *) malloc(*size);
 	if (stats_threads == NULL) {
 		/* No free space for allocation */
-		irq_spinlock_unlock(&threads_lock, true);
+		thread_registry_unlock();
 		*size = 0;
 		return NULL;
 	}
@@ -368,7 +328,7 @@ static void *get_stats_threads(struct sysinfo_item *item, size_t *size,
 		thread = thread_next(thread);
 	}
 
-	irq_spinlock_unlock(&threads_lock, true);
+	thread_registry_unlock();
 
 	return ((void *) stats_threads);
 }
@@ -438,7 +398,7 @@ static void *get_stats_ipccs(struct sysinfo_item *item, size_t *size,
     bool dry_run, void *data)
 {
 	/* Messing with tasks structures, avoid deadlock */
-	irq_spinlock_lock(&tasks_lock, true);
+	task_registry_lock();
 
 	ipccs_state_t state = {
 		.counting = true,
@@ -451,12 +411,12 @@ static void *get_stats_ipccs(struct sysinfo_item *item, size_t *size,
 	task_t *task = task_first();
 	while (task != NULL) {
 		task_hold(task);
-		irq_spinlock_unlock(&tasks_lock, true);
+		task_registry_unlock();
 
 		caps_apply_to_kobject_type(task, KOBJECT_TYPE_PHONE,
 		    produce_stats_ipcc_cb, &state);
 
-		irq_spinlock_lock(&tasks_lock, true);
+		task_registry_lock();
 
 		task = task_next(task);
 	}
@@ -471,19 +431,19 @@ static void *get_stats_ipccs(struct sysinfo_item *item, size_t *size,
 	task = task_first();
 	while (task != NULL) {
 		/* We already hold a reference to the task */
-		irq_spinlock_unlock(&tasks_lock, true);
+		task_registry_unlock();
 
 		caps_apply_to_kobject_type(task, KOBJECT_TYPE_PHONE,
 		    produce_stats_ipcc_cb, &state);
 
-		irq_spinlock_lock(&tasks_lock, true);
+		task_registry_lock();
 
 		task_t *prev_task = task;
 		task = task_next(prev_task);
 		task_release(prev_task);
 	}
 
-	irq_spinlock_unlock(&tasks_lock, true);
+	task_registry_unlock();
 
 	return ((void *) state.data);
 }
@@ -578,12 +538,12 @@ static sysinfo_return_t get_stats_thread(const char *name, bool dry_run,
 		return ret;
 
 	/* Messing with threads structures */
-	irq_spinlock_lock(&threads_lock, true);
+	thread_registry_lock();
 
 	thread_t *thread = thread_find_by_id(thread_id);
 	if (thread == NULL) {
 		/* No thread with this ID */
-		irq_spinlock_unlock(&threads_lock, true);
+		thread_registry_unlock();
 		return ret;
 	}
 
@@ -592,13 +552,13 @@ static sysinfo_return_t get_stats_thread(const char *name, bool dry_run,
 		ret.data.data = NULL;
 		ret.data.size = sizeof(stats_thread_t);
 
-		irq_spinlock_unlock(&threads_lock, true);
+		thread_registry_unlock();
 	} else {
 		/* Allocate stats_thread_t structure */
 		stats_thread_t *stats_thread =
 		    (stats_thread_t *) malloc(sizeof(stats_thread_t));
 		if (stats_thread == NULL) {
-			irq_spinlock_unlock(&threads_lock, true);
+			thread_registry_unlock();
 			return ret;
 		}
 
@@ -609,7 +569,7 @@ static sysinfo_return_t get_stats_thread(const char *name, bool dry_run,
 
 		produce_stats_thread(thread, stats_thread);
 
-		irq_spinlock_unlock(&threads_lock, true);
+		thread_registry_unlock();
 	}
 
 	return ret;
@@ -31,6 +31,14 @@
  * @{
  */
 /** @file
+ *
+ * The fixed sysinfo tree is read without taking any lock. Writers
+ * (registering drivers and subsystems) are serialized by sysinfo_lock
+ * and publish fully constructed items into the tree using release
+ * stores, while readers traverse the tree using the matching acquire
+ * loads. Since items are never removed from the tree, no grace
+ * period tracking is needed. A reader racing with a redefinition of
+ * an already existing item observes either the old or the new value.
  */
 
 #include <assert.h>
@@ -42,6 +50,7 @@
 #include <arch/asm.h>
 #include <errno.h>
 #include <macros.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 
 /** Maximal sysinfo path length */
@@ -50,12 +59,12 @@
 bool fb_exported = false;
 
 /** Global sysinfo tree root item */
-static sysinfo_item_t *global_root = NULL;
+static _Atomic(sysinfo_item_t *) global_root = NULL;
 
 /** Sysinfo SLAB cache */
 static slab_cache_t *sysinfo_item_cache;
 
-/** Sysinfo lock */
+/** Sysinfo writer lock */
 static mutex_t sysinfo_lock;
 
 /** Sysinfo item constructor
@@ -107,10 +116,13 @@ void sysinfo_init(void)
 
 /** Recursively find an item in sysinfo tree
  *
- * Should be called with sysinfo_lock held.
+ * The tree is traversed without locking. The acquire loads pair
+ * with the release stores done by the writers, so every item that
+ * becomes visible is fully constructed.
  *
  * @param name    Current sysinfo path suffix.
- * @param subtree Current sysinfo (sub)tree root item.
+ * @param subtree Current sysinfo (sub)tree root item
+ *                (may be NULL for an empty subtree).
  * @param ret     If the return value is NULL, this argument
  *                can be set either to NULL (i.e. no item was
  *                found and no data was generated) or the
@@ -126,8 +138,6 @@ void sysinfo_init(void)
 _NO_TRACE static sysinfo_item_t *sysinfo_find_item(const char *name,
     sysinfo_item_t *subtree, sysinfo_return_t **ret, bool dry_run)
 {
-	assert(subtree != NULL);
-
 	sysinfo_item_t *cur = subtree;
 
 	/* Walk all siblings */
@@ -145,11 +155,13 @@ _NO_TRACE static sysinfo_item_t *sysinfo_find_item(const char *name,
 		/* Partial match up to the delimiter */
 		if ((name[i] == '.') && (cur->name[i] == 0)) {
 			/* Look into the subtree */
-			switch (cur->subtree_type) {
+			switch (atomic_load_explicit(&cur->subtree_type,
+			    memory_order_acquire)) {
 			case SYSINFO_SUBTREE_TABLE:
 				/* Recursively find in subtree */
 				return sysinfo_find_item(name + i + 1,
-				    cur->subtree.table, ret, dry_run);
+				    atomic_load_explicit(&cur->subtree.table,
+				    memory_order_relaxed), ret, dry_run);
 			case SYSINFO_SUBTREE_FUNCTION:
 				/* Get generated data */
 				if (ret != NULL)
@@ -166,7 +178,7 @@ _NO_TRACE static sysinfo_item_t *sysinfo_find_item(const char *name,
 			}
 		}
 
-		cur = cur->next;
+		cur = atomic_load_explicit(&cur->next, memory_order_acquire);
 	}
 
 	/* Not found, no data generated */
@@ -176,7 +188,70 @@ _NO_TRACE static sysinfo_item_t *sysinfo_find_item(const char *name,
 	return NULL;
 }
 
+/** Recursively create a detached branch of items for a path suffix
+ *
+ * Create a chain of new items covering the whole path suffix,
+ * connected through fixed subtrees. The branch is not yet reachable
+ * from the sysinfo tree, so it can be constructed without regard to
+ * concurrent readers. The caller is supposed to publish the head of
+ * the branch using a single release store (or to dispose of it if
+ * the overall operation fails).
+ *
+ * Should be called with sysinfo_lock held.
+ *
+ * @param name Current sysinfo path suffix.
+ * @param leaf Pointer to where the leaf item of the
+ *             branch is stored on success.
+ *
+ * @return Head item of the branch or NULL on allocation failure.
+ *
+ */
+_NO_TRACE static sysinfo_item_t *sysinfo_create_branch(const char *name,
+    sysinfo_item_t **leaf)
+{
+	size_t i = 0;
+
+	/* Find the first delimiter in name */
+	while ((name[i] != 0) && (name[i] != '.'))
+		i++;
+
+	sysinfo_item_t *item =
+	    (sysinfo_item_t *) slab_alloc(sysinfo_item_cache, FRAME_ATOMIC);
+	if (!item)
+		return NULL;
+
+	/* Fill in item name up to the delimiter */
+	item->name = str_ndup(name, i);
+	if (!item->name) {
+		slab_free(sysinfo_item_cache, item);
+		return NULL;
+	}
+
+	/* Create subtree items */
+	if (name[i] == '.') {
+		sysinfo_item_t *sub = sysinfo_create_branch(name + i + 1, leaf);
+		if (!sub) {
+			free(item->name);
+			item->name = NULL;
+			slab_free(sysinfo_item_cache, item);
+			return NULL;
+		}
+
+		/* The branch is still detached, plain stores suffice */
+		item->subtree_type = SYSINFO_SUBTREE_TABLE;
+		item->subtree.table = sub;
+	} else
+		*leaf = item;
+
+	return item;
+}
+
 /** Recursively create items in sysinfo tree
+ *
+ * New items are always constructed as a complete detached branch
+ * first and then made reachable for the lock-free readers using a
+ * single release store, either to the (sub)tree root or to the next
+ * pointer of the last sibling.
  *
  * Should be called with sysinfo_lock held.
  *
@@ -190,49 +265,24 @@ _NO_TRACE static sysinfo_item_t *sysinfo_find_item(const char *name,
  *
  */
 _NO_TRACE static sysinfo_item_t *sysinfo_create_path(const char *name,
-    sysinfo_item_t **psubtree)
+    _Atomic(sysinfo_item_t *) *psubtree)
 {
 	assert(psubtree != NULL);
 
-	if (*psubtree == NULL) {
-		/* No parent */
-
-		size_t i = 0;
-
-		/* Find the first delimiter in name */
-		while ((name[i] != 0) && (name[i] != '.'))
-			i++;
-
-		*psubtree =
-		    (sysinfo_item_t *) slab_alloc(sysinfo_item_cache, FRAME_ATOMIC);
-		if (!*psubtree)
-			return NULL;
+	sysinfo_item_t *cur =
+	    atomic_load_explicit(psubtree, memory_order_relaxed);
 
-		/* Fill in item name up to the delimiter */
-		(*psubtree)->name = str_ndup(name, i);
-		if (!(*psubtree)->name) {
-			slab_free(sysinfo_item_cache, *psubtree);
+	if (cur == NULL) {
+		/* No parent, publish a new branch as the (sub)tree root */
+		sysinfo_item_t *leaf;
+		sysinfo_item_t *branch = sysinfo_create_branch(name, &leaf);
+		if (!branch)
 			return NULL;
-		}
-
-		/* Create subtree items */
-		if (name[i] == '.') {
-			(*psubtree)->subtree_type = SYSINFO_SUBTREE_TABLE;
-			sysinfo_item_t *item = sysinfo_create_path(name + i + 1,
-			    &((*psubtree)->subtree.table));
-			if (!item) {
-				free((*psubtree)->name);
-				slab_free(sysinfo_item_cache, *psubtree);
-			}
-			return item;
-		}
 
-		/* No subtree needs to be created */
-		return *psubtree;
+		atomic_store_explicit(psubtree, branch, memory_order_release);
+		return leaf;
 	}
 
-	sysinfo_item_t *cur = *psubtree;
-
 	/* Walk all siblings */
 	while (cur != NULL) {
 		size_t i = 0;
@@ -251,13 +301,28 @@ _NO_TRACE static sysinfo_item_t *sysinfo_create_path(const char *name,
 		/* Partial match up to the delimiter */
 		if ((name[i] == '.') && (cur->name[i] == 0)) {
 			switch (cur->subtree_type) {
-			case SYSINFO_SUBTREE_NONE:
-				/* No subtree yet, create one */
-				cur->subtree_type = SYSINFO_SUBTREE_TABLE;
-				return sysinfo_create_path(name + i + 1,
-				    &(cur->subtree.table));
+			case SYSINFO_SUBTREE_NONE: {
+				/* No subtree yet, publish a new branch */
+				sysinfo_item_t *leaf;
+				sysinfo_item_t *branch =
+				    sysinfo_create_branch(name + i + 1, &leaf);
+				if (!branch)
+					return NULL;
+
+				/*
+				 * Readers inspect the subtree only after
+				 * observing SYSINFO_SUBTREE_TABLE, so the
+				 * release store on the subtree type also
+				 * publishes the table pointer.
+				 */
+				atomic_store_explicit(&cur->subtree.table,
+				    branch, memory_order_relaxed);
+				atomic_store_explicit(&cur->subtree_type,
+				    SYSINFO_SUBTREE_TABLE, memory_order_release);
+				return leaf;
+			}
 			case SYSINFO_SUBTREE_TABLE:
-				/* Subtree already created, add new sibling */
+				/* Subtree already created, descend into it */
 				return sysinfo_create_path(name + i + 1,
 				    &(cur->subtree.table));
 			default:
@@ -271,46 +336,23 @@ _NO_TRACE static sysinfo_item_t *sysinfo_create_path(const char *name,
 
 		/*
 		 * No match and no more siblings to check
-		 * -> create a new sibling item.
+		 * -> publish a new branch as a sibling item.
 		 */
-		if (cur->next == NULL) {
-			/* Find the first delimiter in name */
-			i = 0;
-			while ((name[i] != 0) && (name[i] != '.'))
-				i++;
-
-			sysinfo_item_t *item =
-			    (sysinfo_item_t *) slab_alloc(sysinfo_item_cache, FRAME_ATOMIC);
-			if (!item)
-				return NULL;
-
-			cur->next = item;
-
-			/* Fill in item name up to the delimiter */
-			item->name = str_ndup(name, i);
-			if (!item->name) {
-				slab_free(sysinfo_item_cache, item);
+		sysinfo_item_t *next =
+		    atomic_load_explicit(&cur->next, memory_order_relaxed);
+		if (next == NULL) {
+			sysinfo_item_t *leaf;
+			sysinfo_item_t *branch = sysinfo_create_branch(name,
+			    &leaf);
+			if (!branch)
 				return NULL;
-			}
 
-			/* Create subtree items */
-			if (name[i] == '.') {
-				item->subtree_type = SYSINFO_SUBTREE_TABLE;
-				sysinfo_item_t *sub = sysinfo_create_path(
-				    name + i + 1, &(item->subtree.table));
-				if (!sub) {
-					free(item->name);
-					slab_free(sysinfo_item_cache, item);
-					return NULL;
-				}
-				return sub;
-			}
-
-			/* No subtree needs to be created */
-			return item;
+			atomic_store_explicit(&cur->next, branch,
+			    memory_order_release);
+			return leaf;
 		}
 
-		cur = cur->next;
+		cur = next;
 	}
 
 	unreachable();
@@ -324,10 +366,10 @@ _NO_TRACE static sysinfo_item_t *sysinfo_create_path(const char *name,
  * @param val  Value to store in the item.
  *
  */
-void sysinfo_set_item_val(const char *name, sysinfo_item_t **root,
+void sysinfo_set_item_val(const char *name, _Atomic(sysinfo_item_t *) *root,
     sysarg_t val)
 {
-	/* Protect sysinfo tree consistency */
+	/* Serialize sysinfo tree updates */
 	mutex_lock(&sysinfo_lock);
 
 	if (root == NULL)
@@ -335,8 +377,10 @@ void sysinfo_set_item_val(const char *name, sysinfo_item_t **root,
 
 	sysinfo_item_t *item = sysinfo_create_path(name, root);
 	if (item != NULL) {
-		item->val_type = SYSINFO_VAL_VAL;
+		/* Publish the value before the value type */
 		item->val.val = val;
+		atomic_store_explicit(&item->val_type, SYSINFO_VAL_VAL,
+		    memory_order_release);
 	} else {
 		printf("Could not set sysinfo item %s.\n", name);
 	}
@@ -357,10 +401,10 @@ void sysinfo_set_item_val(const char *name, sysinfo_item_t **root,
  * @param size Size of the binary data.
  *
  */
-void sysinfo_set_item_data(const char *name, sysinfo_item_t **root,
+void sysinfo_set_item_data(const char *name, _Atomic(sysinfo_item_t *) *root,
     void *data, size_t size)
 {
-	/* Protect sysinfo tree consistency */
+	/* Serialize sysinfo tree updates */
 	mutex_lock(&sysinfo_lock);
 
 	if (root == NULL)
@@ -368,9 +412,11 @@ void sysinfo_set_item_data(const char *name, sysinfo_item_t **root,
 
 	sysinfo_item_t *item = sysinfo_create_path(name, root);
 	if (item != NULL) {
-		item->val_type = SYSINFO_VAL_DATA;
+		/* Publish the value before the value type */
 		item->val.data.data = data;
 		item->val.data.size = size;
+		atomic_store_explicit(&item->val_type, SYSINFO_VAL_DATA,
+		    memory_order_release);
 	} else {
 		printf("Could not set sysinfo item %s.\n", name);
 	}
@@ -387,10 +433,10 @@ void sysinfo_set_item_data(const char *name, sysinfo_item_t **root,
  * @param data Private data.
  *
  */
-void sysinfo_set_item_gen_val(const char *name, sysinfo_item_t **root,
-    sysinfo_fn_val_t fn, void *data)
+void sysinfo_set_item_gen_val(const char *name,
+    _Atomic(sysinfo_item_t *) *root, sysinfo_fn_val_t fn, void *data)
 {
-	/* Protect sysinfo tree consistency */
+	/* Serialize sysinfo tree updates */
 	mutex_lock(&sysinfo_lock);
 
 	if (root == NULL)
@@ -398,9 +444,11 @@ void sysinfo_set_item_gen_val(const char *name, sysinfo_item_t **root,
 
 	sysinfo_item_t *item = sysinfo_create_path(name, root);
 	if (item != NULL) {
-		item->val_type = SYSINFO_VAL_FUNCTION_VAL;
+		/* Publish the generator before the value type */
 		item->val.gen_val.fn = fn;
 		item->val.gen_val.data = data;
+		atomic_store_explicit(&item->val_type,
+		    SYSINFO_VAL_FUNCTION_VAL, memory_order_release);
 	} else {
 		printf("Could not set sysinfo item %s.\n", name);
 	}
@@ -422,10 +470,10 @@ void sysinfo_set_item_gen_val(const char *name, sysinfo_item_t **root,
  * @param data Private data.
  *
  */
-void sysinfo_set_item_gen_data(const char *name, sysinfo_item_t **root,
-    sysinfo_fn_data_t fn, void *data)
+void sysinfo_set_item_gen_data(const char *name,
+    _Atomic(sysinfo_item_t *) *root, sysinfo_fn_data_t fn, void *data)
 {
-	/* Protect sysinfo tree consistency */
+	/* Serialize sysinfo tree updates */
 	mutex_lock(&sysinfo_lock);
 
 	if (root == NULL)
@@ -433,9 +481,11 @@ void sysinfo_set_item_gen_data(const char *name, sysinfo_item_t **root,
 
 	sysinfo_item_t *item = sysinfo_create_path(name, root);
 	if (item != NULL) {
-		item->val_type = SYSINFO_VAL_FUNCTION_DATA;
+		/* Publish the generator before the value type */
 		item->val.gen_data.fn = fn;
 		item->val.gen_data.data = data;
+		atomic_store_explicit(&item->val_type,
+		    SYSINFO_VAL_FUNCTION_DATA, memory_order_release);
 	} else {
 		printf("Could not set sysinfo item %s.\n", name);
 	}
@@ -450,9 +500,10 @@ void sysinfo_set_item_gen_data(const char *name, sysinfo_item_t **root,
  *             a new root item (NULL for global sysinfo root).
  *
  */
-void sysinfo_set_item_undefined(const char *name, sysinfo_item_t **root)
+void sysinfo_set_item_undefined(const char *name,
+    _Atomic(sysinfo_item_t *) *root)
 {
-	/* Protect sysinfo tree consistency */
+	/* Serialize sysinfo tree updates */
 	mutex_lock(&sysinfo_lock);
 
 	if (root == NULL)
@@ -460,7 +511,8 @@ void sysinfo_set_item_undefined(const char *name, sysinfo_item_t **root)
 
 	sysinfo_item_t *item = sysinfo_create_path(name, root);
 	if (item != NULL)
-		item->val_type = SYSINFO_VAL_UNDEFINED;
+		atomic_store_explicit(&item->val_type, SYSINFO_VAL_UNDEFINED,
+		    memory_order_release);
 	else
 		printf("Could not set sysinfo item %s.\n", name);
 
@@ -476,10 +528,10 @@ void sysinfo_set_item_undefined(const char *name, sysinfo_item_t **root)
  * @param data Private data to be passed to the generator.
  *
  */
-void sysinfo_set_subtree_fn(const char *name, sysinfo_item_t **root,
+void sysinfo_set_subtree_fn(const char *name, _Atomic(sysinfo_item_t *) *root,
     sysinfo_fn_subtree_t fn, void *data)
 {
-	/* Protect sysinfo tree consistency */
+	/* Serialize sysinfo tree updates */
 	mutex_lock(&sysinfo_lock);
 
 	if (root == NULL)
@@ -492,9 +544,11 @@ void sysinfo_set_subtree_fn(const char *name, sysinfo_item_t **root,
 	 * a fixed subtree
 	 */
 	if ((item != NULL) && (item->subtree_type != SYSINFO_SUBTREE_TABLE)) {
-		item->subtree_type = SYSINFO_SUBTREE_FUNCTION;
+		/* Publish the generator before the subtree type */
 		item->subtree.generator.fn = fn;
 		item->subtree.generator.data = data;
+		atomic_store_explicit(&item->subtree_type,
+		    SYSINFO_SUBTREE_FUNCTION, memory_order_release);
 	} else {
 		printf("Could not set sysinfo item %s.\n", name);
 	}
@@ -609,7 +663,7 @@ void sysinfo_dump(sysinfo_item_t *root)
 
 /** Return sysinfo item value determined by name
  *
- * Should be called with sysinfo_lock held.
+ * The fixed tree is traversed without locking.
  *
  * @param name    Sysinfo path.
  * @param root    Root item of the sysinfo (sub)tree.
@@ -622,7 +676,7 @@ void sysinfo_dump(sysinfo_item_t *root)
  *
  */
 _NO_TRACE static sysinfo_return_t sysinfo_get_item(const char *name,
-    sysinfo_item_t **root, bool dry_run)
+    _Atomic(sysinfo_item_t *) *root, bool dry_run)
 {
 	if (root == NULL)
 		root = &global_root;
@@ -630,14 +684,18 @@ _NO_TRACE static sysinfo_return_t sysinfo_get_item(const char *name,
 	/* Try to find the item or generate data */
 	sysinfo_return_t ret;
 	sysinfo_return_t *ret_ptr = &ret;
-	sysinfo_item_t *item = sysinfo_find_item(name, *root, &ret_ptr,
+	sysinfo_item_t *item = sysinfo_find_item(name,
+	    atomic_load_explicit(root, memory_order_acquire), &ret_ptr,
 	    dry_run);
 
 	if (item != NULL) {
 		/* Item found in the fixed sysinfo tree */
 
-		ret.tag = item->val_type;
-		switch (item->val_type) {
+		sysinfo_item_val_type_t val_type =
+		    atomic_load_explicit(&item->val_type, memory_order_acquire);
+
+		ret.tag = val_type;
+		switch (val_type) {
 		case SYSINFO_VAL_UNDEFINED:
 			break;
 		case SYSINFO_VAL_VAL:
@@ -691,15 +749,8 @@ _NO_TRACE static sysinfo_return_t sysinfo_get_item_uspace(uspace_addr_t ptr, siz
 		return ret;
 
 	if ((copy_from_uspace(path, ptr, size + 1) == 0) &&
-	    (path[size] == 0)) {
-		/*
-		 * Prevent other functions from messing with sysinfo while we
-		 * are reading it.
-		 */
-		mutex_lock(&sysinfo_lock);
+	    (path[size] == 0))
 		ret = sysinfo_get_item(path, NULL, dry_run);
-		mutex_unlock(&sysinfo_lock);
-	}
 
 	free(path);
 	return ret;
@@ -707,7 +758,7 @@ _NO_TRACE static sysinfo_return_t sysinfo_get_item_uspace(uspace_addr_t ptr, siz
 
 /** Return sysinfo keys determined by name
  *
- * Should be called with sysinfo_lock held.
+ * The fixed tree is traversed without locking.
  *
  * @param name    Sysinfo path.
  * @param root    Root item of the sysinfo (sub)tree.
@@ -720,7 +771,7 @@ _NO_TRACE static sysinfo_return_t sysinfo_get_item_uspace(uspace_addr_t ptr, siz
  *
  */
 _NO_TRACE static sysinfo_return_t sysinfo_get_keys(const char *name,
-    sysinfo_item_t **root, bool dry_run)
+    _Atomic(sysinfo_item_t *) *root, bool dry_run)
 {
 	if (root == NULL)
 		root = &global_root;
@@ -729,13 +780,16 @@ _NO_TRACE static sysinfo_return_t sysinfo_get_keys(const char *name,
 
 	if (name[0] != 0) {
 		/* Try to find the item */
-		sysinfo_item_t *item =
-		    sysinfo_find_item(name, *root, NULL, dry_run);
+		sysinfo_item_t *item = sysinfo_find_item(name,
+		    atomic_load_explicit(root, memory_order_acquire), NULL,
+		    dry_run);
 		if ((item != NULL) &&
-		    (item->subtree_type == SYSINFO_SUBTREE_TABLE))
-			subtree = item->subtree.table;
+		    (atomic_load_explicit(&item->subtree_type,
+		    memory_order_acquire) == SYSINFO_SUBTREE_TABLE))
+			subtree = atomic_load_explicit(&item->subtree.table,
+			    memory_order_relaxed);
 	} else
-		subtree = *root;
+		subtree = atomic_load_explicit(root, memory_order_acquire);
 
 	sysinfo_return_t ret;
 	ret.tag = SYSINFO_VAL_UNDEFINED;
@@ -745,7 +799,8 @@ _NO_TRACE static sysinfo_return_t sysinfo_get_keys(const char *name,
 		 * Calculate the size of subkeys.
 		 */
 		size_t size = 0;
-		for (sysinfo_item_t *cur = subtree; cur; cur = cur->next)
+		for (sysinfo_item_t *cur = subtree; cur;
+		    cur = atomic_load_explicit(&cur->next, memory_order_acquire))
 			size += str_size(cur->name) + 1;
 
 		if (dry_run) {
@@ -758,8 +813,16 @@ _NO_TRACE static sysinfo_return_t sysinfo_get_keys(const char *name,
 			if (names == NULL)
 				return ret;
 
+			/*
+			 * New siblings can be appended concurrently. Only
+			 * the keys that fit the calculated size (i.e. those
+			 * present during the first pass) are returned.
+			 */
 			size_t pos = 0;
-			for (sysinfo_item_t *cur = subtree; cur; cur = cur->next) {
+			for (sysinfo_item_t *cur = subtree;
+			    (cur != NULL) && (pos < size);
+			    cur = atomic_load_explicit(&cur->next,
+			    memory_order_acquire)) {
 				str_cpy(names + pos, size - pos, cur->name);
 				pos += str_size(cur->name) + 1;
 			}
@@ -802,15 +865,8 @@ _NO_TRACE static sysinfo_return_t sysinfo_get_keys_uspace(uspace_addr_t ptr, siz
 		return ret;
 
 	if ((copy_from_uspace(path, ptr, size + 1) == 0) &&
-	    (path[size] == 0)) {
-		/*
-		 * Prevent other functions from messing with sysinfo while we
-		 * are reading it.
-		 */
-		mutex_lock(&sysinfo_lock);
+	    (path[size] == 0))
 		ret = sysinfo_get_keys(path, NULL, dry_run);
-		mutex_unlock(&sysinfo_lock);
-	}
 
 	free(path);
 	return ret;
@@ -58,6 +58,8 @@
 #include <mm/frame.h>
 #include <ddi/ddi.h>
 #include <arch/cycle.h>
+#include <debug/sampling.h>
+#include <macros.h>
 #include <preemption.h>
 
 /* Pointer to variable with uptime */
@@ -120,6 +122,36 @@ static void clock_update_counters(uint64_t current_tick)
 	}
 }
 
+/** Number of clock ticks an idle CPU may skip.
+ *
+ * Architecture timer drivers implementing tickless idle call this before
+ * entering low-power sleep and defer their next interrupt accordingly.
+ * The skipped periods must be added to CPU_LOCAL->missed_clock_ticks when
+ * the deferred interrupt finally arrives, which keeps current_clock_tick,
+ * the uptime counters and pending deadlines exact.
+ *
+ * The skip is bounded by one second so that the public uptime counters,
+ * which are maintained by CPU 0 from its tick handler, never go stale by
+ * more than that.
+ *
+ * @return Number of tick periods the next clock interrupt may be
+ *         deferred by. Zero means the CPU must keep ticking at HZ.
+ *
+ */
+uint64_t clock_idle_ticks(void)
+{
+	deadline_t next = timeout_next_deadline();
+
+	if (next == DEADLINE_NEVER)
+		return HZ;
+
+	uint64_t current = CPU_LOCAL->current_clock_tick;
+	if (next <= current + 1)
+		return 0;
+
+	return min(next - current - 1, (uint64_t) HZ);
+}
+
 static void cpu_update_accounting(void)
 {
 	// FIXME: get_cycle() is unimplemented on several platforms
@@ -147,6 +179,12 @@ void clock(void)
 	/* Account CPU usage */
 	cpu_update_accounting();
 
+	/* Take a profiling sample if the sampling profiler is enabled */
+	profile_clock_tick();
+
+	/* Cascade due timer wheel slots into the sorted near list. */
+	timeout_wheel_advance(current_clock_tick);
+
 	/*
 	 * To avoid lock ordering problems,
 	 * run all expired timeouts as you visit them.
@@ -164,6 +202,7 @@ void clock(void)
 		}
 
 		list_remove(cur);
+		CPU->timeout_pending--;
 		timeout_handler_t handler = timeout->handler;
 		void *arg = timeout->arg;
 		atomic_bool *finished = &timeout->finished;
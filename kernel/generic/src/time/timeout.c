@@ -34,11 +34,19 @@
 /**
  * @file
  * @brief Timeout management functions.
+ *
+ * Timeouts that are already due or expire within the next few ticks live
+ * in a short sorted per-CPU list that clock() consumes directly. Timeouts
+ * beyond that horizon live in a per-CPU hierarchical timer wheel and
+ * cascade towards the sorted list as the clock advances, so arming and
+ * cancelling a timeout is O(1) regardless of how many timeouts are
+ * pending.
  */
 
 #include <time/timeout.h>
 #include <typedefs.h>
 #include <config.h>
+#include <macros.h>
 #include <panic.h>
 #include <synch/spinlock.h>
 #include <halt.h>
@@ -46,6 +54,18 @@
 #include <arch/asm.h>
 #include <arch.h>
 
+/** Level shift of the timer wheel; 2^shift == TIMEOUT_WHEEL_SLOTS. */
+#define TIMEOUT_WHEEL_SHIFT  6
+
+/** Number of ticks covered by wheel level @a level and all levels below. */
+#define TIMEOUT_WHEEL_SPAN(level) \
+	(UINT64_C(1) << (TIMEOUT_WHEEL_SHIFT * ((level) + 1)))
+
+/** Slot of @a deadline on wheel level @a level. */
+#define TIMEOUT_WHEEL_SLOT(deadline, level) \
+	(((deadline) >> (TIMEOUT_WHEEL_SHIFT * (level))) & \
+	    (TIMEOUT_WHEEL_SLOTS - 1))
+
 /** Initialize timeouts
  *
  * Initialize kernel timeouts.
@@ -55,6 +75,14 @@ void timeout_init(void)
 {
 	irq_spinlock_initialize(&CPU->timeoutlock, "cpu.timeoutlock");
 	list_initialize(&CPU->timeout_active_list);
+
+	for (unsigned int level = 0; level < TIMEOUT_WHEEL_LEVELS; level++) {
+		for (unsigned int slot = 0; slot < TIMEOUT_WHEEL_SLOTS; slot++)
+			list_initialize(&CPU->timeout_wheel[level][slot]);
+	}
+
+	CPU->timeout_wheel_tick = CPU_LOCAL->current_clock_tick;
+	CPU->timeout_pending = 0;
 }
 
 /** Initialize timeout
@@ -79,21 +107,29 @@ deadline_t timeout_deadline_in_usec(uint32_t usec)
 	return CPU_LOCAL->current_clock_tick + us2ticks(usec);
 }
 
-static void timeout_register_deadline_locked(timeout_t *timeout, deadline_t deadline,
-    timeout_handler_t handler, void *arg)
+/** Compute the coalescing slack for a deadline.
+ *
+ * The slack is proportional to the remaining delay, so short timeouts
+ * stay accurate while long ones trade a little precision for fewer
+ * interrupts.
+ */
+static deadline_t timeout_slack(deadline_t deadline)
 {
-	assert(!link_in_use(&timeout->link));
+	uint64_t now = CPU_LOCAL->current_clock_tick;
 
-	*timeout = (timeout_t) {
-		.cpu = CPU,
-		.deadline = deadline,
-		.handler = handler,
-		.arg = arg,
-		.finished = ATOMIC_VAR_INIT(false),
-	};
+	if (deadline <= now)
+		return 0;
 
-	/* Insert timeout into the active timeouts list according to timeout->deadline. */
+	return (deadline - now) >> TIMEOUT_SLACK_SHIFT;
+}
 
+/** Insert a timeout into the sorted near list.
+ *
+ * The near list only ever holds timeouts that are already due or expire
+ * within the next few ticks, so the linear insertion scan is short.
+ */
+static void timeout_enqueue_near(timeout_t *timeout)
+{
 	link_t *last = list_last(&CPU->timeout_active_list);
 	if (last == NULL || timeout->deadline >= list_get_instance(last, timeout_t, link)->deadline) {
 		list_append(&timeout->link, &CPU->timeout_active_list);
@@ -109,6 +145,122 @@ static void timeout_register_deadline_locked(timeout_t *timeout, deadline_t dead
 	}
 }
 
+/** Insert a timeout into the near list or the appropriate wheel slot.
+ *
+ * Must be called with CPU->timeoutlock held.
+ */
+static void timeout_insert(timeout_t *timeout)
+{
+	uint64_t base = CPU->timeout_wheel_tick;
+	deadline_t deadline = timeout->deadline;
+
+	/* Already due or due at the next tick. */
+	if (deadline <= base + 1) {
+		timeout_enqueue_near(timeout);
+		return;
+	}
+
+	unsigned int level = 0;
+	while ((level < TIMEOUT_WHEEL_LEVELS - 1) &&
+	    (deadline - base >= TIMEOUT_WHEEL_SPAN(level)))
+		level++;
+
+	if (level == 0) {
+		/*
+		 * If an already registered timeout expires within the slack
+		 * window, snap to its deadline so both fire from one clock
+		 * interrupt. The deadline is only ever moved later, never
+		 * earlier, consistent with the "or slightly more" contract
+		 * of timeout_register(). Level 0 slots hold one tick each,
+		 * so this is a bounded scan of neighboring slots.
+		 */
+		deadline_t limit = min(deadline + timeout_slack(deadline),
+		    base + TIMEOUT_WHEEL_SPAN(0) - 1);
+
+		for (deadline_t d = deadline + 1; d <= limit; d++) {
+			if (!list_empty(
+			    &CPU->timeout_wheel[0][TIMEOUT_WHEEL_SLOT(d, 0)])) {
+				deadline = d;
+				timeout->deadline = d;
+				break;
+			}
+		}
+	}
+
+	/*
+	 * Deadlines beyond the range of the wheel park in the outermost
+	 * slot and are re-sorted when it cascades.
+	 */
+	if (deadline - base >= TIMEOUT_WHEEL_SPAN(level))
+		deadline = base + TIMEOUT_WHEEL_SPAN(level) - 1;
+
+	list_append(&timeout->link,
+	    &CPU->timeout_wheel[level][TIMEOUT_WHEEL_SLOT(deadline, level)]);
+}
+
+/** Re-insert all timeouts of the given wheel slot.
+ *
+ * Timeouts that became due move to the sorted near list, the others drop
+ * to a lower wheel level.
+ */
+static void timeout_cascade(unsigned int level, size_t slot)
+{
+	list_t *bucket = &CPU->timeout_wheel[level][slot];
+	link_t *cur;
+
+	while ((cur = list_first(bucket)) != NULL) {
+		list_remove(cur);
+		timeout_insert(list_get_instance(cur, timeout_t, link));
+	}
+}
+
+/** Advance the timer wheel up to the given clock tick.
+ *
+ * Cascades wheel slots whose time has come, ultimately feeding due
+ * timeouts into the sorted near list. Called from clock() with interrupts
+ * disabled before the expired timeouts are run.
+ *
+ * @param current_tick Current value of CPU_LOCAL->current_clock_tick.
+ *
+ */
+void timeout_wheel_advance(uint64_t current_tick)
+{
+	irq_spinlock_lock(&CPU->timeoutlock, false);
+
+	while (CPU->timeout_wheel_tick < current_tick) {
+		uint64_t base = ++CPU->timeout_wheel_tick;
+
+		timeout_cascade(0, TIMEOUT_WHEEL_SLOT(base, 0));
+
+		for (unsigned int level = 1; level < TIMEOUT_WHEEL_LEVELS;
+		    level++) {
+			if ((base & (TIMEOUT_WHEEL_SPAN(level - 1) - 1)) != 0)
+				break;
+
+			timeout_cascade(level, TIMEOUT_WHEEL_SLOT(base, level));
+		}
+	}
+
+	irq_spinlock_unlock(&CPU->timeoutlock, false);
+}
+
+static void timeout_register_deadline_locked(timeout_t *timeout, deadline_t deadline,
+    timeout_handler_t handler, void *arg)
+{
+	assert(!link_in_use(&timeout->link));
+
+	*timeout = (timeout_t) {
+		.cpu = CPU,
+		.deadline = deadline,
+		.handler = handler,
+		.arg = arg,
+		.finished = ATOMIC_VAR_INIT(false),
+	};
+
+	CPU->timeout_pending++;
+	timeout_insert(timeout);
+}
+
 /** Register timeout
  *
  * Insert timeout handler f (with argument arg)
@@ -137,6 +289,56 @@ void timeout_register_deadline(timeout_t *timeout, deadline_t deadline,
 	irq_spinlock_unlock(&CPU->timeoutlock, true);
 }
 
+/** Get the deadline of the earliest pending timeout on the current CPU.
+ *
+ * Meant for architecture timer drivers implementing tickless idle:
+ * before entering low-power sleep, an idle CPU may program its next
+ * timer interrupt for this deadline instead of ticking at HZ. See
+ * clock_idle_ticks().
+ *
+ * If the earliest pending timeout sits in an outer level of the timer
+ * wheel, a lower bound on its deadline is returned instead; the CPU then
+ * wakes up early, cascades the wheel and goes idle again. Waking early is
+ * always safe, waking late is not.
+ *
+ * @return Deadline of the earliest active timeout in clock ticks (or a
+ *         lower bound on it), or DEADLINE_NEVER if no timeout is pending.
+ *
+ */
+deadline_t timeout_next_deadline(void)
+{
+	irq_spinlock_lock(&CPU->timeoutlock, true);
+
+	uint64_t base = CPU->timeout_wheel_tick;
+	deadline_t deadline = DEADLINE_NEVER;
+
+	link_t *first = list_first(&CPU->timeout_active_list);
+	if (first != NULL) {
+		deadline = list_get_instance(first, timeout_t, link)->deadline;
+	} else if (CPU->timeout_pending > 0) {
+		/*
+		 * Scan level 0 of the wheel; its slots cover the next
+		 * TIMEOUT_WHEEL_SPAN(0) ticks, one tick each. Timeouts in
+		 * the outer levels cannot expire before the end of that
+		 * horizon, so it serves as the fallback lower bound.
+		 */
+		deadline = base + TIMEOUT_WHEEL_SPAN(0);
+
+		for (deadline_t d = base + 1;
+		    d <= base + TIMEOUT_WHEEL_SPAN(0) - 1; d++) {
+			if (!list_empty(
+			    &CPU->timeout_wheel[0][TIMEOUT_WHEEL_SLOT(d, 0)])) {
+				deadline = d;
+				break;
+			}
+		}
+	}
+
+	irq_spinlock_unlock(&CPU->timeoutlock, true);
+
+	return deadline;
+}
+
 /** Unregister timeout
  *
  * Remove timeout from timeout list.
@@ -159,6 +361,7 @@ bool timeout_unregister(timeout_t *timeout)
 	bool success = link_in_use(&timeout->link);
 	if (success) {
 		list_remove(&timeout->link);
+		timeout->cpu->timeout_pending--;
 	}
 
 	irq_spinlock_unlock(&timeout->cpu->timeoutlock, true);
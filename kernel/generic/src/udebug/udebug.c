@@ -45,6 +45,7 @@
 #include <arch.h>
 #include <proc/task.h>
 #include <proc/thread.h>
+#include <stdlib.h>
 
 /** Initialize udebug part of task structure.
  *
@@ -59,6 +60,10 @@ void udebug_task_init(udebug_task_t *ut)
 	ut->begin_call = NULL;
 	ut->not_stoppable_count = 0;
 	ut->evmask = 0;
+	ut->ev_ring = NULL;
+	ut->ev_ring_head = 0;
+	ut->ev_ring_count = 0;
+	ut->ev_ring_lost = 0;
 }
 
 /** Initialize udebug part of thread structure.
@@ -209,6 +214,42 @@ void udebug_before_thread_runs(void)
 	udebug_stoppable_end();
 }
 
+/** Record a syscall event into the task's event ring.
+ *
+ * Must be called with TASK->udebug.lock and THREAD->udebug.lock held.
+ * The event is recorded without taking GO away from the thread, so the
+ * thread continues running and no GO answer is generated. If the ring
+ * is full the event is dropped and accounted in ev_ring_lost.
+ *
+ */
+static void udebug_ev_ring_record(udebug_event_t etype, sysarg_t id,
+    sysarg_t rc, sysarg_t a1, sysarg_t a2, sysarg_t a3, sysarg_t a4,
+    sysarg_t a5, sysarg_t a6)
+{
+	udebug_task_t *ut = &TASK->udebug;
+
+	if (ut->ev_ring_count == UDEBUG_EV_RING_SIZE) {
+		ut->ev_ring_lost++;
+		return;
+	}
+
+	udebug_ev_t *ev = &ut->ev_ring[ut->ev_ring_head];
+
+	ev->thread = (sysarg_t) THREAD;
+	ev->etype = etype;
+	ev->sc_id = id;
+	ev->sc_rc = rc;
+	ev->args[0] = a1;
+	ev->args[1] = a2;
+	ev->args[2] = a3;
+	ev->args[3] = a4;
+	ev->args[4] = a5;
+	ev->args[5] = a6;
+
+	ut->ev_ring_head = (ut->ev_ring_head + 1) % UDEBUG_EV_RING_SIZE;
+	ut->ev_ring_count++;
+}
+
 /** Syscall event hook.
  *
  * Must be called before and after servicing a system call. This generates
@@ -233,6 +274,18 @@ void udebug_syscall_event(sysarg_t a1, sysarg_t a2, sysarg_t a3,
 		return;
 	}
 
+	if (TASK->udebug.ev_ring != NULL) {
+		/*
+		 * Event ring mode. Record the event and let the thread
+		 * continue instead of reporting through the GO call.
+		 */
+		udebug_ev_ring_record(etype, id, rc, a1, a2, a3, a4, a5, a6);
+
+		mutex_unlock(&THREAD->udebug.lock);
+		mutex_unlock(&TASK->udebug.lock);
+		return;
+	}
+
 	/* Fill in the GO response. */
 	call_t *call = THREAD->udebug.go_call;
 	THREAD->udebug.go_call = NULL;
@@ -452,6 +505,15 @@ errno_t udebug_task_cleanup(struct task *task)
 	task->udebug.dt_state = UDEBUG_TS_INACTIVE;
 	task->udebug.debugger = NULL;
 
+	if (task->udebug.ev_ring != NULL) {
+		free(task->udebug.ev_ring);
+		task->udebug.ev_ring = NULL;
+	}
+
+	task->udebug.ev_ring_head = 0;
+	task->udebug.ev_ring_count = 0;
+	task->udebug.ev_ring_lost = 0;
+
 	return 0;
 }
 
@@ -45,14 +45,49 @@
 #include <arch.h>
 #include <errno.h>
 #include <ipc/ipc.h>
+#include <stdlib.h>
 #include <syscall/copy.h>
 #include <udebug/udebug.h>
 #include <udebug/udebug_ops.h>
 #include <udebug/udebug_ipc.h>
 
+/** Preprocess a MEM_READ_V request.
+ *
+ * Copies the range array from the caller's address space into a kernel
+ * buffer. This must happen in the context of the sender (the debugger);
+ * the buffer is passed to the recipient in call->buffer.
+ *
+ * @param call	The call structure.
+ */
+static errno_t udebug_mem_read_v_preprocess(call_t *call)
+{
+	uspace_addr_t uspace_ranges = ipc_get_arg3(&call->data);
+	size_t nranges = ipc_get_arg4(&call->data);
+
+	if ((nranges == 0) || (nranges > UDEBUG_MEM_RANGES_MAX))
+		return ELIMIT;
+
+	udebug_mem_range_t *ranges =
+	    malloc(nranges * sizeof(udebug_mem_range_t));
+	if (!ranges)
+		return ENOMEM;
+
+	errno_t rc = copy_from_uspace(ranges, uspace_ranges,
+	    nranges * sizeof(udebug_mem_range_t));
+	if (rc != EOK) {
+		free(ranges);
+		return rc;
+	}
+
+	call->buffer = (uint8_t *) ranges;
+	return EOK;
+}
+
 errno_t udebug_request_preprocess(call_t *call, phone_t *phone)
 {
 	switch (ipc_get_arg1(&call->data)) {
+	case UDEBUG_M_MEM_READ_V:
+		return udebug_mem_read_v_preprocess(call);
 		/* future UDEBUG_M_REGS_WRITE, UDEBUG_M_MEM_WRITE: */
 	default:
 		break;
@@ -435,6 +470,108 @@ static void udebug_receive_mem_read(call_t *call)
 	ipc_answer(&TASK->kb.box, call);
 }
 
+/** Process a MEM_READ_V call.
+ *
+ * Reads several ranges of memory of the current (debugged) task at once.
+ * @param call	The call structure.
+ */
+static void udebug_receive_mem_read_v(call_t *call)
+{
+	uspace_addr_t uspace_dst;
+	udebug_mem_range_t *ranges;
+	size_t nranges;
+	void *buffer = NULL;
+	size_t size;
+	errno_t rc;
+
+	uspace_dst = ipc_get_arg2(&call->data);
+	nranges = ipc_get_arg4(&call->data);
+
+	/* The range array was copied in by udebug_request_preprocess(). */
+	ranges = (udebug_mem_range_t *) call->buffer;
+	call->buffer = NULL;
+
+	rc = udebug_mem_read_v(ranges, nranges, &buffer, &size);
+	free(ranges);
+
+	if (rc != EOK) {
+		ipc_set_retval(&call->data, rc);
+		ipc_answer(&TASK->kb.box, call);
+		return;
+	}
+
+	assert(buffer != NULL);
+
+	ipc_set_retval(&call->data, EOK);
+	/*
+	 * ARG1=dest, ARG2=size as in IPC_M_DATA_READ so that
+	 * same code in process_answer() can be used
+	 * (no way to distinguish method in answer)
+	 */
+	ipc_set_arg1(&call->data, uspace_dst);
+	ipc_set_arg2(&call->data, size);
+	call->buffer = buffer;
+
+	ipc_answer(&TASK->kb.box, call);
+}
+
+/** Process a SET_EVRING call.
+ *
+ * Enables or disables the syscall event ring for the current task.
+ * @param call	The call structure.
+ */
+static void udebug_receive_set_evring(call_t *call)
+{
+	errno_t rc;
+
+	rc = udebug_ev_ring_set(ipc_get_arg2(&call->data) != 0);
+
+	ipc_set_retval(&call->data, rc);
+	ipc_answer(&TASK->kb.box, call);
+}
+
+/** Process an EV_READ call.
+ *
+ * Reads recorded syscall events from the event ring of the current task.
+ * @param call	The call structure.
+ */
+static void udebug_receive_ev_read(call_t *call)
+{
+	uspace_addr_t uspace_addr;
+	size_t buf_size;
+	void *buffer;
+	size_t copied, needed, lost;
+	errno_t rc;
+
+	uspace_addr = ipc_get_arg2(&call->data);	/* Destination address */
+	buf_size = ipc_get_arg3(&call->data);	/* Dest. buffer size */
+
+	rc = udebug_ev_read(&buffer, buf_size, &copied, &needed, &lost);
+	if (rc != EOK) {
+		ipc_set_retval(&call->data, rc);
+		ipc_answer(&TASK->kb.box, call);
+		return;
+	}
+
+	/*
+	 * Make use of call->buffer to transfer data to caller's userspace
+	 */
+
+	ipc_set_retval(&call->data, EOK);
+	/*
+	 * ARG1=dest, ARG2=size as in IPC_M_DATA_READ so that
+	 * same code in process_answer() can be used
+	 * (no way to distinguish method in answer)
+	 */
+	ipc_set_arg1(&call->data, uspace_addr);
+	ipc_set_arg2(&call->data, copied);
+	ipc_set_arg3(&call->data, needed);
+	ipc_set_arg4(&call->data, lost);
+	call->buffer = buffer;
+
+	ipc_answer(&TASK->kb.box, call);
+}
+
 /** Handle a debug call received on the kernel answerbox.
  *
  * This is called by the kbox servicing thread. Verifies that the sender
@@ -455,6 +592,16 @@ void udebug_call_receive(call_t *call)
 		 * control exits this function.
 		 */
 		if (TASK->udebug.debugger != call->sender) {
+			/*
+			 * Drop any data attached to the call by request
+			 * preprocessing so that it is not copied out
+			 * by the answer processing.
+			 */
+			if (call->buffer) {
+				free(call->buffer);
+				call->buffer = NULL;
+			}
+
 			ipc_set_retval(&call->data, EINVAL);
 			ipc_answer(&TASK->kb.box, call);
 			return;
@@ -495,6 +642,15 @@ void udebug_call_receive(call_t *call)
 	case UDEBUG_M_MEM_READ:
 		udebug_receive_mem_read(call);
 		break;
+	case UDEBUG_M_MEM_READ_V:
+		udebug_receive_mem_read_v(call);
+		break;
+	case UDEBUG_M_SET_EVRING:
+		udebug_receive_set_evring(call);
+		break;
+	case UDEBUG_M_EV_READ:
+		udebug_receive_ev_read(call);
+		break;
 	}
 }
 
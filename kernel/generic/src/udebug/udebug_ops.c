@@ -51,6 +51,7 @@
 #include <udebug/udebug.h>
 #include <udebug/udebug_ops.h>
 #include <memw.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 /** Prepare a thread for a debugging operation.
@@ -264,7 +265,7 @@ errno_t udebug_go(thread_t *thread, call_t *call)
 	thread->udebug.cur_event = 0;  /* none */
 
 	/*
-	 * Neither thread's lock nor threads_lock may be held during wakeup.
+	 * Neither thread's lock nor the thread registry locks may be held during wakeup.
 	 *
 	 */
 	waitq_wake_all(&thread->udebug.go_wq);
@@ -563,5 +564,181 @@ errno_t udebug_mem_read(uspace_addr_t uspace_addr, size_t n, void **buffer)
 	return EOK;
 }
 
+/** Read several ranges of the debugged task's memory at once.
+ *
+ * Gathers the @a nranges ranges described by @a ranges from the address
+ * space of the debugged task into a single allocated buffer, packed back
+ * to back in order. A pointer to the buffer is written to @a buffer and
+ * its total size to @a size.
+ *
+ * @param ranges  Array of ranges to read.
+ * @param nranges Number of ranges in the array.
+ * @param buffer  For storing a pointer to the allocated buffer.
+ * @param size    For storing the total number of bytes read.
+ *
+ */
+errno_t udebug_mem_read_v(const udebug_mem_range_t *ranges, size_t nranges,
+    void **buffer, size_t *size)
+{
+	/* Verify task state */
+	mutex_lock(&TASK->udebug.lock);
+
+	if (TASK->udebug.dt_state != UDEBUG_TS_ACTIVE) {
+		mutex_unlock(&TASK->udebug.lock);
+		return EBUSY;
+	}
+
+	size_t total = 0;
+	for (size_t i = 0; i < nranges; i++) {
+		if (total + ranges[i].size < total) {
+			mutex_unlock(&TASK->udebug.lock);
+			return ELIMIT;
+		}
+
+		total += ranges[i].size;
+	}
+
+	void *data_buffer = malloc(total);
+	if (!data_buffer) {
+		mutex_unlock(&TASK->udebug.lock);
+		return ENOMEM;
+	}
+
+	size_t pos = 0;
+	errno_t rc = EOK;
+
+	for (size_t i = 0; i < nranges; i++) {
+		rc = copy_from_uspace((uint8_t *) data_buffer + pos,
+		    ranges[i].addr, ranges[i].size);
+		if (rc != EOK)
+			break;
+
+		pos += ranges[i].size;
+	}
+
+	mutex_unlock(&TASK->udebug.lock);
+
+	if (rc != EOK) {
+		free(data_buffer);
+		return rc;
+	}
+
+	*buffer = data_buffer;
+	*size = total;
+	return EOK;
+}
+
+/** Enable or disable the syscall event ring.
+ *
+ * While the ring is enabled, syscall events selected by the event mask
+ * are recorded into a per-task ring instead of stopping the thread and
+ * answering its GO call. The debugger drains the recorded events with
+ * udebug_ev_read(). Disabling the ring frees it and reverts to the
+ * one-event-per-GO protocol.
+ *
+ * @param enable Whether the ring should be enabled.
+ *
+ * @return Zero on success or an error code.
+ *
+ */
+errno_t udebug_ev_ring_set(bool enable)
+{
+	mutex_lock(&TASK->udebug.lock);
+
+	if (TASK->udebug.dt_state != UDEBUG_TS_ACTIVE) {
+		mutex_unlock(&TASK->udebug.lock);
+		return EINVAL;
+	}
+
+	if (enable) {
+		if (TASK->udebug.ev_ring == NULL) {
+			TASK->udebug.ev_ring = malloc(UDEBUG_EV_RING_SIZE *
+			    sizeof(udebug_ev_t));
+			if (TASK->udebug.ev_ring == NULL) {
+				mutex_unlock(&TASK->udebug.lock);
+				return ENOMEM;
+			}
+
+			TASK->udebug.ev_ring_head = 0;
+			TASK->udebug.ev_ring_count = 0;
+			TASK->udebug.ev_ring_lost = 0;
+		}
+	} else {
+		if (TASK->udebug.ev_ring != NULL) {
+			free(TASK->udebug.ev_ring);
+			TASK->udebug.ev_ring = NULL;
+		}
+	}
+
+	mutex_unlock(&TASK->udebug.lock);
+	return EOK;
+}
+
+/** Read and remove events from the syscall event ring.
+ *
+ * Copies as many of the oldest recorded events as fit into @a buf_size
+ * bytes into a newly allocated buffer and removes them from the ring.
+ * A pointer to the buffer is written to @a buffer, the number of bytes
+ * copied to @a stored and the number of bytes that were available to
+ * @a needed. The number of events lost to ring overflow since the last
+ * read is written to @a lost and the counter is reset.
+ *
+ * @param buffer   For storing a pointer to the allocated buffer.
+ * @param buf_size Size of the receiving userspace buffer in bytes.
+ * @param stored   The actual number of bytes copied will be stored here.
+ * @param needed   Total number of bytes that were available.
+ * @param lost     Number of events dropped due to ring overflow.
+ *
+ * @return EOK on success, EINVAL if there is no active debugging
+ *         session or the ring is not enabled, ENOMEM if memory
+ *         allocation failed.
+ *
+ */
+errno_t udebug_ev_read(void **buffer, size_t buf_size, size_t *stored,
+    size_t *needed, size_t *lost)
+{
+	mutex_lock(&TASK->udebug.lock);
+
+	if ((TASK->udebug.dt_state != UDEBUG_TS_ACTIVE) ||
+	    (TASK->udebug.ev_ring == NULL)) {
+		mutex_unlock(&TASK->udebug.lock);
+		return EINVAL;
+	}
+
+	size_t avail = TASK->udebug.ev_ring_count;
+	size_t ncopy = buf_size / sizeof(udebug_ev_t);
+	if (ncopy > avail)
+		ncopy = avail;
+
+	udebug_ev_t *ev_buffer = malloc(ncopy * sizeof(udebug_ev_t) + 1);
+	if (!ev_buffer) {
+		mutex_unlock(&TASK->udebug.lock);
+		return ENOMEM;
+	}
+
+	/* Copy out the oldest events and remove them from the ring. */
+
+	size_t tail = (TASK->udebug.ev_ring_head + UDEBUG_EV_RING_SIZE -
+	    avail) % UDEBUG_EV_RING_SIZE;
+
+	for (size_t i = 0; i < ncopy; i++) {
+		ev_buffer[i] = TASK->udebug.ev_ring[tail];
+		tail = (tail + 1) % UDEBUG_EV_RING_SIZE;
+	}
+
+	TASK->udebug.ev_ring_count -= ncopy;
+
+	*lost = TASK->udebug.ev_ring_lost;
+	TASK->udebug.ev_ring_lost = 0;
+
+	mutex_unlock(&TASK->udebug.lock);
+
+	*buffer = ev_buffer;
+	*stored = ncopy * sizeof(udebug_ev_t);
+	*needed = avail * sizeof(udebug_ev_t);
+
+	return EOK;
+}
+
 /** @}
  */
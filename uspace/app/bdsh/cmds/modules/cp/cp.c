@@ -30,6 +30,8 @@
 #include <str_error.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <fibril.h>
+#include <fibril_synch.h>
 #include <io/console.h>
 #include <io/keycode.h>
 #include <getopt.h>
@@ -44,7 +46,7 @@
 #include "cmds.h"
 
 #define CP_VERSION "0.0.1"
-#define CP_DEFAULT_BUFLEN  1024
+#define CP_DEFAULT_BUFLEN  (256 * 1024)
 
 static const char *cmdname = "cp";
 static console_ctrl_t *con;
@@ -66,6 +68,28 @@ typedef enum {
 	TYPE_DIR
 } dentry_type_t;
 
+/** State shared between the read fibril and the writer in copy_file() */
+typedef struct {
+	/** Source file */
+	int fd;
+	/** Size of each buffer */
+	size_t blen;
+	/** Data buffers, filled and drained in round-robin order */
+	char *buf[2];
+	/** Number of valid bytes in each buffer */
+	size_t nbytes[2];
+	/** Buffer holds data waiting to be written */
+	bool full[2];
+	/** Reader is finished (end of file or error) */
+	bool done;
+	/** Writer failed, reader should stop */
+	bool abort;
+	/** Reader result */
+	errno_t rc;
+	fibril_mutex_t lock;
+	fibril_condvar_t cv;
+} cp_stream_t;
+
 static int copy_file(const char *src, const char *dest,
     size_t blen, int vb);
 
@@ -390,16 +414,66 @@ exit:
 	return rc;
 }
 
+/** Read fibril filling the stream buffers from the source file.
+ *
+ * Runs ahead of the writer in copy_file() so that reading the next
+ * block overlaps with writing out the previous one.
+ *
+ * @param arg Argument (cp_stream_t *)
+ * @return EOK (unused)
+ */
+static errno_t read_fibril(void *arg)
+{
+	cp_stream_t *s = (cp_stream_t *) arg;
+	aoff64_t pos = 0;
+	unsigned int cur = 0;
+	size_t nread;
+	errno_t rc = EOK;
+
+	while (true) {
+		fibril_mutex_lock(&s->lock);
+		while (s->full[cur] && !s->abort)
+			fibril_condvar_wait(&s->cv, &s->lock);
+		if (s->abort) {
+			fibril_mutex_unlock(&s->lock);
+			break;
+		}
+		fibril_mutex_unlock(&s->lock);
+
+		rc = vfs_read(s->fd, &pos, s->buf[cur], s->blen, &nread);
+		if (rc != EOK || nread == 0)
+			break;
+
+		fibril_mutex_lock(&s->lock);
+		s->nbytes[cur] = nread;
+		s->full[cur] = true;
+		fibril_condvar_broadcast(&s->cv);
+		fibril_mutex_unlock(&s->lock);
+
+		cur = 1 - cur;
+	}
+
+	fibril_mutex_lock(&s->lock);
+	s->rc = rc;
+	s->done = true;
+	fibril_condvar_broadcast(&s->cv);
+	fibril_mutex_unlock(&s->lock);
+
+	return EOK;
+}
+
 static int copy_file(const char *src, const char *dest,
     size_t blen, int vb)
 {
 	int fd1, fd2;
-	size_t rbytes, wbytes;
+	size_t wbytes;
 	errno_t rc;
 	off64_t total;
-	char *buff = NULL;
-	aoff64_t posr = 0, posw = 0;
+	aoff64_t posw = 0;
 	vfs_stat_t st;
+	cp_stream_t stream;
+	unsigned int cur;
+	fid_t fid;
 
 	if (vb)
 		printf("Copying %s to %s\n", src, dest);
@@ -428,29 +502,76 @@ static int copy_file(const char *src, const char *dest,
 	if (vb)
 		printf("%" PRIu64 " bytes to copy\n", total);
 
-	if (NULL == (buff = (char *) malloc(blen))) {
+	memset(&stream, 0, sizeof(stream));
+	stream.fd = fd1;
+	stream.blen = blen;
+	fibril_mutex_initialize(&stream.lock);
+	fibril_condvar_initialize(&stream.cv);
+
+	stream.buf[0] = (char *) malloc(blen);
+	stream.buf[1] = (char *) malloc(blen);
+	if (stream.buf[0] == NULL || stream.buf[1] == NULL) {
 		printf("Unable to allocate enough memory to read %s\n",
 		    src);
 		rc = ENOMEM;
 		goto out;
 	}
 
-	while ((rc = vfs_read(fd1, &posr, buff, blen, &rbytes)) == EOK &&
-	    rbytes > 0) {
-		if ((rc = vfs_write(fd2, &posw, buff, rbytes, &wbytes)) != EOK)
+	fid = fibril_create(read_fibril, &stream);
+	if (fid == 0) {
+		printf("Unable to create read fibril\n");
+		rc = ENOMEM;
+		goto out;
+	}
+
+	fibril_add_ready(fid);
+
+	/* Write out the buffers as the read fibril fills them */
+	cur = 0;
+	while (true) {
+		fibril_mutex_lock(&stream.lock);
+		while (!stream.full[cur] && !stream.done)
+			fibril_condvar_wait(&stream.cv, &stream.lock);
+		if (!stream.full[cur]) {
+			/* End of file or read error */
+			rc = stream.rc;
+			fibril_mutex_unlock(&stream.lock);
 			break;
+		}
+		fibril_mutex_unlock(&stream.lock);
+
+		rc = vfs_write(fd2, &posw, stream.buf[cur],
+		    stream.nbytes[cur], &wbytes);
+
+		fibril_mutex_lock(&stream.lock);
+		if (rc != EOK)
+			stream.abort = true;
+		stream.full[cur] = false;
+		fibril_condvar_broadcast(&stream.cv);
+		fibril_mutex_unlock(&stream.lock);
+
+		if (rc != EOK)
+			break;
+
+		cur = 1 - cur;
 	}
 
-	if (rc != EOK) {
+	/* Wait for the read fibril to finish */
+	fibril_mutex_lock(&stream.lock);
+	while (!stream.done)
+		fibril_condvar_wait(&stream.cv, &stream.lock);
+	fibril_mutex_unlock(&stream.lock);
+
+	if (rc != EOK)
 		printf("\nError copying %s: %s\n", src, str_error(rc));
-		return -1;
-	}
 
 out:
 	vfs_put(fd1);
 	vfs_put(fd2);
-	if (buff)
-		free(buff);
+	if (stream.buf[0])
+		free(stream.buf[0]);
+	if (stream.buf[1])
+		free(stream.buf[1]);
 	if (rc != EOK) {
 		return -1;
 	} else {
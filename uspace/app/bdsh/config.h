@@ -57,6 +57,9 @@
 #define WORD_MAX 1023
 #define INPUT_MAX 4096
 
+/* How many pipes are permitted in a single command line */
+#define PIPE_MAX 8
+
 /* Leftovers from Autoconf */
 #define PACKAGE_MAINTAINER "Tim Post"
 #define PACKAGE_BUGREPORT "echo@echoreply.us"
@@ -101,7 +101,7 @@ static errno_t process_input_nohup(cliuser_t *usr, list_t *alias_hups, size_t co
 	errno_t rc = EOK;
 	tokenizer_t tok;
 	unsigned int i, pipe_count, processed_pipes;
-	unsigned int pipe_pos[2];
+	unsigned int pipe_pos[PIPE_MAX];
 	char *redir_from = NULL;
 	char *redir_to = NULL;
 
@@ -131,14 +131,20 @@ static errno_t process_input_nohup(cliuser_t *usr, list_t *alias_hups, size_t co
 	}
 
 	/*
-	 * Until full support for pipes is implemented, allow for a simple case:
-	 * [from <file> |] command [| to <file>]
+	 * A command line may consist of several stages separated by pipes:
+	 *
+	 *   [from <file> |] command [| command]... [| to <file>]
+	 *
+	 * The first and last stage may redirect from/to a file. The output
+	 * of each stage is staged into an anonymous temporary file which
+	 * the next stage reads (VFS provides no pipe object that would
+	 * allow streaming between concurrently running stages).
 	 *
 	 * First find the pipes and check that there are no more
 	 */
 	for (i = 0, pipe_count = 0; i < tokens_length; i++) {
 		if (tokens[i].type == TOKTYPE_PIPE) {
-			if (pipe_count >= 2) {
+			if (pipe_count >= PIPE_MAX) {
 				print_pipe_usage();
 				rc = ENOTSUP;
 				goto finit;
@@ -161,27 +167,39 @@ static errno_t process_input_nohup(cliuser_t *usr, list_t *alias_hups, size_t co
 		processed_pipes++;
 	}
 
-	/* Check if the second part (| to <file>) is present */
+	/* Check if the last part (| to <file>) is present */
 	if ((pipe_count - processed_pipes) > 0 &&
-	    (pipe_pos[processed_pipes] == tokens_length - 4 ||
-	    (pipe_pos[processed_pipes] == tokens_length - 5 &&
+	    (pipe_pos[pipe_count - 1] == tokens_length - 4 ||
+	    (pipe_pos[pipe_count - 1] == tokens_length - 5 &&
 	    tokens[tokens_length - 4].type == TOKTYPE_SPACE)) &&
 	    str_cmp(tokens[tokens_length - 3].text, "to") == 0) {
 		/* Ignore the last three tokens (pipe, to, file) and set to */
 		redir_to = tokens[tokens_length - 1].text;
-		cmd_token_end = pipe_pos[processed_pipes];
+		cmd_token_end = pipe_pos[pipe_count - 1];
 		processed_pipes++;
 	}
 
-	if (processed_pipes != pipe_count) {
-		print_pipe_usage();
-		rc = ENOTSUP;
-		goto finit;
+	/* Split the remaining tokens into pipeline stages */
+	unsigned int stage_start[PIPE_MAX + 1];
+	unsigned int stage_end[PIPE_MAX + 1];
+	unsigned int nstages = 0;
+	unsigned int start = cmd_token_start;
+
+	for (i = cmd_token_start; i < cmd_token_end; i++) {
+		if (tokens[i].type == TOKTYPE_PIPE) {
+			stage_start[nstages] = start;
+			stage_end[nstages] = i;
+			nstages++;
+			start = i + 1;
+		}
 	}
+	stage_start[nstages] = start;
+	stage_end[nstages] = cmd_token_end;
+	nstages++;
 
-	/* Convert tokens of the command to string array */
+	/* Convert tokens of the first stage to string array */
 	unsigned int cmd_pos = 0;
-	for (i = cmd_token_start; i < cmd_token_end; i++) {
+	for (i = stage_start[0]; i < stage_end[0]; i++) {
 		if (tokens[i].type != TOKTYPE_SPACE) {
 			cmd[cmd_pos++] = tokens[i].text;
 		}
@@ -252,6 +270,9 @@ static errno_t process_input_nohup(cliuser_t *usr, list_t *alias_hups, size_t co
 
 	FILE *from = NULL;
 	FILE *to = NULL;
+	FILE *pin = NULL;
+	FILE *pout = NULL;
+	unsigned int stage;
 
 	if (redir_from) {
 		from = fopen(redir_from, "r");
@@ -260,7 +281,6 @@ static errno_t process_input_nohup(cliuser_t *usr, list_t *alias_hups, size_t co
 			rc = errno;
 			goto finit_with_files;
 		}
-		new_iostate.stdin = from;
 	}
 
 	if (redir_to) {
@@ -270,16 +290,71 @@ static errno_t process_input_nohup(cliuser_t *usr, list_t *alias_hups, size_t co
 			rc = errno;
 			goto finit_with_files;
 		}
-		new_iostate.stdout = to;
 	}
 
-	if (run_command(cmd, usr, &new_iostate) == 0) {
-		rc = EOK;
-	} else {
-		rc = EINVAL;
+	/* The first stage reads from the 'from' file (if any) */
+	pin = from;
+	from = NULL;
+
+	for (stage = 0; stage < nstages; stage++) {
+		/* Convert tokens of the stage to string array */
+		cmd_pos = 0;
+		for (i = stage_start[stage]; i < stage_end[stage]; i++) {
+			if (tokens[i].type != TOKTYPE_SPACE) {
+				cmd[cmd_pos++] = tokens[i].text;
+			}
+		}
+		cmd[cmd_pos++] = NULL;
+
+		if (cmd[0] == NULL) {
+			print_pipe_usage();
+			rc = ENOTSUP;
+			goto finit_with_files;
+		}
+
+		if (stage < nstages - 1) {
+			/* Stage output into an anonymous temporary file */
+			pout = tmpfile();
+			if (pout == NULL) {
+				printf("Cannot create temporary file\n");
+				rc = EIO;
+				goto finit_with_files;
+			}
+		} else {
+			pout = to;
+		}
+
+		new_iostate.stdin = (pin != NULL) ? pin : stdin;
+		new_iostate.stdout = (pout != NULL) ? pout : stdout;
+
+		if (run_command(cmd, usr, &new_iostate) != 0) {
+			rc = EINVAL;
+			goto finit_with_files;
+		}
+
+		/* This stage's input is no longer needed */
+		if (pin != NULL) {
+			fclose(pin);
+			pin = NULL;
+		}
+
+		if (stage < nstages - 1) {
+			/* The next stage reads what this stage wrote */
+			rewind(pout);
+			pin = pout;
+			pout = NULL;
+		}
 	}
 
+	rc = EOK;
+
 finit_with_files:
+	if (pout != NULL && pout != to) {
+		fclose(pout);
+	}
+	if (pin != NULL) {
+		fclose(pin);
+	}
 	if (from != NULL) {
 		fclose(from);
 	}
@@ -316,10 +391,11 @@ errno_t process_input(cliuser_t *usr)
 void print_pipe_usage(void)
 {
 	printf("Invalid syntax!\n");
-	printf("Usage of redirection (pipes in the future):\n");
+	printf("Usage of pipes and redirection:\n");
 	printf("from filename | command ...\n");
-	printf("from filename | command ... | to filename\n");
 	printf("command ... | to filename\n");
+	printf("command ... | command ...\n");
+	printf("from filename | command ... | command ... | to filename\n");
 
 }
 
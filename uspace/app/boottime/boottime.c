@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup boottime
+ * @{
+ */
+/** @file boottime.c
+ * @brief Report boot milestone timing.
+ *
+ * Fetch the table of boot milestones recorded by the kernel and the
+ * boot-time user space components via the boottime.data sysinfo item
+ * and print it, with the time elapsed between consecutive
+ * milestones. Milestones recorded before the kernel clock started
+ * ticking have no uptime; for those the raw cycle counter deltas are
+ * the only measure.
+ */
+
+#include <abi/sysinfo.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sysinfo.h>
+
+#define NAME  "boottime"
+
+int main(int argc, char *argv[])
+{
+	size_t size;
+	boottime_entry_t *entries = sysinfo_get_data("boottime.data", &size);
+	if (entries == NULL) {
+		fprintf(stderr, "%s: Unable to get boot milestone data.\n",
+		    NAME);
+		return 1;
+	}
+
+	size_t count = size / sizeof(boottime_entry_t);
+	if (count == 0) {
+		printf("No boot milestones recorded.\n");
+		free(entries);
+		return 0;
+	}
+
+	printf("%12s %12s %16s  %s\n", "uptime [s]", "delta [ms]",
+	    "delta [cycles]", "milestone");
+
+	for (size_t i = 0; i < count; i++) {
+		boottime_entry_t *entry = &entries[i];
+
+		if (entry->usec != 0) {
+			printf("%5" PRIu64 ".%06" PRIu64 " ",
+			    entry->usec / 1000000, entry->usec % 1000000);
+		} else {
+			printf("%12s ", "-");
+		}
+
+		if ((i > 0) && (entry->usec != 0) &&
+		    (entries[i - 1].usec != 0)) {
+			uint64_t delta = entry->usec - entries[i - 1].usec;
+			printf("%8" PRIu64 ".%03" PRIu64 " ", delta / 1000,
+			    delta % 1000);
+		} else {
+			printf("%12s ", "-");
+		}
+
+		if (i > 0) {
+			printf("%16" PRIu64 "  ",
+			    entry->cycles - entries[i - 1].cycles);
+		} else {
+			printf("%16s  ", "-");
+		}
+
+		printf("%s\n", entry->name);
+	}
+
+	free(entries);
+	return 0;
+}
+
+/** @}
+ */
@@ -116,10 +116,12 @@ int main()
     ts.add<std::test::numeric_test>();
     ts.add<std::test::adaptors_test>();
     ts.add<std::test::memory_test>();
+    ts.add<std::test::memory_resource_test>();
     ts.add<std::test::list_test>();
     ts.add<std::test::ratio_test>();
     ts.add<std::test::functional_test>();
     ts.add<std::test::algorithm_test>();
+    ts.add<std::test::execution_test>();
     ts.add<std::test::future_test>();
 
     return ts.run(true) ? 0 : 1;
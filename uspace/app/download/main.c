@@ -35,7 +35,11 @@
  *
  */
 
+#include <adt/list.h>
+#include <assert.h>
 #include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str.h>
@@ -44,6 +48,7 @@
 #include <macros.h>
 
 #include <http/http.h>
+#include <http/pool.h>
 #include <uri.h>
 
 #define NAME "download"
@@ -54,13 +59,353 @@
 #endif
 #define USER_AGENT "HelenOS-" NAME "/" VERSION
 
+/** Size of one ranged request in parallel mode */
+#define CHUNK_SIZE (1024 * 1024)
+/** Maximum number of parallel connections */
+#define MAX_CONNS 8
+
+/** State shared by the parallel download fibrils */
+typedef struct {
+	const char *host;
+	uint16_t port;
+	const char *path;
+	/** Total size of the file */
+	size_t total_size;
+	/** Total number of chunks */
+	size_t nchunks;
+	/** Next chunk to hand out to a worker */
+	size_t next_chunk;
+	/** Next chunk to write to the output */
+	size_t next_write;
+	/** Completed chunks not yet written out */
+	list_t done; /* of dl_chunk_t */
+	/** Number of chunks on @c done */
+	size_t ndone;
+	/** Bound on @c ndone (backpressure for reassembly) */
+	size_t max_done;
+	/** Number of worker fibrils still running */
+	size_t nrunning;
+	/** First error encountered */
+	errno_t rc;
+	http_pool_t *pool;
+	fibril_mutex_t lock;
+	fibril_condvar_t cv;
+} dl_state_t;
+
+/** One completed chunk awaiting reassembly */
+typedef struct {
+	link_t link;
+	/** Chunk index */
+	size_t index;
+	/** Chunk data */
+	void *data;
+	/** Chunk size */
+	size_t size;
+} dl_chunk_t;
+
 static void syntax_print(void)
 {
-	fprintf(stderr, "Usage: download [-o <outfile>] <url>\n");
+	fprintf(stderr, "Usage: download [-o <outfile>] [-n <conns>] <url>\n");
 	fprintf(stderr, "  Without -o, data will be written to stdout, so you may want\n");
 	fprintf(stderr, "  to redirect the output, e.g.\n");
 	fprintf(stderr, "\n");
 	fprintf(stderr, "    download http://helenos.org/ | to helenos.html\n\n");
+	fprintf(stderr, "  With -n, up to <conns> connections download byte ranges\n");
+	fprintf(stderr, "  of the file in parallel (the server must support ranges).\n\n");
+}
+
+/** Create a request for the file with the standard headers. */
+static http_request_t *dl_request_create(dl_state_t *dl, const char *method)
+{
+	http_request_t *req = http_request_create(method, dl->path);
+	if (req == NULL)
+		return NULL;
+
+	errno_t rc = http_headers_append(&req->headers, "Host", dl->host);
+	if (rc != EOK) {
+		http_request_destroy(req);
+		return NULL;
+	}
+
+	rc = http_headers_append(&req->headers, "User-Agent", USER_AGENT);
+	if (rc != EOK) {
+		http_request_destroy(req);
+		return NULL;
+	}
+
+	return req;
+}
+
+/** Determine the total file size with a HEAD request. */
+static errno_t dl_get_size(dl_state_t *dl, size_t *out_size)
+{
+	http_t *http = NULL;
+	errno_t rc = http_pool_get(dl->pool, dl->host, dl->port, &http);
+	if (rc != EOK)
+		return rc;
+
+	http_request_t *req = dl_request_create(dl, "HEAD");
+	if (req == NULL) {
+		http_destroy(http);
+		return ENOMEM;
+	}
+
+	rc = http_send_request(http, req);
+	http_request_destroy(req);
+	if (rc != EOK) {
+		http_destroy(http);
+		return rc;
+	}
+
+	http_response_t *response = NULL;
+	rc = http_receive_response(&http->recv_buffer, &response, 16 * 1024,
+	    100);
+	if (rc != EOK) {
+		http_destroy(http);
+		return rc;
+	}
+
+	if (response->status != 200) {
+		http_response_destroy(response);
+		http_destroy(http);
+		return EIO;
+	}
+
+	rc = http_response_body_size(response, out_size);
+
+	if (rc == EOK && http_response_keep_alive(response))
+		http_pool_put(dl->pool, http);
+	else
+		http_destroy(http);
+
+	http_response_destroy(response);
+	return rc;
+}
+
+/** Fetch one chunk over a (pooled) connection. */
+static errno_t dl_fetch_chunk(dl_state_t *dl, size_t index, dl_chunk_t **out)
+{
+	size_t start = index * CHUNK_SIZE;
+	size_t size = min(CHUNK_SIZE, dl->total_size - start);
+
+	http_t *http = NULL;
+	errno_t rc = http_pool_get(dl->pool, dl->host, dl->port, &http);
+	if (rc != EOK)
+		return rc;
+
+	http_request_t *req = dl_request_create(dl, "GET");
+	if (req == NULL) {
+		http_destroy(http);
+		return ENOMEM;
+	}
+
+	char *range = NULL;
+	int ret = asprintf(&range, "bytes=%zu-%zu", start, start + size - 1);
+	if (ret < 0) {
+		http_request_destroy(req);
+		http_destroy(http);
+		return ENOMEM;
+	}
+
+	rc = http_headers_append(&req->headers, "Range", range);
+	free(range);
+	if (rc != EOK) {
+		http_request_destroy(req);
+		http_destroy(http);
+		return rc;
+	}
+
+	rc = http_send_request(http, req);
+	http_request_destroy(req);
+	if (rc != EOK) {
+		http_destroy(http);
+		return rc;
+	}
+
+	http_response_t *response = NULL;
+	rc = http_receive_response(&http->recv_buffer, &response, 16 * 1024,
+	    100);
+	if (rc != EOK) {
+		http_destroy(http);
+		return rc;
+	}
+
+	if (response->status != 206) {
+		fprintf(stderr, "Server does not support ranges "
+		    "(status %d)\n", response->status);
+		http_response_destroy(response);
+		http_destroy(http);
+		return EIO;
+	}
+
+	dl_chunk_t *chunk = calloc(1, sizeof(dl_chunk_t));
+	if (chunk == NULL) {
+		http_response_destroy(response);
+		http_destroy(http);
+		return ENOMEM;
+	}
+
+	link_initialize(&chunk->link);
+	chunk->index = index;
+	chunk->size = size;
+	chunk->data = malloc(size);
+	if (chunk->data == NULL) {
+		rc = ENOMEM;
+		goto error;
+	}
+
+	size_t done = 0;
+	while (done < size) {
+		size_t nrecv;
+		rc = recv_buffer(&http->recv_buffer,
+		    (char *)chunk->data + done, size - done, &nrecv);
+		if (rc != EOK)
+			goto error;
+		if (nrecv == 0) {
+			rc = EIO;
+			goto error;
+		}
+		done += nrecv;
+	}
+
+	if (http_response_keep_alive(response))
+		http_pool_put(dl->pool, http);
+	else
+		http_destroy(http);
+
+	http_response_destroy(response);
+	*out = chunk;
+	return EOK;
+error:
+	free(chunk->data);
+	free(chunk);
+	http_response_destroy(response);
+	http_destroy(http);
+	return rc;
+}
+
+/** Worker fibril fetching chunks until none are left or an error occurs. */
+static errno_t dl_worker(void *arg)
+{
+	dl_state_t *dl = arg;
+
+	while (true) {
+		fibril_mutex_lock(&dl->lock);
+		while (dl->rc == EOK && dl->next_chunk < dl->nchunks &&
+		    dl->ndone >= dl->max_done)
+			fibril_condvar_wait(&dl->cv, &dl->lock);
+
+		if (dl->rc != EOK || dl->next_chunk >= dl->nchunks) {
+			fibril_mutex_unlock(&dl->lock);
+			break;
+		}
+
+		size_t index = dl->next_chunk++;
+		fibril_mutex_unlock(&dl->lock);
+
+		dl_chunk_t *chunk = NULL;
+		errno_t rc = dl_fetch_chunk(dl, index, &chunk);
+
+		fibril_mutex_lock(&dl->lock);
+		if (rc != EOK) {
+			if (dl->rc == EOK)
+				dl->rc = rc;
+		} else {
+			list_append(&chunk->link, &dl->done);
+			dl->ndone++;
+		}
+		fibril_condvar_broadcast(&dl->cv);
+		fibril_mutex_unlock(&dl->lock);
+
+		if (rc != EOK)
+			break;
+	}
+
+	fibril_mutex_lock(&dl->lock);
+	dl->nrunning--;
+	fibril_condvar_broadcast(&dl->cv);
+	fibril_mutex_unlock(&dl->lock);
+	return EOK;
+}
+
+/** Find the next chunk due for writing on the done list. */
+static dl_chunk_t *dl_next_done(dl_state_t *dl)
+{
+	assert(fibril_mutex_is_locked(&dl->lock));
+
+	list_foreach(dl->done, link, dl_chunk_t, chunk) {
+		if (chunk->index == dl->next_write)
+			return chunk;
+	}
+
+	return NULL;
+}
+
+/** Download a file over @a nconns parallel connections.
+ *
+ * Worker fibrils each pull one byte range at a time; this fibril
+ * reassembles the chunks in order to the output file.
+ */
+static errno_t dl_parallel(dl_state_t *dl, size_t nconns, FILE *ofile)
+{
+	errno_t rc = dl_get_size(dl, &dl->total_size);
+	if (rc != EOK) {
+		fprintf(stderr, "Failed determining file size: %s\n",
+		    str_error(rc));
+		return rc;
+	}
+
+	dl->nchunks = (dl->total_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	dl->max_done = 2 * nconns;
+
+	for (size_t i = 0; i < nconns; i++) {
+		fid_t fid = fibril_create(dl_worker, dl);
+		if (fid == 0)
+			break;
+		dl->nrunning++;
+		fibril_add_ready(fid);
+	}
+
+	if (dl->nrunning == 0)
+		return ENOMEM;
+
+	fibril_mutex_lock(&dl->lock);
+	while (dl->next_write < dl->nchunks && dl->rc == EOK) {
+		dl_chunk_t *chunk = dl_next_done(dl);
+		if (chunk == NULL) {
+			fibril_condvar_wait(&dl->cv, &dl->lock);
+			continue;
+		}
+
+		list_remove(&chunk->link);
+		dl->ndone--;
+		dl->next_write++;
+		fibril_condvar_broadcast(&dl->cv);
+		fibril_mutex_unlock(&dl->lock);
+
+		fwrite(chunk->data, 1, chunk->size, ofile);
+		free(chunk->data);
+		free(chunk);
+
+		fibril_mutex_lock(&dl->lock);
+	}
+
+	rc = dl->rc;
+
+	/* Wait for the workers to finish before tearing down */
+	while (dl->nrunning > 0)
+		fibril_condvar_wait(&dl->cv, &dl->lock);
+
+	link_t *link;
+	while ((link = list_first(&dl->done)) != NULL) {
+		dl_chunk_t *chunk = list_get_instance(link, dl_chunk_t, link);
+		list_remove(link);
+		free(chunk->data);
+		free(chunk);
+	}
+
+	fibril_mutex_unlock(&dl->lock);
+	return rc;
 }
 
 int main(int argc, char *argv[])
@@ -72,6 +417,7 @@ int main(int argc, char *argv[])
 	void *buf = NULL;
 	uri_t *uri = NULL;
 	http_t *http = NULL;
+	uint16_t nconns = 1;
 	errno_t rc;
 	int ret;
 
@@ -83,21 +429,44 @@ int main(int argc, char *argv[])
 
 	i = 1;
 
-	if (str_cmp(argv[i], "-o") == 0) {
-		++i;
-		if (argc < i + 1) {
+	while (i < argc && argv[i][0] == '-') {
+		if (str_cmp(argv[i], "-o") == 0) {
+			++i;
+			if (argc < i + 1) {
+				syntax_print();
+				rc = EINVAL;
+				goto error;
+			}
+
+			ofname = argv[i++];
+			ofile = fopen(ofname, "wb");
+			if (ofile == NULL) {
+				fprintf(stderr, "Error creating '%s'.\n", ofname);
+				rc = EINVAL;
+				goto error;
+			}
+		} else if (str_cmp(argv[i], "-n") == 0) {
+			++i;
+			if (argc < i + 1) {
+				syntax_print();
+				rc = EINVAL;
+				goto error;
+			}
+
+			rc = str_uint16_t(argv[i++], NULL, 10, true, &nconns);
+			if (rc != EOK || nconns == 0) {
+				fprintf(stderr, "Invalid number of "
+				    "connections\n");
+				rc = EINVAL;
+				goto error;
+			}
+
+			nconns = min(nconns, MAX_CONNS);
+		} else {
 			syntax_print();
 			rc = EINVAL;
 			goto error;
 		}
-
-		ofname = argv[i++];
-		ofile = fopen(ofname, "wb");
-		if (ofile == NULL) {
-			fprintf(stderr, "Error creating '%s'.\n", ofname);
-			rc = EINVAL;
-			goto error;
-		}
 	}
 
 	if (argc != i + 1) {
@@ -163,6 +532,50 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (nconns > 1) {
+		dl_state_t dl;
+
+		dl.host = uri->host;
+		dl.port = port;
+		dl.path = server_path;
+		dl.total_size = 0;
+		dl.nchunks = 0;
+		dl.next_chunk = 0;
+		dl.next_write = 0;
+		list_initialize(&dl.done);
+		dl.ndone = 0;
+		dl.max_done = 0;
+		dl.nrunning = 0;
+		dl.rc = EOK;
+		fibril_mutex_initialize(&dl.lock);
+		fibril_condvar_initialize(&dl.cv);
+
+		dl.pool = http_pool_create(nconns);
+		if (dl.pool == NULL) {
+			fprintf(stderr, "Failed creating connection pool\n");
+			free(server_path);
+			rc = ENOMEM;
+			goto error;
+		}
+
+		rc = dl_parallel(&dl, nconns, ofile != NULL ? ofile : stdout);
+		http_pool_destroy(dl.pool);
+		free(server_path);
+		if (rc != EOK) {
+			fprintf(stderr, "Download failed: %s\n", str_error(rc));
+			rc = EIO;
+			goto error;
+		}
+
+		uri_destroy(uri);
+		if (ofile != NULL && fclose(ofile) != 0) {
+			printf("Error writing '%s'.\n", ofname);
+			return EIO;
+		}
+
+		return EOK;
+	}
+
 	http_request_t *req = http_request_create("GET", server_path);
 	free(server_path);
 	if (req == NULL) {
@@ -47,6 +47,7 @@
 #include <io/keycode.h>
 #include <io/pos_event.h>
 #include <io/style.h>
+#include <limits.h>
 #include <macros.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -74,7 +75,8 @@ enum redraw_flags {
 	REDRAW_TEXT	= (1 << 0),
 	REDRAW_ROW	= (1 << 1),
 	REDRAW_STATUS	= (1 << 2),
-	REDRAW_CARET	= (1 << 3)
+	REDRAW_CARET	= (1 << 3),
+	REDRAW_RANGE	= (1 << 4)
 };
 
 /** Pane
@@ -111,6 +113,11 @@ typedef struct {
 	/** Bitmask of components that need redrawing */
 	enum redraw_flags rflags;
 
+	/** First damaged document row (inclusive, for REDRAW_RANGE) */
+	int dmg_r0;
+	/** Last damaged document row (exclusive, for REDRAW_RANGE) */
+	int dmg_r1;
+
 	/** Current position of the caret */
 	tag_t caret_pos;
 
@@ -190,6 +197,8 @@ static errno_t pane_update(pane_t *);
 static errno_t pane_text_display(pane_t *);
 static void pane_row_display(void);
 static errno_t pane_row_range_display(pane_t *, int r0, int r1);
+static void pane_damage_rows(int, int);
+static errno_t pane_range_display(pane_t *);
 static void pane_status_display(pane_t *);
 static void pane_caret_display(pane_t *);
 
@@ -823,7 +832,7 @@ static void pos_handle(pos_event_t *ev)
 static void caret_move(spt_t new_caret_pt, bool select, bool update_ideal_column)
 {
 	spt_t old_caret_pt, old_sel_pt;
-	coord_t c_old, c_new;
+	coord_t c_old, c_new, c_sel;
 	bool had_sel;
 
 	/* Check if we had selection before. */
@@ -845,14 +854,19 @@ static void caret_move(spt_t new_caret_pt, bool select, bool update_ideal_column
 	if (select) {
 		spt_get_coord(&old_caret_pt, &c_old);
 
-		if (c_old.row == c_new.row)
+		if (c_old.row == c_new.row) {
 			pane.rflags |= REDRAW_ROW;
-		else
-			pane.rflags |= REDRAW_TEXT;
-
+		} else {
+			/* Redraw the rows the selection grew or shrank by. */
+			pane_damage_rows(min(c_old.row, c_new.row),
+			    max(c_old.row, c_new.row) + 1);
+		}
 	} else if (had_sel == true) {
-		/* Redraw because text was unselected. */
-		pane.rflags |= REDRAW_TEXT;
+		/* Redraw the formerly selected rows. */
+		spt_get_coord(&old_caret_pt, &c_old);
+		spt_get_coord(&old_sel_pt, &c_sel);
+		pane_damage_rows(min(c_old.row, c_sel.row),
+		    max(c_old.row, c_sel.row) + 1);
 	}
 
 	if (update_ideal_column)
@@ -1155,6 +1169,10 @@ static errno_t pane_update(pane_t *pane)
 		rc = pane_text_display(pane);
 		if (rc != EOK)
 			return rc;
+	} else if (pane->rflags & REDRAW_RANGE) {
+		rc = pane_range_display(pane);
+		if (rc != EOK)
+			return rc;
 	}
 
 	if (pane->rflags & REDRAW_ROW)
@@ -1167,7 +1185,7 @@ static errno_t pane_update(pane_t *pane)
 		pane_caret_display(pane);
 
 	pane->rflags &= ~(REDRAW_TEXT | REDRAW_ROW | REDRAW_STATUS |
-	    REDRAW_CARET);
+	    REDRAW_CARET | REDRAW_RANGE);
 	return EOK;
 }
 
@@ -1369,6 +1387,47 @@ static errno_t pane_row_range_display(pane_t *pane, int r0, int r1)
 	return EOK;
 }
 
+/** Mark a range of document rows as needing redraw.
+ *
+ * The accumulated range is repainted by the next pane update unless
+ * a full repaint is scheduled anyway. Rows shifted by an insertion
+ * or deletion of a line should be damaged up to @c INT_MAX, which
+ * stands for the rest of the visible area.
+ *
+ * @param r0 First damaged row (inclusive)
+ * @param r1 Last damaged row (exclusive)
+ */
+static void pane_damage_rows(int r0, int r1)
+{
+	if ((pane.rflags & REDRAW_RANGE) == 0) {
+		pane.dmg_r0 = r0;
+		pane.dmg_r1 = r1;
+		pane.rflags |= REDRAW_RANGE;
+	} else {
+		pane.dmg_r0 = min(pane.dmg_r0, r0);
+		pane.dmg_r1 = max(pane.dmg_r1, r1);
+	}
+}
+
+/** Display the damaged row range.
+ *
+ * @param pane Pane
+ * @return EOK on success or an error code
+ */
+static errno_t pane_range_display(pane_t *pane)
+{
+	int r0, r1;
+
+	r0 = max(pane->dmg_r0 - pane->sh_row, 0);
+	r1 = (pane->dmg_r1 == INT_MAX) ? pane->rows :
+	    min(pane->dmg_r1 - pane->sh_row, pane->rows);
+
+	if (r0 >= r1)
+		return EOK;
+
+	return pane_row_range_display(pane, r0, r1);
+}
+
 /** Display pane status in the status line.
  *
  * @param pane Pane
@@ -1538,10 +1597,12 @@ static ui_evclaim_t pane_ctl_pos_event(void *arg, pos_event_t *event)
 static void insert_char(char32_t c)
 {
 	spt_t pt;
+	coord_t coord;
 	char cbuf[STR_BOUNDS(1) + 1];
 	size_t offs;
 
 	tag_get_pt(&pane.caret_pos, &pt);
+	spt_get_coord(&pt, &coord);
 
 	offs = 0;
 	chr_encode(c, cbuf, &offs, STR_BOUNDS(1) + 1);
@@ -1550,8 +1611,10 @@ static void insert_char(char32_t c)
 	(void) sheet_insert(doc.sh, &pt, dir_before, cbuf);
 
 	pane.rflags |= REDRAW_ROW;
-	if (c == '\n')
-		pane.rflags |= REDRAW_TEXT;
+	if (c == '\n') {
+		/* Following rows shift down. */
+		pane_damage_rows(coord.row, INT_MAX);
+	}
 }
 
 /** Delete the character before the caret. */
@@ -1569,8 +1632,10 @@ static void delete_char_before(void)
 	(void) sheet_delete(doc.sh, &sp, &ep);
 
 	pane.rflags |= REDRAW_ROW;
-	if (coord.column < 1)
-		pane.rflags |= REDRAW_TEXT;
+	if (coord.column < 1) {
+		/* Following rows shift up. */
+		pane_damage_rows(coord.row - 1, INT_MAX);
+	}
 }
 
 /** Delete the character after the caret. */
@@ -1588,8 +1653,10 @@ static void delete_char_after(void)
 	(void) sheet_delete(doc.sh, &sp, &ep);
 
 	pane.rflags |= REDRAW_ROW;
-	if (ec.row != sc.row)
-		pane.rflags |= REDRAW_TEXT;
+	if (ec.row != sc.row) {
+		/* Following rows shift up. */
+		pane_damage_rows(sc.row, INT_MAX);
+	}
 }
 
 /** Scroll pane after caret has moved.
@@ -1942,10 +2009,12 @@ static void selection_delete(void)
 	else
 		sheet_delete(doc.sh, &pb, &pa);
 
-	if (ca.row == cb.row)
+	if (ca.row == cb.row) {
 		pane.rflags |= REDRAW_ROW;
-	else
-		pane.rflags |= REDRAW_TEXT;
+	} else {
+		/* Following rows shift up. */
+		pane_damage_rows(min(ca.row, cb.row), INT_MAX);
+	}
 }
 
 /** Select all text in the editor */
@@ -31,7 +31,7 @@
  */
 /**
  * @file
- * @brief Prototype implementation of Sheet data structure.
+ * @brief Implementation of Sheet data structure.
  *
  * The sheet is an abstract data structure representing a piece of text.
  * On top of this data structure we can implement a text editor. It is
@@ -43,9 +43,14 @@
  * versa. The text that is inserted or deleted can contain tabs and newlines
  * which are interpreted and properly acted upon.
  *
- * This is a trivial implementation with poor efficiency with O(N+n)
- * insertion and deletion and O(N) mapping (in both directions), where
- * N is the size of the file and n is the size of the inserted/deleted text.
+ * The text is stored in a gap buffer: a single allocation with a movable
+ * hole at the point of the last modification. Insertion and deletion thus
+ * cost O(d+n) where d is the distance from the previous modification and
+ * n is the size of the inserted/deleted text, which is amortized O(n) for
+ * localized editing. An index of line start offsets is maintained along
+ * with the text, so mapping between coordinates and file positions costs
+ * O(log L) plus a walk over a single line instead of a scan of the whole
+ * file.
  */
 
 #include <stdlib.h>
@@ -61,10 +66,121 @@
 enum {
 	TAB_WIDTH	= 8,
 
-	/** Initial  of dat buffer in bytes */
-	INITIAL_SIZE	= 32
+	/** Initial size of data buffer in bytes */
+	INITIAL_SIZE	= 32,
+
+	/** Initial number of entries in the line index */
+	INITIAL_LINES	= 16
 };
 
+/** Get the size of the gap. */
+static size_t sheet_gap_size(sheet_t *sh)
+{
+	return sh->dbuf_size - sh->text_size;
+}
+
+/** Move the gap to the specified logical offset. */
+static void sheet_move_gap(sheet_t *sh, size_t off)
+{
+	size_t gap_size = sheet_gap_size(sh);
+
+	if (off < sh->gap_off) {
+		memmove(sh->data + off + gap_size, sh->data + off,
+		    sh->gap_off - off);
+	} else if (off > sh->gap_off) {
+		memmove(sh->data + sh->gap_off,
+		    sh->data + sh->gap_off + gap_size, off - sh->gap_off);
+	}
+
+	sh->gap_off = off;
+}
+
+/** Copy text out of the sheet, bridging the gap if needed.
+ *
+ * @param sh   Sheet to read from.
+ * @param off  Logical offset to start reading at.
+ * @param size Number of bytes to read.
+ * @param dest Destination buffer.
+ */
+static void sheet_read(sheet_t *sh, size_t off, size_t size, char *dest)
+{
+	size_t part;
+
+	if (off < sh->gap_off) {
+		part = min(size, sh->gap_off - off);
+		memcpy(dest, sh->data + off, part);
+		off += part;
+		dest += part;
+		size -= part;
+	}
+
+	if (size > 0)
+		memcpy(dest, sh->data + off + sheet_gap_size(sh), size);
+}
+
+/** Decode a character at a logical offset and advance the offset. */
+static char32_t sheet_decode(sheet_t *sh, size_t *off)
+{
+	char buf[STR_BOUNDS(1)];
+	size_t avail;
+	size_t loff;
+	char32_t c;
+
+	avail = min(sh->text_size - *off, (size_t) STR_BOUNDS(1));
+	sheet_read(sh, *off, avail, buf);
+
+	loff = 0;
+	c = str_decode(buf, &loff, avail);
+	*off += loff;
+
+	return c;
+}
+
+/** Find the line containing a logical offset.
+ *
+ * @return Index of the greatest line start that is less than or equal
+ *	   to @a b_off.
+ */
+static size_t sheet_line_find(sheet_t *sh, size_t b_off)
+{
+	size_t lo = 0;
+	size_t hi = sh->line_cnt;
+
+	/* Invariant: line_off[lo] <= b_off < line_off[hi] */
+	while (lo + 1 < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (sh->line_off[mid] <= b_off)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/** Make room for additional entries in the line index. */
+static errno_t sheet_line_reserve(sheet_t *sh, size_t extra)
+{
+	size_t ncap;
+	size_t *nlines;
+
+	if (sh->line_cnt + extra <= sh->line_cap)
+		return EOK;
+
+	ncap = sh->line_cap;
+	while (sh->line_cnt + extra > ncap)
+		ncap = ncap * 2;
+
+	nlines = realloc(sh->line_off, ncap * sizeof(size_t));
+	if (nlines == NULL)
+		return ENOMEM;
+
+	sh->line_off = nlines;
+	sh->line_cap = ncap;
+	return EOK;
+}
+
 /** Initialize an empty sheet. */
 errno_t sheet_create(sheet_t **rsh)
 {
@@ -76,6 +192,7 @@ errno_t sheet_create(sheet_t **rsh)
 
 	sh->dbuf_size = INITIAL_SIZE;
 	sh->text_size = 0;
+	sh->gap_off = 0;
 
 	sh->data = malloc(sh->dbuf_size);
 	if (sh->data == NULL) {
@@ -83,6 +200,18 @@ errno_t sheet_create(sheet_t **rsh)
 		return ENOMEM;
 	}
 
+	sh->line_cap = INITIAL_LINES;
+	sh->line_off = malloc(sh->line_cap * sizeof(size_t));
+	if (sh->line_off == NULL) {
+		free(sh->data);
+		free(sh);
+		return ENOMEM;
+	}
+
+	/* The first line starts at the beginning of the file. */
+	sh->line_off[0] = 0;
+	sh->line_cnt = 1;
+
 	list_initialize(&sh->tags);
 
 	*rsh = sh;
@@ -104,28 +233,66 @@ errno_t sheet_create(sheet_t **rsh)
  */
 errno_t sheet_insert(sheet_t *sh, spt_t *pos, enum dir_spec dir, char *str)
 {
-	char *ipp;
 	size_t sz;
+	size_t nl;
+	size_t idx;
 	char *newp;
+	size_t i;
 
 	sz = str_size(str);
-	if (sh->text_size + sz > sh->dbuf_size) {
-		/* Enlarge data buffer. */
-		newp = realloc(sh->data, sh->dbuf_size * 2);
+
+	/* Number of lines the inserted text will add. */
+	nl = 0;
+	for (i = 0; i < sz; i++) {
+		if (str[i] == '\n')
+			++nl;
+	}
+
+	/* Reserve all space up front so that failure leaves us intact. */
+	if (sheet_line_reserve(sh, nl) != EOK)
+		return ELIMIT;
+
+	if (sheet_gap_size(sh) < sz) {
+		size_t nsize = sh->dbuf_size;
+
+		while (nsize - sh->text_size < sz)
+			nsize = nsize * 2;
+
+		newp = realloc(sh->data, nsize);
 		if (newp == NULL)
 			return ELIMIT;
 
+		/* Move the part after the gap to the end of the buffer. */
+		memmove(newp + sh->gap_off + (nsize - sh->text_size),
+		    newp + sh->gap_off + sheet_gap_size(sh),
+		    sh->text_size - sh->gap_off);
+
 		sh->data = newp;
-		sh->dbuf_size = sh->dbuf_size * 2;
+		sh->dbuf_size = nsize;
 	}
 
-	ipp = sh->data + pos->b_off;
-
-	/* Copy data. */
-	memmove(ipp + sz, ipp, sh->text_size - pos->b_off);
-	memcpy(ipp, str, sz);
+	/* Copy data into the gap. */
+	sheet_move_gap(sh, pos->b_off);
+	memcpy(sh->data + sh->gap_off, str, sz);
+	sh->gap_off += sz;
 	sh->text_size += sz;
 
+	/* Update the line index. */
+	idx = sheet_line_find(sh, pos->b_off);
+
+	memmove(&sh->line_off[idx + 1 + nl], &sh->line_off[idx + 1],
+	    (sh->line_cnt - idx - 1) * sizeof(size_t));
+	sh->line_cnt += nl;
+
+	for (i = idx + 1 + nl; i < sh->line_cnt; i++)
+		sh->line_off[i] += sz;
+
+	nl = 0;
+	for (i = 0; i < sz; i++) {
+		if (str[i] == '\n')
+			sh->line_off[idx + 1 + nl++] = pos->b_off + i + 1;
+	}
+
 	/* Adjust tags. */
 
 	list_foreach(sh->tags, link, tag_t, tag) {
@@ -150,17 +317,32 @@ errno_t sheet_insert(sheet_t *sh, spt_t *pos, enum dir_spec dir, char *str)
  */
 errno_t sheet_delete(sheet_t *sh, spt_t *spos, spt_t *epos)
 {
-	char *spp;
 	size_t sz;
 	char *newp;
 	size_t shrink_size;
+	size_t sidx, eidx;
+	size_t i;
 
-	spp = sh->data + spos->b_off;
 	sz = epos->b_off - spos->b_off;
 
-	memmove(spp, spp + sz, sh->text_size - (spos->b_off + sz));
+	/* Let the gap absorb the deleted range. */
+	sheet_move_gap(sh, spos->b_off);
 	sh->text_size -= sz;
 
+	/*
+	 * Drop the index entries of line starts that lie inside the
+	 * deleted range and rebase the ones that follow it.
+	 */
+	sidx = sheet_line_find(sh, spos->b_off);
+	eidx = sheet_line_find(sh, epos->b_off);
+
+	memmove(&sh->line_off[sidx + 1], &sh->line_off[eidx + 1],
+	    (sh->line_cnt - eidx - 1) * sizeof(size_t));
+	sh->line_cnt -= eidx - sidx;
+
+	for (i = sidx + 1; i < sh->line_cnt; i++)
+		sh->line_off[i] -= sz;
+
 	/* Adjust tags. */
 	list_foreach(sh->tags, link, tag_t, tag) {
 		if (tag->b_off >= epos->b_off)
@@ -173,6 +355,8 @@ errno_t sheet_delete(sheet_t *sh, spt_t *spos, spt_t *epos)
 	shrink_size = max(sh->dbuf_size / 4, INITIAL_SIZE);
 	if (sh->text_size <= shrink_size && sh->dbuf_size > INITIAL_SIZE) {
 		/* Shrink data buffer. */
+		sheet_move_gap(sh, sh->text_size);
+
 		newp = realloc(sh->data, shrink_size);
 		if (newp == NULL) {
 			/* Failed to shrink buffer... no matter. */
@@ -190,26 +374,24 @@ errno_t sheet_delete(sheet_t *sh, spt_t *spos, spt_t *epos)
 void sheet_copy_out(sheet_t *sh, spt_t const *spos, spt_t const *epos,
     char *buf, size_t bufsize, spt_t *fpos)
 {
-	char *spp;
 	size_t range_sz;
 	size_t copy_sz;
 	size_t off, prev;
 	char32_t c;
 
-	spp = sh->data + spos->b_off;
 	range_sz = epos->b_off - spos->b_off;
 	copy_sz = (range_sz < bufsize - 1) ? range_sz : bufsize - 1;
 
+	sheet_read(sh, spos->b_off, copy_sz, buf);
+
 	prev = off = 0;
 	do {
 		prev = off;
-		c = str_decode(spp, &off, copy_sz);
+		c = str_decode(buf, &off, copy_sz);
 	} while (c != '\0');
 
 	/* Crop copy_sz down to the last full character. */
 	copy_sz = prev;
-
-	memcpy(buf, spp, copy_sz);
 	buf[copy_sz] = '\0';
 
 	fpos->b_off = spos->b_off + copy_sz;
@@ -221,11 +403,19 @@ void sheet_get_cell_pt(sheet_t *sh, coord_t const *coord, enum dir_spec dir,
     spt_t *pt)
 {
 	size_t cur_pos, prev_pos;
+	size_t row;
 	char32_t c;
 	coord_t cc;
 
-	cc.row = cc.column = 1;
-	cur_pos = prev_pos = 0;
+	/* Start the walk at the beginning of the requested row. */
+	row = (coord->row < 1) ? 1 : (size_t) coord->row;
+	if (row > sh->line_cnt)
+		row = sh->line_cnt;
+
+	cc.row = row;
+	cc.column = 1;
+	cur_pos = prev_pos = sh->line_off[row - 1];
+
 	while (true) {
 		if (prev_pos >= sh->text_size) {
 			/* Cannot advance any further. */
@@ -240,7 +430,7 @@ void sheet_get_cell_pt(sheet_t *sh, coord_t const *coord, enum dir_spec dir,
 
 		prev_pos = cur_pos;
 
-		c = str_decode(sh->data, &cur_pos, sh->text_size);
+		c = sheet_decode(sh, &cur_pos);
 		if (c == '\n') {
 			++cc.row;
 			cc.column = 1;
@@ -273,32 +463,28 @@ void sheet_get_row_width(sheet_t *sh, int row, int *length)
 /** Get the number of rows in a sheet. */
 void sheet_get_num_rows(sheet_t *sh, int *rows)
 {
-	int cnt;
-	size_t bo;
-
-	cnt = 1;
-	for (bo = 0; bo < sh->dbuf_size; ++bo) {
-		if (sh->data[bo] == '\n')
-			cnt += 1;
-	}
-
-	*rows = cnt;
+	*rows = (int) sh->line_cnt;
 }
 
 /** Get the coordinates of an s-point. */
 void spt_get_coord(spt_t const *pos, coord_t *coord)
 {
 	size_t off;
+	size_t idx;
 	coord_t cc;
 	char32_t c;
 	sheet_t *sh;
 
 	sh = pos->sh;
-	cc.row = cc.column = 1;
 
-	off = 0;
+	/* Walk only the line containing the s-point. */
+	idx = sheet_line_find(sh, pos->b_off);
+	cc.row = idx + 1;
+	cc.column = 1;
+
+	off = sh->line_off[idx];
 	while (off < pos->b_off && off < sh->text_size) {
-		c = str_decode(sh->data, &off, sh->text_size);
+		c = sheet_decode(sh, &off);
 		if (c == '\n') {
 			++cc.row;
 			cc.column = 1;
@@ -321,7 +507,7 @@ bool spt_equal(spt_t const *a, spt_t const *b)
 /** Get a character at spt and return next spt */
 char32_t spt_next_char(spt_t spt, spt_t *next)
 {
-	char32_t ch = str_decode(spt.sh->data, &spt.b_off, spt.sh->text_size);
+	char32_t ch = sheet_decode(spt.sh, &spt.b_off);
 	if (next)
 		*next = spt;
 	return ch;
@@ -329,7 +515,16 @@ char32_t spt_next_char(spt_t spt, spt_t *next)
 
 char32_t spt_prev_char(spt_t spt, spt_t *prev)
 {
-	char32_t ch = str_decode_reverse(spt.sh->data, &spt.b_off, spt.sh->text_size);
+	char buf[STR_BOUNDS(1)];
+	size_t start, len;
+	char32_t ch;
+
+	start = (spt.b_off >= STR_BOUNDS(1)) ? spt.b_off - STR_BOUNDS(1) : 0;
+	len = spt.b_off - start;
+	sheet_read(spt.sh, start, len, buf);
+
+	ch = str_decode_reverse(buf, &len, len);
+	spt.b_off = start + len;
 	if (prev)
 		*prev = spt;
 	return ch;
@@ -42,9 +42,21 @@
 struct sheet {
 	/* Note: This structure is opaque for the user. */
 
+	/** Size of the text (i.e. excluding the gap) */
 	size_t text_size;
+	/** Size of the data buffer (i.e. including the gap) */
 	size_t dbuf_size;
+	/** Data buffer with a movable gap */
 	char *data;
+	/** Logical offset at which the gap is located */
+	size_t gap_off;
+
+	/** Logical offset of the first byte of each line */
+	size_t *line_off;
+	/** Number of lines (entries in @c line_off) */
+	size_t line_cnt;
+	/** Number of allocated entries in @c line_off */
+	size_t line_cap;
 
 	list_t tags;
 };
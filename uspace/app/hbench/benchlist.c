@@ -38,15 +38,30 @@
 #include "hbench.h"
 
 benchmark_t *benchmarks[] = {
+	&benchmark_blk_read,
 	&benchmark_dir_read,
+	&benchmark_fibril_contention,
+	&benchmark_fibril_create,
 	&benchmark_fibril_mutex,
+	&benchmark_fibril_pingpong,
+	&benchmark_fibril_switch,
+	&benchmark_file_rand_read,
 	&benchmark_file_read,
+	&benchmark_file_write,
 	&benchmark_malloc1,
 	&benchmark_malloc2,
 	&benchmark_ns_ping,
 	&benchmark_ping_pong,
 	&benchmark_read1k,
 	&benchmark_taskgetid,
+	&benchmark_tcp_rr,
+	&benchmark_tcp_stream,
+	&benchmark_udp_rr,
+	&benchmark_udp_stream,
+	&benchmark_vm_fault,
+	&benchmark_vm_mapunmap,
+	&benchmark_vm_protect,
+	&benchmark_vm_share,
 	&benchmark_write1k,
 };
 
@@ -33,12 +33,26 @@
  * @file
  */
 
+#include <adt/list.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <str.h>
 #include "hbench.h"
 
 static FILE *csv_output = NULL;
 
+/** Aggregated baseline data for one benchmark. */
+typedef struct {
+	link_t link;
+	char *name;
+	double duration_sum;
+	size_t duration_count;
+	double p99_sum;
+	size_t p99_count;
+} baseline_entry_t;
+
+static LIST_INITIALIZE(baseline_entries);
+
 /** Open CSV benchmark report.
  *
  * @param filename Filename where to store the CSV.
@@ -51,7 +65,9 @@ errno_t csv_report_open(const char *filename)
 		return errno;
 	}
 
-	fprintf(csv_output, "benchmark,run,size,duration_nanos\n");
+	fprintf(csv_output, "benchmark,run,size,duration_nanos,"
+	    "sample_count,sample_p50_nanos,sample_p95_nanos,"
+	    "sample_p99_nanos,sample_max_nanos,sample_stddev_nanos\n");
 
 	return EOK;
 }
@@ -73,9 +89,21 @@ void csv_report_add_entry(bench_run_t *run, int run_index,
 		return;
 	}
 
-	fprintf(csv_output, "%s,%d,%" PRIu64 ",%lld\n",
+	fprintf(csv_output, "%s,%d,%" PRIu64 ",%lld",
 	    bench->name, run_index, workload_size,
 	    (long long) stopwatch_get_nanos(&run->stopwatch));
+
+	if (run->sample_count > 0) {
+		bench_sample_stats_t stats;
+		bench_sample_stats_compute(run->samples, run->sample_count,
+		    &stats);
+		fprintf(csv_output, ",%zu,%lld,%lld,%lld,%lld,%.0f\n",
+		    stats.count, (long long) stats.p50, (long long) stats.p95,
+		    (long long) stats.p99, (long long) stats.max,
+		    stats.stddev);
+	} else {
+		fprintf(csv_output, ",0,,,,,\n");
+	}
 }
 
 /** Close CSV report.
@@ -90,5 +118,147 @@ void csv_report_close(void)
 	}
 }
 
+static baseline_entry_t *baseline_find(const char *name)
+{
+	list_foreach(baseline_entries, link, baseline_entry_t, entry) {
+		if (str_cmp(entry->name, name) == 0)
+			return entry;
+	}
+	return NULL;
+}
+
+/** Split one CSV line into fields, in place.
+ *
+ * Unlike str_tok(), empty fields are preserved.
+ *
+ * @return Number of fields found (at most max_fields).
+ */
+static size_t csv_split(char *line, char **fields, size_t max_fields)
+{
+	size_t count = 0;
+
+	fields[count++] = line;
+	while (count < max_fields) {
+		char *comma = str_chr(line, ',');
+		if (comma == NULL)
+			break;
+		*comma = '\0';
+		line = comma + 1;
+		fields[count++] = line;
+	}
+
+	return count;
+}
+
+/** Load a previously written CSV report to compare new results against.
+ *
+ * Warm-up entries (negative run index) are skipped; the remaining rows
+ * are aggregated per benchmark. Reports from before per-operation
+ * sampling (four columns) are accepted, they simply carry no p99 data.
+ *
+ * @param filename Baseline CSV report.
+ * @return EOK on success or an error code from errno.h.
+ */
+errno_t csv_baseline_load(const char *filename)
+{
+	FILE *input = fopen(filename, "r");
+	if (input == NULL) {
+		return errno;
+	}
+
+	char line[256];
+	bool header = true;
+	while (fgets(line, sizeof(line), input) != NULL) {
+		if (header) {
+			header = false;
+			continue;
+		}
+
+		size_t len = str_size(line);
+		while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+			line[--len] = '\0';
+
+		char *fields[10];
+		size_t nfields = csv_split(line, fields, 10);
+		if (nfields < 4)
+			continue;
+
+		/* Skip warm-up runs. */
+		if (fields[1][0] == '-')
+			continue;
+
+		uint64_t duration;
+		if (str_uint64_t(fields[3], NULL, 10, true, &duration) != EOK)
+			continue;
+
+		baseline_entry_t *entry = baseline_find(fields[0]);
+		if (entry == NULL) {
+			entry = calloc(1, sizeof(baseline_entry_t));
+			if (entry == NULL) {
+				fclose(input);
+				return ENOMEM;
+			}
+			entry->name = str_dup(fields[0]);
+			if (entry->name == NULL) {
+				free(entry);
+				fclose(input);
+				return ENOMEM;
+			}
+			link_initialize(&entry->link);
+			list_append(&entry->link, &baseline_entries);
+		}
+
+		entry->duration_sum += (double) duration;
+		entry->duration_count++;
+
+		uint64_t p99;
+		if (nfields >= 8 && fields[7][0] != '\0' &&
+		    str_uint64_t(fields[7], NULL, 10, true, &p99) == EOK) {
+			entry->p99_sum += (double) p99;
+			entry->p99_count++;
+		}
+	}
+
+	fclose(input);
+	return EOK;
+}
+
+/** Get baseline averages for the given benchmark.
+ *
+ * @param name Benchmark name.
+ * @param duration_avg Place to store average run duration in nanoseconds.
+ * @param p99_avg Place to store average p99 operation latency.
+ * @param has_p99 Stores whether the baseline contains p99 data.
+ * @return Whether the baseline contains the benchmark at all.
+ */
+bool csv_baseline_get(const char *name, double *duration_avg, double *p99_avg,
+    bool *has_p99)
+{
+	baseline_entry_t *entry = baseline_find(name);
+	if (entry == NULL || entry->duration_count == 0)
+		return false;
+
+	*duration_avg = entry->duration_sum / entry->duration_count;
+	*has_p99 = entry->p99_count > 0;
+	if (*has_p99)
+		*p99_avg = entry->p99_sum / entry->p99_count;
+
+	return true;
+}
+
+/** Free the loaded baseline data. */
+void csv_baseline_cleanup(void)
+{
+	link_t *link;
+
+	while ((link = list_first(&baseline_entries)) != NULL) {
+		baseline_entry_t *entry =
+		    list_get_instance(link, baseline_entry_t, link);
+		list_remove(link);
+		free(entry->name);
+		free(entry);
+	}
+}
+
 /** @}
  */
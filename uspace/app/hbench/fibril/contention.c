@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <inttypes.h>
+#include <str.h>
+#include "../hbench.h"
+
+/*
+ * Many fibrils distributed over several runner threads all repeatedly
+ * yield, hammering the ready queue. The number of runner threads and
+ * fibrils is configurable via the "threads" and "fibrils" parameters.
+ */
+
+#define DEFAULT_THREADS "4"
+#define DEFAULT_FIBRILS "16"
+
+/* The main fibril runs on a thread of its own. */
+static uint64_t threads_spawned = 1;
+
+typedef struct {
+	uint64_t yields;
+	fibril_semaphore_t done;
+} shared_t;
+
+static errno_t worker(void *arg)
+{
+	shared_t *shared = arg;
+	fibril_detach(fibril_get_id());
+
+	for (uint64_t i = 0; i < shared->yields; i++)
+		fibril_yield();
+
+	fibril_semaphore_up(&shared->done);
+
+	return EOK;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	const char *nthreads_str =
+	    bench_env_param_get(env, "threads", DEFAULT_THREADS);
+	const char *nfibrils_str =
+	    bench_env_param_get(env, "fibrils", DEFAULT_FIBRILS);
+
+	uint64_t nthreads;
+	errno_t rc = str_uint64_t(nthreads_str, NULL, 10, true, &nthreads);
+	if (rc != EOK || nthreads == 0) {
+		return bench_run_fail(run, "invalid thread count '%s'",
+		    nthreads_str);
+	}
+
+	uint64_t nfibrils;
+	rc = str_uint64_t(nfibrils_str, NULL, 10, true, &nfibrils);
+	if (rc != EOK || nfibrils == 0) {
+		return bench_run_fail(run, "invalid fibril count '%s'",
+		    nfibrils_str);
+	}
+
+	/* Runner threads cannot be removed again; only add missing ones. */
+	if (nthreads > threads_spawned) {
+		int missing = nthreads - threads_spawned;
+		if (fibril_test_spawn_runners(missing) != missing) {
+			return bench_run_fail(run,
+			    "failed to spawn fibril runner threads");
+		}
+		threads_spawned = nthreads;
+	}
+
+	shared_t shared;
+	fibril_semaphore_initialize(&shared.done, 0);
+	shared.yields = size / nfibrils + 1;
+
+	uint64_t created = 0;
+	bool ret = true;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < nfibrils; i++) {
+		fid_t fid = fibril_create(worker, &shared);
+		if (fid == 0) {
+			bench_run_fail(run, "failed to create fibril %" PRIu64,
+			    i);
+			ret = false;
+			break;
+		}
+		fibril_add_ready(fid);
+		created++;
+	}
+	for (uint64_t i = 0; i < created; i++)
+		fibril_semaphore_down(&shared.done);
+	bench_run_stop(run);
+
+	return ret;
+}
+
+benchmark_t benchmark_fibril_contention = {
+	.name = "fibril_contention",
+	.desc = "Ready-queue contention with many yielding fibrils",
+	.entry = &runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <fibril.h>
+#include <fibril_synch.h>
+#include "../hbench.h"
+
+/*
+ * Measures the cost of creating a fibril, scheduling it for the first
+ * time and waiting until it finishes, i.e. the closest equivalent of a
+ * thread create/join cycle.
+ */
+
+static errno_t worker(void *arg)
+{
+	fibril_semaphore_t *sem = arg;
+	fibril_detach(fibril_get_id());
+
+	fibril_semaphore_up(sem);
+
+	return EOK;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	fibril_semaphore_t sem;
+	fibril_semaphore_initialize(&sem, 0);
+
+	stopwatch_t op_watch;
+	stopwatch_init(&op_watch);
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		stopwatch_start(&op_watch);
+		fid_t fid = fibril_create(worker, &sem);
+		if (fid == 0) {
+			return bench_run_fail(run, "failed to create fibril");
+		}
+		fibril_add_ready(fid);
+		fibril_semaphore_down(&sem);
+		stopwatch_stop(&op_watch);
+		bench_run_sample(run, stopwatch_get_nanos(&op_watch));
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_fibril_create = {
+	.name = "fibril_create",
+	.desc = "Fibril create/first schedule/finish cycle",
+	.entry = &runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
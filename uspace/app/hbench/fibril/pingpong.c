@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <fibril.h>
+#include <fibril_synch.h>
+#include "../hbench.h"
+
+/*
+ * Condition variable ping-pong between two fibrils. A second fibril
+ * runner thread is spawned in setup so that the wakeups actually cross
+ * threads (and processors, when available), exercising the scheduler
+ * wakeup path rather than a cooperative in-thread switch.
+ */
+
+typedef struct {
+	fibril_mutex_t mutex;
+	fibril_condvar_t cv;
+	int turn;
+	bool stop;
+	bool done;
+} shared_t;
+
+static errno_t competitor(void *arg)
+{
+	shared_t *shared = arg;
+	fibril_detach(fibril_get_id());
+
+	fibril_mutex_lock(&shared->mutex);
+	while (true) {
+		while (shared->turn != 1 && !shared->stop)
+			fibril_condvar_wait(&shared->cv, &shared->mutex);
+		if (shared->stop)
+			break;
+		shared->turn = 0;
+		fibril_condvar_signal(&shared->cv);
+	}
+	shared->done = true;
+	fibril_condvar_broadcast(&shared->cv);
+	fibril_mutex_unlock(&shared->mutex);
+
+	return EOK;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	shared_t shared;
+	fibril_mutex_initialize(&shared.mutex);
+	fibril_condvar_initialize(&shared.cv);
+	shared.turn = 0;
+	shared.stop = false;
+	shared.done = false;
+
+	fid_t other = fibril_create(competitor, &shared);
+	if (other == 0) {
+		return bench_run_fail(run, "failed to create fibril");
+	}
+	fibril_add_ready(other);
+
+	fibril_mutex_lock(&shared.mutex);
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		shared.turn = 1;
+		fibril_condvar_signal(&shared.cv);
+		while (shared.turn != 0)
+			fibril_condvar_wait(&shared.cv, &shared.mutex);
+	}
+	bench_run_stop(run);
+
+	shared.stop = true;
+	fibril_condvar_broadcast(&shared.cv);
+	while (!shared.done)
+		fibril_condvar_wait(&shared.cv, &shared.mutex);
+	fibril_mutex_unlock(&shared.mutex);
+
+	return true;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	/* Runner threads cannot be removed again, so spawn only once. */
+	static bool spawned = false;
+
+	if (!spawned) {
+		if (fibril_test_spawn_runners(1) != 1) {
+			return bench_run_fail(run,
+			    "failed to spawn fibril runner thread");
+		}
+		spawned = true;
+	}
+
+	return true;
+}
+
+benchmark_t benchmark_fibril_pingpong = {
+	.name = "fibril_pingpong",
+	.desc = "Cross-thread condition variable wakeup ping-pong",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <block.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <inttypes.h>
+#include <loc.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * Raw block device read throughput via block_read_direct(), bypassing
+ * the block cache. Parameters: 'device' (service name, mandatory),
+ * 'blocks' (blocks per read), 'mode' ('seq' or 'rand') and 'fibrils'
+ * (number of fibrils issuing reads in parallel, i.e. the queue depth
+ * seen by the block service). Ops/s times blocks times the device
+ * block size gives the byte throughput. Per-operation latency samples
+ * are recorded only at queue depth one, where they are meaningful.
+ */
+
+#define DEFAULT_BLOCKS "8"
+#define DEFAULT_MODE "seq"
+#define DEFAULT_FIBRILS "1"
+
+#define COMM_SIZE 4096
+
+static service_id_t service_id;
+static bool block_inited = false;
+static size_t block_size;
+static aoff64_t dev_nblocks;
+
+typedef struct {
+	aoff64_t first;
+	aoff64_t span;
+	size_t blocks;
+	bool random;
+	uint64_t ops;
+	bench_run_t *run;
+	fibril_semaphore_t *done;
+	errno_t rc;
+} blkread_work_t;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *device = bench_env_param_get(env, "device", NULL);
+	if (device == NULL) {
+		return bench_run_fail(run,
+		    "missing 'device' parameter (try -p device=devices/...)");
+	}
+
+	errno_t rc = loc_service_get_id(device, &service_id, 0);
+	if (rc != EOK) {
+		return bench_run_fail(run, "error resolving device '%s'",
+		    device);
+	}
+
+	rc = block_init(service_id, COMM_SIZE);
+	if (rc != EOK) {
+		return bench_run_fail(run,
+		    "error opening block device '%s': %s (%d)", device,
+		    str_error(rc), rc);
+	}
+
+	block_inited = true;
+
+	rc = block_get_bsize(service_id, &block_size);
+	if (rc != EOK)
+		return bench_run_fail(run, "error getting block size");
+
+	rc = block_get_nblocks(service_id, &dev_nblocks);
+	if (rc != EOK)
+		return bench_run_fail(run, "error getting device size");
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	if (block_inited) {
+		block_fini(service_id);
+		block_inited = false;
+	}
+
+	return true;
+}
+
+/** Pseudo-random block address within [first, first + span). */
+static aoff64_t random_block(aoff64_t first, aoff64_t span)
+{
+	uint64_t r = (((uint64_t) rand()) << 16) ^ (uint64_t) rand();
+	return first + (r % span);
+}
+
+static errno_t blkread_work(blkread_work_t *work)
+{
+	uint8_t *buf = malloc(work->blocks * block_size);
+	if (buf == NULL)
+		return ENOMEM;
+
+	stopwatch_t op_watch;
+	stopwatch_init(&op_watch);
+
+	errno_t rc = EOK;
+	aoff64_t ba = work->first;
+
+	for (uint64_t i = 0; i < work->ops; i++) {
+		if (work->random) {
+			ba = random_block(work->first, work->span);
+		} else {
+			if (ba + work->blocks > work->first + work->span)
+				ba = work->first;
+		}
+
+		if (work->run != NULL)
+			stopwatch_start(&op_watch);
+		rc = block_read_direct(service_id, ba, work->blocks, buf);
+		if (rc != EOK)
+			break;
+		if (work->run != NULL) {
+			stopwatch_stop(&op_watch);
+			bench_run_sample(work->run,
+			    stopwatch_get_nanos(&op_watch));
+		}
+
+		if (!work->random)
+			ba += work->blocks;
+	}
+
+	free(buf);
+
+	return rc;
+}
+
+static errno_t blkread_fibril(void *arg)
+{
+	blkread_work_t *work = arg;
+	fibril_detach(fibril_get_id());
+
+	work->rc = blkread_work(work);
+	fibril_semaphore_up(work->done);
+
+	return EOK;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	const char *blocks_str = bench_env_param_get(env, "blocks",
+	    DEFAULT_BLOCKS);
+	uint64_t blocks;
+	errno_t rc = str_uint64_t(blocks_str, NULL, 10, true, &blocks);
+	if (rc != EOK || blocks == 0)
+		return bench_run_fail(run, "invalid block count '%s'", blocks_str);
+
+	const char *mode = bench_env_param_get(env, "mode", DEFAULT_MODE);
+	bool random;
+	if (str_cmp(mode, "seq") == 0)
+		random = false;
+	else if (str_cmp(mode, "rand") == 0)
+		random = true;
+	else
+		return bench_run_fail(run, "invalid mode '%s' (seq or rand)", mode);
+
+	const char *fibrils_str = bench_env_param_get(env, "fibrils",
+	    DEFAULT_FIBRILS);
+	uint64_t nfibrils;
+	rc = str_uint64_t(fibrils_str, NULL, 10, true, &nfibrils);
+	if (rc != EOK || nfibrils == 0)
+		return bench_run_fail(run, "invalid fibril count '%s'", fibrils_str);
+
+	if (dev_nblocks < blocks * nfibrils) {
+		return bench_run_fail(run,
+		    "device too small (%" PRIu64 " blocks)", dev_nblocks);
+	}
+
+	blkread_work_t *works = calloc(nfibrils, sizeof(blkread_work_t));
+	if (works == NULL)
+		return bench_run_fail(run, "out of memory");
+
+	fibril_semaphore_t done;
+	fibril_semaphore_initialize(&done, 0);
+
+	/* Give each fibril its own slice of the device. */
+	aoff64_t span = dev_nblocks / nfibrils;
+	for (uint64_t i = 0; i < nfibrils; i++) {
+		works[i].first = i * span;
+		works[i].span = span;
+		works[i].blocks = blocks;
+		works[i].random = random;
+		works[i].ops = niter / nfibrils + 1;
+		works[i].run = (nfibrils == 1) ? run : NULL;
+		works[i].done = &done;
+		works[i].rc = EOK;
+	}
+
+	bool ret = true;
+
+	bench_run_start(run);
+	if (nfibrils == 1) {
+		works[0].rc = blkread_work(&works[0]);
+	} else {
+		uint64_t started;
+		for (started = 0; started < nfibrils; started++) {
+			fid_t fid = fibril_create(blkread_fibril,
+			    &works[started]);
+			if (fid == 0)
+				break;
+			fibril_add_ready(fid);
+		}
+
+		for (uint64_t i = 0; i < started; i++)
+			fibril_semaphore_down(&done);
+
+		if (started < nfibrils)
+			ret = bench_run_fail(run, "failed to create fibril");
+	}
+	bench_run_stop(run);
+
+	for (uint64_t i = 0; i < nfibrils; i++) {
+		if (ret && works[i].rc != EOK) {
+			ret = bench_run_fail(run, "read failed: %s (%d)",
+			    str_error(works[i].rc), works[i].rc);
+		}
+	}
+
+	free(works);
+
+	return ret;
+}
+
+benchmark_t benchmark_blk_read = {
+	.name = "blk_read",
+	.desc = "Raw block device reads ('device', 'blocks', 'mode', 'fibrils' params)",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * Random file read: each operation seeks to a pseudo-random offset and
+ * reads one buffer. Compare against file_read at the same 'bufsize' to
+ * see how much the FS cache and read-ahead favor sequential access.
+ */
+
+#define DEFAULT_BUFSIZE "4096"
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	const char *path = bench_env_param_get(env, "filename",
+	    "/data/web/helenos.png");
+
+	const char *bufsize_str = bench_env_param_get(env, "bufsize",
+	    DEFAULT_BUFSIZE);
+	uint64_t buf_size;
+	errno_t rc = str_uint64_t(bufsize_str, NULL, 10, true, &buf_size);
+	if (rc != EOK || buf_size == 0) {
+		return bench_run_fail(run, "invalid buffer size '%s'",
+		    bufsize_str);
+	}
+
+	char *buf = malloc(buf_size);
+	if (buf == NULL) {
+		return bench_run_fail(run, "failed to allocate %" PRIu64 "B buffer",
+		    buf_size);
+	}
+
+	bool ret = true;
+
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		bench_run_fail(run, "failed to open %s for reading: %s",
+		    path, str_error(errno));
+		ret = false;
+		goto leave_free_buf;
+	}
+
+	if (fseek(file, 0, SEEK_END) != 0) {
+		bench_run_fail(run, "failed to seek in %s: %s", path,
+		    str_error(errno));
+		ret = false;
+		goto leave_close;
+	}
+
+	long file_size = ftell(file);
+	if (file_size <= 0) {
+		bench_run_fail(run, "failed to get size of %s", path);
+		ret = false;
+		goto leave_close;
+	}
+
+	/* Range of offsets from which a whole buffer can be read. */
+	uint64_t range = 1;
+	if ((uint64_t) file_size > buf_size)
+		range = (uint64_t) file_size - buf_size + 1;
+
+	stopwatch_t op_watch;
+	stopwatch_init(&op_watch);
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		uint64_t offset =
+		    ((((uint64_t) rand()) << 16) ^ (uint64_t) rand()) % range;
+
+		stopwatch_start(&op_watch);
+		if (fseek(file, (long) offset, SEEK_SET) != 0) {
+			bench_run_fail(run, "failed to seek in %s: %s",
+			    path, str_error(errno));
+			ret = false;
+			goto leave_close;
+		}
+		fread(buf, 1, buf_size, file);
+		if (ferror(file)) {
+			bench_run_fail(run, "failed to read from %s: %s",
+			    path, str_error(errno));
+			ret = false;
+			goto leave_close;
+		}
+		stopwatch_stop(&op_watch);
+		bench_run_sample(run, stopwatch_get_nanos(&op_watch));
+	}
+	bench_run_stop(run);
+
+leave_close:
+	fclose(file);
+
+leave_free_buf:
+	free(buf);
+
+	return ret;
+}
+
+benchmark_t benchmark_file_rand_read = {
+	.name = "file_rand_read",
+	.desc = "Read a file at random offsets ('filename' and 'bufsize' params)",
+	.entry = &runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -31,12 +31,14 @@
  * @{
  */
 
+#include <inttypes.h>
+#include <str.h>
 #include <str_error.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "../hbench.h"
 
-#define BUFFER_SIZE 4096
+#define DEFAULT_BUFSIZE "4096"
 
 /** Execute file reading benchmark.
  *
@@ -48,9 +50,19 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
 {
 	const char *path = bench_env_param_get(env, "filename", "/data/web/helenos.png");
 
-	char *buf = malloc(BUFFER_SIZE);
+	const char *bufsize_str = bench_env_param_get(env, "bufsize",
+	    DEFAULT_BUFSIZE);
+	uint64_t buf_size;
+	errno_t src = str_uint64_t(bufsize_str, NULL, 10, true, &buf_size);
+	if (src != EOK || buf_size == 0) {
+		return bench_run_fail(run, "invalid buffer size '%s'",
+		    bufsize_str);
+	}
+
+	char *buf = malloc(buf_size);
 	if (buf == NULL) {
-		return bench_run_fail(run, "failed to allocate %dB buffer", BUFFER_SIZE);
+		return bench_run_fail(run, "failed to allocate %" PRIu64 "B buffer",
+		    buf_size);
 	}
 
 	bool ret = true;
@@ -63,8 +75,12 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
 		goto leave_free_buf;
 	}
 
+	stopwatch_t op_watch;
+	stopwatch_init(&op_watch);
+
 	bench_run_start(run);
 	for (uint64_t i = 0; i < size; i++) {
+		stopwatch_start(&op_watch);
 		int rc = fseek(file, 0, SEEK_SET);
 		if (rc != 0) {
 			bench_run_fail(run, "failed to rewind %s: %s",
@@ -73,7 +89,7 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
 			goto leave_close;
 		}
 		while (!feof(file)) {
-			fread(buf, 1, BUFFER_SIZE, file);
+			fread(buf, 1, buf_size, file);
 			if (ferror(file)) {
 				bench_run_fail(run, "failed to read from %s: %s",
 				    path, str_error(errno));
@@ -81,6 +97,8 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
 				goto leave_close;
 			}
 		}
+		stopwatch_stop(&op_watch);
+		bench_run_sample(run, stopwatch_get_nanos(&op_watch));
 	}
 	bench_run_stop(run);
 
@@ -95,7 +113,7 @@ leave_free_buf:
 
 benchmark_t benchmark_file_read = {
 	.name = "file_read",
-	.desc = "Sequentially read contents of a file (use 'filename' param to alter the default).",
+	.desc = "Sequentially read contents of a file ('filename' and 'bufsize' params).",
 	.entry = &runner,
 	.setup = NULL,
 	.teardown = NULL
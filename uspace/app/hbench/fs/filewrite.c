@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <inttypes.h>
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * Sequential file write throughput. Each operation appends one buffer
+ * to a scratch file (stdio buffering is disabled so every fwrite hits
+ * the VFS). Ops/s times 'bufsize' gives the byte throughput; note that
+ * like file_read this mostly measures the FS cache, not the disk.
+ * The scratch file is removed afterwards.
+ */
+
+#define DEFAULT_FILENAME "/tmp/hbench-write.tmp"
+#define DEFAULT_BUFSIZE "4096"
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	const char *path = bench_env_param_get(env, "filename",
+	    DEFAULT_FILENAME);
+
+	const char *bufsize_str = bench_env_param_get(env, "bufsize",
+	    DEFAULT_BUFSIZE);
+	uint64_t buf_size;
+	errno_t rc = str_uint64_t(bufsize_str, NULL, 10, true, &buf_size);
+	if (rc != EOK || buf_size == 0) {
+		return bench_run_fail(run, "invalid buffer size '%s'",
+		    bufsize_str);
+	}
+
+	char *buf = malloc(buf_size);
+	if (buf == NULL) {
+		return bench_run_fail(run, "failed to allocate %" PRIu64 "B buffer",
+		    buf_size);
+	}
+
+	memset(buf, 'x', buf_size);
+
+	bool ret = true;
+
+	FILE *file = fopen(path, "w");
+	if (file == NULL) {
+		bench_run_fail(run, "failed to open %s for writing: %s",
+		    path, str_error(errno));
+		ret = false;
+		goto leave_free_buf;
+	}
+
+	setvbuf(file, NULL, _IONBF, 0);
+
+	stopwatch_t op_watch;
+	stopwatch_init(&op_watch);
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		stopwatch_start(&op_watch);
+		size_t nwr = fwrite(buf, 1, buf_size, file);
+		if (nwr != buf_size) {
+			bench_run_fail(run, "failed to write to %s: %s",
+			    path, str_error(errno));
+			ret = false;
+			goto leave_close;
+		}
+		stopwatch_stop(&op_watch);
+		bench_run_sample(run, stopwatch_get_nanos(&op_watch));
+	}
+	bench_run_stop(run);
+
+leave_close:
+	fclose(file);
+	remove(path);
+
+leave_free_buf:
+	free(buf);
+
+	return ret;
+}
+
+benchmark_t benchmark_file_write = {
+	.name = "file_write",
+	.desc = "Sequentially write a scratch file ('filename' and 'bufsize' params)",
+	.entry = &runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
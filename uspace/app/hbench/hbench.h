@@ -40,10 +40,14 @@
 #include <errno.h>
 #include <stdbool.h>
 #include <perf.h>
+#include <pmu.h>
 
 #define DEFAULT_RUN_COUNT 10
 #define DEFAULT_MIN_RUN_DURATION_MSEC 1000
 
+/** How many per-operation samples a run keeps (bounded reservoir). */
+#define BENCH_RESERVOIR_SIZE 1024
+
 /** Single run information.
  *
  * Used to store both performance information (now, only wall-clock
@@ -58,8 +62,35 @@ typedef struct {
 	stopwatch_t stopwatch;
 	char *error_message;
 	size_t error_message_buffer_size;
+	/*
+	 * Reservoir of per-operation durations, filled by benchmarks that
+	 * call bench_run_sample(). Allocated lazily, NULL when the
+	 * benchmark does not record individual operations.
+	 */
+	nsec_t *samples;
+	size_t sample_count;
+	uint64_t samples_seen;
+	/*
+	 * Hardware counter readings for the run, valid only when
+	 * pmu_valid is set (i.e. on hardware with usable performance
+	 * counters).
+	 */
+	uint64_t pmu_cycles;
+	uint64_t pmu_cache_misses;
+	bool pmu_valid;
 } bench_run_t;
 
+/** Summary statistics over per-operation samples. */
+typedef struct {
+	size_t count;
+	nsec_t p50;
+	nsec_t p95;
+	nsec_t p99;
+	nsec_t max;
+	double mean;
+	double stddev;
+} bench_sample_stats_t;
+
 /** Benchmark environment configuration.
  *
  * Benchmarking code (runners) should use access functions to read
@@ -98,7 +129,12 @@ typedef struct {
 } benchmark_t;
 
 extern void bench_run_init(bench_run_t *, char *, size_t);
+extern void bench_run_cleanup(bench_run_t *);
 extern bool bench_run_fail(bench_run_t *, const char *, ...);
+extern void bench_run_sample(bench_run_t *, nsec_t);
+extern void bench_sample_stats_compute(nsec_t *, size_t,
+    bench_sample_stats_t *);
+extern double estimate_square_root(double, double);
 
 /*
  * We keep the following two functions inline to ensure that we start
@@ -110,18 +146,37 @@ extern bool bench_run_fail(bench_run_t *, const char *, ...);
 
 static inline void bench_run_start(bench_run_t *run)
 {
+	/*
+	 * The hardware counters start before the stopwatch so that the
+	 * syscall overhead of starting them is not timed. On hardware
+	 * without counters the calls fail and pmu_valid stays unset.
+	 */
+	run->pmu_valid = false;
+	pmu_counter_start(0, PMU_EVENT_CYCLES);
+	pmu_counter_start(1, PMU_EVENT_CACHE_MISSES);
 	stopwatch_start(&run->stopwatch);
 }
 
 static inline void bench_run_stop(bench_run_t *run)
 {
 	stopwatch_stop(&run->stopwatch);
+
+	if ((pmu_counter_read(0, &run->pmu_cycles) == EOK) &&
+	    (pmu_counter_read(1, &run->pmu_cache_misses) == EOK))
+		run->pmu_valid = true;
+
+	pmu_counter_stop(0);
+	pmu_counter_stop(1);
 }
 
 extern errno_t csv_report_open(const char *);
 extern void csv_report_add_entry(bench_run_t *, int, benchmark_t *, uint64_t);
 extern void csv_report_close(void);
 
+extern errno_t csv_baseline_load(const char *);
+extern bool csv_baseline_get(const char *, double *, double *, bool *);
+extern void csv_baseline_cleanup(void);
+
 extern errno_t bench_env_init(bench_env_t *);
 extern errno_t bench_env_param_set(bench_env_t *, const char *, const char *);
 extern const char *bench_env_param_get(bench_env_t *, const char *, const char *);
@@ -131,15 +186,30 @@ extern benchmark_t *benchmarks[];
 extern size_t benchmark_count;
 
 /* Put your benchmark descriptors here (and also to benchlist.c). */
+extern benchmark_t benchmark_blk_read;
 extern benchmark_t benchmark_dir_read;
+extern benchmark_t benchmark_fibril_contention;
+extern benchmark_t benchmark_fibril_create;
 extern benchmark_t benchmark_fibril_mutex;
+extern benchmark_t benchmark_fibril_pingpong;
+extern benchmark_t benchmark_fibril_switch;
+extern benchmark_t benchmark_file_rand_read;
 extern benchmark_t benchmark_file_read;
+extern benchmark_t benchmark_file_write;
 extern benchmark_t benchmark_malloc1;
 extern benchmark_t benchmark_malloc2;
 extern benchmark_t benchmark_ns_ping;
 extern benchmark_t benchmark_ping_pong;
 extern benchmark_t benchmark_read1k;
 extern benchmark_t benchmark_taskgetid;
+extern benchmark_t benchmark_tcp_rr;
+extern benchmark_t benchmark_tcp_stream;
+extern benchmark_t benchmark_udp_rr;
+extern benchmark_t benchmark_udp_stream;
+extern benchmark_t benchmark_vm_fault;
+extern benchmark_t benchmark_vm_mapunmap;
+extern benchmark_t benchmark_vm_protect;
+extern benchmark_t benchmark_vm_share;
 extern benchmark_t benchmark_write1k;
 
 #endif
@@ -66,33 +66,12 @@ static void short_report(bench_run_t *info, int run_index,
 	} else {
 		printf(".\n");
 	}
-}
 
-/** Estimate square root value.
- *
- * @param value The value to compute square root of.
- * @param precision Required precision (e.g. 0.00001).
- *
- * @details
- *
- * This is a temporary solution until we have proper sqrt() implementation
- * in libmath.
- *
- * The algorithm uses Babylonian method [1].
- *
- * [1] https://en.wikipedia.org/wiki/Methods_of_computing_square_roots#Babylonian_method
- */
-static double estimate_square_root(double value, double precision)
-{
-	double estimate = 1.;
-	double prev_estimate = estimate + 10 * precision;
-
-	while (fabs(estimate - prev_estimate) > precision) {
-		prev_estimate = estimate;
-		estimate = (prev_estimate + value / prev_estimate) / 2.;
+	if (info->pmu_valid) {
+		printf("Counters: %" PRIu64 " cycles, %" PRIu64
+		    " cache misses.\n", info->pmu_cycles,
+		    info->pmu_cache_misses);
 	}
-
-	return estimate;
 }
 
 /** Compute available statistics from given stopwatches.
@@ -136,8 +115,18 @@ static void compute_stats(bench_run_t *runs, size_t run_count,
 	*out_thruput_avg = 1.0 / (inv_thruput_sum / run_count);
 }
 
+/** Print summary statistics of all measured runs.
+ *
+ * Besides the per-run averages, per-operation samples from all runs
+ * (when the benchmark records them) are merged and reported as
+ * percentiles to expose tail latencies.
+ *
+ * @param out_duration_avg Stores average run duration in nanoseconds.
+ * @param out_sample_p99 Stores p99 operation latency or NAN without samples.
+ */
 static void summary_stats(bench_run_t *runs, size_t run_count,
-    benchmark_t *bench, uint64_t workload_size)
+    benchmark_t *bench, uint64_t workload_size, double *out_duration_avg,
+    double *out_sample_p99)
 {
 	double duration_avg, duration_sigma, thruput_avg;
 	compute_stats(runs, run_count, workload_size, 0.001,
@@ -147,6 +136,90 @@ static void summary_stats(bench_run_t *runs, size_t run_count,
 	    "%.0f ops/s; Samples: %zu\n",
 	    workload_size, duration_avg / 1000.0, duration_sigma / 1000.0,
 	    thruput_avg * 1000000000.0, run_count);
+
+	size_t pmu_runs = 0;
+	uint64_t cycles_sum = 0;
+	uint64_t misses_sum = 0;
+	for (size_t i = 0; i < run_count; i++) {
+		if (runs[i].pmu_valid) {
+			pmu_runs++;
+			cycles_sum += runs[i].pmu_cycles;
+			misses_sum += runs[i].pmu_cache_misses;
+		}
+	}
+	if (pmu_runs > 0) {
+		printf("Counters: %.0f cycles, %.0f cache misses per run.\n",
+		    (double) cycles_sum / pmu_runs,
+		    (double) misses_sum / pmu_runs);
+	}
+
+	*out_duration_avg = duration_avg;
+	*out_sample_p99 = NAN;
+
+	size_t total = 0;
+	for (size_t i = 0; i < run_count; i++)
+		total += runs[i].sample_count;
+	if (total == 0)
+		return;
+
+	nsec_t *merged = malloc(sizeof(nsec_t) * total);
+	if (merged == NULL)
+		return;
+
+	size_t pos = 0;
+	for (size_t i = 0; i < run_count; i++) {
+		for (size_t j = 0; j < runs[i].sample_count; j++)
+			merged[pos++] = runs[i].samples[j];
+	}
+
+	bench_sample_stats_t stats;
+	bench_sample_stats_compute(merged, total, &stats);
+	printf("Latency: p50 %lld ns, p95 %lld ns, p99 %lld ns, "
+	    "max %lld ns (sd %.0f ns); Samples: %zu\n",
+	    (long long) stats.p50, (long long) stats.p95,
+	    (long long) stats.p99, (long long) stats.max,
+	    stats.stddev, stats.count);
+
+	*out_sample_p99 = stats.p99;
+	free(merged);
+}
+
+/** Tolerated slow-down against the baseline, in percent. */
+static int baseline_tolerance = 5;
+
+/** Compare the results with the loaded baseline report, if any.
+ *
+ * @return Whether the results are within tolerance of the baseline.
+ */
+static bool baseline_check(benchmark_t *bench, double duration_avg,
+    double sample_p99)
+{
+	double base_avg, base_p99;
+	bool has_p99;
+
+	if (!csv_baseline_get(bench->name, &base_avg, &base_p99, &has_p99))
+		return true;
+
+	bool ok = true;
+	double limit = 1.0 + (double) baseline_tolerance / 100.0;
+
+	printf("Baseline: duration %+.1f%% (avg %.0f us)",
+	    (duration_avg / base_avg - 1.0) * 100.0, base_avg / 1000.0);
+	if (duration_avg > base_avg * limit) {
+		printf(" REGRESSION");
+		ok = false;
+	}
+	if (has_p99 && !isnan(sample_p99)) {
+		printf("; p99 %+.1f%% (base %.0f ns)",
+		    (sample_p99 / base_p99 - 1.0) * 100.0, base_p99);
+		if (sample_p99 > base_p99 * limit) {
+			printf(" REGRESSION");
+			ok = false;
+		}
+	}
+	printf("\n");
+
+	return ok;
 }
 
 static bool run_benchmark(bench_env_t *env, benchmark_t *bench)
@@ -193,9 +266,11 @@ static bool run_benchmark(bench_env_t *env, benchmark_t *bench)
 
 		bool ok = bench->entry(env, &run, workload_size);
 		if (!ok) {
+			bench_run_cleanup(&run);
 			goto leave_error;
 		}
 		short_report(&run, -1, bench, workload_size);
+		bench_run_cleanup(&run);
 
 		nsec_t duration = stopwatch_get_nanos(&run.stopwatch);
 		if (duration > env->minimal_run_duration_nanos) {
@@ -216,15 +291,26 @@ static bool run_benchmark(bench_env_t *env, benchmark_t *bench)
 
 		bool ok = bench->entry(env, &runs[i], workload_size);
 		if (!ok) {
+			for (size_t j = 0; j <= i; j++)
+				bench_run_cleanup(&runs[j]);
 			free(runs);
 			goto leave_error;
 		}
 		short_report(&runs[i], i, bench, workload_size);
 	}
 
-	summary_stats(runs, env->run_count, bench, workload_size);
+	double duration_avg;
+	double sample_p99;
+	summary_stats(runs, env->run_count, bench, workload_size,
+	    &duration_avg, &sample_p99);
+
+	if (!baseline_check(bench, duration_avg, sample_p99))
+		ret = false;
+
 	printf("\nBenchmark completed\n");
 
+	for (size_t i = 0; i < env->run_count; i++)
+		bench_run_cleanup(&runs[i]);
 	free(runs);
 
 	goto leave;
@@ -306,16 +392,21 @@ static void list_benchmarks(void)
 static void print_usage(const char *progname)
 {
 	printf("Usage: %s [options] <benchmark>\n", progname);
-	printf("-h, --help                 "
+	printf("-h, --help                  "
 	    "Print this help and exit\n");
-	printf("-d, --duration MILLIS      "
+	printf("-b, --baseline filename.csv "
+	    "Compare results against a previous CSV report\n");
+	printf("-d, --duration MILLIS       "
 	    "Set minimal run duration (milliseconds)\n");
-	printf("-n, --count N              "
+	printf("-n, --count N               "
 	    "Set number of measured runs\n");
-	printf("-o, --output filename.csv  "
+	printf("-o, --output filename.csv   "
 	    "Store machine-readable data in filename.csv\n");
-	printf("-p, --param KEY=VALUE      "
+	printf("-p, --param KEY=VALUE       "
 	    "Additional parameters for the benchmark\n");
+	printf("-t, --tolerance PERCENT     "
+	    "Tolerated slow-down against the baseline (default %d)\n",
+	    baseline_tolerance);
 	printf("<benchmark> is one of the following:\n");
 	list_benchmarks();
 }
@@ -337,21 +428,27 @@ int main(int argc, char *argv[])
 		return -5;
 	}
 
-	const char *short_options = "ho:p:n:d:";
+	const char *short_options = "hb:o:p:n:d:t:";
 	struct option long_options[] = {
+		{ "baseline", required_argument, NULL, 'b' },
 		{ "duration", required_argument, NULL, 'd' },
 		{ "help", optional_argument, NULL, 'h' },
 		{ "count", required_argument, NULL, 'n' },
 		{ "output", required_argument, NULL, 'o' },
 		{ "param", required_argument, NULL, 'p' },
+		{ "tolerance", required_argument, NULL, 't' },
 		{ 0, 0, NULL, 0 }
 	};
 
 	char *csv_output_filename = NULL;
+	char *csv_baseline_filename = NULL;
 
 	int opt = 0;
 	while ((opt = getopt_long(argc, argv, short_options, long_options, NULL)) > 0) {
 		switch (opt) {
+		case 'b':
+			csv_baseline_filename = optarg;
+			break;
 		case 'd':
 			errno = EOK;
 			bench_env.minimal_run_duration_nanos = MSEC2NSEC(atoll(optarg));
@@ -377,6 +474,14 @@ int main(int argc, char *argv[])
 		case 'p':
 			handle_param_arg(&bench_env, optarg);
 			break;
+		case 't':
+			errno = EOK;
+			baseline_tolerance = (int) atoll(optarg);
+			if ((errno != EOK) || (baseline_tolerance <= 0)) {
+				fprintf(stderr, "Invalid -t argument.\n");
+				return -3;
+			}
+			break;
 		case -1:
 		default:
 			break;
@@ -400,6 +505,15 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (csv_baseline_filename != NULL) {
+		errno_t rc = csv_baseline_load(csv_baseline_filename);
+		if (rc != EOK) {
+			fprintf(stderr, "Failed to load CSV baseline '%s': %s\n",
+			    csv_baseline_filename, str_error(rc));
+			return -4;
+		}
+	}
+
 	int exit_code = 0;
 
 	if (str_cmp(benchmark, "*") == 0) {
@@ -420,6 +534,7 @@ int main(int argc, char *argv[])
 	}
 
 	csv_report_close();
+	csv_baseline_cleanup();
 	bench_env_cleanup(&bench_env);
 
 	return exit_code;
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <inet/endpoint.h>
+#include <inet/hostport.h>
+#include <inet/tcp.h>
+#include <inttypes.h>
+#include <mem.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * TCP request-response latency against a remote echo service. Each
+ * operation sends one message and waits until the full echo comes back.
+ * Parameters: 'remote' (host:port of the echo service, mandatory),
+ * 'msgsize' (bytes per message), 'conns' (number of connections the
+ * requests are spread over, round-robin).
+ */
+
+#define DEFAULT_MSGSIZE "64"
+#define DEFAULT_CONNS "1"
+
+static tcp_t *tcp = NULL;
+static tcp_conn_t **conns = NULL;
+static size_t conn_count = 0;
+
+/* All callbacks optional; we use the blocking receive interface. */
+static tcp_cb_t conn_cb;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *remote = bench_env_param_get(env, "remote", NULL);
+	if (remote == NULL) {
+		return bench_run_fail(run,
+		    "missing 'remote' parameter (try -p remote=host:port)");
+	}
+
+	const char *conns_str = bench_env_param_get(env, "conns",
+	    DEFAULT_CONNS);
+	uint64_t nconns;
+	errno_t rc = str_uint64_t(conns_str, NULL, 10, true, &nconns);
+	if (rc != EOK || nconns == 0) {
+		return bench_run_fail(run, "invalid connection count '%s'",
+		    conns_str);
+	}
+
+	inet_ep2_t epp;
+	const char *errmsg;
+
+	inet_ep2_init(&epp);
+	rc = inet_hostport_plookup_one(remote, ip_any, &epp.remote, NULL,
+	    &errmsg);
+	if (rc != EOK) {
+		return bench_run_fail(run, "%s (host:port %s)", errmsg,
+		    remote);
+	}
+
+	rc = tcp_create(&tcp);
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed creating TCP service: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	conns = calloc(nconns, sizeof(tcp_conn_t *));
+	if (conns == NULL)
+		return bench_run_fail(run, "out of memory");
+
+	for (conn_count = 0; conn_count < nconns; conn_count++) {
+		rc = tcp_conn_create(tcp, &epp, &conn_cb, NULL,
+		    &conns[conn_count]);
+		if (rc != EOK) {
+			return bench_run_fail(run,
+			    "failed creating connection to %s: %s (%d)",
+			    remote, str_error(rc), rc);
+		}
+
+		rc = tcp_conn_wait_connected(conns[conn_count]);
+		if (rc != EOK) {
+			conn_count++;
+			return bench_run_fail(run,
+			    "failed connecting to %s: %s (%d)", remote,
+			    str_error(rc), rc);
+		}
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	for (size_t i = 0; i < conn_count; i++)
+		tcp_conn_destroy(conns[i]);
+	free(conns);
+	conns = NULL;
+	conn_count = 0;
+
+	tcp_destroy(tcp);
+	tcp = NULL;
+
+	return true;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	const char *msgsize_str = bench_env_param_get(env, "msgsize",
+	    DEFAULT_MSGSIZE);
+	uint64_t msg_size;
+	errno_t rc = str_uint64_t(msgsize_str, NULL, 10, true, &msg_size);
+	if (rc != EOK || msg_size == 0) {
+		return bench_run_fail(run, "invalid message size '%s'",
+		    msgsize_str);
+	}
+
+	char *buf = malloc(msg_size);
+	if (buf == NULL) {
+		return bench_run_fail(run, "failed to allocate %" PRIu64 " B buffer",
+		    msg_size);
+	}
+
+	memset(buf, 'x', msg_size);
+
+	bool ret = true;
+
+	stopwatch_t op_watch;
+	stopwatch_init(&op_watch);
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		tcp_conn_t *conn = conns[i % conn_count];
+
+		stopwatch_start(&op_watch);
+		rc = tcp_conn_send(conn, buf, msg_size);
+		if (rc != EOK) {
+			ret = bench_run_fail(run, "send failed: %s (%d)",
+			    str_error(rc), rc);
+			break;
+		}
+
+		size_t pos = 0;
+		while (pos < msg_size) {
+			size_t nrecv;
+			rc = tcp_conn_recv_wait(conn, buf + pos,
+			    msg_size - pos, &nrecv);
+			if (rc != EOK) {
+				ret = bench_run_fail(run,
+				    "receive failed: %s (%d)",
+				    str_error(rc), rc);
+				goto leave;
+			}
+			pos += nrecv;
+		}
+		stopwatch_stop(&op_watch);
+		bench_run_sample(run, stopwatch_get_nanos(&op_watch));
+	}
+leave:
+	bench_run_stop(run);
+
+	free(buf);
+
+	return ret;
+}
+
+benchmark_t benchmark_tcp_rr = {
+	.name = "tcp_rr",
+	.desc = "TCP request-response latency against a remote echo service",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <inet/endpoint.h>
+#include <inet/hostport.h>
+#include <inet/tcp.h>
+#include <inttypes.h>
+#include <mem.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * TCP send throughput: pushes messages over a single connection as fast
+ * as the stack accepts them. The remote peer must consume (and may
+ * discard) the data. Ops/s times 'msgsize' gives the byte throughput.
+ * Parameters: 'remote' (host:port, mandatory), 'msgsize' (bytes).
+ */
+
+#define DEFAULT_MSGSIZE "4096"
+
+static tcp_t *tcp = NULL;
+static tcp_conn_t *conn = NULL;
+
+static tcp_cb_t conn_cb;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *remote = bench_env_param_get(env, "remote", NULL);
+	if (remote == NULL) {
+		return bench_run_fail(run,
+		    "missing 'remote' parameter (try -p remote=host:port)");
+	}
+
+	inet_ep2_t epp;
+	const char *errmsg;
+
+	inet_ep2_init(&epp);
+	errno_t rc = inet_hostport_plookup_one(remote, ip_any, &epp.remote,
+	    NULL, &errmsg);
+	if (rc != EOK) {
+		return bench_run_fail(run, "%s (host:port %s)", errmsg,
+		    remote);
+	}
+
+	rc = tcp_create(&tcp);
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed creating TCP service: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	rc = tcp_conn_create(tcp, &epp, &conn_cb, NULL, &conn);
+	if (rc != EOK) {
+		return bench_run_fail(run,
+		    "failed creating connection to %s: %s (%d)", remote,
+		    str_error(rc), rc);
+	}
+
+	rc = tcp_conn_wait_connected(conn);
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed connecting to %s: %s (%d)",
+		    remote, str_error(rc), rc);
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	if (conn != NULL) {
+		tcp_conn_destroy(conn);
+		conn = NULL;
+	}
+
+	tcp_destroy(tcp);
+	tcp = NULL;
+
+	return true;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	const char *msgsize_str = bench_env_param_get(env, "msgsize",
+	    DEFAULT_MSGSIZE);
+	uint64_t msg_size;
+	errno_t rc = str_uint64_t(msgsize_str, NULL, 10, true, &msg_size);
+	if (rc != EOK || msg_size == 0) {
+		return bench_run_fail(run, "invalid message size '%s'",
+		    msgsize_str);
+	}
+
+	char *buf = malloc(msg_size);
+	if (buf == NULL) {
+		return bench_run_fail(run, "failed to allocate %" PRIu64 " B buffer",
+		    msg_size);
+	}
+
+	memset(buf, 'x', msg_size);
+
+	bool ret = true;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		rc = tcp_conn_send(conn, buf, msg_size);
+		if (rc != EOK) {
+			ret = bench_run_fail(run, "send failed: %s (%d)",
+			    str_error(rc), rc);
+			break;
+		}
+	}
+	bench_run_stop(run);
+
+	free(buf);
+
+	return ret;
+}
+
+benchmark_t benchmark_tcp_stream = {
+	.name = "tcp_stream",
+	.desc = "TCP send throughput over a single connection",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <fibril_synch.h>
+#include <inet/endpoint.h>
+#include <inet/hostport.h>
+#include <inet/udp.h>
+#include <inttypes.h>
+#include <mem.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * UDP request-response latency against a remote echo service. Each
+ * operation sends one datagram and waits for the reply (replies are
+ * delivered through the association callback, so the operation blocks
+ * on a condition variable). Unlike tcp_rr this also measures datagram
+ * loss indirectly: a lost reply fails the run with a timeout.
+ * Parameters: 'remote' (host:port, mandatory), 'msgsize' (bytes).
+ */
+
+#define DEFAULT_MSGSIZE "64"
+#define REPLY_TIMEOUT_USEC 5000000
+
+static udp_t *udp = NULL;
+static udp_assoc_t *assoc = NULL;
+
+static FIBRIL_MUTEX_INITIALIZE(reply_lock);
+static FIBRIL_CONDVAR_INITIALIZE(reply_cv);
+static uint64_t replies_rcvd = 0;
+
+static void bench_udp_recv_msg(udp_assoc_t *assoc, udp_rmsg_t *rmsg)
+{
+	fibril_mutex_lock(&reply_lock);
+	replies_rcvd++;
+	fibril_condvar_signal(&reply_cv);
+	fibril_mutex_unlock(&reply_lock);
+}
+
+static void bench_udp_recv_err(udp_assoc_t *assoc, udp_rerr_t *rerr)
+{
+}
+
+static void bench_udp_link_state(udp_assoc_t *assoc, udp_link_state_t lstate)
+{
+}
+
+static udp_cb_t assoc_cb = {
+	.recv_msg = bench_udp_recv_msg,
+	.recv_err = bench_udp_recv_err,
+	.link_state = bench_udp_link_state
+};
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *remote = bench_env_param_get(env, "remote", NULL);
+	if (remote == NULL) {
+		return bench_run_fail(run,
+		    "missing 'remote' parameter (try -p remote=host:port)");
+	}
+
+	inet_ep2_t epp;
+	const char *errmsg;
+
+	inet_ep2_init(&epp);
+	errno_t rc = inet_hostport_plookup_one(remote, ip_any, &epp.remote,
+	    NULL, &errmsg);
+	if (rc != EOK) {
+		return bench_run_fail(run, "%s (host:port %s)", errmsg,
+		    remote);
+	}
+
+	rc = udp_create(&udp);
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed creating UDP service: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	rc = udp_assoc_create(udp, &epp, &assoc_cb, NULL, &assoc);
+	if (rc != EOK) {
+		return bench_run_fail(run,
+		    "failed creating association with %s: %s (%d)", remote,
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	if (assoc != NULL) {
+		udp_assoc_destroy(assoc);
+		assoc = NULL;
+	}
+
+	udp_destroy(udp);
+	udp = NULL;
+
+	return true;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	const char *msgsize_str = bench_env_param_get(env, "msgsize",
+	    DEFAULT_MSGSIZE);
+	uint64_t msg_size;
+	errno_t rc = str_uint64_t(msgsize_str, NULL, 10, true, &msg_size);
+	if (rc != EOK || msg_size == 0) {
+		return bench_run_fail(run, "invalid message size '%s'",
+		    msgsize_str);
+	}
+
+	char *buf = malloc(msg_size);
+	if (buf == NULL) {
+		return bench_run_fail(run, "failed to allocate %" PRIu64 " B buffer",
+		    msg_size);
+	}
+
+	memset(buf, 'x', msg_size);
+
+	bool ret = true;
+
+	stopwatch_t op_watch;
+	stopwatch_init(&op_watch);
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		fibril_mutex_lock(&reply_lock);
+		uint64_t rcvd_before = replies_rcvd;
+		fibril_mutex_unlock(&reply_lock);
+
+		stopwatch_start(&op_watch);
+		rc = udp_assoc_send_msg(assoc, NULL, buf, msg_size);
+		if (rc != EOK) {
+			ret = bench_run_fail(run, "send failed: %s (%d)",
+			    str_error(rc), rc);
+			break;
+		}
+
+		fibril_mutex_lock(&reply_lock);
+		while (replies_rcvd == rcvd_before) {
+			rc = fibril_condvar_wait_timeout(&reply_cv,
+			    &reply_lock, REPLY_TIMEOUT_USEC);
+			if (rc != EOK) {
+				fibril_mutex_unlock(&reply_lock);
+				ret = bench_run_fail(run,
+				    "timed out waiting for reply "
+				    "(datagram lost?)");
+				goto leave;
+			}
+		}
+		fibril_mutex_unlock(&reply_lock);
+		stopwatch_stop(&op_watch);
+		bench_run_sample(run, stopwatch_get_nanos(&op_watch));
+	}
+leave:
+	bench_run_stop(run);
+
+	free(buf);
+
+	return ret;
+}
+
+benchmark_t benchmark_udp_rr = {
+	.name = "udp_rr",
+	.desc = "UDP request-response latency against a remote echo service",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
@@ -33,8 +33,10 @@
  * @file
  */
 
+#include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "hbench.h"
 
 /** Initialize bench run structure.
@@ -48,6 +50,26 @@ void bench_run_init(bench_run_t *run, char *error_buffer, size_t error_buffer_si
 	stopwatch_init(&run->stopwatch);
 	run->error_message = error_buffer;
 	run->error_message_buffer_size = error_buffer_size;
+	run->samples = NULL;
+	run->sample_count = 0;
+	run->samples_seen = 0;
+	run->pmu_cycles = 0;
+	run->pmu_cache_misses = 0;
+	run->pmu_valid = false;
+}
+
+/** Release resources owned by a bench run structure.
+ *
+ * Note that the error message buffer is owned by the caller.
+ *
+ * @param run Structure to clean up.
+ */
+void bench_run_cleanup(bench_run_t *run)
+{
+	free(run->samples);
+	run->samples = NULL;
+	run->sample_count = 0;
+	run->samples_seen = 0;
 }
 
 /** Format error message on benchmark failure.
@@ -75,5 +97,120 @@ bool bench_run_fail(bench_run_t *run, const char *fmt, ...)
 	return false;
 }
 
+/** Record the duration of a single operation.
+ *
+ * Keeps a bounded reservoir of samples: once the reservoir is full,
+ * each further sample replaces a random slot with probability
+ * reservoir_size / samples_seen, so the reservoir remains a uniform
+ * sample of all operations observed so far.
+ *
+ * Sampling is best effort: when the reservoir cannot be allocated the
+ * sample is silently dropped.
+ *
+ * @param run Current benchmark run.
+ * @param nanos Duration of the operation.
+ */
+void bench_run_sample(bench_run_t *run, nsec_t nanos)
+{
+	if (run->samples == NULL) {
+		run->samples = malloc(sizeof(nsec_t) * BENCH_RESERVOIR_SIZE);
+		if (run->samples == NULL)
+			return;
+	}
+
+	run->samples_seen++;
+	if (run->sample_count < BENCH_RESERVOIR_SIZE) {
+		run->samples[run->sample_count++] = nanos;
+	} else {
+		uint64_t r = (((uint64_t) rand()) << 16) ^ (uint64_t) rand();
+		uint64_t idx = r % run->samples_seen;
+		if (idx < BENCH_RESERVOIR_SIZE)
+			run->samples[idx] = nanos;
+	}
+}
+
+/** Estimate square root value.
+ *
+ * @param value The value to compute square root of.
+ * @param precision Required precision (e.g. 0.00001).
+ *
+ * @details
+ *
+ * This is a temporary solution until we have proper sqrt() implementation
+ * in libmath.
+ *
+ * The algorithm uses Babylonian method [1].
+ *
+ * [1] https://en.wikipedia.org/wiki/Methods_of_computing_square_roots#Babylonian_method
+ */
+double estimate_square_root(double value, double precision)
+{
+	double estimate = 1.;
+	double prev_estimate = estimate + 10 * precision;
+
+	while (fabs(estimate - prev_estimate) > precision) {
+		prev_estimate = estimate;
+		estimate = (prev_estimate + value / prev_estimate) / 2.;
+	}
+
+	return estimate;
+}
+
+static int nsec_cmp(const void *a, const void *b)
+{
+	const nsec_t *na = a;
+	const nsec_t *nb = b;
+
+	if (*na < *nb)
+		return -1;
+	if (*na > *nb)
+		return 1;
+	return 0;
+}
+
+/** Nearest-rank percentile of a sorted sample array. */
+static nsec_t percentile(nsec_t *sorted, size_t count, unsigned int p)
+{
+	size_t idx = (count * p + 99) / 100;
+
+	if (idx > 0)
+		idx--;
+	return sorted[idx];
+}
+
+/** Compute summary statistics over per-operation samples.
+ *
+ * @param samples Sample array; sorted in place as a side effect.
+ * @param count Number of samples (must be positive).
+ * @param stats Place to store the computed statistics.
+ */
+void bench_sample_stats_compute(nsec_t *samples, size_t count,
+    bench_sample_stats_t *stats)
+{
+	qsort(samples, count, sizeof(nsec_t), nsec_cmp);
+
+	stats->count = count;
+	stats->p50 = percentile(samples, count, 50);
+	stats->p95 = percentile(samples, count, 95);
+	stats->p99 = percentile(samples, count, 99);
+	stats->max = samples[count - 1];
+
+	double sum = 0.0;
+	double sum2 = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		double nanos = samples[i];
+		sum += nanos;
+		sum2 += nanos * nanos;
+	}
+	stats->mean = sum / count;
+	if (count > 1) {
+		double sigma2 = (sum2 - sum * stats->mean) /
+		    ((double) count - 1);
+		stats->stddev = estimate_square_root(sigma2, 0.001);
+	} else {
+		stats->stddev = NAN;
+	}
+}
+
 /** @}
  */
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <as.h>
+#include <inttypes.h>
+#include <str.h>
+#include "../hbench.h"
+
+/*
+ * Measures as_area_change_flags() on a fully populated area: each
+ * iteration drops the write permission and restores it again, forcing
+ * the kernel to walk and re-map the whole area twice. The area size can
+ * be set with the "size" parameter (bytes).
+ */
+
+#define DEFAULT_SIZE "1048576"
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	const char *size_str = bench_env_param_get(env, "size", DEFAULT_SIZE);
+
+	uint64_t area_size;
+	errno_t rc = str_uint64_t(size_str, NULL, 10, true, &area_size);
+	if (rc != EOK || area_size == 0) {
+		return bench_run_fail(run, "invalid area size '%s'", size_str);
+	}
+
+	volatile char *area = as_area_create(AS_AREA_ANY, area_size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+	    AS_AREA_UNPAGED);
+	if (area == AS_MAP_FAILED) {
+		return bench_run_fail(run, "failed to create %" PRIu64 " B area",
+		    area_size);
+	}
+
+	/* Populate the area so that there are mappings to change. */
+	for (uint64_t offset = 0; offset < area_size; offset += PAGE_SIZE)
+		area[offset] = 1;
+
+	bool ret = true;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		rc = as_area_change_flags((void *) area,
+		    AS_AREA_READ | AS_AREA_CACHEABLE);
+		if (rc != EOK) {
+			ret = bench_run_fail(run,
+			    "failed to make area read-only");
+			break;
+		}
+
+		rc = as_area_change_flags((void *) area,
+		    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE);
+		if (rc != EOK) {
+			ret = bench_run_fail(run,
+			    "failed to make area writable again");
+			break;
+		}
+	}
+	bench_run_stop(run);
+
+	as_area_destroy((void *) area);
+
+	return ret;
+}
+
+benchmark_t benchmark_vm_protect = {
+	.name = "vm_protect",
+	.desc = "Address space area protection change cycle ('size' param in bytes)",
+	.entry = &runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <as.h>
+#include <errno.h>
+#include <ipc_test.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * Measures the latency of sharing an address space area from another
+ * task: each iteration shares in the IPC test server's read-only area
+ * and unmaps it again. There is no direct as_area_share() syscall in
+ * userspace, so the IPC share-in protocol is the path that exercises
+ * the kernel's area sharing machinery.
+ */
+
+static ipc_test_t *test = NULL;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	errno_t rc = ipc_test_create(&test);
+	if (rc != EOK) {
+		return bench_run_fail(run,
+		    "failed contacting IPC test server (have you run /srv/test/ipc-test?): %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	ipc_test_destroy(test);
+	return true;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	size_t size;
+	errno_t rc = ipc_test_get_ro_area_size(test, &size);
+	if (rc != EOK) {
+		return bench_run_fail(run,
+		    "failed getting read-only area size: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	stopwatch_t op_watch;
+	stopwatch_init(&op_watch);
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		stopwatch_start(&op_watch);
+		const void *ro_ptr;
+		rc = ipc_test_share_in_ro(test, size, &ro_ptr);
+		if (rc != EOK) {
+			return bench_run_fail(run,
+			    "failed sharing in area: %s (%d)",
+			    str_error(rc), rc);
+		}
+
+		rc = as_area_destroy((void *) ro_ptr);
+		if (rc != EOK) {
+			return bench_run_fail(run,
+			    "failed unmapping shared area");
+		}
+		stopwatch_stop(&op_watch);
+		bench_run_sample(run, stopwatch_get_nanos(&op_watch));
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_vm_share = {
+	.name = "vm_share",
+	.desc = "Share in and unmap an area from the IPC test server",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
@@ -33,7 +33,9 @@
  * @file
  */
 
+#include <boottime.h>
 #include <fibril.h>
+#include <fibril_synch.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <vfs/vfs.h>
@@ -80,6 +82,82 @@ static const char *sys_dirs[] = {
 	"/w/data"
 };
 
+/** Maximum number of declared dependencies of one server */
+#define SRV_MAX_DEPS  3
+
+/** Server startup state */
+typedef enum {
+	/** Waiting for dependencies */
+	SRV_WAITING = 0,
+	/** Start in progress */
+	SRV_STARTING,
+	/** Start finished (successfully or not) */
+	SRV_DONE
+} srv_state_t;
+
+/** Declarative server start record */
+typedef struct {
+	/** Server binary path */
+	const char *path;
+	/** Optional argument */
+	const char *arg;
+	/** Do not start when the root file system has this format */
+	const char *skip_rdfmt;
+	/** Servers that must finish starting first (NULL-terminated) */
+	const char *deps[SRV_MAX_DEPS];
+	/** Startup state */
+	srv_state_t state;
+} srv_dep_t;
+
+/** File system and base servers started before mounting /loc.
+ *
+ * Servers without mutual dependencies are started concurrently.
+ * A dependency must precede its dependents in the table.
+ */
+static srv_dep_t fs_srvs[] = {
+	{ "/srv/fs/tmpfs", NULL, "tmpfs", { NULL } },
+	{ "/srv/fs/exfat", NULL, "exfat", { NULL } },
+	{ "/srv/fs/fat", NULL, "fat", { NULL } },
+	{ "/srv/fs/cdfs", NULL, NULL, { NULL } },
+	{ "/srv/fs/mfs", NULL, NULL, { NULL } },
+	{ "/srv/klog", NULL, NULL, { NULL } },
+	{ "/srv/fs/locfs", NULL, NULL, { NULL } },
+	{ "/srv/taskmon", NULL, NULL, { NULL } }
+};
+
+/** System servers started once /loc is mounted. */
+static srv_dep_t sys_srvs[] = {
+	{ "/srv/devman", NULL, NULL, { NULL } },
+	{ "/srv/hid/s3c24xx_uart", NULL, NULL, { NULL } },
+	{ "/srv/hid/s3c24xx_ts", NULL, NULL, { NULL } },
+	{ "/srv/bd/vbd", NULL, NULL, { NULL } },
+	{ "/srv/volsrv", NULL, NULL, { "/srv/bd/vbd", NULL } },
+	{ "/srv/net/loopip", NULL, NULL, { NULL } },
+	{ "/srv/net/ethip", NULL, NULL, { NULL } },
+	{ "/srv/net/inetsrv", NULL, NULL,
+	    { "/srv/net/loopip", "/srv/net/ethip", NULL } },
+	{ "/srv/net/tcp", NULL, NULL, { "/srv/net/inetsrv", NULL } },
+	{ "/srv/net/udp", NULL, NULL, { "/srv/net/inetsrv", NULL } },
+	{ "/srv/net/dnsrsrv", NULL, NULL, { "/srv/net/udp", NULL } },
+	{ "/srv/net/dhcp", NULL, NULL, { "/srv/net/udp", NULL } },
+	{ "/srv/net/nconfsrv", NULL, NULL, { "/srv/net/dhcp", NULL } },
+	{ "/srv/clipboard", NULL, NULL, { NULL } },
+	{ "/srv/hid/remcons", NULL, NULL, { "/srv/net/tcp", NULL } },
+	{ "/srv/hid/input", HID_INPUT, NULL, { NULL } },
+	{ "/srv/hid/output", HID_OUTPUT, NULL, { NULL } },
+	{ "/srv/audio/hound", NULL, NULL, { NULL } }
+};
+
+/** Currently started batch of servers */
+static srv_dep_t *srv_batch;
+static size_t srv_batch_count;
+
+/** Number of start fibrils still running */
+static unsigned srv_running;
+
+static FIBRIL_MUTEX_INITIALIZE(srv_lock);
+static FIBRIL_CONDVAR_INITIALIZE(srv_cv);
+
 /** Print banner */
 static void info_print(void)
 {
@@ -246,9 +324,112 @@ static errno_t srv_startl(const char *path, ...)
 		printf("%s: Server %s failed to start (exit code %d)\n", NAME,
 		    path, retval);
 
+	if (retval == 0)
+		boottime_mark(path);
+
 	return retval == 0 ? EOK : EPARTY;
 }
 
+/** Find a server record in the current batch */
+static srv_dep_t *srv_find(const char *path)
+{
+	for (size_t i = 0; i < srv_batch_count; i++) {
+		if (str_cmp(srv_batch[i].path, path) == 0)
+			return &srv_batch[i];
+	}
+
+	return NULL;
+}
+
+/** Check whether all dependencies of a server have been started.
+ *
+ * Must be called with @c srv_lock held.
+ */
+static bool srv_deps_done(srv_dep_t *srv)
+{
+	for (size_t i = 0; i < SRV_MAX_DEPS; i++) {
+		if (srv->deps[i] == NULL)
+			break;
+
+		srv_dep_t *dep = srv_find(srv->deps[i]);
+		if ((dep != NULL) && (dep->state != SRV_DONE))
+			return false;
+	}
+
+	return true;
+}
+
+/** Start one server once its dependencies have been started */
+static errno_t srv_start_fibril(void *arg)
+{
+	srv_dep_t *srv = (srv_dep_t *) arg;
+
+	fibril_mutex_lock(&srv_lock);
+	while (!srv_deps_done(srv))
+		fibril_condvar_wait(&srv_cv, &srv_lock);
+	srv->state = SRV_STARTING;
+	fibril_mutex_unlock(&srv_lock);
+
+	if (srv->arg != NULL)
+		srv_start(srv->path, srv->arg);
+	else
+		srv_start(srv->path);
+
+	fibril_mutex_lock(&srv_lock);
+	srv->state = SRV_DONE;
+	srv_running--;
+	fibril_condvar_broadcast(&srv_cv);
+	fibril_mutex_unlock(&srv_lock);
+
+	return EOK;
+}
+
+/** Start a batch of servers concurrently.
+ *
+ * Servers are spawned in parallel; each waits only for its declared
+ * dependencies. The function returns when every server in the batch
+ * has finished starting.
+ */
+static void srv_start_batch(srv_dep_t *srvs, size_t count)
+{
+	srv_batch = srvs;
+	srv_batch_count = count;
+
+	for (size_t i = 0; i < count; i++) {
+		srv_dep_t *srv = &srvs[i];
+
+		if ((srv->skip_rdfmt != NULL) &&
+		    (str_cmp(STRING(RDFMT), srv->skip_rdfmt) == 0)) {
+			fibril_mutex_lock(&srv_lock);
+			srv->state = SRV_DONE;
+			fibril_condvar_broadcast(&srv_cv);
+			fibril_mutex_unlock(&srv_lock);
+			continue;
+		}
+
+		fibril_mutex_lock(&srv_lock);
+		srv_running++;
+		fibril_mutex_unlock(&srv_lock);
+
+		fid_t fid = fibril_create(srv_start_fibril, srv);
+		if (fid != 0) {
+			fibril_add_ready(fid);
+		} else {
+			/*
+			 * Start synchronously. Only dependencies preceding
+			 * this entry can be pending, so this cannot
+			 * deadlock.
+			 */
+			srv_start_fibril(srv);
+		}
+	}
+
+	fibril_mutex_lock(&srv_lock);
+	while (srv_running > 0)
+		fibril_condvar_wait(&srv_cv, &srv_lock);
+	fibril_mutex_unlock(&srv_lock);
+}
+
 static errno_t console(const char *isvc, const char *osvc)
 {
 	/* Wait for the input service to be ready */
@@ -420,24 +601,17 @@ int main(int argc, char *argv[])
 
 	info_print();
 
+	boottime_mark("init:start");
+
 	if (!mount_root(STRING(RDFMT))) {
 		printf("%s: Exiting\n", NAME);
 		return 1;
 	}
 
+	boottime_mark("init:rootfs");
+
 	/* Make sure file systems are running. */
-	if (str_cmp(STRING(RDFMT), "tmpfs") != 0)
-		srv_start("/srv/fs/tmpfs");
-	if (str_cmp(STRING(RDFMT), "exfat") != 0)
-		srv_start("/srv/fs/exfat");
-	if (str_cmp(STRING(RDFMT), "fat") != 0)
-		srv_start("/srv/fs/fat");
-	srv_start("/srv/fs/cdfs");
-	srv_start("/srv/fs/mfs");
-
-	srv_start("/srv/klog");
-	srv_start("/srv/fs/locfs");
-	srv_start("/srv/taskmon");
+	srv_start_batch(fs_srvs, ARRAY_SIZE(fs_srvs));
 
 	if (!mount_locfs()) {
 		printf("%s: Exiting\n", NAME);
@@ -446,28 +620,9 @@ int main(int argc, char *argv[])
 
 	mount_tmpfs();
 
-	srv_start("/srv/devman");
-	srv_start("/srv/hid/s3c24xx_uart");
-	srv_start("/srv/hid/s3c24xx_ts");
-
-	srv_start("/srv/bd/vbd");
-	srv_start("/srv/volsrv");
+	srv_start_batch(sys_srvs, ARRAY_SIZE(sys_srvs));
 
-	srv_start("/srv/net/loopip");
-	srv_start("/srv/net/ethip");
-	srv_start("/srv/net/inetsrv");
-	srv_start("/srv/net/tcp");
-	srv_start("/srv/net/udp");
-	srv_start("/srv/net/dnsrsrv");
-	srv_start("/srv/net/dhcp");
-	srv_start("/srv/net/nconfsrv");
-
-	srv_start("/srv/clipboard");
-	srv_start("/srv/hid/remcons");
-
-	srv_start("/srv/hid/input", HID_INPUT);
-	srv_start("/srv/hid/output", HID_OUTPUT);
-	srv_start("/srv/audio/hound");
+	boottime_mark("init:services");
 
 	init_sysvol();
 
@@ -490,6 +645,8 @@ int main(int argc, char *argv[])
 		getterm("term/vc5", "/app/bdsh", false);
 	}
 
+	boottime_mark("init:done");
+
 	return 0;
 }
 
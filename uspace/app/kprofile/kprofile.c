@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kprofile
+ * @{
+ */
+/** @file kprofile.c
+ * @brief Flat profile from the kernel sampling profiler.
+ *
+ * Fetch a snapshot of the per-CPU sample ring buffers via the
+ * profile.data sysinfo item, symbolize the sampled program counters
+ * against ELF images and print a flat profile. Profiling is started
+ * and stopped from the kernel console using the profile command.
+ *
+ * Kernel samples are symbolized against the image given with -k,
+ * user space samples against the (statically linked, fixed-base)
+ * images given as plain arguments. Samples that match no image are
+ * aggregated by address.
+ */
+
+#include <abi/sysinfo.h>
+#include <elf/elf_symtab.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include <sysinfo.h>
+
+#define NAME  "kprofile"
+
+/** Maximum number of user space images to symbolize against */
+#define MAX_IMAGES  16
+
+typedef struct {
+	const char *path;
+	elf_symtab_t *symtab;
+} image_t;
+
+static image_t kernel_image;
+static image_t user_images[MAX_IMAGES];
+static size_t user_image_cnt = 0;
+
+/** One row of the flat profile */
+typedef struct {
+	char *name;       /**< Symbol name or NULL if unresolved */
+	const char *path; /**< Image the symbol comes from or NULL */
+	uint64_t pc;      /**< Sampled address (exact for unresolved rows) */
+	bool kernel;      /**< Sample taken in kernel code */
+	uint64_t count;   /**< Number of samples */
+} prof_row_t;
+
+static prof_row_t *rows = NULL;
+static size_t row_cnt = 0;
+static size_t row_cap = 0;
+
+static void usage(void)
+{
+	printf("Usage: %s [-k <kernel-image>] [<app-image> ...]\n", NAME);
+}
+
+/** Account one sample to its flat profile row */
+static errno_t count_sample(const profile_sample_t *sample)
+{
+	char *name = NULL;
+	const char *path = NULL;
+	size_t offs;
+
+	if (sample->flags & PROFILE_SAMPLE_KERNEL) {
+		if (kernel_image.symtab != NULL &&
+		    elf_symtab_addr_to_name(kernel_image.symtab,
+		    (uintptr_t) sample->pc, &name, &offs) == EOK) {
+			path = kernel_image.path;
+		}
+	} else {
+		for (size_t i = 0; i < user_image_cnt; i++) {
+			if (elf_symtab_addr_to_name(user_images[i].symtab,
+			    (uintptr_t) sample->pc, &name, &offs) == EOK) {
+				path = user_images[i].path;
+				break;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < row_cnt; i++) {
+		prof_row_t *row = &rows[i];
+
+		if (row->kernel != (bool) (sample->flags &
+		    PROFILE_SAMPLE_KERNEL))
+			continue;
+
+		if (name != NULL) {
+			if (row->name != NULL &&
+			    str_cmp(row->name, name) == 0 &&
+			    row->path == path) {
+				row->count++;
+				return EOK;
+			}
+		} else {
+			if (row->name == NULL && row->pc == sample->pc) {
+				row->count++;
+				return EOK;
+			}
+		}
+	}
+
+	if (row_cnt >= row_cap) {
+		size_t ncap = (row_cap == 0) ? 64 : 2 * row_cap;
+		prof_row_t *nrows = realloc(rows, ncap * sizeof(prof_row_t));
+		if (nrows == NULL)
+			return ENOMEM;
+		rows = nrows;
+		row_cap = ncap;
+	}
+
+	rows[row_cnt].name = name;
+	rows[row_cnt].path = path;
+	rows[row_cnt].pc = sample->pc;
+	rows[row_cnt].kernel = (sample->flags & PROFILE_SAMPLE_KERNEL) != 0;
+	rows[row_cnt].count = 1;
+	row_cnt++;
+
+	return EOK;
+}
+
+static int row_cmp(const void *a, const void *b)
+{
+	const prof_row_t *ra = a;
+	const prof_row_t *rb = b;
+
+	if (ra->count > rb->count)
+		return -1;
+	if (ra->count < rb->count)
+		return 1;
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	errno_t rc;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (str_cmp(argv[i], "-k") == 0) {
+			if (i + 1 >= argc) {
+				usage();
+				return 1;
+			}
+			kernel_image.path = argv[++i];
+		} else if (str_cmp(argv[i], "-h") == 0 ||
+		    str_cmp(argv[i], "--help") == 0) {
+			usage();
+			return 0;
+		} else {
+			if (user_image_cnt >= MAX_IMAGES) {
+				fprintf(stderr, "%s: Too many images "
+				    "(at most %d).\n", NAME, MAX_IMAGES);
+				return 1;
+			}
+			user_images[user_image_cnt++].path = argv[i];
+		}
+	}
+
+	if (kernel_image.path != NULL) {
+		rc = elf_symtab_load(kernel_image.path, &kernel_image.symtab);
+		if (rc != EOK) {
+			fprintf(stderr, "%s: Unable to load symbols from %s: "
+			    "%s.\n", NAME, kernel_image.path, str_error(rc));
+			return 1;
+		}
+	}
+
+	for (size_t img = 0; img < user_image_cnt; img++) {
+		rc = elf_symtab_load(user_images[img].path,
+		    &user_images[img].symtab);
+		if (rc != EOK) {
+			fprintf(stderr, "%s: Unable to load symbols from %s: "
+			    "%s.\n", NAME, user_images[img].path,
+			    str_error(rc));
+			return 1;
+		}
+	}
+
+	sysarg_t enabled;
+	if (sysinfo_get_value("profile.enabled", &enabled) != EOK) {
+		fprintf(stderr, "%s: Kernel sampling profiler not "
+		    "available.\n", NAME);
+		return 1;
+	}
+
+	sysarg_t nentries;
+	sysarg_t rate;
+	if (sysinfo_get_value("profile.entries", &nentries) != EOK ||
+	    sysinfo_get_value("profile.rate", &rate) != EOK) {
+		fprintf(stderr, "%s: Unable to get buffer geometry.\n", NAME);
+		return 1;
+	}
+
+	size_t size;
+	void *data = sysinfo_get_data("profile.data", &size);
+	if (data == NULL) {
+		fprintf(stderr, "%s: Unable to get profile data.\n", NAME);
+		return 1;
+	}
+
+	size_t buf_size = sizeof(size_t) + sizeof(profile_sample_t) * nentries;
+	size_t cpus = size / buf_size;
+
+	printf("Profiling is %s, %" PRIun " samples/s per CPU, "
+	    "%zu CPU buffer(s) of %" PRIun " samples.\n",
+	    enabled ? "enabled" : "disabled", rate, cpus, nentries);
+
+	uint64_t total = 0;
+	uint64_t overwritten = 0;
+
+	uint8_t *pos = (uint8_t *) data;
+	for (size_t cpu = 0; cpu < cpus; cpu++) {
+		size_t head = *((size_t *) pos);
+		profile_sample_t *samples =
+		    (profile_sample_t *) (pos + sizeof(size_t));
+
+		size_t valid = (head < nentries) ? head : nentries;
+		if (head > nentries)
+			overwritten += head - nentries;
+
+		for (size_t s = 0; s < valid; s++) {
+			if (count_sample(&samples[s]) != EOK) {
+				fprintf(stderr, "%s: Out of memory.\n", NAME);
+				free(data);
+				return 1;
+			}
+			total++;
+		}
+
+		pos += buf_size;
+	}
+
+	free(data);
+
+	if (total == 0) {
+		printf("No samples recorded. Start profiling with the "
+		    "'profile start' kernel console command.\n");
+		return 0;
+	}
+
+	qsort(rows, row_cnt, sizeof(prof_row_t), row_cmp);
+
+	printf("%" PRIu64 " sample(s)", total);
+	if (overwritten > 0)
+		printf(" (%" PRIu64 " older sample(s) overwritten)",
+		    overwritten);
+	printf("\n\n");
+
+	printf("%8s %6s %s %s\n", "samples", "%", "k", "symbol");
+	for (size_t r = 0; r < row_cnt; r++) {
+		prof_row_t *row = &rows[r];
+
+		printf("%8" PRIu64 " %6.2f %c ", row->count,
+		    100.0 * row->count / total, row->kernel ? 'k' : 'u');
+
+		if (row->name != NULL)
+			printf("%s (%s)\n", row->name, row->path);
+		else
+			printf("%#" PRIx64 "\n", row->pc);
+	}
+
+	free(rows);
+
+	if (kernel_image.symtab != NULL)
+		elf_symtab_delete(kernel_image.symtab);
+	for (size_t img = 0; img < user_image_cnt; img++)
+		elf_symtab_delete(user_images[img].symtab);
+
+	return 0;
+}
+
+/** @}
+ */
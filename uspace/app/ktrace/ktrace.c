@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup ktrace
+ * @{
+ */
+/** @file ktrace.c
+ * @brief Dump the kernel tracepoint buffers.
+ *
+ * Fetch a snapshot of the per-CPU kernel tracepoint ring buffers
+ * via the trace.data sysinfo item and print the recorded events.
+ * Tracing is started and stopped from the kernel console using the
+ * trace command.
+ */
+
+#include <abi/sysinfo.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sysinfo.h>
+
+#define NAME  "ktrace"
+
+static const char *event_name(uint32_t event)
+{
+	switch (event) {
+	case TRACE_EVENT_SCHEDULER_ENTER:
+		return "scheduler_enter";
+	case TRACE_EVENT_SYSCALL:
+		return "syscall";
+	case TRACE_EVENT_IPC_CALL:
+		return "ipc_call";
+	case TRACE_EVENT_FRAME_ALLOC:
+		return "frame_alloc";
+	default:
+		return "unknown";
+	}
+}
+
+/** Print the contents of one per-CPU buffer, oldest entry first */
+static void dump_buffer(size_t head, trace_entry_t *entries, size_t nentries)
+{
+	size_t valid = (head < nentries) ? head : nentries;
+	size_t start = (head < nentries) ? 0 : (head % nentries);
+
+	if (head > nentries)
+		printf("(%zu older events overwritten)\n", head - nentries);
+
+	for (size_t i = 0; i < valid; i++) {
+		trace_entry_t *entry = &entries[(start + i) % nentries];
+
+		printf("%20" PRIu64 " cpu%-3" PRIu32 " %-16s %#18" PRIx64
+		    " %#18" PRIx64 "\n", entry->stamp, entry->cpu,
+		    event_name(entry->event), entry->arg1, entry->arg2);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	sysarg_t enabled;
+	if (sysinfo_get_value("trace.enabled", &enabled) != EOK) {
+		fprintf(stderr, "%s: Kernel tracepoints not available.\n",
+		    NAME);
+		return 1;
+	}
+
+	sysarg_t nentries;
+	if (sysinfo_get_value("trace.entries", &nentries) != EOK) {
+		fprintf(stderr, "%s: Unable to get buffer geometry.\n", NAME);
+		return 1;
+	}
+
+	size_t size;
+	void *data = sysinfo_get_data("trace.data", &size);
+	if (data == NULL) {
+		fprintf(stderr, "%s: Unable to get trace data.\n", NAME);
+		return 1;
+	}
+
+	size_t buf_size = sizeof(size_t) + sizeof(trace_entry_t) * nentries;
+	size_t cpus = size / buf_size;
+
+	printf("Tracing is %s, %zu CPU buffer(s) of %" PRIun " entries.\n",
+	    enabled ? "enabled" : "disabled", cpus, nentries);
+
+	uint8_t *pos = (uint8_t *) data;
+	for (size_t cpu = 0; cpu < cpus; cpu++) {
+		size_t head = *((size_t *) pos);
+		trace_entry_t *entries =
+		    (trace_entry_t *) (pos + sizeof(size_t));
+
+		printf("== cpu%zu: %zu event(s) recorded\n", cpu, head);
+		dump_buffer(head, entries, nentries);
+
+		pos += buf_size;
+	}
+
+	free(data);
+	return 0;
+}
+
+/** @}
+ */
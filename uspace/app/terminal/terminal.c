@@ -48,6 +48,7 @@
 #include <io/concaps.h>
 #include <io/console.h>
 #include <io/pixelmap.h>
+#include <macros.h>
 #include <task.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -70,6 +71,9 @@
 #define TERM_CAPS \
 	(CONSOLE_CAP_STYLE | CONSOLE_CAP_INDEXED | CONSOLE_CAP_RGB)
 
+/** How many glyphs are looked up ahead when rendering a run of cells */
+#define GLYPH_RUN_MAX  32
+
 static LIST_INITIALIZE(terms);
 
 static errno_t term_open(con_srvs_t *, con_srv_t *);
@@ -250,43 +254,165 @@ static void term_update_char(terminal_t *term, pixelmap_t *pixelmap,
 	term_update_region(term, bx, by, FONT_WIDTH, FONT_SCANLINES);
 }
 
-static bool term_update_scroll(terminal_t *term, pixelmap_t *pixelmap,
-    sysarg_t sx, sysarg_t sy)
+/** Render a run of cells sharing the same attributes.
+ *
+ * Rendering a whole run at once computes the colors once, looks each
+ * glyph up once instead of once per scanline and fills each scanline
+ * left to right, which is considerably faster than going cell by cell.
+ */
+static void term_render_run(terminal_t *term, pixelmap_t *pixelmap,
+    sysarg_t sx, sysarg_t sy, sysarg_t col, sysarg_t row, sysarg_t ncols)
 {
-	sysarg_t top_row = chargrid_get_top_row(term->frontbuf);
+	charfield_t *field =
+	    chargrid_charfield_at(term->backbuf, col, row);
 
-	if (term->top_row == top_row) {
-		return false;
+	pixel_t bgcolor = 0;
+	pixel_t fgcolor = 0;
+
+	attrs_rgb(field->attrs, &bgcolor, &fgcolor);
+
+	sysarg_t bx = sx + (col * FONT_WIDTH);
+	sysarg_t by = sy + (row * FONT_SCANLINES);
+
+	while (ncols > 0) {
+		sysarg_t n = min(ncols, GLYPH_RUN_MAX);
+		uint16_t glyphs[GLYPH_RUN_MAX];
+
+		for (sysarg_t i = 0; i < n; i++) {
+			field = chargrid_charfield_at(term->backbuf, col + i,
+			    row);
+			glyphs[i] = fb_font_glyph(field->ch, NULL);
+		}
+
+		for (unsigned int y = 0; y < FONT_SCANLINES; y++) {
+			pixel_t *dst = pixelmap_pixel_at(pixelmap, bx, by + y);
+			pixel_t *dst_max = pixelmap_pixel_at(pixelmap,
+			    bx + (n * FONT_WIDTH) - 1, by + y);
+			if (!dst || !dst_max)
+				continue;
+			for (sysarg_t i = 0; i < n; i++) {
+				uint8_t bits = fb_font[glyphs[i]][y];
+				int count = FONT_WIDTH;
+				while (count-- != 0)
+					*dst++ = (bits & (1 << count)) ? fgcolor : bgcolor;
+			}
+		}
+
+		term_update_region(term, bx, by, n * FONT_WIDTH,
+		    FONT_SCANLINES);
+
+		bx += n * FONT_WIDTH;
+		col += n;
+		ncols -= n;
 	}
+}
 
-	term->top_row = top_row;
+/** Synchronize one row of the back buffer with the front buffer and render
+ * the cells that changed, batching contiguous same-attribute spans.
+ *
+ * @param dirty_only Only consider cells with CHAR_FLAG_DIRTY set
+ * @param force Render every cell, even if it has not changed
+ * @return @c true if anything was rendered
+ */
+static bool term_update_row(terminal_t *term, pixelmap_t *pixelmap,
+    sysarg_t sx, sysarg_t sy, sysarg_t row, bool dirty_only, bool force)
+{
+	bool update = false;
+	sysarg_t col;
+
+	/* Copy changed cells to the back buffer and mark them for rendering */
 
-	for (sysarg_t row = 0; row < term->rows; row++) {
-		for (sysarg_t col = 0; col < term->cols; col++) {
-			charfield_t *front_field =
-			    chargrid_charfield_at(term->frontbuf, col, row);
-			charfield_t *back_field =
-			    chargrid_charfield_at(term->backbuf, col, row);
-			bool update = false;
+	for (col = 0; col < term->cols; col++) {
+		charfield_t *front_field =
+		    chargrid_charfield_at(term->frontbuf, col, row);
+		charfield_t *back_field =
+		    chargrid_charfield_at(term->backbuf, col, row);
+		bool cupdate = force;
 
+		if (!dirty_only || (front_field->flags & CHAR_FLAG_DIRTY) ==
+		    CHAR_FLAG_DIRTY) {
 			if (front_field->ch != back_field->ch) {
 				back_field->ch = front_field->ch;
-				update = true;
+				cupdate = true;
 			}
 
-			if (!attrs_same(front_field->attrs, back_field->attrs)) {
+			if (!attrs_same(front_field->attrs,
+			    back_field->attrs)) {
 				back_field->attrs = front_field->attrs;
-				update = true;
+				cupdate = true;
 			}
 
 			front_field->flags &= ~CHAR_FLAG_DIRTY;
+		}
 
-			if (update) {
-				term_update_char(term, pixelmap, sx, sy, col, row);
-			}
+		if (cupdate)
+			back_field->flags |= CHAR_FLAG_DIRTY;
+		else
+			back_field->flags &= ~CHAR_FLAG_DIRTY;
+	}
+
+	/* Render marked cells, merging same-attribute neighbors into runs */
+
+	col = 0;
+	while (col < term->cols) {
+		charfield_t *back_field =
+		    chargrid_charfield_at(term->backbuf, col, row);
+
+		if ((back_field->flags & CHAR_FLAG_DIRTY) != CHAR_FLAG_DIRTY) {
+			col++;
+			continue;
+		}
+
+		/* The cursor cell is rendered inverted, on its own */
+		if (chargrid_cursor_at(term->backbuf, col, row)) {
+			back_field->flags &= ~CHAR_FLAG_DIRTY;
+			term_update_char(term, pixelmap, sx, sy, col, row);
+			update = true;
+			col++;
+			continue;
+		}
+
+		sysarg_t run_start = col;
+		char_attrs_t attrs = back_field->attrs;
+
+		while (col < term->cols) {
+			back_field = chargrid_charfield_at(term->backbuf, col,
+			    row);
+
+			if ((back_field->flags & CHAR_FLAG_DIRTY) !=
+			    CHAR_FLAG_DIRTY)
+				break;
+			if (!attrs_same(back_field->attrs, attrs))
+				break;
+			if (chargrid_cursor_at(term->backbuf, col, row))
+				break;
+
+			back_field->flags &= ~CHAR_FLAG_DIRTY;
+			col++;
 		}
+
+		term_render_run(term, pixelmap, sx, sy, run_start, row,
+		    col - run_start);
+		update = true;
+	}
+
+	return update;
+}
+
+static bool term_update_scroll(terminal_t *term, pixelmap_t *pixelmap,
+    sysarg_t sx, sysarg_t sy)
+{
+	sysarg_t top_row = chargrid_get_top_row(term->frontbuf);
+
+	if (term->top_row == top_row) {
+		return false;
 	}
 
+	term->top_row = top_row;
+
+	for (sysarg_t row = 0; row < term->rows; row++)
+		term_update_row(term, pixelmap, sx, sy, row, false, false);
+
 	return true;
 }
 
@@ -351,34 +477,9 @@ static void term_update(terminal_t *term)
 		update = true;
 	} else {
 		for (sysarg_t y = 0; y < term->rows; y++) {
-			for (sysarg_t x = 0; x < term->cols; x++) {
-				charfield_t *front_field =
-				    chargrid_charfield_at(term->frontbuf, x, y);
-				charfield_t *back_field =
-				    chargrid_charfield_at(term->backbuf, x, y);
-				bool cupdate = false;
-
-				if ((front_field->flags & CHAR_FLAG_DIRTY) ==
-				    CHAR_FLAG_DIRTY) {
-					if (front_field->ch != back_field->ch) {
-						back_field->ch = front_field->ch;
-						cupdate = true;
-					}
-
-					if (!attrs_same(front_field->attrs,
-					    back_field->attrs)) {
-						back_field->attrs = front_field->attrs;
-						cupdate = true;
-					}
-
-					front_field->flags &= ~CHAR_FLAG_DIRTY;
-				}
-
-				if (cupdate) {
-					term_update_char(term, &pixelmap, sx, sy, x, y);
-					update = true;
-				}
-			}
+			if (term_update_row(term, &pixelmap, sx, sy, y,
+			    true, false))
+				update = true;
 		}
 	}
 
@@ -421,20 +522,9 @@ static void term_repaint(terminal_t *term)
 	sysarg_t sy = 0;
 
 	if (!term_update_scroll(term, &pixelmap, sx, sy)) {
-		for (sysarg_t y = 0; y < term->rows; y++) {
-			for (sysarg_t x = 0; x < term->cols; x++) {
-				charfield_t *front_field =
-				    chargrid_charfield_at(term->frontbuf, x, y);
-				charfield_t *back_field =
-				    chargrid_charfield_at(term->backbuf, x, y);
-
-				back_field->ch = front_field->ch;
-				back_field->attrs = front_field->attrs;
-				front_field->flags &= ~CHAR_FLAG_DIRTY;
-
-				term_update_char(term, &pixelmap, sx, sy, x, y);
-			}
-		}
+		for (sysarg_t y = 0; y < term->rows; y++)
+			term_update_row(term, &pixelmap, sx, sy, y, false,
+			    true);
 	}
 
 	term_update_cursor(term, &pixelmap, sx, sy);
@@ -501,42 +591,45 @@ static errno_t term_read(con_srv_t *srv, void *buf, size_t size, size_t *nread)
 	return EOK;
 }
 
+/** Write one character to the front buffer. The caller must hold term->mtx
+ * and is responsible for updating the display afterwards. */
 static void term_write_char(terminal_t *term, wchar_t ch)
 {
-	sysarg_t updated = 0;
-
-	fibril_mutex_lock(&term->mtx);
-
 	switch (ch) {
 	case '\n':
-		updated = chargrid_newline(term->frontbuf);
+		chargrid_newline(term->frontbuf);
 		break;
 	case '\r':
 		break;
 	case '\t':
-		updated = chargrid_tabstop(term->frontbuf, 8);
+		chargrid_tabstop(term->frontbuf, 8);
 		break;
 	case '\b':
-		updated = chargrid_backspace(term->frontbuf);
+		chargrid_backspace(term->frontbuf);
 		break;
 	default:
-		updated = chargrid_putuchar(term->frontbuf, ch, true);
+		chargrid_putuchar(term->frontbuf, ch, true);
 	}
-
-	fibril_mutex_unlock(&term->mtx);
-
-	if (updated > 1)
-		term_update(term);
 }
 
 static errno_t term_write(con_srv_t *srv, void *data, size_t size, size_t *nwritten)
 {
 	terminal_t *term = srv_to_terminal(srv);
 
+	/*
+	 * Only render once the entire chunk has been written to the front
+	 * buffer. Rendering after every scrolled line would repaint the
+	 * whole grid once per line of output.
+	 */
+	fibril_mutex_lock(&term->mtx);
+
 	size_t off = 0;
 	while (off < size)
 		term_write_char(term, str_decode(data, &off, size));
 
+	fibril_mutex_unlock(&term->mtx);
+
+	term_update(term);
 	gfx_update(term->gc);
 	*nwritten = size;
 	return EOK;
@@ -99,7 +99,7 @@ const sc_desc_t syscall_desc[] = {
 	[SYS_IOSPACE_ENABLE] = { "iospace_enable", 1, V_ERRNO },
 	[SYS_IOSPACE_DISABLE] = { "iospace_disable", 1, V_ERRNO },
 
-	[SYS_IPC_IRQ_SUBSCRIBE] = { "ipc_irq_subscribe", 4, V_ERRNO },
+	[SYS_IPC_IRQ_SUBSCRIBE] = { "ipc_irq_subscribe", 5, V_ERRNO },
 	[SYS_IPC_IRQ_UNSUBSCRIBE] = { "ipc_irq_unsubscribe", 2, V_ERRNO },
 
 	/* Sysinfo syscalls. */
@@ -113,7 +113,11 @@ const sc_desc_t syscall_desc[] = {
 	/* Kernel console syscalls. */
 	[SYS_DEBUG_CONSOLE] = { "debug_console", 0, V_ERRNO },
 
-	[SYS_KLOG] = { "klog", 5, V_ERRNO }
+	[SYS_KLOG] = { "klog", 5, V_ERRNO },
+
+	[SYS_BOOTTIME_MARK] = { "boottime_mark", 2, V_ERRNO },
+
+	[SYS_PMU_CTL] = { "pmu_ctl", 3, V_ERRNO }
 };
 
 const size_t syscall_desc_len = (sizeof(syscall_desc) / sizeof(sc_desc_t));
@@ -67,6 +67,9 @@
 uintptr_t thread_hash_buf[THBUF_SIZE];
 int n_threads;
 
+/** How long to sleep when the event ring is found empty (usec) */
+#define EV_POLL_INTERVAL 10000
+
 int next_thread_id;
 
 ipc_call_t thread_ipc_req[THBUF_SIZE];
@@ -90,6 +93,7 @@ static char **cmd_args;
 static task_id_t task_id;
 static task_wait_t task_w;
 static bool task_wait_for;
+static bool batch_mode;
 
 /** Combination of events/data to print. */
 display_mask_t display_mask;
@@ -417,6 +421,74 @@ static void event_thread_b(uintptr_t hash)
 	thread_trace_start(hash);
 }
 
+/** Print one syscall event recorded in the kernel event ring. */
+static void event_print(udebug_ev_t *ev)
+{
+	unsigned sc_id = (unsigned) ev->sc_id;
+	int rv_type;
+
+	if ((display_mask & DM_SYSCALL) == 0)
+		return;
+
+	printf("[%p] ", (void *) ev->thread);
+
+	if (ev->etype == UDEBUG_EVENT_SYSCALL_B) {
+		if (syscall_desc_defined(sc_id)) {
+			printf("%s", syscall_desc[sc_id].name);
+			print_sc_args(ev->args, syscall_desc[sc_id].n_args);
+		} else {
+			printf("unknown_syscall<%u>", sc_id);
+			print_sc_args(ev->args, 6);
+		}
+		putchar('\n');
+	} else {
+		if (syscall_desc_defined(sc_id)) {
+			printf("%s", syscall_desc[sc_id].name);
+			rv_type = syscall_desc[sc_id].rv_type;
+		} else {
+			printf("unknown_syscall<%u>", sc_id);
+			rv_type = V_PTR;
+		}
+		print_sc_retval(ev->sc_rc, rv_type);
+	}
+}
+
+/** Drain recorded syscall events from the kernel event ring.
+ *
+ * In batch mode the threads of the debugged task run freely while their
+ * syscall events accumulate in a kernel ring. This fibril periodically
+ * reads whole batches of events in a single round trip and prints them.
+ */
+static errno_t ev_drain_fibril(void *arg)
+{
+	static udebug_ev_t ev_buf[UDEBUG_EV_RING_SIZE];
+	size_t copied, needed, lost;
+	size_t cnt, i;
+	errno_t rc;
+
+	(void) arg;
+
+	while (!abort_trace) {
+		rc = udebug_ev_read(sess, ev_buf, sizeof(ev_buf), &copied,
+		    &needed, &lost);
+		if (rc != EOK)
+			break;
+
+		cnt = copied / sizeof(udebug_ev_t);
+		for (i = 0; i < cnt; i++)
+			event_print(&ev_buf[i]);
+
+		if (lost > 0)
+			printf("Warning: %zu syscall events lost.\n", lost);
+
+		/* Poll again once the ring has been emptied. */
+		if (needed <= copied)
+			fibril_usleep(EV_POLL_INTERVAL);
+	}
+
+	return EOK;
+}
+
 static errno_t trace_loop(void *thread_hash_arg)
 {
 	errno_t rc;
@@ -541,6 +613,7 @@ static void trace_task(task_id_t task_id)
 	kbd_event_t ev;
 	bool done;
 	int i;
+	fid_t fid;
 	errno_t rc;
 
 	ipcp_init();
@@ -553,6 +626,22 @@ static void trace_task(task_id_t task_id)
 
 	abort_trace = false;
 
+	if (batch_mode) {
+		rc = udebug_ev_ring_set(sess, true);
+		if (rc != EOK) {
+			printf("Failed to enable event ring (%s)\n",
+			    str_error(rc));
+			return;
+		}
+
+		fid = fibril_create(ev_drain_fibril, NULL);
+		if (fid == 0) {
+			printf("Error creating fibril\n");
+			return;
+		}
+		fibril_add_ready(fid);
+	}
+
 	for (i = 0; i < n_threads; i++) {
 		thread_trace_start(thread_hash_buf[i]);
 	}
@@ -677,8 +766,8 @@ static void main_init(void)
 static void print_syntax(void)
 {
 	printf("Syntax:\n");
-	printf("\ttrace [+<events>] <executable> [<arg1> [...]]\n");
-	printf("or\ttrace [+<events>] -t <task_id>\n");
+	printf("\ttrace [+<events>] [-b] <executable> [<arg1> [...]]\n");
+	printf("or\ttrace [+<events>] [-b] -t <task_id>\n");
 	printf("Events: (default is +tp)\n");
 	printf("\n");
 	printf("\tt ... Thread creation and termination\n");
@@ -686,6 +775,9 @@ static void print_syntax(void)
 	printf("\ti ... Low-level IPC\n");
 	printf("\tp ... Protocol level\n");
 	printf("\n");
+	printf("\t-b ... Batch mode: collect syscall events in the kernel\n");
+	printf("\t       event ring instead of stopping on each of them\n");
+	printf("\n");
 	printf("Examples:\n");
 	printf("\ttrace +s /app/tetris\n");
 	printf("\ttrace +tsip -t 12\n");
@@ -735,7 +827,9 @@ static int parse_args(int argc, char *argv[])
 		if (arg[0] == '+') {
 			display_mask = parse_display_mask(&arg[1]);
 		} else if (arg[0] == '-') {
-			if (arg[1] == 't') {
+			if (arg[1] == 'b') {
+				batch_mode = true;
+			} else if (arg[1] == 't') {
 				/* Trace an already running task */
 				--argc;
 				++argv;
@@ -385,19 +385,15 @@ static void hdaudio_interrupt(ipc_call_t *icall, ddf_dev_t *dev)
 	hda_ctl_interrupt(hda->ctl);
 
 	if (ipc_get_arg3(icall) != 0) {
-		/* Buffer completed */
+		/*
+		 * Buffer completed. BDL entries are split to match the
+		 * client's fragment size, so one entry equals one fragment.
+		 */
 		hda_lock(hda);
-		if (hda->playing) {
+		if (hda->playing)
 			hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
-		} else if (hda->capturing) {
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
+		else if (hda->capturing)
 			hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
-		}
 
 		hda_unlock(hda);
 	}
@@ -247,6 +247,12 @@ static errno_t hda_start_playback(ddf_fun_t *fun, unsigned frames,
 		return EBUSY;
 	}
 
+	/* Interrupt after every period worth of frames */
+	rc = hda_stream_buffers_split(hda->pcm_buffers,
+	    frames * pcm_sample_format_frame_size(channels, format));
+	if (rc != EOK)
+		ddf_msg(LVL_WARN, "Cannot use a period of %u frames", frames);
+
 	/* XXX Choose appropriate parameters */
 	uint32_t fmt;
 	/* 48 kHz, 16-bits, 1 channel */
@@ -306,6 +312,12 @@ static errno_t hda_start_capture(ddf_fun_t *fun, unsigned frames, unsigned chann
 		return EBUSY;
 	}
 
+	/* Interrupt after every period worth of frames */
+	rc = hda_stream_buffers_split(hda->pcm_buffers,
+	    frames * pcm_sample_format_frame_size(channels, format));
+	if (rc != EOK)
+		ddf_msg(LVL_WARN, "Cannot use a period of %u frames", frames);
+
 	/* XXX Choose appropriate parameters */
 	uint32_t fmt;
 	/* 48 kHz, 16-bits, 1 channel */
@@ -48,14 +48,18 @@
 #include "spec/bdl.h"
 #include "stream.h"
 
+enum {
+	/** Maximum number of BDL entries (periods) per cyclic buffer */
+	bdl_entries_max = 64
+};
+
 errno_t hda_stream_buffers_alloc(hda_t *hda, hda_stream_buffers_t **rbufs)
 {
 	void *bdl;
 	void *buffer;
 	uintptr_t buffer_phys;
 	hda_stream_buffers_t *bufs = NULL;
-	size_t i;
-	//size_t j, k;
+	//size_t i, j, k;
 	errno_t rc;
 
 	bufs = calloc(1, sizeof(hda_stream_buffers_t));
@@ -72,7 +76,7 @@ errno_t hda_stream_buffers_alloc(hda_t *hda, hda_stream_buffers_t **rbufs)
 	 * it must be within the 32-bit address space.
 	 */
 	bdl = AS_AREA_ANY;
-	rc = dmamem_map_anonymous(bufs->nbuffers * sizeof(hda_buffer_desc_t),
+	rc = dmamem_map_anonymous(bdl_entries_max * sizeof(hda_buffer_desc_t),
 	    hda->ctl->ok64bit ? 0 : DMAMEM_4GiB, AS_AREA_READ | AS_AREA_WRITE,
 	    0, &bufs->bdl_phys, &bdl);
 	if (rc != EOK)
@@ -82,11 +86,11 @@ errno_t hda_stream_buffers_alloc(hda_t *hda, hda_stream_buffers_t **rbufs)
 
 	/* Allocate arrays of buffer pointers */
 
-	bufs->buf = calloc(bufs->nbuffers, sizeof(void *));
+	bufs->buf = calloc(bdl_entries_max, sizeof(void *));
 	if (bufs->buf == NULL)
 		goto error;
 
-	bufs->buf_phys = calloc(bufs->nbuffers, sizeof(uintptr_t));
+	bufs->buf_phys = calloc(bdl_entries_max, sizeof(uintptr_t));
 	if (bufs->buf_phys == NULL)
 		goto error;
 
@@ -126,13 +130,51 @@ errno_t hda_stream_buffers_alloc(hda_t *hda, hda_stream_buffers_t **rbufs)
 		goto error;
 	}
 
+	bufs->buf_base = buffer;
+	bufs->buf_base_phys = buffer_phys;
+
+	/* Fill in buffer pointers and BDL with the default split */
+	rc = hda_stream_buffers_split(bufs, bufs->bufsize);
+	if (rc != EOK)
+		goto error;
+
+	*rbufs = bufs;
+	return EOK;
+error:
+	hda_stream_buffers_free(bufs);
+	return ENOMEM;
+}
+
+/** Split the cyclic buffer into period-sized BDL entries.
+ *
+ * Interrupt on completion is requested for every entry, so the period
+ * determines both the interrupt rate and the achievable latency.
+ *
+ * @param bufs Stream buffers
+ * @param period Size of one entry in bytes
+ *
+ * @return EOK on success, EINVAL if the period does not evenly divide
+ *         the buffer or would need more than @c bdl_entries_max entries.
+ */
+errno_t hda_stream_buffers_split(hda_stream_buffers_t *bufs, size_t period)
+{
+	size_t total;
+	size_t i;
+
+	total = bufs->nbuffers * bufs->bufsize;
+	if (period == 0 || (period % 128) != 0 || (total % period) != 0 ||
+	    total / period > bdl_entries_max)
+		return EINVAL;
+
+	bufs->nbuffers = total / period;
+	bufs->bufsize = period;
+
 	for (i = 0; i < bufs->nbuffers; i++) {
-		bufs->buf[i] = buffer + i * bufs->bufsize;
-		bufs->buf_phys[i] = buffer_phys + i * bufs->bufsize;
+		bufs->buf[i] = bufs->buf_base + i * bufs->bufsize;
+		bufs->buf_phys[i] = bufs->buf_base_phys + i * bufs->bufsize;
 
 		ddf_msg(LVL_DEBUG, "Stream buf phys=0x%llx virt=%p",
-		    (long long unsigned)(uintptr_t)bufs->buf[i],
-		    (void *)bufs->buf_phys[i]);
+		    (long long unsigned)bufs->buf_phys[i], bufs->buf[i]);
 	}
 
 	/* Fill in BDL */
@@ -142,11 +184,7 @@ errno_t hda_stream_buffers_alloc(hda_t *hda, hda_stream_buffers_t **rbufs)
 		bufs->bdl[i].flags = BIT_V(uint32_t, bdf_ioc);
 	}
 
-	*rbufs = bufs;
 	return EOK;
-error:
-	hda_stream_buffers_free(bufs);
-	return ENOMEM;
 }
 
 void hda_stream_buffers_free(hda_stream_buffers_t *bufs)
@@ -31,6 +31,7 @@
  */
 
 #include <as.h>
+#include <byteorder.h>
 #include <errno.h>
 #include <stdio.h>
 #include <ddf/interrupt.h>
@@ -51,6 +52,9 @@
 #define HI(ptr) \
 	((uint32_t) (((uint64_t) ((uintptr_t) (ptr))) >> 32))
 
+/** Maximum number of blocks transferred by a single FPDMA command. */
+#define AHCI_RW_BLOCKS_MAX  256
+
 /** Interrupt pseudocode for a single port
  *
  * The interrupt handling works as follows:
@@ -59,11 +63,13 @@
  *    (stored as arg2).
  * 2. If port interrupt is indicated, then:
  *    3. Port interrupt status register is cleared.
- *    4. Global interrupt status register is read
+ *    4. Port SATA active register is read
+ *       (stored as arg3).
+ *    5. Global interrupt status register is read
  *       and cleared (any potential interrupts from
  *       other ports are reasserted automatically).
- *    5. Port number is stored as arg1.
- *    6. The interrupt is accepted.
+ *    6. Port number is stored as arg1.
+ *    7. The interrupt is accepted.
  *
  */
 #define AHCI_PORT_CMDS(port) \
@@ -76,7 +82,7 @@
 	{ \
 		/* Check if port asserted interrupt */ \
 		.cmd = CMD_PREDICATE, \
-		.value = 5, \
+		.value = 6, \
 		.srcarg = 2, \
 	}, \
 	{ \
@@ -85,6 +91,12 @@
 		.addr = NULL, \
 		.srcarg = 2 \
 	}, \
+	{ \
+		/* Read port SATA active register */ \
+		.cmd = CMD_PIO_READ_32, \
+		.addr = NULL, \
+		.dstarg = 3 \
+	}, \
 	{ \
 		/* Read global interrupt status register */ \
 		.cmd = CMD_PIO_READ_32, \
@@ -113,11 +125,15 @@ static errno_t get_num_blocks(ddf_fun_t *, uint64_t *);
 static errno_t get_block_size(ddf_fun_t *, size_t *);
 static errno_t read_blocks(ddf_fun_t *, uint64_t, size_t, void *);
 static errno_t write_blocks(ddf_fun_t *, uint64_t, size_t, void *);
+static errno_t read_blocks_dma(ddf_fun_t *, uint64_t, size_t, uintptr_t);
+static errno_t write_blocks_dma(ddf_fun_t *, uint64_t, size_t, uintptr_t);
+static errno_t discard_blocks(ddf_fun_t *, uint64_t, size_t);
 
 static errno_t ahci_identify_device(sata_dev_t *);
 static errno_t ahci_set_highest_ultra_dma_mode(sata_dev_t *);
-static errno_t ahci_rb_fpdma(sata_dev_t *, uintptr_t, uint64_t);
-static errno_t ahci_wb_fpdma(sata_dev_t *, uintptr_t, uint64_t);
+static errno_t ahci_rb_fpdma(sata_dev_t *, uintptr_t, uint64_t, uint16_t);
+static errno_t ahci_wb_fpdma(sata_dev_t *, uintptr_t, uint64_t, uint16_t);
+static errno_t ahci_dsm_trim(sata_dev_t *, uintptr_t);
 
 static void ahci_sata_devices_create(ahci_dev_t *, ddf_dev_t *);
 static ahci_dev_t *ahci_ahci_create(ddf_dev_t *);
@@ -139,7 +155,10 @@ static ahci_iface_t ahci_interface = {
 	.get_num_blocks = &get_num_blocks,
 	.get_block_size = &get_block_size,
 	.read_blocks = &read_blocks,
-	.write_blocks = &write_blocks
+	.write_blocks = &write_blocks,
+	.read_blocks_dma = &read_blocks_dma,
+	.write_blocks_dma = &write_blocks_dma,
+	.discard_blocks = &discard_blocks
 };
 
 static ddf_dev_ops_t ahci_ops = {
@@ -229,29 +248,35 @@ static errno_t read_blocks(ddf_fun_t *fun, uint64_t blocknum,
 {
 	sata_dev_t *sata = fun_sata_dev(fun);
 
+	if (count == 0)
+		return EOK;
+
+	size_t chunk = (count < AHCI_RW_BLOCKS_MAX) ? count : AHCI_RW_BLOCKS_MAX;
+
 	uintptr_t phys;
 	void *ibuf = AS_AREA_ANY;
-	errno_t rc = dmamem_map_anonymous(sata->block_size, DMAMEM_4GiB,
+	errno_t rc = dmamem_map_anonymous(sata->block_size * chunk, DMAMEM_4GiB,
 	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &ibuf);
 	if (rc != EOK) {
 		ddf_msg(LVL_ERROR, "Cannot allocate read buffer.");
 		return rc;
 	}
 
-	memset(buf, 0, sata->block_size);
+	memset(buf, 0, sata->block_size * count);
 
-	fibril_mutex_lock(&sata->lock);
+	for (size_t cur = 0; cur < count; cur += chunk) {
+		size_t now = count - cur;
+		if (now > chunk)
+			now = chunk;
 
-	for (size_t cur = 0; cur < count; cur++) {
-		rc = ahci_rb_fpdma(sata, phys, blocknum + cur);
+		rc = ahci_rb_fpdma(sata, phys, blocknum + cur, now);
 		if (rc != EOK)
 			break;
 
 		memcpy((void *) (((uint8_t *) buf) + (sata->block_size * cur)),
-		    ibuf, sata->block_size);
+		    ibuf, sata->block_size * now);
 	}
 
-	fibril_mutex_unlock(&sata->lock);
 	dmamem_unmap_anonymous(ibuf);
 
 	return rc;
@@ -272,31 +297,163 @@ static errno_t write_blocks(ddf_fun_t *fun, uint64_t blocknum,
 {
 	sata_dev_t *sata = fun_sata_dev(fun);
 
+	if (count == 0)
+		return EOK;
+
+	size_t chunk = (count < AHCI_RW_BLOCKS_MAX) ? count : AHCI_RW_BLOCKS_MAX;
+
 	uintptr_t phys;
 	void *ibuf = AS_AREA_ANY;
-	errno_t rc = dmamem_map_anonymous(sata->block_size, DMAMEM_4GiB,
+	errno_t rc = dmamem_map_anonymous(sata->block_size * chunk, DMAMEM_4GiB,
 	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &ibuf);
 	if (rc != EOK) {
 		ddf_msg(LVL_ERROR, "Cannot allocate write buffer.");
 		return rc;
 	}
 
-	fibril_mutex_lock(&sata->lock);
+	for (size_t cur = 0; cur < count; cur += chunk) {
+		size_t now = count - cur;
+		if (now > chunk)
+			now = chunk;
 
-	for (size_t cur = 0; cur < count; cur++) {
 		memcpy(ibuf, (void *) (((uint8_t *) buf) + (sata->block_size * cur)),
-		    sata->block_size);
-		rc = ahci_wb_fpdma(sata, phys, blocknum + cur);
+		    sata->block_size * now);
+		rc = ahci_wb_fpdma(sata, phys, blocknum + cur, now);
 		if (rc != EOK)
 			break;
 	}
 
-	fibril_mutex_unlock(&sata->lock);
 	dmamem_unmap_anonymous(ibuf);
 
 	return rc;
 }
 
+/** Read data blocks directly into a physically contiguous buffer.
+ *
+ * The device transfers the data by DMA straight to the caller's buffer,
+ * without any intermediate copy. The buffer must be physically contiguous
+ * and located below 4 GiB.
+ *
+ * @param fun      Device function handling the call.
+ * @param blocknum Number of first block.
+ * @param count    Number of blocks to read.
+ * @param phys     Physical address of the buffer.
+ *
+ * @return EOK if succeed, error code otherwise
+ *
+ */
+static errno_t read_blocks_dma(ddf_fun_t *fun, uint64_t blocknum,
+    size_t count, uintptr_t phys)
+{
+	sata_dev_t *sata = fun_sata_dev(fun);
+	errno_t rc = EOK;
+
+	for (size_t cur = 0; cur < count; cur += AHCI_RW_BLOCKS_MAX) {
+		size_t now = count - cur;
+		if (now > AHCI_RW_BLOCKS_MAX)
+			now = AHCI_RW_BLOCKS_MAX;
+
+		rc = ahci_rb_fpdma(sata, phys + sata->block_size * cur,
+		    blocknum + cur, now);
+		if (rc != EOK)
+			break;
+	}
+
+	return rc;
+}
+
+/** Write data blocks directly from a physically contiguous buffer.
+ *
+ * The device transfers the data by DMA straight from the caller's buffer,
+ * without any intermediate copy. The buffer must be physically contiguous
+ * and located below 4 GiB.
+ *
+ * @param fun      Device function handling the call.
+ * @param blocknum Number of first block.
+ * @param count    Number of blocks to write.
+ * @param phys     Physical address of the buffer.
+ *
+ * @return EOK if succeed, error code otherwise
+ *
+ */
+static errno_t write_blocks_dma(ddf_fun_t *fun, uint64_t blocknum,
+    size_t count, uintptr_t phys)
+{
+	sata_dev_t *sata = fun_sata_dev(fun);
+	errno_t rc = EOK;
+
+	for (size_t cur = 0; cur < count; cur += AHCI_RW_BLOCKS_MAX) {
+		size_t now = count - cur;
+		if (now > AHCI_RW_BLOCKS_MAX)
+			now = AHCI_RW_BLOCKS_MAX;
+
+		rc = ahci_wb_fpdma(sata, phys + sata->block_size * cur,
+		    blocknum + cur, now);
+		if (rc != EOK)
+			break;
+	}
+
+	return rc;
+}
+
+/** Discard (trim) data blocks whose contents are no longer needed.
+ *
+ * The blocks are unmapped by the DATA SET MANAGEMENT command with the
+ * TRIM bit set. The device may return arbitrary data for subsequent
+ * reads of discarded blocks.
+ *
+ * @param fun      Device function handling the call.
+ * @param blocknum Number of first block.
+ * @param count    Number of blocks to discard.
+ *
+ * @return EOK if succeed, ENOTSUP if the device cannot discard blocks,
+ *         error code otherwise
+ *
+ */
+static errno_t discard_blocks(ddf_fun_t *fun, uint64_t blocknum, size_t count)
+{
+	sata_dev_t *sata = fun_sata_dev(fun);
+
+	if (!sata->dsm_trim)
+		return ENOTSUP;
+
+	if (count == 0)
+		return EOK;
+
+	uintptr_t phys;
+	uint64_t *ranges = AS_AREA_ANY;
+	errno_t rc = dmamem_map_anonymous(SATA_DSM_BUFFER_LENGTH, DMAMEM_4GiB,
+	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, (void *) &ranges);
+	if (rc != EOK) {
+		ddf_msg(LVL_ERROR, "Cannot allocate buffer for discard.");
+		return rc;
+	}
+
+	while ((count > 0) && (rc == EOK)) {
+		memset(ranges, 0, SATA_DSM_BUFFER_LENGTH);
+
+		/* Cover the range by up to 64 LBA range entries. */
+		unsigned int entry = 0;
+		while ((count > 0) && (entry < SATA_DSM_RANGES_PER_BLOCK)) {
+			uint64_t now = count;
+			if (now > SATA_DSM_MAX_RANGE_SECTORS)
+				now = SATA_DSM_MAX_RANGE_SECTORS;
+
+			ranges[entry++] = host2uint64_t_le(
+			    (blocknum & 0xffffffffffffULL) | (now << 48));
+
+			blocknum += now;
+			count -= now;
+		}
+
+		rc = ahci_dsm_trim(sata, phys);
+	}
+
+	dmamem_unmap_anonymous(ranges);
+
+	return rc;
+}
+
 /*
  * AHCI Commands
  */
@@ -478,6 +635,11 @@ static errno_t ahci_identify_device(sata_dev_t *sata)
 		goto error;
 	}
 
+	/* Limit the number of usable command slots by the device queue depth. */
+	unsigned int queue_depth = (idata->queue_depth & 0x001f) + 1;
+	if (queue_depth < sata->nslots)
+		sata->nslots = queue_depth;
+
 	uint16_t logsec = idata->physical_logic_sector_size;
 	if ((logsec & 0xc000) == 0x4000) {
 		/* Length of sector may be larger than 512 B */
@@ -539,6 +701,10 @@ static errno_t ahci_identify_device(sata_dev_t *sata)
 		}
 	}
 
+	/* Support for discarding blocks by DATA SET MANAGEMENT TRIM. */
+	sata->dsm_trim = (!sata->is_packet_device) &&
+	    ((idata->data_set_mgmt & sata_dsm_trim) != 0);
+
 	fibril_mutex_unlock(&sata->lock);
 	dmamem_unmap_anonymous(idata);
 
@@ -668,23 +834,102 @@ error:
 	return EINTR;
 }
 
-/** Set AHCI registers for reading one sector from the SATA device using FPDMA.
+/** Get command table of the given command slot.
+ *
+ * @param sata SATA device structure.
+ * @param slot Command slot number.
+ *
+ * @return Pointer to the command table of the slot.
+ *
+ */
+static volatile uint32_t *ahci_cmd_table_get(sata_dev_t *sata,
+    unsigned int slot)
+{
+	return (volatile uint32_t *) (((volatile uint8_t *) sata->cmd_table) +
+	    slot * AHCI_CMD_TABLE_SIZE);
+}
+
+/** Allocate a free command slot, waiting for one if all are occupied.
+ *
+ * @param sata SATA device structure.
+ *
+ * @return Number of the allocated command slot.
+ *
+ */
+static unsigned int ahci_slot_acquire(sata_dev_t *sata)
+{
+	fibril_mutex_lock(&sata->slot_lock);
+
+	while (true) {
+		for (unsigned int slot = 0; slot < sata->nslots; slot++) {
+			uint32_t mask = 1 << slot;
+			if ((sata->slots_busy & mask) == 0) {
+				sata->slots_busy |= mask;
+				fibril_mutex_unlock(&sata->slot_lock);
+				return slot;
+			}
+		}
+
+		fibril_condvar_wait(&sata->slot_condvar, &sata->slot_lock);
+	}
+}
+
+/** Issue the command prepared in a slot and wait for its completion.
+ *
+ * The slot is released before returning.
+ *
+ * @param sata SATA device structure.
+ * @param slot Command slot with the prepared command.
+ *
+ * @return EOK if succeed, error code otherwise
+ *
+ */
+static errno_t ahci_slot_execute(sata_dev_t *sata, unsigned int slot)
+{
+	uint32_t mask = 1 << slot;
+
+	fibril_mutex_lock(&sata->slot_lock);
+
+	sata->slots_issued |= mask;
+	sata->port->pxsact |= mask;
+	sata->port->pxci |= mask;
+
+	while ((sata->slots_done & mask) == 0)
+		fibril_condvar_wait(&sata->slot_condvar, &sata->slot_lock);
+
+	errno_t rc = (sata->slots_failed & mask) ? EINTR : EOK;
+
+	sata->slots_done &= ~mask;
+	sata->slots_failed &= ~mask;
+	sata->slots_busy &= ~mask;
+	fibril_condvar_broadcast(&sata->slot_condvar);
+
+	fibril_mutex_unlock(&sata->slot_lock);
+
+	return rc;
+}
+
+/** Set AHCI registers for reading sectors from the SATA device using FPDMA.
  *
  * @param sata     SATA device structure.
+ * @param slot     Command slot to prepare the command in.
  * @param phys     Physical address of buffer for sector data.
- * @param blocknum Block number to read.
+ * @param blocknum Number of first block to read.
+ * @param count    Number of blocks to read.
  *
  */
-static void ahci_rb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
-    uint64_t blocknum)
+static void ahci_rb_fpdma_cmd(sata_dev_t *sata, unsigned int slot,
+    uintptr_t phys, uint64_t blocknum, uint16_t count)
 {
+	volatile uint32_t *cmd_table = ahci_cmd_table_get(sata, slot);
 	volatile sata_ncq_command_frame_t *cmd =
-	    (sata_ncq_command_frame_t *) sata->cmd_table;
+	    (sata_ncq_command_frame_t *) cmd_table;
 
 	cmd->fis_type = SATA_CMD_FIS_TYPE;
 	cmd->c = SATA_CMD_FIS_COMMAND_INDICATOR;
 	cmd->command = 0x60;
-	cmd->tag = 0;
+	cmd->tag = slot << 3;
+	cmd->fua = 0;
 	cmd->control = 0;
 
 	cmd->reserved1 = 0;
@@ -694,8 +939,8 @@ static void ahci_rb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
 	cmd->reserved5 = 0;
 	cmd->reserved6 = 0;
 
-	cmd->sector_count_low = 1;
-	cmd->sector_count_high = 0;
+	cmd->sector_count_low = count & 0xff;
+	cmd->sector_count_high = (count >> 8) & 0xff;
 
 	cmd->lba0 = blocknum & 0xff;
 	cmd->lba1 = (blocknum >> 8) & 0xff;
@@ -705,35 +950,34 @@ static void ahci_rb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
 	cmd->lba5 = (blocknum >> 40) & 0xff;
 
 	volatile ahci_cmd_prdt_t *prdt =
-	    (ahci_cmd_prdt_t *) (&sata->cmd_table[0x20]);
+	    (ahci_cmd_prdt_t *) (&cmd_table[0x20]);
 
 	prdt->data_address_low = LO(phys);
 	prdt->data_address_upper = HI(phys);
 	prdt->reserved1 = 0;
-	prdt->dbc = sata->block_size - 1;
+	prdt->dbc = (sata->block_size * count) - 1;
 	prdt->reserved2 = 0;
 	prdt->ioc = 0;
 
-	sata->cmd_header->prdtl = 1;
-	sata->cmd_header->flags =
+	sata->cmd_header[slot].prdtl = 1;
+	sata->cmd_header[slot].flags =
 	    AHCI_CMDHDR_FLAGS_CLEAR_BUSY_UPON_OK |
 	    AHCI_CMDHDR_FLAGS_5DWCMD;
-	sata->cmd_header->bytesprocessed = 0;
-
-	sata->port->pxsact |= 1;
-	sata->port->pxci |= 1;
+	sata->cmd_header[slot].bytesprocessed = 0;
 }
 
-/** Read one sector from the SATA device using FPDMA.
+/** Read sectors from the SATA device using FPDMA.
  *
  * @param sata     SATA device structure.
  * @param phys     Physical address of buffer for sector data.
- * @param blocknum Block number to read.
+ * @param blocknum Number of first block to read.
+ * @param count    Number of blocks to read.
  *
  * @return EOK if succeed, error code otherwise
  *
  */
-static errno_t ahci_rb_fpdma(sata_dev_t *sata, uintptr_t phys, uint64_t blocknum)
+static errno_t ahci_rb_fpdma(sata_dev_t *sata, uintptr_t phys,
+    uint64_t blocknum, uint16_t count)
 {
 	if (sata->is_invalid_device) {
 		ddf_msg(LVL_ERROR,
@@ -741,37 +985,39 @@ static errno_t ahci_rb_fpdma(sata_dev_t *sata, uintptr_t phys, uint64_t blocknum
 		return EINTR;
 	}
 
-	ahci_rb_fpdma_cmd(sata, phys, blocknum);
-	ahci_port_is_t pxis = ahci_wait_event(sata);
+	unsigned int slot = ahci_slot_acquire(sata);
+	ahci_rb_fpdma_cmd(sata, slot, phys, blocknum, count);
+	errno_t rc = ahci_slot_execute(sata, slot);
 
-	if ((sata->is_invalid_device) || (ahci_port_is_error(pxis))) {
+	if (rc != EOK) {
 		ddf_msg(LVL_ERROR,
 		    "%s: Unrecoverable error during FPDMA read", sata->model);
-		return EINTR;
 	}
 
-	return EOK;
+	return rc;
 }
 
-/** Set AHCI registers for writing one sector to the SATA device, use FPDMA.
+/** Set AHCI registers for writing sectors to the SATA device, use FPDMA.
  *
  * @param sata     SATA device structure.
+ * @param slot     Command slot to prepare the command in.
  * @param phys     Physical address of buffer with sector data.
- * @param blocknum Block number to write.
- *
- * @return EOK if succeed, error code otherwise
+ * @param blocknum Number of first block to write.
+ * @param count    Number of blocks to write.
  *
  */
-static void ahci_wb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
-    uint64_t blocknum)
+static void ahci_wb_fpdma_cmd(sata_dev_t *sata, unsigned int slot,
+    uintptr_t phys, uint64_t blocknum, uint16_t count)
 {
+	volatile uint32_t *cmd_table = ahci_cmd_table_get(sata, slot);
 	volatile sata_ncq_command_frame_t *cmd =
-	    (sata_ncq_command_frame_t *) sata->cmd_table;
+	    (sata_ncq_command_frame_t *) cmd_table;
 
 	cmd->fis_type = SATA_CMD_FIS_TYPE;
 	cmd->c = SATA_CMD_FIS_COMMAND_INDICATOR;
 	cmd->command = 0x61;
-	cmd->tag = 0;
+	cmd->tag = slot << 3;
+	cmd->fua = 0;
 	cmd->control = 0;
 
 	cmd->reserved1 = 0;
@@ -781,8 +1027,8 @@ static void ahci_wb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
 	cmd->reserved5 = 0;
 	cmd->reserved6 = 0;
 
-	cmd->sector_count_low = 1;
-	cmd->sector_count_high = 0;
+	cmd->sector_count_low = count & 0xff;
+	cmd->sector_count_high = (count >> 8) & 0xff;
 
 	cmd->lba0 = blocknum & 0xff;
 	cmd->lba1 = (blocknum >> 8) & 0xff;
@@ -791,13 +1037,86 @@ static void ahci_wb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
 	cmd->lba4 = (blocknum >> 32) & 0xff;
 	cmd->lba5 = (blocknum >> 40) & 0xff;
 
+	volatile ahci_cmd_prdt_t *prdt =
+	    (ahci_cmd_prdt_t *) (&cmd_table[0x20]);
+
+	prdt->data_address_low = LO(phys);
+	prdt->data_address_upper = HI(phys);
+	prdt->reserved1 = 0;
+	prdt->dbc = (sata->block_size * count) - 1;
+	prdt->reserved2 = 0;
+	prdt->ioc = 0;
+
+	sata->cmd_header[slot].prdtl = 1;
+	sata->cmd_header[slot].flags =
+	    AHCI_CMDHDR_FLAGS_CLEAR_BUSY_UPON_OK |
+	    AHCI_CMDHDR_FLAGS_WRITE |
+	    AHCI_CMDHDR_FLAGS_5DWCMD;
+	sata->cmd_header[slot].bytesprocessed = 0;
+}
+
+/** Write sectors into the SATA device, use FPDMA.
+ *
+ * @param sata     SATA device structure.
+ * @param phys     Physical address of buffer with sector data.
+ * @param blocknum Number of first block to write.
+ * @param count    Number of blocks to write.
+ *
+ * @return EOK if succeed, error code otherwise
+ *
+ */
+static errno_t ahci_wb_fpdma(sata_dev_t *sata, uintptr_t phys,
+    uint64_t blocknum, uint16_t count)
+{
+	if (sata->is_invalid_device) {
+		ddf_msg(LVL_ERROR,
+		    "%s: FPDMA write to invalid device", sata->model);
+		return EINTR;
+	}
+
+	unsigned int slot = ahci_slot_acquire(sata);
+	ahci_wb_fpdma_cmd(sata, slot, phys, blocknum, count);
+	errno_t rc = ahci_slot_execute(sata, slot);
+
+	if (rc != EOK) {
+		ddf_msg(LVL_ERROR,
+		    "%s: Unrecoverable error during FPDMA write", sata->model);
+	}
+
+	return rc;
+}
+
+/** Set AHCI registers for discarding blocks by DATA SET MANAGEMENT TRIM.
+ *
+ * @param sata SATA device structure.
+ * @param phys Physical address of one payload block with LBA range entries.
+ *
+ */
+static void ahci_dsm_trim_cmd(sata_dev_t *sata, uintptr_t phys)
+{
+	volatile sata_std_command_frame_t *cmd =
+	    (sata_std_command_frame_t *) sata->cmd_table;
+
+	cmd->fis_type = SATA_CMD_FIS_TYPE;
+	cmd->c = SATA_CMD_FIS_COMMAND_INDICATOR;
+	cmd->command = 0x06;
+	cmd->features = 0x01;
+	cmd->lba_lower = 0;
+	cmd->device = 0x40;
+	cmd->lba_upper = 0;
+	cmd->features_upper = 0;
+	cmd->count = 1;
+	cmd->reserved1 = 0;
+	cmd->control = 0;
+	cmd->reserved2 = 0;
+
 	volatile ahci_cmd_prdt_t *prdt =
 	    (ahci_cmd_prdt_t *) (&sata->cmd_table[0x20]);
 
 	prdt->data_address_low = LO(phys);
 	prdt->data_address_upper = HI(phys);
 	prdt->reserved1 = 0;
-	prdt->dbc = sata->block_size - 1;
+	prdt->dbc = SATA_DSM_BUFFER_LENGTH - 1;
 	prdt->reserved2 = 0;
 	prdt->ioc = 0;
 
@@ -805,40 +1124,62 @@ static void ahci_wb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
 	sata->cmd_header->flags =
 	    AHCI_CMDHDR_FLAGS_CLEAR_BUSY_UPON_OK |
 	    AHCI_CMDHDR_FLAGS_WRITE |
-	    AHCI_CMDHDR_FLAGS_5DWCMD;
+	    AHCI_CMDHDR_FLAGS_2DWCMD;
 	sata->cmd_header->bytesprocessed = 0;
 
+	/* Run command. */
 	sata->port->pxsact |= 1;
 	sata->port->pxci |= 1;
 }
 
-/** Write one sector into the SATA device, use FPDMA.
+/** Discard blocks by the DATA SET MANAGEMENT TRIM command.
  *
- * @param sata     SATA device structure.
- * @param phys     Physical address of buffer with sector data.
- * @param blocknum Block number to write.
+ * @param sata SATA device structure.
+ * @param phys Physical address of one payload block with LBA range entries.
  *
  * @return EOK if succeed, error code otherwise
  *
  */
-static errno_t ahci_wb_fpdma(sata_dev_t *sata, uintptr_t phys, uint64_t blocknum)
+static errno_t ahci_dsm_trim(sata_dev_t *sata, uintptr_t phys)
 {
 	if (sata->is_invalid_device) {
 		ddf_msg(LVL_ERROR,
-		    "%s: FPDMA write to invalid device", sata->model);
+		    "%s: Discarding blocks on invalid device", sata->model);
 		return EINTR;
 	}
 
-	ahci_wb_fpdma_cmd(sata, phys, blocknum);
+	/*
+	 * DATA SET MANAGEMENT is not an NCQ command. Wait until all queued
+	 * commands finish and keep the command slots reserved so that no
+	 * NCQ command is outstanding while it runs.
+	 */
+	fibril_mutex_lock(&sata->slot_lock);
+	while (sata->slots_busy != 0)
+		fibril_condvar_wait(&sata->slot_condvar, &sata->slot_lock);
+	sata->slots_busy = ~((uint32_t) 0);
+	fibril_mutex_unlock(&sata->slot_lock);
+
+	fibril_mutex_lock(&sata->lock);
+
+	ahci_dsm_trim_cmd(sata, phys);
 	ahci_port_is_t pxis = ahci_wait_event(sata);
 
+	errno_t rc = EOK;
 	if ((sata->is_invalid_device) || (ahci_port_is_error(pxis))) {
 		ddf_msg(LVL_ERROR,
-		    "%s: Unrecoverable error during FPDMA write", sata->model);
-		return EINTR;
+		    "%s: Error during DATA SET MANAGEMENT TRIM", sata->model);
+		rc = EIO;
 	}
 
-	return EOK;
+	fibril_mutex_unlock(&sata->lock);
+
+	/* Make the command slots available again. */
+	fibril_mutex_lock(&sata->slot_lock);
+	sata->slots_busy = 0;
+	fibril_condvar_broadcast(&sata->slot_condvar);
+	fibril_mutex_unlock(&sata->slot_lock);
+
+	return rc;
 }
 
 /*
@@ -898,6 +1239,7 @@ static void ahci_interrupt(ipc_call_t *icall, ddf_dev_t *dev)
 	ahci_dev_t *ahci = dev_ahci_dev(dev);
 	unsigned int port = ipc_get_arg1(icall);
 	ahci_port_is_t pxis = ipc_get_arg2(icall);
+	uint32_t pxsact = ipc_get_arg3(icall);
 
 	if (port >= AHCI_MAX_PORTS)
 		return;
@@ -906,6 +1248,30 @@ static void ahci_interrupt(ipc_call_t *icall, ddf_dev_t *dev)
 	if (sata == NULL)
 		return;
 
+	/* Demultiplex completed queued commands to their slots */
+	fibril_mutex_lock(&sata->slot_lock);
+
+	uint32_t done = sata->slots_issued & ~pxsact;
+	if (ahci_port_is_error(pxis)) {
+		/*
+		 * The error cannot be attributed to a single command,
+		 * fail all outstanding commands.
+		 */
+		done = sata->slots_issued;
+		sata->slots_failed |= done;
+
+		if (ahci_port_is_permanent_error(pxis))
+			sata->is_invalid_device = true;
+	}
+
+	if (done != 0) {
+		sata->slots_issued &= ~done;
+		sata->slots_done |= done;
+		fibril_condvar_broadcast(&sata->slot_condvar);
+	}
+
+	fibril_mutex_unlock(&sata->slot_lock);
+
 	/* Evaluate port event */
 	if ((ahci_port_is_end_of_operation(pxis)) ||
 	    (ahci_port_is_error(pxis))) {
@@ -947,6 +1313,11 @@ static sata_dev_t *ahci_sata_allocate(ahci_dev_t *ahci, volatile ahci_port_t *po
 	sata->fun = fun;
 	sata->port = port;
 
+	/* Number of command slots implemented by the HBA. */
+	ahci_ghc_cap_t cap;
+	cap.u32 = ahci->memregs->ghc.cap;
+	sata->nslots = cap.ncs + 1;
+
 	/* Allocate and init retfis structure. */
 	errno_t rc = dmamem_map_anonymous(size, DMAMEM_4GiB,
 	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &virt_fb);
@@ -957,7 +1328,7 @@ static sata_dev_t *ahci_sata_allocate(ahci_dev_t *ahci, volatile ahci_port_t *po
 	sata->port->pxfbu = HI(phys);
 	sata->port->pxfb = LO(phys);
 
-	/* Allocate and init command header structure. */
+	/* Allocate and init command list structure. */
 	rc = dmamem_map_anonymous(size, DMAMEM_4GiB,
 	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &virt_cmd);
 	if (rc != EOK)
@@ -968,17 +1339,23 @@ static sata_dev_t *ahci_sata_allocate(ahci_dev_t *ahci, volatile ahci_port_t *po
 	sata->port->pxclb = LO(phys);
 	sata->cmd_header = (ahci_cmdhdr_t *) virt_cmd;
 
-	/* Allocate and init command table structure. */
-	rc = dmamem_map_anonymous(size, DMAMEM_4GiB,
+	/* Allocate and init command tables, one for each command slot. */
+	size_t table_size = AHCI_MAX_SLOTS * AHCI_CMD_TABLE_SIZE;
+	rc = dmamem_map_anonymous(table_size, DMAMEM_4GiB,
 	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &virt_table);
 	if (rc != EOK)
 		goto error_table;
 
-	memset(virt_table, 0, size);
-	sata->cmd_header->cmdtableu = HI(phys);
-	sata->cmd_header->cmdtable = LO(phys);
+	memset(virt_table, 0, table_size);
 	sata->cmd_table = (uint32_t *) virt_table;
 
+	for (unsigned int slot = 0; slot < AHCI_MAX_SLOTS; slot++) {
+		uintptr_t table_phys = phys + slot * AHCI_CMD_TABLE_SIZE;
+
+		sata->cmd_header[slot].cmdtableu = HI(table_phys);
+		sata->cmd_header[slot].cmdtable = LO(table_phys);
+	}
+
 	return sata;
 
 error_table:
@@ -1056,6 +1433,8 @@ static errno_t ahci_sata_create(ahci_dev_t *ahci, ddf_dev_t *dev,
 	fibril_mutex_initialize(&sata->lock);
 	fibril_mutex_initialize(&sata->event_lock);
 	fibril_condvar_initialize(&sata->event_condvar);
+	fibril_mutex_initialize(&sata->slot_lock);
+	fibril_condvar_initialize(&sata->slot_condvar);
 
 	ahci_sata_hw_start(sata);
 
@@ -1163,7 +1542,7 @@ static ahci_dev_t *ahci_ahci_create(ddf_dev_t *dev)
 	ahci_ranges[0].size = sizeof(ahci_memregs_t);
 
 	for (unsigned int port = 0; port < AHCI_MAX_PORTS; port++) {
-		size_t base = port * 7;
+		size_t base = port * 8;
 
 		ahci_cmds[base].addr =
 		    ((uint32_t *) RNGABSPTR(hw_res_parsed.mem_ranges.ranges[0])) +
@@ -1172,9 +1551,14 @@ static ahci_dev_t *ahci_ahci_create(ddf_dev_t *dev)
 		ahci_cmds[base + 2].addr = ahci_cmds[base].addr;
 
 		ahci_cmds[base + 3].addr =
+		    ((uint32_t *) RNGABSPTR(hw_res_parsed.mem_ranges.ranges[0])) +
+		    AHCI_PORTS_REGISTERS_OFFSET + port * AHCI_PORT_REGISTERS_SIZE +
+		    AHCI_PORT_SACT_REGISTER_OFFSET;
+
+		ahci_cmds[base + 4].addr =
 		    ((uint32_t *) RNGABSPTR(hw_res_parsed.mem_ranges.ranges[0])) +
 		    AHCI_GHC_IS_REGISTER_OFFSET;
-		ahci_cmds[base + 4].addr = ahci_cmds[base + 3].addr;
+		ahci_cmds[base + 5].addr = ahci_cmds[base + 4].addr;
 	}
 
 	irq_code_t ct;
@@ -40,6 +40,9 @@
 #include <stdint.h>
 #include "ahci_hw.h"
 
+/** Size reserved for the command table of a single command slot. */
+#define AHCI_CMD_TABLE_SIZE  256
+
 /** AHCI Device. */
 typedef struct {
 	/** Pointer to ddf device. */
@@ -72,15 +75,36 @@ typedef struct {
 	/** Pointer to SATA port. */
 	volatile ahci_port_t *port;
 
-	/** Pointer to command header. */
+	/** Pointer to command list (one header per command slot). */
 	volatile ahci_cmdhdr_t *cmd_header;
 
-	/** Pointer to command table. */
+	/** Pointer to command table of the first command slot. */
 	volatile uint32_t *cmd_table;
 
 	/** Mutex for single operation on device. */
 	fibril_mutex_t lock;
 
+	/** Mutex protecting the command slot state. */
+	fibril_mutex_t slot_lock;
+
+	/** Signals command slot state changes. */
+	fibril_condvar_t slot_condvar;
+
+	/** Bitmask of command slots allocated to running operations. */
+	uint32_t slots_busy;
+
+	/** Bitmask of command slots with a command issued to hardware. */
+	uint32_t slots_issued;
+
+	/** Bitmask of command slots with a completed command. */
+	uint32_t slots_done;
+
+	/** Bitmask of completed command slots which ended with an error. */
+	uint32_t slots_failed;
+
+	/** Number of usable command slots. */
+	unsigned int nslots;
+
 	/** Mutex for event signaling condition variable. */
 	fibril_mutex_t event_lock;
 
@@ -104,6 +128,9 @@ typedef struct {
 
 	/** Highest UDMA mode supported. */
 	uint8_t highest_udma_mode;
+
+	/** Device supports the DATA SET MANAGEMENT TRIM command. */
+	bool dsm_trim;
 } sata_dev_t;
 
 #endif
@@ -42,6 +42,9 @@
 /** AHCI standard 1.3 - maximum ports. */
 #define AHCI_MAX_PORTS  32
 
+/** AHCI standard 1.3 - maximum command slots per port. */
+#define AHCI_MAX_SLOTS  32
+
 /*
  * AHCI PCI Registers
  */
@@ -389,6 +392,9 @@ typedef uint32_t ahci_ghc_is_t;
 /** AHCI port IS register offset. */
 #define AHCI_PORT_IS_REGISTER_OFFSET  4
 
+/** AHCI port SACT register offset. */
+#define AHCI_PORT_SACT_REGISTER_OFFSET  13
+
 /** AHCI Memory register Ports implemented. */
 typedef struct {
 	/** If a bit is set to 1, the corresponding port
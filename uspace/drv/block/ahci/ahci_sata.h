@@ -48,6 +48,15 @@
 /** Size for indentify (packet) device buffer in bytes. */
 #define SATA_IDENTIFY_DEVICE_BUFFER_LENGTH  512
 
+/** Size for one DATA SET MANAGEMENT payload block in bytes. */
+#define SATA_DSM_BUFFER_LENGTH  512
+
+/** Number of LBA range entries in one DATA SET MANAGEMENT payload block. */
+#define SATA_DSM_RANGES_PER_BLOCK  64
+
+/** Maximum number of sectors covered by one DATA SET MANAGEMENT range entry. */
+#define SATA_DSM_MAX_RANGE_SECTORS  0xffff
+
 /*
  * SATA Fis Frames
  */
@@ -209,12 +218,17 @@ typedef struct {
 	uint16_t total_lba48_2;
 	uint16_t total_lba48_3;
 
-	uint16_t reserved104[1 + 105 - 104];
+	uint16_t reserved104;
+	/* Maximum number of 512-byte DATA SET MANAGEMENT payload blocks. */
+	uint16_t max_dsm_blocks;
 	uint16_t physical_logic_sector_size;
 	/* Note: more fields are defined in ATA/ATAPI-7. */
 	uint16_t reserved107[1 + 127 - 107];
 	uint16_t reserved128[1 + 159 - 128];
-	uint16_t reserved160[1 + 255 - 160];
+	uint16_t reserved160[1 + 168 - 160];
+	/* DATA SET MANAGEMENT command support. */
+	uint16_t data_set_mgmt;
+	uint16_t reserved170[1 + 255 - 170];
 } sata_identify_data_t;
 
 /** Capability bits for register device. */
@@ -225,6 +239,12 @@ enum sata_rd_caps {
 	sata_rd_cap_dma = 0x0100
 };
 
+/** Bits of @c identify_data_t.data_set_mgmt. */
+enum sata_dsm {
+	/** TRIM bit of the DATA SET MANAGEMENT command supported. */
+	sata_dsm_trim = 0x0001
+};
+
 /** Bits of @c identify_data_t.cmd_set1. */
 enum sata_cs1 {
 	/** 48-bit address feature set. */
@@ -48,21 +48,24 @@
 	usb_log_debug2("USB cl08: " format, ##__VA_ARGS__)
 
 /** Send command via bulk-only transport.
+ *
+ * The command block wrapper is tagged with a tag unique to the device
+ * (and automatically compared with the answer).
  *
  * @param mfun		Mass storage function
- * @param tag		Command block wrapper tag (automatically compared
- *			with answer)
  * @param cmd		SCSI command
  *
  * @return		Error code
  */
-errno_t usb_massstor_cmd(usbmast_fun_t *mfun, uint32_t tag, scsi_cmd_t *cmd)
+errno_t usb_massstor_cmd(usbmast_fun_t *mfun, scsi_cmd_t *cmd)
 {
 	errno_t rc;
 
 	if (cmd->data_in && cmd->data_out)
 		return EINVAL;
 
+	const uint32_t tag = mfun->mdev->next_tag++;
+
 	usb_pipe_t *bulk_in_pipe = mfun->mdev->bulk_in_pipe;
 	usb_pipe_t *bulk_out_pipe = mfun->mdev->bulk_out_pipe;
 
@@ -39,7 +39,10 @@
 #include <as.h>
 #include <async.h>
 #include <bd_srv.h>
+#include <fibril.h>
+#include <fibril_synch.h>
 #include <macros.h>
+#include <mem.h>
 #include <usb/dev/driver.h>
 #include <usb/debug.h>
 #include <usb/classes/classes.h>
@@ -54,6 +57,12 @@
 
 #define NAME "usbmast"
 
+/** Size of the bounce buffer for coalescing adjacent transfers */
+#define COALESCE_BUF_SIZE	(128 * 1024)
+
+/** Maximum number of requests serviced by a single SCSI command */
+#define MAX_BATCH_REQS		32
+
 static const usb_endpoint_description_t bulk_in_ep = {
 	.transfer_type = USB_TRANSFER_BULK,
 	.direction = USB_DIRECTION_IN,
@@ -103,6 +112,223 @@ static usbmast_fun_t *bd_srv_usbmast(bd_srv_t *bd)
 	return (usbmast_fun_t *) bd->srvs->sarg;
 }
 
+/** Determine whether a request can join a batch.
+ *
+ * The request must target the same LUN in the same direction as the
+ * head of the batch, continue exactly where the batch so far ends and
+ * keep the combined transfer within the bounce buffer and within the
+ * 16-bit transfer length of Read (10)/Write (10).
+ *
+ * @param head		First request of the batch
+ * @param req		Candidate request
+ * @param total		Number of blocks in the batch so far
+ *
+ * @return		@c true iff @a req can join the batch
+ */
+static bool usbmast_req_mergeable(usbmast_req_t *head, usbmast_req_t *req,
+    size_t total)
+{
+	if (req->mfun != head->mfun || req->op != head->op)
+		return false;
+
+	if (head->op != USBMAST_REQ_READ && head->op != USBMAST_REQ_WRITE)
+		return false;
+
+	if (req->ba != head->ba + total)
+		return false;
+
+	if (total + req->cnt > UINT16_MAX)
+		return false;
+
+	if ((total + req->cnt) * head->mfun->block_size > COALESCE_BUF_SIZE)
+		return false;
+
+	return true;
+}
+
+/** Carry out a batch of coalesced requests with a single SCSI command.
+ *
+ * Batches of more than one request are staged through the bounce
+ * buffer. The requests of the batch cover a contiguous, ascending
+ * range of blocks, so the client buffers simply need to be gathered
+ * into (scattered from) the bounce buffer in batch order.
+ *
+ * @param mdev		Mass storage device
+ * @param batch		Requests to carry out
+ * @param nreqs		Number of requests
+ * @param total		Total number of blocks in the batch
+ *
+ * @return		Error code (common to all requests of the batch)
+ */
+static errno_t usbmast_batch_exec(usbmast_dev_t *mdev, usbmast_req_t **batch,
+    size_t nreqs, size_t total)
+{
+	usbmast_fun_t *mfun = batch[0]->mfun;
+	uint8_t *bp;
+	size_t nbytes;
+	size_t i;
+	errno_t rc;
+
+	switch (batch[0]->op) {
+	case USBMAST_REQ_SYNC:
+		return usbmast_sync_cache(mfun, batch[0]->ba, batch[0]->cnt);
+	case USBMAST_REQ_READ:
+		if (nreqs == 1) {
+			return usbmast_read(mfun, batch[0]->ba, batch[0]->cnt,
+			    batch[0]->buf);
+		}
+
+		rc = usbmast_read(mfun, batch[0]->ba, total,
+		    mdev->coalesce_buf);
+		if (rc != EOK)
+			return rc;
+
+		bp = mdev->coalesce_buf;
+		for (i = 0; i < nreqs; i++) {
+			nbytes = batch[i]->cnt * mfun->block_size;
+			memcpy(batch[i]->buf, bp, nbytes);
+			bp += nbytes;
+		}
+
+		return EOK;
+	case USBMAST_REQ_WRITE:
+		if (nreqs == 1) {
+			return usbmast_write(mfun, batch[0]->ba, batch[0]->cnt,
+			    batch[0]->data);
+		}
+
+		bp = mdev->coalesce_buf;
+		for (i = 0; i < nreqs; i++) {
+			nbytes = batch[i]->cnt * mfun->block_size;
+			memcpy(bp, batch[i]->data, nbytes);
+			bp += nbytes;
+		}
+
+		return usbmast_write(mfun, batch[0]->ba, total,
+		    mdev->coalesce_buf);
+	}
+
+	return EINVAL;
+}
+
+/** Worker fibril servicing the I/O request queue.
+ *
+ * The bulk-only transport admits just one command cycle on the bulk
+ * pipes at a time, so requests queued while a command is in progress
+ * are not issued immediately. Instead, adjacent requests of the same
+ * kind that pile up in the queue are coalesced and serviced together
+ * by a single SCSI command. Only an unbroken run of requests at the
+ * head of the queue is coalesced so that overlapping transfers are
+ * never reordered.
+ *
+ * @param arg		Mass storage device (usbmast_dev_t)
+ * @return		EOK
+ */
+static errno_t usbmast_worker(void *arg)
+{
+	usbmast_dev_t *mdev = (usbmast_dev_t *) arg;
+	usbmast_req_t *batch[MAX_BATCH_REQS];
+	usbmast_req_t *head;
+	usbmast_req_t *req;
+	size_t nreqs;
+	size_t total;
+	size_t i;
+	errno_t rc;
+
+	fibril_mutex_lock(&mdev->lock);
+
+	while (!mdev->stopping) {
+		if (list_empty(&mdev->queue)) {
+			fibril_condvar_wait(&mdev->queue_cv, &mdev->lock);
+			continue;
+		}
+
+		head = list_get_instance(list_first(&mdev->queue),
+		    usbmast_req_t, link);
+		list_remove(&head->link);
+
+		batch[0] = head;
+		nreqs = 1;
+		total = head->cnt;
+
+		while (nreqs < MAX_BATCH_REQS && !list_empty(&mdev->queue)) {
+			req = list_get_instance(list_first(&mdev->queue),
+			    usbmast_req_t, link);
+			if (!usbmast_req_mergeable(head, req, total))
+				break;
+
+			list_remove(&req->link);
+			batch[nreqs++] = req;
+			total += req->cnt;
+		}
+
+		fibril_mutex_unlock(&mdev->lock);
+		rc = usbmast_batch_exec(mdev, batch, nreqs, total);
+		fibril_mutex_lock(&mdev->lock);
+
+		for (i = 0; i < nreqs; i++) {
+			batch[i]->rc = rc;
+			batch[i]->done = true;
+		}
+
+		fibril_condvar_broadcast(&mdev->done_cv);
+	}
+
+	/* Fail whatever requests are still queued. */
+	while (!list_empty(&mdev->queue)) {
+		req = list_get_instance(list_first(&mdev->queue),
+		    usbmast_req_t, link);
+		list_remove(&req->link);
+		req->rc = EIO;
+		req->done = true;
+	}
+
+	mdev->stopped = true;
+	fibril_condvar_broadcast(&mdev->done_cv);
+	fibril_mutex_unlock(&mdev->lock);
+
+	return EOK;
+}
+
+/** Enqueue an I/O request and wait for its completion.
+ *
+ * @param mfun		Mass storage function
+ * @param op		Requested operation
+ * @param ba		Address of first block
+ * @param cnt		Number of blocks
+ * @param buf		Destination buffer (read requests)
+ * @param data		Source data (write requests)
+ *
+ * @return		Error code
+ */
+static errno_t usbmast_req_enqueue(usbmast_fun_t *mfun, usbmast_req_op_t op,
+    uint64_t ba, size_t cnt, void *buf, const void *data)
+{
+	usbmast_dev_t *mdev = mfun->mdev;
+	usbmast_req_t req;
+
+	link_initialize(&req.link);
+	req.mfun = mfun;
+	req.op = op;
+	req.ba = ba;
+	req.cnt = cnt;
+	req.buf = buf;
+	req.data = data;
+	req.done = false;
+	req.rc = EOK;
+
+	fibril_mutex_lock(&mdev->lock);
+	list_append(&req.link, &mdev->queue);
+	fibril_condvar_signal(&mdev->queue_cv);
+
+	while (!req.done)
+		fibril_condvar_wait(&mdev->done_cv, &mdev->lock);
+
+	fibril_mutex_unlock(&mdev->lock);
+
+	return req.rc;
+}
+
 /** Callback when a device is removed from the system.
  *
  * @param dev Representation of USB device.
@@ -123,6 +349,16 @@ static errno_t usbmast_device_gone(usb_device_t *dev)
 		ddf_fun_destroy(mdev->luns[i]);
 		mdev->luns[i] = NULL;
 	}
+
+	/* Stop the worker fibril; it fails any requests still queued. */
+	fibril_mutex_lock(&mdev->lock);
+	mdev->stopping = true;
+	fibril_condvar_broadcast(&mdev->queue_cv);
+	while (!mdev->stopped)
+		fibril_condvar_wait(&mdev->done_cv, &mdev->lock);
+	fibril_mutex_unlock(&mdev->lock);
+
+	free(mdev->coalesce_buf);
 	free(mdev->luns);
 	return EOK;
 }
@@ -185,12 +421,39 @@ static errno_t usbmast_device_add(usb_device_t *dev)
 
 	mdev->bulk_in_pipe = &epm_in->pipe;
 	mdev->bulk_out_pipe = &epm_out->pipe;
+
+	fibril_mutex_initialize(&mdev->lock);
+	fibril_condvar_initialize(&mdev->queue_cv);
+	fibril_condvar_initialize(&mdev->done_cv);
+	list_initialize(&mdev->queue);
+	mdev->next_tag = 1;
+
+	mdev->coalesce_buf = malloc(COALESCE_BUF_SIZE);
+	if (mdev->coalesce_buf == NULL) {
+		usb_log_error("Failed allocating coalescing buffer.");
+		free(mdev->luns);
+		return ENOMEM;
+	}
+
 	for (i = 0; i < mdev->lun_count; i++) {
 		rc = usbmast_fun_create(mdev, i);
 		if (rc != EOK)
 			goto error;
 	}
 
+	/*
+	 * Start servicing I/O requests. Requests of clients who raced in
+	 * before this point have simply been sitting in the queue.
+	 */
+	fid_t fid = fibril_create(usbmast_worker, mdev);
+	if (fid == 0) {
+		usb_log_error("Failed creating worker fibril.");
+		rc = ENOMEM;
+		goto error;
+	}
+
+	fibril_add_ready(fid);
+
 	return EOK;
 error:
 	/* Destroy functions */
@@ -204,6 +467,20 @@ error:
 		}
 		ddf_fun_destroy(mdev->luns[i]);
 	}
+
+	/* The worker is not running, fail queued requests directly. */
+	fibril_mutex_lock(&mdev->lock);
+	while (!list_empty(&mdev->queue)) {
+		usbmast_req_t *req = list_get_instance(list_first(&mdev->queue),
+		    usbmast_req_t, link);
+		list_remove(&req->link);
+		req->rc = EIO;
+		req->done = true;
+	}
+	fibril_condvar_broadcast(&mdev->done_cv);
+	fibril_mutex_unlock(&mdev->lock);
+
+	free(mdev->coalesce_buf);
 	free(mdev->luns);
 	return rc;
 }
@@ -354,7 +631,7 @@ static errno_t usbmast_bd_read_blocks(bd_srv_t *bd, uint64_t ba, size_t cnt, voi
 	if (size < cnt * mfun->block_size)
 		return EINVAL;
 
-	return usbmast_read(mfun, ba, cnt, buf);
+	return usbmast_req_enqueue(mfun, USBMAST_REQ_READ, ba, cnt, buf, NULL);
 }
 
 /** Synchronize blocks to nonvolatile storage. */
@@ -362,7 +639,7 @@ static errno_t usbmast_bd_sync_cache(bd_srv_t *bd, uint64_t ba, size_t cnt)
 {
 	usbmast_fun_t *mfun = bd_srv_usbmast(bd);
 
-	return usbmast_sync_cache(mfun, ba, cnt);
+	return usbmast_req_enqueue(mfun, USBMAST_REQ_SYNC, ba, cnt, NULL, NULL);
 }
 
 /** Write blocks to the device. */
@@ -374,7 +651,7 @@ static errno_t usbmast_bd_write_blocks(bd_srv_t *bd, uint64_t ba, size_t cnt,
 	if (size < cnt * mfun->block_size)
 		return EINVAL;
 
-	return usbmast_write(mfun, ba, cnt, buf);
+	return usbmast_req_enqueue(mfun, USBMAST_REQ_WRITE, ba, cnt, NULL, buf);
 }
 
 /** Get device block size. */
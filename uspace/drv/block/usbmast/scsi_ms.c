@@ -85,7 +85,7 @@ static errno_t usb_massstor_unit_ready(usbmast_fun_t *mfun)
 	cmd.cdb = &cdb;
 	cmd.cdb_size = sizeof(cdb);
 
-	rc = usb_massstor_cmd(mfun, 0xDEADBEEF, &cmd);
+	rc = usb_massstor_cmd(mfun, &cmd);
 
 	if (rc != EOK) {
 		usb_log_error("Test Unit Ready failed on device %s: %s.",
@@ -122,7 +122,7 @@ static errno_t usbmast_run_cmd(usbmast_fun_t *mfun, scsi_cmd_t *cmd)
 			return rc;
 		}
 
-		rc = usb_massstor_cmd(mfun, 0xDEADBEEF, cmd);
+		rc = usb_massstor_cmd(mfun, cmd);
 		if (rc != EOK) {
 			usb_log_error("Inquiry transport failed, device %s: %s.",
 			    usb_device_get_name(mfun->mdev->usb_dev), str_error(rc));
@@ -180,7 +180,7 @@ errno_t usbmast_inquiry(usbmast_fun_t *mfun, usbmast_inquiry_data_t *inq_res)
 	cmd.data_in = &inq_data;
 	cmd.data_in_size = sizeof(inq_data);
 
-	rc = usb_massstor_cmd(mfun, 0xDEADBEEF, &cmd);
+	rc = usb_massstor_cmd(mfun, &cmd);
 
 	if (rc != EOK) {
 		usb_log_error("Inquiry transport failed, device %s: %s.",
@@ -248,7 +248,7 @@ errno_t usbmast_request_sense(usbmast_fun_t *mfun, void *buf, size_t size)
 	cmd.data_in = buf;
 	cmd.data_in_size = size;
 
-	rc = usb_massstor_cmd(mfun, 0xDEADBEEF, &cmd);
+	rc = usb_massstor_cmd(mfun, &cmd);
 
 	if (rc != EOK || cmd.status != CMDS_GOOD) {
 		usb_log_error("Request Sense failed, device %s: %s.",
@@ -36,7 +36,9 @@
 #ifndef USBMAST_H_
 #define USBMAST_H_
 
+#include <adt/list.h>
 #include <bd_srv.h>
+#include <fibril_synch.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <usb/usb.h>
@@ -53,6 +55,22 @@ typedef struct usbmast_dev {
 	usb_pipe_t *bulk_in_pipe;
 	/** Data write pipe */
 	usb_pipe_t *bulk_out_pipe;
+	/** Protects the I/O request queue */
+	fibril_mutex_t lock;
+	/** Signaled when a request is enqueued or the worker should stop */
+	fibril_condvar_t queue_cv;
+	/** Signaled when requests complete or the worker terminates */
+	fibril_condvar_t done_cv;
+	/** Queue of outstanding I/O requests (of usbmast_req_t) */
+	list_t queue;
+	/** Tag for the next command block wrapper */
+	uint32_t next_tag;
+	/** Bounce buffer for coalesced transfers */
+	uint8_t *coalesce_buf;
+	/** The worker fibril should terminate */
+	bool stopping;
+	/** The worker fibril has terminated */
+	bool stopped;
 } usbmast_dev_t;
 
 /** Mass storage function.
@@ -74,6 +92,39 @@ typedef struct {
 	bd_srvs_t bds;
 } usbmast_fun_t;
 
+/** Operation carried out by a queued I/O request. */
+typedef enum {
+	USBMAST_REQ_READ,
+	USBMAST_REQ_WRITE,
+	USBMAST_REQ_SYNC
+} usbmast_req_op_t;
+
+/** Queued I/O request.
+ *
+ * Allocated on the stack of the client fibril, which blocks until the
+ * worker fibril marks the request as done.
+ */
+typedef struct {
+	/** Link to usbmast_dev_t.queue */
+	link_t link;
+	/** Function/LUN the request is addressed to */
+	usbmast_fun_t *mfun;
+	/** Requested operation */
+	usbmast_req_op_t op;
+	/** Address of the first block */
+	uint64_t ba;
+	/** Number of blocks */
+	size_t cnt;
+	/** Destination buffer (read requests) */
+	void *buf;
+	/** Source data (write requests) */
+	const void *data;
+	/** The request has been completed */
+	bool done;
+	/** Result of the request */
+	errno_t rc;
+} usbmast_req_t;
+
 #endif
 
 /**
@@ -32,6 +32,7 @@
 #include <stdint.h>
 
 #include <as.h>
+#include <macros.h>
 #include <ddf/driver.h>
 #include <ddf/interrupt.h>
 #include <ddf/log.h>
@@ -56,6 +57,10 @@
  * used for request headers, the following RQ_BUFFERS descriptors are used
  * for in/out buffers and the last RQ_BUFFERS descriptors are used for request
  * footers.
+ *
+ * When the device supports indirect descriptors, the three descriptors of
+ * each request live in a per-request indirect descriptor table instead and
+ * only the first RQ_BUFFERS ring descriptors are used.
  */
 #define REQ_HEADER_DESC(descno)	(0 * RQ_BUFFERS + (descno))
 #define REQ_BUFFER_DESC(descno)	(1 * RQ_BUFFERS + (descno))
@@ -83,6 +88,7 @@ static void virtio_blk_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
 	while (virtio_virtq_consume_used(vdev, RQ_QUEUE, &descno, &len)) {
 		assert(descno < RQ_BUFFERS);
 		fibril_mutex_lock(&virtio_blk->completion_lock[descno]);
+		virtio_blk->rq_done[descno] = true;
 		fibril_condvar_signal(&virtio_blk->completion_cv[descno]);
 		fibril_mutex_unlock(&virtio_blk->completion_lock[descno]);
 	}
@@ -157,22 +163,25 @@ static errno_t virtio_blk_bd_close(bd_srv_t *bd)
 	return EOK;
 }
 
-static errno_t virtio_blk_rw_block(virtio_blk_t *virtio_blk, bool read,
-    aoff64_t ba, void *buf)
+/** Allocate a request descriptor, waiting until one becomes available
+ *
+ * The allocated descno determines the header descriptor (REQ_HEADER_DESC),
+ * the buffer descriptor (REQ_BUFFER_DESC) and the footer (REQ_FOOTER_DESC)
+ * descriptor, or, with indirect descriptors, the indirect table.
+ */
+static uint16_t virtio_blk_rq_alloc(virtio_blk_t *virtio_blk)
 {
 	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
 
-	/*
-	 * Allocate a descriptor.
-	 *
-	 * The allocated descno will determine the header descriptor
-	 * (REQ_HEADER_DESC), the buffer descriptor (REQ_BUFFER_DESC) and the
-	 * footer (REQ_FOOTER_DESC) descriptor.
-	 */
 	fibril_mutex_lock(&virtio_blk->free_lock);
 	uint16_t descno = virtio_alloc_desc(vdev, RQ_QUEUE,
 	    &virtio_blk->rq_free_head);
 	while (descno == (uint16_t) -1U) {
+		/*
+		 * Push out any batched requests first, otherwise we could
+		 * wait for a free descriptor forever.
+		 */
+		virtio_virtq_notify(vdev, RQ_QUEUE);
 		fibril_condvar_wait(&virtio_blk->free_cv,
 		    &virtio_blk->free_lock);
 		descno = virtio_alloc_desc(vdev, RQ_QUEUE,
@@ -181,6 +190,58 @@ static errno_t virtio_blk_rw_block(virtio_blk_t *virtio_blk, bool read,
 	fibril_mutex_unlock(&virtio_blk->free_lock);
 
 	assert(descno < RQ_BUFFERS);
+	return descno;
+}
+
+/** Set the descriptors describing a request with the given data buffer */
+static void virtio_blk_rq_desc_set(virtio_blk_t *virtio_blk, bool read,
+    uint16_t descno, uintptr_t buf_phys, size_t buf_size)
+{
+	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
+
+	if (vdev->features & VIRTIO_F_RING_INDIRECT_DESC) {
+		/*
+		 * Describe the whole request by a single ring descriptor
+		 * referring to a three-entry indirect descriptor table.
+		 */
+		virtq_desc_t *table =
+		    (virtq_desc_t *) virtio_blk->rq_indirect[descno];
+		virtio_indirect_desc_set(table, 0,
+		    virtio_blk->rq_header_p[descno],
+		    sizeof(virtio_blk_req_header_t), VIRTQ_DESC_F_NEXT, 1);
+		virtio_indirect_desc_set(table, 1, buf_phys, buf_size,
+		    VIRTQ_DESC_F_NEXT | (read ? VIRTQ_DESC_F_WRITE : 0), 2);
+		virtio_indirect_desc_set(table, 2,
+		    virtio_blk->rq_footer_p[descno],
+		    sizeof(virtio_blk_req_footer_t), VIRTQ_DESC_F_WRITE, 0);
+		virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_HEADER_DESC(descno),
+		    virtio_blk->rq_indirect_p[descno],
+		    3 * sizeof(virtq_desc_t), VIRTQ_DESC_F_INDIRECT, 0);
+	} else {
+		/* Set the descriptors and chain them in the virtqueue */
+		virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_HEADER_DESC(descno),
+		    virtio_blk->rq_header_p[descno],
+		    sizeof(virtio_blk_req_header_t), VIRTQ_DESC_F_NEXT,
+		    REQ_BUFFER_DESC(descno));
+		virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_BUFFER_DESC(descno),
+		    buf_phys, buf_size,
+		    VIRTQ_DESC_F_NEXT | (read ? VIRTQ_DESC_F_WRITE : 0),
+		    REQ_FOOTER_DESC(descno));
+		virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_FOOTER_DESC(descno),
+		    virtio_blk->rq_footer_p[descno],
+		    sizeof(virtio_blk_req_footer_t), VIRTQ_DESC_F_WRITE, 0);
+	}
+}
+
+/** Describe a request and put it on the available ring
+ *
+ * The device is not notified; the caller batches one or more submissions
+ * behind a single virtio_virtq_notify().
+ */
+static void virtio_blk_rq_submit(virtio_blk_t *virtio_blk, bool read,
+    aoff64_t ba, const void *buf, uint16_t descno)
+{
+	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
 
 	/* Setup the request header */
 	virtio_blk_req_header_t *req_header =
@@ -194,29 +255,49 @@ static errno_t virtio_blk_rw_block(virtio_blk_t *virtio_blk, bool read,
 	if (!read)
 		memcpy(virtio_blk->rq_buf[descno], buf, VIRTIO_BLK_BLOCK_SIZE);
 
-	fibril_mutex_lock(&virtio_blk->completion_lock[descno]);
+	virtio_blk->rq_done[descno] = false;
 
-	/*
-	 * Set the descriptors, chain them in the virtqueue and notify the
-	 * device.
-	 */
-	virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_HEADER_DESC(descno),
-	    virtio_blk->rq_header_p[descno], sizeof(virtio_blk_req_header_t),
-	    VIRTQ_DESC_F_NEXT, REQ_BUFFER_DESC(descno));
-	virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_BUFFER_DESC(descno),
-	    virtio_blk->rq_buf_p[descno], VIRTIO_BLK_BLOCK_SIZE,
-	    VIRTQ_DESC_F_NEXT | (read ? VIRTQ_DESC_F_WRITE : 0),
-	    REQ_FOOTER_DESC(descno));
-	virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_FOOTER_DESC(descno),
-	    virtio_blk->rq_footer_p[descno], sizeof(virtio_blk_req_footer_t),
-	    VIRTQ_DESC_F_WRITE, 0);
-	virtio_virtq_produce_available(vdev, RQ_QUEUE, descno);
+	virtio_blk_rq_desc_set(virtio_blk, read, descno,
+	    virtio_blk->rq_buf_p[descno], VIRTIO_BLK_BLOCK_SIZE);
+	virtio_virtq_produce_enqueue(vdev, RQ_QUEUE, REQ_HEADER_DESC(descno));
+}
 
-	/*
-	 * Wait for the completion of the request.
-	 */
-	fibril_condvar_wait(&virtio_blk->completion_cv[descno],
-	    &virtio_blk->completion_lock[descno]);
+/** Describe a request around a caller-provided DMA buffer and put it on the
+ * available ring
+ *
+ * Unlike virtio_blk_rq_submit(), the device transfers the data directly
+ * to/from the physical memory at @a buf_phys, so a single request can cover
+ * any number of blocks. The device is not notified.
+ */
+static void virtio_blk_rq_submit_dma(virtio_blk_t *virtio_blk, bool read,
+    aoff64_t ba, uintptr_t buf_phys, size_t buf_size, uint16_t descno)
+{
+	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
+
+	/* Setup the request header */
+	virtio_blk_req_header_t *req_header =
+	    (virtio_blk_req_header_t *) virtio_blk->rq_header[descno];
+	memset(req_header, 0, sizeof(virtio_blk_req_header_t));
+	pio_write_le32(&req_header->type,
+	    read ? VIRTIO_BLK_T_IN : VIRTIO_BLK_T_OUT);
+	pio_write_le64(&req_header->sector, ba);
+
+	virtio_blk->rq_done[descno] = false;
+
+	virtio_blk_rq_desc_set(virtio_blk, read, descno, buf_phys, buf_size);
+	virtio_virtq_produce_enqueue(vdev, RQ_QUEUE, REQ_HEADER_DESC(descno));
+}
+
+/** Wait for the completion of a request and collect its result */
+static errno_t virtio_blk_rq_wait(virtio_blk_t *virtio_blk, bool read,
+    void *buf, uint16_t descno)
+{
+	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
+
+	fibril_mutex_lock(&virtio_blk->completion_lock[descno]);
+	while (!virtio_blk->rq_done[descno])
+		fibril_condvar_wait(&virtio_blk->completion_cv[descno],
+		    &virtio_blk->completion_lock[descno]);
 	fibril_mutex_unlock(&virtio_blk->completion_lock[descno]);
 
 	errno_t rc;
@@ -256,20 +337,43 @@ static errno_t virtio_blk_bd_rw_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
     void *buf, size_t size, bool read)
 {
 	virtio_blk_t *virtio_blk = (virtio_blk_t *) bd->srvs->sarg;
-	aoff64_t i;
-	errno_t rc;
+	uint16_t descno[RQ_BUFFERS];
+	errno_t rc = EOK;
 
 	if (size != cnt * VIRTIO_BLK_BLOCK_SIZE)
 		return EINVAL;
 
-	for (i = 0; i < cnt; i++) {
-		rc = virtio_blk_rw_block(virtio_blk, read, ba + i,
-		    buf + i * VIRTIO_BLK_BLOCK_SIZE);
-		if (rc != EOK)
-			return rc;
+	size_t done = 0;
+	while (done < cnt && rc == EOK) {
+		size_t batch = min(cnt - done, RQ_BUFFERS);
+
+		/*
+		 * Submit the whole batch and notify the device only once.
+		 */
+		for (size_t i = 0; i < batch; i++) {
+			descno[i] = virtio_blk_rq_alloc(virtio_blk);
+			virtio_blk_rq_submit(virtio_blk, read, ba + done + i,
+			    buf + (done + i) * VIRTIO_BLK_BLOCK_SIZE,
+			    descno[i]);
+		}
+		virtio_virtq_notify(&virtio_blk->virtio_dev, RQ_QUEUE);
+
+		/*
+		 * Collect all requests of the batch, even the ones following
+		 * a failed request.
+		 */
+		for (size_t i = 0; i < batch; i++) {
+			errno_t req_rc = virtio_blk_rq_wait(virtio_blk, read,
+			    buf + (done + i) * VIRTIO_BLK_BLOCK_SIZE,
+			    descno[i]);
+			if (rc == EOK)
+				rc = req_rc;
+		}
+
+		done += batch;
 	}
 
-	return EOK;
+	return rc;
 }
 
 static errno_t virtio_blk_bd_read_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
@@ -284,6 +388,82 @@ static errno_t virtio_blk_bd_write_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
 	return virtio_blk_bd_rw_blocks(bd, ba, cnt, (void *) buf, size, false);
 }
 
+static errno_t virtio_blk_bd_rw_blocks_dma(bd_srv_t *bd, aoff64_t ba,
+    size_t cnt, uintptr_t phys, bool read)
+{
+	virtio_blk_t *virtio_blk = (virtio_blk_t *) bd->srvs->sarg;
+
+	uint16_t descno = virtio_blk_rq_alloc(virtio_blk);
+	virtio_blk_rq_submit_dma(virtio_blk, read, ba, phys,
+	    cnt * VIRTIO_BLK_BLOCK_SIZE, descno);
+	virtio_virtq_notify(&virtio_blk->virtio_dev, RQ_QUEUE);
+
+	/* The device transfers directly to/from the caller's buffer. */
+	return virtio_blk_rq_wait(virtio_blk, false, NULL, descno);
+}
+
+static errno_t virtio_blk_bd_read_blocks_dma(bd_srv_t *bd, aoff64_t ba,
+    size_t cnt, uintptr_t phys)
+{
+	return virtio_blk_bd_rw_blocks_dma(bd, ba, cnt, phys, true);
+}
+
+static errno_t virtio_blk_bd_write_blocks_dma(bd_srv_t *bd, aoff64_t ba,
+    size_t cnt, uintptr_t phys)
+{
+	return virtio_blk_bd_rw_blocks_dma(bd, ba, cnt, phys, false);
+}
+
+/** Discard a range of blocks whose contents are no longer needed */
+static errno_t virtio_blk_bd_discard(bd_srv_t *bd, aoff64_t ba, size_t cnt)
+{
+	virtio_blk_t *virtio_blk = (virtio_blk_t *) bd->srvs->sarg;
+	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
+	virtio_blk_cfg_t *blkcfg = vdev->device_cfg;
+
+	if (!(vdev->features & VIRTIO_BLK_F_DISCARD))
+		return ENOTSUP;
+
+	uint32_t max_sectors = pio_read_le32(&blkcfg->max_discard_sectors);
+	if (max_sectors == 0)
+		max_sectors = (uint32_t) -1U;
+
+	errno_t rc = EOK;
+	while (cnt > 0 && rc == EOK) {
+		size_t now = min(cnt, (size_t) max_sectors);
+
+		uint16_t descno = virtio_blk_rq_alloc(virtio_blk);
+
+		/* Setup the request header */
+		virtio_blk_req_header_t *req_header =
+		    (virtio_blk_req_header_t *) virtio_blk->rq_header[descno];
+		memset(req_header, 0, sizeof(virtio_blk_req_header_t));
+		pio_write_le32(&req_header->type, VIRTIO_BLK_T_DISCARD);
+
+		/* The range to discard goes into the data buffer */
+		virtio_blk_discard_t *seg =
+		    (virtio_blk_discard_t *) virtio_blk->rq_buf[descno];
+		pio_write_le64(&seg->sector, ba);
+		pio_write_le32(&seg->num_sectors, (uint32_t) now);
+		pio_write_le32(&seg->flags, 0);
+
+		virtio_blk->rq_done[descno] = false;
+
+		virtio_blk_rq_desc_set(virtio_blk, false, descno,
+		    virtio_blk->rq_buf_p[descno], sizeof(virtio_blk_discard_t));
+		virtio_virtq_produce_enqueue(vdev, RQ_QUEUE,
+		    REQ_HEADER_DESC(descno));
+		virtio_virtq_notify(vdev, RQ_QUEUE);
+
+		rc = virtio_blk_rq_wait(virtio_blk, false, NULL, descno);
+
+		ba += now;
+		cnt -= now;
+	}
+
+	return rc;
+}
+
 static errno_t virtio_blk_bd_get_block_size(bd_srv_t *bd, size_t *size)
 {
 	*size = VIRTIO_BLK_BLOCK_SIZE;
@@ -305,6 +485,9 @@ bd_ops_t virtio_blk_bd_ops = {
 	.write_blocks = virtio_blk_bd_write_blocks,
 	.get_block_size = virtio_blk_bd_get_block_size,
 	.get_num_blocks = virtio_blk_bd_get_num_blocks,
+	.read_blocks_dma = virtio_blk_bd_read_blocks_dma,
+	.write_blocks_dma = virtio_blk_bd_write_blocks_dma,
+	.discard = virtio_blk_bd_discard,
 };
 
 static errno_t virtio_blk_initialize(ddf_dev_t *dev)
@@ -341,7 +524,11 @@ static errno_t virtio_blk_initialize(ddf_dev_t *dev)
 		goto fail;
 
 	/* Reset the device and negotiate the feature bits */
-	rc = virtio_device_setup_start(vdev, 0);
+	rc = virtio_device_setup_start(vdev, VIRTIO_BLK_F_DISCARD);
+	if (rc == ENOTSUP) {
+		/* The device cannot discard blocks; proceed without it */
+		rc = virtio_device_setup_start(vdev, 0);
+	}
 	if (rc != EOK)
 		goto fail;
 
@@ -364,8 +551,14 @@ static errno_t virtio_blk_initialize(ddf_dev_t *dev)
 		goto fail;
 	}
 
-	/* For each in/out request we need 3 descriptors */
-	rc = virtio_virtq_setup(vdev, RQ_QUEUE, 3 * RQ_BUFFERS);
+	/*
+	 * For each in/out request we need 3 descriptors. With indirect
+	 * descriptors the 3 descriptors live in a per-request table and a
+	 * request occupies a single ring descriptor.
+	 */
+	bool indirect = (vdev->features & VIRTIO_F_RING_INDIRECT_DESC) != 0;
+	rc = virtio_virtq_setup(vdev, RQ_QUEUE,
+	    (indirect ? 1 : 3) * RQ_BUFFERS);
 	if (rc != EOK)
 		goto fail;
 
@@ -384,6 +577,12 @@ static errno_t virtio_blk_initialize(ddf_dev_t *dev)
 	    false, virtio_blk->rq_footer, virtio_blk->rq_footer_p);
 	if (rc != EOK)
 		goto fail;
+	if (indirect) {
+		rc = virtio_setup_dma_bufs(RQ_BUFFERS, 3 * sizeof(virtq_desc_t),
+		    true, virtio_blk->rq_indirect, virtio_blk->rq_indirect_p);
+		if (rc != EOK)
+			goto fail;
+	}
 
 	/*
 	 * Put all request descriptors on a free list. Because of the
@@ -415,6 +614,7 @@ fail:
 	virtio_teardown_dma_bufs(virtio_blk->rq_header);
 	virtio_teardown_dma_bufs(virtio_blk->rq_buf);
 	virtio_teardown_dma_bufs(virtio_blk->rq_footer);
+	virtio_teardown_dma_bufs(virtio_blk->rq_indirect);
 
 	virtio_device_setup_fail(vdev);
 	virtio_pci_dev_cleanup(vdev);
@@ -428,6 +628,7 @@ static void virtio_blk_uninitialize(ddf_dev_t *dev)
 	virtio_teardown_dma_bufs(virtio_blk->rq_header);
 	virtio_teardown_dma_bufs(virtio_blk->rq_buf);
 	virtio_teardown_dma_bufs(virtio_blk->rq_footer);
+	virtio_teardown_dma_bufs(virtio_blk->rq_indirect);
 
 	virtio_device_setup_fail(&virtio_blk->virtio_dev);
 	virtio_pci_dev_cleanup(&virtio_blk->virtio_dev);
@@ -40,6 +40,7 @@
 /* Operation types. */
 #define VIRTIO_BLK_T_IN		0
 #define VIRTIO_BLK_T_OUT	1
+#define VIRTIO_BLK_T_DISCARD	11
 
 /* Status codes returned by the device. */
 #define VIRTIO_BLK_S_OK		0
@@ -50,6 +51,8 @@
 
 /** Device is read-only. */
 #define VIRTIO_BLK_F_RO		(1U << 5)
+/** Device supports the discard command. */
+#define VIRTIO_BLK_F_DISCARD	(1U << 13)
 
 typedef struct {
 	uint32_t type;
@@ -57,12 +60,38 @@ typedef struct {
 	uint64_t sector;
 } virtio_blk_req_header_t;
 
+/** Data segment of a discard request */
+typedef struct {
+	uint64_t sector;
+	uint32_t num_sectors;
+	uint32_t flags;
+} virtio_blk_discard_t;
+
 typedef struct {
 	uint8_t status;
 } virtio_blk_req_footer_t;
 
 typedef struct {
 	uint64_t capacity;
+	uint32_t size_max;
+	uint32_t seg_max;
+	struct {
+		uint16_t cylinders;
+		uint8_t heads;
+		uint8_t sectors;
+	} geometry;
+	uint32_t blk_size;
+	struct {
+		uint8_t physical_block_exp;
+		uint8_t alignment_offset;
+		uint16_t min_io_size;
+		uint32_t opt_io_size;
+	} topology;
+	uint8_t writeback;
+	uint8_t unused0[3];
+	uint32_t max_discard_sectors;
+	uint32_t max_discard_seg;
+	uint32_t discard_sector_alignment;
 } virtio_blk_cfg_t;
 
 typedef struct {
@@ -77,6 +106,10 @@ typedef struct {
 	void *rq_footer[RQ_BUFFERS];
 	uintptr_t rq_footer_p[RQ_BUFFERS];
 
+	/* Indirect descriptor tables (with VIRTIO_F_RING_INDIRECT_DESC) */
+	void *rq_indirect[RQ_BUFFERS];
+	uintptr_t rq_indirect_p[RQ_BUFFERS];
+
 	uint16_t rq_free_head;
 
 	int irq;
@@ -89,6 +122,7 @@ typedef struct {
 
 	fibril_mutex_t completion_lock[RQ_BUFFERS];
 	fibril_condvar_t completion_cv[RQ_BUFFERS];
+	bool rq_done[RQ_BUFFERS];
 } virtio_blk_t;
 
 #endif
@@ -88,6 +88,18 @@ static endpoint_t *ehci_endpoint_create(device_t *dev,
 
 	ehci_ep->qh = ehci_ep->dma_buffer.virt;
 
+	/*
+	 * High-speed endpoints encode the interval as an exponent in
+	 * microframes, full/low-speed report it in frames directly.
+	 */
+	const unsigned poll = desc->endpoint.poll_interval;
+	if (dev->speed == USB_SPEED_HIGH)
+		ehci_ep->interval = poll > 0 ? (1u << (poll - 1)) / 8 : 1;
+	else
+		ehci_ep->interval = poll;
+	if (ehci_ep->interval == 0)
+		ehci_ep->interval = 1;
+
 	link_initialize(&ehci_ep->eplist_link);
 	link_initialize(&ehci_ep->pending_link);
 	return &ehci_ep->base;
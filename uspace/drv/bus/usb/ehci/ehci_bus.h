@@ -51,6 +51,9 @@ typedef struct ehci_endpoint {
 	/** EHCI endpoint descriptor, backed by dma_buffer */
 	qh_t *qh;
 
+	/** Polling interval in frames (interrupt endpoints) */
+	unsigned interval;
+
 	dma_buffer_t dma_buffer;
 
 	/** Link in endpoint_list */
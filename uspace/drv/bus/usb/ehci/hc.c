@@ -206,11 +206,30 @@ int hc_gone(hc_device_t *hcd)
 {
 	hc_t *hc = hcd_to_hc(hcd);
 	endpoint_list_fini(&hc->async_list);
-	endpoint_list_fini(&hc->int_list);
+	for (unsigned i = 0; i < EHCI_INT_LIST_COUNT; ++i)
+		endpoint_list_fini(&hc->int_lists[i]);
 	dma_buffer_free(&hc->dma_buffer);
 	return EOK;
 }
 
+/** Select the interrupt schedule list for an endpoint.
+ *
+ * Picks the list with the largest power-of-two interval not exceeding
+ * the polling interval of the endpoint, so the endpoint is polled at
+ * least as often as it requests.
+ */
+static endpoint_list_t *hc_int_list(hc_t *instance, const endpoint_t *ep)
+{
+	const ehci_endpoint_t *ehci_ep = ehci_endpoint_get(ep);
+	unsigned i = 0;
+
+	while (i + 1 < EHCI_INT_LIST_COUNT &&
+	    (1u << (i + 1)) <= ehci_ep->interval)
+		++i;
+
+	return &instance->int_lists[i];
+}
+
 void hc_enqueue_endpoint(hc_t *instance, const endpoint_t *ep)
 {
 	assert(instance);
@@ -226,7 +245,7 @@ void hc_enqueue_endpoint(hc_t *instance, const endpoint_t *ep)
 		endpoint_list_append_ep(&instance->async_list, ehci_ep);
 		break;
 	case USB_TRANSFER_INTERRUPT:
-		endpoint_list_append_ep(&instance->int_list, ehci_ep);
+		endpoint_list_append_ep(hc_int_list(instance, ep), ehci_ep);
 		break;
 	case USB_TRANSFER_ISOCHRONOUS:
 		/* NOT SUPPORTED */
@@ -245,7 +264,7 @@ void hc_dequeue_endpoint(hc_t *instance, const endpoint_t *ep)
 	    usb_str_direction(ep->direction));
 	switch (ep->transfer_type) {
 	case USB_TRANSFER_INTERRUPT:
-		endpoint_list_remove_ep(&instance->int_list, ehci_ep);
+		endpoint_list_remove_ep(hc_int_list(instance, ep), ehci_ep);
 		/* Fall through */
 	case USB_TRANSFER_ISOCHRONOUS:
 		/* NOT SUPPORTED */
@@ -494,31 +513,58 @@ errno_t hc_init_memory(hc_t *instance)
 	 */
 	endpoint_list_chain(&instance->async_list, &instance->async_list);
 
-	usb_log_debug2("HC(%p): Initializing Interrupt list (%p).", instance,
-	    &instance->int_list);
-	ret = endpoint_list_init(&instance->int_list, "INT");
-	if (ret != EOK) {
-		usb_log_error("HC(%p): Failed to setup INT list: %s",
-		    instance, str_error(ret));
-		endpoint_list_fini(&instance->async_list);
-		return ret;
+	static const char *const int_list_names[EHCI_INT_LIST_COUNT] = {
+		"INT-1", "INT-2", "INT-4", "INT-8",
+		"INT-16", "INT-32", "INT-64", "INT-128",
+	};
+
+	for (unsigned i = 0; i < EHCI_INT_LIST_COUNT; ++i) {
+		usb_log_debug2("HC(%p): Initializing Interrupt list (%p).",
+		    instance, &instance->int_lists[i]);
+		ret = endpoint_list_init(&instance->int_lists[i],
+		    int_list_names[i]);
+		if (ret != EOK) {
+			usb_log_error("HC(%p): Failed to setup %s list: %s",
+			    instance, int_list_names[i], str_error(ret));
+			endpoint_list_fini(&instance->async_list);
+			while (i > 0)
+				endpoint_list_fini(&instance->int_lists[--i]);
+			return ret;
+		}
 	}
 
+	/*
+	 * Chain the lists into a binary tree: the list with interval 2^i
+	 * continues with the list of interval 2^(i-1), so that whenever a
+	 * longer-interval list is scheduled, all shorter intervals follow.
+	 */
+	for (unsigned i = EHCI_INT_LIST_COUNT - 1; i > 0; --i)
+		endpoint_list_chain(&instance->int_lists[i],
+		    &instance->int_lists[i - 1]);
+
 	/* Take 1024 periodic list heads, we ignore low mem options */
 	if (dma_buffer_alloc(&instance->dma_buffer, PAGE_SIZE)) {
 		usb_log_error("HC(%p): Failed to get ISO schedule page.",
 		    instance);
 		endpoint_list_fini(&instance->async_list);
-		endpoint_list_fini(&instance->int_list);
+		for (unsigned i = 0; i < EHCI_INT_LIST_COUNT; ++i)
+			endpoint_list_fini(&instance->int_lists[i]);
 		return ENOMEM;
 	}
 	instance->periodic_list = instance->dma_buffer.virt;
 
 	usb_log_debug2("HC(%p): Initializing Periodic list.", instance);
 	for (unsigned i = 0; i < PAGE_SIZE / sizeof(link_pointer_t); ++i) {
-		/* Disable everything for now */
-		instance->periodic_list[i] =
-		    LINK_POINTER_QH(addr_to_phys(instance->int_list.list_head));
+		/*
+		 * Frame i enters the schedule at the list whose interval
+		 * matches the alignment of the frame number, i.e. the list
+		 * with interval 2^k is reached from every 2^k-th frame.
+		 */
+		unsigned list = 0;
+		while (list < EHCI_INT_LIST_COUNT - 1 && !(i & (1u << list)))
+			++list;
+		instance->periodic_list[i] = LINK_POINTER_QH(
+		    addr_to_phys(instance->int_lists[list].list_head));
 	}
 	return EOK;
 }
@@ -53,6 +53,12 @@
 #include "hw_struct/link_pointer.h"
 #include "endpoint_list.h"
 
+/**
+ * Number of interrupt schedule lists. List i is polled every 2^i frames,
+ * so intervals from 1 up to 128 frames are honored.
+ */
+#define EHCI_INT_LIST_COUNT  8
+
 /** Main EHCI driver structure */
 typedef struct hc {
 	/* Common device header */
@@ -71,8 +77,8 @@ typedef struct hc {
 	/** CONTROL and BULK schedules */
 	endpoint_list_t async_list;
 
-	/** INT schedule */
-	endpoint_list_t int_list;
+	/** INT schedules, one per polling interval of 2^i frames */
+	endpoint_list_t int_lists[EHCI_INT_LIST_COUNT];
 
 	/** List of active transfers */
 	list_t pending_endpoints;
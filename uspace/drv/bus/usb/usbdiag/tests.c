@@ -33,7 +33,11 @@
  * @file
  * Code for executing diagnostic tests.
  */
+#include <assert.h>
 #include <errno.h>
+#include <fibril_synch.h>
+#include <inttypes.h>
+#include <stdlib.h>
 #include <str_error.h>
 #include <usb/debug.h>
 #include <usbdiag_iface.h>
@@ -45,159 +49,314 @@
 
 static const uint32_t test_data_src = 0xDEADBEEF;
 
-static errno_t test_in(usb_pipe_t *pipe, const usbdiag_test_params_t *params, usbdiag_test_results_t *results)
+enum {
+	/** Maximum number of recorded latency samples */
+	lat_samples_max = 4096
+};
+
+/** Reservoir of per-transfer latency samples. */
+typedef struct {
+	uint32_t sample[lat_samples_max];
+	size_t nsamples;
+	uint64_t offered;
+} lat_reservoir_t;
+
+/** Shared state of one streaming test. */
+typedef struct {
+	usb_pipe_t *pipe;
+	size_t size;
+	usb_direction_t dir;
+	bool validate;
+	struct timespec stop_time;
+
+	/** Protects the fields below */
+	fibril_mutex_t lock;
+	fibril_condvar_t done_cv;
+	/** Number of worker fibrils still running */
+	unsigned workers;
+	/** First error encountered, EOK while the test goes on */
+	errno_t rc;
+	uint32_t transfer_count;
+	lat_reservoir_t lat;
+} stream_test_t;
+
+/** Record a latency sample.
+ *
+ * Uses reservoir sampling, so the reservoir holds a uniform subset of
+ * all transfer latencies regardless of their count. Must be called with
+ * the test lock held.
+ *
+ * @param lat Latency reservoir
+ * @param usec Latency of one transfer in microseconds
+ */
+static void lat_record(lat_reservoir_t *lat, uint32_t usec)
 {
-	if (!pipe)
-		return EBADMEM;
+	uint64_t idx;
 
-	bool validate = params->validate_data;
-	size_t size = params->transfer_size;
-	if (!size)
-		size = pipe->desc.max_transfer_size;
+	lat->offered++;
+	if (lat->nsamples < lat_samples_max) {
+		lat->sample[lat->nsamples++] = usec;
+		return;
+	}
 
-	const uint32_t test_data = uint32_host2usb(test_data_src);
-	if (validate && size % sizeof(test_data))
-		return EINVAL;
+	idx = rand() % lat->offered;
+	if (idx < lat_samples_max)
+		lat->sample[idx] = usec;
+}
 
-	size_t test_data_size = size / sizeof(test_data);
-	char *buffer = usb_pipe_alloc_buffer(pipe, size);
-	if (!buffer)
-		return ENOMEM;
+static int lat_cmp(const void *a, const void *b)
+{
+	uint32_t la = *(const uint32_t *) a;
+	uint32_t lb = *(const uint32_t *) b;
+
+	if (la < lb)
+		return -1;
+	if (la > lb)
+		return 1;
+	return 0;
+}
 
-	// TODO: Are we sure that no other test is running on this endpoint?
+/** Get a latency percentile from a sorted reservoir. */
+static uint32_t lat_percentile(const lat_reservoir_t *lat, unsigned pct)
+{
+	size_t idx;
 
-	usb_log_info("Performing %s IN test with duration %ld ms.", usb_str_transfer_type(pipe->desc.transfer_type), params->min_duration);
+	if (lat->nsamples == 0)
+		return 0;
 
-	errno_t rc = EOK;
-	uint32_t transfer_count = 0;
+	idx = lat->nsamples * pct / 100;
+	if (idx >= lat->nsamples)
+		idx = lat->nsamples - 1;
 
-	struct timespec start_time, final_time, stop_time;
-	getuptime(&start_time);
-	getuptime(&stop_time);
+	return lat->sample[idx];
+}
 
-	ts_add_diff(&stop_time, MSEC2NSEC(params->min_duration));
-	getuptime(&final_time);
+/** Perform one IN transfer and optionally validate the data. */
+static errno_t stream_transfer_in(stream_test_t *test, char *buffer)
+{
+	usb_pipe_t *pipe = test->pipe;
+	const uint32_t test_data = uint32_host2usb(test_data_src);
+	size_t remaining = test->size;
+	size_t transferred;
+	errno_t rc;
+
+	// Read device's response.
+	while (remaining > 0) {
+		if ((rc = usb_pipe_read_dma(pipe, buffer, buffer + test->size - remaining, remaining, &transferred))) {
+			usb_log_error("Read of %s IN endpoint failed with error: %s", usb_str_transfer_type(pipe->desc.transfer_type), str_error(rc));
+			return rc;
+		}
 
-	while (!ts_gt(&final_time, &stop_time)) {
-		++transfer_count;
+		if (transferred > remaining) {
+			usb_log_error("Read of %s IN endpoint returned more data than expected.", usb_str_transfer_type(pipe->desc.transfer_type));
+			return EINVAL;
+		}
 
-		// Read device's response.
-		size_t remaining = size;
-		size_t transferred;
+		remaining -= transferred;
+	}
 
-		while (remaining > 0) {
-			if ((rc = usb_pipe_read_dma(pipe, buffer, buffer + size - remaining, remaining, &transferred))) {
-				usb_log_error("Read of %s IN endpoint failed with error: %s", usb_str_transfer_type(pipe->desc.transfer_type), str_error(rc));
-				break;
-			}
+	if (test->validate) {
+		uint32_t *beef_buffer = (uint32_t *) buffer;
 
-			if (transferred > remaining) {
-				usb_log_error("Read of %s IN endpoint returned more data than expected.", usb_str_transfer_type(pipe->desc.transfer_type));
-				rc = EINVAL;
-				break;
+		/* Check if the beef is really dead. */
+		for (size_t i = 0; i < test->size / sizeof(test_data); ++i) {
+			if (beef_buffer[i] != test_data) {
+				usb_log_error("Read of %s IN endpoint returned "
+				    "invalid data at address %zu. [ 0x%X != 0x%X ]",
+				    usb_str_transfer_type(pipe->desc.transfer_type), i * sizeof(test_data), beef_buffer[i], test_data);
+				return EINVAL;
 			}
-
-			remaining -= transferred;
 		}
+	}
 
-		if (rc)
-			break;
+	return EOK;
+}
 
-		if (validate) {
-			uint32_t *beef_buffer = (uint32_t *) buffer;
-
-			/* Check if the beef is really dead. */
-			for (size_t i = 0; i < test_data_size; ++i) {
-				if (beef_buffer[i] != test_data) {
-					usb_log_error("Read of %s IN endpoint returned "
-					    "invalid data at address %zu. [ 0x%X != 0x%X ]",
-					    usb_str_transfer_type(pipe->desc.transfer_type), i * sizeof(test_data), beef_buffer[i], test_data);
-					rc = EINVAL;
-				}
-			}
+/** Perform one OUT transfer. */
+static errno_t stream_transfer_out(stream_test_t *test, char *buffer)
+{
+	usb_pipe_t *pipe = test->pipe;
+	errno_t rc;
 
-			if (rc)
-				break;
-		}
+	// Write buffer to device.
+	if ((rc = usb_pipe_write_dma(pipe, buffer, buffer, test->size))) {
+		usb_log_error("Write to %s OUT endpoint failed with error: %s", usb_str_transfer_type(pipe->desc.transfer_type), str_error(rc));
+		return rc;
+	}
+
+	return EOK;
+}
 
-		getuptime(&final_time);
+/** Streaming test worker.
+ *
+ * Each worker keeps one transfer outstanding at all times, so running
+ * several workers on the same pipe exercises host stack queueing.
+ */
+static errno_t stream_worker(void *arg)
+{
+	stream_test_t *test = (stream_test_t *) arg;
+	struct timespec before, after;
+	errno_t rc = EOK;
+	bool failed;
+	char *buffer;
+
+	buffer = usb_pipe_alloc_buffer(test->pipe, test->size);
+	if (!buffer) {
+		rc = ENOMEM;
+		goto done;
 	}
 
-	usbdiag_dur_t in_duration = NSEC2MSEC(final_time.tv_nsec - start_time.tv_nsec) +
-	    SEC2MSEC(final_time.tv_sec - start_time.tv_sec);
+	if (test->dir == USB_DIRECTION_OUT && test->validate) {
+		const uint32_t test_data = uint32_host2usb(test_data_src);
+		for (size_t i = 0; i < test->size; i += sizeof(test_data))
+			memcpy(buffer + i, &test_data, sizeof(test_data));
+	}
 
-	usb_log_info("Test on %s IN endpoint completed in %lu ms.", usb_str_transfer_type(pipe->desc.transfer_type), in_duration);
+	while (true) {
+		fibril_mutex_lock(&test->lock);
+		failed = (test->rc != EOK);
+		fibril_mutex_unlock(&test->lock);
 
-	results->act_duration = in_duration;
-	results->transfer_count = transfer_count;
-	results->transfer_size = size;
+		if (failed)
+			break;
+
+		getuptime(&before);
+		if (ts_gt(&before, &test->stop_time))
+			break;
 
-	usb_pipe_free_buffer(pipe, buffer);
+		if (test->dir == USB_DIRECTION_IN)
+			rc = stream_transfer_in(test, buffer);
+		else
+			rc = stream_transfer_out(test, buffer);
 
-	return rc;
+		if (rc != EOK)
+			break;
+
+		getuptime(&after);
+
+		fibril_mutex_lock(&test->lock);
+		test->transfer_count++;
+		lat_record(&test->lat,
+		    (uint32_t) NSEC2USEC(ts_sub_diff(&after, &before)));
+		fibril_mutex_unlock(&test->lock);
+	}
+
+	usb_pipe_free_buffer(test->pipe, buffer);
+done:
+	fibril_mutex_lock(&test->lock);
+	if (rc != EOK && test->rc == EOK)
+		test->rc = rc;
+	assert(test->workers > 0);
+	test->workers--;
+	fibril_condvar_broadcast(&test->done_cv);
+	fibril_mutex_unlock(&test->lock);
+
+	return EOK;
 }
 
-static errno_t test_out(usb_pipe_t *pipe, const usbdiag_test_params_t *params, usbdiag_test_results_t *results)
+/** Run a streaming test on a pipe.
+ *
+ * Spawn the requested number of workers, each keeping one transfer
+ * outstanding, until the minimum test duration elapses; then collect
+ * throughput and latency statistics.
+ */
+static errno_t stream_test(usb_pipe_t *pipe, const usbdiag_test_params_t *params, usb_direction_t dir, usbdiag_test_results_t *results)
 {
+	struct timespec start_time, final_time;
+	stream_test_t *test;
+	usbdiag_dur_t duration;
+	unsigned depth;
+	unsigned i;
+	errno_t rc;
+	fid_t fid;
+
 	if (!pipe)
 		return EBADMEM;
 
-	bool validate = params->validate_data;
 	size_t size = params->transfer_size;
 	if (!size)
 		size = pipe->desc.max_transfer_size;
 
-	const uint32_t test_data = uint32_host2usb(test_data_src);
-
-	if (validate && size % sizeof(test_data))
+	if (params->validate_data && size % sizeof(test_data_src))
 		return EINVAL;
 
-	char *buffer = usb_pipe_alloc_buffer(pipe, size);
-	if (!buffer)
-		return ENOMEM;
+	depth = params->queue_depth;
+	if (depth == 0)
+		depth = 1;
 
-	if (validate) {
-		for (size_t i = 0; i < size; i += sizeof(test_data)) {
-			memcpy(buffer + i, &test_data, sizeof(test_data));
-		}
-	}
+	if (depth > USBDIAG_MAX_QUEUE_DEPTH)
+		return EINVAL;
 
 	// TODO: Are we sure that no other test is running on this endpoint?
 
-	usb_log_info("Performing %s OUT test.", usb_str_transfer_type(pipe->desc.transfer_type));
+	test = calloc(1, sizeof(stream_test_t));
+	if (!test)
+		return ENOMEM;
 
-	errno_t rc = EOK;
-	uint32_t transfer_count = 0;
+	test->pipe = pipe;
+	test->size = size;
+	test->dir = dir;
+	test->validate = params->validate_data;
+	fibril_mutex_initialize(&test->lock);
+	fibril_condvar_initialize(&test->done_cv);
 
-	struct timespec start_time, final_time, stop_time;
-	getuptime(&start_time);
-	getuptime(&stop_time);
+	usb_log_info("Performing %s %s test with duration %ld ms, queue depth %u.",
+	    usb_str_transfer_type(pipe->desc.transfer_type),
+	    dir == USB_DIRECTION_IN ? "IN" : "OUT", params->min_duration,
+	    depth);
 
-	ts_add_diff(&stop_time, MSEC2NSEC(params->min_duration));
-	getuptime(&final_time);
+	getuptime(&start_time);
+	test->stop_time = start_time;
+	ts_add_diff(&test->stop_time, MSEC2NSEC(params->min_duration));
 
-	while (!ts_gt(&final_time, &stop_time)) {
-		++transfer_count;
+	fibril_mutex_lock(&test->lock);
 
-		// Write buffer to device.
-		if ((rc = usb_pipe_write_dma(pipe, buffer, buffer, size))) {
-			usb_log_error("Write to %s OUT endpoint failed with error: %s", usb_str_transfer_type(pipe->desc.transfer_type), str_error(rc));
+	for (i = 0; i < depth; i++) {
+		fid = fibril_create(stream_worker, test);
+		if (fid == 0)
 			break;
-		}
 
-		getuptime(&final_time);
+		test->workers++;
+		fibril_add_ready(fid);
 	}
 
-	usbdiag_dur_t in_duration = NSEC2MSEC(final_time.tv_nsec - start_time.tv_nsec) +
-	    SEC2MSEC(final_time.tv_sec - start_time.tv_sec);
+	if (test->workers == 0) {
+		fibril_mutex_unlock(&test->lock);
+		free(test);
+		return ENOMEM;
+	}
 
-	usb_log_info("Test on %s OUT endpoint completed in %ld ms.", usb_str_transfer_type(pipe->desc.transfer_type), in_duration);
+	while (test->workers > 0)
+		fibril_condvar_wait(&test->done_cv, &test->lock);
 
-	results->act_duration = in_duration;
-	results->transfer_count = transfer_count;
-	results->transfer_size = size;
+	rc = test->rc;
+	fibril_mutex_unlock(&test->lock);
+
+	getuptime(&final_time);
+	duration = NSEC2MSEC(ts_sub_diff(&final_time, &start_time));
 
-	usb_pipe_free_buffer(pipe, buffer);
+	results->act_duration = duration;
+	results->transfer_count = test->transfer_count;
+	results->transfer_size = size;
+	results->throughput = duration > 0 ?
+	    (uint64_t) test->transfer_count * size * 1000 / duration : 0;
+
+	qsort(test->lat.sample, test->lat.nsamples, sizeof(uint32_t), lat_cmp);
+	results->lat_min = test->lat.nsamples > 0 ? test->lat.sample[0] : 0;
+	results->lat_max = test->lat.nsamples > 0 ?
+	    test->lat.sample[test->lat.nsamples - 1] : 0;
+	results->lat_p50 = lat_percentile(&test->lat, 50);
+	results->lat_p95 = lat_percentile(&test->lat, 95);
+	results->lat_p99 = lat_percentile(&test->lat, 99);
+
+	usb_log_info("Test on %s %s endpoint completed in %lu ms: "
+	    "%u transfers, %" PRIu64 " B/s, latency %u/%u/%u us (p50/p95/p99).",
+	    usb_str_transfer_type(pipe->desc.transfer_type),
+	    dir == USB_DIRECTION_IN ? "IN" : "OUT", duration,
+	    test->transfer_count, results->throughput,
+	    results->lat_p50, results->lat_p95, results->lat_p99);
+
+	free(test);
 
 	return rc;
 }
@@ -224,7 +383,7 @@ errno_t usbdiag_dev_test_in(ddf_fun_t *fun, const usbdiag_test_params_t *params,
 		return ENOTSUP;
 	}
 
-	return test_in(pipe, params, results);
+	return stream_test(pipe, params, USB_DIRECTION_IN, results);
 }
 
 errno_t usbdiag_dev_test_out(ddf_fun_t *fun, const usbdiag_test_params_t *params, usbdiag_test_results_t *results)
@@ -249,7 +408,7 @@ errno_t usbdiag_dev_test_out(ddf_fun_t *fun, const usbdiag_test_params_t *params
 		return ENOTSUP;
 	}
 
-	return test_out(pipe, params, results);
+	return stream_test(pipe, params, USB_DIRECTION_OUT, results);
 }
 
 /**
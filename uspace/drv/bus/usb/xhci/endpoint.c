@@ -135,6 +135,9 @@ static errno_t xhci_endpoint_init(xhci_endpoint_t *xhci_ep, device_t *dev,
 	/* But actualy can do full scatter-gather. */
 	ep->required_transfer_buffer_policy = dma_policy_create(flags, PAGE_SIZE);
 
+	/* And transfers do not have to start at the buffer beginning */
+	ep->transfer_offset_supported = true;
+
 	return EOK;
 
 err:
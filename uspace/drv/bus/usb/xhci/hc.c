@@ -46,6 +46,16 @@
 #include "transfers.h"
 #include "trb_ring.h"
 
+/**
+ * Interrupt moderation interval in 250 ns increments. With 40 us, the
+ * interrupter fires at most 25000 times per second, coalescing events
+ * of bursty endpoints into fewer interrupts.
+ */
+#define XHCI_INTR_MODERATION_INTERVAL  160
+
+/** Maximum number of events drained from the event ring in one go. */
+#define XHCI_EVENT_BATCH_MAX  32
+
 /**
  * Default USB Speed ID mapping: Table 157
  */
@@ -489,6 +499,7 @@ errno_t hc_start(xhci_hc_t *hc)
 	xhci_interrupter_regs_t *intr0 = &hc->rt_regs->ir[0];
 	XHCI_REG_WR(intr0, XHCI_INTR_ERSTSZ, hc->event_ring.segment_count);
 	XHCI_REG_WR(intr0, XHCI_INTR_ERDP, hc->event_ring.dequeue_ptr);
+	XHCI_REG_WR(intr0, XHCI_INTR_IMI, XHCI_INTR_MODERATION_INTERVAL);
 
 	const uintptr_t erstba_phys = dma_buffer_phys_base(&hc->event_ring.erst);
 	XHCI_REG_WR(intr0, XHCI_INTR_ERSTBA, erstba_phys);
@@ -660,19 +671,44 @@ static void hc_run_event_ring(xhci_hc_t *hc, xhci_event_ring_t *event_ring,
 {
 	errno_t err;
 
-	xhci_trb_t trb;
+	xhci_trb_t trbs[XHCI_EVENT_BATCH_MAX];
+	size_t ntrbs, ndeferred, i;
 	hc->event_handler = fibril_get_id();
 
-	while ((err = xhci_event_ring_dequeue(event_ring, &trb)) != ENOENT) {
-		if ((err = hc_handle_event(hc, &trb)) != EOK) {
-			usb_log_error("Failed to handle event in interrupt: %s", str_error(err));
+	do {
+		/* Drain a batch of pending events from the hardware ring */
+		ntrbs = 0;
+		while (ntrbs < XHCI_EVENT_BATCH_MAX &&
+		    xhci_event_ring_dequeue(event_ring, &trbs[ntrbs]) != ENOENT)
+			++ntrbs;
+
+		/*
+		 * Handle fast events right away and compact the events
+		 * deferred to the event worker fibril to the beginning of
+		 * the batch, so they can be handed over in one go.
+		 */
+		ndeferred = 0;
+		for (i = 0; i < ntrbs; i++) {
+			const unsigned type = TRB_TYPE(trbs[i]);
+
+			if (type < ARRAY_SIZE(event_handlers) &&
+			    event_handlers[type]) {
+				trbs[ndeferred++] = trbs[i];
+				continue;
+			}
+
+			if ((err = hc_handle_event(hc, &trbs[i])) != EOK) {
+				usb_log_error("Failed to handle event in interrupt: %s", str_error(err));
+			}
 		}
 
-		XHCI_REG_WR(intr, XHCI_INTR_ERDP, hc->event_ring.dequeue_ptr);
-	}
+		if (ndeferred > 0)
+			xhci_sw_ring_enqueue_batch(&hc->sw_ring, trbs, ndeferred);
+	} while (ntrbs == XHCI_EVENT_BATCH_MAX);
 
 	hc->event_handler = 0;
 
+	/* Update ERDP once per pass, clearing the Event Handler Busy flag */
 	uint64_t erdp = hc->event_ring.dequeue_ptr;
 	erdp |= XHCI_REG_MASK(XHCI_INTR_ERDP_EHB);
 	XHCI_REG_WR(intr, XHCI_INTR_ERDP, erdp);
@@ -472,6 +472,33 @@ errno_t xhci_sw_ring_enqueue(xhci_sw_ring_t *ring, xhci_trb_t *trb)
 	return ring->running ? EOK : EINTR;
 }
 
+errno_t xhci_sw_ring_enqueue_batch(xhci_sw_ring_t *ring, xhci_trb_t *trbs,
+    size_t count)
+{
+	size_t i;
+
+	assert(ring);
+	assert(trbs);
+
+	fibril_mutex_lock(&ring->guard);
+	for (i = 0; i < count; i++) {
+		while (ring->running && TRB_CYCLE(*ring->enqueue))
+			fibril_condvar_wait(&ring->dequeued_cv, &ring->guard);
+
+		if (!ring->running)
+			break;
+
+		*ring->enqueue = trbs[i];
+		TRB_SET_CYCLE(*ring->enqueue, 1);
+		if (++ring->enqueue == ring->end)
+			ring->enqueue = ring->begin;
+	}
+	fibril_condvar_signal(&ring->enqueued_cv);
+	fibril_mutex_unlock(&ring->guard);
+
+	return ring->running ? EOK : EINTR;
+}
+
 errno_t xhci_sw_ring_dequeue(xhci_sw_ring_t *ring, xhci_trb_t *trb)
 {
 	assert(ring);
@@ -131,8 +131,10 @@ typedef struct xhci_sw_ring {
 
 extern void xhci_sw_ring_init(xhci_sw_ring_t *, size_t);
 
-/* Both may block if the ring is full/empty. */
+/* All may block if the ring is full/empty. */
 extern errno_t xhci_sw_ring_enqueue(xhci_sw_ring_t *, xhci_trb_t *);
+extern errno_t xhci_sw_ring_enqueue_batch(xhci_sw_ring_t *, xhci_trb_t *,
+    size_t);
 extern errno_t xhci_sw_ring_dequeue(xhci_sw_ring_t *, xhci_trb_t *);
 
 extern void xhci_sw_ring_restart(xhci_sw_ring_t *);
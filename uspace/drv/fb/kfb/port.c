@@ -46,6 +46,7 @@
 #include <ddi.h>
 #include <ddf/log.h>
 #include <errno.h>
+#include <fibril_synch.h>
 #include <gfx/bitmap.h>
 #include <gfx/color.h>
 #include <gfx/coord.h>
@@ -62,6 +63,12 @@
 #include "port.h"
 
 #define FB_POS(fb, x, y)  ((y) * (fb)->scanline + (x) * (fb)->pixel_bytes)
+#define SHADOW_POS(fb, x, y)  ((fb)->shadow + (y) * (fb)->rect.p1.x + (x))
+
+enum {
+	/** Interval between framebuffer flushes (microseconds) */
+	kfb_flush_period_usec = 20000
+};
 
 typedef struct {
 	ddf_fun_t *fun;
@@ -74,6 +81,7 @@ typedef struct {
 	visual_t visual;
 
 	pixel2visual_t pixel2visual;
+	pixel2visual_row_t pixel2visual_row;
 	visual2pixel_t visual2pixel;
 	visual_mask_t visual_mask;
 	size_t pixel_bytes;
@@ -81,6 +89,18 @@ typedef struct {
 	size_t size;
 	uint8_t *addr;
 
+	/** Protects the shadow buffer and the flush state */
+	fibril_mutex_t lock;
+
+	/** Scene in pixel_t format, flushed to the framebuffer in batches */
+	pixel_t *shadow;
+
+	/** Rectangle modified since the last flush */
+	gfx_rect_t flush_rect;
+
+	/** Flush timer */
+	fibril_timer_t *flush_timer;
+
 	/** Current drawing color */
 	pixel_t color;
 } kfb_t;
@@ -92,6 +112,10 @@ typedef struct {
 	gfx_bitmap_flags_t flags;
 	pixel_t key_color;
 	bool myalloc;
+	/** Pixels are a shared memory area allocated by us */
+	bool shalloc;
+	/** Pixels alias the framebuffer; rendering is implicit */
+	bool fbdirect;
 } kfb_bitmap_t;
 
 static errno_t kfb_ddev_get_gc(void *, sysarg_t *, sysarg_t *);
@@ -139,6 +163,65 @@ static errno_t kfb_ddev_get_info(void *arg, ddev_info_t *info)
 	return EOK;
 }
 
+/** Flush the accumulated dirty rectangle to the framebuffer.
+ *
+ * Convert the modified part of the shadow buffer to the framebuffer
+ * in whole scanline runs. The drawing operations themselves only touch
+ * the (cached) shadow buffer, so they do not block on the latency of
+ * uncached framebuffer memory. Also serves as the flush timer handler.
+ *
+ * @param arg KFB
+ */
+static void kfb_flush(void *arg)
+{
+	kfb_t *kfb = (kfb_t *) arg;
+	gfx_rect_t rect;
+	gfx_coord_t y;
+
+	fibril_mutex_lock(&kfb->lock);
+
+	rect = kfb->flush_rect;
+	kfb->flush_rect.p0.x = 0;
+	kfb->flush_rect.p0.y = 0;
+	kfb->flush_rect.p1.x = 0;
+	kfb->flush_rect.p1.y = 0;
+
+	if (kfb->addr == AS_AREA_ANY || gfx_rect_is_empty(&rect)) {
+		fibril_mutex_unlock(&kfb->lock);
+		return;
+	}
+
+	for (y = rect.p0.y; y < rect.p1.y; y++) {
+		kfb->pixel2visual_row(kfb->addr + FB_POS(kfb, rect.p0.x, y),
+		    SHADOW_POS(kfb, rect.p0.x, y), rect.p1.x - rect.p0.x);
+	}
+
+	fibril_mutex_unlock(&kfb->lock);
+}
+
+/** Add a rectangle to the area pending a flush.
+ *
+ * Must be called with the KFB lock held. Arms the flush timer when the
+ * pending area becomes non-empty, so that modifications are written to
+ * the framebuffer in batches instead of one by one.
+ *
+ * @param kfb KFB
+ * @param rect Modified rectangle (sorted and clipped)
+ */
+static void kfb_mark_dirty(kfb_t *kfb, gfx_rect_t *rect)
+{
+	gfx_rect_t env;
+
+	if (gfx_rect_is_empty(&kfb->flush_rect)) {
+		kfb->flush_rect = *rect;
+		fibril_timer_set(kfb->flush_timer, kfb_flush_period_usec,
+		    kfb_flush, (void *) kfb);
+	} else {
+		gfx_rect_envelope(&kfb->flush_rect, rect, &env);
+		kfb->flush_rect = env;
+	}
+}
+
 /** Set clipping rectangle on KFB.
  *
  * @param arg KFB
@@ -189,17 +272,121 @@ static errno_t kfb_gc_fill_rect(void *arg, gfx_rect_t *rect)
 	kfb_t *kfb = (kfb_t *) arg;
 	gfx_rect_t crect;
 	gfx_coord_t x, y;
+	size_t rowsize;
+	pixel_t *frow;
+	pixel_t *dst;
 
 	/* Make sure we have a sorted, clipped rectangle */
 	gfx_rect_clip(rect, &kfb->rect, &crect);
 
-	for (y = crect.p0.y; y < crect.p1.y; y++) {
-		for (x = crect.p0.x; x < crect.p1.x; x++) {
-			kfb->pixel2visual(kfb->addr + FB_POS(kfb, x, y),
-			    kfb->color);
+	if (crect.p1.x <= crect.p0.x || crect.p1.y <= crect.p0.y)
+		return EOK;
+
+	fibril_mutex_lock(&kfb->lock);
+
+	/* Fill the first scanline pixel by pixel */
+	frow = SHADOW_POS(kfb, crect.p0.x, crect.p0.y);
+	dst = frow;
+	for (x = crect.p0.x; x < crect.p1.x; x++)
+		*dst++ = kfb->color;
+
+	/* Replicate it into the remaining scanlines */
+	rowsize = (crect.p1.x - crect.p0.x) * sizeof(pixel_t);
+	for (y = crect.p0.y + 1; y < crect.p1.y; y++)
+		memcpy(SHADOW_POS(kfb, crect.p0.x, y), frow, rowsize);
+
+	kfb_mark_dirty(kfb, &crect);
+	fibril_mutex_unlock(&kfb->lock);
+
+	return EOK;
+}
+
+/** Determine if the framebuffer itself can back a direct output bitmap.
+ *
+ * Direct output bitmap pixels are in pixel_t format. The framebuffer can
+ * only be handed out directly if its visual has the same byte layout as
+ * pixel_t (the unused pad byte absorbs the alpha channel), the bitmap
+ * covers the entire framebuffer and the scanlines are packed.
+ *
+ * @param kfb KFB
+ * @param params Bitmap params
+ * @return @c true iff the bitmap can alias the framebuffer
+ */
+static bool kfb_gc_fb_aliasable(kfb_t *kfb, gfx_bitmap_params_t *params)
+{
+	gfx_coord2_t dim;
+
+#ifdef __LE__
+	if (kfb->visual != VISUAL_BGR_8_8_8_0)
+		return false;
+#else
+	if (kfb->visual != VISUAL_RGB_0_8_8_8)
+		return false;
+#endif
+
+	/* Bitmap must cover the entire framebuffer */
+	if (params->rect.p0.x != kfb->rect.p0.x ||
+	    params->rect.p0.y != kfb->rect.p0.y ||
+	    params->rect.p1.x != kfb->rect.p1.x ||
+	    params->rect.p1.y != kfb->rect.p1.y)
+		return false;
+
+	/* No padding at the end of scanlines */
+	gfx_coord2_subtract(&kfb->rect.p1, &kfb->rect.p0, &dim);
+	return kfb->scanline == dim.x * sizeof(uint32_t);
+}
+
+/** Create direct output bitmap in KFB GC.
+ *
+ * The returned pixels either alias the framebuffer itself (in which case
+ * rendering is implicit) or a shadow buffer that is converted to the
+ * framebuffer when the bitmap is rendered. Either way the pixels lie in
+ * a memory area that can be shared with the client, so the client can
+ * compose the scene itself and only ask us to flush the dirty rectangles.
+ *
+ * @param kfb KFB
+ * @param params Bitmap params
+ * @param rbm Place to store pointer to new bitmap
+ * @return EOK on success or an error code
+ */
+static errno_t kfb_gc_bitmap_create_direct(kfb_t *kfb,
+    gfx_bitmap_params_t *params, void **rbm)
+{
+	kfb_bitmap_t *kfbbm;
+	gfx_coord2_t dim;
+
+	kfbbm = calloc(1, sizeof(kfb_bitmap_t));
+	if (kfbbm == NULL)
+		return ENOMEM;
+
+	gfx_coord2_subtract(&params->rect.p1, &params->rect.p0, &dim);
+	kfbbm->rect = params->rect;
+	kfbbm->flags = params->flags;
+	kfbbm->key_color = params->key_color;
+
+	if (kfb_gc_fb_aliasable(kfb, params)) {
+		/* Hand out the framebuffer itself */
+		kfbbm->alloc.pitch = kfb->scanline;
+		kfbbm->alloc.off0 = 0;
+		kfbbm->alloc.pixels = kfb->addr;
+		kfbbm->fbdirect = true;
+	} else {
+		/* Shadow buffer in a sharable memory area */
+		kfbbm->alloc.pitch = dim.x * sizeof(uint32_t);
+		kfbbm->alloc.off0 = 0;
+		kfbbm->alloc.pixels = as_area_create(AS_AREA_ANY,
+		    dim.x * dim.y * sizeof(uint32_t), AS_AREA_READ |
+		    AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+		if (kfbbm->alloc.pixels == AS_MAP_FAILED) {
+			free(kfbbm);
+			return ENOMEM;
 		}
+
+		kfbbm->shalloc = true;
 	}
 
+	kfbbm->kfb = kfb;
+	*rbm = (void *)kfbbm;
 	return EOK;
 }
 
@@ -219,6 +406,18 @@ errno_t kfb_gc_bitmap_create(void *arg, gfx_bitmap_params_t *params,
 	gfx_coord2_t dim;
 	errno_t rc;
 
+	if ((params->flags & bmpf_direct_output) != 0) {
+		/* Cannot combine direct output with other flags */
+		if ((params->flags & ~bmpf_direct_output) != 0)
+			return ENOTSUP;
+
+		/* We allocate the pixels of a direct output bitmap */
+		if (alloc != NULL)
+			return EINVAL;
+
+		return kfb_gc_bitmap_create_direct(kfb, params, rbm);
+	}
+
 	/* Check that we support all required flags */
 	if ((params->flags & ~(bmpf_color_key | bmpf_colorize)) != 0)
 		return ENOTSUP;
@@ -263,7 +462,9 @@ error:
 static errno_t kfb_gc_bitmap_destroy(void *bm)
 {
 	kfb_bitmap_t *kfbbm = (kfb_bitmap_t *)bm;
-	if (kfbbm->myalloc)
+	if (kfbbm->shalloc)
+		as_area_destroy(kfbbm->alloc.pixels);
+	else if (kfbbm->myalloc)
 		free(kfbbm->alloc.pixels);
 	free(kfbbm);
 	return EOK;
@@ -288,12 +489,16 @@ static errno_t kfb_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	gfx_coord2_t offs;
 	gfx_coord2_t bmdim;
 	gfx_coord2_t dim;
-	gfx_coord2_t sp;
-	gfx_coord2_t dp;
 	gfx_coord2_t pos;
 	pixelmap_t pbm;
+	pixel_t *srow;
+	pixel_t *dst;
 	pixel_t color;
 
+	/* Framebuffer-backed bitmap: the pixels are already on the screen */
+	if (kfbbm->fbdirect)
+		return EOK;
+
 	/* Clip source rectangle to bitmap bounds */
 
 	if (srect0 != NULL)
@@ -326,46 +531,45 @@ static errno_t kfb_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	 */
 	gfx_rect_clip(&srect, &skfbrect, &crect);
 
+	fibril_mutex_lock(&kfb->lock);
+
 	if ((kfbbm->flags & bmpf_color_key) != 0) {
-		/* Simple copy */
-		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
-			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
-				gfx_coord2_subtract(&pos, &kfbbm->rect.p0, &sp);
-				gfx_coord2_add(&pos, &offs, &dp);
-
-				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
-				if (color != kfbbm->key_color) {
-					kfb->pixel2visual(kfb->addr +
-					    FB_POS(kfb, dp.x, dp.y), color);
-				}
-			}
-		}
-	} else if ((kfbbm->flags & bmpf_colorize) != 0) {
 		/* Color key */
 		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
+			srow = pixelmap_pixel_at(&pbm,
+			    crect.p0.x - kfbbm->rect.p0.x,
+			    pos.y - kfbbm->rect.p0.y);
+			dst = SHADOW_POS(kfb, crect.p0.x + offs.x,
+			    pos.y + offs.y);
+			if (srow == NULL)
+				continue;
 			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
-				gfx_coord2_subtract(&pos, &kfbbm->rect.p0, &sp);
-				gfx_coord2_add(&pos, &offs, &dp);
-
-				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
-				kfb->pixel2visual(kfb->addr +
-				    FB_POS(kfb, dp.x, dp.y), color);
+				color = *srow++;
+				if (color != kfbbm->key_color)
+					*dst = color;
+				dst++;
 			}
 		}
 	} else {
-		/* Color key & colorize */
+		/* Simple copy - whole scanlines at once */
 		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
-			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
-				gfx_coord2_subtract(&pos, &kfbbm->rect.p0, &sp);
-				gfx_coord2_add(&pos, &offs, &dp);
-
-				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
-				kfb->pixel2visual(kfb->addr +
-				    FB_POS(kfb, dp.x, dp.y), color);
-			}
+			srow = pixelmap_pixel_at(&pbm,
+			    crect.p0.x - kfbbm->rect.p0.x,
+			    pos.y - kfbbm->rect.p0.y);
+			if (srow == NULL)
+				continue;
+			memcpy(SHADOW_POS(kfb, crect.p0.x + offs.x,
+			    pos.y + offs.y), srow,
+			    (crect.p1.x - crect.p0.x) * sizeof(pixel_t));
 		}
 	}
 
+	/* Rectangle modified on the screen */
+	gfx_rect_translate(&offs, &crect, &drect);
+	kfb_mark_dirty(kfb, &drect);
+
+	fibril_mutex_unlock(&kfb->lock);
+
 	return EOK;
 }
 
@@ -388,6 +592,7 @@ static void kfb_client_conn(ipc_call_t *icall, void *arg)
 	ddev_srv_t srv;
 	sysarg_t gc_id;
 	gfx_context_t *gc;
+	gfx_coord_t x, y;
 	errno_t rc;
 
 	kfb = (kfb_t *) ddf_fun_data_get((ddf_fun_t *) arg);
@@ -417,6 +622,21 @@ static void kfb_client_conn(ipc_call_t *icall, void *arg)
 		if (rc != EOK)
 			goto error;
 
+		kfb->shadow = malloc(kfb->rect.p1.x * kfb->rect.p1.y *
+		    sizeof(pixel_t));
+		if (kfb->shadow == NULL) {
+			rc = ENOMEM;
+			goto error;
+		}
+
+		/* Seed the shadow buffer with the current screen contents */
+		for (y = 0; y < kfb->rect.p1.y; y++) {
+			for (x = 0; x < kfb->rect.p1.x; x++) {
+				*SHADOW_POS(kfb, x, y) = kfb->visual2pixel(
+				    kfb->addr + FB_POS(kfb, x, y));
+			}
+		}
+
 		rc = gfx_context_new(&kfb_gc_ops, kfb, &gc);
 		if (rc != EOK)
 			goto error;
@@ -424,6 +644,11 @@ static void kfb_client_conn(ipc_call_t *icall, void *arg)
 		/* GC connection */
 		gc_conn(icall, gc);
 
+		(void) fibril_timer_clear(kfb->flush_timer);
+
+		free(kfb->shadow);
+		kfb->shadow = NULL;
+
 		rc = physmem_unmap(kfb->addr);
 		if (rc == EOK)
 			kfb->addr = AS_AREA_ANY;
@@ -431,6 +656,11 @@ static void kfb_client_conn(ipc_call_t *icall, void *arg)
 
 	return;
 error:
+	if (kfb->shadow != NULL) {
+		free(kfb->shadow);
+		kfb->shadow = NULL;
+	}
+
 	if (kfb->addr != AS_AREA_ANY) {
 		if (physmem_unmap(kfb->addr) == EOK)
 			kfb->addr = AS_AREA_ANY;
@@ -526,66 +756,77 @@ errno_t port_init(ddf_dev_t *dev)
 	switch (visual) {
 	case VISUAL_INDIRECT_8:
 		kfb->pixel2visual = pixel2bgr_323;
+		kfb->pixel2visual_row = pixel2bgr_323_row;
 		kfb->visual2pixel = bgr_323_2pixel;
 		kfb->visual_mask = visual_mask_323;
 		kfb->pixel_bytes = 1;
 		break;
 	case VISUAL_RGB_5_5_5_LE:
 		kfb->pixel2visual = pixel2rgb_555_le;
+		kfb->pixel2visual_row = pixel2rgb_555_le_row;
 		kfb->visual2pixel = rgb_555_le_2pixel;
 		kfb->visual_mask = visual_mask_555;
 		kfb->pixel_bytes = 2;
 		break;
 	case VISUAL_RGB_5_5_5_BE:
 		kfb->pixel2visual = pixel2rgb_555_be;
+		kfb->pixel2visual_row = pixel2rgb_555_be_row;
 		kfb->visual2pixel = rgb_555_be_2pixel;
 		kfb->visual_mask = visual_mask_555;
 		kfb->pixel_bytes = 2;
 		break;
 	case VISUAL_RGB_5_6_5_LE:
 		kfb->pixel2visual = pixel2rgb_565_le;
+		kfb->pixel2visual_row = pixel2rgb_565_le_row;
 		kfb->visual2pixel = rgb_565_le_2pixel;
 		kfb->visual_mask = visual_mask_565;
 		kfb->pixel_bytes = 2;
 		break;
 	case VISUAL_RGB_5_6_5_BE:
 		kfb->pixel2visual = pixel2rgb_565_be;
+		kfb->pixel2visual_row = pixel2rgb_565_be_row;
 		kfb->visual2pixel = rgb_565_be_2pixel;
 		kfb->visual_mask = visual_mask_565;
 		kfb->pixel_bytes = 2;
 		break;
 	case VISUAL_RGB_8_8_8:
 		kfb->pixel2visual = pixel2rgb_888;
+		kfb->pixel2visual_row = pixel2rgb_888_row;
 		kfb->visual2pixel = rgb_888_2pixel;
 		kfb->visual_mask = visual_mask_888;
 		kfb->pixel_bytes = 3;
 		break;
 	case VISUAL_BGR_8_8_8:
 		kfb->pixel2visual = pixel2bgr_888;
+		kfb->pixel2visual_row = pixel2bgr_888_row;
 		kfb->visual2pixel = bgr_888_2pixel;
 		kfb->visual_mask = visual_mask_888;
 		kfb->pixel_bytes = 3;
 		break;
 	case VISUAL_RGB_8_8_8_0:
 		kfb->pixel2visual = pixel2rgb_8880;
+		kfb->pixel2visual_row = pixel2rgb_8880_row;
 		kfb->visual2pixel = rgb_8880_2pixel;
 		kfb->visual_mask = visual_mask_8880;
 		kfb->pixel_bytes = 4;
 		break;
 	case VISUAL_RGB_0_8_8_8:
 		kfb->pixel2visual = pixel2rgb_0888;
+		kfb->pixel2visual_row = pixel2rgb_0888_row;
 		kfb->visual2pixel = rgb_0888_2pixel;
 		kfb->visual_mask = visual_mask_0888;
 		kfb->pixel_bytes = 4;
 		break;
 	case VISUAL_BGR_0_8_8_8:
 		kfb->pixel2visual = pixel2bgr_0888;
+		kfb->pixel2visual_row = pixel2bgr_0888_row;
 		kfb->visual2pixel = bgr_0888_2pixel;
 		kfb->visual_mask = visual_mask_0888;
 		kfb->pixel_bytes = 4;
 		break;
 	case VISUAL_BGR_8_8_8_0:
 		kfb->pixel2visual = pixel2bgr_8880;
+		kfb->pixel2visual_row = pixel2bgr_8880_row;
 		kfb->visual2pixel = bgr_8880_2pixel;
 		kfb->visual_mask = visual_mask_8880;
 		kfb->pixel_bytes = 4;
@@ -597,6 +838,14 @@ errno_t port_init(ddf_dev_t *dev)
 	kfb->size = scanline * height;
 	kfb->addr = AS_AREA_ANY;
 
+	fibril_mutex_initialize(&kfb->lock);
+
+	kfb->flush_timer = fibril_timer_create(NULL);
+	if (kfb->flush_timer == NULL) {
+		rc = ENOMEM;
+		goto error;
+	}
+
 	rc = ddf_fun_bind(fun);
 	if (rc != EOK)
 		goto error;
@@ -609,6 +858,8 @@ errno_t port_init(ddf_dev_t *dev)
 
 	return EOK;
 error:
+	if (kfb != NULL && kfb->flush_timer != NULL)
+		fibril_timer_destroy(kfb->flush_timer);
 	if (fun != NULL)
 		ddf_fun_destroy(fun);
 	return rc;
@@ -142,22 +142,30 @@ static void default_connection_handler(ddf_fun_t *fun, ipc_call_t *icall)
 	}
 }
 
-static const usb_hid_report_field_t *get_mouse_axis_move_field(uint8_t rid, usb_hid_report_t *report,
-    int32_t usage)
+/** Build a usage path for looking up one of the axis fields. */
+static usb_hid_report_path_t *create_axis_path(int32_t usage)
 {
 	usb_hid_report_path_t *path = usb_hid_report_path();
-	usb_hid_report_path_append_item(path, USB_HIDUT_PAGE_GENERIC_DESKTOP,
-	    usage);
+	if (path == NULL)
+		return NULL;
+
+	if (usb_hid_report_path_append_item(path,
+	    USB_HIDUT_PAGE_GENERIC_DESKTOP, usage) != EOK) {
+		usb_hid_report_path_free(path);
+		return NULL;
+	}
+
+	return path;
+}
 
+static const usb_hid_report_field_t *get_mouse_axis_move_field(uint8_t rid, usb_hid_report_t *report,
+    usb_hid_report_path_t *path)
+{
 	usb_hid_report_path_set_report_id(path, rid);
 
-	const usb_hid_report_field_t *field = usb_hid_report_get_sibling(
+	return usb_hid_report_get_sibling(
 	    report, NULL, path, USB_HID_PATH_COMPARE_END,
 	    USB_HID_REPORT_TYPE_INPUT);
-
-	usb_hid_report_path_free(path);
-
-	return field;
 }
 
 static void usb_mouse_process_report(usb_hid_dev_t *hid_dev,
@@ -171,14 +179,11 @@ static void usb_mouse_process_report(usb_hid_dev_t *hid_dev,
 	}
 
 	const usb_hid_report_field_t *move_x = get_mouse_axis_move_field(
-	    hid_dev->report_id, &hid_dev->report,
-	    USB_HIDUT_USAGE_GENERIC_DESKTOP_X);
+	    hid_dev->report_id, &hid_dev->report, mouse_dev->path_x);
 	const usb_hid_report_field_t *move_y = get_mouse_axis_move_field(
-	    hid_dev->report_id, &hid_dev->report,
-	    USB_HIDUT_USAGE_GENERIC_DESKTOP_Y);
+	    hid_dev->report_id, &hid_dev->report, mouse_dev->path_y);
 	const usb_hid_report_field_t *wheel = get_mouse_axis_move_field(
-	    hid_dev->report_id, &hid_dev->report,
-	    USB_HIDUT_USAGE_GENERIC_DESKTOP_WHEEL);
+	    hid_dev->report_id, &hid_dev->report, mouse_dev->path_wheel);
 
 	bool absolute_x = move_x && !USB_HID_ITEM_FLAG_RELATIVE(move_x->item_flags);
 	bool absolute_y = move_y && !USB_HID_ITEM_FLAG_RELATIVE(move_y->item_flags);
@@ -194,12 +199,16 @@ static void usb_mouse_process_report(usb_hid_dev_t *hid_dev,
 	int shift_z =  wheel ?  wheel->value : 0;
 
 	if (absolute_x && absolute_y) {
-		async_exch_t *exch =
-		    async_exchange_begin(mouse_dev->mouse_sess);
-		if (exch != NULL) {
-			async_msg_4(exch, MOUSEEV_ABS_MOVE_EVENT,
-			    shift_x, shift_y, move_x->logical_maximum, move_y->logical_maximum);
-			async_exchange_end(exch);
+		/* Report a position only when it actually changed */
+		if (move_x->changed || move_y->changed) {
+			async_exch_t *exch =
+			    async_exchange_begin(mouse_dev->mouse_sess);
+			if (exch != NULL) {
+				async_msg_4(exch, MOUSEEV_ABS_MOVE_EVENT,
+				    shift_x, shift_y, move_x->logical_maximum,
+				    move_y->logical_maximum);
+				async_exchange_end(exch);
+			}
 		}
 
 		// Even if we move the mouse absolutely, we need to resolve wheel
@@ -217,18 +226,7 @@ static void usb_mouse_process_report(usb_hid_dev_t *hid_dev,
 	}
 
 	/* Buttons */
-	usb_hid_report_path_t *path = usb_hid_report_path();
-	if (path == NULL) {
-		usb_log_warning("Failed to create USB HID report path.");
-		return;
-	}
-	errno_t ret =
-	    usb_hid_report_path_append_item(path, USB_HIDUT_PAGE_BUTTON, 0);
-	if (ret != EOK) {
-		usb_hid_report_path_free(path);
-		usb_log_warning("Failed to add buttons to report path.");
-		return;
-	}
+	usb_hid_report_path_t *path = mouse_dev->path_buttons;
 	usb_hid_report_path_set_report_id(path, hid_dev->report_id);
 
 	usb_hid_report_field_t *field = usb_hid_report_get_sibling(
@@ -258,8 +256,6 @@ static void usb_mouse_process_report(usb_hid_dev_t *hid_dev,
 		    USB_HID_PATH_COMPARE_USAGE_PAGE_ONLY,
 		    USB_HID_REPORT_TYPE_INPUT);
 	}
-
-	usb_hid_report_path_free(path);
 }
 
 #define FUN_UNBIND_DESTROY(fun) \
@@ -312,6 +308,19 @@ static size_t usb_mouse_get_highest_button(usb_hid_report_t *report, uint8_t rep
 	return highest_button;
 }
 
+static void mouse_dev_paths_free(usb_mouse_t *mouse_dev)
+{
+	usb_hid_report_path_free(mouse_dev->path_x);
+	usb_hid_report_path_free(mouse_dev->path_y);
+	usb_hid_report_path_free(mouse_dev->path_wheel);
+	usb_hid_report_path_free(mouse_dev->path_buttons);
+
+	mouse_dev->path_x = NULL;
+	mouse_dev->path_y = NULL;
+	mouse_dev->path_wheel = NULL;
+	mouse_dev->path_buttons = NULL;
+}
+
 static errno_t mouse_dev_init(usb_mouse_t *mouse_dev, usb_hid_dev_t *hid_dev)
 {
 	// FIXME: This may not be optimal since stupid hardware vendor may
@@ -330,6 +339,32 @@ static errno_t mouse_dev_init(usb_mouse_t *mouse_dev, usb_hid_dev_t *hid_dev)
 		return ENOMEM;
 	}
 
+	/* Build the field lookup paths once instead of on every report */
+	mouse_dev->path_x = create_axis_path(
+	    USB_HIDUT_USAGE_GENERIC_DESKTOP_X);
+	mouse_dev->path_y = create_axis_path(
+	    USB_HIDUT_USAGE_GENERIC_DESKTOP_Y);
+	mouse_dev->path_wheel = create_axis_path(
+	    USB_HIDUT_USAGE_GENERIC_DESKTOP_WHEEL);
+
+	mouse_dev->path_buttons = usb_hid_report_path();
+	if (mouse_dev->path_buttons != NULL &&
+	    usb_hid_report_path_append_item(mouse_dev->path_buttons,
+	    USB_HIDUT_PAGE_BUTTON, 0) != EOK) {
+		usb_hid_report_path_free(mouse_dev->path_buttons);
+		mouse_dev->path_buttons = NULL;
+	}
+
+	if (mouse_dev->path_x == NULL || mouse_dev->path_y == NULL ||
+	    mouse_dev->path_wheel == NULL ||
+	    mouse_dev->path_buttons == NULL) {
+		usb_log_error(NAME ": out of memory, giving up on device!");
+		mouse_dev_paths_free(mouse_dev);
+		free(mouse_dev->buttons);
+		free(mouse_dev);
+		return ENOMEM;
+	}
+
 	// TODO: how to know if the device supports the request???
 	usbhid_req_set_idle(usb_device_get_default_pipe(hid_dev->usb_dev),
 	    usb_device_get_iface_number(hid_dev->usb_dev), IDLE_RATE);
@@ -423,6 +458,7 @@ void usb_mouse_deinit(usb_hid_dev_t *hid_dev, void *data)
 	if (mouse_dev->mouse_sess != NULL)
 		async_hangup(mouse_dev->mouse_sess);
 
+	mouse_dev_paths_free(mouse_dev);
 	free(mouse_dev->buttons);
 	FUN_UNBIND_DESTROY(mouse_dev->mouse_fun);
 }
@@ -49,6 +49,12 @@ typedef struct {
 	int32_t *buttons;
 	size_t buttons_count;
 
+	/** Prebuilt usage paths for per-report field lookups. */
+	usb_hid_report_path_t *path_x;
+	usb_hid_report_path_t *path_y;
+	usb_hid_report_path_t *path_wheel;
+	usb_hid_report_path_t *path_buttons;
+
 	/** DDF mouse function */
 	ddf_fun_t *mouse_fun;
 } usb_mouse_t;
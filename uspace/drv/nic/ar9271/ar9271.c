@@ -107,6 +107,7 @@ static errno_t ar9271_ieee80211_set_freq(ieee80211_dev_t *, uint16_t);
 static errno_t ar9271_ieee80211_bssid_change(ieee80211_dev_t *, bool);
 static errno_t ar9271_ieee80211_key_config(ieee80211_dev_t *, ieee80211_key_config_t *,
     bool);
+static errno_t ar9271_ieee80211_tx_aggr(ieee80211_dev_t *, uint8_t, bool);
 
 static driver_ops_t ar9271_driver_ops = {
 	.dev_add = ar9271_add_device
@@ -122,7 +123,8 @@ static ieee80211_ops_t ar9271_ieee80211_ops = {
 	.tx_handler = ar9271_ieee80211_tx_handler,
 	.set_freq = ar9271_ieee80211_set_freq,
 	.bssid_change = ar9271_ieee80211_bssid_change,
-	.key_config = ar9271_ieee80211_key_config
+	.key_config = ar9271_ieee80211_key_config,
+	.tx_aggr = ar9271_ieee80211_tx_aggr
 };
 
 static ieee80211_iface_t ar9271_ieee80211_iface;
@@ -410,6 +412,30 @@ static errno_t ar9271_ieee80211_bssid_change(ieee80211_dev_t *ieee80211_dev,
 	return EOK;
 }
 
+static errno_t ar9271_ieee80211_tx_aggr(ieee80211_dev_t *ieee80211_dev,
+    uint8_t tid, bool enable)
+{
+	assert(ieee80211_dev);
+
+	ar9271_t *ar9271 = (ar9271_t *) ieee80211_get_specific(ieee80211_dev);
+
+	/*
+	 * The target firmware does the A-MPDU aggregation and block ack
+	 * processing itself, it only has to be told for which TID the
+	 * block ack session was established.
+	 */
+	htc_aggr_msg_t aggr_msg;
+	memset(&aggr_msg, 0, sizeof(htc_aggr_msg_t));
+	aggr_msg.sta_index = 1;
+	aggr_msg.tidno = tid;
+	aggr_msg.aggr_enable = enable ? 1 : 0;
+
+	wmi_send_command(ar9271->htc_device, WMI_TX_AGGR_ENABLE,
+	    (uint8_t *) &aggr_msg, sizeof(aggr_msg), NULL);
+
+	return EOK;
+}
+
 static errno_t ar9271_ieee80211_key_config(ieee80211_dev_t *ieee80211_dev,
     ieee80211_key_config_t *key_conf, bool insert)
 {
@@ -255,6 +255,16 @@ typedef struct {
 	uint8_t pad;
 } __attribute__((packed)) htc_cap_msg_t;
 
+/** HTC TX aggregation message.
+ *
+ */
+typedef struct {
+	uint8_t sta_index;
+	uint8_t tidno;
+	uint8_t aggr_enable;
+	uint8_t pad;
+} __attribute__((packed)) htc_aggr_msg_t;
+
 typedef struct {
 	uint8_t sta_index;
 	uint8_t is_new;
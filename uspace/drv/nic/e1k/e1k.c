@@ -58,6 +58,21 @@
 #define E1000_RX_FRAME_COUNT  128
 #define E1000_TX_FRAME_COUNT  128
 
+/** Number of frames received by one interrupt that switches to polling
+ *
+ * When an interrupt drains this many frames from the receive ring the
+ * receiver is considered loaded and reception continues by polling with
+ * interrupts masked.
+ *
+ */
+#define E1000_POLL_ENTER_THRESHOLD  (E1000_RX_FRAME_COUNT / 4)
+
+/** Delay between receive ring polls in polling mode */
+#define E1000_POLL_PERIOD_USEC  100
+
+/** Number of consecutive empty polls that switches back to interrupts */
+#define E1000_POLL_IDLE_ROUNDS  8
+
 #define E1000_RECEIVE_ADDRESS  16
 
 /** Maximum sending frame size */
@@ -173,6 +188,15 @@ typedef struct {
 
 	/** Lock for EEPROM access */
 	fibril_mutex_t eeprom_lock;
+
+	/** Receive polling mode active */
+	bool polling;
+
+	/** Lock for polling state */
+	fibril_mutex_t polling_lock;
+
+	/** Signalled when polling mode is entered */
+	fibril_condvar_t polling_cv;
 } e1000_t;
 
 /** Global mutex for work with shared irq structure */
@@ -185,6 +209,9 @@ static errno_t e1000_set_addr(ddf_fun_t *, const nic_address_t *);
 static errno_t e1000_defective_get_mode(ddf_fun_t *, uint32_t *);
 static errno_t e1000_defective_set_mode(ddf_fun_t *, uint32_t);
 
+static errno_t e1000_offload_probe(ddf_fun_t *, uint32_t *, uint32_t *);
+static errno_t e1000_offload_set(ddf_fun_t *, uint32_t, uint32_t);
+
 static errno_t e1000_get_cable_state(ddf_fun_t *, nic_cable_state_t *);
 static errno_t e1000_get_device_info(ddf_fun_t *, nic_device_info_t *);
 static errno_t e1000_get_operation_mode(ddf_fun_t *, int *,
@@ -213,6 +240,8 @@ static nic_iface_t e1000_nic_iface = {
 	.vlan_set_tag = &e1000_vlan_set_tag,
 	.defective_get_mode = &e1000_defective_get_mode,
 	.defective_set_mode = &e1000_defective_set_mode,
+	.offload_probe = &e1000_offload_probe,
+	.offload_set = &e1000_offload_set,
 };
 
 /** Basic device operations for E1000 driver */
@@ -551,6 +580,58 @@ static errno_t e1000_defective_set_mode(ddf_fun_t *fun, uint32_t mode)
 	return rc;
 }
 
+/** Probe supported offload computations
+ *
+ * The 8254x family can insert and verify TCP, UDP and IPv4 checksums
+ * and segment TCP payloads using context descriptors. None of them is
+ * active: frames handed down by the link layer do not carry the
+ * per-frame offload information the hardware needs.
+ *
+ * @param      fun       Device function
+ * @param[out] supported Supported offload computations
+ * @param[out] active    Currently active offload computations
+ *
+ * @return EOK
+ *
+ */
+static errno_t e1000_offload_probe(ddf_fun_t *fun, uint32_t *supported,
+    uint32_t *active)
+{
+	*supported = NIC_OFFLOAD_TX_IPV4_CHECKSUM |
+	    NIC_OFFLOAD_RX_IPV4_CHECKSUM |
+	    NIC_OFFLOAD_TX_TCP_CHECKSUM |
+	    NIC_OFFLOAD_RX_TCP_CHECKSUM |
+	    NIC_OFFLOAD_TX_UDP_CHECKSUM |
+	    NIC_OFFLOAD_RX_UDP_CHECKSUM |
+	    NIC_OFFLOAD_TCP_SEGMENTATION;
+	*active = 0;
+
+	return EOK;
+}
+
+/** Set active offload computations
+ *
+ * @param fun    Device function
+ * @param mask   Mask of offload computations to change
+ * @param active Offload computations to activate
+ *
+ * @return EOK if no offload computation was to be activated
+ * @return ENOTSUP otherwise
+ *
+ */
+static errno_t e1000_offload_set(ddf_fun_t *fun, uint32_t mask,
+    uint32_t active)
+{
+	/*
+	 * Offloads cannot be activated until the frames passed to
+	 * send_frame carry offload metadata.
+	 */
+	if ((mask & active) != 0)
+		return ENOTSUP;
+
+	return EOK;
+}
+
 /** Write receive address to RA registr
  *
  * @param e1000      E1000 data structure
@@ -1169,10 +1250,13 @@ static uint32_t e1000_inc_tail(uint32_t tail, uint32_t descriptors_count)
  *
  * @param nic NIC data
  *
+ * @return Number of frames received
+ *
  */
-static void e1000_receive_frames(nic_t *nic)
+static unsigned int e1000_receive_frames(nic_t *nic)
 {
 	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
+	unsigned int frames = 0;
 
 	fibril_mutex_lock(&e1000->rx_lock);
 
@@ -1200,9 +1284,13 @@ static void e1000_receive_frames(nic_t *nic)
 
 		rx_descriptor = (e1000_rx_descriptor_t *)
 		    (e1000->rx_ring_virt + next_tail * sizeof(e1000_rx_descriptor_t));
+
+		frames++;
 	}
 
 	fibril_mutex_unlock(&e1000->rx_lock);
+
+	return frames;
 }
 
 /** Enable E1000 interupts
@@ -1233,11 +1321,73 @@ static void e1000_disable_interrupts(e1000_t *e1000)
  * @param nic NIC data
  * @param icr ICR register value
  *
+ * @return Number of frames received
+ *
  */
-static void e1000_interrupt_handler_impl(nic_t *nic, uint32_t icr)
+static unsigned int e1000_interrupt_handler_impl(nic_t *nic, uint32_t icr)
 {
 	if (icr & ICR_RXT0)
-		e1000_receive_frames(nic);
+		return e1000_receive_frames(nic);
+
+	return 0;
+}
+
+/** Receive ring polling fibril
+ *
+ * While polling mode is active keep draining the receive ring with
+ * interrupts masked. When the ring stays empty for several consecutive
+ * polls, re-enable interrupts and wait for the next load peak.
+ *
+ * @param arg NIC data (nic_t *)
+ *
+ * @return Does not return
+ *
+ */
+static errno_t e1000_poll_fibril(void *arg)
+{
+	nic_t *nic = (nic_t *) arg;
+	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
+	unsigned int idle_rounds;
+	bool stopped;
+
+	while (true) {
+		fibril_mutex_lock(&e1000->polling_lock);
+		while (!e1000->polling)
+			fibril_condvar_wait(&e1000->polling_cv,
+			    &e1000->polling_lock);
+		fibril_mutex_unlock(&e1000->polling_lock);
+
+		idle_rounds = 0;
+		stopped = false;
+
+		while (idle_rounds < E1000_POLL_IDLE_ROUNDS) {
+			if (e1000_receive_frames(nic) > 0)
+				idle_rounds = 0;
+			else
+				idle_rounds++;
+
+			fibril_usleep(E1000_POLL_PERIOD_USEC);
+
+			fibril_mutex_lock(&e1000->polling_lock);
+			stopped = !e1000->polling;
+			fibril_mutex_unlock(&e1000->polling_lock);
+
+			if (stopped)
+				break;
+		}
+
+		fibril_mutex_lock(&e1000->polling_lock);
+		if (e1000->polling) {
+			e1000->polling = false;
+
+			/* Acknowledge causes raised while polling */
+			(void) E1000_REG_READ(e1000, E1000_ICR);
+			e1000_enable_interrupts(e1000);
+		}
+		fibril_mutex_unlock(&e1000->polling_lock);
+	}
+
+	return EOK;
 }
 
 /** Handle device interrupt
@@ -1253,8 +1403,19 @@ static void e1000_interrupt_handler(ipc_call_t *icall,
 	nic_t *nic = NIC_DATA_DEV(dev);
 	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
 
-	e1000_interrupt_handler_impl(nic, icr);
-	e1000_enable_interrupts(e1000);
+	unsigned int frames = e1000_interrupt_handler_impl(nic, icr);
+
+	if (frames >= E1000_POLL_ENTER_THRESHOLD) {
+		/*
+		 * The receiver is under load. Leave interrupts masked
+		 * and let the polling fibril drain the ring.
+		 */
+		fibril_mutex_lock(&e1000->polling_lock);
+		e1000->polling = true;
+		fibril_mutex_unlock(&e1000->polling_lock);
+		fibril_condvar_broadcast(&e1000->polling_cv);
+	} else
+		e1000_enable_interrupts(e1000);
 }
 
 /** Register interrupt handler for the card in the system
@@ -1301,7 +1462,7 @@ static void e1000_poll(nic_t *nic)
 	assert(e1000);
 
 	uint32_t icr = E1000_REG_READ(e1000, E1000_ICR);
-	e1000_interrupt_handler_impl(nic, icr);
+	(void) e1000_interrupt_handler_impl(nic, icr);
 }
 
 /** Calculates ITR register interrupt from timespec structure
@@ -1812,6 +1973,11 @@ static errno_t e1000_on_down_unlocked(nic_t *nic)
 	e1000_disable_tx(e1000);
 	e1000_disable_rx(e1000);
 
+	/* Stop the polling fibril from re-enabling interrupts */
+	fibril_mutex_lock(&e1000->polling_lock);
+	e1000->polling = false;
+	fibril_mutex_unlock(&e1000->polling_lock);
+
 	hw_res_disable_interrupt(e1000->parent_sess, e1000->irq);
 	e1000_disable_interrupts(e1000);
 
@@ -1909,6 +2075,8 @@ static e1000_t *e1000_create_dev_data(ddf_dev_t *dev)
 	fibril_mutex_initialize(&e1000->rx_lock);
 	fibril_mutex_initialize(&e1000->tx_lock);
 	fibril_mutex_initialize(&e1000->eeprom_lock);
+	fibril_mutex_initialize(&e1000->polling_lock);
+	fibril_condvar_initialize(&e1000->polling_cv);
 
 	return e1000;
 }
@@ -2194,6 +2362,14 @@ errno_t e1000_dev_add(ddf_dev_t *dev)
 	if (rc != EOK)
 		goto err_rx_structure;
 
+	fid_t fid = fibril_create(e1000_poll_fibril, nic);
+	if (fid == 0) {
+		rc = ENOMEM;
+		goto err_rx_structure;
+	}
+
+	fibril_add_ready(fid);
+
 	rc = ddf_fun_bind(fun);
 	if (rc != EOK)
 		goto err_fun_bind;
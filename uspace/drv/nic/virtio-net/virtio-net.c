@@ -75,31 +75,76 @@ static void virtio_net_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
 	virtio_net_t *virtio_net = nic_get_specific(nic);
 	virtio_dev_t *vdev = &virtio_net->virtio_dev;
 
+	bool mrg_rxbuf = (vdev->features & VIRTIO_NET_F_MRG_RXBUF) != 0;
+	uint16_t bufs[RX_BUFFERS];
+	uint32_t lens[RX_BUFFERS];
+	unsigned replenished = 0;
+
 	uint16_t descno;
 	uint32_t len;
 	while (virtio_virtq_consume_used(vdev, RX_QUEUE_1, &descno, &len)) {
 		virtio_net_hdr_t *hdr =
 		    (virtio_net_hdr_t *) virtio_net->rx_buf[descno];
-		if (len <= sizeof(*hdr)) {
-			ddf_msg(LVL_WARN,
-			    "RX data length too short, packet dropped");
-			virtio_virtq_produce_available(vdev, RX_QUEUE_1,
-			    descno);
-			continue;
+
+		bufs[0] = descno;
+		lens[0] = len;
+
+		/*
+		 * With mergeable receive buffers a large frame spans
+		 * num_buffers consecutive used ring entries.
+		 */
+		unsigned nbufs = 1;
+		if (mrg_rxbuf && len >= sizeof(*hdr))
+			nbufs = hdr->num_buffers;
+
+		bool complete = (nbufs >= 1) && (nbufs <= RX_BUFFERS);
+		if (!complete)
+			nbufs = 1;
+
+		size_t total = len;
+		for (unsigned i = 1; i < nbufs; i++) {
+			if (!virtio_virtq_consume_used(vdev, RX_QUEUE_1,
+			    &bufs[i], &lens[i])) {
+				nbufs = i;
+				complete = false;
+				break;
+			}
+			total += lens[i];
 		}
 
-		nic_frame_t *frame = nic_alloc_frame(nic, len - sizeof(*hdr));
-		if (frame) {
-			memcpy(frame->data, &hdr[1], len - sizeof(*hdr));
-			nic_received_frame(nic, frame);
+		if (complete && total > sizeof(*hdr)) {
+			nic_frame_t *frame = nic_alloc_frame(nic,
+			    total - sizeof(*hdr));
+			if (frame) {
+				uint8_t *dst = frame->data;
+				memcpy(dst, &hdr[1], lens[0] - sizeof(*hdr));
+				dst += lens[0] - sizeof(*hdr);
+				for (unsigned i = 1; i < nbufs; i++) {
+					memcpy(dst,
+					    virtio_net->rx_buf[bufs[i]],
+					    lens[i]);
+					dst += lens[i];
+				}
+				nic_received_frame(nic, frame);
+			} else {
+				ddf_msg(LVL_WARN,
+				    "Cannot allocate RX frame, packet dropped");
+			}
 		} else {
 			ddf_msg(LVL_WARN,
-			    "Cannot allocate RX frame, packet dropped");
+			    "RX data length too short, packet dropped");
 		}
 
-		virtio_virtq_produce_available(vdev, RX_QUEUE_1, descno);
+		/* Return the buffers to the ring without notifying yet */
+		for (unsigned i = 0; i < nbufs; i++)
+			virtio_virtq_produce_enqueue(vdev, RX_QUEUE_1, bufs[i]);
+		replenished += nbufs;
 	}
 
+	/* One kick for the whole batch of replenished buffers */
+	if (replenished > 0)
+		virtio_virtq_notify(vdev, RX_QUEUE_1);
+
 	while (virtio_virtq_consume_used(vdev, TX_QUEUE_1, &descno, &len)) {
 		virtio_free_desc(vdev, TX_QUEUE_1, &virtio_net->tx_free_head,
 		    descno);
@@ -197,7 +242,12 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 
 	/* Reset the device and negotiate the feature bits */
 	rc = virtio_device_setup_start(vdev,
-	    VIRTIO_NET_F_MAC | VIRTIO_NET_F_CTRL_VQ);
+	    VIRTIO_NET_F_MAC | VIRTIO_NET_F_CTRL_VQ | VIRTIO_NET_F_MRG_RXBUF);
+	if (rc == ENOTSUP) {
+		/* Retry without the optional mergeable receive buffers */
+		rc = virtio_device_setup_start(vdev,
+		    VIRTIO_NET_F_MAC | VIRTIO_NET_F_CTRL_VQ);
+	}
 	if (rc != EOK)
 		goto fail;
 
@@ -261,9 +311,12 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 		 * Put the set descriptor into the available ring of the RX
 		 * queue.
 		 */
-		virtio_virtq_produce_available(vdev, RX_QUEUE_1, i);
+		virtio_virtq_produce_enqueue(vdev, RX_QUEUE_1, i);
 	}
 
+	/* Notify the device about all the RX buffers at once */
+	virtio_virtq_notify(vdev, RX_QUEUE_1);
+
 	/*
 	 * Put all TX and CT buffers on a free list
 	 */
@@ -471,10 +524,60 @@ static errno_t virtio_net_get_operation_mode(ddf_fun_t *fun, int *speed,
 	return EOK;
 }
 
+static errno_t virtio_net_offload_probe(ddf_fun_t *fun, uint32_t *supported,
+    uint32_t *active)
+{
+	nic_t *nic = nic_get_from_ddf_fun(fun);
+	if (!nic)
+		return ENOENT;
+
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	virtio_pci_common_cfg_t *cfg = virtio_net->virtio_dev.common_cfg;
+
+	/* Read the feature bits offered by the device */
+	pio_write_le32(&cfg->device_feature_select, VIRTIO_FEATURES_0_31);
+	uint32_t device_features = pio_read_le32(&cfg->device_feature);
+
+	*supported = 0;
+	if (device_features & VIRTIO_NET_F_CSUM)
+		*supported |= NIC_OFFLOAD_TX_TCP_CHECKSUM |
+		    NIC_OFFLOAD_TX_UDP_CHECKSUM;
+	if (device_features & VIRTIO_NET_F_GUEST_CSUM)
+		*supported |= NIC_OFFLOAD_RX_TCP_CHECKSUM |
+		    NIC_OFFLOAD_RX_UDP_CHECKSUM;
+	if (device_features & (VIRTIO_NET_F_HOST_TSO4 | VIRTIO_NET_F_HOST_TSO6))
+		*supported |= NIC_OFFLOAD_TCP_SEGMENTATION;
+
+	/*
+	 * Neither VIRTIO_NET_F_CSUM nor the TSO features are negotiated
+	 * during setup, so no offload is active.
+	 */
+	*active = 0;
+
+	return EOK;
+}
+
+static errno_t virtio_net_offload_set(ddf_fun_t *fun, uint32_t mask,
+    uint32_t active)
+{
+	/*
+	 * Activating an offload would require negotiating the
+	 * corresponding feature and filling in virtio_net_hdr_t for each
+	 * frame, which the frames handed down by the link layer do not
+	 * describe.
+	 */
+	if ((mask & active) != 0)
+		return ENOTSUP;
+
+	return EOK;
+}
+
 static nic_iface_t virtio_net_nic_iface = {
 	.get_device_info = virtio_net_get_device_info,
 	.get_cable_state = virtio_net_get_cable_state,
 	.get_operation_mode = virtio_net_get_operation_mode,
+	.offload_probe = virtio_net_offload_probe,
+	.offload_set = virtio_net_offload_set,
 };
 
 int main(void)
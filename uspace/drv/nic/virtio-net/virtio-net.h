@@ -43,6 +43,16 @@
 #define VIRTIO_NET_F_GUEST_CSUM		(1U << 2)
 /** Device has given MAC address. */
 #define VIRTIO_NET_F_MAC		(1U << 5)
+/** Driver can receive TSOv4. */
+#define VIRTIO_NET_F_GUEST_TSO4		(1U << 7)
+/** Driver can receive TSOv6. */
+#define VIRTIO_NET_F_GUEST_TSO6		(1U << 8)
+/** Device can receive TSOv4. */
+#define VIRTIO_NET_F_HOST_TSO4		(1U << 11)
+/** Device can receive TSOv6. */
+#define VIRTIO_NET_F_HOST_TSO6		(1U << 12)
+/** Device can merge receive buffers. */
+#define VIRTIO_NET_F_MRG_RXBUF		(1U << 15)
 /** Control channel is available */
 #define VIRTIO_NET_F_CTRL_VQ		(1U << 17)
 
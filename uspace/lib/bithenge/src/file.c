@@ -45,11 +45,26 @@
 #include <bithenge/blob.h>
 #include <bithenge/file.h>
 
+/** Size of a cached window. Must be a power of two. */
+#define WINDOW_SIZE 16384
+
+/** Number of windows cached per file. */
+#define MAX_WINDOWS 4
+
+/** An aligned window of the file kept in memory. */
+typedef struct {
+	aoff64_t offset; /**< File offset; a multiple of WINDOW_SIZE. */
+	size_t size; /**< Number of valid bytes in @a data. */
+	char *data; /**< Window contents, or NULL if the slot is unused. */
+} file_window_t;
+
 typedef struct {
 	bithenge_blob_t base;
 	int fd;
 	aoff64_t size; // needed by file_read()
 	bool needs_close;
+	/** Cached windows, most recently used first. */
+	file_window_t windows[MAX_WINDOWS];
 } file_blob_t;
 
 static inline file_blob_t *blob_as_file(bithenge_blob_t *base)
@@ -69,24 +84,97 @@ static errno_t file_size(bithenge_blob_t *base, aoff64_t *size)
 	return EOK;
 }
 
+/** Read exactly @a size bytes at @a offset, coping with short reads. */
+static errno_t file_read_exact(int fd, aoff64_t offset, char *buffer,
+    size_t size)
+{
+	while (size > 0) {
+		size_t amount_read;
+		errno_t rc = vfs_read(fd, &offset, buffer, size, &amount_read);
+		if (rc != EOK)
+			return rc;
+		if (amount_read == 0)
+			return EIO;
+		buffer += amount_read;
+		size -= amount_read;
+	}
+	return EOK;
+}
+
+/** Find the cached window holding @a offset, demand-loading it if necessary,
+ * and move it to the front of the cache. */
+static errno_t file_get_window(file_blob_t *blob, aoff64_t offset,
+    file_window_t **out)
+{
+	aoff64_t base_offset = offset & ~(aoff64_t)(WINDOW_SIZE - 1);
+
+	size_t i;
+	for (i = 0; i < MAX_WINDOWS; i++) {
+		if (blob->windows[i].data != NULL &&
+		    blob->windows[i].offset == base_offset)
+			break;
+	}
+	if (i == MAX_WINDOWS) {
+		/* Not cached; load into the least recently used slot. */
+		file_window_t *window = &blob->windows[MAX_WINDOWS - 1];
+		if (window->data == NULL) {
+			window->data = malloc(WINDOW_SIZE);
+			if (window->data == NULL)
+				return ENOMEM;
+		}
+		window->offset = base_offset;
+		window->size = min(WINDOW_SIZE, blob->size - base_offset);
+		errno_t rc = file_read_exact(blob->fd, base_offset,
+		    window->data, window->size);
+		if (rc != EOK) {
+			free(window->data);
+			window->data = NULL;
+			return rc;
+		}
+		i = MAX_WINDOWS - 1;
+	}
+
+	file_window_t window = blob->windows[i];
+	memmove(&blob->windows[1], &blob->windows[0],
+	    i * sizeof(blob->windows[0]));
+	blob->windows[0] = window;
+	*out = &blob->windows[0];
+	return EOK;
+}
+
 static errno_t file_read(bithenge_blob_t *base, aoff64_t offset, char *buffer,
     aoff64_t *size)
 {
 	file_blob_t *blob = blob_as_file(base);
 	if (offset > blob->size)
 		return ELIMIT;
+	*size = min(*size, blob->size - offset);
 
-	size_t amount_read;
-	errno_t rc = vfs_read(blob->fd, &offset, buffer, *size, &amount_read);
-	if (rc != EOK)
-		return errno;
-	*size += amount_read;
+	/* Large reads bypass the window cache. */
+	if (*size >= WINDOW_SIZE)
+		return file_read_exact(blob->fd, offset, buffer, *size);
+
+	aoff64_t remaining = *size;
+	while (remaining > 0) {
+		file_window_t *window;
+		errno_t rc = file_get_window(blob, offset, &window);
+		if (rc != EOK)
+			return rc;
+		size_t window_offset = offset - window->offset;
+		size_t amount = min(remaining, window->size - window_offset);
+		memcpy(buffer, window->data + window_offset, amount);
+		offset += amount;
+		buffer += amount;
+		remaining -= amount;
+	}
 	return EOK;
 }
 
 static void file_destroy(bithenge_blob_t *base)
 {
 	file_blob_t *blob = blob_as_file(base);
+	for (size_t i = 0; i < MAX_WINDOWS; i++)
+		free(blob->windows[i].data);
 	vfs_put(blob->fd);
 	free(blob);
 }
@@ -130,6 +218,8 @@ static errno_t new_file_blob(bithenge_node_t **out, int fd, bool needs_close)
 	blob->size = stat.st_size;
 #endif
 	blob->needs_close = needs_close;
+	for (size_t i = 0; i < MAX_WINDOWS; i++)
+		blob->windows[i].data = NULL;
 	*out = bithenge_blob_as_node(file_as_blob(blob));
 
 	return EOK;
@@ -54,10 +54,28 @@
 #include <str_error.h>
 #include <offset.h>
 #include <inttypes.h>
+#include <time.h>
 #include "block.h"
 
 #define MAX_WRITE_RETRIES 10
 
+/** Default number of blocks fetched ahead of a sequential reader. */
+#define CACHE_RA_BLOCKS		8
+
+/** Period of the write-behind flusher fibril. */
+#define CACHE_FLUSHER_PERIOD	(500 * 1000)
+
+/** Upper bound on the size of a merged request batch. */
+#define SCHED_MAX_BATCH_BYTES	(128 * 1024)
+
+/** How long a request may sit in the queue before the address-ordered
+ * dispatch is overridden in its favour.
+ */
+#define SCHED_DEADLINE_NSEC	(50 * 1000000ll)
+
+/** Number of pending discard ranges accumulated before flushing them. */
+#define DISCARD_BATCH_RANGES	32
+
 /** Lock protecting the device connection list */
 static FIBRIL_MUTEX_INITIALIZE(dcl_lock);
 /** Device connection list head. */
@@ -72,9 +90,65 @@ typedef struct {
 	hash_table_t block_hash;
 	list_t free_list;
 	enum cache_mode mode;
+	aoff64_t next_seq;        /**< Expected next block of a sequence. */
+	unsigned seq_run;         /**< Length of the current sequential run. */
+	unsigned ra_blocks;       /**< Read-ahead batch size; 0 disables. */
+	bool flusher_running;     /**< True while the flusher fibril lives. */
+	bool flusher_stop;        /**< Tells the flusher fibril to exit. */
+	fibril_condvar_t flusher_cv;
 } cache_t;
 
+/** One block request queued with the I/O scheduler.
+ *
+ * Allocated on the stack of the submitting fibril, which blocks until
+ * the request is marked done.
+ */
 typedef struct {
+	link_t link;
+	bool write;
+	aoff64_t ba;              /**< Address of the first block (physical). */
+	size_t cnt;               /**< Number of physical blocks. */
+	void *buf;
+	size_t size;
+	struct timespec submitted;
+	bool done;
+	errno_t rc;
+} sched_req_t;
+
+/** Per-device I/O scheduler state. */
+typedef struct {
+	fibril_mutex_t lock;
+	block_sched_policy_t policy;
+	unsigned qdepth;          /**< Max. request batches in flight. */
+	unsigned in_flight;       /**< Current number of batches in flight. */
+	/** Queued requests; sorted by address under BLOCK_SCHED_DEADLINE. */
+	list_t queue;
+	aoff64_t last_ba;         /**< Elevator position. */
+	bool stop;                /**< Tells the dispatcher fibril to exit. */
+	bool running;             /**< True while the dispatcher fibril lives. */
+	/** Signaled when work arrives or an in-flight slot frees up. */
+	fibril_condvar_t queue_cv;
+	/** Broadcast when requests complete or the dispatcher exits. */
+	fibril_condvar_t done_cv;
+} sched_t;
+
+/** A batch of adjacent requests dispatched to the device as one transfer. */
+typedef struct {
+	struct devcon *devcon;
+	/** The merged requests, sorted by address. */
+	list_t reqs;
+	bool write;
+	aoff64_t ba;              /**< Address of the first block (physical). */
+	size_t cnt;               /**< Total number of physical blocks. */
+} sched_batch_t;
+
+/** A contiguous range of blocks waiting to be discarded. */
+typedef struct {
+	aoff64_t ba;         /**< Address of the first block (physical). */
+	size_t cnt;          /**< Number of physical blocks. */
+} discard_range_t;
+
+typedef struct devcon {
 	link_t link;
 	service_id_t service_id;
 	async_sess_t *sess;
@@ -84,11 +158,22 @@ typedef struct {
 	aoff64_t pblocks;    /**< Number of physical blocks */
 	size_t pblock_size;  /**< Physical block size. */
 	cache_t *cache;
+	sched_t *sched;      /**< I/O scheduler (optional). */
+	/** Protects the pending discard ranges. */
+	fibril_mutex_t discard_lock;
+	/** Pending discard ranges, merged where adjacent. */
+	discard_range_t discard_pend[DISCARD_BATCH_RANGES];
+	/** Number of pending discard ranges. */
+	unsigned discard_npend;
+	/** The device does not support discard; stop bothering it. */
+	bool discard_unsup;
 } devcon_t;
 
 static errno_t read_blocks(devcon_t *, aoff64_t, size_t, void *, size_t);
 static errno_t write_blocks(devcon_t *, aoff64_t, size_t, void *, size_t);
 static aoff64_t ba_ltop(devcon_t *, aoff64_t);
+static void sched_fini(devcon_t *);
+static void discard_flush_locked(devcon_t *);
 
 static devcon_t *devcon_search(service_id_t service_id)
 {
@@ -123,6 +208,10 @@ static errno_t devcon_add(service_id_t service_id, async_sess_t *sess,
 	devcon->pblock_size = bsize;
 	devcon->pblocks = dev_size;
 	devcon->cache = NULL;
+	devcon->sched = NULL;
+	fibril_mutex_initialize(&devcon->discard_lock);
+	devcon->discard_npend = 0;
+	devcon->discard_unsup = false;
 
 	fibril_mutex_lock(&dcl_lock);
 	list_foreach(dcl, link, devcon_t, d) {
@@ -194,6 +283,13 @@ void block_fini(service_id_t service_id)
 	if (devcon->cache)
 		(void) block_cache_fini(service_id);
 
+	if (devcon->sched)
+		sched_fini(devcon);
+
+	fibril_mutex_lock(&devcon->discard_lock);
+	discard_flush_locked(devcon);
+	fibril_mutex_unlock(&devcon->discard_lock);
+
 	(void)bd_sync_cache(devcon->bd, 0, 0);
 
 	devcon_remove(devcon);
@@ -240,6 +336,391 @@ void *block_bb_get(service_id_t service_id)
 	return devcon->bb_buf;
 }
 
+/** Add a request to the scheduler queue.
+ *
+ * Under BLOCK_SCHED_DEADLINE the queue is kept sorted by block address;
+ * otherwise requests are queued in arrival order.
+ */
+static void sched_enqueue(sched_t *sched, sched_req_t *req)
+{
+	if (sched->policy == BLOCK_SCHED_DEADLINE) {
+		list_foreach(sched->queue, link, sched_req_t, cur) {
+			if (cur->ba > req->ba) {
+				list_insert_before(&req->link, &cur->link);
+				return;
+			}
+		}
+	}
+
+	list_append(&req->link, &sched->queue);
+}
+
+/** Pick the next request to dispatch.
+ *
+ * Under BLOCK_SCHED_DEADLINE this is the queued request closest to the
+ * elevator position in the direction of increasing addresses, unless
+ * some request has been waiting longer than the deadline, in which case
+ * that request wins. Other policies dispatch in arrival order.
+ *
+ * Must be called with the scheduler lock held and the queue non-empty.
+ */
+static sched_req_t *sched_pick(sched_t *sched)
+{
+	if (sched->policy != BLOCK_SCHED_DEADLINE) {
+		return list_get_instance(list_first(&sched->queue),
+		    sched_req_t, link);
+	}
+
+	struct timespec now;
+	getuptime(&now);
+
+	sched_req_t *oldest = NULL;
+	sched_req_t *next = NULL;
+
+	list_foreach(sched->queue, link, sched_req_t, cur) {
+		if (oldest == NULL || ts_sub_diff(&cur->submitted,
+		    &oldest->submitted) < 0)
+			oldest = cur;
+		if (next == NULL && cur->ba >= sched->last_ba)
+			next = cur;
+	}
+
+	if (ts_sub_diff(&now, &oldest->submitted) > SCHED_DEADLINE_NSEC)
+		return oldest;
+
+	if (next != NULL)
+		return next;
+
+	/* Wrap the elevator around to the lowest address. */
+	return list_get_instance(list_first(&sched->queue), sched_req_t, link);
+}
+
+/** Form a dispatch batch around the chosen request.
+ *
+ * Removes @a first from the queue along with any queued requests of the
+ * same direction that are adjacent to the batch's address range, up to
+ * SCHED_MAX_BATCH_BYTES worth of data.
+ *
+ * Must be called with the scheduler lock held.
+ */
+static sched_batch_t *sched_batch_create(devcon_t *devcon, sched_req_t *first)
+{
+	sched_t *sched = devcon->sched;
+
+	sched_batch_t *batch = malloc(sizeof(sched_batch_t));
+	if (batch == NULL)
+		return NULL;
+
+	batch->devcon = devcon;
+	list_initialize(&batch->reqs);
+	batch->write = first->write;
+	batch->ba = first->ba;
+	batch->cnt = first->cnt;
+
+	list_remove(&first->link);
+	list_append(&first->link, &batch->reqs);
+
+	if (sched->policy == BLOCK_SCHED_FIFO)
+		return batch;
+
+	bool merged = true;
+	while (merged) {
+		merged = false;
+
+		list_foreach(sched->queue, link, sched_req_t, cur) {
+			if (cur->write != batch->write)
+				continue;
+			if ((batch->cnt + cur->cnt) * devcon->pblock_size >
+			    SCHED_MAX_BATCH_BYTES)
+				continue;
+
+			if (cur->ba == batch->ba + batch->cnt) {
+				list_remove(&cur->link);
+				list_append(&cur->link, &batch->reqs);
+			} else if (cur->ba + cur->cnt == batch->ba) {
+				list_remove(&cur->link);
+				list_prepend(&cur->link, &batch->reqs);
+				batch->ba = cur->ba;
+			} else {
+				continue;
+			}
+
+			batch->cnt += cur->cnt;
+			merged = true;
+			break;
+		}
+	}
+
+	return batch;
+}
+
+/** Mark all requests of a batch done and release the in-flight slot. */
+static void sched_batch_complete(sched_batch_t *batch, errno_t rc)
+{
+	sched_t *sched = batch->devcon->sched;
+
+	fibril_mutex_lock(&sched->lock);
+
+	while (!list_empty(&batch->reqs)) {
+		sched_req_t *req = list_get_instance(list_first(&batch->reqs),
+		    sched_req_t, link);
+		list_remove(&req->link);
+		req->rc = rc;
+		req->done = true;
+	}
+
+	sched->in_flight--;
+	fibril_condvar_signal(&sched->queue_cv);
+	fibril_condvar_broadcast(&sched->done_cv);
+	fibril_mutex_unlock(&sched->lock);
+
+	free(batch);
+}
+
+/** Worker fibril carrying out one dispatch batch. */
+static errno_t sched_worker(void *arg)
+{
+	sched_batch_t *batch = arg;
+	devcon_t *devcon = batch->devcon;
+	errno_t rc;
+
+	if (list_count(&batch->reqs) == 1) {
+		sched_req_t *req = list_get_instance(list_first(&batch->reqs),
+		    sched_req_t, link);
+
+		if (req->write) {
+			rc = bd_write_blocks(devcon->bd, req->ba, req->cnt,
+			    req->buf, req->size);
+		} else {
+			rc = bd_read_blocks(devcon->bd, req->ba, req->cnt,
+			    req->buf, req->size);
+		}
+
+		sched_batch_complete(batch, rc);
+		return EOK;
+	}
+
+	/*
+	 * Several adjacent requests were merged. Do the transfer through a
+	 * bounce buffer and gather/scatter the data of the individual
+	 * requests. If the bounce buffer cannot be allocated, fall back to
+	 * dispatching the requests one by one.
+	 */
+	size_t nbytes = batch->cnt * devcon->pblock_size;
+	void *bounce = malloc(nbytes);
+	if (bounce == NULL) {
+		rc = EOK;
+		list_foreach(batch->reqs, link, sched_req_t, req) {
+			errno_t rrc;
+
+			if (req->write) {
+				rrc = bd_write_blocks(devcon->bd, req->ba,
+				    req->cnt, req->buf, req->size);
+			} else {
+				rrc = bd_read_blocks(devcon->bd, req->ba,
+				    req->cnt, req->buf, req->size);
+			}
+
+			if (rrc != EOK)
+				rc = rrc;
+		}
+
+		sched_batch_complete(batch, rc);
+		return EOK;
+	}
+
+	if (batch->write) {
+		list_foreach(batch->reqs, link, sched_req_t, req) {
+			memcpy(bounce + (req->ba - batch->ba) *
+			    devcon->pblock_size, req->buf,
+			    req->cnt * devcon->pblock_size);
+		}
+
+		rc = bd_write_blocks(devcon->bd, batch->ba, batch->cnt,
+		    bounce, nbytes);
+	} else {
+		rc = bd_read_blocks(devcon->bd, batch->ba, batch->cnt,
+		    bounce, nbytes);
+
+		if (rc == EOK) {
+			list_foreach(batch->reqs, link, sched_req_t, req) {
+				memcpy(req->buf, bounce +
+				    (req->ba - batch->ba) *
+				    devcon->pblock_size,
+				    req->cnt * devcon->pblock_size);
+			}
+		}
+	}
+
+	free(bounce);
+	sched_batch_complete(batch, rc);
+	return EOK;
+}
+
+/** Scheduler dispatcher fibril.
+ *
+ * Takes requests off the queue, forms batches and hands them to worker
+ * fibrils, keeping at most qdepth batches in flight.
+ */
+static errno_t sched_dispatcher(void *arg)
+{
+	devcon_t *devcon = arg;
+	sched_t *sched = devcon->sched;
+
+	fibril_mutex_lock(&sched->lock);
+
+	while (true) {
+		while (!sched->stop && (list_empty(&sched->queue) ||
+		    sched->in_flight >= sched->qdepth))
+			fibril_condvar_wait(&sched->queue_cv, &sched->lock);
+
+		if (sched->stop && list_empty(&sched->queue))
+			break;
+
+		sched_req_t *first = sched_pick(sched);
+		sched_batch_t *batch = sched_batch_create(devcon, first);
+		if (batch == NULL) {
+			/*
+			 * Out of memory. Fail the request; the submitter
+			 * will see the error.
+			 */
+			list_remove(&first->link);
+			first->rc = ENOMEM;
+			first->done = true;
+			fibril_condvar_broadcast(&sched->done_cv);
+			continue;
+		}
+
+		sched->last_ba = batch->ba + batch->cnt;
+
+		fid_t fid = fibril_create(sched_worker, batch);
+		if (fid == 0) {
+			/* Carry out the batch ourselves. */
+			sched->in_flight++;
+			fibril_mutex_unlock(&sched->lock);
+			(void) sched_worker(batch);
+			fibril_mutex_lock(&sched->lock);
+			continue;
+		}
+
+		sched->in_flight++;
+		fibril_add_ready(fid);
+	}
+
+	sched->running = false;
+	fibril_condvar_broadcast(&sched->done_cv);
+	fibril_mutex_unlock(&sched->lock);
+	return EOK;
+}
+
+/** Queue a request with the scheduler and wait for its completion. */
+static errno_t sched_submit(devcon_t *devcon, bool write, aoff64_t ba,
+    size_t cnt, void *buf, size_t size)
+{
+	sched_t *sched = devcon->sched;
+	sched_req_t req;
+
+	link_initialize(&req.link);
+	req.write = write;
+	req.ba = ba;
+	req.cnt = cnt;
+	req.buf = buf;
+	req.size = size;
+	getuptime(&req.submitted);
+	req.done = false;
+	req.rc = EOK;
+
+	fibril_mutex_lock(&sched->lock);
+	sched_enqueue(sched, &req);
+	fibril_condvar_signal(&sched->queue_cv);
+
+	while (!req.done)
+		fibril_condvar_wait(&sched->done_cv, &sched->lock);
+	fibril_mutex_unlock(&sched->lock);
+
+	return req.rc;
+}
+
+/** Shut down the I/O scheduler of a device. */
+static void sched_fini(devcon_t *devcon)
+{
+	sched_t *sched = devcon->sched;
+
+	fibril_mutex_lock(&sched->lock);
+	sched->stop = true;
+	fibril_condvar_broadcast(&sched->queue_cv);
+	while (sched->running || sched->in_flight > 0)
+		fibril_condvar_wait(&sched->done_cv, &sched->lock);
+	fibril_mutex_unlock(&sched->lock);
+
+	devcon->sched = NULL;
+	free(sched);
+}
+
+/** Select the I/O scheduling policy for a block device.
+ *
+ * Should be called right after block_init(), before any I/O is started
+ * on the device. With BLOCK_SCHED_FIFO and a queue depth of at most one,
+ * requests pass to the device one at a time in arrival order, which is
+ * also the behavior of devices with no scheduler set. Other policies
+ * queue requests and merge adjacent ones into single device transfers;
+ * BLOCK_SCHED_DEADLINE additionally dispatches them in elevator order,
+ * bounding the wait of any single request by a deadline.
+ *
+ * The scheduler only orders requests that are in its queue at the same
+ * time; callers that depend on the ordering of conflicting requests must
+ * serialize them, as they must even without a scheduler.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param policy	Scheduling policy.
+ * @param qdepth	Maximum number of request batches in flight; 0 is
+ *			treated as 1.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t block_sched_set(service_id_t service_id, block_sched_policy_t policy,
+    unsigned qdepth)
+{
+	devcon_t *devcon = devcon_search(service_id);
+	sched_t *sched;
+
+	if (!devcon)
+		return ENOENT;
+
+	if (devcon->sched != NULL)
+		sched_fini(devcon);
+
+	if (policy == BLOCK_SCHED_FIFO && qdepth <= 1)
+		return EOK;
+
+	sched = malloc(sizeof(sched_t));
+	if (sched == NULL)
+		return ENOMEM;
+
+	fibril_mutex_initialize(&sched->lock);
+	sched->policy = policy;
+	sched->qdepth = (qdepth > 0) ? qdepth : 1;
+	sched->in_flight = 0;
+	list_initialize(&sched->queue);
+	sched->last_ba = 0;
+	sched->stop = false;
+	sched->running = false;
+	fibril_condvar_initialize(&sched->queue_cv);
+	fibril_condvar_initialize(&sched->done_cv);
+
+	fid_t fid = fibril_create(sched_dispatcher, devcon);
+	if (fid == 0) {
+		free(sched);
+		return ENOMEM;
+	}
+
+	devcon->sched = sched;
+	sched->running = true;
+	fibril_add_ready(fid);
+
+	return EOK;
+}
+
 static size_t cache_key_hash(const void *key)
 {
 	const aoff64_t *lba = key;
@@ -267,6 +748,76 @@ static const hash_table_ops_t cache_ops = {
 	.remove_callback = NULL
 };
 
+/** Write-behind flusher fibril.
+ *
+ * Periodically walks the free list of a write-back cache and writes out
+ * dirty, unreferenced blocks, so that a later eviction finds the blocks
+ * already clean and never has to block the evicting reader on device I/O.
+ */
+static errno_t cache_flusher(void *arg)
+{
+	devcon_t *devcon = arg;
+	cache_t *cache = devcon->cache;
+
+	fibril_mutex_lock(&cache->lock);
+
+	while (!cache->flusher_stop) {
+		(void) fibril_condvar_wait_timeout(&cache->flusher_cv,
+		    &cache->lock, CACHE_FLUSHER_PERIOD);
+
+		while (!cache->flusher_stop) {
+			/*
+			 * Find a dirty block that nobody is using and pin it.
+			 */
+			block_t *b = NULL;
+			list_foreach(cache->free_list, free_link, block_t,
+			    cur) {
+				fibril_mutex_lock(&cur->lock);
+				if (cur->dirty && !cur->toxic &&
+				    cur->write_failures < MAX_WRITE_RETRIES) {
+					assert(cur->refcnt == 0);
+					cur->refcnt++;
+					list_remove(&cur->free_link);
+					b = cur;
+					break;
+				}
+				fibril_mutex_unlock(&cur->lock);
+			}
+			if (!b)
+				break;
+
+			/*
+			 * Do the I/O while holding the block lock, like the
+			 * eviction path in block_get() does, so that a client
+			 * cannot modify and re-dirty the block while its old
+			 * contents are in flight and have the dirty flag
+			 * cleared from under it afterwards. Only the cache
+			 * lock is released for the duration of the I/O.
+			 */
+			fibril_mutex_unlock(&cache->lock);
+			errno_t rc = write_blocks(devcon, b->pba,
+			    cache->blocks_cluster, b->data, b->size);
+			if (rc == EOK) {
+				b->dirty = false;
+				b->write_failures = 0;
+			} else
+				b->write_failures++;
+			fibril_mutex_unlock(&b->lock);
+
+			fibril_mutex_lock(&cache->lock);
+			fibril_mutex_lock(&b->lock);
+			if (!--b->refcnt)
+				list_append(&b->free_link, &cache->free_list);
+			fibril_mutex_unlock(&b->lock);
+		}
+	}
+
+	cache->flusher_running = false;
+	fibril_condvar_broadcast(&cache->flusher_cv);
+	fibril_mutex_unlock(&cache->lock);
+	return EOK;
+}
+
 errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
     enum cache_mode mode)
 {
@@ -286,6 +837,12 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 	cache->block_count = blocks;
 	cache->blocks_cached = 0;
 	cache->mode = mode;
+	cache->next_seq = 0;
+	cache->seq_run = 0;
+	cache->ra_blocks = CACHE_RA_BLOCKS;
+	cache->flusher_running = false;
+	cache->flusher_stop = false;
+	fibril_condvar_initialize(&cache->flusher_cv);
 
 	/* Allow 1:1 or small-to-large block size translation */
 	if (cache->lblock_size % devcon->pblock_size != 0) {
@@ -301,9 +858,36 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 	}
 
 	devcon->cache = cache;
+
+	if (mode == CACHE_MODE_WB) {
+		fid_t fid = fibril_create(cache_flusher, devcon);
+		if (fid) {
+			cache->flusher_running = true;
+			fibril_add_ready(fid);
+		}
+	}
+
 	return EOK;
 }
 
+/** Set the read-ahead batch size of a cached block device.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param ra_blocks	Number of blocks to fetch ahead of a sequential
+ *			reader; 0 disables read-ahead.
+ */
+void block_cache_read_ahead_set(service_id_t service_id, unsigned ra_blocks)
+{
+	devcon_t *devcon = devcon_search(service_id);
+
+	assert(devcon);
+	assert(devcon->cache);
+
+	fibril_mutex_lock(&devcon->cache->lock);
+	devcon->cache->ra_blocks = ra_blocks;
+	fibril_mutex_unlock(&devcon->cache->lock);
+}
+
 errno_t block_cache_fini(service_id_t service_id)
 {
 	devcon_t *devcon = devcon_search(service_id);
@@ -316,6 +900,16 @@ errno_t block_cache_fini(service_id_t service_id)
 		return EOK;
 	cache = devcon->cache;
 
+	/*
+	 * Shut down the write-behind flusher first.
+	 */
+	fibril_mutex_lock(&cache->lock);
+	cache->flusher_stop = true;
+	fibril_condvar_broadcast(&cache->flusher_cv);
+	while (cache->flusher_running)
+		fibril_condvar_wait(&cache->flusher_cv, &cache->lock);
+	fibril_mutex_unlock(&cache->lock);
+
 	/*
 	 * We are expecting to find all blocks for this device handle on the
 	 * free list, i.e. the block reference count should be zero. Do not
@@ -368,6 +962,79 @@ static void block_initialize(block_t *b)
 	link_initialize(&b->free_link);
 }
 
+/** Populate the cache with blocks fetched by read-ahead.
+ *
+ * Instantiates cache blocks for @a cnt blocks starting at @a ba and fills
+ * them with data from @a data.  The new blocks are unreferenced and go
+ * straight to the free list, where a sequential reader will find them.
+ * Blocks that are already cached are skipped; the function gives up
+ * silently when the cache cannot accommodate more blocks, as read-ahead
+ * is only a hint.
+ *
+ * @param devcon	Device connection.
+ * @param ba		Address of the first fetched block (logical).
+ * @param data		Buffer holding the data of the fetched blocks.
+ * @param cnt		Number of fetched blocks.
+ */
+static void cache_readahead_insert(devcon_t *devcon, aoff64_t ba, void *data,
+    unsigned cnt)
+{
+	cache_t *cache = devcon->cache;
+
+	fibril_mutex_lock(&cache->lock);
+
+	for (unsigned i = 0; i < cnt; i++, ba++, data += cache->lblock_size) {
+		if (hash_table_find(&cache->block_hash, &ba))
+			continue;
+
+		block_t *b;
+		if (cache_can_grow(cache)) {
+			b = malloc(sizeof(block_t));
+			if (!b)
+				break;
+			b->data = malloc(cache->lblock_size);
+			if (!b->data) {
+				free(b);
+				break;
+			}
+			cache->blocks_cached++;
+		} else {
+			/*
+			 * Recycle a clean block from the head of the free
+			 * list.  Dirty blocks are left for the flusher and
+			 * the eviction path to deal with.
+			 */
+			if (list_empty(&cache->free_list))
+				break;
+			b = list_get_instance(list_first(&cache->free_list),
+			    block_t, free_link);
+
+			fibril_mutex_lock(&b->lock);
+			if (b->dirty) {
+				fibril_mutex_unlock(&b->lock);
+				break;
+			}
+			fibril_mutex_unlock(&b->lock);
+
+			list_remove(&b->free_link);
+			hash_table_remove_item(&cache->block_hash,
+			    &b->hash_link);
+		}
+
+		block_initialize(b);
+		b->refcnt = 0;
+		b->service_id = devcon->service_id;
+		b->size = cache->lblock_size;
+		b->lba = ba;
+		b->pba = ba_ltop(devcon, b->lba);
+		memcpy(b->data, data, cache->lblock_size);
+		hash_table_insert(&cache->block_hash, &b->hash_link);
+		list_append(&b->free_link, &cache->free_list);
+	}
+
+	fibril_mutex_unlock(&cache->lock);
+}
+
 /** Instantiate a block in memory and get a reference to it.
  *
  * @param block			Pointer to where the function will store the
@@ -387,6 +1054,7 @@ errno_t block_get(block_t **block, service_id_t service_id, aoff64_t ba, int fla
 	block_t *b;
 	link_t *link;
 	aoff64_t p_ba;
+	void *ra_buf = NULL;
 	errno_t rc;
 
 	devcon = devcon_search(service_id);
@@ -407,6 +1075,27 @@ errno_t block_get(block_t **block, service_id_t service_id, aoff64_t ba, int fla
 		return EIO;
 	}
 
+	/*
+	 * Detect sequential access.  Read-ahead kicks in once the reader
+	 * requests the expected next block for the second time in a row.
+	 */
+	unsigned ra_cnt = 0;
+	fibril_mutex_lock(&cache->lock);
+	if (ba == cache->next_seq)
+		cache->seq_run++;
+	else
+		cache->seq_run = 0;
+	cache->next_seq = ba + 1;
+	if ((cache->seq_run >= 2) && !(flags & BLOCK_FLAGS_NOREAD))
+		ra_cnt = cache->ra_blocks;
+	fibril_mutex_unlock(&cache->lock);
+
+	/* Do not read ahead past the end of the device. */
+	while (ra_cnt > 0 &&
+	    ba_ltop(devcon, ba + ra_cnt) + cache->blocks_cluster >=
+	    devcon->pblocks)
+		ra_cnt--;
+
 retry:
 	rc = EOK;
 	b = NULL;
@@ -550,14 +1239,58 @@ retry:
 			 * The block contains old or no data. We need to read
 			 * the new contents from the device.
 			 */
-			rc = read_blocks(devcon, b->pba, cache->blocks_cluster,
-			    b->data, cache->lblock_size);
-			if (rc != EOK)
-				b->toxic = true;
+			rc = EIO;
+			if (ra_cnt > 0) {
+				/*
+				 * The reader is sequential.  Fetch the
+				 * requested block and the blocks behind it in
+				 * a single device round trip and seed the
+				 * cache with the surplus.
+				 */
+				ra_buf = malloc((1 + ra_cnt) *
+				    cache->lblock_size);
+				if (ra_buf) {
+					rc = read_blocks(devcon, b->pba,
+					    (1 + ra_cnt) * cache->blocks_cluster,
+					    ra_buf,
+					    (1 + ra_cnt) * cache->lblock_size);
+					if (rc == EOK) {
+						memcpy(b->data, ra_buf,
+						    cache->lblock_size);
+					} else {
+						free(ra_buf);
+						ra_buf = NULL;
+					}
+				}
+			}
+			if (rc != EOK) {
+				/*
+				 * Single-block read; also the fallback when
+				 * the read-ahead batch could not be fetched.
+				 */
+				rc = read_blocks(devcon, b->pba,
+				    cache->blocks_cluster, b->data,
+				    cache->lblock_size);
+				if (rc != EOK)
+					b->toxic = true;
+			}
 		} else
 			rc = EOK;
 
 		fibril_mutex_unlock(&b->lock);
+
+		/*
+		 * Seed the cache with the read-ahead surplus.  This must be
+		 * done after unlocking the block: a concurrent block_get()
+		 * may be waiting for the block's lock while holding the
+		 * cache lock.
+		 */
+		if (ra_buf) {
+			cache_readahead_insert(devcon, ba + 1,
+			    ra_buf + cache->lblock_size, ra_cnt);
+			free(ra_buf);
+			ra_buf = NULL;
+		}
 	}
 out:
 	if ((rc != EOK) && b) {
@@ -767,6 +1500,34 @@ errno_t block_read_direct(service_id_t service_id, aoff64_t ba, size_t cnt, void
 	return read_blocks(devcon, ba, cnt, buf, devcon->pblock_size * cnt);
 }
 
+/** Read several block segments directly from device (bypass cache).
+ *
+ * All segments are read in a single device round trip; the data is stored
+ * in @a buf back to back, in segment order.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param segs		Array of (address, count) segments (physical).
+ * @param nsegs		Number of segments.
+ * @param buf		Buffer for storing the data.
+ *
+ * @return		EOK on success or an error code on failure.
+ */
+errno_t block_readv_direct(service_id_t service_id, const bd_seg_t *segs,
+    size_t nsegs, void *buf)
+{
+	devcon_t *devcon;
+
+	devcon = devcon_search(service_id);
+	assert(devcon);
+
+	size_t cnt = 0;
+	for (size_t i = 0; i < nsegs; i++)
+		cnt += segs[i].cnt;
+
+	return bd_readv(devcon->bd, segs, nsegs, buf,
+	    devcon->pblock_size * cnt);
+}
+
 /** Write blocks directly to device (bypass cache).
  *
  * @param service_id	Service ID of the block device.
@@ -787,6 +1548,121 @@ errno_t block_write_direct(service_id_t service_id, aoff64_t ba, size_t cnt,
 	return write_blocks(devcon, ba, cnt, (void *)data, devcon->pblock_size * cnt);
 }
 
+/** Write several block segments directly to device (bypass cache).
+ *
+ * All segments are written in a single device round trip; the data of the
+ * segments is taken from @a data back to back, in segment order.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param segs		Array of (address, count) segments (physical).
+ * @param nsegs		Number of segments.
+ * @param data		The data to be written.
+ *
+ * @return		EOK on success or an error code on failure.
+ */
+errno_t block_writev_direct(service_id_t service_id, const bd_seg_t *segs,
+    size_t nsegs, const void *data)
+{
+	devcon_t *devcon;
+
+	devcon = devcon_search(service_id);
+	assert(devcon);
+
+	size_t cnt = 0;
+	for (size_t i = 0; i < nsegs; i++)
+		cnt += segs[i].cnt;
+
+	return bd_writev(devcon->bd, segs, nsegs, data,
+	    devcon->pblock_size * cnt);
+}
+
+/** Send the pending discard ranges of a device to the device.
+ *
+ * Must be called with the discard lock held.
+ */
+static void discard_flush_locked(devcon_t *devcon)
+{
+	for (unsigned i = 0; i < devcon->discard_npend; i++) {
+		errno_t rc = bd_discard(devcon->bd, devcon->discard_pend[i].ba,
+		    devcon->discard_pend[i].cnt);
+		if (rc == ENOTSUP) {
+			devcon->discard_unsup = true;
+			break;
+		}
+		/* Discard is only advisory; other errors are ignored. */
+	}
+
+	devcon->discard_npend = 0;
+}
+
+/** Tell the device that blocks no longer contain useful data.
+ *
+ * Lets the device unmap the blocks, e.g. TRIM them on an SSD or return
+ * them to the pool of a thin-provisioned volume. Discards are batched:
+ * adjacent ranges are merged and the accumulated ranges are sent to the
+ * device only once enough of them pile up, or on block_sync_cache() and
+ * block_fini(). The operation is advisory; devices without discard
+ * support turn it into a no-op.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param ba		Address of the first block (logical).
+ * @param cnt		Number of blocks.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t block_discard(service_id_t service_id, aoff64_t ba, size_t cnt)
+{
+	devcon_t *devcon;
+
+	devcon = devcon_search(service_id);
+	assert(devcon);
+
+	if (devcon->discard_unsup || cnt == 0)
+		return EOK;
+
+	aoff64_t pba;
+	size_t pcnt;
+	if (devcon->cache != NULL) {
+		pba = ba_ltop(devcon, ba);
+		pcnt = cnt * devcon->cache->blocks_cluster;
+	} else {
+		pba = ba;
+		pcnt = cnt;
+	}
+
+	fibril_mutex_lock(&devcon->discard_lock);
+
+	/* Merge with a pending range if the new range is adjacent to it. */
+	for (unsigned i = 0; i < devcon->discard_npend; i++) {
+		discard_range_t *r = &devcon->discard_pend[i];
+
+		if (r->ba + r->cnt == pba) {
+			r->cnt += pcnt;
+			fibril_mutex_unlock(&devcon->discard_lock);
+			return EOK;
+		}
+
+		if (pba + pcnt == r->ba) {
+			r->ba = pba;
+			r->cnt += pcnt;
+			fibril_mutex_unlock(&devcon->discard_lock);
+			return EOK;
+		}
+	}
+
+	if (devcon->discard_npend == DISCARD_BATCH_RANGES)
+		discard_flush_locked(devcon);
+
+	if (!devcon->discard_unsup) {
+		devcon->discard_pend[devcon->discard_npend].ba = pba;
+		devcon->discard_pend[devcon->discard_npend].cnt = pcnt;
+		devcon->discard_npend++;
+	}
+
+	fibril_mutex_unlock(&devcon->discard_lock);
+	return EOK;
+}
+
 /** Synchronize blocks to persistent storage.
  *
  * @param service_id	Service ID of the block device.
@@ -802,6 +1678,11 @@ errno_t block_sync_cache(service_id_t service_id, aoff64_t ba, size_t cnt)
 	devcon = devcon_search(service_id);
 	assert(devcon);
 
+	/* Push out batched discards before making the data durable. */
+	fibril_mutex_lock(&devcon->discard_lock);
+	discard_flush_locked(devcon);
+	fibril_mutex_unlock(&devcon->discard_lock);
+
 	return bd_sync_cache(devcon->bd, ba, cnt);
 }
 
@@ -921,7 +1802,11 @@ static errno_t read_blocks(devcon_t *devcon, aoff64_t ba, size_t cnt, void *buf,
 {
 	assert(devcon);
 
-	errno_t rc = bd_read_blocks(devcon->bd, ba, cnt, buf, size);
+	errno_t rc;
+	if (devcon->sched != NULL)
+		rc = sched_submit(devcon, false, ba, cnt, buf, size);
+	else
+		rc = bd_read_blocks(devcon->bd, ba, cnt, buf, size);
 	if (rc != EOK) {
 		printf("Error %s reading %zu blocks starting at block %" PRIuOFF64
 		    " from device handle %" PRIun "\n", str_error_name(rc), cnt, ba,
@@ -948,7 +1833,11 @@ static errno_t write_blocks(devcon_t *devcon, aoff64_t ba, size_t cnt, void *dat
 {
 	assert(devcon);
 
-	errno_t rc = bd_write_blocks(devcon->bd, ba, cnt, data, size);
+	errno_t rc;
+	if (devcon->sched != NULL)
+		rc = sched_submit(devcon, true, ba, cnt, data, size);
+	else
+		rc = bd_write_blocks(devcon->bd, ba, cnt, data, size);
 	if (rc != EOK) {
 		printf("Error %s writing %zu blocks starting at block %" PRIuOFF64
 		    " to device handle %" PRIun "\n", str_error_name(rc), cnt, ba, devcon->service_id);
@@ -40,6 +40,7 @@
 
 #include <offset.h>
 #include <async.h>
+#include <bd.h>
 #include <fibril_synch.h>
 #include <adt/hash_table.h>
 #include <adt/list.h>
@@ -98,13 +99,28 @@ enum cache_mode {
 	CACHE_MODE_WB
 };
 
+/** I/O scheduling policy */
+typedef enum {
+	/** Dispatch requests in arrival order */
+	BLOCK_SCHED_FIFO,
+	/** Merge adjacent requests, dispatch in arrival order */
+	BLOCK_SCHED_MERGE,
+	/** Merge adjacent requests, dispatch in elevator order bounded
+	 * by a per-request deadline
+	 */
+	BLOCK_SCHED_DEADLINE
+} block_sched_policy_t;
+
 extern errno_t block_init(service_id_t, size_t);
 extern void block_fini(service_id_t);
 
+extern errno_t block_sched_set(service_id_t, block_sched_policy_t, unsigned);
+
 extern errno_t block_bb_read(service_id_t, aoff64_t);
 extern void *block_bb_get(service_id_t);
 
 extern errno_t block_cache_init(service_id_t, size_t, unsigned, enum cache_mode);
+extern void block_cache_read_ahead_set(service_id_t, unsigned);
 extern errno_t block_cache_fini(service_id_t);
 
 extern errno_t block_get(block_t **, service_id_t, aoff64_t, int);
@@ -117,9 +133,14 @@ extern errno_t block_get_bsize(service_id_t, size_t *);
 extern errno_t block_get_nblocks(service_id_t, aoff64_t *);
 extern errno_t block_read_toc(service_id_t, uint8_t, void *, size_t);
 extern errno_t block_read_direct(service_id_t, aoff64_t, size_t, void *);
+extern errno_t block_readv_direct(service_id_t, const bd_seg_t *, size_t,
+    void *);
 extern errno_t block_read_bytes_direct(service_id_t, aoff64_t, size_t, void *);
 extern errno_t block_write_direct(service_id_t, aoff64_t, size_t, const void *);
+extern errno_t block_writev_direct(service_id_t, const bd_seg_t *, size_t,
+    const void *);
 extern errno_t block_sync_cache(service_id_t, aoff64_t, size_t);
+extern errno_t block_discard(service_id_t, aoff64_t, size_t);
 
 #endif
 
@@ -1086,6 +1086,7 @@ void async_hangup(async_sess_t *sess)
 		free(exch);
 	}
 
+	async_window_teardown(sess);
 	free(sess);
 
 	fibril_mutex_unlock(&async_sess_mutex);
@@ -1293,6 +1294,138 @@ errno_t async_share_out_start(async_exch_t *exch, void *src, unsigned int flags)
 	    (sysarg_t) flags);
 }
 
+/** Establish a persistent shared bulk-transfer window for a session.
+ *
+ * Creates an address space area and shares it out to the server, which is
+ * expected to accept it with async_window_accept(). Once established, bulk
+ * payloads can be staged in the window with async_window_write() and
+ * async_window_read() and described to the peer as mere offset/length pairs
+ * in protocol arguments, avoiding the kernel copies of IPC_M_DATA_READ and
+ * IPC_M_DATA_WRITE on every transfer.
+ *
+ * The protocol between client and server determines when (and whether) the
+ * window is established and how concurrent transfers divide the window
+ * between them; the framework only provides the transport.
+ *
+ * @param exch Exchange for the share-out handshake.
+ * @param size Size of the window in bytes.
+ *
+ * @return Zero on success or an error code from errno.h.
+ *
+ */
+errno_t async_window_setup(async_exch_t *exch, size_t size)
+{
+	if (exch == NULL)
+		return ENOENT;
+
+	if (size == 0)
+		return EINVAL;
+
+	async_sess_t *sess = exch->sess;
+	if (sess->window_base != NULL)
+		return EBUSY;
+
+	void *base = as_area_create(AS_AREA_ANY, size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (base == AS_MAP_FAILED)
+		return ENOMEM;
+
+	errno_t rc = async_share_out_start(exch, base,
+	    AS_AREA_READ | AS_AREA_WRITE);
+	if (rc != EOK) {
+		as_area_destroy(base);
+		return rc;
+	}
+
+	sess->window_base = base;
+	sess->window_size = size;
+	return EOK;
+}
+
+/** Destroy the session's shared bulk-transfer window, if any.
+ *
+ * The caller is responsible for making sure the server side no longer
+ * expects window-based transfers on this session.
+ */
+void async_window_teardown(async_sess_t *sess)
+{
+	if (sess->window_base != NULL) {
+		as_area_destroy(sess->window_base);
+		sess->window_base = NULL;
+		sess->window_size = 0;
+	}
+}
+
+/** Get the session's shared bulk-transfer window.
+ *
+ * @param sess Session.
+ * @param base Optional storage for the window base address.
+ * @param size Optional storage for the window size.
+ *
+ * @return True if the session has a window established.
+ *
+ */
+bool async_window_get(async_sess_t *sess, void **base, size_t *size)
+{
+	if (sess->window_base == NULL)
+		return false;
+
+	if (base)
+		*base = sess->window_base;
+	if (size)
+		*size = sess->window_size;
+
+	return true;
+}
+
+/** Stage data in the session's shared bulk-transfer window.
+ *
+ * @param sess   Session with an established window.
+ * @param offset Offset into the window.
+ * @param src    Source buffer.
+ * @param size   Number of bytes to copy.
+ *
+ * @return ENOENT if the session has no window, ELIMIT if the range does
+ *         not fit into it, zero on success.
+ *
+ */
+errno_t async_window_write(async_sess_t *sess, size_t offset, const void *src,
+    size_t size)
+{
+	if (sess->window_base == NULL)
+		return ENOENT;
+
+	if (offset > sess->window_size || size > sess->window_size - offset)
+		return ELIMIT;
+
+	memcpy((uint8_t *) sess->window_base + offset, src, size);
+	return EOK;
+}
+
+/** Retrieve data from the session's shared bulk-transfer window.
+ *
+ * @param sess   Session with an established window.
+ * @param offset Offset into the window.
+ * @param dst    Destination buffer.
+ * @param size   Number of bytes to copy.
+ *
+ * @return ENOENT if the session has no window, ELIMIT if the range does
+ *         not fit into it, zero on success.
+ *
+ */
+errno_t async_window_read(async_sess_t *sess, size_t offset, void *dst,
+    size_t size)
+{
+	if (sess->window_base == NULL)
+		return ENOENT;
+
+	if (offset > sess->window_size || size > sess->window_size - offset)
+		return ELIMIT;
+
+	memcpy(dst, (uint8_t *) sess->window_base + offset, size);
+	return EOK;
+}
+
 /** Start IPC_M_DATA_READ using the async framework.
  *
  * @param exch    Exchange for sending the message.
@@ -1328,6 +1461,23 @@ errno_t async_data_read_start(async_exch_t *exch, void *dst, size_t size)
 	    (sysarg_t) size);
 }
 
+/** Start IPC_M_DATA_WRITE using the async framework.
+ *
+ * @param exch    Exchange for sending the message.
+ * @param src     Address of the beginning of the source buffer.
+ * @param size    Size of the source buffer (in bytes).
+ * @param dataptr Storage of call data (arg 2 holds actual data size).
+ *
+ * @return Hash of the sent message or 0 on error.
+ *
+ */
+aid_t async_data_write(async_exch_t *exch, const void *src, size_t size,
+    ipc_call_t *dataptr)
+{
+	return async_send_2(exch, IPC_M_DATA_WRITE, (sysarg_t) src,
+	    (sysarg_t) size, dataptr);
+}
+
 /** Wrapper for IPC_M_DATA_WRITE calls using the async framework.
  *
  * @param exch Exchange for sending the message.
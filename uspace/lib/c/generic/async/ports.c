@@ -42,6 +42,7 @@
 #include <errno.h>
 #include <time.h>
 #include <barrier.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <mem.h>
@@ -80,6 +81,48 @@ typedef struct {
 	void *data;
 } port_t;
 
+/** Number of slots in the connection dispatch cache. */
+#define PORT_CACHE_SLOTS  64
+
+/** Connection dispatch cache slot.
+ *
+ * Ports are never destroyed, so a published slot is immutable and the
+ * cache can be probed without taking the interface mutex: the writer
+ * fills in the slot and then publishes it with a release store of
+ * @c used, the reader checks @c used with an acquire load before
+ * touching the other fields.
+ */
+typedef struct {
+	/** True iff the slot has been published */
+	atomic_bool used;
+
+	/** Interface ID */
+	iface_t iface;
+
+	/** Port ID */
+	port_id_t id;
+
+	/** Port connection handler */
+	async_port_handler_t handler;
+
+	/** Client data */
+	void *data;
+} port_cache_slot_t;
+
+/** Flat cache of ports keyed by interface and port ID.
+ *
+ * Insert-only; filled under the interface mutex, probed lock-free.
+ * Ports that do not fit take the locked lookup path.
+ */
+static port_cache_slot_t port_cache[PORT_CACHE_SLOTS];
+
+/** True iff some port did not fit in the dispatch cache.
+ *
+ * While false, every existing port is cached and a cache miss can be
+ * resolved to the fallback handler without taking the mutex.
+ */
+static atomic_bool port_cache_overflow = false;
+
 /** Default fallback fibril function.
  *
  * This fallback fibril function gets called on incomming connections that do
@@ -158,6 +201,80 @@ static const hash_table_ops_t port_hash_table_ops = {
 	.remove_callback = NULL
 };
 
+/** Return cache slot index for interface and port ID. */
+static size_t port_cache_index(iface_t iface, port_id_t port_id)
+{
+	return hash_mix(hash_combine(iface, port_id)) % PORT_CACHE_SLOTS;
+}
+
+/** Publish port in the connection dispatch cache.
+ *
+ * Must be called with the interface mutex held. If the cache is full,
+ * the port is simply not cached and lookups for it take the locked
+ * path.
+ *
+ * @param iface Interface ID
+ * @param port Port to publish
+ */
+static void port_cache_insert(iface_t iface, port_t *port)
+{
+	size_t idx = port_cache_index(iface, port->id);
+	size_t i;
+
+	for (i = 0; i < PORT_CACHE_SLOTS; i++) {
+		port_cache_slot_t *slot =
+		    &port_cache[(idx + i) % PORT_CACHE_SLOTS];
+
+		if (!atomic_load_explicit(&slot->used,
+		    memory_order_relaxed)) {
+			slot->iface = iface;
+			slot->id = port->id;
+			slot->handler = port->handler;
+			slot->data = port->data;
+			atomic_store_explicit(&slot->used, true,
+			    memory_order_release);
+			return;
+		}
+	}
+
+	atomic_store_explicit(&port_cache_overflow, true,
+	    memory_order_release);
+}
+
+/** Look up port in the connection dispatch cache.
+ *
+ * Lock-free. Since the cache is insert-only, an empty slot terminates
+ * the probe sequence.
+ *
+ * @param iface Interface ID
+ * @param port_id Port ID
+ * @param handler Place to store the port connection handler
+ * @param data Place to store the client data
+ * @return True iff the port was found in the cache
+ */
+static bool port_cache_find(iface_t iface, port_id_t port_id,
+    async_port_handler_t *handler, void **data)
+{
+	size_t idx = port_cache_index(iface, port_id);
+	size_t i;
+
+	for (i = 0; i < PORT_CACHE_SLOTS; i++) {
+		port_cache_slot_t *slot =
+		    &port_cache[(idx + i) % PORT_CACHE_SLOTS];
+
+		if (!atomic_load_explicit(&slot->used, memory_order_acquire))
+			return false;
+
+		if (slot->iface == iface && slot->id == port_id) {
+			*handler = slot->handler;
+			*data = slot->data;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static interface_t *async_new_interface(iface_t iface)
 {
 	interface_t *interface =
@@ -224,6 +341,8 @@ errno_t async_create_port_internal(iface_t iface, async_port_handler_t handler,
 		return ENOMEM;
 	}
 
+	port_cache_insert(iface, port);
+
 	*port_id = port->id;
 
 	fibril_rmutex_unlock(&interface_mutex);
@@ -274,9 +393,23 @@ async_port_handler_t async_get_port_handler(iface_t iface, port_id_t port_id,
 {
 	assert(data);
 
-	async_port_handler_t handler = fallback_port_handler;
+	async_port_handler_t handler;
+
+	/* Fast path: single lock-free probe of the dispatch cache. */
+	if (port_cache_find(iface, port_id, &handler, data))
+		return handler;
+
+	/*
+	 * While the cache holds every existing port, a miss resolves
+	 * to the fallback handler without taking the mutex.
+	 */
+	handler = fallback_port_handler;
 	*data = fallback_port_data;
 
+	if (!atomic_load_explicit(&port_cache_overflow, memory_order_acquire))
+		return handler;
+
+	/* Slow path for ports that did not fit in the cache. */
 	port_t *port = async_find_port(iface, port_id);
 	if (port) {
 		handler = port->handler;
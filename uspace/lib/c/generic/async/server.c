@@ -229,6 +229,23 @@ static long notification_freelist_used = 0;
 
 static sysarg_t notification_avail = 0;
 
+/** Number of calls whose receive stamp can be pending at one time */
+#define LATENCY_PENDING_SLOTS  64
+
+/** Receive stamp of a call that has not been answered yet */
+typedef struct {
+	cap_call_handle_t chandle;
+	uint64_t recv_nsec;
+} latency_pending_t;
+
+static fibril_rmutex_t latency_mutex;
+
+/** True when receive-to-answer times of calls are being measured */
+static bool latency_enabled = false;
+
+static latency_pending_t latency_pending[LATENCY_PENDING_SLOTS];
+static async_lat_stats_t latency_stats;
+
 static size_t client_key_hash(const void *key)
 {
 	const task_id_t *in_task_id = key;
@@ -748,7 +765,7 @@ errno_t async_irq_subscribe(int inr, async_notification_handler_t handler,
 		return ENOMEM;
 
 	cap_irq_handle_t ihandle;
-	errno_t rc = ipc_irq_subscribe(inr, notification->imethod, ucode,
+	errno_t rc = ipc_irq_subscribe(inr, notification->imethod, ucode, 0,
 	    &ihandle);
 	if (rc == EOK && handle != NULL) {
 		*handle = ihandle;
@@ -915,6 +932,125 @@ void async_put_client_data_by_id(task_id_t client_id)
 	async_client_put(client);
 }
 
+/** Get the current uptime in nanoseconds */
+static uint64_t latency_now_nsec(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return (uint64_t) SEC2NSEC(ts.tv_sec) + ts.tv_nsec;
+}
+
+/** Convert a latency in nanoseconds to its histogram bucket index */
+static size_t latency_bucket(uint64_t nsec)
+{
+	size_t bucket = 0;
+
+	while ((nsec >>= 1) != 0)
+		bucket++;
+
+	if (bucket >= ASYNC_LAT_BUCKETS)
+		bucket = ASYNC_LAT_BUCKETS - 1;
+
+	return bucket;
+}
+
+/** Record the receive time of a call for latency measurement.
+ *
+ * If all pending slots are taken, the call is simply not measured.
+ *
+ * @param call Data of the incoming call.
+ *
+ */
+static void latency_call_received(ipc_call_t *call)
+{
+	if (!latency_enabled)
+		return;
+
+	uint64_t now = latency_now_nsec();
+
+	fibril_rmutex_lock(&latency_mutex);
+
+	for (size_t i = 0; i < LATENCY_PENDING_SLOTS; i++) {
+		if (latency_pending[i].chandle == CAP_NIL) {
+			latency_pending[i].chandle = call->cap_handle;
+			latency_pending[i].recv_nsec = now;
+			break;
+		}
+	}
+
+	fibril_rmutex_unlock(&latency_mutex);
+}
+
+/** Account an answered call into the latency statistics.
+ *
+ * Calls whose receive time was not recorded (measurement was enabled
+ * after they arrived, or the pending slots were full) are ignored.
+ *
+ * @param chandle Capability handle of the answered call.
+ *
+ */
+static void latency_call_answered(cap_call_handle_t chandle)
+{
+	if (!latency_enabled)
+		return;
+
+	uint64_t now = latency_now_nsec();
+
+	fibril_rmutex_lock(&latency_mutex);
+
+	for (size_t i = 0; i < LATENCY_PENDING_SLOTS; i++) {
+		if (latency_pending[i].chandle == chandle) {
+			uint64_t nsec = now - latency_pending[i].recv_nsec;
+
+			latency_pending[i].chandle = CAP_NIL;
+
+			latency_stats.count++;
+			latency_stats.total_nsec += nsec;
+			latency_stats.buckets[latency_bucket(nsec)]++;
+			break;
+		}
+	}
+
+	fibril_rmutex_unlock(&latency_mutex);
+}
+
+/** Enable or disable server-side IPC latency measurement.
+ *
+ * While enabled, the time between the reception of a call by the
+ * async framework and its answer is accounted into a histogram.
+ * Enabling resets previously collected statistics.
+ *
+ * @param enable True to enable the measurement, false to disable it.
+ *
+ */
+void async_latency_enable(bool enable)
+{
+	fibril_rmutex_lock(&latency_mutex);
+
+	if (enable && !latency_enabled) {
+		memset(&latency_stats, 0, sizeof(latency_stats));
+		for (size_t i = 0; i < LATENCY_PENDING_SLOTS; i++)
+			latency_pending[i].chandle = CAP_NIL;
+	}
+
+	latency_enabled = enable;
+
+	fibril_rmutex_unlock(&latency_mutex);
+}
+
+/** Get a snapshot of the server-side IPC latency statistics.
+ *
+ * @param stats Place to store the statistics.
+ *
+ */
+void async_latency_get(async_lat_stats_t *stats)
+{
+	fibril_rmutex_lock(&latency_mutex);
+	*stats = latency_stats;
+	fibril_rmutex_unlock(&latency_mutex);
+}
+
 /** Handle a call that was received.
  *
  * If the call has the IPC_M_CONNECT_ME_TO method, a new connection is created.
@@ -941,6 +1077,8 @@ static void handle_call(ipc_call_t *call)
 		return;
 	}
 
+	latency_call_received(call);
+
 	/* New connection */
 	if (ipc_get_imethod(call) == IPC_M_CONNECT_ME_TO) {
 		connection_t *conn = calloc(1, sizeof(*conn));
@@ -1022,6 +1160,8 @@ void __async_server_init(void)
 		abort();
 	if (fibril_rmutex_initialize(&notification_mutex) != EOK)
 		abort();
+	if (fibril_rmutex_initialize(&latency_mutex) != EOK)
+		abort();
 
 	if (!hash_table_create(&client_hash_table, 0, 0, &client_hash_table_ops))
 		abort();
@@ -1037,6 +1177,7 @@ void __async_server_fini(void)
 {
 	fibril_rmutex_destroy(&client_mutex);
 	fibril_rmutex_destroy(&notification_mutex);
+	fibril_rmutex_destroy(&latency_mutex);
 }
 
 errno_t async_accept_0(ipc_call_t *call)
@@ -1044,6 +1185,7 @@ errno_t async_accept_0(ipc_call_t *call)
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
+	latency_call_answered(chandle);
 	return ipc_answer_5(chandle, EOK, 0, 0, 0, 0, async_get_label());
 }
 
@@ -1052,6 +1194,7 @@ errno_t async_answer_0(ipc_call_t *call, errno_t retval)
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
+	latency_call_answered(chandle);
 	return ipc_answer_0(chandle, retval);
 }
 
@@ -1060,6 +1203,7 @@ errno_t async_answer_1(ipc_call_t *call, errno_t retval, sysarg_t arg1)
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
+	latency_call_answered(chandle);
 	return ipc_answer_1(chandle, retval, arg1);
 }
 
@@ -1069,6 +1213,7 @@ errno_t async_answer_2(ipc_call_t *call, errno_t retval, sysarg_t arg1,
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
+	latency_call_answered(chandle);
 	return ipc_answer_2(chandle, retval, arg1, arg2);
 }
 
@@ -1078,6 +1223,7 @@ errno_t async_answer_3(ipc_call_t *call, errno_t retval, sysarg_t arg1,
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
+	latency_call_answered(chandle);
 	return ipc_answer_3(chandle, retval, arg1, arg2, arg3);
 }
 
@@ -1087,6 +1233,7 @@ errno_t async_answer_4(ipc_call_t *call, errno_t retval, sysarg_t arg1,
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
+	latency_call_answered(chandle);
 	return ipc_answer_4(chandle, retval, arg1, arg2, arg3, arg4);
 }
 
@@ -1096,6 +1243,7 @@ errno_t async_answer_5(ipc_call_t *call, errno_t retval, sysarg_t arg1,
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
+	latency_call_answered(chandle);
 	return ipc_answer_5(chandle, retval, arg1, arg2, arg3, arg4, arg5);
 }
 
@@ -1307,6 +1455,51 @@ errno_t async_share_out_finalize(ipc_call_t *call, void **dst)
 	    (sysarg_t) dst);
 }
 
+/** Accept a shared bulk-transfer window offered by the client.
+ *
+ * The connection handler calls this at the point where the protocol says
+ * the client establishes its session window with async_window_setup().
+ * The mapping persists for the lifetime of the connection; subsequent
+ * bulk transfers arrive as offset/length descriptors into the window
+ * instead of IPC_M_DATA_READ/WRITE round trips.
+ *
+ * @param base Storage for the mapped window base address.
+ * @param size Storage for the window size.
+ *
+ * @return Zero on success or an error code from errno.h. The handshake
+ *         call is answered with the same code on failure.
+ *
+ */
+errno_t async_window_accept(void **base, size_t *size)
+{
+	assert(base);
+	assert(size);
+
+	ipc_call_t call;
+	size_t wsize;
+	unsigned int flags;
+
+	if (!async_share_out_receive(&call, &wsize, &flags)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	if ((flags & (AS_AREA_READ | AS_AREA_WRITE)) !=
+	    (AS_AREA_READ | AS_AREA_WRITE)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	void *dst = AS_AREA_ANY;
+	errno_t rc = async_share_out_finalize(&call, &dst);
+	if (rc != EOK)
+		return rc;
+
+	*base = dst;
+	*size = wsize;
+	return EOK;
+}
+
 /** Wrapper for receiving the IPC_M_DATA_READ calls using the async framework.
  *
  * This wrapper only makes it more comfortable to receive IPC_M_DATA_READ
@@ -33,6 +33,7 @@
  */
 
 #include <vfs/vfs.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <dirent.h>
 #include <stddef.h>
@@ -40,10 +41,19 @@
 #include <assert.h>
 #include <string.h>
 
+/** Size of the entry name read-ahead buffer. */
+#define DIR_BUF_SIZE  4096
+
 struct __dirstream {
 	int fd;
 	struct dirent res;
 	aoff64_t pos;
+	/** Read-ahead buffer of consecutive null-terminated entry names. */
+	char buf[DIR_BUF_SIZE];
+	size_t buf_used;
+	size_t buf_off;
+	/** False if the server does not support batched directory reads. */
+	bool bulk_ok;
 };
 
 /** Open directory.
@@ -78,6 +88,9 @@ DIR *opendir(const char *dirname)
 
 	dirp->fd = fd;
 	dirp->pos = 0;
+	dirp->buf_used = 0;
+	dirp->buf_off = 0;
+	dirp->bulk_ok = true;
 	return dirp;
 }
 
@@ -92,6 +105,36 @@ struct dirent *readdir(DIR *dirp)
 	errno_t rc;
 	ssize_t len = 0;
 
+	while (dirp->bulk_ok) {
+		if (dirp->buf_off < dirp->buf_used) {
+			/* Serve the next entry from the read-ahead buffer. */
+			const char *name = dirp->buf + dirp->buf_off;
+			size_t size = strnlen(name,
+			    dirp->buf_used - dirp->buf_off) + 1;
+
+			assert(size <= sizeof(dirp->res.d_name));
+
+			memcpy(dirp->res.d_name, name, size);
+			dirp->buf_off += size;
+			return &dirp->res;
+		}
+
+		/* Refill the buffer with one exchange. */
+		dirp->buf_off = 0;
+		dirp->buf_used = 0;
+		rc = vfs_readdir_bulk(dirp->fd, &dirp->pos, dirp->buf,
+		    sizeof(dirp->buf), &dirp->buf_used);
+		if (rc == ENOTSUP) {
+			/* Talking to an old server; read entry by entry. */
+			dirp->bulk_ok = false;
+			break;
+		}
+		if (rc != EOK || dirp->buf_used == 0) {
+			errno = (rc != EOK) ? rc : ENOENT;
+			return NULL;
+		}
+	}
+
 	rc = vfs_read_short(dirp->fd, dirp->pos, dirp->res.d_name,
 	    sizeof(dirp->res.d_name), &len);
 	if (rc != EOK) {
@@ -113,6 +156,8 @@ struct dirent *readdir(DIR *dirp)
 void rewinddir(DIR *dirp)
 {
 	dirp->pos = 0;
+	dirp->buf_used = 0;
+	dirp->buf_off = 0;
 }
 
 /** Close directory.
@@ -84,6 +84,19 @@ static fp_num_t multiply(fp_num_t x, fp_num_t y)
 {
 	assert(/* is_normalized(x) && */ is_normalized(y));
 
+#ifdef __SIZEOF_INT128__
+	unsigned __int128 prod =
+	    (unsigned __int128) x.significand * y.significand;
+
+	/* Round upwards. */
+	prod += (unsigned __int128) 1 << (significand_width - 1);
+
+	fp_num_t ret;
+	ret.significand = (uint64_t) (prod >> significand_width);
+	ret.exponent = x.exponent + y.exponent + significand_width;
+
+	return ret;
+#else
 	const uint32_t low_bits = -1;
 
 	uint64_t a, b, c, d;
@@ -125,6 +138,7 @@ static fp_num_t multiply(fp_num_t x, fp_num_t y)
 	ret.exponent = x.exponent + y.exponent + significand_width;
 
 	return ret;
+#endif
 }
 
 /** Returns a - b. Both must have the same exponent. */
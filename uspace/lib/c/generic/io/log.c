@@ -31,10 +31,15 @@
  * @{
  */
 
+#include <adt/list.h>
+#include <align.h>
 #include <assert.h>
+#include <barrier.h>
 #include <errno.h>
 #include <fibril_synch.h>
+#include <mem.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <async.h>
@@ -66,6 +71,36 @@ static async_sess_t *logger_session;
 /** Maximum length of a single log message (in bytes). */
 #define MESSAGE_BUFFER_SIZE 4096
 
+/** Message ring shared with the logger service (NULL if not set up). */
+static logger_ring_t *log_ring = NULL;
+
+/** Size of the data area of the shared message ring. */
+static size_t log_ring_dsize;
+
+/** Lock serializing producers of the shared message ring. */
+static FIBRIL_MUTEX_INITIALIZE(log_ring_mutex);
+
+/** Format string registered with the logger service. */
+typedef struct {
+	link_t link;
+	char *fmt;
+	uint32_t id;
+} log_fmt_t;
+
+/** Format strings registered with the logger service. */
+static LIST_INITIALIZE(log_fmts);
+static FIBRIL_MUTEX_INITIALIZE(log_fmts_mutex);
+
+/** Arguments captured from one format string. */
+typedef struct {
+	uint8_t atype[LOGGER_RING_MAX_ARGS];
+	uint64_t aval[LOGGER_RING_MAX_ARGS];
+	const char *astr[LOGGER_RING_MAX_ARGS];
+	size_t astr_size[LOGGER_RING_MAX_ARGS];
+	unsigned argc;
+	size_t str_bytes;
+} log_ring_args_t;
+
 /** Send formatted message to the logger service.
  *
  * @param session Initialized IPC session with the logger.
@@ -108,6 +143,420 @@ static errno_t logger_message(async_sess_t *session, log_t log, log_level_t leve
 	return reg_msg_rc;
 }
 
+/** Share a message ring with the logger service.
+ *
+ * Failure is not fatal: messages simply keep using the synchronous
+ * protocol.
+ */
+static void log_ring_setup(void)
+{
+	async_exch_t *exchange = async_exchange_begin(logger_session);
+	if (exchange == NULL)
+		return;
+
+	aid_t req = async_send_0(exchange, LOGGER_WRITER_CREATE_RING, NULL);
+	errno_t rc = async_window_setup(exchange, LOGGER_RING_SIZE);
+	errno_t req_rc;
+	async_wait_for(req, &req_rc);
+
+	async_exchange_end(exchange);
+
+	if ((rc != EOK) || (req_rc != EOK)) {
+		if (rc == EOK)
+			async_window_teardown(logger_session);
+		return;
+	}
+
+	void *base;
+	size_t size;
+	if (!async_window_get(logger_session, &base, &size))
+		return;
+
+	fibril_mutex_lock(&log_ring_mutex);
+	log_ring = base;
+	log_ring_dsize = size - sizeof(logger_ring_t);
+	fibril_mutex_unlock(&log_ring_mutex);
+}
+
+/** Get the id of a format string, registering it if seen for the first time.
+ *
+ * @param fmt Format string.
+ * @param id Place to store the format id.
+ * @return Error code of the registration or EOK on success.
+ */
+static errno_t log_fmt_get_id(const char *fmt, uint32_t *id)
+{
+	fibril_mutex_lock(&log_fmts_mutex);
+	list_foreach(log_fmts, link, log_fmt_t, entry) {
+		if (str_cmp(entry->fmt, fmt) == 0) {
+			*id = entry->id;
+			fibril_mutex_unlock(&log_fmts_mutex);
+			return EOK;
+		}
+	}
+	fibril_mutex_unlock(&log_fmts_mutex);
+
+	log_fmt_t *entry = calloc(1, sizeof(log_fmt_t));
+	if (entry == NULL)
+		return ENOMEM;
+
+	entry->fmt = str_dup(fmt);
+	if (entry->fmt == NULL) {
+		free(entry);
+		return ENOMEM;
+	}
+
+	async_exch_t *exchange = async_exchange_begin(logger_session);
+	if (exchange == NULL) {
+		free(entry->fmt);
+		free(entry);
+		return ENOMEM;
+	}
+
+	ipc_call_t answer;
+	aid_t req = async_send_0(exchange, LOGGER_WRITER_REGISTER_FMT, &answer);
+	errno_t rc = async_data_write_start(exchange, fmt, str_size(fmt));
+	errno_t req_rc;
+	async_wait_for(req, &req_rc);
+
+	async_exchange_end(exchange);
+
+	if (rc == EOK)
+		rc = req_rc;
+
+	if (rc != EOK) {
+		free(entry->fmt);
+		free(entry);
+		return rc;
+	}
+
+	entry->id = (uint32_t) ipc_get_arg1(&answer);
+	*id = entry->id;
+
+	fibril_mutex_lock(&log_fmts_mutex);
+	list_append(&entry->link, &log_fmts);
+	fibril_mutex_unlock(&log_fmts_mutex);
+
+	return EOK;
+}
+
+/** Capture the arguments of a printf-like format string.
+ *
+ * Only conversions that the logger can replay later are accepted.
+ * Anything else (floating point, variable width, too many arguments)
+ * makes the caller fall back to formatting the message locally.
+ *
+ * @param fmt Format string.
+ * @param args Arguments.
+ * @param ra Place to store the captured arguments.
+ * @return True if all conversions were captured.
+ */
+static bool log_ring_capture_args(const char *fmt, va_list args,
+    log_ring_args_t *ra)
+{
+	ra->argc = 0;
+	ra->str_bytes = 0;
+
+	while (*fmt != 0) {
+		if (*fmt == '\n') {
+			/* The synchronous path trims trailing newlines. */
+			return false;
+		}
+
+		if (*fmt != '%') {
+			fmt++;
+			continue;
+		}
+
+		fmt++;
+
+		/* Flags */
+		while (*fmt == '-' || *fmt == '+' || *fmt == ' ' ||
+		    *fmt == '#' || *fmt == '0')
+			fmt++;
+
+		/* Width */
+		if (*fmt == '*')
+			return false;
+		while (*fmt >= '0' && *fmt <= '9')
+			fmt++;
+
+		/* Precision */
+		if (*fmt == '.') {
+			fmt++;
+			if (*fmt == '*')
+				return false;
+			while (*fmt >= '0' && *fmt <= '9')
+				fmt++;
+		}
+
+		/* Length modifier */
+		enum {
+			lm_none,
+			lm_hh,
+			lm_h,
+			lm_l,
+			lm_ll,
+			lm_z,
+			lm_j,
+			lm_t
+		} lm = lm_none;
+
+		switch (*fmt) {
+		case 'h':
+			fmt++;
+			if (*fmt == 'h') {
+				fmt++;
+				lm = lm_hh;
+			} else {
+				lm = lm_h;
+			}
+			break;
+		case 'l':
+			fmt++;
+			if (*fmt == 'l') {
+				fmt++;
+				lm = lm_ll;
+			} else {
+				lm = lm_l;
+			}
+			break;
+		case 'z':
+			fmt++;
+			lm = lm_z;
+			break;
+		case 'j':
+			fmt++;
+			lm = lm_j;
+			break;
+		case 't':
+			fmt++;
+			lm = lm_t;
+			break;
+		default:
+			break;
+		}
+
+		char conv = *fmt;
+		if (conv == 0)
+			return false;
+		fmt++;
+
+		if (conv == '%') {
+			if (lm != lm_none)
+				return false;
+			continue;
+		}
+
+		if (ra->argc >= LOGGER_RING_MAX_ARGS)
+			return false;
+
+		unsigned i = ra->argc;
+		ra->astr[i] = NULL;
+		ra->astr_size[i] = 0;
+
+		switch (conv) {
+		case 'd':
+		case 'i': {
+			int64_t val;
+
+			switch (lm) {
+			case lm_l:
+				val = va_arg(args, long);
+				break;
+			case lm_ll:
+				val = va_arg(args, long long);
+				break;
+			case lm_z:
+				val = (intptr_t) va_arg(args, size_t);
+				break;
+			case lm_j:
+				val = va_arg(args, intmax_t);
+				break;
+			case lm_t:
+				val = va_arg(args, ptrdiff_t);
+				break;
+			default:
+				val = va_arg(args, int);
+				break;
+			}
+
+			ra->atype[i] = LOGGER_ARG_SIGNED;
+			ra->aval[i] = (uint64_t) val;
+			break;
+		}
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X': {
+			uint64_t val;
+
+			switch (lm) {
+			case lm_l:
+				val = va_arg(args, unsigned long);
+				break;
+			case lm_ll:
+				val = va_arg(args, unsigned long long);
+				break;
+			case lm_z:
+				val = va_arg(args, size_t);
+				break;
+			case lm_j:
+				val = va_arg(args, uintmax_t);
+				break;
+			case lm_t:
+				val = (uint64_t) va_arg(args, ptrdiff_t);
+				break;
+			default:
+				val = va_arg(args, unsigned int);
+				break;
+			}
+
+			ra->atype[i] = LOGGER_ARG_UNSIGNED;
+			ra->aval[i] = val;
+			break;
+		}
+		case 'c':
+			if (lm != lm_none)
+				return false;
+			ra->atype[i] = LOGGER_ARG_UNSIGNED;
+			ra->aval[i] = (uint64_t) va_arg(args, int);
+			break;
+		case 'p':
+			if (lm != lm_none)
+				return false;
+			ra->atype[i] = LOGGER_ARG_UNSIGNED;
+			ra->aval[i] = (uintptr_t) va_arg(args, void *);
+			break;
+		case 's': {
+			if (lm != lm_none)
+				return false;
+			const char *str = va_arg(args, const char *);
+			if (str == NULL)
+				return false;
+			ra->atype[i] = LOGGER_ARG_STR;
+			ra->astr[i] = str;
+			ra->astr_size[i] = str_size(str) + 1;
+			ra->str_bytes += ra->astr_size[i];
+			break;
+		}
+		default:
+			return false;
+		}
+
+		ra->argc++;
+	}
+
+	return true;
+}
+
+/** Try to pass a message via the shared message ring.
+ *
+ * The record carries the format id and the raw arguments; the logger
+ * formats the message lazily (and only if someone wants it).
+ *
+ * @param ctx Log to use.
+ * @param level Severity level of the message.
+ * @param fmt Format string.
+ * @param args Arguments.
+ * @return True if the message was handed over to the logger,
+ *         false if the caller shall use the synchronous protocol.
+ */
+static bool log_ring_msg(log_t ctx, log_level_t level, const char *fmt,
+    va_list args)
+{
+	if (log_ring == NULL)
+		return false;
+
+	log_ring_args_t ra;
+	va_list cargs;
+	va_copy(cargs, args);
+	bool ok = log_ring_capture_args(fmt, cargs, &ra);
+	va_end(cargs);
+	if (!ok)
+		return false;
+
+	uint32_t fmt_id;
+	if (log_fmt_get_id(fmt, &fmt_id) != EOK)
+		return false;
+
+	if (ctx == LOG_DEFAULT)
+		ctx = default_log_id;
+
+	size_t rec_size = ALIGN_UP(sizeof(logger_ring_rec_t) + ra.str_bytes, 8);
+	if (rec_size > log_ring_dsize / 4)
+		return false;
+
+	fibril_mutex_lock(&log_ring_mutex);
+
+	uint64_t wpos = log_ring->wpos;
+	uint64_t rpos = log_ring->rpos;
+	size_t off = (size_t) (wpos % log_ring_dsize);
+
+	/* Records never wrap - pad to the end of the data area instead. */
+	size_t pad = 0;
+	if (rec_size > log_ring_dsize - off)
+		pad = log_ring_dsize - off;
+
+	if (log_ring_dsize - (size_t) (wpos - rpos) < rec_size + pad) {
+		/* Ring is full - fall back to the synchronous protocol. */
+		fibril_mutex_unlock(&log_ring_mutex);
+		return false;
+	}
+
+	if (pad > 0) {
+		logger_ring_rec_t *prec =
+		    (logger_ring_rec_t *) (log_ring->data + off);
+		prec->size = (uint32_t) pad;
+		prec->fmt_id = LOGGER_RING_PAD;
+		off = 0;
+	}
+
+	logger_ring_rec_t *rec = (logger_ring_rec_t *) (log_ring->data + off);
+	rec->size = (uint32_t) rec_size;
+	rec->fmt_id = fmt_id;
+	rec->log_id = (uint64_t) ctx;
+	rec->level = (uint8_t) level;
+	rec->argc = (uint8_t) ra.argc;
+
+	size_t spos = sizeof(logger_ring_rec_t);
+	for (unsigned i = 0; i < ra.argc; i++) {
+		rec->atype[i] = ra.atype[i];
+		if (ra.atype[i] == LOGGER_ARG_STR) {
+			memcpy((uint8_t *) rec + spos, ra.astr[i],
+			    ra.astr_size[i]);
+			rec->aval[i] = (uint64_t) spos;
+			spos += ra.astr_size[i];
+		} else {
+			rec->aval[i] = ra.aval[i];
+		}
+	}
+
+	/* Publish the record before exposing it to the consumer. */
+	write_barrier();
+	log_ring->wpos = wpos + pad + rec_size;
+
+	/*
+	 * Wake the logger only on the empty to non-empty transition;
+	 * otherwise it is draining already and will pick up the new
+	 * record on its own.
+	 */
+	memory_barrier();
+	bool notify = (log_ring->rpos == wpos);
+
+	fibril_mutex_unlock(&log_ring_mutex);
+
+	if (notify) {
+		async_exch_t *exchange = async_exchange_begin(logger_session);
+		if (exchange != NULL) {
+			async_msg_0(exchange, LOGGER_WRITER_RING_NOTIFY);
+			async_exchange_end(exchange);
+		}
+	}
+
+	return true;
+}
+
 /** Get name of the log level.
  *
  * @param level The log level.
@@ -174,6 +623,8 @@ errno_t log_init(const char *prog_name)
 
 	default_log_id = log_create(prog_name, LOG_NO_PARENT);
 
+	log_ring_setup();
+
 	return EOK;
 }
 
@@ -239,6 +690,9 @@ void log_msgv(log_t ctx, log_level_t level, const char *fmt, va_list args)
 {
 	assert(level < LVL_LIMIT);
 
+	if (log_ring_msg(ctx, level, fmt, args))
+		return;
+
 	char *message_buffer = malloc(MESSAGE_BUFFER_SIZE);
 	if (message_buffer == NULL)
 		return;
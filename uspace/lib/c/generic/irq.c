@@ -56,6 +56,7 @@ static const irq_code_t default_ucode = {
  * @param inr    IRQ number.
  * @param method Use this method for notifying me.
  * @param ucode  Top-half pseudocode handler.
+ * @param flags  Notification flags (IRQ_NOTIF_COALESCE).
  *
  * @param[out] out_handle  IRQ capability handle returned by the kernel.
  *
@@ -63,13 +64,13 @@ static const irq_code_t default_ucode = {
  *
  */
 errno_t ipc_irq_subscribe(int inr, sysarg_t method, const irq_code_t *ucode,
-    cap_irq_handle_t *out_handle)
+    sysarg_t flags, cap_irq_handle_t *out_handle)
 {
 	if (ucode == NULL)
 		ucode = &default_ucode;
 
-	return (errno_t) __SYSCALL4(SYS_IPC_IRQ_SUBSCRIBE, inr, method,
-	    (sysarg_t) ucode, (sysarg_t) out_handle);
+	return (errno_t) __SYSCALL5(SYS_IPC_IRQ_SUBSCRIBE, inr, method,
+	    (sysarg_t) ucode, flags, (sysarg_t) out_handle);
 }
 
 /** Unsubscribe from IRQ notification.
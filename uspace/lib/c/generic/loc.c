@@ -27,6 +27,8 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <adt/list.h>
+#include <mem.h>
 #include <str.h>
 #include <ipc/services.h>
 #include <ns.h>
@@ -49,6 +51,38 @@ static void *cat_change_arg = NULL;
 static async_sess_t *loc_cons_block_sess = NULL;
 static async_sess_t *loc_consumer_sess = NULL;
 
+/*
+ * Cache of name to ID resolutions and category memberships. Entries
+ * are valid as long as the cached change generation matches the one
+ * published by the location service. The service sends its current
+ * generation with every change event, so steady-state lookups are
+ * answered locally without a round trip.
+ */
+static FIBRIL_MUTEX_INITIALIZE(loc_cache_mutex);
+static LIST_INITIALIZE(loc_svc_cache);
+static LIST_INITIALIZE(loc_cat_cache);
+static LIST_INITIALIZE(loc_cat_svcs_cache);
+/** Generation the cached entries were resolved at */
+static sysarg_t loc_cache_gen = 0;
+/** Last change generation published by the location service */
+static sysarg_t loc_srv_gen = 0;
+static bool loc_cache_active = false;
+
+/** Cached name to ID resolution. */
+typedef struct {
+	link_t cache;
+	char *name;
+	sysarg_t id;
+} loc_name_cache_t;
+
+/** Cached list of services in a category. */
+typedef struct {
+	link_t cache;
+	category_id_t cat_id;
+	service_id_t *ids;
+	size_t count;
+} loc_cat_svcs_cache_t;
+
 static void loc_cb_conn(ipc_call_t *icall, void *arg)
 {
 	while (true) {
@@ -62,6 +96,11 @@ static void loc_cb_conn(ipc_call_t *icall, void *arg)
 
 		switch (ipc_get_imethod(&call)) {
 		case LOC_EVENT_CAT_CHANGE:
+			/* Invalidate cached resolutions. */
+			fibril_mutex_lock(&loc_cache_mutex);
+			loc_srv_gen = ipc_get_arg1(&call);
+			fibril_mutex_unlock(&loc_cache_mutex);
+
 			fibril_mutex_lock(&loc_callback_mutex);
 			loc_cat_change_cb_t cb_fun = cat_change_cb;
 			void *cb_arg = cat_change_arg;
@@ -126,6 +165,285 @@ static errno_t loc_callback_create(void)
 	return EOK;
 }
 
+/** Drop all cached resolutions.
+ *
+ * Must be called with loc_cache_mutex locked.
+ */
+static void loc_cache_flush(void)
+{
+	link_t *link;
+
+	while (!list_empty(&loc_svc_cache)) {
+		link = list_first(&loc_svc_cache);
+		loc_name_cache_t *entry = list_get_instance(link,
+		    loc_name_cache_t, cache);
+		list_remove(link);
+		free(entry->name);
+		free(entry);
+	}
+
+	while (!list_empty(&loc_cat_cache)) {
+		link = list_first(&loc_cat_cache);
+		loc_name_cache_t *entry = list_get_instance(link,
+		    loc_name_cache_t, cache);
+		list_remove(link);
+		free(entry->name);
+		free(entry);
+	}
+
+	while (!list_empty(&loc_cat_svcs_cache)) {
+		link = list_first(&loc_cat_svcs_cache);
+		loc_cat_svcs_cache_t *entry = list_get_instance(link,
+		    loc_cat_svcs_cache_t, cache);
+		list_remove(link);
+		free(entry->ids);
+		free(entry);
+	}
+
+	loc_cache_gen = loc_srv_gen;
+}
+
+/** Start caching resolutions.
+ *
+ * Make sure we have a callback connection through which the location
+ * service announces changes and store the current change generation.
+ *
+ * @return EOK on success or an error code
+ */
+static errno_t loc_cache_start(void)
+{
+	async_exch_t *exch;
+	sysarg_t gen;
+	errno_t rc;
+
+	fibril_mutex_lock(&loc_cache_mutex);
+	if (loc_cache_active) {
+		fibril_mutex_unlock(&loc_cache_mutex);
+		return EOK;
+	}
+	fibril_mutex_unlock(&loc_cache_mutex);
+
+	fibril_mutex_lock(&loc_callback_mutex);
+	rc = loc_callback_create();
+	fibril_mutex_unlock(&loc_callback_mutex);
+	if (rc != EOK)
+		return rc;
+
+	exch = loc_exchange_begin_blocking();
+	rc = async_req_0_1(exch, LOC_GET_GENERATION, &gen);
+	loc_exchange_end(exch);
+	if (rc != EOK)
+		return rc;
+
+	fibril_mutex_lock(&loc_cache_mutex);
+	if (!loc_cache_active) {
+		/* Change events may have arrived already. */
+		if (loc_srv_gen < gen)
+			loc_srv_gen = gen;
+		loc_cache_gen = loc_srv_gen;
+		loc_cache_active = true;
+	}
+	fibril_mutex_unlock(&loc_cache_mutex);
+
+	return EOK;
+}
+
+/** Get the generation against which a new resolution will be validated. */
+static sysarg_t loc_cache_gen_snapshot(void)
+{
+	sysarg_t gen;
+
+	fibril_mutex_lock(&loc_cache_mutex);
+	gen = loc_srv_gen;
+	fibril_mutex_unlock(&loc_cache_mutex);
+
+	return gen;
+}
+
+/** Look up a cached name resolution.
+ *
+ * @param list Cache list to search
+ * @param name Name to resolve
+ * @param id Place to store the cached ID
+ * @return True if a valid entry was found
+ */
+static bool loc_cache_get_name(list_t *list, const char *name, sysarg_t *id)
+{
+	bool found = false;
+
+	fibril_mutex_lock(&loc_cache_mutex);
+
+	if (!loc_cache_active) {
+		fibril_mutex_unlock(&loc_cache_mutex);
+		return false;
+	}
+
+	if (loc_cache_gen != loc_srv_gen)
+		loc_cache_flush();
+
+	list_foreach(*list, cache, loc_name_cache_t, entry) {
+		if (str_cmp(entry->name, name) == 0) {
+			*id = entry->id;
+			found = true;
+			break;
+		}
+	}
+
+	fibril_mutex_unlock(&loc_cache_mutex);
+	return found;
+}
+
+/** Insert a name resolution into the cache.
+ *
+ * @param list Cache list to insert to
+ * @param name Resolved name
+ * @param id Resolved ID
+ * @param gen Generation the resolution was made at
+ */
+static void loc_cache_insert_name(list_t *list, const char *name, sysarg_t id,
+    sysarg_t gen)
+{
+	loc_name_cache_t *entry;
+
+	entry = calloc(1, sizeof(loc_name_cache_t));
+	if (entry == NULL)
+		return;
+
+	entry->name = str_dup(name);
+	if (entry->name == NULL) {
+		free(entry);
+		return;
+	}
+
+	entry->id = id;
+
+	fibril_mutex_lock(&loc_cache_mutex);
+
+	/* The directory has changed since the resolution - do not cache. */
+	if (!loc_cache_active || gen != loc_srv_gen) {
+		fibril_mutex_unlock(&loc_cache_mutex);
+		free(entry->name);
+		free(entry);
+		return;
+	}
+
+	if (loc_cache_gen != loc_srv_gen)
+		loc_cache_flush();
+
+	/* Another fibril may have inserted the entry in the meantime. */
+	list_foreach(*list, cache, loc_name_cache_t, old) {
+		if (str_cmp(old->name, name) == 0) {
+			fibril_mutex_unlock(&loc_cache_mutex);
+			free(entry->name);
+			free(entry);
+			return;
+		}
+	}
+
+	link_initialize(&entry->cache);
+	list_append(&entry->cache, list);
+	fibril_mutex_unlock(&loc_cache_mutex);
+}
+
+/** Look up a cached list of services in a category.
+ *
+ * On success, return a newly allocated copy which the caller should
+ * free.
+ *
+ * @param cat_id Category ID
+ * @param data Place to store pointer to array of IDs
+ * @param count Place to store number of IDs
+ * @return True if a valid entry was found
+ */
+static bool loc_cache_get_cat_svcs(category_id_t cat_id, service_id_t **data,
+    size_t *count)
+{
+	bool found = false;
+
+	fibril_mutex_lock(&loc_cache_mutex);
+
+	if (!loc_cache_active) {
+		fibril_mutex_unlock(&loc_cache_mutex);
+		return false;
+	}
+
+	if (loc_cache_gen != loc_srv_gen)
+		loc_cache_flush();
+
+	list_foreach(loc_cat_svcs_cache, cache, loc_cat_svcs_cache_t, entry) {
+		if (entry->cat_id == cat_id) {
+			size_t size = entry->count * sizeof(service_id_t);
+			service_id_t *ids = malloc(size > 0 ? size : 1);
+			if (ids == NULL)
+				break;
+
+			memcpy(ids, entry->ids, size);
+			*data = ids;
+			*count = entry->count;
+			found = true;
+			break;
+		}
+	}
+
+	fibril_mutex_unlock(&loc_cache_mutex);
+	return found;
+}
+
+/** Insert a list of services in a category into the cache.
+ *
+ * @param cat_id Category ID
+ * @param data Array of IDs
+ * @param count Number of IDs
+ * @param gen Generation the list was read at
+ */
+static void loc_cache_insert_cat_svcs(category_id_t cat_id,
+    service_id_t *data, size_t count, sysarg_t gen)
+{
+	loc_cat_svcs_cache_t *entry;
+	size_t size = count * sizeof(service_id_t);
+
+	entry = calloc(1, sizeof(loc_cat_svcs_cache_t));
+	if (entry == NULL)
+		return;
+
+	entry->ids = malloc(size > 0 ? size : 1);
+	if (entry->ids == NULL) {
+		free(entry);
+		return;
+	}
+
+	memcpy(entry->ids, data, size);
+	entry->cat_id = cat_id;
+	entry->count = count;
+
+	fibril_mutex_lock(&loc_cache_mutex);
+
+	/* The directory has changed since the resolution - do not cache. */
+	if (!loc_cache_active || gen != loc_srv_gen) {
+		fibril_mutex_unlock(&loc_cache_mutex);
+		free(entry->ids);
+		free(entry);
+		return;
+	}
+
+	if (loc_cache_gen != loc_srv_gen)
+		loc_cache_flush();
+
+	/* Another fibril may have inserted the entry in the meantime. */
+	list_foreach(loc_cat_svcs_cache, cache, loc_cat_svcs_cache_t, old) {
+		if (old->cat_id == cat_id) {
+			fibril_mutex_unlock(&loc_cache_mutex);
+			free(entry->ids);
+			free(entry);
+			return;
+		}
+	}
+
+	link_initialize(&entry->cache);
+	list_append(&entry->cache, &loc_cat_svcs_cache);
+	fibril_mutex_unlock(&loc_cache_mutex);
+}
+
 /** Start an async exchange on the loc session (blocking).
  *
  * @return New exchange.
@@ -316,6 +634,18 @@ errno_t loc_service_get_id(const char *fqdn, service_id_t *handle,
     unsigned int flags)
 {
 	async_exch_t *exch;
+	sysarg_t id;
+	sysarg_t gen;
+
+	/* Try the cache of previous resolutions first. */
+	if (loc_cache_get_name(&loc_svc_cache, fqdn, &id)) {
+		if (handle != NULL)
+			*handle = (service_id_t) id;
+		return EOK;
+	}
+
+	(void) loc_cache_start();
+	gen = loc_cache_gen_snapshot();
 
 	if (flags & IPC_FLAG_BLOCKING)
 		exch = loc_exchange_begin_blocking();
@@ -349,6 +679,8 @@ errno_t loc_service_get_id(const char *fqdn, service_id_t *handle,
 	if (handle != NULL)
 		*handle = (service_id_t) ipc_get_arg1(&answer);
 
+	loc_cache_insert_name(&loc_svc_cache, fqdn, ipc_get_arg1(&answer), gen);
+
 	return retval;
 }
 
@@ -498,6 +830,18 @@ errno_t loc_category_get_id(const char *name, category_id_t *cat_id,
     unsigned int flags)
 {
 	async_exch_t *exch;
+	sysarg_t id;
+	sysarg_t gen;
+
+	/* Try the cache of previous resolutions first. */
+	if (loc_cache_get_name(&loc_cat_cache, name, &id)) {
+		if (cat_id != NULL)
+			*cat_id = (category_id_t) id;
+		return EOK;
+	}
+
+	(void) loc_cache_start();
+	gen = loc_cache_gen_snapshot();
 
 	if (flags & IPC_FLAG_BLOCKING)
 		exch = loc_exchange_begin_blocking();
@@ -531,6 +875,8 @@ errno_t loc_category_get_id(const char *name, category_id_t *cat_id,
 	if (cat_id != NULL)
 		*cat_id = (category_id_t) ipc_get_arg1(&answer);
 
+	loc_cache_insert_name(&loc_cat_cache, name, ipc_get_arg1(&answer), gen);
+
 	return retval;
 }
 
@@ -835,8 +1181,22 @@ static errno_t loc_get_ids_internal(sysarg_t method, sysarg_t arg1,
 errno_t loc_category_get_svcs(category_id_t cat_id, service_id_t **data,
     size_t *count)
 {
-	return loc_get_ids_internal(LOC_CATEGORY_GET_SVCS, cat_id,
+	sysarg_t gen;
+	errno_t rc;
+
+	/* Try the cache of previous resolutions first. */
+	if (loc_cache_get_cat_svcs(cat_id, data, count))
+		return EOK;
+
+	(void) loc_cache_start();
+	gen = loc_cache_gen_snapshot();
+
+	rc = loc_get_ids_internal(LOC_CATEGORY_GET_SVCS, cat_id,
 	    data, count);
+	if (rc == EOK)
+		loc_cache_insert_cat_svcs(cat_id, *data, *count, gen);
+
+	return rc;
 }
 
 /** Get list of categories.
@@ -853,6 +1213,90 @@ errno_t loc_get_categories(category_id_t **data, size_t *count)
 	    data, count);
 }
 
+static errno_t loc_cat_changes_get_once(sysarg_t since, category_id_t *id_buf,
+    size_t buf_size, size_t *act_size, sysarg_t *rgen)
+{
+	async_exch_t *exch = loc_exchange_begin_blocking();
+
+	ipc_call_t answer;
+	aid_t req = async_send_1(exch, LOC_CAT_CHANGED_GET, since, &answer);
+	errno_t rc = async_data_read_start(exch, id_buf, buf_size);
+
+	loc_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+
+	if (retval != EOK)
+		return retval;
+
+	*act_size = ipc_get_arg1(&answer);
+	*rgen = ipc_get_arg2(&answer);
+	return EOK;
+}
+
+/** Get IDs of categories changed since a given generation.
+ *
+ * Returns an allocated array of IDs of the categories whose membership
+ * changed after generation @a since, along with the generation the set
+ * is valid for. This allows a subscriber to process any number of
+ * coalesced change events in a single exchange.
+ *
+ * @param since		Last generation already processed by the caller
+ * @param data		Place to store pointer to array of IDs
+ * @param count		Place to store number of IDs
+ * @param rgen		Place to store the current generation
+ * @return 		EOK on success or an error code
+ */
+errno_t loc_get_cat_changes(sysarg_t since, category_id_t **data,
+    size_t *count, sysarg_t *rgen)
+{
+	*data = NULL;
+	*count = 0;
+
+	size_t act_size = 0;
+	sysarg_t gen = 0;
+	errno_t rc = loc_cat_changes_get_once(since, NULL, 0, &act_size,
+	    &gen);
+	if (rc != EOK)
+		return rc;
+
+	size_t alloc_size = act_size;
+	category_id_t *ids = malloc(alloc_size);
+	if (ids == NULL)
+		return ENOMEM;
+
+	while (true) {
+		rc = loc_cat_changes_get_once(since, ids, alloc_size,
+		    &act_size, &gen);
+		if (rc != EOK) {
+			free(ids);
+			return rc;
+		}
+
+		if (act_size <= alloc_size)
+			break;
+
+		alloc_size = act_size;
+		category_id_t *tmp = realloc(ids, alloc_size);
+		if (tmp == NULL) {
+			free(ids);
+			return ENOMEM;
+		}
+		ids = tmp;
+	}
+
+	*count = act_size / sizeof(category_id_t);
+	*data = ids;
+	*rgen = gen;
+	return EOK;
+}
+
 errno_t loc_register_cat_change_cb(loc_cat_change_cb_t cb_fun, void *cb_arg)
 {
 	fibril_mutex_lock(&loc_callback_mutex);
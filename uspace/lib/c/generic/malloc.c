@@ -35,6 +35,7 @@
 
 #include <stdlib.h>
 #include <stdalign.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <as.h>
@@ -44,8 +45,13 @@
 #include <errno.h>
 #include <bitops.h>
 #include <mem.h>
+#include <inttypes.h>
+#include <io/log.h>
+#include <stacktrace.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <adt/gcdlcm.h>
+#include <adt/hash.h>
 #include <malloc.h>
 
 #include "private/malloc.h"
@@ -198,6 +204,51 @@ static heap_block_head_t *next_fit = NULL;
 /** Futex for thread-safe heap manipulation */
 static fibril_rmutex_t malloc_mutex;
 
+/** Number of independent front-end arenas. Must be a power of two. */
+#define ARENA_COUNT  8
+
+/** Log2 of BASE_ALIGN, used to compute arena size classes. */
+#define ARENA_CLASS_SHIFT  4
+
+/** Number of size classes cached by the arenas. */
+#define ARENA_CLASSES  8
+
+/** Largest net block size served from the arenas. */
+#define ARENA_CLASS_MAX  ((size_t) BASE_ALIGN << (ARENA_CLASSES - 1))
+
+/** Number of blocks fetched from the heap when a bin runs empty. */
+#define ARENA_REFILL  8
+
+/** Node overlaid on the payload of a cached free block. */
+typedef struct arena_node {
+	struct arena_node *next;
+} arena_node_t;
+
+/** Front-end arena caching small heap blocks.
+ *
+ * Threads are spread over the arenas by their identity, so with a handful
+ * of threads each effectively owns one arena and allocations of small
+ * blocks do not contend on malloc_mutex. Blocks cached in a bin remain
+ * marked as used in the underlying heap, which keeps the heap walkers
+ * away from them.
+ */
+typedef struct {
+	/** Serializes access to the bins. */
+	fibril_rmutex_t lock;
+
+	/** Cached free blocks, one LIFO list per size class. */
+	arena_node_t *bins[ARENA_CLASSES];
+
+	/**
+	 * Lock-free list of blocks freed while the arena lock was
+	 * contended. Drained into the bins by the next thread that
+	 * holds the arena lock.
+	 */
+	_Atomic(arena_node_t *) remote;
+} arena_t;
+
+static arena_t arenas[ARENA_COUNT];
+
 #define malloc_assert(expr) safe_assert(expr)
 
 /*
@@ -207,6 +258,8 @@ static_assert(BASE_ALIGN >= alignof(heap_area_t), "");
 static_assert(BASE_ALIGN >= alignof(heap_block_head_t), "");
 static_assert(BASE_ALIGN >= alignof(heap_block_foot_t), "");
 static_assert(BASE_ALIGN >= alignof(max_align_t), "");
+static_assert(BASE_ALIGN == (1 << ARENA_CLASS_SHIFT), "");
+static_assert(sizeof(arena_node_t) <= BASE_ALIGN, "");
 
 /** Serializes access to the heap from multiple threads. */
 static inline void heap_lock(void)
@@ -220,6 +273,200 @@ static inline void heap_unlock(void)
 	fibril_rmutex_unlock(&malloc_mutex);
 }
 
+/*
+ * Optional heap statistics.
+ *
+ * When the statistics are enabled, the public allocation entry points
+ * keep per-size-class allocation and deallocation counts and track the
+ * live and peak number of allocated bytes. The counters are updated
+ * with relaxed atomics, so they cost a single load on the fast path
+ * while the statistics are off and never take a lock when they are on.
+ * A small table of sampled allocation call sites can additionally be
+ * kept to attribute the traffic to code; the sampler walks the stack
+ * with the stacktrace frame pointer interface.
+ *
+ * Blocks cached by the arena front end count as free, even though
+ * they remain marked as used in the underlying heap: the statistics
+ * describe what the application holds, not what the heap holds.
+ */
+
+/** Heap statistics gate. */
+static atomic_bool heap_stats_on = ATOMIC_VAR_INIT(false);
+
+/** Sample every heap_stats_rate-th allocation (zero disables sampling). */
+static atomic_size_t heap_stats_rate = ATOMIC_VAR_INIT(0);
+
+/** Allocation sequence number driving the sampler. */
+static atomic_uint_fast64_t heap_stats_seq;
+
+/** Allocations per size class (class = floor(log2(gross size))). */
+static atomic_uint_fast64_t heap_stats_allocs[HEAP_STATS_CLASSES];
+
+/** Deallocations per size class. */
+static atomic_uint_fast64_t heap_stats_frees[HEAP_STATS_CLASSES];
+
+/** Gross bytes currently allocated. */
+static atomic_uint_fast64_t heap_stats_live;
+
+/** Largest value of heap_stats_live observed so far. */
+static atomic_uint_fast64_t heap_stats_peak;
+
+/** Serializes access to the sampled call site table. */
+static fibril_rmutex_t heap_stats_mutex;
+
+/** Sampled allocation call sites. */
+static heap_stats_site_t heap_stats_sites[HEAP_STATS_SITES];
+
+/** Read a stack word of the current thread for the sampler. */
+static errno_t heap_stats_read_uintptr(void *arg, uintptr_t addr,
+    uintptr_t *data)
+{
+	(void) arg;
+
+	*data = *((uintptr_t *) addr);
+	return EOK;
+}
+
+static stacktrace_ops_t heap_stats_st_ops = {
+	.read_uintptr = heap_stats_read_uintptr,
+	.printf = NULL
+};
+
+/** Size class of a gross block size. */
+static inline unsigned int heap_stats_class(size_t size)
+{
+	unsigned int class = fnzb(size | 1);
+
+	if (class >= HEAP_STATS_CLASSES)
+		class = HEAP_STATS_CLASSES - 1;
+
+	return class;
+}
+
+/** Attribute a sampled allocation to its call site.
+ *
+ * Captures the current call chain and charges the allocation to the
+ * matching entry of the call site table (allocating a new entry when
+ * the chain was not seen before). Samples are dropped silently once
+ * the table is full.
+ *
+ * @param size Gross size of the allocated block.
+ *
+ */
+static void heap_stats_sample(size_t size)
+{
+	size_t rate = atomic_load_explicit(&heap_stats_rate,
+	    memory_order_relaxed);
+	if (rate == 0)
+		return;
+
+	uint64_t seq = atomic_fetch_add_explicit(&heap_stats_seq, 1,
+	    memory_order_relaxed);
+	if ((seq % rate) != 0)
+		return;
+
+	uintptr_t pc[HEAP_STATS_FRAMES];
+	size_t frames = 0;
+
+	stacktrace_t st;
+	st.op_arg = NULL;
+	st.ops = &heap_stats_st_ops;
+
+	stacktrace_prepare();
+	uintptr_t fp = stacktrace_fp_get();
+	uintptr_t ra = stacktrace_pc_get();
+
+	while ((frames < HEAP_STATS_FRAMES) && (stacktrace_fp_valid(&st, fp))) {
+		pc[frames] = ra;
+		frames++;
+
+		if (stacktrace_ra_get(&st, fp, &ra) != EOK)
+			break;
+
+		if (stacktrace_fp_prev(&st, fp, &fp) != EOK)
+			break;
+	}
+
+	if (frames == 0)
+		return;
+
+	for (size_t i = frames; i < HEAP_STATS_FRAMES; i++)
+		pc[i] = 0;
+
+	fibril_rmutex_lock(&heap_stats_mutex);
+
+	heap_stats_site_t *site = NULL;
+
+	for (size_t i = 0; i < HEAP_STATS_SITES; i++) {
+		heap_stats_site_t *entry = &heap_stats_sites[i];
+
+		if (entry->count == 0) {
+			if (site == NULL)
+				site = entry;
+
+			continue;
+		}
+
+		if (memcmp(entry->pc, pc, sizeof(pc)) == 0) {
+			site = entry;
+			break;
+		}
+	}
+
+	if (site != NULL) {
+		if (site->count == 0)
+			memcpy(site->pc, pc, sizeof(pc));
+
+		site->count++;
+		site->bytes += size;
+	}
+
+	fibril_rmutex_unlock(&heap_stats_mutex);
+}
+
+/** Record an allocation of a block of @a size gross bytes. */
+static void heap_stats_account_alloc(size_t size)
+{
+	if (!atomic_load_explicit(&heap_stats_on, memory_order_relaxed))
+		return;
+
+	atomic_fetch_add_explicit(&heap_stats_allocs[heap_stats_class(size)],
+	    1, memory_order_relaxed);
+
+	uint64_t live = atomic_fetch_add_explicit(&heap_stats_live, size,
+	    memory_order_relaxed) + size;
+
+	uint64_t peak = atomic_load_explicit(&heap_stats_peak,
+	    memory_order_relaxed);
+	while ((live > peak) &&
+	    (!atomic_compare_exchange_weak_explicit(&heap_stats_peak, &peak,
+	    live, memory_order_relaxed, memory_order_relaxed)))
+		;
+
+	heap_stats_sample(size);
+}
+
+/** Record a deallocation of a block of @a size gross bytes. */
+static void heap_stats_account_free(size_t size)
+{
+	if (!atomic_load_explicit(&heap_stats_on, memory_order_relaxed))
+		return;
+
+	atomic_fetch_add_explicit(&heap_stats_frees[heap_stats_class(size)],
+	    1, memory_order_relaxed);
+
+	/*
+	 * Clamp at zero: blocks allocated before the statistics were
+	 * enabled may be freed while they are on.
+	 */
+	uint64_t live = atomic_load_explicit(&heap_stats_live,
+	    memory_order_relaxed);
+	while (!atomic_compare_exchange_weak_explicit(&heap_stats_live, &live,
+	    (live > size) ? (live - size) : 0, memory_order_relaxed,
+	    memory_order_relaxed))
+		;
+}
+
 /** Initialize a heap block
  *
  * Fill in the structures related to a heap block.
@@ -496,12 +743,24 @@ void __malloc_init(void)
 	if (fibril_rmutex_initialize(&malloc_mutex) != EOK)
 		abort();
 
+	for (size_t i = 0; i < ARENA_COUNT; i++) {
+		if (fibril_rmutex_initialize(&arenas[i].lock) != EOK)
+			abort();
+	}
+
+	if (fibril_rmutex_initialize(&heap_stats_mutex) != EOK)
+		abort();
+
 	if (!area_create(PAGE_SIZE))
 		abort();
 }
 
 void __malloc_fini(void)
 {
+	for (size_t i = 0; i < ARENA_COUNT; i++)
+		fibril_rmutex_destroy(&arenas[i].lock);
+
+	fibril_rmutex_destroy(&heap_stats_mutex);
 	fibril_rmutex_destroy(&malloc_mutex);
 }
 
@@ -773,6 +1032,165 @@ static void *malloc_internal(const size_t size, const size_t align)
 	return heap_grow_and_alloc(gross_size, falign);
 }
 
+/** Pick the arena serving the current thread.
+ *
+ * Keyed by the thread context fibril, which is stable for a given thread,
+ * so every thread keeps hitting the same arena.
+ */
+static arena_t *arena_self(void)
+{
+	fibril_t *ctx = fibril_self()->thread_ctx;
+	return &arenas[hash_mix((uintptr_t) ctx) & (ARENA_COUNT - 1)];
+}
+
+/** Size class for a net allocation size.
+ *
+ * @return Size class index, or -1 if the size is served by the heap.
+ */
+static int arena_class(size_t size)
+{
+	if (size > ARENA_CLASS_MAX)
+		return -1;
+
+	if (size <= BASE_ALIGN)
+		return 0;
+
+	return fnzb(size - 1) + 1 - ARENA_CLASS_SHIFT;
+}
+
+/** Net size of the blocks in the given size class. */
+static size_t arena_class_size(int class)
+{
+	return (size_t) BASE_ALIGN << class;
+}
+
+/** Size class of an existing block.
+ *
+ * Only blocks whose size exactly matches a class (i.e. blocks that were
+ * carved for the arenas, or happen to look like them) can be cached;
+ * anything else, e.g. a block trimmed in place by realloc(), goes back
+ * to the heap.
+ *
+ * @return Size class index, or -1 if the block cannot be cached.
+ */
+static int arena_block_class(heap_block_head_t *head)
+{
+	if (head->size < STRUCT_OVERHEAD)
+		return -1;
+
+	size_t net = NET_SIZE(head->size);
+	if ((net == 0) || (net > ARENA_CLASS_MAX))
+		return -1;
+
+	int class = arena_class(net);
+	if (arena_class_size(class) != net)
+		return -1;
+
+	return class;
+}
+
+/** Sort remotely freed blocks into the bins.
+ *
+ * Should be called only with the arena lock held.
+ */
+static void arena_drain(arena_t *arena)
+{
+	arena_node_t *node = atomic_exchange(&arena->remote, NULL);
+
+	while (node != NULL) {
+		arena_node_t *next = node->next;
+
+		heap_block_head_t *head = (heap_block_head_t *)
+		    (((void *) node) - sizeof(heap_block_head_t));
+		int class = arena_block_class(head);
+		malloc_assert(class >= 0);
+
+		node->next = arena->bins[class];
+		arena->bins[class] = node;
+		node = next;
+	}
+}
+
+/** Allocate a small block from the current thread's arena.
+ *
+ * @return Address of the allocated block, or NULL if the size is not
+ *         served by the arenas or memory is exhausted.
+ */
+static void *arena_malloc(size_t size)
+{
+	int class = arena_class(size);
+	if (class < 0)
+		return NULL;
+
+	arena_t *arena = arena_self();
+
+	fibril_rmutex_lock(&arena->lock);
+
+	if (arena->bins[class] == NULL)
+		arena_drain(arena);
+
+	if (arena->bins[class] == NULL) {
+		/* Refill the bin from the heap. */
+		size_t net = arena_class_size(class);
+
+		heap_lock();
+		for (size_t i = 0; i < ARENA_REFILL; i++) {
+			void *addr = malloc_internal(net, BASE_ALIGN);
+			if (addr == NULL)
+				break;
+
+			arena_node_t *node = addr;
+			node->next = arena->bins[class];
+			arena->bins[class] = node;
+		}
+		heap_unlock();
+	}
+
+	arena_node_t *node = arena->bins[class];
+	if (node != NULL)
+		arena->bins[class] = node->next;
+
+	fibril_rmutex_unlock(&arena->lock);
+
+	return node;
+}
+
+/** Return a small block to the current thread's arena.
+ *
+ * Cached blocks stay marked as used in the heap; they migrate to the
+ * arena of the thread that freed them.
+ *
+ * @return True if the block was cached, false if the caller should
+ *         return it to the heap.
+ */
+static bool arena_free(heap_block_head_t *head, void *addr)
+{
+	int class = arena_block_class(head);
+	if (class < 0)
+		return false;
+
+	arena_t *arena = arena_self();
+	arena_node_t *node = addr;
+
+	if (fibril_rmutex_trylock(&arena->lock)) {
+		node->next = arena->bins[class];
+		arena->bins[class] = node;
+		fibril_rmutex_unlock(&arena->lock);
+		return true;
+	}
+
+	/*
+	 * The arena is busy with another thread. Push onto the lock-free
+	 * remote list instead of waiting.
+	 */
+	arena_node_t *old = atomic_load(&arena->remote);
+	do {
+		node->next = old;
+	} while (!atomic_compare_exchange_weak(&arena->remote, &old, node));
+
+	return true;
+}
+
 /** Allocate memory
  *
  * @param size Number of bytes to allocate.
@@ -782,9 +1200,24 @@ static void *malloc_internal(const size_t size, const size_t align)
  */
 void *malloc(const size_t size)
 {
-	heap_lock();
-	void *block = malloc_internal(size, BASE_ALIGN);
-	heap_unlock();
+	void *block = arena_malloc(size);
+
+	if (block == NULL) {
+		/*
+		 * Large blocks, and small ones the arena could not refill
+		 * from a fragmented heap, take the slow path.
+		 */
+		heap_lock();
+		block = malloc_internal(size, BASE_ALIGN);
+		heap_unlock();
+	}
+
+	if (block != NULL) {
+		heap_block_head_t *head = (heap_block_head_t *)
+		    (block - sizeof(heap_block_head_t));
+
+		heap_stats_account_alloc(head->size);
+	}
 
 	return block;
 }
@@ -809,6 +1242,13 @@ void *memalign(const size_t align, const size_t size)
 	void *block = malloc_internal(size, palign);
 	heap_unlock();
 
+	if (block != NULL) {
+		heap_block_head_t *head = (heap_block_head_t *)
+		    (block - sizeof(heap_block_head_t));
+
+		heap_stats_account_alloc(head->size);
+	}
+
 	return block;
 }
 
@@ -918,6 +1358,12 @@ void *realloc(void *const addr, const size_t size)
 
 	heap_unlock();
 
+	if (ptr != NULL) {
+		/* In-place reallocation: account as a free/alloc pair. */
+		heap_stats_account_free(orig_size);
+		heap_stats_account_alloc(head->size);
+	}
+
 	if (reloc) {
 		ptr = malloc(size);
 		if (ptr != NULL) {
@@ -939,8 +1385,6 @@ void free(void *const addr)
 	if (addr == NULL)
 		return;
 
-	heap_lock();
-
 	/* Calculate the position of the header. */
 	heap_block_head_t *head =
 	    (heap_block_head_t *) (addr - sizeof(heap_block_head_t));
@@ -948,6 +1392,14 @@ void free(void *const addr)
 	block_check(head);
 	malloc_assert(!head->free);
 
+	heap_stats_account_free(head->size);
+
+	/* Try to cache small blocks in the arena front end. */
+	if (arena_free(head, addr))
+		return;
+
+	heap_lock();
+
 	heap_area_t *area = head->area;
 
 	area_check(area);
@@ -987,6 +1439,153 @@ void free(void *const addr)
 	heap_unlock();
 }
 
+/** Enable or disable heap statistics
+ *
+ * Enabling resets all counters and the sampled call site table, so a
+ * fresh measurement starts from zero.
+ *
+ * @param enable True to enable the statistics, false to disable them.
+ *
+ */
+void heap_stats_enable(bool enable)
+{
+	if (enable) {
+		for (unsigned int i = 0; i < HEAP_STATS_CLASSES; i++) {
+			atomic_store_explicit(&heap_stats_allocs[i], 0,
+			    memory_order_relaxed);
+			atomic_store_explicit(&heap_stats_frees[i], 0,
+			    memory_order_relaxed);
+		}
+
+		atomic_store_explicit(&heap_stats_live, 0,
+		    memory_order_relaxed);
+		atomic_store_explicit(&heap_stats_peak, 0,
+		    memory_order_relaxed);
+		atomic_store_explicit(&heap_stats_seq, 0,
+		    memory_order_relaxed);
+
+		fibril_rmutex_lock(&heap_stats_mutex);
+		memset(heap_stats_sites, 0, sizeof(heap_stats_sites));
+		fibril_rmutex_unlock(&heap_stats_mutex);
+	}
+
+	atomic_store_explicit(&heap_stats_on, enable, memory_order_relaxed);
+}
+
+/** Set the allocation call site sampling rate
+ *
+ * Takes effect only while the statistics are enabled.
+ *
+ * @param rate Sample every rate-th allocation, zero disables sampling.
+ *
+ */
+void heap_stats_sampling(size_t rate)
+{
+	atomic_store_explicit(&heap_stats_rate, rate, memory_order_relaxed);
+}
+
+/** Get a snapshot of the heap statistics
+ *
+ * The counters are read without mutual exclusion against concurrent
+ * allocations, so the snapshot may mix counter values from slightly
+ * different points in time.
+ *
+ * @param stats Place to store the statistics.
+ *
+ */
+void heap_stats_get(heap_stats_t *stats)
+{
+	for (unsigned int i = 0; i < HEAP_STATS_CLASSES; i++) {
+		stats->alloc_count[i] =
+		    atomic_load_explicit(&heap_stats_allocs[i],
+		    memory_order_relaxed);
+		stats->free_count[i] =
+		    atomic_load_explicit(&heap_stats_frees[i],
+		    memory_order_relaxed);
+	}
+
+	stats->live_bytes = atomic_load_explicit(&heap_stats_live,
+	    memory_order_relaxed);
+	stats->peak_bytes = atomic_load_explicit(&heap_stats_peak,
+	    memory_order_relaxed);
+}
+
+/** Get the sampled allocation call sites
+ *
+ * @param sites Place to store the call sites.
+ * @param max   Capacity of @a sites in entries.
+ *
+ * @return Number of entries stored.
+ *
+ */
+size_t heap_stats_sites_get(heap_stats_site_t *sites, size_t max)
+{
+	size_t count = 0;
+
+	fibril_rmutex_lock(&heap_stats_mutex);
+
+	for (size_t i = 0; (i < HEAP_STATS_SITES) && (count < max); i++) {
+		if (heap_stats_sites[i].count != 0)
+			sites[count++] = heap_stats_sites[i];
+	}
+
+	fibril_rmutex_unlock(&heap_stats_mutex);
+
+	return count;
+}
+
+/** Dump the heap statistics through the logger
+ *
+ * Logs the live and peak byte counts, the non-empty size classes and
+ * any sampled call sites at the NOTE level. The addresses of the call
+ * chains can be resolved against the task's map file.
+ *
+ */
+void heap_stats_log(void)
+{
+	heap_stats_t stats;
+	heap_stats_get(&stats);
+
+	log_msg(LOG_DEFAULT, LVL_NOTE, "heap: %" PRIu64 " B live, %" PRIu64
+	    " B peak", stats.live_bytes, stats.peak_bytes);
+
+	for (unsigned int i = 0; i < HEAP_STATS_CLASSES; i++) {
+		if ((stats.alloc_count[i] == 0) && (stats.free_count[i] == 0))
+			continue;
+
+		log_msg(LOG_DEFAULT, LVL_NOTE, "heap: class %u (%zu B): %"
+		    PRIu64 " allocs, %" PRIu64 " frees", i, (size_t) 1 << i,
+		    stats.alloc_count[i], stats.free_count[i]);
+	}
+
+	fibril_rmutex_lock(&heap_stats_mutex);
+
+	for (size_t i = 0; i < HEAP_STATS_SITES; i++) {
+		heap_stats_site_t *site = &heap_stats_sites[i];
+
+		if (site->count == 0)
+			continue;
+
+		char chain[HEAP_STATS_FRAMES * 20];
+		size_t pos = 0;
+
+		chain[0] = '\0';
+
+		for (size_t frame = 0; (frame < HEAP_STATS_FRAMES) &&
+		    (site->pc[frame] != 0); frame++) {
+			pos += snprintf(chain + pos, sizeof(chain) - pos,
+			    "%s%p", (frame > 0) ? " " : "",
+			    (void *) site->pc[frame]);
+		}
+
+		log_msg(LOG_DEFAULT, LVL_NOTE, "heap: site %s: %" PRIu64
+		    " samples, %" PRIu64 " B", chain, site->count,
+		    site->bytes);
+	}
+
+	fibril_rmutex_unlock(&heap_stats_mutex);
+}
+
 void *heap_check(void)
 {
 	heap_lock();
@@ -34,9 +34,12 @@
 
 #include <ns.h>
 #include <ipc/ns.h>
+#include <adt/list.h>
 #include <async.h>
+#include <fibril_synch.h>
 #include <macros.h>
 #include <errno.h>
+#include <stdlib.h>
 #include "private/ns.h"
 
 /*
@@ -45,6 +48,19 @@
  */
 static async_sess_t *sess_ns = NULL;
 
+/** Session cached by service_connect_cached(). */
+typedef struct {
+	link_t link;
+	service_t service;
+	iface_t iface;
+	sysarg_t arg3;
+	async_sess_t *sess;
+} cached_sess_t;
+
+/** Sessions shared by service_connect_cached() callers. */
+static LIST_INITIALIZE(cached_sess_list);
+static FIBRIL_MUTEX_INITIALIZE(cached_sess_lock);
+
 errno_t service_register(service_t service, iface_t iface,
     async_port_handler_t handler, void *data)
 {
@@ -76,6 +92,60 @@ errno_t service_register(service_t service, iface_t iface,
 	return rc;
 }
 
+/** Register multiple interfaces of a service at once.
+ *
+ * Equivalent to calling service_register() for each interface, except that
+ * the naming service round trip and the callback connection are paid only
+ * once for the whole set.
+ *
+ * @param service Service to be registered.
+ * @param ifaces  Interfaces to be registered.
+ * @param count   Number of interfaces (at most NS_MAX_IFACES).
+ * @param handler Port connection handler for all interfaces.
+ * @param data    Client data for @a handler.
+ *
+ * @return Zero on success or a value from @ref errno.h.
+ *
+ */
+errno_t service_register_multi(service_t service, const iface_t *ifaces,
+    size_t count, async_port_handler_t handler, void *data)
+{
+	if ((count == 0) || (count > NS_MAX_IFACES))
+		return EINVAL;
+
+	errno_t rc;
+	async_sess_t *sess = ns_session_get(&rc);
+	if (sess == NULL)
+		return rc;
+
+	for (size_t i = 0; i < count; i++) {
+		port_id_t port;
+		rc = async_create_port(ifaces[i], handler, data, &port);
+		if (rc != EOK)
+			return rc;
+	}
+
+	async_exch_t *exch = async_exchange_begin(sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_2(exch, NS_REGISTER_MULTI, service, count,
+	    &answer);
+	rc = async_data_write_start(exch, ifaces, count * sizeof(iface_t));
+	if (rc == EOK)
+		rc = async_connect_to_me(exch, INTERFACE_ANY, service, 0);
+
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	return retval;
+}
+
 errno_t service_register_broker(service_t service, async_port_handler_t handler,
     void *data)
 {
@@ -142,6 +212,60 @@ async_sess_t *service_connect(service_t service, iface_t iface, sysarg_t arg3,
 	return csess;
 }
 
+/** Connect to a singleton service, sharing cached sessions.
+ *
+ * Same as service_connect(), except that the session is set up only on
+ * the first call with the given arguments. Subsequent calls return the
+ * same session, which is shared by all callers (including other fibrils)
+ * and must not be hung up.
+ *
+ * @param service Singleton service ID.
+ * @param iface   Interface to connect to.
+ * @param arg3    Custom connection argument.
+ * @param rc      Placeholder for return code. Unused if NULL.
+ *
+ * @return Shared session on success or NULL on error.
+ *
+ */
+async_sess_t *service_connect_cached(service_t service, iface_t iface,
+    sysarg_t arg3, errno_t *rc)
+{
+	fibril_mutex_lock(&cached_sess_lock);
+
+	list_foreach(cached_sess_list, link, cached_sess_t, cs) {
+		if ((cs->service == service) && (cs->iface == iface) &&
+		    (cs->arg3 == arg3)) {
+			fibril_mutex_unlock(&cached_sess_lock);
+			return cs->sess;
+		}
+	}
+
+	cached_sess_t *cs = malloc(sizeof(cached_sess_t));
+	if (cs == NULL) {
+		fibril_mutex_unlock(&cached_sess_lock);
+		if (rc != NULL)
+			*rc = ENOMEM;
+		return NULL;
+	}
+
+	async_sess_t *sess = service_connect(service, iface, arg3, rc);
+	if (sess == NULL) {
+		fibril_mutex_unlock(&cached_sess_lock);
+		free(cs);
+		return NULL;
+	}
+
+	link_initialize(&cs->link);
+	cs->service = service;
+	cs->iface = iface;
+	cs->arg3 = arg3;
+	cs->sess = sess;
+	list_append(&cs->link, &cached_sess_list);
+
+	fibril_mutex_unlock(&cached_sess_lock);
+	return sess;
+}
+
 /** Wait and connect to a singleton service.
  *
  * @param service Singleton service ID.
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ * @brief Hardware performance counter self-measurement.
+ *
+ * The counters virtualize per task: they count only events generated
+ * by the calling task's threads, in both user and kernel mode. On
+ * hardware without usable counters every function returns ENOTSUP.
+ */
+
+#include <libc.h>
+#include <pmu.h>
+
+/** Start a performance counter
+ *
+ * Resets the counter to zero and starts counting the given event.
+ *
+ * @param counter Counter index, less than PMU_COUNTERS.
+ * @param event   Event to count.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t pmu_counter_start(unsigned int counter, pmu_event_t event)
+{
+	return (errno_t) __SYSCALL3(SYS_PMU_CTL, PMU_CTL_START, counter,
+	    (sysarg_t) event);
+}
+
+/** Stop a performance counter
+ *
+ * The accumulated value remains readable until the counter is
+ * started again.
+ *
+ * @param counter Counter index, less than PMU_COUNTERS.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t pmu_counter_stop(unsigned int counter)
+{
+	return (errno_t) __SYSCALL3(SYS_PMU_CTL, PMU_CTL_STOP, counter, 0);
+}
+
+/** Read a performance counter
+ *
+ * @param counter Counter index, less than PMU_COUNTERS.
+ * @param value   Place to store the event count accumulated since
+ *                the counter was started.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t pmu_counter_read(unsigned int counter, uint64_t *value)
+{
+	return (errno_t) __SYSCALL3(SYS_PMU_CTL, PMU_CTL_READ, counter,
+	    (sysarg_t) value);
+}
+
+/** @}
+ */
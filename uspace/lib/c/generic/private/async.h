@@ -76,6 +76,12 @@ struct async_sess {
 
 	/** Data for stateful connections */
 	void *remote_state_data;
+
+	/** Shared bulk-transfer window base (NULL if not established) */
+	void *window_base;
+
+	/** Shared bulk-transfer window size */
+	size_t window_size;
 };
 
 /** Exchange data */
@@ -38,6 +38,9 @@
 
 #include "./futex.h"
 
+/** Per-thread fibril scheduling context. Defined in thread/fibril.c. */
+struct _fibril_worker;
+
 typedef struct {
 	fibril_t *fibril;
 } fibril_event_t;
@@ -62,6 +65,11 @@ struct fibril {
 
 	fibril_t *thread_ctx;
 
+	/** Worker owned by this fibril. Only set on thread context fibrils. */
+	struct _fibril_worker *worker;
+	/** Link for a worker's lock-free ready inbox. */
+	fibril_t *inbox_next;
+
 	bool is_running : 1;
 	bool is_writer : 1;
 	/* In some places, we use fibril structs that can't be freed. */
@@ -81,6 +89,9 @@ extern fibril_t *fibril_self(void);
 extern void __fibrils_init(void);
 extern void __fibrils_fini(void);
 
+/** True once the task runs fibrils on more than one thread. */
+extern bool __fibrils_multithreaded;
+
 extern void fibril_wait_for(fibril_event_t *);
 extern errno_t fibril_wait_timeout(fibril_event_t *, const struct timespec *);
 extern void fibril_notify(fibril_event_t *);
@@ -55,6 +55,10 @@ typedef struct futex {
 
 extern errno_t futex_initialize(futex_t *futex, int value);
 
+extern void __futex_lock_spin(futex_t *futex);
+extern errno_t futex_up_deferred(futex_t *futex);
+extern void futex_flush_deferred(void);
+
 static inline errno_t futex_destroy(futex_t *futex)
 {
 	if (futex->whandle) {
@@ -85,9 +89,13 @@ void __futex_give_to(futex_t *, void *, const char *);
 
 #else
 
-#define futex_lock(fut)     (void) futex_down((fut))
+#define futex_lock(fut)     __futex_lock_spin((fut))
 #define futex_trylock(fut)  futex_trydown((fut))
-#define futex_unlock(fut)   (void) futex_up((fut))
+#define futex_unlock(fut) \
+	do { \
+		(void) futex_up((fut)); \
+		futex_flush_deferred(); \
+	} while (0)
 
 #define futex_give_to(fut, owner) ((void)0)
 #define futex_assert_is_locked(fut) assert(atomic_load_explicit(&(fut)->val, memory_order_relaxed) <= 0)
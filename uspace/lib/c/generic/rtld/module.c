@@ -49,6 +49,7 @@
 #include <rtld/rtld_debug.h>
 #include <rtld/dynamic.h>
 #include <rtld/rtld_arch.h>
+#include <rtld/symbol.h>
 #include <rtld/module.h>
 #include <libarch/rtld/module.h>
 
@@ -94,6 +95,7 @@ errno_t module_create_static_exec(rtld_t *rtld, module_t **rmodule)
 	}
 
 	list_append(&module->modules_link, &rtld->modules);
+	symbol_cache_invalidate(rtld);
 
 	if (rmodule != NULL)
 		*rmodule = module;
@@ -234,6 +236,7 @@ module_t *module_load(rtld_t *rtld, const char *name, mlflags_t flags)
 
 	/* Insert into the list of loaded modules */
 	list_append(&m->modules_link, &rtld->modules);
+	symbol_cache_invalidate(rtld);
 
 	/* Copy TLS info */
 	m->tdata = info.tls.tdata;
@@ -34,6 +34,8 @@
  * @file
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str.h>
@@ -105,6 +107,165 @@ static elf_symbol_t *def_find_in_module(const char *name, module_t *m)
 	return sym; /* Found */
 }
 
+/*
+ * Cache of global-scope symbol lookups.
+ *
+ * The scan over the global module list in symbol_def_find() depends only
+ * on the symbol name and search flags, not on the origin module, so its
+ * result can be remembered in the rtld environment and reused by later
+ * relocations referencing the same symbol (negative results included).
+ * The cache is flushed whenever a module is added to the module list.
+ */
+
+typedef struct {
+	ht_link_t lcache;
+	/** Symbol name (owned copy) */
+	char *name;
+	/** Search flags used for the lookup */
+	symbol_search_flags_t flags;
+	/** Module defining the symbol or @c NULL for a negative result */
+	module_t *mod;
+	/** Symbol definition or @c NULL for a negative result */
+	elf_symbol_t *sym;
+} sym_cache_entry_t;
+
+typedef struct {
+	const char *name;
+	symbol_search_flags_t flags;
+} sym_cache_key_t;
+
+static size_t sym_cache_ops_hash(const ht_link_t *item)
+{
+	sym_cache_entry_t *entry = hash_table_get_inst(item, sym_cache_entry_t,
+	    lcache);
+
+	return hash_combine(elf_hash((unsigned char *) entry->name),
+	    entry->flags);
+}
+
+static size_t sym_cache_ops_key_hash(const void *arg)
+{
+	const sym_cache_key_t *key = arg;
+
+	return hash_combine(elf_hash((unsigned char *) key->name), key->flags);
+}
+
+static bool sym_cache_ops_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	sym_cache_entry_t *e1 = hash_table_get_inst(item1, sym_cache_entry_t,
+	    lcache);
+	sym_cache_entry_t *e2 = hash_table_get_inst(item2, sym_cache_entry_t,
+	    lcache);
+
+	return e1->flags == e2->flags && str_cmp(e1->name, e2->name) == 0;
+}
+
+static bool sym_cache_ops_key_equal(const void *arg, const ht_link_t *item)
+{
+	const sym_cache_key_t *key = arg;
+	sym_cache_entry_t *entry = hash_table_get_inst(item, sym_cache_entry_t,
+	    lcache);
+
+	return key->flags == entry->flags &&
+	    str_cmp(key->name, entry->name) == 0;
+}
+
+static void sym_cache_ops_remove_callback(ht_link_t *item)
+{
+	sym_cache_entry_t *entry = hash_table_get_inst(item, sym_cache_entry_t,
+	    lcache);
+
+	free(entry->name);
+	free(entry);
+}
+
+static const hash_table_ops_t sym_cache_ops = {
+	.hash = sym_cache_ops_hash,
+	.key_hash = sym_cache_ops_key_hash,
+	.equal = sym_cache_ops_equal,
+	.key_equal = sym_cache_ops_key_equal,
+	.remove_callback = sym_cache_ops_remove_callback
+};
+
+/** Look up a cached global-scope lookup result.
+ *
+ * @param env	Runtime environment
+ * @param name	Symbol name
+ * @param flags	Symbol search flags
+ *
+ * @return Cache entry or @c NULL if the lookup is not cached
+ */
+static sym_cache_entry_t *sym_cache_find(rtld_t *env, const char *name,
+    symbol_search_flags_t flags)
+{
+	sym_cache_key_t key = {
+		.name = name,
+		.flags = flags
+	};
+	ht_link_t *link;
+
+	if (!env->sym_cache_init)
+		return NULL;
+
+	link = hash_table_find(&env->sym_cache, &key);
+	if (link == NULL)
+		return NULL;
+
+	return hash_table_get_inst(link, sym_cache_entry_t, lcache);
+}
+
+/** Remember the result of a global-scope symbol lookup.
+ *
+ * Failure to cache is not an error, merely a missed optimization,
+ * so out-of-memory conditions are silently ignored.
+ *
+ * @param env	Runtime environment
+ * @param name	Symbol name
+ * @param flags	Symbol search flags
+ * @param mod	Module defining the symbol (@c NULL if not found)
+ * @param sym	Symbol definition (@c NULL if not found)
+ */
+static void sym_cache_insert(rtld_t *env, const char *name,
+    symbol_search_flags_t flags, module_t *mod, elf_symbol_t *sym)
+{
+	sym_cache_entry_t *entry;
+
+	if (!env->sym_cache_init) {
+		if (!hash_table_create(&env->sym_cache, 0, 0, &sym_cache_ops))
+			return;
+		env->sym_cache_init = true;
+	}
+
+	entry = malloc(sizeof(sym_cache_entry_t));
+	if (entry == NULL)
+		return;
+
+	entry->name = str_dup(name);
+	if (entry->name == NULL) {
+		free(entry);
+		return;
+	}
+
+	entry->flags = flags;
+	entry->mod = mod;
+	entry->sym = sym;
+
+	hash_table_insert(&env->sym_cache, &entry->lcache);
+}
+
+/** Flush the symbol lookup cache.
+ *
+ * Must be called whenever a module is added to the module list as
+ * previously cached results (especially negative ones) may change.
+ *
+ * @param env	Runtime environment
+ */
+void symbol_cache_invalidate(rtld_t *env)
+{
+	if (env->sym_cache_init)
+		hash_table_clear(&env->sym_cache);
+}
+
 /** Find the definition of a symbol in a module and its deps.
  *
  * Search the module dependency graph is breadth-first, beginning
@@ -211,6 +372,9 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
 elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
     symbol_search_flags_t flags, module_t **mod)
 {
+	sym_cache_entry_t *entry;
+	module_t *gm;
+	elf_symbol_t *gs;
 	elf_symbol_t *s;
 
 	DPRINTF("symbol_def_find('%s', origin='%s'\n",
@@ -231,17 +395,38 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 
 	/* Not DT_SYMBOLIC or no match. Now try other locations. */
 
-	list_foreach(origin->rtld->modules, modules_link, module_t, m) {
-		DPRINTF("module '%s' local?\n", m->dyn.soname);
-		if (!m->local && (!m->exec || (flags & ssf_noexec) == 0)) {
-			DPRINTF("!local->find '%s' in module '%s'\n", name, m->dyn.soname);
-			s = def_find_in_module(name, m);
-			if (s != NULL) {
-				/* Found */
-				*mod = m;
-				return s;
+	entry = sym_cache_find(origin->rtld, name, flags);
+	if (entry != NULL) {
+		DPRINTF("cache hit for '%s'\n", name);
+		/* A negative entry means skipping straight to origin. */
+		if (entry->sym != NULL) {
+			*mod = entry->mod;
+			return entry->sym;
+		}
+	} else {
+		gm = NULL;
+		gs = NULL;
+
+		list_foreach(origin->rtld->modules, modules_link, module_t, m) {
+			DPRINTF("module '%s' local?\n", m->dyn.soname);
+			if (!m->local && (!m->exec || (flags & ssf_noexec) == 0)) {
+				DPRINTF("!local->find '%s' in module '%s'\n", name, m->dyn.soname);
+				s = def_find_in_module(name, m);
+				if (s != NULL) {
+					/* Found */
+					gm = m;
+					gs = s;
+					break;
+				}
 			}
 		}
+
+		sym_cache_insert(origin->rtld, name, flags, gm, gs);
+
+		if (gs != NULL) {
+			*mod = gm;
+			return gs;
+		}
 	}
 
 	/* Finally, try origin. */
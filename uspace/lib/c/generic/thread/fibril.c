@@ -83,17 +83,57 @@ typedef enum {
 	SWITCH_FROM_BLOCKED,
 } _switch_type_t;
 
-static bool multithreaded = false;
+bool __fibrils_multithreaded = false;
 
 /* This futex serializes access to global data. */
 static futex_t fibril_futex;
 static futex_t ready_semaphore;
 static long ready_st_count;
 
-static LIST_INITIALIZE(ready_list);
 static LIST_INITIALIZE(fibril_list);
 static LIST_INITIALIZE(timeout_list);
 
+/** Per-thread fibril scheduling context.
+ *
+ * Every thread that enters the fibril scheduler owns one of these,
+ * anchored on its thread context (helper) fibril. Ready fibrils are
+ * distributed among the workers instead of sitting in one global run
+ * queue, so a thread normally touches only its own queue and other
+ * threads resort to work stealing, instead of all serializing on
+ * fibril_futex.
+ */
+typedef struct _fibril_worker {
+	/**
+	 * Lock-free inbox of fibrils made ready for this worker.
+	 * A LIFO stack linked through fibril_t::inbox_next. Any thread
+	 * pushes; drained into @c queue under @c lock.
+	 */
+	_Atomic(fibril_t *) inbox;
+
+	/** Guards @c queue. Acquired after fibril_futex when holding both. */
+	futex_t lock;
+
+	/** FIFO of ready fibrils. Other workers may steal from it. */
+	list_t queue;
+} _fibril_worker_t;
+
+#define FIBRIL_WORKERS_MAX  64
+
+/**
+ * All registered workers. Slots are filled in order under fibril_futex and
+ * published by incrementing _worker_count. Workers are never unregistered,
+ * so readers can scan the array without any lock; a worker whose thread is
+ * gone merely remains an empty steal victim.
+ */
+static _fibril_worker_t *_workers[FIBRIL_WORKERS_MAX];
+static atomic_size_t _worker_count;
+
+/** Round-robin counter for picking push targets and steal start points. */
+static atomic_size_t _worker_rr;
+
+/** Statically allocated worker serving threads without one of their own. */
+static _fibril_worker_t _worker_initial;
+
 static futex_t ipc_lists_futex;
 static LIST_INITIALIZE(ipc_waiter_list);
 static LIST_INITIALIZE(ipc_buffer_list);
@@ -109,17 +149,153 @@ static fibril_t _fibril_event_timed_out;
 static inline void _ready_debug_check(void)
 {
 #ifdef READY_DEBUG
-	assert(!multithreaded);
-	long count = (long) list_count(&ready_list) +
-	    (long) list_count(&ipc_buffer_free_list);
+	assert(!__fibrils_multithreaded);
+	long count = (long) list_count(&ipc_buffer_free_list);
+	size_t workers = atomic_load(&_worker_count);
+	for (size_t i = 0; i < workers; i++) {
+		count += (long) list_count(&_workers[i]->queue);
+		for (fibril_t *f = atomic_load(&_workers[i]->inbox); f;
+		    f = f->inbox_next)
+			count++;
+	}
 	assert(ready_st_count == count);
 #endif
 }
 
-static inline void _ready_up(void)
+/** @return The worker owned by the current thread, or NULL if none yet. */
+static _fibril_worker_t *_worker_self(void)
+{
+	fibril_t *ctx = fibril_self()->thread_ctx;
+	return ctx ? ctx->worker : NULL;
+}
+
+/** Give a thread context fibril a worker of its own and register it. */
+static void _worker_attach(fibril_t *ctx)
+{
+	futex_assert_is_not_locked(&fibril_futex);
+
+	if (ctx->worker)
+		return;
+
+	_fibril_worker_t *w = calloc(1, sizeof(_fibril_worker_t));
+	if (w && futex_initialize(&w->lock, 1) != EOK) {
+		free(w);
+		w = NULL;
+	}
+
+	if (!w) {
+		/* Share the initial worker rather than fail. */
+		ctx->worker = &_worker_initial;
+		return;
+	}
+
+	list_initialize(&w->queue);
+
+	futex_lock(&fibril_futex);
+	size_t count = atomic_load(&_worker_count);
+	if (count < FIBRIL_WORKERS_MAX) {
+		_workers[count] = w;
+		atomic_store(&_worker_count, count + 1);
+		ctx->worker = w;
+		w = NULL;
+	} else {
+		ctx->worker = &_worker_initial;
+	}
+	futex_unlock(&fibril_futex);
+
+	if (w) {
+		futex_destroy(&w->lock);
+		free(w);
+	}
+}
+
+/** Push a ready fibril onto a worker's lock-free inbox. */
+static void _worker_inbox_push(_fibril_worker_t *w, fibril_t *f)
+{
+	fibril_t *old = atomic_load(&w->inbox);
+	do {
+		f->inbox_next = old;
+	} while (!atomic_compare_exchange_weak(&w->inbox, &old, f));
+}
+
+/** Drain the inbox into the worker's queue. Needs w->lock held. */
+static void _worker_drain_inbox(_fibril_worker_t *w)
 {
-	if (multithreaded) {
-		futex_up(&ready_semaphore);
+	futex_assert_is_locked(&w->lock);
+
+	fibril_t *chain = atomic_exchange(&w->inbox, NULL);
+
+	/* The inbox is LIFO. Reverse it to keep the ready queue FIFO. */
+	fibril_t *rev = NULL;
+	while (chain) {
+		fibril_t *next = chain->inbox_next;
+		chain->inbox_next = rev;
+		rev = chain;
+		chain = next;
+	}
+
+	while (rev) {
+		fibril_t *next = rev->inbox_next;
+		rev->inbox_next = NULL;
+		list_append(&rev->link, &w->queue);
+		rev = next;
+	}
+}
+
+/** Take one ready fibril from the given worker, or NULL. */
+static fibril_t *_worker_take(_fibril_worker_t *w)
+{
+	futex_lock(&w->lock);
+	_worker_drain_inbox(w);
+	fibril_t *f = list_pop(&w->queue, fibril_t, link);
+	futex_unlock(&w->lock);
+	return f;
+}
+
+/**
+ * Take one ready fibril, preferring the current thread's own queue and
+ * stealing from the other workers when it is empty.
+ */
+static fibril_t *_ready_queue_take(void)
+{
+	_fibril_worker_t *own = _worker_self();
+
+	if (own) {
+		fibril_t *f = _worker_take(own);
+		if (f)
+			return f;
+	}
+
+	size_t count = atomic_load(&_worker_count);
+	size_t start = atomic_fetch_add(&_worker_rr, 1);
+
+	for (size_t i = 0; i < count; i++) {
+		_fibril_worker_t *w = _workers[(start + i) % count];
+		if (w == own)
+			continue;
+
+		fibril_t *f = _worker_take(w);
+		if (f)
+			return f;
+	}
+
+	return NULL;
+}
+
+/** Post a ready token.
+ *
+ * With @a defer_wake, the wakeup syscall is morphed into the caller's
+ * next futex_unlock(), so a thread woken while we still hold a lock it
+ * needs does not go straight back to sleep. Only pass true while
+ * holding a futex lock.
+ */
+static inline void _ready_up(bool defer_wake)
+{
+	if (__fibrils_multithreaded) {
+		if (defer_wake)
+			futex_up_deferred(&ready_semaphore);
+		else
+			futex_up(&ready_semaphore);
 	} else {
 		ready_st_count++;
 		_ready_debug_check();
@@ -128,7 +304,7 @@ static inline void _ready_up(void)
 
 static inline errno_t _ready_down(const struct timespec *expires)
 {
-	if (multithreaded)
+	if (__fibrils_multithreaded)
 		return futex_down_timeout(&ready_semaphore, expires);
 
 	_ready_debug_check();
@@ -256,9 +432,9 @@ static errno_t _ipc_wait(ipc_call_t *call, const struct timespec *expires)
 }
 
 /*
- * Waits until a ready fibril is added to the list, or an IPC message arrives.
- * Returns NULL on timeout and may also return NULL if returning from IPC
- * wait after new ready fibrils are added.
+ * Waits until a ready fibril is added to a worker queue, or an IPC message
+ * arrives. Returns NULL on timeout and may also return NULL if returning
+ * from IPC wait after new ready fibrils are added.
  */
 static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 {
@@ -277,36 +453,42 @@ static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 
 	/*
 	 * Once we acquire a token from ready_semaphore, there are two options.
-	 * Either there is a ready fibril in the list, or it's our turn to
-	 * call `ipc_wait_cycle()`. There is one extra token on the semaphore
-	 * for each entry of the call buffer.
+	 * Either there is a ready fibril in some worker's queue, or it's our
+	 * turn to call `ipc_wait_cycle()`. There is one extra token on the
+	 * semaphore for each entry of the call buffer.
 	 */
 
-	if (!locked)
-		futex_lock(&fibril_futex);
-	fibril_t *f = list_pop(&ready_list, fibril_t, link);
-	if (!f)
-		atomic_fetch_add_explicit(&threads_in_ipc_wait, 1,
-		    memory_order_relaxed);
-	if (!locked)
-		futex_unlock(&fibril_futex);
+	fibril_t *f = _ready_queue_take();
+	if (!f) {
+		atomic_fetch_add(&threads_in_ipc_wait, 1);
+
+		/*
+		 * Recheck after advertising ourselves. Either the pushing
+		 * thread observes the incremented counter and pokes us out
+		 * of the IPC wait, or we observe its fibril here. Both
+		 * sides use sequentially consistent operations, so at
+		 * least one of the two always happens.
+		 */
+		f = _ready_queue_take();
+		if (f)
+			atomic_fetch_sub(&threads_in_ipc_wait, 1);
+	}
 
 	if (f)
 		return f;
 
-	if (!multithreaded)
+	if (!__fibrils_multithreaded)
 		assert(list_empty(&ipc_buffer_list));
 
 	/* No fibril is ready, IPC wait it is. */
 	ipc_call_t call = { 0 };
 	rc = _ipc_wait(&call, expires);
 
-	atomic_fetch_sub_explicit(&threads_in_ipc_wait, 1,
-	    memory_order_relaxed);
+	atomic_fetch_sub(&threads_in_ipc_wait, 1);
 
 	if (rc != EOK && rc != ENOENT) {
 		/* Return token. */
-		_ready_up();
+		_ready_up(false);
 		return NULL;
 	}
 
@@ -337,7 +519,7 @@ static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 		f = _fibril_trigger_internal(&w->event, _EVENT_TRIGGERED);
 
 		/* Return token. */
-		_ready_up();
+		_ready_up(true);
 	} else {
 		_ipc_buffer_t *buf = list_pop(&ipc_buffer_free_list, _ipc_buffer_t, link);
 		assert(buf);
@@ -366,11 +548,22 @@ static void _ready_list_push(fibril_t *f)
 
 	futex_assert_is_locked(&fibril_futex);
 
-	/* Enqueue in ready_list. */
-	list_append(&f->link, &ready_list);
-	_ready_up();
+	/*
+	 * Prefer the current thread's own worker for cache locality; idle
+	 * threads woken by the semaphore will steal if we pile up work.
+	 * Threads without a worker spread wakeups round-robin.
+	 */
+	_fibril_worker_t *w = _worker_self();
+	if (!w) {
+		size_t count = atomic_load(&_worker_count);
+		size_t i = atomic_fetch_add(&_worker_rr, 1);
+		w = _workers[i % count];
+	}
+
+	_worker_inbox_push(w, f);
+	_ready_up(true);
 
-	if (atomic_load_explicit(&threads_in_ipc_wait, memory_order_relaxed)) {
+	if (atomic_load(&threads_in_ipc_wait)) {
 		DPRINTF("Poking.\n");
 		/* Wakeup one thread sleeping in SYS_IPC_WAIT. */
 		ipc_poke();
@@ -391,7 +584,7 @@ static errno_t _wait_ipc(ipc_call_t *call, const struct timespec *expires)
 		/* Return to freelist. */
 		list_append(&buf->link, &ipc_buffer_free_list);
 		/* Return IPC wait token. */
-		_ready_up();
+		_ready_up(true);
 
 		futex_unlock(&ipc_lists_futex);
 		return rc;
@@ -517,6 +710,7 @@ static errno_t _helper_fibril_fn(void *arg)
 {
 	/* Set itself as the thread's own context. */
 	fibril_self()->thread_ctx = fibril_self();
+	_worker_attach(fibril_self());
 
 	(void) arg;
 
@@ -635,6 +829,7 @@ errno_t fibril_wait_timeout(fibril_event_t *event,
 		    fibril_create_generic(_helper_fibril_fn, NULL, PAGE_SIZE);
 		if (!fibril_self()->thread_ctx)
 			return ENOMEM;
+		_worker_attach(fibril_self()->thread_ctx);
 	}
 
 	futex_lock(&fibril_futex);
@@ -797,11 +992,11 @@ int fibril_test_spawn_runners(int n)
 {
 	assert(fibril_self()->rmutex_locks == 0);
 
-	if (!multithreaded) {
+	if (!__fibrils_multithreaded) {
 		_ready_debug_check();
 		if (futex_initialize(&ready_semaphore, ready_st_count) != EOK)
 			abort();
-		multithreaded = true;
+		__fibrils_multithreaded = true;
 	}
 
 	errno_t rc;
@@ -830,7 +1025,7 @@ void fibril_enable_multithreaded(void)
 {
 	// TODO: Implement better.
 	//       For now, 4 total runners is a sensible default.
-	if (!multithreaded) {
+	if (!__fibrils_multithreaded) {
 		fibril_test_spawn_runners(3);
 	}
 }
@@ -870,6 +1065,12 @@ void __fibrils_init(void)
 	if (futex_initialize(&ipc_lists_futex, 1) != EOK)
 		abort();
 
+	if (futex_initialize(&_worker_initial.lock, 1) != EOK)
+		abort();
+	list_initialize(&_worker_initial.queue);
+	_workers[0] = &_worker_initial;
+	atomic_store(&_worker_count, 1);
+
 	/*
 	 * We allow a fixed, small amount of parallelism for IPC reads, but
 	 * since IPC is currently serialized in kernel, there's not much
@@ -881,7 +1082,7 @@ void __fibrils_init(void)
 
 	for (int i = 0; i < IPC_BUFFER_COUNT; i++) {
 		list_append(&buffers[i].link, &ipc_buffer_free_list);
-		_ready_up();
+		_ready_up(false);
 	}
 }
 
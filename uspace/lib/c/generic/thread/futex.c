@@ -57,6 +57,92 @@ errno_t futex_initialize(futex_t *futex, int val)
 	return futex_allocate_waitq(futex);
 }
 
+/*
+ * Upper bound on the number of busy-wait iterations in __futex_lock_spin().
+ * Futex-protected critical sections are short (a few list operations), so
+ * the budget corresponds to a couple of such sections.
+ */
+#define FUTEX_SPIN_MAX        300
+/* Upper bound on the exponential backoff between lock word re-reads. */
+#define FUTEX_SPIN_DELAY_MAX  64
+
+/** Lock a futex, briefly spinning before sleeping in the kernel.
+ *
+ * Futexes guard microsecond-scale critical sections, so when the holder
+ * runs on another CPU it is usually cheaper to busy-wait for a moment
+ * than to pay for a sleep and wakeup syscall pair. The backoff between
+ * re-reads of the lock word grows exponentially to keep cacheline
+ * traffic down.
+ */
+void __futex_lock_spin(futex_t *futex)
+{
+	/*
+	 * With a single thread the holder cannot make progress while we
+	 * spin, so go to sleep right away (the kernel will run the holder).
+	 */
+	if (__fibrils_multithreaded) {
+		unsigned delay = 1;
+
+		for (unsigned spins = 0; spins < FUTEX_SPIN_MAX;
+		    spins += delay) {
+			if (atomic_load_explicit(&futex->val,
+			    memory_order_relaxed) > 0)
+				break;
+
+			for (unsigned i = 0; i < delay; i++)
+				atomic_signal_fence(memory_order_seq_cst);
+
+			if (delay < FUTEX_SPIN_DELAY_MAX)
+				delay *= 2;
+		}
+	}
+
+	(void) futex_down(futex);
+}
+
+/* Capacity of the per-thread deferred wakeup buffer. */
+#define FUTEX_DEFERRED_MAX  4
+
+static fibril_local futex_t *deferred_wakeups[FUTEX_DEFERRED_MAX];
+static fibril_local unsigned deferred_cnt;
+
+/** Up the futex, deferring the wakeup syscall to the next futex_unlock().
+ *
+ * When the caller still holds a lock that the sleeper will need right
+ * after waking (e.g. posting a ready token while holding the scheduler
+ * lock), an immediate wakeup would only send the sleeper back to sleep
+ * on that lock. Deferring the wakeup until the caller unlocks morphs
+ * the wait and also moves the syscall out of the critical section.
+ *
+ * May only be called while holding a futex lock; futex_unlock() issues
+ * the pending wakeups. The token itself is published immediately.
+ */
+errno_t futex_up_deferred(futex_t *futex)
+{
+	if (atomic_fetch_add_explicit(&futex->val, 1,
+	    memory_order_release) < 0) {
+		if (deferred_cnt < FUTEX_DEFERRED_MAX) {
+			deferred_wakeups[deferred_cnt++] = futex;
+			return EOK;
+		}
+
+		return __SYSCALL1(SYS_WAITQ_WAKEUP,
+		    (sysarg_t) futex->whandle);
+	}
+
+	return EOK;
+}
+
+/** Issue wakeups deferred by futex_up_deferred(). */
+void futex_flush_deferred(void)
+{
+	while (deferred_cnt > 0) {
+		futex_t *futex = deferred_wakeups[--deferred_cnt];
+		(void) __SYSCALL1(SYS_WAITQ_WAKEUP,
+		    (sysarg_t) futex->whandle);
+	}
+}
+
 #ifdef CONFIG_DEBUG_FUTEX
 
 void __futex_assert_is_locked(futex_t *futex, const char *name)
@@ -91,7 +177,7 @@ void __futex_lock(futex_t *futex, const char *name)
 	fibril_t *self = (fibril_t *) fibril_get_id();
 	DPRINTF("Locking futex %s (%p) by fibril %p.\n", name, futex, self);
 	__futex_assert_is_not_locked(futex, name);
-	futex_down(futex);
+	__futex_lock_spin(futex);
 
 	void *prev_owner = atomic_load_explicit(&futex->owner,
 	    memory_order_relaxed);
@@ -106,6 +192,7 @@ void __futex_unlock(futex_t *futex, const char *name)
 	__futex_assert_is_locked(futex, name);
 	atomic_store_explicit(&futex->owner, NULL, memory_order_relaxed);
 	futex_up(futex);
+	futex_flush_deferred();
 }
 
 bool __futex_trylock(futex_t *futex, const char *name)
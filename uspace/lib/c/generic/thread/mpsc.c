@@ -48,6 +48,10 @@
  *
  * The original algorithm uses one lock on each side. Since this queue is
  * single-consumer, we only use the tail lock.
+ *
+ * To avoid one wakeup syscall per message, producers only notify the
+ * consumer when it has announced (via the `waiting` flag) that it is about
+ * to block. A consumer that is busy draining the queue is never poked.
  */
 
 typedef struct mpsc_node mpsc_node_t;
@@ -59,6 +63,8 @@ struct mpsc {
 	mpsc_node_t *tail;
 	mpsc_node_t *close_node;
 	fibril_event_t event;
+	/* True when the consumer may be blocked and needs a wakeup. */
+	bool waiting;
 };
 
 struct mpsc_node {
@@ -107,6 +113,18 @@ void mpsc_destroy(mpsc_t *q)
 	free(q);
 }
 
+static void _mpsc_notify(mpsc_t *q)
+{
+	/*
+	 * Only issue a wakeup when the consumer announced it is about to
+	 * block. If it is running, it will see the new node on its own and
+	 * we save the syscall. The exchange also makes sure that a burst of
+	 * producers wakes the consumer at most once.
+	 */
+	if (__atomic_exchange_n(&q->waiting, false, __ATOMIC_SEQ_CST))
+		fibril_notify(&q->event);
+}
+
 static errno_t _mpsc_push(mpsc_t *q, mpsc_node_t *n)
 {
 	fibril_rmutex_lock(&q->t_lock);
@@ -121,7 +139,7 @@ static errno_t _mpsc_push(mpsc_t *q, mpsc_node_t *n)
 
 	fibril_rmutex_unlock(&q->t_lock);
 
-	fibril_notify(&q->event);
+	_mpsc_notify(q);
 	return EOK;
 }
 
@@ -145,6 +163,71 @@ errno_t mpsc_send(mpsc_t *q, const void *b)
 	return _mpsc_push(q, n);
 }
 
+/**
+ * Send several elements on the channel at once.
+ * `b` points to an array of `count` elements, each of the `elem_size` set in
+ * `mpsc_create`. The elements are enqueued consecutively with a single
+ * publish and at most one consumer wakeup for the whole batch.
+ *
+ * This function is safe for use under restricted mutex lock.
+ *
+ * @return ENOMEM if allocation failed, EINVAL if the queue is closed.
+ */
+errno_t mpsc_send_batch(mpsc_t *q, const void *b, size_t count)
+{
+	const unsigned char *data = b;
+	mpsc_node_t *first = NULL;
+	mpsc_node_t *last = NULL;
+
+	if (count == 0)
+		return EOK;
+
+	for (size_t i = 0; i < count; i++) {
+		mpsc_node_t *n = malloc(sizeof(mpsc_node_t) + q->elem_size);
+		if (!n) {
+			while (first) {
+				mpsc_node_t *next = first->next;
+				free(first);
+				first = next;
+			}
+			return ENOMEM;
+		}
+
+		n->next = NULL;
+		memcpy(n->data, data + i * q->elem_size, q->elem_size);
+
+		if (last)
+			last->next = n;
+		else
+			first = n;
+		last = n;
+	}
+
+	fibril_rmutex_lock(&q->t_lock);
+
+	if (q->tail == q->close_node) {
+		fibril_rmutex_unlock(&q->t_lock);
+		while (first) {
+			mpsc_node_t *next = first->next;
+			free(first);
+			first = next;
+		}
+		return EINVAL;
+	}
+
+	/*
+	 * The inner links were written before this release store, so the
+	 * consumer sees the whole chain once it sees the first node.
+	 */
+	__atomic_store_n(&q->tail->next, first, __ATOMIC_RELEASE);
+	q->tail = last;
+
+	fibril_rmutex_unlock(&q->t_lock);
+
+	_mpsc_notify(q);
+	return EOK;
+}
+
 /**
  * Receive data from the channel.
  *
@@ -162,7 +245,22 @@ errno_t mpsc_receive(mpsc_t *q, void *b, const struct timespec *expires)
 		if (new_head)
 			break;
 
+		/*
+		 * Announce that we are about to block, then recheck.
+		 * A producer either observes the `waiting` flag and wakes us,
+		 * or we observe its node here. Both sides use sequentially
+		 * consistent accesses, so the wakeup cannot be lost.
+		 */
+		__atomic_store_n(&q->waiting, true, __ATOMIC_SEQ_CST);
+
+		new_head = __atomic_load_n(&n->next, __ATOMIC_SEQ_CST);
+		if (new_head) {
+			__atomic_store_n(&q->waiting, false, __ATOMIC_SEQ_CST);
+			break;
+		}
+
 		errno_t rc = fibril_wait_timeout(&q->event, expires);
+		__atomic_store_n(&q->waiting, false, __ATOMIC_SEQ_CST);
 		if (rc != EOK)
 			return rc;
 	}
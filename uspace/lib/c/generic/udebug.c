@@ -123,6 +123,44 @@ errno_t udebug_mem_read(async_sess_t *sess, void *buffer, uintptr_t addr, size_t
 	return rc;
 }
 
+errno_t udebug_mem_read_v(async_sess_t *sess, void *buffer,
+    const udebug_mem_range_t *ranges, size_t nranges)
+{
+	async_exch_t *exch = async_exchange_begin(sess);
+	errno_t rc = async_req_4_0(exch, IPC_M_DEBUG, UDEBUG_M_MEM_READ_V,
+	    (sysarg_t) buffer, (sysarg_t) ranges, nranges);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
+errno_t udebug_ev_ring_set(async_sess_t *sess, bool enable)
+{
+	async_exch_t *exch = async_exchange_begin(sess);
+	errno_t rc = async_req_2_0(exch, IPC_M_DEBUG, UDEBUG_M_SET_EVRING,
+	    enable ? 1 : 0);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
+errno_t udebug_ev_read(async_sess_t *sess, void *buffer, size_t n,
+    size_t *copied, size_t *needed, size_t *lost)
+{
+	sysarg_t a_copied, a_needed, a_lost;
+
+	async_exch_t *exch = async_exchange_begin(sess);
+	errno_t rc = async_req_3_4(exch, IPC_M_DEBUG, UDEBUG_M_EV_READ,
+	    (sysarg_t) buffer, n, NULL, &a_copied, &a_needed, &a_lost);
+	async_exchange_end(exch);
+
+	*copied = (size_t) a_copied;
+	*needed = (size_t) a_needed;
+	*lost = (size_t) a_lost;
+
+	return rc;
+}
+
 errno_t udebug_args_read(async_sess_t *sess, thash_t tid, sysarg_t *buffer)
 {
 	async_exch_t *exch = async_exchange_begin(sess);
@@ -42,11 +42,13 @@
 #include <stdint.h>
 #include <ipc/services.h>
 #include <ns.h>
+#include <as.h>
 #include <async.h>
 #include <fibril_synch.h>
 #include <errno.h>
 #include <assert.h>
 #include <str.h>
+#include <mem.h>
 #include <loc.h>
 #include <ipc/vfs.h>
 #include <ipc/loc.h>
@@ -117,6 +119,7 @@
 
 static FIBRIL_MUTEX_INITIALIZE(vfs_mutex);
 static async_sess_t *vfs_sess = NULL;
+static async_sess_t *vfs_pager_sess = NULL;
 
 static FIBRIL_MUTEX_INITIALIZE(cwd_mutex);
 
@@ -224,6 +227,38 @@ char *vfs_absolutize(const char *path, size_t *retlen)
 	return ncwd_path;
 }
 
+/** Wait for an asynchronous read or write to complete
+ *
+ * Block until the request described by @a async has been fully processed by
+ * the VFS server and return its result. Every completion token produced by
+ * vfs_read_async() or vfs_write_async() must be consumed by exactly one call
+ * to this function.
+ *
+ * @param async         Completion token of the request
+ * @param[out] nbytes   Actual number of bytes transferred (0 or more)
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_async_wait(vfs_async_t *async, size_t *nbytes)
+{
+	errno_t rc;
+
+	async_wait_for(async->data_req, &rc);
+
+	if (rc == EOK)
+		async_wait_for(async->req, &rc);
+	else
+		async_forget(async->req);
+
+	vfs_exchange_end(async->exch);
+
+	if (rc != EOK)
+		return rc;
+
+	*nbytes = (size_t) ipc_get_arg1(&async->answer);
+	return EOK;
+}
+
 /** Clone a file handle
  *
  * The caller can choose whether to clone an existing file handle into another
@@ -744,6 +779,45 @@ errno_t vfs_mount_path(const char *mp, const char *fs_name, const char *fqsn,
 	return (errno_t) rc;
 }
 
+/** Map a file into memory
+ *
+ * Create a read-only memory mapping of the first @a size bytes of @a file.
+ * Pages of the mapping are faulted in on demand from the VFS server, which
+ * keeps them in its page cache, so all tasks mapping the same file share the
+ * underlying physical frames and no data is copied when the mapping is
+ * accessed.  This makes the mapping a zero-copy, IPC-free alternative to
+ * vfs_read() for large files.
+ *
+ * The file handle must remain open for as long as the mapping exists and
+ * the mapping must be destroyed with as_area_destroy() before the handle
+ * is put.
+ *
+ * @param file          File handle to map
+ * @param size          Size of the mapping in bytes
+ * @param[out] rarea    Place to store the address of the mapping
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_map(int file, size_t size, void **rarea)
+{
+	fibril_mutex_lock(&vfs_mutex);
+
+	while (vfs_pager_sess == NULL) {
+		vfs_pager_sess = service_connect_blocking(SERVICE_VFS,
+		    INTERFACE_PAGER, 0, NULL);
+	}
+
+	fibril_mutex_unlock(&vfs_mutex);
+
+	void *area = async_as_area_create(AS_AREA_ANY, size,
+	    AS_AREA_READ | AS_AREA_CACHEABLE, vfs_pager_sess, file, 0, 0);
+	if (area == AS_MAP_FAILED)
+		return ENOMEM;
+
+	*rarea = area;
+	return EOK;
+}
+
 /** Open a file handle for I/O
  *
  * @param file  File handle to enable I/O on
@@ -861,6 +935,38 @@ errno_t vfs_read(int file, aoff64_t *pos, void *buf, size_t nbyte, size_t *nread
 	return EOK;
 }
 
+/** Start an asynchronous read from a file
+ *
+ * Send a read request to the VFS server without waiting for it to complete.
+ * Any number of requests may be kept in flight at once; each one is
+ * eventually completed by a matching call to vfs_async_wait(). The actual
+ * number of bytes read may be lower than requested, as with
+ * vfs_read_short(). Both @a buf and @a async must remain valid until the
+ * wait completes.
+ *
+ * @param file          File handle to read from
+ * @param[in] pos       Position to read from
+ * @param buf           Buffer to read into
+ * @param nbyte         Maximum number of bytes to read
+ * @param[out] async    Completion token to pass to vfs_async_wait()
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_read_async(int file, aoff64_t pos, void *buf, size_t nbyte,
+    vfs_async_t *async)
+{
+	if (nbyte > DATA_XFER_LIMIT)
+		nbyte = DATA_XFER_LIMIT;
+
+	async->exch = vfs_exchange_begin();
+
+	async->req = async_send_3(async->exch, VFS_IN_READ, file, LOWER32(pos),
+	    UPPER32(pos), &async->answer);
+	async->data_req = async_data_read(async->exch, buf, nbyte, NULL);
+
+	return EOK;
+}
+
 /** Read bytes from a file
  *
  * Read up to @a nbyte bytes from file. The actual number of bytes read
@@ -906,6 +1012,124 @@ errno_t vfs_read_short(int file, aoff64_t pos, void *buf, size_t nbyte,
 	return EOK;
 }
 
+/** Read a batch of directory entries
+ *
+ * Read as many directory entries as fit into the provided buffer in a
+ * single exchange with the VFS server. The entries are stored in the
+ * buffer back-to-back as null-terminated strings.
+ *
+ * @param file          File handle of an open directory
+ * @param[inout] pos    Position to read from, updated to the position of
+ *                      the first entry not returned
+ * @param buf           Buffer for the entry names
+ * @param size          Size of the buffer
+ * @param[out] nbytes   Number of buffer bytes filled with entry names.
+ *                      Zero means the end of the directory was reached.
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_readdir_bulk(int file, aoff64_t *pos, void *buf, size_t size,
+    size_t *nbytes)
+{
+	errno_t rc;
+	ipc_call_t answer;
+	aid_t req;
+
+	if (size > DATA_XFER_LIMIT)
+		size = DATA_XFER_LIMIT;
+
+	async_exch_t *exch = vfs_exchange_begin();
+
+	req = async_send_3(exch, VFS_IN_READDIR, file, LOWER32(*pos),
+	    UPPER32(*pos), &answer);
+	rc = async_data_read_start(exch, buf, size);
+
+	vfs_exchange_end(exch);
+
+	if (rc == EOK)
+		async_wait_for(req, &rc);
+	else
+		async_forget(req);
+
+	if (rc != EOK)
+		return rc;
+
+	*nbytes = (size_t) ipc_get_arg1(&answer);
+	*pos = MERGE_LOUP32(ipc_get_arg2(&answer), ipc_get_arg3(&answer));
+	return EOK;
+}
+
+/** Read a vector of buffers from a file
+ *
+ * Issue one read request per buffer and keep all of them in flight at the
+ * same time. The buffers are filled with data from consecutive positions in
+ * the file. Reading stops at the first buffer that was not filled completely
+ * (e.g. because the end of the file was reached); the contents of any
+ * buffers beyond that point are undefined and not counted in @a *nread.
+ *
+ * @param file          File handle to read from
+ * @param[inout] pos    Position to read from, updated by the actual bytes
+ *                      read
+ * @param iov           Array of buffers to read into
+ * @param cnt           Number of buffers in @a iov
+ * @param[out] nread    Actual number of bytes read (0 or more)
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_readv(int file, aoff64_t *pos, const vfs_iovec_t *iov, size_t cnt,
+    size_t *nread)
+{
+	if (cnt == 0) {
+		*nread = 0;
+		return EOK;
+	}
+
+	vfs_async_t *async = calloc(cnt, sizeof(vfs_async_t));
+	if (async == NULL)
+		return ENOMEM;
+
+	aoff64_t spos = *pos;
+	for (size_t i = 0; i < cnt; i++) {
+		(void) vfs_read_async(file, spos, iov[i].buffer, iov[i].size,
+		    &async[i]);
+		spos += iov[i].size;
+	}
+
+	errno_t rc = EOK;
+	size_t total = 0;
+	bool valid = true;
+
+	/* Every request must be collected, even after a failure. */
+	for (size_t i = 0; i < cnt; i++) {
+		size_t nbytes;
+		errno_t rc2 = vfs_async_wait(&async[i], &nbytes);
+
+		if (!valid)
+			continue;
+
+		if (rc2 != EOK) {
+			rc = rc2;
+			valid = false;
+			continue;
+		}
+
+		total += nbytes;
+		if (nbytes < iov[i].size)
+			valid = false;
+	}
+
+	free(async);
+
+	if (rc != EOK) {
+		*nread = total;
+		return rc;
+	}
+
+	*pos += total;
+	*nread = total;
+	return EOK;
+}
+
 /** Rename a file or directory
  *
  * There is no file-handle-based variant to disallow attempts to introduce loops
@@ -1076,6 +1300,98 @@ errno_t vfs_stat(int file, vfs_stat_t *stat)
 	return rc;
 }
 
+/** Get information about multiple files
+ *
+ * Resolve and stat a batch of paths in as few exchanges with the VFS
+ * server as possible. Failures to resolve or stat individual paths are
+ * reported in the respective result entries and do not abort the batch.
+ *
+ * @param paths         Array of file paths to get information about
+ * @param cnt           Number of paths
+ * @param[out] results  Array of @a cnt result entries to fill in
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_stat_batch(const char *const *paths, size_t cnt,
+    vfs_stat_batch_t *results)
+{
+	size_t max_cnt = DATA_XFER_LIMIT / sizeof(vfs_stat_batch_t);
+	errno_t rc = EOK;
+
+	int root = vfs_root();
+	if (root < 0)
+		return ENOENT;
+
+	size_t done = 0;
+	while (done < cnt && rc == EOK) {
+		/*
+		 * Absolutize a batch of paths into a single buffer of
+		 * consecutive null-terminated strings.
+		 */
+		char *blob = NULL;
+		size_t blob_size = 0;
+		size_t batch = 0;
+
+		while (done + batch < cnt && batch < max_cnt) {
+			size_t asize;
+			char *apath = vfs_absolutize(paths[done + batch],
+			    &asize);
+			if (!apath) {
+				rc = ENOMEM;
+				break;
+			}
+
+			if (batch > 0 &&
+			    blob_size + asize + 1 > DATA_XFER_LIMIT) {
+				free(apath);
+				break;
+			}
+
+			char *nblob = realloc(blob, blob_size + asize + 1);
+			if (!nblob) {
+				free(apath);
+				rc = ENOMEM;
+				break;
+			}
+
+			blob = nblob;
+			memcpy(blob + blob_size, apath, asize + 1);
+			blob_size += asize + 1;
+			free(apath);
+			++batch;
+		}
+
+		if (rc != EOK) {
+			free(blob);
+			break;
+		}
+
+		async_exch_t *exch = vfs_exchange_begin();
+
+		ipc_call_t answer;
+		aid_t req = async_send_2(exch, VFS_IN_STAT_BATCH, root, batch,
+		    &answer);
+		rc = async_data_write_start(exch, blob, blob_size);
+		if (rc == EOK) {
+			rc = async_data_read_start(exch, results + done,
+			    batch * sizeof(vfs_stat_batch_t));
+		}
+
+		vfs_exchange_end(exch);
+
+		errno_t rc_orig;
+		async_wait_for(req, &rc_orig);
+		if (rc == EOK)
+			rc = rc_orig;
+
+		free(blob);
+		done += batch;
+	}
+
+	vfs_put(root);
+	return rc;
+}
+
 /** Get file information
  *
  * @param path          File path to get information about
@@ -1327,6 +1643,38 @@ errno_t vfs_write(int file, aoff64_t *pos, const void *buf, size_t nbyte,
 	return EOK;
 }
 
+/** Start an asynchronous write to a file
+ *
+ * Send a write request to the VFS server without waiting for it to complete.
+ * Any number of requests may be kept in flight at once; each one is
+ * eventually completed by a matching call to vfs_async_wait(). The actual
+ * number of bytes written may be lower than requested, as with
+ * vfs_write_short(). Both @a buf and @a async must remain valid until the
+ * wait completes.
+ *
+ * @param file          File handle to write to
+ * @param[in] pos       Position to write to
+ * @param buf           Buffer to write from
+ * @param nbyte         Maximum number of bytes to write
+ * @param[out] async    Completion token to pass to vfs_async_wait()
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_write_async(int file, aoff64_t pos, const void *buf, size_t nbyte,
+    vfs_async_t *async)
+{
+	if (nbyte > DATA_XFER_LIMIT)
+		nbyte = DATA_XFER_LIMIT;
+
+	async->exch = vfs_exchange_begin();
+
+	async->req = async_send_3(async->exch, VFS_IN_WRITE, file, LOWER32(pos),
+	    UPPER32(pos), &async->answer);
+	async->data_req = async_data_write(async->exch, buf, nbyte, NULL);
+
+	return EOK;
+}
+
 /** Write bytes to a file
  *
  * Write up to @a nbyte bytes from file. The actual number of bytes written
@@ -1370,5 +1718,76 @@ errno_t vfs_write_short(int file, aoff64_t pos, const void *buf, size_t nbyte,
 	return EOK;
 }
 
+/** Write a vector of buffers to a file
+ *
+ * Issue one write request per buffer and keep all of them in flight at the
+ * same time. The buffers are written to consecutive positions in the file.
+ * The reported number of bytes written stops at the first buffer that was
+ * not written in full, even though later buffers may have been written at
+ * their assumed positions.
+ *
+ * @param file          File handle to write to
+ * @param[inout] pos    Position to write to, updated by the actual bytes
+ *                      written
+ * @param iov           Array of buffers to write from
+ * @param cnt           Number of buffers in @a iov
+ * @param[out] nwritten Actual number of bytes written (0 or more)
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_writev(int file, aoff64_t *pos, const vfs_iovec_t *iov, size_t cnt,
+    size_t *nwritten)
+{
+	if (cnt == 0) {
+		*nwritten = 0;
+		return EOK;
+	}
+
+	vfs_async_t *async = calloc(cnt, sizeof(vfs_async_t));
+	if (async == NULL)
+		return ENOMEM;
+
+	aoff64_t spos = *pos;
+	for (size_t i = 0; i < cnt; i++) {
+		(void) vfs_write_async(file, spos, iov[i].buffer, iov[i].size,
+		    &async[i]);
+		spos += iov[i].size;
+	}
+
+	errno_t rc = EOK;
+	size_t total = 0;
+	bool valid = true;
+
+	/* Every request must be collected, even after a failure. */
+	for (size_t i = 0; i < cnt; i++) {
+		size_t nbytes;
+		errno_t rc2 = vfs_async_wait(&async[i], &nbytes);
+
+		if (!valid)
+			continue;
+
+		if (rc2 != EOK) {
+			rc = rc2;
+			valid = false;
+			continue;
+		}
+
+		total += nbytes;
+		if (nbytes < iov[i].size)
+			valid = false;
+	}
+
+	free(async);
+
+	if (rc != EOK) {
+		*nwritten = total;
+		return rc;
+	}
+
+	*pos += total;
+	*nwritten = total;
+	return EOK;
+}
+
 /** @}
  */
@@ -311,6 +311,19 @@ extern errno_t async_share_out_start(async_exch_t *, void *, unsigned int);
 extern bool async_share_out_receive(ipc_call_t *, size_t *, unsigned int *);
 extern errno_t async_share_out_finalize(ipc_call_t *, void **);
 
+/*
+ * Session-wide shared window for bulk data transfers. Once a window is
+ * established, bulk payloads can be passed as offset/length descriptors
+ * in protocol arguments instead of IPC_M_DATA_READ/WRITE copies.
+ */
+extern errno_t async_window_setup(async_exch_t *, size_t);
+extern void async_window_teardown(async_sess_t *);
+extern bool async_window_get(async_sess_t *, void **, size_t *);
+extern errno_t async_window_write(async_sess_t *, size_t, const void *,
+    size_t);
+extern errno_t async_window_read(async_sess_t *, size_t, void *, size_t);
+extern errno_t async_window_accept(void **, size_t *);
+
 extern errno_t async_data_read_forward_0_0(async_exch_t *, sysarg_t);
 extern errno_t async_data_read_forward_1_0(async_exch_t *, sysarg_t, sysarg_t);
 extern errno_t async_data_read_forward_2_0(async_exch_t *, sysarg_t, sysarg_t,
@@ -356,6 +369,8 @@ extern errno_t async_data_write_forward_3_1(async_exch_t *, sysarg_t, sysarg_t,
 extern errno_t async_data_write_forward_4_1(async_exch_t *, sysarg_t, sysarg_t,
     sysarg_t, sysarg_t, sysarg_t, ipc_call_t *);
 
+extern aid_t async_data_write(async_exch_t *, const void *, size_t,
+    ipc_call_t *);
 extern errno_t async_data_write_start(async_exch_t *, const void *, size_t);
 extern bool async_data_write_receive(ipc_call_t *, size_t *);
 extern errno_t async_data_write_finalize(ipc_call_t *, void *, size_t);
@@ -382,6 +397,28 @@ extern void *async_as_area_create(void *, size_t, unsigned int, async_sess_t *,
 
 errno_t async_spawn_notification_handler(void);
 
+/*
+ * Server-side IPC latency measurement.
+ */
+
+/** Number of log2-scaled buckets in the server-side latency histogram */
+#define ASYNC_LAT_BUCKETS  32
+
+/** Server-side IPC latency statistics
+ *
+ * Receive-to-answer times of the calls answered by this server
+ * process. Bucket i of the histogram counts the calls answered
+ * within 2^i (inclusive) to 2^(i+1) (exclusive) nanoseconds.
+ */
+typedef struct {
+	uint64_t count;       /**< Number of answered calls accounted */
+	uint64_t total_nsec;  /**< Total receive-to-answer time */
+	uint64_t buckets[ASYNC_LAT_BUCKETS];  /**< Log2-scaled histogram */
+} async_lat_stats_t;
+
+extern void async_latency_enable(bool);
+extern void async_latency_get(async_lat_stats_t *);
+
 #endif
 
 /** @}
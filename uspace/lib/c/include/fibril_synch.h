@@ -205,6 +205,7 @@ typedef struct mpsc mpsc_t;
 extern mpsc_t *mpsc_create(size_t);
 extern void mpsc_destroy(mpsc_t *);
 extern errno_t mpsc_send(mpsc_t *, const void *);
+extern errno_t mpsc_send_batch(mpsc_t *, const void *, size_t);
 extern errno_t mpsc_receive(mpsc_t *, void *, const struct timespec *);
 extern void mpsc_close(mpsc_t *);
 
@@ -39,7 +39,7 @@
 #include <abi/ddi/irq.h>
 #include <abi/cap.h>
 
-extern errno_t ipc_irq_subscribe(int, sysarg_t, const irq_code_t *,
+extern errno_t ipc_irq_subscribe(int, sysarg_t, const irq_code_t *, sysarg_t,
     cap_irq_handle_t *);
 extern errno_t ipc_irq_unsubscribe(cap_irq_handle_t);
 
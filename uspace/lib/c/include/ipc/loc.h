@@ -68,7 +68,9 @@ typedef enum {
 	LOC_GET_SERVICE_COUNT,
 	LOC_GET_CATEGORIES,
 	LOC_GET_NAMESPACES,
-	LOC_GET_SERVICES
+	LOC_GET_SERVICES,
+	LOC_GET_GENERATION,
+	LOC_CAT_CHANGED_GET
 } loc_request_t;
 
 typedef enum {
@@ -34,6 +34,7 @@
 #define _LIBC_IPC_LOGGER_H_
 
 #include <ipc/common.h>
+#include <stdint.h>
 
 typedef enum {
 	/** Set (global) default displayed logging level.
@@ -71,9 +72,85 @@ typedef enum {
 	 * Returns: error code
 	 * Followed by: string with the message.
 	 */
-	LOGGER_WRITER_MESSAGE
+	LOGGER_WRITER_MESSAGE,
+	/** Register a format string for the shared message ring.
+	 *
+	 * Returns: error code, format id
+	 * Followed by: string with the printf-like format.
+	 */
+	LOGGER_WRITER_REGISTER_FMT,
+	/** Set up the shared message ring.
+	 *
+	 * Returns: error code
+	 * Followed by: async_window_setup() sharing the ring.
+	 */
+	LOGGER_WRITER_CREATE_RING,
+	/** Notify the logger that the shared message ring is not empty.
+	 *
+	 * Sent as a message (no answer is expected).
+	 */
+	LOGGER_WRITER_RING_NOTIFY
 } logger_writer_request_t;
 
+/** Size of the shared message ring (including its header). */
+#define LOGGER_RING_SIZE  32768
+
+/** Maximum number of arguments in one binary log record. */
+#define LOGGER_RING_MAX_ARGS  8
+
+/** Format id of padding records at the end of the ring data area. */
+#define LOGGER_RING_PAD  UINT32_MAX
+
+/** Types of binary log record arguments. */
+typedef enum {
+	/** Signed integer (sign-extended to 64 bits) */
+	LOGGER_ARG_SIGNED = 0,
+	/** Unsigned integer */
+	LOGGER_ARG_UNSIGNED,
+	/** String stored inline (value is its offset within the record) */
+	LOGGER_ARG_STR
+} logger_ring_arg_t;
+
+/** Header of the shared message ring.
+ *
+ * The ring is written by the client task and drained asynchronously by
+ * the logger. Both positions only ever grow; a position modulo the size
+ * of the data area yields the offset of the next record. Records never
+ * wrap around the end of the data area: where a record would not fit
+ * contiguously, the remaining bytes are covered by a padding record.
+ */
+typedef struct {
+	/** Total number of bytes produced */
+	volatile uint64_t wpos;
+	/** Total number of bytes consumed */
+	volatile uint64_t rpos;
+	/** Record data */
+	uint8_t data[];
+} logger_ring_t;
+
+/** One binary log record in the shared message ring.
+ *
+ * The header is followed by the inline data of string arguments. The
+ * total size is always a multiple of eight bytes.
+ */
+typedef struct {
+	/** Record size in bytes (including this header) */
+	uint32_t size;
+	/** Format id from LOGGER_WRITER_REGISTER_FMT */
+	uint32_t fmt_id;
+	/** Log id */
+	uint64_t log_id;
+	/** Severity level (log_level_t) */
+	uint8_t level;
+	/** Number of arguments */
+	uint8_t argc;
+	/** Argument types (logger_ring_arg_t) */
+	uint8_t atype[LOGGER_RING_MAX_ARGS];
+	uint8_t pad[6];
+	/** Argument values */
+	uint64_t aval[LOGGER_RING_MAX_ARGS];
+} logger_ring_rec_t;
+
 #endif
 
 /** @}
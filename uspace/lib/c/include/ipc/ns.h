@@ -41,11 +41,15 @@ typedef enum {
 	NS_PING = IPC_FIRST_USER_METHOD,
 	NS_REGISTER,
 	NS_REGISTER_BROKER,
+	NS_REGISTER_MULTI,
 	NS_TASK_WAIT,
 	NS_ID_INTRO,
 	NS_RETVAL
 } ns_request_t;
 
+/** Maximum number of interfaces NS_REGISTER_MULTI accepts at once. */
+#define NS_MAX_IFACES  16
+
 #endif
 
 /** @}
@@ -77,10 +77,12 @@ typedef enum {
 	VFS_IN_OPEN,
 	VFS_IN_PUT,
 	VFS_IN_READ,
+	VFS_IN_READDIR,
 	VFS_IN_REGISTER,
 	VFS_IN_RENAME,
 	VFS_IN_RESIZE,
 	VFS_IN_STAT,
+	VFS_IN_STAT_BATCH,
 	VFS_IN_STATFS,
 	VFS_IN_SYNC,
 	VFS_IN_UNLINK,
@@ -187,6 +189,13 @@ enum {
 	MODE_READ = 1,
 	MODE_WRITE = 2,
 	MODE_APPEND = 4,
+	/**
+	 * Coalesce small sequential writes in the VFS server and forward them
+	 * to the file system in larger chunks.  Buffered data is flushed when
+	 * the buffer fills up or ages out, and on sync, seek-away, read,
+	 * resize and the last close of the file.
+	 */
+	MODE_BUFWRITE = 8,
 };
 
 #endif
@@ -35,14 +35,65 @@
 #ifndef _LIBC_MALLOC_H_
 #define _LIBC_MALLOC_H_
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <_bits/decls.h>
 
 #ifdef _HELENOS_SOURCE
 __HELENOS_DECLS_BEGIN;
 
+/** Number of power-of-two size classes tracked by the heap statistics. */
+#define HEAP_STATS_CLASSES  32
+
+/** Number of call sites tracked by the allocation sampler. */
+#define HEAP_STATS_SITES  32
+
+/** Number of program counters captured per sampled call site. */
+#define HEAP_STATS_FRAMES  6
+
+/** Heap allocation statistics.
+ *
+ * Sizes are gross block sizes (including the allocator overhead) and
+ * class i covers blocks of [2^i, 2^(i + 1)) bytes. The counters only
+ * reflect allocations made while the statistics were enabled; frees of
+ * older blocks are counted, but do not decrease the live byte count
+ * below zero.
+ */
+typedef struct {
+	/** Allocations per size class. */
+	uint64_t alloc_count[HEAP_STATS_CLASSES];
+
+	/** Deallocations per size class. */
+	uint64_t free_count[HEAP_STATS_CLASSES];
+
+	/** Bytes currently allocated. */
+	uint64_t live_bytes;
+
+	/** Largest value of live_bytes observed so far. */
+	uint64_t peak_bytes;
+} heap_stats_t;
+
+/** Sampled allocation call site. */
+typedef struct {
+	/** Call chain, innermost frame first, zero-padded. */
+	uintptr_t pc[HEAP_STATS_FRAMES];
+
+	/** Number of sampled allocations from this call chain. */
+	uint64_t count;
+
+	/** Gross bytes attributed to this call chain. */
+	uint64_t bytes;
+} heap_stats_site_t;
+
 extern void *heap_check(void);
 
+extern void heap_stats_enable(bool);
+extern void heap_stats_sampling(size_t);
+extern void heap_stats_get(heap_stats_t *);
+extern size_t heap_stats_sites_get(heap_stats_site_t *, size_t);
+extern void heap_stats_log(void);
+
 __HELENOS_DECLS_END;
 #endif
 
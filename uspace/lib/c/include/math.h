@@ -54,6 +54,10 @@ void sincos(double, double *, double *);
 void sincosf(float, float *, float *);
 void sincosl(long double, long double *, long double *);
 
+/* HelenOS extensions: fast evaluation over arrays of arguments. */
+void math_sin_batch(const double *, double *, size_t);
+void math_cos_batch(const double *, double *, size_t);
+
 #endif
 
 #if FLT_EVAL_METHOD == 0
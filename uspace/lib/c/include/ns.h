@@ -41,8 +41,12 @@
 
 extern errno_t service_register(service_t, iface_t, async_port_handler_t,
     void *);
+extern errno_t service_register_multi(service_t, const iface_t *, size_t,
+    async_port_handler_t, void *);
 extern errno_t service_register_broker(service_t, async_port_handler_t, void *);
 extern async_sess_t *service_connect(service_t, iface_t, sysarg_t, errno_t *);
+extern async_sess_t *service_connect_cached(service_t, iface_t, sysarg_t,
+    errno_t *);
 extern async_sess_t *service_connect_blocking(service_t, iface_t, sysarg_t,
     errno_t *);
 
@@ -51,6 +51,7 @@ extern elf_symbol_t *symbol_bfs_find(const char *, module_t *, module_t **);
 extern elf_symbol_t *symbol_def_find(const char *, module_t *,
     symbol_search_flags_t, module_t **);
 extern void *symbol_get_addr(elf_symbol_t *, module_t *, tcb_t *);
+extern void symbol_cache_invalidate(rtld_t *);
 
 #endif
 
@@ -35,8 +35,10 @@
 #ifndef _LIBC_TYPES_RTLD_RTLD_H_
 #define _LIBC_TYPES_RTLD_RTLD_H_
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <elf/elf_mod.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -60,6 +62,12 @@ typedef struct rtld {
 
 	/** List of initial modules */
 	list_t imodules;
+
+	/** Cache of global-scope symbol lookups */
+	hash_table_t sym_cache;
+
+	/** True if @c sym_cache has been initialized */
+	bool sym_cache_init;
 } rtld_t;
 
 #endif
@@ -36,6 +36,7 @@
 #define _LIBC_UDEBUG_H_
 
 #include <abi/udebug.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <async.h>
@@ -52,6 +53,11 @@ extern errno_t udebug_name_read(async_sess_t *, void *, size_t, size_t *,
 extern errno_t udebug_areas_read(async_sess_t *, void *, size_t, size_t *,
     size_t *);
 extern errno_t udebug_mem_read(async_sess_t *, void *, uintptr_t, size_t);
+extern errno_t udebug_mem_read_v(async_sess_t *, void *,
+    const udebug_mem_range_t *, size_t);
+extern errno_t udebug_ev_ring_set(async_sess_t *, bool);
+extern errno_t udebug_ev_read(async_sess_t *, void *, size_t, size_t *,
+    size_t *, size_t *);
 extern errno_t udebug_args_read(async_sess_t *, thash_t, sysarg_t *);
 extern errno_t udebug_regs_read(async_sess_t *, thash_t, void *);
 extern errno_t udebug_go(async_sess_t *, thash_t, udebug_event_t *, sysarg_t *,
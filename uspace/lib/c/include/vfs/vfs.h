@@ -64,6 +64,12 @@ typedef struct {
 	service_id_t service;
 } vfs_stat_t;
 
+/** Single result of vfs_stat_batch(). The stat is valid only if rc == EOK. */
+typedef struct {
+	errno_t rc;
+	vfs_stat_t stat;
+} vfs_stat_batch_t;
+
 typedef struct {
 	char fs_name[FS_NAME_MAXLEN + 1];
 	uint32_t f_bsize;    /* fundamental file system block size */
@@ -78,9 +84,29 @@ typedef struct {
 	size_t size;
 } vfs_fstypes_t;
 
+/** Single buffer of a vectored I/O transfer. */
+typedef struct {
+	void *buffer;
+	size_t size;
+} vfs_iovec_t;
+
+/** Completion token of an asynchronous read or write request.
+ *
+ * Filled in by vfs_read_async() and vfs_write_async() and consumed by
+ * vfs_async_wait().  The token and the data buffer of the request must
+ * remain valid until the wait completes.
+ */
+typedef struct {
+	async_exch_t *exch;
+	aid_t req;
+	aid_t data_req;
+	ipc_call_t answer;
+} vfs_async_t;
+
 extern errno_t vfs_fhandle(FILE *, int *);
 
 extern char *vfs_absolutize(const char *, size_t *);
+extern errno_t vfs_async_wait(vfs_async_t *, size_t *);
 extern errno_t vfs_clone(int, int, bool, int *);
 extern errno_t vfs_cwd_get(char *path, size_t);
 extern errno_t vfs_cwd_set(const char *path);
@@ -93,6 +119,7 @@ extern errno_t vfs_link(int, const char *, vfs_file_kind_t, int *);
 extern errno_t vfs_link_path(const char *, vfs_file_kind_t, int *);
 extern errno_t vfs_lookup(const char *, int, int *);
 extern errno_t vfs_lookup_open(const char *, int, int, int *);
+extern errno_t vfs_map(int, size_t, void **);
 extern errno_t vfs_mount_path(const char *, const char *, const char *,
     const char *, unsigned int, unsigned int);
 extern errno_t vfs_mount(int, const char *, service_id_t, const char *, unsigned,
@@ -101,13 +128,18 @@ extern errno_t vfs_open(int, int);
 extern errno_t vfs_pass_handle(async_exch_t *, int, async_exch_t *);
 extern errno_t vfs_put(int);
 extern errno_t vfs_read(int, aoff64_t *, void *, size_t, size_t *);
+extern errno_t vfs_read_async(int, aoff64_t, void *, size_t, vfs_async_t *);
 extern errno_t vfs_read_short(int, aoff64_t, void *, size_t, ssize_t *);
+extern errno_t vfs_readdir_bulk(int, aoff64_t *, void *, size_t, size_t *);
+extern errno_t vfs_readv(int, aoff64_t *, const vfs_iovec_t *, size_t,
+    size_t *);
 extern errno_t vfs_receive_handle(bool, int *);
 extern errno_t vfs_rename_path(const char *, const char *);
 extern errno_t vfs_resize(int, aoff64_t);
 extern int vfs_root(void);
 extern errno_t vfs_root_set(int);
 extern errno_t vfs_stat(int, vfs_stat_t *);
+extern errno_t vfs_stat_batch(const char *const *, size_t, vfs_stat_batch_t *);
 extern errno_t vfs_stat_path(const char *, vfs_stat_t *);
 extern errno_t vfs_statfs(int, vfs_statfs_t *);
 extern errno_t vfs_statfs_path(const char *, vfs_statfs_t *);
@@ -118,7 +150,11 @@ extern errno_t vfs_unmount(int);
 extern errno_t vfs_unmount_path(const char *);
 extern errno_t vfs_walk(int, const char *, int, int *);
 extern errno_t vfs_write(int, aoff64_t *, const void *, size_t, size_t *);
+extern errno_t vfs_write_async(int, aoff64_t, const void *, size_t,
+    vfs_async_t *);
 extern errno_t vfs_write_short(int, aoff64_t, const void *, size_t, ssize_t *);
+extern errno_t vfs_writev(int, aoff64_t *, const vfs_iovec_t *, size_t,
+    size_t *);
 
 #endif
 
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/btree.h>
+#include <pcut/pcut.h>
+#include <stdlib.h>
+
+/** Test entry */
+typedef struct {
+	int key;
+} test_entry_t;
+
+enum {
+	/** Length of test number sequences */
+	test_seq_len = 300
+};
+
+/** Test get key function.
+ *
+ * @param entry Entry
+ * @return Pointer to key
+ */
+static void *test_getkey(void *entry)
+{
+	return &((test_entry_t *) entry)->key;
+}
+
+/** Test compare function.
+ *
+ * @param a First key
+ * @param b Second key
+ * @return <0, 0, >0 if @a a is less than, equal or greater than @a b
+ */
+static int test_cmp(void *a, void *b)
+{
+	int *ia = (int *)a;
+	int *ib = (int *)b;
+
+	return *ia - *ib;
+}
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(btree);
+
+/** Increasing sequence test.
+ *
+ * Test initialization, emptiness, insertion of increasing sequence and
+ * walking via btree_first / btree_find_gt.
+ */
+PCUT_TEST(incr_seq)
+{
+	btree_t btree;
+	test_entry_t *e;
+	int i;
+
+	btree_initialize(&btree, test_getkey, test_cmp);
+
+	PCUT_ASSERT_EQUALS(true, btree_empty(&btree));
+
+	for (i = 0; i < test_seq_len; i++) {
+		e = calloc(1, sizeof(test_entry_t));
+		PCUT_ASSERT_NOT_NULL(e);
+
+		e->key = i;
+		PCUT_ASSERT_ERRNO_VAL(EOK, btree_insert(&btree, e));
+		PCUT_ASSERT_ERRNO_VAL(EOK, btree_validate(&btree));
+	}
+
+	PCUT_ASSERT_INT_EQUALS(test_seq_len, (int) btree_count(&btree));
+
+	i = 0;
+	e = btree_first(&btree);
+	while (e != NULL) {
+		PCUT_ASSERT_INT_EQUALS(i, e->key);
+		e = btree_find_gt(&btree, &e->key);
+		++i;
+	}
+	PCUT_ASSERT_INT_EQUALS(test_seq_len, i);
+
+	i = test_seq_len;
+	e = btree_last(&btree);
+	while (e != NULL) {
+		--i;
+		PCUT_ASSERT_INT_EQUALS(i, e->key);
+		e = btree_find_lt(&btree, &e->key);
+	}
+
+	PCUT_ASSERT_INT_EQUALS(0, i);
+
+	while (!btree_empty(&btree)) {
+		e = btree_first(&btree);
+		PCUT_ASSERT_NOT_NULL(btree_remove(&btree, &e->key));
+		free(e);
+	}
+
+	btree_finalize(&btree);
+}
+
+/** Decreasing sequence test.
+ *
+ * Test insertion of decreasing sequence and duplicate rejection.
+ */
+PCUT_TEST(decr_seq)
+{
+	btree_t btree;
+	test_entry_t *e;
+	test_entry_t dup;
+	int i;
+
+	btree_initialize(&btree, test_getkey, test_cmp);
+
+	for (i = test_seq_len - 1; i >= 0; i--) {
+		e = calloc(1, sizeof(test_entry_t));
+		PCUT_ASSERT_NOT_NULL(e);
+
+		e->key = i;
+		PCUT_ASSERT_ERRNO_VAL(EOK, btree_insert(&btree, e));
+		PCUT_ASSERT_ERRNO_VAL(EOK, btree_validate(&btree));
+	}
+
+	dup.key = test_seq_len / 2;
+	PCUT_ASSERT_ERRNO_VAL(EEXIST, btree_insert(&btree, &dup));
+	PCUT_ASSERT_INT_EQUALS(test_seq_len, (int) btree_count(&btree));
+
+	i = 0;
+	e = btree_first(&btree);
+	while (e != NULL) {
+		PCUT_ASSERT_INT_EQUALS(i, e->key);
+		e = btree_find_gt(&btree, &e->key);
+		++i;
+	}
+	PCUT_ASSERT_INT_EQUALS(test_seq_len, i);
+
+	while (!btree_empty(&btree)) {
+		e = btree_first(&btree);
+		PCUT_ASSERT_NOT_NULL(btree_remove(&btree, &e->key));
+		free(e);
+	}
+
+	btree_finalize(&btree);
+}
+
+/** Removal test.
+ *
+ * Remove every other entry and verify the survivors and the tree
+ * invariants after each removal.
+ */
+PCUT_TEST(remove_alternate)
+{
+	btree_t btree;
+	test_entry_t *e;
+	int key;
+	int i;
+
+	btree_initialize(&btree, test_getkey, test_cmp);
+
+	for (i = 0; i < test_seq_len; i++) {
+		e = calloc(1, sizeof(test_entry_t));
+		PCUT_ASSERT_NOT_NULL(e);
+
+		e->key = i;
+		PCUT_ASSERT_ERRNO_VAL(EOK, btree_insert(&btree, e));
+	}
+
+	for (i = 0; i < test_seq_len; i += 2) {
+		e = btree_remove(&btree, &i);
+		PCUT_ASSERT_NOT_NULL(e);
+		PCUT_ASSERT_INT_EQUALS(i, e->key);
+		PCUT_ASSERT_ERRNO_VAL(EOK, btree_validate(&btree));
+		free(e);
+	}
+
+	PCUT_ASSERT_INT_EQUALS(test_seq_len / 2, (int) btree_count(&btree));
+
+	/* Removing an absent key must fail. */
+	key = 0;
+	PCUT_ASSERT_NULL(btree_remove(&btree, &key));
+
+	i = 1;
+	e = btree_first(&btree);
+	while (e != NULL) {
+		PCUT_ASSERT_INT_EQUALS(i, e->key);
+		e = btree_find_gt(&btree, &e->key);
+		i += 2;
+	}
+	PCUT_ASSERT_INT_EQUALS(test_seq_len + 1, i);
+
+	while (!btree_empty(&btree)) {
+		e = btree_first(&btree);
+		PCUT_ASSERT_NOT_NULL(btree_remove(&btree, &e->key));
+		free(e);
+	}
+
+	PCUT_ASSERT_EQUALS(true, btree_empty(&btree));
+	btree_finalize(&btree);
+}
+
+/** Find tests.
+ *
+ * Test btree_find_eq / geq / gt / leq / lt on a sequence of even keys.
+ */
+PCUT_TEST(find)
+{
+	btree_t btree;
+	test_entry_t *e;
+	int key;
+	int i;
+
+	btree_initialize(&btree, test_getkey, test_cmp);
+
+	/* Keys 0, 2, 4, ..., 2 * (test_seq_len - 1) */
+	for (i = 0; i < test_seq_len; i++) {
+		e = calloc(1, sizeof(test_entry_t));
+		PCUT_ASSERT_NOT_NULL(e);
+
+		e->key = 2 * i;
+		PCUT_ASSERT_ERRNO_VAL(EOK, btree_insert(&btree, e));
+	}
+
+	key = 10;
+	e = btree_find_eq(&btree, &key);
+	PCUT_ASSERT_NOT_NULL(e);
+	PCUT_ASSERT_INT_EQUALS(10, e->key);
+
+	key = 11;
+	PCUT_ASSERT_NULL(btree_find_eq(&btree, &key));
+
+	e = btree_find_geq(&btree, &key);
+	PCUT_ASSERT_NOT_NULL(e);
+	PCUT_ASSERT_INT_EQUALS(12, e->key);
+
+	key = 10;
+	e = btree_find_geq(&btree, &key);
+	PCUT_ASSERT_NOT_NULL(e);
+	PCUT_ASSERT_INT_EQUALS(10, e->key);
+
+	e = btree_find_gt(&btree, &key);
+	PCUT_ASSERT_NOT_NULL(e);
+	PCUT_ASSERT_INT_EQUALS(12, e->key);
+
+	e = btree_find_leq(&btree, &key);
+	PCUT_ASSERT_NOT_NULL(e);
+	PCUT_ASSERT_INT_EQUALS(10, e->key);
+
+	key = 11;
+	e = btree_find_leq(&btree, &key);
+	PCUT_ASSERT_NOT_NULL(e);
+	PCUT_ASSERT_INT_EQUALS(10, e->key);
+
+	key = 10;
+	e = btree_find_lt(&btree, &key);
+	PCUT_ASSERT_NOT_NULL(e);
+	PCUT_ASSERT_INT_EQUALS(8, e->key);
+
+	key = 0;
+	PCUT_ASSERT_NULL(btree_find_lt(&btree, &key));
+
+	key = 2 * (test_seq_len - 1);
+	PCUT_ASSERT_NULL(btree_find_gt(&btree, &key));
+
+	key = -1;
+	e = btree_find_geq(&btree, &key);
+	PCUT_ASSERT_NOT_NULL(e);
+	PCUT_ASSERT_INT_EQUALS(0, e->key);
+
+	while (!btree_empty(&btree)) {
+		e = btree_first(&btree);
+		PCUT_ASSERT_NOT_NULL(btree_remove(&btree, &e->key));
+		free(e);
+	}
+
+	btree_finalize(&btree);
+}
+
+PCUT_EXPORT(btree);
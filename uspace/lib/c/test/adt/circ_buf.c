@@ -78,4 +78,42 @@ PCUT_TEST(push_pop)
 	PCUT_ASSERT_ERRNO_VAL(EAGAIN, rc);
 }
 
+/** Batched insertion/deletion test.
+ *
+ * Test pushing and popping batches of entries, including batches that
+ * wrap around the end of the buffer and batches truncated by the
+ * buffer filling up or running empty.
+ */
+PCUT_TEST(push_pop_n)
+{
+	circ_buf_t cbuf;
+	int src[buffer_size];
+	int dst[buffer_size];
+	int i;
+
+	circ_buf_init(&cbuf, buffer, buffer_size, sizeof(int));
+
+	for (i = 0; i < buffer_size; i++)
+		src[i] = i;
+
+	/* Offset the indices so that batches wrap around the end. */
+	PCUT_ASSERT_INT_EQUALS(buffer_size - 6,
+	    circ_buf_push_n(&cbuf, src, buffer_size - 6));
+	PCUT_ASSERT_INT_EQUALS(buffer_size - 6,
+	    circ_buf_pop_n(&cbuf, dst, buffer_size));
+
+	/* A batch larger than the free space must be truncated. */
+	PCUT_ASSERT_INT_EQUALS(buffer_size,
+	    circ_buf_push_n(&cbuf, src, buffer_size + 4));
+	PCUT_ASSERT_INT_EQUALS(0, circ_buf_push_n(&cbuf, src, 1));
+	PCUT_ASSERT_INT_EQUALS(buffer_size, circ_buf_nused(&cbuf));
+
+	PCUT_ASSERT_INT_EQUALS(buffer_size,
+	    circ_buf_pop_n(&cbuf, dst, buffer_size + 4));
+	PCUT_ASSERT_INT_EQUALS(0, circ_buf_pop_n(&cbuf, dst, 1));
+
+	for (i = 0; i < buffer_size; i++)
+		PCUT_ASSERT_INT_EQUALS(i, dst[i]);
+}
+
 PCUT_EXPORT(circ_buf);
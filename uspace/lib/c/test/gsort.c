@@ -28,6 +28,7 @@
 
 #include <pcut/pcut.h>
 #include <gsort.h>
+#include <stdlib.h>
 
 static int cmp_func(void *a, void *b, void *param)
 {
@@ -105,4 +106,66 @@ PCUT_TEST(gsort_desc)
 	}
 }
 
+/* sort a large random array */
+PCUT_TEST(gsort_large_random)
+{
+	int size = 10000;
+	int *data = malloc(size * sizeof(int));
+	PCUT_ASSERT_NOT_NULL(data);
+
+	unsigned seed = 1;
+	for (int i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (int) (seed % 1000);
+	}
+
+	bool ret = gsort(data, size, sizeof(int), cmp_func, NULL);
+	PCUT_ASSERT_TRUE(ret);
+
+	int prev = data[0];
+	for (int i = 1; i < size; i++) {
+		PCUT_ASSERT_TRUE(prev <= data[i]);
+		prev = data[i];
+	}
+
+	free(data);
+}
+
+typedef struct {
+	short key;
+	char tag;
+} odd_elem_t;
+
+static int cmp_odd_func(void *a, void *b, void *param)
+{
+	odd_elem_t *ea = (odd_elem_t *) a;
+	odd_elem_t *eb = (odd_elem_t *) b;
+
+	if (ea->key == eb->key)
+		return 0;
+
+	return ea->key < eb->key ? -1 : 1;
+}
+
+/* sort elements of an uncommon width, keeping payload with key */
+PCUT_TEST(gsort_odd_width)
+{
+	int size = 100;
+	odd_elem_t data[size];
+
+	for (int i = 0; i < size; i++) {
+		data[i].key = (short) ((i * 29) % 37);
+		data[i].tag = (char) (data[i].key % 10);
+	}
+
+	bool ret = gsort(data, size, sizeof(odd_elem_t), cmp_odd_func, NULL);
+	PCUT_ASSERT_TRUE(ret);
+
+	for (int i = 0; i < size; i++) {
+		if (i > 0)
+			PCUT_ASSERT_TRUE(data[i - 1].key <= data[i].key);
+		PCUT_ASSERT_INT_EQUALS(data[i].key % 10, data[i].tag);
+	}
+}
+
 PCUT_EXPORT(gsort);
@@ -32,6 +32,7 @@
 
 PCUT_INIT;
 
+PCUT_IMPORT(btree);
 PCUT_IMPORT(capa);
 PCUT_IMPORT(casting);
 PCUT_IMPORT(circ_buf);
@@ -35,6 +35,7 @@
  */
 
 #include <errno.h>
+#include <mem.h>
 #include <pcut/pcut.h>
 #include <stdio.h>
 #include <str.h>
@@ -131,6 +132,35 @@ PCUT_TEST(tmpfile)
 	fclose(f);
 }
 
+/** Large fwrite exercising the stream buffer bypass */
+PCUT_TEST(fwrite_large)
+{
+	FILE *f;
+	static char wbuf[5 * BUFSIZ];
+	static char rbuf[5 * BUFSIZ];
+	size_t n;
+	size_t i;
+
+	for (i = 0; i < sizeof(wbuf); i++)
+		wbuf[i] = (char) ('a' + (i % 26));
+
+	f = tmpfile();
+	PCUT_ASSERT_NOT_NULL(f);
+
+	/* Mix a small staged write with a large direct one. */
+	n = fwrite(wbuf, 1, 10, f);
+	PCUT_ASSERT_INT_EQUALS(10, n);
+	n = fwrite(wbuf + 10, 1, sizeof(wbuf) - 10, f);
+	PCUT_ASSERT_INT_EQUALS(sizeof(wbuf) - 10, n);
+
+	rewind(f);
+	n = fread(rbuf, 1, sizeof(rbuf), f);
+	PCUT_ASSERT_INT_EQUALS(sizeof(rbuf), n);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(wbuf, rbuf, sizeof(wbuf)));
+
+	fclose(f);
+}
+
 /** tmpnam function with buffer argument */
 PCUT_TEST(tmpnam_buf)
 {
@@ -37,11 +37,14 @@
 #define _CODEPAGE_CP437_H
 
 #include <errno.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <str.h>
 
 extern char32_t cp437_decode(uint8_t);
 extern errno_t cp437_encode(char32_t, uint8_t *);
+extern errno_t cp437_decode_str(const uint8_t *, size_t, char *, size_t);
+extern errno_t cp437_encode_str(const char *, uint8_t *, size_t, size_t *);
 
 #endif
 
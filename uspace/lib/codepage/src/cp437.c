@@ -37,6 +37,7 @@
  * (such as box drawing) used in text-based user interfaces.
  */
 
+#include <assert.h>
 #include <codepage/cp437.h>
 #include <errno.h>
 #include <stdint.h>
@@ -324,5 +325,76 @@ errno_t cp437_encode(char32_t c, uint8_t *code)
 	return EOK;
 }
 
+/** Decode a buffer of code page 437 codes into a string.
+ *
+ * Converts an entire run of 8-bit codes (such as a directory entry name
+ * or a row of text) with a single call, indexing the translation table
+ * directly instead of decoding one character per call.
+ *
+ * @param data Buffer of 8-bit codes
+ * @param nbytes Number of codes in the buffer
+ * @param dest Destination buffer for the null-terminated string
+ * @param size Size of the destination buffer in bytes
+ * @return EOK on success, EOVERFLOW if the string does not fit
+ *         into the destination buffer.
+ */
+errno_t cp437_decode_str(const uint8_t *data, size_t nbytes, char *dest,
+    size_t size)
+{
+	size_t offs;
+	size_t i;
+	errno_t rc;
+
+	assert(size > 0);
+
+	offs = 0;
+	for (i = 0; i < nbytes; i++) {
+		rc = chr_encode(cp437[data[i]], dest, &offs, size - 1);
+		if (rc != EOK)
+			return rc;
+	}
+
+	dest[offs] = '\0';
+	return EOK;
+}
+
+/** Encode a string to a buffer of code page 437 codes.
+ *
+ * Converts an entire string with a single call. The output is not
+ * null-terminated; the number of codes produced is returned instead.
+ *
+ * @param str String to encode
+ * @param data Destination buffer for the 8-bit codes
+ * @param size Size of the destination buffer in bytes
+ * @param nbytes Place to store the number of codes produced
+ * @return EOK on success, EDOM if a character cannot be encoded to
+ *         CP437, EOVERFLOW if the destination buffer is too small.
+ */
+errno_t cp437_encode_str(const char *str, uint8_t *data, size_t size,
+    size_t *nbytes)
+{
+	size_t offs;
+	size_t n;
+	char32_t c;
+	errno_t rc;
+
+	offs = 0;
+	n = 0;
+
+	while ((c = str_decode(str, &offs, STR_NO_LIMIT)) != 0) {
+		if (n >= size)
+			return EOVERFLOW;
+
+		rc = cp437_encode(c, &data[n]);
+		if (rc != EOK)
+			return rc;
+
+		++n;
+	}
+
+	*nbytes = n;
+	return EOK;
+}
+
 /** @}
  */
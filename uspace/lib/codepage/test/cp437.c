@@ -28,6 +28,7 @@
 
 #include <codepage/cp437.h>
 #include <pcut/pcut.h>
+#include <str.h>
 
 PCUT_INIT;
 
@@ -85,4 +86,51 @@ PCUT_TEST(encode_cases)
 	PCUT_ASSERT_ERRNO_VAL(EDOM, rc);
 }
 
+/** Batch decoding of a buffer of codes */
+PCUT_TEST(decode_str)
+{
+	uint8_t codes[] = { 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0xdb };
+	char buf[32];
+	errno_t rc;
+
+	rc = cp437_decode_str(codes, sizeof(codes), buf, sizeof(buf));
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, str_cmp(buf, "Hello█"));
+
+	/* Empty input produces an empty string */
+	rc = cp437_decode_str(codes, 0, buf, sizeof(buf));
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, str_cmp(buf, ""));
+
+	/* Output that does not fit is rejected */
+	rc = cp437_decode_str(codes, sizeof(codes), buf, 6);
+	PCUT_ASSERT_ERRNO_VAL(EOVERFLOW, rc);
+}
+
+/** Batch encoding of a string */
+PCUT_TEST(encode_str)
+{
+	uint8_t codes[8];
+	size_t nbytes;
+	errno_t rc;
+
+	rc = cp437_encode_str("Hello█", codes, sizeof(codes), &nbytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(6, nbytes);
+	PCUT_ASSERT_INT_EQUALS(0x48, codes[0]);
+	PCUT_ASSERT_INT_EQUALS(0x65, codes[1]);
+	PCUT_ASSERT_INT_EQUALS(0x6c, codes[2]);
+	PCUT_ASSERT_INT_EQUALS(0x6c, codes[3]);
+	PCUT_ASSERT_INT_EQUALS(0x6f, codes[4]);
+	PCUT_ASSERT_INT_EQUALS(0xdb, codes[5]);
+
+	/* Character that has no CP437 representation */
+	rc = cp437_encode_str("aőb", codes, sizeof(codes), &nbytes);
+	PCUT_ASSERT_ERRNO_VAL(EDOM, rc);
+
+	/* String longer than the destination buffer */
+	rc = cp437_encode_str("Hello█", codes, 3, &nbytes);
+	PCUT_ASSERT_ERRNO_VAL(EOVERFLOW, rc);
+}
+
 PCUT_EXPORT(cp437);
@@ -0,0 +1,1206 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ * @brief Implementation of deflate compression
+ *
+ * A deflate implementation (compression into a `deflate' stream as
+ * described by RFC 1951), the counterpart of inflate.c. The encoder
+ * uses hash chain string matching with lazy evaluation and emits
+ * either fixed or dynamic Huffman blocks, whichever is smaller.
+ *
+ * The API is streaming: input is pushed incrementally and compressed
+ * output is handed to a write callback, so that long-running services
+ * can compress data as it is produced. A one-shot buffer-to-buffer
+ * wrapper matching the inflate() interface is provided as well.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <mem.h>
+#include <stdlib.h>
+#include "deflate.h"
+
+/** Maximum bits in the Huffman code */
+#define MAX_HUFFMAN_BIT  15
+/** Maximum bits in the code length code */
+#define MAX_ORDER_BIT    7
+
+/** Minimum match length */
+#define MIN_MATCH  3
+/** Maximum match length */
+#define MAX_MATCH  258
+
+/** Number of length codes */
+#define MAX_LEN     29
+/** Number of distance codes */
+#define MAX_DIST    30
+/** Number of order codes */
+#define MAX_ORDER   19
+/** Number of literal/length codes */
+#define MAX_LITLEN  286
+/** Number of fixed literal/length codes */
+#define MAX_FIXED_LITLEN  288
+
+/** Size of the match window */
+#define WINDOW_SIZE  32768
+/** Size of the sliding input buffer (window and lookahead) */
+#define BUF_SIZE     (2 * WINDOW_SIZE)
+#define BUF_MASK     (BUF_SIZE - 1)
+
+/** Number of hash chain heads */
+#define HASH_SIZE  32768
+#define HASH_MASK  (HASH_SIZE - 1)
+
+/** Number of symbols buffered before a block is emitted */
+#define SYM_MAX  16384
+
+/** Size of the output staging buffer */
+#define OUT_SIZE  4096
+
+/** Do not emit minimum-length matches further back than this */
+#define TOO_FAR  4096
+
+/** Minimum lookahead for unconstrained match searching */
+#define MIN_LOOKAHEAD  (MAX_MATCH + MIN_MATCH + 1)
+
+/** Length code base values */
+static const uint16_t lens[MAX_LEN] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+/** Length code extra bits */
+static const uint16_t lens_ext[MAX_LEN] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+/** Distance code base values */
+static const uint16_t dists[MAX_DIST] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+	8193, 12289, 16385, 24577
+};
+
+/** Distance code extra bits */
+static const uint16_t dists_ext[MAX_DIST] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11,
+	12, 12, 13, 13
+};
+
+/** Order codes */
+static const short order[MAX_ORDER] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/** Extra bits of the repeat order codes 16, 17 and 18 */
+static const uint16_t order_ext[3] = {
+	2, 3, 7
+};
+
+/** Match search effort per compression level
+ *
+ */
+typedef struct {
+	uint16_t good_match;  /**< Reduce chain search above this length */
+	uint16_t lazy_match;  /**< Do not search lazily above this length */
+	uint16_t nice_match;  /**< Stop chain search at this length */
+	uint16_t max_chain;   /**< Maximum hash chain links to follow */
+} effort_t;
+
+static const effort_t efforts[DEFLATE_EFFORT_MAX + 1] = {
+	{ 0, 0, 0, 0 },  /* unused */
+	{ 4, 4, 8, 4 },
+	{ 4, 5, 16, 8 },
+	{ 4, 6, 32, 32 },
+	{ 4, 4, 16, 16 },
+	{ 8, 16, 32, 32 },
+	{ 8, 16, 128, 128 },
+	{ 8, 32, 128, 256 },
+	{ 32, 128, 258, 1024 },
+	{ 32, 258, 258, 4096 }
+};
+
+/** Deflate compression state
+ *
+ */
+struct deflate {
+	deflate_write_t write;  /**< Output callback */
+	void *arg;              /**< Output callback argument */
+	errno_t error;          /**< First error encountered */
+
+	effort_t effort;        /**< Match search effort */
+
+	/* Sliding input buffer */
+	uint8_t window[BUF_SIZE];
+	size_t strstart;        /**< Start of the current string */
+	size_t lookahead;       /**< Input bytes available at strstart */
+
+	/* Hash chains (position 0 doubles as the nil link) */
+	uint16_t head[HASH_SIZE];
+	uint16_t prev[BUF_SIZE];
+
+	/* Lazy matching */
+	size_t prev_len;        /**< Match length at the previous position */
+	size_t prev_dist;       /**< Match distance at the previous position */
+	bool pending_lit;       /**< Literal at strstart - 1 not yet emitted */
+
+	/* Buffered block contents */
+	uint16_t sym_dist[SYM_MAX];    /**< Match distance (0 for a literal) */
+	uint16_t sym_lenlit[SYM_MAX];  /**< Match length or literal byte */
+	size_t sym_cnt;
+	uint16_t lit_freq[MAX_LITLEN];
+	uint16_t dist_freq[MAX_DIST];
+
+	/* Symbol lookup */
+	uint16_t len_sym[MAX_MATCH + 1];  /**< Match length to length code */
+	uint8_t dist_sym_lo[257];         /**< Distances 1 to 256 */
+	uint8_t dist_sym_hi[256];         /**< (Distance - 1) / 128 above that */
+
+	/* Fixed Huffman codes */
+	uint8_t fixed_lit_len[MAX_FIXED_LITLEN];
+	uint16_t fixed_lit_code[MAX_FIXED_LITLEN];
+	uint8_t fixed_dist_len[MAX_DIST];
+	uint16_t fixed_dist_code[MAX_DIST];
+
+	/* Bit-level output */
+	uint32_t bitbuf;
+	size_t bitlen;
+	uint8_t outbuf[OUT_SIZE];
+	size_t outcnt;
+};
+
+/** Reverse the bit order of a Huffman code
+ *
+ * The canonical code has its first bit in the most significant
+ * position while the output stream expects the first bit in the
+ * least significant position.
+ *
+ * @param code Canonical Huffman code.
+ * @param len  Number of bits in the code.
+ *
+ * @return Bit-reversed code.
+ *
+ */
+static inline uint16_t reverse_bits(uint16_t code, size_t len)
+{
+	uint16_t rev = 0;
+
+	while (len > 0) {
+		rev = (rev << 1) | (code & 1);
+		code >>= 1;
+		len--;
+	}
+
+	return rev;
+}
+
+/** Pass accumulated output to the write callback
+ *
+ * @param state Deflate state.
+ *
+ */
+static void drain_output(deflate_t *state)
+{
+	if ((state->outcnt > 0) && (state->error == EOK)) {
+		errno_t rc = state->write(state->arg, state->outbuf,
+		    state->outcnt);
+		if (rc != EOK)
+			state->error = rc;
+	}
+
+	state->outcnt = 0;
+}
+
+/** Append a byte to the output
+ *
+ * @param state Deflate state.
+ * @param byte  Byte to append.
+ *
+ */
+static inline void out_byte(deflate_t *state, uint8_t byte)
+{
+	state->outbuf[state->outcnt] = byte;
+	state->outcnt++;
+
+	if (state->outcnt == OUT_SIZE)
+		drain_output(state);
+}
+
+/** Append bits to the output
+ *
+ * @param state Deflate state.
+ * @param val   Bits to append (least significant bit first).
+ * @param cnt   Number of bits to append (at most 16).
+ *
+ */
+static inline void put_bits(deflate_t *state, uint32_t val, size_t cnt)
+{
+	state->bitbuf |= val << state->bitlen;
+	state->bitlen += cnt;
+
+	while (state->bitlen >= 8) {
+		out_byte(state, (uint8_t) state->bitbuf);
+		state->bitbuf >>= 8;
+		state->bitlen -= 8;
+	}
+}
+
+/** Pad the output with zero bits up to a byte boundary
+ *
+ * @param state Deflate state.
+ *
+ */
+static void align_output(deflate_t *state)
+{
+	if (state->bitlen > 0) {
+		out_byte(state, (uint8_t) state->bitbuf);
+		state->bitbuf = 0;
+		state->bitlen = 0;
+	}
+}
+
+/** Compute code lengths for a canonical Huffman code
+ *
+ * Build a Huffman tree over the used symbols and derive code
+ * lengths, redistributing codes that would exceed the length
+ * limit. Unused symbols get a zero length.
+ *
+ * @param freq   Array of symbol frequencies.
+ * @param n      Number of symbols.
+ * @param limit  Maximum code length in bits.
+ * @param length Computed code lengths.
+ *
+ */
+static void huffman_lengths(const uint16_t *freq, size_t n, size_t limit,
+    uint8_t *length)
+{
+	uint16_t leaf[MAX_LITLEN];
+	uint32_t nfreq[2 * MAX_LITLEN];
+	uint16_t parent[2 * MAX_LITLEN];
+	uint16_t depth[2 * MAX_LITLEN];
+
+	memset(length, 0, n * sizeof(uint8_t));
+
+	/* Collect used symbols sorted by ascending frequency */
+	size_t nleaf = 0;
+	size_t symbol;
+	for (symbol = 0; symbol < n; symbol++) {
+		if (freq[symbol] == 0)
+			continue;
+
+		size_t pos = nleaf;
+		while ((pos > 0) && (freq[leaf[pos - 1]] > freq[symbol])) {
+			leaf[pos] = leaf[pos - 1];
+			pos--;
+		}
+
+		leaf[pos] = symbol;
+		nleaf++;
+	}
+
+	if (nleaf == 0)
+		return;
+
+	if (nleaf == 1) {
+		length[leaf[0]] = 1;
+		return;
+	}
+
+	/*
+	 * Two-queue Huffman tree construction: the sorted leaves form
+	 * one queue and the internal nodes (created in non-decreasing
+	 * frequency order) form the other.
+	 */
+	size_t node;
+	for (node = 0; node < nleaf; node++)
+		nfreq[node] = freq[leaf[node]];
+
+	size_t lq = 0;
+	size_t iq = nleaf;
+	size_t nodes = nleaf;
+
+	size_t step;
+	for (step = 0; step < nleaf - 1; step++) {
+		size_t pair[2];
+		size_t i;
+		for (i = 0; i < 2; i++) {
+			if ((lq < nleaf) &&
+			    ((iq == nodes) || (nfreq[lq] <= nfreq[iq]))) {
+				pair[i] = lq;
+				lq++;
+			} else {
+				pair[i] = iq;
+				iq++;
+			}
+		}
+
+		nfreq[nodes] = nfreq[pair[0]] + nfreq[pair[1]];
+		parent[pair[0]] = nodes;
+		parent[pair[1]] = nodes;
+		nodes++;
+	}
+
+	/* Compute leaf depths (parents always have higher indices) */
+	depth[nodes - 1] = 0;
+
+	for (node = nodes - 1; node > 0; node--)
+		depth[node - 1] = depth[parent[node - 1]] + 1;
+
+	/* Count codes of each length, clamping at the limit */
+	size_t count[MAX_HUFFMAN_BIT + 1];
+	memset(count, 0, sizeof(count));
+
+	/* Signed: the redistribution loop may overshoot by one */
+	int overflow = 0;
+
+	size_t li;
+	for (li = 0; li < nleaf; li++) {
+		size_t bits = depth[li];
+		if (bits > limit) {
+			bits = limit;
+			overflow++;
+		}
+
+		count[bits]++;
+	}
+
+	/*
+	 * Redistribute over-long codes: move a leaf from the deepest
+	 * non-full level down one level to make room for an overflowed
+	 * leaf as its sibling.
+	 */
+	while (overflow > 0) {
+		size_t bits = limit - 1;
+		while (count[bits] == 0)
+			bits--;
+
+		count[bits]--;
+		count[bits + 1] += 2;
+		count[limit]--;
+		overflow -= 2;
+	}
+
+	/* Assign the longest codes to the least frequent symbols */
+	li = 0;
+	size_t bits;
+	for (bits = limit; bits >= 1; bits--) {
+		size_t cnt;
+		for (cnt = count[bits]; cnt > 0; cnt--) {
+			length[leaf[li]] = bits;
+			li++;
+		}
+	}
+}
+
+/** Generate canonical Huffman codes from code lengths
+ *
+ * The codes are stored bit-reversed, ready for emission.
+ *
+ * @param length Code lengths.
+ * @param n      Number of symbols.
+ * @param code   Generated codes.
+ *
+ */
+static void huffman_codes(const uint8_t *length, size_t n, uint16_t *code)
+{
+	uint16_t count[MAX_HUFFMAN_BIT + 1];
+	uint16_t next[MAX_HUFFMAN_BIT + 1];
+
+	memset(count, 0, sizeof(count));
+
+	size_t symbol;
+	for (symbol = 0; symbol < n; symbol++)
+		count[length[symbol]]++;
+
+	count[0] = 0;
+
+	uint16_t val = 0;
+	size_t bits;
+	for (bits = 1; bits <= MAX_HUFFMAN_BIT; bits++) {
+		val = (val + count[bits - 1]) << 1;
+		next[bits] = val;
+	}
+
+	for (symbol = 0; symbol < n; symbol++) {
+		if (length[symbol] != 0) {
+			code[symbol] = reverse_bits(next[length[symbol]],
+			    length[symbol]);
+			next[length[symbol]]++;
+		}
+	}
+}
+
+/** Compute the cost of the block symbols in bits
+ *
+ * @param state    Deflate state.
+ * @param lit_len  Literal/length code lengths.
+ * @param dist_len Distance code lengths.
+ *
+ * @return Number of bits needed to encode the buffered symbols.
+ *
+ */
+static size_t block_cost(deflate_t *state, const uint8_t *lit_len,
+    const uint8_t *dist_len)
+{
+	size_t bits = 0;
+
+	size_t symbol;
+	for (symbol = 0; symbol < MAX_LITLEN; symbol++)
+		bits += (size_t) state->lit_freq[symbol] * lit_len[symbol];
+
+	for (symbol = 257; symbol < MAX_LITLEN; symbol++)
+		bits += (size_t) state->lit_freq[symbol] *
+		    lens_ext[symbol - 257];
+
+	for (symbol = 0; symbol < MAX_DIST; symbol++)
+		bits += (size_t) state->dist_freq[symbol] *
+		    (dist_len[symbol] + dists_ext[symbol]);
+
+	return bits;
+}
+
+/** Emit the buffered symbols using the given codes
+ *
+ * Terminated by the end-of-block code.
+ *
+ * @param state     Deflate state.
+ * @param lit_len   Literal/length code lengths.
+ * @param lit_code  Literal/length codes (bit-reversed).
+ * @param dist_len  Distance code lengths.
+ * @param dist_code Distance codes (bit-reversed).
+ *
+ */
+static void emit_symbols(deflate_t *state, const uint8_t *lit_len,
+    const uint16_t *lit_code, const uint8_t *dist_len,
+    const uint16_t *dist_code)
+{
+	size_t i;
+	for (i = 0; i < state->sym_cnt; i++) {
+		uint16_t dist = state->sym_dist[i];
+		uint16_t lenlit = state->sym_lenlit[i];
+
+		if (dist == 0) {
+			/* Literal */
+			put_bits(state, lit_code[lenlit], lit_len[lenlit]);
+			continue;
+		}
+
+		/* Match length */
+		uint16_t lsym = state->len_sym[lenlit];
+		put_bits(state, lit_code[lsym], lit_len[lsym]);
+		put_bits(state, lenlit - lens[lsym - 257],
+		    lens_ext[lsym - 257]);
+
+		/* Match distance */
+		uint16_t dsym = (dist <= 256) ?
+		    state->dist_sym_lo[dist] :
+		    state->dist_sym_hi[(dist - 1) >> 7];
+		put_bits(state, dist_code[dsym], dist_len[dsym]);
+		put_bits(state, dist - dists[dsym], dists_ext[dsym]);
+	}
+
+	/* End of block */
+	put_bits(state, lit_code[256], lit_len[256]);
+}
+
+/** Emit the buffered symbols as a complete block
+ *
+ * Choose between fixed and dynamic Huffman codes based on the
+ * resulting block size and reset the symbol buffer.
+ *
+ * @param state Deflate state.
+ * @param last  Mark the block as the last block of the stream.
+ *
+ */
+static void emit_block(deflate_t *state, bool last)
+{
+	uint8_t lit_len[MAX_FIXED_LITLEN];
+	uint16_t lit_code[MAX_FIXED_LITLEN];
+	uint8_t dist_len[MAX_DIST];
+	uint16_t dist_code[MAX_DIST];
+	uint8_t cl_len[MAX_ORDER];
+	uint16_t cl_code[MAX_ORDER];
+	uint16_t cl_freq[MAX_ORDER];
+
+	/* The end-of-block code is always present */
+	state->lit_freq[256]++;
+
+	/* Build dynamic Huffman codes */
+	huffman_lengths(state->lit_freq, MAX_LITLEN, MAX_HUFFMAN_BIT, lit_len);
+	huffman_lengths(state->dist_freq, MAX_DIST, MAX_HUFFMAN_BIT, dist_len);
+
+	/* Make sure at least one distance code exists */
+	size_t symbol;
+	bool have_dist = false;
+	for (symbol = 0; symbol < MAX_DIST; symbol++) {
+		if (dist_len[symbol] != 0)
+			have_dist = true;
+	}
+
+	if (!have_dist)
+		dist_len[0] = 1;
+
+	huffman_codes(lit_len, MAX_LITLEN, lit_code);
+	huffman_codes(dist_len, MAX_DIST, dist_code);
+
+	size_t nlen = MAX_LITLEN;
+	while ((nlen > 257) && (lit_len[nlen - 1] == 0))
+		nlen--;
+
+	size_t ndist = MAX_DIST;
+	while ((ndist > 1) && (dist_len[ndist - 1] == 0))
+		ndist--;
+
+	/*
+	 * Run-length encode the code length sequence using the
+	 * repeat codes 16 (repeat previous), 17 and 18 (repeat zero)
+	 */
+	uint8_t cl_sym[MAX_LITLEN + MAX_DIST];
+	uint8_t cl_arg[MAX_LITLEN + MAX_DIST];
+	size_t cl_cnt = 0;
+
+	memset(cl_freq, 0, sizeof(cl_freq));
+
+	size_t pos = 0;
+	while (pos < nlen + ndist) {
+		uint8_t len = (pos < nlen) ? lit_len[pos] :
+		    dist_len[pos - nlen];
+
+		size_t run = 1;
+		while ((pos + run < nlen + ndist) &&
+		    (((pos + run < nlen) ? lit_len[pos + run] :
+		    dist_len[pos + run - nlen]) == len))
+			run++;
+
+		pos += run;
+
+		if (len == 0) {
+			while (run >= 11) {
+				size_t cnt = (run > 138) ? 138 : run;
+				cl_sym[cl_cnt] = 18;
+				cl_arg[cl_cnt] = cnt - 11;
+				cl_cnt++;
+				cl_freq[18]++;
+				run -= cnt;
+			}
+
+			if (run >= 3) {
+				cl_sym[cl_cnt] = 17;
+				cl_arg[cl_cnt] = run - 3;
+				cl_cnt++;
+				cl_freq[17]++;
+				run = 0;
+			}
+		} else {
+			/* The first occurrence is coded literally */
+			cl_sym[cl_cnt] = len;
+			cl_cnt++;
+			cl_freq[len]++;
+			run--;
+
+			while (run >= 3) {
+				size_t cnt = (run > 6) ? 6 : run;
+				cl_sym[cl_cnt] = 16;
+				cl_arg[cl_cnt] = cnt - 3;
+				cl_cnt++;
+				cl_freq[16]++;
+				run -= cnt;
+			}
+		}
+
+		while (run > 0) {
+			cl_sym[cl_cnt] = len;
+			cl_cnt++;
+			cl_freq[len]++;
+			run--;
+		}
+	}
+
+	/* Build the code length code */
+	huffman_lengths(cl_freq, MAX_ORDER, MAX_ORDER_BIT, cl_len);
+	huffman_codes(cl_len, MAX_ORDER, cl_code);
+
+	size_t ncode = MAX_ORDER;
+	while ((ncode > 4) && (cl_len[order[ncode - 1]] == 0))
+		ncode--;
+
+	/* Compare the block sizes of both encodings */
+	size_t fixed_bits = block_cost(state, state->fixed_lit_len,
+	    state->fixed_dist_len);
+
+	size_t dyn_bits = 14 + 3 * ncode +
+	    block_cost(state, lit_len, dist_len);
+
+	size_t cl_used = 0;
+	size_t i;
+	for (i = 0; i < cl_cnt; i++) {
+		dyn_bits += cl_len[cl_sym[i]];
+		if (cl_sym[i] >= 16)
+			dyn_bits += order_ext[cl_sym[i] - 16];
+	}
+
+	for (symbol = 0; symbol < MAX_ORDER; symbol++) {
+		if (cl_len[symbol] != 0)
+			cl_used++;
+	}
+
+	/*
+	 * A single-symbol code length code would be incomplete, which
+	 * some decoders reject. Fixed codes are as good in this corner
+	 * case anyway.
+	 */
+	if ((fixed_bits <= dyn_bits) || (cl_used < 2)) {
+		/* Fixed Huffman codes */
+		put_bits(state, last ? 1 : 0, 1);
+		put_bits(state, 1, 2);
+
+		emit_symbols(state, state->fixed_lit_len,
+		    state->fixed_lit_code, state->fixed_dist_len,
+		    state->fixed_dist_code);
+	} else {
+		/* Dynamic Huffman codes */
+		put_bits(state, last ? 1 : 0, 1);
+		put_bits(state, 2, 2);
+
+		put_bits(state, nlen - 257, 5);
+		put_bits(state, ndist - 1, 5);
+		put_bits(state, ncode - 4, 4);
+
+		for (i = 0; i < ncode; i++)
+			put_bits(state, cl_len[order[i]], 3);
+
+		for (i = 0; i < cl_cnt; i++) {
+			put_bits(state, cl_code[cl_sym[i]], cl_len[cl_sym[i]]);
+			if (cl_sym[i] >= 16)
+				put_bits(state, cl_arg[i],
+				    order_ext[cl_sym[i] - 16]);
+		}
+
+		emit_symbols(state, lit_len, lit_code, dist_len, dist_code);
+	}
+
+	/* Reset the block */
+	state->sym_cnt = 0;
+	memset(state->lit_freq, 0, sizeof(state->lit_freq));
+	memset(state->dist_freq, 0, sizeof(state->dist_freq));
+}
+
+/** Record a literal byte
+ *
+ * @param state Deflate state.
+ * @param byte  Literal byte.
+ *
+ */
+static void record_literal(deflate_t *state, uint8_t byte)
+{
+	state->sym_dist[state->sym_cnt] = 0;
+	state->sym_lenlit[state->sym_cnt] = byte;
+	state->sym_cnt++;
+	state->lit_freq[byte]++;
+
+	if (state->sym_cnt == SYM_MAX)
+		emit_block(state, false);
+}
+
+/** Record a match
+ *
+ * @param state Deflate state.
+ * @param len   Match length.
+ * @param dist  Match distance.
+ *
+ */
+static void record_match(deflate_t *state, size_t len, size_t dist)
+{
+	state->sym_dist[state->sym_cnt] = (uint16_t) dist;
+	state->sym_lenlit[state->sym_cnt] = (uint16_t) len;
+	state->sym_cnt++;
+
+	state->lit_freq[state->len_sym[len]]++;
+	state->dist_freq[(dist <= 256) ? state->dist_sym_lo[dist] :
+	    state->dist_sym_hi[(dist - 1) >> 7]]++;
+
+	if (state->sym_cnt == SYM_MAX)
+		emit_block(state, false);
+}
+
+/** Insert a string into the hash chains
+ *
+ * @param state Deflate state.
+ * @param pos   Window position of the string.
+ *
+ * @return Previous head of the chain (0 for none).
+ *
+ */
+static inline size_t insert_string(deflate_t *state, size_t pos)
+{
+	size_t hash = ((((size_t) state->window[pos]) << 10) ^
+	    (((size_t) state->window[pos + 1]) << 5) ^
+	    ((size_t) state->window[pos + 2])) & HASH_MASK;
+
+	size_t head = state->head[hash];
+	state->prev[pos & BUF_MASK] = (uint16_t) head;
+	state->head[hash] = (uint16_t) pos;
+
+	return head;
+}
+
+/** Find the longest match for the current string
+ *
+ * Walk the hash chain starting at @a cur, keeping only matches
+ * longer than @a state->prev_len.
+ *
+ * @param state Deflate state.
+ * @param cur   Head of the hash chain for the current string.
+ * @param dist  Distance of the best match (on improvement).
+ *
+ * @return Length of the best match found (or the previous length).
+ *
+ */
+static size_t longest_match(deflate_t *state, size_t cur, size_t *dist)
+{
+	size_t chain = state->effort.max_chain;
+	size_t best_len = state->prev_len;
+
+	if (best_len >= state->effort.good_match)
+		chain >>= 2;
+
+	size_t max_len = (state->lookahead < MAX_MATCH) ?
+	    state->lookahead : MAX_MATCH;
+	if (best_len >= max_len)
+		return best_len;
+
+	size_t nice = state->effort.nice_match;
+	if (nice > max_len)
+		nice = max_len;
+
+	size_t limit = (state->strstart > WINDOW_SIZE) ?
+	    state->strstart - WINDOW_SIZE : 0;
+
+	const uint8_t *scan = state->window + state->strstart;
+	size_t best_pos = 0;
+
+	do {
+		const uint8_t *match = state->window + cur;
+
+		/*
+		 * Quickly reject candidates that cannot improve on the
+		 * best match so far
+		 */
+		if ((match[best_len] != scan[best_len]) ||
+		    (match[best_len - 1] != scan[best_len - 1]) ||
+		    (match[0] != scan[0]) || (match[1] != scan[1])) {
+			cur = state->prev[cur & BUF_MASK];
+			continue;
+		}
+
+		size_t len = 2;
+		while ((len < max_len) && (match[len] == scan[len]))
+			len++;
+
+		if (len > best_len) {
+			best_len = len;
+			best_pos = cur;
+
+			if (len >= nice)
+				break;
+		}
+
+		cur = state->prev[cur & BUF_MASK];
+	} while ((cur > limit) && (--chain > 0));
+
+	if (best_pos != 0)
+		*dist = state->strstart - best_pos;
+
+	return best_len;
+}
+
+/** Slide the window down by half the input buffer
+ *
+ * Discard the oldest half of the input buffer to make room for
+ * more input, rebasing all positions.
+ *
+ * @param state Deflate state.
+ *
+ */
+static void slide_window(deflate_t *state)
+{
+	memmove(state->window, state->window + WINDOW_SIZE,
+	    BUF_SIZE - WINDOW_SIZE);
+	state->strstart -= WINDOW_SIZE;
+
+	size_t i;
+	for (i = 0; i < HASH_SIZE; i++)
+		state->head[i] = (state->head[i] >= WINDOW_SIZE) ?
+		    (state->head[i] - WINDOW_SIZE) : 0;
+
+	for (i = 0; i < BUF_SIZE; i++)
+		state->prev[i] = (state->prev[i] >= WINDOW_SIZE) ?
+		    (state->prev[i] - WINDOW_SIZE) : 0;
+}
+
+/** Compress buffered input
+ *
+ * Lazy matching: a match at the current position is only emitted
+ * after the next position has been tried for a longer match,
+ * otherwise the current byte becomes a literal.
+ *
+ * @param state Deflate state.
+ * @param final No more input will follow (compress everything).
+ *
+ */
+static void process_input(deflate_t *state, bool final)
+{
+	while (state->lookahead > 0) {
+		/*
+		 * Unless this is the end of the stream, keep enough
+		 * lookahead to never truncate a match artificially
+		 */
+		if ((!final) && (state->lookahead < MIN_LOOKAHEAD))
+			break;
+
+		size_t head = 0;
+		if (state->lookahead >= MIN_MATCH)
+			head = insert_string(state, state->strstart);
+
+		size_t match_len = MIN_MATCH - 1;
+		size_t match_dist = 0;
+
+		if ((head != 0) &&
+		    (state->prev_len < state->effort.lazy_match) &&
+		    (state->strstart - head <= WINDOW_SIZE)) {
+			match_len = longest_match(state, head, &match_dist);
+
+			/* Too distant minimum-length matches do not pay off */
+			if ((match_len == MIN_MATCH) &&
+			    (match_dist > TOO_FAR))
+				match_len = MIN_MATCH - 1;
+		}
+
+		if ((state->prev_len >= MIN_MATCH) &&
+		    (match_len <= state->prev_len)) {
+			/* The match at the previous position wins */
+			record_match(state, state->prev_len, state->prev_dist);
+
+			/*
+			 * Insert the strings covered by the match (the
+			 * current position is inserted already)
+			 */
+			size_t max_insert = state->strstart +
+			    state->lookahead - MIN_MATCH;
+
+			state->lookahead -= state->prev_len - 1;
+			size_t steps = state->prev_len - 2;
+
+			while (steps > 0) {
+				state->strstart++;
+				if (state->strstart <= max_insert)
+					insert_string(state, state->strstart);
+				steps--;
+			}
+
+			state->strstart++;
+			state->prev_len = MIN_MATCH - 1;
+			state->pending_lit = false;
+		} else if (state->pending_lit) {
+			/* No improvement, emit the previous byte */
+			record_literal(state,
+			    state->window[state->strstart - 1]);
+
+			state->prev_len = match_len;
+			state->prev_dist = match_dist;
+			state->strstart++;
+			state->lookahead--;
+		} else {
+			/* Defer the decision by one byte */
+			state->pending_lit = true;
+			state->prev_len = match_len;
+			state->prev_dist = match_dist;
+			state->strstart++;
+			state->lookahead--;
+		}
+	}
+
+	if ((final) && (state->pending_lit)) {
+		record_literal(state, state->window[state->strstart - 1]);
+		state->pending_lit = false;
+		state->prev_len = MIN_MATCH - 1;
+	}
+}
+
+/** Create a deflate compression stream
+ *
+ * @param effort Compression effort (DEFLATE_EFFORT_MIN to
+ *               DEFLATE_EFFORT_MAX).
+ * @param write  Callback receiving the compressed output.
+ * @param arg    Argument passed to the callback.
+ * @param rstate Created stream.
+ *
+ * @return EOK on success.
+ * @return EINVAL on invalid effort.
+ * @return ENOMEM on memory allocation failure.
+ *
+ */
+errno_t deflate_create(unsigned int effort, deflate_write_t write, void *arg,
+    deflate_t **rstate)
+{
+	if ((effort < DEFLATE_EFFORT_MIN) || (effort > DEFLATE_EFFORT_MAX))
+		return EINVAL;
+
+	deflate_t *state = calloc(1, sizeof(deflate_t));
+	if (state == NULL)
+		return ENOMEM;
+
+	state->write = write;
+	state->arg = arg;
+	state->error = EOK;
+	state->effort = efforts[effort];
+	state->prev_len = MIN_MATCH - 1;
+
+	/* Match length to length code */
+	size_t symbol;
+	for (symbol = 0; symbol < MAX_LEN; symbol++) {
+		size_t next = (symbol + 1 < MAX_LEN) ?
+		    lens[symbol + 1] : (MAX_MATCH + 1);
+
+		size_t len;
+		for (len = lens[symbol]; len < next; len++)
+			state->len_sym[len] = 257 + symbol;
+	}
+
+	/* Distance to distance code */
+	for (symbol = 0; symbol < MAX_DIST; symbol++) {
+		size_t next = (symbol + 1 < MAX_DIST) ?
+		    dists[symbol + 1] : (WINDOW_SIZE + 1);
+
+		size_t dist;
+		for (dist = dists[symbol]; dist < next; dist++) {
+			if (dist <= 256)
+				state->dist_sym_lo[dist] = symbol;
+			else
+				state->dist_sym_hi[(dist - 1) >> 7] = symbol;
+		}
+	}
+
+	/* Fixed Huffman codes */
+	for (symbol = 0; symbol < MAX_FIXED_LITLEN; symbol++) {
+		if (symbol < 144)
+			state->fixed_lit_len[symbol] = 8;
+		else if (symbol < 256)
+			state->fixed_lit_len[symbol] = 9;
+		else if (symbol < 280)
+			state->fixed_lit_len[symbol] = 7;
+		else
+			state->fixed_lit_len[symbol] = 8;
+	}
+
+	for (symbol = 0; symbol < MAX_DIST; symbol++)
+		state->fixed_dist_len[symbol] = 5;
+
+	huffman_codes(state->fixed_lit_len, MAX_FIXED_LITLEN,
+	    state->fixed_lit_code);
+	huffman_codes(state->fixed_dist_len, MAX_DIST,
+	    state->fixed_dist_code);
+
+	*rstate = state;
+	return EOK;
+}
+
+/** Push input data into a deflate stream
+ *
+ * Compressed output is passed to the write callback as it is
+ * produced. Some input may be retained until more data is pushed
+ * or the stream is flushed or finished.
+ *
+ * @param state Deflate stream.
+ * @param data  Input data.
+ * @param size  Input data size (bytes).
+ *
+ * @return EOK on success.
+ * @return Error code returned by the write callback.
+ *
+ */
+errno_t deflate_push(deflate_t *state, const void *data, size_t size)
+{
+	const uint8_t *src = (const uint8_t *) data;
+
+	while (size > 0) {
+		if (state->strstart + state->lookahead == BUF_SIZE) {
+			process_input(state, false);
+
+			if (state->strstart >= WINDOW_SIZE)
+				slide_window(state);
+
+			if (state->error != EOK)
+				return state->error;
+		}
+
+		size_t space = BUF_SIZE - state->strstart - state->lookahead;
+		size_t cnt = (size < space) ? size : space;
+
+		memcpy(state->window + state->strstart + state->lookahead,
+		    src, cnt);
+		state->lookahead += cnt;
+		src += cnt;
+		size -= cnt;
+	}
+
+	process_input(state, false);
+	return state->error;
+}
+
+/** Flush a deflate stream
+ *
+ * Compress and write out all input pushed so far and realign the
+ * output to a byte boundary (by an empty stored block) so that the
+ * receiver can decode everything pushed up to this point. The
+ * stream remains open for more input.
+ *
+ * @param state Deflate stream.
+ *
+ * @return EOK on success.
+ * @return Error code returned by the write callback.
+ *
+ */
+errno_t deflate_flush(deflate_t *state)
+{
+	process_input(state, true);
+
+	if (state->sym_cnt > 0)
+		emit_block(state, false);
+
+	/* Empty stored block realigns the output to a byte boundary */
+	put_bits(state, 0, 3);
+	align_output(state);
+	out_byte(state, 0x00);
+	out_byte(state, 0x00);
+	out_byte(state, 0xff);
+	out_byte(state, 0xff);
+
+	drain_output(state);
+	return state->error;
+}
+
+/** Finish a deflate stream
+ *
+ * Compress and write out all remaining input and terminate the
+ * stream with a final block. No more input can be pushed.
+ *
+ * @param state Deflate stream.
+ *
+ * @return EOK on success.
+ * @return Error code returned by the write callback.
+ *
+ */
+errno_t deflate_finish(deflate_t *state)
+{
+	process_input(state, true);
+	emit_block(state, true);
+	align_output(state);
+	drain_output(state);
+
+	return state->error;
+}
+
+/** Destroy a deflate stream
+ *
+ * Any input not yet written out is discarded.
+ *
+ * @param state Deflate stream.
+ *
+ */
+void deflate_destroy(deflate_t *state)
+{
+	free(state);
+}
+
+/** Context of the one-shot buffer output callback */
+typedef struct {
+	uint8_t *dest;   /**< Output buffer */
+	size_t destlen;  /**< Output buffer size */
+	size_t destcnt;  /**< Position in the output buffer */
+} deflate_buf_t;
+
+static errno_t deflate_buf_write(void *arg, const void *data, size_t size)
+{
+	deflate_buf_t *buf = (deflate_buf_t *) arg;
+
+	if (buf->destcnt + size > buf->destlen)
+		return ENOMEM;
+
+	memcpy(buf->dest + buf->destcnt, data, size);
+	buf->destcnt += size;
+
+	return EOK;
+}
+
+/** Deflate data
+ *
+ * One-shot counterpart of inflate(), compressing a single buffer
+ * with the default effort.
+ *
+ * @param src     Source data buffer.
+ * @param srclen  Source buffer size (bytes).
+ * @param dest    Destination data buffer.
+ * @param destlen Destination buffer size (bytes).
+ * @param destcnt Size of the compressed data (bytes).
+ *
+ * @return EOK on success.
+ * @return ENOMEM on output buffer overrun or allocation failure.
+ *
+ */
+errno_t deflate(const void *src, size_t srclen, void *dest, size_t destlen,
+    size_t *destcnt)
+{
+	deflate_buf_t buf;
+	buf.dest = (uint8_t *) dest;
+	buf.destlen = destlen;
+	buf.destcnt = 0;
+
+	deflate_t *state;
+	errno_t rc = deflate_create(DEFLATE_EFFORT_DEFAULT, deflate_buf_write,
+	    &buf, &state);
+	if (rc != EOK)
+		return rc;
+
+	rc = deflate_push(state, src, srclen);
+	if (rc == EOK)
+		rc = deflate_finish(state);
+
+	deflate_destroy(state);
+
+	if (rc == EOK)
+		*destcnt = buf.destcnt;
+
+	return rc;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2026 HelenOS Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCOMPRESS_DEFLATE_H_
+#define LIBCOMPRESS_DEFLATE_H_
+
+#include <stddef.h>
+
+/** Lowest compression effort (fastest) */
+#define DEFLATE_EFFORT_MIN      1
+/** Default compression effort */
+#define DEFLATE_EFFORT_DEFAULT  6
+/** Highest compression effort (best compression) */
+#define DEFLATE_EFFORT_MAX      9
+
+/** Output callback for streaming compression */
+typedef errno_t (*deflate_write_t)(void *, const void *, size_t);
+
+struct deflate;
+typedef struct deflate deflate_t;
+
+extern errno_t deflate_create(unsigned int, deflate_write_t, void *,
+    deflate_t **);
+extern errno_t deflate_push(deflate_t *, const void *, size_t);
+extern errno_t deflate_flush(deflate_t *);
+extern errno_t deflate_finish(deflate_t *);
+extern void deflate_destroy(deflate_t *);
+
+extern errno_t deflate(const void *, size_t, void *, size_t, size_t *);
+
+#endif
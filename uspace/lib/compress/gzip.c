@@ -32,6 +32,7 @@
 #include <mem.h>
 #include <byteorder.h>
 #include <stdlib.h>
+#include <crypto.h>
 #include "gzip.h"
 #include "inflate.h"
 
@@ -69,8 +70,6 @@ typedef struct {
  * data to 4 GiB (expanding input streams that actually
  * encode more data will always fail).
  *
- * So far, no CRC is perfomed.
- *
  * @param[in]  src     Source data buffer.
  * @param[in]  srclen  Source buffer size (bytes).
  * @param[out] dest    Destination data buffer.
@@ -79,7 +78,8 @@ typedef struct {
  * @return EOK on success.
  * @return ENOENT on distance too large.
  * @return EINVAL on invalid Huffman code, invalid deflate data,
- *                   invalid compression method or invalid stream.
+ *                   invalid compression method, invalid stream or
+ *                   CRC mismatch.
  * @return ELIMIT on input buffer overrun.
  * @return ENOMEM on output buffer overrun.
  *
@@ -175,9 +175,16 @@ errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
 
 	errno_t ret = inflate(stream, stream_length, *dest, *destlen);
 	if (ret != EOK) {
-		free(dest);
+		free(*dest);
 		return ret;
 	}
 
+	/* Verify the checksum of the uncompressed data */
+
+	if (crc32_ieee(0, *dest, *destlen) != uint32_t_le2host(footer.crc32)) {
+		free(*dest);
+		return EINVAL;
+	}
+
 	return EOK;
 }
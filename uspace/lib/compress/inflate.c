@@ -30,12 +30,13 @@
 /** @file
  * @brief Implementation of inflate decompression
  *
- * A simple inflate implementation (decompression of `deflate' stream as
- * described by RFC 1951) based on puff.c by Mark Adler. This code is
- * currently not optimized for speed but for readability.
+ * An inflate implementation (decompression of `deflate' stream as
+ * described by RFC 1951) based on puff.c by Mark Adler. Huffman codes
+ * are decoded via two-level lookup tables and matches are copied in
+ * chunks, so the decoding speed should be roughly comparable to zlib.
  *
  * All dynamically allocated memory memory is taken from the stack. The
- * stack usage should be typically bounded by 2 KB.
+ * stack usage should be typically bounded by 10 KB.
  *
  * Original copyright notice:
  *
@@ -87,6 +88,46 @@
 /** Number of all codes */
 #define MAX_CODE  (MAX_LITLEN + MAX_DIST)
 
+/** Number of bits resolved by the first-level literal/length table */
+#define LITLEN_TABLE_BITS  9
+/** Number of bits resolved by the first-level distance table */
+#define DIST_TABLE_BITS    6
+/** Number of bits resolved by the code length code table */
+#define ORDER_TABLE_BITS   7
+
+/**
+ * Maximum number of literal/length table entries (first level and
+ * sub-tables), see the ENOUGH bound of zlib
+ */
+#define MAX_LITLEN_ENTRIES  852
+/** Maximum number of distance table entries (first level and sub-tables) */
+#define MAX_DIST_ENTRIES    592
+/** Number of fixed literal/length table entries (all codes are 7 to 9 bits) */
+#define MAX_FIXED_LITLEN_ENTRIES  512
+/** Number of fixed distance table entries (all codes are 5 bits) */
+#define MAX_FIXED_DIST_ENTRIES    32
+
+/** Table entry flag marking a link to a second-level table */
+#define TABLE_SUB  UINT32_C(0x80000000)
+
+/** Table entry for a directly decoded symbol */
+#define TABLE_ENTRY(len, symbol) \
+	((((uint32_t) (len)) << 16) | (symbol))
+
+/** Code length of a directly decoded table entry */
+#define TABLE_ENTRY_LEN(entry)     ((size_t) ((entry) >> 16))
+/** Symbol of a directly decoded table entry */
+#define TABLE_ENTRY_SYMBOL(entry)  ((uint16_t) ((entry) & 0xffff))
+
+/** Table entry linking to a second-level table */
+#define TABLE_SUB_ENTRY(bits, offset) \
+	(TABLE_SUB | (((uint32_t) (bits)) << 24) | (offset))
+
+/** Number of bits resolved by the linked second-level table */
+#define TABLE_SUB_BITS(entry)    ((size_t) (((entry) >> 24) & 0xf))
+/** Offset of the linked second-level table */
+#define TABLE_SUB_OFFSET(entry)  ((size_t) ((entry) & 0xffffff))
+
 /** Check for input buffer overrun condition */
 #define CHECK_OVERRUN(state) \
 	do { \
@@ -106,7 +147,7 @@ typedef struct {
 	size_t srclen;    /**< Input buffer size */
 	size_t srccnt;    /**< Position in the input buffer */
 
-	uint16_t bitbuf;  /**< Bit buffer */
+	uint32_t bitbuf;  /**< Bit buffer */
 	size_t bitlen;    /**< Number of bits in the bit buffer */
 
 	bool overrun;     /**< Overrun condition */
@@ -120,6 +161,17 @@ typedef struct {
 	uint16_t *symbol;  /**< Array of symbols */
 } huffman_t;
 
+/** Huffman decoding table
+ *
+ * First-level table indexed by the low @c bits bits of the bit buffer,
+ * followed by second-level tables for codes longer than @c bits.
+ *
+ */
+typedef struct {
+	uint32_t *entry;  /**< First-level table followed by sub-tables */
+	size_t bits;      /**< Number of bits resolved by the first level */
+} huffman_table_t;
+
 /** Length codes
  *
  */
@@ -226,36 +278,60 @@ static huffman_t dist_code = {
 	.symbol = dist_symbol
 };
 
+/** Fill the bit buffer to at least the given number of bits
+ *
+ * Stop short of the requested number of bits if the input
+ * buffer is exhausted (the caller is expected to check the
+ * resulting bit count).
+ *
+ * @param state Inflate state.
+ * @param cnt   Number of bits to make available (at most 15).
+ *
+ */
+static inline void refill_bits(inflate_state_t *state, size_t cnt)
+{
+	while ((state->bitlen < cnt) && (state->srccnt < state->srclen)) {
+		/* Load 8 more bits */
+		state->bitbuf |=
+		    ((uint32_t) state->src[state->srccnt]) << state->bitlen;
+		state->srccnt++;
+		state->bitlen += 8;
+	}
+}
+
+/** Remove bits from the bit buffer
+ *
+ * @param state Inflate state.
+ * @param cnt   Number of bits to remove (must be available).
+ *
+ */
+static inline void drop_bits(inflate_state_t *state, size_t cnt)
+{
+	state->bitbuf >>= cnt;
+	state->bitlen -= cnt;
+}
+
 /** Get bits from the bit buffer
  *
  * @param state Inflate state.
- * @param cnt   Number of bits to return (at most 16).
+ * @param cnt   Number of bits to return (at most 15).
  *
  * @return Returned bits.
  *
  */
 static inline uint16_t get_bits(inflate_state_t *state, size_t cnt)
 {
-	/* Bit accumulator for at least 20 bits */
-	uint32_t val = state->bitbuf;
+	refill_bits(state, cnt);
 
-	while (state->bitlen < cnt) {
-		if (state->srccnt == state->srclen) {
-			state->overrun = true;
-			return 0;
-		}
-
-		/* Load 8 more bits */
-		val |= ((uint32_t) state->src[state->srccnt]) << state->bitlen;
-		state->srccnt++;
-		state->bitlen += 8;
+	if (state->bitlen < cnt) {
+		state->overrun = true;
+		return 0;
 	}
 
-	/* Update bits in the buffer */
-	state->bitbuf = (uint16_t) (val >> cnt);
-	state->bitlen -= cnt;
+	uint16_t val = (uint16_t) (state->bitbuf & ((1 << cnt) - 1));
+	drop_bits(state, cnt);
 
-	return ((uint16_t) (val & ((1 << cnt) - 1)));
+	return val;
 }
 
 /** Decode `stored' block
@@ -270,7 +346,11 @@ static inline uint16_t get_bits(inflate_state_t *state, size_t cnt)
  */
 static errno_t inflate_stored(inflate_state_t *state)
 {
-	/* Discard bits in the bit buffer */
+	/*
+	 * Discard bits up to the next byte boundary and return
+	 * whole buffered bytes back to the input buffer
+	 */
+	state->srccnt -= state->bitlen >> 3;
 	state->bitbuf = 0;
 	state->bitlen = 0;
 
@@ -304,54 +384,48 @@ static errno_t inflate_stored(inflate_state_t *state)
 	return EOK;
 }
 
-/** Decode a symbol using the Huffman code
+/** Decode a symbol using a Huffman decoding table
+ *
+ * Look up the low bits of the bit buffer in the first-level
+ * table and follow the link to a second-level table for codes
+ * longer than the first level resolves.
  *
- * @param state   Inflate state.
- * @param huffman Huffman code.
- * @param symbol  Decoded symbol.
+ * @param state  Inflate state.
+ * @param table  Huffman decoding table.
+ * @param symbol Decoded symbol.
  *
- * @param EOK on success.
- * @param EINVAL on invalid Huffman code.
+ * @return EOK on success.
+ * @return EINVAL on invalid Huffman code.
+ * @return ELIMIT on input buffer overrun.
  *
  */
-static errno_t huffman_decode(inflate_state_t *state, huffman_t *huffman,
+static errno_t huffman_decode(inflate_state_t *state, huffman_table_t *table,
     uint16_t *symbol)
 {
-	/* Decode bits */
-	uint16_t code = 0;
-
-	/* First code of the given length */
-	size_t first = 0;
-
-	/*
-	 * Index of the first code of the given length
-	 * in the symbol table
-	 */
-	size_t index = 0;
-
-	/* Current number of bits in the code */
-	size_t len;
-
-	for (len = 1; len <= MAX_HUFFMAN_BIT; len++) {
-		/* Get next bit */
-		code |= get_bits(state, 1);
-		CHECK_OVERRUN(*state);
+	refill_bits(state, MAX_HUFFMAN_BIT);
+
+	uint32_t entry =
+	    table->entry[state->bitbuf & ((1 << table->bits) - 1)];
+	if ((entry & TABLE_SUB) != 0) {
+		size_t bits = TABLE_SUB_BITS(entry);
+		entry = table->entry[TABLE_SUB_OFFSET(entry) +
+		    ((state->bitbuf >> table->bits) & ((1 << bits) - 1))];
+	}
 
-		uint16_t count = huffman->count[len];
-		if (code < first + count) {
-			/* Return decoded symbol */
-			*symbol = huffman->symbol[index + code - first];
-			return EOK;
-		}
+	if (entry == 0) {
+		/* No code with this bit pattern */
+		return EINVAL;
+	}
 
-		/* Update for next length */
-		index += count;
-		first += count;
-		first <<= 1;
-		code <<= 1;
+	size_t len = TABLE_ENTRY_LEN(entry);
+	if (len > state->bitlen) {
+		state->overrun = true;
+		return ELIMIT;
 	}
 
-	return EINVAL;
+	drop_bits(state, len);
+	*symbol = TABLE_ENTRY_SYMBOL(entry);
+	return EOK;
 }
 
 /** Construct Huffman tables from canonical Huffman code
@@ -410,13 +484,174 @@ static int16_t huffman_construct(huffman_t *huffman, uint16_t *length, size_t n)
 	return left;
 }
 
+/** Reverse the bit order of a Huffman code
+ *
+ * The canonical code has its first bit in the most significant
+ * position while the bit buffer delivers the first bit in the
+ * least significant position.
+ *
+ * @param code Canonical Huffman code.
+ * @param len  Number of bits in the code.
+ *
+ * @return Bit-reversed code.
+ *
+ */
+static inline uint16_t reverse_bits(uint16_t code, size_t len)
+{
+	uint16_t rev = 0;
+
+	while (len > 0) {
+		rev = (rev << 1) | (code & 1);
+		code >>= 1;
+		len--;
+	}
+
+	return rev;
+}
+
+/** Construct a Huffman decoding table from canonical Huffman tables
+ *
+ * Build a first-level table resolving at most @a root bits per
+ * lookup. Codes longer than @a root bits are resolved via
+ * second-level tables appended after the first level. The
+ * second-level tables are sized to the longest code sharing the
+ * respective first-level prefix, which bounds the total number of
+ * entries by the @a max_entries limits derived in zlib.
+ *
+ * @param table       Constructed decoding table.
+ * @param huffman     Canonical Huffman tables (not over-subscribed).
+ * @param root        Number of bits resolved by the first level.
+ * @param max_entries Size of the entry array of @a table.
+ *
+ * @return EOK on success.
+ * @return EINVAL if the table entries would be exceeded.
+ *
+ */
+static errno_t huffman_table_construct(huffman_table_t *table,
+    huffman_t *huffman, size_t root, size_t max_entries)
+{
+	/* Find the longest code length */
+	size_t max;
+	for (max = MAX_HUFFMAN_BIT; max > 0; max--) {
+		if (huffman->count[max] != 0)
+			break;
+	}
+
+	if (max == 0) {
+		/* No codes at all, any decoding attempt will fail */
+		table->bits = 1;
+		table->entry[0] = 0;
+		table->entry[1] = 0;
+		return EOK;
+	}
+
+	/* Do not resolve more bits than the longest code has */
+	if (root > max)
+		root = max;
+
+	table->bits = root;
+
+	size_t used = (size_t) 1 << root;
+	if (used > max_entries)
+		return EINVAL;
+
+	memset(table->entry, 0, used * sizeof(uint32_t));
+
+	/* Number of codes of each length not yet entered */
+	uint16_t remains[MAX_HUFFMAN_BIT + 1];
+	memcpy(remains, huffman->count,
+	    (MAX_HUFFMAN_BIT + 1) * sizeof(uint16_t));
+
+	/* Canonical code of the current symbol */
+	uint16_t code = 0;
+
+	/* Index of the current symbol in the symbol table */
+	size_t index = 0;
+
+	/* First-level prefix of the current second-level table */
+	size_t low = (size_t) -1;
+
+	/* Offset of the current second-level table */
+	size_t sub_off = 0;
+
+	/* Number of bits resolved by the current second-level table */
+	size_t sub_bits = 0;
+
+	size_t len;
+	for (len = 1; len <= max; len++) {
+		size_t cnt;
+		for (cnt = 0; cnt < huffman->count[len]; cnt++) {
+			uint16_t symbol = huffman->symbol[index];
+			index++;
+
+			uint16_t rev = reverse_bits(code, len);
+			code++;
+
+			if (len <= root) {
+				/*
+				 * Replicate the entry for every buffer
+				 * content that starts with this code.
+				 */
+				size_t idx;
+				for (idx = rev; idx < ((size_t) 1 << root);
+				    idx += ((size_t) 1 << len))
+					table->entry[idx] = TABLE_ENTRY(len, symbol);
+
+				remains[len]--;
+				continue;
+			}
+
+			size_t prefix = rev & (((size_t) 1 << root) - 1);
+			if (prefix != low) {
+				/*
+				 * Start a new second-level table, sized
+				 * to the longest remaining code that can
+				 * share this prefix
+				 */
+				sub_bits = len - root;
+				int16_t left = (int16_t) (1 << sub_bits);
+				while (sub_bits + root < max) {
+					left -= remains[sub_bits + root];
+					if (left <= 0)
+						break;
+					sub_bits++;
+					left <<= 1;
+				}
+
+				sub_off = used;
+				used += (size_t) 1 << sub_bits;
+				if (used > max_entries)
+					return EINVAL;
+
+				memset(&table->entry[sub_off], 0,
+				    ((size_t) 1 << sub_bits) * sizeof(uint32_t));
+
+				table->entry[prefix] =
+				    TABLE_SUB_ENTRY(sub_bits, sub_off);
+				low = prefix;
+			}
+
+			size_t idx;
+			for (idx = rev >> root; idx < ((size_t) 1 << sub_bits);
+			    idx += ((size_t) 1 << (len - root)))
+				table->entry[sub_off + idx] = TABLE_ENTRY(len, symbol);
+
+			remains[len]--;
+		}
+
+		code <<= 1;
+	}
+
+	return EOK;
+}
+
 /** Decode literal/length and distance codes
  *
  * Decode until end-of-block code.
  *
- * @param state     Inflate state.
- * @param len_code  Huffman code for literal/length.
- * @param dist_code Huffman code for distance.
+ * @param state      Inflate state.
+ * @param len_table  Decoding table for literal/length.
+ * @param dist_table Decoding table for distance.
  *
  * @return EOK on success.
  * @return ENOENT on distance too large.
@@ -425,13 +660,13 @@ static int16_t huffman_construct(huffman_t *huffman, uint16_t *length, size_t n)
  * @return ENOMEM on output buffer overrun.
  *
  */
-static errno_t inflate_codes(inflate_state_t *state, huffman_t *len_code,
-    huffman_t *dist_code)
+static errno_t inflate_codes(inflate_state_t *state, huffman_table_t *len_table,
+    huffman_table_t *dist_table)
 {
 	uint16_t symbol;
 
 	do {
-		errno_t err = huffman_decode(state, len_code, &symbol);
+		errno_t err = huffman_decode(state, len_table, &symbol);
 		if (err != EOK) {
 			/* Error decoding */
 			return err;
@@ -454,7 +689,7 @@ static errno_t inflate_codes(inflate_state_t *state, huffman_t *len_code,
 			CHECK_OVERRUN(*state);
 
 			/* Get distance */
-			err = huffman_decode(state, dist_code, &symbol);
+			err = huffman_decode(state, dist_table, &symbol);
 			if (err != EOK)
 				return err;
 
@@ -465,12 +700,30 @@ static errno_t inflate_codes(inflate_state_t *state, huffman_t *len_code,
 			if (state->destcnt + len > state->destlen)
 				return ENOMEM;
 
-			while (len > 0) {
-				/* Copy len bytes from distance bytes back */
-				state->dest[state->destcnt] =
-				    state->dest[state->destcnt - dist];
-				state->destcnt++;
-				len--;
+			/* Copy len bytes from dist bytes back */
+			uint8_t *dst = state->dest + state->destcnt;
+			state->destcnt += len;
+
+			if (dist == 1) {
+				/* Run of a single byte */
+				memset(dst, dst[-1], len);
+			} else if (dist >= len) {
+				/* Non-overlapping match */
+				memcpy(dst, dst - dist, len);
+			} else {
+				/*
+				 * Overlapping match, copy in chunks of
+				 * dist bytes (the source of each chunk
+				 * has been written out completely)
+				 */
+				while (len >= dist) {
+					memcpy(dst, dst - dist, dist);
+					dst += dist;
+					len -= dist;
+				}
+
+				if (len > 0)
+					memcpy(dst, dst - dist, len);
 			}
 		}
 	} while (symbol != 256);
@@ -480,9 +733,9 @@ static errno_t inflate_codes(inflate_state_t *state, huffman_t *len_code,
 
 /** Decode `fixed codes' block
  *
- * @param state     Inflate state.
- * @param len_code  Huffman code for literal/length.
- * @param dist_code Huffman code for distance.
+ * @param state      Inflate state.
+ * @param len_table  Decoding table for literal/length.
+ * @param dist_table Decoding table for distance.
  *
  * @return EOK on success.
  * @return ENOENT on distance too large.
@@ -491,10 +744,10 @@ static errno_t inflate_codes(inflate_state_t *state, huffman_t *len_code,
  * @return ENOMEM on output buffer overrun.
  *
  */
-static errno_t inflate_fixed(inflate_state_t *state, huffman_t *len_code,
-    huffman_t *dist_code)
+static errno_t inflate_fixed(inflate_state_t *state, huffman_table_t *len_table,
+    huffman_table_t *dist_table)
 {
-	return inflate_codes(state, len_code, dist_code);
+	return inflate_codes(state, len_table, dist_table);
 }
 
 /** Decode `dynamic codes' block
@@ -515,8 +768,12 @@ static errno_t inflate_dynamic(inflate_state_t *state)
 	uint16_t dyn_len_symbol[MAX_LITLEN];
 	uint16_t dyn_dist_count[MAX_HUFFMAN_BIT + 1];
 	uint16_t dyn_dist_symbol[MAX_DIST];
+	uint32_t dyn_len_entry[MAX_LITLEN_ENTRIES];
+	uint32_t dyn_dist_entry[MAX_DIST_ENTRIES];
 	huffman_t dyn_len_code;
 	huffman_t dyn_dist_code;
+	huffman_table_t dyn_len_table;
+	huffman_table_t dyn_dist_table;
 
 	dyn_len_code.count = dyn_len_count;
 	dyn_len_code.symbol = dyn_len_symbol;
@@ -524,6 +781,9 @@ static errno_t inflate_dynamic(inflate_state_t *state)
 	dyn_dist_code.count = dyn_dist_count;
 	dyn_dist_code.symbol = dyn_dist_symbol;
 
+	dyn_len_table.entry = dyn_len_entry;
+	dyn_dist_table.entry = dyn_dist_entry;
+
 	/* Get number of bits in each table */
 	uint16_t nlen = get_bits(state, 5) + 257;
 	CHECK_OVERRUN(*state);
@@ -554,11 +814,17 @@ static errno_t inflate_dynamic(inflate_state_t *state)
 	if (rc != 0)
 		return EINVAL;
 
+	/* Build decoding table (the literal/length table is reused) */
+	errno_t ret = huffman_table_construct(&dyn_len_table, &dyn_len_code,
+	    ORDER_TABLE_BITS, MAX_LITLEN_ENTRIES);
+	if (ret != EOK)
+		return ret;
+
 	/* Read length/literal and distance code length tables */
 	index = 0;
 	while (index < nlen + ndist) {
 		uint16_t symbol;
-		errno_t err = huffman_decode(state, &dyn_len_code, &symbol);
+		errno_t err = huffman_decode(state, &dyn_len_table, &symbol);
 		if (err != EOK)
 			return EOK;
 
@@ -603,12 +869,22 @@ static errno_t inflate_dynamic(inflate_state_t *state)
 	if ((rc < 0) || ((rc > 0) && (dyn_len_code.count[0] + 1 != nlen)))
 		return EINVAL;
 
+	ret = huffman_table_construct(&dyn_len_table, &dyn_len_code,
+	    LITLEN_TABLE_BITS, MAX_LITLEN_ENTRIES);
+	if (ret != EOK)
+		return ret;
+
 	/* Build Huffman tables for distance codes */
 	rc = huffman_construct(&dyn_dist_code, length + nlen, ndist);
 	if ((rc < 0) || ((rc > 0) && (dyn_dist_code.count[0] + 1 != ndist)))
 		return EINVAL;
 
-	return inflate_codes(state, &dyn_len_code, &dyn_dist_code);
+	ret = huffman_table_construct(&dyn_dist_table, &dyn_dist_code,
+	    DIST_TABLE_BITS, MAX_DIST_ENTRIES);
+	if (ret != EOK)
+		return ret;
+
+	return inflate_codes(state, &dyn_len_table, &dyn_dist_table);
 }
 
 /** Inflate data
@@ -643,6 +919,13 @@ errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
 
 	state.overrun = false;
 
+	/* Decoding tables for fixed codes (built on first use) */
+	uint32_t fixed_len_entry[MAX_FIXED_LITLEN_ENTRIES];
+	uint32_t fixed_dist_entry[MAX_FIXED_DIST_ENTRIES];
+	huffman_table_t fixed_len_table;
+	huffman_table_t fixed_dist_table;
+	bool fixed_tables = false;
+
 	uint16_t last;
 	errno_t ret = EOK;
 
@@ -660,7 +943,27 @@ errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
 			ret = inflate_stored(&state);
 			break;
 		case 1:
-			ret = inflate_fixed(&state, &len_code, &dist_code);
+			if (!fixed_tables) {
+				fixed_len_table.entry = fixed_len_entry;
+				fixed_dist_table.entry = fixed_dist_entry;
+
+				ret = huffman_table_construct(&fixed_len_table,
+				    &len_code, LITLEN_TABLE_BITS,
+				    MAX_FIXED_LITLEN_ENTRIES);
+				if (ret != EOK)
+					break;
+
+				ret = huffman_table_construct(&fixed_dist_table,
+				    &dist_code, DIST_TABLE_BITS,
+				    MAX_FIXED_DIST_ENTRIES);
+				if (ret != EOK)
+					break;
+
+				fixed_tables = true;
+			}
+
+			ret = inflate_fixed(&state, &fixed_len_table,
+			    &fixed_dist_table);
 			break;
 		case 2:
 			ret = inflate_dynamic(&state);
@@ -42,6 +42,19 @@ namespace std
 
     namespace aux
     {
+        /**
+         * Elements per deque bucket. The default targets roughly half
+         * a kilobyte per bucket so that queue-heavy code touches few
+         * buckets; users may specialize this for a specific element
+         * type when a different trade-off is needed.
+         */
+        template<class T>
+        struct deque_bucket_size
+        {
+            static constexpr size_t value =
+                sizeof(T) <= 128 ? 512 / sizeof(T) : 4;
+        };
+
         /**
          * Note: We decided that these iterators contain a
          *       reference to the container and an index, which
@@ -833,7 +846,10 @@ namespace std
                 if (back_bucket_idx_ == 0)
                 { // Means we gotta pop data_[back_bucket_ - 1][bucket_size_ - 1]!
                     if (data_[back_bucket_])
-                        allocator_.deallocate(data_[back_bucket_], bucket_size_);
+                    {
+                        retire_bucket_(data_[back_bucket_]);
+                        --bucket_count_;
+                    }
 
                     --back_bucket_;
                     back_bucket_idx_ = bucket_size_ - 1;
@@ -853,7 +869,10 @@ namespace std
                 if (front_bucket_idx_ >= bucket_size_)
                 { // Means we gotta pop data_[front_bucket_ + 1][0]!
                     if (data_[front_bucket_])
-                        allocator_.deallocate(data_[front_bucket_], bucket_size_);
+                    {
+                        retire_bucket_(data_[front_bucket_]);
+                        --bucket_count_;
+                    }
 
                     ++front_bucket_;
                     front_bucket_idx_ = 1;
@@ -923,6 +942,7 @@ namespace std
                 std::swap(bucket_capacity_, other.bucket_capacity_);
                 std::swap(size_, other.size_);
                 std::swap(data_, other.data_);
+                std::swap(spare_bucket_, other.spare_bucket_);
             }
 
             void clear() noexcept
@@ -954,7 +974,7 @@ namespace std
             size_type front_bucket_;
             size_type back_bucket_;
 
-            static constexpr size_type bucket_size_{16};
+            static constexpr size_type bucket_size_{aux::deque_bucket_size<value_type>::value};
             static constexpr size_type default_bucket_count_{2};
             static constexpr size_type default_bucket_capacity_{4};
             static constexpr size_type default_front_{1};
@@ -966,12 +986,41 @@ namespace std
 
             value_type** data_;
 
+            /**
+             * One retired bucket is kept around instead of being
+             * returned to the allocator, so a queue oscillating
+             * around a bucket boundary does not allocate and free
+             * a bucket on every push/pop pair.
+             */
+            value_type* spare_bucket_{};
+
+            value_type* allocate_bucket_()
+            {
+                if (spare_bucket_)
+                {
+                    auto res = spare_bucket_;
+                    spare_bucket_ = nullptr;
+
+                    return res;
+                }
+
+                return allocator_.allocate(bucket_size_);
+            }
+
+            void retire_bucket_(value_type* bucket)
+            {
+                if (!spare_bucket_)
+                    spare_bucket_ = bucket;
+                else
+                    allocator_.deallocate(bucket, bucket_size_);
+            }
+
             void init_()
             {
                 data_ = new value_type*[bucket_capacity_];
 
                 for (size_type i = front_bucket_; i <= back_bucket_; ++i)
-                    data_[i] = allocator_.allocate(bucket_size_);
+                    data_[i] = allocate_bucket_();
             }
 
             void prepare_for_size_(size_type size)
@@ -1066,6 +1115,12 @@ namespace std
                 for (size_type i = front_bucket_; i <= back_bucket_; ++i)
                     allocator_.deallocate(data_[i], bucket_size_);
 
+                if (spare_bucket_)
+                {
+                    allocator_.deallocate(spare_bucket_, bucket_size_);
+                    spare_bucket_ = nullptr;
+                }
+
                 delete[] data_;
                 data_ = nullptr;
             }
@@ -1087,7 +1142,7 @@ namespace std
 
                 ++back_bucket_;
                 ++bucket_count_;
-                data_[back_bucket_] = allocator_.allocate(bucket_size_);
+                data_[back_bucket_] = allocate_bucket_();
                 back_bucket_idx_ = size_type{};
             }
 
@@ -1098,20 +1153,42 @@ namespace std
 
                 --front_bucket_;
                 ++bucket_count_;
-                data_[front_bucket_] = allocator_.allocate(bucket_size_);
+                data_[front_bucket_] = allocate_bucket_();
                 front_bucket_idx_ = bucket_size_;
             }
 
             void expand_()
             {
+                /**
+                 * A drifting queue leaves dead slots behind the front
+                 * (or back) of the map. If at least half of the map is
+                 * dead space, recenter the live buckets in place rather
+                 * than growing the map - otherwise a steady-state FIFO
+                 * would double the map forever.
+                 */
+                if (bucket_count_ <= bucket_capacity_ / 2)
+                {
+                    size_type new_front = (bucket_capacity_ - bucket_count_) / 2;
+                    if (new_front < front_bucket_)
+                    {
+                        for (size_type i = 0; i < bucket_count_; ++i)
+                            data_[new_front + i] = data_[front_bucket_ + i];
+                    }
+                    else if (new_front > front_bucket_)
+                    {
+                        for (size_type i = bucket_count_; i > 0; --i)
+                            data_[new_front + i - 1] = data_[front_bucket_ + i - 1];
+                    }
+
+                    front_bucket_ = new_front;
+                    back_bucket_ = new_front + bucket_count_ - 1;
+
+                    return;
+                }
+
                 bucket_capacity_ *= 2;
                 value_type** new_data = new value_type*[bucket_capacity_];
 
-                /**
-                 * Note: This currently expands both sides whenever one reaches
-                 *       its limit. Might be better to expand only one (or both when
-                 *       the other is near its limit)?
-                 */
                 size_type new_front = bucket_capacity_ / 4;
                 size_type new_back = new_front + bucket_count_ - 1;
 
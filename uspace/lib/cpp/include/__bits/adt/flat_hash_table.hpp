@@ -0,0 +1,622 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_ADT_FLAT_HASH_TABLE
+#define LIBCPP_BITS_ADT_FLAT_HASH_TABLE
+
+#include <__bits/adt/key_extractors.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace std::aux
+{
+    /**
+     * Open-addressing backing store shared by flat_unordered_map and
+     * flat_unordered_set. Elements live in one contiguous array with a
+     * parallel byte array of slot states, so probing touches consecutive
+     * cache lines instead of chasing per-node pointers. Deletion leaves
+     * a tombstone that gets cleaned up by the next rehash.
+     *
+     * Unlike the standard unordered containers there is no per-element
+     * allocation, which also means no reference or iterator stability
+     * across inserts.
+     */
+
+    enum class flat_hash_state : uint8_t
+    {
+        empty = 0,
+        full,
+        deleted
+    };
+
+    template<class Value, class Reference, class Pointer, class Size>
+    class flat_hash_table_iterator
+    {
+        public:
+            using value_type      = Value;
+            using size_type       = Size;
+            using reference       = Reference;
+            using pointer         = Pointer;
+            using difference_type = ptrdiff_t;
+
+            using iterator_category = forward_iterator_tag;
+
+            flat_hash_table_iterator(value_type* storage = nullptr,
+                                     const flat_hash_state* state = nullptr,
+                                     size_type idx = size_type{},
+                                     size_type capacity = size_type{})
+                : storage_{storage}, state_{state}, idx_{idx},
+                  capacity_{capacity}
+            { /* DUMMY BODY */ }
+
+            flat_hash_table_iterator(const flat_hash_table_iterator&) = default;
+            flat_hash_table_iterator& operator=(const flat_hash_table_iterator&) = default;
+
+            reference operator*()
+            {
+                return storage_[idx_];
+            }
+
+            pointer operator->()
+            {
+                return &storage_[idx_];
+            }
+
+            flat_hash_table_iterator& operator++()
+            {
+                ++idx_;
+                while (idx_ < capacity_ && state_[idx_] != flat_hash_state::full)
+                    ++idx_;
+
+                return *this;
+            }
+
+            flat_hash_table_iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++(*this);
+
+                return tmp;
+            }
+
+            size_type idx() const
+            {
+                return idx_;
+            }
+
+        private:
+            value_type* storage_;
+            const flat_hash_state* state_;
+            size_type idx_;
+            size_type capacity_;
+
+            template<class V, class CR, class CP, class S>
+            friend class flat_hash_table_const_iterator;
+    };
+
+    template<class Value, class Ref, class Ptr, class Size>
+    bool operator==(const flat_hash_table_iterator<Value, Ref, Ptr, Size>& lhs,
+                    const flat_hash_table_iterator<Value, Ref, Ptr, Size>& rhs)
+    {
+        return lhs.idx() == rhs.idx();
+    }
+
+    template<class Value, class Ref, class Ptr, class Size>
+    bool operator!=(const flat_hash_table_iterator<Value, Ref, Ptr, Size>& lhs,
+                    const flat_hash_table_iterator<Value, Ref, Ptr, Size>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template<class Value, class ConstReference, class ConstPointer, class Size>
+    class flat_hash_table_const_iterator
+    {
+        public:
+            using value_type      = Value;
+            using size_type       = Size;
+            using const_reference = ConstReference;
+            using const_pointer   = ConstPointer;
+            using difference_type = ptrdiff_t;
+
+            using iterator_category = forward_iterator_tag;
+
+            /* For iterator_traits. */
+            using reference = ConstReference;
+            using pointer   = ConstPointer;
+
+            flat_hash_table_const_iterator(const value_type* storage = nullptr,
+                                           const flat_hash_state* state = nullptr,
+                                           size_type idx = size_type{},
+                                           size_type capacity = size_type{})
+                : storage_{storage}, state_{state}, idx_{idx},
+                  capacity_{capacity}
+            { /* DUMMY BODY */ }
+
+            flat_hash_table_const_iterator(const flat_hash_table_const_iterator&) = default;
+            flat_hash_table_const_iterator& operator=(const flat_hash_table_const_iterator&) = default;
+
+            template<class R, class P>
+            flat_hash_table_const_iterator(
+                const flat_hash_table_iterator<Value, R, P, Size>& other)
+                : storage_{other.storage_}, state_{other.state_},
+                  idx_{other.idx_}, capacity_{other.capacity_}
+            { /* DUMMY BODY */ }
+
+            const_reference operator*() const
+            {
+                return storage_[idx_];
+            }
+
+            const_pointer operator->() const
+            {
+                return &storage_[idx_];
+            }
+
+            flat_hash_table_const_iterator& operator++()
+            {
+                ++idx_;
+                while (idx_ < capacity_ && state_[idx_] != flat_hash_state::full)
+                    ++idx_;
+
+                return *this;
+            }
+
+            flat_hash_table_const_iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++(*this);
+
+                return tmp;
+            }
+
+            size_type idx() const
+            {
+                return idx_;
+            }
+
+        private:
+            const value_type* storage_;
+            const flat_hash_state* state_;
+            size_type idx_;
+            size_type capacity_;
+    };
+
+    template<class Value, class CRef, class CPtr, class Size>
+    bool operator==(const flat_hash_table_const_iterator<Value, CRef, CPtr, Size>& lhs,
+                    const flat_hash_table_const_iterator<Value, CRef, CPtr, Size>& rhs)
+    {
+        return lhs.idx() == rhs.idx();
+    }
+
+    template<class Value, class CRef, class CPtr, class Size>
+    bool operator!=(const flat_hash_table_const_iterator<Value, CRef, CPtr, Size>& lhs,
+                    const flat_hash_table_const_iterator<Value, CRef, CPtr, Size>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template<
+        class Value, class Key, class KeyExtractor,
+        class Hasher, class KeyEq
+    >
+    class flat_hash_table
+    {
+        public:
+            using value_type  = Value;
+            using key_type    = Key;
+            using size_type   = size_t;
+            using hasher      = Hasher;
+            using key_equal   = KeyEq;
+            using key_extract = KeyExtractor;
+
+            using iterator = flat_hash_table_iterator<
+                value_type, value_type&, value_type*, size_type
+            >;
+            using const_iterator = flat_hash_table_const_iterator<
+                value_type, const value_type&, const value_type*, size_type
+            >;
+
+            static constexpr size_type min_capacity{8};
+
+            explicit flat_hash_table(size_type capacity,
+                                     const hasher& hf = hasher{},
+                                     const key_equal& eql = key_equal{})
+                : storage_{}, state_{}, capacity_{pow2_(capacity)},
+                  size_{}, deleted_{}, hasher_{hf}, key_eq_{eql},
+                  key_extractor_{}
+            {
+                storage_ = allocate_storage_(capacity_);
+                state_ = new flat_hash_state[capacity_]();
+            }
+
+            flat_hash_table(const flat_hash_table& other)
+                : storage_{}, state_{}, capacity_{other.capacity_},
+                  size_{other.size_}, deleted_{}, hasher_{other.hasher_},
+                  key_eq_{other.key_eq_}, key_extractor_{other.key_extractor_}
+            {
+                storage_ = allocate_storage_(capacity_);
+                state_ = new flat_hash_state[capacity_]();
+
+                for (size_type i = 0; i < capacity_; ++i)
+                {
+                    if (other.state_[i] == flat_hash_state::full)
+                    {
+                        new (&storage_[i]) value_type{other.storage_[i]};
+                        state_[i] = flat_hash_state::full;
+                    }
+                }
+            }
+
+            flat_hash_table(flat_hash_table&& other)
+                : storage_{other.storage_}, state_{other.state_},
+                  capacity_{other.capacity_}, size_{other.size_},
+                  deleted_{other.deleted_}, hasher_{move(other.hasher_)},
+                  key_eq_{move(other.key_eq_)},
+                  key_extractor_{move(other.key_extractor_)}
+            {
+                /* Leave other in a valid empty state. */
+                other.capacity_ = min_capacity;
+                other.storage_ = allocate_storage_(other.capacity_);
+                other.state_ = new flat_hash_state[other.capacity_]();
+                other.size_ = 0;
+                other.deleted_ = 0;
+            }
+
+            flat_hash_table& operator=(const flat_hash_table& other)
+            {
+                if (this != &other)
+                {
+                    flat_hash_table tmp{other};
+                    swap(tmp);
+                }
+
+                return *this;
+            }
+
+            flat_hash_table& operator=(flat_hash_table&& other)
+            {
+                if (this != &other)
+                    swap(other);
+
+                return *this;
+            }
+
+            ~flat_hash_table()
+            {
+                destroy_all_();
+                ::operator delete(storage_);
+                delete[] state_;
+            }
+
+            bool empty() const noexcept
+            {
+                return size_ == 0;
+            }
+
+            size_type size() const noexcept
+            {
+                return size_;
+            }
+
+            size_type capacity() const noexcept
+            {
+                return capacity_;
+            }
+
+            iterator begin() noexcept
+            {
+                return iterator{
+                    storage_, state_, first_full_(), capacity_
+                };
+            }
+
+            const_iterator begin() const noexcept
+            {
+                return const_iterator{
+                    storage_, state_, first_full_(), capacity_
+                };
+            }
+
+            iterator end() noexcept
+            {
+                return iterator{storage_, state_, capacity_, capacity_};
+            }
+
+            const_iterator end() const noexcept
+            {
+                return const_iterator{storage_, state_, capacity_, capacity_};
+            }
+
+            void clear()
+            {
+                destroy_all_();
+
+                for (size_type i = 0; i < capacity_; ++i)
+                    state_[i] = flat_hash_state::empty;
+
+                size_ = 0;
+                deleted_ = 0;
+            }
+
+            iterator find(const key_type& key)
+            {
+                auto idx = find_index_(key);
+                if (idx == capacity_)
+                    return end();
+
+                return iterator{storage_, state_, idx, capacity_};
+            }
+
+            const_iterator find(const key_type& key) const
+            {
+                auto idx = find_index_(key);
+                if (idx == capacity_)
+                    return end();
+
+                return const_iterator{storage_, state_, idx, capacity_};
+            }
+
+            size_type count(const key_type& key) const
+            {
+                return find_index_(key) == capacity_ ? 0 : 1;
+            }
+
+            template<class V>
+            pair<iterator, bool> insert(V&& val)
+            {
+                const auto& key = key_extractor_(val);
+
+                auto idx = find_index_(key);
+                if (idx != capacity_)
+                {
+                    return pair<iterator, bool>{
+                        iterator{storage_, state_, idx, capacity_}, false
+                    };
+                }
+
+                ensure_space_();
+                idx = insert_slot_(hasher_(key));
+
+                new (&storage_[idx]) value_type{forward<V>(val)};
+                state_[idx] = flat_hash_state::full;
+                ++size_;
+
+                return pair<iterator, bool>{
+                    iterator{storage_, state_, idx, capacity_}, true
+                };
+            }
+
+            size_type erase(const key_type& key)
+            {
+                auto idx = find_index_(key);
+                if (idx == capacity_)
+                    return 0;
+
+                erase_slot_(idx);
+
+                return 1;
+            }
+
+            iterator erase(const_iterator it)
+            {
+                auto idx = it.idx();
+                erase_slot_(idx);
+
+                auto res = iterator{storage_, state_, idx, capacity_};
+                if (state_[idx] != flat_hash_state::full)
+                    ++res;
+
+                return res;
+            }
+
+            void reserve(size_type count)
+            {
+                if (count * 4 > capacity_ * 3)
+                    rehash_(pow2_(count * 4 / 3 + 1));
+            }
+
+            void rehash(size_type count)
+            {
+                auto capacity = pow2_(count);
+                while (size_ * 4 > capacity * 3)
+                    capacity *= 2;
+
+                rehash_(capacity);
+            }
+
+            float load_factor() const noexcept
+            {
+                return size_ / static_cast<float>(capacity_);
+            }
+
+            void swap(flat_hash_table& other)
+            {
+                std::swap(storage_, other.storage_);
+                std::swap(state_, other.state_);
+                std::swap(capacity_, other.capacity_);
+                std::swap(size_, other.size_);
+                std::swap(deleted_, other.deleted_);
+                std::swap(hasher_, other.hasher_);
+                std::swap(key_eq_, other.key_eq_);
+            }
+
+            hasher hash_function() const
+            {
+                return hasher_;
+            }
+
+            key_equal key_eq() const
+            {
+                return key_eq_;
+            }
+
+        private:
+            value_type* storage_;
+            flat_hash_state* state_;
+            size_type capacity_;
+            size_type size_;
+            size_type deleted_;
+            hasher hasher_;
+            key_equal key_eq_;
+            key_extract key_extractor_;
+
+            static value_type* allocate_storage_(size_type capacity)
+            {
+                return static_cast<value_type*>(
+                    ::operator new(capacity * sizeof(value_type))
+                );
+            }
+
+            static size_type pow2_(size_type capacity)
+            {
+                size_type res{min_capacity};
+                while (res < capacity)
+                    res *= 2;
+
+                return res;
+            }
+
+            size_type first_full_() const
+            {
+                size_type idx{};
+                while (idx < capacity_ && state_[idx] != flat_hash_state::full)
+                    ++idx;
+
+                return idx;
+            }
+
+            /**
+             * Returns the index of the element with the given key,
+             * or capacity_ if there is no such element.
+             */
+            size_type find_index_(const key_type& key) const
+            {
+                auto idx = hasher_(key) & (capacity_ - 1);
+
+                for (size_type probes = 0; probes < capacity_; ++probes)
+                {
+                    if (state_[idx] == flat_hash_state::empty)
+                        return capacity_;
+
+                    if (state_[idx] == flat_hash_state::full &&
+                        key_eq_(key_extractor_(storage_[idx]), key))
+                        return idx;
+
+                    idx = (idx + 1) & (capacity_ - 1);
+                }
+
+                return capacity_;
+            }
+
+            /**
+             * Returns the first reusable slot of the probe
+             * sequence of the given hash. The key must not be
+             * present in the table.
+             */
+            size_type insert_slot_(size_type hash)
+            {
+                auto idx = hash & (capacity_ - 1);
+
+                while (state_[idx] == flat_hash_state::full)
+                    idx = (idx + 1) & (capacity_ - 1);
+
+                if (state_[idx] == flat_hash_state::deleted)
+                    --deleted_;
+
+                return idx;
+            }
+
+            void erase_slot_(size_type idx)
+            {
+                storage_[idx].~value_type();
+                state_[idx] = flat_hash_state::deleted;
+                --size_;
+                ++deleted_;
+            }
+
+            void ensure_space_()
+            {
+                if ((size_ + deleted_ + 1) * 4 <= capacity_ * 3)
+                    return;
+
+                /*
+                 * If the table is mostly tombstones, rehashing to the
+                 * same capacity reclaims them without growing.
+                 */
+                if (size_ * 2 < capacity_)
+                    rehash_(capacity_);
+                else
+                    rehash_(capacity_ * 2);
+            }
+
+            void rehash_(size_type new_capacity)
+            {
+                auto new_storage = allocate_storage_(new_capacity);
+                auto new_state = new flat_hash_state[new_capacity]();
+
+                for (size_type i = 0; i < capacity_; ++i)
+                {
+                    if (state_[i] != flat_hash_state::full)
+                        continue;
+
+                    auto idx = hasher_(key_extractor_(storage_[i])) &
+                        (new_capacity - 1);
+                    while (new_state[idx] != flat_hash_state::empty)
+                        idx = (idx + 1) & (new_capacity - 1);
+
+                    new (&new_storage[idx]) value_type{move(storage_[i])};
+                    new_state[idx] = flat_hash_state::full;
+
+                    storage_[i].~value_type();
+                }
+
+                ::operator delete(storage_);
+                delete[] state_;
+
+                storage_ = new_storage;
+                state_ = new_state;
+                capacity_ = new_capacity;
+                deleted_ = 0;
+            }
+
+            void destroy_all_()
+            {
+                for (size_type i = 0; i < capacity_; ++i)
+                {
+                    if (state_[i] == flat_hash_state::full)
+                        storage_[i].~value_type();
+                }
+            }
+    };
+}
+
+#endif
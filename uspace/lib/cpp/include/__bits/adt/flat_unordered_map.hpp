@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_ADT_FLAT_UNORDERED_MAP
+#define LIBCPP_BITS_ADT_FLAT_UNORDERED_MAP
+
+#include <__bits/adt/flat_hash_table.hpp>
+#include <initializer_list>
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace std
+{
+    /**
+     * Open-addressing counterpart of unordered_map (non-standard
+     * extension). Elements are stored in one flat array, so lookup-heavy
+     * code gets cache-line locality and inserts do not allocate per
+     * element. The price is that references and iterators are
+     * invalidated by any insert; the multi variant and the bucket
+     * interface are not provided.
+     */
+
+    template<
+        class Key, class Value,
+        class Hash = hash<Key>,
+        class Pred = equal_to<Key>
+    >
+    class flat_unordered_map
+    {
+        public:
+            using key_type        = Key;
+            using mapped_type     = Value;
+            using value_type      = pair<const key_type, mapped_type>;
+            using hasher          = Hash;
+            using key_equal       = Pred;
+            using pointer         = value_type*;
+            using const_pointer   = const value_type*;
+            using reference       = value_type&;
+            using const_reference = const value_type&;
+            using size_type       = size_t;
+            using difference_type = ptrdiff_t;
+
+            using table_type = aux::flat_hash_table<
+                value_type, key_type,
+                aux::key_value_key_extractor<key_type, mapped_type>,
+                hasher, key_equal
+            >;
+
+            using iterator       = typename table_type::iterator;
+            using const_iterator = typename table_type::const_iterator;
+
+            flat_unordered_map()
+                : flat_unordered_map{default_capacity_}
+            { /* DUMMY BODY */ }
+
+            explicit flat_unordered_map(size_type capacity,
+                                        const hasher& hf = hasher{},
+                                        const key_equal& eql = key_equal{})
+                : table_{capacity, hf, eql}
+            { /* DUMMY BODY */ }
+
+            template<class InputIterator>
+            flat_unordered_map(InputIterator first, InputIterator last,
+                               size_type capacity = default_capacity_,
+                               const hasher& hf = hasher{},
+                               const key_equal& eql = key_equal{})
+                : flat_unordered_map{capacity, hf, eql}
+            {
+                insert(first, last);
+            }
+
+            flat_unordered_map(initializer_list<value_type> init,
+                               size_type capacity = default_capacity_,
+                               const hasher& hf = hasher{},
+                               const key_equal& eql = key_equal{})
+                : flat_unordered_map{capacity, hf, eql}
+            {
+                insert(init.begin(), init.end());
+            }
+
+            flat_unordered_map(const flat_unordered_map&) = default;
+            flat_unordered_map(flat_unordered_map&&) = default;
+            flat_unordered_map& operator=(const flat_unordered_map&) = default;
+            flat_unordered_map& operator=(flat_unordered_map&&) = default;
+
+            flat_unordered_map& operator=(initializer_list<value_type> init)
+            {
+                table_.clear();
+                table_.reserve(init.size());
+                insert(init.begin(), init.end());
+
+                return *this;
+            }
+
+            bool empty() const noexcept
+            {
+                return table_.empty();
+            }
+
+            size_type size() const noexcept
+            {
+                return table_.size();
+            }
+
+            iterator begin() noexcept
+            {
+                return table_.begin();
+            }
+
+            const_iterator begin() const noexcept
+            {
+                return table_.begin();
+            }
+
+            iterator end() noexcept
+            {
+                return table_.end();
+            }
+
+            const_iterator end() const noexcept
+            {
+                return table_.end();
+            }
+
+            const_iterator cbegin() const noexcept
+            {
+                return table_.begin();
+            }
+
+            const_iterator cend() const noexcept
+            {
+                return table_.end();
+            }
+
+            template<class... Args>
+            pair<iterator, bool> emplace(Args&&... args)
+            {
+                return table_.insert(value_type{forward<Args>(args)...});
+            }
+
+            pair<iterator, bool> insert(const value_type& val)
+            {
+                return table_.insert(val);
+            }
+
+            pair<iterator, bool> insert(value_type&& val)
+            {
+                return table_.insert(move(val));
+            }
+
+            template<class T>
+            pair<iterator, bool> insert(T&& val)
+            {
+                return table_.insert(value_type{forward<T>(val)});
+            }
+
+            template<class InputIterator>
+            void insert(InputIterator first, InputIterator last)
+            {
+                while (first != last)
+                    insert(*first++);
+            }
+
+            void insert(initializer_list<value_type> init)
+            {
+                insert(init.begin(), init.end());
+            }
+
+            size_type erase(const key_type& key)
+            {
+                return table_.erase(key);
+            }
+
+            iterator erase(const_iterator position)
+            {
+                return table_.erase(position);
+            }
+
+            void clear() noexcept
+            {
+                table_.clear();
+            }
+
+            void swap(flat_unordered_map& other)
+            {
+                table_.swap(other.table_);
+            }
+
+            mapped_type& operator[](const key_type& key)
+            {
+                auto it = table_.find(key);
+                if (it != table_.end())
+                    return it->second;
+
+                auto res = table_.insert(value_type{key, mapped_type{}});
+
+                return res.first->second;
+            }
+
+            mapped_type& operator[](key_type&& key)
+            {
+                auto it = table_.find(key);
+                if (it != table_.end())
+                    return it->second;
+
+                auto res = table_.insert(value_type{move(key), mapped_type{}});
+
+                return res.first->second;
+            }
+
+            mapped_type& at(const key_type& key)
+            {
+                // TODO: out_of_range
+                auto it = table_.find(key);
+
+                return it->second;
+            }
+
+            const mapped_type& at(const key_type& key) const
+            {
+                // TODO: out_of_range
+                auto it = table_.find(key);
+
+                return it->second;
+            }
+
+            iterator find(const key_type& key)
+            {
+                return table_.find(key);
+            }
+
+            const_iterator find(const key_type& key) const
+            {
+                return table_.find(key);
+            }
+
+            size_type count(const key_type& key) const
+            {
+                return table_.count(key);
+            }
+
+            size_type capacity() const noexcept
+            {
+                return table_.capacity();
+            }
+
+            float load_factor() const noexcept
+            {
+                return table_.load_factor();
+            }
+
+            void rehash(size_type capacity)
+            {
+                table_.rehash(capacity);
+            }
+
+            void reserve(size_type count)
+            {
+                table_.reserve(count);
+            }
+
+            hasher hash_function() const
+            {
+                return table_.hash_function();
+            }
+
+            key_equal key_eq() const
+            {
+                return table_.key_eq();
+            }
+
+        private:
+            table_type table_;
+
+            static constexpr size_type default_capacity_{table_type::min_capacity};
+    };
+
+    template<class Key, class Value, class Hash, class Pred>
+    void swap(flat_unordered_map<Key, Value, Hash, Pred>& lhs,
+              flat_unordered_map<Key, Value, Hash, Pred>& rhs)
+    {
+        lhs.swap(rhs);
+    }
+}
+
+#endif
@@ -30,6 +30,7 @@
 #define LIBCPP_BITS_ADT_VECTOR
 
 #include <algorithm>
+#include <cstring>
 #include <initializer_list>
 #include <iterator>
 #include <memory>
@@ -88,9 +89,34 @@ namespace std
             template<class InputIterator>
             vector(InputIterator first, InputIterator last,
                    const Allocator& alloc = Allocator{})
-            {
-                // TODO: research constraints and provide multiple
-                //       implementations via enable_if
+                : data_{}, size_{}, capacity_{}, allocator_{alloc}
+            {
+                if constexpr (is_integral<InputIterator>::value)
+                { // Required by the standard.
+                    size_ = capacity_ = static_cast<size_type>(first);
+                    data_ = allocator_.allocate(capacity_);
+
+                    for (size_type i = 0; i < size_; ++i)
+                    {
+                        allocator_traits<Allocator>::construct(
+                            allocator_, data_ + i,
+                            static_cast<value_type>(last)
+                        );
+                    }
+                }
+                else
+                {
+                    size_ = capacity_ =
+                        static_cast<size_type>(distance(first, last));
+                    data_ = allocator_.allocate(capacity_);
+
+                    for (size_type i = 0; first != last; ++i, ++first)
+                    {
+                        allocator_traits<Allocator>::construct(
+                            allocator_, data_ + i, *first
+                        );
+                    }
+                }
             }
 
             vector(const vector& other)
@@ -526,9 +552,7 @@ namespace std
                 {
                     auto new_data = allocator_.allocate(capacity);
 
-                    auto to_copy = min(size, size_);
-                    for (size_type i = 0; i < to_copy; ++i)
-                        new_data[i] = move(data_[i]);
+                    relocate_(new_data, data_, min(size, size_));
 
                     std::swap(data_, new_data);
 
@@ -539,6 +563,34 @@ namespace std
                 size_ = size;
             }
 
+            /**
+             * Moves count live elements from src into the raw
+             * storage at dst and ends their lifetime at the source.
+             * Trivially copyable types are relocated with a single
+             * memcpy, everything else is move constructed and the
+             * source destroyed.
+             */
+            void relocate_(value_type* dst, value_type* src, size_type count)
+            {
+                if (count == 0)
+                    return;
+
+                if constexpr (is_trivially_copyable<value_type>::value)
+                    memcpy(dst, src, count * sizeof(value_type));
+                else
+                {
+                    for (size_type i = 0; i < count; ++i)
+                    {
+                        allocator_traits<Allocator>::construct(
+                            allocator_, dst + i, move(src[i])
+                        );
+                        allocator_traits<Allocator>::destroy(
+                            allocator_, src + i
+                        );
+                    }
+                }
+            }
+
             void destroy_from_end_until_(iterator target)
             {
                 if (!empty())
@@ -551,10 +603,18 @@ namespace std
 
             size_type next_capacity_(size_type hint = 0) const noexcept
             {
+                /**
+                 * Note: We grow by 1.5x rather than doubling. That keeps
+                 *       the total memory overshoot lower after a reserve()
+                 *       that guessed slightly wrong and lets the allocator
+                 *       eventually reuse the sum of previously freed
+                 *       buffers for a later growth step.
+                 */
+                auto grown = capacity_ + capacity_ / 2;
                 if (hint != 0)
-                    return max(capacity_ * 2, hint);
+                    return max(grown, hint);
                 else
-                    return max(capacity_ * 2, size_type{2u});
+                    return max(grown, size_type{4u});
             }
 
             iterator shift_(iterator position, size_type count)
@@ -569,21 +629,22 @@ namespace std
                 else
                 {
                     auto start_idx = static_cast<size_type>(position - begin());
-                    auto end_idx = start_idx + count;
                     auto new_size = size_ + count;
+                    auto new_capacity = next_capacity_(new_size);
 
-                    // Auxiliary vector for easier swap.
-                    vector tmp{};
-                    tmp.resize_without_copy_(max(new_size, capacity_));
-                    tmp.size_ = new_size;
+                    auto new_data = allocator_.allocate(new_capacity);
 
-                    // Copy before insertion index.
-                    copy(begin(), begin() + start_idx, tmp.begin());
+                    // Relocate around the gap left for the insertion.
+                    relocate_(new_data, data_, start_idx);
+                    relocate_(new_data + start_idx + count,
+                              data_ + start_idx, size_ - start_idx);
 
-                    // Copy after insertion index.
-                    copy(begin() + start_idx, end(), tmp.begin() + end_idx);
+                    if (data_)
+                        allocator_.deallocate(data_, capacity_);
 
-                    swap(tmp);
+                    data_ = new_data;
+                    capacity_ = new_capacity;
+                    size_ = new_size;
 
                     // Position was invalidated!
                     return begin() + start_idx;
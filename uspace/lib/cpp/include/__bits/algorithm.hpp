@@ -750,13 +750,16 @@ namespace std
     template<class ForwardIterator>
     ForwardIterator is_sorted_until(ForwardIterator first, ForwardIterator last)
     {
-        if (distance(first, last) < 2)
+        if (first == last)
             return last;
 
-        while (first != last)
+        auto next = first;
+        while (++next != last)
         {
-            if (*first > *(++first))
-                return first;
+            if (*next < *first)
+                return next;
+
+            first = next;
         }
 
         return last;
@@ -766,13 +769,16 @@ namespace std
     ForwardIterator is_sorted_until(ForwardIterator first, ForwardIterator last,
                                     Comp comp)
     {
-        if (distance(first, last) < 2)
+        if (first == last)
             return last;
 
-        while (first != last)
+        auto next = first;
+        while (++next != last)
         {
-            if (!comp(*first, *(++first)))
-                return first;
+            if (comp(*next, *first))
+                return next;
+
+            first = next;
         }
 
         return last;
@@ -883,32 +889,29 @@ namespace std
             using aux::heap_left_child;
             using aux::heap_right_child;
 
-            auto left = heap_left_child(idx);
-            auto right = heap_right_child(idx);
-
-            bool left_incorrect{comp(first[idx], first[left])};
-            bool right_incorrect{comp(first[idx], first[right])};
-            while ((left < count && left_incorrect) ||
-                   (right < count && right_incorrect))
+            /**
+             * Note: The children have to be bounds checked
+             *       before they are compared, both to keep
+             *       the sift-down within the heap and to avoid
+             *       reading past the end of the range.
+             */
+            while (true)
             {
-                if (right >= count || (left_incorrect && comp(first[right], first[left])))
-                {
-                    swap(first[idx], first[left]);
+                auto left = heap_left_child(idx);
+                auto right = heap_right_child(idx);
+                auto largest = idx;
 
-                    idx = left;
-                }
-                else if (right < count && right_incorrect)
-                {
-                    swap(first[idx], first[right]);
+                if (left < count && comp(first[largest], first[left]))
+                    largest = left;
+                if (right < count && comp(first[largest], first[right]))
+                    largest = right;
 
-                    idx = right;
-                } // Else should not happen because of the while condition.
+                if (largest == idx)
+                    break;
 
-                left = heap_left_child(idx);
-                right = heap_right_child(idx);
+                swap(first[idx], first[largest]);
 
-                left_incorrect = comp(first[idx], first[left]);
-                right_incorrect = comp(first[idx], first[right]);
+                idx = largest;
             }
         }
     }
@@ -971,7 +974,7 @@ namespace std
             return;
 
         swap(first[0], first[count - 1]);
-        aux::correct_children(first, decltype(count){}, count - 2, comp);
+        aux::correct_children(first, decltype(count){}, count - 1, comp);
     }
 
     /**
@@ -140,7 +140,7 @@ namespace std
                 if (!ibuf_ && mode_is_in_(mode_))
                     ibuf_ = new char_type[buf_size_];
                 if (!obuf_ && mode_is_out_(mode_))
-                    obuf_ = new char_type[buf_size_];
+                    obuf_ = new char_type[obuf_size_];
                 init_();
 
                 return this;
@@ -255,14 +255,57 @@ namespace std
                     return traits_type::eof();
 
                 auto count = static_cast<size_t>(this->output_next_ - this->output_begin_);
-                fwrite(obuf_, sizeof(char_type), count, file_);
-                fflush(file_);
+                if (count > 0)
+                {
+                    fwrite(obuf_, sizeof(char_type), count, file_);
+
+                    this->output_next_ = this->output_begin_;
+                }
 
-                this->output_next_ = this->output_begin_;
+                if (!traits_type::eq_int_type(c, traits_type::eof()) &&
+                    this->write_avail_())
+                    *this->output_next_++ = traits_type::to_char_type(c);
 
                 return traits_type::not_eof(c);
             }
 
+            streamsize xsputn(const char_type* s, streamsize n) override
+            {
+                if (!mode_is_out_(mode_) || !s || n == 0)
+                    return 0;
+
+                /**
+                 * Sequences that do not fit into the put area
+                 * are not worth the extra copy, flush whatever
+                 * we have and write them out directly.
+                 */
+                if (n >= static_cast<streamsize>(obuf_size_))
+                {
+                    overflow();
+
+                    return static_cast<streamsize>(
+                        fwrite(s, sizeof(char_type), n, file_));
+                }
+
+                streamsize written{};
+                while (written < n)
+                {
+                    if (!this->write_avail_())
+                        overflow();
+
+                    auto space = static_cast<streamsize>(
+                        this->output_end_ - this->output_next_);
+                    auto count = (n - written < space) ? (n - written) : space;
+
+                    traits_type::copy(this->output_next_, s + written,
+                                      static_cast<size_t>(count));
+                    this->output_next_ += count;
+                    written += count;
+                }
+
+                return written;
+            }
+
             basic_streambuf<char_type, traits_type>*
             setbuf(char_type* s, streamsize n) override
             {
@@ -290,9 +333,14 @@ namespace std
             int sync() override
             {
                 if (mode_is_out_(mode_))
+                {
                     overflow();
 
-                return 0; // TODO: what is the correct return value?
+                    if (fflush(file_))
+                        return -1;
+                }
+
+                return 0;
             }
 
             void imbue(const locale& loc) override
@@ -311,6 +359,14 @@ namespace std
 
             static constexpr size_t buf_size_{128};
 
+            /**
+             * The output buffer is large enough to batch
+             * writes into big VFS requests, writing per
+             * character or per line is an order of magnitude
+             * slower.
+             */
+            static constexpr size_t obuf_size_{64 * 1024};
+
             const char* get_mode_str_(ios_base::openmode mode)
             {
                 /**
@@ -371,7 +427,7 @@ namespace std
                 if (obuf_)
                 {
                     this->output_begin_ = this->output_next_ = obuf_;
-                    this->output_end_ = obuf_ + buf_size_;
+                    this->output_end_ = obuf_ + obuf_size_;
                 }
             }
     };
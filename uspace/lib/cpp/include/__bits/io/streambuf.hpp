@@ -133,6 +133,20 @@ namespace std
 
             streamsize sgetn(char_type* s, streamsize n)
             {
+                /**
+                 * Note: Fast path - when the get area already
+                 *       holds the requested characters we copy
+                 *       them in bulk without any virtual dispatch.
+                 */
+                if (s && 0 < n && read_avail_() &&
+                    n <= static_cast<streamsize>(input_end_ - input_next_))
+                {
+                    traits_type::copy(s, input_next_, static_cast<size_t>(n));
+                    input_next_ += n;
+
+                    return n;
+                }
+
                 return xsgetn(s, n);
             }
 
@@ -174,6 +188,20 @@ namespace std
 
             streamsize sputn(const char_type* s, streamsize n)
             {
+                /**
+                 * Note: Fast path - when the put area has room
+                 *       for the entire sequence we copy it in
+                 *       bulk without any virtual dispatch.
+                 */
+                if (s && 0 < n && write_avail_() &&
+                    n <= static_cast<streamsize>(output_end_ - output_next_))
+                {
+                    traits_type::copy(output_next_, s, static_cast<size_t>(n));
+                    output_next_ += n;
+
+                    return n;
+                }
+
                 return xsputn(s, n);
             }
 
@@ -337,12 +365,18 @@ namespace std
 
                 streamsize i{0};
                 auto eof = traits_type::eof();
-                for (; i <= n; ++i)
+                for (; i < n; ++i)
                 {
-                    if (!read_avail_() && traits_type::eq_int_type(uflow(), eof))
-                        break;
-
-                    *s++ = *input_next_++;
+                    if (read_avail_())
+                        *s++ = *input_next_++;
+                    else
+                    {
+                        auto c = uflow();
+                        if (traits_type::eq_int_type(c, eof))
+                            break;
+
+                        *s++ = traits_type::to_char_type(c);
+                    }
                 }
 
                 return i;
@@ -381,12 +415,10 @@ namespace std
                     return 0;
 
                 streamsize i{0};
-                for (; i <= n; ++i)
+                for (; i < n; ++i)
                 {
-                    if (!write_avail_() && traits_type::eq_int_type(overflow(), traits_type::eof()))
+                    if (traits_type::eq_int_type(sputc(*s++), traits_type::eof()))
                         break;
-
-                    *output_next_++ = *s++;
                 }
 
                 return i;
@@ -128,11 +128,39 @@ namespace std::aux
     {
         public:
             stdout_streambuf()
-                : basic_streambuf<Char, Traits>{}
+                : basic_streambuf<Char, Traits>{}, buffer_{nullptr}
             { /* DUMMY BODY */ }
 
             virtual ~stdout_streambuf()
-            { /* DUMMY BODY */ }
+            {
+                sync();
+
+                if (buffer_)
+                    delete[] buffer_;
+            }
+
+            /**
+             * Called from ios_base::sync_with_stdio(): while
+             * synchronization with stdio is off we batch output
+             * in our own put area and hand it to stdio in large
+             * blocks instead of going through it per character.
+             */
+            void set_sync(bool sync)
+            {
+                if (!sync && !buffer_)
+                {
+                    buffer_ = new char_type[buf_size_];
+                    this->setp(buffer_, buffer_ + buf_size_);
+                }
+                else if (sync && buffer_)
+                {
+                    this->sync();
+                    this->setp(nullptr, nullptr);
+
+                    delete[] buffer_;
+                    buffer_ = nullptr;
+                }
+            }
 
         protected:
             using traits_type = Traits;
@@ -142,10 +170,15 @@ namespace std::aux
 
             int_type overflow(int_type c = traits_type::eof()) override
             {
+                flush_buffer_();
+
                 if (!traits_type::eq_int_type(c, traits_type::eof()))
                 {
                     auto cc = traits_type::to_char_type(c);
-                    fwrite(&cc, sizeof(char_type), 1, out_);
+                    if (this->write_avail_())
+                        *this->output_next_++ = cc;
+                    else
+                        fwrite(&cc, sizeof(char_type), 1, out_);
                 }
 
                 return traits_type::not_eof(c);
@@ -153,11 +186,41 @@ namespace std::aux
 
             streamsize xsputn(const char_type* s, streamsize n) override
             {
-                return fwrite(s, sizeof(char_type), n, out_);
+                /**
+                 * Sequences that do not fit into the put area
+                 * are not worth the extra copy, flush whatever
+                 * we have and write them out directly.
+                 */
+                if (!buffer_ || n >= static_cast<streamsize>(buf_size_))
+                {
+                    flush_buffer_();
+
+                    return fwrite(s, sizeof(char_type), n, out_);
+                }
+
+                streamsize written{};
+                while (written < n)
+                {
+                    if (!this->write_avail_())
+                        flush_buffer_();
+
+                    auto space = static_cast<streamsize>(
+                        this->output_end_ - this->output_next_);
+                    auto count = (n - written < space) ? (n - written) : space;
+
+                    traits_type::copy(this->output_next_, s + written,
+                                      static_cast<size_t>(count));
+                    this->output_next_ += count;
+                    written += count;
+                }
+
+                return written;
             }
 
             int sync() override
             {
+                flush_buffer_();
+
                 if (fflush(out_))
                     return -1;
                 return 0;
@@ -165,7 +228,29 @@ namespace std::aux
 
         private:
             FILE* out_{stdout};
+
+            char_type* buffer_;
+
+            static constexpr size_t buf_size_{64 * 1024};
+
+            void flush_buffer_()
+            {
+                auto count = static_cast<size_t>(
+                    this->output_next_ - this->output_begin_);
+                if (count > 0)
+                {
+                    fwrite(this->output_begin_, sizeof(char_type), count, out_);
+                    this->output_next_ = this->output_begin_;
+                }
+            }
     };
+
+    /**
+     * Implemented in iostream.cpp where the streambuf of cout
+     * lives, invoked whenever ios_base::sync_with_stdio() changes
+     * the synchronization state.
+     */
+    void stdio_sync_changed(bool sync);
 }
 
 #endif
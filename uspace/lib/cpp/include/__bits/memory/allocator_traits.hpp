@@ -218,7 +218,7 @@ namespace std
 
             void deallocate(pointer ptr, size_type n)
             {
-                ::operator delete(ptr, n);
+                ::operator delete(ptr, n * sizeof(value_type));
             }
 
             size_type max_size() const noexcept
@@ -0,0 +1,650 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_MEMORY_MEMORY_RESOURCE
+#define LIBCPP_BITS_MEMORY_MEMORY_RESOURCE
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+#include <__bits/adt/map.hpp>
+#include <__bits/adt/unordered_map.hpp>
+#include <__bits/adt/vector.hpp>
+#include <__bits/string/string.hpp>
+
+namespace std::pmr
+{
+    /**
+     * 23.12, memory resources (C++17):
+     * Note: As libcpp has no stack unwinding support yet,
+     *       allocation failure returns nullptr where the
+     *       standard mandates throwing bad_alloc.
+     */
+
+    class memory_resource
+    {
+        public:
+            virtual ~memory_resource();
+
+            void* allocate(size_t bytes,
+                           size_t alignment = alignof(max_align_t))
+            {
+                return do_allocate(bytes, alignment);
+            }
+
+            void deallocate(void* ptr, size_t bytes,
+                            size_t alignment = alignof(max_align_t))
+            {
+                do_deallocate(ptr, bytes, alignment);
+            }
+
+            bool is_equal(const memory_resource& other) const noexcept
+            {
+                return do_is_equal(other);
+            }
+
+        protected:
+            virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+            virtual void do_deallocate(void* ptr, size_t bytes,
+                                       size_t alignment) = 0;
+            virtual bool do_is_equal(const memory_resource& other) const noexcept = 0;
+    };
+
+    inline bool operator==(const memory_resource& lhs, const memory_resource& rhs) noexcept
+    {
+        return &lhs == &rhs || lhs.is_equal(rhs);
+    }
+
+    inline bool operator!=(const memory_resource& lhs, const memory_resource& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    memory_resource* new_delete_resource() noexcept;
+    memory_resource* null_memory_resource() noexcept;
+    memory_resource* get_default_resource() noexcept;
+    memory_resource* set_default_resource(memory_resource* r) noexcept;
+
+    /**
+     * 23.12.3, class template polymorphic_allocator:
+     */
+
+    template<class T>
+    class polymorphic_allocator
+    {
+        public:
+            using value_type = T;
+
+            polymorphic_allocator() noexcept
+                : resource_{get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            polymorphic_allocator(memory_resource* r) noexcept
+                : resource_{r}
+            { /* DUMMY BODY */ }
+
+            polymorphic_allocator(const polymorphic_allocator&) = default;
+
+            template<class U>
+            polymorphic_allocator(const polymorphic_allocator<U>& other) noexcept
+                : resource_{other.resource()}
+            { /* DUMMY BODY */ }
+
+            /**
+             * Note: The standard deletes the copy assignment, but our
+             *       containers assign their allocators, so we keep it
+             *       to make the pmr container aliases usable.
+             */
+            polymorphic_allocator& operator=(const polymorphic_allocator&) = default;
+
+            T* allocate(size_t n)
+            {
+                return static_cast<T*>(
+                    resource_->allocate(n * sizeof(T), alignof(T))
+                );
+            }
+
+            void deallocate(T* ptr, size_t n)
+            {
+                resource_->deallocate(ptr, n * sizeof(T), alignof(T));
+            }
+
+            template<class U, class... Args>
+            void construct(U* ptr, Args&&... args)
+            {
+                ::new (static_cast<void*>(ptr)) U(forward<Args>(args)...);
+            }
+
+            template<class U>
+            void destroy(U* ptr)
+            {
+                ptr->~U();
+            }
+
+            polymorphic_allocator select_on_container_copy_construction() const
+            {
+                return polymorphic_allocator{};
+            }
+
+            memory_resource* resource() const noexcept
+            {
+                return resource_;
+            }
+
+        private:
+            memory_resource* resource_;
+    };
+
+    template<class T1, class T2>
+    bool operator==(const polymorphic_allocator<T1>& lhs,
+                    const polymorphic_allocator<T2>& rhs) noexcept
+    {
+        return *lhs.resource() == *rhs.resource();
+    }
+
+    template<class T1, class T2>
+    bool operator!=(const polymorphic_allocator<T1>& lhs,
+                    const polymorphic_allocator<T2>& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    /**
+     * 23.12.5, class monotonic_buffer_resource:
+     *
+     * Bump allocator that releases everything at once: allocation
+     * just advances a pointer in the current chunk, deallocation is
+     * a no-op and release() (or the destructor) returns all upstream
+     * chunks. Ideal for request-scoped parsing.
+     */
+
+    class monotonic_buffer_resource : public memory_resource
+    {
+        public:
+            explicit monotonic_buffer_resource(memory_resource* upstream)
+                : upstream_{upstream}, initial_buffer_{}, initial_size_{},
+                  chunks_{}, current_{}, available_{},
+                  next_size_{default_next_size_}
+            { /* DUMMY BODY */ }
+
+            monotonic_buffer_resource()
+                : monotonic_buffer_resource{get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            explicit monotonic_buffer_resource(size_t initial_size,
+                                               memory_resource* upstream = get_default_resource())
+                : monotonic_buffer_resource{upstream}
+            {
+                if (initial_size > 0)
+                    next_size_ = initial_size;
+            }
+
+            monotonic_buffer_resource(void* buffer, size_t buffer_size,
+                                      memory_resource* upstream = get_default_resource())
+                : upstream_{upstream},
+                  initial_buffer_{static_cast<char*>(buffer)},
+                  initial_size_{buffer_size}, chunks_{},
+                  current_{static_cast<char*>(buffer)},
+                  available_{buffer_size},
+                  next_size_{buffer_size > 0 ? buffer_size * 2 : default_next_size_}
+            { /* DUMMY BODY */ }
+
+            monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+            monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+            ~monotonic_buffer_resource() override
+            {
+                release();
+            }
+
+            void release()
+            {
+                while (chunks_)
+                {
+                    auto next = chunks_->next;
+                    upstream_->deallocate(chunks_, chunks_->size,
+                                          alignof(max_align_t));
+                    chunks_ = next;
+                }
+
+                current_ = initial_buffer_;
+                available_ = initial_size_;
+                next_size_ = initial_size_ > 0 ?
+                    initial_size_ * 2 : default_next_size_;
+            }
+
+            memory_resource* upstream_resource() const noexcept
+            {
+                return upstream_;
+            }
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override
+            {
+                auto res = allocate_from_current_(bytes, alignment);
+                if (res)
+                    return res;
+
+                /*
+                 * The current chunk is exhausted, get a bigger one
+                 * from upstream.
+                 */
+                auto needed = sizeof(chunk_) + bytes + alignment;
+                auto size = next_size_;
+                while (size < needed)
+                    size *= 2;
+
+                auto mem = static_cast<char*>(
+                    upstream_->allocate(size, alignof(max_align_t))
+                );
+                if (!mem)
+                    return nullptr;
+
+                auto chunk = reinterpret_cast<chunk_*>(mem);
+                chunk->next = chunks_;
+                chunk->size = size;
+                chunks_ = chunk;
+
+                current_ = mem + sizeof(chunk_);
+                available_ = size - sizeof(chunk_);
+                next_size_ = size * 2;
+
+                return allocate_from_current_(bytes, alignment);
+            }
+
+            void do_deallocate(void*, size_t, size_t) override
+            { /* DUMMY BODY */ }
+
+            bool do_is_equal(const memory_resource& other) const noexcept override
+            {
+                return this == &other;
+            }
+
+        private:
+            struct chunk_
+            {
+                chunk_* next;
+                size_t size;
+            };
+
+            static constexpr size_t default_next_size_{1024};
+
+            memory_resource* upstream_;
+            char* initial_buffer_;
+            size_t initial_size_;
+            chunk_* chunks_;
+            char* current_;
+            size_t available_;
+            size_t next_size_;
+
+            void* allocate_from_current_(size_t bytes, size_t alignment)
+            {
+                auto addr = reinterpret_cast<uintptr_t>(current_);
+                auto aligned = (addr + alignment - 1) & ~(alignment - 1);
+                auto padding = aligned - addr;
+
+                if (padding + bytes > available_)
+                    return nullptr;
+
+                current_ += padding + bytes;
+                available_ -= padding + bytes;
+
+                return reinterpret_cast<void*>(aligned);
+            }
+    };
+
+    /**
+     * 23.12.6, pool resource classes:
+     */
+
+    struct pool_options
+    {
+        size_t max_blocks_per_chunk = 0;
+        size_t largest_required_pool_block = 0;
+    };
+
+    /**
+     * Pool allocator without any internal synchronization. Small
+     * allocations are served from per-size-class free lists refilled
+     * by carving chunks obtained from upstream; large allocations are
+     * forwarded to upstream directly. All memory is returned by
+     * release() or the destructor.
+     */
+
+    class unsynchronized_pool_resource : public memory_resource
+    {
+        public:
+            unsynchronized_pool_resource(const pool_options& opts,
+                                         memory_resource* upstream)
+                : opts_{opts}, upstream_{upstream}, pools_{}, big_blocks_{}
+            {
+                if (opts_.max_blocks_per_chunk == 0 ||
+                    opts_.max_blocks_per_chunk > default_max_blocks_)
+                    opts_.max_blocks_per_chunk = default_max_blocks_;
+
+                if (opts_.largest_required_pool_block == 0)
+                    opts_.largest_required_pool_block = default_largest_block_;
+
+                largest_block_ = min_block_size_;
+                pool_count_ = 1;
+                while (largest_block_ < opts_.largest_required_pool_block &&
+                       pool_count_ < max_pool_count_)
+                {
+                    largest_block_ *= 2;
+                    ++pool_count_;
+                }
+                opts_.largest_required_pool_block = largest_block_;
+
+                for (size_t i = 0; i < pool_count_; ++i)
+                    pools_[i].next_blocks = initial_blocks_per_chunk_;
+            }
+
+            unsynchronized_pool_resource()
+                : unsynchronized_pool_resource{pool_options{}, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            explicit unsynchronized_pool_resource(memory_resource* upstream)
+                : unsynchronized_pool_resource{pool_options{}, upstream}
+            { /* DUMMY BODY */ }
+
+            explicit unsynchronized_pool_resource(const pool_options& opts)
+                : unsynchronized_pool_resource{opts, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            unsynchronized_pool_resource(const unsynchronized_pool_resource&) = delete;
+            unsynchronized_pool_resource& operator=(const unsynchronized_pool_resource&) = delete;
+
+            ~unsynchronized_pool_resource() override
+            {
+                release();
+            }
+
+            void release()
+            {
+                for (size_t i = 0; i < pool_count_; ++i)
+                {
+                    auto chunk = pools_[i].chunks;
+                    while (chunk)
+                    {
+                        auto next = chunk->next;
+                        upstream_->deallocate(chunk, chunk->size,
+                                              alignof(max_align_t));
+                        chunk = next;
+                    }
+
+                    pools_[i].chunks = nullptr;
+                    pools_[i].free = nullptr;
+                    pools_[i].next_blocks = initial_blocks_per_chunk_;
+                }
+
+                while (big_blocks_)
+                {
+                    auto next = big_blocks_->next;
+                    upstream_->deallocate(big_blocks_, big_blocks_->size,
+                                          big_blocks_->alignment);
+                    big_blocks_ = next;
+                }
+            }
+
+            memory_resource* upstream_resource() const noexcept
+            {
+                return upstream_;
+            }
+
+            pool_options options() const noexcept
+            {
+                return opts_;
+            }
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override
+            {
+                if (bytes > largest_block_ || alignment > alignof(max_align_t))
+                    return allocate_big_(bytes, alignment);
+
+                auto idx = pool_index_(bytes, alignment);
+                auto& pool = pools_[idx];
+
+                if (!pool.free && !refill_pool_(idx))
+                    return nullptr;
+
+                auto block = pool.free;
+                pool.free = *static_cast<void**>(block);
+
+                return block;
+            }
+
+            void do_deallocate(void* ptr, size_t bytes,
+                               size_t alignment) override
+            {
+                if (bytes > largest_block_ || alignment > alignof(max_align_t))
+                {
+                    deallocate_big_(ptr);
+                    return;
+                }
+
+                auto& pool = pools_[pool_index_(bytes, alignment)];
+
+                *static_cast<void**>(ptr) = pool.free;
+                pool.free = ptr;
+            }
+
+            bool do_is_equal(const memory_resource& other) const noexcept override
+            {
+                return this == &other;
+            }
+
+        private:
+            struct chunk_
+            {
+                chunk_* next;
+                size_t size;
+            };
+
+            struct big_block_
+            {
+                big_block_* next;
+                size_t size;
+                size_t alignment;
+            };
+
+            struct pool_
+            {
+                void* free;
+                chunk_* chunks;
+                size_t next_blocks;
+            };
+
+            static constexpr size_t min_block_size_{sizeof(void*)};
+            static constexpr size_t max_pool_count_{16};
+            static constexpr size_t default_largest_block_{1024};
+            static constexpr size_t default_max_blocks_{8192};
+            static constexpr size_t initial_blocks_per_chunk_{8};
+
+            pool_options opts_;
+            memory_resource* upstream_;
+            pool_ pools_[max_pool_count_];
+            big_block_* big_blocks_;
+            size_t largest_block_;
+            size_t pool_count_;
+
+            size_t pool_index_(size_t bytes, size_t alignment) const
+            {
+                auto wanted = bytes > alignment ? bytes : alignment;
+
+                size_t idx{};
+                size_t block = min_block_size_;
+                while (block < wanted)
+                {
+                    block *= 2;
+                    ++idx;
+                }
+
+                return idx;
+            }
+
+            bool refill_pool_(size_t idx)
+            {
+                auto& pool = pools_[idx];
+                auto block_size = min_block_size_ << idx;
+
+                auto blocks = pool.next_blocks;
+                auto size = sizeof(chunk_) + block_size * blocks + block_size;
+
+                auto mem = static_cast<char*>(
+                    upstream_->allocate(size, alignof(max_align_t))
+                );
+                if (!mem)
+                    return false;
+
+                auto chunk = reinterpret_cast<chunk_*>(mem);
+                chunk->next = pool.chunks;
+                chunk->size = size;
+                pool.chunks = chunk;
+
+                /* Align the first block to the block size stride. */
+                auto addr = reinterpret_cast<uintptr_t>(mem + sizeof(chunk_));
+                auto mask = (block_size < alignof(max_align_t) ?
+                    block_size : alignof(max_align_t)) - 1;
+                auto start = reinterpret_cast<char*>((addr + mask) & ~mask);
+
+                for (size_t i = 0; i < blocks; ++i)
+                {
+                    auto block = static_cast<void*>(start + i * block_size);
+                    *static_cast<void**>(block) = pool.free;
+                    pool.free = block;
+                }
+
+                if (pool.next_blocks < opts_.max_blocks_per_chunk)
+                    pool.next_blocks *= 2;
+
+                return true;
+            }
+
+            void* allocate_big_(size_t bytes, size_t alignment)
+            {
+                auto header = alignment > sizeof(big_block_) ?
+                    alignment : sizeof(big_block_);
+                auto size = header + bytes;
+
+                auto mem = static_cast<char*>(
+                    upstream_->allocate(size, alignment)
+                );
+                if (!mem)
+                    return nullptr;
+
+                auto block = reinterpret_cast<big_block_*>(mem);
+                block->next = big_blocks_;
+                block->size = size;
+                block->alignment = alignment;
+                big_blocks_ = block;
+
+                return mem + header;
+            }
+
+            void deallocate_big_(void* ptr)
+            {
+                big_block_** link = &big_blocks_;
+                while (*link)
+                {
+                    auto block = *link;
+                    auto header = block->alignment > sizeof(big_block_) ?
+                        block->alignment : sizeof(big_block_);
+
+                    if (reinterpret_cast<char*>(block) + header == ptr)
+                    {
+                        *link = block->next;
+                        upstream_->deallocate(block, block->size,
+                                              block->alignment);
+                        return;
+                    }
+
+                    link = &block->next;
+                }
+            }
+    };
+
+    /**
+     * Aliases for containers using the polymorphic allocator.
+     * Note: Of these, vector and string actually route their storage
+     *       through the allocator today; the node-based containers
+     *       still allocate their nodes directly and only carry the
+     *       allocator along. They are provided so code can already be
+     *       written against the pmr interfaces.
+     */
+
+    template<class T>
+    using vector = std::vector<T, polymorphic_allocator<T>>;
+
+    template<class Char, class Traits = char_traits<Char>>
+    using basic_string = std::basic_string<
+        Char, Traits, polymorphic_allocator<Char>
+    >;
+
+    using string    = basic_string<char>;
+    using u16string = basic_string<char16_t>;
+    using u32string = basic_string<char32_t>;
+    using wstring   = basic_string<wchar_t>;
+
+    template<class Key, class Value, class Compare = less<Key>>
+    using map = std::map<
+        Key, Value, Compare,
+        polymorphic_allocator<pair<const Key, Value>>
+    >;
+
+    template<class Key, class Value, class Compare = less<Key>>
+    using multimap = std::multimap<
+        Key, Value, Compare,
+        polymorphic_allocator<pair<const Key, Value>>
+    >;
+
+    template<
+        class Key, class Value,
+        class Hash = hash<Key>,
+        class Pred = equal_to<Key>
+    >
+    using unordered_map = std::unordered_map<
+        Key, Value, Hash, Pred,
+        polymorphic_allocator<pair<const Key, Value>>
+    >;
+
+    template<
+        class Key, class Value,
+        class Hash = hash<Key>,
+        class Pred = equal_to<Key>
+    >
+    using unordered_multimap = std::unordered_multimap<
+        Key, Value, Hash, Pred,
+        polymorphic_allocator<pair<const Key, Value>>
+    >;
+}
+
+#endif
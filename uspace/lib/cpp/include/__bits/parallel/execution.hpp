@@ -0,0 +1,553 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_PARALLEL_EXECUTION
+#define LIBCPP_BITS_PARALLEL_EXECUTION
+
+#include <__bits/thread/thread_pool.hpp>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+namespace std::execution
+{
+    /**
+     * 20.19, execution policies (C++17):
+     * Note: Unlike in the standard, the policy overloads of the
+     *       algorithms live in this header and not in <algorithm>
+     *       and <numeric>, which keeps the threading machinery out
+     *       of translation units that only use the serial versions.
+     */
+
+    class sequenced_policy
+    { /* DUMMY BODY */ };
+
+    class parallel_policy
+    { /* DUMMY BODY */ };
+
+    class parallel_unsequenced_policy
+    { /* DUMMY BODY */ };
+
+    inline constexpr sequenced_policy seq{};
+    inline constexpr parallel_policy par{};
+    inline constexpr parallel_unsequenced_policy par_unseq{};
+
+    /**
+     * Non-standard: Ranges shorter than this are handed to the
+     * serial algorithms, as the fork/join overhead would dominate.
+     */
+    inline size_t parallel_threshold{4096};
+}
+
+namespace std
+{
+    template<class T>
+    struct is_execution_policy: false_type
+    { /* DUMMY BODY */ };
+
+    template<>
+    struct is_execution_policy<execution::sequenced_policy>: true_type
+    { /* DUMMY BODY */ };
+
+    template<>
+    struct is_execution_policy<execution::parallel_policy>: true_type
+    { /* DUMMY BODY */ };
+
+    template<>
+    struct is_execution_policy<execution::parallel_unsequenced_policy>: true_type
+    { /* DUMMY BODY */ };
+
+    template<class T>
+    inline constexpr bool is_execution_policy_v = is_execution_policy<T>::value;
+}
+
+namespace std::aux
+{
+    /**
+     * Fork/join helpers built on the std::async worker pool.
+     * The caller waiting for its chunks helps draining the pool
+     * queue, so a parallel algorithm invoked from a pooled task
+     * cannot deadlock the fixed-size pool.
+     */
+
+    class parallel_latch
+    {
+        public:
+            explicit parallel_latch(size_t count)
+                : mutex_{}, condvar_{}, count_{count}
+            {
+                threading::mutex::init(mutex_);
+                threading::condvar::init(condvar_);
+            }
+
+            void count_down()
+            {
+                threading::mutex::lock(mutex_);
+                bool done = (--count_ == 0);
+                threading::mutex::unlock(mutex_);
+
+                if (done)
+                    threading::condvar::broadcast(condvar_);
+            }
+
+            bool done()
+            {
+                threading::mutex::lock(mutex_);
+                bool res = (count_ == 0);
+                threading::mutex::unlock(mutex_);
+
+                return res;
+            }
+
+            void wait()
+            {
+                auto& pool = thread_pool::instance();
+
+                while (!done())
+                {
+                    if (pool.try_run_one())
+                        continue;
+
+                    threading::mutex::lock(mutex_);
+                    while (count_ > 0)
+                        threading::condvar::wait(condvar_, mutex_);
+                    threading::mutex::unlock(mutex_);
+                }
+            }
+
+        private:
+            mutex_t mutex_;
+            condvar_t condvar_;
+            size_t count_;
+    };
+
+    /**
+     * Splits [0, size) into one chunk per pool worker and
+     * runs f(begin, end) on each, returning once all chunks
+     * have finished.
+     */
+    template<class F>
+    void parallel_run(size_t size, F&& f)
+    {
+        auto& pool = thread_pool::instance();
+
+        auto chunks = thread_pool::worker_count;
+        if (chunks > size)
+            chunks = size;
+
+        parallel_latch latch{chunks};
+        auto step = size / chunks;
+
+        size_t begin{};
+        for (size_t i = 0; i < chunks; ++i)
+        {
+            auto end = (i == chunks - 1) ? size : begin + step;
+            pool.submit(
+                [&latch, &f, begin, end](){
+                    f(begin, end);
+                    latch.count_down();
+                }
+            );
+            begin = end;
+        }
+
+        latch.wait();
+    }
+
+    template<class ExecutionPolicy, class Iterator>
+    bool parallel_viable(ExecutionPolicy&&, Iterator first, Iterator last)
+    {
+        if constexpr (is_same_v<decay_t<ExecutionPolicy>,
+                                execution::sequenced_policy>)
+            return false;
+        else if constexpr (!is_base_of_v<
+            random_access_iterator_tag,
+            typename iterator_traits<Iterator>::iterator_category
+        >)
+            return false;
+        else
+        {
+            return static_cast<size_t>(last - first) >=
+                execution::parallel_threshold;
+        }
+    }
+
+    /**
+     * Stable merge of two sorted ranges that moves the elements
+     * to the output. If construct is set the output is raw memory
+     * and the elements are move constructed into it instead of
+     * being move assigned.
+     */
+    template<class In, class Out, class Compare>
+    void merge_move(In first1, In last1, In first2, In last2,
+                    Out out, Compare& comp, bool construct)
+    {
+        using value_type = typename iterator_traits<In>::value_type;
+
+        auto put = [&out, construct](value_type& val){
+            if (construct)
+                ::new (static_cast<void*>(addressof(*out))) value_type{move(val)};
+            else
+                *out = move(val);
+            ++out;
+        };
+
+        while (first1 != last1 && first2 != last2)
+        {
+            if (comp(*first2, *first1))
+                put(*first2++);
+            else
+                put(*first1++);
+        }
+
+        while (first1 != last1)
+            put(*first1++);
+        while (first2 != last2)
+            put(*first2++);
+    }
+
+    /**
+     * Parallel merge sort: the chunks are sorted in parallel by
+     * the serial std::sort and then pairwise merged (again in
+     * parallel) between the input range and a scratch buffer.
+     */
+    template<class RandomAccessIterator, class Compare>
+    void parallel_sort(RandomAccessIterator first, RandomAccessIterator last,
+                       Compare comp)
+    {
+        using value_type =
+            typename iterator_traits<RandomAccessIterator>::value_type;
+
+        auto size = static_cast<size_t>(last - first);
+        auto& pool = thread_pool::instance();
+
+        size_t chunks = thread_pool::worker_count;
+        size_t bounds[thread_pool::worker_count + 1];
+
+        auto step = size / chunks;
+        for (size_t i = 0; i < chunks; ++i)
+            bounds[i] = i * step;
+        bounds[chunks] = size;
+
+        parallel_latch sort_latch{chunks};
+        for (size_t i = 0; i < chunks; ++i)
+        {
+            pool.submit(
+                [&, i](){
+                    sort(first + bounds[i], first + bounds[i + 1], comp);
+                    sort_latch.count_down();
+                }
+            );
+        }
+        sort_latch.wait();
+
+        auto buf = static_cast<value_type*>(
+            ::operator new(size * sizeof(value_type))
+        );
+        bool in_buf{false};
+        bool buf_constructed{false};
+
+        while (chunks > 1)
+        {
+            auto merged = (chunks + 1) / 2;
+
+            parallel_latch merge_latch{merged};
+            for (size_t i = 0; i < merged; ++i)
+            {
+                pool.submit(
+                    [&, i](){
+                        auto begin1 = bounds[2 * i];
+                        auto end1 = bounds[2 * i + 1];
+                        auto end2 = (2 * i + 2 <= chunks) ?
+                            bounds[2 * i + 2] : end1;
+
+                        if (!in_buf)
+                        {
+                            merge_move(
+                                first + begin1, first + end1,
+                                first + end1, first + end2,
+                                buf + begin1, comp, !buf_constructed
+                            );
+                        }
+                        else
+                        {
+                            merge_move(
+                                buf + begin1, buf + end1,
+                                buf + end1, buf + end2,
+                                first + begin1, comp, false
+                            );
+                        }
+                        merge_latch.count_down();
+                    }
+                );
+            }
+            merge_latch.wait();
+
+            for (size_t i = 0; i < merged; ++i)
+                bounds[i] = bounds[2 * i];
+            bounds[merged] = size;
+
+            if (!in_buf)
+                buf_constructed = true;
+            in_buf = !in_buf;
+            chunks = merged;
+        }
+
+        if (in_buf)
+        {
+            parallel_run(
+                size,
+                [&](size_t begin, size_t end){
+                    for (size_t i = begin; i < end; ++i)
+                        first[i] = move(buf[i]);
+                }
+            );
+        }
+
+        if (buf_constructed)
+        {
+            for (size_t i = 0; i < size; ++i)
+                buf[i].~value_type();
+        }
+        ::operator delete(buf);
+    }
+}
+
+namespace std
+{
+    /**
+     * Execution policy overloads of the algorithms (C++17).
+     * The policy is only a hint: short ranges and non random
+     * access iterators fall back to the serial versions.
+     */
+
+    template<
+        class ExecutionPolicy, class Iterator, class Function,
+        class = enable_if_t<is_execution_policy_v<decay_t<ExecutionPolicy>>>
+    >
+    void for_each(ExecutionPolicy&& policy, Iterator first, Iterator last,
+                  Function f)
+    {
+        if (!aux::parallel_viable(policy, first, last))
+        {
+            for_each(first, last, move(f));
+
+            return;
+        }
+
+        aux::parallel_run(
+            static_cast<size_t>(last - first),
+            [&](size_t begin, size_t end){
+                for (auto it = first + begin; it != first + end; ++it)
+                    f(*it);
+            }
+        );
+    }
+
+    template<
+        class ExecutionPolicy, class Iterator,
+        class OutputIterator, class UnaryOperation,
+        class = enable_if_t<is_execution_policy_v<decay_t<ExecutionPolicy>>>
+    >
+    OutputIterator transform(ExecutionPolicy&& policy,
+                             Iterator first, Iterator last,
+                             OutputIterator result, UnaryOperation op)
+    {
+        if (!aux::parallel_viable(policy, first, last))
+            return transform(first, last, result, move(op));
+
+        auto size = static_cast<size_t>(last - first);
+        aux::parallel_run(
+            size,
+            [&](size_t begin, size_t end){
+                for (size_t i = begin; i < end; ++i)
+                    result[i] = op(first[i]);
+            }
+        );
+
+        return result + size;
+    }
+
+    template<
+        class ExecutionPolicy, class Iterator1, class Iterator2,
+        class OutputIterator, class BinaryOperation,
+        class = enable_if_t<is_execution_policy_v<decay_t<ExecutionPolicy>>>
+    >
+    OutputIterator transform(ExecutionPolicy&& policy,
+                             Iterator1 first1, Iterator1 last1,
+                             Iterator2 first2, OutputIterator result,
+                             BinaryOperation op)
+    {
+        if (!aux::parallel_viable(policy, first1, last1))
+            return transform(first1, last1, first2, result, move(op));
+
+        auto size = static_cast<size_t>(last1 - first1);
+        aux::parallel_run(
+            size,
+            [&](size_t begin, size_t end){
+                for (size_t i = begin; i < end; ++i)
+                    result[i] = op(first1[i], first2[i]);
+            }
+        );
+
+        return result + size;
+    }
+
+    template<
+        class ExecutionPolicy, class Iterator, class OutputIterator,
+        class = enable_if_t<is_execution_policy_v<decay_t<ExecutionPolicy>>>
+    >
+    OutputIterator copy(ExecutionPolicy&& policy,
+                        Iterator first, Iterator last, OutputIterator result)
+    {
+        if (!aux::parallel_viable(policy, first, last))
+            return copy(first, last, result);
+
+        auto size = static_cast<size_t>(last - first);
+        aux::parallel_run(
+            size,
+            [&](size_t begin, size_t end){
+                for (size_t i = begin; i < end; ++i)
+                    result[i] = first[i];
+            }
+        );
+
+        return result + size;
+    }
+
+    template<
+        class ExecutionPolicy, class RandomAccessIterator, class Compare,
+        class = enable_if_t<is_execution_policy_v<decay_t<ExecutionPolicy>>>
+    >
+    void sort(ExecutionPolicy&& policy,
+              RandomAccessIterator first, RandomAccessIterator last,
+              Compare comp)
+    {
+        if (!aux::parallel_viable(policy, first, last))
+        {
+            sort(first, last, move(comp));
+
+            return;
+        }
+
+        aux::parallel_sort(first, last, comp);
+    }
+
+    template<
+        class ExecutionPolicy, class RandomAccessIterator,
+        class = enable_if_t<is_execution_policy_v<decay_t<ExecutionPolicy>>>
+    >
+    void sort(ExecutionPolicy&& policy,
+              RandomAccessIterator first, RandomAccessIterator last)
+    {
+        using value_type =
+            typename iterator_traits<RandomAccessIterator>::value_type;
+
+        sort(forward<ExecutionPolicy>(policy), first, last,
+             less<value_type>{});
+    }
+
+    template<
+        class ExecutionPolicy, class Iterator, class T, class BinaryOperation,
+        class = enable_if_t<is_execution_policy_v<decay_t<ExecutionPolicy>>>
+    >
+    T reduce(ExecutionPolicy&& policy, Iterator first, Iterator last,
+             T init, BinaryOperation op)
+    {
+        if (!aux::parallel_viable(policy, first, last))
+            return reduce(first, last, move(init), move(op));
+
+        auto size = static_cast<size_t>(last - first);
+
+        /**
+         * Each chunk reduces into its own slot seeded by the
+         * first chunk element, the partials are then folded
+         * into init. This requires op to be associative, which
+         * reduce (unlike accumulate) may assume.
+         */
+        auto partials = static_cast<T*>(
+            ::operator new(aux::thread_pool::worker_count * sizeof(T))
+        );
+        size_t used{};
+
+        aux::parallel_run(
+            size,
+            [&](size_t begin, size_t end){
+                auto acc = static_cast<T>(first[begin]);
+                for (size_t i = begin + 1; i < end; ++i)
+                    acc = op(acc, first[i]);
+
+                auto slot = __atomic_fetch_add(&used, 1, __ATOMIC_ACQ_REL);
+                ::new (static_cast<void*>(partials + slot)) T{move(acc)};
+            }
+        );
+
+        auto res{move(init)};
+        for (size_t i = 0; i < used; ++i)
+        {
+            res = op(res, partials[i]);
+            partials[i].~T();
+        }
+        ::operator delete(partials);
+
+        return res;
+    }
+
+    template<
+        class ExecutionPolicy, class Iterator, class T,
+        class = enable_if_t<is_execution_policy_v<decay_t<ExecutionPolicy>>>
+    >
+    T reduce(ExecutionPolicy&& policy, Iterator first, Iterator last, T init)
+    {
+        return reduce(
+            forward<ExecutionPolicy>(policy), first, last, move(init),
+            [](const T& lhs, const auto& rhs){
+                return lhs + rhs;
+            }
+        );
+    }
+
+    template<
+        class ExecutionPolicy, class Iterator,
+        class = enable_if_t<is_execution_policy_v<decay_t<ExecutionPolicy>>>
+    >
+    auto reduce(ExecutionPolicy&& policy, Iterator first, Iterator last)
+    {
+        using value_type = typename iterator_traits<Iterator>::value_type;
+
+        return reduce(
+            forward<ExecutionPolicy>(policy), first, last, value_type{}
+        );
+    }
+}
+
+#endif
@@ -32,8 +32,11 @@
 namespace std::aux
 {
     /**
-     * At the moment we do not have atomics, change this
-     * to std::atomic<long> once we do.
+     * Counters are plain integers manipulated through the
+     * compiler atomic builtins, see refcount_obj.cpp for
+     * the memory ordering used. Single-threaded programs
+     * can define LIBCPP_SINGLE_THREADED_REFCOUNT to drop
+     * the atomics altogether.
      */
     using refcount_t = long;
 
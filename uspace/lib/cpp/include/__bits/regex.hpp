@@ -29,6 +29,2604 @@
 #ifndef LIBCPP_BITS_REGEX
 #define LIBCPP_BITS_REGEX
 
-#error "<regex> is not implemented"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Automaton-based regex engine. Patterns are parsed into a syntax
+ * tree, compiled to a Thompson NFA program and matched without
+ * backtracking:
+ *
+ *   1) A lazily built byte-wide DFA (built per compiled pattern,
+ *      states memoized on demand) scans the input at close to
+ *      memory bandwidth and either rejects the whole range or
+ *      locates the earliest match end.
+ *   2) A Pike-style NFA simulation with capture slots then runs to
+ *      produce leftmost-first (ECMAScript) submatches. It is the
+ *      engine of record; the DFA is a prefilter, so inputs that do
+ *      not match - the common case when scanning logs - never pay
+ *      for submatch tracking.
+ *
+ * Compiled patterns are kept in a small process-wide LRU cache keyed
+ * by (pattern, flags), so repeatedly constructing the same regex
+ * (e.g. in a loop over files) amortizes compilation to a lookup.
+ *
+ * The grammar is the DFA-friendly core of ECMAScript: literals,
+ * '.', bracket expressions, \d\D\w\W\s\S, alternation, (capturing
+ * and non-capturing) groups, greedy/lazy *, +, ?, {n,m}, and the
+ * ^, $, \b, \B assertions. Backreferences and lookaround are not
+ * finite automata and are rejected at compile time.
+ */
+
+namespace std
+{
+    namespace regex_constants
+    {
+        enum syntax_option_type : uint16_t
+        {
+            icase      = 1U << 0,
+            nosubs     = 1U << 1,
+            optimize   = 1U << 2,
+            collate    = 1U << 3,
+            ECMAScript = 1U << 4,
+            basic      = 1U << 5,
+            extended   = 1U << 6,
+            awk        = 1U << 7,
+            grep       = 1U << 8,
+            egrep      = 1U << 9,
+            multiline  = 1U << 10
+        };
+
+        constexpr syntax_option_type operator|(syntax_option_type lhs, syntax_option_type rhs)
+        {
+            return static_cast<syntax_option_type>(
+                static_cast<uint16_t>(lhs) | static_cast<uint16_t>(rhs));
+        }
+
+        constexpr syntax_option_type operator&(syntax_option_type lhs, syntax_option_type rhs)
+        {
+            return static_cast<syntax_option_type>(
+                static_cast<uint16_t>(lhs) & static_cast<uint16_t>(rhs));
+        }
+
+        constexpr syntax_option_type operator^(syntax_option_type lhs, syntax_option_type rhs)
+        {
+            return static_cast<syntax_option_type>(
+                static_cast<uint16_t>(lhs) ^ static_cast<uint16_t>(rhs));
+        }
+
+        constexpr syntax_option_type operator~(syntax_option_type opts)
+        {
+            return static_cast<syntax_option_type>(~static_cast<uint16_t>(opts));
+        }
+
+        inline syntax_option_type& operator|=(syntax_option_type& lhs, syntax_option_type rhs)
+        {
+            return lhs = lhs | rhs;
+        }
+
+        inline syntax_option_type& operator&=(syntax_option_type& lhs, syntax_option_type rhs)
+        {
+            return lhs = lhs & rhs;
+        }
+
+        enum match_flag_type : uint16_t
+        {
+            match_default     = 0,
+            match_not_bol     = 1U << 0,
+            match_not_eol     = 1U << 1,
+            match_not_bow     = 1U << 2,
+            match_not_eow     = 1U << 3,
+            match_any         = 1U << 4,
+            match_not_null    = 1U << 5,
+            match_continuous  = 1U << 6,
+            match_prev_avail  = 1U << 7,
+            format_default    = 0,
+            format_sed        = 1U << 8,
+            format_no_copy    = 1U << 9,
+            format_first_only = 1U << 10
+        };
+
+        constexpr match_flag_type operator|(match_flag_type lhs, match_flag_type rhs)
+        {
+            return static_cast<match_flag_type>(
+                static_cast<uint16_t>(lhs) | static_cast<uint16_t>(rhs));
+        }
+
+        constexpr match_flag_type operator&(match_flag_type lhs, match_flag_type rhs)
+        {
+            return static_cast<match_flag_type>(
+                static_cast<uint16_t>(lhs) & static_cast<uint16_t>(rhs));
+        }
+
+        constexpr match_flag_type operator^(match_flag_type lhs, match_flag_type rhs)
+        {
+            return static_cast<match_flag_type>(
+                static_cast<uint16_t>(lhs) ^ static_cast<uint16_t>(rhs));
+        }
+
+        constexpr match_flag_type operator~(match_flag_type flags)
+        {
+            return static_cast<match_flag_type>(~static_cast<uint16_t>(flags));
+        }
+
+        inline match_flag_type& operator|=(match_flag_type& lhs, match_flag_type rhs)
+        {
+            return lhs = lhs | rhs;
+        }
+
+        inline match_flag_type& operator&=(match_flag_type& lhs, match_flag_type rhs)
+        {
+            return lhs = lhs & rhs;
+        }
+
+        enum error_type
+        {
+            error_collate,
+            error_ctype,
+            error_escape,
+            error_backref,
+            error_brack,
+            error_paren,
+            error_brace,
+            error_badbrace,
+            error_range,
+            error_space,
+            error_badrepeat,
+            error_complexity,
+            error_stack
+        };
+    }
+
+    /**
+     * 30.6, class regex_error:
+     */
+
+    class regex_error: public runtime_error
+    {
+        public:
+            explicit regex_error(regex_constants::error_type ecode,
+                                 const char* what = "regex_error")
+                : runtime_error{what}, code_{ecode}
+            { /* DUMMY BODY */ }
+
+            regex_constants::error_type code() const
+            {
+                return code_;
+            }
+
+        private:
+            regex_constants::error_type code_;
+    };
+
+    /**
+     * 30.7, class template regex_traits:
+     */
+
+    template<class Char>
+    struct regex_traits
+    {
+        using char_type       = Char;
+        using string_type     = basic_string<Char>;
+        using locale_type     = int; // No locale support in the engine.
+        using char_class_type = uint16_t;
+
+        static size_t length(const char_type* p)
+        {
+            return char_traits<char_type>::length(p);
+        }
+
+        char_type translate(char_type c) const
+        {
+            return c;
+        }
+
+        char_type translate_nocase(char_type c) const
+        {
+            if (c >= static_cast<char_type>('A') && c <= static_cast<char_type>('Z'))
+                return static_cast<char_type>(c - static_cast<char_type>('A') + static_cast<char_type>('a'));
+            return c;
+        }
+
+        locale_type imbue(locale_type)
+        {
+            return locale_type{};
+        }
+
+        locale_type getloc() const
+        {
+            return locale_type{};
+        }
+    };
+
+    namespace aux
+    {
+        /**
+         * Compiled form: a Thompson NFA program. Instructions either
+         * consume one character (literal, any, cls), fork control flow
+         * (split, jmp), record a capture boundary (save) or test a
+         * zero-width condition. Split prefers x over y, which encodes
+         * greedy vs lazy quantifiers for the NFA simulation.
+         */
+
+        enum class rx_op : uint8_t
+        {
+            match,
+            literal,
+            any,
+            cls,
+            split,
+            jmp,
+            save,
+            line_begin,
+            line_end,
+            word_boundary,
+            nonword_boundary
+        };
+
+        struct rx_inst
+        {
+            rx_op op{};
+            char32_t literal{};
+            size_t x{};
+            size_t y{};
+        };
+
+        struct rx_class
+        {
+            vector<pair<char32_t, char32_t>> ranges;
+            bool negate{};
+
+            bool contains(char32_t c) const
+            {
+                bool in{};
+                for (const auto& r: ranges)
+                {
+                    if (r.first <= c && c <= r.second)
+                    {
+                        in = true;
+                        break;
+                    }
+                }
+
+                return in != negate;
+            }
+        };
+
+        constexpr size_t rx_no_target = static_cast<size_t>(-1);
+        constexpr size_t rx_infinite_repeat = static_cast<size_t>(-1);
+        constexpr size_t rx_max_insts = size_t{1} << 14;
+        constexpr size_t rx_max_repeat = 1024;
+
+        inline bool rx_is_word(char32_t c)
+        {
+            return (c >= U'0' && c <= U'9') || (c >= U'a' && c <= U'z') ||
+                   (c >= U'A' && c <= U'Z') || c == U'_';
+        }
+
+        /**
+         * Adds [lo, hi] to a class, and when folding case also the
+         * alphabetic counterparts of any letters the range covers.
+         */
+        inline void rx_add_range(vector<pair<char32_t, char32_t>>& ranges,
+                                 char32_t lo, char32_t hi, bool fold)
+        {
+            ranges.emplace_back(lo, hi);
+            if (!fold)
+                return;
+
+            auto l = lo < U'a' ? U'a' : lo;
+            auto h = hi > U'z' ? U'z' : hi;
+            if (l <= h)
+                ranges.emplace_back(l - 32, h - 32);
+
+            l = lo < U'A' ? U'A' : lo;
+            h = hi > U'Z' ? U'Z' : hi;
+            if (l <= h)
+                ranges.emplace_back(l + 32, h + 32);
+        }
+
+        inline void rx_add_class_escape(vector<pair<char32_t, char32_t>>& ranges, char32_t esc)
+        {
+            switch (esc)
+            {
+                case U'd':
+                    ranges.emplace_back(U'0', U'9');
+                    break;
+                case U'w':
+                    ranges.emplace_back(U'0', U'9');
+                    ranges.emplace_back(U'a', U'z');
+                    ranges.emplace_back(U'A', U'Z');
+                    ranges.emplace_back(U'_', U'_');
+                    break;
+                case U's':
+                    ranges.emplace_back(U'\t', U'\r'); // \t \n \v \f \r
+                    ranges.emplace_back(U' ', U' ');
+                    break;
+            }
+        }
+
+        /**
+         * Parse tree. Repetition is expanded at compile time, so the
+         * tree is the only place {n,m} exists.
+         */
+
+        enum class rx_node_type
+        {
+            empty,
+            literal,
+            any,
+            cls,
+            concat,
+            alternation,
+            repeat,
+            group,
+            line_begin,
+            line_end,
+            word_boundary,
+            nonword_boundary
+        };
+
+        struct rx_node
+        {
+            rx_node_type type{rx_node_type::empty};
+            char32_t literal{};
+            size_t cls{};
+            size_t group{}; // 1-based capture index, 0 for (?:...)
+            size_t min{};
+            size_t max{};
+            bool greedy{true};
+            vector<unique_ptr<rx_node>> children;
+        };
+
+        template<class Char>
+        class rx_parser
+        {
+            public:
+                rx_parser(const Char* first, const Char* last,
+                          regex_constants::syntax_option_type flags,
+                          vector<rx_class>& classes)
+                    : current_{first}, last_{last}, flags_{flags},
+                      classes_{classes}, groups_{}, assertions_{}
+                { /* DUMMY BODY */ }
+
+                unique_ptr<rx_node> parse()
+                {
+                    auto res = parse_alternation();
+                    if (!eof()) // A stray ')' is the only way to stop early.
+                        throw regex_error{regex_constants::error_paren,
+                                          "regex_error: unbalanced parenthesis"};
+
+                    return res;
+                }
+
+                size_t group_count() const
+                {
+                    return groups_;
+                }
+
+                bool has_assertions() const
+                {
+                    return assertions_;
+                }
+
+            private:
+                const Char* current_;
+                const Char* last_;
+                regex_constants::syntax_option_type flags_;
+                vector<rx_class>& classes_;
+                size_t groups_;
+                bool assertions_;
+
+                bool eof() const
+                {
+                    return current_ == last_;
+                }
+
+                char32_t peek() const
+                {
+                    return static_cast<char32_t>(
+                        static_cast<make_unsigned_t<Char>>(*current_));
+                }
+
+                char32_t get()
+                {
+                    auto c = peek();
+                    ++current_;
+
+                    return c;
+                }
+
+                bool icase() const
+                {
+                    return (flags_ & regex_constants::icase) != 0;
+                }
+
+                static unique_ptr<rx_node> make(rx_node_type type)
+                {
+                    auto res = make_unique<rx_node>();
+                    res->type = type;
+
+                    return res;
+                }
+
+                unique_ptr<rx_node> parse_alternation()
+                {
+                    auto first = parse_concat();
+                    if (eof() || peek() != U'|')
+                        return first;
+
+                    auto res = make(rx_node_type::alternation);
+                    res->children.push_back(move(first));
+                    while (!eof() && peek() == U'|')
+                    {
+                        get();
+                        res->children.push_back(parse_concat());
+                    }
+
+                    return res;
+                }
+
+                unique_ptr<rx_node> parse_concat()
+                {
+                    auto res = make(rx_node_type::concat);
+                    while (!eof() && peek() != U'|' && peek() != U')')
+                        res->children.push_back(parse_repeat());
+
+                    if (res->children.empty())
+                        return make(rx_node_type::empty);
+                    if (res->children.size() == 1U)
+                        return move(res->children[0]);
+
+                    return res;
+                }
+
+                unique_ptr<rx_node> parse_repeat()
+                {
+                    auto atom = parse_atom();
+                    if (eof())
+                        return atom;
+
+                    size_t min{}, max{};
+                    auto c = peek();
+                    if (c == U'*')
+                    {
+                        get();
+                        min = 0;
+                        max = rx_infinite_repeat;
+                    }
+                    else if (c == U'+')
+                    {
+                        get();
+                        min = 1;
+                        max = rx_infinite_repeat;
+                    }
+                    else if (c == U'?')
+                    {
+                        get();
+                        min = 0;
+                        max = 1;
+                    }
+                    else if (c == U'{' && is_counted_repeat())
+                        parse_counts(min, max);
+                    else
+                        return atom;
+
+                    if (!repeatable(*atom))
+                        throw regex_error{regex_constants::error_badrepeat,
+                                          "regex_error: nothing to repeat"};
+
+                    auto res = make(rx_node_type::repeat);
+                    res->min = min;
+                    res->max = max;
+                    if (!eof() && peek() == U'?')
+                    {
+                        get();
+                        res->greedy = false;
+                    }
+                    res->children.push_back(move(atom));
+
+                    return res;
+                }
+
+                static bool repeatable(const rx_node& node)
+                {
+                    switch (node.type)
+                    {
+                        case rx_node_type::empty:
+                        case rx_node_type::repeat:
+                        case rx_node_type::line_begin:
+                        case rx_node_type::line_end:
+                        case rx_node_type::word_boundary:
+                        case rx_node_type::nonword_boundary:
+                            return false;
+                        default:
+                            return true;
+                    }
+                }
+
+                /**
+                 * ECMAScript treats '{' that does not open a valid
+                 * counted repetition as a literal brace.
+                 */
+                bool is_counted_repeat() const
+                {
+                    auto it = current_ + 1;
+                    if (it == last_ || *it < static_cast<Char>('0') ||
+                        *it > static_cast<Char>('9'))
+                        return false;
+
+                    while (it != last_ && *it >= static_cast<Char>('0') &&
+                           *it <= static_cast<Char>('9'))
+                        ++it;
+                    if (it != last_ && *it == static_cast<Char>(','))
+                    {
+                        ++it;
+                        while (it != last_ && *it >= static_cast<Char>('0') &&
+                               *it <= static_cast<Char>('9'))
+                            ++it;
+                    }
+
+                    return it != last_ && *it == static_cast<Char>('}');
+                }
+
+                void parse_counts(size_t& min, size_t& max)
+                {
+                    get(); // '{'
+                    min = parse_number();
+                    if (peek() == U',')
+                    {
+                        get();
+                        if (peek() == U'}')
+                            max = rx_infinite_repeat;
+                        else
+                            max = parse_number();
+                    }
+                    else
+                        max = min;
+                    get(); // '}', guaranteed by is_counted_repeat()
+
+                    if (max != rx_infinite_repeat && max < min)
+                        throw regex_error{regex_constants::error_badbrace,
+                                          "regex_error: invalid repetition counts"};
+                    if (min > rx_max_repeat ||
+                        (max != rx_infinite_repeat && max > rx_max_repeat))
+                        throw regex_error{regex_constants::error_complexity,
+                                          "regex_error: repetition count too large"};
+                }
+
+                size_t parse_number()
+                {
+                    size_t res{};
+                    while (!eof() && peek() >= U'0' && peek() <= U'9')
+                    {
+                        res = res * 10 + (get() - U'0');
+                        if (res > rx_max_repeat)
+                            throw regex_error{regex_constants::error_complexity,
+                                              "regex_error: repetition count too large"};
+                    }
+
+                    return res;
+                }
+
+                unique_ptr<rx_node> parse_atom()
+                {
+                    auto c = get();
+                    switch (c)
+                    {
+                        case U'.':
+                            return make(rx_node_type::any);
+                        case U'^':
+                            assertions_ = true;
+                            return make(rx_node_type::line_begin);
+                        case U'$':
+                            assertions_ = true;
+                            return make(rx_node_type::line_end);
+                        case U'(':
+                            return parse_group();
+                        case U'[':
+                            return parse_class();
+                        case U'\\':
+                            return parse_escape();
+                        case U'*':
+                        case U'+':
+                        case U'?':
+                            throw regex_error{regex_constants::error_badrepeat,
+                                              "regex_error: nothing to repeat"};
+                        default:
+                            return make_literal(c);
+                    }
+                }
+
+                unique_ptr<rx_node> make_literal(char32_t c)
+                {
+                    if (icase() && ((c >= U'a' && c <= U'z') || (c >= U'A' && c <= U'Z')))
+                    {
+                        rx_class cls{};
+                        rx_add_range(cls.ranges, c, c, true);
+
+                        auto res = make(rx_node_type::cls);
+                        res->cls = classes_.size();
+                        classes_.push_back(move(cls));
+
+                        return res;
+                    }
+
+                    auto res = make(rx_node_type::literal);
+                    res->literal = c;
+
+                    return res;
+                }
+
+                unique_ptr<rx_node> parse_group()
+                {
+                    size_t idx{};
+                    if (!eof() && peek() == U'?')
+                    {
+                        get();
+                        if (eof())
+                            throw regex_error{regex_constants::error_paren,
+                                              "regex_error: unterminated group"};
+                        auto kind = get();
+                        if (kind != U':')
+                            throw regex_error{regex_constants::error_paren,
+                                              "regex_error: lookaround is not supported"};
+                    }
+                    else if ((flags_ & regex_constants::nosubs) == 0)
+                        idx = ++groups_;
+
+                    auto body = parse_alternation();
+                    if (eof() || get() != U')')
+                        throw regex_error{regex_constants::error_paren,
+                                          "regex_error: unterminated group"};
+
+                    auto res = make(rx_node_type::group);
+                    res->group = idx;
+                    res->children.push_back(move(body));
+
+                    return res;
+                }
+
+                unique_ptr<rx_node> parse_escape()
+                {
+                    if (eof())
+                        throw regex_error{regex_constants::error_escape,
+                                          "regex_error: trailing backslash"};
+
+                    auto c = get();
+                    switch (c)
+                    {
+                        case U'b':
+                            assertions_ = true;
+                            return make(rx_node_type::word_boundary);
+                        case U'B':
+                            assertions_ = true;
+                            return make(rx_node_type::nonword_boundary);
+                        case U'd':
+                        case U'w':
+                        case U's':
+                        case U'D':
+                        case U'W':
+                        case U'S':
+                        {
+                            rx_class cls{};
+                            rx_add_class_escape(cls.ranges,
+                                                c < U'a' ? c + 32 : c);
+                            cls.negate = c < U'a';
+
+                            auto res = make(rx_node_type::cls);
+                            res->cls = classes_.size();
+                            classes_.push_back(move(cls));
+
+                            return res;
+                        }
+                        default:
+                            return make_literal(escape_value(c));
+                    }
+                }
+
+                char32_t escape_value(char32_t c)
+                {
+                    switch (c)
+                    {
+                        case U'n':
+                            return U'\n';
+                        case U't':
+                            return U'\t';
+                        case U'r':
+                            return U'\r';
+                        case U'f':
+                            return U'\f';
+                        case U'v':
+                            return U'\v';
+                        case U'0':
+                            return U'\0';
+                        case U'x':
+                            return parse_hex(2);
+                        case U'u':
+                            return parse_hex(4);
+                        default:
+                            if (c >= U'1' && c <= U'9')
+                                throw regex_error{regex_constants::error_backref,
+                                                  "regex_error: backreferences are not supported"};
+                            return c;
+                    }
+                }
+
+                char32_t parse_hex(size_t digits)
+                {
+                    char32_t res{};
+                    for (size_t i = 0; i < digits; ++i)
+                    {
+                        if (eof())
+                            throw regex_error{regex_constants::error_escape,
+                                              "regex_error: invalid hexadecimal escape"};
+                        auto c = get();
+                        if (c >= U'0' && c <= U'9')
+                            res = res * 16 + (c - U'0');
+                        else if (c >= U'a' && c <= U'f')
+                            res = res * 16 + (c - U'a' + 10);
+                        else if (c >= U'A' && c <= U'F')
+                            res = res * 16 + (c - U'A' + 10);
+                        else
+                            throw regex_error{regex_constants::error_escape,
+                                              "regex_error: invalid hexadecimal escape"};
+                    }
+
+                    return res;
+                }
+
+                unique_ptr<rx_node> parse_class()
+                {
+                    rx_class cls{};
+                    if (!eof() && peek() == U'^')
+                    {
+                        get();
+                        cls.negate = true;
+                    }
+
+                    bool first{true};
+                    while (true)
+                    {
+                        if (eof())
+                            throw regex_error{regex_constants::error_brack,
+                                              "regex_error: unterminated bracket expression"};
+                        auto c = get();
+                        if (c == U']' && !first)
+                            break;
+                        first = false;
+
+                        bool was_escape_class{};
+                        char32_t lo = class_char(cls, c, was_escape_class);
+                        if (was_escape_class)
+                            continue;
+
+                        if (!eof() && peek() == U'-')
+                        {
+                            auto save = current_;
+                            get();
+                            if (!eof() && peek() != U']')
+                            {
+                                auto hi_raw = get();
+                                bool hi_class{};
+                                char32_t hi = class_char(cls, hi_raw, hi_class);
+                                if (hi_class || hi < lo)
+                                    throw regex_error{regex_constants::error_range,
+                                                      "regex_error: invalid character range"};
+                                rx_add_range(cls.ranges, lo, hi, icase());
+                                continue;
+                            }
+                            current_ = save; // trailing '-' is a literal
+                        }
+                        rx_add_range(cls.ranges, lo, lo, icase());
+                    }
+
+                    auto res = make(rx_node_type::cls);
+                    res->cls = classes_.size();
+                    classes_.push_back(move(cls));
+
+                    return res;
+                }
+
+                /**
+                 * Reads one bracket expression member. If it is a class
+                 * escape (\d etc.), its ranges are merged into the class
+                 * being parsed and is_class is set.
+                 */
+                char32_t class_char(rx_class& cls, char32_t c, bool& is_class)
+                {
+                    is_class = false;
+                    if (c != U'\\')
+                        return c;
+                    if (eof())
+                        throw regex_error{regex_constants::error_escape,
+                                          "regex_error: trailing backslash"};
+
+                    auto esc = get();
+                    switch (esc)
+                    {
+                        case U'd':
+                        case U'w':
+                        case U's':
+                            is_class = true;
+                            rx_add_class_escape(cls.ranges, esc);
+                            return 0;
+                        case U'D':
+                        case U'W':
+                        case U'S':
+                            throw regex_error{regex_constants::error_brack,
+                                              "regex_error: negated class escape in bracket expression"};
+                        case U'b':
+                            return U'\b';
+                        default:
+                            return escape_value(esc);
+                    }
+                }
+        };
+
+        /**
+         * The compiled pattern shared between copies of a basic_regex
+         * and between cache hits. The DFA caches hang off it lazily,
+         * guarded by a lock so a pattern may be used from several
+         * fibrils at once.
+         */
+
+        class rx_dfa;
+
+        template<class Char>
+        struct rx_program
+        {
+            vector<rx_inst> insts;
+            vector<rx_class> classes;
+            size_t groups{};
+            bool has_assertions{};
+            regex_constants::syntax_option_type flags{};
+
+            mutex dfa_lock;
+            unique_ptr<rx_dfa> dfa_search;
+            unique_ptr<rx_dfa> dfa_match;
+        };
+
+        template<class Char>
+        class rx_compiler
+        {
+            public:
+                explicit rx_compiler(rx_program<Char>& program)
+                    : program_{program}
+                { /* DUMMY BODY */ }
+
+                void compile(const rx_node& root)
+                {
+                    emit_node(root);
+                    emit(rx_op::match);
+                }
+
+            private:
+                rx_program<Char>& program_;
+
+                size_t emit(rx_op op, char32_t literal = 0,
+                            size_t x = rx_no_target, size_t y = rx_no_target)
+                {
+                    if (program_.insts.size() >= rx_max_insts)
+                        throw regex_error{regex_constants::error_complexity,
+                                          "regex_error: pattern too large"};
+                    program_.insts.push_back(rx_inst{op, literal, x, y});
+
+                    return program_.insts.size() - 1;
+                }
+
+                size_t here() const
+                {
+                    return program_.insts.size();
+                }
+
+                void patch_x(size_t idx, size_t target)
+                {
+                    program_.insts[idx].x = target;
+                }
+
+                void patch_y(size_t idx, size_t target)
+                {
+                    program_.insts[idx].y = target;
+                }
+
+                void emit_node(const rx_node& node)
+                {
+                    switch (node.type)
+                    {
+                        case rx_node_type::empty:
+                            break;
+                        case rx_node_type::literal:
+                            emit(rx_op::literal, node.literal);
+                            break;
+                        case rx_node_type::any:
+                            emit(rx_op::any);
+                            break;
+                        case rx_node_type::cls:
+                            emit(rx_op::cls, 0, node.cls);
+                            break;
+                        case rx_node_type::line_begin:
+                            emit(rx_op::line_begin);
+                            break;
+                        case rx_node_type::line_end:
+                            emit(rx_op::line_end);
+                            break;
+                        case rx_node_type::word_boundary:
+                            emit(rx_op::word_boundary);
+                            break;
+                        case rx_node_type::nonword_boundary:
+                            emit(rx_op::nonword_boundary);
+                            break;
+                        case rx_node_type::concat:
+                            for (const auto& child: node.children)
+                                emit_node(*child);
+                            break;
+                        case rx_node_type::group:
+                            if (node.group != 0)
+                            {
+                                emit(rx_op::save, 0, 2 * node.group);
+                                emit_node(*node.children[0]);
+                                emit(rx_op::save, 0, 2 * node.group + 1);
+                            }
+                            else
+                                emit_node(*node.children[0]);
+                            break;
+                        case rx_node_type::alternation:
+                            emit_alternation(node);
+                            break;
+                        case rx_node_type::repeat:
+                            emit_repeat(node);
+                            break;
+                    }
+                }
+
+                void emit_alternation(const rx_node& node)
+                {
+                    vector<size_t> jumps;
+                    size_t last_split{rx_no_target};
+
+                    for (size_t i = 0; i < node.children.size(); ++i)
+                    {
+                        if (i + 1 < node.children.size())
+                        {
+                            auto split = emit(rx_op::split);
+                            patch_x(split, here());
+                            last_split = split;
+                        }
+
+                        emit_node(*node.children[i]);
+
+                        if (i + 1 < node.children.size())
+                        {
+                            jumps.push_back(emit(rx_op::jmp));
+                            patch_y(last_split, here());
+                        }
+                    }
+
+                    for (auto j: jumps)
+                        patch_x(j, here());
+                }
+
+                void emit_repeat(const rx_node& node)
+                {
+                    const auto& body = *node.children[0];
+                    auto min = node.min;
+                    auto max = node.max;
+
+                    for (size_t i = 0; i < min; ++i)
+                    {
+                        if (max == rx_infinite_repeat && i + 1 == min)
+                        {
+                            // x{n,} tail: loop the last mandatory copy.
+                            auto start = here();
+                            emit_node(body);
+                            auto split = emit(rx_op::split);
+                            if (node.greedy)
+                            {
+                                patch_x(split, start);
+                                patch_y(split, here());
+                            }
+                            else
+                            {
+                                patch_x(split, here());
+                                patch_y(split, start);
+                            }
+                            return;
+                        }
+                        emit_node(body);
+                    }
+
+                    if (max == rx_infinite_repeat)
+                    {
+                        // x* : split over the body with a back edge.
+                        auto split = emit(rx_op::split);
+                        auto start = here();
+                        emit_node(body);
+                        auto back = emit(rx_op::split);
+                        if (node.greedy)
+                        {
+                            patch_x(split, start);
+                            patch_x(back, start);
+                            patch_y(split, here());
+                            patch_y(back, here());
+                        }
+                        else
+                        {
+                            patch_y(split, start);
+                            patch_y(back, start);
+                            patch_x(split, here());
+                            patch_x(back, here());
+                        }
+                        return;
+                    }
+
+                    // x{n,m}: m - n optional copies, all bailing to the end.
+                    vector<size_t> splits;
+                    for (size_t i = min; i < max; ++i)
+                    {
+                        auto split = emit(rx_op::split);
+                        if (node.greedy)
+                            patch_x(split, here());
+                        else
+                            patch_y(split, here());
+                        splits.push_back(split);
+                        emit_node(body);
+                    }
+                    for (auto split: splits)
+                    {
+                        if (node.greedy)
+                            patch_y(split, here());
+                        else
+                            patch_x(split, here());
+                    }
+                }
+        };
+
+        /**
+         * Lazily built DFA over the NFA program, byte-wide, so it is
+         * only used for narrow character patterns without zero-width
+         * assertions. Each DFA state is a canonicalized epsilon
+         * closure of NFA states; transitions are filled in on first
+         * use and memoized, so the hot loop of a scan is a single
+         * table walk per input byte. The state budget bounds memory;
+         * a pattern that blows it falls back to the NFA simulation.
+         */
+
+        class rx_dfa
+        {
+            public:
+                static constexpr int scan_no_match = 0;
+                static constexpr int scan_match = 1;
+                static constexpr int scan_gave_up = 2;
+
+                rx_dfa(const vector<rx_inst>& insts,
+                       const vector<rx_class>& classes, bool anchored)
+                    : insts_{insts}, anchored_{anchored}, gave_up_{}
+                {
+                    bitmaps_.resize(classes.size());
+                    for (size_t i = 0; i < classes.size(); ++i)
+                    {
+                        for (size_t c = 0; c < 256; ++c)
+                        {
+                            if (classes[i].contains(static_cast<char32_t>(c)))
+                                bitmaps_[i][c >> 5] |= uint32_t{1} << (c & 31);
+                        }
+                    }
+
+                    start_closure_ = closure(vector<size_t>{0U});
+                    start_ = intern(start_closure_);
+                }
+
+                /**
+                 * Scans [first, last) and reports whether any match
+                 * ends inside it, leaving the earliest such end offset
+                 * in end. With require_end only a match ending exactly
+                 * at last counts (the regex_match prefilter).
+                 */
+                template<class Iter>
+                int scan(Iter first, Iter last, bool require_end, size_t& end)
+                {
+                    if (gave_up_)
+                        return scan_gave_up;
+
+                    size_t cur = start_;
+                    size_t pos{};
+                    auto it = first;
+
+                    while (true)
+                    {
+                        if (accepting_[cur] && (!require_end || it == last))
+                        {
+                            end = pos;
+                            return scan_match;
+                        }
+                        if (it == last)
+                            return scan_no_match;
+
+                        auto c = static_cast<unsigned char>(*it);
+                        auto next = next_[cur * 256 + c];
+                        if (next == unbuilt_)
+                        {
+                            next = build_transition(cur, c);
+                            if (gave_up_)
+                                return scan_gave_up;
+                        }
+                        if (next == dead_)
+                            return scan_no_match;
+
+                        cur = static_cast<size_t>(next);
+                        ++it;
+                        ++pos;
+
+                        // Hot loop: one table walk per byte for as long
+                        // as every transition is already built and no
+                        // accepting state is entered.
+                        while (it != last && !accepting_[cur])
+                        {
+                            next = next_[cur * 256 + static_cast<unsigned char>(*it)];
+                            if (next < 0)
+                                break;
+
+                            cur = static_cast<size_t>(next);
+                            ++it;
+                            ++pos;
+                        }
+                    }
+                }
+
+            private:
+                static constexpr int32_t unbuilt_ = -1;
+                static constexpr int32_t dead_ = -2;
+
+                const vector<rx_inst>& insts_;
+
+                struct bitmap
+                {
+                    uint32_t words[8]{};
+
+                    uint32_t& operator[](size_t idx)
+                    {
+                        return words[idx];
+                    }
+
+                    bool test(unsigned char c) const
+                    {
+                        return (words[c >> 5] >> (c & 31)) & 1U;
+                    }
+                };
+
+                vector<bitmap> bitmaps_;
+                vector<vector<size_t>> pcs_;
+                vector<int32_t> next_; // max_states_ x 256, flattened
+                vector<uint8_t> accepting_;
+                unordered_map<string, size_t> index_;
+                vector<size_t> start_closure_;
+                size_t start_;
+                bool anchored_;
+                bool gave_up_;
+
+                static constexpr size_t max_states_ = 2048;
+
+                vector<size_t> closure(vector<size_t> set) const
+                {
+                    vector<bool> seen(insts_.size(), false);
+                    vector<size_t> stack{move(set)};
+                    vector<size_t> res;
+
+                    while (!stack.empty())
+                    {
+                        auto pc = stack.back();
+                        stack.pop_back();
+                        if (seen[pc])
+                            continue;
+                        seen[pc] = true;
+
+                        const auto& inst = insts_[pc];
+                        switch (inst.op)
+                        {
+                            case rx_op::jmp:
+                                stack.push_back(inst.x);
+                                break;
+                            case rx_op::split:
+                                stack.push_back(inst.x);
+                                stack.push_back(inst.y);
+                                break;
+                            case rx_op::save:
+                                stack.push_back(pc + 1);
+                                break;
+                            default:
+                                res.push_back(pc);
+                                break;
+                        }
+                    }
+
+                    sort(res.begin(), res.end());
+
+                    return res;
+                }
+
+                static void sort(typename vector<size_t>::iterator first,
+                                 typename vector<size_t>::iterator last)
+                {
+                    // Insertion sort: closures are small and mostly ordered.
+                    for (auto it = first; it != last; ++it)
+                    {
+                        auto val = *it;
+                        auto pos = it;
+                        while (pos != first && *(pos - 1) > val)
+                        {
+                            *pos = *(pos - 1);
+                            --pos;
+                        }
+                        *pos = val;
+                    }
+                }
+
+                size_t intern(const vector<size_t>& pcs)
+                {
+                    string key(reinterpret_cast<const char*>(pcs.data()),
+                               pcs.size() * sizeof(size_t));
+                    auto it = index_.find(key);
+                    if (it != index_.end())
+                        return it->second;
+
+                    if (pcs_.size() >= max_states_)
+                    {
+                        gave_up_ = true;
+                        return 0;
+                    }
+
+                    bool accept{};
+                    for (auto pc: pcs)
+                    {
+                        if (insts_[pc].op == rx_op::match)
+                        {
+                            accept = true;
+                            break;
+                        }
+                    }
+
+                    pcs_.push_back(pcs);
+                    next_.insert(next_.end(), 256, unbuilt_);
+                    accepting_.push_back(accept);
+                    index_.emplace(move(key), pcs_.size() - 1);
+
+                    return pcs_.size() - 1;
+                }
+
+                int32_t build_transition(size_t state, unsigned char c)
+                {
+                    vector<size_t> moved;
+                    for (auto pc: pcs_[state])
+                    {
+                        const auto& inst = insts_[pc];
+                        switch (inst.op)
+                        {
+                            case rx_op::literal:
+                                if (inst.literal == static_cast<char32_t>(c))
+                                    moved.push_back(pc + 1);
+                                break;
+                            case rx_op::any:
+                                if (c != '\n')
+                                    moved.push_back(pc + 1);
+                                break;
+                            case rx_op::cls:
+                                if (bitmaps_[inst.x].test(c))
+                                    moved.push_back(pc + 1);
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+
+                    auto res = closure(move(moved));
+                    if (!anchored_)
+                    {
+                        // Unanchored scan: a new match attempt may begin
+                        // at every position, so fold the start closure in.
+                        res.insert(res.end(), start_closure_.begin(),
+                                   start_closure_.end());
+                        sort(res.begin(), res.end());
+                        res.erase(unique(res.begin(), res.end()), res.end());
+                    }
+
+                    int32_t target;
+                    if (res.empty())
+                        target = dead_;
+                    else
+                    {
+                        auto idx = intern(res);
+                        if (gave_up_)
+                            return dead_;
+                        target = static_cast<int32_t>(idx);
+                    }
+
+                    next_[state * 256 + c] = target;
+
+                    return target;
+                }
+
+                static typename vector<size_t>::iterator
+                unique(typename vector<size_t>::iterator first,
+                       typename vector<size_t>::iterator last)
+                {
+                    if (first == last)
+                        return last;
+
+                    auto result = first;
+                    while (++first != last)
+                    {
+                        if (*result != *first)
+                            *++result = *first;
+                    }
+
+                    return ++result;
+                }
+        };
+
+        /**
+         * Pike-style NFA simulation: runs all NFA threads in lock step
+         * over the input, carrying capture slots per thread. Threads
+         * are kept in priority order, which yields the leftmost-first
+         * (ECMAScript) match without backtracking, in O(input x
+         * program) worst case.
+         */
+
+        template<class Char, class Iter>
+        class rx_vm
+        {
+            public:
+                rx_vm(const rx_program<Char>& program, Iter first, Iter last)
+                    : program_{program}, first_{first}, last_{last},
+                      visited_(program.insts.size(), 0U), generation_{}
+                { /* DUMMY BODY */ }
+
+                bool run(bool anchored, bool require_end,
+                         regex_constants::match_flag_type mf,
+                         vector<ptrdiff_t>& caps_out)
+                {
+                    const auto slots = 2 * (program_.groups + 1);
+                    vector<thread> clist, nlist;
+                    vector<ptrdiff_t> best;
+                    bool matched{};
+
+                    auto it = first_;
+                    ptrdiff_t pos{};
+                    bool at_end = it == last_;
+                    char32_t cur = at_end ? 0 : to_char32(*it);
+                    bool have_prev{};
+                    char32_t prev{};
+
+                    multiline_ = (program_.flags & regex_constants::multiline) != 0;
+                    mf_ = mf;
+
+                    while (true)
+                    {
+                        ++generation_;
+
+                        if (!matched && (pos == 0 || !anchored))
+                        {
+                            vector<ptrdiff_t> caps(slots, -1);
+                            caps[0] = pos;
+                            add_thread(clist, 0, pos, move(caps),
+                                       have_prev, prev, at_end, cur);
+                        }
+
+                        bool have_next{};
+                        char32_t next_ch{};
+                        if (!at_end)
+                        {
+                            auto it2 = it;
+                            ++it2;
+                            if (it2 != last_)
+                            {
+                                have_next = true;
+                                next_ch = to_char32(*it2);
+                            }
+                        }
+
+                        ++generation_;
+                        for (size_t i = 0; i < clist.size(); ++i)
+                        {
+                            auto& t = clist[i];
+                            const auto& inst = program_.insts[t.pc];
+
+                            switch (inst.op)
+                            {
+                                case rx_op::match:
+                                    if (require_end && !at_end)
+                                        break;
+                                    if ((mf & regex_constants::match_not_null) &&
+                                        t.caps[0] == pos)
+                                        break;
+                                    t.caps[1] = pos;
+                                    best = t.caps;
+                                    matched = true;
+                                    // Lower-priority threads can no longer
+                                    // produce a better match.
+                                    i = clist.size();
+                                    break;
+                                case rx_op::literal:
+                                    if (!at_end && cur == inst.literal)
+                                        add_thread(nlist, t.pc + 1, pos + 1,
+                                                   vector<ptrdiff_t>{t.caps},
+                                                   true, cur, !have_next, next_ch);
+                                    break;
+                                case rx_op::any:
+                                    if (!at_end && cur != U'\n')
+                                        add_thread(nlist, t.pc + 1, pos + 1,
+                                                   vector<ptrdiff_t>{t.caps},
+                                                   true, cur, !have_next, next_ch);
+                                    break;
+                                case rx_op::cls:
+                                    if (!at_end && program_.classes[inst.x].contains(cur))
+                                        add_thread(nlist, t.pc + 1, pos + 1,
+                                                   vector<ptrdiff_t>{t.caps},
+                                                   true, cur, !have_next, next_ch);
+                                    break;
+                                default:
+                                    break; // Epsilon ops resolved by add_thread.
+                            }
+                        }
+
+                        if (at_end)
+                            break;
+                        if (nlist.empty() && (matched || anchored))
+                            break;
+
+                        clist.swap(nlist);
+                        nlist.clear();
+
+                        have_prev = true;
+                        prev = cur;
+                        ++it;
+                        ++pos;
+                        at_end = it == last_;
+                        cur = at_end ? 0 : to_char32(*it);
+                    }
+
+                    if (matched)
+                        caps_out = move(best);
+
+                    return matched;
+                }
+
+            private:
+                struct thread
+                {
+                    size_t pc;
+                    vector<ptrdiff_t> caps;
+                };
+
+                const rx_program<Char>& program_;
+                Iter first_;
+                Iter last_;
+                vector<size_t> visited_;
+                size_t generation_;
+                bool multiline_{};
+                regex_constants::match_flag_type mf_{};
+
+                static char32_t to_char32(Char c)
+                {
+                    return static_cast<char32_t>(
+                        static_cast<make_unsigned_t<Char>>(c));
+                }
+
+                void add_thread(vector<thread>& list, size_t pc, ptrdiff_t pos,
+                                vector<ptrdiff_t> caps, bool have_prev,
+                                char32_t prev, bool at_end, char32_t cur)
+                {
+                    if (visited_[pc] == generation_)
+                        return;
+                    visited_[pc] = generation_;
+
+                    const auto& inst = program_.insts[pc];
+                    switch (inst.op)
+                    {
+                        case rx_op::jmp:
+                            add_thread(list, inst.x, pos, move(caps),
+                                       have_prev, prev, at_end, cur);
+                            break;
+                        case rx_op::split:
+                            add_thread(list, inst.x, pos, vector<ptrdiff_t>{caps},
+                                       have_prev, prev, at_end, cur);
+                            add_thread(list, inst.y, pos, move(caps),
+                                       have_prev, prev, at_end, cur);
+                            break;
+                        case rx_op::save:
+                            if (inst.x < caps.size())
+                                caps[inst.x] = pos;
+                            add_thread(list, pc + 1, pos, move(caps),
+                                       have_prev, prev, at_end, cur);
+                            break;
+                        case rx_op::line_begin:
+                            if (test_line_begin(pos, have_prev, prev))
+                                add_thread(list, pc + 1, pos, move(caps),
+                                           have_prev, prev, at_end, cur);
+                            break;
+                        case rx_op::line_end:
+                            if (test_line_end(at_end, cur))
+                                add_thread(list, pc + 1, pos, move(caps),
+                                           have_prev, prev, at_end, cur);
+                            break;
+                        case rx_op::word_boundary:
+                            if (test_word_boundary(have_prev, prev, at_end, cur))
+                                add_thread(list, pc + 1, pos, move(caps),
+                                           have_prev, prev, at_end, cur);
+                            break;
+                        case rx_op::nonword_boundary:
+                            if (!test_word_boundary(have_prev, prev, at_end, cur))
+                                add_thread(list, pc + 1, pos, move(caps),
+                                           have_prev, prev, at_end, cur);
+                            break;
+                        default:
+                            list.push_back(thread{pc, move(caps)});
+                            break;
+                    }
+                }
+
+                bool test_line_begin(ptrdiff_t pos, bool have_prev, char32_t prev) const
+                {
+                    if (pos == 0 && !have_prev)
+                        return (mf_ & regex_constants::match_not_bol) == 0;
+
+                    return multiline_ && have_prev && prev == U'\n';
+                }
+
+                bool test_line_end(bool at_end, char32_t cur) const
+                {
+                    if (at_end)
+                        return (mf_ & regex_constants::match_not_eol) == 0;
+
+                    return multiline_ && cur == U'\n';
+                }
+
+                static bool test_word_boundary(bool have_prev, char32_t prev,
+                                               bool at_end, char32_t cur)
+                {
+                    bool before = have_prev && rx_is_word(prev);
+                    bool after = !at_end && rx_is_word(cur);
+
+                    return before != after;
+                }
+        };
+
+        template<class Char>
+        shared_ptr<rx_program<Char>> rx_compile(const basic_string<Char>& pattern,
+                                                regex_constants::syntax_option_type flags)
+        {
+            auto program = make_shared<rx_program<Char>>();
+            program->flags = flags;
+
+            rx_parser<Char> parser{pattern.data(), pattern.data() + pattern.size(),
+                                   flags, program->classes};
+            auto root = parser.parse();
+
+            program->groups = parser.group_count();
+            program->has_assertions = parser.has_assertions();
+
+            rx_compiler<Char> compiler{*program};
+            compiler.compile(*root);
+
+            return program;
+        }
+
+        /**
+         * Process-wide LRU cache of compiled patterns, keyed by the
+         * pattern text and syntax flags. A handful of entries is
+         * enough for the intended use case (the same few patterns
+         * applied over and over); a linear scan over that handful
+         * is cheaper than hashing the pattern would be.
+         */
+        template<class Char>
+        shared_ptr<rx_program<Char>> rx_cache_fetch(const basic_string<Char>& pattern,
+                                                    regex_constants::syntax_option_type flags)
+        {
+            struct entry
+            {
+                basic_string<Char> pattern;
+                regex_constants::syntax_option_type flags;
+                shared_ptr<rx_program<Char>> program;
+            };
+
+            static constexpr size_t capacity = 16;
+            static mutex lock{};
+            static vector<entry> entries{};
+
+            {
+                lock_guard<mutex> guard{lock};
+                for (size_t i = 0; i < entries.size(); ++i)
+                {
+                    if (entries[i].flags == flags && entries[i].pattern == pattern)
+                    {
+                        auto res = entries[i].program;
+                        // Move the hit to the front (most recent).
+                        for (size_t j = i; j > 0; --j)
+                            std::swap(entries[j], entries[j - 1]);
+
+                        return res;
+                    }
+                }
+            }
+
+            // Compile outside the lock; failures are not cached.
+            auto program = rx_compile(pattern, flags);
+
+            lock_guard<mutex> guard{lock};
+            if (entries.size() >= capacity)
+                entries.pop_back();
+            entries.insert(entries.begin(), entry{pattern, flags, program});
+
+            return program;
+        }
+
+        /**
+         * Runs the DFA prefilter when the pattern qualifies for it.
+         * Returns one of the rx_dfa scan results; scan_gave_up also
+         * stands for "not applicable" and sends the caller to the
+         * NFA simulation.
+         */
+        template<class Char, class Iter>
+        int rx_prefilter(rx_program<Char>& program, Iter first, Iter last,
+                         bool anchored, bool require_end)
+        {
+            if constexpr (sizeof(Char) == 1)
+            {
+                if (program.has_assertions)
+                    return rx_dfa::scan_gave_up;
+
+                lock_guard<mutex> guard{program.dfa_lock};
+                auto& dfa = anchored ? program.dfa_match : program.dfa_search;
+                if (!dfa)
+                    dfa = make_unique<rx_dfa>(program.insts, program.classes,
+                                              anchored);
+
+                size_t end{};
+                return dfa->scan(first, last, require_end, end);
+            }
+            else
+            {
+                (void) program;
+                (void) first;
+                (void) last;
+                (void) anchored;
+                (void) require_end;
+
+                return rx_dfa::scan_gave_up;
+            }
+        }
+    }
+
+    /**
+     * 30.8, class template basic_regex:
+     */
+
+    template<class Char, class Traits = regex_traits<Char>>
+    class basic_regex
+    {
+        public:
+            using value_type  = Char;
+            using traits_type = Traits;
+            using string_type = typename Traits::string_type;
+            using locale_type = typename Traits::locale_type;
+            using flag_type   = regex_constants::syntax_option_type;
+
+            static constexpr flag_type icase      = regex_constants::icase;
+            static constexpr flag_type nosubs     = regex_constants::nosubs;
+            static constexpr flag_type optimize   = regex_constants::optimize;
+            static constexpr flag_type collate    = regex_constants::collate;
+            static constexpr flag_type ECMAScript = regex_constants::ECMAScript;
+            static constexpr flag_type basic      = regex_constants::basic;
+            static constexpr flag_type extended   = regex_constants::extended;
+            static constexpr flag_type awk        = regex_constants::awk;
+            static constexpr flag_type grep       = regex_constants::grep;
+            static constexpr flag_type egrep      = regex_constants::egrep;
+            static constexpr flag_type multiline  = regex_constants::multiline;
+
+            basic_regex()
+                : program_{}, flags_{ECMAScript}
+            { /* DUMMY BODY */ }
+
+            explicit basic_regex(const Char* p, flag_type f = ECMAScript)
+                : basic_regex{string_type{p}, f}
+            { /* DUMMY BODY */ }
+
+            basic_regex(const Char* p, size_t len, flag_type f = ECMAScript)
+                : basic_regex{string_type{p, len}, f}
+            { /* DUMMY BODY */ }
+
+            basic_regex(const basic_regex&) = default;
+            basic_regex(basic_regex&&) noexcept = default;
+
+            template<class Alloc>
+            explicit basic_regex(const basic_string<Char, char_traits<Char>, Alloc>& str,
+                                 flag_type f = ECMAScript)
+                : program_{aux::rx_cache_fetch(string_type{str.data(), str.size()}, f)},
+                  flags_{f}
+            { /* DUMMY BODY */ }
+
+            template<class InputIterator>
+            basic_regex(InputIterator first, InputIterator last,
+                        flag_type f = ECMAScript)
+                : basic_regex{string_type{first, last}, f}
+            { /* DUMMY BODY */ }
+
+            basic_regex(initializer_list<Char> init, flag_type f = ECMAScript)
+                : basic_regex{string_type{init.begin(), init.end()}, f}
+            { /* DUMMY BODY */ }
+
+            ~basic_regex() = default;
+
+            basic_regex& operator=(const basic_regex&) = default;
+            basic_regex& operator=(basic_regex&&) noexcept = default;
+
+            basic_regex& operator=(const Char* p)
+            {
+                return assign(p);
+            }
+
+            basic_regex& operator=(initializer_list<Char> init)
+            {
+                return assign(init);
+            }
+
+            template<class Alloc>
+            basic_regex& operator=(const basic_string<Char, char_traits<Char>, Alloc>& str)
+            {
+                return assign(str);
+            }
+
+            basic_regex& assign(const basic_regex& other)
+            {
+                return *this = other;
+            }
+
+            basic_regex& assign(basic_regex&& other) noexcept
+            {
+                return *this = move(other);
+            }
+
+            basic_regex& assign(const Char* p, flag_type f = ECMAScript)
+            {
+                return assign(string_type{p}, f);
+            }
+
+            basic_regex& assign(const Char* p, size_t len, flag_type f = ECMAScript)
+            {
+                return assign(string_type{p, len}, f);
+            }
+
+            template<class Alloc>
+            basic_regex& assign(const basic_string<Char, char_traits<Char>, Alloc>& str,
+                                flag_type f = ECMAScript)
+            {
+                // Compile first so a throwing assign leaves *this unchanged.
+                auto program = aux::rx_cache_fetch(string_type{str.data(), str.size()}, f);
+                program_ = move(program);
+                flags_ = f;
+
+                return *this;
+            }
+
+            template<class InputIterator>
+            basic_regex& assign(InputIterator first, InputIterator last,
+                                flag_type f = ECMAScript)
+            {
+                return assign(string_type{first, last}, f);
+            }
+
+            basic_regex& assign(initializer_list<Char> init, flag_type f = ECMAScript)
+            {
+                return assign(string_type{init.begin(), init.end()}, f);
+            }
+
+            unsigned mark_count() const
+            {
+                return program_ ? static_cast<unsigned>(program_->groups) : 0U;
+            }
+
+            flag_type flags() const
+            {
+                return flags_;
+            }
+
+            locale_type imbue(locale_type loc)
+            {
+                return traits_.imbue(loc);
+            }
+
+            locale_type getloc() const
+            {
+                return traits_.getloc();
+            }
+
+            void swap(basic_regex& other) noexcept
+            {
+                program_.swap(other.program_);
+                std::swap(flags_, other.flags_);
+            }
+
+            /**
+             * Engine access for the match algorithms; not part of
+             * the public interface.
+             */
+            aux::rx_program<Char>* engine() const
+            {
+                return program_.get();
+            }
+
+        private:
+            shared_ptr<aux::rx_program<Char>> program_;
+            flag_type flags_;
+            Traits traits_;
+    };
+
+    using regex  = basic_regex<char>;
+    using wregex = basic_regex<wchar_t>;
+
+    template<class Char, class Traits>
+    void swap(basic_regex<Char, Traits>& lhs, basic_regex<Char, Traits>& rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    /**
+     * 30.9, class template sub_match:
+     */
+
+    template<class BidirectionalIterator>
+    class sub_match: public pair<BidirectionalIterator, BidirectionalIterator>
+    {
+        public:
+            using iterator        = BidirectionalIterator;
+            using value_type      = typename iterator_traits<iterator>::value_type;
+            using difference_type = typename iterator_traits<iterator>::difference_type;
+            using string_type     = basic_string<value_type>;
+
+            bool matched{};
+
+            constexpr sub_match()
+                : pair<iterator, iterator>{}
+            { /* DUMMY BODY */ }
+
+            difference_type length() const
+            {
+                return matched ? distance(this->first, this->second) : 0;
+            }
+
+            operator string_type() const
+            {
+                return str();
+            }
+
+            string_type str() const
+            {
+                return matched ? string_type{this->first, this->second}
+                               : string_type{};
+            }
+
+            int compare(const sub_match& other) const
+            {
+                return str().compare(other.str());
+            }
+
+            int compare(const string_type& other) const
+            {
+                return str().compare(other);
+            }
+
+            int compare(const value_type* other) const
+            {
+                return str().compare(other);
+            }
+    };
+
+    using csub_match  = sub_match<const char*>;
+    using wcsub_match = sub_match<const wchar_t*>;
+    using ssub_match  = sub_match<string::const_iterator>;
+    using wssub_match = sub_match<wstring::const_iterator>;
+
+    template<class BiIter>
+    bool operator==(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs)
+    {
+        return lhs.compare(rhs) == 0;
+    }
+
+    template<class BiIter>
+    bool operator!=(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs)
+    {
+        return lhs.compare(rhs) != 0;
+    }
+
+    template<class BiIter>
+    bool operator<(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs)
+    {
+        return lhs.compare(rhs) < 0;
+    }
+
+    template<class BiIter>
+    bool operator<=(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs)
+    {
+        return lhs.compare(rhs) <= 0;
+    }
+
+    template<class BiIter>
+    bool operator>(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs)
+    {
+        return lhs.compare(rhs) > 0;
+    }
+
+    template<class BiIter>
+    bool operator>=(const sub_match<BiIter>& lhs, const sub_match<BiIter>& rhs)
+    {
+        return lhs.compare(rhs) >= 0;
+    }
+
+    template<class BiIter>
+    bool operator==(const sub_match<BiIter>& lhs,
+                    const typename sub_match<BiIter>::string_type& rhs)
+    {
+        return lhs.compare(rhs) == 0;
+    }
+
+    template<class BiIter>
+    bool operator==(const typename sub_match<BiIter>::string_type& lhs,
+                    const sub_match<BiIter>& rhs)
+    {
+        return rhs.compare(lhs) == 0;
+    }
+
+    template<class BiIter>
+    bool operator==(const sub_match<BiIter>& lhs,
+                    const typename iterator_traits<BiIter>::value_type* rhs)
+    {
+        return lhs.compare(rhs) == 0;
+    }
+
+    template<class BiIter>
+    bool operator==(const typename iterator_traits<BiIter>::value_type* lhs,
+                    const sub_match<BiIter>& rhs)
+    {
+        return rhs.compare(lhs) == 0;
+    }
+
+    /**
+     * 30.10, class template match_results:
+     */
+
+    template<class BidirectionalIterator,
+             class Allocator = allocator<sub_match<BidirectionalIterator>>>
+    class match_results
+    {
+        public:
+            using value_type      = sub_match<BidirectionalIterator>;
+            using const_reference = const value_type&;
+            using reference       = value_type&;
+            using const_iterator  = typename vector<value_type>::const_iterator;
+            using iterator        = const_iterator;
+            using difference_type = typename iterator_traits<BidirectionalIterator>::difference_type;
+            using size_type       = size_t;
+            using allocator_type  = Allocator;
+            using char_type       = typename iterator_traits<BidirectionalIterator>::value_type;
+            using string_type     = basic_string<char_type>;
+
+            match_results()
+                : matches_{}, prefix_{}, suffix_{}, ready_{}
+            { /* DUMMY BODY */ }
+
+            bool ready() const
+            {
+                return ready_;
+            }
+
+            bool empty() const
+            {
+                return matches_.empty();
+            }
+
+            size_type size() const
+            {
+                return matches_.size();
+            }
+
+            size_type max_size() const
+            {
+                return matches_.max_size();
+            }
+
+            difference_type position(size_type idx = 0) const
+            {
+                return distance(base_, (*this)[idx].first);
+            }
+
+            difference_type length(size_type idx = 0) const
+            {
+                return (*this)[idx].length();
+            }
+
+            string_type str(size_type idx = 0) const
+            {
+                return (*this)[idx].str();
+            }
+
+            const_reference operator[](size_type idx) const
+            {
+                return idx < matches_.size() ? matches_[idx] : unmatched_;
+            }
+
+            const_reference prefix() const
+            {
+                return prefix_;
+            }
+
+            const_reference suffix() const
+            {
+                return suffix_;
+            }
+
+            const_iterator begin() const
+            {
+                return matches_.begin();
+            }
+
+            const_iterator end() const
+            {
+                return matches_.end();
+            }
+
+            const_iterator cbegin() const
+            {
+                return matches_.cbegin();
+            }
+
+            const_iterator cend() const
+            {
+                return matches_.cend();
+            }
+
+            template<class OutputIterator>
+            OutputIterator format(OutputIterator out, const char_type* fmt_first,
+                                  const char_type* fmt_last,
+                                  regex_constants::match_flag_type = regex_constants::format_default) const
+            {
+                for (auto it = fmt_first; it != fmt_last; ++it)
+                {
+                    if (*it != static_cast<char_type>('$') || it + 1 == fmt_last)
+                    {
+                        *out++ = *it;
+                        continue;
+                    }
+
+                    ++it;
+                    auto c = *it;
+                    if (c == static_cast<char_type>('$'))
+                        *out++ = c;
+                    else if (c == static_cast<char_type>('&'))
+                        out = copy_group(out, 0);
+                    else if (c == static_cast<char_type>('`'))
+                        out = copy_range(out, prefix_);
+                    else if (c == static_cast<char_type>('\''))
+                        out = copy_range(out, suffix_);
+                    else if (c >= static_cast<char_type>('0') && c <= static_cast<char_type>('9'))
+                    {
+                        size_type idx = c - static_cast<char_type>('0');
+                        if (it + 1 != fmt_last &&
+                            *(it + 1) >= static_cast<char_type>('0') &&
+                            *(it + 1) <= static_cast<char_type>('9'))
+                        {
+                            ++it;
+                            idx = idx * 10 + (*it - static_cast<char_type>('0'));
+                        }
+                        out = copy_group(out, idx);
+                    }
+                    else
+                    {
+                        *out++ = static_cast<char_type>('$');
+                        *out++ = c;
+                    }
+                }
+
+                return out;
+            }
+
+            template<class OutputIterator>
+            OutputIterator format(OutputIterator out, const string_type& fmt,
+                                  regex_constants::match_flag_type flags = regex_constants::format_default) const
+            {
+                return format(out, fmt.data(), fmt.data() + fmt.size(), flags);
+            }
+
+            string_type format(const string_type& fmt,
+                               regex_constants::match_flag_type flags = regex_constants::format_default) const
+            {
+                string_type res{};
+                format(back_inserter(res), fmt, flags);
+
+                return res;
+            }
+
+            allocator_type get_allocator() const
+            {
+                return allocator_type{};
+            }
+
+            void swap(match_results& other)
+            {
+                matches_.swap(other.matches_);
+                std::swap(prefix_, other.prefix_);
+                std::swap(suffix_, other.suffix_);
+                std::swap(base_, other.base_);
+                std::swap(ready_, other.ready_);
+            }
+
+            /**
+             * Populates the results from the engine's capture slots;
+             * not part of the public interface.
+             */
+            void assign_results(BidirectionalIterator first, BidirectionalIterator last,
+                                const vector<ptrdiff_t>& caps, size_t groups,
+                                bool matched)
+            {
+                ready_ = true;
+                base_ = first;
+                matches_.clear();
+                prefix_ = value_type{};
+                suffix_ = value_type{};
+
+                if (!matched)
+                    return;
+
+                matches_.resize(groups + 1);
+                for (size_t i = 0; i <= groups; ++i)
+                {
+                    auto b = caps[2 * i];
+                    auto e = caps[2 * i + 1];
+                    if (b < 0 || e < 0)
+                    {
+                        matches_[i].first = last;
+                        matches_[i].second = last;
+                        matches_[i].matched = false;
+                    }
+                    else
+                    {
+                        matches_[i].first = next(first, b);
+                        matches_[i].second = next(first, e);
+                        matches_[i].matched = true;
+                    }
+                }
+
+                prefix_.first = first;
+                prefix_.second = matches_[0].first;
+                prefix_.matched = prefix_.first != prefix_.second;
+
+                suffix_.first = matches_[0].second;
+                suffix_.second = last;
+                suffix_.matched = suffix_.first != suffix_.second;
+            }
+
+        private:
+            vector<value_type> matches_;
+            value_type prefix_;
+            value_type suffix_;
+            value_type unmatched_{};
+            BidirectionalIterator base_{};
+            bool ready_;
+
+            template<class OutputIterator>
+            OutputIterator copy_group(OutputIterator out, size_type idx) const
+            {
+                return copy_range(out, (*this)[idx]);
+            }
+
+            template<class OutputIterator>
+            OutputIterator copy_range(OutputIterator out, const value_type& sub) const
+            {
+                if (!sub.matched)
+                    return out;
+                for (auto it = sub.first; it != sub.second; ++it)
+                    *out++ = *it;
+
+                return out;
+            }
+    };
+
+    using cmatch  = match_results<const char*>;
+    using wcmatch = match_results<const wchar_t*>;
+    using smatch  = match_results<string::const_iterator>;
+    using wsmatch = match_results<wstring::const_iterator>;
+
+    template<class BiIter, class Alloc>
+    bool operator==(const match_results<BiIter, Alloc>& lhs,
+                    const match_results<BiIter, Alloc>& rhs)
+    {
+        if (lhs.ready() != rhs.ready())
+            return false;
+        if (!lhs.ready())
+            return true;
+        if (lhs.size() != rhs.size())
+            return false;
+        for (typename match_results<BiIter, Alloc>::size_type i = 0; i < lhs.size(); ++i)
+        {
+            if (!(lhs[i] == rhs[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    template<class BiIter, class Alloc>
+    bool operator!=(const match_results<BiIter, Alloc>& lhs,
+                    const match_results<BiIter, Alloc>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template<class BiIter, class Alloc>
+    void swap(match_results<BiIter, Alloc>& lhs, match_results<BiIter, Alloc>& rhs)
+    {
+        lhs.swap(rhs);
+    }
+
+    /**
+     * 30.11, regular expression algorithms:
+     */
+
+    template<class BidirectionalIterator, class Allocator, class Char, class Traits>
+    bool regex_search(BidirectionalIterator first, BidirectionalIterator last,
+                      match_results<BidirectionalIterator, Allocator>& m,
+                      const basic_regex<Char, Traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        auto program = e.engine();
+        if (!program)
+        {
+            m = match_results<BidirectionalIterator, Allocator>{};
+            return false;
+        }
+
+        bool anchored = (flags & regex_constants::match_continuous) != 0;
+
+        /**
+         * Fast path: the DFA rejects non-matching input at memory
+         * bandwidth without touching captures. Only a confirmed hit
+         * pays for the NFA simulation below.
+         */
+        auto prefilter = aux::rx_prefilter(*program, first, last, anchored, false);
+        if (prefilter == aux::rx_dfa::scan_no_match)
+        {
+            m.assign_results(first, last, {}, 0, false);
+            return false;
+        }
+
+        aux::rx_vm<Char, BidirectionalIterator> vm{*program, first, last};
+        vector<ptrdiff_t> caps;
+        bool matched = vm.run(anchored, false, flags, caps);
+
+        m.assign_results(first, last, caps, program->groups, matched);
+
+        return matched;
+    }
+
+    template<class BidirectionalIterator, class Char, class Traits>
+    bool regex_search(BidirectionalIterator first, BidirectionalIterator last,
+                      const basic_regex<Char, Traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        match_results<BidirectionalIterator> m{};
+
+        return regex_search(first, last, m, e, flags);
+    }
+
+    template<class Char, class Allocator, class Traits>
+    bool regex_search(const Char* str, match_results<const Char*, Allocator>& m,
+                      const basic_regex<Char, Traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_search(str, str + char_traits<Char>::length(str), m, e, flags);
+    }
+
+    template<class Char, class Traits>
+    bool regex_search(const Char* str, const basic_regex<Char, Traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_search(str, str + char_traits<Char>::length(str), e, flags);
+    }
+
+    template<class STraits, class SAlloc, class Allocator, class Char, class Traits>
+    bool regex_search(const basic_string<Char, STraits, SAlloc>& str,
+                      match_results<typename basic_string<Char, STraits, SAlloc>::const_iterator,
+                                    Allocator>& m,
+                      const basic_regex<Char, Traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_search(str.begin(), str.end(), m, e, flags);
+    }
+
+    template<class STraits, class SAlloc, class Char, class Traits>
+    bool regex_search(const basic_string<Char, STraits, SAlloc>& str,
+                      const basic_regex<Char, Traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_search(str.begin(), str.end(), e, flags);
+    }
+
+    template<class BidirectionalIterator, class Allocator, class Char, class Traits>
+    bool regex_match(BidirectionalIterator first, BidirectionalIterator last,
+                     match_results<BidirectionalIterator, Allocator>& m,
+                     const basic_regex<Char, Traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        auto program = e.engine();
+        if (!program)
+        {
+            m = match_results<BidirectionalIterator, Allocator>{};
+            return false;
+        }
+
+        auto prefilter = aux::rx_prefilter(*program, first, last, true, true);
+        if (prefilter == aux::rx_dfa::scan_no_match)
+        {
+            m.assign_results(first, last, {}, 0, false);
+            return false;
+        }
+
+        aux::rx_vm<Char, BidirectionalIterator> vm{*program, first, last};
+        vector<ptrdiff_t> caps;
+        bool matched = vm.run(true, true, flags, caps);
+
+        m.assign_results(first, last, caps, program->groups, matched);
+
+        return matched;
+    }
+
+    template<class BidirectionalIterator, class Char, class Traits>
+    bool regex_match(BidirectionalIterator first, BidirectionalIterator last,
+                     const basic_regex<Char, Traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        match_results<BidirectionalIterator> m{};
+
+        return regex_match(first, last, m, e, flags);
+    }
+
+    template<class Char, class Allocator, class Traits>
+    bool regex_match(const Char* str, match_results<const Char*, Allocator>& m,
+                     const basic_regex<Char, Traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_match(str, str + char_traits<Char>::length(str), m, e, flags);
+    }
+
+    template<class Char, class Traits>
+    bool regex_match(const Char* str, const basic_regex<Char, Traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_match(str, str + char_traits<Char>::length(str), e, flags);
+    }
+
+    template<class STraits, class SAlloc, class Allocator, class Char, class Traits>
+    bool regex_match(const basic_string<Char, STraits, SAlloc>& str,
+                     match_results<typename basic_string<Char, STraits, SAlloc>::const_iterator,
+                                   Allocator>& m,
+                     const basic_regex<Char, Traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_match(str.begin(), str.end(), m, e, flags);
+    }
+
+    template<class STraits, class SAlloc, class Char, class Traits>
+    bool regex_match(const basic_string<Char, STraits, SAlloc>& str,
+                     const basic_regex<Char, Traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_match(str.begin(), str.end(), e, flags);
+    }
+
+    /**
+     * 30.12.1, class template regex_iterator:
+     */
+
+    template<class BidirectionalIterator,
+             class Char = typename iterator_traits<BidirectionalIterator>::value_type,
+             class Traits = regex_traits<Char>>
+    class regex_iterator
+    {
+        public:
+            using regex_type        = basic_regex<Char, Traits>;
+            using value_type        = match_results<BidirectionalIterator>;
+            using difference_type   = ptrdiff_t;
+            using pointer           = const value_type*;
+            using reference         = const value_type&;
+            using iterator_category = forward_iterator_tag;
+
+            regex_iterator()
+                : first_{}, last_{}, regex_{}, flags_{}, match_{}
+            { /* DUMMY BODY */ }
+
+            regex_iterator(BidirectionalIterator first, BidirectionalIterator last,
+                           const regex_type& re,
+                           regex_constants::match_flag_type flags = regex_constants::match_default)
+                : first_{first}, last_{last}, regex_{&re}, flags_{flags}, match_{}
+            {
+                if (!regex_search(first_, last_, match_, *regex_, flags_))
+                    regex_ = nullptr;
+            }
+
+            regex_iterator(const regex_iterator&) = default;
+            regex_iterator& operator=(const regex_iterator&) = default;
+
+            bool operator==(const regex_iterator& other) const
+            {
+                if (!regex_ && !other.regex_)
+                    return true;
+                if (!regex_ || !other.regex_)
+                    return false;
+
+                return first_ == other.first_ && last_ == other.last_ &&
+                       regex_ == other.regex_ && flags_ == other.flags_ &&
+                       match_[0] == other.match_[0];
+            }
+
+            bool operator!=(const regex_iterator& other) const
+            {
+                return !(*this == other);
+            }
+
+            reference operator*() const
+            {
+                return match_;
+            }
+
+            pointer operator->() const
+            {
+                return &match_;
+            }
+
+            regex_iterator& operator++()
+            {
+                auto start = match_[0].second;
+                if (match_[0].first == match_[0].second)
+                {
+                    // Empty match: retry non-empty at the same position
+                    // before stepping over one character.
+                    if (start == last_)
+                    {
+                        regex_ = nullptr;
+                        return *this;
+                    }
+                    if (regex_search(start, last_, match_, *regex_,
+                                     flags_ | regex_constants::match_not_null |
+                                     regex_constants::match_continuous))
+                        return *this;
+                    ++start;
+                }
+
+                if (!regex_search(start, last_, match_, *regex_, flags_))
+                    regex_ = nullptr;
+
+                return *this;
+            }
+
+            regex_iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++(*this);
+
+                return tmp;
+            }
+
+        private:
+            BidirectionalIterator first_;
+            BidirectionalIterator last_;
+            const regex_type* regex_;
+            regex_constants::match_flag_type flags_;
+            value_type match_;
+    };
+
+    using cregex_iterator  = regex_iterator<const char*>;
+    using wcregex_iterator = regex_iterator<const wchar_t*>;
+    using sregex_iterator  = regex_iterator<string::const_iterator>;
+    using wsregex_iterator = regex_iterator<wstring::const_iterator>;
+
+    /**
+     * 30.11.4, function template regex_replace:
+     */
+
+    template<class OutputIterator, class BidirectionalIterator, class Traits, class Char>
+    OutputIterator regex_replace(OutputIterator out,
+                                 BidirectionalIterator first, BidirectionalIterator last,
+                                 const basic_regex<Char, Traits>& e,
+                                 const basic_string<Char>& fmt,
+                                 regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        regex_iterator<BidirectionalIterator, Char, Traits> it{first, last, e, flags};
+        regex_iterator<BidirectionalIterator, Char, Traits> end{};
+
+        auto rest = first;
+        for (; it != end; ++it)
+        {
+            const auto& m = *it;
+            if ((flags & regex_constants::format_no_copy) == 0)
+            {
+                // Copy from the end of the previous match, not from the
+                // prefix of this one: after an empty match the iterator
+                // steps over a character the prefix would miss.
+                for (auto c = rest; c != m[0].first; ++c)
+                    *out++ = *c;
+            }
+            out = m.format(out, fmt, flags);
+            rest = m[0].second;
+
+            if (flags & regex_constants::format_first_only)
+                break;
+        }
+
+        if ((flags & regex_constants::format_no_copy) == 0)
+        {
+            for (; rest != last; ++rest)
+                *out++ = *rest;
+        }
+
+        return out;
+    }
+
+    template<class OutputIterator, class BidirectionalIterator, class Traits, class Char>
+    OutputIterator regex_replace(OutputIterator out,
+                                 BidirectionalIterator first, BidirectionalIterator last,
+                                 const basic_regex<Char, Traits>& e, const Char* fmt,
+                                 regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_replace(out, first, last, e, basic_string<Char>{fmt}, flags);
+    }
+
+    template<class Traits, class Char, class STraits, class SAlloc>
+    basic_string<Char> regex_replace(const basic_string<Char, STraits, SAlloc>& str,
+                                     const basic_regex<Char, Traits>& e,
+                                     const basic_string<Char>& fmt,
+                                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        basic_string<Char> res{};
+        regex_replace(back_inserter(res), str.begin(), str.end(), e, fmt, flags);
+
+        return res;
+    }
+
+    template<class Traits, class Char, class STraits, class SAlloc>
+    basic_string<Char> regex_replace(const basic_string<Char, STraits, SAlloc>& str,
+                                     const basic_regex<Char, Traits>& e, const Char* fmt,
+                                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_replace(str, e, basic_string<Char>{fmt}, flags);
+    }
+
+    template<class Traits, class Char>
+    basic_string<Char> regex_replace(const Char* str, const basic_regex<Char, Traits>& e,
+                                     const basic_string<Char>& fmt,
+                                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        basic_string<Char> res{};
+        regex_replace(back_inserter(res), str,
+                      str + char_traits<Char>::length(str), e, fmt, flags);
+
+        return res;
+    }
+
+    template<class Traits, class Char>
+    basic_string<Char> regex_replace(const Char* str, const basic_regex<Char, Traits>& e,
+                                     const Char* fmt,
+                                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_replace(str, e, basic_string<Char>{fmt}, flags);
+    }
+}
 
 #endif
@@ -478,8 +478,9 @@ namespace std
                  *  size() = 0
                  *  capacity() = unspecified
                  */
-                data_ = allocator_.allocate(default_capacity_);
-                capacity_ = default_capacity_;
+                data_ = local_;
+                capacity_ = sso_capacity_;
+                ensure_null_terminator_();
             }
 
             basic_string(const basic_string& other)
@@ -490,12 +491,22 @@ namespace std
             }
 
             basic_string(basic_string&& other)
-                : data_{other.data_}, size_{other.size_},
+                : data_{}, size_{other.size_},
                   capacity_{other.capacity_}, allocator_{move(other.allocator_)}
             {
-                other.data_ = nullptr;
+                if (other.is_local_())
+                {
+                    /* Short strings are copied, not stolen. */
+                    data_ = local_;
+                    traits_type::copy(local_, other.local_, sso_capacity_);
+                }
+                else
+                    data_ = other.data_;
+
+                other.data_ = other.local_;
                 other.size_ = 0;
-                other.capacity_ = 0;
+                other.capacity_ = sso_capacity_;
+                other.ensure_null_terminator_();
             }
 
             basic_string(const basic_string& other, size_type pos, size_type n = npos,
@@ -520,9 +531,19 @@ namespace std
             }
 
             basic_string(size_type n, value_type c, const allocator_type& alloc = allocator_type{})
-                : data_{}, size_{n}, capacity_{n + 1}, allocator_{alloc}
+                : data_{}, size_{n}, capacity_{}, allocator_{alloc}
             {
-                data_ = allocator_.allocate(capacity_);
+                if (size_ < sso_capacity_)
+                {
+                    data_ = local_;
+                    capacity_ = sso_capacity_;
+                }
+                else
+                {
+                    capacity_ = size_ + 1;
+                    data_ = allocator_.allocate(capacity_);
+                }
+
                 for (size_type i = 0; i < size_; ++i)
                     traits_type::assign(data_[i], c);
                 ensure_null_terminator_();
@@ -536,8 +557,17 @@ namespace std
                 if constexpr (is_integral<InputIterator>::value)
                 { // Required by the standard.
                     size_ = static_cast<size_type>(first);
-                    capacity_ = size_;
-                    data_ = allocator_.allocate(capacity_);
+
+                    if (size_ < sso_capacity_)
+                    {
+                        data_ = local_;
+                        capacity_ = sso_capacity_;
+                    }
+                    else
+                    {
+                        capacity_ = size_ + 1;
+                        data_ = allocator_.allocate(capacity_);
+                    }
 
                     for (size_type i = 0; i < size_; ++i)
                         traits_type::assign(data_[i], static_cast<value_type>(last));
@@ -561,16 +591,27 @@ namespace std
             }
 
             basic_string(basic_string&& other, const allocator_type& alloc)
-                : data_{other.data_}, size_{other.size_}, capacity_{other.capacity_}, allocator_{alloc}
+                : data_{}, size_{other.size_}, capacity_{other.capacity_}, allocator_{alloc}
             {
-                other.data_ = nullptr;
+                if (other.is_local_())
+                {
+                    /* Short strings are copied, not stolen. */
+                    data_ = local_;
+                    traits_type::copy(local_, other.local_, sso_capacity_);
+                }
+                else
+                    data_ = other.data_;
+
+                other.data_ = other.local_;
                 other.size_ = 0;
-                other.capacity_ = 0;
+                other.capacity_ = sso_capacity_;
+                other.ensure_null_terminator_();
             }
 
             ~basic_string()
             {
-                allocator_.deallocate(data_, capacity_);
+                if (!is_local_())
+                    allocator_.deallocate(data_, capacity_);
             }
 
             basic_string& operator=(const basic_string& other)
@@ -1160,7 +1201,24 @@ namespace std
                 noexcept(allocator_traits<allocator_type>::propagate_on_container_swap::value ||
                          allocator_traits<allocator_type>::is_always_equal::value)
             {
+                bool this_local = is_local_();
+                bool other_local = other.is_local_();
+
+                /*
+                 * The in-object buffers cannot be swapped by pointer,
+                 * swap their contents and fix up the pointers afterwards.
+                 */
+                value_type tmp[sso_capacity_];
+                traits_type::copy(tmp, local_, sso_capacity_);
+                traits_type::copy(local_, other.local_, sso_capacity_);
+                traits_type::copy(other.local_, tmp, sso_capacity_);
+
                 std::swap(data_, other.data_);
+                if (other_local)
+                    data_ = local_;
+                if (this_local)
+                    other.data_ = other.local_;
+
                 std::swap(size_, other.size_);
                 std::swap(capacity_, other.capacity_);
             }
@@ -1476,31 +1534,45 @@ namespace std
             }
 
         private:
+            /**
+             * Short strings are stored directly in local_ with data_
+             * pointing at it, avoiding any allocator traffic. Long
+             * strings keep data_ on the heap; local_ is then unused.
+             */
+            static constexpr size_type sso_capacity_{16 / sizeof(value_type)};
+
             value_type* data_;
             size_type size_;
             size_type capacity_;
+            value_type local_[sso_capacity_];
             allocator_type allocator_;
 
             template<class C, class T, class A>
             friend class basic_stringbuf;
 
-            /**
-             * Arbitrary value, standard just requires
-             * data() to have some capacity.
-             * (Well, we could've done data_ = &data_ and
-             * set capacity to 0, but that would be too cryptic.)
-             */
-            static constexpr size_type default_capacity_{4};
+            bool is_local_() const noexcept
+            {
+                return data_ == local_;
+            }
 
             void init_(const value_type* str, size_type size)
             {
-                if (data_)
+                if (data_ && !is_local_())
                     allocator_.deallocate(data_, capacity_);
 
                 size_ = size;
-                capacity_ = size + 1;
 
-                data_ = allocator_.allocate(capacity_);
+                if (size < sso_capacity_)
+                {
+                    data_ = local_;
+                    capacity_ = sso_capacity_;
+                }
+                else
+                {
+                    capacity_ = size + 1;
+                    data_ = allocator_.allocate(capacity_);
+                }
+
                 traits_type::copy(data_, str, size);
                 ensure_null_terminator_();
             }
@@ -1526,30 +1598,42 @@ namespace std
 
             void resize_without_copy_(size_type capacity)
             {
-                if (data_)
+                if (data_ && !is_local_())
                     allocator_.deallocate(data_, capacity_);
 
-                data_ = allocator_.allocate(capacity);
+                if (capacity <= sso_capacity_)
+                {
+                    data_ = local_;
+                    capacity_ = sso_capacity_;
+                }
+                else
+                {
+                    data_ = allocator_.allocate(capacity);
+                    capacity_ = capacity;
+                }
+
                 size_ = 0;
-                capacity_ = capacity;
                 ensure_null_terminator_();
             }
 
             void resize_with_copy_(size_type size, size_type capacity)
             {
-                if(capacity_ == 0 || capacity_ < capacity)
+                if (capacity_ < capacity && capacity > sso_capacity_)
                 {
                     auto new_data = allocator_.allocate(capacity);
 
                     auto to_copy = min(size, size_);
                     traits_type::move(new_data, data_, to_copy);
 
-                    std::swap(data_, new_data);
+                    auto old_data = data_;
+                    data_ = new_data;
+
+                    if (old_data && old_data != local_)
+                        allocator_.deallocate(old_data, capacity_);
 
-                    allocator_.deallocate(new_data, capacity_);
+                    capacity_ = capacity;
                 }
 
-                capacity_ = capacity;
                 size_ = size;
                 ensure_null_terminator_();
             }
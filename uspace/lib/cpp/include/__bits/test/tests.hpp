@@ -256,6 +256,34 @@ namespace std::test
             void test_pointers();
     };
 
+    class execution_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+
+        private:
+            void test_sort();
+            void test_for_each();
+            void test_transform();
+            void test_reduce();
+            void test_copy();
+    };
+
+    class memory_resource_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+
+        private:
+            void test_default_resource();
+            void test_polymorphic_allocator();
+            void test_monotonic_buffer_resource();
+            void test_unsynchronized_pool_resource();
+            void test_pmr_containers();
+    };
+
     class list_test: public test_suite
     {
         public:
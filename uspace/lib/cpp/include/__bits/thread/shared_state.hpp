@@ -38,6 +38,7 @@
 #include <__bits/functional/invoke.hpp>
 #include <__bits/refcount_obj.hpp>
 #include <__bits/thread/future_common.hpp>
+#include <__bits/thread/thread_pool.hpp>
 #include <__bits/thread/threading.hpp>
 #include <cerrno>
 #include <thread>
@@ -70,6 +71,15 @@ namespace std::aux
                 value_set_ = set;
             }
 
+            void mark_set_and_notify()
+            {
+                threading::mutex::lock(mutex_);
+                value_set_ = true;
+                threading::mutex::unlock(mutex_);
+
+                threading::condvar::broadcast(condvar_);
+            }
+
             bool is_set() const noexcept
             {
                 return value_set_;
@@ -274,9 +284,16 @@ namespace std::aux
     {
         public:
             async_shared_state(F&& f, Args&&... args)
-                : shared_state<R>{}, thread_{}
+                : shared_state<R>{}
             {
-                thread_ = thread{
+                /**
+                 * Note: The task runs on one of the worker fibrils
+                 *       of the shared pool instead of a fibril of
+                 *       its own, so there is no thread to join and
+                 *       every path through the task has to mark the
+                 *       state ready and notify the condvar waiters.
+                 */
+                thread_pool::instance().submit(
                     [=](){
                         try
                         {
@@ -285,50 +302,33 @@ namespace std::aux
                             else
                             {
                                 invoke(f, args...);
-                                this->mark_set(true);
+                                this->mark_set_and_notify();
                             }
                         }
                         catch(const exception& __exception)
                         {
                             this->set_exception(make_exception_ptr(__exception));
+                            this->mark_set_and_notify();
                         }
                     }
-                };
+                );
             }
 
             void destroy() override
             {
+                /**
+                 * Note: The submitted task references this state,
+                 *       so we must not get destroyed before it
+                 *       has run.
+                 */
                 if (!this->is_set())
-                    thread_.join();
-            }
-
-            void wait() const override
-            {
-                if (!this->is_set())
-                    const_cast<thread&>(thread_).join();
+                    shared_state_base::wait();
             }
 
             ~async_shared_state() override
             {
                 destroy();
             }
-
-        protected:
-            future_status timed_wait_(aux::time_unit_t time) const override
-            {
-                /**
-                 * Note: Currently we have no timed join, but this
-                 *       behaviour should be compliant.
-                 */
-                aux::threading::time::sleep(time);
-                if (this->value_set_)
-                    return future_status::ready;
-                else
-                    return future_status::timeout;
-            }
-
-        private:
-            thread thread_;
     };
 
     template<class R, class F, class... Args>
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_THREAD_THREAD_POOL
+#define LIBCPP_BITS_THREAD_THREAD_POOL
+
+#include <__bits/functional/function.hpp>
+#include <__bits/thread/threading.hpp>
+
+namespace std::aux
+{
+    /**
+     * Fixed pool of worker fibrils shared by all std::async
+     * invocations, so that each task reuses an already running
+     * fibril instead of spawning a new one (and a new fibril
+     * stack) per invocation. Tasks are queued in FIFO order
+     * under a fibril mutex -- fibrils are scheduled cooperatively,
+     * so there is no lock contention to avoid here.
+     *
+     * Note: A pooled task that blocks on the result of another
+     *       pooled task can exhaust the workers, so dependent
+     *       tasks should be launched as deferred instead.
+     */
+    class thread_pool
+    {
+        public:
+            static constexpr size_t worker_count{4};
+
+            static thread_pool& instance();
+
+            void submit(function<void()> func);
+
+            bool try_run_one();
+
+            thread_pool(const thread_pool&) = delete;
+            thread_pool& operator=(const thread_pool&) = delete;
+
+        private:
+            thread_pool();
+            ~thread_pool();
+
+            struct task_
+            {
+                task_* next;
+                function<void()> func;
+            };
+
+            bool pop_and_run_();
+
+            static ::helenos::errno_t worker_main_(void*);
+
+            mutex_t mutex_;
+            condvar_t condvar_;
+            task_* head_;
+            task_* tail_;
+            bool stop_;
+    };
+}
+
+#endif
@@ -83,6 +83,31 @@ namespace std
  */
 extern int __exception;
 
+#ifdef LIBCPP_NO_EXCEPTIONS
+
+/**
+ * Exception-free build flavor (CONFIG_CPP_NO_EXCEPTIONS):
+ * throw statements abort the task outright instead of
+ * updating the exception state and catch clauses compile
+ * out entirely. This keeps the diagnostic strings, the
+ * state flag and the unwinding machinery out of the
+ * resulting binaries.
+ */
+
+#define try if constexpr (::std::aux::try_blocks_allowed)
+
+#define throw \
+    do { \
+        ::abort(); \
+    } while (false);
+
+#define catch(expr) if constexpr (false)
+
+#define LIBCPP_EXCEPTION_THROW_CHECK(variable) \
+    variable = false
+
+#else
+
 /**
  * These macros allow us to choose how the program
  * should behave when an exception is thrown
@@ -134,6 +159,8 @@ extern int __exception;
 #define LIBCPP_EXCEPTION_THROW_CHECK(variable) \
     variable = ::std::aux::exception_thrown
 
+#endif
+
 #else
 #define LIBCPP_EXCEPTION_THROW_CHECK(variable) \
     catch (...) \
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <execution>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace std::test
+{
+    bool execution_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        /*
+         * Force the parallel paths even for the small
+         * ranges used below.
+         */
+        auto old_threshold = std::execution::parallel_threshold;
+        std::execution::parallel_threshold = 16;
+
+        test_sort();
+        test_for_each();
+        test_transform();
+        test_reduce();
+        test_copy();
+
+        std::execution::parallel_threshold = old_threshold;
+
+        return end();
+    }
+
+    const char* execution_test::name()
+    {
+        return "execution";
+    }
+
+    void execution_test::test_sort()
+    {
+        std::vector<int> data(512), check(512);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = check[i] = std::rand() % 1000;
+
+        std::sort(std::execution::par, data.begin(), data.end());
+        std::sort(check.begin(), check.end());
+
+        test_eq(
+            "parallel sort", data.begin(), data.end(),
+            check.begin(), check.end()
+        );
+
+        std::sort(
+            std::execution::par, data.begin(), data.end(),
+            [](int lhs, int rhs){
+                return rhs < lhs;
+            }
+        );
+        test_eq(
+            "parallel sort with comparator",
+            std::is_sorted(
+                data.begin(), data.end(),
+                [](int lhs, int rhs){
+                    return rhs < lhs;
+                }
+            ),
+            true
+        );
+
+        std::vector<int> small{3, 1, 2};
+        std::sort(std::execution::par, small.begin(), small.end());
+        test_eq(
+            "below-threshold sort falls back to serial",
+            std::is_sorted(small.begin(), small.end()), true
+        );
+    }
+
+    void execution_test::test_for_each()
+    {
+        std::vector<int> data(256, 1);
+
+        std::for_each(
+            std::execution::par, data.begin(), data.end(),
+            [](int& element){
+                element += 2;
+            }
+        );
+
+        test_eq(
+            "parallel for_each",
+            std::all_of(
+                data.begin(), data.end(),
+                [](int element){
+                    return element == 3;
+                }
+            ),
+            true
+        );
+    }
+
+    void execution_test::test_transform()
+    {
+        std::vector<int> data(256, 2), res(256);
+
+        auto it = std::transform(
+            std::execution::par, data.begin(), data.end(), res.begin(),
+            [](int element){
+                return element * 5;
+            }
+        );
+
+        test_eq("parallel transform return value", it, res.end());
+        test_eq(
+            "parallel transform",
+            std::all_of(
+                res.begin(), res.end(),
+                [](int element){
+                    return element == 10;
+                }
+            ),
+            true
+        );
+
+        std::vector<int> res2(256);
+        std::transform(
+            std::execution::par, data.begin(), data.end(),
+            res.begin(), res2.begin(),
+            [](int lhs, int rhs){
+                return lhs + rhs;
+            }
+        );
+        test_eq(
+            "parallel binary transform",
+            std::all_of(
+                res2.begin(), res2.end(),
+                [](int element){
+                    return element == 12;
+                }
+            ),
+            true
+        );
+    }
+
+    void execution_test::test_reduce()
+    {
+        std::vector<int> data(256, 2);
+
+        test_eq(
+            "serial reduce",
+            std::reduce(data.begin(), data.end()), 512
+        );
+        test_eq(
+            "parallel reduce",
+            std::reduce(std::execution::par, data.begin(), data.end(), 0),
+            512
+        );
+        test_eq(
+            "parallel reduce with operation",
+            std::reduce(
+                std::execution::par, data.begin(), data.end(), 10,
+                [](int lhs, int rhs){
+                    return lhs + rhs;
+                }
+            ),
+            522
+        );
+    }
+
+    void execution_test::test_copy()
+    {
+        std::vector<int> data(256), res(256);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<int>(i);
+
+        auto it = std::copy(
+            std::execution::par, data.begin(), data.end(), res.begin()
+        );
+
+        test_eq("parallel copy return value", it, res.end());
+        test_eq(
+            "parallel copy", res.begin(), res.end(),
+            data.begin(), data.end()
+        );
+    }
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+
+namespace std::test
+{
+    namespace aux
+    {
+        /**
+         * Upstream resource that counts the traffic passing
+         * through it, so tests can check what the resources
+         * under test forward upstream.
+         */
+        class counting_resource : public pmr::memory_resource
+        {
+            public:
+                size_t allocation_count{};
+                size_t deallocation_count{};
+                size_t bytes_outstanding{};
+
+            protected:
+                void* do_allocate(size_t bytes, size_t alignment) override
+                {
+                    auto res = pmr::new_delete_resource()->allocate(
+                        bytes, alignment
+                    );
+                    if (res)
+                    {
+                        ++allocation_count;
+                        bytes_outstanding += bytes;
+                    }
+
+                    return res;
+                }
+
+                void do_deallocate(void* ptr, size_t bytes,
+                                   size_t alignment) override
+                {
+                    ++deallocation_count;
+                    bytes_outstanding -= bytes;
+
+                    pmr::new_delete_resource()->deallocate(
+                        ptr, bytes, alignment
+                    );
+                }
+
+                bool do_is_equal(const pmr::memory_resource& other) const noexcept override
+                {
+                    return this == &other;
+                }
+        };
+    }
+
+    bool memory_resource_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_default_resource();
+        test_polymorphic_allocator();
+        test_monotonic_buffer_resource();
+        test_unsynchronized_pool_resource();
+        test_pmr_containers();
+
+        return end();
+    }
+
+    const char* memory_resource_test::name()
+    {
+        return "memory_resource";
+    }
+
+    void memory_resource_test::test_default_resource()
+    {
+        auto def = pmr::get_default_resource();
+        test_eq("default resource is new_delete_resource",
+                def, pmr::new_delete_resource());
+
+        auto ptr = def->allocate(32);
+        test_eq("new_delete_resource allocates", (ptr != nullptr), true);
+        def->deallocate(ptr, 32);
+
+        test_eq("null_memory_resource returns nullptr",
+                pmr::null_memory_resource()->allocate(32),
+                static_cast<void*>(nullptr));
+
+        aux::counting_resource res{};
+        auto old = pmr::set_default_resource(&res);
+        test_eq("set_default_resource returns old resource",
+                old, pmr::new_delete_resource());
+        test_eq("set_default_resource sets new resource",
+                pmr::get_default_resource(),
+                static_cast<pmr::memory_resource*>(&res));
+
+        pmr::set_default_resource(nullptr);
+        test_eq("set_default_resource(nullptr) restores new_delete",
+                pmr::get_default_resource(), pmr::new_delete_resource());
+    }
+
+    void memory_resource_test::test_polymorphic_allocator()
+    {
+        aux::counting_resource res{};
+        pmr::polymorphic_allocator<int> alloc{&res};
+
+        test_eq("polymorphic_allocator resource()",
+                alloc.resource(),
+                static_cast<pmr::memory_resource*>(&res));
+
+        auto ptr = alloc.allocate(4);
+        test_eq("polymorphic_allocator routes to resource",
+                res.allocation_count, 1U);
+        test_eq("polymorphic_allocator allocation size",
+                res.bytes_outstanding, 4 * sizeof(int));
+
+        alloc.construct(ptr, 42);
+        test_eq("polymorphic_allocator construct", *ptr, 42);
+        alloc.destroy(ptr);
+        alloc.deallocate(ptr, 4);
+
+        test_eq("polymorphic_allocator deallocate returns memory",
+                res.bytes_outstanding, 0U);
+
+        pmr::polymorphic_allocator<long> alloc2{&res};
+        test_eq("allocators over the same resource compare equal",
+                (alloc == alloc2), true);
+        test_eq("select_on_container_copy_construction uses default",
+                alloc.select_on_container_copy_construction().resource(),
+                pmr::get_default_resource());
+    }
+
+    void memory_resource_test::test_monotonic_buffer_resource()
+    {
+        aux::counting_resource upstream{};
+        pmr::monotonic_buffer_resource mono{64, &upstream};
+
+        auto p1 = mono.allocate(16);
+        auto p2 = mono.allocate(16);
+        test_eq("monotonic allocations succeed",
+                (p1 != nullptr && p2 != nullptr), true);
+        test_eq("monotonic allocations are distinct", (p1 != p2), true);
+        test_eq("monotonic reuses its chunk", upstream.allocation_count, 1U);
+
+        auto p3 = mono.allocate(8, 64);
+        test_eq("monotonic respects alignment",
+                reinterpret_cast<uintptr_t>(p3) % 64, 0UL);
+
+        mono.deallocate(p1, 16);
+        test_eq("monotonic deallocate is a no-op",
+                (upstream.deallocation_count == 0U), true);
+
+        for (size_t i = 0; i < 100; ++i)
+            mono.allocate(64);
+        auto grown = upstream.allocation_count;
+        test_eq("monotonic grows via upstream", (grown > 1U), true);
+
+        mono.release();
+        test_eq("release returns all chunks upstream",
+                upstream.bytes_outstanding, 0U);
+
+        auto p4 = mono.allocate(16);
+        test_eq("monotonic usable after release", (p4 != nullptr), true);
+
+        char buffer[128];
+        pmr::monotonic_buffer_resource buffered{buffer, sizeof(buffer), &upstream};
+        auto before = upstream.allocation_count;
+        auto p5 = buffered.allocate(32);
+        test_eq("initial buffer served without upstream",
+                upstream.allocation_count, before);
+        test_eq("initial buffer allocation inside buffer",
+                (p5 >= buffer && p5 < buffer + sizeof(buffer)), true);
+    }
+
+    void memory_resource_test::test_unsynchronized_pool_resource()
+    {
+        aux::counting_resource upstream{};
+        pmr::unsynchronized_pool_resource pool{&upstream};
+
+        test_eq("pool options get defaults",
+                (pool.options().largest_required_pool_block > 0U), true);
+
+        auto p1 = pool.allocate(24);
+        auto chunks = upstream.allocation_count;
+        pool.deallocate(p1, 24);
+        auto p2 = pool.allocate(24);
+        test_eq("pool reuses freed block", p1, p2);
+        test_eq("pool block reuse without upstream traffic",
+                upstream.allocation_count, chunks);
+        pool.deallocate(p2, 24);
+
+        auto big_size = pool.options().largest_required_pool_block + 1;
+        auto p3 = pool.allocate(big_size);
+        test_eq("oversized allocation succeeds", (p3 != nullptr), true);
+        auto outstanding = upstream.bytes_outstanding;
+        pool.deallocate(p3, big_size);
+        test_eq("oversized deallocation goes upstream",
+                (upstream.bytes_outstanding < outstanding), true);
+
+        pool.allocate(32);
+        pool.allocate(512);
+        pool.allocate(big_size);
+        pool.release();
+        test_eq("pool release returns everything upstream",
+                upstream.bytes_outstanding, 0U);
+
+        auto p4 = pool.allocate(32);
+        test_eq("pool usable after release", (p4 != nullptr), true);
+        pool.deallocate(p4, 32);
+    }
+
+    void memory_resource_test::test_pmr_containers()
+    {
+        aux::counting_resource upstream{};
+
+        {
+            pmr::monotonic_buffer_resource arena{512, &upstream};
+            pmr::vector<int> vec{pmr::polymorphic_allocator<int>{&arena}};
+
+            for (int i = 0; i < 50; ++i)
+                vec.push_back(i);
+
+            bool ok{true};
+            for (int i = 0; i < 50; ++i)
+                ok &= (vec[i] == i);
+            test_eq("pmr::vector contents", ok, true);
+            test_eq("pmr::vector allocates from the arena",
+                    (upstream.allocation_count > 0U), true);
+        }
+        test_eq("arena destructor frees vector storage",
+                upstream.bytes_outstanding, 0U);
+
+        {
+            pmr::monotonic_buffer_resource arena{512, &upstream};
+            pmr::string str{
+                pmr::polymorphic_allocator<char>{&arena}
+            };
+
+            for (size_t i = 0; i < 100; ++i)
+                str.append("ab");
+
+            test_eq("pmr::string size", str.size(), 200U);
+            test_eq("pmr::string contents", (str[0] == 'a' && str[199] == 'b'), true);
+        }
+        test_eq("arena destructor frees string storage",
+                upstream.bytes_outstanding, 0U);
+    }
+}
@@ -26,6 +26,7 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <__bits/io/streambufs.hpp>
 #include <ios>
 
 namespace std
@@ -35,6 +36,17 @@ namespace std
     long ios_base::ierror_{0};
     void* ios_base::perror_{nullptr};
 
+    bool ios_base::sync_with_stdio(bool sync)
+    {
+        auto old = sync_;
+        sync_ = sync;
+
+        if (old != sync)
+            aux::stdio_sync_changed(sync);
+
+        return old;
+    }
+
     ios_base::ios_base()
         : iarray_{}, parray_{}, iarray_size_{}, parray_size_{},
           flags_{}, precision_{}, width_{}, locale_{/* TODO: use locale()? */},
@@ -39,6 +39,17 @@ namespace std
     namespace aux
     {
         ios_base::Init init{};
+
+        namespace
+        {
+            stdout_streambuf<char>* stdout_buf{};
+        }
+
+        void stdio_sync_changed(bool sync)
+        {
+            if (stdout_buf)
+                stdout_buf->set_sync(sync);
+        }
     }
 
     int ios_base::Init::init_cnt_{};
@@ -49,8 +60,10 @@ namespace std
         {
             // TODO: These buffers should be static too
             //       in case somebody reassigns to cout/cin.
+            aux::stdout_buf = ::new aux::stdout_streambuf<char>{};
+
             ::new(&cin) istream{::new aux::stdin_streambuf<char>{}};
-            ::new(&cout) ostream{::new aux::stdout_streambuf<char>{}};
+            ::new(&cout) ostream{aux::stdout_buf};
 
             cin.tie(&cout);
         }
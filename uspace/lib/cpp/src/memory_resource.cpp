@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+
+namespace std::pmr
+{
+    memory_resource::~memory_resource()
+    { /* DUMMY BODY */ }
+
+    namespace
+    {
+        class new_delete_resource_t : public memory_resource
+        {
+            protected:
+                void* do_allocate(size_t bytes, size_t alignment) override
+                {
+                    if (alignment > alignof(max_align_t))
+                        return ::helenos::memalign(alignment, bytes);
+
+                    return ::operator new(bytes);
+                }
+
+                void do_deallocate(void* ptr, size_t, size_t) override
+                {
+                    ::operator delete(ptr);
+                }
+
+                bool do_is_equal(const memory_resource& other) const noexcept override
+                {
+                    return this == &other;
+                }
+        };
+
+        class null_memory_resource_t : public memory_resource
+        {
+            protected:
+                void* do_allocate(size_t, size_t) override
+                {
+                    // TODO: Should throw bad_alloc.
+                    return nullptr;
+                }
+
+                void do_deallocate(void*, size_t, size_t) override
+                { /* DUMMY BODY */ }
+
+                bool do_is_equal(const memory_resource& other) const noexcept override
+                {
+                    return this == &other;
+                }
+        };
+
+        new_delete_resource_t new_delete_resource_instance{};
+        null_memory_resource_t null_memory_resource_instance{};
+
+        memory_resource* default_resource{&new_delete_resource_instance};
+    }
+
+    memory_resource* new_delete_resource() noexcept
+    {
+        return &new_delete_resource_instance;
+    }
+
+    memory_resource* null_memory_resource() noexcept
+    {
+        return &null_memory_resource_instance;
+    }
+
+    memory_resource* get_default_resource() noexcept
+    {
+        return default_resource;
+    }
+
+    memory_resource* set_default_resource(memory_resource* r) noexcept
+    {
+        auto old = default_resource;
+        default_resource = (r != nullptr) ? r : &new_delete_resource_instance;
+
+        return old;
+    }
+}
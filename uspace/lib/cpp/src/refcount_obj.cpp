@@ -30,20 +30,75 @@
 
 namespace std::aux
 {
+    /**
+     * Incrementing a reference count only requires that the
+     * count itself stays consistent, so a relaxed increment
+     * is enough. Decrements release the modifications made
+     * by this owner and the one that drops the count to zero
+     * additionally acquires them all before destruction.
+     * Defining LIBCPP_SINGLE_THREADED_REFCOUNT switches to
+     * plain non-atomic counting for single-threaded programs.
+     */
+
+#ifdef LIBCPP_SINGLE_THREADED_REFCOUNT
+    void refcount_obj::increment()
+    {
+        ++refcount_;
+    }
+
+    void refcount_obj::increment_weak()
+    {
+        ++weak_refcount_;
+    }
+
+    bool refcount_obj::decrement()
+    {
+        if (--refcount_ == 0)
+        {
+            /**
+             * First call to destroy() will delete the held object,
+             * so it doesn't matter what the weak_refcount_ is,
+             * but we added one and we need to remove it now.
+             */
+            decrement_weak();
+
+            return true;
+        }
+        else
+            return false;
+    }
+
+    bool refcount_obj::decrement_weak()
+    {
+        return --weak_refcount_ == 0 && refs() == 0;
+    }
+
+    refcount_t refcount_obj::refs() const
+    {
+        return refcount_;
+    }
+
+    refcount_t refcount_obj::weak_refs() const
+    {
+        return weak_refcount_;
+    }
+#else
     void refcount_obj::increment()
     {
-        __atomic_add_fetch(&refcount_, 1, __ATOMIC_ACQ_REL);
+        __atomic_add_fetch(&refcount_, 1, __ATOMIC_RELAXED);
     }
 
     void refcount_obj::increment_weak()
     {
-        __atomic_add_fetch(&weak_refcount_, 1, __ATOMIC_ACQ_REL);
+        __atomic_add_fetch(&weak_refcount_, 1, __ATOMIC_RELAXED);
     }
 
     bool refcount_obj::decrement()
     {
-        if (__atomic_sub_fetch(&refcount_, 1, __ATOMIC_ACQ_REL) == 0)
+        if (__atomic_sub_fetch(&refcount_, 1, __ATOMIC_RELEASE) == 0)
         {
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
             /**
              * First call to destroy() will delete the held object,
              * so it doesn't matter what the weak_refcount_ is,
@@ -59,7 +114,14 @@ namespace std::aux
 
     bool refcount_obj::decrement_weak()
     {
-        return __atomic_sub_fetch(&weak_refcount_, 1, __ATOMIC_ACQ_REL) == 0 && refs() == 0;
+        if (__atomic_sub_fetch(&weak_refcount_, 1, __ATOMIC_RELEASE) == 0)
+        {
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+            return refs() == 0;
+        }
+        else
+            return false;
     }
 
     refcount_t refcount_obj::refs() const
@@ -71,6 +133,7 @@ namespace std::aux
     {
         return __atomic_load_n(&weak_refcount_, __ATOMIC_RELAXED);
     }
+#endif
 
     bool refcount_obj::expired() const
     {
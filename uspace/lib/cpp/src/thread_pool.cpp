@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/thread/thread_pool.hpp>
+#include <cerrno>
+#include <utility>
+
+namespace std::aux
+{
+    thread_pool& thread_pool::instance()
+    {
+        static thread_pool pool{};
+
+        return pool;
+    }
+
+    thread_pool::thread_pool()
+        : mutex_{}, condvar_{}, head_{}, tail_{}, stop_{}
+    {
+        threading::mutex::init(mutex_);
+        threading::condvar::init(condvar_);
+
+        for (size_t i = 0; i < worker_count; ++i)
+        {
+            auto fid = ::helenos::fibril_create(worker_main_, this);
+            if (fid)
+                ::helenos::fibril_add_ready(fid);
+        }
+    }
+
+    thread_pool::~thread_pool()
+    {
+        threading::mutex::lock(mutex_);
+        stop_ = true;
+
+        while (head_)
+        {
+            auto task = head_;
+            head_ = head_->next;
+
+            delete task;
+        }
+        tail_ = nullptr;
+        threading::mutex::unlock(mutex_);
+
+        threading::condvar::broadcast(condvar_);
+    }
+
+    void thread_pool::submit(function<void()> func)
+    {
+        auto task = new task_{nullptr, move(func)};
+
+        threading::mutex::lock(mutex_);
+        if (tail_)
+            tail_->next = task;
+        else
+            head_ = task;
+        tail_ = task;
+        threading::mutex::unlock(mutex_);
+
+        threading::condvar::signal(condvar_);
+    }
+
+    bool thread_pool::try_run_one()
+    {
+        threading::mutex::lock(mutex_);
+
+        if (!head_)
+        {
+            threading::mutex::unlock(mutex_);
+
+            return false;
+        }
+
+        auto task = head_;
+        head_ = head_->next;
+        if (!head_)
+            tail_ = nullptr;
+        threading::mutex::unlock(mutex_);
+
+        task->func();
+        delete task;
+
+        return true;
+    }
+
+    bool thread_pool::pop_and_run_()
+    {
+        threading::mutex::lock(mutex_);
+
+        while (!head_ && !stop_)
+            threading::condvar::wait(condvar_, mutex_);
+
+        if (!head_)
+        {
+            threading::mutex::unlock(mutex_);
+
+            return false;
+        }
+
+        auto task = head_;
+        head_ = head_->next;
+        if (!head_)
+            tail_ = nullptr;
+        threading::mutex::unlock(mutex_);
+
+        task->func();
+        delete task;
+
+        return true;
+    }
+
+    ::helenos::errno_t thread_pool::worker_main_(void* arg)
+    {
+        auto self = static_cast<thread_pool*>(arg);
+
+        while (self->pop_and_run_())
+            ;
+
+        return EOK;
+    }
+}
@@ -30,7 +30,11 @@
  *
  * Implementation of AES-128 symmetric cipher cryptographic algorithm.
  *
- * Based on FIPS 197.
+ * Based on FIPS 197. The cipher rounds are computed with combined
+ * lookup tables (the round transformations collapse into four table
+ * lookups and four XORs per column) and are dispatched to the AES
+ * instruction set when the CPU provides it. An AES-CCM authenticated
+ * encryption mode is provided for packet protocols such as CCMP.
  */
 
 #include <stdbool.h>
@@ -219,56 +223,6 @@ static uint8_t sub_byte(uint8_t byte, bool inv)
 	return inv_sbox[i][j];
 }
 
-/** Perform substitution transformation on state table.
- *
- * @param state State table to be modified.
- * @param inv   Flag indicating whether to use inverse table.
- *
- */
-static void sub_bytes(uint8_t state[ELEMS][ELEMS], bool inv)
-{
-	uint8_t val;
-
-	for (size_t i = 0; i < ELEMS; i++) {
-		for (size_t j = 0; j < ELEMS; j++) {
-			val = state[i][j];
-			state[i][j] = sub_byte(val, inv);
-		}
-	}
-}
-
-/** Perform shift rows transformation on state table.
- *
- * @param state State table to be modified.
- *
- */
-static void shift_rows(uint8_t state[ELEMS][ELEMS])
-{
-	uint8_t temp[ELEMS];
-
-	for (size_t i = 1; i < ELEMS; i++) {
-		memcpy(temp, state[i], i);
-		memmove(state[i], state[i] + i, ELEMS - i);
-		memcpy(state[i] + ELEMS - i, temp, i);
-	}
-}
-
-/** Perform inverted shift rows transformation on state table.
- *
- * @param state State table to be modified.
- *
- */
-static void inv_shift_rows(uint8_t state[ELEMS][ELEMS])
-{
-	uint8_t temp[ELEMS];
-
-	for (size_t i = 1; i < ELEMS; i++) {
-		memcpy(temp, state[i], ELEMS - i);
-		memmove(state[i], state[i] + ELEMS - i, i);
-		memcpy(state[i] + i, temp, ELEMS - i);
-	}
-}
-
 /** Multiplication in GF(2^8).
  *
  * @param x First factor.
@@ -298,93 +252,66 @@ static uint8_t galois_mult(uint8_t x, uint8_t y)
 	return result;
 }
 
-/** Perform mix columns transformation on state table.
+/** Combined round lookup tables.
  *
- * @param state State table to be modified.
+ * enc_table[x] packs the products of the mix columns matrix with
+ * the substituted byte x into one word, most significant byte first:
+ * {02.S(x), S(x), S(x), 03.S(x)}. The tables for the remaining three
+ * column positions are byte rotations of this one. The dec_table
+ * analogously combines the inverse substitution with the inverse mix
+ * columns matrix: {0e.IS(x), 09.IS(x), 0d.IS(x), 0b.IS(x)}.
  *
+ * The tables are computed on first use from the substitution boxes
+ * above. Initialization is idempotent, so a concurrent first use is
+ * harmless.
  */
-static void mix_columns(uint8_t state[ELEMS][ELEMS])
+static uint32_t enc_table[256];
+static uint32_t dec_table[256];
+static bool tables_ready = false;
+
+/** Compute the combined round lookup tables. */
+static void prepare_tables(void)
 {
-	uint8_t orig_state[ELEMS][ELEMS];
-	memcpy(orig_state, state, BLOCK_LEN);
-
-	for (size_t j = 0; j < ELEMS; j++) {
-		state[0][j] =
-		    galois_mult(0x2, orig_state[0][j]) ^
-		    galois_mult(0x3, orig_state[1][j]) ^
-		    orig_state[2][j] ^
-		    orig_state[3][j];
-		state[1][j] =
-		    orig_state[0][j] ^
-		    galois_mult(0x2, orig_state[1][j]) ^
-		    galois_mult(0x3, orig_state[2][j]) ^
-		    orig_state[3][j];
-		state[2][j] =
-		    orig_state[0][j] ^
-		    orig_state[1][j] ^
-		    galois_mult(0x2, orig_state[2][j]) ^
-		    galois_mult(0x3, orig_state[3][j]);
-		state[3][j] =
-		    galois_mult(0x3, orig_state[0][j]) ^
-		    orig_state[1][j] ^
-		    orig_state[2][j] ^
-		    galois_mult(0x2, orig_state[3][j]);
+	if (tables_ready)
+		return;
+
+	for (unsigned int i = 0; i < 256; i++) {
+		uint8_t s = sub_byte((uint8_t) i, false);
+		uint8_t is = sub_byte((uint8_t) i, true);
+
+		enc_table[i] =
+		    ((uint32_t) galois_mult(0x2, s) << 24) |
+		    ((uint32_t) s << 16) |
+		    ((uint32_t) s << 8) |
+		    (uint32_t) galois_mult(0x3, s);
+		dec_table[i] =
+		    ((uint32_t) galois_mult(0x0e, is) << 24) |
+		    ((uint32_t) galois_mult(0x09, is) << 16) |
+		    ((uint32_t) galois_mult(0x0d, is) << 8) |
+		    (uint32_t) galois_mult(0x0b, is);
 	}
+
+	tables_ready = true;
 }
 
-/** Perform inverted mix columns transformation on state table.
+/** Apply inverse mix columns to one column word.
  *
- * @param state State table to be modified.
+ * Used to derive the decryption round keys for the equivalent
+ * inverse cipher. Since dec_table[i] holds the inverse mix columns
+ * matrix applied to IS(i), feeding it the forward substitution of a
+ * byte yields the matrix applied to the byte itself.
  *
- */
-static void inv_mix_columns(uint8_t state[ELEMS][ELEMS])
-{
-	uint8_t orig_state[ELEMS][ELEMS];
-	memcpy(orig_state, state, BLOCK_LEN);
-
-	for (size_t j = 0; j < ELEMS; j++) {
-		state[0][j] =
-		    galois_mult(0x0e, orig_state[0][j]) ^
-		    galois_mult(0x0b, orig_state[1][j]) ^
-		    galois_mult(0x0d, orig_state[2][j]) ^
-		    galois_mult(0x09, orig_state[3][j]);
-		state[1][j] =
-		    galois_mult(0x09, orig_state[0][j]) ^
-		    galois_mult(0x0e, orig_state[1][j]) ^
-		    galois_mult(0x0b, orig_state[2][j]) ^
-		    galois_mult(0x0d, orig_state[3][j]);
-		state[2][j] =
-		    galois_mult(0x0d, orig_state[0][j]) ^
-		    galois_mult(0x09, orig_state[1][j]) ^
-		    galois_mult(0x0e, orig_state[2][j]) ^
-		    galois_mult(0x0b, orig_state[3][j]);
-		state[3][j] =
-		    galois_mult(0x0b, orig_state[0][j]) ^
-		    galois_mult(0x0d, orig_state[1][j]) ^
-		    galois_mult(0x09, orig_state[2][j]) ^
-		    galois_mult(0x0e, orig_state[3][j]);
-	}
-}
-
-/** Perform round key transformation on state table.
+ * @param word Input column, most significant byte first.
  *
- * @param state     State table to be modified.
- * @param round_key Round key to be applied on state table.
+ * @return Transformed column.
  *
  */
-static void add_round_key(uint8_t state[ELEMS][ELEMS], uint32_t *round_key)
+static uint32_t inv_mix_word(uint32_t word)
 {
-	uint8_t byte_round;
-	uint8_t shift;
-	uint32_t mask = 0xff;
-
-	for (size_t j = 0; j < ELEMS; j++) {
-		for (size_t i = 0; i < ELEMS; i++) {
-			shift = 24 - 8 * i;
-			byte_round = (round_key[j] & (mask << shift)) >> shift;
-			state[i][j] = state[i][j] ^ byte_round;
-		}
-	}
+	return dec_table[sub_byte(word >> 24, false)] ^
+	    rotr_uint32(dec_table[sub_byte((word >> 16) & 0xff, false)], 8) ^
+	    rotr_uint32(dec_table[sub_byte((word >> 8) & 0xff, false)], 16) ^
+	    rotr_uint32(dec_table[sub_byte(word & 0xff, false)], 24);
 }
 
 /** Perform substitution transformation on given word.
@@ -447,6 +374,334 @@ static void key_expansion(uint8_t *key, uint32_t *key_exp)
 	}
 }
 
+/** Expanded AES cipher context.
+ *
+ * Holds the precomputed encryption round keys together with the
+ * round keys of the equivalent inverse cipher (reversed order, inner
+ * keys transformed by inverse mix columns), so that the expensive key
+ * schedule is computed once per key instead of once per block.
+ */
+typedef struct {
+	/** Encryption round keys */
+	uint32_t enc_key[ELEMS * (ROUNDS + 1)];
+	/** Decryption round keys in application order */
+	uint32_t dec_key[ELEMS * (ROUNDS + 1)];
+#ifdef __x86_64__
+	/** Encryption round keys serialized for the AES instructions */
+	uint8_t enc_bytes[ROUNDS + 1][BLOCK_LEN];
+	/** Decryption round keys serialized for the AES instructions */
+	uint8_t dec_bytes[ROUNDS + 1][BLOCK_LEN];
+	/** AES instruction set usable */
+	bool ni;
+#endif
+} aes_ctx_t;
+
+#ifdef __x86_64__
+
+/** Check whether the CPU implements the AES instruction set.
+ *
+ * @return True when AESENC and friends may be used.
+ *
+ */
+static bool aes_ni_supported(void)
+{
+	/* Cached CPUID result (-1 = not probed yet) */
+	static int ni_state = -1;
+
+	if (ni_state < 0) {
+		uint32_t eax, ebx, ecx, edx;
+
+		asm volatile (
+		    "cpuid\n"
+		    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+		    : "a" (1), "c" (0)
+		);
+
+		ni_state = (ecx >> 25) & 1;
+	}
+
+	return ni_state != 0;
+}
+
+/** Encrypt one block with the AES instruction set.
+ *
+ * @param round_key Serialized round keys.
+ * @param input     Plaintext block.
+ * @param output    Ciphertext block.
+ *
+ */
+static void aes_ni_encrypt(const uint8_t round_key[ROUNDS + 1][BLOCK_LEN],
+    const uint8_t *input, uint8_t *output)
+{
+	asm volatile (
+	    "movdqu (%[in]), %%xmm0\n"
+	    "movdqu 0x00(%[rk]), %%xmm1\n"
+	    "pxor %%xmm1, %%xmm0\n"
+	    "movdqu 0x10(%[rk]), %%xmm1\n"
+	    "aesenc %%xmm1, %%xmm0\n"
+	    "movdqu 0x20(%[rk]), %%xmm1\n"
+	    "aesenc %%xmm1, %%xmm0\n"
+	    "movdqu 0x30(%[rk]), %%xmm1\n"
+	    "aesenc %%xmm1, %%xmm0\n"
+	    "movdqu 0x40(%[rk]), %%xmm1\n"
+	    "aesenc %%xmm1, %%xmm0\n"
+	    "movdqu 0x50(%[rk]), %%xmm1\n"
+	    "aesenc %%xmm1, %%xmm0\n"
+	    "movdqu 0x60(%[rk]), %%xmm1\n"
+	    "aesenc %%xmm1, %%xmm0\n"
+	    "movdqu 0x70(%[rk]), %%xmm1\n"
+	    "aesenc %%xmm1, %%xmm0\n"
+	    "movdqu 0x80(%[rk]), %%xmm1\n"
+	    "aesenc %%xmm1, %%xmm0\n"
+	    "movdqu 0x90(%[rk]), %%xmm1\n"
+	    "aesenc %%xmm1, %%xmm0\n"
+	    "movdqu 0xa0(%[rk]), %%xmm1\n"
+	    "aesenclast %%xmm1, %%xmm0\n"
+	    "movdqu %%xmm0, (%[out])\n"
+	    :
+	    : [in] "r" (input), [rk] "r" (round_key), [out] "r" (output)
+	    : "xmm0", "xmm1", "memory"
+	);
+}
+
+/** Decrypt one block with the AES instruction set.
+ *
+ * @param round_key Serialized decryption round keys.
+ * @param input     Ciphertext block.
+ * @param output    Plaintext block.
+ *
+ */
+static void aes_ni_decrypt(const uint8_t round_key[ROUNDS + 1][BLOCK_LEN],
+    const uint8_t *input, uint8_t *output)
+{
+	asm volatile (
+	    "movdqu (%[in]), %%xmm0\n"
+	    "movdqu 0x00(%[rk]), %%xmm1\n"
+	    "pxor %%xmm1, %%xmm0\n"
+	    "movdqu 0x10(%[rk]), %%xmm1\n"
+	    "aesdec %%xmm1, %%xmm0\n"
+	    "movdqu 0x20(%[rk]), %%xmm1\n"
+	    "aesdec %%xmm1, %%xmm0\n"
+	    "movdqu 0x30(%[rk]), %%xmm1\n"
+	    "aesdec %%xmm1, %%xmm0\n"
+	    "movdqu 0x40(%[rk]), %%xmm1\n"
+	    "aesdec %%xmm1, %%xmm0\n"
+	    "movdqu 0x50(%[rk]), %%xmm1\n"
+	    "aesdec %%xmm1, %%xmm0\n"
+	    "movdqu 0x60(%[rk]), %%xmm1\n"
+	    "aesdec %%xmm1, %%xmm0\n"
+	    "movdqu 0x70(%[rk]), %%xmm1\n"
+	    "aesdec %%xmm1, %%xmm0\n"
+	    "movdqu 0x80(%[rk]), %%xmm1\n"
+	    "aesdec %%xmm1, %%xmm0\n"
+	    "movdqu 0x90(%[rk]), %%xmm1\n"
+	    "aesdec %%xmm1, %%xmm0\n"
+	    "movdqu 0xa0(%[rk]), %%xmm1\n"
+	    "aesdeclast %%xmm1, %%xmm0\n"
+	    "movdqu %%xmm0, (%[out])\n"
+	    :
+	    : [in] "r" (input), [rk] "r" (round_key), [out] "r" (output)
+	    : "xmm0", "xmm1", "memory"
+	);
+}
+
+#endif /* __x86_64__ */
+
+/** Initialize cipher context from raw key.
+ *
+ * @param ctx     Cipher context to be initialized.
+ * @param key     Input key.
+ * @param decrypt Flag indicating whether the decryption round keys
+ *                are needed as well.
+ *
+ */
+static void aes_ctx_init(aes_ctx_t *ctx, const uint8_t *key, bool decrypt)
+{
+	prepare_tables();
+	key_expansion((uint8_t *) key, ctx->enc_key);
+
+	/*
+	 * Round keys for the equivalent inverse cipher: reversed order,
+	 * all but the first and last transformed by inverse mix columns.
+	 */
+	if (decrypt) {
+		for (size_t r = 0; r <= ROUNDS; r++) {
+			for (size_t c = 0; c < ELEMS; c++) {
+				uint32_t word =
+				    ctx->enc_key[(ROUNDS - r) * ELEMS + c];
+
+				if ((r != 0) && (r != ROUNDS))
+					word = inv_mix_word(word);
+
+				ctx->dec_key[r * ELEMS + c] = word;
+			}
+		}
+	}
+
+#ifdef __x86_64__
+	ctx->ni = aes_ni_supported();
+
+	if (ctx->ni) {
+		for (size_t r = 0; r <= ROUNDS; r++) {
+			for (size_t c = 0; c < ELEMS; c++) {
+				uint32_t ew = ctx->enc_key[r * ELEMS + c];
+
+				ctx->enc_bytes[r][4 * c] = ew >> 24;
+				ctx->enc_bytes[r][4 * c + 1] = ew >> 16;
+				ctx->enc_bytes[r][4 * c + 2] = ew >> 8;
+				ctx->enc_bytes[r][4 * c + 3] = ew;
+
+				if (!decrypt)
+					continue;
+
+				uint32_t dw = ctx->dec_key[r * ELEMS + c];
+
+				ctx->dec_bytes[r][4 * c] = dw >> 24;
+				ctx->dec_bytes[r][4 * c + 1] = dw >> 16;
+				ctx->dec_bytes[r][4 * c + 2] = dw >> 8;
+				ctx->dec_bytes[r][4 * c + 3] = dw;
+			}
+		}
+	}
+#endif
+}
+
+/** Encrypt one block using the combined lookup tables.
+ *
+ * @param ctx    Cipher context.
+ * @param input  Plaintext block.
+ * @param output Ciphertext block.
+ *
+ */
+static void table_encrypt(const aes_ctx_t *ctx, const uint8_t *input,
+    uint8_t *output)
+{
+	uint32_t s[ELEMS];
+	uint32_t t[ELEMS];
+
+	for (size_t c = 0; c < ELEMS; c++) {
+		s[c] = (((uint32_t) input[4 * c] << 24) |
+		    ((uint32_t) input[4 * c + 1] << 16) |
+		    ((uint32_t) input[4 * c + 2] << 8) |
+		    (uint32_t) input[4 * c + 3]) ^ ctx->enc_key[c];
+	}
+
+	for (size_t r = 1; r < ROUNDS; r++) {
+		const uint32_t *rk = ctx->enc_key + r * ELEMS;
+
+		for (size_t c = 0; c < ELEMS; c++) {
+			t[c] = enc_table[s[c] >> 24] ^
+			    rotr_uint32(enc_table[(s[(c + 1) & 3] >> 16) & 0xff], 8) ^
+			    rotr_uint32(enc_table[(s[(c + 2) & 3] >> 8) & 0xff], 16) ^
+			    rotr_uint32(enc_table[s[(c + 3) & 3] & 0xff], 24) ^
+			    rk[c];
+		}
+
+		memcpy(s, t, sizeof(s));
+	}
+
+	for (size_t c = 0; c < ELEMS; c++) {
+		uint32_t word =
+		    (((uint32_t) sub_byte(s[c] >> 24, false) << 24) |
+		    ((uint32_t) sub_byte((s[(c + 1) & 3] >> 16) & 0xff, false) << 16) |
+		    ((uint32_t) sub_byte((s[(c + 2) & 3] >> 8) & 0xff, false) << 8) |
+		    (uint32_t) sub_byte(s[(c + 3) & 3] & 0xff, false)) ^
+		    ctx->enc_key[ROUNDS * ELEMS + c];
+
+		output[4 * c] = word >> 24;
+		output[4 * c + 1] = word >> 16;
+		output[4 * c + 2] = word >> 8;
+		output[4 * c + 3] = word;
+	}
+}
+
+/** Decrypt one block using the combined lookup tables.
+ *
+ * @param ctx    Cipher context.
+ * @param input  Ciphertext block.
+ * @param output Plaintext block.
+ *
+ */
+static void table_decrypt(const aes_ctx_t *ctx, const uint8_t *input,
+    uint8_t *output)
+{
+	uint32_t s[ELEMS];
+	uint32_t t[ELEMS];
+
+	for (size_t c = 0; c < ELEMS; c++) {
+		s[c] = (((uint32_t) input[4 * c] << 24) |
+		    ((uint32_t) input[4 * c + 1] << 16) |
+		    ((uint32_t) input[4 * c + 2] << 8) |
+		    (uint32_t) input[4 * c + 3]) ^ ctx->dec_key[c];
+	}
+
+	for (size_t r = 1; r < ROUNDS; r++) {
+		const uint32_t *rk = ctx->dec_key + r * ELEMS;
+
+		for (size_t c = 0; c < ELEMS; c++) {
+			t[c] = dec_table[s[c] >> 24] ^
+			    rotr_uint32(dec_table[(s[(c + 3) & 3] >> 16) & 0xff], 8) ^
+			    rotr_uint32(dec_table[(s[(c + 2) & 3] >> 8) & 0xff], 16) ^
+			    rotr_uint32(dec_table[s[(c + 1) & 3] & 0xff], 24) ^
+			    rk[c];
+		}
+
+		memcpy(s, t, sizeof(s));
+	}
+
+	for (size_t c = 0; c < ELEMS; c++) {
+		uint32_t word =
+		    (((uint32_t) sub_byte(s[c] >> 24, true) << 24) |
+		    ((uint32_t) sub_byte((s[(c + 3) & 3] >> 16) & 0xff, true) << 16) |
+		    ((uint32_t) sub_byte((s[(c + 2) & 3] >> 8) & 0xff, true) << 8) |
+		    (uint32_t) sub_byte(s[(c + 1) & 3] & 0xff, true)) ^
+		    ctx->dec_key[ROUNDS * ELEMS + c];
+
+		output[4 * c] = word >> 24;
+		output[4 * c + 1] = word >> 16;
+		output[4 * c + 2] = word >> 8;
+		output[4 * c + 3] = word;
+	}
+}
+
+/** Encrypt one block, using hardware support when available.
+ *
+ * @param ctx    Cipher context.
+ * @param input  Plaintext block.
+ * @param output Ciphertext block.
+ *
+ */
+static void aes_block_encrypt(const aes_ctx_t *ctx, const uint8_t *input,
+    uint8_t *output)
+{
+#ifdef __x86_64__
+	if (ctx->ni) {
+		aes_ni_encrypt(ctx->enc_bytes, input, output);
+		return;
+	}
+#endif
+	table_encrypt(ctx, input, output);
+}
+
+/** Decrypt one block, using hardware support when available.
+ *
+ * @param ctx    Cipher context.
+ * @param input  Ciphertext block.
+ * @param output Plaintext block.
+ *
+ */
+static void aes_block_decrypt(const aes_ctx_t *ctx, const uint8_t *input,
+    uint8_t *output)
+{
+#ifdef __x86_64__
+	if (ctx->ni) {
+		aes_ni_decrypt(ctx->dec_bytes, input, output);
+		return;
+	}
+#endif
+	table_decrypt(ctx, input, output);
+}
+
 /** AES-128 encryption algorithm.
  *
  * @param key    Input key.
@@ -466,35 +721,9 @@ errno_t aes_encrypt(uint8_t *key, uint8_t *input, uint8_t *output)
 	if (!output)
 		return ENOMEM;
 
-	/* Create key expansion. */
-	uint32_t key_exp[ELEMS * (ROUNDS + 1)];
-	key_expansion(key, key_exp);
-
-	/* Copy input into state array. */
-	uint8_t state[ELEMS][ELEMS];
-	for (size_t i = 0; i < ELEMS; i++) {
-		for (size_t j = 0; j < ELEMS; j++)
-			state[i][j] = input[i + ELEMS * j];
-	}
-
-	/* Processing loop. */
-	add_round_key(state, key_exp);
-
-	for (size_t k = 1; k <= ROUNDS; k++) {
-		sub_bytes(state, false);
-		shift_rows(state);
-
-		if (k < ROUNDS)
-			mix_columns(state);
-
-		add_round_key(state, key_exp + k * ELEMS);
-	}
-
-	/* Copy state array into output. */
-	for (size_t i = 0; i < ELEMS; i++) {
-		for (size_t j = 0; j < ELEMS; j++)
-			output[i + j * ELEMS] = state[i][j];
-	}
+	aes_ctx_t ctx;
+	aes_ctx_init(&ctx, key, false);
+	aes_block_encrypt(&ctx, input, output);
 
 	return EOK;
 }
@@ -518,33 +747,243 @@ errno_t aes_decrypt(uint8_t *key, uint8_t *input, uint8_t *output)
 	if (!output)
 		return ENOMEM;
 
-	/* Create key expansion. */
-	uint32_t key_exp[ELEMS * (ROUNDS + 1)];
-	key_expansion(key, key_exp);
+	aes_ctx_t ctx;
+	aes_ctx_init(&ctx, key, true);
+	aes_block_decrypt(&ctx, input, output);
+
+	return EOK;
+}
+
+/** Check CCM mode parameters.
+ *
+ * @param nonce_len Nonce length in bytes.
+ * @param aad_len   Additional authenticated data length in bytes.
+ * @param data_len  Payload length in bytes.
+ * @param mic_len   Authentication tag length in bytes.
+ *
+ * @return EOK when the parameters are valid, EINVAL otherwise.
+ *
+ */
+static errno_t ccm_check_params(size_t nonce_len, size_t aad_len,
+    size_t data_len, size_t mic_len)
+{
+	/* The counter field occupies the bytes not used by the nonce. */
+	if ((nonce_len < 7) || (nonce_len > 13))
+		return EINVAL;
+
+	if ((mic_len < 4) || (mic_len > BLOCK_LEN) || (mic_len % 2 != 0))
+		return EINVAL;
+
+	/* Longer AAD would need the extended length encoding. */
+	if (aad_len >= 0xff00)
+		return EINVAL;
+
+	/* The payload length has to fit into the counter field. */
+	size_t len_size = 15 - nonce_len;
+	if ((len_size < sizeof(size_t)) && ((data_len >> (8 * len_size)) != 0))
+		return EINVAL;
+
+	return EOK;
+}
+
+/** Run the CCM counter mode and CBC-MAC computation.
+ *
+ * @param ctx       Cipher context.
+ * @param nonce     Nonce.
+ * @param nonce_len Nonce length in bytes.
+ * @param aad       Additional authenticated data (possibly NULL).
+ * @param aad_len   Additional authenticated data length in bytes.
+ * @param input     Input data.
+ * @param data_len  Payload length in bytes.
+ * @param output    Output data.
+ * @param mic_len   Authentication tag length in bytes.
+ * @param decrypt   Flag indicating the direction of the transform.
+ * @param tag       Computed (encrypted) authentication tag, mic_len bytes.
+ *
+ */
+static void ccm_crypt(const aes_ctx_t *ctx, const uint8_t *nonce,
+    size_t nonce_len, const uint8_t *aad, size_t aad_len,
+    const uint8_t *input, size_t data_len, uint8_t *output,
+    size_t mic_len, bool decrypt, uint8_t *tag)
+{
+	size_t len_size = 15 - nonce_len;
+	uint8_t x[BLOCK_LEN];
+	uint8_t b[BLOCK_LEN];
+	uint8_t a[BLOCK_LEN];
+	uint8_t s[BLOCK_LEN];
+
+	/* First authentication block carrying the parameters. */
+	b[0] = ((aad_len > 0) ? 0x40 : 0x00) |
+	    (((mic_len - 2) / 2) << 3) | (len_size - 1);
+	memcpy(b + 1, nonce, nonce_len);
+
+	size_t len = data_len;
+	for (size_t i = 0; i < len_size; i++) {
+		b[15 - i] = len & 0xff;
+		len >>= 8;
+	}
+
+	aes_block_encrypt(ctx, b, x);
+
+	/* Authenticate the additional data, prefixed with its length. */
+	if (aad_len > 0) {
+		size_t offset = 2;
+
+		memset(b, 0, BLOCK_LEN);
+		b[0] = (aad_len >> 8) & 0xff;
+		b[1] = aad_len & 0xff;
+
+		for (size_t i = 0; i < aad_len; i++) {
+			b[offset++] = aad[i];
 
-	/* Copy input into state array. */
-	uint8_t state[ELEMS][ELEMS];
-	for (size_t i = 0; i < ELEMS; i++) {
-		for (size_t j = 0; j < ELEMS; j++)
-			state[i][j] = input[i + ELEMS * j];
+			if ((offset == BLOCK_LEN) || (i == aad_len - 1)) {
+				for (size_t j = 0; j < offset; j++)
+					x[j] ^= b[j];
+
+				aes_block_encrypt(ctx, x, x);
+				memset(b, 0, BLOCK_LEN);
+				offset = 0;
+			}
+		}
 	}
 
-	/* Processing loop. */
-	add_round_key(state, key_exp + ROUNDS * ELEMS);
+	/* Counter block template. */
+	memset(a, 0, BLOCK_LEN);
+	a[0] = len_size - 1;
+	memcpy(a + 1, nonce, nonce_len);
+
+	/* Keystream block zero encrypts the authentication tag. */
+	uint8_t s0[BLOCK_LEN];
+	aes_block_encrypt(ctx, a, s0);
+
+	/* Transform the payload and authenticate the plaintext. */
+	size_t counter = 0;
+	for (size_t pos = 0; pos < data_len; pos += BLOCK_LEN) {
+		size_t chunk = data_len - pos;
+		if (chunk > BLOCK_LEN)
+			chunk = BLOCK_LEN;
+
+		counter++;
+		size_t cnt = counter;
+		for (size_t i = 0; i < len_size; i++) {
+			a[15 - i] = cnt & 0xff;
+			cnt >>= 8;
+		}
+
+		aes_block_encrypt(ctx, a, s);
+
+		for (size_t i = 0; i < chunk; i++)
+			output[pos + i] = input[pos + i] ^ s[i];
 
-	for (int k = ROUNDS - 1; k >= 0; k--) {
-		inv_shift_rows(state);
-		sub_bytes(state, true);
-		add_round_key(state, key_exp + k * ELEMS);
+		const uint8_t *plain = decrypt ? output : input;
+		for (size_t i = 0; i < chunk; i++)
+			x[i] ^= plain[pos + i];
 
-		if (k > 0)
-			inv_mix_columns(state);
+		aes_block_encrypt(ctx, x, x);
 	}
 
-	/* Copy state array into output. */
-	for (size_t i = 0; i < ELEMS; i++) {
-		for (size_t j = 0; j < ELEMS; j++)
-			output[i + j * ELEMS] = state[i][j];
+	for (size_t i = 0; i < mic_len; i++)
+		tag[i] = x[i] ^ s0[i];
+}
+
+/** AES-128 CCM authenticated encryption.
+ *
+ * Encrypts the payload in counter mode and computes the CBC-MAC
+ * authentication tag over the parameters, the additional data and
+ * the plaintext (RFC 3610). Suitable for CCMP with an 8 byte tag
+ * and a 13 byte nonce.
+ *
+ * @param key       Input key.
+ * @param nonce     Nonce, 7 - 13 bytes.
+ * @param nonce_len Nonce length in bytes.
+ * @param aad       Additional authenticated data (possibly NULL).
+ * @param aad_len   Additional authenticated data length in bytes.
+ * @param input     Plaintext payload.
+ * @param data_len  Payload length in bytes.
+ * @param output    Ciphertext payload, data_len bytes.
+ * @param mic       Output authentication tag.
+ * @param mic_len   Authentication tag length, even, 4 - 16 bytes.
+ *
+ * @return EINVAL when a parameter is not specified or out of range,
+ *         ENOMEM when pointer for output is not allocated,
+ *         otherwise EOK.
+ *
+ */
+errno_t aes_ccm_encrypt(uint8_t *key, uint8_t *nonce, size_t nonce_len,
+    uint8_t *aad, size_t aad_len, uint8_t *input, size_t data_len,
+    uint8_t *output, uint8_t *mic, size_t mic_len)
+{
+	if ((!key) || (!nonce) || ((!input) && (data_len > 0)))
+		return EINVAL;
+
+	if (((!output) && (data_len > 0)) || (!mic))
+		return ENOMEM;
+
+	errno_t rc = ccm_check_params(nonce_len, aad_len, data_len, mic_len);
+	if (rc != EOK)
+		return rc;
+
+	aes_ctx_t ctx;
+	aes_ctx_init(&ctx, key, false);
+
+	ccm_crypt(&ctx, nonce, nonce_len, aad, aad_len, input, data_len,
+	    output, mic_len, false, mic);
+
+	return EOK;
+}
+
+/** AES-128 CCM authenticated decryption.
+ *
+ * Decrypts the payload in counter mode and verifies the CBC-MAC
+ * authentication tag. When the tag does not match, the output
+ * buffer is cleared and no plaintext is disclosed.
+ *
+ * @param key       Input key.
+ * @param nonce     Nonce, 7 - 13 bytes.
+ * @param nonce_len Nonce length in bytes.
+ * @param aad       Additional authenticated data (possibly NULL).
+ * @param aad_len   Additional authenticated data length in bytes.
+ * @param input     Ciphertext payload.
+ * @param data_len  Payload length in bytes.
+ * @param output    Plaintext payload, data_len bytes.
+ * @param mic       Authentication tag to be verified.
+ * @param mic_len   Authentication tag length, even, 4 - 16 bytes.
+ *
+ * @return EINVAL when a parameter is out of range or the
+ *         authentication tag does not match,
+ *         ENOMEM when pointer for output is not allocated,
+ *         otherwise EOK.
+ *
+ */
+errno_t aes_ccm_decrypt(uint8_t *key, uint8_t *nonce, size_t nonce_len,
+    uint8_t *aad, size_t aad_len, uint8_t *input, size_t data_len,
+    uint8_t *output, uint8_t *mic, size_t mic_len)
+{
+	if ((!key) || (!nonce) || ((!input) && (data_len > 0)) || (!mic))
+		return EINVAL;
+
+	if ((!output) && (data_len > 0))
+		return ENOMEM;
+
+	errno_t rc = ccm_check_params(nonce_len, aad_len, data_len, mic_len);
+	if (rc != EOK)
+		return rc;
+
+	aes_ctx_t ctx;
+	aes_ctx_init(&ctx, key, false);
+
+	uint8_t tag[BLOCK_LEN];
+	ccm_crypt(&ctx, nonce, nonce_len, aad, aad_len, input, data_len,
+	    output, mic_len, true, tag);
+
+	/* Constant-time tag comparison. */
+	uint8_t diff = 0;
+	for (size_t i = 0; i < mic_len; i++)
+		diff |= tag[i] ^ mic[i];
+
+	if (diff != 0) {
+		memset(output, 0, data_len);
+		return EINVAL;
 	}
 
 	return EOK;
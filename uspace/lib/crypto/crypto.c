@@ -92,7 +92,24 @@ static const uint32_t md5_sbox[] = {
 	0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
 };
 
+/** Non-linear functions of the MD5 round stages. */
+#define MD5_F(b, c, d)  (((b) & (c)) | (~(b) & (d)))
+#define MD5_G(b, c, d)  (((b) & (d)) | ((c) & ~(d)))
+#define MD5_H(b, c, d)  ((b) ^ (c) ^ (d))
+#define MD5_I(b, c, d)  ((c) ^ ((b) | ~(d)))
+
+/** One MD5 step with the working variables in their natural roles. */
+#define MD5_STEP(f, a, b, c, d, k, g) \
+	do { \
+		(a) += (f) + md5_sbox[k] + x[g]; \
+		(a) = (b) + rotl_uint32((a), md5_shift[k]); \
+	} while (0)
+
 /** Working procedure of MD5 cryptographic hash function.
+ *
+ * The four stages are unrolled by the role rotation of the working
+ * variables, which avoids both the per-step stage dispatch and the
+ * shuffle of a working array.
  *
  * @param h         Working array with interim hash parts values.
  * @param sched_arr Input array with scheduled values from input string.
@@ -100,40 +117,67 @@ static const uint32_t md5_sbox[] = {
  */
 static void md5_proc(uint32_t *h, uint32_t *sched_arr)
 {
-	uint32_t f, g, temp;
-	uint32_t w[HASH_MD5 / 4];
-
-	memcpy(w, h, (HASH_MD5 / 4) * sizeof(uint32_t));
-
-	for (size_t k = 0; k < 64; k++) {
-		if (k < 16) {
-			f = (w[1] & w[2]) | (~w[1] & w[3]);
-			g = k;
-		} else if ((k >= 16) && (k < 32)) {
-			f = (w[1] & w[3]) | (w[2] & ~w[3]);
-			g = (5 * k + 1) % 16;
-		} else if ((k >= 32) && (k < 48)) {
-			f = w[1] ^ w[2] ^ w[3];
-			g = (3 * k + 5) % 16;
-		} else {
-			f = w[2] ^ (w[1] | ~w[3]);
-			g = 7 * k % 16;
-		}
+	uint32_t x[16];
+
+	for (size_t k = 0; k < 16; k++)
+		x[k] = uint32_t_byteorder_swap(sched_arr[k]);
+
+	uint32_t a = h[0];
+	uint32_t b = h[1];
+	uint32_t c = h[2];
+	uint32_t d = h[3];
+
+	for (size_t k = 0; k < 16; k += 4) {
+		MD5_STEP(MD5_F(b, c, d), a, b, c, d, k, k);
+		MD5_STEP(MD5_F(a, b, c), d, a, b, c, k + 1, k + 1);
+		MD5_STEP(MD5_F(d, a, b), c, d, a, b, k + 2, k + 2);
+		MD5_STEP(MD5_F(c, d, a), b, c, d, a, k + 3, k + 3);
+	}
+
+	for (size_t k = 16; k < 32; k += 4) {
+		MD5_STEP(MD5_G(b, c, d), a, b, c, d, k, (5 * k + 1) & 15);
+		MD5_STEP(MD5_G(a, b, c), d, a, b, c, k + 1, (5 * k + 6) & 15);
+		MD5_STEP(MD5_G(d, a, b), c, d, a, b, k + 2, (5 * k + 11) & 15);
+		MD5_STEP(MD5_G(c, d, a), b, c, d, a, k + 3, (5 * k + 16) & 15);
+	}
+
+	for (size_t k = 32; k < 48; k += 4) {
+		MD5_STEP(MD5_H(b, c, d), a, b, c, d, k, (3 * k + 5) & 15);
+		MD5_STEP(MD5_H(a, b, c), d, a, b, c, k + 1, (3 * k + 8) & 15);
+		MD5_STEP(MD5_H(d, a, b), c, d, a, b, k + 2, (3 * k + 11) & 15);
+		MD5_STEP(MD5_H(c, d, a), b, c, d, a, k + 3, (3 * k + 14) & 15);
+	}
 
-		temp = w[3];
-		w[3] = w[2];
-		w[2] = w[1];
-		w[1] += rotl_uint32(w[0] + f + md5_sbox[k] +
-		    uint32_t_byteorder_swap(sched_arr[g]),
-		    md5_shift[k]);
-		w[0] = temp;
+	for (size_t k = 48; k < 64; k += 4) {
+		MD5_STEP(MD5_I(b, c, d), a, b, c, d, k, (7 * k) & 15);
+		MD5_STEP(MD5_I(a, b, c), d, a, b, c, k + 1, (7 * k + 7) & 15);
+		MD5_STEP(MD5_I(d, a, b), c, d, a, b, k + 2, (7 * k + 14) & 15);
+		MD5_STEP(MD5_I(c, d, a), b, c, d, a, k + 3, (7 * k + 21) & 15);
 	}
 
-	for (uint8_t k = 0; k < HASH_MD5 / 4; k++)
-		h[k] += w[k];
+	h[0] += a;
+	h[1] += b;
+	h[2] += c;
+	h[3] += d;
 }
 
+/** Non-linear functions of the SHA-1 round stages. */
+#define SHA1_CH(b, c, d)   (((b) & (c)) | (~(b) & (d)))
+#define SHA1_PAR(b, c, d)  ((b) ^ (c) ^ (d))
+#define SHA1_MAJ(b, c, d)  (((b) & (c)) | ((b) & (d)) | ((c) & (d)))
+
+/** One SHA-1 step with the working variables in their natural roles. */
+#define SHA1_STEP(f, cf, a, b, c, d, e, k) \
+	do { \
+		(e) += rotl_uint32((a), 5) + (f) + (cf) + sched_arr[k]; \
+		(b) = rotl_uint32((b), 30); \
+	} while (0)
+
 /** Working procedure of SHA-1 cryptographic hash function.
+ *
+ * The four stages are unrolled by the role rotation of the working
+ * variables, which avoids both the per-step stage dispatch and the
+ * shuffle of a working array.
  *
  * @param h         Working array with interim hash parts values.
  * @param sched_arr Input array with scheduled values from input string.
@@ -141,9 +185,6 @@ static void md5_proc(uint32_t *h, uint32_t *sched_arr)
  */
 static void sha1_proc(uint32_t *h, uint32_t *sched_arr)
 {
-	uint32_t f, cf, temp;
-	uint32_t w[HASH_SHA1 / 4];
-
 	for (size_t k = 16; k < 80; k++) {
 		sched_arr[k] = rotl_uint32(
 		    sched_arr[k - 3] ^
@@ -153,34 +194,49 @@ static void sha1_proc(uint32_t *h, uint32_t *sched_arr)
 		    1);
 	}
 
-	memcpy(w, h, (HASH_SHA1 / 4) * sizeof(uint32_t));
-
-	for (size_t k = 0; k < 80; k++) {
-		if (k < 20) {
-			f = (w[1] & w[2]) | (~w[1] & w[3]);
-			cf = 0x5A827999;
-		} else if ((k >= 20) && (k < 40)) {
-			f = w[1] ^ w[2] ^ w[3];
-			cf = 0x6ed9eba1;
-		} else if ((k >= 40) && (k < 60)) {
-			f = (w[1] & w[2]) | (w[1] & w[3]) | (w[2] & w[3]);
-			cf = 0x8f1bbcdc;
-		} else {
-			f = w[1] ^ w[2] ^ w[3];
-			cf = 0xca62c1d6;
-		}
+	uint32_t a = h[0];
+	uint32_t b = h[1];
+	uint32_t c = h[2];
+	uint32_t d = h[3];
+	uint32_t e = h[4];
+
+	for (size_t k = 0; k < 20; k += 5) {
+		SHA1_STEP(SHA1_CH(b, c, d), 0x5a827999, a, b, c, d, e, k);
+		SHA1_STEP(SHA1_CH(a, b, c), 0x5a827999, e, a, b, c, d, k + 1);
+		SHA1_STEP(SHA1_CH(e, a, b), 0x5a827999, d, e, a, b, c, k + 2);
+		SHA1_STEP(SHA1_CH(d, e, a), 0x5a827999, c, d, e, a, b, k + 3);
+		SHA1_STEP(SHA1_CH(c, d, e), 0x5a827999, b, c, d, e, a, k + 4);
+	}
 
-		temp = rotl_uint32(w[0], 5) + f + w[4] + cf + sched_arr[k];
+	for (size_t k = 20; k < 40; k += 5) {
+		SHA1_STEP(SHA1_PAR(b, c, d), 0x6ed9eba1, a, b, c, d, e, k);
+		SHA1_STEP(SHA1_PAR(a, b, c), 0x6ed9eba1, e, a, b, c, d, k + 1);
+		SHA1_STEP(SHA1_PAR(e, a, b), 0x6ed9eba1, d, e, a, b, c, k + 2);
+		SHA1_STEP(SHA1_PAR(d, e, a), 0x6ed9eba1, c, d, e, a, b, k + 3);
+		SHA1_STEP(SHA1_PAR(c, d, e), 0x6ed9eba1, b, c, d, e, a, k + 4);
+	}
+
+	for (size_t k = 40; k < 60; k += 5) {
+		SHA1_STEP(SHA1_MAJ(b, c, d), 0x8f1bbcdc, a, b, c, d, e, k);
+		SHA1_STEP(SHA1_MAJ(a, b, c), 0x8f1bbcdc, e, a, b, c, d, k + 1);
+		SHA1_STEP(SHA1_MAJ(e, a, b), 0x8f1bbcdc, d, e, a, b, c, k + 2);
+		SHA1_STEP(SHA1_MAJ(d, e, a), 0x8f1bbcdc, c, d, e, a, b, k + 3);
+		SHA1_STEP(SHA1_MAJ(c, d, e), 0x8f1bbcdc, b, c, d, e, a, k + 4);
+	}
 
-		w[4] = w[3];
-		w[3] = w[2];
-		w[2] = rotl_uint32(w[1], 30);
-		w[1] = w[0];
-		w[0] = temp;
+	for (size_t k = 60; k < 80; k += 5) {
+		SHA1_STEP(SHA1_PAR(b, c, d), 0xca62c1d6, a, b, c, d, e, k);
+		SHA1_STEP(SHA1_PAR(a, b, c), 0xca62c1d6, e, a, b, c, d, k + 1);
+		SHA1_STEP(SHA1_PAR(e, a, b), 0xca62c1d6, d, e, a, b, c, k + 2);
+		SHA1_STEP(SHA1_PAR(d, e, a), 0xca62c1d6, c, d, e, a, b, k + 3);
+		SHA1_STEP(SHA1_PAR(c, d, e), 0xca62c1d6, b, c, d, e, a, k + 4);
 	}
 
-	for (uint8_t k = 0; k < HASH_SHA1 / 4; k++)
-		h[k] += w[k];
+	h[0] += a;
+	h[1] += b;
+	h[2] += c;
+	h[3] += d;
+	h[4] += e;
 }
 
 /** Create hash based on selected algorithm.
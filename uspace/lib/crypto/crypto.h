@@ -53,10 +53,17 @@ typedef enum {
 extern errno_t rc4(uint8_t *, size_t, uint8_t *, size_t, size_t, uint8_t *);
 extern errno_t aes_encrypt(uint8_t *, uint8_t *, uint8_t *);
 extern errno_t aes_decrypt(uint8_t *, uint8_t *, uint8_t *);
+extern errno_t aes_ccm_encrypt(uint8_t *, uint8_t *, size_t, uint8_t *, size_t,
+    uint8_t *, size_t, uint8_t *, uint8_t *, size_t);
+extern errno_t aes_ccm_decrypt(uint8_t *, uint8_t *, size_t, uint8_t *, size_t,
+    uint8_t *, size_t, uint8_t *, uint8_t *, size_t);
 extern errno_t create_hash(uint8_t *, size_t, uint8_t *, hash_func_t);
 extern errno_t hmac(uint8_t *, size_t, uint8_t *, size_t, uint8_t *, hash_func_t);
 extern errno_t pbkdf2(uint8_t *, size_t, uint8_t *, size_t, uint8_t *);
 
 extern uint16_t crc16_ibm(uint16_t crc, uint8_t *buf, size_t len);
 
+extern uint32_t crc32_ieee(uint32_t crc, uint8_t *buf, size_t len);
+extern uint32_t crc32c(uint32_t crc, uint8_t *buf, size_t len);
+
 #endif
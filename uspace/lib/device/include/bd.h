@@ -35,19 +35,93 @@
 #ifndef LIBDEVICE_BD_H
 #define LIBDEVICE_BD_H
 
+#include <adt/list.h>
 #include <async.h>
+#include <fibril_synch.h>
 #include <offset.h>
+#include <stdbool.h>
 
-typedef struct {
+typedef struct bd {
 	async_sess_t *sess;
+	/** Protects the list of outstanding asynchronous requests. */
+	fibril_mutex_t areq_lock;
+	/** Signals completion of an asynchronous request. */
+	fibril_condvar_t areq_cv;
+	/** List of outstanding asynchronous requests (of bd_req_t). */
+	list_t areqs;
+	/** ID for the next asynchronous request. */
+	sysarg_t next_id;
+	/** Client mapping of the shared DMA buffer (NULL if none). */
+	void *dma_buf;
+	/** Size of the shared DMA buffer in bytes. */
+	size_t dma_buf_size;
+	/** Read-only mapping of the server's backing area (NULL if none). */
+	void *shared_area;
+	/** Size of the backing area in bytes. */
+	size_t shared_area_size;
+	/** Block size of the device backing the shared area. */
+	size_t shared_area_bsize;
+	/** Passthrough session to the underlying device (NULL if none). */
+	async_sess_t *pt_sess;
+	/** Block device handle on the passthrough session. */
+	struct bd *pt_bd;
+	/** First block of this device within the underlying device. */
+	aoff64_t pt_base;
+	/** Number of blocks accessible through the passthrough session. */
+	aoff64_t pt_nblocks;
 } bd_t;
 
+/** Asynchronous block device request.
+ *
+ * Allocated by the caller and must stay valid from submission until
+ * the request is collected by bd_wait().
+ */
+typedef struct {
+	/** Link to the list of outstanding requests. */
+	link_t link;
+	/** Request ID. */
+	sysarg_t id;
+	/** Destination buffer (read requests only). */
+	void *data;
+	/** Size of the buffer in bytes. */
+	size_t size;
+	/** Request has completed. */
+	bool done;
+	/** Result of the request. */
+	errno_t rc;
+} bd_req_t;
+
+/** One segment of a vectored block transfer.
+ *
+ * The data of all segments of a transfer is packed back to back, in
+ * segment order, in a single buffer.
+ */
+typedef struct {
+	/** Address of the first block of the segment. */
+	aoff64_t ba;
+	/** Number of blocks in the segment. */
+	size_t cnt;
+} bd_seg_t;
+
 extern errno_t bd_open(async_sess_t *, bd_t **);
 extern void bd_close(bd_t *);
 extern errno_t bd_read_blocks(bd_t *, aoff64_t, size_t, void *, size_t);
+extern errno_t bd_readv(bd_t *, const bd_seg_t *, size_t, void *, size_t);
 extern errno_t bd_read_toc(bd_t *, uint8_t, void *, size_t);
 extern errno_t bd_write_blocks(bd_t *, aoff64_t, size_t, const void *, size_t);
+extern errno_t bd_writev(bd_t *, const bd_seg_t *, size_t, const void *,
+    size_t);
+extern errno_t bd_read_blocks_submit(bd_t *, bd_req_t *, aoff64_t, size_t,
+    void *, size_t);
+extern errno_t bd_write_blocks_submit(bd_t *, bd_req_t *, aoff64_t, size_t,
+    const void *, size_t);
+extern errno_t bd_wait(bd_t *, bd_req_t *);
+extern errno_t bd_dma_buf_create(bd_t *, size_t, void **);
+extern void bd_dma_buf_destroy(bd_t *);
+extern errno_t bd_read_blocks_buf(bd_t *, aoff64_t, size_t, size_t);
+extern errno_t bd_write_blocks_buf(bd_t *, aoff64_t, size_t, size_t);
 extern errno_t bd_sync_cache(bd_t *, aoff64_t, size_t);
+extern errno_t bd_discard(bd_t *, aoff64_t, size_t);
 extern errno_t bd_get_block_size(bd_t *, size_t *);
 extern errno_t bd_get_num_blocks(bd_t *, aoff64_t *);
 
@@ -38,6 +38,7 @@
 #include <adt/list.h>
 #include <async.h>
 #include <fibril_synch.h>
+#include <ipc/loc.h>
 #include <stdbool.h>
 #include <offset.h>
 
@@ -54,6 +55,18 @@ typedef struct {
 	bd_srvs_t *srvs;
 	async_sess_t *client_sess;
 	void *carg;
+	/** Protects @c pending_reqs */
+	fibril_mutex_t lock;
+	/** Signaled when @c pending_reqs drops to zero */
+	fibril_condvar_t pending_cv;
+	/** Number of asynchronous requests in flight */
+	unsigned pending_reqs;
+	/** Server-side mapping of the client's shared DMA buffer */
+	void *dma_buf;
+	/** Size of the shared DMA buffer in bytes */
+	size_t dma_buf_size;
+	/** Physical address of the shared DMA buffer (0 if unknown) */
+	uintptr_t dma_buf_phys;
 } bd_srv_t;
 
 struct bd_ops {
@@ -65,6 +78,16 @@ struct bd_ops {
 	errno_t (*write_blocks)(bd_srv_t *, aoff64_t, size_t, const void *, size_t);
 	errno_t (*get_block_size)(bd_srv_t *, size_t *);
 	errno_t (*get_num_blocks)(bd_srv_t *, aoff64_t *);
+	/** Optional direct DMA transfers to/from a physical address */
+	errno_t (*read_blocks_dma)(bd_srv_t *, aoff64_t, size_t, uintptr_t);
+	errno_t (*write_blocks_dma)(bd_srv_t *, aoff64_t, size_t, uintptr_t);
+	/** Optional memory-resident backing area shared read-only with clients */
+	errno_t (*get_shared_area)(bd_srv_t *, void **, size_t *);
+	/** Optional discarding (unmapping) of blocks whose data is unneeded */
+	errno_t (*discard)(bd_srv_t *, aoff64_t, size_t);
+	/** Optional passthrough to a window of an underlying device */
+	errno_t (*get_passthrough)(bd_srv_t *, service_id_t *, aoff64_t *,
+	    aoff64_t *);
 };
 
 extern void bd_srvs_init(bd_srvs_t *);
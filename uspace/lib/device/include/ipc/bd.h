@@ -43,9 +43,25 @@ typedef enum {
 	BD_READ_BLOCKS,
 	BD_SYNC_CACHE,
 	BD_WRITE_BLOCKS,
-	BD_READ_TOC
+	BD_READ_TOC,
+	BD_READV,
+	BD_WRITEV,
+	BD_AREAD_BLOCKS,
+	BD_AWRITE_BLOCKS,
+	BD_SHARE_BUF,
+	BD_READ_BLOCKS_BUF,
+	BD_WRITE_BLOCKS_BUF,
+	BD_SHARE_AREA,
+	BD_DISCARD,
+	BD_GET_PASSTHROUGH
 } bd_request_t;
 
+/** Completion events sent to the client callback port. */
+typedef enum {
+	BD_READ_COMPLETE = IPC_FIRST_USER_METHOD,
+	BD_WRITE_COMPLETE
+} bd_event_t;
+
 #endif
 
 /** @}
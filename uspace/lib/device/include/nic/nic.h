@@ -75,6 +75,18 @@
 #define NIC_DEFECTIVE_BAD_TCP_CHECKSUM   0x0080
 #define NIC_DEFECTIVE_BAD_UDP_CHECKSUM   0x0100
 
+/*
+ * Offload computations, used in the masks exchanged by
+ * nic_offload_probe() and nic_offload_set()
+ */
+#define NIC_OFFLOAD_TX_IPV4_CHECKSUM  0x0001
+#define NIC_OFFLOAD_RX_IPV4_CHECKSUM  0x0002
+#define NIC_OFFLOAD_TX_TCP_CHECKSUM   0x0004
+#define NIC_OFFLOAD_RX_TCP_CHECKSUM   0x0008
+#define NIC_OFFLOAD_TX_UDP_CHECKSUM   0x0010
+#define NIC_OFFLOAD_RX_UDP_CHECKSUM   0x0020
+#define NIC_OFFLOAD_TCP_SEGMENTATION  0x0040
+
 /**
  * The bitmap uses single bit for each of the 2^12 = 4096 possible VLAN tags.
  * This means its size is 4096/8 = 512 bytes.
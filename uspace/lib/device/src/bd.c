@@ -34,19 +34,135 @@
  * @brief Block device client interface
  */
 
+#include <adt/list.h>
+#include <as.h>
 #include <async.h>
 #include <assert.h>
 #include <bd.h>
+#include <ddi.h>
 #include <errno.h>
+#include <fibril_synch.h>
 #include <ipc/bd.h>
 #include <ipc/services.h>
 #include <loc.h>
 #include <macros.h>
+#include <mem.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <offset.h>
 
 static void bd_cb_conn(ipc_call_t *icall, void *arg);
 
+/** Try to map the server's backing area read-only.
+ *
+ * Memory-backed servers (such as the initial RAM disk) can share their
+ * backing store with the client, letting bd_read_blocks() copy from the
+ * local mapping instead of doing an IPC round trip per read. Most servers
+ * do not support this and the attempt fails silently.
+ */
+static void bd_share_area(bd_t *bd)
+{
+	size_t bsize;
+	aoff64_t nblocks;
+
+	if (bd_get_block_size(bd, &bsize) != EOK ||
+	    bd_get_num_blocks(bd, &nblocks) != EOK)
+		return;
+
+	if (bsize == 0 || nblocks == 0 || nblocks > SIZE_MAX / bsize)
+		return;
+
+	size_t asize = PAGES2SIZE(SIZE2PAGES(nblocks * bsize));
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_0(exch, BD_SHARE_AREA, &answer);
+
+	void *area;
+	errno_t rc = async_share_in_start_0_0(exch, asize, &area);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	if (retval != EOK) {
+		as_area_destroy(area);
+		return;
+	}
+
+	bd->shared_area = area;
+	bd->shared_area_size = nblocks * bsize;
+	bd->shared_area_bsize = bsize;
+}
+
+/** Try to establish a direct session to the underlying device.
+ *
+ * Partition servers merely translate block addresses by a fixed offset
+ * and forward the I/O to the block device server of the whole disk.
+ * Such servers can answer BD_GET_PASSTHROUGH with the underlying service
+ * and the address window of the partition, letting the client send its
+ * I/O to the disk server directly and saving one IPC hop per operation.
+ * Block addresses are translated and range-checked locally. Most servers
+ * do not support the query and the attempt fails silently.
+ */
+static void bd_passthrough_init(bd_t *bd)
+{
+	sysarg_t svc_id;
+	sysarg_t b0_lo, b0_hi;
+	sysarg_t nb_lo, nb_hi;
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+	errno_t rc = async_req_0_5(exch, BD_GET_PASSTHROUGH, &svc_id, &b0_lo,
+	    &b0_hi, &nb_lo, &nb_hi);
+	async_exchange_end(exch);
+
+	if (rc != EOK)
+		return;
+
+	async_sess_t *sess = loc_service_connect((service_id_t) svc_id,
+	    INTERFACE_BLOCK, 0);
+	if (sess == NULL)
+		return;
+
+	bd_t *pt_bd;
+	if (bd_open(sess, &pt_bd) != EOK) {
+		async_hangup(sess);
+		return;
+	}
+
+	/* The window must use the same block size as this device. */
+	size_t bsize;
+	size_t pt_bsize;
+	if (bd_get_block_size(bd, &bsize) != EOK ||
+	    bd_get_block_size(pt_bd, &pt_bsize) != EOK ||
+	    bsize != pt_bsize) {
+		bd_close(pt_bd);
+		async_hangup(sess);
+		return;
+	}
+
+	bd->pt_sess = sess;
+	bd->pt_bd = pt_bd;
+	bd->pt_base = (aoff64_t) MERGE_LOUP32(b0_lo, b0_hi);
+	bd->pt_nblocks = (aoff64_t) MERGE_LOUP32(nb_lo, nb_hi);
+}
+
+/** Translate a block address range for the passthrough session. */
+static errno_t bd_pt_translate(bd_t *bd, aoff64_t ba, size_t cnt,
+    aoff64_t *rba)
+{
+	if (ba + cnt > bd->pt_nblocks)
+		return ELIMIT;
+
+	*rba = bd->pt_base + ba;
+	return EOK;
+}
+
 errno_t bd_open(async_sess_t *sess, bd_t **rbd)
 {
 	bd_t *bd = calloc(1, sizeof(bd_t));
@@ -54,6 +170,10 @@ errno_t bd_open(async_sess_t *sess, bd_t **rbd)
 		return ENOMEM;
 
 	bd->sess = sess;
+	fibril_mutex_initialize(&bd->areq_lock);
+	fibril_condvar_initialize(&bd->areq_cv);
+	list_initialize(&bd->areqs);
+	bd->next_id = 0;
 
 	async_exch_t *exch = async_exchange_begin(sess);
 
@@ -66,6 +186,9 @@ errno_t bd_open(async_sess_t *sess, bd_t **rbd)
 	if (rc != EOK)
 		goto error;
 
+	bd_share_area(bd);
+	bd_passthrough_init(bd);
+
 	*rbd = bd;
 	return EOK;
 
@@ -79,11 +202,164 @@ error:
 void bd_close(bd_t *bd)
 {
 	/* XXX Synchronize with bd_cb_conn */
+	if (bd->pt_bd != NULL) {
+		bd_close(bd->pt_bd);
+		async_hangup(bd->pt_sess);
+	}
+	bd_dma_buf_destroy(bd);
+	if (bd->shared_area != NULL)
+		as_area_destroy(bd->shared_area);
 	free(bd);
 }
 
+/** Create a DMA buffer shared with the block device server.
+ *
+ * The buffer is allocated from physically contiguous memory suitable for
+ * DMA and shared with the server, allowing the device to transfer disk
+ * data directly to and from it when bd_read_blocks_buf() and
+ * bd_write_blocks_buf() are used, without any intermediate copies.
+ * Only one buffer per session is supported; it stays shared until the
+ * session is closed.
+ */
+errno_t bd_dma_buf_create(bd_t *bd, size_t size, void **rbuf)
+{
+	/* Share the buffer with the server we actually transfer with. */
+	if (bd->pt_bd != NULL)
+		return bd_dma_buf_create(bd->pt_bd, size, rbuf);
+
+	if (bd->dma_buf != NULL)
+		return EBUSY;
+
+	/*
+	 * The 4 GiB constraint satisfies the DMA addressing limits of all
+	 * current bd servers.
+	 */
+	uintptr_t phys;
+	void *virt = AS_AREA_ANY;
+	errno_t rc = dmamem_map_anonymous(size, DMAMEM_4GiB,
+	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &virt);
+	if (rc != EOK)
+		return rc;
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_0(exch, BD_SHARE_BUF, &answer);
+	rc = async_share_out_start(exch, virt, AS_AREA_READ | AS_AREA_WRITE);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		dmamem_unmap_anonymous(virt);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+
+	if (retval != EOK) {
+		dmamem_unmap_anonymous(virt);
+		return retval;
+	}
+
+	bd->dma_buf = virt;
+	bd->dma_buf_size = size;
+	*rbuf = virt;
+	return EOK;
+}
+
+/** Destroy the client mapping of the shared DMA buffer.
+ *
+ * The server side of the sharing goes away when the session is closed.
+ */
+void bd_dma_buf_destroy(bd_t *bd)
+{
+	if (bd->pt_bd != NULL) {
+		bd_dma_buf_destroy(bd->pt_bd);
+		return;
+	}
+
+	if (bd->dma_buf != NULL) {
+		dmamem_unmap_anonymous(bd->dma_buf);
+		bd->dma_buf = NULL;
+		bd->dma_buf_size = 0;
+	}
+}
+
+/** Read blocks directly into the shared DMA buffer.
+ *
+ * Reads @a cnt blocks starting with @a ba into the shared DMA buffer
+ * at byte offset @a buf_off.
+ */
+errno_t bd_read_blocks_buf(bd_t *bd, aoff64_t ba, size_t cnt, size_t buf_off)
+{
+	if (bd->pt_bd != NULL) {
+		aoff64_t gba;
+		errno_t rc = bd_pt_translate(bd, ba, cnt, &gba);
+		if (rc != EOK)
+			return rc;
+		return bd_read_blocks_buf(bd->pt_bd, gba, cnt, buf_off);
+	}
+
+	if (bd->dma_buf == NULL)
+		return EINVAL;
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+	errno_t rc = async_req_4_0(exch, BD_READ_BLOCKS_BUF, LOWER32(ba),
+	    UPPER32(ba), cnt, buf_off);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
+/** Write blocks directly from the shared DMA buffer.
+ *
+ * Writes @a cnt blocks starting with @a ba from the shared DMA buffer
+ * at byte offset @a buf_off.
+ */
+errno_t bd_write_blocks_buf(bd_t *bd, aoff64_t ba, size_t cnt, size_t buf_off)
+{
+	if (bd->pt_bd != NULL) {
+		aoff64_t gba;
+		errno_t rc = bd_pt_translate(bd, ba, cnt, &gba);
+		if (rc != EOK)
+			return rc;
+		return bd_write_blocks_buf(bd->pt_bd, gba, cnt, buf_off);
+	}
+
+	if (bd->dma_buf == NULL)
+		return EINVAL;
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+	errno_t rc = async_req_4_0(exch, BD_WRITE_BLOCKS_BUF, LOWER32(ba),
+	    UPPER32(ba), cnt, buf_off);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
 errno_t bd_read_blocks(bd_t *bd, aoff64_t ba, size_t cnt, void *data, size_t size)
 {
+	/* Read directly from the shared backing area, if we have one. */
+	if (bd->shared_area != NULL && ba <= bd->shared_area_size /
+	    bd->shared_area_bsize) {
+		aoff64_t off = ba * bd->shared_area_bsize;
+		size_t bytes = min(cnt * bd->shared_area_bsize, size);
+
+		if (off + bytes <= bd->shared_area_size) {
+			memcpy(data, bd->shared_area + off, bytes);
+			return EOK;
+		}
+	}
+
+	if (bd->pt_bd != NULL) {
+		aoff64_t gba;
+		errno_t rc = bd_pt_translate(bd, ba, cnt, &gba);
+		if (rc != EOK)
+			return rc;
+		return bd_read_blocks(bd->pt_bd, gba, cnt, data, size);
+	}
+
 	async_exch_t *exch = async_exchange_begin(bd->sess);
 
 	ipc_call_t answer;
@@ -106,6 +382,79 @@ errno_t bd_read_blocks(bd_t *bd, aoff64_t ba, size_t cnt, void *data, size_t siz
 	return EOK;
 }
 
+/** Read several block segments in a single round trip.
+ *
+ * The segments are read into @a data back to back, in segment order.
+ * @a size must equal the total size of all segments.
+ */
+/** Translate a segment array for the passthrough session. */
+static errno_t bd_pt_segs_translate(bd_t *bd, const bd_seg_t *segs,
+    size_t nsegs, bd_seg_t **rsegs)
+{
+	bd_seg_t *tsegs;
+	size_t i;
+
+	tsegs = calloc(nsegs, sizeof(bd_seg_t));
+	if (tsegs == NULL)
+		return ENOMEM;
+
+	for (i = 0; i < nsegs; i++) {
+		errno_t rc = bd_pt_translate(bd, segs[i].ba, segs[i].cnt,
+		    &tsegs[i].ba);
+		if (rc != EOK) {
+			free(tsegs);
+			return rc;
+		}
+
+		tsegs[i].cnt = segs[i].cnt;
+	}
+
+	*rsegs = tsegs;
+	return EOK;
+}
+
+errno_t bd_readv(bd_t *bd, const bd_seg_t *segs, size_t nsegs, void *data,
+    size_t size)
+{
+	if (bd->pt_bd != NULL) {
+		bd_seg_t *tsegs;
+		errno_t rc = bd_pt_segs_translate(bd, segs, nsegs, &tsegs);
+		if (rc != EOK)
+			return rc;
+		rc = bd_readv(bd->pt_bd, tsegs, nsegs, data, size);
+		free(tsegs);
+		return rc;
+	}
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_1(exch, BD_READV, nsegs, &answer);
+	errno_t rc = async_data_write_start(exch, segs,
+	    nsegs * sizeof(bd_seg_t));
+	if (rc != EOK) {
+		async_exchange_end(exch);
+		async_forget(req);
+		return rc;
+	}
+
+	rc = async_data_read_start(exch, data, size);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+
+	if (retval != EOK)
+		return retval;
+
+	return EOK;
+}
+
 errno_t bd_read_toc(bd_t *bd, uint8_t session, void *buf, size_t size)
 {
 	async_exch_t *exch = async_exchange_begin(bd->sess);
@@ -132,6 +481,14 @@ errno_t bd_read_toc(bd_t *bd, uint8_t session, void *buf, size_t size)
 errno_t bd_write_blocks(bd_t *bd, aoff64_t ba, size_t cnt, const void *data,
     size_t size)
 {
+	if (bd->pt_bd != NULL) {
+		aoff64_t gba;
+		errno_t rc = bd_pt_translate(bd, ba, cnt, &gba);
+		if (rc != EOK)
+			return rc;
+		return bd_write_blocks(bd->pt_bd, gba, cnt, data, size);
+	}
+
 	async_exch_t *exch = async_exchange_begin(bd->sess);
 
 	ipc_call_t answer;
@@ -153,8 +510,183 @@ errno_t bd_write_blocks(bd_t *bd, aoff64_t ba, size_t cnt, const void *data,
 	return EOK;
 }
 
+/** Write several block segments in a single round trip.
+ *
+ * The data of the segments is taken from @a data back to back, in segment
+ * order.  @a size must equal the total size of all segments.
+ */
+errno_t bd_writev(bd_t *bd, const bd_seg_t *segs, size_t nsegs,
+    const void *data, size_t size)
+{
+	if (bd->pt_bd != NULL) {
+		bd_seg_t *tsegs;
+		errno_t rc = bd_pt_segs_translate(bd, segs, nsegs, &tsegs);
+		if (rc != EOK)
+			return rc;
+		rc = bd_writev(bd->pt_bd, tsegs, nsegs, data, size);
+		free(tsegs);
+		return rc;
+	}
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_1(exch, BD_WRITEV, nsegs, &answer);
+	errno_t rc = async_data_write_start(exch, segs,
+	    nsegs * sizeof(bd_seg_t));
+	if (rc != EOK) {
+		async_exchange_end(exch);
+		async_forget(req);
+		return rc;
+	}
+
+	rc = async_data_write_start(exch, data, size);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	if (retval != EOK)
+		return retval;
+
+	return EOK;
+}
+
+/** Register an asynchronous request as outstanding. */
+static void bd_req_register(bd_t *bd, bd_req_t *req, void *data, size_t size)
+{
+	fibril_mutex_lock(&bd->areq_lock);
+
+	req->id = bd->next_id++;
+	req->data = data;
+	req->size = size;
+	req->done = false;
+	req->rc = EOK;
+	list_append(&req->link, &bd->areqs);
+
+	fibril_mutex_unlock(&bd->areq_lock);
+}
+
+/** Remove an asynchronous request which failed to be submitted. */
+static void bd_req_unregister(bd_t *bd, bd_req_t *req)
+{
+	fibril_mutex_lock(&bd->areq_lock);
+	list_remove(&req->link);
+	fibril_mutex_unlock(&bd->areq_lock);
+}
+
+/** Submit an asynchronous read request.
+ *
+ * The request is tagged with an ID and completes independently of other
+ * requests, so several requests can be outstanding at the same time.
+ * The result is delivered through the callback connection and must be
+ * collected with bd_wait().  Both @a req and @a data must stay valid
+ * until then.
+ */
+errno_t bd_read_blocks_submit(bd_t *bd, bd_req_t *req, aoff64_t ba, size_t cnt,
+    void *data, size_t size)
+{
+	if (bd->pt_bd != NULL) {
+		aoff64_t gba;
+		errno_t rc = bd_pt_translate(bd, ba, cnt, &gba);
+		if (rc != EOK)
+			return rc;
+		return bd_read_blocks_submit(bd->pt_bd, req, gba, cnt, data,
+		    size);
+	}
+
+	bd_req_register(bd, req, data, size);
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+	errno_t rc = async_req_4_0(exch, BD_AREAD_BLOCKS, req->id, LOWER32(ba),
+	    UPPER32(ba), cnt);
+	async_exchange_end(exch);
+
+	if (rc != EOK)
+		bd_req_unregister(bd, req);
+
+	return rc;
+}
+
+/** Submit an asynchronous write request.
+ *
+ * The data is handed over to the server before this function returns,
+ * but the write itself completes independently and must be collected
+ * with bd_wait().  @a req must stay valid until then.
+ */
+errno_t bd_write_blocks_submit(bd_t *bd, bd_req_t *req, aoff64_t ba, size_t cnt,
+    const void *data, size_t size)
+{
+	if (bd->pt_bd != NULL) {
+		aoff64_t gba;
+		errno_t rc = bd_pt_translate(bd, ba, cnt, &gba);
+		if (rc != EOK)
+			return rc;
+		return bd_write_blocks_submit(bd->pt_bd, req, gba, cnt, data,
+		    size);
+	}
+
+	bd_req_register(bd, req, NULL, size);
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+
+	ipc_call_t answer;
+	aid_t aid = async_send_4(exch, BD_AWRITE_BLOCKS, req->id, LOWER32(ba),
+	    UPPER32(ba), cnt, &answer);
+	errno_t rc = async_data_write_start(exch, data, size);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(aid);
+		bd_req_unregister(bd, req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(aid, &retval);
+
+	if (retval != EOK) {
+		bd_req_unregister(bd, req);
+		return retval;
+	}
+
+	return EOK;
+}
+
+/** Wait for completion of an asynchronous request and collect its result. */
+errno_t bd_wait(bd_t *bd, bd_req_t *req)
+{
+	if (bd->pt_bd != NULL)
+		return bd_wait(bd->pt_bd, req);
+
+	fibril_mutex_lock(&bd->areq_lock);
+
+	while (!req->done)
+		fibril_condvar_wait(&bd->areq_cv, &bd->areq_lock);
+
+	list_remove(&req->link);
+	fibril_mutex_unlock(&bd->areq_lock);
+
+	return req->rc;
+}
+
 errno_t bd_sync_cache(bd_t *bd, aoff64_t ba, size_t cnt)
 {
+	if (bd->pt_bd != NULL) {
+		/* (0, 0) means full-device sync and needs no translation. */
+		aoff64_t gba = 0;
+		if (ba != 0 || cnt != 0) {
+			errno_t rc = bd_pt_translate(bd, ba, cnt, &gba);
+			if (rc != EOK)
+				return rc;
+		}
+		return bd_sync_cache(bd->pt_bd, gba, cnt);
+	}
+
 	async_exch_t *exch = async_exchange_begin(bd->sess);
 
 	errno_t rc = async_req_3_0(exch, BD_SYNC_CACHE, LOWER32(ba),
@@ -164,6 +696,31 @@ errno_t bd_sync_cache(bd_t *bd, aoff64_t ba, size_t cnt)
 	return rc;
 }
 
+/** Tell the device that a range of blocks no longer contains useful data.
+ *
+ * The device may unmap the blocks (e.g. TRIM them on an SSD or return
+ * them to the pool of a thin-provisioned volume). Reading discarded
+ * blocks returns unspecified data until they are written again.
+ */
+errno_t bd_discard(bd_t *bd, aoff64_t ba, size_t cnt)
+{
+	if (bd->pt_bd != NULL) {
+		aoff64_t gba;
+		errno_t rc = bd_pt_translate(bd, ba, cnt, &gba);
+		if (rc != EOK)
+			return rc;
+		return bd_discard(bd->pt_bd, gba, cnt);
+	}
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+
+	errno_t rc = async_req_3_0(exch, BD_DISCARD, LOWER32(ba),
+	    UPPER32(ba), cnt);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
 errno_t bd_get_block_size(bd_t *bd, size_t *rbsize)
 {
 	sysarg_t bsize;
@@ -195,12 +752,59 @@ errno_t bd_get_num_blocks(bd_t *bd, aoff64_t *rnb)
 	return EOK;
 }
 
+/** Handle a completion event for an asynchronous request.
+ *
+ * Matches the event to the outstanding request by its ID, receives the
+ * data for a successfully completed read request and wakes up the
+ * fibril waiting in bd_wait().
+ */
+static void bd_complete(bd_t *bd, ipc_call_t *call, bool is_read)
+{
+	sysarg_t id = ipc_get_arg1(call);
+	errno_t rc = (errno_t) ipc_get_arg2(call);
+
+	fibril_mutex_lock(&bd->areq_lock);
+
+	bd_req_t *req = NULL;
+	list_foreach(bd->areqs, link, bd_req_t, cur) {
+		if (cur->id == id) {
+			req = cur;
+			break;
+		}
+	}
+
+	if (req == NULL) {
+		fibril_mutex_unlock(&bd->areq_lock);
+		async_answer_0(call, ENOENT);
+		return;
+	}
+
+	if (is_read && rc == EOK) {
+		ipc_call_t dcall;
+		size_t dsize;
+
+		if (async_data_write_receive(&dcall, &dsize) &&
+		    dsize <= req->size) {
+			async_data_write_finalize(&dcall, req->data, dsize);
+		} else {
+			async_answer_0(&dcall, EINVAL);
+			rc = EIO;
+		}
+	}
+
+	req->rc = rc;
+	req->done = true;
+	fibril_condvar_broadcast(&bd->areq_cv);
+
+	fibril_mutex_unlock(&bd->areq_lock);
+
+	async_answer_0(call, EOK);
+}
+
 static void bd_cb_conn(ipc_call_t *icall, void *arg)
 {
 	bd_t *bd = (bd_t *)arg;
 
-	(void)bd;
-
 	while (true) {
 		ipc_call_t call;
 		async_get_call(&call);
@@ -211,6 +815,12 @@ static void bd_cb_conn(ipc_call_t *icall, void *arg)
 		}
 
 		switch (ipc_get_imethod(&call)) {
+		case BD_READ_COMPLETE:
+			bd_complete(bd, &call, true);
+			break;
+		case BD_WRITE_COMPLETE:
+			bd_complete(bd, &call, false);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
@@ -33,15 +33,34 @@
  * @file
  * @brief Block device server stub
  */
+#include <as.h>
+#include <ddi.h>
 #include <errno.h>
+#include <fibril.h>
 #include <ipc/bd.h>
 #include <macros.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdint.h>
 
+#include <bd.h>
 #include <bd_srv.h>
 
+/** Asynchronous request passed to a worker fibril. */
+typedef struct {
+	bd_srv_t *srv;
+	/** Request ID assigned by the client. */
+	sysarg_t id;
+	/** Address of the first block. */
+	aoff64_t ba;
+	/** Number of blocks. */
+	size_t cnt;
+	/** Data buffer. */
+	void *buf;
+	/** Size of the buffer in bytes. */
+	size_t size;
+} bd_srv_req_t;
+
 static void bd_read_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
 {
 	aoff64_t ba;
@@ -88,6 +107,91 @@ static void bd_read_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
 	async_answer_0(call, EOK);
 }
 
+static void bd_readv_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	size_t nsegs;
+	bd_seg_t *segs;
+	size_t ssize;
+	uint8_t *buf;
+	size_t size;
+	size_t bsize;
+	errno_t rc;
+
+	nsegs = ipc_get_arg1(call);
+
+	rc = async_data_write_accept((void **) &segs, false, 0, 0, 0, &ssize);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return;
+	}
+
+	ipc_call_t rcall;
+	if (!async_data_read_receive(&rcall, &size)) {
+		free(segs);
+		async_answer_0(&rcall, EINVAL);
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if ((nsegs == 0) || (ssize != nsegs * sizeof(bd_seg_t))) {
+		free(segs);
+		async_answer_0(&rcall, EINVAL);
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if (srv->srvs->ops->read_blocks == NULL ||
+	    srv->srvs->ops->get_block_size == NULL ||
+	    srv->srvs->ops->get_block_size(srv, &bsize) != EOK) {
+		free(segs);
+		async_answer_0(&rcall, ENOTSUP);
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	buf = malloc(size);
+	if (buf == NULL) {
+		free(segs);
+		async_answer_0(&rcall, ENOMEM);
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	size_t pos = 0;
+	rc = EOK;
+	for (size_t i = 0; i < nsegs; i++) {
+		size_t sbytes = segs[i].cnt * bsize;
+		if (sbytes > size - pos) {
+			rc = EINVAL;
+			break;
+		}
+
+		rc = srv->srvs->ops->read_blocks(srv, segs[i].ba, segs[i].cnt,
+		    buf + pos, sbytes);
+		if (rc != EOK)
+			break;
+
+		pos += sbytes;
+	}
+
+	if (rc == EOK && pos != size)
+		rc = EINVAL;
+
+	if (rc != EOK) {
+		async_answer_0(&rcall, rc);
+		async_answer_0(call, rc);
+		free(segs);
+		free(buf);
+		return;
+	}
+
+	async_data_read_finalize(&rcall, buf, size);
+
+	free(segs);
+	free(buf);
+	async_answer_0(call, EOK);
+}
+
 static void bd_read_toc_srv(bd_srv_t *srv, ipc_call_t *call)
 {
 	uint8_t session;
@@ -150,6 +254,46 @@ static void bd_sync_cache_srv(bd_srv_t *srv, ipc_call_t *call)
 	async_answer_0(call, rc);
 }
 
+static void bd_discard_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	aoff64_t ba;
+	size_t cnt;
+	errno_t rc;
+
+	ba = MERGE_LOUP32(ipc_get_arg1(call), ipc_get_arg2(call));
+	cnt = ipc_get_arg3(call);
+
+	if (srv->srvs->ops->discard == NULL) {
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	rc = srv->srvs->ops->discard(srv, ba, cnt);
+	async_answer_0(call, rc);
+}
+
+static void bd_get_passthrough_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	service_id_t svc_id;
+	aoff64_t base;
+	aoff64_t nblocks;
+	errno_t rc;
+
+	if (srv->srvs->ops->get_passthrough == NULL) {
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	rc = srv->srvs->ops->get_passthrough(srv, &svc_id, &base, &nblocks);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return;
+	}
+
+	async_answer_5(call, EOK, svc_id, LOWER32(base), UPPER32(base),
+	    LOWER32(nblocks), UPPER32(nblocks));
+}
+
 static void bd_write_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
 {
 	aoff64_t ba;
@@ -177,6 +321,401 @@ static void bd_write_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
 	async_answer_0(call, rc);
 }
 
+static void bd_writev_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	size_t nsegs;
+	bd_seg_t *segs;
+	size_t ssize;
+	uint8_t *data;
+	size_t size;
+	size_t bsize;
+	errno_t rc;
+
+	nsegs = ipc_get_arg1(call);
+
+	rc = async_data_write_accept((void **) &segs, false, 0, 0, 0, &ssize);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return;
+	}
+
+	rc = async_data_write_accept((void **) &data, false, 0, 0, 0, &size);
+	if (rc != EOK) {
+		free(segs);
+		async_answer_0(call, rc);
+		return;
+	}
+
+	if ((nsegs == 0) || (ssize != nsegs * sizeof(bd_seg_t))) {
+		rc = EINVAL;
+		goto out;
+	}
+
+	if (srv->srvs->ops->write_blocks == NULL ||
+	    srv->srvs->ops->get_block_size == NULL ||
+	    srv->srvs->ops->get_block_size(srv, &bsize) != EOK) {
+		rc = ENOTSUP;
+		goto out;
+	}
+
+	size_t pos = 0;
+	rc = EOK;
+	for (size_t i = 0; i < nsegs; i++) {
+		size_t sbytes = segs[i].cnt * bsize;
+		if (sbytes > size - pos) {
+			rc = EINVAL;
+			break;
+		}
+
+		rc = srv->srvs->ops->write_blocks(srv, segs[i].ba, segs[i].cnt,
+		    data + pos, sbytes);
+		if (rc != EOK)
+			break;
+
+		pos += sbytes;
+	}
+
+	if (rc == EOK && pos != size)
+		rc = EINVAL;
+
+out:
+	free(segs);
+	free(data);
+	async_answer_0(call, rc);
+}
+
+/** Note that a worker fibril for an asynchronous request has finished. */
+static void bd_srv_req_done(bd_srv_t *srv)
+{
+	fibril_mutex_lock(&srv->lock);
+	if (--srv->pending_reqs == 0)
+		fibril_condvar_broadcast(&srv->pending_cv);
+	fibril_mutex_unlock(&srv->lock);
+}
+
+/** Worker fibril serving one asynchronous read request. */
+static errno_t bd_aread_blocks_fibril(void *arg)
+{
+	bd_srv_req_t *req = (bd_srv_req_t *) arg;
+	bd_srv_t *srv = req->srv;
+
+	errno_t rc = srv->srvs->ops->read_blocks(srv, req->ba, req->cnt,
+	    req->buf, req->size);
+
+	/* Deliver the result through the client callback connection. */
+	async_exch_t *exch = async_exchange_begin(srv->client_sess);
+
+	ipc_call_t answer;
+	aid_t aid = async_send_2(exch, BD_READ_COMPLETE, req->id, rc, &answer);
+	if (rc == EOK)
+		(void) async_data_write_start(exch, req->buf, req->size);
+	async_exchange_end(exch);
+	async_wait_for(aid, NULL);
+
+	free(req->buf);
+	free(req);
+
+	bd_srv_req_done(srv);
+	return EOK;
+}
+
+static void bd_aread_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	sysarg_t id;
+	aoff64_t ba;
+	size_t cnt;
+	size_t bsize;
+
+	id = ipc_get_arg1(call);
+	ba = MERGE_LOUP32(ipc_get_arg2(call), ipc_get_arg3(call));
+	cnt = ipc_get_arg4(call);
+
+	if (srv->srvs->ops->read_blocks == NULL ||
+	    srv->srvs->ops->get_block_size == NULL ||
+	    srv->srvs->ops->get_block_size(srv, &bsize) != EOK) {
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	bd_srv_req_t *req = calloc(1, sizeof(bd_srv_req_t));
+	if (req == NULL) {
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	req->srv = srv;
+	req->id = id;
+	req->ba = ba;
+	req->cnt = cnt;
+	req->size = cnt * bsize;
+	req->buf = malloc(req->size);
+	if (req->buf == NULL) {
+		free(req);
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	fid_t fid = fibril_create(bd_aread_blocks_fibril, req);
+	if (fid == 0) {
+		free(req->buf);
+		free(req);
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	fibril_mutex_lock(&srv->lock);
+	srv->pending_reqs++;
+	fibril_mutex_unlock(&srv->lock);
+
+	/* Answer the submission, the request completes independently. */
+	async_answer_0(call, EOK);
+	fibril_add_ready(fid);
+}
+
+/** Worker fibril serving one asynchronous write request. */
+static errno_t bd_awrite_blocks_fibril(void *arg)
+{
+	bd_srv_req_t *req = (bd_srv_req_t *) arg;
+	bd_srv_t *srv = req->srv;
+
+	errno_t rc = srv->srvs->ops->write_blocks(srv, req->ba, req->cnt,
+	    req->buf, req->size);
+
+	/* Deliver the result through the client callback connection. */
+	async_exch_t *exch = async_exchange_begin(srv->client_sess);
+	(void) async_req_2_0(exch, BD_WRITE_COMPLETE, req->id, rc);
+	async_exchange_end(exch);
+
+	free(req->buf);
+	free(req);
+
+	bd_srv_req_done(srv);
+	return EOK;
+}
+
+static void bd_awrite_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	sysarg_t id;
+	aoff64_t ba;
+	size_t cnt;
+	void *data;
+	size_t size;
+	errno_t rc;
+
+	id = ipc_get_arg1(call);
+	ba = MERGE_LOUP32(ipc_get_arg2(call), ipc_get_arg3(call));
+	cnt = ipc_get_arg4(call);
+
+	rc = async_data_write_accept(&data, false, 0, 0, 0, &size);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return;
+	}
+
+	if (srv->srvs->ops->write_blocks == NULL) {
+		free(data);
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	bd_srv_req_t *req = calloc(1, sizeof(bd_srv_req_t));
+	if (req == NULL) {
+		free(data);
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	req->srv = srv;
+	req->id = id;
+	req->ba = ba;
+	req->cnt = cnt;
+	req->buf = data;
+	req->size = size;
+
+	fid_t fid = fibril_create(bd_awrite_blocks_fibril, req);
+	if (fid == 0) {
+		free(req->buf);
+		free(req);
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	fibril_mutex_lock(&srv->lock);
+	srv->pending_reqs++;
+	fibril_mutex_unlock(&srv->lock);
+
+	/* Answer the submission, the request completes independently. */
+	async_answer_0(call, EOK);
+	fibril_add_ready(fid);
+}
+
+/** Accept a DMA buffer shared by the client. */
+static void bd_share_buf_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	size_t size;
+	unsigned int flags;
+
+	if (srv->dma_buf != NULL) {
+		async_answer_0(call, EBUSY);
+		return;
+	}
+
+	ipc_call_t scall;
+	if (!async_share_out_receive(&scall, &size, &flags)) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	void *buf;
+	errno_t rc = async_share_out_finalize(&scall, &buf);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return;
+	}
+
+	/*
+	 * Learn the physical address of the buffer so that devices can use
+	 * it directly as a DMA target. The client guarantees the buffer is
+	 * physically contiguous. Should this fail, the buffer remains
+	 * usable, merely without the direct DMA shortcut.
+	 */
+	uintptr_t phys;
+	if (dmamem_map(buf, size, 0, 0, &phys) != EOK)
+		phys = 0;
+
+	srv->dma_buf = buf;
+	srv->dma_buf_size = size;
+	srv->dma_buf_phys = phys;
+
+	async_answer_0(call, EOK);
+}
+
+/** Read blocks directly into the shared DMA buffer. */
+static void bd_read_blocks_buf_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	bd_ops_t *ops = srv->srvs->ops;
+	aoff64_t ba;
+	size_t cnt;
+	size_t buf_off;
+	size_t bsize;
+	errno_t rc;
+
+	ba = MERGE_LOUP32(ipc_get_arg1(call), ipc_get_arg2(call));
+	cnt = ipc_get_arg3(call);
+	buf_off = ipc_get_arg4(call);
+
+	if (srv->dma_buf == NULL || ops->get_block_size == NULL ||
+	    ops->get_block_size(srv, &bsize) != EOK) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	size_t size = cnt * bsize;
+	if (buf_off + size < buf_off || buf_off + size > srv->dma_buf_size) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if (ops->read_blocks_dma != NULL && srv->dma_buf_phys != 0) {
+		rc = ops->read_blocks_dma(srv, ba, cnt,
+		    srv->dma_buf_phys + buf_off);
+	} else if (ops->read_blocks != NULL) {
+		rc = ops->read_blocks(srv, ba, cnt, srv->dma_buf + buf_off,
+		    size);
+	} else {
+		rc = ENOTSUP;
+	}
+
+	async_answer_0(call, rc);
+}
+
+/** Write blocks directly from the shared DMA buffer. */
+static void bd_write_blocks_buf_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	bd_ops_t *ops = srv->srvs->ops;
+	aoff64_t ba;
+	size_t cnt;
+	size_t buf_off;
+	size_t bsize;
+	errno_t rc;
+
+	ba = MERGE_LOUP32(ipc_get_arg1(call), ipc_get_arg2(call));
+	cnt = ipc_get_arg3(call);
+	buf_off = ipc_get_arg4(call);
+
+	if (srv->dma_buf == NULL || ops->get_block_size == NULL ||
+	    ops->get_block_size(srv, &bsize) != EOK) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	size_t size = cnt * bsize;
+	if (buf_off + size < buf_off || buf_off + size > srv->dma_buf_size) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if (ops->write_blocks_dma != NULL && srv->dma_buf_phys != 0) {
+		rc = ops->write_blocks_dma(srv, ba, cnt,
+		    srv->dma_buf_phys + buf_off);
+	} else if (ops->write_blocks != NULL) {
+		rc = ops->write_blocks(srv, ba, cnt, srv->dma_buf + buf_off,
+		    size);
+	} else {
+		rc = ENOTSUP;
+	}
+
+	async_answer_0(call, rc);
+}
+
+/** Share the device's memory-resident backing area with the client.
+ *
+ * The area is shared read-only, so the client can service reads by
+ * copying from the mapping without any IPC round trip. Writes keep
+ * going through the regular protocol and remain visible to the client,
+ * since the mapping aliases the server's own backing store.
+ */
+static void bd_share_area_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	void *area;
+	size_t asize;
+	size_t size;
+	errno_t rc;
+
+	if (srv->srvs->ops->get_shared_area == NULL) {
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	ipc_call_t scall;
+	if (!async_share_in_receive(&scall, &size)) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	rc = srv->srvs->ops->get_shared_area(srv, &area, &asize);
+	if (rc != EOK) {
+		async_answer_0(&scall, rc);
+		async_answer_0(call, rc);
+		return;
+	}
+
+	if (size != PAGES2SIZE(SIZE2PAGES(asize))) {
+		async_answer_0(&scall, EINVAL);
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	rc = async_share_in_finalize(&scall, area, AS_AREA_READ |
+	    AS_AREA_CACHEABLE);
+	if (rc != EOK) {
+		async_answer_0(call, EIO);
+		return;
+	}
+
+	async_answer_0(call, EOK);
+}
+
 static void bd_get_block_size_srv(bd_srv_t *srv, ipc_call_t *call)
 {
 	errno_t rc;
@@ -214,6 +753,9 @@ static bd_srv_t *bd_srv_create(bd_srvs_t *srvs)
 		return NULL;
 
 	srv->srvs = srvs;
+	fibril_mutex_initialize(&srv->lock);
+	fibril_condvar_initialize(&srv->pending_cv);
+	srv->pending_reqs = 0;
 	return srv;
 }
 
@@ -269,6 +811,36 @@ errno_t bd_conn(ipc_call_t *icall, bd_srvs_t *srvs)
 		case BD_WRITE_BLOCKS:
 			bd_write_blocks_srv(srv, &call);
 			break;
+		case BD_AREAD_BLOCKS:
+			bd_aread_blocks_srv(srv, &call);
+			break;
+		case BD_AWRITE_BLOCKS:
+			bd_awrite_blocks_srv(srv, &call);
+			break;
+		case BD_SHARE_BUF:
+			bd_share_buf_srv(srv, &call);
+			break;
+		case BD_READ_BLOCKS_BUF:
+			bd_read_blocks_buf_srv(srv, &call);
+			break;
+		case BD_WRITE_BLOCKS_BUF:
+			bd_write_blocks_buf_srv(srv, &call);
+			break;
+		case BD_SHARE_AREA:
+			bd_share_area_srv(srv, &call);
+			break;
+		case BD_DISCARD:
+			bd_discard_srv(srv, &call);
+			break;
+		case BD_GET_PASSTHROUGH:
+			bd_get_passthrough_srv(srv, &call);
+			break;
+		case BD_READV:
+			bd_readv_srv(srv, &call);
+			break;
+		case BD_WRITEV:
+			bd_writev_srv(srv, &call);
+			break;
 		case BD_GET_BLOCK_SIZE:
 			bd_get_block_size_srv(srv, &call);
 			break;
@@ -280,6 +852,19 @@ errno_t bd_conn(ipc_call_t *icall, bd_srvs_t *srvs)
 		}
 	}
 
+	/* Wait until all asynchronous requests in flight are finished */
+	fibril_mutex_lock(&srv->lock);
+	while (srv->pending_reqs > 0)
+		fibril_condvar_wait(&srv->pending_cv, &srv->lock);
+	fibril_mutex_unlock(&srv->lock);
+
+	/* Unmap the shared DMA buffer, if any */
+	if (srv->dma_buf != NULL) {
+		if (srv->dma_buf_phys != 0)
+			dmamem_unmap(srv->dma_buf, srv->dma_buf_size);
+		as_area_destroy(srv->dma_buf);
+	}
+
 	rc = srvs->ops->close(srv);
 	free(srv);
 
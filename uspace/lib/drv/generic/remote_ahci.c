@@ -47,7 +47,10 @@ typedef enum {
 	IPC_M_AHCI_GET_NUM_BLOCKS,
 	IPC_M_AHCI_GET_BLOCK_SIZE,
 	IPC_M_AHCI_READ_BLOCKS,
-	IPC_M_AHCI_WRITE_BLOCKS
+	IPC_M_AHCI_WRITE_BLOCKS,
+	IPC_M_AHCI_READ_BLOCKS_DMA,
+	IPC_M_AHCI_WRITE_BLOCKS_DMA,
+	IPC_M_AHCI_DISCARD_BLOCKS
 } ahci_iface_funcs_t;
 
 #define MAX_NAME_LENGTH  1024
@@ -181,11 +184,76 @@ errno_t ahci_write_blocks(async_sess_t *sess, uint64_t blocknum, size_t count,
 	return rc;
 }
 
+/** Read blocks directly into a physically contiguous buffer.
+ *
+ * The buffer must be physically contiguous and located below 4 GiB, e.g.
+ * allocated by dmamem_map_anonymous() with the DMAMEM_4GiB constraint.
+ */
+errno_t ahci_read_blocks_dma(async_sess_t *sess, uint64_t blocknum,
+    size_t count, uintptr_t phys)
+{
+	async_exch_t *exch = async_exchange_begin(sess);
+	if (!exch)
+		return EINVAL;
+
+	errno_t rc = async_req_5_0(exch, DEV_IFACE_ID(AHCI_DEV_IFACE),
+	    IPC_M_AHCI_READ_BLOCKS_DMA, HI(blocknum), LO(blocknum), count,
+	    phys);
+
+	async_exchange_end(exch);
+
+	return rc;
+}
+
+/** Write blocks directly from a physically contiguous buffer.
+ *
+ * The buffer must be physically contiguous and located below 4 GiB, e.g.
+ * allocated by dmamem_map_anonymous() with the DMAMEM_4GiB constraint.
+ */
+errno_t ahci_write_blocks_dma(async_sess_t *sess, uint64_t blocknum,
+    size_t count, uintptr_t phys)
+{
+	async_exch_t *exch = async_exchange_begin(sess);
+	if (!exch)
+		return EINVAL;
+
+	errno_t rc = async_req_5_0(exch, DEV_IFACE_ID(AHCI_DEV_IFACE),
+	    IPC_M_AHCI_WRITE_BLOCKS_DMA, HI(blocknum), LO(blocknum), count,
+	    phys);
+
+	async_exchange_end(exch);
+
+	return rc;
+}
+
+/** Discard (trim) blocks whose data is no longer needed.
+ *
+ * The device may return arbitrary data for subsequent reads of discarded
+ * blocks.
+ */
+errno_t ahci_discard_blocks(async_sess_t *sess, uint64_t blocknum,
+    size_t count)
+{
+	async_exch_t *exch = async_exchange_begin(sess);
+	if (!exch)
+		return EINVAL;
+
+	errno_t rc = async_req_4_0(exch, DEV_IFACE_ID(AHCI_DEV_IFACE),
+	    IPC_M_AHCI_DISCARD_BLOCKS, HI(blocknum), LO(blocknum), count);
+
+	async_exchange_end(exch);
+
+	return rc;
+}
+
 static void remote_ahci_get_sata_device_name(ddf_fun_t *, void *, ipc_call_t *);
 static void remote_ahci_get_num_blocks(ddf_fun_t *, void *, ipc_call_t *);
 static void remote_ahci_get_block_size(ddf_fun_t *, void *, ipc_call_t *);
 static void remote_ahci_read_blocks(ddf_fun_t *, void *, ipc_call_t *);
 static void remote_ahci_write_blocks(ddf_fun_t *, void *, ipc_call_t *);
+static void remote_ahci_read_blocks_dma(ddf_fun_t *, void *, ipc_call_t *);
+static void remote_ahci_write_blocks_dma(ddf_fun_t *, void *, ipc_call_t *);
+static void remote_ahci_discard_blocks(ddf_fun_t *, void *, ipc_call_t *);
 
 /** Remote AHCI interface operations. */
 static const remote_iface_func_ptr_t remote_ahci_iface_ops [] = {
@@ -193,7 +261,10 @@ static const remote_iface_func_ptr_t remote_ahci_iface_ops [] = {
 	[IPC_M_AHCI_GET_NUM_BLOCKS] = remote_ahci_get_num_blocks,
 	[IPC_M_AHCI_GET_BLOCK_SIZE] = remote_ahci_get_block_size,
 	[IPC_M_AHCI_READ_BLOCKS] = remote_ahci_read_blocks,
-	[IPC_M_AHCI_WRITE_BLOCKS] = remote_ahci_write_blocks
+	[IPC_M_AHCI_WRITE_BLOCKS] = remote_ahci_write_blocks,
+	[IPC_M_AHCI_READ_BLOCKS_DMA] = remote_ahci_read_blocks_dma,
+	[IPC_M_AHCI_WRITE_BLOCKS_DMA] = remote_ahci_write_blocks_dma,
+	[IPC_M_AHCI_DISCARD_BLOCKS] = remote_ahci_discard_blocks
 };
 
 /** Remote AHCI interface structure.
@@ -328,6 +399,70 @@ void remote_ahci_write_blocks(ddf_fun_t *fun, void *iface, ipc_call_t *call)
 	async_answer_0(call, ret);
 }
 
+static void remote_ahci_read_blocks_dma(ddf_fun_t *fun, void *iface,
+    ipc_call_t *call)
+{
+	const ahci_iface_t *ahci_iface = (ahci_iface_t *) iface;
+
+	if (ahci_iface->read_blocks_dma == NULL) {
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	const uint64_t blocknum =
+	    (((uint64_t) (DEV_IPC_GET_ARG1(*call))) << 32) |
+	    (((uint64_t) (DEV_IPC_GET_ARG2(*call))) & 0xffffffff);
+	const size_t cnt = (size_t) DEV_IPC_GET_ARG3(*call);
+	const uintptr_t phys = (uintptr_t) DEV_IPC_GET_ARG4(*call);
+
+	const errno_t ret = ahci_iface->read_blocks_dma(fun, blocknum, cnt,
+	    phys);
+
+	async_answer_0(call, ret);
+}
+
+static void remote_ahci_write_blocks_dma(ddf_fun_t *fun, void *iface,
+    ipc_call_t *call)
+{
+	const ahci_iface_t *ahci_iface = (ahci_iface_t *) iface;
+
+	if (ahci_iface->write_blocks_dma == NULL) {
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	const uint64_t blocknum =
+	    (((uint64_t) (DEV_IPC_GET_ARG1(*call))) << 32) |
+	    (((uint64_t) (DEV_IPC_GET_ARG2(*call))) & 0xffffffff);
+	const size_t cnt = (size_t) DEV_IPC_GET_ARG3(*call);
+	const uintptr_t phys = (uintptr_t) DEV_IPC_GET_ARG4(*call);
+
+	const errno_t ret = ahci_iface->write_blocks_dma(fun, blocknum, cnt,
+	    phys);
+
+	async_answer_0(call, ret);
+}
+
+static void remote_ahci_discard_blocks(ddf_fun_t *fun, void *iface,
+    ipc_call_t *call)
+{
+	const ahci_iface_t *ahci_iface = (ahci_iface_t *) iface;
+
+	if (ahci_iface->discard_blocks == NULL) {
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	const uint64_t blocknum =
+	    (((uint64_t) (DEV_IPC_GET_ARG1(*call))) << 32) |
+	    (((uint64_t) (DEV_IPC_GET_ARG2(*call))) & 0xffffffff);
+	const size_t cnt = (size_t) DEV_IPC_GET_ARG3(*call);
+
+	const errno_t ret = ahci_iface->discard_blocks(fun, blocknum, cnt);
+
+	async_answer_0(call, ret);
+}
+
 /**
  * @}
  */
@@ -38,6 +38,8 @@
 #include <async.h>
 #include <errno.h>
 #include <ipc/services.h>
+#include <mem.h>
+#include <stdlib.h>
 #include <time.h>
 #include <macros.h>
 
@@ -85,7 +87,8 @@ typedef enum {
 	NIC_OFFLOAD_SET,
 	NIC_POLL_GET_MODE,
 	NIC_POLL_SET_MODE,
-	NIC_POLL_NOW
+	NIC_POLL_NOW,
+	NIC_SEND_FRAMES
 } nic_funcs_t;
 
 /** Send frame from NIC
@@ -117,6 +120,68 @@ errno_t nic_send_frame(async_sess_t *dev_sess, void *data, size_t size)
 	return retval;
 }
 
+/** Send multiple frames from NIC in a single exchange
+ *
+ * The frames are serialized into one buffer (frame sizes followed by
+ * frame data) which is transferred with a single data write, so a burst
+ * of frames does not pay one full IPC round trip per frame.
+ *
+ * @param[in] dev_sess
+ * @param[in] frames   Array of pointers to frame data
+ * @param[in] sizes    Array of frame sizes in bytes
+ * @param[in] count    Number of frames
+ *
+ * @return EOK If the operation was successfully completed
+ *
+ */
+errno_t nic_send_frames(async_sess_t *dev_sess, void **frames, size_t *sizes,
+    size_t count)
+{
+	void *buf;
+	uint8_t *dp;
+	uint32_t *szp;
+	size_t total;
+	size_t i;
+
+	if (count == 1)
+		return nic_send_frame(dev_sess, frames[0], sizes[0]);
+
+	total = count * sizeof(uint32_t);
+	for (i = 0; i < count; i++)
+		total += sizes[i];
+
+	buf = malloc(total);
+	if (buf == NULL)
+		return ENOMEM;
+
+	szp = (uint32_t *) buf;
+	dp = (uint8_t *) buf + count * sizeof(uint32_t);
+
+	for (i = 0; i < count; i++) {
+		szp[i] = (uint32_t) sizes[i];
+		memcpy(dp, frames[i], sizes[i]);
+		dp += sizes[i];
+	}
+
+	async_exch_t *exch = async_exchange_begin(dev_sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_2(exch, DEV_IFACE_ID(NIC_DEV_IFACE),
+	    NIC_SEND_FRAMES, count, &answer);
+	errno_t retval = async_data_write_start(exch, buf, total);
+
+	async_exchange_end(exch);
+	free(buf);
+
+	if (retval != EOK) {
+		async_forget(req);
+		return retval;
+	}
+
+	async_wait_for(req, &retval);
+	return retval;
+}
+
 /** Create callback connection from NIC service
  *
  * @param[in] dev_sess
@@ -1356,6 +1421,56 @@ static void remote_nic_send_frame(ddf_fun_t *dev, void *iface,
 	free(data);
 }
 
+static void remote_nic_send_frames(ddf_fun_t *dev, void *iface,
+    ipc_call_t *call)
+{
+	nic_iface_t *nic_iface = (nic_iface_t *) iface;
+	assert(nic_iface->send_frame);
+
+	size_t count = ipc_get_arg2(call);
+	uint32_t *szp;
+	uint8_t *dp;
+	void *data;
+	size_t size;
+	size_t left;
+	size_t i;
+	errno_t rc;
+
+	rc = async_data_write_accept(&data, false, 0, 0, 0, &size);
+	if (rc != EOK) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if (count == 0 || size < count * sizeof(uint32_t)) {
+		async_answer_0(call, EINVAL);
+		free(data);
+		return;
+	}
+
+	szp = (uint32_t *) data;
+	dp = (uint8_t *) data + count * sizeof(uint32_t);
+	left = size - count * sizeof(uint32_t);
+
+	rc = EOK;
+	for (i = 0; i < count; i++) {
+		if (szp[i] > left) {
+			rc = EINVAL;
+			break;
+		}
+
+		rc = nic_iface->send_frame(dev, dp, szp[i]);
+		if (rc != EOK)
+			break;
+
+		dp += szp[i];
+		left -= szp[i];
+	}
+
+	async_answer_0(call, rc);
+	free(data);
+}
+
 static void remote_nic_callback_create(ddf_fun_t *dev, void *iface,
     ipc_call_t *call)
 {
@@ -2529,7 +2644,8 @@ static const remote_iface_func_ptr_t remote_nic_iface_ops[] = {
 	[NIC_OFFLOAD_SET] = remote_nic_offload_set,
 	[NIC_POLL_GET_MODE] = remote_nic_poll_get_mode,
 	[NIC_POLL_SET_MODE] = remote_nic_poll_set_mode,
-	[NIC_POLL_NOW] = remote_nic_poll_now
+	[NIC_POLL_NOW] = remote_nic_poll_now,
+	[NIC_SEND_FRAMES] = remote_nic_send_frames
 };
 
 /** Remote NIC interface structure.
@@ -46,6 +46,11 @@ extern errno_t ahci_get_num_blocks(async_sess_t *, uint64_t *);
 extern errno_t ahci_get_block_size(async_sess_t *, size_t *);
 extern errno_t ahci_read_blocks(async_sess_t *, uint64_t, size_t, void *);
 extern errno_t ahci_write_blocks(async_sess_t *, uint64_t, size_t, void *);
+extern errno_t ahci_read_blocks_dma(async_sess_t *, uint64_t, size_t,
+    uintptr_t);
+extern errno_t ahci_write_blocks_dma(async_sess_t *, uint64_t, size_t,
+    uintptr_t);
+extern errno_t ahci_discard_blocks(async_sess_t *, uint64_t, size_t);
 
 /** AHCI device communication interface. */
 typedef struct {
@@ -54,6 +59,14 @@ typedef struct {
 	errno_t (*get_block_size)(ddf_fun_t *, size_t *);
 	errno_t (*read_blocks)(ddf_fun_t *, uint64_t, size_t, void *);
 	errno_t (*write_blocks)(ddf_fun_t *, uint64_t, size_t, void *);
+	/**
+	 * Optional direct DMA transfers to/from a physically contiguous
+	 * buffer located below 4 GiB.
+	 */
+	errno_t (*read_blocks_dma)(ddf_fun_t *, uint64_t, size_t, uintptr_t);
+	errno_t (*write_blocks_dma)(ddf_fun_t *, uint64_t, size_t, uintptr_t);
+	/** Optional discarding (trimming) of blocks with unneeded data. */
+	errno_t (*discard_blocks)(ddf_fun_t *, uint64_t, size_t);
 } ahci_iface_t;
 
 #endif
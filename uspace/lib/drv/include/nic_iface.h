@@ -46,6 +46,7 @@ typedef enum {
 } nic_event_t;
 
 extern errno_t nic_send_frame(async_sess_t *, void *, size_t);
+extern errno_t nic_send_frames(async_sess_t *, void **, size_t *, size_t);
 extern errno_t nic_callback_create(async_sess_t *, async_port_handler_t, void *);
 extern errno_t nic_get_state(async_sess_t *, nic_device_state_t *);
 extern errno_t nic_set_state(async_sess_t *, nic_device_state_t);
@@ -43,6 +43,9 @@
 
 #define USBDIAG_CATEGORY "usbdiag"
 
+/** Maximum number of transfers kept outstanding by a streaming test. */
+#define USBDIAG_MAX_QUEUE_DEPTH 64
+
 /** Milliseconds */
 typedef unsigned long usbdiag_dur_t;
 
@@ -52,6 +55,11 @@ typedef struct usbdiag_test_params {
 	size_t transfer_size;
 	usbdiag_dur_t min_duration;
 	bool validate_data;
+	/**
+	 * Number of transfers kept outstanding at a time.
+	 * Zero or one means synchronous operation.
+	 */
+	uint32_t queue_depth;
 } usbdiag_test_params_t;
 
 /** Test results. */
@@ -59,6 +67,16 @@ typedef struct usbdiag_test_results {
 	usbdiag_dur_t act_duration;
 	uint32_t transfer_count;
 	size_t transfer_size;
+
+	/** Average throughput in bytes per second */
+	uint64_t throughput;
+
+	/** Per-transfer latency statistics in microseconds */
+	uint32_t lat_min;
+	uint32_t lat_max;
+	uint32_t lat_p50;
+	uint32_t lat_p95;
+	uint32_t lat_p99;
 } usbdiag_test_results_t;
 
 async_sess_t *usbdiag_connect(devman_handle_t);
@@ -36,12 +36,19 @@
 #include <stdint.h>
 #include "types.h"
 
+/** Preferred number of blocks allocated at once for a growing file. */
+#define EXT4_BALLOC_CLUSTER  8
+
 extern errno_t ext4_balloc_free_block(ext4_inode_ref_t *, uint32_t);
 extern errno_t ext4_balloc_free_blocks(ext4_inode_ref_t *, uint32_t, uint32_t);
 extern uint32_t ext4_balloc_get_first_data_block_in_group(ext4_superblock_t *,
     ext4_block_group_ref_t *);
 extern errno_t ext4_balloc_alloc_block(ext4_inode_ref_t *, uint32_t *);
+extern errno_t ext4_balloc_alloc_blocks(ext4_inode_ref_t *, uint32_t,
+    uint32_t *, uint32_t *);
 extern errno_t ext4_balloc_try_alloc_block(ext4_inode_ref_t *, uint32_t, bool *);
+extern errno_t ext4_balloc_try_alloc_blocks(ext4_inode_ref_t *, uint32_t,
+    uint32_t, uint32_t *);
 
 #endif
 
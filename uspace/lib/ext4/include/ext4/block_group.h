@@ -38,6 +38,9 @@
 #include <stdint.h>
 #include "types.h"
 
+/** Free-extent hint value meaning the longest free run is not known. */
+#define EXT4_FREE_EXTENT_HINT_UNKNOWN  UINT32_MAX
+
 extern uint64_t ext4_block_group_get_block_bitmap(ext4_block_group_t *,
     ext4_superblock_t *);
 extern void ext4_block_group_set_block_bitmap(ext4_block_group_t *,
@@ -77,6 +80,15 @@ extern bool ext4_block_group_has_flag(ext4_block_group_t *, uint32_t);
 extern void ext4_block_group_set_flag(ext4_block_group_t *, uint32_t);
 extern void ext4_block_group_clear_flag(ext4_block_group_t *, uint32_t);
 
+extern errno_t ext4_block_group_free_extent_hints_init(ext4_filesystem_t *);
+extern void ext4_block_group_free_extent_hints_fini(ext4_filesystem_t *);
+extern uint32_t ext4_block_group_get_free_extent_hint(ext4_filesystem_t *,
+    uint32_t);
+extern void ext4_block_group_set_free_extent_hint(ext4_filesystem_t *,
+    uint32_t, uint32_t);
+extern void ext4_block_group_reset_free_extent_hint(ext4_filesystem_t *,
+    uint32_t);
+
 #endif
 
 /**
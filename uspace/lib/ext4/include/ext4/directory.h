@@ -52,6 +52,14 @@ extern uint8_t ext4_directory_entry_ll_get_inode_type(ext4_superblock_t *,
 extern void ext4_directory_entry_ll_set_inode_type(ext4_superblock_t *,
     ext4_directory_entry_ll_t *, uint8_t);
 
+extern errno_t ext4_directory_cache_init(ext4_filesystem_t *);
+extern void ext4_directory_cache_fini(ext4_filesystem_t *);
+extern void ext4_directory_cache_invalidate(ext4_inode_ref_t *);
+extern bool ext4_directory_cache_find(ext4_inode_ref_t *, const char *,
+    uint32_t *);
+extern void ext4_directory_cache_insert(ext4_inode_ref_t *, const char *,
+    uint32_t);
+
 extern errno_t ext4_directory_iterator_init(ext4_directory_iterator_t *,
     ext4_inode_ref_t *, aoff64_t);
 extern errno_t ext4_directory_iterator_next(ext4_directory_iterator_t *);
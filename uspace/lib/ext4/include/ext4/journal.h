@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2012 Frantisek Princ
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libext4
+ * @{
+ */
+
+#ifndef LIBEXT4_JOURNAL_H_
+#define LIBEXT4_JOURNAL_H_
+
+#include <stdint.h>
+#include "types.h"
+
+/*
+ * On-disk structures of the JBD2-compatible journal.
+ * All fields are stored in big-endian byte order.
+ */
+
+/** Magic number of all journal blocks. */
+#define EXT4_JOURNAL_MAGIC  0xc03b3998
+
+/* Journal block types */
+#define EXT4_JOURNAL_BLOCK_DESCRIPTOR     1
+#define EXT4_JOURNAL_BLOCK_COMMIT         2
+#define EXT4_JOURNAL_BLOCK_SUPERBLOCK_V1  3
+#define EXT4_JOURNAL_BLOCK_SUPERBLOCK_V2  4
+#define EXT4_JOURNAL_BLOCK_REVOKE         5
+
+/** Common header of all journal blocks. */
+typedef struct ext4_journal_header {
+	uint32_t magic;
+	uint32_t blocktype;
+	uint32_t sequence;
+} ext4_journal_header_t;
+
+/** Journal superblock (first block of the journal file). */
+typedef struct ext4_journal_superblock {
+	ext4_journal_header_t header;
+
+	/* Static information describing the journal */
+	uint32_t blocksize;        /* Journal device block size */
+	uint32_t maxlen;           /* Total blocks in the journal file */
+	uint32_t first;            /* First block of log information */
+
+	/* Dynamic information describing the current state of the log */
+	uint32_t sequence;         /* First commit ID expected in log */
+	uint32_t start;            /* Block number of the start of log */
+	uint32_t error;            /* Error value set by the journal */
+
+	/* The remaining fields are only valid in a version 2 superblock */
+	uint32_t features_compatible;    /* Compatible feature set */
+	uint32_t features_incompatible;  /* Incompatible feature set */
+	uint32_t features_read_only;     /* Read-only compatible feature set */
+	uint8_t uuid[16];                /* UUID of the journal */
+	uint32_t users_count;            /* Number of filesystems sharing log */
+	uint32_t dyn_superblock;         /* Block of dynamic sb copy */
+	uint32_t max_transaction_blocks; /* Limit of journal blocks per trans */
+	uint32_t max_transaction_data;   /* Limit of data blocks per trans */
+	uint8_t checksum_type;           /* Checksum algorithm used */
+	uint8_t padding2[3];
+	uint32_t fc_blocks_count;        /* Number of fast commit blocks */
+	uint32_t padding[41];
+	uint32_t checksum;               /* crc32c(superblock) */
+	uint8_t users[16 * 48];          /* IDs of all filesystems in log */
+} ext4_journal_superblock_t;
+
+/** Tag describing a single block in a descriptor block. */
+typedef struct ext4_journal_block_tag {
+	uint32_t block;            /* Target block number on the filesystem */
+	uint16_t checksum;         /* Truncated crc32c of the block */
+	uint16_t flags;            /* Tag flags */
+} ext4_journal_block_tag_t;
+
+/* Tag flags */
+#define EXT4_JOURNAL_TAG_ESCAPE     1  /* On-disk block is escaped */
+#define EXT4_JOURNAL_TAG_SAME_UUID  2  /* Block has the same UUID as previous */
+#define EXT4_JOURNAL_TAG_DELETED    4  /* Block was deleted by this trans */
+#define EXT4_JOURNAL_TAG_LAST       8  /* Last tag in the descriptor block */
+
+/** Size of the UUID following a tag without EXT4_JOURNAL_TAG_SAME_UUID. */
+#define EXT4_JOURNAL_TAG_UUID_SIZE  16
+
+/** Header of a revocation block. */
+typedef struct ext4_journal_revoke_header {
+	ext4_journal_header_t header;
+	uint32_t count;            /* Bytes used in this block */
+} ext4_journal_revoke_header_t;
+
+/* Journal incompatible features */
+#define EXT4_JOURNAL_FEATURE_INCOMPAT_REVOKE        0x00000001
+#define EXT4_JOURNAL_FEATURE_INCOMPAT_64BIT         0x00000002
+#define EXT4_JOURNAL_FEATURE_INCOMPAT_ASYNC_COMMIT  0x00000004
+
+#define EXT4_JOURNAL_FEATURE_INCOMPAT_SUPP \
+	(EXT4_JOURNAL_FEATURE_INCOMPAT_REVOKE | \
+	EXT4_JOURNAL_FEATURE_INCOMPAT_64BIT)
+
+extern errno_t ext4_journal_recover(ext4_filesystem_t *);
+
+#endif
+
+/**
+ * @}
+ */
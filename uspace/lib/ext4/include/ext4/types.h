@@ -232,6 +232,18 @@ typedef struct ext4_filesystem {
 	ext4_superblock_t *superblock;
 	aoff64_t inode_block_limits[4];
 	aoff64_t inode_blocks_per_level[4];
+
+	/** Cache of decoded extents of recently used i-nodes (see extent.c). */
+	struct ext4_extent_cache *extent_cache;
+
+	/** Cache of directory entry lookups (see directory.c). */
+	struct ext4_directory_cache *directory_cache;
+
+	/**
+	 * Per-group upper bounds on the length of the longest free block
+	 * run (see block_group.c).
+	 */
+	uint32_t *bg_free_extent_hints;
 } ext4_filesystem_t;
 
 /** Size of buffer for volume name. To hold 16 latin-1 chars encoded as UTF-8
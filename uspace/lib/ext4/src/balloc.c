@@ -115,6 +115,12 @@ errno_t ext4_balloc_free_block(ext4_inode_ref_t *inode_ref, uint32_t block_addr)
 	    sb, free_blocks);
 	bg_ref->dirty = true;
 
+	/* The longest free run in the group may have grown */
+	ext4_block_group_reset_free_extent_hint(fs, block_group);
+
+	/* The on-disk data of the block is no longer needed */
+	(void) block_discard(fs->device, block_addr, 1);
+
 	/* Release block group reference */
 	return ext4_filesystem_put_block_group_ref(bg_ref);
 }
@@ -188,6 +194,12 @@ static errno_t ext4_balloc_free_blocks_internal(ext4_inode_ref_t *inode_ref,
 	    sb, free_blocks);
 	bg_ref->dirty = true;
 
+	/* The longest free run in the group may have grown */
+	ext4_block_group_reset_free_extent_hint(fs, block_group_first);
+
+	/* The on-disk data of the blocks is no longer needed */
+	(void) block_discard(fs->device, first, count);
+
 	/* Release block group reference */
 	return ext4_filesystem_put_block_group_ref(bg_ref);
 }
@@ -614,6 +626,283 @@ success:
 	return rc;
 }
 
+/** Find a free run of blocks in a bitmap.
+ *
+ * Scan the bitmap between start and end and look for the shortest run
+ * of free blocks that is at least desired blocks long (best fit). If no
+ * run is long enough, report the longest run found instead. The exact
+ * length of the longest free run is always reported, so that the caller
+ * can record it as the free-extent hint of the group.
+ *
+ * @param bitmap  Pointer to bitmap
+ * @param start   Index of first bit to consider
+ * @param end     Index of first bit beyond the scanned range
+ * @param desired Desired length of the run
+ * @param rindex  Output value - index of the first block of the run
+ * @param rcount  Output value - length of the run (zero if none found)
+ * @param rmax    Output value - length of the longest free run
+ *
+ */
+static void ext4_balloc_find_free_run(uint8_t *bitmap, uint32_t start,
+    uint32_t end, uint32_t desired, uint32_t *rindex, uint32_t *rcount,
+    uint32_t *rmax)
+{
+	uint32_t best_index = 0;
+	uint32_t best_count = 0;
+	uint32_t max_count = 0;
+
+	uint32_t idx = start;
+	while (idx < end) {
+		/* Skip used blocks */
+		if (!ext4_bitmap_is_free_bit(bitmap, idx)) {
+			idx++;
+			continue;
+		}
+
+		/* Measure the free run */
+		uint32_t run_start = idx;
+		while ((idx < end) && (ext4_bitmap_is_free_bit(bitmap, idx)))
+			idx++;
+
+		uint32_t run_count = idx - run_start;
+
+		if (run_count > max_count)
+			max_count = run_count;
+
+		if (run_count >= desired) {
+			/* Best fit: the shortest sufficiently long run */
+			if ((best_count < desired) || (run_count < best_count)) {
+				best_index = run_start;
+				best_count = run_count;
+			}
+		} else {
+			/* Fallback: the longest run found */
+			if ((best_count < desired) && (run_count > best_count)) {
+				best_index = run_start;
+				best_count = run_count;
+			}
+		}
+	}
+
+	*rindex = best_index;
+	*rcount = best_count;
+	*rmax = max_count;
+}
+
+/** Account allocation of a run of blocks.
+ *
+ * Update the free blocks counters in the superblock and in the block
+ * group and the inode blocks count.
+ *
+ * @param inode_ref Inode the blocks were allocated for
+ * @param bg_ref    Block group the blocks were allocated in
+ * @param count     Number of allocated blocks
+ *
+ */
+static void ext4_balloc_account_alloc(ext4_inode_ref_t *inode_ref,
+    ext4_block_group_ref_t *bg_ref, uint32_t count)
+{
+	ext4_superblock_t *sb = inode_ref->fs->superblock;
+	uint32_t block_size = ext4_superblock_get_block_size(sb);
+
+	/* Update superblock free blocks count */
+	uint32_t sb_free_blocks = ext4_superblock_get_free_blocks_count(sb);
+	sb_free_blocks -= count;
+	ext4_superblock_set_free_blocks_count(sb, sb_free_blocks);
+
+	/* Update inode blocks (different block size!) count */
+	uint64_t ino_blocks = ext4_inode_get_blocks_count(sb, inode_ref->inode);
+	ino_blocks += count * (block_size / EXT4_INODE_BLOCK_SIZE);
+	ext4_inode_set_blocks_count(sb, inode_ref->inode, ino_blocks);
+	inode_ref->dirty = true;
+
+	/* Update block group free blocks count */
+	uint32_t bg_free_blocks =
+	    ext4_block_group_get_free_blocks_count(bg_ref->block_group, sb);
+	bg_free_blocks -= count;
+	ext4_block_group_set_free_blocks_count(bg_ref->block_group, sb,
+	    bg_free_blocks);
+	bg_ref->dirty = true;
+}
+
+/** Try to allocate a run of blocks in one block group.
+ *
+ * Scan the group's bitmap for a best-fit run of free blocks of up to
+ * max_count blocks and allocate it. The free-extent hint of the group
+ * is made exact as a side effect of the scan. If the longest free run
+ * of the group is shorter than min_count blocks, nothing is allocated.
+ *
+ * @param inode_ref Inode to allocate blocks for
+ * @param bgid      Index of the block group
+ * @param max_count Maximum number of blocks to allocate
+ * @param min_count Minimum acceptable length of the free run
+ * @param fblock    Output value - address of the first allocated block
+ * @param count     Output value - number of allocated blocks (zero if
+ *                  the group could not satisfy the request)
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_balloc_alloc_blocks_in_group(ext4_inode_ref_t *inode_ref,
+    uint32_t bgid, uint32_t max_count, uint32_t min_count, uint32_t *fblock,
+    uint32_t *count)
+{
+	ext4_filesystem_t *fs = inode_ref->fs;
+	ext4_superblock_t *sb = fs->superblock;
+
+	*count = 0;
+
+	/* Skip groups that cannot possibly satisfy the request */
+	uint32_t hint = ext4_block_group_get_free_extent_hint(fs, bgid);
+	if (hint < min_count)
+		return EOK;
+
+	/* Load block group reference */
+	ext4_block_group_ref_t *bg_ref;
+	errno_t rc = ext4_filesystem_get_block_group_ref(fs, bgid, &bg_ref);
+	if (rc != EOK)
+		return rc;
+
+	uint32_t free_blocks =
+	    ext4_block_group_get_free_blocks_count(bg_ref->block_group, sb);
+	if (free_blocks == 0) {
+		/* This group has no free blocks */
+		ext4_block_group_set_free_extent_hint(fs, bgid, 0);
+		return ext4_filesystem_put_block_group_ref(bg_ref);
+	}
+
+	/* Compute indexes */
+	uint32_t first_in_group =
+	    ext4_balloc_get_first_data_block_in_group(sb, bg_ref);
+	uint32_t first_in_group_index =
+	    ext4_filesystem_blockaddr2_index_in_group(sb, first_in_group);
+	uint32_t blocks_in_group =
+	    ext4_superblock_get_blocks_in_group(sb, bgid);
+
+	/* Load block with bitmap */
+	uint32_t bitmap_block_addr =
+	    ext4_block_group_get_block_bitmap(bg_ref->block_group, sb);
+
+	block_t *bitmap_block;
+	rc = block_get(&bitmap_block, fs->device, bitmap_block_addr,
+	    BLOCK_FLAGS_NONE);
+	if (rc != EOK) {
+		ext4_filesystem_put_block_group_ref(bg_ref);
+		return rc;
+	}
+
+	/* Find a best-fit free run in the bitmap */
+	uint32_t run_index;
+	uint32_t run_count;
+	uint32_t max_run;
+	ext4_balloc_find_free_run(bitmap_block->data, first_in_group_index,
+	    blocks_in_group, max_count, &run_index, &run_count, &max_run);
+
+	/* The scan made the length of the longest free run exact */
+	ext4_block_group_set_free_extent_hint(fs, bgid, max_run);
+
+	if (run_count < min_count) {
+		/* The group cannot satisfy the request */
+		rc = block_put(bitmap_block);
+		if (rc != EOK) {
+			ext4_filesystem_put_block_group_ref(bg_ref);
+			return rc;
+		}
+
+		return ext4_filesystem_put_block_group_ref(bg_ref);
+	}
+
+	if (run_count > max_count)
+		run_count = max_count;
+
+	/* Modify bitmap */
+	ext4_bitmap_set_bits(bitmap_block->data, run_index, run_count);
+	bitmap_block->dirty = true;
+
+	/* Release block with bitmap */
+	rc = block_put(bitmap_block);
+	if (rc != EOK) {
+		ext4_filesystem_put_block_group_ref(bg_ref);
+		return rc;
+	}
+
+	ext4_balloc_account_alloc(inode_ref, bg_ref, run_count);
+
+	*fblock = ext4_filesystem_index_in_group2blockaddr(sb, run_index, bgid);
+	*count = run_count;
+
+	return ext4_filesystem_put_block_group_ref(bg_ref);
+}
+
+/** Allocate a contiguous run of data blocks.
+ *
+ * Allocate up to max_count contiguous blocks, starting the search in
+ * the block group of the goal computed for the inode. First all groups
+ * are searched for a best-fit free run of the full requested length;
+ * only if no group can provide one, the longest available run is
+ * allocated instead. At least one block is allocated on success.
+ *
+ * @param inode_ref Inode to allocate blocks for
+ * @param max_count Maximum number of blocks to allocate
+ * @param fblock    Output value - address of the first allocated block
+ * @param count     Output value - number of allocated blocks
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_balloc_alloc_blocks(ext4_inode_ref_t *inode_ref,
+    uint32_t max_count, uint32_t *fblock, uint32_t *count)
+{
+	ext4_superblock_t *sb = inode_ref->fs->superblock;
+
+	/* Find GOAL */
+	uint32_t goal;
+	errno_t rc = ext4_balloc_find_goal(inode_ref, &goal);
+	if (rc != EOK)
+		return rc;
+
+	uint32_t goal_group = ext4_filesystem_blockaddr2group(sb, goal);
+	uint32_t block_group_count = ext4_superblock_get_block_group_count(sb);
+
+	/* First pass: require a free run of the full requested length */
+	uint32_t bgid = goal_group;
+	uint32_t remaining = block_group_count;
+
+	while (remaining > 0) {
+		rc = ext4_balloc_alloc_blocks_in_group(inode_ref, bgid,
+		    max_count, max_count, fblock, count);
+		if (rc != EOK)
+			return rc;
+
+		if (*count > 0)
+			return EOK;
+
+		/* Goto next group */
+		bgid = (bgid + 1) % block_group_count;
+		remaining--;
+	}
+
+	/* Second pass: accept the longest free run available */
+	bgid = goal_group;
+	remaining = block_group_count;
+
+	while (remaining > 0) {
+		rc = ext4_balloc_alloc_blocks_in_group(inode_ref, bgid,
+		    max_count, 1, fblock, count);
+		if (rc != EOK)
+			return rc;
+
+		if (*count > 0)
+			return EOK;
+
+		/* Goto next group */
+		bgid = (bgid + 1) % block_group_count;
+		remaining--;
+	}
+
+	return ENOSPC;
+}
+
 /** Try to allocate concrete block.
  *
  * @param inode_ref Inode to allocate block for
@@ -699,6 +988,91 @@ terminate:
 	return ext4_filesystem_put_block_group_ref(bg_ref);
 }
 
+/** Try to allocate a run of concrete blocks.
+ *
+ * Try to allocate up to max_count contiguous blocks starting exactly at
+ * block address first. Only as many blocks as are actually free there
+ * are allocated; if the first block itself is busy, no blocks are
+ * allocated and the function still succeeds. The run never crosses a
+ * block group boundary.
+ *
+ * @param inode_ref Inode to allocate blocks for
+ * @param first     Address of the first block of the run
+ * @param max_count Maximum number of blocks to allocate
+ * @param count     Output value - number of allocated blocks
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_balloc_try_alloc_blocks(ext4_inode_ref_t *inode_ref,
+    uint32_t first, uint32_t max_count, uint32_t *count)
+{
+	ext4_filesystem_t *fs = inode_ref->fs;
+	ext4_superblock_t *sb = fs->superblock;
+
+	*count = 0;
+
+	/* Compute indexes */
+	uint32_t block_group = ext4_filesystem_blockaddr2group(sb, first);
+	uint32_t index_in_group =
+	    ext4_filesystem_blockaddr2_index_in_group(sb, first);
+	uint32_t blocks_in_group =
+	    ext4_superblock_get_blocks_in_group(sb, block_group);
+
+	if (index_in_group >= blocks_in_group)
+		return EOK;
+
+	/* Do not cross the block group boundary */
+	if (max_count > blocks_in_group - index_in_group)
+		max_count = blocks_in_group - index_in_group;
+
+	/* Load block group reference */
+	ext4_block_group_ref_t *bg_ref;
+	errno_t rc = ext4_filesystem_get_block_group_ref(fs, block_group,
+	    &bg_ref);
+	if (rc != EOK)
+		return rc;
+
+	/* Load block with bitmap */
+	uint32_t bitmap_block_addr =
+	    ext4_block_group_get_block_bitmap(bg_ref->block_group, sb);
+	block_t *bitmap_block;
+	rc = block_get(&bitmap_block, fs->device, bitmap_block_addr, 0);
+	if (rc != EOK) {
+		ext4_filesystem_put_block_group_ref(bg_ref);
+		return rc;
+	}
+
+	/* Measure the free run starting at the first block */
+	uint32_t free_count = 0;
+	while ((free_count < max_count) &&
+	    (ext4_bitmap_is_free_bit(bitmap_block->data,
+	    index_in_group + free_count)))
+		free_count++;
+
+	/* Modify bitmap */
+	if (free_count > 0) {
+		ext4_bitmap_set_bits(bitmap_block->data, index_in_group,
+		    free_count);
+		bitmap_block->dirty = true;
+	}
+
+	/* Release block with bitmap */
+	rc = block_put(bitmap_block);
+	if (rc != EOK) {
+		/* Error in saving bitmap */
+		ext4_filesystem_put_block_group_ref(bg_ref);
+		return rc;
+	}
+
+	if (free_count > 0)
+		ext4_balloc_account_alloc(inode_ref, bg_ref, free_count);
+
+	*count = free_count;
+
+	return ext4_filesystem_put_block_group_ref(bg_ref);
+}
+
 /**
  * @}
  */
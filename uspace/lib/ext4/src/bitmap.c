@@ -134,6 +134,67 @@ void ext4_bitmap_set_bit(uint8_t *bitmap, uint32_t index)
 	*target |= 1 << bit_index;
 }
 
+/** Set continous set of bits (set to 1).
+ *
+ * Index and count must be checked by caller, if they aren't out of bounds.
+ *
+ * @param bitmap Pointer to bitmap
+ * @param index  Index of first bit to set
+ * @param count  Number of bits to be set
+ *
+ */
+void ext4_bitmap_set_bits(uint8_t *bitmap, uint32_t index, uint32_t count)
+{
+	uint8_t *target;
+	uint32_t idx = index;
+	uint32_t remaining = count;
+	uint32_t byte_index;
+
+	/* Align index to multiple of 8 */
+	while (((idx % 8) != 0) && (remaining > 0)) {
+		byte_index = idx / 8;
+		uint32_t bit_index = idx % 8;
+
+		target = bitmap + byte_index;
+		*target |= 1 << bit_index;
+
+		idx++;
+		remaining--;
+	}
+
+	/* For < 8 bits this check necessary */
+	if (remaining == 0)
+		return;
+
+	assert((idx % 8) == 0);
+
+	byte_index = idx / 8;
+	target = bitmap + byte_index;
+
+	/* Set the whole bytes */
+	while (remaining >= 8) {
+		*target = 0xff;
+
+		idx += 8;
+		remaining -= 8;
+		target++;
+	}
+
+	assert(remaining < 8);
+
+	/* Set remaining bits */
+	while (remaining != 0) {
+		byte_index = idx / 8;
+		uint32_t bit_index = idx % 8;
+
+		target = bitmap + byte_index;
+		*target |= 1 << bit_index;
+
+		idx++;
+		remaining--;
+	}
+}
+
 /** Check if requested bit is free.
  *
  * @param bitmap Pointer to bitmap
@@ -36,6 +36,8 @@
  */
 
 #include <byteorder.h>
+#include <errno.h>
+#include <stdlib.h>
 #include "ext4/block_group.h"
 #include "ext4/superblock.h"
 
@@ -382,6 +384,104 @@ void ext4_block_group_clear_flag(ext4_block_group_t *bg, uint32_t clear_flag)
 	ext4_block_group_set_flags(bg, flags);
 }
 
+/*
+ * Free-extent hints.
+ *
+ * For each block group an in-memory upper bound on the length of the
+ * longest run of free blocks is kept, so that the block allocator can skip
+ * groups that cannot possibly satisfy a multi-block allocation without
+ * loading and scanning their bitmaps.  A hint is made exact whenever the
+ * group's bitmap is scanned, remains a valid upper bound over allocations
+ * (runs can only shrink) and must be reset whenever blocks are freed in
+ * the group (runs may grow).
+ */
+
+/** Initialize the free-extent hints of a filesystem.
+ *
+ * @param fs Filesystem to initialize the hints for
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_block_group_free_extent_hints_init(ext4_filesystem_t *fs)
+{
+	uint32_t count = ext4_superblock_get_block_group_count(fs->superblock);
+
+	fs->bg_free_extent_hints = malloc(count * sizeof(uint32_t));
+	if (fs->bg_free_extent_hints == NULL)
+		return ENOMEM;
+
+	for (uint32_t i = 0; i < count; i++)
+		fs->bg_free_extent_hints[i] = EXT4_FREE_EXTENT_HINT_UNKNOWN;
+
+	return EOK;
+}
+
+/** Destroy the free-extent hints of a filesystem.
+ *
+ * @param fs Filesystem whose hints are destroyed
+ *
+ */
+void ext4_block_group_free_extent_hints_fini(ext4_filesystem_t *fs)
+{
+	free(fs->bg_free_extent_hints);
+	fs->bg_free_extent_hints = NULL;
+}
+
+/** Get the free-extent hint of a block group.
+ *
+ * @param fs   Filesystem the block group belongs to
+ * @param bgid Index of the block group
+ *
+ * @return Upper bound on the length of the longest free block run
+ *
+ */
+uint32_t ext4_block_group_get_free_extent_hint(ext4_filesystem_t *fs,
+    uint32_t bgid)
+{
+	if (fs->bg_free_extent_hints == NULL)
+		return EXT4_FREE_EXTENT_HINT_UNKNOWN;
+
+	return fs->bg_free_extent_hints[bgid];
+}
+
+/** Set the free-extent hint of a block group.
+ *
+ * To be called with the exact length of the longest free block run after
+ * the group's bitmap has been scanned.
+ *
+ * @param fs     Filesystem the block group belongs to
+ * @param bgid   Index of the block group
+ * @param length Length of the longest free block run
+ *
+ */
+void ext4_block_group_set_free_extent_hint(ext4_filesystem_t *fs,
+    uint32_t bgid, uint32_t length)
+{
+	if (fs->bg_free_extent_hints == NULL)
+		return;
+
+	fs->bg_free_extent_hints[bgid] = length;
+}
+
+/** Reset the free-extent hint of a block group.
+ *
+ * Must be called whenever blocks are freed in the group, as the longest
+ * free block run may have grown.
+ *
+ * @param fs   Filesystem the block group belongs to
+ * @param bgid Index of the block group
+ *
+ */
+void ext4_block_group_reset_free_extent_hint(ext4_filesystem_t *fs,
+    uint32_t bgid)
+{
+	if (fs->bg_free_extent_hints == NULL)
+		return;
+
+	fs->bg_free_extent_hints[bgid] = EXT4_FREE_EXTENT_HINT_UNKNOWN;
+}
+
 /**
  * @}
  */
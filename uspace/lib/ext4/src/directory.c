@@ -35,8 +35,11 @@
  * @brief Ext4 directory structure operations.
  */
 
+#include <adt/hash_table.h>
+#include <adt/list.h>
 #include <byteorder.h>
 #include <errno.h>
+#include <fibril_synch.h>
 #include <mem.h>
 #include <stdlib.h>
 #include <str.h>
@@ -46,6 +49,327 @@
 #include "ext4/inode.h"
 #include "ext4/superblock.h"
 
+/*
+ * Cache of directory entry lookups.
+ *
+ * Looking up a name recomputes its hash and walks the htree (or all data
+ * blocks of an unindexed directory) through the block cache on every
+ * lookup.  To make repeat lookups cheap, each filesystem keeps a small
+ * cache of recently resolved names per directory, including negative
+ * results, so lookups of hot names skip the on-disk search entirely.
+ *
+ * The cache is read and populated by the lookup operation (see ops.c)
+ * and all cached names of a directory are dropped whenever the directory
+ * is modified (entry addition, entry removal).
+ */
+
+/** Maximum number of directories with cached lookups per filesystem. */
+#define EXT4_DIRECTORY_CACHE_DIRS   32
+
+/** Maximum number of cached lookups per directory. */
+#define EXT4_DIRECTORY_CACHE_NAMES  64
+
+/** Single cached name lookup. */
+typedef struct {
+	link_t link;		/**< Per-directory LRU list link. */
+
+	/** Resolved i-node number (zero for a negative result). */
+	uint32_t inode;
+
+	/** Looked-up name. */
+	char name[];
+} ext4_directory_cached_name_t;
+
+/** Cached lookups of a single directory. */
+typedef struct {
+	ht_link_t link;		/**< Directory cache hash table link. */
+	link_t lru_link;	/**< Directory cache LRU list link. */
+
+	/** I-node number of the directory. */
+	uint32_t index;
+
+	/** Number of entries in @c names. */
+	size_t count;
+
+	/** Cached names in least-recently-used order. */
+	list_t names;
+} ext4_directory_cache_dir_t;
+
+/** Per-filesystem cache of directory entry lookups. */
+typedef struct ext4_directory_cache {
+	/** Serializes access to the cache. */
+	fibril_mutex_t lock;
+
+	/** Per-directory entries hashed by i-node number. */
+	hash_table_t dirs;
+
+	/** Per-directory entries in least-recently-used order. */
+	list_t lru;
+
+	/** Number of per-directory entries in the cache. */
+	size_t count;
+} ext4_directory_cache_t;
+
+static size_t directory_cache_key_hash(const void *key)
+{
+	return *(const uint32_t *) key;
+}
+
+static size_t directory_cache_hash(const ht_link_t *item)
+{
+	ext4_directory_cache_dir_t *dir =
+	    hash_table_get_inst(item, ext4_directory_cache_dir_t, link);
+	return dir->index;
+}
+
+static bool directory_cache_key_equal(const void *key, const ht_link_t *item)
+{
+	ext4_directory_cache_dir_t *dir =
+	    hash_table_get_inst(item, ext4_directory_cache_dir_t, link);
+	return *(const uint32_t *) key == dir->index;
+}
+
+static const hash_table_ops_t directory_cache_ops = {
+	.hash = directory_cache_hash,
+	.key_hash = directory_cache_key_hash,
+	.key_equal = directory_cache_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL,
+};
+
+/** Remove a directory entry from the lookup cache.
+ *
+ * The cache must be locked.
+ *
+ * @param cache Directory lookup cache
+ * @param dir   Per-directory entry to remove
+ *
+ */
+static void ext4_directory_cache_dir_remove(ext4_directory_cache_t *cache,
+    ext4_directory_cache_dir_t *dir)
+{
+	link_t *link;
+	while ((link = list_first(&dir->names)) != NULL) {
+		list_remove(link);
+		free(list_get_instance(link, ext4_directory_cached_name_t,
+		    link));
+	}
+
+	hash_table_remove_item(&cache->dirs, &dir->link);
+	list_remove(&dir->lru_link);
+	cache->count--;
+	free(dir);
+}
+
+/** Initialize the directory lookup cache of a filesystem.
+ *
+ * @param fs Filesystem to initialize the cache for
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_directory_cache_init(ext4_filesystem_t *fs)
+{
+	ext4_directory_cache_t *cache = malloc(sizeof(ext4_directory_cache_t));
+	if (cache == NULL)
+		return ENOMEM;
+
+	if (!hash_table_create(&cache->dirs, 0, 0, &directory_cache_ops)) {
+		free(cache);
+		return ENOMEM;
+	}
+
+	fibril_mutex_initialize(&cache->lock);
+	list_initialize(&cache->lru);
+	cache->count = 0;
+
+	fs->directory_cache = cache;
+
+	return EOK;
+}
+
+/** Destroy the directory lookup cache of a filesystem.
+ *
+ * @param fs Filesystem whose cache is destroyed
+ *
+ */
+void ext4_directory_cache_fini(ext4_filesystem_t *fs)
+{
+	ext4_directory_cache_t *cache = fs->directory_cache;
+
+	if (cache == NULL)
+		return;
+
+	link_t *link;
+	while ((link = list_first(&cache->lru)) != NULL) {
+		ext4_directory_cache_dir_t *dir = list_get_instance(link,
+		    ext4_directory_cache_dir_t, lru_link);
+
+		ext4_directory_cache_dir_remove(cache, dir);
+	}
+
+	hash_table_destroy(&cache->dirs);
+	free(cache);
+
+	fs->directory_cache = NULL;
+}
+
+/** Drop all cached lookups of a directory.
+ *
+ * Must be called before any modification of the directory contents.
+ *
+ * @param parent Directory whose cached lookups are dropped
+ *
+ */
+void ext4_directory_cache_invalidate(ext4_inode_ref_t *parent)
+{
+	ext4_directory_cache_t *cache = parent->fs->directory_cache;
+
+	fibril_mutex_lock(&cache->lock);
+
+	ht_link_t *link = hash_table_find(&cache->dirs, &parent->index);
+	if (link != NULL) {
+		ext4_directory_cache_dir_t *dir = hash_table_get_inst(link,
+		    ext4_directory_cache_dir_t, link);
+
+		ext4_directory_cache_dir_remove(cache, dir);
+	}
+
+	fibril_mutex_unlock(&cache->lock);
+}
+
+/** Try to find a name in the directory lookup cache.
+ *
+ * @param parent Directory to search the cached lookup for
+ * @param name   Name of the entry to find
+ * @param inode  Output value for the resolved i-node number
+ *               (zero for a cached negative result)
+ *
+ * @return True if the name was found in the cache
+ *
+ */
+bool ext4_directory_cache_find(ext4_inode_ref_t *parent, const char *name,
+    uint32_t *inode)
+{
+	ext4_directory_cache_t *cache = parent->fs->directory_cache;
+	bool found = false;
+
+	fibril_mutex_lock(&cache->lock);
+
+	ht_link_t *link = hash_table_find(&cache->dirs, &parent->index);
+	if (link != NULL) {
+		ext4_directory_cache_dir_t *dir = hash_table_get_inst(link,
+		    ext4_directory_cache_dir_t, link);
+
+		list_foreach(dir->names, link, ext4_directory_cached_name_t,
+		    cname) {
+			if (str_cmp(cname->name, name) == 0) {
+				/* Keep the name young */
+				list_remove(&cname->link);
+				list_append(&cname->link, &dir->names);
+
+				*inode = cname->inode;
+				found = true;
+				break;
+			}
+		}
+
+		/* Keep the directory's entry young */
+		list_remove(&dir->lru_link);
+		list_append(&dir->lru_link, &cache->lru);
+	}
+
+	fibril_mutex_unlock(&cache->lock);
+
+	return found;
+}
+
+/** Insert a resolved lookup into the directory lookup cache.
+ *
+ * @param parent Directory the name was looked up in
+ * @param name   Looked-up name
+ * @param inode  Resolved i-node number (zero for a negative result)
+ *
+ */
+void ext4_directory_cache_insert(ext4_inode_ref_t *parent, const char *name,
+    uint32_t inode)
+{
+	ext4_directory_cache_t *cache = parent->fs->directory_cache;
+
+	fibril_mutex_lock(&cache->lock);
+
+	ext4_directory_cache_dir_t *dir;
+	ht_link_t *link = hash_table_find(&cache->dirs, &parent->index);
+	if (link != NULL) {
+		dir = hash_table_get_inst(link, ext4_directory_cache_dir_t,
+		    link);
+
+		/* Check whether the name is already cached */
+		list_foreach(dir->names, link, ext4_directory_cached_name_t,
+		    cname) {
+			if (str_cmp(cname->name, name) == 0) {
+				list_remove(&cname->link);
+				list_append(&cname->link, &dir->names);
+
+				cname->inode = inode;
+				fibril_mutex_unlock(&cache->lock);
+				return;
+			}
+		}
+	} else {
+		/* Evict the oldest directory entry if the cache is full */
+		if (cache->count >= EXT4_DIRECTORY_CACHE_DIRS) {
+			link_t *lru_link = list_first(&cache->lru);
+			ext4_directory_cache_dir_t *old =
+			    list_get_instance(lru_link,
+			    ext4_directory_cache_dir_t, lru_link);
+
+			ext4_directory_cache_dir_remove(cache, old);
+		}
+
+		dir = malloc(sizeof(ext4_directory_cache_dir_t));
+		if (dir == NULL) {
+			/* The cache is only an optimization */
+			fibril_mutex_unlock(&cache->lock);
+			return;
+		}
+
+		dir->index = parent->index;
+		dir->count = 0;
+		list_initialize(&dir->names);
+
+		hash_table_insert(&cache->dirs, &dir->link);
+		list_append(&dir->lru_link, &cache->lru);
+		cache->count++;
+	}
+
+	size_t size = str_size(name);
+	ext4_directory_cached_name_t *cname =
+	    malloc(sizeof(ext4_directory_cached_name_t) + size + 1);
+	if (cname == NULL) {
+		/* The cache is only an optimization */
+		fibril_mutex_unlock(&cache->lock);
+		return;
+	}
+
+	/* Evict the oldest name if the directory's entry is full */
+	if (dir->count >= EXT4_DIRECTORY_CACHE_NAMES) {
+		link_t *old_link = list_first(&dir->names);
+		list_remove(old_link);
+		free(list_get_instance(old_link, ext4_directory_cached_name_t,
+		    link));
+		dir->count--;
+	}
+
+	cname->inode = inode;
+	memcpy(cname->name, name, size + 1);
+
+	list_append(&cname->link, &dir->names);
+	dir->count++;
+
+	fibril_mutex_unlock(&cache->lock);
+}
+
 /** Get i-node number from directory entry.
  *
  * @param de Directory entry
@@ -393,6 +717,9 @@ errno_t ext4_directory_add_entry(ext4_inode_ref_t *parent, const char *name,
 {
 	ext4_filesystem_t *fs = parent->fs;
 
+	/* The directory will be modified */
+	ext4_directory_cache_invalidate(parent);
+
 	/* Index adding (if allowed) */
 	if ((ext4_superblock_has_feature_compatible(fs->superblock,
 	    EXT4_FEATURE_COMPAT_DIR_INDEX)) &&
@@ -570,6 +897,9 @@ errno_t ext4_directory_remove_entry(ext4_inode_ref_t *parent, const char *name)
 	    EXT4_INODE_MODE_DIRECTORY))
 		return ENOTDIR;
 
+	/* The directory will be modified */
+	ext4_directory_cache_invalidate(parent);
+
 	/* Try to find entry */
 	ext4_directory_search_result_t result;
 	errno_t rc = ext4_directory_find_entry(&result, parent, name);
@@ -34,8 +34,11 @@
  * @brief Ext4 extent structures operations.
  */
 
+#include <adt/hash_table.h>
+#include <adt/list.h>
 #include <byteorder.h>
 #include <errno.h>
+#include <fibril_synch.h>
 #include <mem.h>
 #include <stdlib.h>
 #include "ext4/balloc.h"
@@ -43,6 +46,302 @@
 #include "ext4/inode.h"
 #include "ext4/superblock.h"
 
+/*
+ * Cache of decoded extents.
+ *
+ * Finding the physical block backing a logical block walks the on-disk
+ * extent tree through the block cache, re-reading index blocks on every
+ * file I/O.  To avoid re-walking the tree block by block during sequential
+ * reads of large files, each filesystem keeps a small cache of extents
+ * decoded during previous traversals, keyed by i-node number and searched
+ * by the logical block interval the extent covers.
+ *
+ * The cache is only read and populated by ext4_extent_find_block() and all
+ * cached extents of an i-node are dropped whenever its extent tree is about
+ * to be modified (truncation, block append).
+ */
+
+/** Maximum number of i-nodes with cached extents per filesystem. */
+#define EXT4_EXTENT_CACHE_INODES   32
+
+/** Maximum number of cached extents per i-node. */
+#define EXT4_EXTENT_CACHE_EXTENTS  16
+
+/** Single extent decoded from the on-disk extent tree. */
+typedef struct {
+	/** First logical block covered by the extent. */
+	uint32_t first_block;
+
+	/** Number of blocks covered by the extent. */
+	uint16_t block_count;
+
+	/** Physical block number of the first covered block. */
+	uint64_t start;
+} ext4_extent_cached_t;
+
+/** Cached extents of a single i-node. */
+typedef struct {
+	ht_link_t link;		/**< Extent cache hash table link. */
+	link_t lru_link;	/**< Extent cache LRU list link. */
+
+	/** I-node number. */
+	uint32_t index;
+
+	/** Number of valid entries in @c extents. */
+	size_t count;
+
+	/** Decoded extents, sorted by first logical block. */
+	ext4_extent_cached_t extents[EXT4_EXTENT_CACHE_EXTENTS];
+} ext4_extent_cache_inode_t;
+
+/** Per-filesystem cache of decoded extents. */
+typedef struct ext4_extent_cache {
+	/** Serializes access to the cache. */
+	fibril_mutex_t lock;
+
+	/** Per-i-node entries hashed by i-node number. */
+	hash_table_t inodes;
+
+	/** Per-i-node entries in least-recently-used order. */
+	list_t lru;
+
+	/** Number of per-i-node entries in the cache. */
+	size_t count;
+} ext4_extent_cache_t;
+
+static size_t extent_cache_key_hash(const void *key)
+{
+	return *(const uint32_t *) key;
+}
+
+static size_t extent_cache_hash(const ht_link_t *item)
+{
+	ext4_extent_cache_inode_t *ci =
+	    hash_table_get_inst(item, ext4_extent_cache_inode_t, link);
+	return ci->index;
+}
+
+static bool extent_cache_key_equal(const void *key, const ht_link_t *item)
+{
+	ext4_extent_cache_inode_t *ci =
+	    hash_table_get_inst(item, ext4_extent_cache_inode_t, link);
+	return *(const uint32_t *) key == ci->index;
+}
+
+static const hash_table_ops_t extent_cache_ops = {
+	.hash = extent_cache_hash,
+	.key_hash = extent_cache_key_hash,
+	.key_equal = extent_cache_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL,
+};
+
+/** Initialize the extent cache of a filesystem.
+ *
+ * @param fs Filesystem to initialize the cache for
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_extent_cache_init(ext4_filesystem_t *fs)
+{
+	ext4_extent_cache_t *cache = malloc(sizeof(ext4_extent_cache_t));
+	if (cache == NULL)
+		return ENOMEM;
+
+	if (!hash_table_create(&cache->inodes, 0, 0, &extent_cache_ops)) {
+		free(cache);
+		return ENOMEM;
+	}
+
+	fibril_mutex_initialize(&cache->lock);
+	list_initialize(&cache->lru);
+	cache->count = 0;
+
+	fs->extent_cache = cache;
+
+	return EOK;
+}
+
+/** Destroy the extent cache of a filesystem.
+ *
+ * @param fs Filesystem whose cache is destroyed
+ *
+ */
+void ext4_extent_cache_fini(ext4_filesystem_t *fs)
+{
+	ext4_extent_cache_t *cache = fs->extent_cache;
+
+	if (cache == NULL)
+		return;
+
+	list_foreach_safe(cache->lru, cur_link, next_link) {
+		ext4_extent_cache_inode_t *ci = list_get_instance(cur_link,
+		    ext4_extent_cache_inode_t, lru_link);
+
+		hash_table_remove_item(&cache->inodes, &ci->link);
+		list_remove(&ci->lru_link);
+		free(ci);
+	}
+
+	hash_table_destroy(&cache->inodes);
+	free(cache);
+
+	fs->extent_cache = NULL;
+}
+
+/** Drop all cached extents of an i-node.
+ *
+ * Must be called before any modification of the i-node's extent tree.
+ *
+ * @param inode_ref I-node whose cached extents are dropped
+ *
+ */
+void ext4_extent_cache_invalidate(ext4_inode_ref_t *inode_ref)
+{
+	ext4_extent_cache_t *cache = inode_ref->fs->extent_cache;
+
+	fibril_mutex_lock(&cache->lock);
+
+	ht_link_t *link = hash_table_find(&cache->inodes, &inode_ref->index);
+	if (link != NULL) {
+		ext4_extent_cache_inode_t *ci = hash_table_get_inst(link,
+		    ext4_extent_cache_inode_t, link);
+
+		hash_table_remove_item(&cache->inodes, &ci->link);
+		list_remove(&ci->lru_link);
+		cache->count--;
+		free(ci);
+	}
+
+	fibril_mutex_unlock(&cache->lock);
+}
+
+/** Try to find the extent covering a logical block in the extent cache.
+ *
+ * @param inode_ref I-node to search the cached extent for
+ * @param iblock    Logical block number to find
+ * @param fblock    Output value for physical block number
+ *
+ * @return True if the extent was found in the cache
+ *
+ */
+static bool ext4_extent_cache_find(ext4_inode_ref_t *inode_ref,
+    uint32_t iblock, uint32_t *fblock)
+{
+	ext4_extent_cache_t *cache = inode_ref->fs->extent_cache;
+	bool found = false;
+
+	fibril_mutex_lock(&cache->lock);
+
+	ht_link_t *link = hash_table_find(&cache->inodes, &inode_ref->index);
+	if (link != NULL) {
+		ext4_extent_cache_inode_t *ci = hash_table_get_inst(link,
+		    ext4_extent_cache_inode_t, link);
+
+		for (size_t i = 0; i < ci->count; i++) {
+			ext4_extent_cached_t *ext = &ci->extents[i];
+
+			if ((iblock >= ext->first_block) &&
+			    (iblock < ext->first_block + ext->block_count)) {
+				*fblock = ext->start + iblock -
+				    ext->first_block;
+				found = true;
+				break;
+			}
+		}
+
+		/* Keep the i-node's entry young */
+		list_remove(&ci->lru_link);
+		list_append(&ci->lru_link, &cache->lru);
+	}
+
+	fibril_mutex_unlock(&cache->lock);
+
+	return found;
+}
+
+/** Insert an extent decoded during a tree traversal into the extent cache.
+ *
+ * @param inode_ref   I-node the extent belongs to
+ * @param first_block First logical block covered by the extent
+ * @param block_count Number of blocks covered by the extent
+ * @param start       Physical block number of the first covered block
+ *
+ */
+static void ext4_extent_cache_insert(ext4_inode_ref_t *inode_ref,
+    uint32_t first_block, uint16_t block_count, uint64_t start)
+{
+	ext4_extent_cache_t *cache = inode_ref->fs->extent_cache;
+
+	fibril_mutex_lock(&cache->lock);
+
+	ext4_extent_cache_inode_t *ci;
+	ht_link_t *link = hash_table_find(&cache->inodes, &inode_ref->index);
+	if (link != NULL) {
+		ci = hash_table_get_inst(link, ext4_extent_cache_inode_t,
+		    link);
+	} else {
+		/* Evict the oldest i-node entry if the cache is full */
+		if (cache->count >= EXT4_EXTENT_CACHE_INODES) {
+			link_t *lru_link = list_first(&cache->lru);
+			ext4_extent_cache_inode_t *old =
+			    list_get_instance(lru_link,
+			    ext4_extent_cache_inode_t, lru_link);
+
+			hash_table_remove_item(&cache->inodes, &old->link);
+			list_remove(&old->lru_link);
+			cache->count--;
+			free(old);
+		}
+
+		ci = malloc(sizeof(ext4_extent_cache_inode_t));
+		if (ci == NULL) {
+			/* The cache is only an optimization */
+			fibril_mutex_unlock(&cache->lock);
+			return;
+		}
+
+		ci->index = inode_ref->index;
+		ci->count = 0;
+
+		hash_table_insert(&cache->inodes, &ci->link);
+		list_append(&ci->lru_link, &cache->lru);
+		cache->count++;
+	}
+
+	/* Find the position keeping the extents sorted */
+	size_t pos = 0;
+	while (pos < ci->count) {
+		if (ci->extents[pos].first_block == first_block) {
+			/* The extent is already cached */
+			fibril_mutex_unlock(&cache->lock);
+			return;
+		}
+
+		if (ci->extents[pos].first_block > first_block)
+			break;
+
+		pos++;
+	}
+
+	/* Start over when the i-node's entry is full */
+	if (ci->count == EXT4_EXTENT_CACHE_EXTENTS) {
+		ci->count = 0;
+		pos = 0;
+	}
+
+	memmove(&ci->extents[pos + 1], &ci->extents[pos],
+	    (ci->count - pos) * sizeof(ext4_extent_cached_t));
+
+	ci->extents[pos].first_block = first_block;
+	ci->extents[pos].block_count = block_count;
+	ci->extents[pos].start = start;
+	ci->count++;
+
+	fibril_mutex_unlock(&cache->lock);
+}
+
 /** Get logical number of the block covered by extent.
  *
  * @param extent Extent to load number from
@@ -390,6 +689,10 @@ errno_t ext4_extent_find_block(ext4_inode_ref_t *inode_ref, uint32_t iblock,
 		return EOK;
 	}
 
+	/* Try the cache of already decoded extents first */
+	if (ext4_extent_cache_find(inode_ref, iblock, fblock))
+		return EOK;
+
 	block_t *block = NULL;
 
 	/* Walk through extent tree */
@@ -429,9 +732,15 @@ errno_t ext4_extent_find_block(ext4_inode_ref_t *inode_ref, uint32_t iblock,
 		/* Compute requested physical block address */
 		uint32_t phys_block;
 		uint32_t first = ext4_extent_get_first_block(extent);
+		uint16_t count = ext4_extent_get_block_count(extent);
 		phys_block = ext4_extent_get_start(extent) + iblock - first;
 
 		*fblock = phys_block;
+
+		/* Remember the decoded extent for future traversals */
+		if ((iblock >= first) && (iblock < first + count))
+			ext4_extent_cache_insert(inode_ref, first, count,
+			    ext4_extent_get_start(extent));
 	}
 
 	/* Cleanup */
@@ -619,6 +928,9 @@ static errno_t ext4_extent_release_branch(ext4_inode_ref_t *inode_ref,
 errno_t ext4_extent_release_blocks_from(ext4_inode_ref_t *inode_ref,
     uint32_t iblock_from)
 {
+	/* The extent tree will be modified */
+	ext4_extent_cache_invalidate(inode_ref);
+
 	/* Find the first extent to modify */
 	ext4_extent_path_t *path;
 	errno_t rc2;
@@ -953,6 +1265,9 @@ static errno_t ext4_extent_append_extent(ext4_inode_ref_t *inode_ref,
  * This function allocates data block, tries to append it
  * to some existing extent or creates new extents.
  * It includes possible extent tree modifications (splitting).
+ * To reduce fragmentation and the number of bitmap scans, blocks are
+ * allocated in clusters of up to EXT4_BALLOC_CLUSTER blocks and the
+ * extra blocks are kept in the extent for subsequent appends.
  *
  * @param inode_ref I-node to append block to
  * @param iblock    Output logical number of newly allocated block
@@ -989,6 +1304,9 @@ errno_t ext4_extent_append_block(ext4_inode_ref_t *inode_ref, uint32_t *iblock,
 	while (path_ptr->depth != 0)
 		path_ptr++;
 
+	uint32_t phys_block = 0;
+	uint32_t alloc_count = 0;
+
 	/* Add new extent to the node if not present */
 	if (path_ptr->extent == NULL)
 		goto append_extent;
@@ -996,19 +1314,22 @@ errno_t ext4_extent_append_block(ext4_inode_ref_t *inode_ref, uint32_t *iblock,
 	uint16_t block_count = ext4_extent_get_block_count(path_ptr->extent);
 	uint16_t block_limit = (1 << 15);
 
-	uint32_t phys_block = 0;
 	if (block_count < block_limit) {
 		/* There is space for new block in the extent */
 		if (block_count == 0) {
 			/* Existing extent is empty */
-			rc = ext4_balloc_alloc_block(inode_ref, &phys_block);
+			rc = ext4_balloc_alloc_blocks(inode_ref,
+			    EXT4_BALLOC_CLUSTER, &phys_block, &alloc_count);
 			if (rc != EOK)
 				goto finish;
 
+			/* The extent tree will be modified */
+			ext4_extent_cache_invalidate(inode_ref);
+
 			/* Initialize extent */
 			ext4_extent_set_first_block(path_ptr->extent, new_block_idx);
 			ext4_extent_set_start(path_ptr->extent, phys_block);
-			ext4_extent_set_block_count(path_ptr->extent, 1);
+			ext4_extent_set_block_count(path_ptr->extent, alloc_count);
 
 			/* Update i-node */
 			if (update_size) {
@@ -1020,23 +1341,50 @@ errno_t ext4_extent_append_block(ext4_inode_ref_t *inode_ref, uint32_t *iblock,
 
 			goto finish;
 		} else {
+			uint32_t first_block =
+			    ext4_extent_get_first_block(path_ptr->extent);
+
+			if (new_block_idx < first_block + block_count) {
+				/* The block was already allocated ahead */
+				phys_block =
+				    ext4_extent_get_start(path_ptr->extent) +
+				    (new_block_idx - first_block);
+
+				/* Update i-node */
+				if (update_size) {
+					ext4_inode_set_size(inode_ref->inode,
+					    inode_size + block_size);
+					inode_ref->dirty = true;
+				}
+
+				goto finish;
+			}
+
 			/* Existing extent contains some blocks */
 			phys_block = ext4_extent_get_start(path_ptr->extent);
-			phys_block += ext4_extent_get_block_count(path_ptr->extent);
+			phys_block += block_count;
+
+			/* Check if the following blocks are free for allocation */
+			uint32_t limit_count = EXT4_BALLOC_CLUSTER;
+			if (limit_count > (uint32_t) (block_limit - block_count))
+				limit_count = block_limit - block_count;
 
-			/* Check if the following block is free for allocation */
-			bool free;
-			rc = ext4_balloc_try_alloc_block(inode_ref, phys_block, &free);
+			rc = ext4_balloc_try_alloc_blocks(inode_ref, phys_block,
+			    limit_count, &alloc_count);
 			if (rc != EOK)
 				goto finish;
 
-			if (!free) {
+			if (alloc_count == 0) {
 				/* Target is not free, new block must be appended to new extent */
 				goto append_extent;
 			}
 
+			/* The extent tree will be modified */
+			ext4_extent_cache_invalidate(inode_ref);
+
 			/* Update extent */
-			ext4_extent_set_block_count(path_ptr->extent, block_count + 1);
+			ext4_extent_set_block_count(path_ptr->extent,
+			    block_count + alloc_count);
 
 			/* Update i-node */
 			if (update_size) {
@@ -1054,15 +1402,23 @@ append_extent:
 	/* Append new extent to the tree */
 	phys_block = 0;
 
-	/* Allocate new data block */
-	rc = ext4_balloc_alloc_block(inode_ref, &phys_block);
+	/* Allocate new data blocks */
+	rc = ext4_balloc_alloc_blocks(inode_ref, EXT4_BALLOC_CLUSTER,
+	    &phys_block, &alloc_count);
 	if (rc != EOK)
 		goto finish;
 
+	/*
+	 * The extent tree will be modified. The cache may be invalidated
+	 * only now, as the block allocator could have repopulated it while
+	 * looking up the allocation goal.
+	 */
+	ext4_extent_cache_invalidate(inode_ref);
+
 	/* Append extent for new block (includes tree splitting if needed) */
 	rc = ext4_extent_append_extent(inode_ref, path, new_block_idx);
 	if (rc != EOK) {
-		ext4_balloc_free_block(inode_ref, phys_block);
+		ext4_balloc_free_blocks(inode_ref, phys_block, alloc_count);
 		goto finish;
 	}
 
@@ -1070,7 +1426,7 @@ append_extent:
 	path_ptr = path + tree_depth;
 
 	/* Initialize newly created extent */
-	ext4_extent_set_block_count(path_ptr->extent, 1);
+	ext4_extent_set_block_count(path_ptr->extent, alloc_count);
 	ext4_extent_set_first_block(path_ptr->extent, new_block_idx);
 	ext4_extent_set_start(path_ptr->extent, phys_block);
 
@@ -53,6 +53,7 @@
 #include "ext4/filesystem.h"
 #include "ext4/ialloc.h"
 #include "ext4/inode.h"
+#include "ext4/journal.h"
 #include "ext4/ops.h"
 #include "ext4/superblock.h"
 
@@ -119,10 +120,17 @@ static errno_t ext4_filesystem_init(ext4_filesystem_t *fs, service_id_t service_
 
 	uint16_t state = ext4_superblock_get_state(fs->superblock);
 
-	if (((state & EXT4_SUPERBLOCK_STATE_VALID_FS) !=
+	/* A journaled filesystem can be recovered from an unclean state */
+	bool recover = ext4_superblock_has_feature_compatible(fs->superblock,
+	    EXT4_FEATURE_COMPAT_HAS_JOURNAL) &&
+	    ext4_superblock_has_feature_incompatible(fs->superblock,
+	    EXT4_FEATURE_INCOMPAT_RECOVER);
+
+	if ((!recover) &&
+	    (((state & EXT4_SUPERBLOCK_STATE_VALID_FS) !=
 	    EXT4_SUPERBLOCK_STATE_VALID_FS) ||
 	    ((state & EXT4_SUPERBLOCK_STATE_ERROR_FS) ==
-	    EXT4_SUPERBLOCK_STATE_ERROR_FS)) {
+	    EXT4_SUPERBLOCK_STATE_ERROR_FS))) {
 		rc = ENOTSUP;
 		goto err_2;
 	}
@@ -137,6 +145,39 @@ static errno_t ext4_filesystem_init(ext4_filesystem_t *fs, service_id_t service_
 	if (rc != EOK)
 		goto err_2;
 
+	/* Initialize the cache of decoded extents */
+	rc = ext4_extent_cache_init(fs);
+	if (rc != EOK)
+		goto err_2;
+
+	/* Initialize the free-extent hints of the block groups */
+	rc = ext4_block_group_free_extent_hints_init(fs);
+	if (rc != EOK) {
+		ext4_extent_cache_fini(fs);
+		goto err_2;
+	}
+
+	/* Initialize the cache of directory entry lookups */
+	rc = ext4_directory_cache_init(fs);
+	if (rc != EOK) {
+		ext4_block_group_free_extent_hints_fini(fs);
+		ext4_extent_cache_fini(fs);
+		goto err_2;
+	}
+
+	/* Replay the journal if the filesystem needs recovery */
+	if (recover) {
+		rc = ext4_journal_recover(fs);
+		/* Recovery may have replaced the superblock */
+		temp_superblock = fs->superblock;
+		if (rc != EOK) {
+			ext4_directory_cache_fini(fs);
+			ext4_block_group_free_extent_hints_fini(fs);
+			ext4_extent_cache_fini(fs);
+			goto err_2;
+		}
+	}
+
 	return EOK;
 err_2:
 	block_cache_fini(fs->device);
@@ -155,6 +196,15 @@ err:
  */
 static void ext4_filesystem_fini(ext4_filesystem_t *fs)
 {
+	/* Destroy the cache of directory entry lookups */
+	ext4_directory_cache_fini(fs);
+
+	/* Destroy the free-extent hints */
+	ext4_block_group_free_extent_hints_fini(fs);
+
+	/* Destroy the cache of decoded extents */
+	ext4_extent_cache_fini(fs);
+
 	/* Release memory space for superblock */
 	free(fs->superblock);
 
@@ -521,6 +571,12 @@ static errno_t ext4_filesystem_check_features(ext4_filesystem_t *fs,
 	incompatible_features =
 	    ext4_superblock_get_features_incompatible(fs->superblock);
 	incompatible_features &= ~EXT4_FEATURE_INCOMPAT_SUPP;
+
+	/* A pending journal recovery is handled during mount (see journal.c) */
+	if (ext4_superblock_has_feature_compatible(fs->superblock,
+	    EXT4_FEATURE_COMPAT_HAS_JOURNAL))
+		incompatible_features &= ~EXT4_FEATURE_INCOMPAT_RECOVER;
+
 	if (incompatible_features > 0)
 		return ENOTSUP;
 
@@ -0,0 +1,623 @@
+/*
+ * Copyright (c) 2012 Frantisek Princ
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libext4
+ * @{
+ */
+/**
+ * @file  journal.c
+ * @brief Recovery of the JBD2-compatible journal.
+ *
+ * Replays transactions committed to the journal before a crash, so that
+ * a journaled volume can be mounted without running a full filesystem
+ * check.  The recovery follows the usual three passes of JBD2: first the
+ * end of the log is found (scan), then the revocation records of all
+ * committed transactions are collected (revoke) and finally the logged
+ * blocks are copied to their home locations on the filesystem (replay),
+ * skipping blocks that were revoked by a later transaction.
+ */
+
+#include <adt/hash_table.h>
+#include <block.h>
+#include <byteorder.h>
+#include <errno.h>
+#include <mem.h>
+#include <stdlib.h>
+#include "ext4/filesystem.h"
+#include "ext4/inode.h"
+#include "ext4/journal.h"
+#include "ext4/superblock.h"
+
+/* Recovery passes */
+#define EXT4_JOURNAL_PASS_SCAN    0
+#define EXT4_JOURNAL_PASS_REVOKE  1
+#define EXT4_JOURNAL_PASS_REPLAY  2
+
+/** State of a journal recovery. */
+typedef struct {
+	/** Filesystem being recovered. */
+	ext4_filesystem_t *fs;
+
+	/** Reference to the journal file i-node. */
+	ext4_inode_ref_t *inode_ref;
+
+	/** First block of log information. */
+	uint32_t first;
+
+	/** Total number of blocks in the journal file. */
+	uint32_t maxlen;
+
+	/** Whether the journal uses 64-bit block tags. */
+	bool addr64;
+
+	/** Revoked blocks hashed by block number. */
+	hash_table_t revoked;
+} ext4_journal_recovery_t;
+
+/** Single revoked block. */
+typedef struct {
+	ht_link_t link;
+
+	/** Number of the revoked block on the filesystem. */
+	uint64_t block;
+
+	/** Sequence number of the newest transaction revoking the block. */
+	uint32_t sequence;
+} ext4_journal_revoked_t;
+
+static size_t revoked_key_hash(const void *key)
+{
+	return (size_t) *(const uint64_t *) key;
+}
+
+static size_t revoked_hash(const ht_link_t *item)
+{
+	ext4_journal_revoked_t *revoked =
+	    hash_table_get_inst(item, ext4_journal_revoked_t, link);
+	return (size_t) revoked->block;
+}
+
+static bool revoked_key_equal(const void *key, const ht_link_t *item)
+{
+	ext4_journal_revoked_t *revoked =
+	    hash_table_get_inst(item, ext4_journal_revoked_t, link);
+	return *(const uint64_t *) key == revoked->block;
+}
+
+static void revoked_remove_callback(ht_link_t *item)
+{
+	free(hash_table_get_inst(item, ext4_journal_revoked_t, link));
+}
+
+static const hash_table_ops_t revoked_ops = {
+	.hash = revoked_hash,
+	.key_hash = revoked_key_hash,
+	.key_equal = revoked_key_equal,
+	.equal = NULL,
+	.remove_callback = revoked_remove_callback,
+};
+
+/** Load a block of the journal file.
+ *
+ * @param rec    Recovery state
+ * @param jblock Logical block number within the journal file
+ * @param block  Output pointer to the loaded block
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_block_get(ext4_journal_recovery_t *rec,
+    uint32_t jblock, block_t **block)
+{
+	uint32_t fblock;
+	errno_t rc = ext4_filesystem_get_inode_data_block_index(rec->inode_ref,
+	    jblock, &fblock);
+	if (rc != EOK)
+		return rc;
+
+	return block_get(block, rec->fs->device, fblock, BLOCK_FLAGS_NONE);
+}
+
+/** Compute the journal block following the passed one.
+ *
+ * The log wraps around to its first block at the end of the journal file.
+ *
+ * @param rec    Recovery state
+ * @param jblock Logical block number within the journal file
+ *
+ * @return Following logical block number
+ *
+ */
+static uint32_t ext4_journal_next_block(ext4_journal_recovery_t *rec,
+    uint32_t jblock)
+{
+	jblock++;
+	if (jblock >= rec->maxlen)
+		jblock = rec->first;
+
+	return jblock;
+}
+
+/** Record the revocation of a block.
+ *
+ * Only the newest revoking transaction of each block is kept.
+ *
+ * @param rec      Recovery state
+ * @param block    Number of the revoked block on the filesystem
+ * @param sequence Sequence number of the revoking transaction
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_revoked_insert(ext4_journal_recovery_t *rec,
+    uint64_t block, uint32_t sequence)
+{
+	ht_link_t *link = hash_table_find(&rec->revoked, &block);
+	if (link != NULL) {
+		ext4_journal_revoked_t *revoked = hash_table_get_inst(link,
+		    ext4_journal_revoked_t, link);
+
+		if (sequence > revoked->sequence)
+			revoked->sequence = sequence;
+
+		return EOK;
+	}
+
+	ext4_journal_revoked_t *revoked =
+	    malloc(sizeof(ext4_journal_revoked_t));
+	if (revoked == NULL)
+		return ENOMEM;
+
+	revoked->block = block;
+	revoked->sequence = sequence;
+
+	hash_table_insert(&rec->revoked, &revoked->link);
+
+	return EOK;
+}
+
+/** Check whether a block is revoked for a transaction.
+ *
+ * @param rec      Recovery state
+ * @param block    Number of the block on the filesystem
+ * @param sequence Sequence number of the replayed transaction
+ *
+ * @return True if the block must not be replayed
+ *
+ */
+static bool ext4_journal_is_revoked(ext4_journal_recovery_t *rec,
+    uint64_t block, uint32_t sequence)
+{
+	ht_link_t *link = hash_table_find(&rec->revoked, &block);
+	if (link == NULL)
+		return false;
+
+	ext4_journal_revoked_t *revoked = hash_table_get_inst(link,
+	    ext4_journal_revoked_t, link);
+
+	return revoked->sequence >= sequence;
+}
+
+/** Copy a logged block to its home location on the filesystem.
+ *
+ * @param rec      Recovery state
+ * @param jblock   Journal block holding the logged data
+ * @param target   Number of the home block on the filesystem
+ * @param flags    Tag flags of the logged block
+ * @param sequence Sequence number of the replayed transaction
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_replay_block(ext4_journal_recovery_t *rec,
+    uint32_t jblock, uint64_t target, uint16_t flags, uint32_t sequence)
+{
+	/* Deleted and revoked blocks must not be replayed */
+	if ((flags & EXT4_JOURNAL_TAG_DELETED) != 0)
+		return EOK;
+
+	if (ext4_journal_is_revoked(rec, target, sequence))
+		return EOK;
+
+	block_t *src;
+	errno_t rc = ext4_journal_block_get(rec, jblock, &src);
+	if (rc != EOK)
+		return rc;
+
+	block_t *dst;
+	rc = block_get(&dst, rec->fs->device, target, BLOCK_FLAGS_NOREAD);
+	if (rc != EOK) {
+		block_put(src);
+		return rc;
+	}
+
+	uint32_t block_size =
+	    ext4_superblock_get_block_size(rec->fs->superblock);
+	memcpy(dst->data, src->data, block_size);
+
+	/* Restore the magic number of an escaped block */
+	if ((flags & EXT4_JOURNAL_TAG_ESCAPE) != 0)
+		*((uint32_t *) dst->data) = host2uint32_t_be(EXT4_JOURNAL_MAGIC);
+
+	dst->dirty = true;
+
+	rc = block_put(dst);
+
+	errno_t rc2 = block_put(src);
+	if (rc == EOK)
+		rc = rc2;
+
+	return rc;
+}
+
+/** Process a descriptor block and the logged blocks following it.
+ *
+ * @param rec      Recovery state
+ * @param pass     Recovery pass being executed
+ * @param block    Loaded descriptor block
+ * @param sequence Sequence number of the transaction
+ * @param jblock   Logical journal block of the descriptor, advanced
+ *                 past the logged blocks of the transaction
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_process_descriptor(ext4_journal_recovery_t *rec,
+    int pass, block_t *block, uint32_t sequence, uint32_t *jblock)
+{
+	uint32_t block_size =
+	    ext4_superblock_get_block_size(rec->fs->superblock);
+
+	size_t tag_size = sizeof(ext4_journal_block_tag_t);
+	if (rec->addr64)
+		tag_size += sizeof(uint32_t);
+
+	uint32_t data_block = ext4_journal_next_block(rec, *jblock);
+
+	size_t offset = sizeof(ext4_journal_header_t);
+	while (offset + tag_size <= block_size) {
+		ext4_journal_block_tag_t *tag = block->data + offset;
+		uint16_t flags = uint16_t_be2host(tag->flags);
+
+		uint64_t target = uint32_t_be2host(tag->block);
+		if (rec->addr64) {
+			uint32_t high = uint32_t_be2host(*((uint32_t *)
+			    (block->data + offset +
+			    sizeof(ext4_journal_block_tag_t))));
+			target |= ((uint64_t) high) << 32;
+		}
+
+		offset += tag_size;
+		if ((flags & EXT4_JOURNAL_TAG_SAME_UUID) == 0)
+			offset += EXT4_JOURNAL_TAG_UUID_SIZE;
+
+		if (pass == EXT4_JOURNAL_PASS_REPLAY) {
+			errno_t rc = ext4_journal_replay_block(rec, data_block,
+			    target, flags, sequence);
+			if (rc != EOK)
+				return rc;
+		}
+
+		data_block = ext4_journal_next_block(rec, data_block);
+
+		if ((flags & EXT4_JOURNAL_TAG_LAST) != 0)
+			break;
+	}
+
+	*jblock = data_block;
+
+	return EOK;
+}
+
+/** Collect the revocation records of a revocation block.
+ *
+ * @param rec      Recovery state
+ * @param block    Loaded revocation block
+ * @param sequence Sequence number of the revoking transaction
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_process_revoke(ext4_journal_recovery_t *rec,
+    block_t *block, uint32_t sequence)
+{
+	ext4_journal_revoke_header_t *header = block->data;
+
+	uint32_t block_size =
+	    ext4_superblock_get_block_size(rec->fs->superblock);
+
+	uint32_t count = uint32_t_be2host(header->count);
+	if (count > block_size)
+		count = block_size;
+
+	size_t record_size = rec->addr64 ? sizeof(uint64_t) : sizeof(uint32_t);
+
+	size_t offset = sizeof(ext4_journal_revoke_header_t);
+	while (offset + record_size <= count) {
+		uint64_t revoked;
+		if (rec->addr64)
+			revoked = uint64_t_be2host(*((uint64_t *)
+			    (block->data + offset)));
+		else
+			revoked = uint32_t_be2host(*((uint32_t *)
+			    (block->data + offset)));
+
+		errno_t rc = ext4_journal_revoked_insert(rec, revoked,
+		    sequence);
+		if (rc != EOK)
+			return rc;
+
+		offset += record_size;
+	}
+
+	return EOK;
+}
+
+/** Execute a single recovery pass over the log.
+ *
+ * @param rec       Recovery state
+ * @param pass      Recovery pass to execute
+ * @param start     Logical journal block of the start of the log
+ * @param start_seq First sequence number expected in the log
+ * @param end_seq   First sequence number beyond the committed log
+ *                  (ignored by the scan pass)
+ * @param next_seq  Output value for the first sequence number with no
+ *                  commit record found (only set by the scan pass)
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_do_pass(ext4_journal_recovery_t *rec, int pass,
+    uint32_t start, uint32_t start_seq, uint32_t end_seq, uint32_t *next_seq)
+{
+	uint32_t jblock = start;
+	uint32_t sequence = start_seq;
+
+	/* Every iteration consumes at least one block of the log */
+	for (uint32_t iter = 0; iter < rec->maxlen; iter++) {
+		if ((pass != EXT4_JOURNAL_PASS_SCAN) && (sequence >= end_seq))
+			break;
+
+		block_t *block;
+		errno_t rc = ext4_journal_block_get(rec, jblock, &block);
+		if (rc != EOK)
+			return rc;
+
+		ext4_journal_header_t *header = block->data;
+
+		if ((uint32_t_be2host(header->magic) != EXT4_JOURNAL_MAGIC) ||
+		    (uint32_t_be2host(header->sequence) != sequence)) {
+			/* End of the log */
+			return block_put(block);
+		}
+
+		bool done = false;
+
+		switch (uint32_t_be2host(header->blocktype)) {
+		case EXT4_JOURNAL_BLOCK_DESCRIPTOR:
+			rc = ext4_journal_process_descriptor(rec, pass, block,
+			    sequence, &jblock);
+			break;
+		case EXT4_JOURNAL_BLOCK_COMMIT:
+			/* The transaction is committed in full */
+			sequence++;
+			jblock = ext4_journal_next_block(rec, jblock);
+			break;
+		case EXT4_JOURNAL_BLOCK_REVOKE:
+			if (pass == EXT4_JOURNAL_PASS_REVOKE)
+				rc = ext4_journal_process_revoke(rec, block,
+				    sequence);
+
+			jblock = ext4_journal_next_block(rec, jblock);
+			break;
+		default:
+			/* Unrecognized block ends the log */
+			done = true;
+			break;
+		}
+
+		errno_t rc2 = block_put(block);
+		if (rc != EOK)
+			return rc;
+
+		if (rc2 != EOK)
+			return rc2;
+
+		if (done)
+			break;
+	}
+
+	if (next_seq != NULL)
+		*next_seq = sequence;
+
+	return EOK;
+}
+
+/** Replay the journal of a filesystem.
+ *
+ * To be called during mount when the filesystem needs recovery.
+ * On success the transactions committed to the journal are applied,
+ * the journal is emptied and the recovery flag of the filesystem is
+ * cleared on the device.
+ *
+ * @param fs Filesystem to recover
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_journal_recover(ext4_filesystem_t *fs)
+{
+	ext4_superblock_t *sb = fs->superblock;
+
+	/* An external journal cannot be recovered by this driver */
+	if (ext4_superblock_has_feature_incompatible(sb,
+	    EXT4_FEATURE_INCOMPAT_JOURNAL_DEV))
+		return ENOTSUP;
+
+	uint32_t journal_inode = ext4_superblock_get_journal_inode_number(sb);
+	if (journal_inode == 0)
+		return ENOTSUP;
+
+	ext4_journal_recovery_t rec;
+	rec.fs = fs;
+
+	errno_t rc = ext4_filesystem_get_inode_ref(fs, journal_inode,
+	    &rec.inode_ref);
+	if (rc != EOK)
+		return rc;
+
+	/* Load the journal superblock (first block of the journal file) */
+	rec.first = 0;
+	rec.maxlen = 1;
+	rec.addr64 = false;
+
+	block_t *sb_block;
+	rc = ext4_journal_block_get(&rec, 0, &sb_block);
+	if (rc != EOK)
+		goto err;
+
+	ext4_journal_superblock_t *jsb = sb_block->data;
+
+	if (uint32_t_be2host(jsb->header.magic) != EXT4_JOURNAL_MAGIC) {
+		rc = ENOTSUP;
+		goto err_jsb;
+	}
+
+	uint32_t blocktype = uint32_t_be2host(jsb->header.blocktype);
+	if ((blocktype != EXT4_JOURNAL_BLOCK_SUPERBLOCK_V1) &&
+	    (blocktype != EXT4_JOURNAL_BLOCK_SUPERBLOCK_V2)) {
+		rc = ENOTSUP;
+		goto err_jsb;
+	}
+
+	/* The journal must use the block size of the filesystem */
+	if (uint32_t_be2host(jsb->blocksize) !=
+	    ext4_superblock_get_block_size(sb)) {
+		rc = ENOTSUP;
+		goto err_jsb;
+	}
+
+	/* Check the journal features (valid in version 2 only) */
+	uint32_t features_incompatible = 0;
+	if (blocktype == EXT4_JOURNAL_BLOCK_SUPERBLOCK_V2)
+		features_incompatible =
+		    uint32_t_be2host(jsb->features_incompatible);
+
+	if ((features_incompatible &
+	    ~EXT4_JOURNAL_FEATURE_INCOMPAT_SUPP) != 0) {
+		rc = ENOTSUP;
+		goto err_jsb;
+	}
+
+	rec.first = uint32_t_be2host(jsb->first);
+	rec.maxlen = uint32_t_be2host(jsb->maxlen);
+	rec.addr64 = (features_incompatible &
+	    EXT4_JOURNAL_FEATURE_INCOMPAT_64BIT) != 0;
+
+	uint32_t start = uint32_t_be2host(jsb->start);
+	uint32_t start_seq = uint32_t_be2host(jsb->sequence);
+
+	if ((rec.first == 0) || (rec.first >= rec.maxlen) ||
+	    (start >= rec.maxlen)) {
+		rc = ENOTSUP;
+		goto err_jsb;
+	}
+
+	uint32_t next_seq = start_seq;
+
+	if (start != 0) {
+		/* The log is not empty - replay it */
+		if (!hash_table_create(&rec.revoked, 0, 0, &revoked_ops)) {
+			rc = ENOMEM;
+			goto err_jsb;
+		}
+
+		rc = ext4_journal_do_pass(&rec, EXT4_JOURNAL_PASS_SCAN, start,
+		    start_seq, 0, &next_seq);
+		if (rc != EOK)
+			goto err_revoked;
+
+		rc = ext4_journal_do_pass(&rec, EXT4_JOURNAL_PASS_REVOKE,
+		    start, start_seq, next_seq, NULL);
+		if (rc != EOK)
+			goto err_revoked;
+
+		rc = ext4_journal_do_pass(&rec, EXT4_JOURNAL_PASS_REPLAY,
+		    start, start_seq, next_seq, NULL);
+		if (rc != EOK)
+			goto err_revoked;
+
+		hash_table_destroy(&rec.revoked);
+	}
+
+	/* Mark the journal empty */
+	jsb->start = host2uint32_t_be(0);
+	jsb->sequence = host2uint32_t_be(next_seq);
+	sb_block->dirty = true;
+
+	rc = block_put(sb_block);
+	if (rc != EOK)
+		goto err;
+
+	rc = ext4_filesystem_put_inode_ref(rec.inode_ref);
+	if (rc != EOK)
+		return rc;
+
+	/*
+	 * The replay may have restored a newer copy of the superblock on
+	 * the device. Re-read it so that the mount does not continue with
+	 * (and write back) the stale pre-recovery fields.
+	 */
+	ext4_superblock_t *new_sb;
+	rc = ext4_superblock_read_direct(fs->device, &new_sb);
+	if (rc != EOK)
+		return rc;
+
+	ext4_superblock_release(fs->superblock);
+	fs->superblock = new_sb;
+	sb = new_sb;
+
+	/* The filesystem no longer needs recovery */
+	uint32_t features = ext4_superblock_get_features_incompatible(sb);
+	features &= ~EXT4_FEATURE_INCOMPAT_RECOVER;
+	ext4_superblock_set_features_incompatible(sb, features);
+
+	return ext4_superblock_write_direct(fs->device, sb);
+
+err_revoked:
+	hash_table_destroy(&rec.revoked);
+err_jsb:
+	block_put(sb_block);
+err:
+	ext4_filesystem_put_inode_ref(rec.inode_ref);
+	return rc;
+}
+
+/**
+ * @}
+ */
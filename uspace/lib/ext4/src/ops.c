@@ -224,12 +224,28 @@ errno_t ext4_match(fs_node_t **rfn, fs_node_t *pfn, const char *component)
 	    EXT4_INODE_MODE_DIRECTORY))
 		return ENOTDIR;
 
+	/* Try to find the name in the lookup cache */
+	uint32_t inode;
+	if (ext4_directory_cache_find(eparent->inode_ref, component, &inode)) {
+		if (inode == 0) {
+			/* Cached negative result */
+			*rfn = NULL;
+			return EOK;
+		}
+
+		return ext4_node_get_core(rfn, eparent->instance, inode);
+	}
+
 	/* Try to find entry */
 	ext4_directory_search_result_t result;
 	errno_t rc = ext4_directory_find_entry(&result, eparent->inode_ref,
 	    component);
 	if (rc != EOK) {
 		if (rc == ENOENT) {
+			/* Cache the negative result */
+			ext4_directory_cache_insert(eparent->inode_ref,
+			    component, 0);
+
 			*rfn = NULL;
 			return EOK;
 		}
@@ -238,7 +254,8 @@ errno_t ext4_match(fs_node_t **rfn, fs_node_t *pfn, const char *component)
 	}
 
 	/* Load node from search result */
-	uint32_t inode = ext4_directory_entry_ll_get_inode(result.dentry);
+	inode = ext4_directory_entry_ll_get_inode(result.dentry);
+	ext4_directory_cache_insert(eparent->inode_ref, component, inode);
 	rc = ext4_node_get_core(rfn, eparent->instance, inode);
 	if (rc != EOK)
 		goto exit;
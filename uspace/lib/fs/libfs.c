@@ -274,6 +274,83 @@ static void vfs_out_is_empty(ipc_call_t *req)
 	async_answer_0(req, children ? ENOTEMPTY : EOK);
 }
 
+/*
+ * Each in-flight VFS request is served over its own parallel exchange and
+ * thus by its own connection fibril, so requests naturally proceed in
+ * parallel.  However, VFS returns an exchange to its pool as soon as the
+ * request is sent, not when it is answered, so a request whose answer VFS
+ * does not synchronously wait for (VFS_OUT_DESTROY, VFS_OUT_CLOSE) blocks
+ * the next request dispatched over the reused exchange until it completes.
+ *
+ * Such requests are therefore served by a bounded pool of worker fibrils,
+ * freeing the connection fibril to pick up the next request immediately.
+ * Only requests which transfer no data (all data phases must be received by
+ * the connection fibril) and whose ordering is enforced by VFS node
+ * management may be served this way.
+ */
+
+/** Bound on the number of worker fibrils serving offloaded requests. */
+#define LIBFS_MAX_WORKERS	8
+
+static FIBRIL_MUTEX_INITIALIZE(workers_mutex);
+static FIBRIL_CONDVAR_INITIALIZE(workers_cv);
+static unsigned workers_active;
+
+typedef void (*vfs_out_handler_t)(ipc_call_t *);
+
+typedef struct {
+	vfs_out_handler_t handler;
+	ipc_call_t call;
+} libfs_work_t;
+
+static errno_t libfs_worker(void *arg)
+{
+	libfs_work_t *work = (libfs_work_t *) arg;
+
+	work->handler(&work->call);
+	free(work);
+
+	fibril_mutex_lock(&workers_mutex);
+	workers_active--;
+	fibril_condvar_signal(&workers_cv);
+	fibril_mutex_unlock(&workers_mutex);
+
+	return EOK;
+}
+
+/** Serve a request in a worker fibril.
+ *
+ * If the worker bound has been reached, wait until a worker finishes.  If a
+ * worker cannot be created, fall back to serving the request in place.
+ */
+static void vfs_out_dispatch(ipc_call_t *req, vfs_out_handler_t handler)
+{
+	fibril_mutex_lock(&workers_mutex);
+	while (workers_active >= LIBFS_MAX_WORKERS)
+		fibril_condvar_wait(&workers_cv, &workers_mutex);
+
+	libfs_work_t *work = malloc(sizeof(libfs_work_t));
+	fid_t fid = 0;
+	if (work != NULL) {
+		work->handler = handler;
+		work->call = *req;
+		fid = fibril_create(libfs_worker, work);
+	}
+
+	if (fid == 0) {
+		fibril_mutex_unlock(&workers_mutex);
+		if (work != NULL)
+			free(work);
+		handler(req);
+		return;
+	}
+
+	workers_active++;
+	fibril_mutex_unlock(&workers_mutex);
+
+	fibril_add_ready(fid);
+}
+
 static void vfs_connection(ipc_call_t *icall, void *arg)
 {
 	if (icall->cap_handle) {
@@ -320,10 +397,10 @@ static void vfs_connection(ipc_call_t *icall, void *arg)
 			vfs_out_truncate(&call);
 			break;
 		case VFS_OUT_CLOSE:
-			vfs_out_close(&call);
+			vfs_out_dispatch(&call, vfs_out_close);
 			break;
 		case VFS_OUT_DESTROY:
-			vfs_out_destroy(&call);
+			vfs_out_dispatch(&call, vfs_out_destroy);
 			break;
 		case VFS_OUT_OPEN_NODE:
 			vfs_out_open_node(&call);
@@ -46,6 +46,9 @@
 #include <types/gfx/typeface.h>
 #include <riff/chunk.h>
 
+/** Number of entries in single-byte glyph lookup cache */
+#define GFX_FONT_GCACHE_SIZE 128
+
 /** Font
  *
  * This is private to libgfxfont.
@@ -69,6 +72,8 @@ struct gfx_font {
 	gfx_bitmap_t *bitmap;
 	/** Bitmap rectangle */
 	gfx_rect_t rect;
+	/** Glyph lookup cache for single-byte patterns, indexed by byte value */
+	struct gfx_glyph *gcache[GFX_FONT_GCACHE_SIZE];
 };
 
 /** Font info
@@ -88,6 +93,7 @@ struct gfx_font_info {
 	riff_rchunk_t fontck;
 };
 
+extern void gfx_font_gcache_forget(gfx_font_t *, gfx_glyph_t *);
 extern errno_t gfx_font_splice_at_glyph(gfx_font_t *, gfx_glyph_t *,
     gfx_rect_t *);
 extern errno_t gfx_font_info_load(gfx_typeface_t *, riff_rchunk_t *);
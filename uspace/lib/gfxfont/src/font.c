@@ -334,6 +334,12 @@ gfx_glyph_t *gfx_font_prev_glyph(gfx_glyph_t *cur)
 }
 
 /** Search for glyph that should be set for the beginning of a string.
+ *
+ * Glyphs found via a single-byte pattern are remembered in the font's
+ * lookup cache so that text rendering does not walk the entire glyph
+ * list for every character. A cached entry is verified against the
+ * glyph's patterns before use, so a stale entry only costs a fallback
+ * to the full search.
  *
  * @param font Font
  * @param str String whose beginning we would like to set
@@ -346,10 +352,24 @@ errno_t gfx_font_search_glyph(gfx_font_t *font, const char *str,
 {
 	gfx_glyph_t *glyph;
 	size_t msize;
+	uint8_t b0;
+
+	/* Fast path via single-byte pattern cache */
+	b0 = (uint8_t) str[0];
+	if (b0 < GFX_FONT_GCACHE_SIZE) {
+		glyph = font->gcache[b0];
+		if (glyph != NULL && gfx_glyph_matches(glyph, str, &msize)) {
+			*rglyph = glyph;
+			*rsize = msize;
+			return EOK;
+		}
+	}
 
 	glyph = gfx_font_first_glyph(font);
 	while (glyph != NULL) {
 		if (gfx_glyph_matches(glyph, str, &msize)) {
+			if (msize == 1 && b0 < GFX_FONT_GCACHE_SIZE)
+				font->gcache[b0] = glyph;
 			*rglyph = glyph;
 			*rsize = msize;
 			return EOK;
@@ -361,6 +381,24 @@ errno_t gfx_font_search_glyph(gfx_font_t *font, const char *str,
 	return ENOENT;
 }
 
+/** Remove glyph from font's glyph lookup cache.
+ *
+ * Must be called when a glyph is about to be destroyed so that the
+ * cache does not retain a dangling pointer.
+ *
+ * @param font Font
+ * @param glyph Glyph being removed
+ */
+void gfx_font_gcache_forget(gfx_font_t *font, gfx_glyph_t *glyph)
+{
+	int i;
+
+	for (i = 0; i < GFX_FONT_GCACHE_SIZE; i++) {
+		if (font->gcache[i] == glyph)
+			font->gcache[i] = NULL;
+	}
+}
+
 /** Replace glyph graphic with empty space of specified width.
  *
  * This is used to resize a glyph in the font bitmap. This changes
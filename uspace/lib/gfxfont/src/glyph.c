@@ -117,6 +117,7 @@ errno_t gfx_glyph_create(gfx_font_t *font, gfx_glyph_metrics_t *metrics,
  */
 void gfx_glyph_destroy(gfx_glyph_t *glyph)
 {
+	gfx_font_gcache_forget(glyph->font, glyph);
 	list_remove(&glyph->lglyphs);
 	free(glyph);
 }
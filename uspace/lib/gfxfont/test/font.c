@@ -450,6 +450,63 @@ PCUT_TEST(search_glyph)
 	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
 }
 
+/** Repeated glyph search uses lookup cache and survives glyph destruction */
+PCUT_TEST(search_glyph_cached)
+{
+	gfx_font_props_t props;
+	gfx_font_metrics_t metrics;
+	gfx_glyph_metrics_t gmetrics;
+	gfx_typeface_t *tface;
+	gfx_font_t *font;
+	gfx_context_t *gc;
+	gfx_glyph_t *glyph;
+	gfx_glyph_t *sglyph;
+	size_t bytes;
+	test_gc_t tgc;
+	errno_t rc;
+
+	rc = gfx_context_new(&test_ops, (void *)&tgc, &gc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_typeface_create(gc, &tface);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_font_props_init(&props);
+	gfx_font_metrics_init(&metrics);
+	rc = gfx_font_create(tface, &props, &metrics, &font);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_glyph_metrics_init(&gmetrics);
+	rc = gfx_glyph_create(font, &gmetrics, &glyph);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_glyph_set_pattern(glyph, "A");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	/* First search populates the cache */
+	rc = gfx_font_search_glyph(font, "A", &sglyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(glyph, sglyph);
+	PCUT_ASSERT_INT_EQUALS(1, bytes);
+
+	/* Second search is answered from the cache */
+	rc = gfx_font_search_glyph(font, "A", &sglyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(glyph, sglyph);
+	PCUT_ASSERT_INT_EQUALS(1, bytes);
+
+	/* Destroying the glyph must invalidate the cached entry */
+	gfx_glyph_destroy(glyph);
+
+	rc = gfx_font_search_glyph(font, "A", &sglyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	gfx_font_close(font);
+	gfx_typeface_destroy(tface);
+	rc = gfx_context_delete(gc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
 /** Test gfx_font_splice_at_glyph() */
 PCUT_TEST(splice_at_glyph)
 {
@@ -43,6 +43,9 @@
 #include "receive-buffer.h"
 
 typedef struct {
+	/** Link to connection pool */
+	link_t lpool;
+
 	char *host;
 	uint16_t port;
 	inet_addr_t addr;
@@ -130,6 +133,8 @@ extern errno_t http_receive_status(receive_buffer_t *, http_version_t *, uint16_
     char **);
 extern errno_t http_receive_response(receive_buffer_t *, http_response_t **,
     size_t, unsigned);
+extern errno_t http_response_body_size(http_response_t *, size_t *);
+extern bool http_response_keep_alive(http_response_t *);
 extern void http_response_destroy(http_response_t *);
 extern errno_t http_close(http_t *);
 extern void http_destroy(http_t *);
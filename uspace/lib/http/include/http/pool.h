@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2013 Martin Sucha
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup http
+ * @{
+ */
+/**
+ * @file Pool of persistent HTTP connections.
+ */
+
+#ifndef HTTP_POOL_H_
+#define HTTP_POOL_H_
+
+#include <adt/list.h>
+#include <fibril_synch.h>
+#include <stddef.h>
+
+#include "http.h"
+
+/** Pool of idle persistent connections keyed by (host, port) */
+typedef struct {
+	/** Idle connections */
+	list_t conns; /* of http_t */
+	/** Maximum number of idle connections kept */
+	size_t max_idle;
+	/** Lock protecting the pool */
+	fibril_mutex_t lock;
+} http_pool_t;
+
+extern http_pool_t *http_pool_create(size_t);
+extern void http_pool_destroy(http_pool_t *);
+extern errno_t http_pool_get(http_pool_t *, const char *, uint16_t,
+    http_t **);
+extern void http_pool_put(http_pool_t *, http_t *);
+
+#endif
+
+/** @}
+ */
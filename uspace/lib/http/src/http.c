@@ -60,6 +60,8 @@ http_t *http_create(const char *host, uint16_t port)
 	if (http == NULL)
 		return NULL;
 
+	link_initialize(&http->lpool);
+
 	http->host = str_dup(host);
 	if (http->host == NULL) {
 		free(http);
@@ -67,6 +69,9 @@ http_t *http_create(const char *host, uint16_t port)
 	}
 	http->port = port;
 
+	http->tcp = NULL;
+	http->conn = NULL;
+
 	http->buffer_size = 4096;
 	errno_t rc = recv_buffer_init(&http->recv_buffer, http->buffer_size,
 	    http_receive, http);
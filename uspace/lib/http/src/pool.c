@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2013 Martin Sucha
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup http
+ * @{
+ */
+/**
+ * @file Pool of persistent HTTP connections.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <str.h>
+
+#include <http/pool.h>
+
+/** Create a connection pool.
+ *
+ * @param max_idle Maximum number of idle connections kept open
+ * @return Pool or @c NULL if out of memory
+ */
+http_pool_t *http_pool_create(size_t max_idle)
+{
+	http_pool_t *pool = malloc(sizeof(http_pool_t));
+	if (pool == NULL)
+		return NULL;
+
+	list_initialize(&pool->conns);
+	pool->max_idle = max_idle;
+	fibril_mutex_initialize(&pool->lock);
+
+	return pool;
+}
+
+/** Destroy a connection pool, closing all idle connections. */
+void http_pool_destroy(http_pool_t *pool)
+{
+	link_t *link;
+
+	while ((link = list_first(&pool->conns)) != NULL) {
+		http_t *http = list_get_instance(link, http_t, lpool);
+		list_remove(link);
+		http_destroy(http);
+	}
+
+	free(pool);
+}
+
+/** Get a connection to the specified host.
+ *
+ * Return an idle persistent connection from the pool if one is
+ * available, otherwise open a new connection. The caller must return
+ * the connection with http_pool_put() once the response has been read
+ * completely, or dispose of it with http_destroy() if it cannot be
+ * reused (e.g. after an I/O error or http_response_keep_alive()
+ * returning false).
+ */
+errno_t http_pool_get(http_pool_t *pool, const char *host, uint16_t port,
+    http_t **out_http)
+{
+	fibril_mutex_lock(&pool->lock);
+
+	list_foreach(pool->conns, lpool, http_t, http) {
+		if (http->port == port && str_cmp(http->host, host) == 0) {
+			list_remove(&http->lpool);
+			fibril_mutex_unlock(&pool->lock);
+			*out_http = http;
+			return EOK;
+		}
+	}
+
+	fibril_mutex_unlock(&pool->lock);
+
+	http_t *http = http_create(host, port);
+	if (http == NULL)
+		return ENOMEM;
+
+	errno_t rc = http_connect(http);
+	if (rc != EOK) {
+		http_destroy(http);
+		return rc;
+	}
+
+	*out_http = http;
+	return EOK;
+}
+
+/** Return an idle connection to the pool.
+ *
+ * If the pool is full, the oldest idle connection is closed.
+ */
+void http_pool_put(http_pool_t *pool, http_t *http)
+{
+	http_t *evict = NULL;
+
+	fibril_mutex_lock(&pool->lock);
+
+	list_append(&http->lpool, &pool->conns);
+	if (list_count(&pool->conns) > pool->max_idle) {
+		evict = list_get_instance(list_first(&pool->conns),
+		    http_t, lpool);
+		list_remove(&evict->lpool);
+	}
+
+	fibril_mutex_unlock(&pool->lock);
+
+	if (evict != NULL)
+		http_destroy(evict);
+}
+
+/** @}
+ */
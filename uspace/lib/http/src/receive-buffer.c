@@ -144,35 +144,53 @@ errno_t recv_cut_str(receive_buffer_t *rb, receive_buffer_mark_t *a, receive_buf
 	return EOK;
 }
 
+/** Refill an empty buffer from the receive function.
+ *
+ * Data preceding the lowest mark is discarded to make room. Returns
+ * ELIMIT if the entire buffer is pinned down by marks, otherwise EOK
+ * with @a nrecv set to the number of bytes received (zero at the end
+ * of the stream).
+ */
+static errno_t recv_fill(receive_buffer_t *rb, size_t *nrecv)
+{
+	size_t free = rb->size - rb->in;
+	if (free == 0) {
+		size_t min_mark = rb->size;
+		list_foreach(rb->marks, link, receive_buffer_mark_t, mark) {
+			min_mark = min(min_mark, mark->offset);
+		}
+
+		if (min_mark == 0)
+			return ELIMIT;
+
+		size_t new_in = rb->in - min_mark;
+		memmove(rb->buffer, rb->buffer + min_mark, new_in);
+		rb->out = rb->in = new_in;
+		free = rb->size - rb->in;
+		list_foreach(rb->marks, link, receive_buffer_mark_t, mark) {
+			mark->offset -= min_mark;
+		}
+	}
+
+	errno_t rc = rb->receive(rb->client_data, rb->buffer + rb->in, free,
+	    nrecv);
+	if (rc != EOK)
+		return rc;
+
+	rb->in += *nrecv;
+	return EOK;
+}
+
 /** Receive one character (with buffering) */
 errno_t recv_char(receive_buffer_t *rb, char *c, bool consume)
 {
 	if (rb->out == rb->in) {
-		size_t free = rb->size - rb->in;
-		if (free == 0) {
-			size_t min_mark = rb->size;
-			list_foreach(rb->marks, link, receive_buffer_mark_t, mark) {
-				min_mark = min(min_mark, mark->offset);
-			}
-
-			if (min_mark == 0)
-				return ELIMIT;
-
-			size_t new_in = rb->in - min_mark;
-			memmove(rb->buffer, rb->buffer + min_mark, new_in);
-			rb->out = rb->in = new_in;
-			free = rb->size - rb->in;
-			list_foreach(rb->marks, link, receive_buffer_mark_t, mark) {
-				mark->offset -= min_mark;
-			}
-		}
-
 		size_t nrecv;
-		errno_t rc = rb->receive(rb->client_data, rb->buffer + rb->in, free, &nrecv);
+		errno_t rc = recv_fill(rb, &nrecv);
 		if (rc != EOK)
 			return rc;
-
-		rb->in = nrecv;
+		if (nrecv == 0)
+			return EIO;
 	}
 
 	*c = rb->buffer[rb->out];
@@ -242,20 +260,21 @@ errno_t recv_discard_str(receive_buffer_t *rb, const char *discard, size_t *ndis
 errno_t recv_while(receive_buffer_t *rb, char_class_func_t class)
 {
 	while (true) {
-		char c = 0;
-		errno_t rc = recv_char(rb, &c, false);
-		if (rc != EOK)
-			return rc;
+		/* Scan the buffered data block-wise */
+		while (rb->out != rb->in) {
+			if (!class(rb->buffer[rb->out]))
+				return EOK;
 
-		if (!class(c))
-			break;
+			rb->out++;
+		}
 
-		rc = recv_char(rb, &c, true);
+		size_t nrecv;
+		errno_t rc = recv_fill(rb, &nrecv);
 		if (rc != EOK)
 			return rc;
+		if (nrecv == 0)
+			return EIO;
 	}
-
-	return EOK;
 }
 
 /** Receive an end of line, either CR, LF, CRLF or LFCR
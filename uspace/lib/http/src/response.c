@@ -220,6 +220,43 @@ error:
 	return rc;
 }
 
+/** Determine the response body size from the Content-Length header.
+ *
+ * Knowing where the body ends allows the caller to read further
+ * responses from the same persistent connection.
+ *
+ * @return EOK on success, HTTP_EMISSING_HEADER if the server did not
+ *         provide the size or an error code
+ */
+errno_t http_response_body_size(http_response_t *resp, size_t *out_size)
+{
+	char *value = NULL;
+	errno_t rc = http_headers_get(&resp->headers, "Content-Length", &value);
+	if (rc != EOK)
+		return rc;
+
+	return str_size_t(value, NULL, 10, true, out_size);
+}
+
+/** Determine whether the connection can be reused for another request.
+ *
+ * HTTP/1.1 connections are persistent unless the server announced
+ * "Connection: close". Older protocol versions close the connection
+ * after each response.
+ */
+bool http_response_keep_alive(http_response_t *resp)
+{
+	if (resp->version.major != 1 || resp->version.minor < 1)
+		return false;
+
+	char *value = NULL;
+	errno_t rc = http_headers_get(&resp->headers, "Connection", &value);
+	if (rc == EOK && str_casecmp(value, "close") == 0)
+		return false;
+
+	return true;
+}
+
 void http_response_destroy(http_response_t *resp)
 {
 	free(resp->message);
@@ -165,6 +165,22 @@ typedef struct {
 	 */
 	errno_t (*key_config)(struct ieee80211_dev *,
 	    ieee80211_key_config_t *key_conf, bool);
+
+	/** Callback to change TX frame aggregation for given TID.
+	 *
+	 * Called when a block ack session with given TID was established
+	 * or torn down, so the device can start (stop) aggregating data
+	 * frames of that TID into A-MPDUs.
+	 *
+	 * @param ieee80211_dev Pointer to IEEE 802.11 device structure.
+	 * @param tid           Traffic identifier of the session.
+	 * @param enable        True to enable aggregation,
+	 *                      false to disable it.
+	 *
+	 * @return EOK if succeed, error code otherwise.
+	 *
+	 */
+	errno_t (*tx_aggr)(struct ieee80211_dev *, uint8_t, bool);
 } ieee80211_ops_t;
 
 /* Initialization functions. */
@@ -198,6 +214,7 @@ extern bool ieee80211_is_beacon_frame(uint16_t);
 extern bool ieee80211_is_probe_response_frame(uint16_t);
 extern bool ieee80211_is_auth_frame(uint16_t);
 extern bool ieee80211_is_assoc_response_frame(uint16_t);
+extern bool ieee80211_is_action_frame(uint16_t);
 
 /* Worker functions. */
 extern errno_t ieee80211_rx_handler(ieee80211_dev_t *, void *, size_t);
@@ -47,6 +47,7 @@ extern errno_t ieee80211_set_freq_impl(ieee80211_dev_t *, uint16_t);
 extern errno_t ieee80211_bssid_change_impl(ieee80211_dev_t *, bool);
 extern errno_t ieee80211_key_config_impl(ieee80211_dev_t *,
     ieee80211_key_config_t *, bool);
+extern errno_t ieee80211_tx_aggr_impl(ieee80211_dev_t *, uint8_t, bool);
 extern errno_t ieee80211_scan_impl(ieee80211_dev_t *);
 extern errno_t ieee80211_prf(uint8_t *, uint8_t *, uint8_t *, size_t);
 extern errno_t ieee80211_rc4_key_unwrap(uint8_t *, uint8_t *, size_t, uint8_t *);
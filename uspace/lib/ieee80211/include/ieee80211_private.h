@@ -130,8 +130,36 @@ typedef enum {
 	IEEE80211_MGMT_DISASSOC_FRAME = 0xA0,
 	IEEE80211_MGMT_AUTH_FRAME = 0xB0,
 	IEEE80211_MGMT_DEAUTH_FRAME = 0xC0,
+	IEEE80211_MGMT_ACTION_FRAME = 0xD0,
 } ieee80211_frame_mgmt_subtype_t;
 
+/** IEEE 802.11 action frame categories. */
+typedef enum {
+	IEEE80211_ACTION_CAT_BLOCK_ACK = 3
+} ieee80211_action_category_t;
+
+/** IEEE 802.11 block ack action field values. */
+typedef enum {
+	IEEE80211_ACTION_BA_ADDBA_REQ = 0,
+	IEEE80211_ACTION_BA_ADDBA_RESP = 1,
+	IEEE80211_ACTION_BA_DELBA = 2
+} ieee80211_action_ba_t;
+
+/** Immediate block ack policy bit in the block ack parameter set. */
+#define IEEE80211_ADDBA_POLICY_IMMEDIATE  0x0002
+
+/** Shift of the TID subfield in the block ack parameter set. */
+#define IEEE80211_ADDBA_PARAM_TID_SHIFT  2
+
+/** Shift of the buffer size subfield in the block ack parameter set. */
+#define IEEE80211_ADDBA_PARAM_BUFSIZE_SHIFT  6
+
+/** Shift of the TID subfield in the DELBA parameter set. */
+#define IEEE80211_DELBA_PARAM_TID_SHIFT  12
+
+/** Number of frames the originator may send within single block ack. */
+#define IEEE80211_ADDBA_BUFSIZE  64
+
 /** IEEE 802.11 data frame subtypes. */
 typedef enum {
 	IEEE80211_DATA_DATA_FRAME = 0x0000,
@@ -348,6 +376,37 @@ typedef struct {
 } __attribute__((packed)) __attribute__((aligned(2)))
     ieee80211_assoc_resp_body_t;
 
+/** IEEE 802.11 ADDBA request frame body. */
+typedef struct {
+	uint8_t category;
+	uint8_t action;
+	uint8_t dialog_token;
+	uint16_t ba_param_set;  /**< Little Endian value! */
+	uint16_t ba_timeout;    /**< Little Endian value! */
+	uint16_t ba_seq_ctrl;   /**< Little Endian value! */
+} __attribute__((packed)) __attribute__((aligned(2)))
+    ieee80211_addba_req_body_t;
+
+/** IEEE 802.11 ADDBA response frame body. */
+typedef struct {
+	uint8_t category;
+	uint8_t action;
+	uint8_t dialog_token;
+	uint16_t status;        /**< Little Endian value! */
+	uint16_t ba_param_set;  /**< Little Endian value! */
+	uint16_t ba_timeout;    /**< Little Endian value! */
+} __attribute__((packed)) __attribute__((aligned(2)))
+    ieee80211_addba_resp_body_t;
+
+/** IEEE 802.11 DELBA frame body. */
+typedef struct {
+	uint8_t category;
+	uint8_t action;
+	uint16_t delba_param_set;  /**< Little Endian value! */
+	uint16_t reason;           /**< Little Endian value! */
+} __attribute__((packed)) __attribute__((aligned(2)))
+    ieee80211_delba_body_t;
+
 /** IEEE 802.11 beacon frame body start. */
 typedef struct {
 	uint8_t timestamp[8];
@@ -408,6 +467,7 @@ extern void ieee80211_set_auth_phase(ieee80211_dev_t *, ieee80211_auth_phase_t);
 extern errno_t ieee80211_probe_request(ieee80211_dev_t *, char *);
 extern errno_t ieee80211_authenticate(ieee80211_dev_t *);
 extern errno_t ieee80211_associate(ieee80211_dev_t *, char *);
+extern errno_t ieee80211_addba_request(ieee80211_dev_t *, uint8_t);
 extern errno_t ieee80211_deauthenticate(ieee80211_dev_t *);
 
 #endif
@@ -151,6 +151,21 @@ inline bool ieee80211_is_assoc_response_frame(uint16_t frame_ctrl)
 	    IEEE80211_MGMT_ASSOC_RESP_FRAME;
 }
 
+/** Check management action frame.
+ *
+ * @param frame_ctrl Frame control field in little endian (!).
+ *
+ * @return True if it is action frame, otherwise false.
+ *
+ */
+inline bool ieee80211_is_action_frame(uint16_t frame_ctrl)
+{
+	frame_ctrl = uint16_t_le2host(frame_ctrl);
+
+	return (frame_ctrl & IEEE80211_FRAME_CTRL_FRAME_SUBTYPE) ==
+	    IEEE80211_MGMT_ACTION_FRAME;
+}
+
 /** Check data frame "to distribution system" direction.
  *
  * @param frame_ctrl Frame control field in little endian (!).
@@ -674,6 +689,9 @@ static errno_t ieee80211_implement(ieee80211_dev_t *ieee80211_dev,
 		if (!ieee80211_ops->key_config)
 			ieee80211_ops->key_config = ieee80211_key_config_impl;
 
+		if (!ieee80211_ops->tx_aggr)
+			ieee80211_ops->tx_aggr = ieee80211_tx_aggr_impl;
+
 		if (!ieee80211_ops->scan)
 			ieee80211_ops->scan = ieee80211_scan_impl;
 	} else
@@ -1049,6 +1067,66 @@ errno_t ieee80211_associate(ieee80211_dev_t *ieee80211_dev, char *password)
 	return EOK;
 }
 
+/** IEEE 802.11 ADDBA request implementation.
+ *
+ * Asks the AP to establish a block ack session for given TID, so the
+ * data frames of that TID can be aggregated into A-MPDUs. The session
+ * is established when the AP confirms it by an ADDBA response.
+ *
+ * @param ieee80211_dev Pointer to IEEE 802.11 device structure.
+ * @param tid           Traffic identifier of the session.
+ *
+ * @return EOK if succeed, error code otherwise.
+ *
+ */
+errno_t ieee80211_addba_request(ieee80211_dev_t *ieee80211_dev, uint8_t tid)
+{
+	ieee80211_scan_result_t *auth_data =
+	    &ieee80211_dev->bssid_info.res_link->scan_result;
+
+	nic_t *nic = nic_get_from_ddf_dev(ieee80211_dev->ddf_dev);
+	nic_address_t nic_address;
+	nic_query_address(nic, &nic_address);
+
+	size_t buffer_size = sizeof(ieee80211_mgmt_header_t) +
+	    sizeof(ieee80211_addba_req_body_t);
+
+	void *buffer = malloc(buffer_size);
+	if (!buffer)
+		return ENOMEM;
+
+	memset(buffer, 0, buffer_size);
+
+	ieee80211_mgmt_header_t *mgmt_header =
+	    (ieee80211_mgmt_header_t *) buffer;
+
+	mgmt_header->frame_ctrl =
+	    host2uint16_t_le(IEEE80211_MGMT_FRAME |
+	    IEEE80211_MGMT_ACTION_FRAME);
+	memcpy(mgmt_header->dest_addr, auth_data->bssid.address, ETH_ADDR);
+	memcpy(mgmt_header->src_addr, nic_address.address, ETH_ADDR);
+	memcpy(mgmt_header->bssid, auth_data->bssid.address, ETH_ADDR);
+
+	ieee80211_addba_req_body_t *addba_body =
+	    (ieee80211_addba_req_body_t *)
+	    (buffer + sizeof(ieee80211_mgmt_header_t));
+	addba_body->category = IEEE80211_ACTION_CAT_BLOCK_ACK;
+	addba_body->action = IEEE80211_ACTION_BA_ADDBA_REQ;
+	addba_body->dialog_token = 1;
+	addba_body->ba_param_set =
+	    host2uint16_t_le(IEEE80211_ADDBA_POLICY_IMMEDIATE |
+	    (tid << IEEE80211_ADDBA_PARAM_TID_SHIFT) |
+	    (IEEE80211_ADDBA_BUFSIZE << IEEE80211_ADDBA_PARAM_BUFSIZE_SHIFT));
+	addba_body->ba_seq_ctrl =
+	    host2uint16_t_le(ieee80211_dev->sequence_number << 4);
+
+	ieee80211_dev->ops->tx_handler(ieee80211_dev, buffer, buffer_size);
+
+	free(buffer);
+
+	return EOK;
+}
+
 /** IEEE 802.11 deauthentication implementation.
  *
  * Note: Expecting locked results_mutex or scan_mutex.
@@ -1373,6 +1451,9 @@ static errno_t ieee80211_process_assoc_response(ieee80211_dev_t *ieee80211_dev,
 		ieee80211_set_auth_phase(ieee80211_dev,
 		    IEEE80211_AUTH_ASSOCIATED);
 		ieee80211_dev->ops->bssid_change(ieee80211_dev, true);
+
+		/* Try to establish block ack session for best effort TID. */
+		ieee80211_addba_request(ieee80211_dev, 0);
 	}
 
 	fibril_mutex_lock(&ieee80211_dev->gen_mutex);
@@ -1382,6 +1463,73 @@ static errno_t ieee80211_process_assoc_response(ieee80211_dev_t *ieee80211_dev,
 	return EOK;
 }
 
+/** Process action frame.
+ *
+ * Only block ack category is handled - an ADDBA response confirming
+ * (or refusing) a block ack session we requested and a DELBA tearing
+ * an established session down. The device is informed about the
+ * session state change so it can adjust TX frame aggregation.
+ *
+ * @param ieee80211_dev Pointer to IEEE 802.11 device structure.
+ * @param mgmt_header   Pointer to start of management frame header.
+ * @param buffer_size   Size of buffer.
+ *
+ * @return EOK if succeed, error code otherwise.
+ *
+ */
+static errno_t ieee80211_process_action(ieee80211_dev_t *ieee80211_dev,
+    ieee80211_mgmt_header_t *mgmt_header, size_t buffer_size)
+{
+	if (buffer_size < sizeof(ieee80211_mgmt_header_t) + 2)
+		return EINVAL;
+
+	uint8_t *action_body =
+	    (uint8_t *) mgmt_header + sizeof(ieee80211_mgmt_header_t);
+
+	if (action_body[0] != IEEE80211_ACTION_CAT_BLOCK_ACK)
+		return EOK;
+
+	switch (action_body[1]) {
+	case IEEE80211_ACTION_BA_ADDBA_RESP: {
+		if (buffer_size < sizeof(ieee80211_mgmt_header_t) +
+		    sizeof(ieee80211_addba_resp_body_t))
+			return EINVAL;
+
+		ieee80211_addba_resp_body_t *addba_resp =
+		    (ieee80211_addba_resp_body_t *) action_body;
+
+		uint8_t tid =
+		    (uint16_t_le2host(addba_resp->ba_param_set) >>
+		    IEEE80211_ADDBA_PARAM_TID_SHIFT) & 0xF;
+
+		if (addba_resp->status == 0)
+			ieee80211_dev->ops->tx_aggr(ieee80211_dev, tid, true);
+
+		break;
+	}
+	case IEEE80211_ACTION_BA_DELBA: {
+		if (buffer_size < sizeof(ieee80211_mgmt_header_t) +
+		    sizeof(ieee80211_delba_body_t))
+			return EINVAL;
+
+		ieee80211_delba_body_t *delba =
+		    (ieee80211_delba_body_t *) action_body;
+
+		uint8_t tid =
+		    uint16_t_le2host(delba->delba_param_set) >>
+		    IEEE80211_DELBA_PARAM_TID_SHIFT;
+
+		ieee80211_dev->ops->tx_aggr(ieee80211_dev, tid, false);
+
+		break;
+	}
+	default:
+		break;
+	}
+
+	return EOK;
+}
+
 static errno_t ieee80211_process_4way_handshake(ieee80211_dev_t *ieee80211_dev,
     void *buffer, size_t buffer_size)
 {
@@ -1718,6 +1866,10 @@ errno_t ieee80211_rx_handler(ieee80211_dev_t *ieee80211_dev, void *buffer,
 		if (ieee80211_is_assoc_response_frame(mgmt_header->frame_ctrl))
 			return ieee80211_process_assoc_response(ieee80211_dev,
 			    mgmt_header);
+
+		if (ieee80211_is_action_frame(mgmt_header->frame_ctrl))
+			return ieee80211_process_action(ieee80211_dev,
+			    mgmt_header, buffer_size);
 	} else if (ieee80211_is_data_frame(frame_ctrl))
 		return ieee80211_process_data(ieee80211_dev, buffer,
 		    buffer_size);
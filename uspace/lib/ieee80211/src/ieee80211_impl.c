@@ -107,6 +107,21 @@ errno_t ieee80211_key_config_impl(ieee80211_dev_t *ieee80211_dev,
 	return EOK;
 }
 
+/** Default implementation of IEEE802.11 TX aggregation function.
+ *
+ * @param ieee80211_dev Structure of IEEE802.11 device.
+ * @param tid           Traffic identifier of the session.
+ * @param enable        True to enable aggregation, false to disable it.
+ *
+ * @return EOK.
+ *
+ */
+errno_t ieee80211_tx_aggr_impl(ieee80211_dev_t *ieee80211_dev, uint8_t tid,
+    bool enable)
+{
+	return EOK;
+}
+
 /** Default implementation of IEEE802.11 scan function.
  *
  * @param ieee80211_dev Structure of IEEE802.11 device.
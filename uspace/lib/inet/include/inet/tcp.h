@@ -39,6 +39,7 @@
 #include <inet/addr.h>
 #include <inet/endpoint.h>
 #include <inet/inet.h>
+#include <inet/iovec.h>
 
 /** TCP connection */
 typedef struct {
@@ -110,12 +111,17 @@ extern void *tcp_listener_userptr(tcp_listener_t *);
 
 extern errno_t tcp_conn_wait_connected(tcp_conn_t *);
 extern errno_t tcp_conn_send(tcp_conn_t *, const void *, size_t);
+extern errno_t tcp_conn_sendv(tcp_conn_t *, const inet_iovec_t *, size_t);
 extern errno_t tcp_conn_send_fin(tcp_conn_t *);
 extern errno_t tcp_conn_push(tcp_conn_t *);
 extern errno_t tcp_conn_reset(tcp_conn_t *);
 
 extern errno_t tcp_conn_recv(tcp_conn_t *, void *, size_t, size_t *);
 extern errno_t tcp_conn_recv_wait(tcp_conn_t *, void *, size_t, size_t *);
+extern errno_t tcp_conn_recvv(tcp_conn_t *, const inet_iovec_t *, size_t,
+    size_t *);
+extern errno_t tcp_conn_recvv_wait(tcp_conn_t *, const inet_iovec_t *, size_t,
+    size_t *);
 
 #endif
 
@@ -37,6 +37,9 @@
 
 #include <ipc/common.h>
 
+/** Maximum number of fragments in a vectored transfer */
+#define TCP_IOV_MAX 16
+
 typedef enum {
 	TCP_CALLBACK_CREATE = IPC_FIRST_USER_METHOD,
 	TCP_CONN_CREATE,
@@ -48,7 +51,9 @@ typedef enum {
 	TCP_CONN_PUSH,
 	TCP_CONN_RESET,
 	TCP_CONN_RECV,
-	TCP_CONN_RECV_WAIT
+	TCP_CONN_RECV_WAIT,
+	TCP_CONN_SENDV,
+	TCP_CONN_RECVV
 } tcp_request_t;
 
 typedef enum {
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2021 Jiri Svoboda
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libinet
+ * @{
+ */
+/** @file Internet checksum (RFC 1071)
+ */
+
+#include <byteorder.h>
+#include <inet/checksum.h>
+#include <mem.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Compute Internet checksum.
+ *
+ * Add @a size bytes at @a data to the checksum @a ivalue and return the
+ * updated checksum. To checksum a message consisting of several parts,
+ * pass the result of one call as @a ivalue of the next; all parts except
+ * the last must have even size. The first call is passed
+ * @c INET_CHECKSUM_INIT.
+ *
+ * @param ivalue	Initial (previous) checksum value
+ * @param data		Data to checksum
+ * @param size		Size of data in bytes
+ * @return		Updated checksum
+ */
+uint16_t inet_checksum_calc(uint16_t ivalue, const void *data, size_t size)
+{
+	const uint8_t *bdata = data;
+	uint64_t sum;
+	uint64_t w64;
+	uint32_t w32;
+	uint16_t w16;
+
+	/*
+	 * The one's complement sum is independent of byte order, so it can
+	 * be computed over native-order words and converted at the end.
+	 * This allows accumulating entire 64-bit words with deferred
+	 * carry folding instead of adding 16 bits at a time. The memcpy
+	 * calls compile to plain (unaligned) loads.
+	 */
+	sum = host2uint16_t_be((uint16_t) ~ivalue);
+
+	while (size >= 8) {
+		memcpy(&w64, bdata, sizeof(w64));
+		sum += (w64 & 0xffffffff) + (w64 >> 32);
+		bdata += 8;
+		size -= 8;
+	}
+
+	if (size >= 4) {
+		memcpy(&w32, bdata, sizeof(w32));
+		sum += w32;
+		bdata += 4;
+		size -= 4;
+	}
+
+	if (size >= 2) {
+		memcpy(&w16, bdata, sizeof(w16));
+		sum += w16;
+		bdata += 2;
+		size -= 2;
+	}
+
+	if (size > 0) {
+		/* Trailing odd byte is padded with zero */
+		w16 = 0;
+		memcpy(&w16, bdata, 1);
+		sum += w16;
+	}
+
+	/* Fold carries back into 16 bits */
+	while ((sum >> 16) != 0)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return ~uint16_t_be2host((uint16_t) sum);
+}
+
+/** Update checksum after changing a 16-bit word of the message.
+ *
+ * Incrementally update the checksum of a message in which the 16-bit
+ * word @a oldw has been replaced with @a neww, without reading the rest
+ * of the message (RFC 1624 eqn. 3). Words wider than 16 bits (e.g.
+ * addresses) are updated by calling this once per 16-bit word.
+ *
+ * @param cksum		Checksum of the original message
+ * @param oldw		Original value of the word
+ * @param neww		New value of the word
+ * @return		Checksum of the modified message
+ */
+uint16_t inet_checksum_update(uint16_t cksum, uint16_t oldw, uint16_t neww)
+{
+	uint32_t sum;
+
+	sum = (uint16_t) ~cksum;
+	sum += (uint16_t) ~oldw;
+	sum += neww;
+
+	while ((sum >> 16) != 0)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return ~(uint16_t) sum;
+}
+
+/** @}
+ */
@@ -471,6 +471,49 @@ errno_t tcp_conn_send(tcp_conn_t *conn, const void *data, size_t bytes)
 	return rc;
 }
 
+/** Send data over TCP connection from multiple buffers.
+ *
+ * Each buffer of @a iov maps onto one IPC data fragment of a single
+ * exchange, so the fragments need not be assembled into a contiguous
+ * buffer first. The data is sent in the order of the buffers.
+ *
+ * @param conn Connection
+ * @param iov  Array of buffers
+ * @param cnt  Number of buffers (at most @c TCP_IOV_MAX)
+ *
+ * @return EOK on success or an error code
+ */
+errno_t tcp_conn_sendv(tcp_conn_t *conn, const inet_iovec_t *iov, size_t cnt)
+{
+	async_exch_t *exch;
+	errno_t rc;
+
+	if (cnt == 0)
+		return EOK;
+	if (cnt > TCP_IOV_MAX)
+		return EINVAL;
+
+	exch = async_exchange_begin(conn->tcp->sess);
+	aid_t req = async_send_2(exch, TCP_CONN_SENDV, conn->id, cnt, NULL);
+
+	rc = EOK;
+	for (size_t i = 0; i < cnt; i++) {
+		rc = async_data_write_start(exch, iov[i].buffer, iov[i].size);
+		if (rc != EOK)
+			break;
+	}
+
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	async_wait_for(req, &rc);
+	return rc;
+}
+
 /** Send FIN.
  *
  * Send FIN, indicating no more data will be send over the connection.
@@ -629,6 +672,134 @@ again:
 	return EOK;
 }
 
+/** Read received data from connection into multiple buffers.
+ *
+ * Vectored counterpart of tcp_conn_recv(). The buffers of @a iov are
+ * filled consecutively with the received data in a single exchange;
+ * the total number of bytes received is stored in @a *nrecv.
+ *
+ * @param conn  Connection
+ * @param iov   Array of buffers
+ * @param cnt   Number of buffers (at most @c TCP_IOV_MAX)
+ * @param nrecv Place to store actual number of received bytes
+ *
+ * @return EOK on success, EAGAIN if no received data is pending, or other
+ *         error code in case of other error
+ */
+errno_t tcp_conn_recvv(tcp_conn_t *conn, const inet_iovec_t *iov, size_t cnt,
+    size_t *nrecv)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+	errno_t rc;
+
+	if (cnt == 0 || cnt > TCP_IOV_MAX)
+		return EINVAL;
+
+	fibril_mutex_lock(&conn->lock);
+	if (!conn->data_avail) {
+		fibril_mutex_unlock(&conn->lock);
+		return EAGAIN;
+	}
+
+	exch = async_exchange_begin(conn->tcp->sess);
+	aid_t req = async_send_2(exch, TCP_CONN_RECVV, conn->id, cnt, &answer);
+
+	rc = EOK;
+	for (size_t i = 0; i < cnt; i++) {
+		rc = async_data_read_start(exch, iov[i].buffer, iov[i].size);
+		if (rc != EOK)
+			break;
+	}
+
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		fibril_mutex_unlock(&conn->lock);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	if (retval != EOK) {
+		fibril_mutex_unlock(&conn->lock);
+		return retval;
+	}
+
+	*nrecv = ipc_get_arg1(&answer);
+	fibril_mutex_unlock(&conn->lock);
+	return EOK;
+}
+
+/** Read received data from connection into multiple buffers with blocking.
+ *
+ * Vectored counterpart of tcp_conn_recv_wait(). Waits for received data
+ * to become available, then fills the buffers of @a iov consecutively.
+ *
+ * @param conn  Connection
+ * @param iov   Array of buffers
+ * @param cnt   Number of buffers (at most @c TCP_IOV_MAX)
+ * @param nrecv Place to store actual number of received bytes
+ *
+ * @return EOK on success or an error code
+ */
+errno_t tcp_conn_recvv_wait(tcp_conn_t *conn, const inet_iovec_t *iov,
+    size_t cnt, size_t *nrecv)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+	errno_t rc;
+
+	if (cnt == 0 || cnt > TCP_IOV_MAX)
+		return EINVAL;
+
+again:
+	fibril_mutex_lock(&conn->lock);
+	while (!conn->data_avail) {
+		fibril_condvar_wait(&conn->cv, &conn->lock);
+	}
+
+	exch = async_exchange_begin(conn->tcp->sess);
+	aid_t req = async_send_2(exch, TCP_CONN_RECVV, conn->id, cnt, &answer);
+
+	rc = EOK;
+	for (size_t i = 0; i < cnt; i++) {
+		rc = async_data_read_start(exch, iov[i].buffer, iov[i].size);
+		if (rc != EOK)
+			break;
+	}
+
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		if (rc == EAGAIN) {
+			conn->data_avail = false;
+			fibril_mutex_unlock(&conn->lock);
+			goto again;
+		}
+		fibril_mutex_unlock(&conn->lock);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	if (retval != EOK) {
+		if (retval == EAGAIN) {
+			conn->data_avail = false;
+			fibril_mutex_unlock(&conn->lock);
+			goto again;
+		}
+		fibril_mutex_unlock(&conn->lock);
+		return retval;
+	}
+
+	*nrecv = ipc_get_arg1(&answer);
+	fibril_mutex_unlock(&conn->lock);
+	return EOK;
+}
+
 /** Connection established event.
  *
  * @param tcp   TCP client
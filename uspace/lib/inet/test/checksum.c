@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2021 Jiri Svoboda
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <inet/checksum.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(checksum);
+
+/** Test inet_checksum_calc() against the RFC 1071 example */
+PCUT_TEST(calc_rfc1071)
+{
+	uint8_t data[] = { 0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7 };
+
+	PCUT_ASSERT_INT_EQUALS(0x220d, inet_checksum_calc(INET_CHECKSUM_INIT,
+	    data, sizeof(data)));
+}
+
+/** Test inet_checksum_calc() pads a trailing odd byte with zero */
+PCUT_TEST(calc_odd_size)
+{
+	uint8_t data[] = { 0x12, 0x34, 0x56 };
+
+	PCUT_ASSERT_INT_EQUALS((uint16_t) ~(0x1234 + 0x5600),
+	    inet_checksum_calc(INET_CHECKSUM_INIT, data, sizeof(data)));
+}
+
+/** Test checksumming a message in parts gives the same result as whole */
+PCUT_TEST(calc_chained)
+{
+	uint8_t data[29];
+	uint16_t whole;
+	uint16_t parts;
+	unsigned i;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = 251 * i;
+
+	whole = inet_checksum_calc(INET_CHECKSUM_INIT, data, sizeof(data));
+	parts = inet_checksum_calc(INET_CHECKSUM_INIT, data, 10);
+	parts = inet_checksum_calc(parts, data + 10, 8);
+	parts = inet_checksum_calc(parts, data + 18, sizeof(data) - 18);
+
+	PCUT_ASSERT_INT_EQUALS(whole, parts);
+}
+
+/** Test inet_checksum_update() matches full recomputation */
+PCUT_TEST(update)
+{
+	uint8_t data[16];
+	uint16_t oldsum;
+	uint16_t newsum;
+	uint16_t oldw;
+	uint16_t neww;
+	unsigned i;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = 17 * i + 3;
+
+	oldsum = inet_checksum_calc(INET_CHECKSUM_INIT, data, sizeof(data));
+
+	/* Replace the word at offset 6 */
+	oldw = ((uint16_t) data[6] << 8) | data[7];
+	data[6] = 0xab;
+	data[7] = 0xcd;
+	neww = ((uint16_t) data[6] << 8) | data[7];
+
+	newsum = inet_checksum_calc(INET_CHECKSUM_INIT, data, sizeof(data));
+	PCUT_ASSERT_INT_EQUALS(newsum,
+	    inet_checksum_update(oldsum, oldw, neww));
+}
+
+PCUT_EXPORT(checksum);
@@ -37,6 +37,7 @@
 
 #include <async.h>
 #include <io/kbd_event.h>
+#include <time.h>
 
 struct input_ev_ops;
 
@@ -44,6 +45,10 @@ typedef struct {
 	async_sess_t *sess;
 	struct input_ev_ops *ev_ops;
 	void *user;
+	/** Time the event currently being delivered was generated
+	 * (0 when the event arrived outside of a batch)
+	 */
+	usec_t ev_time;
 } input_t;
 
 typedef struct input_ev_ops {
@@ -36,6 +36,7 @@
 #define _LIBINPUT_IPC_INPUT_H_
 
 #include <ipc/common.h>
+#include <time.h>
 
 typedef enum {
 	INPUT_ACTIVATE = IPC_FIRST_USER_METHOD
@@ -48,9 +49,25 @@ typedef enum {
 	INPUT_EVENT_MOVE,
 	INPUT_EVENT_ABS_MOVE,
 	INPUT_EVENT_BUTTON,
-	INPUT_EVENT_DCLICK
+	INPUT_EVENT_DCLICK,
+	INPUT_EVENT_BATCH
 } input_notif_t;
 
+/** One entry of an event batch.
+ *
+ * INPUT_EVENT_BATCH is followed by a data write transferring an array
+ * of these entries. Each entry carries the same arguments as the
+ * corresponding single-event message plus the time it was generated.
+ */
+typedef struct {
+	/** Event type (INPUT_EVENT_KEY .. INPUT_EVENT_DCLICK) */
+	input_notif_t type;
+	/** Uptime when the event was generated in microseconds */
+	usec_t time;
+	/** Event arguments, same meaning as the single-message IPC args */
+	sysarg_t args[5];
+} input_event_t;
+
 #endif
 
 /**
@@ -184,6 +184,80 @@ static void input_ev_dclick(input_t *input, ipc_call_t *call)
 	async_answer_0(call, rc);
 }
 
+static void input_ev_batch(input_t *input, ipc_call_t *call)
+{
+	input_event_t *evs = NULL;
+	size_t size;
+	size_t cnt;
+	size_t i;
+	errno_t rc;
+
+	rc = async_data_write_accept((void **) &evs, false, 0, 0, 0, &size);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return;
+	}
+
+	cnt = size / sizeof(input_event_t);
+	i = 0;
+	while (i < cnt && rc == EOK) {
+		input_event_t *ev = &evs[i];
+
+		input->ev_time = ev->time;
+
+		switch (ev->type) {
+		case INPUT_EVENT_KEY:
+			rc = input->ev_ops->key(input, ev->args[0],
+			    ev->args[1], ev->args[2], ev->args[3],
+			    ev->args[4]);
+			break;
+		case INPUT_EVENT_MOVE: {
+			int dx = (int) ev->args[1];
+			int dy = (int) ev->args[2];
+
+			/*
+			 * Coalesce consecutive moves of the same device.
+			 * The deltas simply add up and the consumer need
+			 * not process (e.g. repaint for) each of them.
+			 */
+			while (i + 1 < cnt &&
+			    evs[i + 1].type == INPUT_EVENT_MOVE &&
+			    evs[i + 1].args[0] == ev->args[0]) {
+				++i;
+				dx += (int) evs[i].args[1];
+				dy += (int) evs[i].args[2];
+				input->ev_time = evs[i].time;
+			}
+
+			rc = input->ev_ops->move(input, ev->args[0], dx, dy);
+			break;
+		}
+		case INPUT_EVENT_ABS_MOVE:
+			rc = input->ev_ops->abs_move(input, ev->args[0],
+			    ev->args[1], ev->args[2], ev->args[3],
+			    ev->args[4]);
+			break;
+		case INPUT_EVENT_BUTTON:
+			rc = input->ev_ops->button(input, ev->args[0],
+			    ev->args[1], ev->args[2]);
+			break;
+		case INPUT_EVENT_DCLICK:
+			rc = input->ev_ops->dclick(input, ev->args[0],
+			    ev->args[1]);
+			break;
+		default:
+			rc = ENOTSUP;
+			break;
+		}
+
+		++i;
+	}
+
+	input->ev_time = 0;
+	free(evs);
+	async_answer_0(call, rc);
+}
+
 static void input_cb_conn(ipc_call_t *icall, void *arg)
 {
 	input_t *input = (input_t *) arg;
@@ -219,6 +293,9 @@ static void input_cb_conn(ipc_call_t *icall, void *arg)
 		case INPUT_EVENT_DCLICK:
 			input_ev_dclick(input, &call);
 			break;
+		case INPUT_EVENT_BATCH:
+			input_ev_batch(input, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
@@ -260,8 +260,14 @@ static void gc_bitmap_create_doutput_srv(ipc_gc_srv_t *srvgc, ipc_call_t *icall)
 		return;
 	}
 
+	/*
+	 * Do not insist on a cacheable mapping. The kernel propagates
+	 * cacheability from the source area automatically, which allows
+	 * the backing GC to hand out device memory (e.g. the actual
+	 * framebuffer).
+	 */
 	rc = async_share_in_finalize(&call, alloc.pixels, AS_AREA_READ |
-	    AS_AREA_WRITE | AS_AREA_CACHEABLE);
+	    AS_AREA_WRITE);
 	if (rc != EOK) {
 		gfx_bitmap_destroy(bitmap);
 		async_answer_0(icall, EIO);
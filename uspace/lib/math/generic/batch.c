@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libmath
+ * @{
+ */
+/** @file Batch evaluation of trigonometric functions.
+ *
+ * Fast-path sine and cosine kernels for workloads that evaluate whole
+ * arrays of arguments. Unlike the generic code in trig.c, which divides
+ * by a table of factorials on every iteration, the polynomials here use
+ * precomputed reciprocal-factorial coefficients and are evaluated with
+ * Horner's scheme, so the inner loop consists of multiply-add operations
+ * only. Range reduction likewise avoids division: the argument is
+ * multiplied by 2/pi, rounded to the nearest integer and the multiple of
+ * pi/2 is subtracted using a two-constant (Cody-Waite) representation.
+ *
+ * The batch entry points are plain loops over the scalar kernel so the
+ * compiler is free to vectorize them (SSE2 on amd64).
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Arguments at least this large in magnitude (and non-finite values)
+ * take the slow path through sin()/cos(). The limit keeps the reduced
+ * multiple of pi/2 below 2^20 so that its product with the 33-bit
+ * PIO2_HI constant is still exact.
+ */
+#define BATCH_REDUCE_LIMIT  1.0e6
+
+/** High part of pi/2 (33 significant bits, exact product with small n) */
+#define PIO2_HI  1.57079632673412561417e+00
+/** Low part of pi/2 (pi/2 - PIO2_HI rounded to double) */
+#define PIO2_LO  6.07710050650619224932e-11
+
+/*
+ * Taylor coefficients of sin(r) / r in r^2, precomputed as
+ * reciprocal factorials. Degree 15 keeps the truncation error
+ * below 1e-16 on [-pi/4, pi/4].
+ */
+static const double sin_c3 = -1.6666666666666666e-01;   /* -1/3! */
+static const double sin_c5 = 8.3333333333333333e-03;    /*  1/5! */
+static const double sin_c7 = -1.9841269841269841e-04;   /* -1/7! */
+static const double sin_c9 = 2.7557319223985893e-06;    /*  1/9! */
+static const double sin_c11 = -2.5052108385441719e-08;  /* -1/11! */
+static const double sin_c13 = 1.6059043836821615e-10;   /*  1/13! */
+static const double sin_c15 = -7.6471637318198165e-13;  /* -1/15! */
+
+/*
+ * Taylor coefficients of cos(r) in r^2, precomputed as reciprocal
+ * factorials. Degree 16 for the same error bound as above.
+ */
+static const double cos_c2 = -5.0000000000000000e-01;   /* -1/2! */
+static const double cos_c4 = 4.1666666666666667e-02;    /*  1/4! */
+static const double cos_c6 = -1.3888888888888889e-03;   /* -1/6! */
+static const double cos_c8 = 2.4801587301587302e-05;    /*  1/8! */
+static const double cos_c10 = -2.7557319223985888e-07;  /* -1/10! */
+static const double cos_c12 = 2.0876756987868099e-09;   /*  1/12! */
+static const double cos_c14 = -1.1470745597729725e-11;  /* -1/14! */
+static const double cos_c16 = 4.7794773323873853e-14;   /*  1/16! */
+
+/** Sine polynomial on [-pi/4, pi/4] (Horner evaluation) */
+static inline double poly_sin(double r, double r2)
+{
+	double p;
+
+	p = sin_c13 + r2 * sin_c15;
+	p = sin_c11 + r2 * p;
+	p = sin_c9 + r2 * p;
+	p = sin_c7 + r2 * p;
+	p = sin_c5 + r2 * p;
+	p = sin_c3 + r2 * p;
+
+	return r + r * r2 * p;
+}
+
+/** Cosine polynomial on [-pi/4, pi/4] (Horner evaluation) */
+static inline double poly_cos(double r2)
+{
+	double p;
+
+	p = cos_c14 + r2 * cos_c16;
+	p = cos_c12 + r2 * p;
+	p = cos_c10 + r2 * p;
+	p = cos_c8 + r2 * p;
+	p = cos_c6 + r2 * p;
+	p = cos_c4 + r2 * p;
+	p = cos_c2 + r2 * p;
+
+	return 1.0 + r2 * p;
+}
+
+/** Fast sine and cosine of a moderately sized argument
+ *
+ * Reduce @a arg by the nearest multiple of pi/2 and evaluate both
+ * polynomials on the remainder. The quadrant index selects which of
+ * the two values (and which sign) corresponds to sine and cosine.
+ *
+ * @param arg Argument, |arg| < BATCH_REDUCE_LIMIT
+ * @param s   Place to store sine value
+ * @param c   Place to store cosine value
+ */
+static inline void sincos_kernel(double arg, double *s, double *c)
+{
+	double k;
+	int64_t n;
+	double r;
+	double r2;
+	double ps;
+	double pc;
+
+	/* arg = k * pi/2 + r, |r| <= pi/4, without nearbyint() or fmod() */
+	k = arg * M_2_PI;
+	k = (double)(int64_t)(k >= 0 ? k + 0.5 : k - 0.5);
+	n = (int64_t)k;
+
+	r = (arg - k * PIO2_HI) - k * PIO2_LO;
+	r2 = r * r;
+
+	ps = poly_sin(r, r2);
+	pc = poly_cos(r2);
+
+	*s = (n & 1) ? pc : ps;
+	*c = (n & 1) ? -ps : pc;
+
+	if (n & 2) {
+		*s = -*s;
+		*c = -*c;
+	}
+}
+
+/** Sine of an array of arguments (64-bit floating point)
+ *
+ * Compute dest[i] = sin(src[i]) for each of @a cnt elements.
+ * Non-finite and very large arguments fall back to sin().
+ *
+ * @param src  Array of arguments
+ * @param dest Array to store sine values into (may equal @a src)
+ * @param cnt  Number of elements
+ */
+void math_sin_batch(const double *src, double *dest, size_t cnt)
+{
+	size_t i;
+	double s;
+	double c;
+
+	for (i = 0; i < cnt; i++) {
+		if (fabs(src[i]) < BATCH_REDUCE_LIMIT) {
+			sincos_kernel(src[i], &s, &c);
+			dest[i] = s;
+		} else {
+			dest[i] = sin(src[i]);
+		}
+	}
+}
+
+/** Cosine of an array of arguments (64-bit floating point)
+ *
+ * Compute dest[i] = cos(src[i]) for each of @a cnt elements.
+ * Non-finite and very large arguments fall back to cos().
+ *
+ * @param src  Array of arguments
+ * @param dest Array to store cosine values into (may equal @a src)
+ * @param cnt  Number of elements
+ */
+void math_cos_batch(const double *src, double *dest, size_t cnt)
+{
+	size_t i;
+	double s;
+	double c;
+
+	for (i = 0; i < cnt; i++) {
+		if (fabs(src[i]) < BATCH_REDUCE_LIMIT) {
+			sincos_kernel(src[i], &s, &c);
+			dest[i] = c;
+		} else {
+			dest[i] = cos(src[i]);
+		}
+	}
+}
+
+/** @}
+ */
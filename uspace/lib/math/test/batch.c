@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <math.h>
+#include <pcut/pcut.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(batch);
+
+#define BATCH_CASES 512
+
+/*
+ * The batch kernels use a different range reduction and polynomial than
+ * sin()/cos(), so bit-exact agreement is not expected. Both paths are
+ * accurate to well under this tolerance on the tested range.
+ */
+#define BATCH_TOLERANCE 1.0e-12
+
+/** Batch sine matches scalar sine */
+PCUT_TEST(sin_batch_matches_scalar)
+{
+	double src[BATCH_CASES];
+	double dest[BATCH_CASES];
+	int i;
+
+	/* Cover several periods on both sides of zero. */
+	for (i = 0; i < BATCH_CASES; i++)
+		src[i] = (i - BATCH_CASES / 2) * 0.1;
+
+	math_sin_batch(src, dest, BATCH_CASES);
+
+	for (i = 0; i < BATCH_CASES; i++)
+		PCUT_ASSERT_TRUE(fabs(dest[i] - sin(src[i])) < BATCH_TOLERANCE);
+}
+
+/** Batch cosine matches scalar cosine */
+PCUT_TEST(cos_batch_matches_scalar)
+{
+	double src[BATCH_CASES];
+	double dest[BATCH_CASES];
+	int i;
+
+	for (i = 0; i < BATCH_CASES; i++)
+		src[i] = (i - BATCH_CASES / 2) * 0.1;
+
+	math_cos_batch(src, dest, BATCH_CASES);
+
+	for (i = 0; i < BATCH_CASES; i++)
+		PCUT_ASSERT_TRUE(fabs(dest[i] - cos(src[i])) < BATCH_TOLERANCE);
+}
+
+/** Batch results satisfy the Pythagorean identity */
+PCUT_TEST(batch_identity)
+{
+	double src[BATCH_CASES];
+	double s[BATCH_CASES];
+	double c[BATCH_CASES];
+	double sum;
+	int i;
+
+	for (i = 0; i < BATCH_CASES; i++)
+		src[i] = (i - BATCH_CASES / 2) * 1.37;
+
+	math_sin_batch(src, s, BATCH_CASES);
+	math_cos_batch(src, c, BATCH_CASES);
+
+	for (i = 0; i < BATCH_CASES; i++) {
+		sum = s[i] * s[i] + c[i] * c[i];
+		PCUT_ASSERT_TRUE(fabs(sum - 1.0) < BATCH_TOLERANCE);
+	}
+}
+
+/** Edge cases: empty array, in-place operation, exact zero */
+PCUT_TEST(batch_edge_cases)
+{
+	double buf[4] = { 0.0, M_PI_2, M_PI, -M_PI_2 };
+
+	/* Zero-length call must not touch the buffers. */
+	math_sin_batch(NULL, NULL, 0);
+
+	/* Source and destination may alias. */
+	math_sin_batch(buf, buf, 4);
+
+	PCUT_ASSERT_TRUE(buf[0] == 0.0);
+	PCUT_ASSERT_TRUE(fabs(buf[1] - 1.0) < BATCH_TOLERANCE);
+	PCUT_ASSERT_TRUE(fabs(buf[2]) < BATCH_TOLERANCE);
+	PCUT_ASSERT_TRUE(fabs(buf[3] + 1.0) < BATCH_TOLERANCE);
+}
+
+PCUT_EXPORT(batch);
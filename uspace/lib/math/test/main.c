@@ -31,6 +31,7 @@
 
 PCUT_INIT;
 
+PCUT_IMPORT(batch);
 PCUT_IMPORT(rounding);
 
 PCUT_MAIN();
@@ -43,6 +43,7 @@
 #include <gfx/render.h>
 #include <io/pixel.h>
 #include <io/pixelmap.h>
+#include <mem.h>
 #include <memgfx/memgc.h>
 #include <stdlib.h>
 #include "../private/memgc.h"
@@ -127,7 +128,10 @@ static errno_t mem_gc_fill_rect(void *arg, gfx_rect_t *rect)
 	mem_gc_t *mgc = (mem_gc_t *) arg;
 	gfx_rect_t crect;
 	gfx_coord_t x, y;
+	gfx_coord_t width;
 	pixelmap_t pixelmap;
+	pixel_t *frow;
+	pixel_t *row;
 
 	/* Make sure we have a sorted, clipped rectangle */
 	gfx_rect_clip(rect, &mgc->clip_rect, &crect);
@@ -139,9 +143,19 @@ static errno_t mem_gc_fill_rect(void *arg, gfx_rect_t *rect)
 	pixelmap.height = mgc->rect.p1.y;
 	pixelmap.data = mgc->alloc.pixels;
 
-	for (y = crect.p0.y; y < crect.p1.y; y++) {
-		for (x = crect.p0.x; x < crect.p1.x; x++) {
-			pixelmap_put_pixel(&pixelmap, x, y, mgc->color);
+	width = crect.p1.x - crect.p0.x;
+	if (width > 0 && crect.p1.y > crect.p0.y) {
+		/* Fill the first scanline pixel by pixel */
+		frow = pixelmap_pixel_at(&pixelmap, crect.p0.x, crect.p0.y);
+		assert(frow != NULL);
+		for (x = 0; x < width; x++)
+			frow[x] = mgc->color;
+
+		/* Replicate it into the remaining scanlines */
+		for (y = crect.p0.y + 1; y < crect.p1.y; y++) {
+			row = pixelmap_pixel_at(&pixelmap, crect.p0.x, y);
+			assert(row != NULL);
+			memcpy(row, frow, width * sizeof(pixel_t));
 		}
 	}
 
@@ -382,6 +396,8 @@ static errno_t mem_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	gfx_coord_t x, y;
 	pixelmap_t smap;
 	pixelmap_t dmap;
+	pixel_t *srow;
+	pixel_t *drow;
 	pixel_t pixel;
 
 	if (srect0 != NULL)
@@ -418,36 +434,47 @@ static errno_t mem_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	if ((mbm->flags & bmpf_direct_output) != 0) {
 		/* Nothing to do */
 	} else if ((mbm->flags & bmpf_color_key) == 0) {
-		/* Simple copy */
+		/* Simple copy - whole scanlines at once */
 		for (y = crect.p0.y; y < crect.p1.y; y++) {
-			for (x = crect.p0.x; x < crect.p1.x; x++) {
-				pixel = pixelmap_get_pixel(&smap,
-				    x - mbm->rect.p0.x - offs.x,
-				    y - mbm->rect.p0.y - offs.y);
-				pixelmap_put_pixel(&dmap, x, y, pixel);
-			}
+			srow = pixelmap_pixel_at(&smap,
+			    crect.p0.x - mbm->rect.p0.x - offs.x,
+			    y - mbm->rect.p0.y - offs.y);
+			drow = pixelmap_pixel_at(&dmap, crect.p0.x, y);
+			if (srow == NULL || drow == NULL)
+				continue;
+			memcpy(drow, srow, (crect.p1.x - crect.p0.x) *
+			    sizeof(pixel_t));
 		}
 	} else if ((mbm->flags & bmpf_colorize) == 0) {
 		/* Color key */
 		for (y = crect.p0.y; y < crect.p1.y; y++) {
+			srow = pixelmap_pixel_at(&smap,
+			    crect.p0.x - mbm->rect.p0.x - offs.x,
+			    y - mbm->rect.p0.y - offs.y);
+			drow = pixelmap_pixel_at(&dmap, crect.p0.x, y);
+			if (srow == NULL || drow == NULL)
+				continue;
 			for (x = crect.p0.x; x < crect.p1.x; x++) {
-				pixel = pixelmap_get_pixel(&smap,
-				    x - mbm->rect.p0.x - offs.x,
-				    y - mbm->rect.p0.y - offs.y);
+				pixel = *srow++;
 				if (pixel != mbm->key_color)
-					pixelmap_put_pixel(&dmap, x, y, pixel);
+					*drow = pixel;
+				++drow;
 			}
 		}
 	} else {
 		/* Color key & colorization */
 		for (y = crect.p0.y; y < crect.p1.y; y++) {
+			srow = pixelmap_pixel_at(&smap,
+			    crect.p0.x - mbm->rect.p0.x - offs.x,
+			    y - mbm->rect.p0.y - offs.y);
+			drow = pixelmap_pixel_at(&dmap, crect.p0.x, y);
+			if (srow == NULL || drow == NULL)
+				continue;
 			for (x = crect.p0.x; x < crect.p1.x; x++) {
-				pixel = pixelmap_get_pixel(&smap,
-				    x - mbm->rect.p0.x - offs.x,
-				    y - mbm->rect.p0.y - offs.y);
+				pixel = *srow++;
 				if (pixel != mbm->key_color)
-					pixelmap_put_pixel(&dmap, x, y,
-					    mbm->mgc->color);
+					*drow = mbm->mgc->color;
+				++drow;
 			}
 		}
 	}
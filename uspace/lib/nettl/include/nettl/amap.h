@@ -37,13 +37,17 @@
 #define LIBNETTL_AMAP_H_
 
 #include <adt/list.h>
+#include <fibril_synch.h>
 #include <inet/endpoint.h>
 #include <nettl/portrng.h>
 #include <loc.h>
 
+/** Number of repla hash buckets */
+#define AMAP_REPLA_BUCKETS 64
+
 /** Port range for (remote endpoint, local address) */
 typedef struct {
-	/** Link to amap_t.repla */
+	/** Link to repla hash bucket */
 	link_t lamap;
 	/** Remote endpoint */
 	inet_ep_t rep;
@@ -73,16 +77,26 @@ typedef struct {
 	portrng_t *portrng;
 } amap_llink_t;
 
+/** Repla hash bucket */
+typedef struct {
+	/** Entries hashed to this bucket */
+	list_t entries; /* of amap_repla_t */
+	/** Lock protecting the bucket */
+	fibril_mutex_t lock;
+} amap_repla_bucket_t;
+
 /** Association map */
 typedef struct {
-	/** Remote endpoint, local address */
-	list_t repla; /* of amap_repla_t */
+	/** Remote endpoint, local address (hashed by 4-tuple) */
+	amap_repla_bucket_t repla[AMAP_REPLA_BUCKETS];
 	/** Local addresses */
 	list_t laddr; /* of amap_laddr_t */
 	/** Local links */
 	list_t llink; /* of amap_llink_t */
 	/** Nothing specified (listen on all local addresses) */
 	portrng_t *unspec;
+	/** Lock protecting laddr, llink and unspec */
+	fibril_mutex_t lock;
 } amap_t;
 
 typedef enum {
@@ -74,6 +74,49 @@ static portrng_flags_t aflags_to_pflags(amap_flags_t flags)
 	return pflags;
 }
 
+/** Compute hash of an IP address.
+ *
+ * @param addr Address
+ * @return Hash value
+ */
+static uint32_t amap_addr_hash(inet_addr_t *addr)
+{
+	uint32_t h;
+	size_t i;
+
+	if (addr->version == ip_v6) {
+		h = 0;
+		for (i = 0; i < 16; i++)
+			h = h * 31 + addr->addr6[i];
+		return h;
+	}
+
+	return addr->addr;
+}
+
+/** Get repla hash bucket for given key.
+ *
+ * Hash the (remote endpoint, local address) key. Together with the local
+ * port matched inside the entry's port range this covers the full 4-tuple
+ * identifying a connection.
+ *
+ * @param map Association map
+ * @param rep Remote endpoint
+ * @param la  Local address
+ * @return Hash bucket where the entry belongs
+ */
+static amap_repla_bucket_t *amap_repla_bucket(amap_t *map, inet_ep_t *rep,
+    inet_addr_t *la)
+{
+	uint32_t h;
+
+	h = amap_addr_hash(&rep->addr);
+	h = h * 31 + rep->port;
+	h = h * 31 + amap_addr_hash(la);
+
+	return &map->repla[h % AMAP_REPLA_BUCKETS];
+}
+
 /** Create association map.
  *
  * @param rmap Place to store pointer to new association map
@@ -83,6 +126,7 @@ errno_t amap_create(amap_t **rmap)
 {
 	amap_t *map;
 	errno_t rc;
+	size_t i;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_create()");
 
@@ -97,9 +141,14 @@ errno_t amap_create(amap_t **rmap)
 		return ENOMEM;
 	}
 
-	list_initialize(&map->repla);
+	for (i = 0; i < AMAP_REPLA_BUCKETS; i++) {
+		list_initialize(&map->repla[i].entries);
+		fibril_mutex_initialize(&map->repla[i].lock);
+	}
+
 	list_initialize(&map->laddr);
 	list_initialize(&map->llink);
+	fibril_mutex_initialize(&map->lock);
 
 	*rmap = map;
 	return EOK;
@@ -111,9 +160,13 @@ errno_t amap_create(amap_t **rmap)
  */
 void amap_destroy(amap_t *map)
 {
+	size_t i;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_destroy()");
 
-	assert(list_empty(&map->repla));
+	for (i = 0; i < AMAP_REPLA_BUCKETS; i++)
+		assert(list_empty(&map->repla[i].entries));
+
 	assert(list_empty(&map->laddr));
 	assert(list_empty(&map->llink));
 	free(map);
@@ -122,6 +175,7 @@ void amap_destroy(amap_t *map)
 /** Find exact repla.
  *
  * Find repla (remote endpoint, local address) entry by exact match.
+ * The caller must hold the lock of the bucket the entry hashes to.
  *
  * @param map Association map
  * @param rep Remote endpoint
@@ -133,6 +187,7 @@ void amap_destroy(amap_t *map)
 static errno_t amap_repla_find(amap_t *map, inet_ep_t *rep, inet_addr_t *la,
     amap_repla_t **rrepla)
 {
+	amap_repla_bucket_t *bucket;
 	char *sraddr, *sladdr;
 
 	(void) inet_addr_format(&rep->addr, &sraddr);
@@ -143,7 +198,10 @@ static errno_t amap_repla_find(amap_t *map, inet_ep_t *rep, inet_addr_t *la,
 	free(sraddr);
 	free(sladdr);
 
-	list_foreach(map->repla, lamap, amap_repla_t, repla) {
+	bucket = amap_repla_bucket(map, rep, la);
+	assert(fibril_mutex_is_locked(&bucket->lock));
+
+	list_foreach(bucket->entries, lamap, amap_repla_t, repla) {
 		(void) inet_addr_format(&repla->rep.addr, &sraddr);
 		(void) inet_addr_format(&repla->laddr, &sladdr);
 		log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_repla_find(): "
@@ -166,6 +224,7 @@ static errno_t amap_repla_find(amap_t *map, inet_ep_t *rep, inet_addr_t *la,
 /** Insert repla.
  *
  * Insert new repla (remote endpoint, local address) entry to association map.
+ * The caller must hold the lock of the bucket the entry hashes to.
  *
  * @param amap   Association map
  * @param rep    Remote endpoint
@@ -177,6 +236,7 @@ static errno_t amap_repla_find(amap_t *map, inet_ep_t *rep, inet_addr_t *la,
 static errno_t amap_repla_insert(amap_t *map, inet_ep_t *rep, inet_addr_t *la,
     amap_repla_t **rrepla)
 {
+	amap_repla_bucket_t *bucket;
 	amap_repla_t *repla;
 	errno_t rc;
 
@@ -192,9 +252,12 @@ static errno_t amap_repla_insert(amap_t *map, inet_ep_t *rep, inet_addr_t *la,
 		return ENOMEM;
 	}
 
+	bucket = amap_repla_bucket(map, rep, la);
+	assert(fibril_mutex_is_locked(&bucket->lock));
+
 	repla->rep = *rep;
 	repla->laddr = *la;
-	list_append(&repla->lamap, &map->repla);
+	list_append(&repla->lamap, &bucket->entries);
 
 	*rrepla = repla;
 	return EOK;
@@ -203,6 +266,7 @@ static errno_t amap_repla_insert(amap_t *map, inet_ep_t *rep, inet_addr_t *la,
 /** Remove repla from association map.
  *
  * Remove repla (remote endpoint, local address) from association map.
+ * The caller must hold the lock of the bucket the entry hashes to.
  *
  * @param map   Association map
  * @param repla Repla
@@ -374,12 +438,16 @@ static void amap_llink_remove(amap_t *map, amap_llink_t *llink)
 static errno_t amap_insert_repla(amap_t *map, inet_ep2_t *epp, void *arg,
     amap_flags_t flags, inet_ep2_t *aepp)
 {
+	amap_repla_bucket_t *bucket;
 	amap_repla_t *repla;
 	inet_ep2_t mepp;
 	errno_t rc;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_insert_repla()");
 
+	bucket = amap_repla_bucket(map, &epp->remote, &epp->local.addr);
+	fibril_mutex_lock(&bucket->lock);
+
 	rc = amap_repla_find(map, &epp->remote, &epp->local.addr, &repla);
 	if (rc != EOK) {
 		/* New repla */
@@ -387,6 +455,7 @@ static errno_t amap_insert_repla(amap_t *map, inet_ep2_t *epp, void *arg,
 		    &repla);
 		if (rc != EOK) {
 			assert(rc == ENOMEM);
+			fibril_mutex_unlock(&bucket->lock);
 			return rc;
 		}
 	}
@@ -396,9 +465,12 @@ static errno_t amap_insert_repla(amap_t *map, inet_ep2_t *epp, void *arg,
 	rc = portrng_alloc(repla->portrng, epp->local.port, arg, aflags_to_pflags(flags),
 	    &mepp.local.port);
 	if (rc != EOK) {
+		fibril_mutex_unlock(&bucket->lock);
 		return rc;
 	}
 
+	fibril_mutex_unlock(&bucket->lock);
+
 	*aepp = mepp;
 	return EOK;
 }
@@ -425,12 +497,15 @@ static errno_t amap_insert_laddr(amap_t *map, inet_ep2_t *epp, void *arg,
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_insert_laddr()");
 
+	fibril_mutex_lock(&map->lock);
+
 	rc = amap_laddr_find(map, &epp->local.addr, &laddr);
 	if (rc != EOK) {
 		/* New laddr */
 		rc = amap_laddr_insert(map, &epp->local.addr, &laddr);
 		if (rc != EOK) {
 			assert(rc == ENOMEM);
+			fibril_mutex_unlock(&map->lock);
 			return rc;
 		}
 	}
@@ -440,9 +515,12 @@ static errno_t amap_insert_laddr(amap_t *map, inet_ep2_t *epp, void *arg,
 	rc = portrng_alloc(laddr->portrng, epp->local.port, arg, aflags_to_pflags(flags),
 	    &mepp.local.port);
 	if (rc != EOK) {
+		fibril_mutex_unlock(&map->lock);
 		return rc;
 	}
 
+	fibril_mutex_unlock(&map->lock);
+
 	*aepp = mepp;
 	return EOK;
 }
@@ -469,12 +547,15 @@ static errno_t amap_insert_llink(amap_t *map, inet_ep2_t *epp, void *arg,
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_insert_llink()");
 
+	fibril_mutex_lock(&map->lock);
+
 	rc = amap_llink_find(map, epp->local_link, &llink);
 	if (rc != EOK) {
 		/* New llink */
 		rc = amap_llink_insert(map, epp->local_link, &llink);
 		if (rc != EOK) {
 			assert(rc == ENOMEM);
+			fibril_mutex_unlock(&map->lock);
 			return rc;
 		}
 	}
@@ -484,9 +565,12 @@ static errno_t amap_insert_llink(amap_t *map, inet_ep2_t *epp, void *arg,
 	rc = portrng_alloc(llink->portrng, epp->local.port, arg, aflags_to_pflags(flags),
 	    &mepp.local.port);
 	if (rc != EOK) {
+		fibril_mutex_unlock(&map->lock);
 		return rc;
 	}
 
+	fibril_mutex_unlock(&map->lock);
+
 	*aepp = mepp;
 	return EOK;
 }
@@ -513,12 +597,17 @@ static errno_t amap_insert_unspec(amap_t *map, inet_ep2_t *epp, void *arg,
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_insert_unspec()");
 	mepp = *epp;
 
+	fibril_mutex_lock(&map->lock);
+
 	rc = portrng_alloc(map->unspec, epp->local.port, arg, aflags_to_pflags(flags),
 	    &mepp.local.port);
 	if (rc != EOK) {
+		fibril_mutex_unlock(&map->lock);
 		return rc;
 	}
 
+	fibril_mutex_unlock(&map->lock);
+
 	*aepp = mepp;
 	return EOK;
 }
@@ -597,12 +686,17 @@ errno_t amap_insert(amap_t *map, inet_ep2_t *epp, void *arg, amap_flags_t flags,
  */
 static void amap_remove_repla(amap_t *map, inet_ep2_t *epp)
 {
+	amap_repla_bucket_t *bucket;
 	amap_repla_t *repla;
 	errno_t rc;
 
+	bucket = amap_repla_bucket(map, &epp->remote, &epp->local.addr);
+	fibril_mutex_lock(&bucket->lock);
+
 	rc = amap_repla_find(map, &epp->remote, &epp->local.addr, &repla);
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_remove_repla: not found");
+		fibril_mutex_unlock(&bucket->lock);
 		return;
 	}
 
@@ -610,6 +704,8 @@ static void amap_remove_repla(amap_t *map, inet_ep2_t *epp)
 
 	if (portrng_empty(repla->portrng))
 		amap_repla_remove(map, repla);
+
+	fibril_mutex_unlock(&bucket->lock);
 }
 
 /** Remove endpoint pair using laddr as key from map.
@@ -625,9 +721,12 @@ static void amap_remove_laddr(amap_t *map, inet_ep2_t *epp)
 	amap_laddr_t *laddr;
 	errno_t rc;
 
+	fibril_mutex_lock(&map->lock);
+
 	rc = amap_laddr_find(map, &epp->local.addr, &laddr);
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_remove_laddr: not found");
+		fibril_mutex_unlock(&map->lock);
 		return;
 	}
 
@@ -635,6 +734,8 @@ static void amap_remove_laddr(amap_t *map, inet_ep2_t *epp)
 
 	if (portrng_empty(laddr->portrng))
 		amap_laddr_remove(map, laddr);
+
+	fibril_mutex_unlock(&map->lock);
 }
 
 /** Remove endpoint pair using llink as key from map.
@@ -650,9 +751,12 @@ static void amap_remove_llink(amap_t *map, inet_ep2_t *epp)
 	amap_llink_t *llink;
 	errno_t rc;
 
+	fibril_mutex_lock(&map->lock);
+
 	rc = amap_llink_find(map, epp->local_link, &llink);
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_remove_llink: not found");
+		fibril_mutex_unlock(&map->lock);
 		return;
 	}
 
@@ -660,6 +764,8 @@ static void amap_remove_llink(amap_t *map, inet_ep2_t *epp)
 
 	if (portrng_empty(llink->portrng))
 		amap_llink_remove(map, llink);
+
+	fibril_mutex_unlock(&map->lock);
 }
 
 /** Remove endpoint pair using unspec as key from map.
@@ -672,7 +778,9 @@ static void amap_remove_llink(amap_t *map, inet_ep2_t *epp)
  */
 static void amap_remove_unspec(amap_t *map, inet_ep2_t *epp)
 {
+	fibril_mutex_lock(&map->lock);
 	portrng_free_port(map->unspec, epp->local.port);
+	fibril_mutex_unlock(&map->lock);
 }
 
 /** Remove endpoint pair from map.
@@ -723,6 +831,7 @@ void amap_remove(amap_t *map, inet_ep2_t *epp)
 errno_t amap_find_match(amap_t *map, inet_ep2_t *epp, void **rarg)
 {
 	errno_t rc;
+	amap_repla_bucket_t *bucket;
 	amap_repla_t *repla;
 	amap_laddr_t *laddr;
 	amap_llink_t *llink;
@@ -731,6 +840,9 @@ errno_t amap_find_match(amap_t *map, inet_ep2_t *epp, void **rarg)
 	    epp->local_link);
 
 	/* Remode endpoint, local address */
+	bucket = amap_repla_bucket(map, &epp->remote, &epp->local.addr);
+	fibril_mutex_lock(&bucket->lock);
+
 	rc = amap_repla_find(map, &epp->remote, &epp->local.addr, &repla);
 	if (rc == EOK) {
 		rc = portrng_find_port(repla->portrng, epp->local.port,
@@ -738,10 +850,14 @@ errno_t amap_find_match(amap_t *map, inet_ep2_t *epp, void **rarg)
 		if (rc == EOK) {
 			log_msg(LOG_DEFAULT, LVL_DEBUG2, "Matched repla / "
 			    "port %" PRIu16, epp->local.port);
+			fibril_mutex_unlock(&bucket->lock);
 			return EOK;
 		}
 	}
 
+	fibril_mutex_unlock(&bucket->lock);
+	fibril_mutex_lock(&map->lock);
+
 	/* Local address */
 	rc = amap_laddr_find(map, &epp->local.addr, &laddr);
 	if (rc == EOK) {
@@ -750,6 +866,7 @@ errno_t amap_find_match(amap_t *map, inet_ep2_t *epp, void **rarg)
 		if (rc == EOK) {
 			log_msg(LOG_DEFAULT, LVL_DEBUG2, "Matched laddr / "
 			    "port %" PRIu16, epp->local.port);
+			fibril_mutex_unlock(&map->lock);
 			return EOK;
 		}
 	}
@@ -762,6 +879,7 @@ errno_t amap_find_match(amap_t *map, inet_ep2_t *epp, void **rarg)
 		if (rc == EOK) {
 			log_msg(LOG_DEFAULT, LVL_DEBUG2, "Matched llink / "
 			    "port %" PRIu16, epp->local.port);
+			fibril_mutex_unlock(&map->lock);
 			return EOK;
 		}
 	}
@@ -771,9 +889,12 @@ errno_t amap_find_match(amap_t *map, inet_ep2_t *epp, void **rarg)
 	if (rc == EOK) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG2, "Matched unspec / port %" PRIu16,
 		    epp->local.port);
+		fibril_mutex_unlock(&map->lock);
 		return EOK;
 	}
 
+	fibril_mutex_unlock(&map->lock);
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "No match.");
 	return ENOENT;
 }
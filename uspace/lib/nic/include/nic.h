@@ -68,6 +68,8 @@ typedef struct {
 	link_t link;
 	void *data;
 	size_t size;
+	/** Allocated capacity of @c data */
+	size_t buffer_size;
 } nic_frame_t;
 
 typedef list_t nic_frame_list_t;
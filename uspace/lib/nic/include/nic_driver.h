@@ -89,6 +89,16 @@ struct nic {
 	struct timespec default_poll_period;
 	/** Software period fibrill information */
 	struct sw_poll_info sw_poll_info;
+	/** Received frames waiting for delivery to the client */
+	list_t rx_queue;
+	/** Number of frames in rx_queue */
+	size_t rx_queue_size;
+	/** Fibril delivering frames from rx_queue (0 until the first frame) */
+	fid_t rx_fibril;
+	/** Lock protecting rx_queue */
+	fibril_mutex_t rx_queue_lock;
+	/** Signalled when a frame is appended to rx_queue */
+	fibril_condvar_t rx_queue_cv;
 	/**
 	 * Lock on everything but statistics, rx control and wol virtues. This lock
 	 * cannot be used if filters_lock or stats_lock is already held - you must
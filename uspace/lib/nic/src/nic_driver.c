@@ -53,6 +53,20 @@
 
 #define NIC_GLOBALS_MAX_CACHE_SIZE 16
 
+/** Maximum number of recycled frames kept with their data buffers */
+#define NIC_GLOBALS_MAX_FRAME_CACHE_SIZE 128
+
+/** Buffer capacity of recycled frames
+ *
+ * Covers a standard Ethernet frame including a VLAN tag. Larger frames
+ * are allocated exactly and not recycled.
+ *
+ */
+#define NIC_FRAME_BUF_SIZE 2048
+
+/** Maximum number of received frames queued for delivery to the client */
+#define NIC_RX_QUEUE_MAX 64
+
 nic_globals_t nic_globals;
 
 /**
@@ -256,6 +270,10 @@ errno_t nic_get_resources(nic_t *nic_data, hw_res_list_parsed_t *resources)
 }
 
 /** Allocate frame
+ *
+ * Frames of up to NIC_FRAME_BUF_SIZE bytes are served from a cache of
+ * recycled frames which keep their data buffers, so the common receive
+ * path does not allocate at all.
  *
  *  @param nic_data 	The NIC driver data
  *  @param size	        Frame size in bytes
@@ -265,22 +283,28 @@ nic_frame_t *nic_alloc_frame(nic_t *nic_data, size_t size)
 {
 	nic_frame_t *frame;
 	fibril_mutex_lock(&nic_globals.lock);
-	if (nic_globals.frame_cache_size > 0) {
+	if (size <= NIC_FRAME_BUF_SIZE && nic_globals.frame_cache_size > 0) {
 		link_t *first = list_first(&nic_globals.frame_cache);
 		list_remove(first);
 		nic_globals.frame_cache_size--;
 		frame = list_get_instance(first, nic_frame_t, link);
 		fibril_mutex_unlock(&nic_globals.lock);
-	} else {
-		fibril_mutex_unlock(&nic_globals.lock);
-		frame = malloc(sizeof(nic_frame_t));
-		if (!frame)
-			return NULL;
 
-		link_initialize(&frame->link);
+		frame->size = size;
+		return frame;
 	}
 
-	frame->data = malloc(size);
+	fibril_mutex_unlock(&nic_globals.lock);
+
+	frame = malloc(sizeof(nic_frame_t));
+	if (!frame)
+		return NULL;
+
+	link_initialize(&frame->link);
+
+	frame->buffer_size = (size < NIC_FRAME_BUF_SIZE) ?
+	    NIC_FRAME_BUF_SIZE : size;
+	frame->data = malloc(frame->buffer_size);
 	if (frame->data == NULL) {
 		free(frame);
 		return NULL;
@@ -291,6 +315,9 @@ nic_frame_t *nic_alloc_frame(nic_t *nic_data, size_t size)
 }
 
 /** Release frame
+ *
+ * Frames with the standard buffer capacity are recycled together with
+ * their data buffers.
  *
  * @param nic_data	The driver data
  * @param frame		The frame to release
@@ -300,21 +327,26 @@ void nic_release_frame(nic_t *nic_data, nic_frame_t *frame)
 	if (!frame)
 		return;
 
+	if (frame->data != NULL && frame->buffer_size == NIC_FRAME_BUF_SIZE) {
+		fibril_mutex_lock(&nic_globals.lock);
+		if (nic_globals.frame_cache_size <
+		    NIC_GLOBALS_MAX_FRAME_CACHE_SIZE) {
+			list_prepend(&frame->link, &nic_globals.frame_cache);
+			nic_globals.frame_cache_size++;
+			fibril_mutex_unlock(&nic_globals.lock);
+			return;
+		}
+
+		fibril_mutex_unlock(&nic_globals.lock);
+	}
+
 	if (frame->data != NULL) {
 		free(frame->data);
 		frame->data = NULL;
 		frame->size = 0;
 	}
 
-	fibril_mutex_lock(&nic_globals.lock);
-	if (nic_globals.frame_cache_size >= NIC_GLOBALS_MAX_CACHE_SIZE) {
-		fibril_mutex_unlock(&nic_globals.lock);
-		free(frame);
-	} else {
-		list_prepend(&frame->link, &nic_globals.frame_cache);
-		nic_globals.frame_cache_size++;
-		fibril_mutex_unlock(&nic_globals.lock);
-	}
+	free(frame);
 }
 
 /**
@@ -508,19 +540,15 @@ void nic_set_tx_busy(nic_t *nic_data, int busy)
 }
 
 /**
- * This is the function that the driver should call when it receives a frame.
- * The frame is checked by filters and then sent up to the NIL layer or
- * discarded. The frame is released.
+ * Checks the frame by filters, sends it up to the NIL layer or discards it
+ * and releases it. Runs on the delivery fibril, off the fibril that services
+ * the device.
  *
  * @param nic_data
  * @param frame		The received frame
  */
-void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
+static void nic_deliver_frame(nic_t *nic_data, nic_frame_t *frame)
 {
-	/*
-	 * Note: this function must not lock main lock, because loopback driver
-	 * 		 calls it inside send_frame handler (with locked main lock)
-	 */
 	fibril_rwlock_read_lock(&nic_data->rxc_lock);
 	nic_frame_type_t frame_type;
 	bool check = nic_rxc_check(&nic_data->rx_control, frame->data,
@@ -562,6 +590,83 @@ void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
 	nic_release_frame(nic_data, frame);
 }
 
+/** Fibril delivering queued received frames to the client.
+ *
+ * Dequeues frames from the NIC's receive queue and passes them through the
+ * filters up to the NIL layer. Keeping the delivery off the fibril that
+ * services the device allows the driver to continue draining its buffers
+ * while the client processes earlier frames.
+ *
+ * @param arg	The nic_t structure
+ *
+ * @return This function never returns
+ */
+static errno_t nic_rx_fibril(void *arg)
+{
+	nic_t *nic_data = (nic_t *) arg;
+
+	while (true) {
+		fibril_mutex_lock(&nic_data->rx_queue_lock);
+		while (list_empty(&nic_data->rx_queue)) {
+			fibril_condvar_wait(&nic_data->rx_queue_cv,
+			    &nic_data->rx_queue_lock);
+		}
+		nic_frame_t *frame = list_get_instance(
+		    list_first(&nic_data->rx_queue), nic_frame_t, link);
+		list_remove(&frame->link);
+		nic_data->rx_queue_size--;
+		fibril_mutex_unlock(&nic_data->rx_queue_lock);
+
+		nic_deliver_frame(nic_data, frame);
+	}
+
+	return EOK;
+}
+
+/**
+ * This is the function that the driver should call when it receives a frame.
+ * The frame is queued for the delivery fibril which checks it by filters and
+ * then sends it up to the NIL layer or discards it. The frame is released.
+ *
+ * @param nic_data
+ * @param frame		The received frame
+ */
+void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
+{
+	/*
+	 * Note: this function must not lock main lock, because loopback driver
+	 * 		 calls it inside send_frame handler (with locked main lock)
+	 */
+	fibril_mutex_lock(&nic_data->rx_queue_lock);
+
+	/* Create the delivery fibril upon the first received frame */
+	if (nic_data->rx_fibril == 0) {
+		nic_data->rx_fibril = fibril_create(nic_rx_fibril, nic_data);
+		if (nic_data->rx_fibril != 0)
+			fibril_add_ready(nic_data->rx_fibril);
+	}
+
+	if (nic_data->rx_fibril == 0) {
+		/* No delivery fibril, deliver synchronously as a fallback */
+		fibril_mutex_unlock(&nic_data->rx_queue_lock);
+		nic_deliver_frame(nic_data, frame);
+		return;
+	}
+
+	if (nic_data->rx_queue_size >= NIC_RX_QUEUE_MAX) {
+		/* The client does not keep up, drop rather than stall RX */
+		fibril_mutex_unlock(&nic_data->rx_queue_lock);
+		nic_report_receive_error(nic_data, NIC_REC_BUFFER_OVERFLOW, 1);
+		nic_release_frame(nic_data, frame);
+		return;
+	}
+
+	list_append(&frame->link, &nic_data->rx_queue);
+	nic_data->rx_queue_size++;
+	fibril_condvar_signal(&nic_data->rx_queue_cv);
+	fibril_mutex_unlock(&nic_data->rx_queue_lock);
+}
+
 /**
  * Some NICs can receive multiple frames during single interrupt. These can
  * send them in whole list of frames (actually nic_frame_t structures), then
@@ -617,6 +722,12 @@ static nic_t *nic_create(ddf_dev_t *dev)
 	nic_data->on_stopping = NULL;
 	nic_data->specific = NULL;
 
+	list_initialize(&nic_data->rx_queue);
+	nic_data->rx_queue_size = 0;
+	nic_data->rx_fibril = 0;
+	fibril_mutex_initialize(&nic_data->rx_queue_lock);
+	fibril_condvar_initialize(&nic_data->rx_queue_cv);
+
 	fibril_rwlock_initialize(&nic_data->main_lock);
 	fibril_rwlock_initialize(&nic_data->stats_lock);
 	fibril_rwlock_initialize(&nic_data->rxc_lock);
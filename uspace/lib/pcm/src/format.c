@@ -264,6 +264,177 @@ do { \
 #undef LOOP_ADD
 }
 
+/**
+ * Mix audio data into a buffer of normalized float samples.
+ * @param dst Destination buffer of frames * dst_channels float samples.
+ * @param src Source audio buffer.
+ * @param src_size Size of the source buffer.
+ * @param dst_channels Number of channels in the destination buffer.
+ * @param sf Pointer to the source format descriptor.
+ * @return Error code.
+ *
+ * Samples are added to the accumulator without saturation; the whole
+ * block is converted at once so the inner loop is free of per-sample
+ * dispatch and can be vectorized. Use pcm_format_from_float() to
+ * saturate and store the final mix.
+ */
+errno_t pcm_format_mix_float(float *dst, const void *src, size_t src_size,
+    unsigned dst_channels, const pcm_format_t *sf)
+{
+	if (!dst || !src || !sf)
+		return EINVAL;
+	const size_t src_frame_size = pcm_format_frame_size(sf);
+	if ((src_size % src_frame_size) != 0)
+		return EINVAL;
+
+	const size_t frames = src_size / src_frame_size;
+	const unsigned channels = sf->channels < dst_channels ?
+	    sf->channels : dst_channels;
+
+#define LOOP_MIX(type, endian, low, high) \
+do { \
+	const type *src_buf = src; \
+	const float mul = 2.0f / ((float)(type)high - (float)(type)low); \
+	for (size_t i = 0; i < frames; ++i) { \
+		for (unsigned j = 0; j < channels; ++j) { \
+			const float s = \
+			    from(src_buf[i * sf->channels + j], type, endian); \
+			dst[i * dst_channels + j] += \
+			    (s - (float)(type)low) * mul - 1.0f; \
+		} \
+	} \
+} while (0)
+
+	switch (sf->sample_format) {
+	case PCM_SAMPLE_UINT8:
+		LOOP_MIX(uint8_t, le, UINT8_MIN, UINT8_MAX);
+		break;
+	case PCM_SAMPLE_SINT8:
+		LOOP_MIX(int8_t, le, INT8_MIN, INT8_MAX);
+		break;
+	case PCM_SAMPLE_UINT16_LE:
+		LOOP_MIX(uint16_t, le, UINT16_MIN, UINT16_MAX);
+		break;
+	case PCM_SAMPLE_SINT16_LE:
+		LOOP_MIX(int16_t, le, INT16_MIN, INT16_MAX);
+		break;
+	case PCM_SAMPLE_UINT16_BE:
+		LOOP_MIX(uint16_t, be, UINT16_MIN, UINT16_MAX);
+		break;
+	case PCM_SAMPLE_SINT16_BE:
+		LOOP_MIX(int16_t, be, INT16_MIN, INT16_MAX);
+		break;
+	case PCM_SAMPLE_UINT24_32_LE:
+	case PCM_SAMPLE_UINT32_LE:
+		LOOP_MIX(uint32_t, le, UINT32_MIN, UINT32_MAX);
+		break;
+	case PCM_SAMPLE_SINT24_32_LE:
+	case PCM_SAMPLE_SINT32_LE:
+		LOOP_MIX(int32_t, le, INT32_MIN, INT32_MAX);
+		break;
+	case PCM_SAMPLE_UINT24_32_BE:
+	case PCM_SAMPLE_UINT32_BE:
+		LOOP_MIX(uint32_t, be, UINT32_MIN, UINT32_MAX);
+		break;
+	case PCM_SAMPLE_SINT24_32_BE:
+	case PCM_SAMPLE_SINT32_BE:
+		LOOP_MIX(int32_t, be, INT32_MIN, INT32_MAX);
+		break;
+	case PCM_SAMPLE_UINT24_LE:
+	case PCM_SAMPLE_SINT24_LE:
+	case PCM_SAMPLE_UINT24_BE:
+	case PCM_SAMPLE_SINT24_BE:
+	case PCM_SAMPLE_FLOAT32:
+	default:
+		return ENOTSUP;
+	}
+	return EOK;
+#undef LOOP_MIX
+}
+
+/**
+ * Saturate normalized float samples and store them in the given format.
+ * @param dst Destination audio buffer.
+ * @param dst_size Size of the destination buffer.
+ * @param src Source buffer of normalized float samples.
+ * @param df Pointer to the destination format descriptor.
+ * @return Error code.
+ *
+ * Counterpart of pcm_format_mix_float(); samples outside <-1,1> are
+ * clamped to the full scale of the destination format.
+ */
+errno_t pcm_format_from_float(void *dst, size_t dst_size, const float *src,
+    const pcm_format_t *df)
+{
+	if (!dst || !src || !df)
+		return EINVAL;
+	const size_t dst_frame_size = pcm_format_frame_size(df);
+	if ((dst_size % dst_frame_size) != 0)
+		return EINVAL;
+
+#define LOOP_STORE(type, endian, low, high) \
+do { \
+	type *dst_buf = dst; \
+	const float mul = ((float)(type)high - (float)(type)low) / 2.0f; \
+	const size_t sample_count = dst_size / sizeof(type); \
+	for (size_t i = 0; i < sample_count; ++i) { \
+		float c = src[i]; \
+		if (c < -1.0f) \
+			c = -1.0f; \
+		if (c > 1.0f) \
+			c = 1.0f; \
+		c = (c + 1.0f) * mul + (float)(type)low; \
+		dst_buf[i] = to((type)c, type, endian); \
+	} \
+} while (0)
+
+	switch (df->sample_format) {
+	case PCM_SAMPLE_UINT8:
+		LOOP_STORE(uint8_t, le, UINT8_MIN, UINT8_MAX);
+		break;
+	case PCM_SAMPLE_SINT8:
+		LOOP_STORE(int8_t, le, INT8_MIN, INT8_MAX);
+		break;
+	case PCM_SAMPLE_UINT16_LE:
+		LOOP_STORE(uint16_t, le, UINT16_MIN, UINT16_MAX);
+		break;
+	case PCM_SAMPLE_SINT16_LE:
+		LOOP_STORE(int16_t, le, INT16_MIN, INT16_MAX);
+		break;
+	case PCM_SAMPLE_UINT16_BE:
+		LOOP_STORE(uint16_t, be, UINT16_MIN, UINT16_MAX);
+		break;
+	case PCM_SAMPLE_SINT16_BE:
+		LOOP_STORE(int16_t, be, INT16_MIN, INT16_MAX);
+		break;
+	case PCM_SAMPLE_UINT24_32_LE:
+	case PCM_SAMPLE_UINT32_LE:
+		LOOP_STORE(uint32_t, le, UINT32_MIN, UINT32_MAX);
+		break;
+	case PCM_SAMPLE_SINT24_32_LE:
+	case PCM_SAMPLE_SINT32_LE:
+		LOOP_STORE(int32_t, le, INT32_MIN, INT32_MAX);
+		break;
+	case PCM_SAMPLE_UINT24_32_BE:
+	case PCM_SAMPLE_UINT32_BE:
+		LOOP_STORE(uint32_t, be, UINT32_MIN, UINT32_MAX);
+		break;
+	case PCM_SAMPLE_SINT24_32_BE:
+	case PCM_SAMPLE_SINT32_BE:
+		LOOP_STORE(int32_t, be, INT32_MIN, INT32_MAX);
+		break;
+	case PCM_SAMPLE_UINT24_LE:
+	case PCM_SAMPLE_SINT24_LE:
+	case PCM_SAMPLE_UINT24_BE:
+	case PCM_SAMPLE_SINT24_BE:
+	case PCM_SAMPLE_FLOAT32:
+	default:
+		return ENOTSUP;
+	}
+	return EOK;
+#undef LOOP_STORE
+}
+
 /**
  * Converts all sample formats to float <-1,1>
  * @param buffer Audio data
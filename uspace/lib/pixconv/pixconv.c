@@ -41,6 +41,7 @@
  */
 
 #include <byteorder.h>
+#include <stddef.h>
 #include "pixconv.h"
 
 void pixel2argb_8888(void *dst, pixel_t pix)
@@ -144,6 +145,146 @@ void pixel2gray_8(void *dst, pixel_t pix)
 	*((uint8_t *) dst) = (red + green + blue) >> 24;
 }
 
+/*
+ * Row variants convert a whole run of pixels at once. The per-pixel
+ * conversions above are inlined into a tight loop and the destination
+ * pointer is advanced by the format's pixel size, so blitting code can
+ * pick the conversion once per blit instead of calling through a
+ * function pointer for every pixel.
+ */
+
+void pixel2argb_8888_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint32_t *dp = (uint32_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2argb_8888(dp++, *src++);
+}
+
+void pixel2abgr_8888_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint32_t *dp = (uint32_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2abgr_8888(dp++, *src++);
+}
+
+void pixel2rgba_8888_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint32_t *dp = (uint32_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2rgba_8888(dp++, *src++);
+}
+
+void pixel2bgra_8888_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint32_t *dp = (uint32_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2bgra_8888(dp++, *src++);
+}
+
+void pixel2rgb_0888_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint32_t *dp = (uint32_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2rgb_0888(dp++, *src++);
+}
+
+void pixel2bgr_0888_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint32_t *dp = (uint32_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2bgr_0888(dp++, *src++);
+}
+
+void pixel2rgb_8880_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint32_t *dp = (uint32_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2rgb_8880(dp++, *src++);
+}
+
+void pixel2bgr_8880_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint32_t *dp = (uint32_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2bgr_8880(dp++, *src++);
+}
+
+void pixel2rgb_888_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint8_t *dp = (uint8_t *) dst;
+
+	while (cnt-- > 0) {
+		pixel2rgb_888(dp, *src++);
+		dp += 3;
+	}
+}
+
+void pixel2bgr_888_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint8_t *dp = (uint8_t *) dst;
+
+	while (cnt-- > 0) {
+		pixel2bgr_888(dp, *src++);
+		dp += 3;
+	}
+}
+
+void pixel2rgb_555_be_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint16_t *dp = (uint16_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2rgb_555_be(dp++, *src++);
+}
+
+void pixel2rgb_555_le_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint16_t *dp = (uint16_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2rgb_555_le(dp++, *src++);
+}
+
+void pixel2rgb_565_be_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint16_t *dp = (uint16_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2rgb_565_be(dp++, *src++);
+}
+
+void pixel2rgb_565_le_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint16_t *dp = (uint16_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2rgb_565_le(dp++, *src++);
+}
+
+void pixel2bgr_323_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint8_t *dp = (uint8_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2bgr_323(dp++, *src++);
+}
+
+void pixel2gray_8_row(void *dst, const pixel_t *src, size_t cnt)
+{
+	uint8_t *dp = (uint8_t *) dst;
+
+	while (cnt-- > 0)
+		pixel2gray_8(dp++, *src++);
+}
+
 void visual_mask_8888(void *dst, bool mask)
 {
 	pixel2abgr_8888(dst, mask ? 0xffffffff : 0);
@@ -39,6 +39,7 @@
 
 #include <adt/list.h>
 #include <adt/odict.h>
+#include <stdbool.h>
 #include <stdio.h>
 
 /** SIF session */
@@ -47,6 +48,8 @@ struct sif_sess {
 	FILE *f;
 	/** Repository file name */
 	char *fname;
+	/** Number of journal entries following the base image */
+	size_t journal_ops;
 	/** Root node */
 	struct sif_node *root;
 };
@@ -54,8 +57,26 @@ struct sif_sess {
 /** SIF transaction */
 struct sif_trans {
 	struct sif_sess *sess;
+	/** Operations recorded in this transaction (of sif_op_t) */
+	list_t ops;
+	/** Failed to record an operation */
+	bool failed;
 };
 
+/** SIF journal operation */
+typedef struct {
+	/** Link to @c trans->ops */
+	link_t lops;
+	/** Operation code */
+	int opc;
+	/** Path of the affected node (decimal child indices, '/'-separated) */
+	char *path;
+	/** Node type or attribute name (or @c NULL) */
+	char *arg1;
+	/** Attribute value (or @c NULL) */
+	char *arg2;
+} sif_op_t;
+
 /** SIF attribute */
 typedef struct {
 	/** Node to which this attribute belongs */
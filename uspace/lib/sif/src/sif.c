@@ -68,8 +68,36 @@
 #include "../include/sif.h"
 #include "../private/sif.h"
 
+/** Journal operation codes */
+enum {
+	/** Prepend child */
+	sif_op_prepend = 'p',
+	/** Append child */
+	sif_op_append = 'a',
+	/** Insert before sibling */
+	sif_op_before = 'b',
+	/** Insert after sibling */
+	sif_op_after = 'f',
+	/** Destroy node */
+	sif_op_destroy = 'd',
+	/** Set attribute */
+	sif_op_set_attr = 's',
+	/** Unset attribute */
+	sif_op_unset_attr = 'u'
+};
+
+/** Compact the repository once this many journal entries accumulate */
+enum {
+	sif_journal_limit = 256
+};
+
 static errno_t sif_export_node(sif_node_t *, FILE *);
 static errno_t sif_import_node(sif_node_t *, FILE *, sif_node_t **);
+static errno_t sif_export_op(sif_op_t *, FILE *);
+static errno_t sif_import_op(sif_node_t *, FILE *);
+static errno_t sif_trans_record(sif_trans_t *, int, sif_node_t *,
+    const char *, const char *);
+static void sif_op_delete(sif_op_t *);
 static sif_attr_t *sif_node_first_attr(sif_node_t *);
 static sif_attr_t *sif_node_next_attr(sif_attr_t *);
 static void sif_attr_delete(sif_attr_t *);
@@ -277,6 +305,33 @@ errno_t sif_open(const char *fname, sif_sess_t **rsess)
 		goto error;
 	}
 
+	/* Replay journal entries appended after the base image. */
+	while (true) {
+		int c = fgetc(f);
+		if (c == EOF)
+			break;
+
+		if (c == '\n')
+			continue;
+
+		if (c != '!') {
+			rc = EIO;
+			goto error;
+		}
+
+		rc = sif_import_op(root, f);
+		if (rc != EOK) {
+			/*
+			 * An incomplete trailing entry (e.g. after a crash
+			 * in mid-append) is discarded. It will be dropped
+			 * for good by the next compaction.
+			 */
+			break;
+		}
+
+		++sess->journal_ops;
+	}
+
 	sess->root = root;
 
 	sess->f = f;
@@ -396,10 +451,29 @@ errno_t sif_trans_begin(sif_sess_t *sess, sif_trans_t **rtrans)
 		return ENOMEM;
 
 	trans->sess = sess;
+	list_initialize(&trans->ops);
 	*rtrans = trans;
 	return EOK;
 }
 
+/** Free transaction and any recorded operations.
+ *
+ * @param trans Transaction
+ */
+static void sif_trans_destroy(sif_trans_t *trans)
+{
+	link_t *link;
+	sif_op_t *op;
+
+	while ((link = list_first(&trans->ops)) != NULL) {
+		op = list_get_instance(link, sif_op_t, lops);
+		list_remove(link);
+		sif_op_delete(op);
+	}
+
+	free(trans);
+}
+
 /** Commit SIF transaction.
  *
  * Commit and free the transaction. If an error is returned, that means
@@ -410,25 +484,50 @@ errno_t sif_trans_begin(sif_sess_t *sess, sif_trans_t **rtrans)
  */
 errno_t sif_trans_end(sif_trans_t *trans)
 {
+	sif_sess_t *sess = trans->sess;
 	errno_t rc;
 
-	(void) fclose(trans->sess->f);
+	if (trans->failed)
+		return ENOMEM;
 
-	trans->sess->f = fopen(trans->sess->fname, "w");
-	if (trans->sess->f == NULL)
-		return EIO;
+	if (list_empty(&trans->ops) || sess->journal_ops +
+	    list_count(&trans->ops) > sif_journal_limit) {
+		/* Compact: rewrite the entire repository. */
+		(void) fclose(sess->f);
 
-	rc = sif_export_node(trans->sess->root, trans->sess->f);
-	if (rc != EOK)
-		return rc;
+		sess->f = fopen(sess->fname, "w");
+		if (sess->f == NULL)
+			return EIO;
 
-	if (fputc('\n', trans->sess->f) == EOF)
-		return EIO;
+		rc = sif_export_node(sess->root, sess->f);
+		if (rc != EOK)
+			return rc;
+
+		if (fputc('\n', sess->f) == EOF)
+			return EIO;
+
+		sess->journal_ops = 0;
+	} else {
+		/* Append the transaction to the journal. */
+		(void) fclose(sess->f);
+
+		sess->f = fopen(sess->fname, "a");
+		if (sess->f == NULL)
+			return EIO;
+
+		list_foreach(trans->ops, lops, sif_op_t, op) {
+			rc = sif_export_op(op, sess->f);
+			if (rc != EOK)
+				return rc;
+		}
 
-	if (fflush(trans->sess->f) == EOF)
+		sess->journal_ops += list_count(&trans->ops);
+	}
+
+	if (fflush(sess->f) == EOF)
 		return EIO;
 
-	free(trans);
+	sif_trans_destroy(trans);
 	return EOK;
 }
 
@@ -438,7 +537,7 @@ errno_t sif_trans_end(sif_trans_t *trans)
  */
 void sif_trans_abort(sif_trans_t *trans)
 {
-	free(trans);
+	sif_trans_destroy(trans);
 }
 
 /** Prepend new child.
@@ -457,6 +556,7 @@ errno_t sif_node_prepend_child(sif_trans_t *trans, sif_node_t *parent,
     const char *ctype, sif_node_t **rchild)
 {
 	sif_node_t *child;
+	errno_t rc;
 
 	child = sif_node_new(parent);
 	if (child == NULL)
@@ -468,6 +568,15 @@ errno_t sif_node_prepend_child(sif_trans_t *trans, sif_node_t *parent,
 		return ENOMEM;
 	}
 
+	if (trans != NULL) {
+		rc = sif_trans_record(trans, sif_op_prepend, parent, ctype,
+		    NULL);
+		if (rc != EOK) {
+			sif_node_delete(child);
+			return rc;
+		}
+	}
+
 	list_prepend(&child->lparent, &parent->children);
 
 	*rchild = child;
@@ -489,6 +598,7 @@ errno_t sif_node_append_child(sif_trans_t *trans, sif_node_t *parent,
     const char *ctype, sif_node_t **rchild)
 {
 	sif_node_t *child;
+	errno_t rc;
 
 	child = sif_node_new(parent);
 	if (child == NULL)
@@ -500,6 +610,15 @@ errno_t sif_node_append_child(sif_trans_t *trans, sif_node_t *parent,
 		return ENOMEM;
 	}
 
+	if (trans != NULL) {
+		rc = sif_trans_record(trans, sif_op_append, parent, ctype,
+		    NULL);
+		if (rc != EOK) {
+			sif_node_delete(child);
+			return rc;
+		}
+	}
+
 	list_append(&child->lparent, &parent->children);
 
 	*rchild = child;
@@ -521,6 +640,7 @@ errno_t sif_node_insert_before(sif_trans_t *trans, sif_node_t *sibling,
     const char *ctype, sif_node_t **rchild)
 {
 	sif_node_t *child;
+	errno_t rc;
 
 	child = sif_node_new(sibling->parent);
 	if (child == NULL)
@@ -532,6 +652,16 @@ errno_t sif_node_insert_before(sif_trans_t *trans, sif_node_t *sibling,
 		return ENOMEM;
 	}
 
+	if (trans != NULL) {
+		/* Record the sibling's path before it shifts. */
+		rc = sif_trans_record(trans, sif_op_before, sibling, ctype,
+		    NULL);
+		if (rc != EOK) {
+			sif_node_delete(child);
+			return rc;
+		}
+	}
+
 	list_insert_before(&child->lparent, &sibling->lparent);
 
 	*rchild = child;
@@ -553,6 +683,7 @@ errno_t sif_node_insert_after(sif_trans_t *trans, sif_node_t *sibling,
     const char *ctype, sif_node_t **rchild)
 {
 	sif_node_t *child;
+	errno_t rc;
 
 	child = sif_node_new(sibling->parent);
 	if (child == NULL)
@@ -564,6 +695,15 @@ errno_t sif_node_insert_after(sif_trans_t *trans, sif_node_t *sibling,
 		return ENOMEM;
 	}
 
+	if (trans != NULL) {
+		rc = sif_trans_record(trans, sif_op_after, sibling, ctype,
+		    NULL);
+		if (rc != EOK) {
+			sif_node_delete(child);
+			return rc;
+		}
+	}
+
 	list_insert_after(&child->lparent, &sibling->lparent);
 
 	*rchild = child;
@@ -580,6 +720,12 @@ errno_t sif_node_insert_after(sif_trans_t *trans, sif_node_t *sibling,
  */
 void sif_node_destroy(sif_trans_t *trans, sif_node_t *node)
 {
+	if (trans != NULL) {
+		if (sif_trans_record(trans, sif_op_destroy, node, NULL,
+		    NULL) != EOK)
+			trans->failed = true;
+	}
+
 	list_remove(&node->lparent);
 	sif_node_delete(node);
 }
@@ -630,6 +776,15 @@ errno_t sif_node_set_attr(sif_trans_t *trans, sif_node_t *node,
 		odict_insert(&attr->lattrs, &node->attrs, NULL);
 	}
 
+	if (trans != NULL) {
+		errno_t rc = sif_trans_record(trans, sif_op_set_attr, node,
+		    aname, avalue);
+		if (rc != EOK) {
+			trans->failed = true;
+			return rc;
+		}
+	}
+
 	return EOK;
 }
 
@@ -655,6 +810,12 @@ void sif_node_unset_attr(sif_trans_t *trans, sif_node_t *node,
 	attr = odict_get_instance(link, sif_attr_t, lattrs);
 	odict_remove(link);
 	sif_attr_delete(attr);
+
+	if (trans != NULL) {
+		if (sif_trans_record(trans, sif_op_unset_attr, node, aname,
+		    NULL) != EOK)
+			trans->failed = true;
+	}
 }
 
 /** Export string to file.
@@ -977,6 +1138,298 @@ error:
 	return rc;
 }
 
+/** Get path of a node.
+ *
+ * The path consists of the indices of the node's ancestors among their
+ * siblings, separated by '/'. The root node has an empty path.
+ *
+ * @param node SIF node
+ * @param rpath Place to store pointer to newly allocated path string
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t sif_node_get_path(sif_node_t *node, char **rpath)
+{
+	char *ppath;
+	char *path;
+	unsigned idx;
+	link_t *link;
+	errno_t rc;
+	int rv;
+
+	if (node->parent == NULL) {
+		*rpath = str_dup("");
+		return (*rpath != NULL) ? EOK : ENOMEM;
+	}
+
+	rc = sif_node_get_path(node->parent, &ppath);
+	if (rc != EOK)
+		return rc;
+
+	/* Determine index of node among its siblings */
+	idx = 0;
+	link = list_first(&node->parent->children);
+	while (link != &node->lparent) {
+		assert(link != NULL);
+		link = list_next(link, &node->parent->children);
+		++idx;
+	}
+
+	if (str_size(ppath) > 0)
+		rv = asprintf(&path, "%s/%u", ppath, idx);
+	else
+		rv = asprintf(&path, "%u", idx);
+
+	free(ppath);
+	if (rv < 0)
+		return ENOMEM;
+
+	*rpath = path;
+	return EOK;
+}
+
+/** Find node by path.
+ *
+ * @param root Root node
+ * @param path Node path as produced by sif_node_get_path()
+ * @param rnode Place to store pointer to found node
+ * @return EOK on success, EIO if the path does not match a node
+ */
+static errno_t sif_node_by_path(sif_node_t *root, const char *path,
+    sif_node_t **rnode)
+{
+	sif_node_t *node = root;
+	const char *p = path;
+	char *ep;
+	unsigned long idx;
+
+	while (*p != '\0') {
+		idx = strtoul(p, &ep, 10);
+		if (ep == p)
+			return EIO;
+
+		node = sif_node_first_child(node);
+		while (node != NULL && idx > 0) {
+			node = sif_node_next_child(node);
+			--idx;
+		}
+
+		if (node == NULL)
+			return EIO;
+
+		if (*ep == '/')
+			++ep;
+		else if (*ep != '\0')
+			return EIO;
+
+		p = ep;
+	}
+
+	*rnode = node;
+	return EOK;
+}
+
+/** Record operation into transaction.
+ *
+ * @param trans Transaction
+ * @param opc Operation code
+ * @param node Affected node (or its parent/sibling for child creation)
+ * @param arg1 Node type or attribute name (or @c NULL)
+ * @param arg2 Attribute value (or @c NULL)
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t sif_trans_record(sif_trans_t *trans, int opc, sif_node_t *node,
+    const char *arg1, const char *arg2)
+{
+	sif_op_t *op;
+	errno_t rc;
+
+	op = calloc(1, sizeof(sif_op_t));
+	if (op == NULL)
+		return ENOMEM;
+
+	op->opc = opc;
+
+	rc = sif_node_get_path(node, &op->path);
+	if (rc != EOK) {
+		free(op);
+		return rc;
+	}
+
+	if (arg1 != NULL) {
+		op->arg1 = str_dup(arg1);
+		if (op->arg1 == NULL) {
+			sif_op_delete(op);
+			return ENOMEM;
+		}
+	}
+
+	if (arg2 != NULL) {
+		op->arg2 = str_dup(arg2);
+		if (op->arg2 == NULL) {
+			sif_op_delete(op);
+			return ENOMEM;
+		}
+	}
+
+	list_append(&op->lops, &trans->ops);
+	return EOK;
+}
+
+/** Delete journal operation.
+ *
+ * @param op Operation
+ */
+static void sif_op_delete(sif_op_t *op)
+{
+	if (op == NULL)
+		return;
+
+	if (op->path != NULL)
+		free(op->path);
+	if (op->arg1 != NULL)
+		free(op->arg1);
+	if (op->arg2 != NULL)
+		free(op->arg2);
+
+	free(op);
+}
+
+/** Export journal operation to file.
+ *
+ * @param op Operation
+ * @param f File
+ * @return EOK on success, EIO on I/O error
+ */
+static errno_t sif_export_op(sif_op_t *op, FILE *f)
+{
+	errno_t rc;
+
+	if (fputc('!', f) == EOF)
+		return EIO;
+
+	if (fputc(op->opc, f) == EOF)
+		return EIO;
+
+	rc = sif_export_string(op->path, f);
+	if (rc != EOK)
+		return rc;
+
+	if (op->arg1 != NULL) {
+		rc = sif_export_string(op->arg1, f);
+		if (rc != EOK)
+			return rc;
+	}
+
+	if (op->arg2 != NULL) {
+		rc = sif_export_string(op->arg2, f);
+		if (rc != EOK)
+			return rc;
+	}
+
+	if (fputc('\n', f) == EOF)
+		return EIO;
+
+	return EOK;
+}
+
+/** Import journal operation from file and replay it.
+ *
+ * @param root Root node
+ * @param f File
+ * @return EOK on success, EIO if the entry is malformed or truncated
+ */
+static errno_t sif_import_op(sif_node_t *root, FILE *f)
+{
+	errno_t rc;
+	int opc;
+	char *path = NULL;
+	char *arg1 = NULL;
+	char *arg2 = NULL;
+	sif_node_t *node;
+	sif_node_t *child;
+
+	opc = fgetc(f);
+	if (opc == EOF)
+		return EIO;
+
+	rc = sif_import_string(f, &path);
+	if (rc != EOK)
+		goto error;
+
+	rc = sif_node_by_path(root, path, &node);
+	if (rc != EOK)
+		goto error;
+
+	switch (opc) {
+	case sif_op_prepend:
+	case sif_op_append:
+	case sif_op_before:
+	case sif_op_after:
+		rc = sif_import_string(f, &arg1);
+		if (rc != EOK)
+			goto error;
+
+		if (opc == sif_op_prepend)
+			rc = sif_node_prepend_child(NULL, node, arg1, &child);
+		else if (opc == sif_op_append)
+			rc = sif_node_append_child(NULL, node, arg1, &child);
+		else if (opc == sif_op_before)
+			rc = sif_node_insert_before(NULL, node, arg1, &child);
+		else
+			rc = sif_node_insert_after(NULL, node, arg1, &child);
+		break;
+	case sif_op_destroy:
+		if (node == root) {
+			rc = EIO;
+			goto error;
+		}
+
+		sif_node_destroy(NULL, node);
+		rc = EOK;
+		break;
+	case sif_op_set_attr:
+		rc = sif_import_string(f, &arg1);
+		if (rc != EOK)
+			goto error;
+
+		rc = sif_import_string(f, &arg2);
+		if (rc != EOK)
+			goto error;
+
+		rc = sif_node_set_attr(NULL, node, arg1, arg2);
+		break;
+	case sif_op_unset_attr:
+		rc = sif_import_string(f, &arg1);
+		if (rc != EOK)
+			goto error;
+
+		sif_node_unset_attr(NULL, node, arg1);
+		rc = EOK;
+		break;
+	default:
+		rc = EIO;
+		break;
+	}
+
+	if (rc != EOK)
+		goto error;
+
+	free(path);
+	if (arg1 != NULL)
+		free(arg1);
+	if (arg2 != NULL)
+		free(arg2);
+	return EOK;
+error:
+	if (path != NULL)
+		free(path);
+	if (arg1 != NULL)
+		free(arg1);
+	if (arg2 != NULL)
+		free(arg2);
+	return rc;
+}
+
 /** Get first attribute or a node.
  *
  * @param node SIF node
@@ -601,4 +601,103 @@ PCUT_TEST(sif_persist)
 	PCUT_ASSERT_INT_EQUALS(0, rv);
 }
 
+/** Test replay of journaled transactions on open. */
+PCUT_TEST(sif_journal_replay)
+{
+	sif_sess_t *sess;
+	sif_node_t *root;
+	sif_node_t *ca;
+	sif_node_t *cb;
+	sif_node_t *cc;
+	sif_node_t *node;
+	sif_trans_t *trans;
+	errno_t rc;
+	int rv;
+	char *fname;
+	char *p;
+	const char *aval;
+
+	fname = calloc(L_tmpnam, 1);
+	PCUT_ASSERT_NOT_NULL(fname);
+
+	p = tmpnam(fname);
+	PCUT_ASSERT_TRUE(p == fname);
+
+	rc = sif_create(fname, &sess);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	root = sif_get_root(sess);
+
+	rc = sif_trans_begin(sess, &trans);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = sif_node_append_child(trans, root, "a", &ca);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = sif_node_append_child(trans, root, "c", &cc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = sif_trans_end(trans);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	/* Each of these transactions is appended to the journal. */
+
+	rc = sif_trans_begin(sess, &trans);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = sif_node_insert_before(trans, cc, "b", &cb);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = sif_node_set_attr(trans, cb, "x", "1");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = sif_node_set_attr(trans, cb, "y", "2");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = sif_trans_end(trans);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = sif_trans_begin(sess, &trans);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	sif_node_destroy(trans, ca);
+	sif_node_unset_attr(trans, cb, "y");
+
+	rc = sif_trans_end(trans);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = sif_close(sess);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	/* Now reopen the repository and verify the replayed state */
+
+	rc = sif_open(fname, &sess);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	root = sif_get_root(sess);
+
+	node = sif_node_first_child(root);
+	PCUT_ASSERT_NOT_NULL(node);
+	PCUT_ASSERT_INT_EQUALS(0, str_cmp(sif_node_get_type(node), "b"));
+
+	aval = sif_node_get_attr(node, "x");
+	PCUT_ASSERT_INT_EQUALS(0, str_cmp(aval, "1"));
+
+	aval = sif_node_get_attr(node, "y");
+	PCUT_ASSERT_NULL((void *) aval); // XXX PCUT_ASSERT_NULL does not accept const pointer
+
+	node = sif_node_next_child(node);
+	PCUT_ASSERT_NOT_NULL(node);
+	PCUT_ASSERT_INT_EQUALS(0, str_cmp(sif_node_get_type(node), "c"));
+
+	node = sif_node_next_child(node);
+	PCUT_ASSERT_TRUE(node == NULL);
+
+	rc = sif_close(sess);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rv = remove(fname);
+	PCUT_ASSERT_INT_EQUALS(0, rv);
+}
+
 PCUT_EXPORT(sif);
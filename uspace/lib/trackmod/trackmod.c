@@ -45,7 +45,9 @@
 
 /** Tunables */
 enum {
-	amp_factor = 16
+	amp_factor = 16,
+	/** Number of frames mixed per block */
+	mix_block_frames = 256
 };
 
 /** Standard definitions set in stone */
@@ -807,14 +809,20 @@ errno_t trackmod_modplay_create(trackmod_module_t *module,
 	if (modplay->chan == NULL)
 		goto error;
 
+	modplay->mix_buf = calloc(mix_block_frames, sizeof(int32_t));
+	if (modplay->mix_buf == NULL)
+		goto error;
+
 	trackmod_process_tick(modplay);
 	trackmod_process_row(modplay);
 
 	*rmodplay = modplay;
 	return EOK;
 error:
-	if (modplay != NULL)
+	if (modplay != NULL) {
+		free(modplay->mix_buf);
 		free(modplay->chan);
+	}
 	free(modplay);
 	return ENOMEM;
 }
@@ -825,6 +833,7 @@ error:
  */
 void trackmod_modplay_destroy(trackmod_modplay_t *modplay)
 {
+	free(modplay->mix_buf);
 	free(modplay->chan);
 	free(modplay);
 }
@@ -901,48 +910,79 @@ static void chan_smp_next_frame(trackmod_chan_t *chan)
 	}
 }
 
-/** Render next sample on channel.
+/** Render a block of samples on one channel into the mixing buffer.
+ *
+ * Volume, period and interpolation constants only change at tick
+ * boundaries and a block never spans a tick, so they are hoisted out
+ * of the inner loop. The division by the period is replaced with a
+ * multiplication by its precomputed fixed-point reciprocal, leaving
+ * only multiply-add operations in the loop.
  *
  * @param modplay Module playback
  * @param cidx    Channel number
- * @return        Sample value
+ * @param mbuf    Mixing buffer
+ * @param nframes Number of frames to render
  */
-static int trackmod_chan_next_sample(trackmod_modplay_t *modplay,
-    size_t cidx)
+static void trackmod_chan_mix_block(trackmod_modplay_t *modplay, size_t cidx,
+    int32_t *mbuf, size_t nframes)
 {
-	int sl, sn;
-	int period, clk;
-	int s;
-
 	trackmod_chan_t *chan = &modplay->chan[cidx];
+	uint64_t recip;
+	size_t step;
+	unsigned period;
+	int gain;
+	int sl, sn;
+	int32_t frac;
+	size_t i;
 
 	if (chan->sample == NULL || chan->period == 0)
-		return 0;
+		return;
+
+	step = base_clock / modplay->smp_freq;
+	period = chan->period;
+	gain = amp_factor * chan->volume;
+
+	/* 32.32 fixed-point reciprocal of the period */
+	recip = ((uint64_t)1 << 32) / period;
 
 	/*
 	 * Linear interpolation. Note this is slightly simplified:
 	 * We ignore the half-sample offset and the boundary condition
 	 * at the end of the sample (we should extend with zero).
 	 */
-	sl = (int)chan->lsmp * amp_factor * chan->volume / vol_max;
+	sl = (int)chan->lsmp * gain / vol_max;
 	sn = (int)trackmod_sample_get_frame(chan->sample, chan->smp_pos) *
-	    amp_factor * chan->volume / vol_max;
-
-	period = (int)chan->period;
-	clk = (int)chan->smp_clk;
-
-	s = (sl * (period - clk) + sn * clk) / period;
-
-	chan->smp_clk += base_clock / modplay->smp_freq;
-	while (chan->sample != NULL && chan->smp_clk >= chan->period) {
-		chan->smp_clk -= chan->period;
-		chan_smp_next_frame(chan);
+	    gain / vol_max;
+
+	for (i = 0; i < nframes; i++) {
+		/*
+		 * Fractional position within the current source frame
+		 * in 16.16 fixed point (smp_clk * 2^16 / period to
+		 * within one LSB).
+		 */
+		frac = (int32_t)(((uint64_t)chan->smp_clk * recip) >> 16);
+		mbuf[i] += sl + (((sn - sl) * frac) >> 16);
+
+		chan->smp_clk += step;
+		while (chan->smp_clk >= period) {
+			chan->smp_clk -= period;
+			chan_smp_next_frame(chan);
+			if (chan->sample == NULL) {
+				/* End of sample, rest of block is silent. */
+				return;
+			}
+
+			sl = (int)chan->lsmp * gain / vol_max;
+			sn = (int)trackmod_sample_get_frame(chan->sample,
+			    chan->smp_pos) * gain / vol_max;
+		}
 	}
-
-	return s;
 }
 
 /** Render a segment of samples contained entirely within a tick.
+ *
+ * Channels are rendered a block at a time into the mixing buffer,
+ * which is then converted to the output sample format.
  *
  * @param modplay Module playback
  * @param buffer  Buffer for storing audio data
@@ -952,22 +992,32 @@ static void get_samples_within_tick(trackmod_modplay_t *modplay,
     void *buffer, size_t bufsize)
 {
 	size_t nsamples;
+	size_t now;
 	size_t smpidx;
 	size_t chan;
-	int s;
+	int16_t *bp;
 
 	nsamples = bufsize / modplay->frame_size;
+	bp = (int16_t *)buffer;
+
+	while (nsamples > 0) {
+		now = min(nsamples, (size_t)mix_block_frames);
+
+		for (smpidx = 0; smpidx < now; smpidx++)
+			modplay->mix_buf[smpidx] = 0;
 
-	for (smpidx = 0; smpidx < nsamples; smpidx++) {
-		s = 0;
 		for (chan = 0; chan < modplay->module->channels; chan++) {
-			s += trackmod_chan_next_sample(modplay, chan);
+			trackmod_chan_mix_block(modplay, chan,
+			    modplay->mix_buf, now);
 		}
 
-		((int16_t *)buffer)[smpidx] = s;
-	}
+		for (smpidx = 0; smpidx < now; smpidx++)
+			bp[smpidx] = modplay->mix_buf[smpidx];
 
-	modplay->smp += nsamples;
+		bp += now;
+		modplay->smp += now;
+		nsamples -= now;
+	}
 }
 
 /** Render a segment of samples.
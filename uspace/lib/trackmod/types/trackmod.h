@@ -179,6 +179,8 @@ typedef struct {
 
 	/** Channel playback state */
 	trackmod_chan_t *chan;
+	/** Mixing buffer (@c mix_block_frames frames) */
+	int32_t *mix_buf;
 
 	/** BPM (beats per minute) */
 	unsigned bpm;
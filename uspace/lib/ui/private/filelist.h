@@ -36,6 +36,7 @@
 #ifndef _UI_PRIVATE_FILELIST_H
 #define _UI_PRIVATE_FILELIST_H
 
+#include <fibril_synch.h>
 #include <gfx/color.h>
 #include <ipc/loc.h>
 #include <ui/list.h>
@@ -69,6 +70,8 @@ struct ui_file_list_entry {
 	bool isdir;
 	/** Service number for service special entries */
 	service_id_t svc;
+	/** @c true iff the entry could not be stated (stale entry) */
+	bool stale;
 };
 
 /** File list.
@@ -99,6 +102,22 @@ typedef struct ui_file_list {
 
 	/** Directory */
 	char *dir;
+
+	/** Sorted index of entries (valid while reading a directory) */
+	struct ui_file_list_entry **index;
+	/** Number of entries in @c index */
+	size_t index_cnt;
+	/** Number of allocated slots in @c index */
+	size_t index_cap;
+
+	/** Protects @c stat_busy and @c stat_cancel */
+	fibril_mutex_t stat_lock;
+	/** Signaled when the background stat fibril stops */
+	fibril_condvar_t stat_cv;
+	/** Background stat fibril is running */
+	bool stat_busy;
+	/** Ask the background stat fibril to stop */
+	bool stat_cancel;
 } ui_file_list_t;
 
 extern bool ui_file_list_is_active(ui_file_list_t *);
@@ -89,6 +89,8 @@ struct ui_window {
 	gfx_context_t *app_gc;
 	/** Dirty rectangle */
 	gfx_rect_t dirty_rect;
+	/** Nesting level of update batches (updates deferred when > 0) */
+	unsigned update_level;
 	/** UI resource. Ideally this would be in ui_t. */
 	struct ui_resource *res;
 	/** Window decoration */
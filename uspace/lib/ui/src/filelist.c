@@ -36,6 +36,8 @@
 
 #include <dirent.h>
 #include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
 #include <stdlib.h>
 #include <str.h>
 #include <ui/control.h>
@@ -47,6 +49,14 @@
 #include "../private/filelist.h"
 #include "../private/list.h"
 #include "../private/resource.h"
+#include "../private/ui.h"
+
+enum {
+	/** Number of entries statted in one batch by the stat fibril */
+	fl_stat_batch = 64,
+	/** Repaint period while streaming in directory entries */
+	fl_stream_paint_period = 64
+};
 
 static void ui_file_list_ctl_destroy(void *);
 static errno_t ui_file_list_ctl_paint(void *);
@@ -63,6 +73,10 @@ ui_control_ops_t ui_file_list_ctl_ops = {
 
 static void ui_file_list_list_activate_req(ui_list_t *, void *);
 static void ui_file_list_list_selected(ui_list_entry_t *, void *);
+static int ui_file_list_entry_cmp(ui_file_list_entry_t *,
+    ui_file_list_entry_t *);
+static errno_t ui_file_list_stat_fibril(void *);
+static void ui_file_list_stat_halt(ui_file_list_t *);
 
 /** List callbacks */
 ui_list_cb_t ui_file_list_list_cb = {
@@ -107,6 +121,9 @@ errno_t ui_file_list_create(ui_window_t *window, bool active,
 
 	ui_list_set_cb(flist->list, &ui_file_list_list_cb, (void *)flist);
 
+	fibril_mutex_initialize(&flist->stat_lock);
+	fibril_condvar_initialize(&flist->stat_cv);
+
 	flist->window = window;
 	*rflist = flist;
 	return EOK;
@@ -211,13 +228,17 @@ void ui_file_list_entry_attr_init(ui_file_list_entry_attr_t *attr)
 	memset(attr, 0, sizeof(*attr));
 }
 
-/** Append new file list entry.
+/** Insert new file list entry before an existing entry.
  *
  * @param flist File list
  * @param attr Entry attributes
+ * @param enext Entry to insert before or @c NULL to append at the end
+ * @param rentry Place to store pointer to new entry or @c NULL
  * @return EOK on success or an error code
  */
-errno_t ui_file_list_entry_append(ui_file_list_t *flist, ui_file_list_entry_attr_t *attr)
+static errno_t ui_file_list_entry_insert(ui_file_list_t *flist,
+    ui_file_list_entry_attr_t *attr, ui_file_list_entry_t *enext,
+    ui_file_list_entry_t **rentry)
 {
 	ui_file_list_entry_t *entry;
 	ui_list_entry_attr_t lattr;
@@ -273,7 +294,8 @@ errno_t ui_file_list_entry_append(ui_file_list_t *flist, ui_file_list_entry_attr
 		}
 	}
 
-	rc = ui_list_entry_append(flist->list, &lattr, &lentry);
+	rc = ui_list_entry_insert_before(flist->list, &lattr,
+	    enext != NULL ? enext->entry : NULL, &lentry);
 	if (rc != EOK) {
 		free(caption);
 		free(entry->name);
@@ -283,6 +305,76 @@ errno_t ui_file_list_entry_append(ui_file_list_t *flist, ui_file_list_entry_attr
 
 	free(caption);
 	entry->entry = lentry;
+	if (rentry != NULL)
+		*rentry = entry;
+	return EOK;
+}
+
+/** Append new file list entry.
+ *
+ * @param flist File list
+ * @param attr Entry attributes
+ * @return EOK on success or an error code
+ */
+errno_t ui_file_list_entry_append(ui_file_list_t *flist, ui_file_list_entry_attr_t *attr)
+{
+	return ui_file_list_entry_insert(flist, attr, NULL, NULL);
+}
+
+/** Insert new file list entry at its sorted position.
+ *
+ * Looks up the insert position in the sorted entry index by binary
+ * search, inserts the entry there and updates the index. This keeps
+ * the entry list sorted while streaming in a directory without ever
+ * re-sorting the whole list.
+ *
+ * @param flist File list
+ * @param attr Entry attributes
+ * @return EOK on success or an error code
+ */
+static errno_t ui_file_list_sorted_insert(ui_file_list_t *flist,
+    ui_file_list_entry_attr_t *attr)
+{
+	ui_file_list_entry_t key;
+	ui_file_list_entry_t *entry;
+	ui_file_list_entry_t **nindex;
+	size_t ncap;
+	size_t b, e, m;
+	errno_t rc;
+
+	key.name = (char *)attr->name;
+	key.isdir = attr->isdir;
+
+	/* Find the first index entry that compares greater than the key */
+	b = 0;
+	e = flist->index_cnt;
+	while (b < e) {
+		m = b + (e - b) / 2;
+		if (ui_file_list_entry_cmp(flist->index[m], &key) <= 0)
+			b = m + 1;
+		else
+			e = m;
+	}
+
+	if (flist->index_cnt >= flist->index_cap) {
+		ncap = flist->index_cap != 0 ? 2 * flist->index_cap : 64;
+		nindex = realloc(flist->index, ncap * sizeof(*nindex));
+		if (nindex == NULL)
+			return ENOMEM;
+
+		flist->index = nindex;
+		flist->index_cap = ncap;
+	}
+
+	rc = ui_file_list_entry_insert(flist, attr,
+	    b < flist->index_cnt ? flist->index[b] : NULL, &entry);
+	if (rc != EOK)
+		return rc;
+
+	memmove(&flist->index[b + 1], &flist->index[b],
+	    (flist->index_cnt - b) * sizeof(*flist->index));
+	flist->index[b] = entry;
+	++flist->index_cnt;
 	return EOK;
 }
 
@@ -305,6 +397,9 @@ void ui_file_list_clear_entries(ui_file_list_t *flist)
 {
 	ui_file_list_entry_t *entry;
 
+	/* Make sure the stat fibril no longer references the entries */
+	ui_file_list_stat_halt(flist);
+
 	entry = ui_file_list_first(flist);
 	while (entry != NULL) {
 		ui_file_list_entry_destroy(entry);
@@ -313,6 +408,13 @@ void ui_file_list_clear_entries(ui_file_list_t *flist)
 }
 
 /** Read directory into file list entry list.
+ *
+ * The entries are inserted at their sorted positions and painted
+ * periodically as they stream in, so a large directory becomes visible
+ * long before it has been read completely. Only the file names are
+ * collected here; stat information (size, type) is filled in by a
+ * background fibril, which repaints the list as it makes progress.
+ * Use @c ui_file_list_stat_wait() to wait for complete entries.
  *
  * @param flist File list
  * @param dirname Directory path
@@ -322,15 +424,18 @@ errno_t ui_file_list_read_dir(ui_file_list_t *flist, const char *dirname)
 {
 	DIR *dir;
 	struct dirent *dirent;
-	vfs_stat_t finfo;
 	char newdir[256];
 	char *ndir = NULL;
 	ui_file_list_entry_attr_t attr;
-	ui_file_list_entry_t *cur;
-	ui_file_list_entry_t *next;
+	ui_file_list_entry_t *entry;
+	fid_t fid;
 	char *olddn;
+	size_t nread;
 	errno_t rc;
 
+	/* Stop statting the entries we are about to throw away */
+	ui_file_list_stat_halt(flist);
+
 	rc = vfs_cwd_set(dirname);
 	if (rc != EOK)
 		return rc;
@@ -355,65 +460,73 @@ errno_t ui_file_list_read_dir(ui_file_list_t *flist, const char *dirname)
 		attr.name = "..";
 		attr.isdir = true;
 
-		rc = ui_file_list_entry_append(flist, &attr);
+		rc = ui_file_list_sorted_insert(flist, &attr);
 		if (rc != EOK)
 			goto error;
 	}
 
+	nread = 0;
 	dirent = readdir(dir);
 	while (dirent != NULL) {
-		rc = vfs_stat_path(dirent->d_name, &finfo);
-		if (rc != EOK) {
-			/* Possibly a stale entry */
-			dirent = readdir(dir);
-			continue;
-		}
-
 		ui_file_list_entry_attr_init(&attr);
 		attr.name = dirent->d_name;
-		attr.size = finfo.size;
-		attr.isdir = finfo.is_directory;
-		attr.svc = finfo.service;
 
-		rc = ui_file_list_entry_append(flist, &attr);
+		rc = ui_file_list_sorted_insert(flist, &attr);
 		if (rc != EOK)
 			goto error;
 
+		if (++nread % fl_stream_paint_period == 0)
+			(void) ui_file_list_paint(flist);
+
 		dirent = readdir(dir);
 	}
 
 	closedir(dir);
+	dir = NULL;
 
-	rc = ui_file_list_sort(flist);
-	if (rc != EOK)
-		goto error;
+	free(flist->index);
+	flist->index = NULL;
+	flist->index_cnt = 0;
+	flist->index_cap = 0;
 
 	/* Moving up? */
-	if (str_cmp(dirname, "..") == 0) {
+	if (str_cmp(dirname, "..") == 0 && flist->dir != NULL) {
 		/* Get the last component of old path */
 		olddn = str_rchr(flist->dir, '/');
 		if (olddn != NULL && *olddn != '\0') {
 			/* Find corresponding entry */
 			++olddn;
-			cur = ui_file_list_first(flist);
-			next = ui_file_list_next(cur);
-			while (next != NULL && str_cmp(next->name, olddn) <= 0 &&
-			    next->isdir) {
-				cur = next;
-				next = ui_file_list_next(cur);
-			}
+			entry = ui_file_list_first(flist);
+			while (entry != NULL &&
+			    str_cmp(entry->name, olddn) != 0)
+				entry = ui_file_list_next(entry);
 
 			/* Center on the entry */
-			ui_list_cursor_center(flist->list, cur->entry);
+			if (entry != NULL)
+				ui_list_cursor_center(flist->list,
+				    entry->entry);
 		}
 	}
 
 	free(flist->dir);
 	flist->dir = ndir;
 
+	/* Fill in stat information in the background */
+	fid = fibril_create(ui_file_list_stat_fibril, (void *)flist);
+	if (fid != 0) {
+		fibril_mutex_lock(&flist->stat_lock);
+		flist->stat_busy = true;
+		fibril_mutex_unlock(&flist->stat_lock);
+		fibril_add_ready(fid);
+	}
+
 	return EOK;
 error:
 	(void) vfs_cwd_set(flist->dir);
+	free(flist->index);
+	flist->index = NULL;
+	flist->index_cnt = 0;
+	flist->index_cap = 0;
 	if (ndir != NULL)
 		free(ndir);
 	if (dir != NULL)
@@ -421,6 +534,231 @@ error:
 	return rc;
 }
 
+/** Determine if the background stat fibril was asked to stop.
+ *
+ * @param flist File list
+ * @return @c true iff the fibril should stop
+ */
+static bool ui_file_list_stat_cancelled(ui_file_list_t *flist)
+{
+	bool cancel;
+
+	fibril_mutex_lock(&flist->stat_lock);
+	cancel = flist->stat_cancel;
+	fibril_mutex_unlock(&flist->stat_lock);
+
+	return cancel;
+}
+
+/** Delete file list entry from the list.
+ *
+ * Unlike ui_file_list_entry_destroy() this fixes up the cursor and
+ * page position if the entry was under either of them.
+ *
+ * @param entry File list entry
+ */
+static void ui_file_list_entry_delete(ui_file_list_entry_t *entry)
+{
+	ui_list_entry_delete(entry->entry);
+	free(entry->name);
+	free(entry);
+}
+
+/** Finish background stat of file list entries.
+ *
+ * Fix up captions and colors of entries that turned out to be
+ * directories or services, remove stale entries, re-sort (directories
+ * sort before files) and repaint. Must be called with the UI locked.
+ *
+ * @param flist File list
+ */
+static void ui_file_list_stat_finish(ui_file_list_t *flist)
+{
+	ui_file_list_entry_t *entry;
+	ui_file_list_entry_t *next;
+	ui_resource_t *res;
+	char *caption;
+	int rv;
+
+	res = ui_window_get_res(flist->window);
+
+	entry = ui_file_list_first(flist);
+	while (entry != NULL) {
+		next = ui_file_list_next(entry);
+
+		if (entry->stale) {
+			ui_file_list_entry_delete(entry);
+		} else if (entry->isdir && str_cmp(entry->name, "..") != 0) {
+			if (!res->textmode) {
+				rv = asprintf(&caption, "[%s]", entry->name);
+				if (rv >= 0) {
+					(void) ui_list_entry_set_caption(
+					    entry->entry, caption);
+					free(caption);
+				}
+			} else {
+				ui_list_entry_set_color(entry->entry,
+				    flist->dir_color, flist->dir_color);
+			}
+		} else if (entry->svc != 0 && res->textmode) {
+			ui_list_entry_set_color(entry->entry,
+			    flist->svc_color, flist->svc_color);
+		}
+
+		entry = next;
+	}
+
+	(void) ui_file_list_sort(flist);
+	(void) ui_file_list_paint(flist);
+}
+
+/** Background stat fibril.
+ *
+ * Stats the file list entries in batches and fills in their size and
+ * type. The fibril never blocks waiting for the UI lock (it only ever
+ * tries to lock it), so the UI side can safely wait for the fibril
+ * while holding the UI lock.
+ *
+ * @param arg Argument (ui_file_list_t *)
+ * @return EOK (unused)
+ */
+static errno_t ui_file_list_stat_fibril(void *arg)
+{
+	ui_file_list_t *flist = (ui_file_list_t *)arg;
+	ui_t *ui = ui_window_get_ui(flist->window);
+	char *paths[fl_stat_batch];
+	ui_file_list_entry_t *batch[fl_stat_batch];
+	vfs_stat_batch_t *results;
+	ui_file_list_entry_t *entry;
+	size_t cnt;
+	size_t i;
+	errno_t rc;
+	int rv;
+
+	results = calloc(fl_stat_batch, sizeof(vfs_stat_batch_t));
+	if (results == NULL)
+		goto done;
+
+	entry = ui_file_list_first(flist);
+	while (entry != NULL) {
+		/* Collect a batch of entries to stat */
+		cnt = 0;
+		while (entry != NULL && cnt < fl_stat_batch) {
+			if (str_cmp(entry->name, "..") != 0) {
+				/*
+				 * Use an absolute path so that changing
+				 * the working directory (e.g. activating
+				 * the other panel) does not affect us.
+				 */
+				rv = asprintf(&paths[cnt], "%s/%s",
+				    str_cmp(flist->dir, "/") != 0 ?
+				    flist->dir : "", entry->name);
+				if (rv < 0) {
+					entry = NULL;
+					break;
+				}
+
+				batch[cnt] = entry;
+				++cnt;
+			}
+
+			entry = ui_file_list_next(entry);
+		}
+
+		if (cnt == 0)
+			break;
+
+		rc = vfs_stat_batch((const char *const *)paths, cnt,
+		    results);
+
+		for (i = 0; i < cnt; i++)
+			free(paths[i]);
+
+		if (ui_file_list_stat_cancelled(flist))
+			goto cleanup;
+
+		if (rc == EOK) {
+			for (i = 0; i < cnt; i++) {
+				if (results[i].rc == EOK) {
+					batch[i]->size = results[i].stat.size;
+					batch[i]->isdir =
+					    results[i].stat.is_directory;
+					batch[i]->svc =
+					    results[i].stat.service;
+				} else {
+					/* Possibly a stale entry */
+					batch[i]->stale = true;
+				}
+			}
+		}
+
+		/* Show what we have so far, unless the UI is busy */
+		if (fibril_mutex_trylock(&ui->lock)) {
+			(void) ui_file_list_paint(flist);
+			fibril_mutex_unlock(&ui->lock);
+		}
+	}
+
+	/* Fix up captions, remove stale entries and re-sort */
+	while (!ui_file_list_stat_cancelled(flist)) {
+		if (fibril_mutex_trylock(&ui->lock)) {
+			ui_file_list_stat_finish(flist);
+			fibril_mutex_unlock(&ui->lock);
+			break;
+		}
+
+		fibril_usleep(1000);
+	}
+
+cleanup:
+	free(results);
+done:
+	fibril_mutex_lock(&flist->stat_lock);
+	flist->stat_busy = false;
+	fibril_condvar_broadcast(&flist->stat_cv);
+	fibril_mutex_unlock(&flist->stat_lock);
+
+	return EOK;
+}
+
+/** Stop the background stat fibril.
+ *
+ * Ask the stat fibril (if running) to stop and wait until it does.
+ * Safe to call while holding the UI lock, since the fibril never
+ * blocks waiting for it.
+ *
+ * @param flist File list
+ */
+static void ui_file_list_stat_halt(ui_file_list_t *flist)
+{
+	fibril_mutex_lock(&flist->stat_lock);
+	if (flist->stat_busy) {
+		flist->stat_cancel = true;
+		while (flist->stat_busy)
+			fibril_condvar_wait(&flist->stat_cv,
+			    &flist->stat_lock);
+		flist->stat_cancel = false;
+	}
+	fibril_mutex_unlock(&flist->stat_lock);
+}
+
+/** Wait until the background stat fibril has finished.
+ *
+ * After ui_file_list_read_dir() returns, entries show up with zero
+ * size until the background stat fibril fills them in. Wait for it
+ * when complete entries are needed (e.g. before reading entry sizes
+ * programmatically). Must not be called while holding the UI lock.
+ *
+ * @param flist File list
+ */
+void ui_file_list_stat_wait(ui_file_list_t *flist)
+{
+	fibril_mutex_lock(&flist->stat_lock);
+	while (flist->stat_busy)
+		fibril_condvar_wait(&flist->stat_cv, &flist->stat_lock);
+	fibril_mutex_unlock(&flist->stat_lock);
+}
+
 /** Sort file list entries.
  *
  * @param flist File list
@@ -431,6 +769,25 @@ errno_t ui_file_list_sort(ui_file_list_t *flist)
 	return ui_list_sort(flist->list);
 }
 
+/** Compare two file list entries.
+ *
+ * @param a First file list entry
+ * @param b Second file list entry
+ * @return <0, =0, >=0 if a < b, a == b, a > b, resp.
+ */
+static int ui_file_list_entry_cmp(ui_file_list_entry_t *a,
+    ui_file_list_entry_t *b)
+{
+	int dcmp;
+
+	/* Sort directories first */
+	dcmp = b->isdir - a->isdir;
+	if (dcmp != 0)
+		return dcmp;
+
+	return str_cmp(a->name, b->name);
+}
+
 /** Compare two list entries within file list entries.
  *
  * @param ea First UI list entry
@@ -441,17 +798,11 @@ int ui_file_list_list_compare(ui_list_entry_t *ea, ui_list_entry_t *eb)
 {
 	ui_file_list_entry_t *a;
 	ui_file_list_entry_t *b;
-	int dcmp;
 
 	a = (ui_file_list_entry_t *)ui_list_entry_get_arg(ea);
 	b = (ui_file_list_entry_t *)ui_list_entry_get_arg(eb);
 
-	/* Sort directories first */
-	dcmp = b->isdir - a->isdir;
-	if (dcmp != 0)
-		return dcmp;
-
-	return str_cmp(a->name, b->name);
+	return ui_file_list_entry_cmp(a, b);
 }
 
 /** Return first file list entry.
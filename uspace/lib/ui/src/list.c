@@ -675,8 +675,24 @@ ui_evclaim_t ui_list_ctl_pos_event(void *arg, pos_event_t *event)
  */
 errno_t ui_list_entry_append(ui_list_t *list, ui_list_entry_attr_t *attr,
     ui_list_entry_t **rentry)
+{
+	return ui_list_entry_insert_before(list, attr, NULL, rentry);
+}
+
+/** Insert new UI list entry before an existing entry.
+ *
+ * @param list UI list
+ * @param attr Entry attributes
+ * @param enext Entry before which to insert or @c NULL to append at the end
+ * @param rentry Place to store pointer to new entry or @c NULL if not
+ *               interested
+ * @return EOK on success or an error code
+ */
+errno_t ui_list_entry_insert_before(ui_list_t *list, ui_list_entry_attr_t *attr,
+    ui_list_entry_t *enext, ui_list_entry_t **rentry)
 {
 	ui_list_entry_t *entry;
+	size_t idx;
 
 	entry = calloc(1, sizeof(ui_list_entry_t));
 	if (entry == NULL)
@@ -693,7 +709,10 @@ errno_t ui_list_entry_append(ui_list_t *list, ui_list_entry_attr_t *attr,
 	entry->color = attr->color;
 	entry->bgcolor = attr->bgcolor;
 	link_initialize(&entry->lentries);
-	list_append(&entry->lentries, &list->entries);
+	if (enext != NULL)
+		list_insert_before(&entry->lentries, &enext->lentries);
+	else
+		list_append(&entry->lentries, &list->entries);
 
 	if (list->entries_cnt == 0) {
 		/* Adding first entry - need to set the cursor */
@@ -701,6 +720,13 @@ errno_t ui_list_entry_append(ui_list_t *list, ui_list_entry_attr_t *attr,
 		list->cursor_idx = 0;
 		list->page = entry;
 		list->page_idx = 0;
+	} else if (enext != NULL) {
+		/* Entries following the new entry shifted one position */
+		idx = ui_list_entry_get_idx(entry);
+		if (idx <= list->page_idx)
+			++list->page_idx;
+		if (idx <= list->cursor_idx)
+			++list->cursor_idx;
 	}
 
 	++list->entries_cnt;
@@ -899,6 +925,21 @@ errno_t ui_list_entry_set_caption(ui_list_entry_t *entry, const char *caption)
 	return EOK;
 }
 
+/** Set UI list entry color.
+ *
+ * @param entry UI list entry
+ * @param color Text color or @c NULL to use default
+ * @param bgcolor Background color or @c NULL to use default
+ */
+void ui_list_entry_set_color(ui_list_entry_t *entry, gfx_color_t *color,
+    gfx_color_t *bgcolor)
+{
+	entry->color = color;
+	entry->bgcolor = bgcolor;
+
+	(void)ui_list_entry_paint(entry, ui_list_entry_get_idx(entry));
+}
+
 /** Clear UI list entry list.
  *
  * @param list UI list
@@ -1480,10 +1521,11 @@ errno_t ui_list_sort(ui_list_t *list)
 
 	free(emap);
 
-	list->page = ui_list_first(list);
-	list->page_idx = 0;
-	list->cursor = ui_list_first(list);
-	list->cursor_idx = 0;
+	/* Entries moved, but page and cursor should stay on the same entry */
+	if (list->page != NULL)
+		list->page_idx = ui_list_entry_get_idx(list->page);
+	if (list->cursor != NULL)
+		list->cursor_idx = ui_list_entry_get_idx(list->cursor);
 	return EOK;
 }
 
@@ -952,6 +952,37 @@ errno_t ui_window_paint(ui_window_t *window)
 	return ui_window_send_paint(window);
 }
 
+/** Begin window update batch.
+ *
+ * Defer flushing rendered output to the display until the matching
+ * ui_window_end_update(). Use when painting several controls at once
+ * so that all the paints are delivered in a single render operation
+ * instead of one per control. Batches can be nested; only the
+ * outermost end flushes.
+ *
+ * @param window Window
+ */
+void ui_window_begin_update(ui_window_t *window)
+{
+	++window->update_level;
+}
+
+/** End window update batch.
+ *
+ * Ends batch started with ui_window_begin_update(), flushing any
+ * deferred output when the outermost batch is ended.
+ *
+ * @param window Window
+ */
+void ui_window_end_update(ui_window_t *window)
+{
+	assert(window->update_level > 0);
+	--window->update_level;
+
+	if (window->update_level == 0)
+		(void) gfx_update(window->gc);
+}
+
 /** Handle window close event. */
 static void dwnd_close_event(void *arg)
 {
@@ -1516,24 +1547,31 @@ errno_t ui_window_def_paint(ui_window_t *window)
 	gfx_rect_t app_rect;
 	errno_t rc;
 
+	/* Flush all the control paints in one go */
+	ui_window_begin_update(window);
+
 	rc = gfx_set_color(window->gc, window->res->wnd_face_color);
 	if (rc != EOK)
-		return rc;
+		goto error;
 
 	ui_window_get_app_rect(window, &app_rect);
 
 	rc = gfx_fill_rect(window->gc, &app_rect);
 	if (rc != EOK)
-		return rc;
+		goto error;
 
-	if (window->control != NULL)
-		return ui_control_paint(window->control);
+	if (window->control != NULL) {
+		rc = ui_control_paint(window->control);
+		if (rc != EOK)
+			goto error;
+	}
 
-	rc = gfx_update(window->res->gc);
-	if (rc != EOK)
-		return rc;
+	ui_window_end_update(window);
 
 	return EOK;
+error:
+	ui_window_end_update(window);
+	return rc;
 }
 
 /** Default window position event routine.
@@ -1691,6 +1729,10 @@ static void ui_window_update(void *arg)
 {
 	ui_window_t *window = (ui_window_t *) arg;
 
+	/* Defer the update while an update batch is open */
+	if (window->update_level > 0)
+		return;
+
 	if (!gfx_rect_is_empty(&window->dirty_rect)) {
 		(void) gfx_bitmap_render(window->bmp, &window->dirty_rect,
 		    &window->dpos);
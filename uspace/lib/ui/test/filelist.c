@@ -492,6 +492,9 @@ PCUT_TEST(read_dir)
 	rc = ui_file_list_read_dir(flist, p);
 	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
 
+	/* Wait for the background stat fibril to fill in entry sizes */
+	ui_file_list_stat_wait(flist);
+
 	PCUT_ASSERT_INT_EQUALS(2, ui_list_entries_cnt(flist->list));
 
 	entry = ui_file_list_first(flist);
@@ -1011,6 +1014,9 @@ PCUT_TEST(open_dir)
 	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
 	PCUT_ASSERT_STR_EQUALS(p, flist->dir);
 
+	/* Wait for the background stat fibril to fill in entry types */
+	ui_file_list_stat_wait(flist);
+
 	PCUT_ASSERT_INT_EQUALS(2, ui_list_entries_cnt(flist->list));
 
 	entry = ui_file_list_first(flist);
@@ -903,6 +903,64 @@ PCUT_TEST(entry_append)
 	ui_destroy(ui);
 }
 
+/** ui_list_entry_insert_before() inserts entry before another entry */
+PCUT_TEST(entry_insert_before)
+{
+	ui_t *ui;
+	ui_window_t *window;
+	ui_wnd_params_t params;
+	ui_list_t *list;
+	ui_list_entry_attr_t attr;
+	ui_list_entry_t *entry;
+	ui_list_entry_t *e;
+	errno_t rc;
+
+	rc = ui_create_disp(NULL, &ui);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	ui_wnd_params_init(&params);
+	params.caption = "Test";
+
+	rc = ui_window_create(ui, &params, &window);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = ui_list_create(window, true, &list);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	ui_list_entry_attr_init(&attr);
+
+	/* Append entry "b" */
+	attr.caption = "b";
+	attr.arg = (void *)2;
+	rc = ui_list_entry_append(list, &attr, &entry);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	/* Insert entry "a" before it */
+	attr.caption = "a";
+	attr.arg = (void *)1;
+	rc = ui_list_entry_insert_before(list, &attr, entry, NULL);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(2, list_count(&list->entries));
+
+	/* Entries should be in the order "a", "b" */
+	e = ui_list_first(list);
+	PCUT_ASSERT_NOT_NULL(e);
+	PCUT_ASSERT_EQUALS((void *)1, e->arg);
+
+	e = ui_list_next(e);
+	PCUT_ASSERT_NOT_NULL(e);
+	PCUT_ASSERT_EQUALS((void *)2, e->arg);
+
+	/* Cursor should still be at "b", now at index 1 */
+	PCUT_ASSERT_EQUALS(entry, list->cursor);
+	PCUT_ASSERT_INT_EQUALS(1, list->cursor_idx);
+
+	ui_list_destroy(list);
+	ui_window_destroy(window);
+	ui_destroy(ui);
+}
+
 /** ui_list_entry_move_up() moves entry up */
 PCUT_TEST(entry_move_up)
 {
@@ -1243,6 +1301,59 @@ PCUT_TEST(entry_set_caption)
 	ui_destroy(ui);
 }
 
+/** ui_list_entry_set_color() sets entry color */
+PCUT_TEST(entry_set_color)
+{
+	ui_t *ui;
+	ui_window_t *window;
+	ui_wnd_params_t params;
+	ui_list_t *list;
+	ui_list_entry_attr_t attr;
+	ui_list_entry_t *entry;
+	gfx_color_t *color;
+	gfx_color_t *bgcolor;
+	errno_t rc;
+
+	rc = ui_create_disp(NULL, &ui);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	ui_wnd_params_init(&params);
+	params.caption = "Test";
+
+	rc = ui_window_create(ui, &params, &window);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = ui_list_create(window, true, &list);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_color_new_ega(0x0f, &color);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_color_new_ega(0x0a, &bgcolor);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	ui_list_entry_attr_init(&attr);
+
+	/* Append entry and get pointer to it */
+	attr.caption = "a";
+	attr.arg = (void *)1;
+	entry = NULL;
+	rc = ui_list_entry_append(list, &attr, &entry);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_NOT_NULL(entry);
+
+	/* Change colors */
+	ui_list_entry_set_color(entry, color, bgcolor);
+	PCUT_ASSERT_EQUALS(color, entry->color);
+	PCUT_ASSERT_EQUALS(bgcolor, entry->bgcolor);
+
+	ui_list_destroy(list);
+	gfx_color_delete(color);
+	gfx_color_delete(bgcolor);
+	ui_window_destroy(window);
+	ui_destroy(ui);
+}
+
 /** ui_list_entries_cnt() returns the number of entries */
 PCUT_TEST(entries_cnt)
 {
@@ -414,6 +414,35 @@ PCUT_TEST(paint)
 	ui_destroy(ui);
 }
 
+/** Test ui_window_begin_update() / ui_window_end_update() */
+PCUT_TEST(begin_end_update)
+{
+	errno_t rc;
+	ui_t *ui = NULL;
+	ui_wnd_params_t params;
+	ui_window_t *window = NULL;
+
+	rc = ui_create_disp(NULL, &ui);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	ui_wnd_params_init(&params);
+	params.caption = "Hello";
+
+	rc = ui_window_create(ui, &params, &window);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_NOT_NULL(window);
+
+	/* Batches can be nested, painting inside is deferred */
+	ui_window_begin_update(window);
+	ui_window_begin_update(window);
+	ui_window_paint(window);
+	ui_window_end_update(window);
+	ui_window_end_update(window);
+
+	ui_window_destroy(window);
+	ui_destroy(ui);
+}
+
 /** Test ui_window_def_paint() */
 PCUT_TEST(def_paint)
 {
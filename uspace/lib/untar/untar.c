@@ -30,16 +30,66 @@
  * @{
  */
 /** @file
+ *
+ * The archive is consumed through a readahead stream: a producer fibril
+ * keeps issuing large reads into a ring of buffers while the extraction
+ * code drains them, so archive input overlaps with file output whenever
+ * the underlying medium blocks on I/O. File data is written out directly
+ * from the stream buffers in large spans instead of one 512-byte tar
+ * block at a time.
  */
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdbool.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <macros.h>
+#include <mem.h>
+#include <str.h>
 #include <str_error.h>
 #include <vfs/vfs.h>
 #include "private/tar.h"
 #include "untar.h"
 
+enum {
+	/** Size of one readahead buffer in bytes */
+	stream_buf_size = 256 * 1024,
+	/** Number of readahead buffers */
+	stream_bufs = 2
+};
+
+/** Readahead stream over a tar_file_t.
+ *
+ * The producer fibril fills the buffers in round-robin order; the
+ * consumer drains them in the same order. A buffer shorter than
+ * @c stream_buf_size marks the end of the archive (the underlying
+ * read callbacks only return short counts on end of medium or error).
+ */
+typedef struct {
+	tar_file_t *tar;
+
+	fibril_mutex_t lock;
+	fibril_condvar_t change;
+
+	uint8_t *buf[stream_bufs];
+	/** Number of valid bytes in each buffer */
+	size_t nbytes[stream_bufs];
+	/** Buffer is filled and owned by the consumer */
+	bool full[stream_bufs];
+
+	/** Buffer the consumer is draining */
+	size_t rb;
+	/** Consumer position within the current buffer */
+	size_t pos;
+
+	/** Consumer is quitting, producer should terminate */
+	bool stop;
+	/** Producer has terminated */
+	bool done;
+} tar_stream_t;
+
 static size_t get_block_count(size_t bytes)
 {
 	return (bytes + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE;
@@ -55,11 +105,6 @@ static void tar_close(tar_file_t *tar)
 	tar->close(tar);
 }
 
-static size_t tar_read(tar_file_t *tar, void *data, size_t size)
-{
-	return tar->read(tar, data, size);
-}
-
 static void tar_report(tar_file_t *tar, const char *fmt, ...)
 {
 	va_list args;
@@ -70,93 +115,325 @@ static void tar_report(tar_file_t *tar, const char *fmt, ...)
 	va_end(args);
 }
 
-static errno_t tar_skip_blocks(tar_file_t *tar, size_t valid_data_size)
+/** Producer fibril filling the readahead buffers. */
+static errno_t tar_stream_fibril(void *arg)
+{
+	tar_stream_t *stream = (tar_stream_t *) arg;
+	size_t wb = 0;
+
+	while (true) {
+		fibril_mutex_lock(&stream->lock);
+		while (stream->full[wb] && !stream->stop)
+			fibril_condvar_wait(&stream->change, &stream->lock);
+		if (stream->stop) {
+			fibril_mutex_unlock(&stream->lock);
+			break;
+		}
+		fibril_mutex_unlock(&stream->lock);
+
+		/*
+		 * Fill the whole buffer even if the underlying callback
+		 * returns less than asked for; only a zero return marks
+		 * the end of the archive.
+		 */
+		size_t nread = 0;
+		while (nread < stream_buf_size) {
+			size_t now = stream->tar->read(stream->tar,
+			    stream->buf[wb] + nread, stream_buf_size - nread);
+			if (now == 0)
+				break;
+
+			nread += now;
+		}
+
+		fibril_mutex_lock(&stream->lock);
+		stream->nbytes[wb] = nread;
+		stream->full[wb] = true;
+		fibril_condvar_broadcast(&stream->change);
+		fibril_mutex_unlock(&stream->lock);
+
+		if (nread < stream_buf_size)
+			break;
+
+		wb = (wb + 1) % stream_bufs;
+	}
+
+	fibril_mutex_lock(&stream->lock);
+	stream->done = true;
+	fibril_condvar_broadcast(&stream->change);
+	fibril_mutex_unlock(&stream->lock);
+
+	return EOK;
+}
+
+static errno_t tar_stream_init(tar_stream_t *stream, tar_file_t *tar)
+{
+	size_t i;
+
+	memset(stream, 0, sizeof(tar_stream_t));
+	stream->tar = tar;
+	fibril_mutex_initialize(&stream->lock);
+	fibril_condvar_initialize(&stream->change);
+
+	for (i = 0; i < stream_bufs; i++) {
+		stream->buf[i] = malloc(stream_buf_size);
+		if (stream->buf[i] == NULL) {
+			while (i > 0)
+				free(stream->buf[--i]);
+			return ENOMEM;
+		}
+	}
+
+	fid_t fid = fibril_create(tar_stream_fibril, stream);
+	if (fid == 0) {
+		for (i = 0; i < stream_bufs; i++)
+			free(stream->buf[i]);
+		return ENOMEM;
+	}
+
+	fibril_add_ready(fid);
+	return EOK;
+}
+
+static void tar_stream_fini(tar_stream_t *stream)
+{
+	size_t i;
+
+	fibril_mutex_lock(&stream->lock);
+	stream->stop = true;
+	fibril_condvar_broadcast(&stream->change);
+	while (!stream->done)
+		fibril_condvar_wait(&stream->change, &stream->lock);
+	fibril_mutex_unlock(&stream->lock);
+
+	for (i = 0; i < stream_bufs; i++)
+		free(stream->buf[i]);
+}
+
+/** Get a pointer to the next contiguous run of archive data.
+ *
+ * Waits for the producer if no data is buffered yet.
+ *
+ * @param stream	The stream to read from.
+ * @param data		Place to store pointer to the buffered data.
+ *
+ * @return		Number of contiguous bytes available at @a *data,
+ *			zero at the end of the archive.
+ */
+static size_t tar_stream_get(tar_stream_t *stream, void **data)
+{
+	fibril_mutex_lock(&stream->lock);
+
+	while (true) {
+		while (!stream->full[stream->rb])
+			fibril_condvar_wait(&stream->change, &stream->lock);
+
+		if (stream->pos < stream->nbytes[stream->rb])
+			break;
+
+		if (stream->nbytes[stream->rb] < stream_buf_size) {
+			/* Drained the short (final) buffer. */
+			fibril_mutex_unlock(&stream->lock);
+			return 0;
+		}
+
+		/* Hand the drained buffer back to the producer. */
+		stream->full[stream->rb] = false;
+		stream->rb = (stream->rb + 1) % stream_bufs;
+		stream->pos = 0;
+		fibril_condvar_broadcast(&stream->change);
+	}
+
+	*data = stream->buf[stream->rb] + stream->pos;
+	size_t avail = stream->nbytes[stream->rb] - stream->pos;
+
+	fibril_mutex_unlock(&stream->lock);
+	return avail;
+}
+
+/** Mark @a size bytes returned by tar_stream_get() as consumed. */
+static void tar_stream_consume(tar_stream_t *stream, size_t size)
+{
+	stream->pos += size;
+}
+
+/** Read @a size bytes from the stream, crossing buffer boundaries. */
+static size_t tar_stream_read(tar_stream_t *stream, void *data, size_t size)
 {
-	size_t blocks_to_read = get_block_count(valid_data_size);
+	size_t done = 0;
+
+	while (done < size) {
+		void *src;
+		size_t avail = tar_stream_get(stream, &src);
+		if (avail == 0)
+			break;
 
-	while (blocks_to_read > 0) {
-		uint8_t block[TAR_BLOCK_SIZE];
-		size_t actually_read = tar_read(tar, block, TAR_BLOCK_SIZE);
-		if (actually_read != TAR_BLOCK_SIZE)
+		size_t now = min(avail, size - done);
+		memcpy((uint8_t *) data + done, src, now);
+		tar_stream_consume(stream, now);
+		done += now;
+	}
+
+	return done;
+}
+
+/** Skip @a to_skip bytes of archive data. */
+static errno_t tar_stream_skip(tar_stream_t *stream, size_t to_skip)
+{
+	while (to_skip > 0) {
+		void *src;
+		size_t avail = tar_stream_get(stream, &src);
+		if (avail == 0)
 			return errno;
 
-		blocks_to_read--;
+		size_t now = min(avail, to_skip);
+		tar_stream_consume(stream, now);
+		to_skip -= now;
 	}
 
 	return EOK;
 }
 
-static errno_t tar_handle_normal_file(tar_file_t *tar,
+static errno_t tar_skip_blocks(tar_stream_t *stream, size_t valid_data_size)
+{
+	return tar_stream_skip(stream,
+	    get_block_count(valid_data_size) * TAR_BLOCK_SIZE);
+}
+
+/** Make sure the parent directory of @a path exists.
+ *
+ * Well-formed archives list a directory before its contents, so most of
+ * the time the parent is the directory created last. The last created
+ * path is cached in @a last_dir and matching files skip the VFS round
+ * trip entirely; only a cache miss walks the path creating the missing
+ * components.
+ *
+ * @param last_dir	Cache of the last created directory path.
+ * @param path		Path of the file about to be created.
+ */
+static void tar_ensure_parent(char *last_dir, const char *path)
+{
+	char dir[100];
+	size_t i, last_slash;
+
+	last_slash = 0;
+	for (i = 0; path[i] != '\0' && i < sizeof(dir) - 1; i++) {
+		if (path[i] == '/')
+			last_slash = i;
+	}
+
+	if (last_slash == 0)
+		return;
+
+	memcpy(dir, path, last_slash);
+	dir[last_slash] = '\0';
+
+	if (str_cmp(dir, last_dir) == 0)
+		return;
+
+	/* Create all missing components in one pass. */
+	for (i = 1; dir[i] != '\0'; i++) {
+		if (dir[i] != '/')
+			continue;
+
+		dir[i] = '\0';
+		(void) vfs_link_path(dir, KIND_DIRECTORY, NULL);
+		dir[i] = '/';
+	}
+
+	(void) vfs_link_path(dir, KIND_DIRECTORY, NULL);
+	str_cpy(last_dir, 100, dir);
+}
+
+static errno_t tar_handle_normal_file(tar_stream_t *stream, char *last_dir,
     const tar_header_t *header)
 {
-	// FIXME: create the directory first
+	tar_ensure_parent(last_dir, header->filename);
 
 	FILE *file = fopen(header->filename, "wb");
 	if (file == NULL) {
-		tar_report(tar, "Failed to create %s: %s.\n", header->filename,
-		    str_error(errno));
+		tar_report(stream->tar, "Failed to create %s: %s.\n",
+		    header->filename, str_error(errno));
 		return errno;
 	}
 
 	errno_t rc = EOK;
 	size_t bytes_remaining = header->size;
-	size_t blocks = get_block_count(bytes_remaining);
 
-	while (blocks > 0) {
-		uint8_t block[TAR_BLOCK_SIZE];
-		size_t actually_read = tar_read(tar, block, TAR_BLOCK_SIZE);
-		if (actually_read != TAR_BLOCK_SIZE) {
+	while (bytes_remaining > 0) {
+		void *src;
+		size_t avail = tar_stream_get(stream, &src);
+		if (avail == 0) {
 			rc = errno;
-			tar_report(tar, "Failed to read block for %s: %s.\n",
+			tar_report(stream->tar, "Failed to read %s: %s.\n",
 			    header->filename, str_error(rc));
 			break;
 		}
 
-		size_t to_write = TAR_BLOCK_SIZE;
-		if (bytes_remaining < TAR_BLOCK_SIZE)
-			to_write = bytes_remaining;
-
-		size_t actually_written = fwrite(block, 1, to_write, file);
-		if (actually_written != to_write) {
+		size_t now = min(avail, bytes_remaining);
+		size_t actually_written = fwrite(src, 1, now, file);
+		if (actually_written != now) {
 			rc = errno;
-			tar_report(tar, "Failed to write to %s: %s.\n",
+			tar_report(stream->tar, "Failed to write to %s: %s.\n",
 			    header->filename, str_error(rc));
 			break;
 		}
 
-		blocks--;
-		bytes_remaining -= TAR_BLOCK_SIZE;
+		tar_stream_consume(stream, now);
+		bytes_remaining -= now;
 	}
 
 	fclose(file);
-	return rc;
+	if (rc != EOK)
+		return rc;
+
+	/* Skip padding up to the tar block boundary. */
+	return tar_stream_skip(stream,
+	    get_block_count(header->size) * TAR_BLOCK_SIZE - header->size);
 }
 
-static errno_t tar_handle_directory(tar_file_t *tar, const tar_header_t *header)
+static errno_t tar_handle_directory(tar_stream_t *stream, char *last_dir,
+    const tar_header_t *header)
 {
 	errno_t rc = vfs_link_path(header->filename, KIND_DIRECTORY, NULL);
 	if (rc != EOK) {
 		if (rc != EEXIST) {
-			tar_report(tar, "Failed to create directory %s: %s.\n",
+			tar_report(stream->tar,
+			    "Failed to create directory %s: %s.\n",
 			    header->filename, str_error(rc));
 			return rc;
 		}
 	}
 
-	return tar_skip_blocks(tar, header->size);
+	str_cpy(last_dir, 100, header->filename);
+	return tar_skip_blocks(stream, header->size);
 }
 
 int untar(tar_file_t *tar)
 {
+	tar_stream_t stream;
+	char last_dir[100];
+
 	int rc = tar_open(tar);
 	if (rc != EOK) {
 		tar_report(tar, "Failed to open: %s.\n", str_error(rc));
 		return rc;
 	}
 
+	rc = tar_stream_init(&stream, tar);
+	if (rc != EOK) {
+		tar_report(tar, "Failed to start readahead: %s.\n",
+		    str_error(rc));
+		tar_close(tar);
+		return rc;
+	}
+
+	last_dir[0] = '\0';
+
 	while (true) {
 		tar_header_raw_t header_raw;
-		size_t header_ok = tar_read(tar, &header_raw, sizeof(header_raw));
+		size_t header_ok = tar_stream_read(&stream, &header_raw,
+		    sizeof(header_raw));
 		if (header_ok != sizeof(header_raw))
 			break;
 
@@ -172,13 +449,13 @@ int untar(tar_file_t *tar)
 
 		switch (header.type) {
 		case TAR_TYPE_DIRECTORY:
-			rc = tar_handle_directory(tar, &header);
+			rc = tar_handle_directory(&stream, last_dir, &header);
 			break;
 		case TAR_TYPE_NORMAL:
-			rc = tar_handle_normal_file(tar, &header);
+			rc = tar_handle_normal_file(&stream, last_dir, &header);
 			break;
 		default:
-			rc = tar_skip_blocks(tar, header.size);
+			rc = tar_skip_blocks(&stream, header.size);
 			break;
 		}
 
@@ -186,6 +463,7 @@ int untar(tar_file_t *tar)
 			break;
 	}
 
+	tar_stream_fini(&stream);
 	tar_close(tar);
 	return EOK;
 }
@@ -35,6 +35,7 @@
 #ifndef LIBUSB_HIDTYPES_H_
 #define LIBUSB_HIDTYPES_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <adt/list.h>
 
@@ -190,6 +191,15 @@ typedef struct {
 	/** Parsed value */
 	int32_t value;
 
+	/**
+	 * Divisor for the logical to physical value conversion.
+	 * Resolved once, when the field is translated for the first time.
+	 */
+	int32_t resolution;
+
+	/** Whether the last parsed report changed the value */
+	bool changed;
+
 	/** Link to usb_hid_report_description_t.report_items list */
 	link_t ritems_link;
 } usb_hid_report_field_t;
@@ -152,12 +152,19 @@ errno_t usb_hid_parse_report(const usb_hid_report_t *report, const uint8_t *data
 	    usb_hid_report_field_t, item) {
 
 		if (USB_HID_ITEM_FLAG_CONSTANT(item->item_flags) == 0) {
+			const int32_t value =
+			    usb_hid_translate_data(item, data);
+
+			/*
+			 * Relative fields carry a delta and are significant
+			 * even when two successive reports are identical.
+			 */
+			item->changed = (value != item->value) ||
+			    (USB_HID_ITEM_FLAG_RELATIVE(item->item_flags) != 0);
+			item->value = value;
 
 			if (USB_HID_ITEM_FLAG_VARIABLE(item->item_flags) == 0) {
 				/* array */
-				item->value =
-				    usb_hid_translate_data(item, data);
-
 				item->usage = USB_HID_EXTENDED_USAGE(
 				    item->usages[item->value -
 				    item->physical_minimum]);
@@ -175,10 +182,6 @@ errno_t usb_hid_parse_report(const usb_hid_report_t *report, const uint8_t *data
 				usb_hid_report_set_last_item(
 				    item->collection_path,
 				    USB_HID_TAG_CLASS_LOCAL, item->usage);
-			} else {
-				/* variable item */
-				item->value = usb_hid_translate_data(item,
-				    data);
 			}
 		}
 	}
@@ -187,33 +190,53 @@ errno_t usb_hid_parse_report(const usb_hid_report_t *report, const uint8_t *data
 }
 
 /**
- * Translate data from the report as specified in report descriptor item
+ * Resolve the physical limits and scaling of a field.
  *
- * @param item Report descriptor item with definition of translation
- * @param data Data to translate
- * @return Translated data
+ * Computed only once per field; subsequent translations reuse the
+ * cached resolution instead of re-deriving it for every report.
+ *
+ * @param item Report descriptor item to prepare
  */
-int usb_hid_translate_data(usb_hid_report_field_t *item, const uint8_t *data)
+static void usb_hid_translate_prepare(usb_hid_report_field_t *item)
 {
-	/* now only short tags are allowed */
-	if (item->size > 32) {
-		return 0;
-	}
+	if (item->resolution != 0)
+		return;
 
 	if ((item->physical_minimum == 0) && (item->physical_maximum == 0)) {
 		item->physical_minimum = item->logical_minimum;
 		item->physical_maximum = item->logical_maximum;
 	}
 
-	int resolution;
 	if (item->physical_maximum == item->physical_minimum) {
-		resolution = 1;
+		item->resolution = 1;
 	} else {
-		resolution = (item->logical_maximum - item->logical_minimum) /
+		item->resolution =
+		    (item->logical_maximum - item->logical_minimum) /
 		    ((item->physical_maximum - item->physical_minimum) *
 		    (usb_pow(10, (item->unit_exponent))));
 	}
 
+	/* Avoid dividing by zero on degenerate descriptors */
+	if (item->resolution == 0)
+		item->resolution = 1;
+}
+
+/**
+ * Translate data from the report as specified in report descriptor item
+ *
+ * @param item Report descriptor item with definition of translation
+ * @param data Data to translate
+ * @return Translated data
+ */
+int usb_hid_translate_data(usb_hid_report_field_t *item, const uint8_t *data)
+{
+	/* now only short tags are allowed */
+	if (item->size > 32) {
+		return 0;
+	}
+
+	usb_hid_translate_prepare(item);
+
 	int32_t value = 0;
 
 	/* First, skip all bytes we don't care */
@@ -248,7 +271,7 @@ int usb_hid_translate_data(usb_hid_report_field_t *item, const uint8_t *data)
 		value = USB_HID_UINT32_TO_INT32(value, item->size);
 	}
 
-	return (int) (((value - item->logical_minimum) / resolution) +
+	return (int) (((value - item->logical_minimum) / item->resolution) +
 	    item->physical_minimum);
 }
 
@@ -411,31 +434,19 @@ uint32_t usb_hid_translate_data_reverse(usb_hid_report_field_t *item,
     int value)
 {
 	int ret = 0;
-	int resolution;
 
 	if (USB_HID_ITEM_FLAG_CONSTANT(item->item_flags)) {
 		return item->logical_minimum;
 	}
 
-	if ((item->physical_minimum == 0) && (item->physical_maximum == 0)) {
-		item->physical_minimum = item->logical_minimum;
-		item->physical_maximum = item->logical_maximum;
-	}
-
 	/* variable item */
-	if (item->physical_maximum == item->physical_minimum) {
-		resolution = 1;
-	} else {
-		resolution = (item->logical_maximum - item->logical_minimum) /
-		    ((item->physical_maximum - item->physical_minimum) *
-		    (usb_pow(10, (item->unit_exponent))));
-	}
+	usb_hid_translate_prepare(item);
 
-	ret = ((value - item->physical_minimum) * resolution) +
+	ret = ((value - item->physical_minimum) * item->resolution) +
 	    item->logical_minimum;
 
 	usb_log_debug("\tvalue(%x), resolution(%x), phymin(%x) logmin(%x), "
-	    "ret(%x)\n", value, resolution, item->physical_minimum,
+	    "ret(%x)\n", value, item->resolution, item->physical_minimum,
 	    item->logical_minimum, ret);
 
 	if ((item->logical_minimum < 0) || (item->logical_maximum < 0)) {
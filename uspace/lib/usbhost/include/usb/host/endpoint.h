@@ -105,6 +105,12 @@ typedef struct endpoint {
 	dma_policy_t transfer_buffer_policy;
 	/** Enforced by the library. */
 	dma_policy_t required_transfer_buffer_policy;
+	/**
+	 * True iff the HC can schedule a transfer starting at an arbitrary
+	 * offset within the buffer. HCs capable of scatter-gather set this
+	 * to avoid bouncing transfers into a fresh contiguous buffer.
+	 */
+	bool transfer_offset_supported;
 
 	/**
 	 * Number of packets that can be sent in one service interval
@@ -267,14 +267,16 @@ errno_t endpoint_send_batch(endpoint_t *ep, const transfer_request_t *req)
 
 	dma_buffer_acquire(&batch->dma_buffer);
 
-	if (batch->offset != 0) {
-		usb_log_debug("A transfer with nonzero offset requested.");
-		usb_transfer_batch_bounce(batch);
+	if (usb_transfer_batch_bounce_required(batch)) {
+		const errno_t err = usb_transfer_batch_bounce(batch);
+		if (err != EOK) {
+			usb_log_error("Failed to bounce the transfer buffer: "
+			    "%s", str_error(err));
+			usb_transfer_batch_destroy(batch);
+			return err;
+		}
 	}
 
-	if (usb_transfer_batch_bounce_required(batch))
-		usb_transfer_batch_bounce(batch);
-
 	batch->on_complete = req->on_complete;
 	batch->on_complete_data = req->arg;
 
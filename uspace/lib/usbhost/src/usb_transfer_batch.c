@@ -107,6 +107,10 @@ bool usb_transfer_batch_bounce_required(usb_transfer_batch_t *batch)
 	if (!batch->size)
 		return false;
 
+	/* Only HCs capable of scatter-gather can start in mid-buffer */
+	if (batch->offset != 0 && !batch->ep->transfer_offset_supported)
+		return true;
+
 	unsigned flags = batch->dma_buffer.policy & DMA_POLICY_FLAGS_MASK;
 	unsigned required_flags =
 	    batch->ep->required_transfer_buffer_policy & DMA_POLICY_FLAGS_MASK;
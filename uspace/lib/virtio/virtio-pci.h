@@ -63,6 +63,13 @@
 
 #define VIRTIO_F_VERSION_1	1
 
+/* Ring feature bits (features 0 - 31) */
+
+/** The device supports indirect descriptor tables */
+#define VIRTIO_F_RING_INDIRECT_DESC	(1U << 28)
+/** The device uses the used_event / avail_event notification gates */
+#define VIRTIO_F_RING_EVENT_IDX		(1U << 29)
+
 /** Common configuration structure layout according to VIRTIO version 1.0 */
 typedef struct virtio_pci_common_cfg {
 	ioport32_t device_feature_select;
@@ -151,6 +158,19 @@ typedef struct {
 	virtq_used_t *used;
 	uint16_t used_last_idx;
 
+	/**
+	 * Location of the used_event gate (right past the available ring).
+	 * Honored by the device iff VIRTIO_F_RING_EVENT_IDX was negotiated.
+	 */
+	ioport16_t *used_event;
+	/**
+	 * Location of the avail_event gate (right past the used ring).
+	 * Honored by the driver iff VIRTIO_F_RING_EVENT_IDX was negotiated.
+	 */
+	ioport16_t *avail_event;
+	/** Available index at the time of the last device notification */
+	uint16_t avail_kick_idx;
+
 	/** Address of the queue's notification register */
 	ioport16_t *notify;
 } virtq_t;
@@ -179,6 +199,9 @@ typedef struct {
 	/** Device-specific configuration */
 	void *device_cfg;
 
+	/** Features negotiated with the device (bits 0 - 31) */
+	uint32_t features;
+
 	/** Virtqueues */
 	virtq_t *queues;
 } virtio_dev_t;
@@ -191,12 +214,16 @@ extern void virtio_virtq_desc_set(virtio_dev_t *vdev, uint16_t, uint16_t,
     uint64_t, uint32_t, uint16_t, uint16_t);
 extern uint16_t virtio_virtq_desc_get_next(virtio_dev_t *vdev, uint16_t,
     uint16_t);
+extern void virtio_indirect_desc_set(virtq_desc_t *, uint16_t, uint64_t,
+    uint32_t, uint16_t, uint16_t);
 
 extern void virtio_create_desc_free_list(virtio_dev_t *, uint16_t, uint16_t,
     uint16_t *);
 extern uint16_t virtio_alloc_desc(virtio_dev_t *, uint16_t, uint16_t *);
 extern void virtio_free_desc(virtio_dev_t *, uint16_t, uint16_t *, uint16_t);
 
+extern void virtio_virtq_produce_enqueue(virtio_dev_t *, uint16_t, uint16_t);
+extern void virtio_virtq_notify(virtio_dev_t *, uint16_t);
 extern void virtio_virtq_produce_available(virtio_dev_t *, uint16_t, uint16_t);
 extern bool virtio_virtq_consume_used(virtio_dev_t *, uint16_t, uint16_t *,
     uint32_t *);
@@ -113,6 +113,30 @@ uint16_t virtio_virtq_desc_get_next(virtio_dev_t *vdev, uint16_t num,
 	return pio_read_le16(&d->next);
 }
 
+/** Set a descriptor in a driver-provided indirect descriptor table
+ *
+ * The table is a plain DMA buffer of virtq_desc_t entries, e.g. one
+ * allocated by virtio_setup_dma_bufs(). A virtqueue descriptor carrying
+ * the VIRTQ_DESC_F_INDIRECT flag can then refer to the entire table.
+ * Requires the VIRTIO_F_RING_INDIRECT_DESC feature to be negotiated.
+ *
+ * @param table[in]   Virtual address of the indirect descriptor table.
+ * @param descno[in]  Index of the descriptor within the table.
+ * @param addr[in]    Buffer physical address.
+ * @param len[in]     Buffer length.
+ * @param flags[in]   Buffer flags.
+ * @param next[in]    Continuation descriptor within the table.
+ */
+void virtio_indirect_desc_set(virtq_desc_t *table, uint16_t descno,
+    uint64_t addr, uint32_t len, uint16_t flags, uint16_t next)
+{
+	virtq_desc_t *d = &table[descno];
+	pio_write_le64(&d->addr, addr);
+	pio_write_le32(&d->len, len);
+	pio_write_le16(&d->flags, flags);
+	pio_write_le16(&d->next, next);
+}
+
 /** Create free descriptor list from the unused VIRTIO descriptors
  *
  * @param vdev[in]   VIRTIO device for which the free list will be created.
@@ -170,7 +194,12 @@ void virtio_free_desc(virtio_dev_t *vdev, uint16_t num, uint16_t *head,
 	fibril_mutex_unlock(&q->lock);
 }
 
-void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
+/** Put a descriptor chain on the available ring without notifying the device
+ *
+ * Allows several requests to be batched behind a single device notification
+ * issued later by virtio_virtq_notify().
+ */
+void virtio_virtq_produce_enqueue(virtio_dev_t *vdev, uint16_t num,
     uint16_t descno)
 {
 	virtq_t *q = &vdev->queues[num];
@@ -180,11 +209,48 @@ void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
 	pio_write_le16(&q->avail->ring[idx % q->queue_size], descno);
 	write_barrier();
 	pio_write_le16(&q->avail->idx, idx + 1);
+	fibril_mutex_unlock(&q->lock);
+}
+
+/** Notify the device about descriptors put on the available ring
+ *
+ * The notification is suppressed when the device indicates it does not need
+ * it, either via the avail_event gate (if VIRTIO_F_RING_EVENT_IDX was
+ * negotiated) or via the used ring flags.
+ */
+void virtio_virtq_notify(virtio_dev_t *vdev, uint16_t num)
+{
+	virtq_t *q = &vdev->queues[num];
+
+	fibril_mutex_lock(&q->lock);
 	write_barrier();
-	pio_write_le16(q->notify, num);
+	uint16_t idx = pio_read_le16(&q->avail->idx);
+	bool kick;
+	if (vdev->features & VIRTIO_F_RING_EVENT_IDX) {
+		/*
+		 * Kick only if the available index moved past the device's
+		 * avail_event gate since the last notification.
+		 */
+		uint16_t event = pio_read_le16(q->avail_event);
+		kick = (uint16_t) (idx - event - 1) <
+		    (uint16_t) (idx - q->avail_kick_idx);
+	} else {
+		kick = !(pio_read_le16(&q->used->flags) &
+		    VIRTQ_USED_F_NO_NOTIFY);
+	}
+	q->avail_kick_idx = idx;
+	if (kick)
+		pio_write_le16(q->notify, num);
 	fibril_mutex_unlock(&q->lock);
 }
 
+void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
+    uint16_t descno)
+{
+	virtio_virtq_produce_enqueue(vdev, num, descno);
+	virtio_virtq_notify(vdev, num);
+}
+
 bool virtio_virtq_consume_used(virtio_dev_t *vdev, uint16_t num,
     uint16_t *descno, uint32_t *len)
 {
@@ -193,8 +259,23 @@ bool virtio_virtq_consume_used(virtio_dev_t *vdev, uint16_t num,
 	fibril_mutex_lock(&q->lock);
 	uint16_t last_idx = q->used_last_idx % q->queue_size;
 	if (last_idx == (pio_read_le16(&q->used->idx) % q->queue_size)) {
-		fibril_mutex_unlock(&q->lock);
-		return false;
+		if (vdev->features & VIRTIO_F_RING_EVENT_IDX) {
+			/*
+			 * Ask for an interrupt on the next used descriptor
+			 * and then look again so that a descriptor used in
+			 * the meantime is not missed.
+			 */
+			pio_write_le16(q->used_event, q->used_last_idx);
+			write_barrier();
+			if (last_idx ==
+			    (pio_read_le16(&q->used->idx) % q->queue_size)) {
+				fibril_mutex_unlock(&q->lock);
+				return false;
+			}
+		} else {
+			fibril_mutex_unlock(&q->lock);
+			return false;
+		}
 	}
 
 	*descno = (uint16_t) pio_read_le32(&q->used->ring[last_idx].id);
@@ -259,6 +340,15 @@ errno_t virtio_virtq_setup(virtio_dev_t *vdev, uint16_t num, uint16_t size)
 	q->used = q->virt + used_offset;
 	q->used_last_idx = 0;
 
+	/*
+	 * The event gates live in the extra ioport16_t allocated past each
+	 * ring. They take effect only when VIRTIO_F_RING_EVENT_IDX was
+	 * negotiated.
+	 */
+	q->used_event = &q->avail->ring[size];
+	q->avail_event = (ioport16_t *) &q->used->ring[size];
+	q->avail_kick_idx = 0;
+
 	memset(q->virt, 0, q->size);
 
 	/*
@@ -331,6 +421,13 @@ errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
 		return ENOTSUP;
 	features &= device_features;
 
+	/*
+	 * The ring features are not device-specific, so accept them on behalf
+	 * of the driver whenever the device offers them.
+	 */
+	features |= device_features &
+	    (VIRTIO_F_RING_INDIRECT_DESC | VIRTIO_F_RING_EVENT_IDX);
+
 	if (reserved_features != (reserved_features & device_reserved_features))
 		return ENOTSUP;
 	reserved_features &= device_reserved_features;
@@ -344,6 +441,8 @@ errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
 	ddf_msg(LVL_NOTE, "accepted features %x, reserved features %x",
 	    features, reserved_features);
 
+	vdev->features = features;
+
 	/* 5. Set FEATURES_OK */
 	status |= VIRTIO_DEV_STATUS_FEATURES_OK;
 	pio_write_8(&cfg->device_status, status);
@@ -304,6 +304,60 @@ size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *data,
 	return copied_size;
 }
 
+/**
+ * Mix data stored in the pipe into a float accumulator buffer.
+ * @param pipe The pipe that should provide data.
+ * @param acc Accumulator buffer of normalized float samples.
+ * @param frames Number of frames to mix.
+ * @param f Format of the final mix (determines the channel count).
+ * @return Number of frames actually mixed.
+ */
+size_t audio_pipe_mix_acc(audio_pipe_t *pipe, float *acc, size_t frames,
+    const pcm_format_t *f)
+{
+	assert(pipe);
+
+	size_t needed_frames = frames;
+	size_t mixed_frames = 0;
+
+	fibril_mutex_lock(&pipe->guard);
+	while (needed_frames > 0 && !list_empty(&pipe->list)) {
+		/* Get first audio chunk */
+		link_t *l = list_first(&pipe->list);
+		audio_data_link_t *alink = audio_data_link_list_instance(l);
+
+		/* Get audio chunk metadata */
+		const size_t src_frame_size =
+		    pcm_format_frame_size(&alink->adata->format);
+		const size_t available_frames =
+		    audio_data_link_available_frames(alink);
+		const size_t copy_frames = min(available_frames, needed_frames);
+		const size_t src_copy_size = copy_frames * src_frame_size;
+
+		assert(src_copy_size <= audio_data_link_remain_size(alink));
+
+		/* Add the chunk to the accumulator */
+		pcm_format_mix_float(acc + mixed_frames * f->channels,
+		    audio_data_link_start(alink), src_copy_size,
+		    f->channels, &alink->adata->format);
+
+		/* Update values */
+		needed_frames -= copy_frames;
+		mixed_frames += copy_frames;
+		alink->position += src_copy_size;
+		pipe->bytes -= src_copy_size;
+		pipe->frames -= copy_frames;
+		if (audio_data_link_remain_size(alink) == 0) {
+			list_remove(&alink->link);
+			audio_data_link_destroy(alink);
+		} else {
+			assert(needed_frames == 0);
+		}
+	}
+	fibril_mutex_unlock(&pipe->guard);
+	return mixed_frames;
+}
+
 /**
  * @}
  */
@@ -79,6 +79,8 @@ audio_data_t *audio_pipe_pop(audio_pipe_t *pipe);
 
 size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *buffer, size_t size,
     const pcm_format_t *f);
+size_t audio_pipe_mix_acc(audio_pipe_t *pipe, float *acc, size_t frames,
+    const pcm_format_t *f);
 
 /**
  * Total bytes getter.
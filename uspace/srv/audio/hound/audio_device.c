@@ -47,9 +47,12 @@
 #include "audio_device.h"
 #include "log.h"
 
-/* hardwired to provide ~21ms per fragment */
+/* default split, provides ~21ms per fragment on a 64k buffer */
 #define BUFFER_PARTS   16
 
+/* fragment duration to aim for when the device supports smaller fragments */
+#define FRAGMENT_TARGET_USEC   10000
+
 static errno_t device_sink_connection_callback(audio_sink_t *sink, bool new);
 static errno_t device_source_connection_callback(audio_source_t *source, bool new);
 static void device_event_callback(ipc_call_t *icall, void *arg);
@@ -57,6 +60,7 @@ static errno_t device_check_format(audio_sink_t *sink);
 static errno_t get_buffer(audio_device_t *dev);
 static errno_t release_buffer(audio_device_t *dev);
 static void advance_buffer(audio_device_t *dev, size_t size);
+static void setup_fragment_size(audio_device_t *dev, const pcm_format_t *f);
 static inline bool is_running(audio_device_t *dev)
 {
 	assert(dev);
@@ -165,6 +169,7 @@ static errno_t device_sink_connection_callback(audio_sink_t *sink, bool new)
 			    str_error(ret));
 			return ret;
 		}
+		setup_fragment_size(dev, &dev->sink.format);
 		audio_pcm_register_event_callback(dev->sess,
 		    device_event_callback, dev);
 
@@ -227,6 +232,7 @@ static errno_t device_source_connection_callback(audio_source_t *source, bool ne
 			    str_error(ret));
 			return ret;
 		}
+		setup_fragment_size(dev, &dev->source.format);
 
 		//TODO set and test format
 
@@ -392,6 +398,40 @@ static errno_t release_buffer(audio_device_t *dev)
 	return ret;
 }
 
+/**
+ * Choose fragment size aiming at low latency.
+ * @param dev Audio device.
+ * @param f Format of the transported data.
+ *
+ * Splits the buffer into more (smaller) fragments as long as the device
+ * supports the resulting interrupt rate and a fragment is still longer
+ * than the latency target. Keeps the default split when the device does
+ * not report its limits or the format is not known yet.
+ */
+static void setup_fragment_size(audio_device_t *dev, const pcm_format_t *f)
+{
+	assert(dev);
+	assert(dev->buffer.base);
+
+	size_t parts = BUFFER_PARTS;
+	sysarg_t min_frames = 0;
+	const errno_t ret = audio_pcm_query_cap(dev->sess,
+	    AUDIO_CAP_INTERRUPT_MIN_FRAMES, &min_frames);
+	if (ret == EOK && min_frames > 0 && !pcm_format_is_any(f)) {
+		const size_t min_size = min_frames * pcm_format_frame_size(f);
+		while ((dev->buffer.size / (parts * 2)) >= min_size &&
+		    pcm_format_size_to_usec(dev->buffer.size / parts, f) >
+		    FRAGMENT_TARGET_USEC)
+			parts *= 2;
+	}
+	dev->buffer.fragment_size = dev->buffer.size / parts;
+	log_verbose("Using %zu byte (~%lld us) fragments on device '%s'",
+	    dev->buffer.fragment_size,
+	    pcm_format_is_any(f) ? 0 :
+	    (long long)pcm_format_size_to_usec(dev->buffer.fragment_size, f),
+	    dev->name);
+}
+
 /**
  * Move buffer position pointer.
  * @param dev Audio device.
@@ -36,6 +36,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <fibril_synch.h>
+#include <mem.h>
 #include <stdlib.h>
 #include <str.h>
 #include <str_error.h>
@@ -71,6 +72,8 @@ errno_t audio_sink_init(audio_sink_t *sink, const char *name, void *private_data
 		return ENOMEM;
 	sink->private_data = private_data;
 	sink->format = *f;
+	sink->mix_acc = NULL;
+	sink->mix_acc_samples = 0;
 	sink->connection_change = connection_change;
 	sink->check_format = check_format;
 	sink->data_available = data_available;
@@ -87,6 +90,9 @@ void audio_sink_fini(audio_sink_t *sink)
 	assert(sink);
 	assert(list_empty(&sink->connections));
 	assert(!sink->private_data);
+	free(sink->mix_acc);
+	sink->mix_acc = NULL;
+	sink->mix_acc_samples = 0;
 	free(sink->name);
 	sink->name = NULL;
 }
@@ -139,16 +145,40 @@ void audio_sink_mix_inputs(audio_sink_t *sink, void *dest, size_t size)
 	assert(sink);
 	assert(dest);
 
-	pcm_format_silence(dest, size, &sink->format);
+	const size_t frames = pcm_format_size_to_frames(size, &sink->format);
+	const size_t samples = frames * sink->format.channels;
+
 	fibril_mutex_lock(&sink->lock);
+
+	/*
+	 * Mix all inputs into a float accumulator and convert the mix to
+	 * the sink format in one pass, so the destination is decoded and
+	 * encoded once instead of once per connection.
+	 */
+	if (sink->mix_acc_samples < samples) {
+		float *acc = realloc(sink->mix_acc,
+		    samples * sizeof(float));
+		if (!acc) {
+			fibril_mutex_unlock(&sink->lock);
+			log_error("Failed to allocate mixing accumulator");
+			pcm_format_silence(dest, size, &sink->format);
+			return;
+		}
+		sink->mix_acc = acc;
+		sink->mix_acc_samples = samples;
+	}
+	memset(sink->mix_acc, 0, samples * sizeof(float));
+
 	list_foreach(sink->connections, sink_link, connection_t, conn) {
-		const errno_t ret = connection_add_source_data(
-		    conn, dest, size, sink->format);
+		const errno_t ret = connection_add_source_data_acc(
+		    conn, sink->mix_acc, frames, sink->format);
 		if (ret != EOK) {
 			log_warning("Failed to mix source %s: %s",
 			    connection_source_name(conn), str_error(ret));
 		}
 	}
+
+	pcm_format_from_float(dest, size, sink->mix_acc, &sink->format);
 	fibril_mutex_unlock(&sink->lock);
 }
 
@@ -59,6 +59,10 @@ struct audio_sink {
 	char *name;
 	/** Consumes data in this format */
 	pcm_format_t format;
+	/** Mixing accumulator of normalized float samples */
+	float *mix_acc;
+	/** Allocated accumulator capacity in samples */
+	size_t mix_acc_samples;
 	/** Backend data */
 	void *private_data;
 	/** Connect/disconnect callback */
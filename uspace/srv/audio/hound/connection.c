@@ -126,6 +126,36 @@ errno_t connection_add_source_data(connection_t *connection, void *data,
 		    ret, size);
 	return EOK;
 }
+
+/**
+ * Update the source and mix its data into a float accumulator.
+ * @param connection the connection to add.
+ * @param acc Accumulator buffer of normalized float samples.
+ * @param frames Number of frames to mix.
+ * @param format Format of the final mix.
+ */
+errno_t connection_add_source_data_acc(connection_t *connection, float *acc,
+    size_t frames, pcm_format_t format)
+{
+	assert(connection);
+	if (!acc)
+		return EBADMEM;
+	const size_t size = frames * pcm_format_frame_size(&format);
+	if (frames > audio_pipe_frames(&connection->fifo) &&
+	    connection->source->update_available_data) {
+		log_debug("Asking source to provide more data");
+		connection->source->update_available_data(
+		    connection->source, size);
+	}
+	log_verbose("Data available after update: %zu",
+	    audio_pipe_bytes(&connection->fifo));
+	const size_t mixed =
+	    audio_pipe_mix_acc(&connection->fifo, acc, frames, &format);
+	if (mixed != frames)
+		log_warning("Connection failed to provide enough data %zu/%zu",
+		    mixed, frames);
+	return EOK;
+}
 /**
  * Add new data to the connection buffer.
  * @param connection Target conneciton.
@@ -86,6 +86,9 @@ void connection_destroy(connection_t *connection);
 errno_t connection_add_source_data(connection_t *connection, void *data,
     size_t size, pcm_format_t format);
 
+errno_t connection_add_source_data_acc(connection_t *connection, float *acc,
+    size_t frames, pcm_format_t format);
+
 errno_t connection_push_data(connection_t *connection, audio_data_t *adata);
 
 /**
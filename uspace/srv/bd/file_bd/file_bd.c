@@ -44,14 +44,17 @@
 #include <bd_srv.h>
 #include <fibril_synch.h>
 #include <loc.h>
+#include <mem.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <errno.h>
 #include <str_error.h>
 #include <stdbool.h>
 #include <task.h>
 #include <macros.h>
 #include <str.h>
+#include <vfs/vfs.h>
 
 #define NAME "file_bd"
 
@@ -59,12 +62,18 @@
 
 static size_t block_size;
 static aoff64_t num_blocks;
-static FILE *img;
+static int img_fd = -1;
 static loc_srv_t *srv;
 
+/** Optional in-memory copy of the whole image (NULL if not caching). */
+static void *img_cache;
+static bool cache_enabled;
+
+/** Protects @c img_cache against concurrent readers and writers. */
+static fibril_rwlock_t cache_lock;
+
 static service_id_t service_id;
 static bd_srvs_t bd_srvs;
-static fibril_mutex_t dev_lock;
 
 static void print_usage(void);
 static errno_t file_bd_init(const char *fname);
@@ -116,6 +125,8 @@ int main(int argc, char **argv)
 			}
 			++argv;
 			--argc;
+		} else if (str_cmp(*argv, "-c") == 0) {
+			cache_enabled = true;
 		} else {
 			printf("Invalid option '%s'.\n", *argv);
 			print_usage();
@@ -167,7 +178,9 @@ int main(int argc, char **argv)
 
 static void print_usage(void)
 {
-	printf("Usage: " NAME " [-b <block_size>] <image_file> <device_name>\n");
+	printf("Usage: " NAME " [-b <block_size>] [-c] <image_file> "
+	    "<device_name>\n");
+	printf("  -c  Cache the whole image in memory\n");
 }
 
 static errno_t file_bd_init(const char *fname)
@@ -182,32 +195,57 @@ static errno_t file_bd_init(const char *fname)
 		return rc;
 	}
 
-	img = fopen(fname, "rb+");
-	if (img == NULL) {
-		rc = EINVAL;
-		goto error;
-	}
-
-	if (fseek(img, 0, SEEK_END) != 0) {
-		rc = EIO;
+	rc = vfs_lookup_open(fname, WALK_REGULAR, MODE_READ | MODE_WRITE,
+	    &img_fd);
+	if (rc != EOK)
 		goto error;
-	}
 
-	off64_t img_size = ftell(img);
-	if (img_size < 0) {
+	vfs_stat_t stat;
+	rc = vfs_stat(img_fd, &stat);
+	if (rc != EOK) {
 		rc = EIO;
 		goto error;
 	}
 
-	num_blocks = img_size / block_size;
+	num_blocks = stat.size / block_size;
+
+	fibril_rwlock_initialize(&cache_lock);
+
+	if (cache_enabled) {
+		/*
+		 * Keep a private copy of the whole image so that reads
+		 * never touch the file system at all. The cache is
+		 * best-effort: if the image does not fit in memory, fall
+		 * back to plain file access.
+		 */
+		size_t cache_size = 0;
+		if (num_blocks <= SIZE_MAX / block_size)
+			cache_size = num_blocks * block_size;
+
+		if (cache_size != 0)
+			img_cache = malloc(cache_size);
+		if (img_cache != NULL) {
+			aoff64_t pos = 0;
+			size_t nread;
+
+			rc = vfs_read(img_fd, &pos, img_cache, cache_size,
+			    &nread);
+			if (rc != EOK || nread != cache_size) {
+				free(img_cache);
+				img_cache = NULL;
+			}
+		}
 
-	fibril_mutex_initialize(&dev_lock);
+		if (img_cache == NULL)
+			printf("%s: Warning: Unable to cache image, using "
+			    "plain file access.\n", NAME);
+	}
 
 	return EOK;
 error:
-	if (img != NULL) {
-		fclose(img);
-		img = NULL;
+	if (img_fd >= 0) {
+		vfs_put(img_fd);
+		img_fd = -1;
 	}
 
 	if (srv != NULL) {
@@ -240,6 +278,7 @@ static errno_t file_bd_read_blocks(bd_srv_t *bd, uint64_t ba, size_t cnt, void *
     size_t size)
 {
 	size_t n_rd;
+	errno_t rc;
 
 	if (size < cnt * block_size)
 		return EINVAL;
@@ -252,26 +291,31 @@ static errno_t file_bd_read_blocks(bd_srv_t *bd, uint64_t ba, size_t cnt, void *
 		return ELIMIT;
 	}
 
-	fibril_mutex_lock(&dev_lock);
-
-	clearerr(img);
-	if (fseek(img, ba * block_size, SEEK_SET) < 0) {
-		fibril_mutex_unlock(&dev_lock);
-		return EIO;
+	if (img_cache != NULL) {
+		fibril_rwlock_read_lock(&cache_lock);
+		memcpy(buf, img_cache + ba * block_size, cnt * block_size);
+		fibril_rwlock_read_unlock(&cache_lock);
+		return EOK;
 	}
 
-	n_rd = fread(buf, block_size, cnt, img);
-
-	if (ferror(img)) {
-		fibril_mutex_unlock(&dev_lock);
-		return EIO;	/* Read error */
+	/*
+	 * Positional reads do not share any file offset state, so requests
+	 * from different fibrils can proceed concurrently.
+	 */
+	aoff64_t pos = ba * block_size;
+	size_t left = cnt * block_size;
+
+	while (left > 0) {
+		rc = vfs_read(img_fd, &pos, buf, left, &n_rd);
+		if (rc != EOK)
+			return EIO;	/* Read error */
+		if (n_rd == 0)
+			return EINVAL;	/* Read beyond end of device */
+
+		buf += n_rd;
+		left -= n_rd;
 	}
 
-	fibril_mutex_unlock(&dev_lock);
-
-	if (n_rd < cnt)
-		return EINVAL;	/* Read beyond end of device */
-
 	return EOK;
 }
 
@@ -280,6 +324,7 @@ static errno_t file_bd_write_blocks(bd_srv_t *bd, uint64_t ba, size_t cnt,
     const void *buf, size_t size)
 {
 	size_t n_wr;
+	errno_t rc;
 
 	if (size < cnt * block_size)
 		return EINVAL;
@@ -292,27 +337,28 @@ static errno_t file_bd_write_blocks(bd_srv_t *bd, uint64_t ba, size_t cnt,
 		return ELIMIT;
 	}
 
-	fibril_mutex_lock(&dev_lock);
+	/* Write through to the file; the image stays authoritative. */
+	aoff64_t pos = ba * block_size;
+	size_t left = cnt * block_size;
+	const void *src = buf;
 
-	clearerr(img);
-	if (fseek(img, ba * block_size, SEEK_SET) < 0) {
-		fibril_mutex_unlock(&dev_lock);
-		return EIO;
-	}
-
-	n_wr = fwrite(buf, block_size, cnt, img);
+	while (left > 0) {
+		rc = vfs_write(img_fd, &pos, src, left, &n_wr);
+		if (rc != EOK || n_wr == 0)
+			return EIO;	/* Write error */
 
-	if (ferror(img) || n_wr < cnt) {
-		fibril_mutex_unlock(&dev_lock);
-		return EIO;	/* Write error */
+		src += n_wr;
+		left -= n_wr;
 	}
 
-	if (fflush(img) != 0) {
-		fibril_mutex_unlock(&dev_lock);
+	if (vfs_sync(img_fd) != EOK)
 		return EIO;
-	}
 
-	fibril_mutex_unlock(&dev_lock);
+	if (img_cache != NULL) {
+		fibril_rwlock_write_lock(&cache_lock);
+		memcpy(img_cache + ba * block_size, buf, cnt * block_size);
+		fibril_rwlock_write_unlock(&cache_lock);
+	}
 
 	return EOK;
 }
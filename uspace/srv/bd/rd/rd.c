@@ -73,6 +73,7 @@ static errno_t rd_read_blocks(bd_srv_t *, aoff64_t, size_t, void *, size_t);
 static errno_t rd_write_blocks(bd_srv_t *, aoff64_t, size_t, const void *, size_t);
 static errno_t rd_get_block_size(bd_srv_t *, size_t *);
 static errno_t rd_get_num_blocks(bd_srv_t *, aoff64_t *);
+static errno_t rd_get_shared_area(bd_srv_t *, void **, size_t *);
 
 /** This rwlock protects the ramdisk's data.
  *
@@ -89,7 +90,8 @@ static bd_ops_t rd_bd_ops = {
 	.read_blocks = rd_read_blocks,
 	.write_blocks = rd_write_blocks,
 	.get_block_size = rd_get_block_size,
-	.get_num_blocks = rd_get_num_blocks
+	.get_num_blocks = rd_get_num_blocks,
+	.get_shared_area = rd_get_shared_area
 };
 
 static bd_srvs_t bd_srvs;
@@ -211,6 +213,20 @@ static errno_t rd_get_num_blocks(bd_srv_t *bd, aoff64_t *rnb)
 	return EOK;
 }
 
+/** Share the ramdisk image read-only with a client.
+ *
+ * The image is already resident in memory, so clients can read from
+ * the shared mapping directly instead of having every block copied
+ * through IPC. Writes still arrive through rd_write_blocks() and are
+ * immediately visible in the mapping.
+ */
+static errno_t rd_get_shared_area(bd_srv_t *bd, void **rarea, size_t *rsize)
+{
+	*rarea = rd_addr;
+	*rsize = rd_size;
+	return EOK;
+}
+
 int main(int argc, char **argv)
 {
 	printf("%s: HelenOS RAM disk server\n", NAME);
@@ -65,6 +65,9 @@ static errno_t sata_bd_open(bd_srvs_t *, bd_srv_t *);
 static errno_t sata_bd_close(bd_srv_t *);
 static errno_t sata_bd_read_blocks(bd_srv_t *, aoff64_t, size_t, void *, size_t);
 static errno_t sata_bd_write_blocks(bd_srv_t *, aoff64_t, size_t, const void *, size_t);
+static errno_t sata_bd_read_blocks_dma(bd_srv_t *, aoff64_t, size_t, uintptr_t);
+static errno_t sata_bd_write_blocks_dma(bd_srv_t *, aoff64_t, size_t, uintptr_t);
+static errno_t sata_bd_discard(bd_srv_t *, aoff64_t, size_t);
 static errno_t sata_bd_get_block_size(bd_srv_t *, size_t *);
 static errno_t sata_bd_get_num_blocks(bd_srv_t *, aoff64_t *);
 
@@ -73,6 +76,9 @@ static bd_ops_t sata_bd_ops = {
 	.close = sata_bd_close,
 	.read_blocks = sata_bd_read_blocks,
 	.write_blocks = sata_bd_write_blocks,
+	.read_blocks_dma = sata_bd_read_blocks_dma,
+	.write_blocks_dma = sata_bd_write_blocks_dma,
+	.discard = sata_bd_discard,
 	.get_block_size = sata_bd_get_block_size,
 	.get_num_blocks = sata_bd_get_num_blocks
 };
@@ -226,6 +232,32 @@ static errno_t sata_bd_write_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
 	return ahci_write_blocks(sbd->sess, ba, cnt, (void *)buf);
 }
 
+/** Read blocks directly into the client's DMA buffer. */
+static errno_t sata_bd_read_blocks_dma(bd_srv_t *bd, aoff64_t ba, size_t cnt,
+    uintptr_t phys)
+{
+	sata_bd_dev_t *sbd = bd_srv_sata(bd);
+
+	return ahci_read_blocks_dma(sbd->sess, ba, cnt, phys);
+}
+
+/** Write blocks directly from the client's DMA buffer. */
+static errno_t sata_bd_write_blocks_dma(bd_srv_t *bd, aoff64_t ba, size_t cnt,
+    uintptr_t phys)
+{
+	sata_bd_dev_t *sbd = bd_srv_sata(bd);
+
+	return ahci_write_blocks_dma(sbd->sess, ba, cnt, phys);
+}
+
+/** Discard blocks whose data is no longer needed. */
+static errno_t sata_bd_discard(bd_srv_t *bd, aoff64_t ba, size_t cnt)
+{
+	sata_bd_dev_t *sbd = bd_srv_sata(bd);
+
+	return ahci_discard_blocks(sbd->sess, ba, cnt);
+}
+
 /** Get device block size. */
 static errno_t sata_bd_get_block_size(bd_srv_t *bd, size_t *rsize)
 {
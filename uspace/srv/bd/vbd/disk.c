@@ -70,6 +70,8 @@ static errno_t vbds_bd_write_blocks(bd_srv_t *, aoff64_t, size_t, const void *,
     size_t);
 static errno_t vbds_bd_get_block_size(bd_srv_t *, size_t *);
 static errno_t vbds_bd_get_num_blocks(bd_srv_t *, aoff64_t *);
+static errno_t vbds_bd_get_passthrough(bd_srv_t *, service_id_t *, aoff64_t *,
+    aoff64_t *);
 
 static errno_t vbds_bsa_translate(vbds_part_t *, aoff64_t, size_t, aoff64_t *);
 
@@ -92,7 +94,8 @@ static bd_ops_t vbds_bd_ops = {
 	.sync_cache = vbds_bd_sync_cache,
 	.write_blocks = vbds_bd_write_blocks,
 	.get_block_size = vbds_bd_get_block_size,
-	.get_num_blocks = vbds_bd_get_num_blocks
+	.get_num_blocks = vbds_bd_get_num_blocks,
+	.get_passthrough = vbds_bd_get_passthrough
 };
 
 /** Provide disk access to liblabel */
@@ -1070,6 +1073,34 @@ static errno_t vbds_bd_get_num_blocks(bd_srv_t *bd, aoff64_t *rnb)
 	return EOK;
 }
 
+/** Let the client bypass VBD and talk to the underlying disk directly.
+ *
+ * VBD only translates block addresses by the starting block of the
+ * partition. Handing the underlying service and the partition extent to
+ * the client lets it do the translation itself and send I/O straight to
+ * the disk's block device server, saving one IPC hop per operation.
+ */
+static errno_t vbds_bd_get_passthrough(bd_srv_t *bd, service_id_t *rsvc_id,
+    aoff64_t *rbase, aoff64_t *rnblocks)
+{
+	vbds_part_t *part = bd_srv_part(bd);
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG2, "vbds_bd_get_passthrough()");
+
+	fibril_rwlock_read_lock(&part->lock);
+	if (part->lpart == NULL) {
+		fibril_rwlock_read_unlock(&part->lock);
+		return ENOENT;
+	}
+
+	*rsvc_id = part->disk->svc_id;
+	*rbase = part->block0;
+	*rnblocks = part->nblocks;
+	fibril_rwlock_read_unlock(&part->lock);
+
+	return EOK;
+}
+
 void vbds_bd_conn(ipc_call_t *icall, void *arg)
 {
 	vbds_part_t *part;
@@ -31,6 +31,7 @@
  * @{
  */
 
+#include <boottime.h>
 #include <dirent.h>
 #include <errno.h>
 #include <io/log.h>
@@ -49,6 +50,35 @@
 
 static errno_t driver_reassign_fibril(void *);
 
+enum {
+	/**
+	 * Maximum number of devices being probed by drivers at a time.
+	 * Limits the resources consumed when a large device tree is
+	 * enumerated at boot.
+	 */
+	probe_concurrency = 8
+};
+
+/** Limits the number of devices being probed at a time. */
+static FIBRIL_SEMAPHORE_INITIALIZE(probe_sema, probe_concurrency);
+
+/** Bookkeeping for passing devices to a starting driver in parallel. */
+typedef struct {
+	/** Protects pending */
+	fibril_mutex_t lock;
+	/** Signalled when a device has been passed */
+	fibril_condvar_t done_cv;
+	/** Number of devices that have not been passed yet */
+	unsigned pending;
+} driver_pass_t;
+
+/** One device being passed to a starting driver. */
+typedef struct {
+	driver_pass_t *pass;
+	driver_t *driver;
+	dev_node_t *dev;
+} driver_pass_dev_t;
+
 /**
  * Initialize the list of device driver's.
  *
@@ -416,74 +446,197 @@ driver_t *driver_find_by_name(driver_list_t *drv_list, const char *drv_name)
 	return res;
 }
 
+/** Pass one device to its driver and handle probe failure.
+ *
+ * @param driver	The driver the device was assigned to.
+ * @param dev		The device to pass.
+ * @param tree		Device tree
+ */
+static void pass_device(driver_t *driver, dev_node_t *dev, dev_tree_t *tree)
+{
+	add_device(driver, dev, tree);
+
+	/* Device probe failed, need to try next best driver */
+	if (dev->state == DEVICE_NOT_PRESENT) {
+		fibril_mutex_lock(&driver->driver_mutex);
+		list_remove(&dev->driver_devices);
+		fibril_mutex_unlock(&driver->driver_mutex);
+		/* Give an extra reference to driver_reassign_fibril */
+		dev_add_ref(dev);
+		fid_t fid = fibril_create(driver_reassign_fibril, dev);
+		if (fid == 0) {
+			log_msg(LOG_DEFAULT, LVL_ERROR,
+			    "Error creating fibril to assign driver.");
+			dev_del_ref(dev);
+		} else {
+			fibril_add_ready(fid);
+		}
+	}
+}
+
+/** Pass one device to a starting driver in a separate fibril.
+ *
+ * @param arg Device being passed (driver_pass_dev_t)
+ */
+static errno_t pass_device_fibril(void *arg)
+{
+	driver_pass_dev_t *pd = (driver_pass_dev_t *) arg;
+
+	pass_device(pd->driver, pd->dev, &device_tree);
+
+	/* Delete the reference we got from pass_device_start(). */
+	dev_del_ref(pd->dev);
+
+	fibril_mutex_lock(&pd->pass->lock);
+	assert(pd->pass->pending > 0);
+	pd->pass->pending--;
+	fibril_condvar_broadcast(&pd->pass->done_cv);
+	fibril_mutex_unlock(&pd->pass->lock);
+
+	free(pd);
+	return EOK;
+}
+
+/** Start passing a device to the driver in a separate fibril.
+ *
+ * The caller must hold a device reference which is consumed by the
+ * fibril.
+ *
+ * @param pass		Bookkeeping shared by the whole batch of devices.
+ * @param driver	The driver the device was assigned to.
+ * @param dev		The device to pass.
+ * @return		True on success, false if out of resources.
+ */
+static bool pass_device_start(driver_pass_t *pass, driver_t *driver,
+    dev_node_t *dev)
+{
+	driver_pass_dev_t *pd;
+	fid_t fid;
+
+	pd = malloc(sizeof(driver_pass_dev_t));
+	if (pd == NULL)
+		return false;
+
+	pd->pass = pass;
+	pd->driver = driver;
+	pd->dev = dev;
+
+	fid = fibril_create(pass_device_fibril, pd);
+	if (fid == 0) {
+		free(pd);
+		return false;
+	}
+
+	fibril_mutex_lock(&pass->lock);
+	pass->pending++;
+	fibril_mutex_unlock(&pass->lock);
+
+	fibril_add_ready(fid);
+	return true;
+}
+
 /** Notify driver about the devices to which it was assigned.
+ *
+ * The devices are passed in parallel, each in a separate fibril, so
+ * that a single device with a long probe (e.g. link training) delays
+ * only its own bring-up, not everything else queued on the driver.
  *
  * @param driver	The driver to which the devices are passed.
  */
 static void pass_devices_to_driver(driver_t *driver, dev_tree_t *tree)
 {
+	driver_pass_t pass;
 	dev_node_t *dev;
 	link_t *link;
+	unsigned spawned;
+	bool passed;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "pass_devices_to_driver(driver=\"%s\")",
 	    driver->name);
 
+	fibril_mutex_initialize(&pass.lock);
+	fibril_condvar_initialize(&pass.done_cv);
+	pass.pending = 0;
+
 	fibril_mutex_lock(&driver->driver_mutex);
 
 	/*
 	 * Go through devices list as long as there is some device
 	 * that has not been passed to the driver.
 	 */
-	link = driver->devices.head.next;
-	while (link != &driver->devices.head) {
-		dev = list_get_instance(link, dev_node_t, driver_devices);
-		fibril_rwlock_write_lock(&tree->rwlock);
+	while (true) {
+		spawned = 0;
 
-		if (dev->passed_to_driver) {
+		link = driver->devices.head.next;
+		while (link != &driver->devices.head) {
+			dev = list_get_instance(link, dev_node_t,
+			    driver_devices);
+
+			/*
+			 * Mark the device as passed right away so that
+			 * rescans do not pick up devices whose probe is
+			 * still in flight.
+			 */
+			fibril_rwlock_write_lock(&tree->rwlock);
+			passed = dev->passed_to_driver;
+			dev->passed_to_driver = true;
 			fibril_rwlock_write_unlock(&tree->rwlock);
-			link = link->next;
-			continue;
-		}
 
-		dev_add_ref(dev);
+			if (passed) {
+				link = link->next;
+				continue;
+			}
 
-		/*
-		 * Unlock to avoid deadlock when adding device
-		 * handled by itself.
-		 */
-		fibril_mutex_unlock(&driver->driver_mutex);
-		fibril_rwlock_write_unlock(&tree->rwlock);
+			dev_add_ref(dev);
+
+			if (pass_device_start(&pass, driver, dev)) {
+				spawned++;
+				link = link->next;
+				continue;
+			}
+
+			/*
+			 * Could not spawn a fibril for the device - pass it
+			 * synchronously. Unlock to avoid deadlock when adding
+			 * device handled by itself.
+			 */
+			fibril_mutex_unlock(&driver->driver_mutex);
 
-		add_device(driver, dev, tree);
+			pass_device(driver, dev, tree);
+			dev_del_ref(dev);
 
-		/* Device probe failed, need to try next best driver */
-		if (dev->state == DEVICE_NOT_PRESENT) {
+			/*
+			 * Lock again as we will work with driver's
+			 * structure.
+			 */
 			fibril_mutex_lock(&driver->driver_mutex);
-			list_remove(&dev->driver_devices);
-			fibril_mutex_unlock(&driver->driver_mutex);
-			/* Give an extra reference to driver_reassign_fibril */
-			dev_add_ref(dev);
-			fid_t fid = fibril_create(driver_reassign_fibril, dev);
-			if (fid == 0) {
-				log_msg(LOG_DEFAULT, LVL_ERROR,
-				    "Error creating fibril to assign driver.");
-				dev_del_ref(dev);
-			}
-			fibril_add_ready(fid);
+
+			/*
+			 * Restart the cycle to go through all devices again.
+			 */
+			link = driver->devices.head.next;
 		}
 
-		dev_del_ref(dev);
+		if (spawned == 0)
+			break;
 
 		/*
-		 * Lock again as we will work with driver's
-		 * structure.
+		 * Wait until the batch has been passed. Unlock so that the
+		 * driver can register child functions of the devices being
+		 * probed in the meantime.
 		 */
-		fibril_mutex_lock(&driver->driver_mutex);
+		fibril_mutex_unlock(&driver->driver_mutex);
+
+		fibril_mutex_lock(&pass.lock);
+		while (pass.pending > 0)
+			fibril_condvar_wait(&pass.done_cv, &pass.lock);
+		fibril_mutex_unlock(&pass.lock);
 
 		/*
-		 * Restart the cycle to go through all devices again.
+		 * More devices may have been attached to the driver while
+		 * the mutex was not held - rescan.
 		 */
-		link = driver->devices.head.next;
+		fibril_mutex_lock(&driver->driver_mutex);
 	}
 
 	/*
@@ -498,6 +651,11 @@ static void pass_devices_to_driver(driver_t *driver, dev_tree_t *tree)
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "Driver `%s' enters running state.", driver->name);
 	driver->state = DRIVER_RUNNING;
 
+	/* Record the attach completion as a boot milestone. */
+	char mark[BOOTTIME_NAME_SIZE];
+	snprintf(mark, sizeof(mark), "devman:%s", driver->name);
+	boottime_mark(mark);
+
 	fibril_mutex_unlock(&driver->driver_mutex);
 }
 
@@ -645,6 +803,9 @@ void add_device(driver_t *drv, dev_node_t *dev, dev_tree_t *tree)
 		parent_handle = 0;
 	}
 
+	/* Limit the number of devices being probed at a time. */
+	fibril_semaphore_down(&probe_sema);
+
 	async_exch_t *exch = async_exchange_begin(drv->sess);
 
 	ipc_call_t answer;
@@ -664,6 +825,8 @@ void add_device(driver_t *drv, dev_node_t *dev, dev_tree_t *tree)
 		async_wait_for(req, &rc);
 	}
 
+	fibril_semaphore_up(&probe_sema);
+
 	switch (rc) {
 	case EOK:
 		dev->state = DEVICE_USABLE;
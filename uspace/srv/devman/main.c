@@ -36,6 +36,7 @@
  */
 
 #include <assert.h>
+#include <boottime.h>
 #include <ipc/services.h>
 #include <ns.h>
 #include <async.h>
@@ -368,6 +369,7 @@ int main(int argc, char *argv[])
 	}
 
 	printf("%s: Accepting connections.\n", NAME);
+	boottime_mark("devman:accepting");
 	task_retval(0);
 	async_manager();
 
@@ -61,6 +61,9 @@
 
 #define NODE_CACHE_SIZE 200
 
+/** Size of the file content readahead window in blocks */
+#define READAHEAD_BLOCKS 64
+
 /** All root nodes have index 0 */
 #define CDFS_SOME_ROOT  0
 
@@ -229,6 +232,8 @@ typedef struct {
 	service_id_t service_id;  /**< Service ID of block device */
 	cdfs_enc_t enc;		  /**< Filesystem string encoding */
 	char *vol_ident;	  /**< Volume identifier */
+	bool indexing;		  /**< Mount-time metadata index is being
+				       built */
 } cdfs_t;
 
 typedef struct {
@@ -245,7 +250,12 @@ typedef struct {
 	list_t cs_list;           /**< Child's siblings list */
 	cdfs_lba_t lba;           /**< LBA of data on disk */
 	bool processed;           /**< If all children have been read */
+	bool pinned;              /**< Part of the permanent metadata index */
 	unsigned int opened;      /**< Opened count */
+
+	void *ra_buf;             /**< Readahead buffer */
+	aoff64_t ra_start;        /**< File position of the readahead buffer */
+	size_t ra_valid;          /**< Number of valid readahead bytes */
 } cdfs_node_t;
 
 /** String encoding */
@@ -317,6 +327,7 @@ static void nodes_remove_callback(ht_link_t *item)
 		}
 	}
 
+	free(node->ra_buf);
 	free(node->fs_node);
 	free(node);
 }
@@ -365,8 +376,13 @@ static void cdfs_node_initialize(cdfs_node_t *node)
 	node->size = 0;
 	node->lba = 0;
 	node->processed = false;
+	node->pinned = false;
 	node->opened = 0;
 
+	node->ra_buf = NULL;
+	node->ra_start = 0;
+	node->ra_valid = 0;
+
 	list_initialize(&node->cs_list);
 }
 
@@ -407,11 +423,18 @@ static errno_t create_node(fs_node_t **rfn, cdfs_t *fs, int lflag,
 	else
 		node->type = CDFS_FILE;
 
+	/*
+	 * Nodes created while the mount-time metadata index is being built
+	 * are pinned and do not count into the evictable node cache.
+	 */
+	node->pinned = fs->indexing;
+
 	/* Insert the new node into the nodes hash table. */
 	hash_table_insert(&nodes, &node->nh_link);
 
 	*rfn = FS_NODE(node);
-	nodes_cached++;
+	if (!node->pinned)
+		nodes_cached++;
 
 	return EOK;
 }
@@ -697,6 +720,39 @@ static fs_node_t *get_cached_node(cdfs_t *fs, fs_index_t index)
 	return get_uncached_node(fs, index);
 }
 
+/** Read the whole directory tree into memory.
+ *
+ * Reads the directory records of @a fn and all its subdirectories so that
+ * subsequent lookups are served from memory without touching the medium.
+ *
+ * @param fs	File system
+ * @param fn	Directory node to start with
+ * @return	EOK on success or an error code
+ */
+static errno_t cdfs_index_tree(cdfs_t *fs, fs_node_t *fn)
+{
+	cdfs_node_t *node = CDFS_NODE(fn);
+	errno_t rc;
+
+	rc = cdfs_readdir(fs, fn);
+	if (rc != EOK)
+		return rc;
+
+	list_foreach(node->cs_list, link, cdfs_dentry_t, dentry) {
+		fs_node_t *cfn = get_cached_node(fs, dentry->index);
+		if (cfn == NULL)
+			return ENOMEM;
+
+		if (CDFS_NODE(cfn)->type == CDFS_DIRECTORY) {
+			rc = cdfs_index_tree(fs, cfn);
+			if (rc != EOK)
+				return rc;
+		}
+	}
+
+	return EOK;
+}
+
 static errno_t cdfs_match(fs_node_t **fn, fs_node_t *pfn, const char *component)
 {
 	cdfs_node_t *parent = CDFS_NODE(pfn);
@@ -1079,6 +1135,17 @@ static cdfs_t *cdfs_fs_create(service_id_t sid, cdfs_lba_t altroot)
 	if (iso_readfs(fs, rfn, altroot) != EOK)
 		goto error;
 
+	/*
+	 * Read the whole directory tree into memory. ISO metadata is small
+	 * and immutable, so navigation never has to wait on the medium
+	 * afterwards. The index is only an optimization - if it cannot be
+	 * built, fall back to reading the directories on demand.
+	 */
+	fs->indexing = true;
+	CDFS_NODE(rfn)->pinned = true;
+	(void) cdfs_index_tree(fs, rfn);
+	fs->indexing = false;
+
 	list_append(&fs->link, &cdfs_instances);
 	return fs;
 error:
@@ -1251,6 +1318,81 @@ static errno_t cdfs_unmounted(service_id_t service_id)
 	return EOK;
 }
 
+/** Read file content through the readahead window.
+ *
+ * The window is filled with a single large request to the block device, so
+ * sequential reading of a file issues one request per READAHEAD_BLOCKS
+ * blocks instead of one per block. Falls back to the block cache when the
+ * window cannot be allocated.
+ *
+ * @param node		File node
+ * @param call		Data read request call
+ * @param pos		File position to read from
+ * @param len		Maximum number of bytes requested
+ * @param rbytes	Place to store the number of bytes read
+ * @return		EOK on success or an error code
+ */
+static errno_t cdfs_read_file(cdfs_node_t *node, ipc_call_t *call,
+    aoff64_t pos, size_t len, size_t *rbytes)
+{
+	service_id_t service_id = node->fs->service_id;
+	errno_t rc;
+
+	uint32_t blocks = node->size / BLOCK_SIZE;
+	if ((node->size % BLOCK_SIZE) != 0)
+		blocks++;
+
+	if (node->ra_buf == NULL) {
+		size_t ra_blocks = min(READAHEAD_BLOCKS, blocks);
+		node->ra_buf = malloc(ra_blocks * BLOCK_SIZE);
+	}
+
+	if (node->ra_buf == NULL) {
+		/* No memory for the window - read a single cached block. */
+		cdfs_lba_t lba = pos / BLOCK_SIZE;
+		size_t offset = pos % BLOCK_SIZE;
+
+		*rbytes = min(len, BLOCK_SIZE - offset);
+		*rbytes = min(*rbytes, node->size - pos);
+
+		block_t *block;
+		rc = block_get(&block, service_id, node->lba + lba,
+		    BLOCK_FLAGS_NONE);
+		if (rc != EOK) {
+			async_answer_0(call, rc);
+			return rc;
+		}
+
+		async_data_read_finalize(call, block->data + offset, *rbytes);
+		return block_put(block);
+	}
+
+	if ((pos < node->ra_start) ||
+	    (pos >= node->ra_start + node->ra_valid)) {
+		/* Refill the window starting at the block containing pos. */
+		cdfs_lba_t lba = pos / BLOCK_SIZE;
+		size_t cnt = min(READAHEAD_BLOCKS, blocks - lba);
+
+		rc = block_read_direct(service_id, node->lba + lba, cnt,
+		    node->ra_buf);
+		if (rc != EOK) {
+			async_answer_0(call, rc);
+			return rc;
+		}
+
+		node->ra_start = (aoff64_t) lba * BLOCK_SIZE;
+		node->ra_valid = cnt * BLOCK_SIZE;
+	}
+
+	size_t offset = pos - node->ra_start;
+
+	*rbytes = min(len, node->ra_valid - offset);
+	*rbytes = min(*rbytes, node->size - pos);
+
+	async_data_read_finalize(call, node->ra_buf + offset, *rbytes);
+	return EOK;
+}
+
 static errno_t cdfs_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
     size_t *rbytes)
 {
@@ -1284,23 +1426,8 @@ static errno_t cdfs_read(service_id_t service_id, fs_index_t index, aoff64_t pos
 			*rbytes = 0;
 			async_data_read_finalize(&call, NULL, 0);
 		} else {
-			cdfs_lba_t lba = pos / BLOCK_SIZE;
-			size_t offset = pos % BLOCK_SIZE;
-
-			*rbytes = min(len, BLOCK_SIZE - offset);
-			*rbytes = min(*rbytes, node->size - pos);
-
-			block_t *block;
-			errno_t rc = block_get(&block, service_id, node->lba + lba,
-			    BLOCK_FLAGS_NONE);
-			if (rc != EOK) {
-				async_answer_0(&call, rc);
-				return rc;
-			}
-
-			async_data_read_finalize(&call, block->data + offset,
-			    *rbytes);
-			rc = block_put(block);
+			errno_t rc = cdfs_read_file(node, &call, pos, len,
+			    rbytes);
 			if (rc != EOK)
 				return rc;
 		}
@@ -1352,7 +1479,7 @@ static bool cache_remove_closed(ht_link_t *item, void *arg)
 	if (0 < *premove_cnt) {
 		cdfs_node_t *node = hash_table_get_inst(item, cdfs_node_t, nh_link);
 
-		if (!node->opened) {
+		if (!node->opened && !node->pinned) {
 			hash_table_remove_item(&nodes, item);
 
 			--nodes_cached;
@@ -1395,6 +1522,13 @@ static errno_t cdfs_close(service_id_t service_id, fs_index_t index)
 	assert(node->opened > 0);
 
 	node->opened--;
+	if (!node->opened && node->ra_buf) {
+		/* Release the readahead window on the last close. */
+		free(node->ra_buf);
+		node->ra_buf = NULL;
+		node->ra_valid = 0;
+	}
+
 	cleanup_cache(service_id);
 
 	return EOK;
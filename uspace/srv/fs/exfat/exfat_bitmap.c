@@ -42,9 +42,331 @@
 #include <errno.h>
 #include <byteorder.h>
 #include <align.h>
+#include <adt/list.h>
 #include <assert.h>
 #include <fibril_synch.h>
 #include <mem.h>
+#include <stdlib.h>
+
+/*
+ * In-memory allocation bitmap.
+ *
+ * The whole allocation bitmap of each mounted file system is loaded into
+ * memory at mount, so cluster allocation scans memory - skipping fully
+ * allocated 64-bit words at a time - instead of probing the block cache bit
+ * by bit. A rotating cursor makes consecutive allocations resume where the
+ * previous one ended. Updated bitmap sectors are remembered in a dirty
+ * bitmap and written back in one batch by exfat_bitmap_cache_sync().
+ */
+typedef struct {
+	link_t link;
+	service_id_t service_id;
+	/** Protects the bitmap image, the dirty bitmap and the cursor. */
+	fibril_mutex_t lock;
+	/** In-memory image of the allocation bitmap. */
+	uint8_t *bitmap;
+	/** Size of the on-disk bitmap in bytes. */
+	size_t size;
+	/** Number of clusters covered by the bitmap. */
+	exfat_cluster_t nclusters;
+	/** Bitmap of dirty bitmap sectors. */
+	uint8_t *dirty;
+	/** Number of bitmap sectors. */
+	uint32_t sectors;
+	/** Cluster where to start the next free-cluster search. */
+	exfat_cluster_t cursor;
+} exfat_bitmap_cache_t;
+
+static LIST_INITIALIZE(bitmap_cache_list);
+static FIBRIL_MUTEX_INITIALIZE(bitmap_cache_lock);
+
+/** Find the in-memory allocation bitmap of a file system instance.
+ *
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		Bitmap cache or NULL if none was built.
+ */
+static exfat_bitmap_cache_t *exfat_bitmap_cache_find(service_id_t service_id)
+{
+	exfat_bitmap_cache_t *cache = NULL;
+
+	fibril_mutex_lock(&bitmap_cache_lock);
+	list_foreach(bitmap_cache_list, link, exfat_bitmap_cache_t, cur) {
+		if (cur->service_id == service_id) {
+			cache = cur;
+			break;
+		}
+	}
+	fibril_mutex_unlock(&bitmap_cache_lock);
+
+	return cache;
+}
+
+/** Mark the bitmap sectors spanned by a byte range as dirty.
+ *
+ * The caller must hold the cache lock.
+ */
+static void exfat_bitmap_cache_mark_dirty(exfat_bs_t *bs,
+    exfat_bitmap_cache_t *cache, size_t offset, size_t size)
+{
+	aoff64_t sec;
+
+	for (sec = offset / BPS(bs); sec <= (offset + size - 1) / BPS(bs);
+	    sec++)
+		cache->dirty[sec / 8] |= 1 << (sec % 8);
+}
+
+/** Allocate a run of clusters from the in-memory allocation bitmap.
+ *
+ * Starts scanning at the rotating cursor and wraps around once, skipping
+ * fully allocated 64-bit words.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param cache		In-memory allocation bitmap.
+ * @param firstc	Output argument holding the first allocated cluster.
+ * @param count		Number of contiguous clusters to allocate.
+ *
+ * @return		EOK on success, ENOSPC otherwise.
+ */
+static errno_t
+exfat_bitmap_cache_alloc_clusters(exfat_bs_t *bs, exfat_bitmap_cache_t *cache,
+    exfat_cluster_t *firstc, exfat_cluster_t count)
+{
+	fibril_mutex_lock(&cache->lock);
+
+	exfat_cluster_t idx = cache->cursor;
+	if (idx >= cache->nclusters)
+		idx = 0;
+
+	exfat_cluster_t run = 0;
+	exfat_cluster_t visited = 0;
+
+	/*
+	 * Allow the scan to run up to count clusters past a full cycle so
+	 * that a free run spanning the starting point is not missed.
+	 */
+	while (visited < cache->nclusters + count) {
+		if ((run == 0) && (idx % 64 == 0) &&
+		    (idx + 64 <= cache->nclusters) &&
+		    (((uint64_t *) cache->bitmap)[idx / 64] == UINT64_MAX)) {
+			/* The whole word is allocated. */
+			idx += 64;
+			visited += 64;
+			if (idx >= cache->nclusters)
+				idx = 0;
+			continue;
+		}
+
+		if (cache->bitmap[idx / 8] & (1 << (idx % 8))) {
+			run = 0;
+		} else {
+			run++;
+			if (run == count) {
+				exfat_cluster_t first = idx - count + 1;
+
+				for (exfat_cluster_t i = first; i <= idx; i++)
+					cache->bitmap[i / 8] |=
+					    (1 << (i % 8));
+
+				exfat_bitmap_cache_mark_dirty(bs, cache,
+				    first / 8, idx / 8 - first / 8 + 1);
+				cache->cursor = idx + 1;
+				*firstc = first + EXFAT_CLST_FIRST;
+
+				fibril_mutex_unlock(&cache->lock);
+				return EOK;
+			}
+		}
+
+		idx++;
+		visited++;
+		if (idx >= cache->nclusters) {
+			idx = 0;
+			run = 0;
+		}
+	}
+
+	fibril_mutex_unlock(&cache->lock);
+	return ENOSPC;
+}
+
+/** Load the allocation bitmap into memory.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t exfat_bitmap_cache_init(exfat_bs_t *bs, service_id_t service_id)
+{
+	exfat_bitmap_cache_t *cache;
+	fs_node_t *fn;
+	exfat_node_t *bitmapp;
+	block_t *b;
+	uint32_t sec;
+	errno_t rc;
+
+	rc = exfat_bitmap_get(&fn, service_id);
+	if (rc != EOK)
+		return rc;
+	bitmapp = EXFAT_NODE(fn);
+
+	cache = malloc(sizeof(exfat_bitmap_cache_t));
+	if (!cache) {
+		(void) exfat_node_put(fn);
+		return ENOMEM;
+	}
+
+	link_initialize(&cache->link);
+	cache->service_id = service_id;
+	fibril_mutex_initialize(&cache->lock);
+	cache->size = bitmapp->size;
+	cache->sectors = ROUND_UP(cache->size, BPS(bs)) / BPS(bs);
+	cache->nclusters = DATA_CNT(bs);
+	if ((uint64_t) cache->nclusters > (uint64_t) cache->size * 8)
+		cache->nclusters = cache->size * 8;
+	cache->cursor = 0;
+
+	cache->bitmap = malloc(ROUND_UP(cache->size, sizeof(uint64_t)));
+	if (!cache->bitmap) {
+		free(cache);
+		(void) exfat_node_put(fn);
+		return ENOMEM;
+	}
+
+	/* The padding up to a whole word reads as allocated. */
+	memset(cache->bitmap, 0xff, ROUND_UP(cache->size, sizeof(uint64_t)));
+
+	cache->dirty = calloc((cache->sectors + 7) / 8, 1);
+	if (!cache->dirty) {
+		free(cache->bitmap);
+		free(cache);
+		(void) exfat_node_put(fn);
+		return ENOMEM;
+	}
+
+	for (sec = 0; sec < cache->sectors; sec++) {
+		size_t bytes = BPS(bs);
+		if ((aoff64_t)(sec + 1) * BPS(bs) > cache->size)
+			bytes = cache->size - (aoff64_t) sec * BPS(bs);
+
+		rc = exfat_block_get(&b, bs, bitmapp, sec, BLOCK_FLAGS_NONE);
+		if (rc != EOK)
+			goto error;
+
+		memcpy(cache->bitmap + (aoff64_t) sec * BPS(bs), b->data,
+		    bytes);
+
+		rc = block_put(b);
+		if (rc != EOK)
+			goto error;
+	}
+
+	rc = exfat_node_put(fn);
+	if (rc != EOK) {
+		free(cache->dirty);
+		free(cache->bitmap);
+		free(cache);
+		return rc;
+	}
+
+	fibril_mutex_lock(&bitmap_cache_lock);
+	list_append(&cache->link, &bitmap_cache_list);
+	fibril_mutex_unlock(&bitmap_cache_lock);
+
+	return EOK;
+
+error:
+	free(cache->dirty);
+	free(cache->bitmap);
+	free(cache);
+	(void) exfat_node_put(fn);
+	return rc;
+}
+
+/** Write back dirty sectors of the in-memory allocation bitmap.
+ *
+ * A no-op for file systems without the in-memory bitmap.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t exfat_bitmap_cache_sync(exfat_bs_t *bs, service_id_t service_id)
+{
+	exfat_bitmap_cache_t *cache;
+	fs_node_t *fn;
+	exfat_node_t *bitmapp;
+	block_t *b;
+	uint32_t sec;
+	errno_t rc;
+
+	cache = exfat_bitmap_cache_find(service_id);
+	if (!cache)
+		return EOK;
+
+	rc = exfat_bitmap_get(&fn, service_id);
+	if (rc != EOK)
+		return rc;
+	bitmapp = EXFAT_NODE(fn);
+
+	fibril_mutex_lock(&cache->lock);
+	for (sec = 0; sec < cache->sectors; sec++) {
+		if (!(cache->dirty[sec / 8] & (1 << (sec % 8))))
+			continue;
+
+		size_t bytes = BPS(bs);
+		if ((aoff64_t)(sec + 1) * BPS(bs) > cache->size)
+			bytes = cache->size - (aoff64_t) sec * BPS(bs);
+
+		rc = exfat_block_get(&b, bs, bitmapp, sec, BLOCK_FLAGS_NONE);
+		if (rc != EOK) {
+			fibril_mutex_unlock(&cache->lock);
+			(void) exfat_node_put(fn);
+			return rc;
+		}
+
+		memcpy(b->data, cache->bitmap + (aoff64_t) sec * BPS(bs),
+		    bytes);
+
+		b->dirty = true;
+		rc = block_put(b);
+		if (rc != EOK) {
+			fibril_mutex_unlock(&cache->lock);
+			(void) exfat_node_put(fn);
+			return rc;
+		}
+
+		cache->dirty[sec / 8] &= ~(1 << (sec % 8));
+	}
+	fibril_mutex_unlock(&cache->lock);
+
+	return exfat_node_put(fn);
+}
+
+/** Destroy the in-memory allocation bitmap of a file system instance.
+ *
+ * The caller is responsible for writing the bitmap back first.
+ *
+ * @param service_id	Service ID of the file system.
+ */
+void exfat_bitmap_cache_fini(service_id_t service_id)
+{
+	exfat_bitmap_cache_t *cache;
+
+	cache = exfat_bitmap_cache_find(service_id);
+	if (!cache)
+		return;
+
+	fibril_mutex_lock(&bitmap_cache_lock);
+	list_remove(&cache->link);
+	fibril_mutex_unlock(&bitmap_cache_lock);
+
+	free(cache->dirty);
+	free(cache->bitmap);
+	free(cache);
+}
 
 errno_t exfat_bitmap_is_free(exfat_bs_t *bs, service_id_t service_id,
     exfat_cluster_t clst)
@@ -52,12 +374,28 @@ errno_t exfat_bitmap_is_free(exfat_bs_t *bs, service_id_t service_id,
 	fs_node_t *fn;
 	block_t *b = NULL;
 	exfat_node_t *bitmapp;
+	exfat_bitmap_cache_t *cache;
 	uint8_t *bitmap;
 	errno_t rc;
 	bool alloc;
 
 	clst -= EXFAT_CLST_FIRST;
 
+	cache = exfat_bitmap_cache_find(service_id);
+	if (cache != NULL) {
+		if (clst >= cache->nclusters)
+			return ENOENT;
+
+		fibril_mutex_lock(&cache->lock);
+		alloc = cache->bitmap[clst / 8] & (1 << (clst % 8));
+		fibril_mutex_unlock(&cache->lock);
+
+		if (alloc)
+			return ENOENT;
+
+		return EOK;
+	}
+
 	rc = exfat_bitmap_get(&fn, service_id);
 	if (rc != EOK)
 		return rc;
@@ -93,11 +431,21 @@ errno_t exfat_bitmap_set_cluster(exfat_bs_t *bs, service_id_t service_id,
 	fs_node_t *fn;
 	block_t *b = NULL;
 	exfat_node_t *bitmapp;
+	exfat_bitmap_cache_t *cache;
 	uint8_t *bitmap;
 	errno_t rc;
 
 	clst -= EXFAT_CLST_FIRST;
 
+	cache = exfat_bitmap_cache_find(service_id);
+	if (cache != NULL) {
+		fibril_mutex_lock(&cache->lock);
+		cache->bitmap[clst / 8] |= (1 << (clst % 8));
+		exfat_bitmap_cache_mark_dirty(bs, cache, clst / 8, 1);
+		fibril_mutex_unlock(&cache->lock);
+		return EOK;
+	}
+
 	rc = exfat_bitmap_get(&fn, service_id);
 	if (rc != EOK)
 		return rc;
@@ -128,11 +476,21 @@ errno_t exfat_bitmap_clear_cluster(exfat_bs_t *bs, service_id_t service_id,
 	fs_node_t *fn;
 	block_t *b = NULL;
 	exfat_node_t *bitmapp;
+	exfat_bitmap_cache_t *cache;
 	uint8_t *bitmap;
 	errno_t rc;
 
 	clst -= EXFAT_CLST_FIRST;
 
+	cache = exfat_bitmap_cache_find(service_id);
+	if (cache != NULL) {
+		fibril_mutex_lock(&cache->lock);
+		cache->bitmap[clst / 8] &= ~(1 << (clst % 8));
+		exfat_bitmap_cache_mark_dirty(bs, cache, clst / 8, 1);
+		fibril_mutex_unlock(&cache->lock);
+		return EOK;
+	}
+
 	rc = exfat_bitmap_get(&fn, service_id);
 	if (rc != EOK)
 		return rc;
@@ -198,6 +556,13 @@ errno_t exfat_bitmap_alloc_clusters(exfat_bs_t *bs, service_id_t service_id,
     exfat_cluster_t *firstc, exfat_cluster_t count)
 {
 	exfat_cluster_t startc, endc;
+	exfat_bitmap_cache_t *cache;
+
+	cache = exfat_bitmap_cache_find(service_id);
+	if (cache != NULL)
+		return exfat_bitmap_cache_alloc_clusters(bs, cache, firstc,
+		    count);
+
 	startc = EXFAT_CLST_FIRST;
 
 	while (startc < DATA_CNT(bs) + 2) {
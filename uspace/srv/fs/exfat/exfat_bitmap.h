@@ -59,6 +59,10 @@ extern errno_t exfat_bitmap_set_clusters(struct exfat_bs *, service_id_t,
 extern errno_t exfat_bitmap_clear_clusters(struct exfat_bs *, service_id_t,
     exfat_cluster_t, exfat_cluster_t);
 
+extern errno_t exfat_bitmap_cache_init(struct exfat_bs *, service_id_t);
+extern errno_t exfat_bitmap_cache_sync(struct exfat_bs *, service_id_t);
+extern void exfat_bitmap_cache_fini(service_id_t);
+
 #endif
 
 /**
@@ -1211,6 +1211,13 @@ static errno_t exfat_fs_open(service_id_t service_id, enum cache_mode cmode,
 
 static void exfat_fs_close(service_id_t service_id, fs_node_t *rfn)
 {
+	/*
+	 * Write back the in-memory allocation bitmap, if any, and destroy
+	 * it.
+	 */
+	(void) exfat_bitmap_cache_sync(block_bb_get(service_id), service_id);
+	exfat_bitmap_cache_fini(service_id);
+
 	/*
 	 * Put the root node and force it to the FAT free node list.
 	 */
@@ -1298,6 +1305,12 @@ exfat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 	if (rc != EOK)
 		return rc;
 
+	/*
+	 * Load the allocation bitmap into memory. The cache is only an
+	 * optimization - keep going without it if it cannot be built.
+	 */
+	(void) exfat_bitmap_cache_init(block_bb_get(service_id), service_id);
+
 	*index = ridxp->index;
 	*size = EXFAT_NODE(rfn)->size;
 
@@ -1454,6 +1467,10 @@ static errno_t exfat_sync(service_id_t service_id, fs_index_t index)
 
 	nodep->dirty = true;
 	rc = exfat_node_sync(nodep);
+	if (rc == EOK) {
+		rc = exfat_bitmap_cache_sync(block_bb_get(service_id),
+		    service_id);
+	}
 
 	exfat_node_put(fn);
 	return rc;
@@ -45,6 +45,7 @@
 #include <errno.h>
 #include <byteorder.h>
 #include <align.h>
+#include <adt/list.h>
 #include <assert.h>
 #include <fibril_synch.h>
 #include <mem.h>
@@ -59,6 +60,468 @@
  */
 static FIBRIL_MUTEX_INITIALIZE(fat_alloc_lock);
 
+/*
+ * In-memory FAT image.
+ *
+ * When a file system is mounted with the "memfat" option, the first copy of
+ * the File Allocation Table is loaded into memory as a whole and all cluster
+ * lookups and updates are served from the image, bypassing the block cache.
+ * Updated FAT sectors are remembered in a bitmap and written back to all
+ * copies of the FAT in one batch by fat_fatcache_sync().
+ */
+typedef struct {
+	link_t link;
+	service_id_t service_id;
+	/** Protects the FAT image and the dirty bitmap. */
+	fibril_mutex_t lock;
+	/** In-memory image of the first FAT copy. */
+	uint8_t *fat;
+	/** Number of sectors per FAT copy. */
+	uint32_t sectors;
+	/** Bitmap of dirty FAT sectors. */
+	uint8_t *dirty;
+} fat_fatcache_t;
+
+static LIST_INITIALIZE(fatcache_list);
+static FIBRIL_MUTEX_INITIALIZE(fatcache_lock);
+
+/** Find the in-memory FAT image of a file system instance.
+ *
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		FAT image or NULL if the file system was not mounted
+ *			with the "memfat" option.
+ */
+static fat_fatcache_t *fat_fatcache_find(service_id_t service_id)
+{
+	fat_fatcache_t *cache = NULL;
+
+	fibril_mutex_lock(&fatcache_lock);
+	list_foreach(fatcache_list, link, fat_fatcache_t, cur) {
+		if (cur->service_id == service_id) {
+			cache = cur;
+			break;
+		}
+	}
+	fibril_mutex_unlock(&fatcache_lock);
+
+	return cache;
+}
+
+/** Mark the FAT sectors spanned by a byte range as dirty.
+ *
+ * The caller must hold the image lock.
+ */
+static void fat_fatcache_mark_dirty(fat_bs_t *bs, fat_fatcache_t *cache,
+    aoff64_t offset, size_t size)
+{
+	aoff64_t sec;
+
+	for (sec = offset / BPS(bs); sec <= (offset + size - 1) / BPS(bs);
+	    sec++)
+		cache->dirty[sec / 8] |= 1 << (sec % 8);
+}
+
+/** Get cluster value from the in-memory FAT image.
+ *
+ * @param bs		Buffer holding the boot sector for the file system.
+ * @param cache		In-memory FAT image.
+ * @param clst		Cluster which to get.
+ * @param value		Output argument holding the value of the cluster.
+ *
+ * @return		EOK or an error code.
+ */
+static errno_t
+fat_fatcache_get_cluster(fat_bs_t *bs, fat_fatcache_t *cache,
+    fat_cluster_t clst, fat_cluster_t *value)
+{
+	aoff64_t offset;
+
+	if (FAT_IS_FAT12(bs)) {
+		offset = (clst + clst / 2);
+		if (offset + 1 >= (aoff64_t) SF(bs) * BPS(bs))
+			return ERANGE;
+
+		fibril_mutex_lock(&cache->lock);
+		*value = cache->fat[offset] | (cache->fat[offset + 1] << 8);
+		fibril_mutex_unlock(&cache->lock);
+
+		if (IS_ODD(clst))
+			*value = (*value) >> 4;
+		else
+			*value = (*value) & FAT12_MASK;
+	} else if (FAT_IS_FAT16(bs)) {
+		offset = (clst * FAT16_CLST_SIZE);
+
+		fibril_mutex_lock(&cache->lock);
+		*value = uint16_t_le2host(*(uint16_t *)(cache->fat + offset));
+		fibril_mutex_unlock(&cache->lock);
+	} else {
+		offset = (clst * FAT32_CLST_SIZE);
+
+		fibril_mutex_lock(&cache->lock);
+		*value = uint32_t_le2host(*(uint32_t *)(cache->fat + offset)) &
+		    FAT32_MASK;
+		fibril_mutex_unlock(&cache->lock);
+	}
+
+	return EOK;
+}
+
+/** Set cluster value in the in-memory FAT image.
+ *
+ * @param bs		Buffer holding the boot sector for the file system.
+ * @param cache		In-memory FAT image.
+ * @param clst		Cluster which is to be set.
+ * @param value		Value to set the cluster with.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t
+fat_fatcache_set_cluster(fat_bs_t *bs, fat_fatcache_t *cache,
+    fat_cluster_t clst, fat_cluster_t value)
+{
+	aoff64_t offset;
+	uint16_t byte1, byte2;
+	fat_cluster_t temp;
+
+	if (FAT_IS_FAT12(bs)) {
+		offset = (clst + clst / 2);
+		if (offset + 1 >= (aoff64_t) SF(bs) * BPS(bs))
+			return ERANGE;
+
+		fibril_mutex_lock(&cache->lock);
+		byte1 = cache->fat[offset];
+		byte2 = cache->fat[offset + 1];
+
+		if (IS_ODD(clst)) {
+			byte1 &= 0x0f;
+			byte2 = 0;
+			value = (value << 4);
+		} else {
+			byte1 = 0;
+			byte2 &= 0xf0;
+			value &= FAT12_MASK;
+		}
+
+		cache->fat[offset] = byte1 | (value & 0xff);
+		cache->fat[offset + 1] = byte2 | (value >> 8);
+
+		fat_fatcache_mark_dirty(bs, cache, offset, 2);
+		fibril_mutex_unlock(&cache->lock);
+	} else if (FAT_IS_FAT16(bs)) {
+		offset = (clst * FAT16_CLST_SIZE);
+
+		fibril_mutex_lock(&cache->lock);
+		*(uint16_t *)(cache->fat + offset) = host2uint16_t_le(value);
+		fat_fatcache_mark_dirty(bs, cache, offset, FAT16_CLST_SIZE);
+		fibril_mutex_unlock(&cache->lock);
+	} else {
+		offset = (clst * FAT32_CLST_SIZE);
+
+		fibril_mutex_lock(&cache->lock);
+		temp = uint32_t_le2host(*(uint32_t *)(cache->fat + offset));
+		temp &= 0xf0000000;
+		temp |= (value & FAT32_MASK);
+		*(uint32_t *)(cache->fat + offset) = host2uint32_t_le(temp);
+		fat_fatcache_mark_dirty(bs, cache, offset, FAT32_CLST_SIZE);
+		fibril_mutex_unlock(&cache->lock);
+	}
+
+	return EOK;
+}
+
+/** Load the entire FAT into memory.
+ *
+ * Only the first FAT copy is read. The shadow copies are updated from the
+ * image during writeback.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t fat_fatcache_init(fat_bs_t *bs, service_id_t service_id)
+{
+	fat_fatcache_t *cache;
+	block_t *b;
+	uint32_t sec;
+	errno_t rc;
+
+	cache = malloc(sizeof(fat_fatcache_t));
+	if (!cache)
+		return ENOMEM;
+
+	link_initialize(&cache->link);
+	cache->service_id = service_id;
+	fibril_mutex_initialize(&cache->lock);
+	cache->sectors = SF(bs);
+
+	cache->fat = malloc(cache->sectors * BPS(bs));
+	if (!cache->fat) {
+		free(cache);
+		return ENOMEM;
+	}
+
+	cache->dirty = calloc((cache->sectors + 7) / 8, 1);
+	if (!cache->dirty) {
+		free(cache->fat);
+		free(cache);
+		return ENOMEM;
+	}
+
+	for (sec = 0; sec < cache->sectors; sec++) {
+		rc = block_get(&b, service_id, RSCNT(bs) + sec,
+		    BLOCK_FLAGS_NONE);
+		if (rc != EOK)
+			goto error;
+		memcpy(cache->fat + sec * BPS(bs), b->data, BPS(bs));
+		rc = block_put(b);
+		if (rc != EOK)
+			goto error;
+	}
+
+	fibril_mutex_lock(&fatcache_lock);
+	list_append(&cache->link, &fatcache_list);
+	fibril_mutex_unlock(&fatcache_lock);
+
+	return EOK;
+
+error:
+	free(cache->dirty);
+	free(cache->fat);
+	free(cache);
+	return rc;
+}
+
+/** Write back dirty sectors of the in-memory FAT image.
+ *
+ * Each dirty sector is mirrored to every copy of the FAT in a single pass.
+ * A no-op for file systems mounted without the "memfat" option.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t fat_fatcache_sync(fat_bs_t *bs, service_id_t service_id)
+{
+	fat_fatcache_t *cache;
+	block_t *b;
+	uint32_t sec;
+	uint8_t fatno;
+	errno_t rc;
+
+	cache = fat_fatcache_find(service_id);
+	if (!cache)
+		return EOK;
+
+	fibril_mutex_lock(&cache->lock);
+	for (sec = 0; sec < cache->sectors; sec++) {
+		if (!(cache->dirty[sec / 8] & (1 << (sec % 8))))
+			continue;
+
+		for (fatno = FAT1; fatno < FATCNT(bs); fatno++) {
+			rc = block_get(&b, service_id, RSCNT(bs) +
+			    SF(bs) * fatno + sec, BLOCK_FLAGS_NOREAD);
+			if (rc != EOK) {
+				fibril_mutex_unlock(&cache->lock);
+				return rc;
+			}
+
+			memcpy(b->data, cache->fat + sec * BPS(bs), BPS(bs));
+
+			b->dirty = true;	/* need to sync block */
+			rc = block_put(b);
+			if (rc != EOK) {
+				fibril_mutex_unlock(&cache->lock);
+				return rc;
+			}
+		}
+
+		cache->dirty[sec / 8] &= ~(1 << (sec % 8));
+	}
+	fibril_mutex_unlock(&cache->lock);
+
+	return EOK;
+}
+
+/** Destroy the in-memory FAT image of a file system instance.
+ *
+ * The caller is responsible for writing the image back first.
+ *
+ * @param service_id	Service ID of the file system.
+ */
+void fat_fatcache_fini(service_id_t service_id)
+{
+	fat_fatcache_t *cache;
+
+	cache = fat_fatcache_find(service_id);
+	if (!cache)
+		return;
+
+	fibril_mutex_lock(&fatcache_lock);
+	list_remove(&cache->link);
+	fibril_mutex_unlock(&fatcache_lock);
+
+	free(cache->dirty);
+	free(cache->fat);
+	free(cache);
+}
+
+/*
+ * Free-cluster summary.
+ *
+ * The cluster space of each mounted file system is divided into fixed-size
+ * regions and the number of free clusters in each region is maintained on
+ * every allocation and deallocation. The allocator uses the counts to skip
+ * regions without any free cluster and a next-free hint to resume the search
+ * where the previous one ended, instead of rescanning the FAT from the start
+ * on every allocation.
+ */
+
+#define FAT_SUMMARY_REGION	4096
+
+typedef struct {
+	link_t link;
+	service_id_t service_id;
+	/** Protects the region counts and the next-free hint. */
+	fibril_mutex_t lock;
+	/** Number of free clusters per region. */
+	uint32_t *counts;
+	/** Number of regions. */
+	uint32_t nregions;
+	/** Cluster where to start the next free-cluster search. */
+	fat_cluster_t next_free;
+} fat_summary_t;
+
+static LIST_INITIALIZE(summary_list);
+static FIBRIL_MUTEX_INITIALIZE(summary_lock);
+
+/** Find the free-cluster summary of a file system instance.
+ *
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		Summary or NULL if none was created.
+ */
+static fat_summary_t *fat_summary_find(service_id_t service_id)
+{
+	fat_summary_t *summary = NULL;
+
+	fibril_mutex_lock(&summary_lock);
+	list_foreach(summary_list, link, fat_summary_t, cur) {
+		if (cur->service_id == service_id) {
+			summary = cur;
+			break;
+		}
+	}
+	fibril_mutex_unlock(&summary_lock);
+
+	return summary;
+}
+
+/** Account an allocated cluster in the free-cluster summary. */
+static void fat_summary_alloc(fat_summary_t *summary, fat_cluster_t clst)
+{
+	if (summary == NULL)
+		return;
+
+	fibril_mutex_lock(&summary->lock);
+	assert(summary->counts[(clst - FAT_CLST_FIRST) /
+	    FAT_SUMMARY_REGION] > 0);
+	summary->counts[(clst - FAT_CLST_FIRST) / FAT_SUMMARY_REGION]--;
+	fibril_mutex_unlock(&summary->lock);
+}
+
+/** Account a freed cluster in the free-cluster summary. */
+static void fat_summary_free(fat_summary_t *summary, fat_cluster_t clst)
+{
+	if (summary == NULL)
+		return;
+
+	fibril_mutex_lock(&summary->lock);
+	summary->counts[(clst - FAT_CLST_FIRST) / FAT_SUMMARY_REGION]++;
+	/* Keep the allocation low and compact. */
+	if (clst < summary->next_free)
+		summary->next_free = clst;
+	fibril_mutex_unlock(&summary->lock);
+}
+
+/** Build the free-cluster summary of a file system instance.
+ *
+ * Scans the first FAT copy once during mount. The summary is kept up to date
+ * by the allocator afterwards.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t fat_summary_init(fat_bs_t *bs, service_id_t service_id)
+{
+	fat_summary_t *summary;
+	fat_cluster_t clst;
+	fat_cluster_t value = 0;
+	errno_t rc;
+
+	summary = malloc(sizeof(fat_summary_t));
+	if (!summary)
+		return ENOMEM;
+
+	link_initialize(&summary->link);
+	summary->service_id = service_id;
+	fibril_mutex_initialize(&summary->lock);
+	summary->nregions = (CC(bs) + FAT_SUMMARY_REGION - 1) /
+	    FAT_SUMMARY_REGION;
+	summary->next_free = FAT_CLST_FIRST;
+
+	summary->counts = calloc(summary->nregions, sizeof(uint32_t));
+	if (!summary->counts) {
+		free(summary);
+		return ENOMEM;
+	}
+
+	for (clst = FAT_CLST_FIRST; clst < CC(bs) + 2; clst++) {
+		rc = fat_get_cluster(bs, service_id, FAT1, clst, &value);
+		if (rc != EOK) {
+			free(summary->counts);
+			free(summary);
+			return rc;
+		}
+
+		if (value == FAT_CLST_RES0) {
+			summary->counts[(clst - FAT_CLST_FIRST) /
+			    FAT_SUMMARY_REGION]++;
+		}
+	}
+
+	fibril_mutex_lock(&summary_lock);
+	list_append(&summary->link, &summary_list);
+	fibril_mutex_unlock(&summary_lock);
+
+	return EOK;
+}
+
+/** Destroy the free-cluster summary of a file system instance.
+ *
+ * @param service_id	Service ID of the file system.
+ */
+void fat_summary_fini(service_id_t service_id)
+{
+	fat_summary_t *summary;
+
+	summary = fat_summary_find(service_id);
+	if (!summary)
+		return;
+
+	fibril_mutex_lock(&summary_lock);
+	list_remove(&summary->link);
+	fibril_mutex_unlock(&summary_lock);
+
+	free(summary->counts);
+	free(summary);
+}
+
 /** Walk the cluster chain.
  *
  * @param bs		Buffer holding the boot sector for the file.
@@ -425,10 +888,19 @@ errno_t
 fat_get_cluster(fat_bs_t *bs, service_id_t service_id, unsigned fatno,
     fat_cluster_t clst, fat_cluster_t *value)
 {
+	fat_fatcache_t *cache;
 	errno_t rc;
 
 	assert(fatno < FATCNT(bs));
 
+	/*
+	 * All FAT copies are mirrored in the in-memory image, so the image
+	 * serves lookups regardless of fatno.
+	 */
+	cache = fat_fatcache_find(service_id);
+	if (cache != NULL)
+		return fat_fatcache_get_cluster(bs, cache, clst, value);
+
 	if (FAT_IS_FAT12(bs))
 		rc = fat_get_cluster_fat12(bs, service_id, fatno, clst, value);
 	else if (FAT_IS_FAT16(bs))
@@ -611,10 +1083,20 @@ errno_t
 fat_set_cluster(fat_bs_t *bs, service_id_t service_id, unsigned fatno,
     fat_cluster_t clst, fat_cluster_t value)
 {
+	fat_fatcache_t *cache;
 	errno_t rc;
 
 	assert(fatno < FATCNT(bs));
 
+	/*
+	 * The image stands for all FAT copies. Updating it repeatedly for
+	 * each shadow copy is idempotent and the writeback mirrors the
+	 * change to every copy.
+	 */
+	cache = fat_fatcache_find(service_id);
+	if (cache != NULL)
+		return fat_fatcache_set_cluster(bs, cache, clst, value);
+
 	if (FAT_IS_FAT12(bs))
 		rc = fat_set_cluster_fat12(bs, service_id, fatno, clst, value);
 	else if (FAT_IS_FAT16(bs))
@@ -677,7 +1159,9 @@ fat_alloc_clusters(fat_bs_t *bs, service_id_t service_id, unsigned nclsts,
 {
 	fat_cluster_t *lifo;    /* stack for storing free cluster numbers */
 	unsigned found = 0;     /* top of the free cluster number stack */
-	fat_cluster_t clst;
+	fat_summary_t *summary;
+	fat_cluster_t total = CC(bs) + 2;
+	fat_cluster_t clst, visited;
 	fat_cluster_t value = 0;
 	fat_cluster_t clst_last1 = FAT_CLST_LAST1(bs);
 	errno_t rc = EOK;
@@ -687,11 +1171,33 @@ fat_alloc_clusters(fat_bs_t *bs, service_id_t service_id, unsigned nclsts,
 		return ENOMEM;
 
 	/*
-	 * Search FAT1 for unused clusters.
+	 * Search FAT1 for unused clusters. Start at the next-free hint and
+	 * wrap around, skipping regions without any free cluster.
 	 */
 	fibril_mutex_lock(&fat_alloc_lock);
-	for (clst = FAT_CLST_FIRST; clst < CC(bs) + 2 && found < nclsts;
-	    clst++) {
+	summary = fat_summary_find(service_id);
+
+	clst = FAT_CLST_FIRST;
+	if (summary != NULL && summary->next_free < total)
+		clst = summary->next_free;
+
+	for (visited = 0; visited < total - FAT_CLST_FIRST &&
+	    found < nclsts; ) {
+		if (summary != NULL && summary->counts[(clst -
+		    FAT_CLST_FIRST) / FAT_SUMMARY_REGION] == 0) {
+			/* The whole region is full. Skip to the next one. */
+			fat_cluster_t skip = FAT_SUMMARY_REGION -
+			    (clst - FAT_CLST_FIRST) % FAT_SUMMARY_REGION;
+			if (skip > total - clst)
+				skip = total - clst;
+
+			visited += skip;
+			clst += skip;
+			if (clst >= total)
+				clst = FAT_CLST_FIRST;
+			continue;
+		}
+
 		rc = fat_get_cluster(bs, service_id, FAT1, clst, &value);
 		if (rc != EOK)
 			break;
@@ -707,11 +1213,23 @@ fat_alloc_clusters(fat_bs_t *bs, service_id_t service_id, unsigned nclsts,
 			if (rc != EOK)
 				break;
 
+			fat_summary_alloc(summary, clst);
 			found++;
 		}
+
+		visited++;
+		clst++;
+		if (clst >= total)
+			clst = FAT_CLST_FIRST;
 	}
 
 	if (rc == EOK && found == nclsts) {
+		if (summary != NULL) {
+			/* Resume the next search where this one ended. */
+			fibril_mutex_lock(&summary->lock);
+			summary->next_free = clst;
+			fibril_mutex_unlock(&summary->lock);
+		}
 		rc = fat_alloc_shadow_clusters(bs, service_id, lifo, nclsts);
 		if (rc == EOK) {
 			*mcl = lifo[found - 1];
@@ -726,6 +1244,7 @@ fat_alloc_clusters(fat_bs_t *bs, service_id_t service_id, unsigned nclsts,
 	while (found--) {
 		(void) fat_set_cluster(bs, service_id, FAT1, lifo[found],
 		    FAT_CLST_RES0);
+		fat_summary_free(summary, lifo[found]);
 	}
 
 	free(lifo);
@@ -746,10 +1265,13 @@ errno_t
 fat_free_clusters(fat_bs_t *bs, service_id_t service_id, fat_cluster_t firstc)
 {
 	unsigned fatno;
+	fat_summary_t *summary;
 	fat_cluster_t nextc = 0;
 	fat_cluster_t clst_bad = FAT_CLST_BAD(bs);
 	errno_t rc;
 
+	summary = fat_summary_find(service_id);
+
 	/* Mark all clusters in the chain as free in all copies of FAT. */
 	while (firstc < FAT_CLST_LAST1(bs)) {
 		assert(firstc >= FAT_CLST_FIRST && firstc < clst_bad);
@@ -765,6 +1287,12 @@ fat_free_clusters(fat_bs_t *bs, service_id_t service_id, fat_cluster_t firstc)
 				return rc;
 		}
 
+		fat_summary_free(summary, firstc);
+
+		/* The data of the freed cluster is no longer needed. */
+		(void) block_discard(service_id, CLBN2PBN(bs, firstc, 0),
+		    SPC(bs));
+
 		firstc = nextc;
 	}
 
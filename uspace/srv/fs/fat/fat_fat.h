@@ -132,6 +132,11 @@ extern errno_t fat_fill_gap(struct fat_bs *, struct fat_node *, fat_cluster_t,
     aoff64_t);
 extern errno_t fat_zero_cluster(struct fat_bs *, service_id_t, fat_cluster_t);
 extern errno_t fat_sanity_check(struct fat_bs *, service_id_t);
+extern errno_t fat_fatcache_init(struct fat_bs *, service_id_t);
+extern errno_t fat_fatcache_sync(struct fat_bs *, service_id_t);
+extern void fat_fatcache_fini(service_id_t);
+extern errno_t fat_summary_init(struct fat_bs *, service_id_t);
+extern void fat_summary_fini(service_id_t);
 
 #endif
 
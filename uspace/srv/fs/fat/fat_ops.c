@@ -1079,6 +1079,7 @@ fat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
     aoff64_t *size)
 {
 	enum cache_mode cmode = CACHE_MODE_WB;
+	bool memfat = false;
 	fat_instance_t *instance;
 	fat_idx_t *ridxp;
 	fs_node_t *rfn;
@@ -1097,6 +1098,8 @@ fat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 			cmode = CACHE_MODE_WT;
 		else if (str_cmp(opt, "nolfn") == 0)
 			instance->lfn_enabled = false;
+		else if (str_cmp(opt, "memfat") == 0)
+			memfat = true;
 	}
 
 	rc = fat_fs_open(service_id, cmode, &rfn, &ridxp);
@@ -1105,6 +1108,25 @@ fat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 		return rc;
 	}
 
+	if (memfat) {
+		/* Load the entire FAT into memory. */
+		rc = fat_fatcache_init(block_bb_get(service_id), service_id);
+		if (rc != EOK) {
+			fat_fs_close(service_id, rfn);
+			free(instance);
+			return rc;
+		}
+	}
+
+	/* Build the free-cluster summary for the allocator. */
+	rc = fat_summary_init(block_bb_get(service_id), service_id);
+	if (rc != EOK) {
+		fat_fatcache_fini(service_id);
+		fat_fs_close(service_id, rfn);
+		free(instance);
+		return rc;
+	}
+
 	fibril_mutex_lock(&ridxp->lock);
 
 	rc = fs_instance_create(service_id, instance);
@@ -1177,6 +1199,15 @@ static errno_t fat_unmounted(service_id_t service_id)
 		return EBUSY;
 	}
 
+	/*
+	 * Write back the in-memory FAT image, if any.
+	 */
+	rc = fat_fatcache_sync(bs, service_id);
+	if (rc != EOK) {
+		(void) fat_node_put(fn);
+		return rc;
+	}
+
 	if (FAT_IS_FAT32(bs)) {
 		/*
 		 * Attempt to update the FAT32 FS info.
@@ -1195,6 +1226,8 @@ static errno_t fat_unmounted(service_id_t service_id)
 	 * stop using libblock for this instance.
 	 */
 	(void) fat_node_fini_by_service_id(service_id);
+	fat_summary_fini(service_id);
+	fat_fatcache_fini(service_id);
 	fat_fs_close(service_id, fn);
 
 	void *data;
@@ -1553,6 +1586,10 @@ static errno_t fat_sync(service_id_t service_id, fs_index_t index)
 
 	nodep->dirty = true;
 	rc = fat_node_sync(nodep);
+	if (rc == EOK) {
+		rc = fat_fatcache_sync(block_bb_get(service_id),
+		    service_id);
+	}
 
 	fat_node_put(fn);
 	return rc;
@@ -151,9 +151,26 @@ struct mfs_dentry_info {
 	struct mfs_node *node;
 };
 
+/* In-memory mirror of an on-disk allocation bitmap */
+struct mfs_bmap_cache {
+	/* Copy of the bitmap, kept in on-disk byte order */
+	bitchunk_t *bmap;
+	/* Number of free bits in each bitmap block */
+	uint32_t *free_count;
+	/* Marks the bitmap blocks modified since the last writeback */
+	bool *dirty;
+	unsigned long nblocks;
+};
+
 struct mfs_instance {
 	service_id_t service_id;
 	struct mfs_sb_info *sbi;
+	/*
+	 * In-memory mirrors of the zone and the inode bitmaps,
+	 * indexed by bmap_id_t.  NULL if the mirror could not
+	 * be allocated at mount time.
+	 */
+	struct mfs_bmap_cache *bmap_cache[2];
 	unsigned open_nodes_cnt;
 };
 
@@ -228,6 +245,15 @@ mfs_count_free_zones(struct mfs_instance *inst, uint32_t *zones);
 extern errno_t
 mfs_count_free_inodes(struct mfs_instance *inst, uint32_t *inodes);
 
+extern errno_t
+mfs_bmap_cache_init(struct mfs_instance *inst);
+
+extern errno_t
+mfs_bmap_cache_sync(struct mfs_instance *inst);
+
+extern void
+mfs_bmap_cache_fini(struct mfs_instance *inst);
+
 /* mfs_utils.c */
 extern uint16_t
 conv16(bool native, uint16_t n);
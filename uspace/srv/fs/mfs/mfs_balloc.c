@@ -46,6 +46,9 @@ mfs_alloc_bit(struct mfs_instance *inst, uint32_t *idx, bmap_id_t bid);
 static errno_t
 mfs_count_free_bits(struct mfs_instance *inst, bmap_id_t bid, uint32_t *free);
 
+static errno_t
+mfs_bmap_cache_load(struct mfs_instance *inst, bmap_id_t bid);
+
 /**Allocate a new inode.
  *
  * @param inst		Pointer to the filesystem instance.
@@ -175,6 +178,16 @@ mfs_count_free_bits(struct mfs_instance *inst, bmap_id_t bid, uint32_t *free)
 	size_t const bitchunk_bits = sizeof(bitchunk_t) * 8;
 	block_t *b;
 	struct mfs_sb_info *sbi = inst->sbi;
+	struct mfs_bmap_cache *cache = inst->bmap_cache[bid];
+
+	if (cache) {
+		/* Sum the per-block counters of the in-memory mirror */
+		for (block = 0; block < cache->nblocks; ++block)
+			free_bits += cache->free_count[block];
+
+		*free = free_bits;
+		return EOK;
+	}
 
 	start_block = MFS_BMAP_START_BLOCK(sbi, bid);
 	nblocks = MFS_BMAP_SIZE_BLOCKS(sbi, bid);
@@ -218,6 +231,185 @@ mfs_count_free_bits(struct mfs_instance *inst, bmap_id_t bid, uint32_t *free)
 	return EOK;
 }
 
+/** Load one of the on-disk bitmaps in memory.
+ *
+ * @param inst		Pointer to the filesystem instance.
+ * @param bid		Type of the bitmap (inode or zone).
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t
+mfs_bmap_cache_load(struct mfs_instance *inst, bmap_id_t bid)
+{
+	struct mfs_sb_info *sbi = inst->sbi;
+	struct mfs_bmap_cache *cache;
+	unsigned start_block;
+	unsigned long nblocks;
+	unsigned long nbits;
+	unsigned long block;
+	bitchunk_t chunk;
+	size_t const bitchunk_bits = sizeof(bitchunk_t) * 8;
+	block_t *b;
+	errno_t r;
+
+	start_block = MFS_BMAP_START_BLOCK(sbi, bid);
+	nblocks = MFS_BMAP_SIZE_BLOCKS(sbi, bid);
+	nbits = MFS_BMAP_SIZE_BITS(sbi, bid);
+
+	cache = malloc(sizeof(*cache));
+	if (!cache)
+		return ENOMEM;
+
+	cache->nblocks = nblocks;
+	cache->bmap = malloc(nblocks * sbi->block_size);
+	cache->free_count = malloc(nblocks * sizeof(uint32_t));
+	cache->dirty = calloc(nblocks, sizeof(bool));
+	if (!cache->bmap || !cache->free_count || !cache->dirty) {
+		r = ENOMEM;
+		goto out_err;
+	}
+
+	for (block = 0; block < nblocks; ++block) {
+		r = block_get(&b, inst->service_id, block + start_block,
+		    BLOCK_FLAGS_NONE);
+		if (r != EOK)
+			goto out_err;
+
+		bitchunk_t *data = (bitchunk_t *) ((uint8_t *) cache->bmap +
+		    block * sbi->block_size);
+		memcpy(data, b->data, sbi->block_size);
+
+		r = block_put(b);
+		if (r != EOK)
+			goto out_err;
+
+		/*
+		 * Compute the per-block counter of free bits, leaving
+		 * out the padding bits past the end of the bitmap.
+		 */
+		uint32_t free_bits = 0;
+		size_t i;
+
+		for (i = 0; i < sbi->block_size / sizeof(bitchunk_t); ++i) {
+			chunk = conv32(sbi->native, data[i]);
+
+			size_t bit;
+			for (bit = 0; bit < bitchunk_bits && nbits > 0;
+			    ++bit, --nbits) {
+				if (!(chunk & (1 << bit)))
+					free_bits++;
+			}
+
+			if (nbits == 0)
+				break;
+		}
+
+		cache->free_count[block] = free_bits;
+	}
+
+	inst->bmap_cache[bid] = cache;
+	return EOK;
+
+out_err:
+	free(cache->bmap);
+	free(cache->free_count);
+	free(cache->dirty);
+	free(cache);
+	return r;
+}
+
+/** Load the zone and the inode bitmaps in memory.
+ *
+ * @param inst		Pointer to the filesystem instance.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t
+mfs_bmap_cache_init(struct mfs_instance *inst)
+{
+	errno_t r;
+
+	r = mfs_bmap_cache_load(inst, BMAP_INODE);
+	if (r != EOK)
+		return r;
+
+	r = mfs_bmap_cache_load(inst, BMAP_ZONE);
+	if (r != EOK) {
+		mfs_bmap_cache_fini(inst);
+		return r;
+	}
+
+	return EOK;
+}
+
+/** Write the modified blocks of the in-memory bitmaps back to disk.
+ *
+ * @param inst		Pointer to the filesystem instance.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t
+mfs_bmap_cache_sync(struct mfs_instance *inst)
+{
+	struct mfs_sb_info *sbi = inst->sbi;
+	bmap_id_t bid;
+	errno_t r;
+
+	for (bid = BMAP_ZONE; bid <= BMAP_INODE; ++bid) {
+		struct mfs_bmap_cache *cache = inst->bmap_cache[bid];
+		if (!cache)
+			continue;
+
+		unsigned start_block = MFS_BMAP_START_BLOCK(sbi, bid);
+		unsigned long block;
+		block_t *b;
+
+		for (block = 0; block < cache->nblocks; ++block) {
+			if (!cache->dirty[block])
+				continue;
+
+			r = block_get(&b, inst->service_id,
+			    block + start_block, BLOCK_FLAGS_NOREAD);
+			if (r != EOK)
+				return r;
+
+			memcpy(b->data, (uint8_t *) cache->bmap +
+			    block * sbi->block_size, sbi->block_size);
+			b->dirty = true;
+
+			r = block_put(b);
+			if (r != EOK)
+				return r;
+
+			cache->dirty[block] = false;
+		}
+	}
+
+	return EOK;
+}
+
+/** Destroy the in-memory bitmaps.
+ *
+ * @param inst		Pointer to the filesystem instance.
+ */
+void
+mfs_bmap_cache_fini(struct mfs_instance *inst)
+{
+	bmap_id_t bid;
+
+	for (bid = BMAP_ZONE; bid <= BMAP_INODE; ++bid) {
+		struct mfs_bmap_cache *cache = inst->bmap_cache[bid];
+		if (!cache)
+			continue;
+
+		free(cache->bmap);
+		free(cache->free_count);
+		free(cache->dirty);
+		free(cache);
+		inst->bmap_cache[bid] = NULL;
+	}
+}
+
 /**Clear a bit in a bitmap.
  *
  * @param inst		Pointer to the filesystem instance.
@@ -257,6 +449,26 @@ mfs_free_bit(struct mfs_instance *inst, uint32_t idx, bmap_id_t bid)
 		}
 	}
 
+	struct mfs_bmap_cache *cache = inst->bmap_cache[bid];
+	if (cache) {
+		/* Clear the bit in the in-memory mirror */
+		const size_t chunk_bits = sizeof(bitchunk_t) * 8;
+		uint32_t block = idx / (sbi->block_size * 8);
+		bitchunk_t chunk;
+
+		chunk = conv32(sbi->native, cache->bmap[idx / chunk_bits]);
+		chunk &= ~(1 << (idx % chunk_bits));
+		cache->bmap[idx / chunk_bits] = conv32(sbi->native, chunk);
+
+		cache->free_count[block]++;
+		cache->dirty[block] = true;
+
+		if (*search > idx)
+			*search = idx;
+
+		return EOK;
+	}
+
 	/* Compute the bitmap block */
 	uint32_t block = idx / (sbi->block_size * 8) + start_block;
 
@@ -319,6 +531,59 @@ mfs_alloc_bit(struct mfs_instance *inst, uint32_t *idx, bmap_id_t bid)
 	}
 	bits_per_block = sbi->block_size * 8;
 
+	struct mfs_bmap_cache *cache = inst->bmap_cache[bid];
+	if (cache) {
+		/* Search the in-memory mirror instead of the disk blocks */
+		const size_t chunk_bits = sizeof(bitchunk_t) * 8;
+		bitchunk_t *bp;
+
+retry_cache:
+		for (i = *search / bits_per_block; i < nblocks; ++i) {
+			if (cache->free_count[i] == 0) {
+				/* The block has no free bits, skip it */
+				continue;
+			}
+
+			bp = cache->bmap +
+			    i * (sbi->block_size / sizeof(bitchunk_t));
+
+			unsigned tmp = *search % bits_per_block;
+
+			freebit = find_free_bit_and_set(bp, sbi->block_size,
+			    sbi->native, tmp);
+			if (freebit == -1) {
+				/* No free bit in this block */
+				continue;
+			}
+
+			/* Free bit found in this block, compute the real index */
+			*idx = freebit + bits_per_block * i;
+			if (*idx > limit) {
+				/* Index is beyond the limit, it is invalid */
+				bitchunk_t chunk = conv32(sbi->native,
+				    bp[freebit / chunk_bits]);
+				chunk &= ~(1 << (freebit % chunk_bits));
+				bp[freebit / chunk_bits] = conv32(sbi->native,
+				    chunk);
+				break;
+			}
+
+			cache->free_count[i]--;
+			cache->dirty[i] = true;
+			*search = *idx;
+			return EOK;
+		}
+
+		if (*search > 0) {
+			/* Repeat the search from the first bitmap block */
+			*search = 0;
+			goto retry_cache;
+		}
+
+		/* Free bit not found, return error */
+		return ENOSPC;
+	}
+
 	block_t *b;
 
 retry:
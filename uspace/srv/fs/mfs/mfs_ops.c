@@ -335,6 +335,8 @@ mfs_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 	/* Initialize the instance structure and remember it */
 	instance->service_id = service_id;
 	instance->sbi = sbi;
+	instance->bmap_cache[BMAP_ZONE] = NULL;
+	instance->bmap_cache[BMAP_INODE] = NULL;
 	instance->open_nodes_cnt = 0;
 	rc = fs_instance_create(service_id, instance);
 	if (rc != EOK) {
@@ -343,6 +345,13 @@ mfs_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 		goto out_error;
 	}
 
+	/*
+	 * Load the allocation bitmaps in memory.  The mirrors are only
+	 * an optimization, so on failure we fall back to the on-disk
+	 * bitmaps.
+	 */
+	(void) mfs_bmap_cache_init(instance);
+
 	mfsdebug("mount successful\n");
 
 	fs_node_t *fn;
@@ -378,6 +387,11 @@ mfs_unmounted(service_id_t service_id)
 	if (inst->open_nodes_cnt != 0)
 		return EBUSY;
 
+	r = mfs_bmap_cache_sync(inst);
+	if (r != EOK)
+		return r;
+	mfs_bmap_cache_fini(inst);
+
 	(void) block_cache_fini(service_id);
 	block_fini(service_id);
 
@@ -1169,8 +1183,13 @@ mfs_sync(service_id_t service_id, fs_index_t index)
 
 	struct mfs_node *mnode = fn->data;
 	mnode->ino_i->dirty = true;
+	struct mfs_instance *inst = mnode->instance;
 
-	return mfs_node_put(fn);
+	rc = mfs_node_put(fn);
+	if (rc == EOK)
+		rc = mfs_bmap_cache_sync(inst);
+
+	return rc;
 }
 
 /** Check if a given number is a power of two.
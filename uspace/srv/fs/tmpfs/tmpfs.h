@@ -64,7 +64,9 @@ typedef struct tmpfs_node {
 	tmpfs_dentry_type_t type;
 	unsigned lnkcnt;	/**< Link count. */
 	size_t size;		/**< File size if type is TMPFS_FILE. */
-	void *data;		/**< File content's if type is TMPFS_FILE. */
+	void **blocks;		/**< Table of data blocks if type is
+				     TMPFS_FILE. NULL entries are holes. */
+	size_t nblocks;		/**< Number of slots in the block table. */
 	list_t cs_list;		/**< Child's siblings list. */
 } tmpfs_node_t;
 
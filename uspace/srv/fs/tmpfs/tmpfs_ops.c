@@ -55,6 +55,12 @@
 /** All root nodes have index 0. */
 #define TMPFS_SOME_ROOT  0
 
+/** Size of a file data block. */
+#define TMPFS_BLOCK_SIZE  4096
+
+/** Backing store for reading file holes. */
+static const uint8_t tmpfs_zero_block[TMPFS_BLOCK_SIZE];
+
 /** Global counter for assigning node indices. Shared by all instances. */
 fs_index_t tmpfs_next_index = 1;
 
@@ -179,9 +185,11 @@ static void nodes_remove_callback(ht_link_t *item)
 		free(dentryp);
 	}
 
-	if (nodep->data) {
+	if (nodep->blocks) {
 		assert(nodep->type == TMPFS_FILE);
-		free(nodep->data);
+		for (size_t i = 0; i < nodep->nblocks; i++)
+			free(nodep->blocks[i]);
+		free(nodep->blocks);
 	}
 	free(nodep->bp);
 	free(nodep);
@@ -204,7 +212,8 @@ static void tmpfs_node_initialize(tmpfs_node_t *nodep)
 	nodep->type = TMPFS_NONE;
 	nodep->lnkcnt = 0;
 	nodep->size = 0;
-	nodep->data = NULL;
+	nodep->blocks = NULL;
+	nodep->nblocks = 0;
 	list_initialize(&nodep->cs_list);
 }
 
@@ -215,6 +224,62 @@ static void tmpfs_dentry_initialize(tmpfs_dentry_t *dentryp)
 	dentryp->node = NULL;
 }
 
+/** Grow the block table of a node to cover the given file size.
+ *
+ * Only the table of block pointers is (re)allocated here. The new slots are
+ * initialized as holes, i.e. they consume no backing memory until written to.
+ *
+ * @param nodep		TMPFS node.
+ * @param size		File size the table needs to cover.
+ *
+ * @return		EOK on success or ENOMEM.
+ */
+static errno_t tmpfs_blocks_grow(tmpfs_node_t *nodep, size_t size)
+{
+	size_t nblocks = (size + TMPFS_BLOCK_SIZE - 1) / TMPFS_BLOCK_SIZE;
+
+	if (nblocks <= nodep->nblocks)
+		return EOK;
+
+	/* Grow the table geometrically to amortize the reallocations. */
+	if (nblocks < 2 * nodep->nblocks)
+		nblocks = 2 * nodep->nblocks;
+
+	void **blocks = realloc(nodep->blocks, nblocks * sizeof(void *));
+	if (!blocks)
+		return ENOMEM;
+
+	for (size_t i = nodep->nblocks; i < nblocks; i++)
+		blocks[i] = NULL;
+
+	nodep->blocks = blocks;
+	nodep->nblocks = nblocks;
+	return EOK;
+}
+
+/** Get the data block covering the given file position, allocating it if
+ * needed.
+ *
+ * The block table must already cover the position. New blocks are
+ * zero-filled.
+ *
+ * @param nodep		TMPFS node.
+ * @param pos		File position.
+ *
+ * @return		Data block or NULL on memory shortage.
+ */
+static void *tmpfs_block_get(tmpfs_node_t *nodep, aoff64_t pos)
+{
+	size_t i = pos / TMPFS_BLOCK_SIZE;
+
+	assert(i < nodep->nblocks);
+
+	if (!nodep->blocks[i])
+		nodep->blocks[i] = calloc(1, TMPFS_BLOCK_SIZE);
+
+	return nodep->blocks[i];
+}
+
 bool tmpfs_init(void)
 {
 	if (!hash_table_create(&nodes, 0, 0, &nodes_ops))
@@ -491,9 +556,19 @@ static errno_t tmpfs_read(service_id_t service_id, fs_index_t index, aoff64_t po
 
 	size_t bytes;
 	if (nodep->type == TMPFS_FILE) {
+		const void *block = tmpfs_zero_block;
+
 		bytes = min(nodep->size - pos, size);
-		(void) async_data_read_finalize(&call, nodep->data + pos,
-		    bytes);
+		if (bytes) {
+			/* Read at most up to the end of the data block. */
+			bytes = min(bytes, TMPFS_BLOCK_SIZE -
+			    pos % TMPFS_BLOCK_SIZE);
+			/* A hole reads as zeros. */
+			if (nodep->blocks[pos / TMPFS_BLOCK_SIZE])
+				block = nodep->blocks[pos / TMPFS_BLOCK_SIZE] +
+				    pos % TMPFS_BLOCK_SIZE;
+		}
+		(void) async_data_read_finalize(&call, block, bytes);
 	} else {
 		tmpfs_dentry_t *dentryp;
 		link_t *lnk;
@@ -553,33 +628,34 @@ tmpfs_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 	}
 
 	/*
-	 * Check whether the file needs to grow.
+	 * Write at most up to the end of the data block covering pos. The
+	 * client will come back for the rest. Only the covering block needs
+	 * backing memory; any gap created by writing beyond the end of the
+	 * file is represented by holes, which read as zeros.
 	 */
-	if (pos + size <= nodep->size) {
-		/* The file size is not changing. */
-		(void) async_data_write_finalize(&call, nodep->data + pos,
-		    size);
-		goto out;
+	size = min(size, TMPFS_BLOCK_SIZE - pos % TMPFS_BLOCK_SIZE);
+
+	if (pos + size > nodep->size) {
+		/* The file needs to grow. */
+		if (tmpfs_blocks_grow(nodep, pos + size) != EOK) {
+			async_answer_0(&call, ENOMEM);
+			size = 0;
+			goto out;
+		}
 	}
-	size_t delta = (pos + size) - nodep->size;
-	/*
-	 * At this point, we are deliberately extremely straightforward and
-	 * simply realloc the contents of the file on every write that grows the
-	 * file. In the end, the situation might not be as bad as it may look:
-	 * our heap allocator can save us and just grow the block whenever
-	 * possible.
-	 */
-	void *newdata = realloc(nodep->data, nodep->size + delta);
-	if (!newdata) {
+
+	void *block = tmpfs_block_get(nodep, pos);
+	if (!block) {
 		async_answer_0(&call, ENOMEM);
 		size = 0;
 		goto out;
 	}
-	/* Clear any newly allocated memory in order to emulate gaps. */
-	memset(newdata + nodep->size, 0, delta);
-	nodep->size += delta;
-	nodep->data = newdata;
-	(void) async_data_write_finalize(&call, nodep->data + pos, size);
+
+	(void) async_data_write_finalize(&call,
+	    block + pos % TMPFS_BLOCK_SIZE, size);
+
+	if (pos + size > nodep->size)
+		nodep->size = pos + size;
 
 out:
 	*wbytes = size;
@@ -609,17 +685,39 @@ static errno_t tmpfs_truncate(service_id_t service_id, fs_index_t index,
 	if (size > SIZE_MAX)
 		return ENOMEM;
 
-	void *newdata = realloc(nodep->data, size);
-	if (!newdata && size)
-		return ENOMEM;
-
 	if (size > nodep->size) {
-		size_t delta = size - nodep->size;
-		memset(newdata + nodep->size, 0, delta);
+		/* The new area is all holes - no backing memory is needed. */
+		errno_t rc = tmpfs_blocks_grow(nodep, size);
+		if (rc != EOK)
+			return rc;
+	} else {
+		/* Free all blocks beyond the new size. */
+		size_t nblocks = (size + TMPFS_BLOCK_SIZE - 1) /
+		    TMPFS_BLOCK_SIZE;
+		for (size_t i = nblocks; i < nodep->nblocks; i++) {
+			free(nodep->blocks[i]);
+			nodep->blocks[i] = NULL;
+		}
+
+		/*
+		 * Zero the truncated tail of the last block so that a later
+		 * extension reads zeros.
+		 */
+		if (size % TMPFS_BLOCK_SIZE != 0 &&
+		    nodep->blocks[size / TMPFS_BLOCK_SIZE]) {
+			memset(nodep->blocks[size / TMPFS_BLOCK_SIZE] +
+			    size % TMPFS_BLOCK_SIZE, 0,
+			    TMPFS_BLOCK_SIZE - size % TMPFS_BLOCK_SIZE);
+		}
+
+		if (!nblocks) {
+			free(nodep->blocks);
+			nodep->blocks = NULL;
+			nodep->nblocks = 0;
+		}
 	}
 
 	nodep->size = size;
-	nodep->data = newdata;
 	return EOK;
 }
 
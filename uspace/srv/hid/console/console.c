@@ -61,6 +61,9 @@
 
 #define UTF8_CHAR_BUFFER_SIZE  (STR_BOUNDS(1) + 1)
 
+/** Number of rows retained in the scrollback buffer */
+#define SCROLLBACK_ROWS  128
+
 typedef struct {
 	atomic_flag refcnt;      /**< Connection reference count */
 	prodcons_t input_pc;  /**< Incoming console events */
@@ -86,6 +89,14 @@ typedef struct {
 
 	chargrid_t *frontbuf;    /**< Front buffer */
 	frontbuf_handle_t fbid;  /**< Front buffer handle */
+
+	chargrid_t *viewbuf;     /**< View buffer for scrollback display */
+	frontbuf_handle_t vbid;  /**< View buffer handle */
+	charfield_t *sback;      /**< Scrollback buffer (ring of rows) */
+	sysarg_t sb_head;        /**< Ring index of next scrollback row */
+	sysarg_t sb_count;       /**< Number of valid scrollback rows */
+	sysarg_t sb_view;        /**< Rows scrolled back (0 = live view) */
+
 	con_srvs_t srvs;         /**< Console service setup */
 } console_t;
 
@@ -197,7 +208,7 @@ static void cons_update(console_t *cons)
 	fibril_mutex_lock(&switch_mtx);
 	fibril_mutex_lock(&cons->mtx);
 
-	if ((active) && (cons == active_console)) {
+	if ((active) && (cons == active_console) && (cons->sb_view == 0)) {
 		output_update(output_sess, cons->fbid);
 		output_cursor_update(output_sess, cons->fbid);
 	}
@@ -211,7 +222,7 @@ static void cons_update_cursor(console_t *cons)
 	fibril_mutex_lock(&switch_mtx);
 	fibril_mutex_lock(&cons->mtx);
 
-	if ((active) && (cons == active_console))
+	if ((active) && (cons == active_console) && (cons->sb_view == 0))
 		output_cursor_update(output_sess, cons->fbid);
 
 	fibril_mutex_unlock(&cons->mtx);
@@ -223,6 +234,9 @@ static void cons_damage(console_t *cons)
 	fibril_mutex_lock(&switch_mtx);
 	fibril_mutex_lock(&cons->mtx);
 
+	/* Leave the scrollback view */
+	cons->sb_view = 0;
+
 	if ((active) && (cons == active_console)) {
 		output_damage(output_sess, cons->fbid, 0, 0, cons->cols,
 		    cons->rows);
@@ -233,6 +247,130 @@ static void cons_damage(console_t *cons)
 	fibril_mutex_unlock(&switch_mtx);
 }
 
+/** Save topmost row to the scrollback ring buffer.
+ *
+ * Called before a character is processed, with @a cons->mtx held.
+ * If processing character @a ch can scroll the grid, the topmost
+ * row (which would be destroyed by the scroll) is copied to the
+ * next scrollback slot. The slot is only advanced when the scroll
+ * actually happens (cons_sback_commit()).
+ *
+ * @param cons Console
+ * @param ch Character about to be processed
+ */
+static void cons_sback_save(console_t *cons, char32_t ch)
+{
+	charfield_t *dst;
+	sysarg_t col, row;
+	sysarg_t x;
+
+	if (cons->sback == NULL)
+		return;
+
+	chargrid_get_cursor(cons->frontbuf, &col, &row);
+	if (row < cons->rows - 1)
+		return;
+
+	if (ch != '\n' && ch != '\t' && col < cons->cols - 1)
+		return;
+
+	dst = cons->sback + cons->sb_head * cons->cols;
+	for (x = 0; x < cons->cols; x++)
+		dst[x] = *chargrid_charfield_at(cons->frontbuf, x, 0);
+}
+
+/** Commit row saved by cons_sback_save() after the grid scrolled.
+ *
+ * Called with @a cons->mtx held.
+ *
+ * @param cons Console
+ */
+static void cons_sback_commit(console_t *cons)
+{
+	if (cons->sback == NULL)
+		return;
+
+	cons->sb_head = (cons->sb_head + 1) % SCROLLBACK_ROWS;
+	if (cons->sb_count < SCROLLBACK_ROWS)
+		cons->sb_count++;
+}
+
+/** Render scrollback view of a console.
+ *
+ * Compose the view buffer from scrollback rows followed by screen
+ * rows and push it to the output. Called with @a switch_mtx and
+ * @a cons->mtx held.
+ *
+ * @param cons Console
+ */
+static void cons_view_render(console_t *cons)
+{
+	charfield_t *dst;
+	sysarg_t sbrow;
+	sysarg_t x, y;
+
+	for (y = 0; y < cons->rows; y++) {
+		for (x = 0; x < cons->cols; x++) {
+			dst = chargrid_charfield_at(cons->viewbuf, x, y);
+			if (y < cons->sb_view) {
+				sbrow = (cons->sb_head + SCROLLBACK_ROWS -
+				    cons->sb_view + y) % SCROLLBACK_ROWS;
+				*dst = cons->sback[sbrow * cons->cols + x];
+			} else {
+				*dst = *chargrid_charfield_at(cons->frontbuf,
+				    x, y - cons->sb_view);
+			}
+		}
+	}
+
+	output_damage(output_sess, cons->vbid, 0, 0, cons->cols, cons->rows);
+	output_cursor_update(output_sess, cons->vbid);
+}
+
+/** Scroll console scrollback view by one page.
+ *
+ * @param cons Console
+ * @param up @c true to scroll towards older output, @c false towards
+ *           the live screen
+ */
+static void cons_sback_scroll(console_t *cons, bool up)
+{
+	sysarg_t page;
+
+	fibril_mutex_lock(&switch_mtx);
+	fibril_mutex_lock(&cons->mtx);
+
+	if ((!active) || (cons != active_console) || (cons->sback == NULL)) {
+		fibril_mutex_unlock(&cons->mtx);
+		fibril_mutex_unlock(&switch_mtx);
+		return;
+	}
+
+	page = (cons->rows > 1) ? cons->rows - 1 : 1;
+
+	if (up) {
+		cons->sb_view += page;
+		if (cons->sb_view > cons->sb_count)
+			cons->sb_view = cons->sb_count;
+	} else {
+		if (cons->sb_view > page)
+			cons->sb_view -= page;
+		else
+			cons->sb_view = 0;
+	}
+
+	if (cons->sb_view > 0) {
+		cons_view_render(cons);
+	} else {
+		output_damage(output_sess, cons->fbid, 0, 0, cons->cols,
+		    cons->rows);
+		output_cursor_update(output_sess, cons->fbid);
+	}
+
+	fibril_mutex_unlock(&cons->mtx);
+	fibril_mutex_unlock(&switch_mtx);
+}
+
 static void cons_switch(unsigned int index)
 {
 	/*
@@ -369,7 +507,14 @@ static errno_t input_ev_key(input_t *input, unsigned kbd_id,
 	if ((key >= KC_F1) && (key <= KC_F1 + CONSOLE_COUNT) &&
 	    ((mods & KM_CTRL) == 0)) {
 		cons_switch(key - KC_F1);
+	} else if ((type == KEY_PRESS) && ((mods & KM_SHIFT) != 0) &&
+	    ((key == KC_PAGE_UP) || (key == KC_PAGE_DOWN))) {
+		cons_sback_scroll(active_console, key == KC_PAGE_UP);
 	} else {
+		/* Any other key press leaves the scrollback view */
+		if ((type == KEY_PRESS) && (active_console->sb_view != 0))
+			cons_damage(active_console);
+
 		/* Got key press/release event */
 		event.type = CEV_KEY;
 
@@ -470,14 +615,23 @@ static errno_t input_ev_dclick(input_t *input, unsigned pos_id, int bnum)
 	return EOK;
 }
 
-/** Process a character from the client (TTY emulation). */
-static void cons_write_char(console_t *cons, char32_t ch)
+/** Process a character from the client (TTY emulation).
+ *
+ * @param cons Console
+ * @param ch Character
+ * @return Number of affected rows as reported by chargrid
+ */
+static sysarg_t cons_write_char(console_t *cons, char32_t ch)
 {
 	sysarg_t updated = 0;
+	sysarg_t top_row;
 
 	fibril_mutex_lock(&cons->mtx);
 	pointer_undraw();
 
+	top_row = chargrid_get_top_row(cons->frontbuf);
+	cons_sback_save(cons, ch);
+
 	switch (ch) {
 	case '\n':
 		updated = chargrid_newline(cons->frontbuf);
@@ -494,11 +648,13 @@ static void cons_write_char(console_t *cons, char32_t ch)
 		updated = chargrid_putuchar(cons->frontbuf, ch, true);
 	}
 
+	if (chargrid_get_top_row(cons->frontbuf) != top_row)
+		cons_sback_commit(cons);
+
 	pointer_draw();
 	fibril_mutex_unlock(&cons->mtx);
 
-	if (updated > 1)
-		cons_update(cons);
+	return updated;
 }
 
 static void cons_set_cursor_vis(console_t *cons, bool visible)
@@ -571,10 +727,21 @@ static errno_t cons_read(con_srv_t *srv, void *buf, size_t size, size_t *nread)
 static errno_t cons_write(con_srv_t *srv, void *data, size_t size, size_t *nwritten)
 {
 	console_t *cons = srv_to_console(srv);
+	bool need_update = false;
 
+	/*
+	 * Only one update is sent to the output for the entire chunk.
+	 * Modified cells carry CHAR_FLAG_DIRTY, so the output server
+	 * still re-renders just the changed rows.
+	 */
 	size_t off = 0;
-	while (off < size)
-		cons_write_char(cons, str_decode(data, &off, size));
+	while (off < size) {
+		if (cons_write_char(cons, str_decode(data, &off, size)) > 1)
+			need_update = true;
+	}
+
+	if (need_update)
+		cons_update(cons);
 
 	*nwritten = size;
 	return EOK;
@@ -947,6 +1114,34 @@ static bool console_srv_init(char *input_svc, char *output_svc)
 				return false;
 			}
 
+			consoles[i].viewbuf =
+			    chargrid_create(cols, rows, CHARGRID_FLAG_SHARED);
+			if (consoles[i].viewbuf == NULL) {
+				printf("%s: Unable to allocate view buffer %zu\n", NAME, i);
+				return false;
+			}
+
+			chargrid_set_cursor_visibility(consoles[i].viewbuf,
+			    false);
+
+			consoles[i].vbid = output_frontbuf_create(output_sess,
+			    consoles[i].viewbuf);
+			if (consoles[i].vbid == 0) {
+				printf("%s: Unable to create view buffer %zu\n", NAME, i);
+				return false;
+			}
+
+			consoles[i].sback = calloc(SCROLLBACK_ROWS * cols,
+			    sizeof(charfield_t));
+			if (consoles[i].sback == NULL) {
+				printf("%s: Unable to allocate scrollback %zu\n", NAME, i);
+				return false;
+			}
+
+			consoles[i].sb_head = 0;
+			consoles[i].sb_count = 0;
+			consoles[i].sb_view = 0;
+
 			con_srvs_init(&consoles[i].srvs);
 			consoles[i].srvs.ops = &con_ops;
 			consoles[i].srvs.sarg = &consoles[i];
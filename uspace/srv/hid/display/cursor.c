@@ -80,79 +80,93 @@ void ds_cursor_destroy(ds_cursor_t *cursor)
 
 	if (cursor->bitmap != NULL)
 		gfx_bitmap_destroy(cursor->bitmap);
+	if (cursor->dbitmap != NULL)
+		gfx_bitmap_destroy(cursor->dbitmap);
 
 	free(cursor);
 }
 
-/** Paint cusor.
+/** Create cursor bitmap in a graphic context.
  *
- * @param cursor Cusor to paint
- * @param pos Position to paint at
- * @param clip Clipping rectangle or @c NULL
+ * @param cursor Cursor
+ * @param gc Graphic context to create the bitmap in
+ * @param rbitmap Place to store pointer to new bitmap
  * @return EOK on success or an error code
  */
-errno_t ds_cursor_paint(ds_cursor_t *cursor, gfx_coord2_t *pos,
-    gfx_rect_t *clip)
+static errno_t ds_cursor_bitmap_create(ds_cursor_t *cursor, gfx_context_t *gc,
+    gfx_bitmap_t **rbitmap)
 {
-	gfx_context_t *dgc;
 	gfx_coord_t x, y;
 	gfx_bitmap_params_t bparams;
 	gfx_bitmap_alloc_t alloc;
+	gfx_bitmap_t *bitmap = NULL;
 	gfx_coord2_t dims;
-	gfx_rect_t sclip;
-	gfx_rect_t srect;
 	pixelmap_t pixelmap;
 	pixel_t pixel;
 	const uint8_t *pp;
 	errno_t rc;
 
-	dgc = ds_display_get_gc(cursor->display);
-	if (dgc == NULL)
-		return EOK;
-
 	gfx_bitmap_params_init(&bparams);
 	bparams.rect = cursor->rect;
 	bparams.flags = bmpf_color_key;
 	bparams.key_color = PIXEL(0, 0, 255, 255);
 
-	if (cursor->bitmap == NULL) {
-		rc = gfx_bitmap_create(dgc, &bparams, NULL, &cursor->bitmap);
-		if (rc != EOK)
-			goto error;
+	rc = gfx_bitmap_create(gc, &bparams, NULL, &bitmap);
+	if (rc != EOK)
+		goto error;
 
-		rc = gfx_bitmap_get_alloc(cursor->bitmap, &alloc);
-		if (rc != EOK) {
-			gfx_bitmap_destroy(cursor->bitmap);
-			cursor->bitmap = NULL;
-			goto error;
-		}
+	rc = gfx_bitmap_get_alloc(bitmap, &alloc);
+	if (rc != EOK) {
+		gfx_bitmap_destroy(bitmap);
+		goto error;
+	}
 
-		gfx_rect_dims(&cursor->rect, &dims);
-		pixelmap.width = dims.x;
-		pixelmap.height = dims.y;
-		pixelmap.data = alloc.pixels;
-
-		pp = cursor->image;
-		for (y = 0; y < dims.y; y++) {
-			for (x = 0; x < dims.x; x++) {
-				switch (*pp) {
-				case 1:
-					pixel = PIXEL(0, 0, 0, 0);
-					break;
-				case 2:
-					pixel = PIXEL(0, 255, 255, 255);
-					break;
-				default:
-					pixel = PIXEL(0, 0, 255, 255);
-					break;
-				}
-
-				pixelmap_put_pixel(&pixelmap, x, y, pixel);
-				++pp;
+	gfx_rect_dims(&cursor->rect, &dims);
+	pixelmap.width = dims.x;
+	pixelmap.height = dims.y;
+	pixelmap.data = alloc.pixels;
+
+	pp = cursor->image;
+	for (y = 0; y < dims.y; y++) {
+		for (x = 0; x < dims.x; x++) {
+			switch (*pp) {
+			case 1:
+				pixel = PIXEL(0, 0, 0, 0);
+				break;
+			case 2:
+				pixel = PIXEL(0, 255, 255, 255);
+				break;
+			default:
+				pixel = PIXEL(0, 0, 255, 255);
+				break;
 			}
+
+			pixelmap_put_pixel(&pixelmap, x, y, pixel);
+			++pp;
 		}
 	}
 
+	*rbitmap = bitmap;
+	return EOK;
+error:
+	return rc;
+}
+
+/** Paint cursor using a particular bitmap.
+ *
+ * @param cursor Cursor to paint
+ * @param bitmap Cursor bitmap to render
+ * @param pos Position to paint at
+ * @param clip Clipping rectangle or @c NULL
+ * @return EOK on success or an error code
+ */
+static errno_t ds_cursor_paint_bmp(ds_cursor_t *cursor, gfx_bitmap_t *bitmap,
+    gfx_coord2_t *pos, gfx_rect_t *clip)
+{
+	gfx_rect_t sclip;
+	gfx_rect_t srect;
+	errno_t rc;
+
 	/* Determine source rectangle */
 	if (clip == NULL) {
 		srect = cursor->rect;
@@ -162,14 +176,67 @@ errno_t ds_cursor_paint(ds_cursor_t *cursor, gfx_coord2_t *pos,
 	}
 
 	if (!gfx_rect_is_empty(&srect)) {
-		rc = gfx_bitmap_render(cursor->bitmap, &srect, pos);
+		rc = gfx_bitmap_render(bitmap, &srect, pos);
 		if (rc != EOK)
 			return rc;
 	}
 
 	return EOK;
-error:
-	return rc;
+}
+
+/** Paint cusor.
+ *
+ * @param cursor Cusor to paint
+ * @param pos Position to paint at
+ * @param clip Clipping rectangle or @c NULL
+ * @return EOK on success or an error code
+ */
+errno_t ds_cursor_paint(ds_cursor_t *cursor, gfx_coord2_t *pos,
+    gfx_rect_t *clip)
+{
+	gfx_context_t *dgc;
+	errno_t rc;
+
+	dgc = ds_display_get_gc(cursor->display);
+	if (dgc == NULL)
+		return EOK;
+
+	if (cursor->bitmap == NULL) {
+		rc = ds_cursor_bitmap_create(cursor, dgc, &cursor->bitmap);
+		if (rc != EOK)
+			return rc;
+	}
+
+	return ds_cursor_paint_bmp(cursor, cursor->bitmap, pos, clip);
+}
+
+/** Paint cursor directly to the front buffer.
+ *
+ * Overlay the cursor on top of the front buffer, bypassing the back
+ * buffer. Used to move the pointer without repainting the scene.
+ *
+ * @param cursor Cursor to paint
+ * @param pos Position to paint at
+ * @param clip Clipping rectangle or @c NULL
+ * @return EOK on success or an error code
+ */
+errno_t ds_cursor_paint_direct(ds_cursor_t *cursor, gfx_coord2_t *pos,
+    gfx_rect_t *clip)
+{
+	gfx_context_t *dgc;
+	errno_t rc;
+
+	dgc = ds_display_get_unbuf_gc(cursor->display);
+	if (dgc == NULL)
+		return EOK;
+
+	if (cursor->dbitmap == NULL) {
+		rc = ds_cursor_bitmap_create(cursor, dgc, &cursor->dbitmap);
+		if (rc != EOK)
+			return rc;
+	}
+
+	return ds_cursor_paint_bmp(cursor, cursor->dbitmap, pos, clip);
 }
 
 /** Get rectangle covered by cursor when drawn at a specified position.
@@ -46,6 +46,8 @@ extern errno_t ds_cursor_create(ds_display_t *, gfx_rect_t *, const uint8_t *,
     ds_cursor_t **);
 extern void ds_cursor_destroy(ds_cursor_t *);
 extern errno_t ds_cursor_paint(ds_cursor_t *, gfx_coord2_t *, gfx_rect_t *);
+extern errno_t ds_cursor_paint_direct(ds_cursor_t *, gfx_coord2_t *,
+    gfx_rect_t *);
 extern void ds_cursor_get_rect(ds_cursor_t *, gfx_coord2_t *, gfx_rect_t *);
 
 #endif
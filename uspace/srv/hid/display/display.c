@@ -33,6 +33,7 @@
  * @file Display server display
  */
 
+#include <assert.h>
 #include <errno.h>
 #include <gfx/bitmap.h>
 #include <gfx/context.h>
@@ -49,7 +50,6 @@
 #include "window.h"
 #include "wmclient.h"
 
-static gfx_context_t *ds_display_get_unbuf_gc(ds_display_t *);
 static void ds_display_invalidate_cb(void *, gfx_rect_t *);
 static void ds_display_update_cb(void *);
 
@@ -653,29 +653,25 @@ ds_seat_t *ds_display_seat_by_idev(ds_display_t *disp, ds_idev_id_t idev_id)
 	return ds_display_default_seat(disp);
 }
 
-/** Allocate back buffer for display.
+/** Create back buffer bitmap and its GC.
  *
  * @param disp Display
- * @return EOK on success or if no back buffer is required, otherwise
- *         an error code.
+ * @param flags Bitmap flags
+ * @return EOK on success or an error code
  */
-static errno_t ds_display_alloc_backbuf(ds_display_t *disp)
+static errno_t ds_display_create_backbuf(ds_display_t *disp,
+    gfx_bitmap_flags_t flags)
 {
 	gfx_context_t *ugc;
 	gfx_bitmap_params_t params;
 	gfx_bitmap_alloc_t alloc;
 	errno_t rc;
 
-	/* Allocate backbuffer */
-	if ((disp->flags & df_disp_double_buf) == 0) {
-		/* Not double buffering. Nothing to do. */
-		return EOK;
-	}
-
 	ugc = ds_display_get_unbuf_gc(disp);
 
 	gfx_bitmap_params_init(&params);
 	params.rect = disp->rect;
+	params.flags = flags;
 
 	rc = gfx_bitmap_create(ugc, &params, NULL,
 	    &disp->backbuf);
@@ -706,6 +702,56 @@ error:
 	return rc;
 }
 
+/** Free back buffer bitmap and its GC.
+ *
+ * @param disp Display
+ */
+static void ds_display_free_backbuf(ds_display_t *disp)
+{
+	if (disp->bbgc != NULL) {
+		mem_gc_delete(disp->bbgc);
+		disp->bbgc = NULL;
+	}
+
+	if (disp->backbuf != NULL) {
+		gfx_bitmap_destroy(disp->backbuf);
+		disp->backbuf = NULL;
+	}
+}
+
+/** Allocate back buffer for display.
+ *
+ * @param disp Display
+ * @return EOK on success or if no back buffer is required, otherwise
+ *         an error code.
+ */
+static errno_t ds_display_alloc_backbuf(ds_display_t *disp)
+{
+	errno_t rc;
+
+	/* Allocate backbuffer */
+	if ((disp->flags & df_disp_double_buf) == 0) {
+		/* Not double buffering. Nothing to do. */
+		return EOK;
+	}
+
+	/*
+	 * Prefer a direct output bitmap. The scene is then composed
+	 * straight in memory provided by the display device (possibly
+	 * the framebuffer itself) and rendering the dirty rectangle is
+	 * all that remains on the update path.
+	 */
+	rc = ds_display_create_backbuf(disp, bmpf_direct_output);
+	if (rc == EOK) {
+		disp->backbuf_direct = true;
+		return EOK;
+	}
+
+	/* Fall back to an ordinary bitmap */
+	disp->backbuf_direct = false;
+	return ds_display_create_backbuf(disp, 0);
+}
+
 /** Add display device to display.
  *
  * @param disp Display
@@ -743,6 +789,21 @@ errno_t ds_display_add_ddev(ds_display_t *disp, ds_ddev_t *ddev)
 			goto error;
 		}
 	} else {
+		/*
+		 * A direct output back buffer is tied to the first output
+		 * device. Replace it with an ordinary bitmap before cloning
+		 * output to the new device.
+		 */
+		if (disp->backbuf_direct) {
+			ds_display_free_backbuf(disp);
+
+			rc = ds_display_create_backbuf(disp, 0);
+			if (rc != EOK)
+				goto error;
+
+			disp->backbuf_direct = false;
+		}
+
 		/* Add new output device to cloning GC */
 		rc = ds_clonegc_add_output(disp->fbgc, ddev->gc);
 		if (rc != EOK)
@@ -950,7 +1011,7 @@ void ds_display_crop_max_rect(gfx_rect_t *arect, gfx_rect_t *mrect)
  * @param display Display
  * @return Unbuffered GC
  */
-static gfx_context_t *ds_display_get_unbuf_gc(ds_display_t *display)
+gfx_context_t *ds_display_get_unbuf_gc(ds_display_t *display)
 {
 	/* In case of unit tests */
 	if (display->fbgc == NULL)
@@ -1002,6 +1063,29 @@ errno_t ds_display_paint_bg(ds_display_t *disp, gfx_rect_t *rect)
 	return gfx_fill_rect(gc, &crect);
 }
 
+/** Paint seat pointers directly to the front buffer.
+ *
+ * @param disp Display
+ * @param rect Clipping rectangle
+ * @return EOK on success, or an error code
+ */
+static errno_t ds_display_paint_pointers(ds_display_t *disp, gfx_rect_t *rect)
+{
+	ds_seat_t *seat;
+	errno_t rc;
+
+	seat = ds_display_first_seat(disp);
+	while (seat != NULL) {
+		rc = ds_seat_paint_pointer_direct(seat, rect);
+		if (rc != EOK)
+			return rc;
+
+		seat = ds_display_next_seat(seat);
+	}
+
+	return EOK;
+}
+
 /** Update front buffer from back buffer.
  *
  * If the display is not double-buffered, no action is taken.
@@ -1011,6 +1095,7 @@ errno_t ds_display_paint_bg(ds_display_t *disp, gfx_rect_t *rect)
  */
 static errno_t ds_display_update(ds_display_t *disp)
 {
+	gfx_rect_t rect;
 	errno_t rc;
 
 	if (disp->backbuf == NULL) {
@@ -1018,7 +1103,9 @@ static errno_t ds_display_update(ds_display_t *disp)
 		return EOK;
 	}
 
-	rc = gfx_bitmap_render(disp->backbuf, &disp->dirty_rect, NULL);
+	rect = disp->dirty_rect;
+
+	rc = gfx_bitmap_render(disp->backbuf, &rect, NULL);
 	if (rc != EOK)
 		return rc;
 
@@ -1027,15 +1114,57 @@ static errno_t ds_display_update(ds_display_t *disp)
 	disp->dirty_rect.p1.x = 0;
 	disp->dirty_rect.p1.y = 0;
 
-	return EOK;
+	/*
+	 * With a direct output back buffer the pointers are part of the
+	 * composed scene. Otherwise the back buffer holds the scene
+	 * without pointers and they are overlaid on top of the newly
+	 * flushed area.
+	 */
+	if (disp->backbuf_direct)
+		return EOK;
+
+	return ds_display_paint_pointers(disp, &rect);
 }
 
-/** Paint display.
+/** Restore a rectangle of the front buffer from the back buffer.
+ *
+ * Repaint a rectangle of the front buffer from the retained,
+ * pointer-free scene in the back buffer, then overlay any pointers
+ * covering it. Used to erase the pointer from its previous position
+ * without repainting any windows.
+ *
+ * @param disp Display
+ * @param rect Rectangle to restore
+ * @return EOK on success, or an error code
+ */
+errno_t ds_display_restore_rect(ds_display_t *disp, gfx_rect_t *rect)
+{
+	gfx_rect_t crect;
+	errno_t rc;
+
+	assert(disp->backbuf != NULL);
+	assert(!disp->backbuf_direct);
+
+	gfx_rect_clip(rect, &disp->rect, &crect);
+	if (gfx_rect_is_empty(&crect))
+		return EOK;
+
+	rc = gfx_bitmap_render(disp->backbuf, &crect, NULL);
+	if (rc != EOK)
+		return rc;
+
+	return ds_display_paint_pointers(disp, &crect);
+}
+
+/** Paint one rectangle of the display.
+ *
+ * Paint background, windows, window previews and pointers within
+ * the bounding rectangle. The front buffer is not updated.
  *
  * @param display Display
- * @param rect Bounding rectangle or @c NULL to repaint entire display
+ * @param rect Bounding rectangle
  */
-errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
+static errno_t ds_display_paint_rect(ds_display_t *disp, gfx_rect_t *rect)
 {
 	errno_t rc;
 	ds_window_t *wnd;
@@ -1066,19 +1195,116 @@ errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
 		wnd = ds_display_prev_window(wnd);
 	}
 
-	/* Paint pointers */
-	seat = ds_display_first_seat(disp);
-	while (seat != NULL) {
-		rc = ds_seat_paint_pointer(seat, rect);
+	/*
+	 * Paint pointers. With an ordinary back buffer it is kept free
+	 * of pointers and they are overlaid onto the front buffer at
+	 * update time instead. With no back buffer or a direct output
+	 * back buffer (where writes may be immediately visible) the
+	 * pointers are painted as part of the scene.
+	 */
+	if (disp->backbuf == NULL || disp->backbuf_direct) {
+		seat = ds_display_first_seat(disp);
+		while (seat != NULL) {
+			rc = ds_seat_paint_pointer(seat, rect);
+			if (rc != EOK)
+				return rc;
+
+			seat = ds_display_next_seat(seat);
+		}
+	}
+
+	return EOK;
+}
+
+/** Add a damage rectangle to the display.
+ *
+ * The rectangle will be repainted by the next compositing pass
+ * (ds_display_composite()). A rectangle incident with an already
+ * accumulated rectangle is merged with it. When all the slots are
+ * occupied, the accumulated damage collapses into a single envelope.
+ *
+ * @param display Display
+ * @param rect Damage rectangle or @c NULL to damage entire display
+ */
+void ds_display_damage(ds_display_t *disp, gfx_rect_t *rect)
+{
+	gfx_rect_t crect;
+	gfx_rect_t envelope;
+	unsigned i;
+
+	if (rect != NULL)
+		gfx_rect_clip(rect, &disp->rect, &crect);
+	else
+		crect = disp->rect;
+
+	if (gfx_rect_is_empty(&crect))
+		return;
+
+	/* Merge with an incident rectangle, if any */
+	for (i = 0; i < disp->ndamage; i++) {
+		if (gfx_rect_is_incident(&disp->damage[i], &crect)) {
+			gfx_rect_envelope(&disp->damage[i], &crect,
+			    &envelope);
+			disp->damage[i] = envelope;
+			return;
+		}
+	}
+
+	if (disp->ndamage < DS_DAMAGE_MAX) {
+		disp->damage[disp->ndamage++] = crect;
+		return;
+	}
+
+	/* All slots occupied. Collapse into a single envelope. */
+	for (i = 1; i < disp->ndamage; i++) {
+		gfx_rect_envelope(&disp->damage[0], &disp->damage[i],
+		    &envelope);
+		disp->damage[0] = envelope;
+	}
+
+	gfx_rect_envelope(&disp->damage[0], &crect, &envelope);
+	disp->damage[0] = envelope;
+	disp->ndamage = 1;
+}
+
+/** Composite the display.
+ *
+ * Repaint the accumulated damage rectangles (and nothing else),
+ * then update the front buffer.
+ *
+ * @param display Display
+ * @return EOK on success or an error code
+ */
+errno_t ds_display_composite(ds_display_t *disp)
+{
+	errno_t rc;
+	unsigned i;
+
+	if (disp->ndamage == 0)
+		return EOK;
+
+	for (i = 0; i < disp->ndamage; i++) {
+		rc = ds_display_paint_rect(disp, &disp->damage[i]);
 		if (rc != EOK)
 			return rc;
-
-		seat = ds_display_next_seat(seat);
 	}
 
+	disp->ndamage = 0;
+
 	return ds_display_update(disp);
 }
 
+/** Paint display.
+ *
+ * @param display Display
+ * @param rect Bounding rectangle or @c NULL to repaint entire display
+ */
+errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
+{
+	ds_display_damage(disp, rect);
+	return ds_display_composite(disp);
+}
+
 /** Display invalidate callback.
  *
  * Called by backbuffer memory GC when something is rendered into it.
@@ -100,7 +100,11 @@ extern void ds_display_remove_cursor(ds_cursor_t *);
 extern void ds_display_update_max_rect(ds_display_t *);
 extern void ds_display_crop_max_rect(gfx_rect_t *, gfx_rect_t *);
 extern gfx_context_t *ds_display_get_gc(ds_display_t *);
+extern gfx_context_t *ds_display_get_unbuf_gc(ds_display_t *);
 extern errno_t ds_display_paint_bg(ds_display_t *, gfx_rect_t *);
+extern errno_t ds_display_restore_rect(ds_display_t *, gfx_rect_t *);
+extern void ds_display_damage(ds_display_t *, gfx_rect_t *);
+extern errno_t ds_display_composite(ds_display_t *);
 extern errno_t ds_display_paint(ds_display_t *, gfx_rect_t *);
 
 #endif
@@ -366,34 +366,31 @@ void ds_seat_get_pointer_rect(ds_seat_t *seat, gfx_rect_t *rect)
  */
 static errno_t ds_seat_repaint_pointer(ds_seat_t *seat, gfx_rect_t *old_rect)
 {
+	ds_display_t *disp = seat->display;
 	gfx_rect_t new_rect;
-	gfx_rect_t envelope;
 	errno_t rc;
 
 	ds_seat_get_pointer_rect(seat, &new_rect);
 
-	if (gfx_rect_is_incident(old_rect, &new_rect)) {
-		/* Rectangles do not intersect. Repaint them separately. */
-		rc = ds_display_paint(seat->display, &new_rect);
-		if (rc != EOK)
-			return rc;
-
-		rc = ds_display_paint(seat->display, old_rect);
-		if (rc != EOK)
-			return rc;
-	} else {
+	if (disp->backbuf != NULL && !disp->backbuf_direct) {
 		/*
-		 * Rectangles intersect. As an optimization, repaint them
-		 * in a single operation.
+		 * The pointer-free scene is retained in the back buffer,
+		 * so the pointer can be moved by restoring the old rectangle
+		 * from it and overlaying the pointer at the new position,
+		 * without repainting any windows.
 		 */
-		gfx_rect_envelope(old_rect, &new_rect, &envelope);
-
-		rc = ds_display_paint(seat->display, &envelope);
+		rc = ds_display_restore_rect(disp, old_rect);
 		if (rc != EOK)
 			return rc;
+
+		return ds_seat_paint_pointer_direct(seat, &new_rect);
 	}
 
-	return EOK;
+	/* Damage both rectangles, then composite in a single pass */
+	ds_display_damage(disp, old_rect);
+	ds_display_damage(disp, &new_rect);
+
+	return ds_display_composite(disp);
 }
 
 /** Post pointing device event to the seat
@@ -571,6 +568,22 @@ errno_t ds_seat_paint_pointer(ds_seat_t *seat, gfx_rect_t *rect)
 	return ds_cursor_paint(cursor, &seat->pntpos, rect);
 }
 
+/** Paint seat pointer directly to the front buffer.
+ *
+ * Overlay the pointer on top of the front buffer contents, bypassing
+ * the back buffer.
+ *
+ * @param seat Seat whose pointer to paint
+ * @param rect Clipping rectangle
+ */
+errno_t ds_seat_paint_pointer_direct(ds_seat_t *seat, gfx_rect_t *rect)
+{
+	ds_cursor_t *cursor;
+
+	cursor = ds_seat_get_cursor(seat);
+	return ds_cursor_paint_direct(cursor, &seat->pntpos, rect);
+}
+
 /** Add input device configuration entry to seat.
  *
  * @param seat Seat
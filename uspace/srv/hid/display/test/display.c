@@ -823,4 +823,70 @@ PCUT_TEST(display_crop_max_rect_right)
 	PCUT_ASSERT_INT_EQUALS(40, mrect.p1.y);
 }
 
+/** Damage accumulation and compositing */
+PCUT_TEST(display_damage_composite)
+{
+	ds_display_t *disp;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	rc = ds_display_create(NULL, df_none, &disp);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	disp->rect.p0.x = 0;
+	disp->rect.p0.y = 0;
+	disp->rect.p1.x = 500;
+	disp->rect.p1.y = 500;
+
+	/* Two disjoint rectangles occupy two slots */
+
+	rect.p0.x = 10;
+	rect.p0.y = 10;
+	rect.p1.x = 20;
+	rect.p1.y = 20;
+	ds_display_damage(disp, &rect);
+
+	rect.p0.x = 100;
+	rect.p0.y = 100;
+	rect.p1.x = 120;
+	rect.p1.y = 120;
+	ds_display_damage(disp, &rect);
+
+	PCUT_ASSERT_INT_EQUALS(2, disp->ndamage);
+
+	/* An incident rectangle merges with the first slot */
+
+	rect.p0.x = 15;
+	rect.p0.y = 15;
+	rect.p1.x = 30;
+	rect.p1.y = 30;
+	ds_display_damage(disp, &rect);
+
+	PCUT_ASSERT_INT_EQUALS(2, disp->ndamage);
+	PCUT_ASSERT_INT_EQUALS(10, disp->damage[0].p0.x);
+	PCUT_ASSERT_INT_EQUALS(10, disp->damage[0].p0.y);
+	PCUT_ASSERT_INT_EQUALS(30, disp->damage[0].p1.x);
+	PCUT_ASSERT_INT_EQUALS(30, disp->damage[0].p1.y);
+
+	/* Damage is clipped to the display rectangle */
+
+	rect.p0.x = 490;
+	rect.p0.y = 490;
+	rect.p1.x = 600;
+	rect.p1.y = 600;
+	ds_display_damage(disp, &rect);
+
+	PCUT_ASSERT_INT_EQUALS(3, disp->ndamage);
+	PCUT_ASSERT_INT_EQUALS(500, disp->damage[2].p1.x);
+	PCUT_ASSERT_INT_EQUALS(500, disp->damage[2].p1.y);
+
+	/* Compositing clears the accumulated damage */
+
+	rc = ds_display_composite(disp);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, disp->ndamage);
+
+	ds_display_destroy(disp);
+}
+
 PCUT_EXPORT(display);
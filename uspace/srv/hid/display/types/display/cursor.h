@@ -48,6 +48,8 @@ typedef struct ds_cursor {
 	link_t ldisplay;
 	/** Bitmap in the display device */
 	gfx_bitmap_t *bitmap;
+	/** Bitmap in the front buffer GC (for direct overlay painting) */
+	gfx_bitmap_t *dbitmap;
 	/** Rectangle represented in the image */
 	gfx_rect_t rect;
 	/** Cursor image */
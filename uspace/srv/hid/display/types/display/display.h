@@ -42,12 +42,16 @@
 #include <gfx/coord.h>
 #include <io/input.h>
 #include <memgfx/memgc.h>
+#include <stdbool.h>
 #include <types/display/cursor.h>
 #include "cursor.h"
 #include "clonegc.h"
 #include "seat.h"
 #include "window.h"
 
+/** Maximum number of accumulated damage rectangles */
+#define DS_DAMAGE_MAX 8
+
 /** Display flags */
 typedef enum {
 	/** No flags enabled */
@@ -113,12 +117,21 @@ typedef struct ds_display {
 	/** Backbuffer GC or @c NULL if not double-buffering */
 	mem_gc_t *bbgc;
 
+	/** Backbuffer is a direct output bitmap (display device memory) */
+	bool backbuf_direct;
+
 	/** Frontbuffer (clone) GC */
 	ds_clonegc_t *fbgc;
 
 	/** Backbuffer dirty rectangle */
 	gfx_rect_t dirty_rect;
 
+	/** Damage rectangles awaiting the next compositing pass */
+	gfx_rect_t damage[DS_DAMAGE_MAX];
+
+	/** Number of valid entries in @c damage */
+	unsigned ndamage;
+
 	/** Display flags */
 	ds_display_flags_t flags;
 } ds_display_t;
@@ -395,9 +395,7 @@ errno_t ds_window_paint_preview(ds_window_t *wnd, gfx_rect_t *rect)
  */
 static errno_t ds_window_repaint_preview(ds_window_t *wnd, gfx_rect_t *old_rect)
 {
-	errno_t rc;
 	gfx_rect_t prect;
-	gfx_rect_t envelope;
 	bool oldr;
 	bool newr;
 
@@ -412,33 +410,13 @@ static errno_t ds_window_repaint_preview(ds_window_t *wnd, gfx_rect_t *old_rect)
 	oldr = (old_rect != NULL) && !gfx_rect_is_empty(old_rect);
 	newr = !gfx_rect_is_empty(&prect);
 
-	if (oldr && newr && gfx_rect_is_incident(old_rect, &prect)) {
-		/*
-		 * As an optimization, repaint both rectangles in a single
-		 * operation.
-		 */
-
-		gfx_rect_envelope(old_rect, &prect, &envelope);
-
-		rc = ds_display_paint(wnd->display, &envelope);
-		if (rc != EOK)
-			return rc;
-	} else {
-		/* Repaint each rectangle separately */
-		if (oldr) {
-			rc = ds_display_paint(wnd->display, old_rect);
-			if (rc != EOK)
-				return rc;
-		}
-
-		if (newr) {
-			rc = ds_display_paint(wnd->display, &prect);
-			if (rc != EOK)
-				return rc;
-		}
-	}
+	/* Damage both rectangles, then composite in a single pass */
+	if (oldr)
+		ds_display_damage(wnd->display, old_rect);
+	if (newr)
+		ds_display_damage(wnd->display, &prect);
 
-	return EOK;
+	return ds_display_composite(wnd->display);
 }
 
 /** Start moving a window by mouse drag.
@@ -1216,11 +1194,11 @@ static void ds_window_invalidate_cb(void *arg, gfx_rect_t *rect)
 	ds_window_t *wnd = (ds_window_t *)arg;
 	gfx_rect_t drect;
 
-	/* Repaint the corresponding part of the display */
+	/* Accumulate damage for the corresponding part of the display */
 
 	gfx_rect_translate(&wnd->dpos, rect, &drect);
 	ds_display_lock(wnd->display);
-	(void) ds_display_paint(wnd->display, &drect);
+	ds_display_damage(wnd->display, &drect);
 	ds_display_unlock(wnd->display);
 }
 
@@ -1232,7 +1210,10 @@ static void ds_window_update_cb(void *arg)
 {
 	ds_window_t *wnd = (ds_window_t *)arg;
 
-	(void) wnd;
+	/* Composite the damage accumulated since the last update */
+	ds_display_lock(wnd->display);
+	(void) ds_display_composite(wnd->display);
+	ds_display_unlock(wnd->display);
 }
 
 /** @}
@@ -55,6 +55,7 @@
 #include <stdlib.h>
 #include <str.h>
 #include <str_error.h>
+#include <time.h>
 
 #include "input.h"
 #include "kbd.h"
@@ -67,6 +68,12 @@
 
 #define NUM_LAYOUTS 5
 
+/** Maximum number of events accumulated in a batch */
+#define EVENT_BATCH_MAX 64
+
+/** Time to wait for further events before flushing a batch */
+#define EVENT_BATCH_FLUSH_USEC 5000
+
 static layout_ops_t *layout[NUM_LAYOUTS] = {
 	&us_qwerty_ops,
 	&us_dvorak_ops,
@@ -107,6 +114,92 @@ static list_t serial_devs;
 
 static FIBRIL_MUTEX_INITIALIZE(discovery_lock);
 
+/** Batch of pointer events awaiting delivery */
+static input_event_t ev_batch[EVENT_BATCH_MAX];
+static size_t ev_batch_cnt;
+
+/** Flushes batches that do not fill up within the flush interval */
+static fibril_timer_t *ev_batch_timer;
+
+static FIBRIL_MUTEX_INITIALIZE(ev_batch_lock);
+
+/** Get current uptime in microseconds. */
+static usec_t event_timestamp(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+}
+
+/** Deliver accumulated events to all active clients.
+ *
+ * Must be called with ev_batch_lock held.
+ */
+static void event_batch_flush_locked(void)
+{
+	if (ev_batch_cnt == 0)
+		return;
+
+	list_foreach(clients, link, client_t, client) {
+		if (client->active) {
+			async_exch_t *exch = async_exchange_begin(client->sess);
+			aid_t req = async_send_0(exch, INPUT_EVENT_BATCH,
+			    NULL);
+			errno_t rc = async_data_write_start(exch, ev_batch,
+			    ev_batch_cnt * sizeof(input_event_t));
+			async_exchange_end(exch);
+			if (rc != EOK)
+				printf("%s: Failed to send event batch: %s\n",
+				    NAME, str_error(rc));
+			async_forget(req);
+		}
+	}
+
+	ev_batch_cnt = 0;
+}
+
+/** Deliver accumulated events to all active clients.
+ *
+ * Called directly before sending a single (unbatched) message so that
+ * event ordering is preserved, and from the flush timer.
+ */
+static void event_batch_flush(void *arg)
+{
+	fibril_mutex_lock(&ev_batch_lock);
+	event_batch_flush_locked();
+	fibril_mutex_unlock(&ev_batch_lock);
+}
+
+/** Queue an event for batched delivery.
+ *
+ * High-rate events which can wait out the flush interval (pointer
+ * movement) are accumulated and delivered as one message instead of
+ * sending each of them separately.
+ */
+static void event_batch_add(input_notif_t type, sysarg_t arg1, sysarg_t arg2,
+    sysarg_t arg3, sysarg_t arg4, sysarg_t arg5)
+{
+	fibril_mutex_lock(&ev_batch_lock);
+
+	input_event_t *ev = &ev_batch[ev_batch_cnt++];
+	ev->type = type;
+	ev->time = event_timestamp();
+	ev->args[0] = arg1;
+	ev->args[1] = arg2;
+	ev->args[2] = arg3;
+	ev->args[3] = arg4;
+	ev->args[4] = arg5;
+
+	if (ev_batch_cnt >= EVENT_BATCH_MAX)
+		event_batch_flush_locked();
+	else if (ev_batch_cnt == 1)
+		fibril_timer_set(ev_batch_timer, EVENT_BATCH_FLUSH_USEC,
+		    event_batch_flush, NULL);
+
+	fibril_mutex_unlock(&ev_batch_lock);
+}
+
 static void *client_data_create(void)
 {
 	client_t *client = (client_t *) calloc(1, sizeof(client_t));
@@ -249,6 +342,9 @@ void kbd_push_event(kbd_dev_t *kdev, int type, unsigned int key)
 
 	ev.c = layout_parse_ev(kdev->active_layout, &ev);
 
+	/* Do not let key events overtake queued pointer events */
+	event_batch_flush(NULL);
+
 	list_foreach(clients, link, client_t, client) {
 		if (client->active) {
 			async_exch_t *exch = async_exchange_begin(client->sess);
@@ -262,17 +358,18 @@ void kbd_push_event(kbd_dev_t *kdev, int type, unsigned int key)
 /** Mouse pointer has moved (relative mode). */
 void mouse_push_event_move(mouse_dev_t *mdev, int dx, int dy, int dz)
 {
-	list_foreach(clients, link, client_t, client) {
-		if (client->active) {
-			async_exch_t *exch = async_exchange_begin(client->sess);
+	if ((dx) || (dy))
+		event_batch_add(INPUT_EVENT_MOVE, mdev->svc_id, dx, dy, 0, 0);
 
-			if ((dx) || (dy))
-				async_msg_3(exch, INPUT_EVENT_MOVE,
-				    mdev->svc_id, dx, dy);
+	if (dz) {
+		// TODO: Implement proper wheel support
+		keycode_t code = dz > 0 ? KC_UP : KC_DOWN;
 
-			if (dz) {
-				// TODO: Implement proper wheel support
-				keycode_t code = dz > 0 ? KC_UP : KC_DOWN;
+		event_batch_flush(NULL);
+
+		list_foreach(clients, link, client_t, client) {
+			if (client->active) {
+				async_exch_t *exch = async_exchange_begin(client->sess);
 
 				for (unsigned int i = 0; i < 3; i++)
 					async_msg_5(exch, INPUT_EVENT_KEY,
@@ -281,9 +378,9 @@ void mouse_push_event_move(mouse_dev_t *mdev, int dx, int dy, int dz)
 
 				async_msg_5(exch, INPUT_EVENT_KEY, KEY_RELEASE,
 				    0 /* XXX kbd_id */, code, 0, 0);
-			}
 
-			async_exchange_end(exch);
+				async_exchange_end(exch);
+			}
 		}
 	}
 }
@@ -292,21 +389,17 @@ void mouse_push_event_move(mouse_dev_t *mdev, int dx, int dy, int dz)
 void mouse_push_event_abs_move(mouse_dev_t *mdev, unsigned int x, unsigned int y,
     unsigned int max_x, unsigned int max_y)
 {
-	list_foreach(clients, link, client_t, client) {
-		if (client->active) {
-			if ((max_x) && (max_y)) {
-				async_exch_t *exch = async_exchange_begin(client->sess);
-				async_msg_5(exch, INPUT_EVENT_ABS_MOVE,
-				    mdev->svc_id, x, y, max_x, max_y);
-				async_exchange_end(exch);
-			}
-		}
-	}
+	if ((max_x) && (max_y))
+		event_batch_add(INPUT_EVENT_ABS_MOVE, mdev->svc_id, x, y,
+		    max_x, max_y);
 }
 
 /** Mouse button has been pressed. */
 void mouse_push_event_button(mouse_dev_t *mdev, int bnum, int press)
 {
+	/* Do not let the button event overtake queued pointer events */
+	event_batch_flush(NULL);
+
 	list_foreach(clients, link, client_t, client) {
 		if (client->active) {
 			async_exch_t *exch = async_exchange_begin(client->sess);
@@ -320,6 +413,9 @@ void mouse_push_event_button(mouse_dev_t *mdev, int bnum, int press)
 /** Mouse button has been double-clicked. */
 void mouse_push_event_dclick(mouse_dev_t *mdev, int bnum)
 {
+	/* Do not let the button event overtake queued pointer events */
+	event_batch_flush(NULL);
+
 	list_foreach(clients, link, client_t, client) {
 		if (client->active) {
 			async_exch_t *exch = async_exchange_begin(client->sess);
@@ -333,6 +429,9 @@ void mouse_push_event_dclick(mouse_dev_t *mdev, int bnum)
 /** Arbitrate client activation */
 static void client_arbitration(void)
 {
+	/* Queued events belong to the previously active client */
+	event_batch_flush(NULL);
+
 	/* Mutual exclusion of active clients */
 	list_foreach(clients, link, client_t, client)
 		client->active = ((active) && (client == active_client));
@@ -893,6 +992,12 @@ int main(int argc, char **argv)
 
 	serial_console = config_get_value("console");
 
+	ev_batch_timer = fibril_timer_create(NULL);
+	if (ev_batch_timer == NULL) {
+		printf("%s: Failed creating event batch timer\n", NAME);
+		return 1;
+	}
+
 	/* Add legacy keyboard devices. */
 	kbd_add_legacy_devs();
 
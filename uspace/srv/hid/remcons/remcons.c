@@ -134,6 +134,7 @@ static errno_t remcons_close(con_srv_t *srv)
 {
 	telnet_user_t *user = srv_to_user(srv);
 
+	telnet_user_flush(user);
 	telnet_user_notify_client_disconnected(user);
 	telnet_user_log(user, "Client disconnected (%p).", srv);
 
@@ -155,7 +156,9 @@ static errno_t remcons_write(con_srv_t *srv, void *data, size_t size, size_t *nw
 
 static void remcons_sync(con_srv_t *srv)
 {
-	(void) srv;
+	telnet_user_t *user = srv_to_user(srv);
+
+	telnet_user_flush(user);
 }
 
 static void remcons_clear(con_srv_t *srv)
@@ -53,6 +53,11 @@
 static FIBRIL_MUTEX_INITIALIZE(users_guard);
 static LIST_INITIALIZE(users);
 
+/** How long output may linger in the buffer before it is flushed (usec). */
+#define OUTPUT_FLUSH_TIMEOUT 5000
+
+static errno_t telnet_user_flush_no_lock(telnet_user_t *);
+
 /** Create new telnet user.
  *
  * @param conn Incoming connection.
@@ -90,6 +95,14 @@ telnet_user_t *telnet_user_create(tcp_conn_t *conn)
 
 	user->cursor_x = 0;
 
+	user->out_buffer_len = 0;
+	user->flush_timer = fibril_timer_create(&user->guard);
+	if (user->flush_timer == NULL) {
+		free(user->service_name);
+		free(user);
+		return NULL;
+	}
+
 	return user;
 }
 
@@ -108,6 +121,9 @@ void telnet_user_destroy(telnet_user_t *user)
 {
 	assert(user);
 
+	(void) fibril_timer_clear(user->flush_timer);
+	fibril_timer_destroy(user->flush_timer);
+
 	fibril_mutex_lock(&users_guard);
 	list_remove(&user->link);
 	fibril_mutex_unlock(&users_guard);
@@ -247,15 +263,61 @@ static kbd_event_t *new_kbd_event(kbd_event_type_t type, char32_t c)
 	return event;
 }
 
-/** Process telnet command (currently only print to screen).
+/** Reply to a telnet option negotiation request, no locking.
+ *
+ * @param user Telnet user structure.
+ * @param cmd Negotiation verb (WILL, WONT, DO, DONT).
+ * @param option_code Option the verb applies to.
+ */
+static void send_telnet_reply_no_lock(telnet_user_t *user, telnet_cmd_t cmd,
+    telnet_cmd_t option_code)
+{
+	const telnet_cmd_t reply[3] = { TELNET_IAC, cmd, option_code };
+
+	/* Keep the reply ordered with respect to buffered output. */
+	(void) telnet_user_flush_no_lock(user);
+	(void) tcp_conn_send(user->conn, (void *) reply, sizeof(reply));
+}
+
+/** Process telnet command.
+ *
+ * Option negotiation requests are answered: the options we announce
+ * ourselves (echo, suppress go-ahead) are confirmed, including a client
+ * asking us not to echo because it does local echo, and everything else
+ * is refused. Other commands are ignored.
  *
  * @param user Telnet user structure.
- * @param option_code Command option code.
- * @param cmd Telnet command.
+ * @param option_code Negotiation verb or 0 for plain commands.
+ * @param cmd Telnet command (option for negotiation verbs).
  */
 static void process_telnet_command(telnet_user_t *user,
     telnet_cmd_t option_code, telnet_cmd_t cmd)
 {
+	switch (option_code) {
+	case TELNET_DO:
+		/* Acceptance of an option we announced via WILL. */
+		if (cmd == TELNET_ECHO || cmd == TELNET_SUPPRESS_GO_AHEAD)
+			return;
+		send_telnet_reply_no_lock(user, TELNET_WONT, cmd);
+		return;
+	case TELNET_DONT:
+		/* The client does local echo, confirm that we stop. */
+		if (cmd == TELNET_ECHO)
+			send_telnet_reply_no_lock(user, TELNET_WONT, cmd);
+		return;
+	case TELNET_WILL:
+		if (cmd == TELNET_SUPPRESS_GO_AHEAD) {
+			send_telnet_reply_no_lock(user, TELNET_DO, cmd);
+			return;
+		}
+		send_telnet_reply_no_lock(user, TELNET_DONT, cmd);
+		return;
+	case TELNET_WONT:
+		return;
+	default:
+		break;
+	}
+
 	if (option_code != 0) {
 		telnet_user_log(user, "Ignoring telnet command %u %u %u.",
 		    TELNET_IAC, option_code, cmd);
@@ -332,7 +394,47 @@ errno_t telnet_user_get_next_keyboard_event(telnet_user_t *user, kbd_event_t *ev
 	return EOK;
 }
 
+/** Send buffered output to the socket, no locking.
+ *
+ * @param user Telnet user.
+ */
+static errno_t telnet_user_flush_no_lock(telnet_user_t *user)
+{
+	errno_t rc;
+
+	if (user->out_buffer_len == 0)
+		return EOK;
+
+	if (user->conn == NULL) {
+		user->out_buffer_len = 0;
+		return EIO;
+	}
+
+	rc = tcp_conn_send(user->conn, user->out_buffer, user->out_buffer_len);
+	user->out_buffer_len = 0;
+
+	return rc;
+}
+
+/** Flush timer handler.
+ *
+ * Called with the user's guard locked.
+ *
+ * @param arg Corresponding @c telnet_user_t structure.
+ */
+static void telnet_user_flush_timer(void *arg)
+{
+	telnet_user_t *user = arg;
+
+	(void) telnet_user_flush_no_lock(user);
+}
+
 /** Send data (convert them first) to the socket, no locking.
+ *
+ * The data is aggregated in the output buffer and sent out either when
+ * the buffer fills up or shortly afterwards (when the flush timer
+ * expires), so that bursts of small writes do not produce a packet
+ * each.
  *
  * @param user Telnet user.
  * @param data Data buffer (not zero terminated).
@@ -340,18 +442,23 @@ errno_t telnet_user_get_next_keyboard_event(telnet_user_t *user, kbd_event_t *ev
  */
 static errno_t telnet_user_send_data_no_lock(telnet_user_t *user, uint8_t *data, size_t size)
 {
-	uint8_t *converted = malloc(3 * size + 1);
-	assert(converted);
-	int converted_size = 0;
+	errno_t rc;
 
 	/* Convert new-lines. */
 	for (size_t i = 0; i < size; i++) {
+		/* Worst case is CR-LF, make sure there is room for two bytes */
+		if (user->out_buffer_len + 2 > OUTPUT_BUFFER_SIZE) {
+			rc = telnet_user_flush_no_lock(user);
+			if (rc != EOK)
+				return rc;
+		}
+
 		if (data[i] == 10) {
-			converted[converted_size++] = 13;
-			converted[converted_size++] = 10;
+			user->out_buffer[user->out_buffer_len++] = 13;
+			user->out_buffer[user->out_buffer_len++] = 10;
 			user->cursor_x = 0;
 		} else {
-			converted[converted_size++] = data[i];
+			user->out_buffer[user->out_buffer_len++] = data[i];
 			if (data[i] == '\b') {
 				user->cursor_x--;
 			} else {
@@ -360,10 +467,13 @@ static errno_t telnet_user_send_data_no_lock(telnet_user_t *user, uint8_t *data,
 		}
 	}
 
-	errno_t rc = tcp_conn_send(user->conn, converted, converted_size);
-	free(converted);
+	if (user->out_buffer_len > 0) {
+		(void) fibril_timer_clear_locked(user->flush_timer);
+		fibril_timer_set_locked(user->flush_timer, OUTPUT_FLUSH_TIMEOUT,
+		    telnet_user_flush_timer, user);
+	}
 
-	return rc;
+	return EOK;
 }
 
 /** Send data (convert them first) to the socket.
@@ -383,6 +493,20 @@ errno_t telnet_user_send_data(telnet_user_t *user, uint8_t *data, size_t size)
 	return rc;
 }
 
+/** Flush any buffered output to the socket.
+ *
+ * @param user Telnet user.
+ */
+void telnet_user_flush(telnet_user_t *user)
+{
+	fibril_mutex_lock(&user->guard);
+
+	(void) fibril_timer_clear_locked(user->flush_timer);
+	(void) telnet_user_flush_no_lock(user);
+
+	fibril_mutex_unlock(&user->guard);
+}
+
 /** Update cursor X position.
  *
  * This call may result in sending control commands over socket.
@@ -44,6 +44,9 @@
 
 #define BUFFER_SIZE 32
 
+/** Size of the output aggregation buffer. */
+#define OUTPUT_BUFFER_SIZE 1024
+
 /** Representation of a connected (human) user. */
 typedef struct {
 	/** Mutex guarding the whole structure. */
@@ -67,6 +70,12 @@ typedef struct {
 	size_t socket_buffer_len;
 	size_t socket_buffer_pos;
 
+	/** Output data waiting to be sent to the socket. */
+	uint8_t out_buffer[OUTPUT_BUFFER_SIZE];
+	size_t out_buffer_len;
+	/** Timer flushing buffered output. */
+	fibril_timer_t *flush_timer;
+
 	/** Task id of the launched application. */
 	task_id_t task_id;
 
@@ -88,6 +97,7 @@ extern bool telnet_user_is_zombie(telnet_user_t *);
 extern void telnet_user_notify_client_disconnected(telnet_user_t *);
 extern errno_t telnet_user_get_next_keyboard_event(telnet_user_t *, kbd_event_t *);
 extern errno_t telnet_user_send_data(telnet_user_t *, uint8_t *, size_t);
+extern void telnet_user_flush(telnet_user_t *);
 extern void telnet_user_update_cursor_x(telnet_user_t *, int);
 
 /** Print informational message about connected user. */
@@ -99,6 +99,8 @@ static void rfb_gc_invalidate_rect(rfb_gc_t *rfbgc, gfx_rect_t *rect)
 	if (gfx_rect_is_empty(rect))
 		return;
 
+	fibril_mutex_lock(&rfb->lock);
+
 	if (!rfb->damage_valid) {
 		old_rect.p0.x = old_rect.p0.y = 0;
 		old_rect.p1.x = old_rect.p1.y = 0;
@@ -115,6 +117,11 @@ static void rfb_gc_invalidate_rect(rfb_gc_t *rfbgc, gfx_rect_t *rect)
 	rfb->damage_rect.y = new_rect.p0.y;
 	rfb->damage_rect.width = new_rect.p1.x - new_rect.p0.x;
 	rfb->damage_rect.height = new_rect.p1.y - new_rect.p0.y;
+
+	rfb->damage_valid = true;
+	fibril_condvar_broadcast(&rfb->damage_cv);
+
+	fibril_mutex_unlock(&rfb->lock);
 }
 
 static errno_t rfb_ddev_get_gc(void *arg, sysarg_t *arg2, sysarg_t *arg3)
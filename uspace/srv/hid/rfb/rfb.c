@@ -135,7 +135,7 @@ static void rfb_framebuffer_update_request_to_host(rfb_framebuffer_update_reques
     rfb_framebuffer_update_request_t *dst)
 {
 	dst->x = uint16_t_be2host(src->x);
-	dst->y = uint16_t_be2host(src->x);
+	dst->y = uint16_t_be2host(src->y);
 	dst->width = uint16_t_be2host(src->width);
 	dst->height = uint16_t_be2host(src->height);
 }
@@ -176,6 +176,7 @@ errno_t rfb_init(rfb_t *rfb, uint16_t width, uint16_t height, const char *name)
 {
 	memset(rfb, 0, sizeof(rfb_t));
 	fibril_mutex_initialize(&rfb->lock);
+	fibril_condvar_initialize(&rfb->damage_cv);
 
 	rfb_pixel_format_t *pf = &rfb->pixel_format;
 	pf->bpp = 32;
@@ -448,6 +449,72 @@ static errno_t rfb_tile_encode_solid(rfb_t *rfb, cpixel_ctx_t *cpixel,
 	return EOK;
 }
 
+/** Find a color in a tile palette.
+ *
+ * @return Palette index or -1 if the color is not in the palette.
+ */
+static int rfb_palette_find(pixel_t *palette, size_t pal_count, pixel_t pixel)
+{
+	for (size_t i = 0; i < pal_count; i++) {
+		if (palette[i] == pixel)
+			return i;
+	}
+	return -1;
+}
+
+static errno_t rfb_tile_encode_palette(rfb_t *rfb, cpixel_ctx_t *cpixel,
+    rfb_rectangle_t *tile, void *buf, size_t *size, uint8_t *pal_count)
+{
+	pixel_t palette[RFB_TRLE_PALETTE_MAX];
+	size_t count = 0;
+
+	/* Collect tile colors, give up if there are too many */
+	for (uint16_t y = tile->y; y < tile->y + tile->height; y++) {
+		for (uint16_t x = tile->x; x < tile->x + tile->width; x++) {
+			pixel_t pixel = pixelmap_get_pixel(&rfb->framebuffer, x, y);
+			if (rfb_palette_find(palette, count, pixel) >= 0)
+				continue;
+			if (count >= RFB_TRLE_PALETTE_MAX)
+				return EINVAL;
+			palette[count++] = pixel;
+		}
+	}
+
+	/* Packed pixel rows, each row padded to a byte boundary */
+	unsigned bpp = (count <= 2) ? 1 : (count <= 4) ? 2 : 4;
+	size_t row_bytes = (tile->width * bpp + 7) / 8;
+
+	*size = count * cpixel->size + tile->height * row_bytes;
+	*pal_count = count;
+	if (buf == NULL)
+		return EOK;
+
+	for (size_t i = 0; i < count; i++) {
+		cpixel_encode(rfb, cpixel, buf, palette[i]);
+		buf += cpixel->size;
+	}
+
+	uint8_t *bp = buf;
+	for (uint16_t y = tile->y; y < tile->y + tile->height; y++) {
+		uint8_t b = 0;
+		unsigned nbits = 0;
+		for (uint16_t x = tile->x; x < tile->x + tile->width; x++) {
+			pixel_t pixel = pixelmap_get_pixel(&rfb->framebuffer, x, y);
+			b = (b << bpp) | rfb_palette_find(palette, count, pixel);
+			nbits += bpp;
+			if (nbits == 8) {
+				*bp++ = b;
+				b = 0;
+				nbits = 0;
+			}
+		}
+		if (nbits > 0)
+			*bp++ = b << (8 - nbits);
+	}
+
+	return EOK;
+}
+
 static size_t rfb_rect_encode_trle(rfb_t *rfb, rfb_rectangle_t *rect, void *buf)
 {
 	cpixel_ctx_t cpixel;
@@ -457,8 +524,8 @@ static size_t rfb_rect_encode_trle(rfb_t *rfb, rfb_rectangle_t *rect, void *buf)
 	for (uint16_t y = 0; y < rect->height; y += 16) {
 		for (uint16_t x = 0; x < rect->width; x += 16) {
 			rfb_rectangle_t tile = {
-				.x = x,
-				.y = y,
+				.x = rect->x + x,
+				.y = rect->y + y,
 				.width = (x + 16 <= rect->width ? 16 : rect->width - x),
 				.height = (y + 16 <= rect->height ? 16 : rect->height - y)
 			};
@@ -469,9 +536,16 @@ static size_t rfb_rect_encode_trle(rfb_t *rfb, rfb_rectangle_t *rect, void *buf)
 				buf +=  1;
 
 			uint8_t tile_enctype = RFB_TILE_ENCODING_SOLID;
+			uint8_t pal_count = 0;
 			size_t tile_size;
 			errno_t rc = rfb_tile_encode_solid(rfb, &cpixel, &tile, buf,
 			    &tile_size);
+			if (rc != EOK) {
+				/* Packed palette tile type is the palette size (2-16) */
+				rc = rfb_tile_encode_palette(rfb, &cpixel, &tile, buf,
+				    &tile_size, &pal_count);
+				tile_enctype = pal_count;
+			}
 			if (rc != EOK) {
 				tile_size = rfb_tile_encode_raw(rfb, &cpixel, &tile, buf);
 				tile_enctype = RFB_TILE_ENCODING_RAW;
@@ -487,20 +561,39 @@ static size_t rfb_rect_encode_trle(rfb_t *rfb, rfb_rectangle_t *rect, void *buf)
 }
 
 static errno_t rfb_send_framebuffer_update(rfb_t *rfb, tcp_conn_t *conn,
-    bool incremental)
+    rfb_framebuffer_update_request_t *fbur)
 {
+	rfb_rectangle_t urect;
+
 	fibril_mutex_lock(&rfb->lock);
-	if (!incremental || !rfb->damage_valid) {
-		rfb->damage_rect.x = 0;
-		rfb->damage_rect.y = 0;
-		rfb->damage_rect.width = rfb->width;
-		rfb->damage_rect.height = rfb->height;
-	}
 
-	/* We send only single raw rectangle right now */
+	if (fbur->incremental) {
+		/* Defer the reply until a part of the framebuffer changes */
+		while (!rfb->damage_valid)
+			fibril_condvar_wait(&rfb->damage_cv, &rfb->lock);
+		urect = rfb->damage_rect;
+	} else {
+		/* Refresh the area the client asked for */
+		urect.x = fbur->x;
+		urect.y = fbur->y;
+		urect.width = fbur->width;
+		urect.height = fbur->height;
+	}
+
+	/* Clip the update rectangle to the framebuffer */
+	if (urect.x > rfb->width)
+		urect.x = rfb->width;
+	if (urect.y > rfb->height)
+		urect.y = rfb->height;
+	urect.width = min(urect.width, rfb->width - urect.x);
+	urect.height = min(urect.height, rfb->height - urect.y);
+
+	/* We send only a single rectangle right now */
 	size_t buf_size = sizeof(rfb_framebuffer_update_t) +
 	    sizeof(rfb_rectangle_t) * 1 +
-	    rfb_rect_encode_raw(rfb, &rfb->damage_rect, NULL);
+	    (rfb->supports_trle ?
+	    rfb_rect_encode_trle(rfb, &urect, NULL) :
+	    rfb_rect_encode_raw(rfb, &urect, NULL));
 
 	void *buf = malloc(buf_size);
 	if (buf == NULL) {
@@ -519,7 +612,7 @@ static errno_t rfb_send_framebuffer_update(rfb_t *rfb, tcp_conn_t *conn,
 	rfb_rectangle_t *rect = pos;
 	pos += sizeof(rfb_rectangle_t);
 
-	*rect = rfb->damage_rect;
+	*rect = urect;
 
 	if (rfb->supports_trle) {
 		rect->enctype = RFB_ENCODING_TRLE;
@@ -530,7 +623,9 @@ static errno_t rfb_send_framebuffer_update(rfb_t *rfb, tcp_conn_t *conn,
 	}
 	rfb_rectangle_to_be(rect, rect);
 
-	rfb->damage_valid = false;
+	/* Incremental updates carry exactly the accumulated damage */
+	if (fbur->incremental)
+		rfb->damage_valid = false;
 
 	size_t send_palette_size = 0;
 	void *send_palette = NULL;
@@ -743,7 +838,7 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 			rfb_framebuffer_update_request_to_host(&fbur, &fbur);
 			log_msg(LOG_DEFAULT, LVL_DEBUG2,
 			    "Received FramebufferUpdateRequest message");
-			rfb_send_framebuffer_update(rfb, conn, fbur.incremental);
+			rfb_send_framebuffer_update(rfb, conn, &fbur);
 			break;
 		case RFB_CMSG_KEY_EVENT:
 			rc = recv_message(conn, message_type, &ke, sizeof(ke));
@@ -54,6 +54,9 @@
 #define RFB_TILE_ENCODING_RAW 0
 #define RFB_TILE_ENCODING_SOLID 1
 
+/** Maximum number of colors in a packed palette tile */
+#define RFB_TRLE_PALETTE_MAX 16
+
 typedef struct {
 	uint8_t bpp;
 	uint8_t depth;
@@ -157,6 +160,7 @@ typedef struct {
 	rfb_rectangle_t damage_rect;
 	bool damage_valid;
 	fibril_mutex_t lock;
+	fibril_condvar_t damage_cv;
 	pixel_t *palette;
 	size_t palette_used;
 	bool supports_trle;
@@ -35,8 +35,10 @@
  */
 
 #include <stdio.h>
+#include <abi/klog.h>
 #include <async.h>
 #include <as.h>
+#include <barrier.h>
 #include <ddi.h>
 #include <errno.h>
 #include <str_error.h>
@@ -75,6 +77,14 @@ static prodcons_t pc;
 #define BUFFER_SIZE PAGE_SIZE
 static void *buffer;
 
+/* Mapped kernel log area (header page followed by the entry buffer) */
+static klog_shared_t *shared = (klog_shared_t *) AS_AREA_ANY;
+static uint8_t *shared_buffer;
+static size_t shared_length;
+
+/* Consumer position within the mapped entry buffer */
+static uint64_t shared_rpos;
+
 /* Notification mutex */
 static FIBRIL_MUTEX_INITIALIZE(mtx);
 
@@ -88,6 +98,116 @@ static const char *facility_name[] = {
 #define facility_len (sizeof(facility_name) / sizeof(const char *))
 static log_t facility_ctx[facility_len];
 
+/** Map the kernel log memory area.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+static errno_t shared_map(void)
+{
+	size_t pages;
+	errno_t rc = sysinfo_get_value("klog.pages", &pages);
+	if (rc != EOK)
+		return rc;
+
+	uintptr_t faddr;
+	rc = sysinfo_get_value("klog.faddr", &faddr);
+	if (rc != EOK)
+		return rc;
+
+	if (pages < 2)
+		return EINVAL;
+
+	rc = physmem_map(faddr, pages,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+	    (void *) &shared);
+	if (rc != EOK)
+		return rc;
+
+	shared_buffer = (uint8_t *) shared + PAGE_SIZE;
+	shared_length = (pages - 1) * PAGE_SIZE;
+	shared_rpos = shared->rpos;
+
+	return EOK;
+}
+
+/** Copy data out of the cyclic entry buffer.
+ *
+ * @param dest Destination buffer.
+ * @param pos  Monotonic position of the data.
+ * @param len  Number of bytes to copy.
+ *
+ */
+static void shared_copy(uint8_t *dest, uint64_t pos, size_t len)
+{
+	size_t off = (size_t) (pos % shared_length);
+
+	for (size_t i = 0; i < len; i++, off = (off + 1) % shared_length)
+		dest[i] = shared_buffer[off];
+}
+
+/** Klog producer (mapped buffer)
+ *
+ * Drains all log entries the kernel has published since the last
+ * run directly from the mapped buffer (no syscalls, no size limit
+ * per run) and hands them to the producer/consumer queue. Entries
+ * overwritten by the kernel while being copied are detected by
+ * re-checking the start position and skipped.
+ *
+ */
+static void producer_shared(void)
+{
+	uint64_t wpos = shared->wpos;
+
+	/* Catch up if the kernel discarded unread entries */
+	if (shared_rpos < shared->start)
+		shared_rpos = shared->start;
+
+	while (shared_rpos < wpos) {
+		size_t entry_len;
+		shared_copy((uint8_t *) &entry_len, shared_rpos,
+		    sizeof(size_t));
+
+		if ((entry_len < sizeof(log_entry_t)) ||
+		    (entry_len > shared_length)) {
+			/* Corrupted header, resynchronize with the writer */
+			shared_rpos = wpos;
+			break;
+		}
+
+		log_entry_t *buf = malloc(entry_len + 1);
+		if (buf == NULL)
+			break;
+
+		shared_copy((uint8_t *) buf, shared_rpos, entry_len);
+
+		read_barrier();
+		if (shared->start > shared_rpos) {
+			/* The entry was overwritten while being copied */
+			free(buf);
+			shared_rpos = shared->start;
+			continue;
+		}
+
+		item_t *item = malloc(sizeof(item_t));
+		if (item == NULL) {
+			free(buf);
+			break;
+		}
+
+		*((uint8_t *) buf + entry_len) = 0;
+		link_initialize(&item->link);
+		item->size = entry_len;
+		item->data = buf;
+		prodcons_produce(&pc, &item->link);
+
+		shared_rpos += entry_len;
+	}
+
+	/* Let the kernel know how far we got (gates the doorbell) */
+	shared->rpos = shared_rpos;
+}
+
 /** Klog producer
  *
  * Copies the log entries to a producer/consumer queue.
@@ -98,6 +218,10 @@ static log_t facility_ctx[facility_len];
  */
 static void producer(void)
 {
+	if (shared_length > 0) {
+		producer_shared();
+		return;
+	}
 	size_t len = 0;
 	errno_t rc = klog_read(buffer, BUFFER_SIZE, &len);
 	if (rc != EOK) {
@@ -219,10 +343,19 @@ int main(int argc, char *argv[])
 		facility_ctx[i] = log_create(facility_name[i], kernel_ctx);
 	}
 
-	buffer = malloc(BUFFER_SIZE);
-	if (buffer == NULL) {
-		log_msg(LOG_DEFAULT, LVL_ERROR, "Unable to allocate buffer");
-		return 1;
+	rc = shared_map();
+	if (rc != EOK) {
+		/* Fall back to reading the log via KLOG_READ */
+		log_msg(LOG_DEFAULT, LVL_WARN,
+		    "Unable to map kernel log (%s), falling back to syscall "
+		    "interface", str_error_name(rc));
+
+		buffer = malloc(BUFFER_SIZE);
+		if (buffer == NULL) {
+			log_msg(LOG_DEFAULT, LVL_ERROR,
+			    "Unable to allocate buffer");
+			return 1;
+		}
 	}
 
 	prodcons_initialize(&pc);
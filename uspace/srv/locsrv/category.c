@@ -87,6 +87,7 @@ static void category_init(category_t *cat, const char *name)
 	fibril_mutex_initialize(&cat->mutex);
 	cat->name = str_dup(name);
 	cat->id = loc_create_id();
+	cat->change_gen = 0;
 	link_initialize(&cat->cat_list);
 	list_initialize(&cat->svc_memb);
 }
@@ -48,6 +48,9 @@ typedef struct {
 	/** Identifier */
 	catid_t id;
 
+	/** Change generation at which the membership last changed */
+	sysarg_t change_gen;
+
 	/** Category name */
 	const char *name;
 
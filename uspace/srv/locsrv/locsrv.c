@@ -59,6 +59,8 @@
 typedef struct {
 	link_t cb_sess_list;
 	async_sess_t *sess;
+	/** Change generation last announced to this subscriber */
+	sysarg_t sent_gen;
 } cb_sess_t;
 
 LIST_INITIALIZE(services_list);
@@ -94,6 +96,47 @@ static categ_dir_t cdir;
 static FIBRIL_MUTEX_INITIALIZE(callback_sess_mutex);
 static LIST_INITIALIZE(callback_sess_list);
 
+/**
+ * Category change events are coalesced: event sources merely raise
+ * @c change_event_pending and a dedicated notifier fibril announces the
+ * current generation to the subscribers. A registration storm thus
+ * costs each subscriber a handful of wakeups instead of one per event.
+ */
+static FIBRIL_CONDVAR_INITIALIZE(change_event_cv);
+static bool change_event_pending = false;
+
+/**
+ * Change generation of the service directory. Incremented on every
+ * change (un)registering a service or altering category membership.
+ * Clients compare it against the generation of their cached resolutions
+ * to invalidate them cheaply.
+ */
+static FIBRIL_MUTEX_INITIALIZE(generation_mutex);
+static sysarg_t loc_generation = 0;
+
+/** Note a change to the service directory.
+ *
+ * Increments the change generation published to consumers.
+ */
+static void loc_generation_bump(void)
+{
+	fibril_mutex_lock(&generation_mutex);
+	loc_generation++;
+	fibril_mutex_unlock(&generation_mutex);
+}
+
+/** Get the current change generation. */
+static sysarg_t loc_generation_get(void)
+{
+	sysarg_t gen;
+
+	fibril_mutex_lock(&generation_mutex);
+	gen = loc_generation;
+	fibril_mutex_unlock(&generation_mutex);
+
+	return gen;
+}
+
 service_id_t loc_create_id(void)
 {
 	/*
@@ -316,6 +359,8 @@ static void loc_service_unregister_core(loc_service_t *service)
 	list_remove(&(service->services));
 	list_remove(&(service->server_services));
 
+	loc_generation_bump();
+
 	/* Remove service from all categories. */
 	while (!list_empty(&service->cat_memb)) {
 		link_t *link = list_first(&service->cat_memb);
@@ -324,6 +369,7 @@ static void loc_service_unregister_core(loc_service_t *service)
 		category_t *cat = memb->cat;
 
 		fibril_mutex_lock(&cat->mutex);
+		cat->change_gen = loc_generation_get();
 		category_remove_service(memb);
 		fibril_mutex_unlock(&cat->mutex);
 	}
@@ -535,6 +581,8 @@ static void loc_service_register(ipc_call_t *icall, loc_server_t *server)
 	fibril_condvar_broadcast(&services_list_cv);
 	fibril_mutex_unlock(&services_list_mutex);
 
+	loc_generation_bump();
+
 	async_answer_1(icall, EOK, service->id);
 }
 
@@ -882,14 +930,52 @@ static void loc_callback_create(ipc_call_t *icall)
 void loc_category_change_event(void)
 {
 	fibril_mutex_lock(&callback_sess_mutex);
+	change_event_pending = true;
+	fibril_condvar_signal(&change_event_cv);
+	fibril_mutex_unlock(&callback_sess_mutex);
+}
 
-	list_foreach(callback_sess_list, cb_sess_list, cb_sess_t, cb_sess) {
-		async_exch_t *exch = async_exchange_begin(cb_sess->sess);
-		async_msg_0(exch, LOC_EVENT_CAT_CHANGE);
-		async_exchange_end(exch);
+/** Change event notifier fibril.
+ *
+ * Announces the current change generation to the callback subscribers.
+ * All events raised while a round of notifications is being sent out
+ * collapse into a single further round, and subscribers that have
+ * already been told about the current generation are skipped.
+ *
+ * @param arg Unused.
+ *
+ * @return Never returns.
+ *
+ */
+static errno_t loc_change_notifier(void *arg)
+{
+	fibril_mutex_lock(&callback_sess_mutex);
+
+	while (true) {
+		while (!change_event_pending)
+			fibril_condvar_wait(&change_event_cv,
+			    &callback_sess_mutex);
+
+		change_event_pending = false;
+		sysarg_t gen = loc_generation_get();
+
+		list_foreach(callback_sess_list, cb_sess_list, cb_sess_t,
+		    cb_sess) {
+			if (cb_sess->sent_gen == gen)
+				continue;
+
+			async_exch_t *exch =
+			    async_exchange_begin(cb_sess->sess);
+			async_msg_1(exch, LOC_EVENT_CAT_CHANGE, gen);
+			async_exchange_end(exch);
+
+			cb_sess->sent_gen = gen;
+		}
 	}
 
+	/* Not reached */
 	fibril_mutex_unlock(&callback_sess_mutex);
+	return EOK;
 }
 
 /** Find ID for category specified by name.
@@ -1170,6 +1256,73 @@ static void loc_category_get_svcs(ipc_call_t *icall)
 	async_answer_1(icall, retval, act_size);
 }
 
+/** Get the current change generation of the service directory.
+ *
+ * In answer will be sent EOK and the generation in arg1.
+ *
+ */
+static void loc_get_generation(ipc_call_t *icall)
+{
+	async_answer_1(icall, EOK, loc_generation_get());
+}
+
+/** Get IDs of categories changed since a given generation.
+ *
+ * The client sends the last generation it has processed in arg1. In
+ * answer will be sent EOK, the size of the changed set in arg1 and the
+ * current generation in arg2; the IDs are transferred by a data read.
+ * This lets a subscriber handle any number of coalesced change events
+ * in a single exchange.
+ *
+ */
+static void loc_cat_changed_get(ipc_call_t *icall)
+{
+	ipc_call_t call;
+	size_t size;
+
+	sysarg_t since = ipc_get_arg1(icall);
+
+	if (!async_data_read_receive(&call, &size)) {
+		async_answer_0(&call, EREFUSED);
+		async_answer_0(icall, EREFUSED);
+		return;
+	}
+
+	fibril_mutex_lock(&cdir.mutex);
+
+	category_id_t *id_buf = (category_id_t *) malloc(size);
+	if (id_buf == NULL) {
+		fibril_mutex_unlock(&cdir.mutex);
+		async_answer_0(&call, ENOMEM);
+		async_answer_0(icall, ENOMEM);
+		return;
+	}
+
+	sysarg_t gen = loc_generation_get();
+	size_t buf_cnt = size / sizeof(category_id_t);
+	size_t act_size = 0;
+	size_t pos = 0;
+
+	list_foreach(cdir.categories, cat_list, category_t, cat) {
+		if (cat->change_gen <= since)
+			continue;
+
+		if (pos < buf_cnt) {
+			id_buf[pos] = cat->id;
+			pos++;
+		}
+
+		act_size += sizeof(category_id_t);
+	}
+
+	fibril_mutex_unlock(&cdir.mutex);
+
+	errno_t retval = async_data_read_finalize(&call, id_buf, size);
+	free(id_buf);
+
+	async_answer_2(icall, retval, act_size, gen);
+}
+
 static void loc_null_create(ipc_call_t *icall)
 {
 	fibril_mutex_lock(&null_services_mutex);
@@ -1241,6 +1394,8 @@ static void loc_null_create(ipc_call_t *icall)
 	fibril_mutex_unlock(&services_list_mutex);
 	fibril_mutex_unlock(&null_services_mutex);
 
+	loc_generation_bump();
+
 	async_answer_1(icall, EOK, (sysarg_t) i);
 }
 
@@ -1299,6 +1454,11 @@ static void loc_service_add_to_cat(ipc_call_t *icall)
 	fibril_mutex_lock(&cat->mutex);
 	retval = category_add_service(cat, svc);
 
+	if (retval == EOK) {
+		loc_generation_bump();
+		cat->change_gen = loc_generation_get();
+	}
+
 	fibril_mutex_unlock(&cat->mutex);
 	fibril_mutex_unlock(&cdir.mutex);
 	fibril_mutex_unlock(&services_list_mutex);
@@ -1528,6 +1688,12 @@ static void loc_connection_consumer(ipc_call_t *icall, void *arg)
 		case LOC_GET_SERVICES:
 			loc_get_services(&call);
 			break;
+		case LOC_GET_GENERATION:
+			loc_get_generation(&call);
+			break;
+		case LOC_CAT_CHANGED_GET:
+			loc_cat_changed_get(&call);
+			break;
 		default:
 			async_answer_0(&call, ENOENT);
 		}
@@ -1546,6 +1712,14 @@ int main(int argc, char *argv[])
 		return -1;
 	}
 
+	fid_t fid = fibril_create(loc_change_notifier, NULL);
+	if (fid == 0) {
+		printf("%s: Error creating change notifier fibril\n", NAME);
+		return -1;
+	}
+
+	fibril_add_ready(fid);
+
 	/* Register location service at naming service */
 	errno_t rc = service_register(SERVICE_LOC, INTERFACE_LOC_SUPPLIER,
 	    loc_connection_supplier, NULL);
@@ -40,13 +40,34 @@
 #include <io/logctl.h>
 #include <io/klog.h>
 #include <ns.h>
+#include <as.h>
 #include <async.h>
 #include <errno.h>
+#include <mem.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <str.h>
 #include <str_error.h>
 #include "logger.h"
 
+/** Size of the buffer one ring record is formatted into. */
+#define MESSAGE_BUFFER_SIZE 4096
+
+/** Maximum number of format strings registered by one client. */
+#define MAX_FORMATS_PER_CLIENT 512
+
+/** Per-connection state of the binary log path. */
+typedef struct {
+	/** Message ring shared by the client (NULL if not set up) */
+	logger_ring_t *ring;
+	/** Size of the data area of the ring */
+	size_t ring_dsize;
+	/** Format strings registered by the client */
+	char *fmts[MAX_FORMATS_PER_CLIENT];
+	/** Number of registered format strings */
+	size_t fmt_count;
+} logger_writer_t;
+
 static logger_log_t *handle_create_log(sysarg_t parent)
 {
 	void *name;
@@ -91,6 +112,222 @@ leave:
 	return rc;
 }
 
+static errno_t handle_register_fmt(logger_writer_t *writer, sysarg_t *id)
+{
+	void *fmt;
+	errno_t rc = async_data_write_accept(&fmt, true, 1, 0, 0, NULL);
+	if (rc != EOK)
+		return rc;
+
+	if (writer->fmt_count >= MAX_FORMATS_PER_CLIENT) {
+		free(fmt);
+		return ELIMIT;
+	}
+
+	writer->fmts[writer->fmt_count] = fmt;
+	*id = writer->fmt_count;
+	writer->fmt_count++;
+
+	return EOK;
+}
+
+static errno_t handle_create_ring(logger_writer_t *writer)
+{
+	void *base;
+	size_t size;
+
+	errno_t rc = async_window_accept(&base, &size);
+	if (rc != EOK)
+		return rc;
+
+	if ((size <= sizeof(logger_ring_t)) ||
+	    (((size - sizeof(logger_ring_t)) % 8) != 0)) {
+		as_area_destroy(base);
+		return EINVAL;
+	}
+
+	if (writer->ring != NULL)
+		as_area_destroy(writer->ring);
+
+	writer->ring = base;
+	writer->ring_dsize = size - sizeof(logger_ring_t);
+
+	return EOK;
+}
+
+/** Format a ring record according to its format string.
+ *
+ * Integer arguments were stored as 64-bit values, thus any length
+ * modifier in the format is replaced with @c j and the value replayed
+ * as intmax_t or uintmax_t.
+ */
+static void ring_format_rec(logger_writer_t *writer, logger_ring_rec_t *rec,
+    char *buffer, size_t buffer_size)
+{
+	const char *fmt = writer->fmts[rec->fmt_id];
+	size_t pos = 0;
+	unsigned arg = 0;
+	char spec[32];
+
+	while ((*fmt != 0) && (pos < buffer_size - 1)) {
+		if (*fmt != '%') {
+			buffer[pos++] = *fmt++;
+			continue;
+		}
+
+		/* Copy the conversion specification (without length). */
+		size_t slen = 0;
+		spec[slen++] = *fmt++;
+		while ((*fmt != 0) && (slen < sizeof(spec) - 3) &&
+		    (str_chr("-+ #0123456789.", *fmt) != NULL))
+			spec[slen++] = *fmt++;
+		while ((*fmt == 'h') || (*fmt == 'l') || (*fmt == 'z') ||
+		    (*fmt == 'j') || (*fmt == 't'))
+			fmt++;
+
+		char conv = *fmt;
+		if (conv == 0)
+			break;
+		fmt++;
+
+		if (conv == '%') {
+			buffer[pos++] = '%';
+			continue;
+		}
+
+		if ((arg >= rec->argc) || (arg >= LOGGER_RING_MAX_ARGS))
+			break;
+
+		uint8_t atype = rec->atype[arg];
+		uint64_t aval = rec->aval[arg];
+		arg++;
+
+		int n = 0;
+
+		switch (conv) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			spec[slen++] = 'j';
+			spec[slen++] = conv;
+			spec[slen] = 0;
+			if (atype == LOGGER_ARG_SIGNED)
+				n = snprintf(buffer + pos, buffer_size - pos,
+				    spec, (intmax_t) (int64_t) aval);
+			else
+				n = snprintf(buffer + pos, buffer_size - pos,
+				    spec, (uintmax_t) aval);
+			break;
+		case 'c':
+			spec[slen++] = conv;
+			spec[slen] = 0;
+			n = snprintf(buffer + pos, buffer_size - pos, spec,
+			    (int) aval);
+			break;
+		case 'p':
+			spec[slen++] = conv;
+			spec[slen] = 0;
+			n = snprintf(buffer + pos, buffer_size - pos, spec,
+			    (void *) (uintptr_t) aval);
+			break;
+		case 's': {
+			if ((atype != LOGGER_ARG_STR) || (aval >= rec->size))
+				break;
+			const char *str = (const char *) rec + aval;
+			/* The string must be terminated within the record. */
+			if (memchr(str, 0, rec->size - aval) == NULL)
+				break;
+			spec[slen++] = conv;
+			spec[slen] = 0;
+			n = snprintf(buffer + pos, buffer_size - pos, spec,
+			    str);
+			break;
+		}
+		default:
+			break;
+		}
+
+		if (n > 0) {
+			if ((size_t) n < buffer_size - pos)
+				pos += n;
+			else
+				pos = buffer_size - 1;
+		}
+	}
+
+	buffer[pos] = 0;
+}
+
+static void ring_log_rec(logger_writer_t *writer, logger_ring_rec_t *rec)
+{
+	if (rec->fmt_id >= writer->fmt_count)
+		return;
+
+	if (rec->level >= LVL_LIMIT)
+		return;
+
+	logger_log_t *log = find_log_by_id_and_lock((sysarg_t) rec->log_id);
+	if (log == NULL)
+		return;
+
+	/* Format lazily - only messages someone wants are rendered. */
+	if (!shall_log_message(log, rec->level)) {
+		log_unlock(log);
+		return;
+	}
+
+	char *buffer = malloc(MESSAGE_BUFFER_SIZE);
+	if (buffer == NULL) {
+		log_unlock(log);
+		return;
+	}
+
+	ring_format_rec(writer, rec, buffer, MESSAGE_BUFFER_SIZE);
+
+	KLOG_PRINTF(rec->level, "[%s] %s: %s",
+	    log->full_name, log_level_str(rec->level), buffer);
+	write_to_log(log, rec->level, buffer);
+
+	free(buffer);
+	log_unlock(log);
+}
+
+static void ring_drain(logger_writer_t *writer)
+{
+	logger_ring_t *ring = writer->ring;
+
+	if (ring == NULL)
+		return;
+
+	while (ring->rpos != ring->wpos) {
+		uint64_t rpos = ring->rpos;
+		size_t off = (size_t) (rpos % writer->ring_dsize);
+		logger_ring_rec_t *rec =
+		    (logger_ring_rec_t *) (ring->data + off);
+
+		uint32_t size = rec->size;
+
+		/* Guard against a misbehaving client. */
+		if ((size < 8) || ((size % 8) != 0) ||
+		    (size > writer->ring_dsize - off) ||
+		    (size > ring->wpos - rpos)) {
+			logger_log("writer: corrupted message ring.\n");
+			as_area_destroy(writer->ring);
+			writer->ring = NULL;
+			return;
+		}
+
+		if ((rec->fmt_id != LOGGER_RING_PAD) &&
+		    (size >= sizeof(logger_ring_rec_t)))
+			ring_log_rec(writer, rec);
+
+		ring->rpos = rpos + size;
+	}
+}
+
 void logger_connection_handler_writer(ipc_call_t *icall)
 {
 	logger_log_t *log;
@@ -104,6 +341,11 @@ void logger_connection_handler_writer(ipc_call_t *icall)
 	logger_registered_logs_t registered_logs;
 	registered_logs_init(&registered_logs);
 
+	logger_writer_t writer;
+	writer.ring = NULL;
+	writer.ring_dsize = 0;
+	writer.fmt_count = 0;
+
 	while (true) {
 		ipc_call_t call;
 		async_get_call(&call);
@@ -133,12 +375,38 @@ void logger_connection_handler_writer(ipc_call_t *icall)
 			    ipc_get_arg2(&call));
 			async_answer_0(&call, rc);
 			break;
+		case LOGGER_WRITER_REGISTER_FMT: {
+			sysarg_t fmt_id = 0;
+			rc = handle_register_fmt(&writer, &fmt_id);
+			if (rc == EOK)
+				async_answer_1(&call, EOK, fmt_id);
+			else
+				async_answer_0(&call, rc);
+			break;
+		}
+		case LOGGER_WRITER_CREATE_RING:
+			rc = handle_create_ring(&writer);
+			async_answer_0(&call, rc);
+			break;
+		case LOGGER_WRITER_RING_NOTIFY:
+			ring_drain(&writer);
+			async_answer_0(&call, EOK);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 			break;
 		}
 	}
 
+	if (writer.ring != NULL) {
+		ring_drain(&writer);
+		if (writer.ring != NULL)
+			as_area_destroy(writer.ring);
+	}
+
+	for (size_t i = 0; i < writer.fmt_count; i++)
+		free(writer.fmts[i]);
+
 	unregister_logs(&registered_logs);
 	logger_log("writer: client terminated.\n");
 }
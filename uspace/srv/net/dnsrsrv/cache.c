@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2013 Jiri Svoboda
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup dnsrsrv
+ * @{
+ */
+/**
+ * @file Query result cache.
+ *
+ * Resolved names are cached for the time to live announced by the
+ * server, and names that the server answered without a usable record
+ * are cached negatively for a short fixed time, so that repeated
+ * lookups of the same name do not go to the network each time.
+ */
+
+#include <adt/list.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <stdlib.h>
+#include <str.h>
+#include <time.h>
+
+#include "cache.h"
+#include "dns_std.h"
+#include "dns_type.h"
+
+/** Maximum number of cache entries */
+#define DNS_CACHE_MAX 64
+
+/** Negative result time to live in seconds */
+#define DNS_NCACHE_TTL 30
+
+/** Cached query result */
+typedef struct {
+	link_t cache_link;
+	/** Queried name */
+	char *name;
+	/** Query type */
+	dns_qtype_t qtype;
+	/** Expiration time */
+	struct timespec expires;
+	/** Query succeeded */
+	bool positive;
+	/** Canonical name (positive entries only) */
+	char *cname;
+	/** Host address (positive entries only) */
+	inet_addr_t addr;
+} dns_cache_entry_t;
+
+/** Cache entries, list of @c dns_cache_entry_t */
+static LIST_INITIALIZE(cache_list);
+/** Protects @c cache_list */
+static FIBRIL_MUTEX_INITIALIZE(cache_lock);
+
+static void dns_cache_entry_destroy(dns_cache_entry_t *entry)
+{
+	free(entry->name);
+	free(entry->cname);
+	free(entry);
+}
+
+/** Find cache entry for name and query type, discarding it if expired.
+ *
+ * Caller must hold @c cache_lock.
+ *
+ * @param name	Queried name
+ * @param qtype	Query type
+ * @param now	Current time
+ * @return	Cache entry or @c NULL if not found
+ */
+static dns_cache_entry_t *dns_cache_find(const char *name, dns_qtype_t qtype,
+    struct timespec *now)
+{
+	list_foreach(cache_list, cache_link, dns_cache_entry_t, entry) {
+		if (entry->qtype != qtype || str_cmp(entry->name, name) != 0)
+			continue;
+
+		if (ts_sub_diff(&entry->expires, now) <= 0) {
+			list_remove(&entry->cache_link);
+			dns_cache_entry_destroy(entry);
+			return NULL;
+		}
+
+		return entry;
+	}
+
+	return NULL;
+}
+
+/** Look up query result in the cache.
+ *
+ * @param name	Queried name
+ * @param qtype	Query type
+ * @param info	Place to store host information on a positive hit
+ *
+ * @return	EOK on a positive hit, EIO on a negative hit,
+ *		ENOENT on a miss
+ */
+errno_t dns_cache_lookup(const char *name, dns_qtype_t qtype,
+    dns_host_info_t *info)
+{
+	dns_cache_entry_t *entry;
+	struct timespec now;
+	char *cname;
+
+	getuptime(&now);
+
+	fibril_mutex_lock(&cache_lock);
+	entry = dns_cache_find(name, qtype, &now);
+	if (entry == NULL) {
+		fibril_mutex_unlock(&cache_lock);
+		return ENOENT;
+	}
+
+	if (!entry->positive) {
+		fibril_mutex_unlock(&cache_lock);
+		return EIO;
+	}
+
+	cname = str_dup(entry->cname);
+	if (cname == NULL) {
+		fibril_mutex_unlock(&cache_lock);
+		return ENOENT;
+	}
+
+	info->cname = cname;
+	info->addr = entry->addr;
+	fibril_mutex_unlock(&cache_lock);
+
+	return EOK;
+}
+
+/** Insert query result into the cache.
+ *
+ * Failure to insert is not reported, the caller loses nothing but the
+ * caching.
+ *
+ * @param name	Queried name
+ * @param qtype	Query type
+ * @param info	Host information or @c NULL for a negative result
+ * @param ttl	Time to live in seconds
+ */
+static void dns_cache_insert_entry(const char *name, dns_qtype_t qtype,
+    dns_host_info_t *info, uint32_t ttl)
+{
+	dns_cache_entry_t *entry;
+	dns_cache_entry_t *old;
+	struct timespec now;
+	link_t *link;
+
+	if (ttl == 0)
+		return;
+
+	entry = calloc(1, sizeof(dns_cache_entry_t));
+	if (entry == NULL)
+		return;
+
+	link_initialize(&entry->cache_link);
+	entry->name = str_dup(name);
+	if (entry->name == NULL) {
+		free(entry);
+		return;
+	}
+
+	entry->qtype = qtype;
+	if (info != NULL) {
+		entry->cname = str_dup(info->cname);
+		if (entry->cname == NULL) {
+			dns_cache_entry_destroy(entry);
+			return;
+		}
+
+		entry->addr = info->addr;
+		entry->positive = true;
+	}
+
+	getuptime(&now);
+	entry->expires = now;
+	ts_add_diff(&entry->expires, SEC2NSEC(ttl));
+
+	fibril_mutex_lock(&cache_lock);
+
+	old = dns_cache_find(name, qtype, &now);
+	if (old != NULL) {
+		list_remove(&old->cache_link);
+		dns_cache_entry_destroy(old);
+	}
+
+	/* Keep the cache bounded, evict the oldest entry */
+	if (list_count(&cache_list) >= DNS_CACHE_MAX) {
+		link = list_first(&cache_list);
+		list_remove(link);
+		dns_cache_entry_destroy(list_get_instance(link,
+		    dns_cache_entry_t, cache_link));
+	}
+
+	list_append(&entry->cache_link, &cache_list);
+	fibril_mutex_unlock(&cache_lock);
+}
+
+/** Insert positive query result into the cache.
+ *
+ * @param name	Queried name
+ * @param qtype	Query type
+ * @param info	Host information
+ * @param ttl	Record time to live in seconds
+ */
+void dns_cache_insert(const char *name, dns_qtype_t qtype,
+    dns_host_info_t *info, uint32_t ttl)
+{
+	dns_cache_insert_entry(name, qtype, info, ttl);
+}
+
+/** Insert negative query result into the cache.
+ *
+ * @param name	Queried name
+ * @param qtype	Query type
+ */
+void dns_cache_insert_negative(const char *name, dns_qtype_t qtype)
+{
+	dns_cache_insert_entry(name, qtype, NULL, DNS_NCACHE_TTL);
+}
+
+/** Flush the entire cache.
+ *
+ * Called when the server address is changed, since cached results may
+ * no longer agree with the new server.
+ */
+void dns_cache_flush(void)
+{
+	link_t *link;
+
+	fibril_mutex_lock(&cache_lock);
+
+	while ((link = list_first(&cache_list)) != NULL) {
+		list_remove(link);
+		dns_cache_entry_destroy(list_get_instance(link,
+		    dns_cache_entry_t, cache_link));
+	}
+
+	fibril_mutex_unlock(&cache_lock);
+}
+
+/** @}
+ */
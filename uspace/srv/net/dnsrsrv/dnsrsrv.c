@@ -45,6 +45,7 @@
 #include <str.h>
 #include <task.h>
 
+#include "cache.h"
 #include "dns_msg.h"
 #include "dns_std.h"
 #include "query.h"
@@ -205,6 +206,9 @@ static void dnsr_set_srvaddr_srv(dnsr_client_t *client, ipc_call_t *icall)
 		return;
 	}
 
+	/* Results from the old server may not match the new one */
+	dns_cache_flush();
+
 	async_answer_0(icall, rc);
 }
 
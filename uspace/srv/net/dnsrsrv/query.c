@@ -34,10 +34,13 @@
  */
 
 #include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
 #include <io/log.h>
 #include <mem.h>
 #include <stdlib.h>
 #include <str.h>
+#include "cache.h"
 #include "dns_msg.h"
 #include "dns_std.h"
 #include "dns_type.h"
@@ -45,10 +48,18 @@
 #include "transport.h"
 
 static uint16_t msg_id;
+static FIBRIL_MUTEX_INITIALIZE(msg_id_lock);
 
 static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
     dns_host_info_t *info)
 {
+	errno_t rc;
+
+	/* First look in the cache */
+	rc = dns_cache_lookup(name, qtype, info);
+	if (rc != ENOENT)
+		return rc;
+
 	/* Start with the caller-provided name */
 	char *sname = str_dup(name);
 	if (sname == NULL)
@@ -79,7 +90,9 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 		return ENOMEM;
 	}
 
+	fibril_mutex_lock(&msg_id_lock);
 	msg->id = msg_id++;
+	fibril_mutex_unlock(&msg_id_lock);
 	msg->qr = QR_QUERY;
 	msg->opcode = OPC_QUERY;
 	msg->aa = false;
@@ -91,7 +104,7 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "dns_name_query: send DNS request");
 	dns_message_t *amsg;
-	errno_t rc = dns_request(msg, &amsg);
+	rc = dns_request(msg, &amsg);
 	if (rc != EOK) {
 		dns_message_destroy(msg);
 		free(sname);
@@ -147,6 +160,8 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 			inet_addr_set(dns_uint32_t_decode(rr->rdata, rr->rdata_size),
 			    &info->addr);
 
+			dns_cache_insert(name, qtype, info, rr->ttl);
+
 			dns_message_destroy(msg);
 			dns_message_destroy(amsg);
 			free(sname);
@@ -172,6 +187,8 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 
 			inet_addr_set6(addr, &info->addr);
 
+			dns_cache_insert(name, qtype, info, rr->ttl);
+
 			dns_message_destroy(msg);
 			dns_message_destroy(amsg);
 			free(sname);
@@ -182,6 +199,8 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "'%s' not resolved, fail", sname);
 
+	dns_cache_insert_negative(name, qtype);
+
 	dns_message_destroy(msg);
 	dns_message_destroy(amsg);
 	free(sname);
@@ -189,20 +208,78 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 	return EIO;
 }
 
+/** Subordinate query running in its own fibril */
+typedef struct {
+	fibril_mutex_t lock;
+	fibril_condvar_t cv;
+	bool done;
+	const char *name;
+	dns_qtype_t qtype;
+	dns_host_info_t info;
+	errno_t rc;
+} dns_squery_t;
+
+static errno_t dns_squery_fibril(void *arg)
+{
+	dns_squery_t *sq = (dns_squery_t *) arg;
+
+	sq->rc = dns_name_query(sq->name, sq->qtype, &sq->info);
+
+	fibril_mutex_lock(&sq->lock);
+	sq->done = true;
+	fibril_mutex_unlock(&sq->lock);
+	fibril_condvar_broadcast(&sq->cv);
+
+	return EOK;
+}
+
 errno_t dns_name2host(const char *name, dns_host_info_t **rinfo, ip_ver_t ver)
 {
 	dns_host_info_t *info = calloc(1, sizeof(dns_host_info_t));
 	if (info == NULL)
 		return ENOMEM;
 
+	dns_squery_t sq;
+	fid_t fid;
 	errno_t rc;
 
 	switch (ver) {
 	case ip_any:
+		/* Query for the A record in parallel with the AAAA record */
+		fibril_mutex_initialize(&sq.lock);
+		fibril_condvar_initialize(&sq.cv);
+		sq.done = false;
+		sq.name = name;
+		sq.qtype = DTYPE_A;
+		memset(&sq.info, 0, sizeof(sq.info));
+
+		fid = fibril_create(dns_squery_fibril, &sq);
+		if (fid == 0) {
+			/* Fall back to sequential queries */
+			rc = dns_name_query(name, DTYPE_AAAA, info);
+
+			if (rc != EOK)
+				rc = dns_name_query(name, DTYPE_A, info);
+
+			break;
+		}
+
+		fibril_add_ready(fid);
 		rc = dns_name_query(name, DTYPE_AAAA, info);
 
-		if (rc != EOK)
-			rc = dns_name_query(name, DTYPE_A, info);
+		fibril_mutex_lock(&sq.lock);
+		while (!sq.done)
+			fibril_condvar_wait(&sq.cv, &sq.lock);
+		fibril_mutex_unlock(&sq.lock);
+
+		if (rc != EOK) {
+			rc = sq.rc;
+			if (rc == EOK)
+				*info = sq.info;
+		} else if (sq.rc == EOK) {
+			/* Prefer the AAAA record, discard the A record */
+			free(sq.info.cname);
+		}
 
 		break;
 	case ip_v4:
@@ -44,14 +44,40 @@
 #include "atrans.h"
 #include "ethip.h"
 
-/** Address translation list (of ethip_atrans_t) */
+/** Number of address translation buckets */
+#define ATRANS_NBUCKETS 16
+
+/** Address translation hash table (of ethip_atrans_t) */
 static FIBRIL_MUTEX_INITIALIZE(atrans_list_lock);
-static LIST_INITIALIZE(atrans_list);
+static list_t atrans_bucket[ATRANS_NBUCKETS];
+static bool atrans_initialized = false;
 static FIBRIL_CONDVAR_INITIALIZE(atrans_cv);
 
+/** Map IP address to a hash table bucket.
+ *
+ * Caller must hold @c atrans_list_lock.
+ *
+ * @param ip_addr	IPv4 address
+ * @return		Bucket
+ */
+static list_t *atrans_bucket_get(addr32_t ip_addr)
+{
+	size_t i;
+
+	if (!atrans_initialized) {
+		for (i = 0; i < ATRANS_NBUCKETS; i++)
+			list_initialize(&atrans_bucket[i]);
+		atrans_initialized = true;
+	}
+
+	return &atrans_bucket[ip_addr % ATRANS_NBUCKETS];
+}
+
 static ethip_atrans_t *atrans_find(addr32_t ip_addr)
 {
-	list_foreach(atrans_list, atrans_list, ethip_atrans_t, atrans) {
+	list_t *bucket = atrans_bucket_get(ip_addr);
+
+	list_foreach(*bucket, atrans_list, ethip_atrans_t, atrans) {
 		if (atrans->ip_addr == ip_addr)
 			return atrans;
 	}
@@ -78,7 +104,7 @@ errno_t atrans_add(addr32_t ip_addr, eth_addr_t *mac_addr)
 		free(prev);
 	}
 
-	list_append(&atrans->atrans_list, &atrans_list);
+	list_append(&atrans->atrans_list, atrans_bucket_get(ip_addr));
 	fibril_mutex_unlock(&atrans_list_lock);
 	fibril_condvar_broadcast(&atrans_cv);
 
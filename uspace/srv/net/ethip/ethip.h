@@ -39,6 +39,7 @@
 
 #include <adt/list.h>
 #include <async.h>
+#include <fibril_synch.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
@@ -51,6 +52,15 @@ typedef struct {
 	inet_addr_t addr;
 } ethip_link_addr_t;
 
+/** Frame queued for transmission */
+typedef struct {
+	link_t link;
+	/** Frame data */
+	void *data;
+	/** Frame size in bytes */
+	size_t size;
+} ethip_sframe_t;
+
 typedef struct ethip_nic {
 	link_t link;
 	service_id_t svc_id;
@@ -68,6 +78,15 @@ typedef struct ethip_nic {
 	 * (of the type ethip_link_addr_t)
 	 */
 	list_t addr_list;
+
+	/** Transmit queue (of the type ethip_sframe_t) */
+	list_t frame_queue;
+	/** Number of frames in @c frame_queue */
+	size_t frame_count;
+	/** Protects @c frame_queue */
+	fibril_mutex_t queue_lock;
+	/** Signalled when @c frame_queue changes */
+	fibril_condvar_t queue_cv;
 } ethip_nic_t;
 
 /** Ethernet frame */
@@ -51,8 +51,14 @@
 #include "ethip_nic.h"
 #include "pdu.h"
 
+/** Maximum number of frames passed to the driver in one exchange */
+#define ETHIP_SEND_BATCH_MAX 16
+/** Maximum number of frames in a NIC's transmit queue */
+#define ETHIP_FRAME_QUEUE_MAX 64
+
 static errno_t ethip_nic_open(service_id_t sid);
 static void ethip_nic_cb_conn(ipc_call_t *icall, void *arg);
+static errno_t ethip_nic_send_fibril(void *arg);
 
 static LIST_INITIALIZE(ethip_nic_list);
 static FIBRIL_MUTEX_INITIALIZE(ethip_discovery_lock);
@@ -115,6 +121,9 @@ static ethip_nic_t *ethip_nic_new(void)
 
 	link_initialize(&nic->link);
 	list_initialize(&nic->addr_list);
+	list_initialize(&nic->frame_queue);
+	fibril_mutex_initialize(&nic->queue_lock);
+	fibril_condvar_initialize(&nic->queue_cv);
 
 	return nic;
 }
@@ -209,6 +218,16 @@ static errno_t ethip_nic_open(service_id_t sid)
 		goto error;
 	}
 
+	fid_t fid = fibril_create(ethip_nic_send_fibril, nic);
+	if (fid == 0) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Error creating transmit "
+		    "fibril for '%s'.", nic->svc_name);
+		rc = ENOMEM;
+		goto error;
+	}
+
+	fibril_add_ready(fid);
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "Initialized IP link service,");
 
 	return EOK;
@@ -350,13 +369,88 @@ ethip_nic_t *ethip_nic_find_by_iplink_sid(service_id_t iplink_sid)
 	return NULL;
 }
 
-errno_t ethip_nic_send(ethip_nic_t *nic, void *data, size_t size)
+/** Transmit queue handler fibril.
+ *
+ * Drain the NIC's transmit queue, handing over as many queued frames
+ * as possible to the driver in a single exchange.
+ *
+ * @param arg	NIC (ethip_nic_t *)
+ * @return	Does not return
+ */
+static errno_t ethip_nic_send_fibril(void *arg)
 {
+	ethip_nic_t *nic = (ethip_nic_t *) arg;
+	void *frames[ETHIP_SEND_BATCH_MAX];
+	size_t sizes[ETHIP_SEND_BATCH_MAX];
+	ethip_sframe_t *sframe;
+	link_t *link;
+	size_t count;
+	size_t i;
 	errno_t rc;
+
+	while (true) {
+		fibril_mutex_lock(&nic->queue_lock);
+		while (list_empty(&nic->frame_queue))
+			fibril_condvar_wait(&nic->queue_cv, &nic->queue_lock);
+
+		count = 0;
+		while (count < ETHIP_SEND_BATCH_MAX &&
+		    (link = list_first(&nic->frame_queue)) != NULL) {
+			list_remove(link);
+			sframe = list_get_instance(link, ethip_sframe_t, link);
+			frames[count] = sframe->data;
+			sizes[count] = sframe->size;
+			free(sframe);
+			++count;
+		}
+
+		nic->frame_count -= count;
+		fibril_mutex_unlock(&nic->queue_lock);
+		fibril_condvar_broadcast(&nic->queue_cv);
+
+		rc = nic_send_frames(nic->sess, frames, sizes, count);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "nic_send_frames -> %s",
+		    str_error_name(rc));
+
+		for (i = 0; i < count; i++)
+			free(frames[i]);
+	}
+
+	return EOK;
+}
+
+errno_t ethip_nic_send(ethip_nic_t *nic, void *data, size_t size)
+{
+	ethip_sframe_t *sframe;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_send(size=%zu)", size);
-	rc = nic_send_frame(nic->sess, data, size);
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "nic_send_frame -> %s", str_error_name(rc));
-	return rc;
+
+	sframe = calloc(1, sizeof(ethip_sframe_t));
+	if (sframe == NULL)
+		return ENOMEM;
+
+	sframe->data = malloc(size);
+	if (sframe->data == NULL) {
+		free(sframe);
+		return ENOMEM;
+	}
+
+	memcpy(sframe->data, data, size);
+	sframe->size = size;
+	link_initialize(&sframe->link);
+
+	fibril_mutex_lock(&nic->queue_lock);
+
+	while (nic->frame_count >= ETHIP_FRAME_QUEUE_MAX)
+		fibril_condvar_wait(&nic->queue_cv, &nic->queue_lock);
+
+	list_append(&sframe->link, &nic->frame_queue);
+	++nic->frame_count;
+
+	fibril_mutex_unlock(&nic->queue_lock);
+	fibril_condvar_broadcast(&nic->queue_cv);
+
+	return EOK;
 }
 
 /** Setup accepted multicast addresses
@@ -43,6 +43,7 @@
 #include <stdlib.h>
 #include <str.h>
 #include "addrobj.h"
+#include "dircache.h"
 #include "inetsrv.h"
 #include "inet_link.h"
 #include "ndp.h"
@@ -92,6 +93,7 @@ errno_t inet_addrobj_add(inet_addrobj_t *addr)
 
 	list_append(&addr->addr_list, &addr_list);
 	fibril_mutex_unlock(&addr_list_lock);
+	inet_dircache_invalidate();
 
 	return EOK;
 }
@@ -101,6 +103,7 @@ void inet_addrobj_remove(inet_addrobj_t *addr)
 	fibril_mutex_lock(&addr_list_lock);
 	list_remove(&addr->addr_list);
 	fibril_mutex_unlock(&addr_list_lock);
+	inet_dircache_invalidate();
 }
 
 /** Find address object matching address @a addr.
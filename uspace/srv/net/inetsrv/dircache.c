@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2012 Jiri Svoboda
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup inet
+ * @{
+ */
+/**
+ * @file
+ * @brief Destination direction cache.
+ *
+ * Routing a datagram walks the address object list and possibly the
+ * static route list. The result for a given (destination, TOS) does not
+ * change unless the configuration changes, so it is cached here and the
+ * per-packet send path reduces to a single hash probe. The cache is
+ * flushed whenever an address object or static route is added or
+ * removed.
+ */
+
+#include <adt/list.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <inet/addr.h>
+#include <stdlib.h>
+
+#include "dircache.h"
+#include "inetsrv.h"
+
+/** Number of direction cache buckets */
+#define DIRCACHE_NBUCKETS	16
+/** Maximum number of entries per bucket */
+#define DIRCACHE_BUCKET_MAX	8
+
+/** Direction cache entry */
+typedef struct {
+	link_t cache_link;
+	/** Destination address */
+	inet_addr_t dest;
+	/** Type of service */
+	uint8_t tos;
+	/** Cached direction */
+	inet_dir_t dir;
+} dircache_entry_t;
+
+/** Protects the entire cache */
+static FIBRIL_MUTEX_INITIALIZE(dircache_lock);
+/** Cache buckets, lists of @c dircache_entry_t */
+static list_t dircache_bucket[DIRCACHE_NBUCKETS];
+/** Buckets have been initialized */
+static bool dircache_initialized = false;
+
+/** Initialize cache buckets if not done yet.
+ *
+ * Caller must hold @c dircache_lock.
+ */
+static void dircache_ensure_init(void)
+{
+	unsigned i;
+
+	if (dircache_initialized)
+		return;
+
+	for (i = 0; i < DIRCACHE_NBUCKETS; i++)
+		list_initialize(&dircache_bucket[i]);
+
+	dircache_initialized = true;
+}
+
+/** Map destination address and TOS to a cache bucket.
+ *
+ * @param dest	Destination address
+ * @param tos	Type of service
+ * @return	Bucket
+ */
+static list_t *dircache_bucket_get(inet_addr_t *dest, uint8_t tos)
+{
+	addr32_t v4;
+	addr128_t v6;
+	unsigned h;
+	size_t i;
+
+	h = tos;
+
+	switch (inet_addr_get(dest, &v4, &v6)) {
+	case ip_v4:
+		h ^= v4;
+		break;
+	case ip_v6:
+		for (i = 0; i < sizeof(v6); i++)
+			h = h * 31 + v6[i];
+		break;
+	default:
+		break;
+	}
+
+	return &dircache_bucket[h % DIRCACHE_NBUCKETS];
+}
+
+/** Find cache entry for destination address and TOS.
+ *
+ * Caller must hold @c dircache_lock.
+ *
+ * @param dest	Destination address
+ * @param tos	Type of service
+ * @return	Cache entry or @c NULL if not found
+ */
+static dircache_entry_t *dircache_find(inet_addr_t *dest, uint8_t tos)
+{
+	list_t *bucket = dircache_bucket_get(dest, tos);
+
+	list_foreach(*bucket, cache_link, dircache_entry_t, entry) {
+		if (inet_addr_compare(&entry->dest, dest) &&
+		    entry->tos == tos)
+			return entry;
+	}
+
+	return NULL;
+}
+
+/** Look up cached direction for destination address and TOS.
+ *
+ * @param dest	Destination address
+ * @param tos	Type of service
+ * @param dir	Place to store direction
+ * @return	EOK on success, ENOENT if not found
+ */
+errno_t inet_dircache_lookup(inet_addr_t *dest, uint8_t tos, inet_dir_t *dir)
+{
+	dircache_entry_t *entry;
+
+	fibril_mutex_lock(&dircache_lock);
+	dircache_ensure_init();
+
+	entry = dircache_find(dest, tos);
+	if (entry == NULL) {
+		fibril_mutex_unlock(&dircache_lock);
+		return ENOENT;
+	}
+
+	*dir = entry->dir;
+	fibril_mutex_unlock(&dircache_lock);
+	return EOK;
+}
+
+/** Insert direction for destination address and TOS into the cache.
+ *
+ * Failure to insert is not reported, the caller loses nothing but the
+ * caching.
+ *
+ * @param dest	Destination address
+ * @param tos	Type of service
+ * @param dir	Direction
+ */
+void inet_dircache_insert(inet_addr_t *dest, uint8_t tos, inet_dir_t *dir)
+{
+	dircache_entry_t *entry;
+	list_t *bucket;
+	link_t *link;
+
+	fibril_mutex_lock(&dircache_lock);
+	dircache_ensure_init();
+
+	entry = dircache_find(dest, tos);
+	if (entry != NULL) {
+		entry->dir = *dir;
+		fibril_mutex_unlock(&dircache_lock);
+		return;
+	}
+
+	entry = calloc(1, sizeof(dircache_entry_t));
+	if (entry == NULL) {
+		fibril_mutex_unlock(&dircache_lock);
+		return;
+	}
+
+	link_initialize(&entry->cache_link);
+	entry->dest = *dest;
+	entry->tos = tos;
+	entry->dir = *dir;
+
+	bucket = dircache_bucket_get(dest, tos);
+
+	/* Keep the bucket bounded, evict the oldest entry */
+	if (list_count(bucket) >= DIRCACHE_BUCKET_MAX) {
+		link = list_first(bucket);
+		list_remove(link);
+		free(list_get_instance(link, dircache_entry_t, cache_link));
+	}
+
+	list_append(&entry->cache_link, bucket);
+	fibril_mutex_unlock(&dircache_lock);
+}
+
+/** Flush the entire cache.
+ *
+ * Called whenever address objects or static routes change, since any
+ * cached direction may have become stale.
+ */
+void inet_dircache_invalidate(void)
+{
+	link_t *link;
+	unsigned i;
+
+	fibril_mutex_lock(&dircache_lock);
+	dircache_ensure_init();
+
+	for (i = 0; i < DIRCACHE_NBUCKETS; i++) {
+		while ((link = list_first(&dircache_bucket[i])) != NULL) {
+			list_remove(link);
+			free(list_get_instance(link, dircache_entry_t,
+			    cache_link));
+		}
+	}
+
+	fibril_mutex_unlock(&dircache_lock);
+}
+
+/** @}
+ */
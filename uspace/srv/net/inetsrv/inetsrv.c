@@ -49,6 +49,7 @@
 #include <stdint.h>
 #include <task.h>
 #include "addrobj.h"
+#include "dircache.h"
 #include "icmp.h"
 #include "icmp_std.h"
 #include "icmpv6.h"
@@ -89,8 +90,12 @@ static errno_t inet_init(void)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_init()");
 
+	errno_t rc = inet_reass_init();
+	if (rc != EOK)
+		return rc;
+
 	port_id_t port;
-	errno_t rc = async_create_port(INTERFACE_INET,
+	rc = async_create_port(INTERFACE_INET,
 	    inet_default_conn, NULL, &port);
 	if (rc != EOK)
 		return rc;
@@ -144,6 +149,9 @@ static errno_t inet_find_dir(inet_addr_t *src, inet_addr_t *dest, uint8_t tos,
 	/* XXX Handle case where source address is specified */
 	(void) src;
 
+	if (inet_dircache_lookup(dest, tos, dir) == EOK)
+		return EOK;
+
 	dir->aobj = inet_addrobj_find(dest, iaf_net);
 	if (dir->aobj != NULL) {
 		dir->ldest = *dest;
@@ -163,6 +171,7 @@ static errno_t inet_find_dir(inet_addr_t *src, inet_addr_t *dest, uint8_t tos,
 		return ENOENT;
 	}
 
+	inet_dircache_insert(dest, tos, dir);
 	return EOK;
 }
 
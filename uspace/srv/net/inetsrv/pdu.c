@@ -48,42 +48,6 @@
 #include "inet_std.h"
 #include "pdu.h"
 
-/** One's complement addition.
- *
- * Result is a + b + carry.
- */
-static uint16_t inet_ocadd16(uint16_t a, uint16_t b)
-{
-	uint32_t s;
-
-	s = (uint32_t)a + (uint32_t)b;
-	return (s & 0xffff) + (s >> 16);
-}
-
-uint16_t inet_checksum_calc(uint16_t ivalue, void *data, size_t size)
-{
-	uint16_t sum;
-	uint16_t w;
-	size_t words, i;
-	uint8_t *bdata;
-
-	sum = ~ivalue;
-	words = size / 2;
-	bdata = (uint8_t *)data;
-
-	for (i = 0; i < words; i++) {
-		w = ((uint16_t)bdata[2 * i] << 8) | bdata[2 * i + 1];
-		sum = inet_ocadd16(sum, w);
-	}
-
-	if (size % 2 != 0) {
-		w = ((uint16_t)bdata[2 * words] << 8);
-		sum = inet_ocadd16(sum, w);
-	}
-
-	return ~sum;
-}
-
 /** Encode IPv4 PDU.
  *
  * Encode internet packet into PDU (serialized form). Will encode a
@@ -297,6 +261,9 @@ errno_t inet_pdu_encode6(inet_packet_t *packet, addr128_t src, addr128_t dest,
 }
 
 /** Decode IPv4 datagram
+ *
+ * The packet data references the payload within @a data and is only
+ * valid as long as @a data.
  *
  * @param data    Serialized IPv4 datagram
  * @param size    Length of serialized IPv4 datagram
@@ -305,7 +272,6 @@ errno_t inet_pdu_encode6(inet_packet_t *packet, addr128_t src, addr128_t dest,
  *
  * @return EOK on success
  * @return EINVAL if the datagram is invalid or damaged
- * @return ENOMEM if not enough memory
  *
  */
 errno_t inet_pdu_decode(void *data, size_t size, service_id_t link_id,
@@ -361,19 +327,22 @@ errno_t inet_pdu_decode(void *data, size_t size, service_id_t link_id,
 	    BIT_RANGE_EXTRACT(uint8_t, VI_IHL_h, VI_IHL_l, hdr->ver_ihl);
 
 	packet->size = tot_len - data_offs;
-	packet->data = calloc(packet->size, 1);
-	if (packet->data == NULL) {
-		log_msg(LOG_DEFAULT, LVL_WARN, "Out of memory.");
-		return ENOMEM;
-	}
 
-	memcpy(packet->data, (uint8_t *) data + data_offs, packet->size);
+	/*
+	 * Reference the payload in place instead of copying it. It is
+	 * only valid as long as the PDU it was decoded from; consumers
+	 * that need the data longer (reassembly) make their own copy.
+	 */
+	packet->data = (uint8_t *) data + data_offs;
 	packet->link_id = link_id;
 
 	return EOK;
 }
 
 /** Decode IPv6 datagram
+ *
+ * The packet data references the payload within @a data and is only
+ * valid as long as @a data.
  *
  * @param data    Serialized IPv6 datagram
  * @param size    Length of serialized IPv6 datagram
@@ -382,7 +351,6 @@ errno_t inet_pdu_decode(void *data, size_t size, service_id_t link_id,
  *
  * @return EOK on success
  * @return EINVAL if the datagram is invalid or damaged
- * @return ENOMEM if not enough memory
  *
  */
 errno_t inet_pdu_decode6(void *data, size_t size, service_id_t link_id,
@@ -455,13 +423,13 @@ errno_t inet_pdu_decode6(void *data, size_t size, service_id_t link_id,
 	packet->offs = foff * FRAG_OFFS_UNIT;
 
 	packet->size = payload_len;
-	packet->data = calloc(packet->size, 1);
-	if (packet->data == NULL) {
-		log_msg(LOG_DEFAULT, LVL_WARN, "Out of memory.");
-		return ENOMEM;
-	}
 
-	memcpy(packet->data, (uint8_t *) data + data_offs, packet->size);
+	/*
+	 * Reference the payload in place instead of copying it. It is
+	 * only valid as long as the PDU it was decoded from; consumers
+	 * that need the data longer (reassembly) make their own copy.
+	 */
+	packet->data = (uint8_t *) data + data_offs;
 	packet->link_id = link_id;
 	return EOK;
 }
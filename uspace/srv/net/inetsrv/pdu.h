@@ -37,16 +37,13 @@
 #ifndef INET_PDU_H_
 #define INET_PDU_H_
 
+#include <inet/checksum.h>
 #include <loc.h>
 #include <stddef.h>
 #include <stdint.h>
 #include "inetsrv.h"
 #include "ndp.h"
 
-#define INET_CHECKSUM_INIT 0xffff
-
-extern uint16_t inet_checksum_calc(uint16_t, void *, size_t);
-
 extern errno_t inet_pdu_encode(inet_packet_t *, addr32_t, addr32_t, size_t, size_t,
     void **, size_t *, size_t *);
 extern errno_t inet_pdu_encode6(inet_packet_t *, addr128_t, addr128_t, size_t,
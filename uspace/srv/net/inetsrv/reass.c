@@ -32,19 +32,45 @@
 /**
  * @file
  * @brief Datagram reassembly.
+ *
+ * Partial datagrams are kept in a hash table keyed by (source address,
+ * destination address, protocol, identification), each bucket protected
+ * by its own lock, so that concurrent fragment bursts belonging to
+ * different flows do not serialize on a single list. Datagrams that are
+ * not completed within the reassembly timeout are discarded by a
+ * periodic sweep.
  */
 
 #include <errno.h>
 #include <fibril_synch.h>
+#include <inet/addr.h>
 #include <io/log.h>
 #include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "inetsrv.h"
 #include "inet_std.h"
 #include "reass.h"
 
+/** Number of reassembly map buckets */
+#define REASS_NBUCKETS	16
+
+/** Reassembly timeout in microseconds */
+#define REASS_TIMEOUT	(30 * 1000 * 1000)
+
+/** Interval between sweeps for expired datagrams in microseconds */
+#define REASS_CLEANUP_INT	(10 * 1000 * 1000)
+
+/** Reassembly map bucket */
+typedef struct {
+	/** Protects @c dgrams */
+	fibril_mutex_t lock;
+	/** Datagrams being reassembled, @c reass_dgram_t */
+	list_t dgrams;
+} reass_bucket_t;
+
 /** Datagram being reassembled.
  *
  * Uniquely identified by (source address, destination address, protocol,
@@ -52,6 +78,8 @@
  */
 typedef struct {
 	link_t map_link;
+	/** Time when the first fragment arrived */
+	struct timespec ctime;
 	/** List of fragments, @c reass_frag_t */
 	list_t frags;
 } reass_dgram_t;
@@ -62,18 +90,84 @@ typedef struct {
 	inet_packet_t packet;
 } reass_frag_t;
 
-/** Datagram map, list of reass_dgram_t */
-static LIST_INITIALIZE(reass_dgram_map);
-/** Protects access to @c reass_dgram_map */
-static FIBRIL_MUTEX_INITIALIZE(reass_dgram_map_lock);
+/** Datagram map */
+static reass_bucket_t reass_buckets[REASS_NBUCKETS];
+/** Timer sweeping the map for expired datagrams */
+static fibril_timer_t *reass_timer;
 
-static reass_dgram_t *reass_dgram_new(void);
-static reass_dgram_t *reass_dgram_get(inet_packet_t *);
+static reass_dgram_t *reass_dgram_new(reass_bucket_t *);
+static reass_dgram_t *reass_dgram_get(reass_bucket_t *, inet_packet_t *);
 static errno_t reass_dgram_insert_frag(reass_dgram_t *, inet_packet_t *);
 static bool reass_dgram_complete(reass_dgram_t *);
 static void reass_dgram_remove(reass_dgram_t *);
 static errno_t reass_dgram_deliver(reass_dgram_t *);
 static void reass_dgram_destroy(reass_dgram_t *);
+static void reass_cleanup_timeout(void *);
+
+/** Initialize datagram reassembly.
+ *
+ * @return		EOK on success or ENOMEM.
+ */
+errno_t inet_reass_init(void)
+{
+	unsigned i;
+
+	for (i = 0; i < REASS_NBUCKETS; i++) {
+		fibril_mutex_initialize(&reass_buckets[i].lock);
+		list_initialize(&reass_buckets[i].dgrams);
+	}
+
+	reass_timer = fibril_timer_create(NULL);
+	if (reass_timer == NULL)
+		return ENOMEM;
+
+	fibril_timer_set(reass_timer, REASS_CLEANUP_INT, reass_cleanup_timeout,
+	    NULL);
+	return EOK;
+}
+
+/** Map packet to a reassembly bucket.
+ *
+ * All fragments of one datagram map to the same bucket.
+ *
+ * @param packet	Packet
+ * @return		Bucket
+ */
+static reass_bucket_t *reass_packet_bucket(inet_packet_t *packet)
+{
+	addr32_t v4;
+	addr128_t v6;
+	unsigned h;
+	size_t i;
+
+	h = ((unsigned) packet->proto << 16) ^ packet->ident;
+
+	switch (inet_addr_get(&packet->src, &v4, &v6)) {
+	case ip_v4:
+		h ^= v4;
+		break;
+	case ip_v6:
+		for (i = 0; i < sizeof(v6); i++)
+			h = h * 31 + v6[i];
+		break;
+	default:
+		break;
+	}
+
+	switch (inet_addr_get(&packet->dest, &v4, &v6)) {
+	case ip_v4:
+		h ^= v4;
+		break;
+	case ip_v6:
+		for (i = 0; i < sizeof(v6); i++)
+			h = h * 31 + v6[i];
+		break;
+	default:
+		break;
+	}
+
+	return &reass_buckets[h % REASS_NBUCKETS];
+}
 
 /** Queue packet for datagram reassembly.
  *
@@ -82,32 +176,36 @@ static void reass_dgram_destroy(reass_dgram_t *);
  */
 errno_t inet_reass_queue_packet(inet_packet_t *packet)
 {
+	reass_bucket_t *bucket;
 	reass_dgram_t *rdg;
 	errno_t rc;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_reass_queue_packet()");
 
-	fibril_mutex_lock(&reass_dgram_map_lock);
+	bucket = reass_packet_bucket(packet);
+	fibril_mutex_lock(&bucket->lock);
 
 	/* Get existing or new datagram */
-	rdg = reass_dgram_get(packet);
+	rdg = reass_dgram_get(bucket, packet);
 	if (rdg == NULL) {
 		/* Only happens when we are out of memory */
-		fibril_mutex_unlock(&reass_dgram_map_lock);
+		fibril_mutex_unlock(&bucket->lock);
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "Allocation failed, packet dropped.");
 		return ENOMEM;
 	}
 
 	/* Insert fragment into the datagram */
 	rc = reass_dgram_insert_frag(rdg, packet);
-	if (rc != EOK)
+	if (rc != EOK) {
+		fibril_mutex_unlock(&bucket->lock);
 		return ENOMEM;
+	}
 
 	/* Check if datagram is complete */
 	if (reass_dgram_complete(rdg)) {
 		/* Remove it from the map */
 		reass_dgram_remove(rdg);
-		fibril_mutex_unlock(&reass_dgram_map_lock);
+		fibril_mutex_unlock(&bucket->lock);
 
 		/* Deliver complete datagram */
 		rc = reass_dgram_deliver(rdg);
@@ -115,20 +213,22 @@ errno_t inet_reass_queue_packet(inet_packet_t *packet)
 		return rc;
 	}
 
-	fibril_mutex_unlock(&reass_dgram_map_lock);
+	fibril_mutex_unlock(&bucket->lock);
 	return EOK;
 }
 
 /** Get datagram reassembly structure for packet.
  *
+ * @param bucket	Bucket the packet maps to
  * @param packet	Packet
  * @return		Datagram reassembly structure matching @a packet
  */
-static reass_dgram_t *reass_dgram_get(inet_packet_t *packet)
+static reass_dgram_t *reass_dgram_get(reass_bucket_t *bucket,
+    inet_packet_t *packet)
 {
-	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
+	assert(fibril_mutex_is_locked(&bucket->lock));
 
-	list_foreach(reass_dgram_map, map_link, reass_dgram_t, rdg) {
+	list_foreach(bucket->dgrams, map_link, reass_dgram_t, rdg) {
 		link_t *f1_link = list_first(&rdg->frags);
 		assert(f1_link != NULL);
 
@@ -145,14 +245,15 @@ static reass_dgram_t *reass_dgram_get(inet_packet_t *packet)
 	}
 
 	/* No existing reassembly structure. Create a new one. */
-	return reass_dgram_new();
+	return reass_dgram_new(bucket);
 }
 
 /** Create new datagram reassembly structure.
  *
+ * @param bucket	Bucket to insert the new structure into
  * @return New datagram reassembly structure.
  */
-static reass_dgram_t *reass_dgram_new(void)
+static reass_dgram_t *reass_dgram_new(reass_bucket_t *bucket)
 {
 	reass_dgram_t *rdg;
 
@@ -160,7 +261,8 @@ static reass_dgram_t *reass_dgram_new(void)
 	if (rdg == NULL)
 		return NULL;
 
-	list_append(&rdg->map_link, &reass_dgram_map);
+	getuptime(&rdg->ctime);
+	list_append(&rdg->map_link, &bucket->dgrams);
 	list_initialize(&rdg->frags);
 
 	return rdg;
@@ -185,9 +287,9 @@ static errno_t reass_dgram_insert_frag(reass_dgram_t *rdg, inet_packet_t *packet
 	void *data_copy;
 	link_t *link;
 
-	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
-
 	frag = reass_frag_new();
+	if (frag == NULL)
+		return ENOMEM;
 
 	/* Clone the packet */
 
@@ -240,7 +342,6 @@ static bool reass_dgram_complete(reass_dgram_t *rdg)
 	reass_frag_t *frag, *prev;
 	link_t *link;
 
-	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
 	assert(!list_empty(&rdg->frags));
 
 	link = list_first(&rdg->frags);
@@ -281,10 +382,60 @@ static bool reass_dgram_complete(reass_dgram_t *rdg)
  */
 static void reass_dgram_remove(reass_dgram_t *rdg)
 {
-	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
 	list_remove(&rdg->map_link);
 }
 
+/** Discard datagrams that have not completed within the timeout.
+ *
+ * @param arg		Not used
+ */
+static void reass_cleanup_timeout(void *arg)
+{
+	struct timespec now;
+	reass_bucket_t *bucket;
+	reass_dgram_t *rdg;
+	list_t expired;
+	link_t *link;
+	link_t *next;
+	unsigned i;
+
+	(void) arg;
+
+	getuptime(&now);
+	list_initialize(&expired);
+
+	for (i = 0; i < REASS_NBUCKETS; i++) {
+		bucket = &reass_buckets[i];
+
+		fibril_mutex_lock(&bucket->lock);
+		link = list_first(&bucket->dgrams);
+		while (link != NULL) {
+			next = list_next(link, &bucket->dgrams);
+			rdg = list_get_instance(link, reass_dgram_t, map_link);
+
+			if (ts_sub_diff(&now, &rdg->ctime) >=
+			    USEC2NSEC(REASS_TIMEOUT)) {
+				list_remove(&rdg->map_link);
+				list_append(&rdg->map_link, &expired);
+			}
+
+			link = next;
+		}
+		fibril_mutex_unlock(&bucket->lock);
+	}
+
+	while ((link = list_first(&expired)) != NULL) {
+		list_remove(link);
+		rdg = list_get_instance(link, reass_dgram_t, map_link);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Reassembly timed out, "
+		    "datagram dropped.");
+		reass_dgram_destroy(rdg);
+	}
+
+	fibril_timer_set(reass_timer, REASS_CLEANUP_INT, reass_cleanup_timeout,
+	    NULL);
+}
+
 /** Deliver complete datagram.
  *
  * @param rdg		Datagram reassembly structure.
@@ -39,6 +39,7 @@
 
 #include "inetsrv.h"
 
+extern errno_t inet_reass_init(void);
 extern errno_t inet_reass_queue_packet(inet_packet_t *);
 
 #endif
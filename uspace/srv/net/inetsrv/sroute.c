@@ -41,6 +41,7 @@
 #include <ipc/loc.h>
 #include <stdlib.h>
 #include <str.h>
+#include "dircache.h"
 #include "sroute.h"
 #include "inetsrv.h"
 #include "inet_link.h"
@@ -79,6 +80,7 @@ void inet_sroute_add(inet_sroute_t *sroute)
 	fibril_mutex_lock(&sroute_list_lock);
 	list_append(&sroute->sroute_list, &sroute_list);
 	fibril_mutex_unlock(&sroute_list_lock);
+	inet_dircache_invalidate();
 }
 
 void inet_sroute_remove(inet_sroute_t *sroute)
@@ -86,6 +88,7 @@ void inet_sroute_remove(inet_sroute_t *sroute)
 	fibril_mutex_lock(&sroute_list_lock);
 	list_remove(&sroute->sroute_list);
 	fibril_mutex_unlock(&sroute_list_lock);
+	inet_dircache_invalidate();
 }
 
 /** Find static route object matching address @a addr.
@@ -39,6 +39,7 @@
 #include <inet/endpoint.h>
 #include <io/log.h>
 #include <macros.h>
+#include <mem.h>
 #include <nettl/amap.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -49,16 +50,21 @@
 #include "rqueue.h"
 #include "segment.h"
 #include "seq_no.h"
+#include "std.h"
 #include "tcp_type.h"
 #include "tqueue.h"
+#include "twheel.h"
 #include "ucall.h"
 
-#define RCV_BUF_SIZE 4096/*2*/
+#define RCV_BUF_SIZE (256 * 1024)
 #define SND_BUF_SIZE 4096
 
 #define MAX_SEGMENT_LIFETIME	(15*1000*1000) //(2*60*1000*1000)
 #define TIME_WAIT_TIMEOUT	(2*MAX_SEGMENT_LIFETIME)
 
+/** Number of duplicate ACKs that trigger fast retransmit (RFC 5681) */
+#define TCP_DUP_ACK_THRESH	3
+
 /** List of all allocated connections */
 static LIST_INITIALIZE(conn_list);
 /** Taken after tcp_conn_t lock */
@@ -122,7 +128,7 @@ tcp_conn_t *tcp_conn_new(inet_ep2_t *epp)
 
 	fibril_mutex_initialize(&conn->lock);
 
-	conn->tw_timer = fibril_timer_create(&conn->lock);
+	conn->tw_timer = tcp_twheel_timer_create(&conn->lock);
 	if (conn->tw_timer == NULL)
 		goto error;
 
@@ -152,6 +158,23 @@ tcp_conn_t *tcp_conn_new(inet_ep2_t *epp)
 	/* Set up receive window. */
 	conn->rcv_wnd = conn->rcv_buf_size;
 
+	/*
+	 * Choose the smallest window scale factor (RFC 1323) which can
+	 * advertise the entire receive buffer.
+	 */
+	conn->rcv_wnd_scale = 0;
+	while ((conn->rcv_buf_size >> conn->rcv_wnd_scale) > UINT16_MAX &&
+	    conn->rcv_wnd_scale < TCP_WSCALE_SHIFT_MAX)
+		conn->rcv_wnd_scale++;
+
+	/*
+	 * Congestion control (RFC 5681). Start in slow start with the
+	 * initial window; the slow start threshold is initially
+	 * effectively unlimited.
+	 */
+	conn->cwnd = 4 * TCP_MSS;
+	conn->ssthresh = UINT32_MAX;
+
 	/* Initialize incoming segment queue */
 	tcp_iqueue_init(&conn->incoming, conn);
 
@@ -190,7 +213,7 @@ error:
 	if (conn != NULL && conn->snd_buf != NULL)
 		free(conn->snd_buf);
 	if (conn != NULL && conn->tw_timer != NULL)
-		fibril_timer_destroy(conn->tw_timer);
+		tcp_twheel_timer_destroy(conn->tw_timer);
 	if (conn != NULL)
 		free(conn);
 
@@ -226,7 +249,7 @@ static void tcp_conn_free(tcp_conn_t *conn)
 	if (conn->snd_buf != NULL)
 		free(conn->snd_buf);
 	if (conn->tw_timer != NULL)
-		fibril_timer_destroy(conn->tw_timer);
+		tcp_twheel_timer_destroy(conn->tw_timer);
 	free(conn);
 }
 
@@ -560,6 +583,22 @@ static void tcp_conn_sa_listen(tcp_conn_t *conn, tcp_segment_t *seg)
 	conn->snd_wl1 = seg->seq;
 	conn->snd_wl2 = seg->seq;
 
+	/*
+	 * Negotiate window scaling (RFC 1323). Window scaling is only in
+	 * effect if both sides included the option in their SYN. Scaled
+	 * windows first apply to segments following the SYN,ACK.
+	 */
+	if (seg->has_wscale) {
+		conn->wnd_scale = true;
+		conn->snd_wnd_scale = min(seg->wscale, TCP_WSCALE_SHIFT_MAX);
+	} else {
+		conn->wnd_scale = false;
+		conn->rcv_wnd_scale = 0;
+	}
+
+	/* Selective acknowledgment (RFC 2018) likewise requires both SYNs */
+	conn->sack_ok = seg->sack_permitted;
+
 	tcp_conn_state_set(conn, st_syn_received);
 
 	tcp_tqueue_ctrl_seg(conn, CTL_SYN | CTL_ACK /* XXX */);
@@ -638,6 +677,21 @@ static void tcp_conn_sa_syn_sent(tcp_conn_t *conn, tcp_segment_t *seg)
 	conn->snd_wl1 = seg->seq;
 	conn->snd_wl2 = seg->seq;
 
+	/*
+	 * Our SYN offered window scaling (RFC 1323). It is only in effect
+	 * if the peer included the option as well.
+	 */
+	if (seg->has_wscale) {
+		conn->wnd_scale = true;
+		conn->snd_wnd_scale = min(seg->wscale, TCP_WSCALE_SHIFT_MAX);
+	} else {
+		conn->wnd_scale = false;
+		conn->rcv_wnd_scale = 0;
+	}
+
+	/* Selective acknowledgment (RFC 2018) likewise requires both SYNs */
+	conn->sack_ok = seg->sack_permitted;
+
 	if (seq_no_syn_acked(conn)) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: syn acked -> Established", conn->name);
 		tcp_conn_state_set(conn, st_established);
@@ -684,6 +738,13 @@ static void tcp_conn_sa_queue(tcp_conn_t *conn, tcp_segment_t *seg)
 	 */
 	while (tcp_iqueue_get_ready_seg(&conn->incoming, &pseg) == EOK)
 		tcp_conn_seg_process(conn, pseg);
+
+	/*
+	 * If out-of-order data remains queued, send a duplicate ACK carrying
+	 * SACK blocks (RFC 2018) so the peer learns which ranges arrived.
+	 */
+	if (conn->sack_ok && !list_empty(&conn->incoming.list))
+		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
 }
 
 /** Process segment RST field.
@@ -802,6 +863,68 @@ static cproc_t tcp_conn_seg_proc_ack_sr(tcp_conn_t *conn, tcp_segment_t *seg)
 	return cp_continue;
 }
 
+/** Grow the congestion window for newly acknowledged data (RFC 5681).
+ *
+ * @param conn		Connection
+ * @param acked		Number of newly acknowledged sequence numbers
+ */
+static void tcp_conn_cc_acked(tcp_conn_t *conn, uint32_t acked)
+{
+	conn->dup_acks = 0;
+
+	if (conn->in_recovery) {
+		if (conn->snd_una - conn->snd_rec <= UINT32_MAX / 2) {
+			/* Recovery point reached, deflate the window */
+			conn->cwnd = conn->ssthresh;
+			conn->in_recovery = false;
+		} else {
+			/*
+			 * Partial acknowledgement (RFC 6582), retransmit
+			 * the next missing segment immediately.
+			 */
+			tcp_tqueue_fast_retransmit(conn);
+			return;
+		}
+	}
+
+	if (conn->cwnd < conn->ssthresh) {
+		/* Slow start */
+		conn->cwnd += min(acked, TCP_MSS);
+	} else {
+		/* Congestion avoidance */
+		conn->cwnd += max(1, TCP_MSS * TCP_MSS / conn->cwnd);
+	}
+}
+
+/** Account for a duplicate acknowledgement (RFC 5681).
+ *
+ * The third consecutive duplicate ACK triggers fast retransmit and
+ * fast recovery.
+ *
+ * @param conn		Connection
+ */
+static void tcp_conn_cc_dup_ack(tcp_conn_t *conn)
+{
+	uint32_t flight;
+
+	++conn->dup_acks;
+
+	if (conn->dup_acks == TCP_DUP_ACK_THRESH) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: fast retransmit",
+		    conn->name);
+		flight = conn->snd_nxt - conn->snd_una;
+		conn->ssthresh = max(flight / 2, 2 * TCP_MSS);
+		conn->cwnd = conn->ssthresh + TCP_DUP_ACK_THRESH * TCP_MSS;
+		conn->snd_rec = conn->snd_nxt;
+		conn->in_recovery = true;
+		tcp_tqueue_fast_retransmit(conn);
+	} else if (conn->dup_acks > TCP_DUP_ACK_THRESH) {
+		/* Each further duplicate ACK means a segment has left */
+		conn->cwnd += TCP_MSS;
+		tcp_tqueue_new_data(conn);
+	}
+}
+
 /** Process segment ACK field in Established state.
  *
  * @param conn		Connection
@@ -811,6 +934,8 @@ static cproc_t tcp_conn_seg_proc_ack_sr(tcp_conn_t *conn, tcp_segment_t *seg)
  */
 static cproc_t tcp_conn_seg_proc_ack_est(tcp_conn_t *conn, tcp_segment_t *seg)
 {
+	uint32_t acked;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_seg_proc_ack_est(%p, %p)", conn, seg);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "SEG.ACK=%u, SND.UNA=%u, SND.NXT=%u",
@@ -828,14 +953,17 @@ static cproc_t tcp_conn_seg_proc_ack_est(tcp_conn_t *conn, tcp_segment_t *seg)
 			return cp_done;
 		} else {
 			log_msg(LOG_DEFAULT, LVL_DEBUG, "Ignoring duplicate ACK.");
+			tcp_conn_cc_dup_ack(conn);
 		}
 	} else {
 		/* Update SND.UNA */
+		acked = seg->ack - conn->snd_una;
 		conn->snd_una = seg->ack;
+		tcp_conn_cc_acked(conn, acked);
 	}
 
 	if (seq_no_new_wnd_update(conn, seg)) {
-		conn->snd_wnd = seg->wnd;
+		conn->snd_wnd = seg->wnd << conn->snd_wnd_scale;
 		conn->snd_wl1 = seg->seq;
 		conn->snd_wl2 = seg->ack;
 
@@ -844,6 +972,12 @@ static cproc_t tcp_conn_seg_proc_ack_est(tcp_conn_t *conn, tcp_segment_t *seg)
 		    conn->snd_wnd, conn->snd_wl1, conn->snd_wl2);
 	}
 
+	/* Record SACK blocks reported by the peer (RFC 2018) */
+	if (conn->sack_ok && seg->nsacks > 0) {
+		conn->snd_nsacks = seg->nsacks;
+		memcpy(conn->snd_sacks, seg->sacks, sizeof(conn->snd_sacks));
+	}
+
 	/*
 	 * Prune acked segments from retransmission queue and
 	 * possibly transmit more data.
@@ -1343,7 +1477,7 @@ void tcp_conn_tw_timer_set(tcp_conn_t *conn)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "tcp_conn_tw_timer_set() begin");
 	tcp_conn_addref(conn);
-	fibril_timer_set_locked(conn->tw_timer, TIME_WAIT_TIMEOUT,
+	tcp_twheel_timer_set_locked(conn->tw_timer, TIME_WAIT_TIMEOUT,
 	    tw_timeout_func, (void *)conn);
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "tcp_conn_tw_timer_set() end");
 }
@@ -1355,7 +1489,7 @@ void tcp_conn_tw_timer_set(tcp_conn_t *conn)
 void tcp_conn_tw_timer_clear(tcp_conn_t *conn)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "tcp_conn_tw_timer_clear() begin");
-	if (fibril_timer_clear_locked(conn->tw_timer) == fts_active)
+	if (tcp_twheel_timer_clear_locked(conn->tw_timer) == fts_active)
 		tcp_conn_delref(conn);
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "tcp_conn_tw_timer_clear() end");
 }
@@ -39,6 +39,9 @@
 #include <stdbool.h>
 #include "tcp_type.h"
 
+/** Sender maximum segment size used by congestion control (RFC 5681) */
+#define TCP_MSS 1460
+
 extern errno_t tcp_conns_init(void);
 extern void tcp_conns_fini(void);
 extern tcp_conn_t *tcp_conn_new(inet_ep2_t *);
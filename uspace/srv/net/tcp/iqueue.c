@@ -127,6 +127,65 @@ void tcp_iqueue_remove_seg(tcp_iqueue_t *iqueue, tcp_segment_t *seg)
 	assert(false);
 }
 
+/** Report ranges of out-of-order data held in the incoming queue.
+ *
+ * Produce up to @a max SACK blocks (RFC 2018) describing the data held
+ * in the queue. The queue is sorted by sequence number, so adjacent and
+ * overlapping segments merge into a single block.
+ *
+ * @param iqueue	Incoming queue
+ * @param blocks	Array of at least @a max blocks to fill in
+ * @param max		Maximum number of blocks to produce
+ * @param nblocks	Place to store number of blocks produced
+ */
+void tcp_iqueue_get_sacks(tcp_iqueue_t *iqueue, tcp_sack_block_t *blocks,
+    unsigned max, unsigned *nblocks)
+{
+	uint32_t base = iqueue->conn->rcv_nxt;
+	uint32_t bleft, bright;
+	uint32_t sleft, sright;
+	unsigned cnt;
+	bool have;
+
+	cnt = 0;
+	have = false;
+	bleft = bright = 0;
+
+	list_foreach(iqueue->list, link, tcp_iqueue_entry_t, qe) {
+		sleft = qe->seg->seq;
+		sright = qe->seg->seq + qe->seg->len;
+
+		/* Offsets from RCV.NXT to get modulo comparisons right */
+		if (have && sleft - base <= bright - base) {
+			/* Merge with the current block */
+			if (sright - base > bright - base)
+				bright = sright;
+			continue;
+		}
+
+		if (have) {
+			blocks[cnt].left = bleft;
+			blocks[cnt].right = bright;
+			if (++cnt >= max) {
+				*nblocks = cnt;
+				return;
+			}
+		}
+
+		bleft = sleft;
+		bright = sright;
+		have = true;
+	}
+
+	if (have) {
+		blocks[cnt].left = bleft;
+		blocks[cnt].right = bright;
+		++cnt;
+	}
+
+	*nblocks = cnt;
+}
+
 /** Get next ready segment from incoming queue.
  *
  * Return the segment with the earliest sequence number if it is ready.
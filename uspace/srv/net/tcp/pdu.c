@@ -37,6 +37,7 @@
 #include <bitops.h>
 #include <byteorder.h>
 #include <errno.h>
+#include <inet/checksum.h>
 #include <inet/endpoint.h>
 #include <mem.h>
 #include <stdlib.h>
@@ -46,44 +47,6 @@
 #include "std.h"
 #include "tcp_type.h"
 
-#define TCP_CHECKSUM_INIT 0xffff
-
-/** One's complement addition.
- *
- * Result is a + b + carry.
- */
-static uint16_t tcp_ocadd16(uint16_t a, uint16_t b)
-{
-	uint32_t s;
-
-	s = (uint32_t)a + (uint32_t)b;
-	return (s & 0xffff) + (s >> 16);
-}
-
-static uint16_t tcp_checksum_calc(uint16_t ivalue, void *data, size_t size)
-{
-	uint16_t sum;
-	uint16_t w;
-	size_t words, i;
-	uint8_t *bdata;
-
-	sum = ~ivalue;
-	words = size / 2;
-	bdata = (uint8_t *)data;
-
-	for (i = 0; i < words; i++) {
-		w = ((uint16_t)bdata[2 * i] << 8) | bdata[2 * i + 1];
-		sum = tcp_ocadd16(sum, w);
-	}
-
-	if (size % 2 != 0) {
-		w = ((uint16_t)bdata[2 * words] << 8);
-		sum = tcp_ocadd16(sum, w);
-	}
-
-	return ~sum;
-}
-
 static void tcp_header_decode_flags(uint16_t doff_flags, tcp_control_t *rctl)
 {
 	tcp_control_t ctl;
@@ -125,7 +88,8 @@ static void tcp_header_encode_flags(tcp_control_t ctl, uint16_t doff_flags0,
 	*rdoff_flags = doff_flags;
 }
 
-static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg, tcp_header_t *hdr)
+static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg,
+    tcp_header_t *hdr, size_t hdr_size)
 {
 	uint16_t doff_flags;
 	uint16_t doff;
@@ -135,7 +99,7 @@ static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg, tcp_header_t *
 	hdr->seq = host2uint32_t_be(seg->seq);
 	hdr->ack = host2uint32_t_be(seg->ack);
 
-	doff = (sizeof(tcp_header_t) / sizeof(uint32_t)) << DF_DATA_OFFSET_l;
+	doff = (hdr_size / sizeof(uint32_t)) << DF_DATA_OFFSET_l;
 	tcp_header_encode_flags(seg->ctrl, doff, &doff_flags);
 
 	hdr->doff_flags = host2uint16_t_be(doff_flags);
@@ -190,18 +154,135 @@ static void tcp_header_decode(tcp_header_t *hdr, tcp_segment_t *seg)
 	seg->up = uint16_t_be2host(hdr->urg_ptr);
 }
 
+/** Decode options following the fixed header.
+ *
+ * Malformed options terminate the scan, the rest of the header is
+ * ignored.
+ *
+ * @param header	Encoded header, including options
+ * @param header_size	Encoded header size in bytes
+ * @param seg		Segment in which to record decoded options
+ */
+static void tcp_options_decode(void *header, size_t header_size,
+    tcp_segment_t *seg)
+{
+	uint8_t *opts = (uint8_t *)header + sizeof(tcp_header_t);
+	size_t rem = header_size - sizeof(tcp_header_t);
+	unsigned nblocks;
+	unsigned i;
+	uint32_t w;
+
+	while (rem > 0) {
+		switch (opts[0]) {
+		case OPT_END_LIST:
+			return;
+		case OPT_NOP:
+			++opts;
+			--rem;
+			break;
+		case OPT_WINDOW_SCALE:
+			if (rem < 3 || opts[1] != 3)
+				return;
+			seg->has_wscale = true;
+			seg->wscale = opts[2];
+			opts += 3;
+			rem -= 3;
+			break;
+		case OPT_SACK_PERMITTED:
+			if (rem < 2 || opts[1] != 2)
+				return;
+			seg->sack_permitted = true;
+			opts += 2;
+			rem -= 2;
+			break;
+		case OPT_SACK:
+			if (rem < 2 || opts[1] < 2 || opts[1] > rem ||
+			    (opts[1] - 2) % (2 * sizeof(uint32_t)) != 0)
+				return;
+			nblocks = (opts[1] - 2) / (2 * sizeof(uint32_t));
+			if (nblocks > TCP_SACK_MAX_BLOCKS)
+				nblocks = TCP_SACK_MAX_BLOCKS;
+			for (i = 0; i < nblocks; i++) {
+				memcpy(&w, opts + 2 + 8 * i, sizeof(w));
+				seg->sacks[i].left = uint32_t_be2host(w);
+				memcpy(&w, opts + 2 + 8 * i + 4, sizeof(w));
+				seg->sacks[i].right = uint32_t_be2host(w);
+			}
+			seg->nsacks = nblocks;
+			rem -= opts[1];
+			opts += opts[1];
+			break;
+		default:
+			/* Skip unrecognized option */
+			if (rem < 2 || opts[1] < 2 || opts[1] > rem)
+				return;
+			rem -= opts[1];
+			opts += opts[1];
+			break;
+		}
+	}
+}
+
 static errno_t tcp_header_encode(inet_ep2_t *epp, tcp_segment_t *seg,
     void **header, size_t *size)
 {
 	tcp_header_t *hdr;
-
-	hdr = calloc(1, sizeof(tcp_header_t));
+	uint8_t *opts;
+	size_t hdr_size;
+	unsigned i;
+	uint32_t w;
+
+	hdr_size = sizeof(tcp_header_t);
+	if (seg->has_wscale)
+		hdr_size += sizeof(uint32_t);
+	if (seg->sack_permitted)
+		hdr_size += sizeof(uint32_t);
+	if (seg->nsacks > 0)
+		hdr_size += sizeof(uint32_t) +
+		    seg->nsacks * 2 * sizeof(uint32_t);
+
+	hdr = calloc(1, hdr_size);
 	if (hdr == NULL)
 		return ENOMEM;
 
-	tcp_header_setup(epp, seg, hdr);
+	tcp_header_setup(epp, seg, hdr, hdr_size);
+	opts = (uint8_t *)hdr + sizeof(tcp_header_t);
+
+	if (seg->has_wscale) {
+		/* Window scale option padded to a full option word */
+		*opts++ = OPT_NOP;
+		*opts++ = OPT_WINDOW_SCALE;
+		*opts++ = 3;
+		*opts++ = seg->wscale;
+	}
+
+	if (seg->sack_permitted) {
+		/* SACK-permitted option padded to a full option word */
+		*opts++ = OPT_NOP;
+		*opts++ = OPT_NOP;
+		*opts++ = OPT_SACK_PERMITTED;
+		*opts++ = 2;
+	}
+
+	if (seg->nsacks > 0) {
+		/* SACK option padded to a full option word */
+		*opts++ = OPT_NOP;
+		*opts++ = OPT_NOP;
+		*opts++ = OPT_SACK;
+		*opts++ = 2 + seg->nsacks * 2 * sizeof(uint32_t);
+
+		for (i = 0; i < seg->nsacks; i++) {
+			w = host2uint32_t_be(seg->sacks[i].left);
+			memcpy(opts, &w, sizeof(w));
+			opts += sizeof(w);
+			w = host2uint32_t_be(seg->sacks[i].right);
+			memcpy(opts, &w, sizeof(w));
+			opts += sizeof(w);
+		}
+	}
+
 	*header = hdr;
-	*size = sizeof(tcp_header_t);
+	*size = hdr_size;
 
 	return EOK;
 }
@@ -270,19 +351,19 @@ static uint16_t tcp_pdu_checksum_calc(tcp_pdu_t *pdu)
 	ip_ver_t ver = tcp_phdr_setup(pdu, &phdr, &phdr6);
 	switch (ver) {
 	case ip_v4:
-		cs_phdr = tcp_checksum_calc(TCP_CHECKSUM_INIT, (void *) &phdr,
+		cs_phdr = inet_checksum_calc(INET_CHECKSUM_INIT, (void *) &phdr,
 		    sizeof(tcp_phdr_t));
 		break;
 	case ip_v6:
-		cs_phdr = tcp_checksum_calc(TCP_CHECKSUM_INIT, (void *) &phdr6,
+		cs_phdr = inet_checksum_calc(INET_CHECKSUM_INIT, (void *) &phdr6,
 		    sizeof(tcp_phdr6_t));
 		break;
 	default:
 		assert(false);
 	}
 
-	cs_headers = tcp_checksum_calc(cs_phdr, pdu->header, pdu->header_size);
-	return tcp_checksum_calc(cs_headers, pdu->text, pdu->text_size);
+	cs_headers = inet_checksum_calc(cs_phdr, pdu->header, pdu->header_size);
+	return inet_checksum_calc(cs_headers, pdu->text, pdu->text_size);
 }
 
 static void tcp_pdu_set_checksum(tcp_pdu_t *pdu, uint16_t checksum)
@@ -304,6 +385,7 @@ errno_t tcp_pdu_decode(tcp_pdu_t *pdu, inet_ep2_t *epp, tcp_segment_t **seg)
 		return ENOMEM;
 
 	tcp_header_decode(pdu->header, nseg);
+	tcp_options_decode(pdu->header, pdu->header_size, nseg);
 	nseg->len += seq_no_control_len(nseg->ctrl);
 
 	hdr = (tcp_header_t *)pdu->header;
@@ -31,11 +31,17 @@
  */
 
 /**
- * @file Global segment receive queue
+ * @file Segment receive queues
+ *
+ * Incoming segments are distributed over several queues by hashing the
+ * endpoint pair, each queue served by its own fibril. Segments of one
+ * connection always hash to the same queue, so their processing order
+ * is preserved, while one busy connection cannot starve the others.
  */
 
 #include <adt/prodcons.h>
 #include <errno.h>
+#include <inet/addr.h>
 #include <io/log.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -47,33 +53,102 @@
 #include "tcp_type.h"
 #include "ucall.h"
 
-static prodcons_t rqueue;
-static bool fibril_active;
+/** Number of receive queue buckets */
+#define RQUEUE_NBUCKETS 4
+
+/** Receive queue bucket */
+typedef struct {
+	/** Queued segments */
+	prodcons_t queue;
+	/** Handler fibril is running */
+	bool active;
+} tcp_rqueue_bucket_t;
+
+static tcp_rqueue_bucket_t rqueue_bucket[RQUEUE_NBUCKETS];
 static fibril_mutex_t lock;
 static fibril_condvar_t cv;
 static tcp_rqueue_cb_t *rqueue_cb;
 
-/** Initialize segment receive queue. */
+/** Initialize segment receive queues. */
 void tcp_rqueue_init(tcp_rqueue_cb_t *rcb)
 {
-	prodcons_initialize(&rqueue);
+	unsigned i;
+
+	for (i = 0; i < RQUEUE_NBUCKETS; i++) {
+		prodcons_initialize(&rqueue_bucket[i].queue);
+		rqueue_bucket[i].active = false;
+	}
+
 	fibril_mutex_initialize(&lock);
 	fibril_condvar_initialize(&cv);
-	fibril_active = false;
 	rqueue_cb = rcb;
 }
 
-/** Finalize segment receive queue. */
+/** Map endpoint pair to a receive queue bucket.
+ *
+ * All segments of one connection map to the same bucket so that their
+ * relative processing order is preserved.
+ *
+ * @param epp	Endpoint pair, oriented for reception
+ * @return	Bucket index
+ */
+static unsigned tcp_rqueue_bucket_idx(inet_ep2_t *epp)
+{
+	addr32_t v4;
+	addr128_t v6;
+	unsigned h;
+	size_t i;
+
+	h = epp->local.port ^ epp->remote.port;
+
+	switch (inet_addr_get(&epp->remote.addr, &v4, &v6)) {
+	case ip_v4:
+		h ^= v4;
+		break;
+	case ip_v6:
+		for (i = 0; i < sizeof(v6); i++)
+			h = h * 31 + v6[i];
+		break;
+	default:
+		break;
+	}
+
+	return h % RQUEUE_NBUCKETS;
+}
+
+/** Queue sentinel entry telling a handler fibril to terminate.
+ *
+ * @param rb	Receive queue bucket
+ */
+static void tcp_rqueue_insert_fin(tcp_rqueue_bucket_t *rb)
+{
+	tcp_rqueue_entry_t *rqe;
+
+	rqe = calloc(1, sizeof(tcp_rqueue_entry_t));
+	if (rqe == NULL) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed allocating RQE.");
+		return;
+	}
+
+	inet_ep2_init(&rqe->epp);
+	rqe->seg = NULL;
+
+	prodcons_produce(&rb->queue, &rqe->link);
+}
+
+/** Finalize segment receive queues. */
 void tcp_rqueue_fini(void)
 {
-	inet_ep2_t epp;
+	unsigned i;
 
-	inet_ep2_init(&epp);
-	tcp_rqueue_insert_seg(&epp, NULL);
+	for (i = 0; i < RQUEUE_NBUCKETS; i++)
+		tcp_rqueue_insert_fin(&rqueue_bucket[i]);
 
 	fibril_mutex_lock(&lock);
-	while (fibril_active)
-		fibril_condvar_wait(&cv, &lock);
+	for (i = 0; i < RQUEUE_NBUCKETS; i++) {
+		while (rqueue_bucket[i].active)
+			fibril_condvar_wait(&cv, &lock);
+	}
 	fibril_mutex_unlock(&lock);
 }
 
@@ -100,19 +175,24 @@ void tcp_rqueue_insert_seg(inet_ep2_t *epp, tcp_segment_t *seg)
 	rqe->epp = *epp;
 	rqe->seg = seg;
 
-	prodcons_produce(&rqueue, &rqe->link);
+	prodcons_produce(&rqueue_bucket[tcp_rqueue_bucket_idx(epp)].queue,
+	    &rqe->link);
 }
 
-/** Receive queue handler fibril. */
+/** Receive queue handler fibril.
+ *
+ * @param arg	Receive queue bucket (tcp_rqueue_bucket_t *)
+ */
 static errno_t tcp_rqueue_fibril(void *arg)
 {
+	tcp_rqueue_bucket_t *rb = (tcp_rqueue_bucket_t *) arg;
 	link_t *link;
 	tcp_rqueue_entry_t *rqe;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_rqueue_fibril()");
 
 	while (true) {
-		link = prodcons_consume(&rqueue);
+		link = prodcons_consume(&rb->queue);
 		rqe = list_get_instance(link, tcp_rqueue_entry_t, link);
 
 		if (rqe->seg == NULL) {
@@ -128,28 +208,32 @@ static errno_t tcp_rqueue_fibril(void *arg)
 
 	/* Finished */
 	fibril_mutex_lock(&lock);
-	fibril_active = false;
+	rb->active = false;
 	fibril_mutex_unlock(&lock);
 	fibril_condvar_broadcast(&cv);
 
 	return 0;
 }
 
-/** Start receive queue handler fibril. */
+/** Start receive queue handler fibrils. */
 void tcp_rqueue_fibril_start(void)
 {
+	unsigned i;
 	fid_t fid;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_rqueue_fibril_start()");
 
-	fid = fibril_create(tcp_rqueue_fibril, NULL);
-	if (fid == 0) {
-		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed creating rqueue fibril.");
-		return;
-	}
+	for (i = 0; i < RQUEUE_NBUCKETS; i++) {
+		fid = fibril_create(tcp_rqueue_fibril, &rqueue_bucket[i]);
+		if (fid == 0) {
+			log_msg(LOG_DEFAULT, LVL_ERROR,
+			    "Failed creating rqueue fibril.");
+			return;
+		}
 
-	fibril_add_ready(fid);
-	fibril_active = true;
+		fibril_add_ready(fid);
+		rqueue_bucket[i].active = true;
+	}
 }
 
 /**
@@ -74,6 +74,11 @@ tcp_segment_t *tcp_segment_dup(tcp_segment_t *seg)
 	scopy->len = seg->len;
 	scopy->wnd = seg->wnd;
 	scopy->up = seg->up;
+	scopy->has_wscale = seg->has_wscale;
+	scopy->wscale = seg->wscale;
+	scopy->sack_permitted = seg->sack_permitted;
+	scopy->nsacks = seg->nsacks;
+	memcpy(scopy->sacks, seg->sacks, sizeof(scopy->sacks));
 
 	tsize = tcp_segment_text_size(seg);
 	scopy->data = calloc(tsize, 1);
@@ -139,11 +139,21 @@ static void tcp_service_lst_cstate_change(tcp_conn_t *conn, void *arg,
 	nstate = conn->cstate;
 	clst = tcp_uc_get_userptr(conn);
 
+	if (old_state == st_listen && nstate == st_syn_received) {
+		/*
+		 * The connection assumed the identity of the incoming
+		 * connection and vacated the listening endpoint. It is no
+		 * longer the listener's sentinel; a fresh sentinel is opened
+		 * below so that further connections can be accepted while
+		 * this one completes its handshake.
+		 */
+		if (clst->conn == conn)
+			clst->conn = NULL;
+	}
+
 	if ((old_state == st_syn_sent || old_state == st_syn_received) &&
 	    (nstate == st_established)) {
 		/* Connection established */
-		clst->conn = NULL;
-
 		rc = tcp_cconn_create(clst->client, conn, &cconn);
 		if (rc != EOK) {
 			/* XXX Could not create client connection */
@@ -169,6 +179,9 @@ static void tcp_service_lst_cstate_change(tcp_conn_t *conn, void *arg,
 
 	/* Replenish sentinel connection */
 
+	if (clst->conn != NULL)
+		return;
+
 	inet_ep2_init(&epp);
 	epp.local = clst->elocal;
 
@@ -996,6 +1009,88 @@ static void tcp_conn_send_srv(tcp_client_t *client, ipc_call_t *icall)
 	free(data);
 }
 
+/** Send data from multiple fragments via connection.
+ *
+ * Handle client request to send data supplied as multiple IPC data
+ * fragments in one exchange. The fragments are passed to the connection
+ * individually and in order, so they are never assembled into one
+ * contiguous buffer.
+ *
+ * @param client TCP client
+ * @param icall  Async request data
+ *
+ */
+static void tcp_conn_sendv_srv(tcp_client_t *client, ipc_call_t *icall)
+{
+	ipc_call_t call;
+	void *frag[TCP_IOV_MAX];
+	size_t fsize[TCP_IOV_MAX];
+	size_t cnt;
+	size_t i;
+	sysarg_t conn_id;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_sendv_srv()");
+
+	conn_id = ipc_get_arg1(icall);
+	cnt = ipc_get_arg2(icall);
+
+	if (cnt == 0 || cnt > TCP_IOV_MAX) {
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	/* Receive all message fragments */
+
+	for (i = 0; i < cnt; i++) {
+		size_t size;
+
+		if (!async_data_write_receive(&call, &size)) {
+			async_answer_0(&call, EREFUSED);
+			async_answer_0(icall, EREFUSED);
+			goto out;
+		}
+
+		if (size > MAX_MSG_SIZE) {
+			async_answer_0(&call, EINVAL);
+			async_answer_0(icall, EINVAL);
+			goto out;
+		}
+
+		frag[i] = malloc(size);
+		if (frag[i] == NULL) {
+			async_answer_0(&call, ENOMEM);
+			async_answer_0(icall, ENOMEM);
+			goto out;
+		}
+
+		fsize[i] = size;
+
+		rc = async_data_write_finalize(&call, frag[i], size);
+		if (rc != EOK) {
+			++i;
+			async_answer_0(&call, rc);
+			async_answer_0(icall, rc);
+			goto out;
+		}
+	}
+
+	/* Send the fragments in order */
+
+	rc = EOK;
+	for (i = 0; i < cnt; i++) {
+		rc = tcp_conn_send_impl(client, conn_id, frag[i], fsize[i]);
+		if (rc != EOK)
+			break;
+	}
+
+	async_answer_0(icall, rc);
+	i = cnt;
+out:
+	while (i > 0)
+		free(frag[--i]);
+}
+
 /** Read received data from connection without blocking.
  *
  * Handle client request to read received data via connection without blocking.
@@ -1111,6 +1206,97 @@ static void tcp_conn_recv_wait_srv(tcp_client_t *client, ipc_call_t *icall)
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_recv_wait_srv(): OK");
 }
 
+/** Read received data from connection into multiple fragments.
+ *
+ * Handle client request to read received data into multiple IPC data
+ * fragments in one exchange. The fragments are filled consecutively;
+ * once the received data runs out, the remaining fragments are
+ * completed empty. The total number of bytes read is returned in the
+ * answer.
+ *
+ * @param client TCP client
+ * @param icall  Async request data
+ *
+ */
+static void tcp_conn_recvv_srv(tcp_client_t *client, ipc_call_t *icall)
+{
+	ipc_call_t call;
+	sysarg_t conn_id;
+	size_t cnt;
+	size_t size, rsize;
+	size_t total;
+	void *data;
+	bool drained;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_recvv_srv()");
+
+	conn_id = ipc_get_arg1(icall);
+	cnt = ipc_get_arg2(icall);
+
+	if (cnt == 0 || cnt > TCP_IOV_MAX) {
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	data = malloc(MAX_MSG_SIZE);
+	if (data == NULL) {
+		async_answer_0(icall, ENOMEM);
+		return;
+	}
+
+	total = 0;
+	drained = false;
+
+	for (size_t i = 0; i < cnt; i++) {
+		if (!async_data_read_receive(&call, &size)) {
+			async_answer_0(&call, EREFUSED);
+			async_answer_0(icall, EREFUSED);
+			free(data);
+			return;
+		}
+
+		if (drained) {
+			/* Received data ran out, complete fragment empty */
+			async_data_read_finalize(&call, data, 0);
+			continue;
+		}
+
+		size = min(size, MAX_MSG_SIZE);
+
+		rc = tcp_conn_recv_impl(client, conn_id, data, size, &rsize);
+		if (rc == EAGAIN && total > 0) {
+			/* Already got some data, report a short read */
+			async_data_read_finalize(&call, data, 0);
+			drained = true;
+			continue;
+		}
+
+		if (rc != EOK) {
+			async_answer_0(&call, rc);
+			async_answer_0(icall, rc);
+			free(data);
+			return;
+		}
+
+		rc = async_data_read_finalize(&call, data, size);
+		if (rc != EOK) {
+			async_answer_0(icall, rc);
+			free(data);
+			return;
+		}
+
+		total += rsize;
+		if (rsize < size)
+			drained = true;
+	}
+
+	async_answer_1(icall, EOK, total);
+	free(data);
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_recvv_srv(): OK");
+}
+
 /** Initialize TCP client structure.
  *
  * @param client TCP client
@@ -1223,6 +1409,12 @@ static void tcp_client_conn(ipc_call_t *icall, void *arg)
 		case TCP_CONN_RECV_WAIT:
 			tcp_conn_recv_wait_srv(&client, &call);
 			break;
+		case TCP_CONN_SENDV:
+			tcp_conn_sendv_srv(&client, &call);
+			break;
+		case TCP_CONN_RECVV:
+			tcp_conn_recvv_srv(&client, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
@@ -154,6 +154,17 @@ typedef struct {
 	tcp_cstate_t cstate;
 } tcp_conn_status_t;
 
+/** Maximum number of SACK blocks in a segment */
+#define TCP_SACK_MAX_BLOCKS 4
+
+/** SACK block (RFC 2018) */
+typedef struct {
+	/** First sequence number of the block */
+	uint32_t left;
+	/** Sequence number immediately following the block */
+	uint32_t right;
+} tcp_sack_block_t;
+
 typedef struct {
 	/** SYN, FIN */
 	tcp_control_t ctrl;
@@ -169,6 +180,18 @@ typedef struct {
 	/** Segment urgent pointer */
 	uint32_t up;
 
+	/** Window scale option is present (SYN segments only) */
+	bool has_wscale;
+	/** Window scale shift count carried by the option */
+	uint8_t wscale;
+
+	/** SACK-permitted option is present (SYN segments only) */
+	bool sack_permitted;
+	/** Number of valid entries in @c sacks */
+	unsigned nsacks;
+	/** Blocks of the SACK option (RFC 2018) */
+	tcp_sack_block_t sacks[TCP_SACK_MAX_BLOCKS];
+
 	/** Segment data, may be moved when trimming segment */
 	void *data;
 	/** Segment data, original pointer used to free data */
@@ -202,11 +225,32 @@ typedef struct {
 	tcp_segment_t *seg;
 } tcp_iqueue_entry_t;
 
+/** Timer wheel timer callback function */
+typedef void (*tcp_twheel_fun_t)(void *);
+
+/** Timer wheel timer */
+typedef struct {
+	/** Link to timer wheel slot when active */
+	link_t link;
+	/** Expiration time in timer wheel ticks */
+	uint64_t expires;
+	/** Callback function */
+	tcp_twheel_fun_t fun;
+	/** Argument to callback function */
+	void *arg;
+	/** Lock guarding the user's state associated with the timer */
+	fibril_mutex_t *lockp;
+	/** Timer state */
+	fibril_timer_state_t state;
+} tcp_twheel_timer_t;
+
 /** Retransmission queue entry */
 typedef struct {
 	link_t link;
 	tcp_conn_t *conn;
 	tcp_segment_t *seg;
+	/** Segment is covered by a received SACK block */
+	bool sacked;
 } tcp_tqueue_entry_t;
 
 /** Retransmission queue callbacks */
@@ -221,7 +265,7 @@ typedef struct {
 	list_t list;
 
 	/** Retransmission timer */
-	fibril_timer_t *timer;
+	tcp_twheel_timer_t *timer;
 
 	/** Callbacks */
 	tcp_tqueue_cb_t *cb;
@@ -269,7 +313,7 @@ struct tcp_conn {
 	tcp_tqueue_t retransmit;
 
 	/** Time-Wait timeout timer */
-	fibril_timer_t *tw_timer;
+	tcp_twheel_timer_t *tw_timer;
 
 	/** Receive buffer */
 	uint8_t *rcv_buf;
@@ -316,6 +360,31 @@ struct tcp_conn {
 	uint32_t rcv_up;
 	/** Initial receive sequence number */
 	uint32_t irs;
+
+	/** Peer agreed to window scaling (RFC 1323) */
+	bool wnd_scale;
+	/** Shift count applied to our advertised receive window */
+	uint8_t rcv_wnd_scale;
+	/** Shift count applied to send windows received from the peer */
+	uint8_t snd_wnd_scale;
+
+	/** Peer agreed to selective acknowledgment (RFC 2018) */
+	bool sack_ok;
+	/** Number of valid entries in @c snd_sacks */
+	unsigned snd_nsacks;
+	/** Most recent SACK blocks received from the peer */
+	tcp_sack_block_t snd_sacks[TCP_SACK_MAX_BLOCKS];
+
+	/** Congestion window (RFC 5681) */
+	uint32_t cwnd;
+	/** Slow start threshold */
+	uint32_t ssthresh;
+	/** Number of consecutive duplicate acknowledgements received */
+	uint32_t dup_acks;
+	/** Send sequence number whose acknowledgement ends fast recovery */
+	uint32_t snd_rec;
+	/** Connection is in fast recovery (RFC 6582) */
+	bool in_recovery;
 };
 
 /** Continuation of processing.
@@ -359,7 +428,7 @@ typedef struct tcp_cconn {
 typedef struct tcp_clst {
 	/** Local endpoint */
 	inet_ep_t elocal;
-	/** Connection */
+	/** Sentinel connection */
 	tcp_conn_t *conn;
 	/** Listener ID for the client */
 	sysarg_t id;
@@ -36,12 +36,22 @@
 /** Verify that two segments have the same content */
 void test_seg_same(tcp_segment_t *a, tcp_segment_t *b)
 {
+	unsigned i;
+
 	PCUT_ASSERT_INT_EQUALS(a->ctrl, b->ctrl);
 	PCUT_ASSERT_INT_EQUALS(a->seq, b->seq);
 	PCUT_ASSERT_INT_EQUALS(a->ack, b->ack);
 	PCUT_ASSERT_INT_EQUALS(a->len, b->len);
 	PCUT_ASSERT_INT_EQUALS(a->wnd, b->wnd);
 	PCUT_ASSERT_INT_EQUALS(a->up, b->up);
+	PCUT_ASSERT_INT_EQUALS(a->has_wscale, b->has_wscale);
+	PCUT_ASSERT_INT_EQUALS(a->wscale, b->wscale);
+	PCUT_ASSERT_INT_EQUALS(a->sack_permitted, b->sack_permitted);
+	PCUT_ASSERT_INT_EQUALS(a->nsacks, b->nsacks);
+	for (i = 0; i < a->nsacks; i++) {
+		PCUT_ASSERT_INT_EQUALS(a->sacks[i].left, b->sacks[i].left);
+		PCUT_ASSERT_INT_EQUALS(a->sacks[i].right, b->sacks[i].right);
+	}
 	PCUT_ASSERT_INT_EQUALS(tcp_segment_text_size(a),
 	    tcp_segment_text_size(b));
 	if (tcp_segment_text_size(a) != 0)
@@ -63,6 +73,7 @@ PCUT_IMPORT(rqueue);
 PCUT_IMPORT(segment);
 PCUT_IMPORT(seq_no);
 PCUT_IMPORT(tqueue);
+PCUT_IMPORT(twheel);
 PCUT_IMPORT(ucall);
 
 PCUT_MAIN();
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2017 Jiri Svoboda
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fibril_synch.h>
+#include <pcut/pcut.h>
+
+#include "../tcp_type.h"
+#include "../twheel.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(twheel);
+
+static FIBRIL_MUTEX_INITIALIZE(test_lock);
+static FIBRIL_CONDVAR_INITIALIZE(test_cv);
+static bool test_timer_fired;
+
+static void test_timer_fun(void *arg)
+{
+	fibril_mutex_lock(&test_lock);
+	test_timer_fired = true;
+	fibril_condvar_broadcast(&test_cv);
+	fibril_mutex_unlock(&test_lock);
+}
+
+/** Create and destroy timer */
+PCUT_TEST(create_destroy)
+{
+	tcp_twheel_timer_t *timer;
+
+	timer = tcp_twheel_timer_create(&test_lock);
+	PCUT_ASSERT_NOT_NULL(timer);
+	tcp_twheel_timer_destroy(timer);
+}
+
+/** Set timer and wait for it to fire */
+PCUT_TEST(set_fire)
+{
+	tcp_twheel_timer_t *timer;
+
+	timer = tcp_twheel_timer_create(&test_lock);
+	PCUT_ASSERT_NOT_NULL(timer);
+
+	fibril_mutex_lock(&test_lock);
+	test_timer_fired = false;
+	tcp_twheel_timer_set_locked(timer, 10 * 1000, test_timer_fun, NULL);
+
+	while (!test_timer_fired)
+		fibril_condvar_wait(&test_cv, &test_lock);
+
+	PCUT_ASSERT_INT_EQUALS(fts_fired,
+	    tcp_twheel_timer_clear_locked(timer));
+	fibril_mutex_unlock(&test_lock);
+
+	tcp_twheel_timer_destroy(timer);
+}
+
+/** Clear timer before it fires */
+PCUT_TEST(set_clear)
+{
+	tcp_twheel_timer_t *timer;
+
+	timer = tcp_twheel_timer_create(&test_lock);
+	PCUT_ASSERT_NOT_NULL(timer);
+
+	fibril_mutex_lock(&test_lock);
+	test_timer_fired = false;
+	tcp_twheel_timer_set_locked(timer, 10 * 1000 * 1000, test_timer_fun,
+	    NULL);
+	PCUT_ASSERT_INT_EQUALS(fts_active,
+	    tcp_twheel_timer_clear_locked(timer));
+	PCUT_ASSERT_FALSE(test_timer_fired);
+	fibril_mutex_unlock(&test_lock);
+
+	tcp_twheel_timer_destroy(timer);
+}
+
+PCUT_EXPORT(twheel);
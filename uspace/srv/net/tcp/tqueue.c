@@ -45,12 +45,14 @@
 
 #include "conn.h"
 #include "inet.h"
+#include "iqueue.h"
 #include "ncsim.h"
 #include "rqueue.h"
 #include "segment.h"
 #include "seq_no.h"
 #include "tqueue.h"
 #include "tcp_type.h"
+#include "twheel.h"
 
 #define RETRANSMIT_TIMEOUT	(2*1000*1000)
 
@@ -66,7 +68,7 @@ errno_t tcp_tqueue_init(tcp_tqueue_t *tqueue, tcp_conn_t *conn,
     tcp_tqueue_cb_t *cb)
 {
 	tqueue->conn = conn;
-	tqueue->timer = fibril_timer_create(&conn->lock);
+	tqueue->timer = tcp_twheel_timer_create(&conn->lock);
 	tqueue->cb = cb;
 	if (tqueue->timer == NULL)
 		return ENOMEM;
@@ -87,7 +89,7 @@ void tcp_tqueue_fini(tcp_tqueue_t *tqueue)
 	tcp_tqueue_entry_t *tqe;
 
 	if (tqueue->timer != NULL) {
-		fibril_timer_destroy(tqueue->timer);
+		tcp_twheel_timer_destroy(tqueue->timer);
 		tqueue->timer = NULL;
 	}
 
@@ -189,8 +191,12 @@ void tcp_tqueue_new_data(tcp_conn_t *conn)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_tqueue_new_data()", conn->name);
 
-	/* Number of free sequence numbers in send window */
-	avail_wnd = (conn->snd_una + conn->snd_wnd) - conn->snd_nxt;
+	/*
+	 * Number of free sequence numbers in the send window, also
+	 * limited by the congestion window (RFC 5681)
+	 */
+	avail_wnd = (conn->snd_una + min(conn->snd_wnd, conn->cwnd)) -
+	    conn->snd_nxt;
 	snd_buf_seqlen = conn->snd_buf_used + (conn->snd_buf_fin ? 1 : 0);
 
 	xfer_seqlen = min(snd_buf_seqlen, avail_wnd);
@@ -237,6 +243,33 @@ void tcp_tqueue_new_data(tcp_conn_t *conn)
 	tcp_segment_delete(seg);
 }
 
+/** Determine if segment is covered by a received SACK block.
+ *
+ * @param conn	Connection
+ * @param seg	Segment
+ * @return	@c true iff the peer has selectively acknowledged @a seg
+ */
+static bool tcp_tqueue_seg_sacked(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	uint32_t sl, sr;
+	uint32_t bl, br;
+	unsigned i;
+
+	/* Offsets from SND.UNA to get modulo comparisons right */
+	sl = seg->seq - conn->snd_una;
+	sr = sl + seg->len;
+
+	for (i = 0; i < conn->snd_nsacks; i++) {
+		bl = conn->snd_sacks[i].left - conn->snd_una;
+		br = conn->snd_sacks[i].right - conn->snd_una;
+
+		if (bl <= sl && sr <= br)
+			return true;
+	}
+
+	return false;
+}
+
 /** Remove ACKed segments from retransmission queue and possibly transmit
  * more data.
  *
@@ -275,6 +308,10 @@ void tcp_tqueue_ack_received(tcp_conn_t *conn)
 
 			/* Reset retransmission timer */
 			tcp_tqueue_timer_set(conn);
+		} else if (conn->sack_ok && !tqe->sacked &&
+		    tcp_tqueue_seg_sacked(conn, tqe->seg)) {
+			/* Mark segment selectively acknowledged (RFC 2018) */
+			tqe->sacked = true;
 		}
 
 		cur = next;
@@ -293,7 +330,34 @@ static void tcp_conn_transmit_segment(tcp_conn_t *conn, tcp_segment_t *seg)
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_conn_transmit_segment(%p, %p)",
 	    conn->name, conn, seg);
 
-	seg->wnd = conn->rcv_wnd;
+	if ((seg->ctrl & CTL_SYN) != 0) {
+		/*
+		 * The window field of a SYN segment is never scaled. Offer
+		 * window scaling in SYN, confirm it in SYN,ACK only if the
+		 * peer offered it as well. The same applies to selective
+		 * acknowledgment.
+		 */
+		seg->wnd = min(conn->rcv_wnd, UINT16_MAX);
+		if ((seg->ctrl & CTL_ACK) == 0 || conn->wnd_scale) {
+			seg->has_wscale = true;
+			seg->wscale = conn->rcv_wnd_scale;
+		}
+		seg->sack_permitted = (seg->ctrl & CTL_ACK) == 0 ||
+		    conn->sack_ok;
+	} else {
+		seg->wnd = min(conn->rcv_wnd >> conn->rcv_wnd_scale,
+		    UINT16_MAX);
+
+		/*
+		 * Report out-of-order data held in the incoming queue
+		 * (RFC 2018) so the peer only resends what is missing.
+		 */
+		if (conn->sack_ok && (seg->ctrl & CTL_ACK) != 0 &&
+		    (seg->ctrl & CTL_RST) == 0) {
+			tcp_iqueue_get_sacks(&conn->incoming, seg->sacks,
+			    TCP_SACK_MAX_BLOCKS, &seg->nsacks);
+		}
+	}
 
 	if ((seg->ctrl & CTL_ACK) != 0)
 		seg->ack = conn->rcv_nxt;
@@ -317,13 +381,77 @@ void tcp_tqueue_send_immed(tcp_conn_t *conn, tcp_segment_t *seg)
 	conn->retransmit.cb->transmit_seg(&conn->ident, seg);
 }
 
-static void retransmit_timeout_func(void *arg)
+/** Retransmit the oldest segment not covered by a received SACK block.
+ *
+ * @param conn	Connection
+ * @return	@c true if a segment was retransmitted
+ */
+static bool tcp_tqueue_retransmit_seg(tcp_conn_t *conn)
 {
-	tcp_conn_t *conn = (tcp_conn_t *) arg;
 	tcp_tqueue_entry_t *tqe;
 	tcp_segment_t *rt_seg;
 	link_t *link;
 
+	link = list_first(&conn->retransmit.list);
+	if (link == NULL) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Nothing to retransmit");
+		return false;
+	}
+
+	tqe = list_get_instance(link, tcp_tqueue_entry_t, link);
+
+	/* Skip segments the peer has already selectively acknowledged */
+	while (tqe->sacked) {
+		link = list_next(&tqe->link, &conn->retransmit.list);
+		if (link == NULL) {
+			/*
+			 * Every queued segment is marked, yet none has been
+			 * cumulatively acked - the peer may have reneged.
+			 * Discard the scoreboard and retransmit from the
+			 * oldest segment.
+			 */
+			conn->snd_nsacks = 0;
+			list_foreach(conn->retransmit.list, link,
+			    tcp_tqueue_entry_t, te) {
+				te->sacked = false;
+			}
+
+			link = list_first(&conn->retransmit.list);
+		}
+
+		tqe = list_get_instance(link, tcp_tqueue_entry_t, link);
+	}
+
+	rt_seg = tcp_segment_dup(tqe->seg);
+	if (rt_seg == NULL) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failed.");
+		/* XXX Handle properly */
+		return false;
+	}
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmitting segment", conn->name);
+	tcp_conn_transmit_segment(tqe->conn, rt_seg);
+	return true;
+}
+
+/** Retransmit the first unacknowledged segment without waiting for the
+ * retransmission timer to expire (fast retransmit, RFC 5681).
+ *
+ * @param conn	Connection
+ */
+void tcp_tqueue_fast_retransmit(tcp_conn_t *conn)
+{
+	assert(fibril_mutex_is_locked(&conn->lock));
+
+	if (tcp_tqueue_retransmit_seg(conn))
+		tcp_tqueue_timer_set(conn);
+}
+
+static void retransmit_timeout_func(void *arg)
+{
+	tcp_conn_t *conn = (tcp_conn_t *) arg;
+	uint32_t flight;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmit_timeout_func(%p)", conn->name, conn);
 
 	tcp_conn_lock(conn);
@@ -335,30 +463,24 @@ static void retransmit_timeout_func(void *arg)
 		return;
 	}
 
-	link = list_first(&conn->retransmit.list);
-	if (link == NULL) {
-		log_msg(LOG_DEFAULT, LVL_DEBUG, "Nothing to retransmit");
-		tcp_conn_unlock(conn);
-		tcp_conn_delref(conn);
-		return;
-	}
-
-	tqe = list_get_instance(link, tcp_tqueue_entry_t, link);
+	/*
+	 * The network is presumed congested: collapse the congestion
+	 * window and restart slow start (RFC 5681).
+	 */
+	flight = conn->snd_nxt - conn->snd_una;
+	conn->ssthresh = max(flight / 2, 2 * TCP_MSS);
+	conn->cwnd = TCP_MSS;
+	conn->dup_acks = 0;
+	conn->in_recovery = false;
 
-	rt_seg = tcp_segment_dup(tqe->seg);
-	if (rt_seg == NULL) {
-		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failed.");
+	if (!tcp_tqueue_retransmit_seg(conn)) {
 		tcp_conn_unlock(conn);
 		tcp_conn_delref(conn);
-		/* XXX Handle properly */
 		return;
 	}
 
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmitting segment", conn->name);
-	tcp_conn_transmit_segment(tqe->conn, rt_seg);
-
 	/* Reset retransmission timer */
-	fibril_timer_set_locked(conn->retransmit.timer, RETRANSMIT_TIMEOUT,
+	tcp_twheel_timer_set_locked(conn->retransmit.timer, RETRANSMIT_TIMEOUT,
 	    retransmit_timeout_func, (void *) conn);
 
 	tcp_conn_unlock(conn);
@@ -377,7 +499,7 @@ static void tcp_tqueue_timer_set(tcp_conn_t *conn)
 	tcp_tqueue_timer_clear(conn);
 
 	tcp_conn_addref(conn);
-	fibril_timer_set_locked(conn->retransmit.timer, RETRANSMIT_TIMEOUT,
+	tcp_twheel_timer_set_locked(conn->retransmit.timer, RETRANSMIT_TIMEOUT,
 	    retransmit_timeout_func, (void *) conn);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: tcp_tqueue_timer_set() end", conn->name);
@@ -390,7 +512,7 @@ static void tcp_tqueue_timer_clear(tcp_conn_t *conn)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: tcp_tqueue_timer_clear() begin", conn->name);
 
-	if (fibril_timer_clear_locked(conn->retransmit.timer) == fts_active)
+	if (tcp_twheel_timer_clear_locked(conn->retransmit.timer) == fts_active)
 		tcp_conn_delref(conn);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: tcp_tqueue_timer_clear() end", conn->name);
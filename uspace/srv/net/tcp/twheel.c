@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2015 Jiri Svoboda
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup tcp
+ * @{
+ */
+
+/**
+ * @file Timer wheel
+ *
+ * All connection timers are multiplexed onto a single server-wide
+ * hierarchical timer wheel driven by one fibril, instead of one fibril
+ * per timer as with fibril_timer_t. The interface mirrors fibril timers
+ * so that timers remain consistent with the connection lock: the locked
+ * set/clear operations must be called with the user lock held and the
+ * callback function is invoked without it, but must acquire it. Clearing
+ * a timer whose callback is currently executing waits for the callback
+ * to complete (releasing the user lock while waiting), except when
+ * called from the callback itself.
+ */
+
+#include <adt/list.h>
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <stdlib.h>
+#include "tcp_type.h"
+#include "twheel.h"
+
+/** Timer wheel tick in microseconds */
+#define TWHEEL_TICK	(10 * 1000)
+/** Number of slots in each wheel level */
+#define TWHEEL_SLOTS	256
+
+/** Lock guarding all timer wheel state */
+static FIBRIL_MUTEX_INITIALIZE(twheel_lock);
+/** Broadcast when a timer callback completes */
+static FIBRIL_CONDVAR_INITIALIZE(twheel_done_cv);
+/** Inner wheel, one tick per slot */
+static list_t twheel_l0[TWHEEL_SLOTS];
+/** Outer wheel, TWHEEL_SLOTS ticks per slot */
+static list_t twheel_l1[TWHEEL_SLOTS];
+/** Timers expiring beyond the range of the outer wheel */
+static LIST_INITIALIZE(twheel_long);
+/** Current time in ticks */
+static uint64_t twheel_tick;
+/** Timer whose callback is currently executing */
+static tcp_twheel_timer_t *twheel_cur;
+/** Timer wheel fibril or 0 if not started yet */
+static fid_t twheel_fid;
+
+/** Insert timer into the appropriate wheel level.
+ *
+ * Caller must hold @c twheel_lock and the timer's expiration time
+ * must not be in the past.
+ *
+ * @param timer		Timer
+ */
+static void tcp_twheel_insert(tcp_twheel_timer_t *timer)
+{
+	uint64_t delta = timer->expires - twheel_tick;
+
+	if (delta < TWHEEL_SLOTS) {
+		list_append(&timer->link,
+		    &twheel_l0[timer->expires % TWHEEL_SLOTS]);
+	} else if (delta < (uint64_t)TWHEEL_SLOTS * TWHEEL_SLOTS) {
+		list_append(&timer->link,
+		    &twheel_l1[(timer->expires / TWHEEL_SLOTS) % TWHEEL_SLOTS]);
+	} else {
+		list_append(&timer->link, &twheel_long);
+	}
+}
+
+/** Move timers from the outer levels towards the inner wheel.
+ *
+ * Called when the inner wheel wraps around. Caller must hold
+ * @c twheel_lock.
+ */
+static void tcp_twheel_cascade(void)
+{
+	tcp_twheel_timer_t *timer;
+	list_t *slot;
+	link_t *link;
+	link_t *next;
+
+	slot = &twheel_l1[(twheel_tick / TWHEEL_SLOTS) % TWHEEL_SLOTS];
+	while ((link = list_first(slot)) != NULL) {
+		list_remove(link);
+		timer = list_get_instance(link, tcp_twheel_timer_t, link);
+		tcp_twheel_insert(timer);
+	}
+
+	if (twheel_tick % ((uint64_t)TWHEEL_SLOTS * TWHEEL_SLOTS) != 0)
+		return;
+
+	/* The outer wheel wrapped around, too */
+	link = list_first(&twheel_long);
+	while (link != NULL) {
+		next = list_next(link, &twheel_long);
+		timer = list_get_instance(link, tcp_twheel_timer_t, link);
+
+		if (timer->expires - twheel_tick <
+		    (uint64_t)TWHEEL_SLOTS * TWHEEL_SLOTS) {
+			list_remove(link);
+			tcp_twheel_insert(timer);
+		}
+
+		link = next;
+	}
+}
+
+/** Timer wheel fibril.
+ *
+ * Advances the wheel by one tick at a time, cascading the outer levels
+ * and firing expired timers.
+ *
+ * @param arg		Not used
+ * @return		Does not return
+ */
+static errno_t tcp_twheel_fibril(void *arg)
+{
+	fibril_condvar_t tick_cv;
+	tcp_twheel_timer_t *timer;
+	tcp_twheel_fun_t fun;
+	void *farg;
+	list_t *slot;
+	link_t *link;
+
+	fibril_condvar_initialize(&tick_cv);
+
+	fibril_mutex_lock(&twheel_lock);
+	while (true) {
+		fibril_condvar_wait_timeout(&tick_cv, &twheel_lock,
+		    TWHEEL_TICK);
+		++twheel_tick;
+
+		if (twheel_tick % TWHEEL_SLOTS == 0)
+			tcp_twheel_cascade();
+
+		slot = &twheel_l0[twheel_tick % TWHEEL_SLOTS];
+		while ((link = list_first(slot)) != NULL) {
+			list_remove(link);
+			timer = list_get_instance(link, tcp_twheel_timer_t,
+			    link);
+
+			timer->state = fts_fired;
+			twheel_cur = timer;
+			fun = timer->fun;
+			farg = timer->arg;
+
+			/*
+			 * The callback may delete the timer, so it must
+			 * not be accessed after the callback returns.
+			 */
+			fibril_mutex_unlock(&twheel_lock);
+			fun(farg);
+			fibril_mutex_lock(&twheel_lock);
+
+			twheel_cur = NULL;
+			fibril_condvar_broadcast(&twheel_done_cv);
+		}
+	}
+
+	/* Not reached */
+	return EOK;
+}
+
+/** Start the timer wheel fibril if it is not running yet.
+ *
+ * @return		EOK on success, ENOMEM if out of memory
+ */
+static errno_t tcp_twheel_start(void)
+{
+	unsigned i;
+	fid_t fid;
+
+	fibril_mutex_lock(&twheel_lock);
+
+	if (twheel_fid != 0) {
+		fibril_mutex_unlock(&twheel_lock);
+		return EOK;
+	}
+
+	for (i = 0; i < TWHEEL_SLOTS; i++) {
+		list_initialize(&twheel_l0[i]);
+		list_initialize(&twheel_l1[i]);
+	}
+
+	fid = fibril_create(tcp_twheel_fibril, NULL);
+	if (fid == 0) {
+		fibril_mutex_unlock(&twheel_lock);
+		return ENOMEM;
+	}
+
+	twheel_fid = fid;
+	fibril_mutex_unlock(&twheel_lock);
+
+	fibril_add_ready(fid);
+	return EOK;
+}
+
+/** Create new timer wheel timer.
+ *
+ * @param lock		Lock guarding the user's state associated with
+ *			the timer
+ * @return		New timer on success, @c NULL if out of memory
+ */
+tcp_twheel_timer_t *tcp_twheel_timer_create(fibril_mutex_t *lock)
+{
+	tcp_twheel_timer_t *timer;
+
+	timer = calloc(1, sizeof(tcp_twheel_timer_t));
+	if (timer == NULL)
+		return NULL;
+
+	link_initialize(&timer->link);
+	timer->state = fts_not_set;
+	timer->lockp = lock;
+
+	if (tcp_twheel_start() != EOK) {
+		free(timer);
+		return NULL;
+	}
+
+	return timer;
+}
+
+/** Destroy timer wheel timer.
+ *
+ * @param timer		Timer, must not be active
+ */
+void tcp_twheel_timer_destroy(tcp_twheel_timer_t *timer)
+{
+	assert(timer->state == fts_not_set || timer->state == fts_fired);
+	free(timer);
+}
+
+/** Set timer wheel timer.
+ *
+ * Set timer to execute a callback function after the specified interval.
+ * Must be called with the timer's user lock held.
+ *
+ * @param timer		Timer
+ * @param delay		Delay in microseconds
+ * @param fun		Callback function
+ * @param arg		Argument for @a fun
+ */
+void tcp_twheel_timer_set_locked(tcp_twheel_timer_t *timer, usec_t delay,
+    tcp_twheel_fun_t fun, void *arg)
+{
+	assert(fibril_mutex_is_locked(timer->lockp));
+
+	fibril_mutex_lock(&twheel_lock);
+	assert(timer->state == fts_not_set || timer->state == fts_fired);
+
+	timer->fun = fun;
+	timer->arg = arg;
+	timer->expires = twheel_tick + 1 + delay / TWHEEL_TICK;
+	timer->state = fts_active;
+	tcp_twheel_insert(timer);
+
+	fibril_mutex_unlock(&twheel_lock);
+}
+
+/** Clear timer wheel timer.
+ *
+ * Clears (cancels) timer and returns last state of the timer.
+ * This can be one of:
+ *    - fts_not_set	If the timer has not been set or has been cleared
+ *    - fts_active	Timer was set but did not fire
+ *    - fts_fired	Timer fired
+ * If the timer callback is currently executing, wait for it to complete
+ * first (except when called from the callback itself). Must be called
+ * with the timer's user lock held.
+ *
+ * @param timer		Timer
+ * @return		Last timer state
+ */
+fibril_timer_state_t tcp_twheel_timer_clear_locked(tcp_twheel_timer_t *timer)
+{
+	fibril_timer_state_t old_state;
+
+	assert(fibril_mutex_is_locked(timer->lockp));
+
+	fibril_mutex_lock(&twheel_lock);
+	while (twheel_cur == timer && fibril_get_id() != twheel_fid) {
+		/*
+		 * Wait with a timeout: the callback may have already
+		 * passed its critical section under the user lock, in
+		 * which case its completion broadcast could precede our
+		 * wait.
+		 */
+		fibril_mutex_unlock(&twheel_lock);
+		fibril_condvar_wait_timeout(&twheel_done_cv, timer->lockp,
+		    TWHEEL_TICK);
+		fibril_mutex_lock(&twheel_lock);
+	}
+
+	old_state = timer->state;
+	if (timer->state == fts_active)
+		list_remove(&timer->link);
+	timer->state = fts_not_set;
+	fibril_mutex_unlock(&twheel_lock);
+
+	return old_state;
+}
+
+/**
+ * @}
+ */
@@ -53,9 +53,32 @@ typedef struct {
 /** List of clonable-service connection requests. */
 static list_t cs_req;
 
+/** Loader task spawned in advance. */
+typedef struct {
+	link_t link;
+	async_sess_t *sess;
+} cs_loader_t;
+
+/** Pool of loader tasks spawned in advance.
+ *
+ * Handing out a preforked loader removes the task creation and C library
+ * startup of a fresh loader from the spawn critical path; the pool is
+ * refilled in the background.
+ */
+static list_t cs_pool;
+
+/** Number of loader tasks to keep spawned in advance. */
+#define LOADER_POOL_SIZE  2
+
 errno_t ns_clonable_init(void)
 {
 	list_initialize(&cs_req);
+	list_initialize(&cs_pool);
+
+	/* Prefork the initial pool of loader tasks. */
+	for (unsigned i = 0; i < LOADER_POOL_SIZE; i++)
+		(void) loader_spawn("loader");
+
 	return EOK;
 }
 
@@ -74,9 +97,27 @@ void ns_clonable_register(ipc_call_t *call)
 {
 	link_t *req_link = list_first(&cs_req);
 	if (req_link == NULL) {
-		/* There was no pending connection request. */
-		printf("%s: Unexpected clonable server.\n", NAME);
-		async_answer_0(call, EBUSY);
+		/*
+		 * There is no pending connection request. Keep the loader
+		 * in the pool for a future request.
+		 */
+		cs_loader_t *csl = malloc(sizeof(cs_loader_t));
+		if (csl == NULL) {
+			async_answer_0(call, ENOMEM);
+			return;
+		}
+
+		async_answer_0(call, EOK);
+
+		async_sess_t *sess = async_callback_receive(EXCHANGE_SERIALIZE);
+		if (sess == NULL) {
+			free(csl);
+			return;
+		}
+
+		link_initialize(&csl->link);
+		csl->sess = sess;
+		list_append(&csl->link, &cs_pool);
 		return;
 	}
 
@@ -114,6 +155,25 @@ void ns_clonable_forward(service_t service, iface_t iface, ipc_call_t *call)
 {
 	assert(ns_service_is_clonable(service, iface));
 
+	link_t *pool_link = list_first(&cs_pool);
+	if (pool_link != NULL) {
+		/* Hand out a preforked loader and refill the pool. */
+		cs_loader_t *csl = list_get_instance(pool_link, cs_loader_t,
+		    link);
+		list_remove(pool_link);
+
+		async_exch_t *exch = async_exchange_begin(csl->sess);
+		async_forward_1(call, exch, iface, ipc_get_arg3(call),
+		    IPC_FF_NONE);
+		async_exchange_end(exch);
+
+		async_hangup(csl->sess);
+		free(csl);
+
+		(void) loader_spawn("loader");
+		return;
+	}
+
 	cs_req_t *csr = malloc(sizeof(cs_req_t));
 	if (csr == NULL) {
 		async_answer_0(call, ENOMEM);
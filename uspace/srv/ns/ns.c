@@ -103,6 +103,11 @@ static void ns_connection(ipc_call_t *icall, void *arg)
 			service = ipc_get_arg1(&call);
 			retval = ns_service_register_broker(service);
 			break;
+		case NS_REGISTER_MULTI:
+			service = ipc_get_arg1(&call);
+			retval = ns_service_register_multi(service,
+			    ipc_get_arg2(&call));
+			break;
 		case NS_PING:
 			retval = EOK;
 			break;
@@ -34,6 +34,7 @@
 #include <assert.h>
 #include <async.h>
 #include <errno.h>
+#include <ipc/ns.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "service.h"
@@ -297,6 +298,94 @@ errno_t ns_service_register(service_t service, iface_t iface)
 	return EOK;
 }
 
+/** Register several interfaces of a service with a single callback.
+ *
+ * The interface list is transferred via a data write and all listed
+ * interfaces share one callback session to the server. Forwarded
+ * connections carry the interface in the first argument, so the server
+ * still dispatches them to the proper port.
+ *
+ * @param service Service to which the interfaces belong.
+ * @param count   Number of interfaces to be registered.
+ *
+ * @return Zero on success or a value from @ref errno.h.
+ *
+ */
+errno_t ns_service_register_multi(service_t service, size_t count)
+{
+	iface_t *ifaces;
+	size_t size;
+	errno_t rc = async_data_write_accept((void **) &ifaces, false,
+	    sizeof(iface_t), NS_MAX_IFACES * sizeof(iface_t), sizeof(iface_t),
+	    &size);
+	if (rc != EOK)
+		return rc;
+
+	if ((count == 0) || (size != count * sizeof(iface_t))) {
+		free(ifaces);
+		return EINVAL;
+	}
+
+	hashed_service_t *hashed_service;
+	ht_link_t *link = hash_table_find(&service_hash_table, &service);
+
+	if (link) {
+		hashed_service = hash_table_get_inst(link, hashed_service_t,
+		    link);
+
+		assert(hashed_service->service == service);
+	} else {
+		hashed_service =
+		    (hashed_service_t *) malloc(sizeof(hashed_service_t));
+		if (!hashed_service) {
+			free(ifaces);
+			return ENOMEM;
+		}
+
+		if (!hash_table_create(&hashed_service->iface_hash_table, 0, 0,
+		    &iface_hash_table_ops)) {
+			free(hashed_service);
+			free(ifaces);
+			return ENOMEM;
+		}
+
+		hashed_service->broker_sess = NULL;
+		hashed_service->service = service;
+		hash_table_insert(&service_hash_table, &hashed_service->link);
+	}
+
+	async_sess_t *sess = async_callback_receive(EXCHANGE_SERIALIZE);
+	if (sess == NULL) {
+		free(ifaces);
+		return EIO;
+	}
+
+	rc = EOK;
+	for (size_t i = 0; i < count; i++) {
+		link = hash_table_find(&hashed_service->iface_hash_table,
+		    &ifaces[i]);
+		if (link) {
+			rc = EEXIST;
+			continue;
+		}
+
+		hashed_iface_t *hashed_iface =
+		    (hashed_iface_t *) malloc(sizeof(hashed_iface_t));
+		if (!hashed_iface) {
+			rc = ENOMEM;
+			break;
+		}
+
+		hashed_iface->iface = ifaces[i];
+		hashed_iface->sess = sess;
+		hash_table_insert(&hashed_service->iface_hash_table,
+		    &hashed_iface->link);
+	}
+
+	free(ifaces);
+	return rc;
+}
+
 /** Register broker service.
  *
  * @param service Broker service to be registered.
@@ -36,11 +36,13 @@
 #include <ipc/common.h>
 #include <ipc/services.h>
 #include <abi/ipc/interfaces.h>
+#include <stddef.h>
 
 extern errno_t ns_service_init(void);
 extern void ns_pending_conn_process(void);
 
 extern errno_t ns_service_register(service_t, iface_t);
+extern errno_t ns_service_register_multi(service_t, size_t);
 extern errno_t ns_service_register_broker(service_t);
 extern void ns_service_forward(service_t, iface_t, ipc_call_t *);
 
@@ -99,6 +99,24 @@ int main(int argc, char **argv)
 		return ENOMEM;
 	}
 
+	/*
+	 * Initialize the lookup cache.
+	 */
+	if (!vfs_dcache_init()) {
+		printf("%s: Failed to initialize the lookup cache\n",
+		    NAME);
+		return ENOMEM;
+	}
+
+	/*
+	 * Initialize the pager's page cache.
+	 */
+	if (!vfs_pager_init()) {
+		printf("%s: Failed to initialize the page cache\n",
+		    NAME);
+		return ENOMEM;
+	}
+
 	/*
 	 * Allocate and initialize the Path Lookup Buffer.
 	 */
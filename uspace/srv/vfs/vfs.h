@@ -37,10 +37,12 @@
 #include <adt/list.h>
 #include <adt/hash_table.h>
 #include <fibril_synch.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <loc.h>
 #include <stdbool.h>
+#include <time.h>
 #include <ipc/vfs.h>
 #include <task.h>
 #include <vfs/vfs.h>
@@ -108,9 +110,11 @@ typedef struct _vfs_node {
 
 	/**
 	 * Usage counter.  This includes, but is not limited to, all vfs_file_t
-	 * structures that reference this node.
+	 * structures that reference this node.  Manipulated atomically; once
+	 * it drops to zero, the node is on its way out and the count must not
+	 * be incremented again.
 	 */
-	unsigned refcnt;
+	atomic_int refcnt;
 
 	ht_link_t nh_link;		/**< Node hash-table link. */
 
@@ -136,8 +140,15 @@ typedef struct {
 
 	vfs_node_t *node;
 
-	/** Number of file handles referencing this file. */
-	unsigned refcnt;
+	/**
+	 * Number of file handles referencing this file.  Manipulated
+	 * atomically; once it drops to zero, the structure is returned to the
+	 * client's pool and the count must not be incremented again.
+	 */
+	atomic_int refcnt;
+
+	/** Link for placing the structure into the client's pool. */
+	link_t free_link;
 
 	int permissions;
 	bool open_read;
@@ -145,9 +156,22 @@ typedef struct {
 
 	/** Append on write. */
 	bool append;
-} vfs_file_t;
 
-extern fibril_mutex_t nodes_mutex;
+	/** Coalesce small sequential writes (MODE_BUFWRITE). */
+	bool wbuf_enabled;
+
+	/** Write-aggregation buffer, allocated on the first buffered write. */
+	void *wbuf;
+
+	/** File offset of the first buffered byte. */
+	aoff64_t wbuf_pos;
+
+	/** Number of buffered bytes. */
+	size_t wbuf_len;
+
+	/** Time the oldest buffered byte entered the buffer. */
+	struct timespec wbuf_stamp;
+} vfs_file_t;
 
 extern fibril_condvar_t fs_list_cv;
 extern fibril_mutex_t fs_list_lock;
@@ -182,6 +206,11 @@ extern errno_t vfs_get_fstypes(vfs_fstypes_t *);
 extern errno_t vfs_lookup_internal(vfs_node_t *, char *, int, vfs_lookup_res_t *);
 extern errno_t vfs_link_internal(vfs_node_t *, char *, vfs_triplet_t *);
 
+extern bool vfs_dcache_init(void);
+extern void vfs_dcache_invalidate(void);
+extern void vfs_dcache_invalidate_negative(void);
+extern void vfs_dcache_node_update(vfs_node_t *);
+
 extern bool vfs_nodes_init(void);
 extern vfs_node_t *vfs_node_get(vfs_lookup_res_t *);
 extern vfs_node_t *vfs_node_peek(vfs_lookup_res_t *result);
@@ -199,6 +228,8 @@ extern errno_t vfs_wait_handle_internal(bool, int *);
 
 extern vfs_file_t *vfs_file_get(int);
 extern void vfs_file_put(vfs_file_t *);
+extern void vfs_file_unlock(vfs_file_t *);
+extern void vfs_file_unref(vfs_file_t *);
 extern errno_t vfs_fd_assign(vfs_file_t *, int);
 extern errno_t vfs_fd_alloc(vfs_file_t **file, bool desc, int *);
 extern errno_t vfs_fd_free(int);
@@ -214,9 +245,12 @@ extern errno_t vfs_op_mtab_get(void);
 extern errno_t vfs_op_open(int fd, int flags);
 extern errno_t vfs_op_put(int fd);
 extern errno_t vfs_op_read(int fd, aoff64_t, size_t *out_bytes);
+extern errno_t vfs_op_readdir(int fd, aoff64_t *, void *buf, size_t size,
+    size_t *out_bytes);
 extern errno_t vfs_op_rename(int basefd, char *old, char *new);
 extern errno_t vfs_op_resize(int fd, int64_t size);
 extern errno_t vfs_op_stat(int fd);
+extern errno_t vfs_op_stat_path(int basefd, char *path, vfs_stat_t *stat);
 extern errno_t vfs_op_statfs(int fd);
 extern errno_t vfs_op_sync(int fd);
 extern errno_t vfs_op_unlink(int parentfd, int expectfd, char *path);
@@ -227,6 +261,8 @@ extern errno_t vfs_op_write(int fd, aoff64_t, size_t *out_bytes);
 
 extern void vfs_register(ipc_call_t *);
 
+extern bool vfs_pager_init(void);
+extern void vfs_page_cache_invalidate(vfs_node_t *);
 extern void vfs_page_in(ipc_call_t *);
 
 typedef struct {
@@ -236,6 +272,8 @@ typedef struct {
 
 extern errno_t vfs_rdwr_internal(int, aoff64_t, bool, rdwr_io_chunk_t *);
 
+extern errno_t vfs_wbuf_flush(vfs_file_t *);
+
 extern void vfs_connection(ipc_call_t *, void *);
 
 #endif
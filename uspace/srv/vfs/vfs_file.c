@@ -39,6 +39,7 @@
 #include <stdlib.h>
 #include <str.h>
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <fibril.h>
 #include <fibril_synch.h>
@@ -50,11 +51,26 @@
 #define VFS_DATA	((vfs_client_data_t *) async_get_client_data())
 #define FILES		(VFS_DATA->files)
 
+/*
+ * The handle table is a plain array of pointers indexed by the file handle.
+ * The translation on the I/O path is a lock-free atomic load of the slot
+ * followed by an atomic reference count increment; the client mutex is only
+ * taken when handles are allocated, assigned or freed.
+ *
+ * A file structure whose reference count dropped to zero is not freed but
+ * returned to a per-client pool from which new handles are allocated, so a
+ * stale pointer loaded from a slot concurrently with a close always points
+ * to a vfs_file_t.  After acquiring a reference, the reader rechecks that
+ * the slot still refers to the same structure and backs off if the
+ * structure was recycled for another handle in the meantime.
+ */
+
 typedef struct {
 	fibril_mutex_t lock;
 	fibril_condvar_t cv;
 	list_t passed_handles;
-	vfs_file_t **files;
+	list_t free_files;
+	vfs_file_t *_Atomic *files;
 } vfs_client_data_t;
 
 typedef struct {
@@ -70,12 +86,16 @@ static bool vfs_files_init(vfs_client_data_t *vfs_data)
 {
 	fibril_mutex_lock(&vfs_data->lock);
 	if (!vfs_data->files) {
-		vfs_data->files = malloc(VFS_MAX_OPEN_FILES * sizeof(vfs_file_t *));
+		vfs_data->files = malloc(VFS_MAX_OPEN_FILES *
+		    sizeof(vfs_file_t *_Atomic));
 		if (!vfs_data->files) {
 			fibril_mutex_unlock(&vfs_data->lock);
 			return false;
 		}
-		memset(vfs_data->files, 0, VFS_MAX_OPEN_FILES * sizeof(vfs_file_t *));
+		for (int i = 0; i < VFS_MAX_OPEN_FILES; i++) {
+			atomic_store_explicit(&vfs_data->files[i], NULL,
+			    memory_order_relaxed);
+		}
 	}
 	fibril_mutex_unlock(&vfs_data->lock);
 	return true;
@@ -90,12 +110,22 @@ static void vfs_files_done(vfs_client_data_t *vfs_data)
 		return;
 
 	for (i = 0; i < VFS_MAX_OPEN_FILES; i++) {
-		if (vfs_data->files[i])
+		if (atomic_load_explicit(&vfs_data->files[i],
+		    memory_order_relaxed))
 			(void) _vfs_fd_free(vfs_data, i);
 	}
 
 	free(vfs_data->files);
 
+	/*
+	 * All handles are gone now, so the pool can be safely emptied.
+	 */
+	while (!list_empty(&vfs_data->free_files)) {
+		link_t *lnk = list_first(&vfs_data->free_files);
+		list_remove(lnk);
+		free(list_get_instance(lnk, vfs_file_t, free_link));
+	}
+
 	while (!list_empty(&vfs_data->passed_handles)) {
 		link_t *lnk;
 		vfs_boxed_handle_t *bh;
@@ -117,6 +147,7 @@ void *vfs_client_data_create(void)
 		fibril_mutex_initialize(&vfs_data->lock);
 		fibril_condvar_initialize(&vfs_data->cv);
 		list_initialize(&vfs_data->passed_handles);
+		list_initialize(&vfs_data->free_files);
 		vfs_data->files = NULL;
 	}
 
@@ -134,7 +165,8 @@ void vfs_client_data_destroy(void *data)
 /** Close the file in the endpoint FS server. */
 static errno_t vfs_file_close_remote(vfs_file_t *file)
 {
-	assert(!file->refcnt);
+	assert(atomic_load_explicit(&file->refcnt,
+	    memory_order_relaxed) == 0);
 
 	async_exch_t *exch = vfs_exchange_grab(file->node->fs_handle);
 
@@ -150,16 +182,38 @@ static errno_t vfs_file_close_remote(vfs_file_t *file)
 	return ipc_get_retval(&answer);
 }
 
+/** Try to acquire a reference to a file found in the handle table.
+ *
+ * Fails if the file's reference count has already dropped to zero, in which
+ * case the file is being closed and must be treated as if the handle were
+ * not occupied at all.
+ *
+ * @return		True on success, false if the file is being closed.
+ */
+static bool _vfs_file_tryref(vfs_file_t *file)
+{
+	int cnt = atomic_load_explicit(&file->refcnt, memory_order_relaxed);
+	while (cnt > 0) {
+		if (atomic_compare_exchange_weak_explicit(&file->refcnt,
+		    &cnt, cnt + 1, memory_order_relaxed, memory_order_relaxed))
+			return true;
+	}
+	return false;
+}
+
 /** Increment reference count of VFS file structure.
+ *
+ * The caller must already hold a reference to the file.
  *
  * @param file		File structure that will have reference count
  *			incremented.
  */
-static void vfs_file_addref(vfs_client_data_t *vfs_data, vfs_file_t *file)
+static void vfs_file_addref(vfs_file_t *file)
 {
-	assert(fibril_mutex_is_locked(&vfs_data->lock));
-
-	file->refcnt++;
+	int old = atomic_fetch_add_explicit(&file->refcnt, 1,
+	    memory_order_relaxed);
+	assert(old >= 1);
+	(void) old;
 }
 
 /** Decrement reference count of VFS file structure.
@@ -171,26 +225,85 @@ static errno_t vfs_file_delref(vfs_client_data_t *vfs_data, vfs_file_t *file)
 {
 	errno_t rc = EOK;
 
-	assert(fibril_mutex_is_locked(&vfs_data->lock));
+	int old = atomic_fetch_sub_explicit(&file->refcnt, 1,
+	    memory_order_release);
+	assert(old >= 1);
+	if (old != 1)
+		return EOK;
 
-	if (file->refcnt-- == 1) {
-		/*
-		 * Lost the last reference to a file, need to close it in the
-		 * endpoint FS and drop our reference to the underlying VFS node.
-		 */
+	/*
+	 * Lost the last reference to a file, need to close it in the
+	 * endpoint FS and drop our reference to the underlying VFS node.
+	 */
+	atomic_thread_fence(memory_order_acquire);
 
-		if (file->node != NULL) {
-			if (file->open_read || file->open_write) {
-				rc = vfs_file_close_remote(file);
-			}
-			vfs_node_delref(file->node);
+	if (file->node != NULL) {
+		/* Buffered writes must reach the FS before the close. */
+		(void) vfs_wbuf_flush(file);
+		if (file->open_read || file->open_write) {
+			rc = vfs_file_close_remote(file);
 		}
-		free(file);
+		vfs_node_delref(file->node);
+		file->node = NULL;
 	}
 
+	if (file->wbuf != NULL) {
+		free(file->wbuf);
+		file->wbuf = NULL;
+	}
+
+	/*
+	 * The structure may still be examined by a concurrent
+	 * _vfs_file_get() which loaded its address from the handle table
+	 * before we were done, so instead of freeing it, return it to the
+	 * client's pool from which it can only be reused as a vfs_file_t
+	 * again.
+	 */
+	fibril_mutex_lock(&vfs_data->lock);
+	list_append(&file->free_link, &vfs_data->free_files);
+	fibril_mutex_unlock(&vfs_data->lock);
+
 	return rc;
 }
 
+/** Get a fresh file structure from the client's pool.
+ *
+ * Must be called with the client mutex held.
+ */
+static vfs_file_t *_vfs_file_new(vfs_client_data_t *vfs_data)
+{
+	vfs_file_t *file;
+
+	if (!list_empty(&vfs_data->free_files)) {
+		link_t *lnk = list_first(&vfs_data->free_files);
+		list_remove(lnk);
+		file = list_get_instance(lnk, vfs_file_t, free_link);
+	} else {
+		file = (vfs_file_t *) malloc(sizeof(vfs_file_t));
+		if (!file)
+			return NULL;
+	}
+
+	/*
+	 * Initialize the fields one by one rather than via memset(); the
+	 * reference count may be concurrently probed by a reader holding a
+	 * stale pointer to a recycled structure.
+	 */
+	fibril_mutex_initialize(&file->_lock);
+	link_initialize(&file->free_link);
+	file->node = NULL;
+	file->permissions = 0;
+	file->open_read = false;
+	file->open_write = false;
+	file->append = false;
+	file->wbuf_enabled = false;
+	file->wbuf = NULL;
+	file->wbuf_pos = 0;
+	file->wbuf_len = 0;
+
+	return file;
+}
+
 static errno_t _vfs_fd_alloc(vfs_client_data_t *vfs_data, vfs_file_t **file, bool desc, int *out_fd)
 {
 	if (!vfs_files_init(vfs_data))
@@ -204,21 +317,23 @@ static errno_t _vfs_fd_alloc(vfs_client_data_t *vfs_data, vfs_file_t **file, boo
 
 	fibril_mutex_lock(&vfs_data->lock);
 	while (true) {
-		if (!vfs_data->files[i]) {
-			vfs_data->files[i] = (vfs_file_t *) malloc(sizeof(vfs_file_t));
-			if (!vfs_data->files[i]) {
+		if (!atomic_load_explicit(&vfs_data->files[i],
+		    memory_order_relaxed)) {
+			vfs_file_t *new = _vfs_file_new(vfs_data);
+			if (!new) {
 				fibril_mutex_unlock(&vfs_data->lock);
 				return ENOMEM;
 			}
 
-			memset(vfs_data->files[i], 0, sizeof(vfs_file_t));
+			fibril_mutex_lock(&new->_lock);
 
-			fibril_mutex_initialize(&vfs_data->files[i]->_lock);
-			fibril_mutex_lock(&vfs_data->files[i]->_lock);
-			vfs_file_addref(vfs_data, vfs_data->files[i]);
+			/* One reference for the table, one for the caller. */
+			atomic_store_explicit(&new->refcnt, 2,
+			    memory_order_relaxed);
+			atomic_store_explicit(&vfs_data->files[i], new,
+			    memory_order_release);
 
-			*file = vfs_data->files[i];
-			vfs_file_addref(vfs_data, *file);
+			*file = new;
 
 			fibril_mutex_unlock(&vfs_data->lock);
 			*out_fd = (int) i;
@@ -257,29 +372,41 @@ errno_t vfs_fd_alloc(vfs_file_t **file, bool desc, int *out_fd)
 	return _vfs_fd_alloc(VFS_DATA, file, desc, out_fd);
 }
 
-static errno_t _vfs_fd_free_locked(vfs_client_data_t *vfs_data, int fd)
+/** Unhook a file from a handle.
+ *
+ * Must be called with the client mutex held.  The handle table's reference
+ * must be dropped by the caller after releasing the mutex.
+ *
+ * @return		The unhooked file or NULL if the handle was unused.
+ */
+static vfs_file_t *_vfs_fd_unassign_locked(vfs_client_data_t *vfs_data, int fd)
 {
-	if ((fd < 0) || (fd >= VFS_MAX_OPEN_FILES) || !vfs_data->files[fd]) {
-		return EBADF;
+	if ((fd < 0) || (fd >= VFS_MAX_OPEN_FILES))
+		return NULL;
+
+	vfs_file_t *file = atomic_load_explicit(&vfs_data->files[fd],
+	    memory_order_relaxed);
+	if (file != NULL) {
+		atomic_store_explicit(&vfs_data->files[fd], NULL,
+		    memory_order_relaxed);
 	}
 
-	errno_t rc = vfs_file_delref(vfs_data, vfs_data->files[fd]);
-	vfs_data->files[fd] = NULL;
-	return rc;
+	return file;
 }
 
 static errno_t _vfs_fd_free(vfs_client_data_t *vfs_data, int fd)
 {
-	errno_t rc;
-
 	if (!vfs_files_init(vfs_data))
 		return ENOMEM;
 
 	fibril_mutex_lock(&vfs_data->lock);
-	rc = _vfs_fd_free_locked(vfs_data, fd);
+	vfs_file_t *file = _vfs_fd_unassign_locked(vfs_data, fd);
 	fibril_mutex_unlock(&vfs_data->lock);
 
-	return rc;
+	if (!file)
+		return EBADF;
+
+	return vfs_file_delref(vfs_data, file);
 }
 
 /** Release file descriptor.
@@ -315,23 +442,22 @@ errno_t vfs_fd_assign(vfs_file_t *file, int fd)
 	}
 
 	/* Make sure fd is closed. */
-	(void) _vfs_fd_free_locked(VFS_DATA, fd);
-	assert(FILES[fd] == NULL);
+	vfs_file_t *old = _vfs_fd_unassign_locked(VFS_DATA, fd);
 
-	FILES[fd] = file;
-	vfs_file_addref(VFS_DATA, FILES[fd]);
+	vfs_file_addref(file);
+	atomic_store_explicit(&FILES[fd], file, memory_order_release);
 	fibril_mutex_unlock(&VFS_DATA->lock);
 
+	if (old)
+		(void) vfs_file_delref(VFS_DATA, old);
+
 	return EOK;
 }
 
 static void _vfs_file_put(vfs_client_data_t *vfs_data, vfs_file_t *file)
 {
 	fibril_mutex_unlock(&file->_lock);
-
-	fibril_mutex_lock(&vfs_data->lock);
 	vfs_file_delref(vfs_data, file);
-	fibril_mutex_unlock(&vfs_data->lock);
 }
 
 static vfs_file_t *_vfs_file_get(vfs_client_data_t *vfs_data, int fd)
@@ -339,26 +465,41 @@ static vfs_file_t *_vfs_file_get(vfs_client_data_t *vfs_data, int fd)
 	if (!vfs_files_init(vfs_data))
 		return NULL;
 
-	fibril_mutex_lock(&vfs_data->lock);
-	if ((fd >= 0) && (fd < VFS_MAX_OPEN_FILES)) {
-		vfs_file_t *file = vfs_data->files[fd];
-		if (file != NULL) {
-			vfs_file_addref(vfs_data, file);
-			fibril_mutex_unlock(&vfs_data->lock);
+	if ((fd < 0) || (fd >= VFS_MAX_OPEN_FILES))
+		return NULL;
+
+	while (true) {
+		vfs_file_t *file = atomic_load_explicit(&vfs_data->files[fd],
+		    memory_order_acquire);
+		if (file == NULL)
+			return NULL;
+
+		if (!_vfs_file_tryref(file)) {
+			/*
+			 * The handle was closed under our hands.  Reload the
+			 * slot; it no longer refers to this structure.
+			 */
+			continue;
+		}
 
+		/*
+		 * The structure may have been closed and recycled for a
+		 * different handle between the load and the tryref.  Only
+		 * proceed if the slot still refers to it.
+		 */
+		if (atomic_load_explicit(&vfs_data->files[fd],
+		    memory_order_relaxed) == file) {
 			fibril_mutex_lock(&file->_lock);
 			if (file->node == NULL) {
 				_vfs_file_put(vfs_data, file);
 				return NULL;
 			}
-			assert(file != NULL);
 			assert(file->node != NULL);
 			return file;
 		}
-	}
-	fibril_mutex_unlock(&vfs_data->lock);
 
-	return NULL;
+		vfs_file_delref(vfs_data, file);
+	}
 }
 
 /** Find VFS file structure for a given file descriptor.
@@ -381,6 +522,28 @@ void vfs_file_put(vfs_file_t *file)
 	_vfs_file_put(VFS_DATA, file);
 }
 
+/** Drop the lock of a file structure while keeping the reference.
+ *
+ * Subsequent requests on the same file handle can then be served in
+ * parallel.  The caller must eventually release its reference using
+ * vfs_file_unref().
+ *
+ * @param file		VFS file structure.
+ */
+void vfs_file_unlock(vfs_file_t *file)
+{
+	fibril_mutex_unlock(&file->_lock);
+}
+
+/** Release a reference to an already unlocked file structure.
+ *
+ * @param file		VFS file structure.
+ */
+void vfs_file_unref(vfs_file_t *file)
+{
+	(void) vfs_file_delref(VFS_DATA, file);
+}
+
 void vfs_op_pass_handle(task_id_t donor_id, task_id_t acceptor_id, int donor_fd)
 {
 	vfs_client_data_t *donor_data = NULL;
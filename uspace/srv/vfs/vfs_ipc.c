@@ -183,6 +183,40 @@ static void vfs_in_read(ipc_call_t *req)
 	async_answer_1(req, rc, bytes);
 }
 
+static void vfs_in_readdir(ipc_call_t *req)
+{
+	int fd = ipc_get_arg1(req);
+	aoff64_t pos = MERGE_LOUP32(ipc_get_arg2(req),
+	    ipc_get_arg3(req));
+
+	/* Now we expect a read request for the batch of entry names. */
+	ipc_call_t call;
+	size_t size;
+	if (!async_data_read_receive(&call, &size)) {
+		async_answer_0(req, EINVAL);
+		return;
+	}
+
+	char *buf = malloc(size);
+	if (!buf) {
+		async_answer_0(&call, ENOMEM);
+		async_answer_0(req, ENOMEM);
+		return;
+	}
+
+	size_t bytes = 0;
+	errno_t rc = vfs_op_readdir(fd, &pos, buf, size, &bytes);
+	if (rc != EOK) {
+		async_answer_0(&call, rc);
+		async_answer_0(req, rc);
+	} else {
+		async_data_read_finalize(&call, buf, bytes);
+		async_answer_3(req, EOK, bytes, LOWER32(pos), UPPER32(pos));
+	}
+
+	free(buf);
+}
+
 static void vfs_in_rename(ipc_call_t *req)
 {
 	/* The common base directory. */
@@ -242,6 +276,77 @@ static void vfs_in_stat(ipc_call_t *req)
 	async_answer_0(req, rc);
 }
 
+static void vfs_in_stat_batch(ipc_call_t *req)
+{
+	int basefd = ipc_get_arg1(req);
+	size_t cnt = ipc_get_arg2(req);
+
+	if (cnt == 0 || cnt > DATA_XFER_LIMIT / sizeof(vfs_stat_batch_t)) {
+		async_answer_0(req, EINVAL);
+		return;
+	}
+
+	/*
+	 * Now we expect the client to send us the paths as consecutive
+	 * null-terminated strings.
+	 */
+	char *paths = NULL;
+	size_t size = 0;
+	errno_t rc = async_data_write_accept((void **) &paths, false, 0, 0, 0,
+	    &size);
+	if (rc != EOK) {
+		async_answer_0(req, rc);
+		return;
+	}
+
+	vfs_stat_batch_t *results = calloc(cnt, sizeof(vfs_stat_batch_t));
+	if (!results) {
+		free(paths);
+		async_answer_0(req, ENOMEM);
+		return;
+	}
+
+	size_t off = 0;
+	for (size_t i = 0; i < cnt; i++) {
+		if (off >= size) {
+			/* Fewer paths than advertised. */
+			rc = EINVAL;
+			break;
+		}
+
+		size_t len = str_nsize(paths + off, size - off);
+		if (len == size - off) {
+			/* The last path is not null-terminated. */
+			rc = EINVAL;
+			break;
+		}
+
+		results[i].rc = vfs_op_stat_path(basefd, paths + off,
+		    &results[i].stat);
+		off += len + 1;
+	}
+
+	free(paths);
+
+	if (rc != EOK) {
+		free(results);
+		async_answer_0(req, rc);
+		return;
+	}
+
+	/* Now we should get a read request for the results. */
+	ipc_call_t call;
+	size_t len;
+	if (async_data_read_receive(&call, &len)) {
+		if (len > cnt * sizeof(vfs_stat_batch_t))
+			len = cnt * sizeof(vfs_stat_batch_t);
+		(void) async_data_read_finalize(&call, results, len);
+	}
+
+	async_answer_0(req, rc);
+	free(results);
+}
+
 static void vfs_in_statfs(ipc_call_t *req)
 {
 	int fd = (int) ipc_get_arg1(req);
@@ -356,6 +461,9 @@ void vfs_connection(ipc_call_t *icall, void *arg)
 		case VFS_IN_READ:
 			vfs_in_read(&call);
 			break;
+		case VFS_IN_READDIR:
+			vfs_in_readdir(&call);
+			break;
 		case VFS_IN_REGISTER:
 			vfs_register(&call);
 			cont = false;
@@ -369,6 +477,9 @@ void vfs_connection(ipc_call_t *icall, void *arg)
 		case VFS_IN_STAT:
 			vfs_in_stat(&call);
 			break;
+		case VFS_IN_STAT_BATCH:
+			vfs_in_stat_batch(&call);
+			break;
 		case VFS_IN_STATFS:
 			vfs_in_statfs(&call);
 			break;
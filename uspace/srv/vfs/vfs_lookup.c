@@ -42,8 +42,11 @@
 #include <str.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <fibril_synch.h>
 #include <adt/list.h>
+#include <adt/hash_table.h>
+#include <adt/hash.h>
 #include <vfs/canonify.h>
 #include <dirent.h>
 #include <assert.h>
@@ -52,6 +55,273 @@ FIBRIL_MUTEX_INITIALIZE(plb_mutex);
 LIST_INITIALIZE(plb_entries);	/**< PLB entry ring buffer. */
 uint8_t *plb = NULL;
 
+/*
+ * Lookup cache.
+ *
+ * Maps the triplet of the lookup base node, the lookup flags and the
+ * canonical path to the result of a previously successful lookup, so that
+ * hot-path resolutions are answered inside the VFS task without a round
+ * trip to the FS server.  Only lookups which do not modify the namespace
+ * are cached.  The cache is flushed whenever the namespace changes in a
+ * way that could invalidate a cached result: on unlink (which also covers
+ * rename) and on mount/unmount.  Cached file sizes are refreshed from the
+ * respective in-memory VFS node as long as one exists and are written
+ * back by the node when it is being destroyed.
+ *
+ * Lookups failing with ENOENT are cached as negative entries, so repeated
+ * probes for nonexistent paths (PATH searches, configuration fallbacks)
+ * are answered without a round trip as well.  Negative entries are
+ * dropped whenever a name is created, as the new name may satisfy any of
+ * them.
+ */
+
+/** Maximum number of cached lookup results. */
+#define DCACHE_CAPACITY		128
+
+/** Lookup flags which change the outcome of a cacheable lookup. */
+#define DCACHE_LFLAG_MASK	(L_FILE | L_DIRECTORY | L_MP | L_DISABLE_MOUNTS)
+
+typedef struct {
+	ht_link_t dc_link;	/**< Cache hash-table link. */
+	link_t lru_link;	/**< LRU list link. */
+	vfs_triplet_t base;	/**< Triplet of the lookup base node. */
+	int lflag;		/**< Masked lookup flags. */
+	char *path;		/**< Canonical path relative to the base. */
+	bool negative;		/**< True if the lookup failed with ENOENT. */
+	vfs_lookup_res_t res;	/**< Cached lookup result. */
+} dcache_entry_t;
+
+typedef struct {
+	vfs_triplet_t base;
+	int lflag;
+	const char *path;
+} dcache_key_t;
+
+/** Mutex protecting the lookup cache. */
+static FIBRIL_MUTEX_INITIALIZE(dcache_mutex);
+static hash_table_t dcache;
+static LIST_INITIALIZE(dcache_lru);
+static size_t dcache_count;
+
+static size_t dcache_path_hash(const char *path)
+{
+	size_t hash = 0;
+	while (*path)
+		hash = hash_combine(hash, (unsigned char) *path++);
+	return hash;
+}
+
+static size_t dcache_key_hash(const void *key)
+{
+	const dcache_key_t *k = key;
+	size_t hash = hash_combine(k->base.fs_handle, k->base.index);
+	hash = hash_combine(hash, k->base.service_id);
+	hash = hash_combine(hash, k->lflag);
+	return hash_combine(hash, dcache_path_hash(k->path));
+}
+
+static size_t dcache_hash(const ht_link_t *item)
+{
+	dcache_entry_t *entry = hash_table_get_inst(item, dcache_entry_t,
+	    dc_link);
+	dcache_key_t key = {
+		.base = entry->base,
+		.lflag = entry->lflag,
+		.path = entry->path
+	};
+	return dcache_key_hash(&key);
+}
+
+static bool dcache_key_equal(const void *key, const ht_link_t *item)
+{
+	const dcache_key_t *k = key;
+	dcache_entry_t *entry = hash_table_get_inst(item, dcache_entry_t,
+	    dc_link);
+	return entry->base.fs_handle == k->base.fs_handle &&
+	    entry->base.service_id == k->base.service_id &&
+	    entry->base.index == k->base.index &&
+	    entry->lflag == k->lflag && str_cmp(entry->path, k->path) == 0;
+}
+
+/** Lookup cache hash table operations. */
+static const hash_table_ops_t dcache_ops = {
+	.hash = dcache_hash,
+	.key_hash = dcache_key_hash,
+	.key_equal = dcache_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL,
+};
+
+/** Initialize the lookup cache.
+ *
+ * @return		Return true on success, false on failure.
+ */
+bool vfs_dcache_init(void)
+{
+	return hash_table_create(&dcache, 0, 0, &dcache_ops);
+}
+
+static void dcache_entry_destroy(dcache_entry_t *entry)
+{
+	hash_table_remove_item(&dcache, &entry->dc_link);
+	list_remove(&entry->lru_link);
+	dcache_count--;
+	free(entry->path);
+	free(entry);
+}
+
+/** Try to answer a lookup from the cache.
+ *
+ * @param base		Triplet of the lookup base node.
+ * @param path		Canonical path being looked up.
+ * @param lflag		Masked lookup flags.
+ * @param res		Empty structure where the cached result is stored.
+ * @param negative	Set to true if the cached lookup failed with ENOENT,
+ *			in which case @a res is left untouched.
+ *
+ * @return		True on a cache hit, false otherwise.
+ */
+static bool dcache_lookup(vfs_triplet_t *base, const char *path, int lflag,
+    vfs_lookup_res_t *res, bool *negative)
+{
+	dcache_key_t key = {
+		.base = *base,
+		.lflag = lflag,
+		.path = path
+	};
+
+	fibril_mutex_lock(&dcache_mutex);
+	ht_link_t *tmp = hash_table_find(&dcache, &key);
+	if (!tmp) {
+		fibril_mutex_unlock(&dcache_mutex);
+		return false;
+	}
+
+	dcache_entry_t *entry = hash_table_get_inst(tmp, dcache_entry_t,
+	    dc_link);
+	list_remove(&entry->lru_link);
+	list_prepend(&entry->lru_link, &dcache_lru);
+	*negative = entry->negative;
+	if (!entry->negative)
+		*res = entry->res;
+	fibril_mutex_unlock(&dcache_mutex);
+	return true;
+}
+
+/** Remember the result of a lookup.
+ *
+ * @param res		Result of a successful lookup, or NULL to record a
+ *			negative entry for a lookup that failed with ENOENT.
+ */
+static void dcache_insert(vfs_triplet_t *base, const char *path, int lflag,
+    vfs_lookup_res_t *res)
+{
+	dcache_entry_t *entry = malloc(sizeof(dcache_entry_t));
+	if (!entry)
+		return;
+
+	entry->base = *base;
+	entry->lflag = lflag;
+	entry->path = str_dup(path);
+	entry->negative = (res == NULL);
+	if (res != NULL)
+		entry->res = *res;
+	else
+		memset(&entry->res, 0, sizeof(entry->res));
+	if (!entry->path) {
+		free(entry);
+		return;
+	}
+
+	dcache_key_t key = {
+		.base = *base,
+		.lflag = lflag,
+		.path = path
+	};
+
+	fibril_mutex_lock(&dcache_mutex);
+
+	/* A concurrent lookup may have beaten us to it. */
+	ht_link_t *tmp = hash_table_find(&dcache, &key);
+	if (tmp) {
+		dcache_entry_t *old = hash_table_get_inst(tmp, dcache_entry_t,
+		    dc_link);
+		old->negative = (res == NULL);
+		if (res != NULL)
+			old->res = *res;
+		list_remove(&old->lru_link);
+		list_prepend(&old->lru_link, &dcache_lru);
+		fibril_mutex_unlock(&dcache_mutex);
+		free(entry->path);
+		free(entry);
+		return;
+	}
+
+	hash_table_insert(&dcache, &entry->dc_link);
+	list_prepend(&entry->lru_link, &dcache_lru);
+	dcache_count++;
+
+	if (dcache_count > DCACHE_CAPACITY) {
+		dcache_entry_destroy(list_get_instance(list_last(&dcache_lru),
+		    dcache_entry_t, lru_link));
+	}
+
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+/** Flush the lookup cache.
+ *
+ * Called whenever the file system namespace is modified in a way that
+ * could invalidate a cached lookup result.
+ */
+void vfs_dcache_invalidate(void)
+{
+	fibril_mutex_lock(&dcache_mutex);
+	while (!list_empty(&dcache_lru)) {
+		dcache_entry_destroy(list_get_instance(list_first(&dcache_lru),
+		    dcache_entry_t, lru_link));
+	}
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+/** Drop all negative entries from the lookup cache.
+ *
+ * Called whenever a new name is created; the created name may be exactly
+ * the one whose absence a negative entry records.
+ */
+void vfs_dcache_invalidate_negative(void)
+{
+	fibril_mutex_lock(&dcache_mutex);
+	list_foreach_safe(dcache_lru, cur, next) {
+		dcache_entry_t *entry = list_get_instance(cur, dcache_entry_t,
+		    lru_link);
+		if (entry->negative)
+			dcache_entry_destroy(entry);
+	}
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+/** Write the final metadata of a dying node back to the lookup cache.
+ *
+ * Must be called before the node is removed from the node hash table so
+ * that no lookup can observe a stale size in between.
+ *
+ * @param node		Node that is about to be destroyed.
+ */
+void vfs_dcache_node_update(vfs_node_t *node)
+{
+	fibril_mutex_lock(&dcache_mutex);
+	list_foreach(dcache_lru, lru_link, dcache_entry_t, entry) {
+		if (entry->res.triplet.fs_handle == node->fs_handle &&
+		    entry->res.triplet.service_id == node->service_id &&
+		    entry->res.triplet.index == node->index) {
+			entry->res.size = node->size;
+			entry->res.type = node->type;
+		}
+	}
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
 static errno_t plb_insert_entry(plb_entry_t *entry, char *path, size_t *start,
     size_t len)
 {
@@ -202,6 +472,12 @@ errno_t vfs_link_internal(vfs_node_t *base, char *path, vfs_triplet_t *child)
 	if (orig_rc != EOK)
 		rc = orig_rc;
 
+	/*
+	 * The new name may satisfy a cached negative lookup.
+	 */
+	if (rc == EOK)
+		vfs_dcache_invalidate_negative();
+
 out:
 	return rc;
 }
@@ -387,8 +663,56 @@ errno_t vfs_lookup_internal(vfs_node_t *base, char *path, int lflag,
 
 		vfs_node_put(parent);
 
+		/*
+		 * Removing a name could invalidate any number of cached
+		 * results, including results cached under different names
+		 * (e.g. after a rename).  Flush the whole cache.
+		 */
+		if ((rc == EOK) && (lflag & L_UNLINK))
+			vfs_dcache_invalidate();
+
+		/*
+		 * Creating a name may satisfy a cached negative lookup.
+		 */
+		if ((rc == EOK) && (lflag & L_CREATE))
+			vfs_dcache_invalidate_negative();
+
 	} else {
-		rc = _vfs_lookup_internal(base, path, lflag, result, len);
+		vfs_lookup_res_t res;
+		bool negative = false;
+		int clflag = lflag & DCACHE_LFLAG_MASK;
+
+		if (dcache_lookup((vfs_triplet_t *) base, path, clflag,
+		    &res, &negative)) {
+			if (negative)
+				return ENOENT;
+
+			/*
+			 * Refresh the cached metadata from the in-memory
+			 * node, if there is one; the node has the
+			 * authoritative size.
+			 */
+			vfs_node_t *node = vfs_node_peek(&res);
+			if (node) {
+				res.size = node->size;
+				res.type = node->type;
+				vfs_node_put(node);
+			}
+			if (result != NULL)
+				*result = res;
+			return EOK;
+		}
+
+		rc = _vfs_lookup_internal(base, path, lflag, &res, len);
+		if (rc == EOK) {
+			dcache_insert((vfs_triplet_t *) base, path, clflag,
+			    &res);
+			if (result != NULL)
+				*result = res;
+		} else if (rc == ENOENT) {
+			dcache_insert((vfs_triplet_t *) base, path, clflag,
+			    NULL);
+		}
 	}
 
 	return rc;
@@ -38,6 +38,7 @@
 #include "vfs.h"
 #include <stdlib.h>
 #include <str.h>
+#include <stdatomic.h>
 #include <fibril_synch.h>
 #include <adt/hash_table.h>
 #include <adt/hash.h>
@@ -46,18 +47,24 @@
 #include <errno.h>
 #include <macros.h>
 
-/** Mutex protecting the VFS node hash table. */
-FIBRIL_MUTEX_INITIALIZE(nodes_mutex);
+/*
+ * The VFS node table is sharded by triplet hash in order to spread lock
+ * contention of concurrent clients over several mutexes.  The reference
+ * count of a node is manipulated with atomics, so the common addref/delref
+ * path takes no lock at all; the shard mutex is only taken when a node is
+ * inserted into or removed from its shard.
+ */
 
-#define NODES_BUCKETS_LOG	8
-#define NODES_BUCKETS		(1 << NODES_BUCKETS_LOG)
+#define NODES_SHARDS_LOG	4
+#define NODES_SHARDS		(1 << NODES_SHARDS_LOG)
 
-/** VFS node hash table containing all active, in-memory VFS nodes. */
-hash_table_t nodes;
+typedef struct {
+	fibril_mutex_t lock;
+	hash_table_t table;
+} nodes_shard_t;
 
-#define KEY_FS_HANDLE	0
-#define KEY_DEV_HANDLE	1
-#define KEY_INDEX	2
+/** VFS node shards jointly containing all active, in-memory VFS nodes. */
+static nodes_shard_t nodes_shards[NODES_SHARDS];
 
 static size_t nodes_key_hash(const void *);
 static size_t nodes_hash(const ht_link_t *);
@@ -73,29 +80,56 @@ const hash_table_ops_t nodes_ops = {
 	.remove_callback = NULL,
 };
 
-/** Initialize the VFS node hash table.
+static inline nodes_shard_t *nodes_shard(const vfs_triplet_t *tri)
+{
+	return &nodes_shards[nodes_key_hash(tri) & (NODES_SHARDS - 1)];
+}
+
+/** Initialize the VFS node table.
  *
  * @return		Return true on success, false on failure.
  */
 bool vfs_nodes_init(void)
 {
-	return hash_table_create(&nodes, 0, 0, &nodes_ops);
+	for (unsigned i = 0; i < NODES_SHARDS; i++) {
+		fibril_mutex_initialize(&nodes_shards[i].lock);
+		if (!hash_table_create(&nodes_shards[i].table, 0, 0,
+		    &nodes_ops))
+			return false;
+	}
+	return true;
 }
 
-static inline void _vfs_node_addref(vfs_node_t *node)
+/** Try to acquire a reference to a node found in its shard.
+ *
+ * Must be called with the shard mutex held.  Fails if the node's reference
+ * count has already dropped to zero, in which case the node is on its way
+ * out and must be treated as if it were not in the table at all.
+ *
+ * @return		True on success, false if the node is being destroyed.
+ */
+static bool _vfs_node_tryref(vfs_node_t *node)
 {
-	node->refcnt++;
+	int cnt = atomic_load_explicit(&node->refcnt, memory_order_relaxed);
+	while (cnt > 0) {
+		if (atomic_compare_exchange_weak_explicit(&node->refcnt,
+		    &cnt, cnt + 1, memory_order_relaxed, memory_order_relaxed))
+			return true;
+	}
+	return false;
 }
 
 /** Increment reference count of a VFS node.
+ *
+ * The caller must already hold a reference to the node.
  *
  * @param node		VFS node that will have its refcnt incremented.
  */
 void vfs_node_addref(vfs_node_t *node)
 {
-	fibril_mutex_lock(&nodes_mutex);
-	_vfs_node_addref(node);
-	fibril_mutex_unlock(&nodes_mutex);
+	int old = atomic_fetch_add_explicit(&node->refcnt, 1,
+	    memory_order_relaxed);
+	assert(old >= 1);
 }
 
 /** Decrement reference count of a VFS node.
@@ -106,50 +140,75 @@ void vfs_node_addref(vfs_node_t *node)
  */
 void vfs_node_delref(vfs_node_t *node)
 {
-	bool free_node = false;
-
-	fibril_mutex_lock(&nodes_mutex);
-
-	node->refcnt--;
-	if (node->refcnt == 0) {
-		/*
-		 * We are dropping the last reference to this node.
-		 * Remove it from the VFS node hash table.
-		 */
-
-		hash_table_remove_item(&nodes, &node->nh_link);
-		free_node = true;
-	}
-
-	fibril_mutex_unlock(&nodes_mutex);
+	int old = atomic_fetch_sub_explicit(&node->refcnt, 1,
+	    memory_order_release);
+	assert(old >= 1);
+	if (old != 1)
+		return;
+
+	/*
+	 * We dropped the last reference.  Synchronize with the other
+	 * decrementers and dismantle the node.
+	 */
+	atomic_thread_fence(memory_order_acquire);
 
-	if (free_node) {
-		/*
-		 * VFS_OUT_DESTROY will free up the file's resources if there
-		 * are no more hard links.
-		 */
+	vfs_triplet_t tri = node_triplet(node);
+	nodes_shard_t *shard = nodes_shard(&tri);
+
+	fibril_mutex_lock(&shard->lock);
+
+	/*
+	 * Hand the node's final metadata over to the lookup cache before the
+	 * node leaves the table, so that no lookup can observe a stale size
+	 * in between.
+	 */
+	vfs_dcache_node_update(node);
+
+	/*
+	 * A concurrent vfs_node_get() may have observed our zero reference
+	 * count, given up on this node and replaced it in the table with a
+	 * fresh instance.  Only remove the node if it is still ours.
+	 */
+	ht_link_t *tmp = hash_table_find(&shard->table, &tri);
+	if (tmp == &node->nh_link)
+		hash_table_remove_item(&shard->table, &node->nh_link);
+
+	fibril_mutex_unlock(&shard->lock);
+
+	/*
+	 * The node's index may be reused by the file system once the node is
+	 * destroyed, so any pages the pager may still cache for it must go.
+	 */
+	vfs_page_cache_invalidate(node);
+
+	/*
+	 * VFS_OUT_DESTROY will free up the file's resources if there
+	 * are no more hard links.
+	 */
 
-		async_exch_t *exch = vfs_exchange_grab(node->fs_handle);
-		async_msg_2(exch, VFS_OUT_DESTROY, (sysarg_t) node->service_id,
-		    (sysarg_t)node->index);
-		vfs_exchange_release(exch);
+	async_exch_t *exch = vfs_exchange_grab(node->fs_handle);
+	async_msg_2(exch, VFS_OUT_DESTROY, (sysarg_t) node->service_id,
+	    (sysarg_t)node->index);
+	vfs_exchange_release(exch);
 
-		free(node);
-	}
+	free(node);
 }
 
 /** Forget node.
  *
- * This function will remove the node from the node hash table and deallocate
+ * This function will remove the node from the node table and deallocate
  * its memory, regardless of the node's reference count.
  *
  * @param node	Node to be forgotten.
  */
 void vfs_node_forget(vfs_node_t *node)
 {
-	fibril_mutex_lock(&nodes_mutex);
-	hash_table_remove_item(&nodes, &node->nh_link);
-	fibril_mutex_unlock(&nodes_mutex);
+	vfs_triplet_t tri = node_triplet(node);
+	nodes_shard_t *shard = nodes_shard(&tri);
+
+	fibril_mutex_lock(&shard->lock);
+	hash_table_remove_item(&shard->table, &node->nh_link);
+	fibril_mutex_unlock(&shard->lock);
 	free(node);
 }
 
@@ -167,45 +226,58 @@ void vfs_node_forget(vfs_node_t *node)
  */
 vfs_node_t *vfs_node_get(vfs_lookup_res_t *result)
 {
+	nodes_shard_t *shard = nodes_shard(&result->triplet);
 	vfs_node_t *node;
 
-	fibril_mutex_lock(&nodes_mutex);
-	ht_link_t *tmp = hash_table_find(&nodes, &result->triplet);
-	if (!tmp) {
-		node = (vfs_node_t *) malloc(sizeof(vfs_node_t));
-		if (!node) {
-			fibril_mutex_unlock(&nodes_mutex);
-			return NULL;
-		}
-		memset(node, 0, sizeof(vfs_node_t));
-		node->fs_handle = result->triplet.fs_handle;
-		node->service_id = result->triplet.service_id;
-		node->index = result->triplet.index;
-		node->size = result->size;
-		node->type = result->type;
-		fibril_rwlock_initialize(&node->contents_rwlock);
-		hash_table_insert(&nodes, &node->nh_link);
-	} else {
+	fibril_mutex_lock(&shard->lock);
+	ht_link_t *tmp = hash_table_find(&shard->table, &result->triplet);
+	if (tmp) {
 		node = hash_table_get_inst(tmp, vfs_node_t, nh_link);
+		if (_vfs_node_tryref(node)) {
+			fibril_mutex_unlock(&shard->lock);
+			return node;
+		}
+
+		/*
+		 * The node is being destroyed.  Take its place in the table
+		 * so that nobody else stumbles upon it; the destroyer will
+		 * notice and leave the replacement alone.
+		 */
+		hash_table_remove_item(&shard->table, &node->nh_link);
 	}
 
-	_vfs_node_addref(node);
-	fibril_mutex_unlock(&nodes_mutex);
+	node = (vfs_node_t *) malloc(sizeof(vfs_node_t));
+	if (!node) {
+		fibril_mutex_unlock(&shard->lock);
+		return NULL;
+	}
+	memset(node, 0, sizeof(vfs_node_t));
+	node->fs_handle = result->triplet.fs_handle;
+	node->service_id = result->triplet.service_id;
+	node->index = result->triplet.index;
+	node->size = result->size;
+	node->type = result->type;
+	atomic_store_explicit(&node->refcnt, 1, memory_order_relaxed);
+	fibril_rwlock_initialize(&node->contents_rwlock);
+	hash_table_insert(&shard->table, &node->nh_link);
+	fibril_mutex_unlock(&shard->lock);
 
 	return node;
 }
 
 vfs_node_t *vfs_node_peek(vfs_lookup_res_t *result)
 {
+	nodes_shard_t *shard = nodes_shard(&result->triplet);
 	vfs_node_t *node = NULL;
 
-	fibril_mutex_lock(&nodes_mutex);
-	ht_link_t *tmp = hash_table_find(&nodes, &result->triplet);
+	fibril_mutex_lock(&shard->lock);
+	ht_link_t *tmp = hash_table_find(&shard->table, &result->triplet);
 	if (tmp) {
 		node = hash_table_get_inst(tmp, vfs_node_t, nh_link);
-		_vfs_node_addref(node);
+		if (!_vfs_node_tryref(node))
+			node = NULL;
 	}
-	fibril_mutex_unlock(&nodes_mutex);
+	fibril_mutex_unlock(&shard->lock);
 
 	return node;
 }
@@ -236,8 +308,12 @@ static bool refcnt_visitor(ht_link_t *item, void *arg)
 	struct refcnt_data *rd = (void *) arg;
 
 	if ((node->fs_handle == rd->fs_handle) &&
-	    (node->service_id == rd->service_id))
-		rd->refcnt += node->refcnt;
+	    (node->service_id == rd->service_id)) {
+		int cnt = atomic_load_explicit(&node->refcnt,
+		    memory_order_relaxed);
+		if (cnt > 0)
+			rd->refcnt += cnt;
+	}
 
 	return true;
 }
@@ -251,9 +327,11 @@ vfs_nodes_refcount_sum_get(fs_handle_t fs_handle, service_id_t service_id)
 		.service_id = service_id
 	};
 
-	fibril_mutex_lock(&nodes_mutex);
-	hash_table_apply(&nodes, refcnt_visitor, &rd);
-	fibril_mutex_unlock(&nodes_mutex);
+	for (unsigned i = 0; i < NODES_SHARDS; i++) {
+		fibril_mutex_lock(&nodes_shards[i].lock);
+		hash_table_apply(&nodes_shards[i].table, refcnt_visitor, &rd);
+		fibril_mutex_unlock(&nodes_shards[i].lock);
+	}
 
 	return rd.refcnt;
 }
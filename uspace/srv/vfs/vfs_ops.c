@@ -48,11 +48,13 @@
 #include <adt/list.h>
 #include <ctype.h>
 #include <assert.h>
+#include <time.h>
 #include <vfs/canonify.h>
 
 /* Forward declarations of static functions. */
 static errno_t vfs_truncate_internal(fs_handle_t, service_id_t, fs_index_t,
     aoff64_t);
+static errno_t vfs_wbuf_write(vfs_file_t *, aoff64_t, size_t *);
 
 /**
  * This rwlock prevents the race between a triplet-to-VFS-node resolution and a
@@ -271,6 +273,9 @@ errno_t vfs_op_mount(int mpfd, unsigned service_id, unsigned flags,
 		vfs_node_addref(mp->node);
 		vfs_node_addref(root);
 		mp->node->mount = root;
+
+		/* Lookups through the mount point must cross it now. */
+		vfs_dcache_invalidate();
 	}
 
 	fibril_rwlock_write_unlock(&namespace_rwlock);
@@ -312,7 +317,8 @@ errno_t vfs_op_open(int fd, int mode)
 	if (!file)
 		return EBADF;
 
-	if ((mode & ~file->permissions) != 0) {
+	/* MODE_BUFWRITE is a behavior flag, not an access right. */
+	if (((mode & ~MODE_BUFWRITE) & ~file->permissions) != 0) {
 		vfs_file_put(file);
 		return EPERM;
 	}
@@ -325,6 +331,8 @@ errno_t vfs_op_open(int fd, int mode)
 	file->open_read = (mode & MODE_READ) != 0;
 	file->open_write = (mode & (MODE_WRITE | MODE_APPEND)) != 0;
 	file->append = (mode & MODE_APPEND) != 0;
+	file->wbuf_enabled = ((mode & MODE_BUFWRITE) != 0) &&
+	    file->open_write;
 
 	if (!file->open_read && !file->open_write) {
 		vfs_file_put(file);
@@ -411,13 +419,11 @@ static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
     void *ipc_cb_data)
 {
 	/*
-	 * The following code strongly depends on the fact that the files data
-	 * structure can be only accessed by a single fibril and all file
-	 * operations are serialized (i.e. the reads and writes cannot
-	 * interleave and a file cannot be closed while it is being read).
-	 *
-	 * Additional synchronization needs to be added once the table of
-	 * open files supports parallel access!
+	 * Writes are serialized by the open file's lock for the whole duration
+	 * of the request.  Reads drop the lock before the data transfer (see
+	 * below), so a client can keep several reads on the same file handle
+	 * in flight at once; the node's contents_rwlock still arbitrates
+	 * between readers and writers of the file contents.
 	 */
 
 	/* Lookup the file structure corresponding to the file descriptor. */
@@ -430,6 +436,32 @@ static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
 		return EINVAL;
 	}
 
+	if (file->wbuf_enabled) {
+		errno_t wrc;
+
+		if (!read && (ipc_cb == rdwr_ipc_client)) {
+			wrc = vfs_wbuf_write(file, pos, (size_t *) ipc_cb_data);
+			vfs_file_put(file);
+			return wrc;
+		}
+
+		/* Reads must not miss data still sitting in the buffer. */
+		wrc = vfs_wbuf_flush(file);
+		if (wrc != EOK) {
+			vfs_file_put(file);
+			return wrc;
+		}
+	}
+
+	/*
+	 * A read does not modify the open file and our reference keeps the
+	 * file's node in place, so the file's lock is not needed during the
+	 * data transfer.  Dropping it early lets other requests on the same
+	 * file handle proceed in parallel.
+	 */
+	if (read)
+		vfs_file_unlock(file);
+
 	vfs_info_t *fs_info = fs_handle_to_info(file->node->fs_handle);
 	assert(fs_info);
 
@@ -495,7 +527,196 @@ static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
 		fibril_rwlock_write_unlock(&file->node->contents_rwlock);
 	}
 
-	vfs_file_put(file);
+	/* Written-to pages kept by the pager are stale now. */
+	if (!read && (rc == EOK))
+		vfs_page_cache_invalidate(file->node);
+
+	if (read)
+		vfs_file_unref(file);
+	else
+		vfs_file_put(file);
+
+	return rc;
+}
+
+/*
+ * Write coalescing (MODE_BUFWRITE).
+ *
+ * A file opened with MODE_BUFWRITE owns a small aggregation buffer in which
+ * writes extending the buffered run are only accumulated; the endpoint FS
+ * server sees them as one large write when the buffer is flushed.  The
+ * buffer is protected by the file's _lock, which vfs_file_get() holds for
+ * the duration of every operation on the file.
+ */
+
+/** Size of the per-file write-aggregation buffer. */
+#define WBUF_SIZE	8192
+
+/** Buffered data older than this is flushed by the next buffered write. */
+#define WBUF_MAX_AGE	MSEC2NSEC(500)
+
+/** Write a run of bytes to the endpoint FS server.
+ *
+ * The caller must have exclusive access to the file.
+ */
+static errno_t vfs_wbuf_write_out(vfs_file_t *file, aoff64_t pos,
+    const void *data, size_t len, size_t *nwritten)
+{
+	errno_t rc = EOK;
+	size_t total = 0;
+
+	fibril_rwlock_write_lock(&file->node->contents_rwlock);
+
+	while (total < len) {
+		async_exch_t *exch = vfs_exchange_grab(file->node->fs_handle);
+
+		ipc_call_t answer;
+		aid_t msg = async_send_4(exch, VFS_OUT_WRITE,
+		    file->node->service_id, file->node->index,
+		    LOWER32(pos + total), UPPER32(pos + total), &answer);
+		rc = async_data_write_start(exch, data + total, len - total);
+		vfs_exchange_release(exch);
+
+		if (rc != EOK) {
+			async_forget(msg);
+			break;
+		}
+
+		async_wait_for(msg, &rc);
+		if (rc != EOK)
+			break;
+
+		size_t wbytes = ipc_get_arg1(&answer);
+
+		/* Update the cached version of node's size. */
+		file->node->size = MERGE_LOUP32(ipc_get_arg2(&answer),
+		    ipc_get_arg3(&answer));
+
+		if (wbytes == 0) {
+			rc = EIO;
+			break;
+		}
+
+		total += wbytes;
+	}
+
+	fibril_rwlock_write_unlock(&file->node->contents_rwlock);
+
+	/* Written-to pages kept by the pager are stale now. */
+	if (total > 0)
+		vfs_page_cache_invalidate(file->node);
+
+	*nwritten = total;
+	return rc;
+}
+
+/** Send buffered data of a file to the endpoint FS server.
+ *
+ * The caller must have exclusive access to the file, either by holding its
+ * _lock or by holding its last reference.  The buffer is emptied even if
+ * the write fails; the error is reported to the caller the same way an
+ * ordinary failed write would be.
+ */
+errno_t vfs_wbuf_flush(vfs_file_t *file)
+{
+	if ((file->wbuf == NULL) || (file->wbuf_len == 0))
+		return EOK;
+
+	size_t nwritten;
+	errno_t rc = vfs_wbuf_write_out(file, file->wbuf_pos, file->wbuf,
+	    file->wbuf_len, &nwritten);
+
+	file->wbuf_len = 0;
+	return rc;
+}
+
+/** Service a client write through the write-aggregation buffer.
+ *
+ * Receives the data phase of the current VFS_IN_WRITE request.  Writes
+ * which extend the buffered run are merely copied into the buffer;
+ * everything else causes the buffer to be flushed first.
+ */
+static errno_t vfs_wbuf_write(vfs_file_t *file, aoff64_t pos,
+    size_t *out_bytes)
+{
+	ipc_call_t call;
+	size_t size;
+	errno_t rc;
+
+	if (!async_data_write_receive(&call, &size)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	if (file->wbuf == NULL) {
+		file->wbuf = malloc(WBUF_SIZE);
+		if (file->wbuf == NULL) {
+			async_answer_0(&call, ENOMEM);
+			return ENOMEM;
+		}
+		file->wbuf_len = 0;
+	}
+
+	if (file->append) {
+		pos = (file->wbuf_len > 0) ?
+		    (file->wbuf_pos + file->wbuf_len) : file->node->size;
+	}
+
+	/* Flush the buffer if this write does not extend the buffered run. */
+	if ((file->wbuf_len > 0) &&
+	    ((pos != file->wbuf_pos + file->wbuf_len) ||
+	    (file->wbuf_len + size > WBUF_SIZE))) {
+		rc = vfs_wbuf_flush(file);
+		if (rc != EOK) {
+			async_answer_0(&call, rc);
+			return rc;
+		}
+	}
+
+	if (size > WBUF_SIZE) {
+		/* Too large to aggregate; write it out directly. */
+		void *buf = malloc(size);
+		if (buf == NULL) {
+			async_answer_0(&call, ENOMEM);
+			return ENOMEM;
+		}
+
+		rc = async_data_write_finalize(&call, buf, size);
+		if (rc != EOK) {
+			free(buf);
+			return rc;
+		}
+
+		rc = vfs_wbuf_write_out(file, pos, buf, size, out_bytes);
+		free(buf);
+
+		/* A short write is not an error for the client. */
+		if (*out_bytes > 0)
+			rc = EOK;
+
+		return rc;
+	}
+
+	/* An empty buffer starts a new run at this position. */
+	if (file->wbuf_len == 0) {
+		file->wbuf_pos = pos;
+		getuptime(&file->wbuf_stamp);
+	}
+
+	rc = async_data_write_finalize(&call, file->wbuf + file->wbuf_len,
+	    size);
+	if (rc != EOK)
+		return rc;
+
+	file->wbuf_len += size;
+	*out_bytes = size;
+
+	/* Flush on the size and age thresholds. */
+	struct timespec now;
+	getuptime(&now);
+	if ((file->wbuf_len == WBUF_SIZE) ||
+	    (ts_sub_diff(&now, &file->wbuf_stamp) >= WBUF_MAX_AGE))
+		rc = vfs_wbuf_flush(file);
 
 	return rc;
 }
@@ -510,6 +731,56 @@ errno_t vfs_op_read(int fd, aoff64_t pos, size_t *out_bytes)
 	return vfs_rdwr(fd, pos, true, rdwr_ipc_client, out_bytes);
 }
 
+/* Maximum size of a single directory entry name; matches struct dirent. */
+#define READDIR_NAME_BUF  256
+
+errno_t vfs_op_readdir(int fd, aoff64_t *pos, void *buf, size_t size,
+    size_t *out_bytes)
+{
+	char name[READDIR_NAME_BUF];
+	size_t used = 0;
+	errno_t rc = EOK;
+
+	/*
+	 * Batch up directory entries from the endpoint FS into the buffer
+	 * as consecutive null-terminated strings. The FS protocol returns
+	 * one entry per request, but those round trips stay between us and
+	 * the FS server; the client gets the whole batch in one transfer.
+	 */
+	while (used < size) {
+		rdwr_io_chunk_t chunk = {
+			.buffer = name,
+			.size = sizeof(name)
+		};
+
+		rc = vfs_rdwr_internal(fd, *pos, true, &chunk);
+		if (rc != EOK)
+			break;
+		if (chunk.size == 0)
+			break;
+
+		size_t len = str_nsize(name, sizeof(name));
+		if (len >= sizeof(name)) {
+			/* The FS did not null-terminate the entry name. */
+			rc = EIO;
+			break;
+		}
+
+		/* Leave an entry that does not fit for the next batch. */
+		if (used + len + 1 > size)
+			break;
+
+		memcpy((char *) buf + used, name, len + 1);
+		used += len + 1;
+		*pos += chunk.size;
+	}
+
+	*out_bytes = used;
+
+	/* Report an error only if not even one entry was read. */
+	return (used > 0) ? EOK : rc;
+}
+
 errno_t vfs_op_rename(int basefd, char *old, char *new)
 {
 	vfs_file_t *base_file = vfs_file_get(basefd);
@@ -622,12 +893,20 @@ errno_t vfs_op_resize(int fd, int64_t size)
 		return EINVAL;
 	}
 
+	errno_t wrc = vfs_wbuf_flush(file);
+	if (wrc != EOK) {
+		vfs_file_put(file);
+		return wrc;
+	}
+
 	fibril_rwlock_write_lock(&file->node->contents_rwlock);
 
 	errno_t rc = vfs_truncate_internal(file->node->fs_handle,
 	    file->node->service_id, file->node->index, size);
-	if (rc == EOK)
+	if (rc == EOK) {
 		file->node->size = size;
+		vfs_page_cache_invalidate(file->node);
+	}
 
 	fibril_rwlock_write_unlock(&file->node->contents_rwlock);
 	vfs_file_put(file);
@@ -651,6 +930,52 @@ errno_t vfs_op_stat(int fd)
 	return rc;
 }
 
+/** Read file information from the endpoint FS into a local buffer. */
+static errno_t vfs_stat_internal(vfs_node_t *node, vfs_stat_t *stat)
+{
+	async_exch_t *exch = vfs_exchange_grab(node->fs_handle);
+
+	ipc_call_t answer;
+	aid_t msg = async_send_3(exch, VFS_OUT_STAT, node->service_id,
+	    node->index, false, &answer);
+	if (msg == 0) {
+		vfs_exchange_release(exch);
+		return EINVAL;
+	}
+
+	errno_t rc = async_data_read_start(exch, stat, sizeof(vfs_stat_t));
+
+	vfs_exchange_release(exch);
+
+	if (rc == EOK)
+		async_wait_for(msg, &rc);
+	else
+		async_forget(msg);
+
+	return rc;
+}
+
+errno_t vfs_op_stat_path(int basefd, char *path, vfs_stat_t *stat)
+{
+	int fd = -1;
+	errno_t rc = vfs_op_walk(basefd, 0, path, &fd);
+	if (rc != EOK)
+		return rc;
+
+	vfs_file_t *file = vfs_file_get(fd);
+	if (!file) {
+		(void) vfs_op_put(fd);
+		return EBADF;
+	}
+
+	rc = vfs_stat_internal(file->node, stat);
+
+	vfs_file_put(file);
+	(void) vfs_op_put(fd);
+
+	return rc;
+}
+
 errno_t vfs_op_statfs(int fd)
 {
 	vfs_file_t *file = vfs_file_get(fd);
@@ -674,6 +999,12 @@ errno_t vfs_op_sync(int fd)
 	if (!file)
 		return EBADF;
 
+	errno_t wrc = vfs_wbuf_flush(file);
+	if (wrc != EOK) {
+		vfs_file_put(file);
+		return wrc;
+	}
+
 	async_exch_t *fs_exch = vfs_exchange_grab(file->node->fs_handle);
 
 	aid_t msg;
@@ -826,6 +1157,9 @@ errno_t vfs_op_unmount(int mpfd)
 	vfs_node_put(mp->node);
 	mp->node->mount = NULL;
 
+	/* No cached result may keep pointing into the unmounted file system. */
+	vfs_dcache_invalidate();
+
 	fibril_rwlock_write_unlock(&namespace_rwlock);
 
 	vfs_file_put(mp);
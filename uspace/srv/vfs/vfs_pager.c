@@ -38,23 +38,207 @@
 #include "vfs.h"
 #include <async.h>
 #include <fibril_synch.h>
+#include <adt/hash_table.h>
+#include <adt/hash.h>
+#include <adt/list.h>
 #include <errno.h>
+#include <stdlib.h>
+#include <mem.h>
 #include <as.h>
 
+/*
+ * The page cache retains the pages handed out to the pager's clients.  When
+ * the kernel picks up our answer to IPC_M_PAGE_IN, it maps the very physical
+ * frame backing the page in our address space into the faulting task, so as
+ * long as a page stays in the cache, all tasks mapping the same file range
+ * share one frame and repeated faults are served without talking to the
+ * endpoint file system at all.
+ *
+ * Pages are keyed by the identity of the underlying file system node rather
+ * than by the client's file handle, so that mappings created from different
+ * tasks (and thus different file handles) of the same file meet in the cache.
+ */
+
+/** Maximum number of pages retained by the page cache. */
+#define PAGE_CACHE_CAPACITY	128
+
+typedef struct {
+	ht_link_t pc_link;	/**< Page cache hash table link. */
+	link_t lru_link;	/**< Page cache LRU list link. */
+
+	/* Identity of the file system node the page belongs to. */
+	vfs_triplet_t triplet;
+
+	/** Offset of the page in the file. */
+	aoff64_t offset;
+
+	/** The cached page itself, mapped in our address space. */
+	void *page;
+
+	/** Size of the cached page. */
+	size_t page_size;
+} page_cache_entry_t;
+
+typedef struct {
+	vfs_triplet_t triplet;
+	aoff64_t offset;
+} page_cache_key_t;
+
+/** Protects page_cache, page_cache_lru and page_cache_count. */
+static FIBRIL_MUTEX_INITIALIZE(page_cache_mutex);
+
+static hash_table_t page_cache;
+static LIST_INITIALIZE(page_cache_lru);
+static size_t page_cache_count;
+
+static size_t page_cache_key_hash(const void *key)
+{
+	const page_cache_key_t *pk = key;
+	size_t hash = hash_combine(pk->triplet.fs_handle, pk->triplet.index);
+	hash = hash_combine(hash, pk->triplet.service_id);
+	return hash_combine(hash, pk->offset);
+}
+
+static size_t page_cache_hash(const ht_link_t *item)
+{
+	page_cache_entry_t *entry = hash_table_get_inst(item,
+	    page_cache_entry_t, pc_link);
+	page_cache_key_t key = {
+		.triplet = entry->triplet,
+		.offset = entry->offset
+	};
+	return page_cache_key_hash(&key);
+}
+
+static bool page_cache_key_equal(const void *key, const ht_link_t *item)
+{
+	const page_cache_key_t *pk = key;
+	page_cache_entry_t *entry = hash_table_get_inst(item,
+	    page_cache_entry_t, pc_link);
+	return (pk->triplet.fs_handle == entry->triplet.fs_handle) &&
+	    (pk->triplet.service_id == entry->triplet.service_id) &&
+	    (pk->triplet.index == entry->triplet.index) &&
+	    (pk->offset == entry->offset);
+}
+
+/** Page cache hash table operations. */
+static const hash_table_ops_t page_cache_ops = {
+	.hash = page_cache_hash,
+	.key_hash = page_cache_key_hash,
+	.key_equal = page_cache_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL,
+};
+
+/** Initialize the pager's page cache.
+ *
+ * @return		Return true on success, false on failure.
+ */
+bool vfs_pager_init(void)
+{
+	return hash_table_create(&page_cache, 0, 0, &page_cache_ops);
+}
+
+/** Drop a page from the page cache.
+ *
+ * Must be called with page_cache_mutex held.  Only our own reference to the
+ * page is given up; frames still mapped by clients stay alive thanks to the
+ * references the kernel took on their behalf.
+ */
+static void page_cache_evict(page_cache_entry_t *entry)
+{
+	hash_table_remove_item(&page_cache, &entry->pc_link);
+	list_remove(&entry->lru_link);
+	page_cache_count--;
+	as_area_destroy(entry->page);
+	free(entry);
+}
+
+/** Find a cached page.
+ *
+ * Must be called with page_cache_mutex held.
+ */
+static page_cache_entry_t *page_cache_find(vfs_triplet_t *triplet,
+    aoff64_t offset)
+{
+	page_cache_key_t key = {
+		.triplet = *triplet,
+		.offset = offset
+	};
+	ht_link_t *tmp = hash_table_find(&page_cache, &key);
+	if (!tmp)
+		return NULL;
+	return hash_table_get_inst(tmp, page_cache_entry_t, pc_link);
+}
+
+/** Throw away all cached pages of a node.
+ *
+ * Called whenever the contents of the node changes under the cache, i.e. on
+ * writes, truncations and node destruction.  Existing mappings keep the old
+ * frames (private mappings are snapshots by nature), but new faults will see
+ * the fresh contents.
+ *
+ * @param node		VFS node whose pages are to be dropped.
+ */
+void vfs_page_cache_invalidate(vfs_node_t *node)
+{
+	fibril_mutex_lock(&page_cache_mutex);
+	list_foreach_safe(page_cache_lru, cur, next) {
+		page_cache_entry_t *entry = list_get_instance(cur,
+		    page_cache_entry_t, lru_link);
+		if ((entry->triplet.fs_handle == node->fs_handle) &&
+		    (entry->triplet.service_id == node->service_id) &&
+		    (entry->triplet.index == node->index))
+			page_cache_evict(entry);
+	}
+	fibril_mutex_unlock(&page_cache_mutex);
+}
+
 void vfs_page_in(ipc_call_t *req)
 {
 	aoff64_t offset = ipc_get_arg1(req);
 	size_t page_size = ipc_get_arg2(req);
 	int fd = ipc_get_arg3(req);
+	page_cache_entry_t *entry;
 	void *page;
 	errno_t rc;
 
+	vfs_file_t *file = vfs_file_get(fd);
+	if (!file) {
+		async_answer_0(req, EBADF);
+		return;
+	}
+
+	vfs_triplet_t triplet = {
+		.fs_handle = file->node->fs_handle,
+		.service_id = file->node->service_id,
+		.index = file->node->index
+	};
+
+	/*
+	 * Fast path: answer straight from the page cache.  We answer while
+	 * still holding the mutex so that the page cannot be evicted before
+	 * the kernel picks up the frame behind it.
+	 */
+	fibril_mutex_lock(&page_cache_mutex);
+	entry = page_cache_find(&triplet, offset);
+	if (entry && (entry->page_size >= page_size)) {
+		list_remove(&entry->lru_link);
+		list_append(&entry->lru_link, &page_cache_lru);
+		async_answer_1(req, EOK, (sysarg_t) entry->page);
+		fibril_mutex_unlock(&page_cache_mutex);
+		vfs_file_put(file);
+		return;
+	}
+	fibril_mutex_unlock(&page_cache_mutex);
+
 	page = as_area_create(AS_AREA_ANY, page_size,
 	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
 	    AS_AREA_UNPAGED);
 
 	if (page == AS_MAP_FAILED) {
 		async_answer_0(req, ENOMEM);
+		vfs_file_put(file);
 		return;
 	}
 
@@ -77,15 +261,70 @@ void vfs_page_in(ipc_call_t *req)
 		chunk.size = page_size - total;
 	} while (total < page_size);
 
-	async_answer_1(req, rc, (sysarg_t) page);
+	if (rc != EOK) {
+		async_answer_0(req, rc);
+		as_area_destroy(page);
+		vfs_file_put(file);
+		return;
+	}
 
 	/*
-	 * FIXME:
-	 * This is just for now until we implement proper page cache
-	 * management.  Not keeping the pages around in a cache results in
-	 * inherently non-coherent private mappings.
+	 * Zero out the part of the page beyond the end of file.  Shared pages
+	 * must not leak whatever the anonymous backend put there, and writing
+	 * the whole page also makes sure it is faulted in before we hand it to
+	 * the kernel.
 	 */
-	as_area_destroy(page);
+	if (total < page_size)
+		memset(page + total, 0, page_size - total);
+
+	fibril_mutex_lock(&page_cache_mutex);
+
+	entry = page_cache_find(&triplet, offset);
+	if (entry && (entry->page_size >= page_size)) {
+		/*
+		 * Someone else paged the same page in while we were reading
+		 * it.  Use their copy so that all clients share one frame.
+		 */
+		list_remove(&entry->lru_link);
+		list_append(&entry->lru_link, &page_cache_lru);
+		async_answer_1(req, EOK, (sysarg_t) entry->page);
+		fibril_mutex_unlock(&page_cache_mutex);
+		as_area_destroy(page);
+		vfs_file_put(file);
+		return;
+	}
+
+	entry = malloc(sizeof(page_cache_entry_t));
+	if (entry) {
+		entry->triplet = triplet;
+		entry->offset = offset;
+		entry->page = page;
+		entry->page_size = page_size;
+		hash_table_insert(&page_cache, &entry->pc_link);
+		list_append(&entry->lru_link, &page_cache_lru);
+		page_cache_count++;
+
+		while (page_cache_count > PAGE_CACHE_CAPACITY) {
+			page_cache_entry_t *victim = list_get_instance(
+			    list_first(&page_cache_lru), page_cache_entry_t,
+			    lru_link);
+			page_cache_evict(victim);
+		}
+
+		async_answer_1(req, EOK, (sysarg_t) page);
+		fibril_mutex_unlock(&page_cache_mutex);
+	} else {
+		/*
+		 * Cannot cache the page.  Serve this one fault and drop the
+		 * page; the kernel references the frame on behalf of the
+		 * client while processing the answer.
+		 */
+		fibril_mutex_unlock(&page_cache_mutex);
+		async_answer_1(req, EOK, (sysarg_t) page);
+		as_area_destroy(page);
+	}
+
+	vfs_file_put(file);
 }
 
 /**
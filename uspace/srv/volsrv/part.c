@@ -53,10 +53,32 @@
 #include "volume.h"
 
 static errno_t vol_part_add_locked(vol_parts_t *, service_id_t);
+static errno_t vol_part_create(vol_parts_t *, service_id_t, vol_part_t **);
+static errno_t vol_part_attach_locked(vol_parts_t *, vol_part_t *);
+static void vol_part_probe_batch(vol_part_t **, size_t);
 static void vol_part_remove_locked(vol_part_t *);
 static errno_t vol_part_find_by_id_ref_locked(vol_parts_t *, service_id_t,
     vol_part_t **);
 
+/** Maximum number of fibrils probing new partitions in parallel */
+#define VOL_PROBE_FIBRILS 8
+
+/** State shared by a batch of partition probe fibrils */
+typedef struct {
+	/** Synchronize access to batch state */
+	fibril_mutex_t lock;
+	/** Signalled when the last worker finishes */
+	fibril_condvar_t done_cv;
+	/** Partitions to probe (failed entries are set to @c NULL) */
+	vol_part_t **parts;
+	/** Number of partitions */
+	size_t count;
+	/** Index of the next partition to probe */
+	size_t next;
+	/** Number of worker fibrils still running */
+	size_t nworkers;
+} vol_part_probe_batch_t;
+
 struct fsname_type {
 	const char *name;
 	vol_fstype_t fstype;
@@ -91,23 +113,30 @@ static errno_t vol_part_check_new(vol_parts_t *parts)
 {
 	bool already_known;
 	bool still_exists;
-	category_id_t part_cat;
 	service_id_t *svcs;
+	vol_part_t **nparts;
 	size_t count, i;
+	size_t nnew;
 	link_t *cur, *next;
 	vol_part_t *part;
 	errno_t rc;
 
 	fibril_mutex_lock(&parts->lock);
 
-	rc = loc_category_get_id("partition", &part_cat, IPC_FLAG_BLOCKING);
-	if (rc != EOK) {
-		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed resolving category 'partition'.");
-		fibril_mutex_unlock(&parts->lock);
-		return ENOENT;
+	/* The category ID is static so it only needs to be resolved once. */
+	if (!parts->part_cat_valid) {
+		rc = loc_category_get_id("partition", &parts->part_cat,
+		    IPC_FLAG_BLOCKING);
+		if (rc != EOK) {
+			log_msg(LOG_DEFAULT, LVL_ERROR, "Failed resolving category 'partition'.");
+			fibril_mutex_unlock(&parts->lock);
+			return ENOENT;
+		}
+
+		parts->part_cat_valid = true;
 	}
 
-	rc = loc_category_get_svcs(part_cat, &svcs, &count);
+	rc = loc_category_get_svcs(parts->part_cat, &svcs, &count);
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed getting list of partition "
 		    "devices.");
@@ -115,7 +144,15 @@ static errno_t vol_part_check_new(vol_parts_t *parts)
 		return EIO;
 	}
 
-	/* Check for new partitions */
+	nparts = calloc(count, sizeof(vol_part_t *));
+	if (nparts == NULL && count > 0) {
+		free(svcs);
+		fibril_mutex_unlock(&parts->lock);
+		return ENOMEM;
+	}
+
+	/* Create partition structures for new partitions */
+	nnew = 0;
 	for (i = 0; i < count; i++) {
 		already_known = false;
 
@@ -130,14 +167,36 @@ static errno_t vol_part_check_new(vol_parts_t *parts)
 		if (!already_known) {
 			log_msg(LOG_DEFAULT, LVL_DEBUG, "Found partition '%lu'",
 			    (unsigned long) svcs[i]);
-			rc = vol_part_add_locked(parts, svcs[i]);
+			rc = vol_part_create(parts, svcs[i], &nparts[nnew]);
 			if (rc != EOK) {
 				log_msg(LOG_DEFAULT, LVL_ERROR, "Could not add "
 				    "partition.");
+				continue;
 			}
+
+			++nnew;
 		}
 	}
 
+	/*
+	 * Probe and mount the new partitions in parallel, without holding
+	 * the lock, so that waiting for one device does not hold up the
+	 * others. The partitions are not on the list yet, so nobody else
+	 * can see them.
+	 */
+	if (nnew > 0) {
+		fibril_mutex_unlock(&parts->lock);
+		vol_part_probe_batch(nparts, nnew);
+		fibril_mutex_lock(&parts->lock);
+
+		for (i = 0; i < nnew; i++) {
+			if (nparts[i] != NULL)
+				(void) vol_part_attach_locked(parts, nparts[i]);
+		}
+	}
+
+	free(nparts);
+
 	/* Check for removed partitions */
 	cur = list_first(&parts->parts);
 	while (cur != NULL) {
@@ -211,7 +270,14 @@ static errno_t vol_part_probe(vol_part_t *part)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "Probe partition %s", part->svc_name);
 
-	assert(fibril_mutex_is_locked(&part->parts->lock));
+	/*
+	 * A partition that is already on the partition list must be
+	 * protected by the list lock. Newly discovered partitions are
+	 * probed before being attached (possibly several in parallel)
+	 * and are private to the prober.
+	 */
+	assert(!link_used(&part->lparts) ||
+	    fibril_mutex_is_locked(&part->parts->lock));
 
 	fst = &fstab[0];
 	while (fst->name != NULL) {
@@ -405,6 +471,162 @@ static errno_t vol_part_mount(vol_part_t *part)
 	return rc;
 }
 
+/** Create partition structure for a newly discovered partition.
+ *
+ * The partition is neither probed nor attached to the partition list yet.
+ *
+ * @param parts Partition list
+ * @param sid Service ID of the partition
+ * @param rpart Place to store pointer to new partition structure
+ * @return EOK on success or an error code
+ */
+static errno_t vol_part_create(vol_parts_t *parts, service_id_t sid,
+    vol_part_t **rpart)
+{
+	vol_part_t *part;
+	errno_t rc;
+
+	part = vol_part_new();
+	if (part == NULL)
+		return ENOMEM;
+
+	part->svc_id = sid;
+	part->parts = parts;
+
+	rc = loc_service_get_name(sid, &part->svc_name);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed getting service name.");
+		vol_part_delete(part);
+		return rc;
+	}
+
+	*rpart = part;
+	return EOK;
+}
+
+/** Attach probed partition to the partition list.
+ *
+ * If a partition with the same service ID was attached in the meantime,
+ * the new partition structure is destroyed.
+ *
+ * @param parts Partition list
+ * @param part Partition
+ * @return EOK on success, EEXIST if the partition is already present
+ */
+static errno_t vol_part_attach_locked(vol_parts_t *parts, vol_part_t *part)
+{
+	vol_part_t *old;
+
+	assert(fibril_mutex_is_locked(&parts->lock));
+
+	/* Check for duplicates */
+	if (vol_part_find_by_id_ref_locked(parts, part->svc_id, &old) == EOK) {
+		vol_part_del_ref(old);
+		vol_part_delete(part);
+		return EEXIST;
+	}
+
+	list_append(&part->lparts, &parts->parts);
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "Added partition %zu", part->svc_id);
+
+	return EOK;
+}
+
+/** Worker fibril probing and mounting partitions from a batch.
+ *
+ * Workers take partitions off the shared batch until none remain.
+ * Partitions that fail to probe or mount are destroyed and their
+ * slot in the batch is set to @c NULL.
+ *
+ * @param arg Batch (vol_part_probe_batch_t *)
+ * @return EOK (fibril return value is unused)
+ */
+static errno_t vol_part_probe_fibril(void *arg)
+{
+	vol_part_probe_batch_t *batch = (vol_part_probe_batch_t *) arg;
+	vol_part_t *part;
+	size_t i;
+	errno_t rc;
+
+	fibril_mutex_lock(&batch->lock);
+
+	while (batch->next < batch->count) {
+		i = batch->next++;
+		part = batch->parts[i];
+		fibril_mutex_unlock(&batch->lock);
+
+		rc = vol_part_probe(part);
+		if (rc == EOK)
+			rc = vol_part_mount(part);
+
+		if (rc != EOK)
+			vol_part_delete(part);
+
+		fibril_mutex_lock(&batch->lock);
+		if (rc != EOK)
+			batch->parts[i] = NULL;
+	}
+
+	assert(batch->nworkers > 0);
+	--batch->nworkers;
+	if (batch->nworkers == 0)
+		fibril_condvar_signal(&batch->done_cv);
+
+	fibril_mutex_unlock(&batch->lock);
+	return EOK;
+}
+
+/** Probe and mount a batch of partitions with bounded parallelism.
+ *
+ * Blocks until every partition in the batch has been processed.
+ * Must be called without the partition list lock held.
+ *
+ * @param nparts Array of partitions to probe (failed entries are
+ *               destroyed and set to @c NULL)
+ * @param count Number of partitions
+ */
+static void vol_part_probe_batch(vol_part_t **nparts, size_t count)
+{
+	vol_part_probe_batch_t batch;
+	size_t nw;
+	size_t i;
+	fid_t fid;
+
+	fibril_mutex_initialize(&batch.lock);
+	fibril_condvar_initialize(&batch.done_cv);
+	batch.parts = nparts;
+	batch.count = count;
+	batch.next = 0;
+	batch.nworkers = 0;
+
+	nw = count < VOL_PROBE_FIBRILS ? count : VOL_PROBE_FIBRILS;
+
+	fibril_mutex_lock(&batch.lock);
+
+	for (i = 0; i < nw; i++) {
+		fid = fibril_create(vol_part_probe_fibril, &batch);
+		if (fid == 0)
+			break;
+
+		++batch.nworkers;
+		fibril_add_ready(fid);
+	}
+
+	if (batch.nworkers == 0) {
+		/* Could not create any worker. Probe in place. */
+		batch.nworkers = 1;
+		fibril_mutex_unlock(&batch.lock);
+		(void) vol_part_probe_fibril(&batch);
+		fibril_mutex_lock(&batch.lock);
+	}
+
+	while (batch.nworkers > 0)
+		fibril_condvar_wait(&batch.done_cv, &batch.lock);
+
+	fibril_mutex_unlock(&batch.lock);
+}
+
 static errno_t vol_part_add_locked(vol_parts_t *parts, service_id_t sid)
 {
 	vol_part_t *part;
@@ -422,18 +644,9 @@ static errno_t vol_part_add_locked(vol_parts_t *parts, service_id_t sid)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "partition %zu is new", sid);
 
-	part = vol_part_new();
-	if (part == NULL)
-		return ENOMEM;
-
-	part->svc_id = sid;
-	part->parts = parts;
-
-	rc = loc_service_get_name(sid, &part->svc_name);
-	if (rc != EOK) {
-		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed getting service name.");
-		goto error;
-	}
+	rc = vol_part_create(parts, sid, &part);
+	if (rc != EOK)
+		return rc;
 
 	rc = vol_part_probe(part);
 	if (rc != EOK)
@@ -443,11 +656,7 @@ static errno_t vol_part_add_locked(vol_parts_t *parts, service_id_t sid)
 	if (rc != EOK)
 		goto error;
 
-	list_append(&part->lparts, &parts->parts);
-
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "Added partition %zu", part->svc_id);
-
-	return EOK;
+	return vol_part_attach_locked(parts, part);
 
 error:
 	vol_part_delete(part);
@@ -480,6 +689,44 @@ errno_t vol_part_add_part(vol_parts_t *parts, service_id_t sid)
 static void vol_part_cat_change_cb(void *arg)
 {
 	vol_parts_t *parts = (vol_parts_t *) arg;
+	category_id_t *cats;
+	category_id_t part_cat;
+	size_t count;
+	sysarg_t gen;
+	bool ours = true;
+	errno_t rc;
+
+	/*
+	 * Change events are coalesced, so fetch the entire set of
+	 * categories changed since the last processed generation and
+	 * skip the rescan when 'partition' is not among them.
+	 */
+	rc = loc_get_cat_changes(parts->loc_gen, &cats, &count, &gen);
+	if (rc == EOK) {
+		/* Use the category ID cached by vol_part_check_new(). */
+		fibril_mutex_lock(&parts->lock);
+		if (parts->part_cat_valid) {
+			part_cat = parts->part_cat;
+			rc = EOK;
+		} else {
+			rc = loc_category_get_id("partition", &part_cat, 0);
+		}
+		fibril_mutex_unlock(&parts->lock);
+
+		if (rc == EOK) {
+			ours = false;
+			for (size_t i = 0; i < count; i++) {
+				if (cats[i] == part_cat)
+					ours = true;
+			}
+		}
+
+		free(cats);
+		parts->loc_gen = gen;
+	}
+
+	if (!ours)
+		return;
 
 	(void) vol_part_check_new(parts);
 }
@@ -77,6 +77,12 @@ typedef struct vol_parts {
 	list_t parts;
 	/** Underlying volumes */
 	struct vol_volumes *volumes;
+	/** Location service change generation last processed */
+	sysarg_t loc_gen;
+	/** Cached ID of the 'partition' category */
+	category_id_t part_cat;
+	/** @c true iff @c part_cat has been resolved */
+	bool part_cat_valid;
 } vol_parts_t;
 
 #endif